@@ -0,0 +1,197 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "scattering_analyzer.h"
+
+struct NoiseAnalysisResults;
+
+namespace analysis_shard {
+
+/**
+ * Analysis shard file format (.rtshard): mergeable analyzer state of one time range
+ *
+ * ScatteringData and NoiseAnalysisResults describe a single run and cannot
+ * be combined, so a recording analyzed in pieces (spans on several threads,
+ * or time ranges on several machines) could not be reduced to one result.
+ * A shard keeps only what combines exactly: per-pixel counts with their
+ * first frame, running totals and maxima, Welford moments (merged with
+ * Chan's formula), the cluster size histogram, tile totals and the
+ * per-frame counts of the last window_frames frames. Merging a shard with
+ * the one that follows it in time gives the shard a single pass over both
+ * ranges would have produced; top-K hot pixels are re-derived from the
+ * merged counts.
+ *
+ * Not kept: the per-pixel window plane and decay rates (both need every
+ * frame's mask), and the last frame each pixel scattered, which is only
+ * known for pixels in a shard's own top-K list (see merge).
+ *
+ * File layout (little-endian): "RTSHARD\0", u32 version, then the body as
+ * LEB128 varints (counts as gaps between raster indices) and raw doubles.
+ * save() writes a temporary file and renames it over the target, so a
+ * crash mid-write leaves the previous file intact (see CheckpointWriter).
+ *
+ * **Usage:**
+ * ```cpp
+ * AnalysisShard shard;                           // Per span / machine
+ * analyzer.export_shard(shard);
+ * shard.add_noise(results);                      // Per frame
+ *
+ * AnalysisShard total = shards[0];               // In time order
+ * for (size_t i = 1; i < shards.size(); ++i) total.merge(shards[i]);
+ * total.publish(data);                           // ScatteringData for the CSV exporters
+ * ```
+ */
+constexpr char FILE_MAGIC[8] = {'R', 'T', 'S', 'H', 'A', 'R', 'D', '\0'};
+constexpr uint32_t VERSION = 2;
+constexpr const char* EXTENSION = ".rtshard";
+
+} // namespace analysis_shard
+
+/**
+ * Mergeable analysis state of one time range (see analysis_shard)
+ */
+class AnalysisShard {
+public:
+    /**
+     * Count, mean and sum of squared deviations (Welford), plus extremes
+     */
+    struct Moments {
+        int64_t n = 0;
+        double mean = 0.0;
+        double m2 = 0.0;
+        double min = std::numeric_limits<double>::infinity();    // Unset while min > max
+        double max = -std::numeric_limits<double>::infinity();
+
+        void add(double x);
+        void merge(const Moments& other);   // Chan et al. parallel update
+        double variance() const { return n > 1 ? m2 / (n - 1) : 0.0; }
+        double stddev() const;
+    };
+
+    /**
+     * Temporal count of one pixel
+     */
+    struct Pixel {
+        uint32_t key;                      // y * width + x
+        int64_t count;
+        int64_t first_seen;                // Frame index within the shard
+    };
+
+    /**
+     * Region or reference totals (names must match to merge)
+     */
+    struct Totals {
+        std::string name;
+        int64_t scattering_events = 0;
+        int64_t missing_events = 0;
+        int64_t max_scattering_pixels = 0;
+    };
+
+    /**
+     * Per-frame noise analysis results folded into moments
+     */
+    struct NoiseSummary {
+        Moments num_dots;
+        Moments signal_mean;
+        Moments signal_std;
+        Moments noise_mean;
+        Moments noise_std;
+        Moments snr_db;
+        Moments contrast_ratio;
+
+        void add(const NoiseAnalysisResults& results);
+        void merge(const NoiseSummary& other);
+    };
+
+    int width = 0;
+    int height = 0;
+    uint64_t reference_hash = 0;           // Of the unshifted reference (see reference_hash)
+    int64_t begin_timestamp = 0;           // Covered time range in us (informational)
+    int64_t end_timestamp = 0;
+
+    // Scattering
+    int64_t frames = 0;
+    int64_t total_scattering_events = 0;
+    int64_t candidate_pixels = 0;          // Pixels outside the reference
+    Moments rate;                          // Scattering pixels per frame (min / max unset from export_shard)
+    std::vector<Pixel> pixels;             // Non-zero counts in raster order
+    int hot_pixel_k = 16;
+    std::vector<ScatteringAnalyzer::HotPixel> hot_pixels;   // Top-K, highest count first
+
+    int window_size = 0;                   // Configured window (0 = disabled)
+    std::vector<int32_t> window_tail;      // Scattering pixels of the last min(frames, window_size) frames, oldest first
+
+    bool clusters_enabled = false;
+    int64_t total_clusters = 0;
+    int64_t total_single_pixel = 0;
+    int64_t max_largest_pixels = 0;
+    std::array<int64_t, ScatteringAnalyzer::CLUSTER_BINS> cluster_histogram{};
+
+    std::vector<Totals> regions;
+    std::vector<Totals> references;
+    std::vector<int64_t> plane_events;     // Per bit plane (empty = plane sweep off)
+    cv::Mat tile_total;                    // CV_32SC1 (empty = tile map off)
+
+    // Noise
+    NoiseSummary noise;
+
+    /**
+     * Fold one frame's noise results in
+     */
+    void add_noise(const NoiseAnalysisResults& results) { noise.add(results); }
+
+    /**
+     * Append a shard covering the frames right after this one
+     *
+     * Counts, totals, histograms and moments combine exactly (moments up to
+     * floating-point rounding), and merging is associative, so shards can
+     * be reduced pairwise in any grouping as long as their time order is
+     * kept. An empty shard on either side is the identity. The merged top-K
+     * takes each pixel's last_seen_frame from the latest shard that had it
+     * in its own top-K; otherwise it is the pixel's first frame in the
+     * latest shard it scattered in (a lower bound).
+     * @param later Shard of the same sensor and configuration
+     * @return false if size, reference, regions or settings differ (this is unchanged)
+     */
+    bool merge(const AnalysisShard& later);
+
+    /**
+     * Fill the cumulative fields of a ScatteringData from this shard
+     *
+     * Counts, hot pixels, totals, averages, the window average, clusters,
+     * regions, references, planes and tiles; per-frame fields and the
+     * per-pixel window and decay planes are left untouched.
+     */
+    void publish(ScatteringAnalyzer::ScatteringData& data) const;
+
+    /**
+     * Export shard totals as CSV (one metric per row)
+     * @return true if written successfully
+     */
+    bool export_summary_csv(const std::string& filepath) const;
+
+    /**
+     * Fingerprint of a packed reference (FNV-1a over its words)
+     */
+    static uint64_t hash_reference(const video::BinaryFrame& reference);
+
+    void serialize(std::vector<uint8_t>& out) const;
+    bool deserialize(const uint8_t* data, size_t size);
+
+    /**
+     * Write or read a .rtshard file
+     * @return false if the file cannot be written / read or is not a shard
+     */
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+    bool is_compatible(const AnalysisShard& later) const;
+    std::vector<ScatteringAnalyzer::HotPixel> merge_hot_pixels(const std::vector<Pixel>& merged,
+                                                               const AnalysisShard& later) const;
+};
@@ -22,23 +22,302 @@ public:
 
         // Frame generation
         int accumulation_time_us = 1000;  // Event accumulation period in microseconds (100-100000 μs)
+        bool native_accumulation = true;  // Accumulate events directly into the binary frame (false = SDK frame generator)
+        bool polarity_planes = false;     // Native frames also carry ON/OFF bits per pixel (set pixels 252-255, not 255)
+        int preview_binning = 0;          // Native frames: also OR-bin events into a 2x2 or 4x4 display preview (0 = off)
+        int accumulation_threads = 1;     // Native frames: threads writing large batches by row band (1 = serial)
+        bool raw_decode = false;          // Native frames: decode EVT 2.1/3.0 buffers straight into the accumulator
+        int slice_mode = 0;               // Native frames: 0 = every accumulation window, 1 = every slice_events events,
+                                          // 2 = slice_events events or accumulation_time_us, whichever comes first
+        int slice_events = 100000;        // Events per frame for slice_mode 1 and 2
+        std::string accumulation_windows_us = "";  // Coarser windows OR-reduced from the native frames, e.g. "10000,100000"
+
+        // Adaptive accumulation time (video::AccumulationController; time-sliced native frames, no windows)
+        bool accumulation_adaptive = false;
+        int accumulation_adaptive_target = 0;          // 0 = events per frame, 1 = fraction of pixels set
+        int accumulation_adaptive_events = 20000;      // Target events per frame
+        float accumulation_adaptive_occupancy = 0.05f; // Target fraction of pixels set per frame
+        int accumulation_adaptive_min_us = 500;        // Window bounds
+        int accumulation_adaptive_max_us = 50000;
+
+        // Multi-camera: each camera runs its own accumulation thread, frame pool and analysis
+        int camera_count = 1;                // Cameras to open (1 to core::AppState::MAX_CAMERAS)
+        std::string camera_serial_cache = "last_cameras.txt";  // Serials tried before discovery ("" = always discover)
+        int latency_budget_ms = 0;           // Largest camera-to-host lag before shedding (0 = off, live only)
+        int latency_shed_mode = 0;           // 0 = drop whole windows, 1 = collapse the backlog into one frame
+        bool qos_enabled = false;            // Shed deferrable work (heatmap, visualizations, charts, thumbnails) under pressure
+        int qos_latency_ms = 100;            // Frame latency at analysis/display that starts shedding
+        int qos_queue_percent = 50;          // Analysis queue fill that starts shedding
+        int qos_decimation = 4;              // While decimating, run 1 in this many deferrable calls
+        int qos_hold_ms = 1000;              // Pressure-free time before shedding eases
+
+        // Region of interest: frames, analysis and display cover only this part of the sensor
+        bool roi_enabled = false;   // Set on the sensor through I_ROI when supported, else cropped in software
+        int roi_x = 0;              // Top-left column
+        int roi_y = 0;              // Top-left row
+        int roi_width = 0;          // 0 = to the right edge
+        int roi_height = 0;         // 0 = to the bottom edge
+
+        // Closed-loop ERC: keep the event rate just below what the pipeline can ingest
+        bool erc_auto = false;              // Adjust the sensor's ERC cap from ring fill and drops
+        int erc_min_kevps = 1000;           // Lowest cap the loop may set
+        int erc_max_kevps = 0;              // Highest cap (0 = sensor maximum)
+        int erc_high_water_percent = 50;    // Ingestion ring peak fill treated as saturation
+        int erc_low_water_percent = 10;     // Peak fill below which the cap may rise
+        int erc_interval_ms = 250;          // Control period
+        int monitoring_interval_ms = 1000;  // Sensor monitoring poll period (0 = off)
+        int reconnect_stall_ms = 3000;      // Event-free time before a camera is reopened (0 = no watchdog)
 
         // Binary image mode settings (reliability testing)
         int binary_bit_1 = 5;       // First bit position (0-7) for binary image extraction
         int binary_bit_2 = 6;       // Second bit position (0-7) for binary image extraction
 
+        // Time-surface view: show per-pixel event recency instead of the binary window (display only)
+        bool time_surface_display = false;
+        int time_surface_decay_us = 20000;  // Time for a pixel to fade to 1/e brightness
+
         // Trail Filter settings
         bool trail_filter_enabled = true;   // Enable trail filter by default
         int trail_filter_type = 2;          // Filter type: 0=TRAIL, 1=STC_CUT_TRAIL, 2=STC_KEEP_TRAIL
         int trail_filter_threshold = 1000;  // Threshold in microseconds
 
+        // Software background-activity filter (video::EventNoiseFilter); also works on replays
+        bool noise_filter_enabled = false;
+        int noise_filter_threshold_us = 2000;  // A neighbour event this recent keeps an event
+
+        // Online hot-pixel detection (video::PixelRateMonitor)
+        bool pixel_rate_monitor_enabled = false;
+        int pixel_rate_half_life_ms = 1000;    // Half-life of each pixel's decaying event count
+        float pixel_rate_sigma = 6.0f;         // Poisson standard deviations above the 8 neighbours that flag a pixel
+        std::string hot_pixel_mask_file = "hot_pixels.rthp";  // Known hot pixels from --dark-calibration (empty = none)
+        bool hot_pixel_suppress = false;           // Drop the known hot pixels' events (video::EventPixelMask)
+        bool hot_pixel_suppress_hardware = true;   // Program the sensor's digital event mask first, where it has one
+
+        // Inter-event interval histograms per pixel class, shown with the biases (video::EventIntervalHistogram)
+        bool event_interval_histogram = false;
+
+        // Row/column readout defects from per-frame projections (video::LineDefectDetector)
+        bool line_defect_enabled = false;
+        float line_defect_sigma = 8.0f;        // Robust standard deviations (1.4826 MAD) above the median line
+        float line_defect_min_fill = 0.25f;    // Fraction of a line that must fire
+        int line_defect_min_frames = 3;        // Frames a line must stand out in before it is reported
+
+        // Stuck / flickering pixel classifier (native accumulation only)
+        bool toggle_analysis_enabled = false;
+        int toggle_window_frames = 100;        // Frames per classification window (2-255)
+        int toggle_stuck_frames = 50;          // Consecutive set frames that make a pixel stuck (1-255)
+        float toggle_flicker_rate = 0.2f;      // Toggles per frame that make a pixel flicker
+
+        // Anti-flicker band from the measured flicker frequency (video::FlickerEstimator)
+        bool antiflicker_auto = false;
+        int antiflicker_auto_margin_hz = 10;   // Band stop is the detected frequency +/- this
+
         // File I/O
         std::string capture_directory = "";  // Directory for saving captured frames (defaults to application directory)
+        int png_profile = 1;                 // PNG speed/size: 0=FAST, 1=BALANCED, 2=SMALL
+        bool png_bilevel = true;             // Write 0/255 images as 1-bit PNGs
+        int capture_dedup_distance = -1;     // Automated captures within this many differing pixels of the last PNG are stored as references (-1 = off, 0 = identical only)
+        bool capture_catalog = true;         // Index capture metadata for search (see CaptureCatalog)
+        int catalog_threads = 0;             // Backfill scan threads (0 = hardware threads)
+        int image_cache_mb = 256;            // Decoded captures kept for Load Image (see ImageCache, 0 = off)
+        int image_prefetch = 2;              // Captures decoded ahead on each side of the loaded one
+        int gallery_threads = 0;             // Capture gallery thumbnail decoders (0 = hardware threads / 2)
+        std::string recording_directory = "";  // Directory for raw event recordings (defaults to capture directory)
+        int recording_preallocate_mb = 0;      // File size reserved when a recording starts (0 = grow on demand)
+        int recording_compress_threads = 2;    // Chunk compressor threads (0 = uncompressed 8-byte words)
+        double burst_pre_s = 1.0;              // Burst capture: frames kept from before the trigger
+        double burst_post_s = 1.0;             // Burst capture: frames captured after the trigger
+        int burst_max_mb = 1024;               // RAM cap for the burst ring (windows shrink to fit)
+        double history_s = 5.0;                // Scrub-back history kept behind the live frame (0 = off)
+        int history_max_mb = 256;              // RAM cap for the compressed history
+        bool trigger_capture = false;          // External trigger windows each become one burst file
+        int trigger_window_us = 0;             // Trigger window length from the rising edge (0 = until falling edge)
+        bool trigger_latency_map = false;      // Rising trigger edges mark a stimulus; map each pixel's response latency
+        int trigger_latency_window_us = 20000; // Time after an onset in which a pixel's first event is its response
+        int trigger_latency_min_cycles = 10;   // Responses a pixel needs to be mapped
+        int memory_budget_mb = 2048;           // Pools, caches and burst rings together (see MemoryBudget, 0 = unlimited)
+        bool merge_streams = false;            // Host-time merge of every camera into synchronized windows (see video::StreamMerger)
+        int merge_window_us = 0;               // Synchronized window length (0 = accumulation_time_us)
+        int merge_buffer_events = 1048576;     // Look-ahead per camera while another lags
+        int merge_max_wait_ms = 20;            // Back-pressure wait of a camera that is ahead before its batch is dropped
     };
 
     // Runtime settings
     struct RuntimeSettings {
         bool debug_mode = false;            // Enable debug output
+        bool triple_buffer_display = true;  // Display via TripleBufferRenderer (false = synchronous TextureManager)
+        bool gpu_pipeline = false;          // Bit extraction, scattering and stats in compute shaders (needs GL 4.3)
+        bool shader_display = false;        // Colour the raw frame in a fragment shader (GL 3.0); no CPU extraction for display
+        bool gpu_event_scatter = false;     // Display frames built from events by a compute shader (needs GL 4.4)
+        int ui_max_fps = 60;                // UI render cap while frames or input arrive (0 = vsync only)
+        int ui_idle_fps = 4;                // UI render rate with no new frame or input, and while minimized
+        bool low_latency_present = false;   // Swap interval 0 with presents paced by the UI scheduler
+        bool late_latch = true;             // Low-latency mode: take a frame that arrived while the UI was built
+
+        // Event file replay (replaces the camera when replay_file is set)
+        std::string replay_file = "";       // Recording to replay (.rtev)
+        double replay_speed = 1.0;          // 1.0 = real time, N = N times faster, 0 = as fast as possible
+        bool replay_loop = false;           // Restart at end of file
+        double replay_start_s = 0.0;        // Start this far into the recording (seeks via the chunk index)
+        int replay_decode_threads = 4;      // Chunks decoded ahead in parallel (0 = on the replay thread)
+
+        // Metrics export for unattended stations (see core::MetricsExporter)
+        int metrics_export = 0;             // 0=off, 1=Prometheus scrape endpoint, 2=StatsD UDP push
+        int metrics_port = 9464;            // Prometheus listen port
+        std::string metrics_statsd_host = "127.0.0.1";
+        int metrics_statsd_port = 8125;
+        int metrics_interval_ms = 1000;     // StatsD push period
+        std::string metrics_prefix = "rtcam";
+
+        // Shared-memory ring for external analysis processes (see video::SharedMemoryPublisher)
+        bool shm_publish = false;               // Native frames only
+        std::string shm_name = "rtcam";         // "Local\<name>" on Windows
+        int shm_frame_slots = 8;
+        bool shm_packed = true;                 // 1 bit per pixel (false = 1 byte per pixel)
+        int shm_event_slots = 0;                // Raw event batch slots (0 = frames only)
+        int shm_event_slot_events = 65536;      // Events per slot; larger batches span several
+
+        // Compressed binary frames for remote viewers over TCP (see video::FrameStreamer)
+        bool stream_enabled = false;
+        int stream_port = 9500;
+        int stream_max_fps = 30;                // Per client and camera (0 = as fast as each link drains)
+        int stream_max_clients = 4;
+        bool stream_preview = false;            // Stream the binned preview instead of full frames (needs preview_binning)
+
+        // Fleet reporting: per-camera station reports to an aggregator over UDP (see core::FleetReporter)
+        bool fleet_report = false;
+        std::string fleet_host = "127.0.0.1";   // Aggregator (IPv4 address)
+        int fleet_port = 9600;                  // Reports go to / the aggregator listens on this UDP port
+        std::string fleet_station;              // Station name ("" = host name)
+
+        // Aggregator mode: ingest station reports instead of running a camera (also --aggregate)
+        bool fleet_aggregate = false;
+        int fleet_shards = 4;                   // Ingestion threads
+        std::string fleet_directory = "fleet";  // Per-sensor CSV histories ("" = none); relative to the recording directory
+        int fleet_stale_s = 10;                 // Silence before a sensor leaves the fleet gauges
+
+        // Analyzer plugins fed every binary frame and event batch (see video::AnalyzerHost)
+        std::string analyzer_plugins;           // ';'-separated shared library paths ("" = none)
+        int analyzer_threads = 0;               // Plugin pool threads (0 = one per plugin)
+        std::string pipeline_stages;            // "name:kind,thread|pool|gpu,depth[,oldest|newest];..." ("" = none)
+        int pipeline_stage_threads = 0;         // Stage pool threads (0 = one per pool stage)
+
+        // Per-machine kernel selection (see video::BackendTuner)
+        bool backend_autotune = true;           // Benchmark the SIMD tiers at startup when not cached
+        std::string backend_cache = "backend_tuning.txt";  // Cached choices ("" = measure every start)
+        std::string backend_overrides;          // "kernel:tier;..." applied last (e.g. "bgr_to_gray:avx2")
+
+        // Startup warm-up before streaming: pools, rings, GL resources, shaders and kernels at sensor size
+        bool warmup = true;
+        std::string shader_cache = "shader_cache";  // Linked program binaries ("" = compile every start)
+
+        // Long-run trend history (see core::TrendStore); relative paths go in the recording directory
+        std::string trend_history_file = "trend_history.bin";  // "" = keep in memory only
+
+        // Columnar per-frame log of every analyzed frame (see core::RunLog), one file per run
+        std::string run_log_directory = "run_logs";  // "" = off; relative paths go in the recording directory
+        bool run_report = true;                 // HTML report beside the run log at the end of a run (see RunReport)
+
+        // Ring of recent stage timings dumped on stalls (see core::FlightRecorder)
+        bool flight_recorder = true;
+        std::string flight_directory = "flight";  // Dumps; relative paths go in the recording directory
+        int flight_window_s = 10;               // Seconds before the trigger in a dump
+        int flight_spike_ms = 150;              // Frame latency that triggers a dump (0 = off)
+        int flight_gap_ms = 1000;               // Frame-free time that triggers a dump (0 = off; off in replay)
+        int flight_cooldown_s = 60;             // Minimum time between dumps
+
+        // Headless operation for rigs without a display (also --headless)
+        bool headless = false;                  // No window: camera-paced loop, metrics via the exporter
+        std::string headless_reference = "";    // Binary PNG to run scattering against ("" = no scattering)
+        int headless_capture_interval_s = 0;    // Save the latest frame every N seconds (0 = off)
+        int headless_duration_s = 0;            // Stop after N seconds (0 = until Ctrl+C or end of replay)
+
+        // Soak run (also --soak): resource growth sampled against a baseline (see core::SoakMonitor)
+        bool soak = false;                      // Replays loop at a fixed rate; growth past a limit fails the run
+        int soak_interval_s = 60;
+        int soak_warmup_s = 300;                // Baseline taken after this
+        double soak_max_rss_growth_mb = 64.0;   // 0 = not checked
+        double soak_max_private_growth_mb = 64.0;
+        int soak_max_handle_growth = 100;
+        int soak_max_gl_growth = 32;
+
+        // Bias sweep (also --bias-sweep; runs headless, then exits). Each bias takes
+        // "start:stop[:step]", "a,b,c" or "" to keep the configured value
+        bool dark_calibration = false;          // Integrate with the lens capped and save the hot pixel mask
+        int dark_calibration_s = 30;            // Integration time (sensor time)
+        float dark_calibration_sigma = 6.0f;    // Standard deviations above the median rate
+        float dark_calibration_min_rate_hz = 1.0f;  // Rate a hot pixel must also exceed
+
+        bool bias_sweep = false;
+        std::string sweep_bias_diff_on = "";
+        std::string sweep_bias_diff_off = "";
+        std::string sweep_bias_hpf = "";
+        std::string sweep_bias_refr = "";
+        int sweep_settle_ms = 500;              // Wait after each change before capturing
+        bool sweep_auto_settle = false;         // Measure the settle time with bias steps first (BiasStepResponse)
+        float sweep_settle_tolerance_percent = 10.0f;  // Settled = event rate within this of its new steady state
+        int sweep_frames = 30;                  // Frames analyzed per point
+        std::string sweep_output = "bias_sweep.csv";  // Relative paths go in the capture directory
+
+        // Genetic optimizer (also --ga; runs headless, then exits). Scores each
+        // candidate by scattering + missing against headless_reference, else by SNR
+        bool ga_optimize = false;
+        bool ga_resume = false;                 // Continue from ga_checkpoint (also --ga-resume)
+        int ga_population = 12;
+        int ga_generations = 10;                // Budget = population * generations evaluations
+        double ga_crossover_rate = 0.7;
+        double ga_mutation_rate = 0.2;          // Per-gene probability
+        int ga_seed = 0;                        // 0 = random
+        bool ga_optimize_biases = true;
+        bool ga_optimize_trail_filter = false;
+        bool ga_optimize_antiflicker = false;
+        int ga_settle_ms = 500;                 // Wait after applying a candidate before capturing
+        int ga_frames = 30;                     // Frames analyzed per candidate
+        std::string ga_output = "ga_results.csv";         // Relative paths go in the capture directory
+        std::string ga_checkpoint = "ga_checkpoint.txt";  // Written after every evaluation
+
+        // Regions with their own scattering statistics, "name:x,y,w,h;name:x,y,w,h" in
+        // frame coordinates (see ScatteringAnalyzer::set_regions)
+        std::string scattering_regions = "";
+        std::string scattering_polarity = "both";  // "on" / "off" analyze one polarity (needs polarity_planes)
+        bool scattering_plane_sweep = false;       // Also score each of the 8 bit planes of live frames
+        bool scattering_tile_map = false;          // Also count scattering per 16x16 tile (headless exports it)
+        bool scattering_clusters = false;          // Also group scattering pixels into 8-connected clusters per frame
+        bool scattering_event_mode = false;        // Headless: test events against the reference as they arrive, not frames
+        std::string scattering_compare_references = "";  // Other baselines scored in the same sweep, "a.png;b.png"
+        int scattering_align_interval_ms = 0;      // Re-estimate the reference offset this often (0 = fixed reference)
+        int scattering_align_max_px = 16;          // Largest reference offset accepted
+        int scattering_reference_frames = 0;       // Without headless_reference: vote a reference from this many live frames (0 = off)
+        float scattering_reference_occupancy = 0.5f;  // Fraction of those frames a pixel must be set in
+        float scattering_ci_target = 0.0f;         // Headless stops once every 95 % interval is within +/- this fraction of its rate (0 = off)
+        int scattering_ci_min_frames = 300;        // Frames analyzed before a rate can count as converged
+        int heatmap_timeline_interval_s = 10;      // Count plane snapshot into the run log directory (0 = off)
+        int scattering_checkpoint_interval_s = 60; // Save the scattering state for resuming after a crash (0 = off)
+        std::string scattering_checkpoint_file = "checkpoints/scattering.rtshard";  // Relative paths go in the recording directory
+        bool scattering_checkpoint_resume = true;  // Continue from a checkpoint left by a crashed run
+        std::string lifetime_stats_directory;      // Per-sensor lifetime pixel statistics files, merged by headless runs (empty = off)
+        int lifetime_checkpoint_s = 600;           // Merge the session into them this often (0 = at the end only)
+    };
+
+    // Thread placement (see core::ThreadPlacements). Core lists give one core per
+    // camera, e.g. "2,4" (empty = not pinned); priorities are idle, low, normal,
+    // high, highest or critical
+    struct ThreadSettings {
+        std::string decode_cores = "";          // SDK decoding (or replay) thread per camera
+        std::string decode_priority = "normal";
+        bool decode_isolate = false;            // Keep every other pipeline thread off the decode cores
+        std::string accumulation_cores = "";    // Frame building thread per camera
+        std::string accumulation_priority = "normal";
+        std::string analysis_cores = "";        // Scattering worker per camera
+        std::string analysis_priority = "normal";
+        std::string io_core = "";               // Image save queue and recorder writer
+        std::string io_priority = "normal";
+        std::string ui_core = "";               // Main thread (render or headless loop)
+        std::string ui_priority = "normal";
+        std::string decode_mmcss = "Pro Audio";       // Windows MMCSS task of the decode threads ("" = none)
+        std::string accumulation_mmcss = "Capture";   // MMCSS task of the frame building threads
+        bool lock_buffers = true;               // Event rings and frame pools in locked memory (see LockedMemory)
+        bool large_pages = true;                // Large pages for locked blocks of 2 MB or more
     };
 
     // Singleton access
@@ -83,10 +362,14 @@ public:
     RuntimeSettings& runtime_settings() { return runtime_settings_; }
     const RuntimeSettings& runtime_settings() const { return runtime_settings_; }
 
+    ThreadSettings& thread_settings() { return thread_settings_; }
+    const ThreadSettings& thread_settings() const { return thread_settings_; }
+
 private:
     AppConfig() = default;
     ~AppConfig() = default;
 
     CameraSettings camera_settings_;
     RuntimeSettings runtime_settings_;
+    ThreadSettings thread_settings_;
 };
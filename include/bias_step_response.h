@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "camera/event_processor.h"
+
+namespace Metavision {
+    class I_LL_Biases;
+}
+
+/**
+ * BiasStepResponse - Measures how long the event rate takes to settle after a bias change
+ *
+ * One measurement watches the per-window statistics of the camera's
+ * EventProcessor for a baseline, applies a single bias step through the
+ * ControlQueue (so the write is ordered with every other register access),
+ * and stamps the write in sensor time through the camera's ClockSync. The
+ * windows after the write are then compared with the new steady state (the
+ * mean rate over the tail of the observation): the settle time runs from
+ * the write to the end of the last window outside the tolerance band.
+ *
+ * The band is the larger of tolerance_percent of the steady rate and three
+ * Poisson standard deviations of the steady count per window, so a quiet
+ * scene does not read as never settling. Idle windows have no statistics
+ * entry and count as zero events.
+ *
+ * The bias sweep uses this to replace a fixed settle time with a measured
+ * one.
+ *
+ * **Usage:**
+ * ```cpp
+ * auto result = BiasStepResponse::measure(0, biases, "bias_diff_on", 40, options, should_stop);
+ * if (result.settled) settle_ms = result.settle_us / 1000;
+ * ```
+ */
+class BiasStepResponse {
+public:
+    struct Options {
+        double tolerance_percent = 10.0;    // Settling band around the new steady rate
+        int baseline_ms = 300;              // Observed before the step
+        int observe_ms = 3000;              // Observed after the step (longest settle that can be measured)
+        int steady_ms = 500;                // Tail of the observation averaged as the new steady state
+    };
+
+    struct Result {
+        bool measured = false;              // Written and observed
+        bool settled = false;               // Back in the band before the steady tail began
+        std::string bias;
+        int from = 0;
+        int to = 0;
+        int64_t write_ts = -1;              // Sensor time the write started (us)
+        int64_t write_us = 0;               // Duration of the register write
+        double rate_before_kevps = 0.0;     // Baseline mean
+        double rate_after_kevps = 0.0;      // New steady state
+        int64_t settle_us = -1;             // Write start to the end of the last window outside the band
+        int windows = 0;                    // Windows after the write (idle ones included)
+    };
+
+    /**
+     * Step one bias and measure the settling of the event rate (blocks for baseline + observation)
+     * @param camera_index Camera whose statistics and clock are used
+     * @param biases Bias facility of that camera
+     * @param name Bias to step (e.g. "bias_diff_on")
+     * @param value Value after the step (the bias is left there)
+     * @param options Timing and tolerance
+     * @param should_stop Polled while waiting; true returns early (measured = false)
+     */
+    static Result measure(int camera_index, Metavision::I_LL_Biases* biases, const std::string& name, int value,
+                          const Options& options, const std::function<bool()>& should_stop);
+
+    /**
+     * Settle time from windows already collected (exposed for offline use)
+     * @param windows Completed windows, oldest first
+     * @param write_ts Sensor time of the write
+     * @param options Tolerance and steady tail
+     * @param result Rates, settle time and window count filled in
+     */
+    static void analyze(const std::vector<EventCamera::EventProcessor::WindowStats>& windows, int64_t write_ts,
+                        const Options& options, Result& result);
+};
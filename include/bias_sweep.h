@@ -0,0 +1,187 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "video/binary_frame.h"
+#include "video/frame_buffer.h"
+#include "video/frame_pool.h"
+
+namespace Metavision {
+    class I_LL_Biases;
+}
+
+/**
+ * BiasSweep - Steps the analog biases through a grid and measures each point
+ *
+ * Each step applies one bias combination, waits the settling time while
+ * discarding frames, then copies N consecutive frames into pooled buffers
+ * and hands the batch to an analysis thread. The next combination is
+ * applied as soon as the batch is handed off, so settling of step k+1
+ * overlaps the analysis of step k. The pool holds two batches (one being
+ * captured, one being analyzed), so capture never waits on a free slot.
+ *
+ * Analysis packs the frames on the shared thread pool and reports active
+ * pixel statistics, the per-frame toggle rate, a stability SNR and, with a
+ * reference image, scattering and missing pixels. Rows are appended to a
+ * CSV in step order.
+ *
+ * measure() is the same pipeline without the grid: the caller configures
+ * each step itself and gets the results back, which lets an optimizer
+ * choose the next point while the previous one is still being analyzed.
+ *
+ * **Usage:**
+ * ```cpp
+ * BiasSweep sweep(frame_buffer);
+ * sweep.run(BiasSweep::make_grid(on, off, hpf, refr), options, ll_biases, should_stop);
+ * ```
+ */
+class BiasSweep {
+public:
+    struct BiasPoint {
+        int diff_on = 0;
+        int diff_off = 0;
+        int hpf = 0;
+        int refr = 0;
+    };
+
+    struct Options {
+        int settle_ms = 500;            // Wait after applying a bias point before capturing
+        int frames = 30;                // Frames captured per point
+        std::string csv_path = "bias_sweep.csv";
+        std::shared_ptr<const video::BinaryFrame> reference;  // Packed reference for scattering (null = none)
+    };
+
+    /**
+     * Measurements of one bias point
+     */
+    struct StepResult {
+        int step = 0;
+        BiasPoint biases;
+        int frames = 0;                 // Frames actually captured
+        double event_rate_kevps = 0.0;  // Delivered during the capture window
+        int64_t dropped_events = 0;     // Lost to a full ingestion ring during capture
+        double active_mean_percent = 0.0;
+        double active_stddev_percent = 0.0;
+        double active_min_percent = 0.0;
+        double active_max_percent = 0.0;
+        double ever_active_percent = 0.0;   // Pixels active in any captured frame
+        double toggle_percent = 0.0;        // Pixels changing between consecutive frames
+        double always_active_percent = 0.0; // Pixels active in every captured frame
+        double snr_db = 0.0;                // Always-active vs. intermittently active pixels
+        double scattering_percent = -1.0;   // Live AND NOT reference (-1 = no reference)
+        double missing_percent = -1.0;      // Reference AND NOT live, of reference pixels
+    };
+
+    enum class StepStatus {
+        Ready,      // Camera configured for the step, measure it
+        Done,       // No more steps
+        Failed      // Configuration failed, abort
+    };
+
+    /** Configures the camera for a step (called on the thread running measure()) */
+    using StepFn = std::function<StepStatus(int step)>;
+    /** Receives each finished step in order (called on the analysis thread) */
+    using ResultFn = std::function<void(const StepResult& result)>;
+
+    /**
+     * Create sweep (does not start anything)
+     * @param source Frame buffer in queue mode that the camera path stores into
+     */
+    explicit BiasSweep(video::FrameBuffer& source);
+    ~BiasSweep();
+
+    // Non-copyable
+    BiasSweep(const BiasSweep&) = delete;
+    BiasSweep& operator=(const BiasSweep&) = delete;
+
+    /**
+     * Parse the values of one bias: "start:stop:step", "a,b,c" or a single value
+     * @param spec Value list ("" = keep current)
+     * @param current Value used when spec is empty
+     * @param values Output
+     * @return true if spec parsed
+     */
+    static bool parse_values(const std::string& spec, int current, std::vector<int>& values);
+
+    /**
+     * Cartesian product of the per-bias value lists (refr varies fastest)
+     */
+    static std::vector<BiasPoint> make_grid(const std::vector<int>& diff_on, const std::vector<int>& diff_off,
+                                            const std::vector<int>& hpf, const std::vector<int>& refr);
+
+    /**
+     * Run the whole sweep on the calling thread (blocks until done or stopped)
+     * @param points Bias combinations in order
+     * @param options Timing, frame count, output and reference
+     * @param biases Camera bias facility
+     * @param should_stop Polled between frames; true aborts after the current step
+     * @return true if every point was measured and the CSV written
+     */
+    bool run(const std::vector<BiasPoint>& points, const Options& options,
+             Metavision::I_LL_Biases* biases, const std::function<bool()>& should_stop);
+
+    /**
+     * Measure steps until next_step returns Done (blocks until done or stopped)
+     *
+     * next_step(i + 1) is called as soon as step i has been captured, so it
+     * runs while step i is analyzed and may only see results up to i - 1.
+     *
+     * @param next_step Configures the camera for each step
+     * @param on_result Receives each analyzed step (StepResult::biases left default)
+     * @param options Timing, frame count and reference (csv_path unused)
+     * @param should_stop Polled between frames; true aborts after the current step
+     * @return true if next_step ended the run with Done
+     */
+    bool measure(const StepFn& next_step, const ResultFn& on_result, const Options& options,
+                 const std::function<bool()>& should_stop);
+
+    const std::vector<StepResult>& get_results() const { return results_; }
+
+    /**
+     * Apply one bias combination
+     * @return true if every bias was accepted
+     */
+    static bool apply(Metavision::I_LL_Biases* biases, const BiasPoint& point);
+
+private:
+    struct Batch {
+        StepResult result;                  // Capture-side fields filled in
+        std::vector<video::FrameRef> frames;
+    };
+
+    bool capture(Batch& batch, const Options& options, const std::function<bool()>& should_stop);
+    void drain();
+    void analysis_loop();
+    void analyze(Batch& batch);
+    void write_row(const StepResult& result);
+
+    video::FrameBuffer& source_;
+    int consumer_id_ = -1;
+    std::unique_ptr<video::FramePool> pool_;  // Two batches of slots, sized per run
+    std::shared_ptr<const video::BinaryFrame> reference_bits_;  // Options::reference of the current run
+    int64_t reference_pixels_ = 0;
+
+    // Analysis thread only
+    std::vector<video::BinaryFrame> packed_;
+    video::BinaryFrame ever_active_;
+    video::BinaryFrame always_active_;
+    ResultFn on_result_;
+    std::ofstream csv_;
+
+    // Single-slot handoff from the capture side to the analysis thread
+    std::thread analysis_thread_;
+    std::mutex handoff_mutex_;
+    std::condition_variable handoff_cv_;
+    bool has_pending_ = false;
+    bool finishing_ = false;
+    Batch pending_;
+    std::vector<StepResult> results_;
+};
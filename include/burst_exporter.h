@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "image_manager.h"
+#include "video/binary_frame.h"
+
+/**
+ * BurstExporter - Converts burst files to PNG + JSON sets across all cores
+ *
+ * Customers who need per-frame images get one PNG per frame with a JSON
+ * sidecar in the ImageManager format (save_metadata_json), written next to
+ * each burst in a folder named after it, with the same frame names as
+ * BurstCapture::export_png. Converting one frame after the other on the
+ * burst writer thread took minutes for a long burst.
+ *
+ * A reader thread walks the bursts in order and reads each frame straight
+ * into one of MAX_IN_FLIGHT_PER_THREAD x threads recycled BinaryFrame
+ * slots; PNG encoding and both writes run on a pool of its own. The reader
+ * waits for a free slot, so memory stays flat however long the bursts are
+ * and the work scales with the encoder threads (reading is a fraction of
+ * the encode cost).
+ *
+ * Camera fields of the metadata (bits, biases, accumulation) are taken
+ * from the configuration when the export starts; sensor timestamp, image
+ * statistics and a comment naming the burst frame are filled per frame.
+ *
+ * **Usage:**
+ * ```cpp
+ * auto& exporter = BurstExporter::instance();
+ * exporter.start({"C:\\bursts\\burst_a.rtbf", "C:\\bursts\\burst_b.rtbf"});   // UI thread
+ * BurstExporter::Progress progress = exporter.get_progress();                  // Every frame
+ * ```
+ */
+class BurstExporter {
+public:
+    static constexpr int MAX_IN_FLIGHT_PER_THREAD = 2;   // Frames read ahead per encoder thread
+
+    struct Progress {
+        bool busy = false;
+        int files_done = 0;
+        int files_total = 0;
+        int64_t frames_done = 0;        // PNG and JSON written
+        int64_t frames_total = 0;
+        int64_t failed = 0;             // Frames whose PNG or JSON could not be written
+        double elapsed_s = 0.0;
+        std::string current;            // Burst being read
+        std::string last_directory;     // Output folder of the last burst finished
+    };
+
+    static BurstExporter& instance();
+
+    // Non-copyable
+    BurstExporter(const BurstExporter&) = delete;
+    BurstExporter& operator=(const BurstExporter&) = delete;
+
+    /**
+     * Start converting bursts in the background (reads the PNG options and metadata from the config)
+     * @param bursts Burst files, converted in order (unreadable ones are skipped)
+     * @param threads Encoder threads (0 = all cores)
+     * @return false if an export is running or no file is a burst
+     */
+    bool start(const std::vector<std::string>& bursts, int threads = 0);
+
+    /**
+     * Stop after the frames already read; their PNGs are still written
+     */
+    void cancel() { cancel_.store(true); }
+
+    /**
+     * Wait for the running export, if any
+     */
+    void wait();
+
+    bool is_busy() const { return busy_.load(); }
+
+    Progress get_progress() const;
+
+    /**
+     * Burst files in a directory, oldest first
+     */
+    static std::vector<std::string> list_bursts(const std::string& directory);
+
+private:
+    struct Burst {
+        std::string path;
+        uint32_t frames = 0;
+    };
+
+    struct Slot {
+        video::BinaryFrame frame;
+        std::string png_path;
+        ImageManager::ImageMetadata metadata;
+    };
+
+    BurstExporter() = default;
+    ~BurstExporter();
+
+    void run(std::vector<Burst> bursts, int threads, ImageManager::PngOptions png,
+             ImageManager::ImageMetadata metadata);
+    void encode(Slot& slot, const ImageManager::PngOptions& png);
+
+    std::thread thread_;
+    std::atomic<bool> busy_{false};
+    std::atomic<bool> cancel_{false};
+
+    // Slots free for the reader (returned by the encoders)
+    std::mutex slot_mutex_;
+    std::condition_variable slot_cv_;
+    std::vector<Slot*> free_slots_;
+
+    mutable std::mutex progress_mutex_;
+    Progress progress_;                       // Guarded by progress_mutex_ (counters below excepted)
+    std::chrono::steady_clock::time_point started_;
+    std::atomic<int64_t> frames_done_{0};
+    std::atomic<int64_t> failed_{0};
+};
@@ -69,6 +69,9 @@ public:
 
     /**
      * @brief Apply all pending bias changes to camera
+     *
+     * Only biases that differ from a sensor's current values are written.
+     * The values are captured now; the writes run on the ControlQueue thread.
      */
     void apply_to_camera();
 
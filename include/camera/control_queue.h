@@ -0,0 +1,104 @@
+#ifndef CONTROL_QUEUE_H
+#define CONTROL_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace EventCamera {
+
+/**
+ * @brief Camera-control thread for hardware register writes
+ *
+ * ERC, anti-flicker, trail filter, ROI and bias changes are register I/O
+ * over USB, taking milliseconds per call. Features and the bias manager
+ * update their own state on the UI thread and post() the hardware writes
+ * here; the worker runs them in order while holding
+ * CameraManager::device_mutex(), so a write never races a watchdog reopen
+ * and never stalls a rendered frame.
+ *
+ * A command posted with the same key as the last queued one replaces it:
+ * dragging a slider queues one write per frame, but only the newest value
+ * reaches the camera once the worker catches up. Commands with different
+ * keys keep their order.
+ *
+ * **Usage:**
+ * ```cpp
+ * ControlQueue::instance().post("erc.rate", [modules, rate] { ... });  // UI thread
+ * ControlQueue::instance().drain();   // Before the facilities go away
+ * ```
+ */
+class ControlQueue {
+public:
+    using Command = std::function<void()>;
+
+    static constexpr size_t MAX_PENDING = 64;   // Oldest command dropped beyond this
+
+    static ControlQueue& instance();
+
+    // Non-copyable
+    ControlQueue(const ControlQueue&) = delete;
+    ControlQueue& operator=(const ControlQueue&) = delete;
+
+    /**
+     * Queue a hardware command
+     * @param key Coalescing key (e.g. "erc.rate"); a queued command with the same key at the tail is replaced
+     * @param command Work to run on the control thread; exceptions are caught and logged
+     * @return false if the queue has been shut down
+     */
+    bool post(const std::string& key, Command command);
+
+    /**
+     * Wait until every command queued so far has run
+     */
+    void drain();
+
+    /**
+     * Run the remaining commands, then stop the worker (further posts fail)
+     */
+    void shutdown();
+
+    /**
+     * True while a command is queued or running (for a "applying..." hint)
+     */
+    bool is_busy() const;
+
+    // Statistics
+    size_t get_pending() const;
+    int64_t get_executed() const { return executed_.load(std::memory_order_relaxed); }
+    int64_t get_coalesced() const { return coalesced_.load(std::memory_order_relaxed); }
+    int64_t get_failed() const { return failed_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        std::string key;
+        Command command;
+    };
+
+    ControlQueue();
+    ~ControlQueue();
+
+    void worker_loop();
+    void run(Entry& entry);
+
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;        // Work queued or stopping
+    std::condition_variable idle_cv_;   // Queue empty and nothing running
+    std::deque<Entry> commands_;
+    size_t in_progress_ = 0;
+    bool stopping_ = false;
+
+    std::atomic<int64_t> executed_{0};
+    std::atomic<int64_t> coalesced_{0};
+    std::atomic<int64_t> failed_{0};
+};
+
+} // namespace EventCamera
+
+#endif // CONTROL_QUEUE_H
@@ -2,30 +2,56 @@
 #define EVENT_PROCESSOR_H
 
 #include <metavision/sdk/base/events/event_cd.h>
+#include "video/simd_utils.h"
+#include <array>
 #include <cstdint>
-
-// Forward declarations
-namespace core {
-    class AppState;
-}
+#include <mutex>
+#include <vector>
 
 namespace EventCamera {
 
 /**
- * @brief Event processing logic
+ * @brief Per-batch event statistics stage of the accumulation thread
+ *
+ * Runs first on every batch the frame builder receives and summarizes it in
+ * one vectorized pass (video::simd::event_stats): ON/OFF counts, time range
+ * and bounding box. Batch totals go to the metrics registry; the batch is
+ * also split at accumulation-window boundaries (aligned like the frame
+ * generators) so each completed window's statistics can be looked up by the
+ * frame stamped with its end, and land in that frame's metadata.
  *
- * Handles processing of camera event batches, including:
- * - Event metrics tracking
- * - Batch age validation
- * - Frame generation coordination
+ * process_events() must be called from a single thread (the accumulation
+ * thread); the getters may be called from any thread.
  */
 class EventProcessor {
 public:
-    EventProcessor(core::AppState& state);
+    static constexpr size_t HISTORY = 16;   // Completed windows kept for lookup by frame timestamp
+
+    /**
+     * @brief Statistics of one completed accumulation window
+     */
+    struct WindowStats {
+        int64_t window_end_ts = 0;      // Sensor time closing the window (us)
+        int64_t window_us = 0;          // Window length (us)
+        uint64_t window_index = 0;      // Windows completed since configure()
+        video::simd::EventStats stats;
+    };
+
+    EventProcessor() = default;
     ~EventProcessor() = default;
 
+    // Non-copyable
+    EventProcessor(const EventProcessor&) = delete;
+    EventProcessor& operator=(const EventProcessor&) = delete;
+
     /**
-     * @brief Process a batch of events
+     * @brief Set the window length and drop the window in progress (accumulation thread, or before it runs)
+     * @param accumulation_time_us Window length in microseconds
+     */
+    void configure(uint32_t accumulation_time_us);
+
+    /**
+     * @brief Summarize a batch of events
      * @param begin Iterator to first event
      * @param end Iterator past last event
      */
@@ -33,22 +59,51 @@ public:
                        const Metavision::EventCD* end);
 
     /**
-     * @brief Check if event batch is too old
-     * @param event_ts Event timestamp in microseconds
-     * @return true if batch should be skipped
+     * @brief Statistics of the last batch (accumulation thread only)
      */
-    bool is_batch_too_old(int64_t event_ts) const;
+    const video::simd::EventStats& last_batch() const { return batch_; }
 
     /**
-     * @brief Update event metrics from batch
-     * @param begin Iterator to first event
-     * @param end Iterator past last event
+     * @brief Find the completed window that ends at a frame's timestamp
+     * @param window_end_ts Frame timestamp (end of its accumulation window)
+     * @param out Output
+     * @return false if that window is not (or no longer) in the history
+     */
+    bool get_window(int64_t window_end_ts, WindowStats& out) const;
+
+    /**
+     * @brief Copy the most recent completed window
+     * @return false if no window has completed yet
      */
-    void update_event_metrics(const Metavision::EventCD* begin,
-                             const Metavision::EventCD* end);
+    bool get_last_window(WindowStats& out) const;
+
+    /**
+     * @brief Append the completed windows newer than a window index, oldest first
+     *
+     * Polling faster than HISTORY windows sees every window; idle gaps have
+     * no entry (their windows held no events).
+     * @param after_index window_index of the last window already seen (0 = all in the history)
+     * @param out Appended to
+     * @return Index of the newest window appended, or after_index if none
+     */
+    uint64_t get_windows_since(uint64_t after_index, std::vector<WindowStats>& out) const;
 
 private:
-    core::AppState& state_;
+    /**
+     * @brief Publish the window in progress and start the next one
+     */
+    void publish(int64_t window_end_ts);
+
+    // Accumulation thread
+    int64_t accumulation_time_us_ = 1;
+    int64_t window_end_ts_ = -1;        // -1 = not aligned yet
+    video::simd::EventStats window_;
+    video::simd::EventStats batch_;
+
+    // Completed windows, oldest overwritten first
+    mutable std::mutex mutex_;
+    std::array<WindowStats, HISTORY> history_{};
+    uint64_t windows_ = 0;
 };
 
 } // namespace EventCamera
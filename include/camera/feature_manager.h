@@ -14,9 +14,16 @@ namespace EventCamera {
  *
  * The FeatureManager handles registration, initialization, and lifecycle
  * management of all camera hardware features.
+ *
+ * The feature list is published as an immutable snapshot: render_all_ui()
+ * loads it without taking the mutex, so a registration or shutdown on
+ * another thread never blocks the UI. Hardware writes themselves run on the
+ * ControlQueue thread.
  */
 class FeatureManager {
 public:
+    using FeatureList = std::vector<std::shared_ptr<IHardwareFeature>>;
+
     FeatureManager() = default;
     ~FeatureManager() = default;
 
@@ -44,6 +51,8 @@ public:
 
     /**
      * @brief Shutdown all features
+     *
+     * Waits for queued hardware commands first: they hold facility pointers.
      */
     void shutdown_all();
 
@@ -84,14 +93,15 @@ public:
 
     /**
      * @brief Get all registered features
-     * @return Vector of all registered features
+     * @return Snapshot of the registered features (never null)
      */
-    const std::vector<std::shared_ptr<IHardwareFeature>>& get_all_features() const {
-        return features_;
+    std::shared_ptr<const FeatureList> get_all_features() const {
+        return std::atomic_load(&features_);
     }
 
 private:
-    std::vector<std::shared_ptr<IHardwareFeature>> features_;
+    // Writers copy, modify and publish under mutex_; readers only load
+    std::shared_ptr<const FeatureList> features_ = std::make_shared<const FeatureList>();
     std::mutex mutex_;
 };
 
@@ -10,6 +10,8 @@ namespace EventCamera {
  * @brief Anti-Flicker filter feature
  *
  * Filters out flicker from artificial lighting (50/60Hz)
+ * Hardware writes are posted to the ControlQueue; the supported frequency
+ * range is read once at initialize() for the UI.
  */
 class AntiFlickerFeature : public IHardwareFeature {
 public:
@@ -57,6 +59,10 @@ private:
     int low_freq_ = 100;
     int high_freq_ = 150;
     int duty_cycle_ = 50;
+
+    // Read from the primary camera at initialize()
+    int min_supported_freq_ = 0;
+    int max_supported_freq_ = 0;
 };
 
 } // namespace EventCamera
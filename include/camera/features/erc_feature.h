@@ -10,6 +10,8 @@ namespace EventCamera {
  * @brief Event Rate Controller (ERC) feature
  *
  * Limits the maximum event rate to prevent bandwidth saturation.
+ * Hardware writes are posted to the ControlQueue; the supported range and
+ * count period are read once at initialize() for the UI.
  */
 class ERCFeature : public IHardwareFeature {
 public:
@@ -48,6 +50,11 @@ private:
     std::vector<Metavision::I_ErcModule*> all_erc_;  // All cameras to control
     bool enabled_ = false;
     int target_rate_kevps_ = 1000;  // kilo-events per second
+
+    // Read from the primary camera at initialize()
+    int min_rate_kevps_ = 0;
+    int max_rate_kevps_ = 0;
+    uint32_t count_period_us_ = 0;  // 0 = unknown
 };
 
 } // namespace EventCamera
@@ -3,6 +3,10 @@
 
 #include "camera/hardware_feature.h"
 #include <metavision/hal/facilities/i_monitoring.h>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace EventCamera {
 
@@ -10,6 +14,8 @@ namespace EventCamera {
  * @brief Hardware monitoring feature (temperature, illumination, pixel dead time)
  *
  * Provides read-only access to camera sensor monitoring information.
+ * The sensors are polled on the ControlQueue thread about once a second
+ * while the panel is open; render_ui() shows the last readings.
  */
 class MonitoringFeature : public IHardwareFeature {
 public:
@@ -34,11 +40,38 @@ public:
     bool render_ui() override;
 
 private:
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{1000};
+
+    /**
+     * @brief Last values read from one camera
+     */
+    struct Reading {
+        bool temperature_ok = false;
+        int temperature = 0;        // °C
+        bool illumination_ok = false;
+        int illumination = 0;       // lux
+        bool dead_time_ok = false;
+        int dead_time = 0;          // μs
+    };
+
+    /**
+     * @brief Readings shared with the queued poll (outlives the feature if needed)
+     */
+    struct Readings {
+        std::mutex mutex;           // Held only to copy values in or out
+        std::vector<Reading> values;
+    };
+
     /**
      * @brief Check which monitoring capabilities are supported
      */
     void detect_capabilities();
 
+    /**
+     * @brief Queue a read of all cameras if the last one is older than POLL_INTERVAL
+     */
+    void request_poll();
+
     Metavision::I_Monitoring* monitoring_ = nullptr;  // Primary camera
     std::vector<Metavision::I_Monitoring*> all_monitoring_;  // All cameras
 
@@ -46,6 +79,9 @@ private:
     bool has_temperature_ = false;
     bool has_illumination_ = false;
     bool has_dead_time_ = false;
+
+    std::shared_ptr<Readings> readings_ = std::make_shared<Readings>();
+    std::chrono::steady_clock::time_point last_poll_{};
 };
 
 } // namespace EventCamera
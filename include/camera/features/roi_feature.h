@@ -18,6 +18,7 @@ namespace EventCamera {
  *
  * Defines a rectangular region to process or ignore events.
  * Coordinates with the ROIFilter for visualization.
+ * Hardware writes are posted to the ControlQueue.
  */
 class ROIFeature : public IHardwareFeature {
 public:
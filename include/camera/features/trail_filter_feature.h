@@ -11,6 +11,8 @@ namespace EventCamera {
  * @brief Event Trail Filter feature
  *
  * Filters noise from event bursts and rapid flickering
+ * Hardware writes are posted to the ControlQueue; the supported threshold
+ * range is read once at initialize() for the UI.
  */
 class TrailFilterFeature : public IHardwareFeature {
 public:
@@ -55,6 +57,10 @@ private:
     bool enabled_ = false;
     int filter_type_ = 0;  // 0=TRAIL, 1=STC_CUT_TRAIL, 2=STC_KEEP_TRAIL
     int threshold_us_ = 10000;
+
+    // Read from the primary camera at initialize()
+    uint32_t min_threshold_us_ = 0;
+    uint32_t max_threshold_us_ = 0;
 };
 
 } // namespace EventCamera
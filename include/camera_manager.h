@@ -2,22 +2,76 @@
 
 #include <metavision/sdk/driver/camera.h>
 #include <metavision/sdk/core/algorithms/periodic_frame_generation_algorithm.h>
+#include "core/clock_sync.h"
+#include "core/erc_controller.h"
+#include "camera/event_processor.h"
+#include "video/binary_frame_accumulator.h"
+#include "video/event_activity.h"
+#include "video/event_noise_filter.h"
+#include "video/event_recorder.h"
+#include "video/shm_publisher.h"
+#include "video/analyzer_host.h"
+#include "video/stream_merger.h"
+#include "video/event_replay.h"
+#include "video/event_scatter_queue.h"
+#include "video/scattering_event_tap.h"
+#include "video/event_ring.h"
+#include "video/flicker_estimator.h"
+#include "video/accumulation_controller.h"
+#include "video/pixel_rate_monitor.h"
+#include "video/event_interval_histogram.h"
+#include "video/dark_frame_calibrator.h"
+#include "video/event_pixel_mask.h"
+#include "video/line_defect_detector.h"
+#include "video/pixel_toggle_analyzer.h"
+#include "video/raw_event_decoder.h"
+#include "video/time_surface.h"
+#include "video/trigger_gate.h"
+#include "video/trigger_latency_map.h"
+#include "video/window_pyramid.h"
+#include <array>
 #include <opencv2/core.hpp>
 #include <string>
 #include <vector>
+#include <map>
 #include <memory>
 #include <functional>
 #include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+namespace Metavision {
+    class I_LL_Biases;
+    class I_DigitalEventMask;
+}
 
 /**
  * CameraManager handles enumeration, selection, and initialization of SilkyEvCam event cameras.
- * Simplified for single camera operation (Reliability Testing Application).
+ *
+ * Each opened camera gets its own pipeline: the SDK decoding thread hands
+ * batches to a private event ring, drained by a dedicated accumulation
+ * thread (optionally pinned to a CPU core) into that camera's frame
+ * builder, noise filter, activity profile and time surface. Cameras never
+ * share a generator or a thread, so several sensors can be tested in
+ * parallel on one host. The frame callback receives the camera index.
+ * Replay, recording and ERC control act on camera 0.
  *
  * Hardware: CenturyArks SilkyEvCam HD
  * SDK: Metavision (via CenturyArks silky_common_plugin)
  */
 class CameraManager {
 public:
+    /**
+     * What the accumulation thread does when a camera lags past the latency budget
+     */
+    enum class LatencyShedMode {
+        DropWindows = 0,    // Skip whole accumulation windows until the lag is under half the budget
+        CatchUpFrame = 1    // Collapse the queued backlog into one frame (native accumulation only)
+    };
+
     // Singleton instance
     static CameraManager& instance() {
         static CameraManager instance;
@@ -31,6 +85,12 @@ public:
     // Frame callback type: receives generated frame and camera index
     using FrameCallback = std::function<void(const cv::Mat&, int)>;
 
+    // Configure callback: receives the camera index while the camera is opened but not streaming
+    using ConfigureCallback = std::function<void(int)>;
+
+    // Coarse window callback: receives packed frame, end of its window and camera index
+    using WindowCallback = std::function<void(const video::BinaryFrame&, Metavision::timestamp, int)>;
+
     struct CameraInfo {
         std::string serial;
         uint16_t width;
@@ -67,22 +127,114 @@ public:
     const std::vector<CameraInfo>& get_cameras() const { return cameras_; }
 
     /**
-     * Initialize single camera (simplified for reliability testing)
+     * Initialize single camera (first available, see initialize_cameras())
      * @param accumulation_time_us Frame accumulation period in microseconds
+     * @param native_binary Accumulate events straight into a CV_8UC1 binary frame
+     *                      instead of a BGR frame from PeriodicFrameGenerationAlgorithm
+     * @param binary_bit_1 First bit position used by the native accumulator
+     * @param binary_bit_2 Second bit position used by the native accumulator
+     * @param roi Sensor window to stream (empty = full sensor, 0 width/height = to the edge). Set on the camera
+     *            through I_ROI when supported, otherwise cropped in software; either
+     *            way frames are roi.size() and event coordinates are offset by roi.tl()
      * @return true if successful
      */
-    bool initialize_single_camera(int accumulation_time_us);
+    bool initialize_single_camera(int accumulation_time_us, bool native_binary = false,
+                                  int binary_bit_1 = 5, int binary_bit_2 = 6, const cv::Rect& roi = cv::Rect());
+
+    /**
+     * Initialize up to max_cameras available cameras, each with its own pipeline
+     *
+     * Every camera is opened with the same frame settings and ROI (see
+     * initialize_single_camera()). Cameras that fail to open are skipped.
+     * Preferred serials (e.g. the previous session's cameras) are opened
+     * directly; device discovery only runs if they do not cover max_cameras.
+     *
+     * @param max_cameras Number of cameras wanted (>= 1)
+     * @param accumulation_time_us Frame accumulation period in microseconds
+     * @param native_binary See initialize_single_camera()
+     * @param binary_bit_1 First bit position used by the native accumulator
+     * @param binary_bit_2 Second bit position used by the native accumulator
+     * @param roi See initialize_single_camera()
+     * @param preferred_serials Serials to try first, in camera order (missing ones are skipped)
+     * @return Number of cameras initialized (0 = none)
+     */
+    int initialize_cameras(int max_cameras, int accumulation_time_us, bool native_binary = false,
+                           int binary_bit_1 = 5, int binary_bit_2 = 6, const cv::Rect& roi = cv::Rect(),
+                           const std::vector<std::string>& preferred_serials = {});
 
     /**
-     * Start the single camera with frame generation
-     * @param callback Frame callback function
+     * Get number of frame pipelines (initialized cameras, or 1 for replay)
+     */
+    int num_pipelines() const { return static_cast<int>(pipelines_.size()); }
+
+    /**
+     * Initialize a recorded event file as the event source instead of a camera
+     * @param path Recording written by the event recorder
+     * @param accumulation_time_us Frame accumulation period in microseconds
+     * @param native_binary See initialize_single_camera()
+     * @param binary_bit_1 First bit position used by the native accumulator
+     * @param binary_bit_2 Second bit position used by the native accumulator
+     * @param roi Sensor window to build frames from (empty = full sensor, cropped in software)
+     * @return true if the file was opened
+     */
+    bool initialize_replay(const std::string& path, int accumulation_time_us, bool native_binary = false,
+                           int binary_bit_1 = 5, int binary_bit_2 = 6, const cv::Rect& roi = cv::Rect());
+
+    /**
+     * Start every initialized camera (or the replay source) with frame generation
+     * @param callback Frame callback function, called on each camera's accumulation thread
+     * @param replay_speed Replay pacing (1.0 = real time, 0 = as fast as possible; camera ignores it)
+     * @param configure Called for each camera just before it starts streaming, so biases and
+     *                  filters are in place for the first event (not called for replay)
      * @return true if successful
      */
-    bool start_single_camera(FrameCallback callback);
+    bool start_single_camera(FrameCallback callback, double replay_speed = 1.0,
+                             const ConfigureCallback& configure = nullptr);
+
+    /**
+     * Write only the biases whose value differs from the sensor's
+     *
+     * Reads the whole bias bank once, then sets each differing bias; an
+     * unchanged configuration costs no write at all, and a single changed
+     * bias costs one.
+     *
+     * @param biases Bias facility of the camera
+     * @param values Bias name -> value
+     * @return Number of biases written, or -1 if the facility is missing or refused a value
+     */
+    static int write_biases(Metavision::I_LL_Biases* biases, const std::map<std::string, int>& values);
+
+    /**
+     * Program the sensor's digital event mask with hot pixels
+     *
+     * The facility has a small fixed number of mask slots. Pixels are
+     * assigned to slots in raster order and the unused slots are disabled,
+     * so an empty mask clears the hardware mask. Pixels beyond the last
+     * slot are left in remaining for the software mask.
+     *
+     * @param masks Digital event mask facility of the camera
+     * @param mask Set = hot pixel (frame coordinates)
+     * @param origin Sensor position of the frame's top-left pixel
+     * @param remaining Output: pixels of mask not programmed
+     * @return Number of pixels programmed, or -1 if the facility is missing or refused a slot
+     */
+    static int write_pixel_masks(Metavision::I_DigitalEventMask* masks, const video::BinaryFrame& mask,
+                                 cv::Point origin, video::BinaryFrame& remaining);
+
+    /**
+     * Check if events come from a replayed file instead of a camera
+     */
+    bool is_replay() const { return replay_ != nullptr; }
+
+    /**
+     * Get replay source (nullptr when running a camera)
+     */
+    video::EventReplay* replay() { return replay_.get(); }
+    const video::EventReplay* replay() const { return replay_.get(); }
 
     /**
      * Check if camera is connected
-     * @param index Camera index (0 for single camera)
+     * @param index Camera index
      * @return true if connected
      */
     bool is_camera_connected(int index = 0) const;
@@ -99,25 +251,898 @@ public:
 
     /**
      * Get current event count (for focus adjust monitoring)
+     * @param index Camera index
+     */
+    uint64_t get_event_count(int index = 0) const { return pipeline(index).event_count; }
+
+    /**
+     * Get number of event batches dropped because the accumulation thread fell behind
+     * @param index Camera index
+     */
+    int64_t get_dropped_event_batches(int index = 0) const { return pipeline(index).event_ring.get_dropped_batches(); }
+
+    /**
+     * Get number of events dropped because the accumulation thread fell behind
+     * @param index Camera index
+     */
+    int64_t get_dropped_events(int index = 0) const { return pipeline(index).event_ring.get_dropped_events(); }
+
+    /**
+     * Bound camera-to-host lag at ingestion (live cameras only; replay never sheds)
+     *
+     * Lag is host time minus the host time of a batch's last event, mapped
+     * through the camera's clock_sync(). Over budget, the accumulation thread
+     * sheds the backlog as configured; every window it skips or collapses is
+     * counted.
+     *
+     * @param budget_ms Largest acceptable lag (0 = off)
+     * @param mode How to shed (CatchUpFrame falls back to DropWindows with the SDK frame generator)
+     */
+    void set_latency_budget(int budget_ms, LatencyShedMode mode);
+    int get_latency_budget_ms() const { return static_cast<int>(latency_budget_us_.load() / 1000); }
+
+    /**
+     * Get the camera-to-host lag of the last batch accumulated (0 until the budget is set)
+     * @param index Camera index
+     */
+    int64_t get_latency_lag_us(int index = 0) const { return pipeline(index).lag_us.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of accumulation windows dropped or collapsed to stay within the latency budget
+     * @param index Camera index
+     */
+    int64_t get_shed_windows(int index = 0) const { return pipeline(index).shed_windows.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the camera's sensor-to-host clock mapping, fed by its decoding thread
+     * (live cameras only; never valid for replay)
+     * @param index Camera index
+     */
+    const core::ClockSync& clock_sync(int index = 0) const { return pipeline(index).clock_sync; }
+
+    /**
+     * Start adjusting the sensor's ERC cap from ingestion ring fill and drops
+     *
+     * Runs core::ErcController on its own thread, so the HAL calls never
+     * stall decoding or accumulation. Call after start_single_camera().
+     *
+     * @param settings Loop bounds and thresholds (max_rate_kevps <= 0 = sensor maximum)
+     * @param interval_ms Control period in milliseconds
+     * @return true if the loop runs (false for replay or sensors without ERC)
+     */
+    bool start_erc_control(const core::ErcController::Settings& settings, int interval_ms);
+
+    /**
+     * Stop the ERC control loop (the last cap stays applied)
+     */
+    void stop_erc_control();
+
+    bool is_erc_control_running() const { return erc_running_.load(); }
+
+    /**
+     * Get ERC cap last applied by the control loop in kev/s (0 = not running yet)
+     */
+    int get_erc_rate_kevps() const { return erc_rate_kevps_.load(std::memory_order_relaxed); }
+
+    /**
+     * Sensor monitoring values cached by the monitoring thread
+     */
+    struct MonitoringReading {
+        float temperature_c = std::numeric_limits<float>::quiet_NaN();  // NaN = not available
+        int dead_time_us = -1;      // Pixel dead time (-1 = not available)
+        int64_t sampled_us = 0;     // Host time of the sample (0 = never sampled)
+    };
+
+    /**
+     * Start polling each camera's I_Monitoring facility on its own thread
+     *
+     * Every facility read is a USB register round trip, so the UI and the
+     * pipeline threads only read the cached values (get_monitoring). Camera
+     * 0's readings also go to the camera.temperature_c and
+     * camera.dead_time_us gauges, which the trend store and exporters
+     * sample. Call after start_single_camera().
+     *
+     * @param interval_ms Sample period in milliseconds
+     * @return true if the poller runs (false for replay or without cameras)
+     */
+    bool start_monitoring(int interval_ms);
+
+    /**
+     * Stop the monitoring poller (cached readings are kept)
+     */
+    void stop_monitoring();
+
+    bool is_monitoring_running() const { return monitoring_running_.load(); }
+
+    /**
+     * Get the latest cached monitoring values (never touches the camera)
+     * @param index Camera index
+     */
+    MonitoringReading get_monitoring(int index = 0) const;
+
+    /**
+     * Start watching every live camera for a stalled event stream
+     *
+     * A camera that delivers no events for stall_ms is treated as unplugged:
+     * is_camera_connected() turns false, then the device is closed and
+     * reopened by serial (retried every stall_ms) with its ROI, the configure
+     * callback (biases, filters) and the current ERC cap. Pipelines, frame
+     * pools, textures and analysis state stay allocated throughout, so a
+     * long test resumes where it stopped. Call after start_single_camera().
+     *
+     * @param stall_ms Event-free time that counts as a stall
+     * @param configure Re-applies settings to the reopened camera (before it streams)
+     * @return true if the watchdog runs (false for replay or without cameras)
+     */
+    bool start_watchdog(int stall_ms, const ConfigureCallback& configure);
+
+    /**
+     * Stop the stall watchdog
+     */
+    void stop_watchdog();
+
+    /**
+     * True while a stalled camera is waiting to be reopened
+     * @param index Camera index
+     */
+    bool is_reconnecting(int index = 0) const;
+
+    /**
+     * Lock held while the watchdog swaps a camera's device
+     *
+     * Hold it while using a camera's facilities from outside the camera
+     * manager, after checking is_camera_connected().
+     */
+    std::mutex& device_mutex() { return device_mutex_; }
+
+    /**
+     * Get per-row/per-column activity of the last accumulation window
+     * @param index Camera index
+     */
+    video::EventActivityProfile& activity(int index = 0) { return pipeline(index).activity; }
+    const video::EventActivityProfile& activity(int index = 0) const { return pipeline(index).activity; }
+
+    /**
+     * Get ON/OFF counts, time range and bounding box of recent accumulation windows
+     * @param index Camera index
+     */
+    const EventCamera::EventProcessor& event_stats(int index = 0) const { return pipeline(index).event_stats; }
+
+    /**
+     * Get the software background-activity filter applied before frame building
+     * @param index Camera index
+     */
+    video::EventNoiseFilter& noise_filter(int index = 0) { return pipeline(index).noise_filter; }
+    const video::EventNoiseFilter& noise_filter(int index = 0) const { return pipeline(index).noise_filter; }
+
+    /**
+     * Get the per-pixel last-event plane behind the time-surface view (updates off by default)
+     * @param index Camera index
+     */
+    video::TimeSurface& time_surface(int index = 0) { return pipeline(index).time_surface; }
+    const video::TimeSurface& time_surface(int index = 0) const { return pipeline(index).time_surface; }
+
+    /**
+     * Get the per-pixel rate estimator that flags emerging hot pixels (off by default)
+     * @param index Camera index
+     */
+    video::PixelRateMonitor& pixel_rates(int index = 0) { return pipeline(index).pixel_rates; }
+    const video::PixelRateMonitor& pixel_rates(int index = 0) const { return pipeline(index).pixel_rates; }
+
+    /**
+     * Get the per-class inter-event interval histograms (off by default)
+     * @param index Camera index
+     */
+    video::EventIntervalHistogram& event_intervals(int index = 0) { return pipeline(index).intervals; }
+    const video::EventIntervalHistogram& event_intervals(int index = 0) const { return pipeline(index).intervals; }
+
+    /**
+     * Get the dark-frame hot pixel calibration (idle until started)
+     * @param index Camera index
+     */
+    video::DarkFrameCalibrator& dark_frames(int index = 0) { return pipeline(index).dark_frames; }
+
+    /**
+     * Get the ingestion mask that drops known hot pixel events (off by default)
+     * @param index Camera index
+     */
+    video::EventPixelMask& pixel_mask(int index = 0) { return pipeline(index).pixel_mask; }
+    const video::EventPixelMask& pixel_mask(int index = 0) const { return pipeline(index).pixel_mask; }
+
+    /**
+     * Get the row/column defect detector fed from native frames (off by default)
+     * @param index Camera index
+     */
+    video::LineDefectDetector& line_defects(int index = 0) { return pipeline(index).line_defects; }
+    const video::LineDefectDetector& line_defects(int index = 0) const { return pipeline(index).line_defects; }
+
+    /**
+     * Get the stuck / flickering pixel classifier fed from native frames (off by default)
+     * @param index Camera index
+     */
+    video::PixelToggleAnalyzer& pixel_toggles(int index = 0) { return pipeline(index).toggles; }
+    const video::PixelToggleAnalyzer& pixel_toggles(int index = 0) const { return pipeline(index).toggles; }
+
+    /**
+     * Get the capture windows opened by the camera's trigger input (off by default)
+     *
+     * Step it from the frame callback to learn which frames fall inside a window.
+     * @param index Camera index
+     */
+    video::TriggerGate& trigger_gate(int index = 0) { return pipeline(index).trigger_gate; }
+    const video::TriggerGate& trigger_gate(int index = 0) const { return pipeline(index).trigger_gate; }
+
+    /**
+     * Consume external trigger events alongside CD events, on every camera
+     *
+     * Enables the main channel of the sensor's trigger-in facility when the
+     * cameras start and feeds its events to each pipeline's TriggerGate on
+     * the decoding thread (call before start_single_camera(); replay has no
+     * trigger events).
+     * @param enabled Open capture windows from trigger edges
+     * @param window_us Window length from the rising edge (0 = until the falling edge)
+     */
+    void set_trigger_capture(bool enabled, int64_t window_us);
+
+    /**
+     * Get the per-pixel latency map to trigger onsets (off by default)
+     * @param index Camera index
+     */
+    video::TriggerLatencyMap& trigger_latency(int index = 0) { return pipeline(index).latency_map; }
+    const video::TriggerLatencyMap& trigger_latency(int index = 0) const { return pipeline(index).latency_map; }
+
+    /**
+     * Map each pixel's response latency to trigger onsets, on every camera
+     *
+     * Enables the trigger input like set_trigger_capture() (the two can run
+     * together; call before start_single_camera()).
+     * @param enabled Treat rising trigger edges as stimulus onsets
+     * @param window_us Time after an onset in which a pixel's first event is its response
+     */
+    void set_trigger_latency(bool enabled, int64_t window_us);
+
+    /**
+     * Get the event-rate spectrum used to find the flicker frequency (off by default)
+     * @param index Camera index
+     */
+    video::FlickerEstimator& flicker(int index = 0) { return pipeline(index).flicker; }
+
+    /**
+     * Get the controller that retunes the accumulation window from frame contents (off by default)
+     *
+     * Only acts on time-sliced native accumulation without accumulation windows.
+     * @param index Camera index
+     */
+    video::AccumulationController& accumulation_control(int index = 0) { return pipeline(index).accumulation_control; }
+
+    /**
+     * Start streaming raw CD events of the running camera to a file
+     * @param path Output file (event_file format)
+     * @param preallocate_bytes File size to reserve up front (0 = none)
+     * @param compress_threads Chunk compressor threads (0 = uncompressed)
+     * @return true if recording started
+     */
+    bool start_recording(const std::string& path, uint64_t preallocate_bytes = 0, int compress_threads = 0);
+
+    /**
+     * Stop recording and close the file (no-op if not recording)
+     */
+    void stop_recording() { recorder_.stop(); }
+
+    /**
+     * Get event recorder (state and statistics)
+     */
+    const video::EventRecorder& recorder() const { return recorder_; }
+
+    /**
+     * Publish native frames (and optionally event batches) to a shared-memory ring
+     * for external analysis processes (before the accumulation threads start)
+     *
+     * Frame size is taken from the initialized pipelines.
+     * @param options Ring name and slot counts (width and height are filled in)
+     * @return true if publishing
+     */
+    bool start_publishing(video::SharedMemoryPublisher::Options options);
+
+    /**
+     * Close the shared-memory ring (accumulation threads must be stopped)
+     */
+    void stop_publishing() { publisher_.stop(); }
+
+    /**
+     * Get shared-memory publisher (state and counts)
+     */
+    const video::SharedMemoryPublisher& publisher() const { return publisher_; }
+
+    /**
+     * Get analyzer plugin host (load and start plugins before the camera streams;
+     * event batches are fed from the accumulation threads, frames by the frame callback)
+     */
+    video::AnalyzerHost& analyzers() { return analyzers_; }
+
+    /**
+     * Merge the event streams of every camera in host time and emit synchronized windows
+     * (before the accumulation threads start; needs two or more cameras, not with raw decode)
+     * @param options Window length and look-ahead bounds
+     * @param on_window Called on the merge thread for every closed window
+     * @return true if merging
+     */
+    bool start_merging(const video::StreamMerger::Options& options, video::StreamMerger::WindowCallback on_window);
+
+    /**
+     * Stop the merge thread (accumulation threads must be stopped)
+     */
+    void stop_merging() { merger_.stop(); }
+
+    /**
+     * Write every camera's event ring once, so the first batches take no page faults
+     * (before the camera streams start)
+     */
+    void prefault_event_rings();
+
+    /**
+     * Get stream merger (state and statistics)
+     */
+    const video::StreamMerger& merger() const { return merger_; }
+
+    /**
+     * Get sensor timestamp of the frame being delivered
+     * (valid inside the frame callback, which runs on that camera's accumulation thread)
+     * @param index Camera index
+     */
+    int64_t get_last_frame_timestamp(int index = 0) const {
+        return pipeline(index).last_frame_timestamp.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the time span the frame being delivered actually covers (us; valid inside the frame callback)
+     * @param index Camera index
+     */
+    uint32_t get_last_frame_window_us(int index = 0) const {
+        return pipeline(index).last_frame_window_us.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the number of events in the frame being delivered (-1 = not counted; valid inside the frame callback)
+     * @param index Camera index
+     */
+    int64_t get_last_frame_events(int index = 0) const {
+        return pipeline(index).last_frame_events.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the number of ON events in the frame being delivered (-1 = not counted; valid inside the frame callback)
+     * @param index Camera index
+     */
+    int64_t get_last_frame_on_events(int index = 0) const {
+        return pipeline(index).last_frame_on_events.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Get size of the frames the callback receives (empty until initialized)
+     * @param index Camera index
+     */
+    cv::Size get_frame_size(int index = 0) const { return pipeline(index).frame_size; }
+
+    /**
+     * Get sensor coordinates of frame pixel (0, 0) (non-zero with an ROI)
+     * @param index Camera index
+     */
+    cv::Point get_frame_origin(int index = 0) const { return pipeline(index).frame_origin; }
+
+    /**
+     * Check if an ROI restricts frames to part of the sensor
+     * @param index Camera index
+     */
+    bool has_roi(int index = 0) const { return pipeline(index).crop_to_window; }
+
+    /**
+     * Check if the ROI is applied by the sensor (false = cropped in software)
+     * @param index Camera index
+     */
+    bool is_hardware_roi(int index = 0) const { return pipeline(index).hardware_roi; }
+
+    /**
+     * Check if frames are produced by the native binary accumulator
+     * (callback receives CV_8UC1 0/255 frames instead of BGR frames; same for every camera)
+     */
+    bool is_native_binary() const { return pipeline(0).binary_accumulator != nullptr; }
+
+    /**
+     * Record ON/OFF polarity in the low bits of native binary frames, on every camera
+     * (see BinaryFrameAccumulator::set_polarity_planes; call before start_single_camera())
+     * @return false if frames do not come from the native accumulator
+     */
+    bool set_polarity_planes(bool enabled);
+
+    /**
+     * Check if frames carry BinaryFrameAccumulator::ON_BIT / OFF_BIT per pixel
+     */
+    bool has_polarity_planes() const {
+        const auto& accumulator = pipeline(0).binary_accumulator;
+        return accumulator && accumulator->has_polarity_planes();
+    }
+
+    /**
+     * Row bands touched by the frame being delivered (only valid inside the frame callback)
+     * @param index Camera index
+     * @return RowBands::ALL unless frames come from the native accumulator
      */
-    uint64_t get_event_count() const { return event_count_; }
+    video::RowBands get_frame_row_bands(int index = 0) const {
+        const auto& accumulator = pipeline(index).binary_accumulator;
+        return accumulator ? accumulator->row_bands() : video::RowBands{};
+    }
+
+    /**
+     * Occupied 64 x 8 blocks of the frame being delivered (only valid inside the frame callback)
+     * @param index Camera index
+     * @return nullptr unless frames come from the native accumulator on a black background
+     */
+    std::shared_ptr<const video::BlockMap> get_frame_block_map(int index = 0) const {
+        const auto& accumulator = pipeline(index).binary_accumulator;
+        return accumulator ? accumulator->block_map() : nullptr;
+    }
+
+    /**
+     * Statistics of the frame being delivered, built with it (only valid inside the frame callback)
+     * @param index Camera index
+     * @param stats Receives the statistics, box in sensor coordinates
+     * @return false unless frames come from the native accumulator
+     */
+    bool get_frame_stats(video::BinaryFrameAccumulator::FrameStats& stats, int index = 0) const {
+        const Pipeline& pipe = pipeline(index);
+        if (!pipe.binary_accumulator) {
+            return false;
+        }
+        stats = pipe.binary_accumulator->frame_stats();
+        if (stats.has_box()) {
+            stats.x_min += pipe.frame_origin.x;
+            stats.x_max += pipe.frame_origin.x;
+            stats.y_min += pipe.frame_origin.y;
+            stats.y_max += pipe.frame_origin.y;
+        }
+        return true;
+    }
+
+    /**
+     * Also OR-bin native frames into a display preview, on every camera
+     * (see BinaryFrameAccumulator::set_preview_binning; call before start_single_camera())
+     * @param binning Pixels per side of a preview pixel: 2 or 4 (0 = off)
+     * @return false if frames do not come from the native accumulator
+     */
+    bool set_preview_binning(int binning);
+
+    /**
+     * Write large batches of native frames with several threads, on every camera
+     * (see BinaryFrameAccumulator::set_parallel_threads; call before start_single_camera())
+     * @param threads Threads per camera including the accumulation thread (1 = serial)
+     * @return false if frames do not come from the native accumulator
+     */
+    bool set_accumulation_threads(int threads);
+
+    /**
+     * Decode EVT 2.1 / EVT 3.0 device buffers straight into the native accumulator
+     * (see video::RawEventDecoder; call before start_single_camera())
+     *
+     * Skips EventCD materialization and the event ring: the decoding thread
+     * builds frames itself, so the frame callback runs there. Only used for
+     * uncropped native frames from a camera streaming EVT 2.1 or EVT 3.0;
+     * otherwise (and for replay) events take the usual path. Stages that need
+     * individual events (recording, noise filter, activity, time surface,
+     * pixel rates, flicker, event statistics, shared-memory events, analyzer
+     * events) and latency shedding get nothing in this mode.
+     */
+    void set_raw_decode(bool enabled) { raw_decode_requested_ = enabled; }
+
+    /**
+     * Hand camera 0's events, window by window, to the GPU event scatter (see video::EventScatterQueue)
+     *
+     * Packed on the accumulation thread after the noise filter; frames are
+     * still built on the CPU for analysis. Call before start_single_camera()
+     * (raw decode is skipped while this is on, it bypasses the event stages).
+     */
+    void set_event_scatter(bool enabled) { pipeline(0).scatter_queue.set_enabled(enabled); }
+
+    /**
+     * Completed event windows for the GPU event scatter (GL thread)
+     */
+    video::EventScatterQueue& event_scatter_queue() { return pipeline(0).scatter_queue; }
+
+    /**
+     * Event-driven scattering test for a camera's events (see video::ScatteringEventTap)
+     *
+     * Fed on the accumulation thread after the noise filter while the
+     * scattering worker has it enabled. Raw decode bypasses it.
+     * @param index Pipeline index (0 .. num_pipelines() - 1)
+     */
+    video::ScatteringEventTap& scattering_event_tap(int index) { return pipeline(index).scattering_tap; }
+
+    /**
+     * Pixels per side of a preview pixel (0 = no previews)
+     */
+    int get_preview_binning() const {
+        const auto& accumulator = pipeline(0).binary_accumulator;
+        return accumulator ? accumulator->get_preview_binning() : 0;
+    }
+
+    /**
+     * Binned preview of the frame being delivered (only valid inside the frame callback; may be kept)
+     * @param index Camera index
+     * @return Empty unless preview binning is on
+     */
+    cv::Mat get_frame_preview(int index = 0) const {
+        const auto& accumulator = pipeline(index).binary_accumulator;
+        return accumulator ? accumulator->preview_frame() : cv::Mat();
+    }
+
+    /**
+     * Change accumulation time and binary bit positions while running, on every camera
+     *
+     * Bumps a configuration epoch that each accumulation thread checks
+     * before its next batch. The native accumulator switches at its next
+     * window boundary; the SDK frame generator is recreated for a new
+     * accumulation time (its bits are applied downstream, per frame). Safe
+     * from any thread; no camera restart.
+     * @param accumulation_time_us Window length in microseconds (kept while coarse windows are built)
+     * @param binary_bit_1 First bit position (0-7)
+     * @param binary_bit_2 Second bit position (0-7)
+     */
+    void set_frame_parameters(int accumulation_time_us, int binary_bit_1, int binary_bit_2);
+
+    /**
+     * Slice native frames by event count instead of time, on every camera
+     * (see BinaryFrameAccumulator::set_slicing; call before start_single_camera())
+     * @param mode Time, Events or EventsOrTime (time limit = accumulation time)
+     * @param slice_events Events per frame for the event-count modes
+     * @return false if frames do not come from the native accumulator
+     */
+    bool set_frame_slicing(video::BinaryFrameAccumulator::SliceMode mode, int slice_events);
+
+    /**
+     * Build coarser accumulation windows alongside the regular frames, on every camera
+     *
+     * The native accumulator keeps a packed copy of each frame and a
+     * video::WindowPyramid ORs those into one frame per window, so e.g.
+     * 1 ms frames also give 10 ms and 100 ms frames without a second pass
+     * over the events (call before start_single_camera()).
+     * @param windows_us Coarse windows in microseconds, empty to turn off
+     * @return Number of coarse levels built (0 without native accumulation
+     *         or with event-count slicing, whose frames have no window grid)
+     */
+    int set_accumulation_windows(const std::vector<int>& windows_us);
+
+    /**
+     * Get number of coarse accumulation windows (see set_accumulation_windows)
+     */
+    int get_window_levels() const { return pipeline(0).window_pyramid.levels(); }
+
+    /**
+     * Get window length of a coarse level in microseconds (levels are sorted shortest first)
+     */
+    int get_window_us(int level) const { return pipeline(0).window_pyramid.window_us(level); }
+
+    /**
+     * Set the consumer of one coarse level; runs on each camera's accumulation thread
+     * (call before start_single_camera())
+     * @param level Level index (0 to get_window_levels() - 1)
+     */
+    void set_window_consumer(int level, WindowCallback consumer);
 
 private:
     CameraManager() = default;
 
 public:
-    ~CameraManager() = default;
+    ~CameraManager() {
+        stop_watchdog();
+        stop_erc_control();
+        stop_monitoring();
+        stop_accumulation_threads();
+    }
 
 private:
-    std::vector<CameraInfo> cameras_;
+    /**
+     * Everything one camera needs between its decoding thread and the frame callback
+     *
+     * Accumulation-thread members are only touched by that pipeline's own
+     * thread, so pipelines share nothing but the metrics counters.
+     */
+    struct Pipeline {
+        int index = 0;
+
+        // Frame generation
+        std::unique_ptr<Metavision::PeriodicFrameGenerationAlgorithm> frame_generator;
+        std::unique_ptr<video::BinaryFrameAccumulator> binary_accumulator;
+        std::function<void(Metavision::timestamp, cv::Mat&)> on_frame;  // Output callback of either builder
+        int accumulation_time_us = 1;
+        std::atomic<bool> camera_started{false};
+        cv::Size frame_size;
+        std::atomic<int64_t> last_frame_timestamp{0};
+        std::atomic<uint32_t> last_frame_window_us{0};  // Actual span of the last frame
+        std::atomic<int64_t> last_frame_events{-1};     // Events in it (-1 = SDK generator, not counted)
+        std::atomic<int64_t> last_frame_on_events{-1};  // ON events among them
+
+        // ROI: frames cover frame_origin + frame_size of the sensor
+        cv::Point frame_origin;
+        bool crop_to_window = false;
+        bool hardware_roi = false;
+        std::vector<Metavision::EventCD> window_events;  // Accumulation thread: batch in frame coordinates
+
+        // Event counting for focus adjust
+        std::atomic<uint64_t> event_count{0};
+
+        // Row/column projections, counted on the accumulation thread
+        video::EventActivityProfile activity;
+
+        // Per-batch and per-window event statistics, first pass of the accumulation thread
+        EventCamera::EventProcessor event_stats;
+        uint64_t bus_window_seen = 0;       // Accumulation thread: last window published on the bus
+        bool bus_window_synced = false;     // bus_window_seen is current (false while nobody subscribes)
+        std::vector<EventCamera::EventProcessor::WindowStats> bus_windows;  // Accumulation thread: reused
+
+        // Known hot pixels dropped at ingestion, before the noise filter (off by default)
+        video::EventPixelMask pixel_mask;
+
+        // Software noise filter, run on the accumulation thread (off by default)
+        video::EventNoiseFilter noise_filter;
+        std::vector<Metavision::EventCD> filtered_events;  // Accumulation thread: kept events of an uncropped batch
+
+        // Time-surface view, updated on the accumulation thread while displayed
+        video::TimeSurface time_surface;
+
+        // Hot-pixel detection from per-pixel event rates, on the accumulation thread (off by default)
+        video::PixelRateMonitor pixel_rates;
+
+        // Inter-event intervals per pixel class for refractory tuning, on the accumulation thread (off by default)
+        video::EventIntervalHistogram intervals;
+
+        // Dark-frame calibration counters, on the accumulation thread (idle unless started)
+        video::DarkFrameCalibrator dark_frames;
+
+        // Whole rows or columns firing, projected from each frame in the frame callback (off by default)
+        video::LineDefectDetector line_defects;
+
+        // Stuck / flickering pixels from consecutive frames, in the frame callback (off by default)
+        video::PixelToggleAnalyzer toggles;
+
+        // Trigger-in capture windows, fed on the decoding thread (off by default)
+        video::TriggerGate trigger_gate;
+
+        // Per-pixel latency to trigger onsets, on the accumulation thread (off by default)
+        video::TriggerLatencyMap latency_map;
 
-    // Frame generation for single camera
-    std::unique_ptr<Metavision::PeriodicFrameGenerationAlgorithm> frame_generator_;
+        // Global event-rate histogram for flicker detection, on the accumulation thread (off by default)
+        video::FlickerEstimator flicker;
+
+        // Adaptive window length, applied from the frame callback (off by default)
+        video::AccumulationController accumulation_control;
+
+        // Coarse windows OR-reduced from the packed native frames (accumulation thread)
+        video::WindowPyramid window_pyramid;
+
+        // Decode thread -> accumulation thread hand-off
+        video::EventRing event_ring;
+        std::thread accumulation_thread;
+        std::atomic<bool> accumulation_running{false};
+        bool decode_placed = false;  // Decode thread placed on its first callback (decode thread only)
+
+        // Packed event windows for the GPU event scatter, filled on the accumulation thread (camera 0, off by default)
+        video::EventScatterQueue scatter_queue;
+
+        // Scattering pixels per window, tested on the accumulation thread (off unless a worker enables it)
+        video::ScatteringEventTap scattering_tap;
+
+        // Raw buffers decoded on the decoding thread, no accumulation-thread hand-off (see set_raw_decode)
+        video::RawEventDecoder raw_decoder;
+        bool raw_decode = false;
+
+        // Sensor-to-host clock mapping, fed on the decoding thread
+        core::ClockSync clock_sync;
+
+        // Frame parameters epoch last applied (accumulation thread; see set_frame_parameters)
+        uint32_t frame_config_epoch = 0;
+
+        // Latency budget: shedding state (accumulation thread)
+        enum class Shed { None, Dropping, CatchingUp } shed = Shed::None;
+        Metavision::timestamp shed_first_ts = 0;    // First event shed or collapsed
+        Metavision::timestamp shed_last_ts = 0;     // Last event shed or collapsed so far
+        size_t catch_up_batches = 0;                // Batches left to collapse
+        std::atomic<int64_t> lag_us{0};
+        std::atomic<int64_t> shed_windows{0};
+
+        // Stall watchdog (see start_watchdog)
+        std::atomic<int64_t> last_event_us{0};      // Host time of the last delivered batch
+        std::atomic<bool> reconnecting{false};
+        std::atomic<bool> restart_pending{false};   // Accumulation thread restarts its frame builder
+
+        // Monitoring readings, written by the monitoring thread (see start_monitoring)
+        std::atomic<float> temperature_c{std::numeric_limits<float>::quiet_NaN()};
+        std::atomic<int> dead_time_us{-1};
+        std::atomic<int64_t> monitoring_us{0};
+    };
+
+    /**
+     * Get pipeline by camera index (index 0 always exists, even before initialization)
+     */
+    Pipeline& pipeline(int index) { return *pipelines_[index]; }
+    const Pipeline& pipeline(int index) const { return *pipelines_[index]; }
+
+    /**
+     * Replace all pipelines with count fresh ones (accumulation threads must be stopped)
+     */
+    void reset_pipelines(int count);
+
+    std::vector<CameraInfo> cameras_;
+    std::vector<std::unique_ptr<Pipeline>> pipelines_ = make_pipelines(1);
     FrameCallback frame_callback_;
-    bool camera_started_ = false;
+    std::array<WindowCallback, video::WindowPyramid::MAX_LEVELS> window_consumers_;
+
+    static std::vector<std::unique_ptr<Pipeline>> make_pipelines(int count);
+
+    // ERC control loop (see start_erc_control)
+    std::thread erc_thread_;
+    std::atomic<bool> erc_running_{false};
+    std::atomic<int> erc_rate_kevps_{0};
+    std::mutex erc_wake_mutex_;
+    std::condition_variable erc_wake_cv_;
+
+    // Monitoring poller (see start_monitoring)
+    std::thread monitoring_thread_;
+    std::atomic<bool> monitoring_running_{false};
+    std::mutex monitoring_wake_mutex_;
+    std::condition_variable monitoring_wake_cv_;
+
+    // Stall watchdog (see start_watchdog)
+    std::thread watchdog_thread_;
+    std::atomic<bool> watchdog_running_{false};
+    std::mutex watchdog_wake_mutex_;
+    std::condition_variable watchdog_wake_cv_;
+    ConfigureCallback reconnect_configure_;
 
-    // Event counting for focus adjust
-    std::atomic<uint64_t> event_count_{0};
+    // Held while a camera's device is swapped or its facilities are used off the SDK threads
+    std::mutex device_mutex_;
+
+    // Decode thread -> disk writer thread hand-off (idle unless recording)
+    video::EventRecorder recorder_;
+
+    // Frames and events for external readers, written on the accumulation threads (idle unless started)
+    video::SharedMemoryPublisher publisher_;
+
+    // Analyzer plugins fed from the accumulation threads (idle unless plugins are loaded)
+    video::AnalyzerHost analyzers_;
+
+    // Host-time merge of every camera's events, fed from the accumulation threads (idle unless started)
+    video::StreamMerger merger_;
+
+    // Recorded file standing in for the camera (replay mode only)
+    std::unique_ptr<video::EventReplay> replay_;
+
+    // Raw decode requested (see set_raw_decode); each pipeline decides whether it applies
+    bool raw_decode_requested_ = false;
+
+    // Live frame parameters (see set_frame_parameters)
+    struct FrameConfig {
+        int accumulation_time_us = 1;
+        int binary_bit_1 = 0;
+        int binary_bit_2 = 0;
+    };
+    std::mutex frame_config_mutex_;
+    FrameConfig frame_config_;                       // Guarded by frame_config_mutex_
+    std::atomic<uint32_t> frame_config_epoch_{0};    // Bumped on every change
+
+    /**
+     * Apply the current frame parameters to a pipeline (its accumulation thread)
+     */
+    void apply_frame_config(Pipeline& pipe);
+
+    /**
+     * Retune the window from the frame just emitted (frame callback, see accumulation_control)
+     */
+    void adapt_accumulation_time(Pipeline& pipe, const cv::Mat& frame);
+
+    // Latency budget (see set_latency_budget)
+    std::atomic<int64_t> latency_budget_us_{0};
+    std::atomic<int> latency_shed_mode_{static_cast<int>(LatencyShedMode::DropWindows)};
+
+    /**
+     * CD event handler shared by the camera decoding threads and the replay thread
+     */
+    void on_cd_events(Pipeline& pipe, const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Raw buffer handler of a camera decoding thread in raw decode mode (see set_raw_decode)
+     */
+    void on_raw_data(Pipeline& pipe, Metavision::Camera& camera, const uint8_t* data, size_t size);
+
+    /**
+     * Route a camera's events to its pipeline: raw buffers to the fused decoder when
+     * raw decode applies, CD events to on_cd_events otherwise
+     */
+    void attach_event_input(Metavision::Camera& camera, Pipeline& pipe);
+
+    /**
+     * Create the frame generator or native binary accumulator for a sensor window
+     * @param pipe Pipeline of the camera
+     * @param window Part of the sensor frames are built from (full sensor = no cropping)
+     * @param sensor_size Full sensor size
+     */
+    void create_frame_builder(Pipeline& pipe, const cv::Rect& window, cv::Size sensor_size,
+                              int accumulation_time_us, bool native_binary,
+                              int binary_bit_1, int binary_bit_2);
+
+    /**
+     * Restrict streaming to the window on the sensor through I_ROI
+     * @return true if the sensor crops (false = crop in software)
+     */
+    static bool set_hardware_roi(Metavision::Camera& camera, const cv::Rect& window);
+
+    /**
+     * Clip a requested ROI to the sensor (width/height <= 0 = to the sensor edge,
+     * so an empty rect is the full sensor; a window outside the sensor = full sensor)
+     */
+    static cv::Rect clip_window(const cv::Rect& roi, int width, int height);
+
+    /**
+     * Copy the events inside the window to pipe.window_events, offset to frame coordinates
+     */
+    static void crop_to_window(Pipeline& pipe, const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Publish the windows event_stats completed since the last call on the PipelineBus (accumulation thread)
+     */
+    static void publish_window_stats(Pipeline& pipe);
+
+    /**
+     * Enforce the latency budget on a batch about to be accumulated (accumulation thread)
+     * @return First event to accumulate (end = the whole batch is shed)
+     */
+    const Metavision::EventCD* shed_backlog(Pipeline& pipe, const Metavision::EventCD* begin,
+                                            const Metavision::EventCD* end);
+
+    /**
+     * Emit the catch-up frame once the backlog it collapses is accumulated
+     */
+    static void end_catch_up(Pipeline& pipe);
+
+    /**
+     * Replace the frame builder's partial window so the next frame is a whole one
+     */
+    static void restart_frame_builder(Pipeline& pipe);
+
+    /**
+     * Accumulation thread body: drains the pipeline's event ring into its frame builder
+     */
+    void accumulation_loop(Pipeline* pipe);
+
+    /**
+     * ERC thread body: samples the ring every interval and applies the controller's cap
+     */
+    void erc_control_loop(core::ErcController controller, int interval_ms);
+
+    /**
+     * Monitoring thread body: reads every camera's I_Monitoring facility each interval
+     */
+    void monitoring_loop(int interval_ms);
+
+    /**
+     * Watchdog thread body: flags stalled cameras and reopens them
+     */
+    void watchdog_loop(int stall_ms);
+
+    /**
+     * Replace a stalled camera's device with a freshly opened one and start it (watchdog thread)
+     * @return true if the camera streams again
+     */
+    bool reopen_camera(int index);
+
+    /**
+     * Enable trigger-in on a camera and route its events to the pipeline's gate (no-op unless gated)
+     */
+    static void attach_trigger_in(Metavision::Camera& camera, Pipeline& pipe);
+
+    /**
+     * Stop and join every pipeline's accumulation thread
+     */
+    void stop_accumulation_threads();
 
     /**
      * Open camera by serial number or index
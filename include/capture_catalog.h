@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "image_manager.h"
+
+/**
+ * CaptureCatalog - In-memory index of the metadata of every saved capture
+ *
+ * Finding captures used to mean parsing one JSON sidecar per PNG. The
+ * catalog keeps each capture's ImageMetadata in memory, so a query over
+ * tens of thousands of captures is a scan of a vector instead of tens of
+ * thousands of file reads.
+ *
+ * On disk, in the capture directory:
+ * - capture_catalog.idx: append-only log, one record per saved capture
+ *   (written by ImageSaveQueue / ImageManager::save_image as they save)
+ * - capture_catalog.snap: compacted snapshot of every entry, rewritten
+ *   (temporary file + rename) every COMPACT_EVERY appends and on close,
+ *   after which the log is emptied
+ *
+ * open() loads the snapshot, then replays the log; a record torn by a
+ * crash ends the replay and is cut off. Records are keyed by path, so
+ * replaying a log already folded into the snapshot changes nothing.
+ * Captures saved before the catalog existed (or by another build) are
+ * backfilled by a parallel scan of the PNG + JSON pairs not yet indexed.
+ *
+ * Paths are stored relative to the catalog directory ('/' separated);
+ * captures saved outside it are not indexed. A deduplicated capture (see
+ * ImageSaveQueue) is indexed under its own PNG name although only its
+ * sidecar exists; full_path() resolves it to the PNG it refers to.
+ *
+ * **Usage:**
+ * ```cpp
+ * CaptureCatalog::instance().open(capture_directory, 4);   // Backfills in the background
+ * CaptureCatalog::Query query;
+ * std::string error;
+ * if (CaptureCatalog::Query::parse("bias_hpf=100 pixel_density>2", query, error)) {
+ *     for (const auto& entry : CaptureCatalog::instance().find(query, 200)) { ... }
+ * }
+ * ```
+ */
+class CaptureCatalog {
+public:
+    static constexpr const char* LOG_FILE = "capture_catalog.idx";
+    static constexpr const char* SNAPSHOT_FILE = "capture_catalog.snap";
+    static constexpr int COMPACT_EVERY = 1024;   // Log records before the snapshot is rewritten
+
+    /**
+     * One indexed capture
+     */
+    struct Entry {
+        std::string path;                        // PNG, relative to the catalog directory
+        ImageManager::ImageMetadata metadata;
+    };
+
+    /**
+     * Conjunction of field comparisons
+     *
+     * Text form: whitespace-separated terms "<field><op><value>", all of
+     * which must hold. Operators: = != < <= > >= on numbers, = != and ~
+     * (contains) on text. Fields are the JSON sidecar keys (bias_hpf,
+     * pixel_density, width, accumulation_time_us, ...) plus path; an
+     * empty query matches everything.
+     */
+    struct Query {
+        enum class Op { EQ, NE, LT, LE, GT, GE, CONTAINS };
+
+        struct Term {
+            int field = 0;                       // Index into the field table
+            Op op = Op::EQ;
+            double number = 0.0;
+            std::string text;
+        };
+
+        std::vector<Term> terms;
+
+        /**
+         * Parse the text form
+         * @param text Query, e.g. "bias_hpf=100 pixel_density>2 comment~hot"
+         * @param out Parsed query
+         * @param error Set to the offending term on failure
+         * @return false if a term has an unknown field, operator or value
+         */
+        static bool parse(const std::string& text, Query& out, std::string& error);
+
+        bool matches(const Entry& entry) const;
+    };
+
+    static CaptureCatalog& instance();
+
+    // Non-copyable
+    CaptureCatalog(const CaptureCatalog&) = delete;
+    CaptureCatalog& operator=(const CaptureCatalog&) = delete;
+
+    /**
+     * Load (or create) the catalog of a capture directory
+     * @param directory Capture directory ("" = current directory)
+     * @param backfill_threads Scan threads for unindexed captures (0 = hardware threads, -1 = no scan)
+     * @return false if the directory cannot be created or the log cannot be opened
+     */
+    bool open(const std::string& directory, int backfill_threads);
+
+    /**
+     * Stop the backfill, compact and close the files
+     */
+    void close();
+
+    /**
+     * Index a capture that has just been saved (any thread; ignored when closed)
+     * @param image_path PNG path as saved
+     * @param metadata Metadata written next to it
+     */
+    void add(const std::string& image_path, const ImageManager::ImageMetadata& metadata);
+
+    /**
+     * Captures matching a query, newest first
+     * @param query Parsed query
+     * @param limit Most entries returned (0 = all)
+     */
+    std::vector<Entry> find(const Query& query, size_t limit) const;
+
+    /**
+     * Absolute path of an entry's PNG (the referenced PNG for a deduplicated capture)
+     */
+    std::string full_path(const Entry& entry) const;
+
+    /**
+     * Absolute catalog directory ("" when closed)
+     */
+    std::string directory() const;
+
+    bool is_open() const { return open_.load(std::memory_order_relaxed); }
+    bool is_backfilling() const { return backfilling_.load(std::memory_order_relaxed); }
+    size_t size() const;
+
+private:
+    CaptureCatalog() = default;
+    ~CaptureCatalog();
+
+    void put(Entry&& entry, bool log);                  // mutex_ held
+    bool append(const Entry& entry);                    // mutex_ held
+    bool compact();                                     // mutex_ held
+    bool load_file(const std::string& path, bool truncate_torn_tail);
+    void backfill(int threads);
+
+    std::string directory_;
+    std::atomic<bool> open_{false};
+
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+    std::unordered_map<std::string, size_t> by_path_;   // path -> entries_ index
+    std::ofstream log_;
+    int log_records_ = 0;
+
+    std::thread backfill_thread_;
+    std::atomic<bool> backfilling_{false};
+    std::atomic<bool> stop_backfill_{false};
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "analysis_shard.h"
+
+/**
+ * CheckpointWriter - Saves analysis shards on a background I/O thread
+ *
+ * A long run that crashes loses everything the analyzer accumulated. The
+ * analysis thread exports its state into a shard it owns and hands it over
+ * with submit(), which only swaps pointers under a mutex and gives back a
+ * spare shard for the next export (its vectors keep their capacity). The
+ * I/O thread serializes the newest shard and writes it atomically
+ * (AnalysisShard::save: temporary file, then rename), so the checkpoint on
+ * disk is always a complete one. A shard still pending when the next one
+ * arrives is superseded, never queued behind it.
+ *
+ * **Usage:**
+ * ```cpp
+ * writer.start("checkpoints/scattering.rtshard");
+ * analyzer.export_shard(*spare);                 // Analysis thread, every minute
+ * spare = writer.submit(std::move(spare));
+ * writer.stop();                                 // Writes what is pending
+ * ```
+ */
+class CheckpointWriter {
+public:
+    CheckpointWriter() = default;
+    ~CheckpointWriter() { stop(); }
+
+    // Non-copyable
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    /**
+     * Start the I/O thread
+     * @param path Checkpoint file (replaced by every write)
+     */
+    void start(const std::string& path);
+
+    /**
+     * Write what is pending, then stop the I/O thread
+     */
+    void stop();
+
+    bool is_running() const { return running_; }
+    const std::string& path() const { return path_; }
+
+    /**
+     * Hand over a filled shard (never blocks on I/O)
+     * @param shard Shard to write (ownership taken)
+     * @return Spare shard to fill next time (never null)
+     */
+    std::unique_ptr<AnalysisShard> submit(std::unique_ptr<AnalysisShard> shard);
+
+    // Statistics
+    int64_t get_written() const { return written_.load(); }
+    int64_t get_failed() const { return failed_.load(); }
+    int64_t get_superseded() const { return superseded_.load(); }
+
+private:
+    void writer_loop();
+
+    std::string path_;
+    std::thread thread_;
+    bool running_ = false;                  // Owner thread only
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_requested_ = false;
+    std::unique_ptr<AnalysisShard> pending_;   // Newest submitted, not yet taken
+    std::unique_ptr<AnalysisShard> spare_;     // Written, waiting to be refilled
+
+    std::atomic<int64_t> written_{0};
+    std::atomic<int64_t> failed_{0};
+    std::atomic<int64_t> superseded_{0};
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Allocation scopes, compiled in only with -DRTCAM_ALLOC_TRACKING=ON (CMake option):
+ *
+ * ```
+ * void process_camera_frame(...) {
+ *     ALLOC_SCOPE("process_frame");
+ *     ...
+ * }
+ * ```
+ *
+ * Each scope adds the calling thread's heap and cv::Mat allocations while
+ * it is open to the histograms alloc.<stage>_count and alloc.<stage>_bytes
+ * (one sample per call, nested scopes included), so a hot-path stage that
+ * starts allocating per frame shows up in the Metrics section, the CSV
+ * dump and the exporters. Without the option the macro expands to nothing.
+ */
+#if RTCAM_ALLOC_TRACKING
+#define ALLOC_CONCAT_(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_(a, b)
+#define ALLOC_SCOPE(stage) \
+    static core::AllocStage ALLOC_CONCAT(alloc_stage_, __LINE__)(stage); \
+    core::AllocScope ALLOC_CONCAT(alloc_scope_, __LINE__)(ALLOC_CONCAT(alloc_stage_, __LINE__))
+#else
+#define ALLOC_SCOPE(stage) ((void)0)
+#endif
+
+namespace core {
+
+class Histogram;
+
+struct AllocCounts {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
+
+/**
+ * Heap allocation counters fed by the replaced global operator new
+ *
+ * The operator new / delete replacements live in alloc_hooks.cpp, which is
+ * only linked into builds that count (pipeline_bench always, the app with
+ * RTCAM_ALLOC_TRACKING); without it every counter stays zero. cv::Mat
+ * buffers come from OpenCV's own allocator, so install_mat_allocator()
+ * wraps the default cv::MatAllocator to count them as well.
+ *
+ * Counting is one thread-local increment plus one relaxed atomic add per
+ * allocation; frees are not counted.
+ */
+class AllocTracker {
+public:
+    /**
+     * Count one allocation (called by the hooks; must not allocate)
+     */
+    static void on_allocate(size_t bytes);
+
+    /**
+     * Allocations made by the calling thread since it started
+     */
+    static AllocCounts thread_counts();
+
+    /**
+     * Allocations made by every thread since the process started
+     */
+    static AllocCounts process_counts();
+
+    /**
+     * True when alloc_hooks.cpp is linked in
+     */
+    static bool is_active();
+
+    /**
+     * Wrap the default cv::MatAllocator so Mat buffers are counted (call once at startup)
+     * @return false if the hooks are not linked (nothing is installed)
+     */
+    static bool install_mat_allocator();
+
+    /**
+     * Mark the hooks as linked (alloc_hooks.cpp static initializer)
+     */
+    static void set_active();
+};
+
+/**
+ * Named stage: alloc.<name>_count and alloc.<name>_bytes histograms
+ */
+class AllocStage {
+public:
+    explicit AllocStage(const char* name);
+
+    // Non-copyable
+    AllocStage(const AllocStage&) = delete;
+    AllocStage& operator=(const AllocStage&) = delete;
+
+    void record(const AllocCounts& delta);
+
+private:
+    Histogram& count_;
+    Histogram& bytes_;
+};
+
+/**
+ * RAII scope: records the thread's allocations into a stage when it goes out of scope (use ALLOC_SCOPE)
+ */
+class AllocScope {
+public:
+    explicit AllocScope(AllocStage& stage) : stage_(stage), start_(AllocTracker::thread_counts()) {}
+
+    ~AllocScope() {
+        const AllocCounts now = AllocTracker::thread_counts();
+        stage_.record({now.count - start_.count, now.bytes - start_.bytes});
+    }
+
+    // Non-copyable
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    AllocStage& stage_;
+    AllocCounts start_;
+};
+
+} // namespace core
@@ -2,8 +2,16 @@
 
 #include "core/display_settings.h"
 #include "core/camera_state.h"
+#include "core/frame_log.h"
+#include "core/frame_sync.h"
+#include "core/latency_stats.h"
 #include "video/frame_buffer.h"
-#include "video/texture_manager.h"
+#include "video/frame_pool.h"
+#include "video/texture_cache.h"
+#include "video/triple_buffer_renderer.h"
+#include "video/burst_capture.h"
+#include "video/frame_history.h"
+#include "scattering_worker.h"
 
 #include <memory>
 #include <atomic>
@@ -25,21 +33,79 @@ public:
     AppState(const AppState&) = delete;
     AppState& operator=(const AppState&) = delete;
 
+    // Cameras with their own frame path (buffer, pool, analysis, display); see CameraManager
+    static constexpr int MAX_CAMERAS = 2;
+
     // === Subsystem Access ===
 
     /**
      * Get frame buffer for camera index
-     * @param camera_index Camera index (0 or 1)
+     * @param camera_index Camera index (0 to MAX_CAMERAS - 1)
      * @return Reference to frame buffer
      */
     video::FrameBuffer& frame_buffer(int camera_index = 0);
 
     /**
-     * Get texture manager for camera index
-     * @param camera_index Camera index (0 or 1)
-     * @return Reference to texture manager
+     * Get frame pool backing processed frames for camera index
+     * @param camera_index Camera index (0 to MAX_CAMERAS - 1)
+     * @return Reference to frame pool
+     */
+    video::FramePool& frame_pool(int camera_index = 0);
+
+    /**
+     * Get texture showing the camera's latest frame
+     * @param camera_index Camera index (0 to MAX_CAMERAS - 1)
+     * @return Reference to texture manager (shared through texture_cache())
+     */
+    const video::TextureManager& texture_manager(int camera_index = 0) const;
+
+    /**
+     * Show a frame as the camera's latest, uploading it unless a view already did
+     * @param camera_index Camera index (0 to MAX_CAMERAS - 1)
+     * @param frame Frame to show
+     */
+    void upload_camera_frame(int camera_index, const video::FrameRef& frame);
+
+    /**
+     * Get the GPU textures shared by all panels and overlays (UI thread only)
+     * @return Reference to texture cache
      */
-    video::TextureManager& texture_manager(int camera_index = 0);
+    video::TextureCache& texture_cache();
+
+    /**
+     * Get triple-buffered display renderer for camera index
+     * @param camera_index Camera index (0 to MAX_CAMERAS - 1)
+     * @return Reference to renderer
+     */
+    video::TripleBufferRenderer& triple_buffer_renderer(int camera_index = 0);
+
+    /**
+     * Get background scattering analysis worker for camera index
+     * @param camera_index Camera index (0 to MAX_CAMERAS - 1)
+     * @return Reference to scattering worker
+     */
+    ScatteringWorker& scattering_worker(int camera_index = 0);
+
+    /**
+     * Get burst capture ring fed by the frame producer for camera index
+     * @param camera_index Camera index (0 to MAX_CAMERAS - 1)
+     * @return Reference to burst capture
+     */
+    video::BurstCapture& burst_capture(int camera_index = 0);
+
+    /**
+     * Get scrub-back frame history fed by the frame producer for camera index
+     * @param camera_index Camera index (0 to MAX_CAMERAS - 1)
+     * @return Reference to frame history
+     */
+    video::FrameHistory& frame_history(int camera_index = 0);
+
+    /**
+     * Get per-frame metadata history appended by the frame producer for camera index
+     * @param camera_index Camera index (0 to MAX_CAMERAS - 1)
+     * @return Reference to frame log
+     */
+    FrameLog& frame_log(int camera_index = 0);
 
     /**
      * Get display settings
@@ -53,6 +119,27 @@ public:
      */
     CameraState& camera_state();
 
+    /**
+     * Get last generated / displayed frame timestamps
+     * @return Reference to frame sync
+     */
+    FrameSync& frame_sync();
+
+    /**
+     * Get end-to-end display latency histograms (UI thread only)
+     * @return Reference to latency stats
+     */
+    LatencyStats& latency_stats();
+
+    /**
+     * Make frame queues wait for every-frame consumers instead of dropping
+     *
+     * For sources that can slow down (file replay), so analysis sees every
+     * frame. Call before the source and consumers are started.
+     * @param lossless true = FrameQueuePolicy::Block, false = DropNewest
+     */
+    void set_lossless_frame_queues(bool lossless);
+
     // === Running State ===
 
     /**
@@ -72,15 +159,28 @@ public:
     void reset_running_flag();
 
 private:
-    // Single camera for reliability testing
-    static constexpr int MAX_CAMERAS = 1;
+    // Frames queued for every-frame consumers (scattering worker); the pool
+    // also covers frames held by the display path on top of the queue
+    static constexpr size_t FRAME_QUEUE_DEPTH = 8;
+    static constexpr int FRAME_POOL_SLOTS = 16;
+    static constexpr int64_t LOSSLESS_BLOCK_TIMEOUT_US = 1000000;  // Stalled consumer still can't hang the source
+
     std::atomic<bool> running_{true};
 
     // Subsystem instances
     std::unique_ptr<video::FrameBuffer> frame_buffers_[MAX_CAMERAS];
-    std::unique_ptr<video::TextureManager> texture_managers_[MAX_CAMERAS];
+    std::unique_ptr<video::FramePool> frame_pools_[MAX_CAMERAS];
+    std::unique_ptr<video::TextureCache> texture_cache_;
+    video::TextureCache::Handle camera_textures_[MAX_CAMERAS];
+    std::unique_ptr<video::TripleBufferRenderer> renderers_[MAX_CAMERAS];
+    std::unique_ptr<ScatteringWorker> scattering_workers_[MAX_CAMERAS];  // Destroyed before frame buffers
+    std::unique_ptr<video::BurstCapture> burst_captures_[MAX_CAMERAS];
+    std::unique_ptr<video::FrameHistory> frame_histories_[MAX_CAMERAS];
+    std::unique_ptr<FrameLog> frame_logs_[MAX_CAMERAS];
     std::unique_ptr<DisplaySettings> display_settings_;
     std::unique_ptr<CameraState> camera_state_;
+    std::unique_ptr<FrameSync> frame_sync_;
+    std::unique_ptr<LatencyStats> latency_stats_;
 };
 
 } // namespace core
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace core {
+
+/**
+ * Camera-to-host clock mapping with drift estimation
+ *
+ * Fits host_us = sensor_us + offset + drift * (sensor_us - reference) online
+ * from (sensor timestamp, steady_clock arrival) pairs, one per delivered
+ * event batch. Arrival is always late by a variable transport delay, so
+ * each bucket of BUCKET_US host time keeps only its least-delayed sample
+ * (minimum-latency filter) and the line is a least-squares fit over the
+ * last BUCKET_COUNT bucket minima (~17 min). That follows crystal drift
+ * (tens of ppm, ie tens of ms over an 8-hour run) instead of freezing the
+ * offset seen at start.
+ *
+ * Mapped times track the fastest deliveries, so to_host_us() of a
+ * just-delivered batch is its transport delay above the best case.
+ *
+ * add_sample() and reset() belong to one thread (the camera's decoding
+ * thread, or before it starts); the model is published through a seqlock,
+ * so to_host_us() and the getters are lock-free from any thread.
+ */
+class ClockSync {
+public:
+    static constexpr int64_t BUCKET_US = 2000000;    // Host time per minimum-latency bucket
+    static constexpr int BUCKET_COUNT = 512;         // Buckets in the fit
+
+    ClockSync() = default;
+
+    // Non-copyable
+    ClockSync(const ClockSync&) = delete;
+    ClockSync& operator=(const ClockSync&) = delete;
+
+    /**
+     * Add one arrival (writer thread)
+     * @param sensor_us Sensor timestamp of the newest event delivered
+     * @param host_us steady_clock microseconds at delivery
+     */
+    void add_sample(int64_t sensor_us, int64_t host_us);
+
+    /**
+     * Forget every sample (sensor time restarted; writer thread or writer stopped)
+     */
+    void reset();
+
+    /**
+     * Check if at least one sample was added
+     */
+    bool is_valid() const { return seq_.load(std::memory_order_acquire) != 0; }
+
+    /**
+     * Map a sensor timestamp to steady_clock microseconds (0 while not valid)
+     */
+    int64_t to_host_us(int64_t sensor_us) const;
+
+    /**
+     * Map steady_clock microseconds to sensor time (inverse of to_host_us; 0 while not valid)
+     *
+     * The result is the newest sensor time a best-case delivery could have
+     * carried by then, e.g. to stamp a register write in camera time.
+     */
+    int64_t to_sensor_us(int64_t host_us) const;
+
+    /**
+     * Get the estimated sensor clock drift relative to the host
+     * @return Parts per million (positive = sensor clock runs slow)
+     */
+    double get_drift_ppm() const;
+
+    /**
+     * Get number of bucket minima the current fit uses
+     */
+    int get_fit_points() const { return fit_points_.load(std::memory_order_relaxed); }
+
+private:
+    struct Point {
+        int64_t sensor_us;
+        int64_t offset_us;  // host - sensor, least delayed sample of the bucket
+    };
+
+    struct Model {
+        int64_t reference_us = 0;   // Sensor time the offset refers to
+        double offset_us = 0.0;     // host - sensor at reference_us
+        double drift = 0.0;         // d(offset) / d(sensor time)
+    };
+
+    void refit();
+    void publish(const Model& model);
+    Model load() const;
+
+    // Writer state
+    static constexpr int64_t NO_POINT = std::numeric_limits<int64_t>::max();
+    std::array<Point, BUCKET_COUNT> points_{};
+    int point_count_ = 0;
+    int next_point_ = 0;
+    Point bucket_{0, NO_POINT};     // Bucket being filled
+    int64_t bucket_end_us_ = 0;
+
+    // Published model (seqlock: odd = being written, 0 = never written)
+    std::atomic<uint32_t> seq_{0};
+    std::atomic<int64_t> reference_us_{0};
+    std::atomic<double> offset_us_{0.0};
+    std::atomic<double> drift_{0.0};
+    std::atomic<int> fit_points_{0};
+};
+
+} // namespace core
@@ -107,7 +107,8 @@ public:
         OR_BEFORE_PROCESSING = 0,  // OR bits before processing, display combined
         OR_AFTER_PROCESSING = 1,   // Process separately, OR after, display combined
         DISPLAY_BIT_1 = 2,         // Display only first bit selector result
-        DISPLAY_BIT_2 = 3          // Display only second bit selector result
+        DISPLAY_BIT_2 = 3,         // Display only second bit selector result
+        TIME_SURFACE = 4           // Display per-pixel event recency (exponential decay) instead of a window
     };
 
     /**
@@ -146,6 +147,18 @@ public:
      */
     DisplayMode get_display_mode() const;
 
+    /**
+     * Set time surface decay constant (TIME_SURFACE display mode)
+     * @param decay_us Time for a pixel to fade to 1/e brightness, in microseconds
+     */
+    void set_time_surface_decay_us(int decay_us);
+
+    /**
+     * Get time surface decay constant
+     * @return Decay constant in microseconds
+     */
+    int get_time_surface_decay_us() const;
+
     /**
      * Set red pixel percentage (for combined view statistics)
      * @param percentage Percentage of non-black pixels that are red (0.0 to 100.0)
@@ -168,6 +181,7 @@ private:
     std::atomic<int> binary_stream_mode_{0};  // BinaryStreamMode as int (default: BIT_0)
     std::atomic<int> binary_stream_mode_2_{7};  // Second bit selector (default: BIT_7)
     std::atomic<int> display_mode_{0};  // DisplayMode as int (default: OR_BEFORE_PROCESSING)
+    std::atomic<int> time_surface_decay_us_{20000};
     std::atomic<float> red_pixel_percentage_{0.0f};  // Percentage of non-black pixels that are red
 };
 
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+
+namespace core {
+
+/**
+ * Closed-loop target for the sensor's Event Rate Controller (ERC)
+ *
+ * A static ERC cap is either too high for bright scenes (the ingestion
+ * ring overflows and batches are dropped) or too low for dark ones. The
+ * controller is fed one Sample per control interval and moves the cap so
+ * the pipeline runs just below saturation:
+ *
+ *   - Saturated (events dropped, or the ring's peak fill reached
+ *     high_water_percent): cut the cap to decrease_percent below the
+ *     smaller of the current cap and the rate the pipeline actually
+ *     delivered, then hold for hold_intervals before raising again.
+ *   - Calm (peak fill at or below low_water_percent for hold_intervals
+ *     in a row) while the cap is binding (delivered rate close to the
+ *     cap): raise it by increase_percent.
+ *   - Anything in between: hold.
+ *
+ * The gap between the two water marks and the hold time are the
+ * hysteresis; the cap never leaves [min_rate_kevps, max_rate_kevps]. The
+ * class holds no hardware or thread state: CameraManager samples the
+ * ring and applies the result.
+ */
+class ErcController {
+public:
+    struct Settings {
+        int min_rate_kevps = 1000;      // Lowest cap the loop may set
+        int max_rate_kevps = 20000;     // Highest cap (sensor maximum when 0 in the config)
+        int high_water_percent = 50;    // Peak ring fill treated as saturation
+        int low_water_percent = 10;     // Peak ring fill treated as headroom
+        int decrease_percent = 20;      // Cut below the delivered rate when saturated
+        int increase_percent = 10;      // Raise per step when calm and binding
+        int hold_intervals = 4;         // Calm intervals required before each raise
+        int binding_percent = 90;       // Delivered rate (of the cap) that counts as binding
+    };
+
+    /**
+     * What the pipeline saw during one control interval
+     */
+    struct Sample {
+        double interval_s = 0.0;        // Length of the interval
+        int64_t events = 0;             // Events delivered by the sensor (ingested + dropped)
+        int64_t dropped_events = 0;     // Events lost to a full ingestion ring
+        int peak_fill_percent = 0;      // Highest ring fill seen during the interval
+    };
+
+    enum class Action {
+        Hold,
+        Decrease,
+        Increase
+    };
+
+    ErcController() = default;
+
+    /**
+     * Reset the loop to a starting cap (clamped to the bounds)
+     */
+    void reset(const Settings& settings, int start_rate_kevps);
+
+    /**
+     * Advance the loop by one control interval
+     * @param sample Measurements of the interval that just ended
+     * @return What changed; get_rate_kevps() holds the new cap
+     */
+    Action update(const Sample& sample);
+
+    int get_rate_kevps() const { return rate_kevps_; }
+    const Settings& settings() const { return settings_; }
+
+private:
+    int clamp(int64_t rate_kevps) const;
+
+    Settings settings_;
+    int rate_kevps_ = 0;
+    int calm_intervals_ = 0;
+};
+
+} // namespace core
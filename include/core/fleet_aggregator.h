@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/fleet_report.h"
+#include "core/metrics.h"
+
+namespace core {
+
+/**
+ * Fleet-wide view of many stations' reports (aggregator mode, --aggregate)
+ *
+ * One receive thread reads station report datagrams (see FleetReporter)
+ * and hands each to the shard that owns its sensor (hash of the serial)
+ * through a single-producer single-consumer ring, so ingestion never takes
+ * a lock and a slow shard only ever drops its own reports. Each shard
+ * thread is the only writer of its sensors' state:
+ *
+ *   - per-sensor gauges fleet.<sensor>.event_rate / .scattering_percent /
+ *     .temperature_c / .hot_pixel_count, and a per-sensor CSV history
+ *     (<directory>/<sensor>.csv, one row per report with its hot pixels)
+ *   - latest values in atomics, read by the receive thread once a second
+ *     for the fleet gauges (fleet.sensors, fleet.scattering_percent_mean /
+ *     _max, fleet.event_rate_total, fleet.temperature_max_c)
+ *
+ * Every gauge goes through the MetricsRegistry, so the existing
+ * MetricsExporter serves the fleet dashboard unchanged. Sensors are only
+ * ever added; one that stops reporting drops out of the fleet gauges after
+ * stale_s but keeps its history.
+ *
+ * **Usage:**
+ * ```cpp
+ * FleetAggregator aggregator;
+ * aggregator.start({9600, 4, "fleet"});
+ * aggregator.get_sensor_count();
+ * aggregator.stop();
+ * ```
+ */
+class FleetAggregator {
+public:
+    static constexpr int MAX_SHARDS = 16;
+    static constexpr int MAX_SENSORS_PER_SHARD = 64;
+    static constexpr size_t RING_CAPACITY = 1024;  // Reports queued per shard (power of two)
+
+    struct Options {
+        int port = 9600;              // UDP listen port (all interfaces)
+        int shards = 4;               // Ingestion threads (1 - MAX_SHARDS)
+        std::string directory;        // Per-sensor CSV histories ("" = none)
+        int stale_s = 10;             // Seconds without a report before a sensor leaves the fleet gauges
+    };
+
+    FleetAggregator() = default;
+    ~FleetAggregator();
+
+    // Non-copyable
+    FleetAggregator(const FleetAggregator&) = delete;
+    FleetAggregator& operator=(const FleetAggregator&) = delete;
+
+    /**
+     * Bind the socket and start the receive and shard threads
+     * @return true if running
+     */
+    bool start(const Options& options);
+
+    /**
+     * Stop all threads and close the histories
+     */
+    void stop();
+
+    bool is_running() const { return running_.load(); }
+
+    uint64_t get_received() const { return received_.load(std::memory_order_relaxed); }
+    uint64_t get_dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t get_rejected() const { return rejected_.load(std::memory_order_relaxed); }
+    int get_sensor_count() const;
+
+    /**
+     * Replace characters that are not safe in file and metric names with '_'
+     */
+    static std::string sanitize(const std::string& id);
+
+private:
+    /**
+     * Latest values of one sensor (written by its shard, read by the receive thread)
+     */
+    struct Sensor {
+        std::string id;
+        std::atomic<int64_t> last_seen_ms{0};   // Aggregator clock
+        std::atomic<float> event_rate{0.0f};
+        std::atomic<float> scattering_percent{std::numeric_limits<float>::quiet_NaN()};   // NaN = not reported
+        std::atomic<float> temperature_c{std::numeric_limits<float>::quiet_NaN()};
+
+        // Shard thread only
+        uint32_t last_sequence = 0;
+        std::ofstream history;
+        Gauge* event_rate_gauge = nullptr;
+        Gauge* scattering_gauge = nullptr;
+        Gauge* temperature_gauge = nullptr;
+        Gauge* hot_pixel_gauge = nullptr;
+    };
+
+    struct Shard {
+        // Ring: the receive thread writes head, the shard thread writes tail
+        std::unique_ptr<fleet::Report[]> ring;
+        alignas(64) std::atomic<uint64_t> head{0};
+        alignas(64) std::atomic<uint64_t> tail{0};
+
+        std::array<std::unique_ptr<Sensor>, MAX_SENSORS_PER_SHARD> sensors;
+        std::atomic<int> sensor_count{0};   // Published with release once the slot is filled
+        std::thread thread;
+    };
+
+    void receive_loop();
+    void shard_loop(Shard& shard);
+    void ingest(Shard& shard, const fleet::Report& report);
+    Sensor* find_or_add(Shard& shard, const std::string& id);
+    void publish_fleet();
+
+    Options options_;
+    intptr_t socket_ = -1;
+    bool winsock_started_ = false;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::thread receive_thread_;
+    std::atomic<bool> running_{false};
+
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> dropped_{0};    // Shard ring full
+    std::atomic<uint64_t> rejected_{0};   // Not a station report
+};
+
+} // namespace core
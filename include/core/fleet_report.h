@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace core {
+namespace fleet {
+
+/**
+ * Station report datagram (see FleetReporter / FleetAggregator)
+ *
+ * One UDP datagram per camera and report interval: a 128-byte
+ * ReportHeader followed by hot_pixel_count HotPixelEntry records (8 bytes
+ * each, highest count first). Integers and floats are little-endian. At
+ * most MAX_HOT_PIXELS entries keep a report at 384 bytes, well under a
+ * typical MTU, so a report is never fragmented and a lost one costs one
+ * second of one sensor's history, nothing else.
+ *
+ * Strings are NUL-padded and not necessarily NUL-terminated.
+ */
+
+constexpr uint32_t MAGIC = 0x52465452;  // "RTFR"
+constexpr uint16_t VERSION = 1;
+constexpr int ID_LENGTH = 32;
+constexpr int MAX_HOT_PIXELS = 32;
+
+enum ReportFlags : uint32_t {
+    HAS_SCATTERING = 1u << 0,   // Scattering fields are valid (analysis running)
+    HAS_TEMPERATURE = 1u << 1   // temperature_c is valid (sensor has a probe)
+};
+
+struct ReportHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t hot_pixel_count;
+    char station[ID_LENGTH];             // Station (app instance) name
+    char sensor[ID_LENGTH];              // Sensor serial, the key of its history
+    uint32_t sequence;                   // Per-camera report counter (gaps = lost datagrams)
+    int32_t camera_index;
+    int64_t unix_ms;                     // Station wall clock
+    float event_rate;                    // events/s
+    float scattering_percent;            // % of reference pixels in the latest frame
+    float scattering_per_frame;          // Mean scattering pixels per frame
+    float temperature_c;
+    int64_t frames_analyzed;
+    uint32_t flags;                      // ReportFlags
+    uint8_t reserved[12];
+};
+static_assert(sizeof(ReportHeader) == 128, "ReportHeader must stay 128 bytes");
+
+struct HotPixelEntry {
+    uint16_t x;
+    uint16_t y;
+    int32_t count;                       // Frames the pixel scattered in
+};
+static_assert(sizeof(HotPixelEntry) == 8, "HotPixelEntry must stay 8 bytes");
+
+constexpr size_t MAX_REPORT_BYTES = sizeof(ReportHeader) + MAX_HOT_PIXELS * sizeof(HotPixelEntry);
+
+/**
+ * One decoded report (fixed size, so it can sit in a preallocated ring slot)
+ */
+struct Report {
+    ReportHeader header;
+    HotPixelEntry hot_pixels[MAX_HOT_PIXELS];
+};
+
+/**
+ * Serialize a report
+ * @param report Report (hot_pixel_count is clamped to MAX_HOT_PIXELS)
+ * @param out Datagram buffer of at least MAX_REPORT_BYTES
+ * @return Datagram length
+ */
+size_t encode(const Report& report, uint8_t* out);
+
+/**
+ * Parse and validate a datagram
+ * @return false for a foreign or truncated datagram
+ */
+bool decode(const uint8_t* data, size_t size, Report& out);
+
+/**
+ * Copy a name into a fixed NUL-padded field (truncated to ID_LENGTH)
+ */
+void set_id(char (&field)[ID_LENGTH], const std::string& value);
+
+/**
+ * Read a fixed field back as a string
+ */
+std::string get_id(const char (&field)[ID_LENGTH]);
+
+} // namespace fleet
+
+/**
+ * Sends station reports to a fleet aggregator
+ *
+ * A connected UDP socket; send() is one non-blocking send() per report,
+ * so the caller (the UI or headless loop, once a second) never waits on
+ * the network and an unreachable aggregator is simply ignored.
+ *
+ * **Usage:**
+ * ```cpp
+ * FleetReporter reporter;
+ * reporter.start({"10.0.0.5", 9600, "station-07"});
+ * reporter.send(report);   // station name and sequence are filled in
+ * reporter.stop();
+ * ```
+ */
+class FleetReporter {
+public:
+    struct Options {
+        std::string host = "127.0.0.1";   // Aggregator (IPv4 address)
+        int port = 9600;
+        std::string station;               // Station name in every report ("" = host name)
+    };
+
+    FleetReporter() = default;
+    ~FleetReporter();
+
+    // Non-copyable
+    FleetReporter(const FleetReporter&) = delete;
+    FleetReporter& operator=(const FleetReporter&) = delete;
+
+    /**
+     * Open the socket
+     * @return true if reports can be sent
+     */
+    bool start(const Options& options);
+
+    /**
+     * Close the socket
+     */
+    void stop();
+
+    bool is_running() const { return socket_ != -1; }
+    const std::string& get_station() const { return options_.station; }
+
+    /**
+     * Send one report (station and sequence are overwritten)
+     * @return false if the datagram could not be queued
+     */
+    bool send(fleet::Report& report);
+
+    uint64_t get_sent() const { return sent_.load(std::memory_order_relaxed); }
+
+private:
+    Options options_;
+    intptr_t socket_ = -1;
+    bool winsock_started_ = false;
+    std::array<uint32_t, 16> sequences_{};   // Next sequence per camera index
+    std::atomic<uint64_t> sent_{0};
+};
+
+} // namespace core
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/metrics.h"
+#include "video/frame_ref.h"
+
+namespace core {
+
+/**
+ * Always-on ring of recent per-frame stage timings, dumped on stalls
+ *
+ * An intermittent 200 ms hiccup is over before a profiler can be attached,
+ * and the latency histograms only say that it happened. The flight recorder
+ * keeps the last RING_RECORDS records in a fixed ring: every displayed and
+ * analyzed frame with its stage stamps (callback, extraction, store,
+ * consumption, upload, swap), the queue depth behind it, and frame drops.
+ * Recording is a handful of stores into a preallocated slot (a per-slot
+ * sequence number makes it lock-free for any number of writers); nothing
+ * is allocated or written to disk on the hot path.
+ *
+ * A watchdog thread dumps the ring when a frame's callback-to-done latency
+ * exceeds spike_ms, or when no frame arrives for gap_ms after frames were
+ * flowing. The dump waits post_trigger_ms so the recovery is in it too,
+ * covers the last window_s seconds, and goes to
+ * flight_<timestamp>_<reason>.csv in the dump directory, next to a copy of
+ * the run's configuration (.ini). Dumps are at least cooldown_s apart and
+ * at most max_dumps per run, so a stuck pipeline does not fill the disk.
+ *
+ * CSV columns: time_ms (relative to the trigger), kind (frame, analysis,
+ * drop), camera, source, frame_index, then the stage intervals in
+ * microseconds (extract, store, queue, upload, present, total; -1 = stage
+ * not reached; for analysis rows queue runs to the end of the analysis) and
+ * value/capacity (queue depth behind the frame, or frames dropped).
+ *
+ * **Usage:**
+ * ```cpp
+ * FlightRecorder::instance().start(options);
+ * FlightRecorder::instance().record_frame(timing, consumed_us, uploaded_us, swapped_us);  // Any thread
+ * FlightRecorder::instance().stop();
+ * ```
+ */
+class FlightRecorder {
+public:
+    static constexpr size_t RING_RECORDS = 65536;     // Power of two; 64 bytes each (4 MB), about a minute at 1 kHz
+
+    enum class Kind : uint8_t {
+        Frame,          // Displayed frame
+        Analysis,       // Frame through the scattering analysis
+        Drop            // Frames dropped by a queue
+    };
+
+    struct Options {
+        std::string directory = "flight";   // Dumps land here (created on the first dump)
+        std::string config_path;            // Copied next to each dump ("" = none)
+        int window_s = 10;                  // Seconds before the trigger in a dump
+        int spike_ms = 150;                 // Frame latency that triggers a dump (0 = off)
+        int gap_ms = 1000;                  // Frame-free time that triggers a dump (0 = off)
+        int post_trigger_ms = 500;          // Recording continues this long before the dump
+        int cooldown_s = 60;                // Minimum time between dumps
+        int max_dumps = 10;                 // Per run
+    };
+
+    static FlightRecorder& instance();
+
+    // Non-copyable
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    /**
+     * Start recording and the watchdog
+     */
+    void start(const Options& options);
+
+    /**
+     * Stop the watchdog (a pending dump is written first)
+     */
+    void stop();
+
+    bool is_running() const { return running_.load(std::memory_order_relaxed); }
+
+    /**
+     * Record a displayed frame (any thread; ignored while stopped)
+     * @param timing Producer stamps carried with the frame
+     * @param consumed_us Display loop took the frame
+     * @param uploaded_us Upload finished (0 = pending)
+     * @param swapped_us Buffer swap returned (0 = unknown)
+     */
+    void record_frame(const video::FrameTiming& timing, int64_t consumed_us, int64_t uploaded_us, int64_t swapped_us);
+
+    /**
+     * Record a frame through analysis (any thread; ignored while stopped)
+     * @param timing Producer stamps carried with the frame
+     * @param camera Camera index
+     * @param done_us Analysis finished
+     * @param backlog Frames still queued for the analysis
+     * @param capacity Queue capacity
+     */
+    void record_analysis(const video::FrameTiming& timing, int camera, int64_t done_us,
+                         size_t backlog, size_t capacity);
+
+    /**
+     * Record frames dropped by a queue (any thread; ignored while stopped)
+     * @param source Source id from source_id()
+     * @param count Frames dropped
+     */
+    void record_drop(uint16_t source, int64_t count);
+
+    /**
+     * Id of a named record source (registered on first use; cache the result)
+     */
+    uint16_t source_id(const std::string& name);
+
+    /**
+     * Request a dump now (any thread; subject to cooldown and max_dumps)
+     * @param reason Short tag for the file name, e.g. "manual"
+     */
+    void trigger(const std::string& reason);
+
+    int get_dumps() const { return dumps_.load(std::memory_order_relaxed); }
+
+    size_t get_ring_bytes() const { return RING_RECORDS * sizeof(Slot); }
+
+    /**
+     * CSV written by the latest dump ("" = none yet)
+     */
+    std::string get_last_dump() const;
+
+private:
+    struct Record {
+        int64_t host_us = 0;                // Callback (frames) or event time
+        int64_t frame_index = -1;
+        std::array<int32_t, 5> stage_us{};  // Extract, store, queue, upload, present (-1 = not reached)
+        int32_t total_us = -1;
+        uint32_t value = 0;
+        uint32_t capacity = 0;
+        uint16_t source = 0;
+        uint8_t camera = 0;
+        Kind kind = Kind::Frame;
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};  // 2 * n + 2 once record n is complete, odd while written
+        Record record;
+    };
+
+    FlightRecorder();
+    ~FlightRecorder();
+
+    void write(const Record& record);
+    void check_latency(int32_t total_us);
+    void watchdog_loop();
+    void dump(const std::string& reason, int64_t trigger_us);
+
+    std::unique_ptr<Slot[]> ring_;
+    std::atomic<uint64_t> head_{0};
+
+    Options options_;
+    std::string config_text_;
+    std::atomic<bool> running_{false};
+    std::thread watchdog_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+
+    // Trigger state (a pending trigger is dumped by the watchdog)
+    std::atomic<bool> pending_{false};      // Checked first, so a sustained spike costs no lock
+    mutable std::mutex trigger_mutex_;     // Also guards last_dump_
+    std::string pending_reason_;
+    int64_t pending_us_ = 0;
+    std::atomic<int64_t> last_frame_us_{0};
+    bool gap_reported_ = false;             // Watchdog only
+    int64_t last_dump_us_ = 0;              // Watchdog only
+    std::atomic<int> dumps_{0};
+    std::string last_dump_;
+
+    std::mutex sources_mutex_;
+    std::vector<std::string> sources_;
+
+    Counter& dumps_metric_;
+    Counter& triggers_metric_;
+};
+
+} // namespace core
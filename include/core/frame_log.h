@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace core {
+
+/**
+ * Metadata of one generated frame (-1 = not counted)
+ */
+struct FrameRecord {
+    int64_t camera_ts = 0;          // Sensor timestamp (end of accumulation, us)
+    int64_t host_us = 0;            // Host time of the frame (camera_ts mapped, else callback time)
+    int32_t window_us = -1;         // Span the frame covers
+    int32_t events = -1;
+    int32_t on_events = -1;
+    int32_t off_events = -1;
+    int32_t active_pixels = -1;
+    int32_t scattering_pixels = -1; // Latest scattering analysis result when the frame was stored
+    int32_t latency_us = -1;        // Sensor time to frame buffer (needs a clock mapping)
+};
+
+/**
+ * Fixed-capacity struct-of-arrays history of the newest frames of one camera
+ *
+ * Charts, status panels and triggers used to derive their own history from
+ * cumulative counters polled once per UI frame. The frame producer appends
+ * one FrameRecord per frame instead, and readers copy whole columns:
+ * each column is a contiguous array, so a query over the last N frames
+ * (percentiles, sums, threshold counts) is a linear scan compilers vectorize,
+ * not a walk over structs.
+ *
+ * Like EventRateChart's rings, row n is stored at n % capacity and
+ * n % capacity + capacity, so the newest rows of a column are contiguous and
+ * copied with one memcpy.
+ *
+ * **Threading:** exactly one writer (the camera's accumulation thread) calls
+ * append(). Rows are published with a release store of the row count;
+ * readers copy, then check how far the writer has started overwriting
+ * (seqlock style, as TrendSeries) and drop rows it may have recycled
+ * meanwhile. Neither side ever blocks or allocates after construction.
+ *
+ * **Usage:**
+ * ```cpp
+ * log.append(record);                                  // Camera thread
+ * FrameLog::Snapshot recent;
+ * log.read(recent, 1000);                              // Any thread
+ * auto events = FrameLog::summarize(recent.column(FrameLog::Events), scratch);
+ * ```
+ */
+class FrameLog {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 8192;   // ~8 s at 1000 fps
+
+    /**
+     * 32-bit columns
+     */
+    enum Column {
+        WindowUs = 0,
+        Events,
+        OnEvents,
+        OffEvents,
+        ActivePixels,
+        ScatteringPixels,
+        LatencyUs,
+        COLUMN_COUNT
+    };
+
+    /**
+     * Copy of the newest rows, oldest first (keeps its capacity between reads)
+     */
+    struct Snapshot {
+        uint64_t first = 0;                  // Row number of index 0 (frames appended before it)
+        std::vector<int64_t> camera_ts;
+        std::vector<int64_t> host_us;
+        std::array<std::vector<int32_t>, COLUMN_COUNT> columns;
+
+        size_t size() const { return camera_ts.size(); }
+        bool empty() const { return camera_ts.empty(); }
+        const std::vector<int32_t>& column(Column c) const { return columns[c]; }
+    };
+
+    /**
+     * Counted values of one column (rows holding -1 are skipped)
+     */
+    struct Summary {
+        size_t count = 0;
+        int32_t min = 0;
+        int32_t max = 0;
+        double mean = 0.0;
+        int32_t p50 = 0;
+        int32_t p99 = 0;
+    };
+
+    /**
+     * @param capacity Rows kept (rounded up to a power of two)
+     */
+    explicit FrameLog(size_t capacity = DEFAULT_CAPACITY);
+
+    // Non-copyable
+    FrameLog(const FrameLog&) = delete;
+    FrameLog& operator=(const FrameLog&) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * Frames appended since construction or clear()
+     */
+    uint64_t written() const { return published_.load(std::memory_order_acquire); }
+
+    /**
+     * Append a frame (writer thread only, O(1))
+     */
+    void append(const FrameRecord& record);
+
+    /**
+     * Forget every row (writer thread, or while no writer runs)
+     */
+    void clear();
+
+    /**
+     * Copy the newest rows (any thread)
+     * @param snapshot Output
+     * @param max_rows Upper bound on rows returned (0 = whole log)
+     * @return Rows copied
+     */
+    size_t read(Snapshot& snapshot, size_t max_rows = 0) const;
+
+    /**
+     * Copy the newest rows of one column (any thread)
+     * @return Row number of values.front()
+     */
+    uint64_t read_column(Column column, std::vector<int32_t>& values, size_t max_rows = 0) const;
+
+    /**
+     * Min, max, mean and percentiles of a column's counted values
+     * @param scratch Reused for the percentile selection
+     */
+    static Summary summarize(const std::vector<int32_t>& values, std::vector<int32_t>& scratch);
+
+    /**
+     * Rows whose value exceeds a threshold (-1 rows never do)
+     */
+    static size_t count_above(const std::vector<int32_t>& values, int32_t threshold);
+
+private:
+    /**
+     * Rows at the front of a copy of [first, first + count) that the writer may have recycled
+     */
+    size_t stale_rows(uint64_t first, size_t count) const;
+
+    size_t capacity_;
+    size_t mask_;
+
+    // Every column holds 2 * capacity_ values (mirrored, see class comment)
+    std::unique_ptr<int64_t[]> camera_ts_;
+    std::unique_ptr<int64_t[]> host_us_;
+    std::array<std::unique_ptr<int32_t[]>, COLUMN_COUNT> columns_;
+
+    std::atomic<uint64_t> published_{0};   // Rows completed
+    std::atomic<uint64_t> writing_{0};     // Rows written or being written (>= published_)
+};
+
+} // namespace core
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace core {
+
+/**
+ * Steady-state genetic algorithm over integer parameters
+ *
+ * Built for camera-in-the-loop tuning, where every evaluation costs a
+ * hardware settle plus a capture and results arrive one at a time and
+ * late. There is no generation barrier: propose() breeds a child from the
+ * members scored so far (tournament selection, uniform crossover, Gaussian
+ * mutation scaled to each gene's range) and report() inserts the child's
+ * fitness, replacing the worst member once the population is full. A
+ * caller may therefore keep proposing while earlier candidates are still
+ * being measured. A "generation" is population_size evaluations.
+ *
+ * The first population_size proposals are the seed genome followed by
+ * random genomes. The whole state (population, best, counters and RNG)
+ * round-trips through save()/load(), so an interrupted run resumes where
+ * it stopped; candidates in flight at save time are simply re-proposed.
+ *
+ * Not thread-safe; fitness is maximized.
+ */
+class GeneticOptimizer {
+public:
+    struct Gene {
+        std::string name;
+        int min_value = 0;
+        int max_value = 0;
+    };
+
+    struct Settings {
+        int population_size = 12;
+        int generations = 10;           // Evaluation budget = population_size * generations
+        double crossover_rate = 0.7;    // Probability a child mixes two parents
+        double mutation_rate = 0.2;     // Per-gene mutation probability
+        double mutation_scale = 0.1;    // Mutation sigma as a fraction of the gene range
+        int tournament_size = 3;
+        uint32_t seed = 0;              // 0 = seed from the clock
+    };
+
+    struct Candidate {
+        int id = -1;                    // Proposal number, unique for the run
+        std::vector<int> values;        // One per gene
+    };
+
+    struct Member {
+        std::vector<int> values;
+        double fitness = 0.0;
+        int id = -1;
+    };
+
+    GeneticOptimizer() = default;
+
+    /**
+     * Start a fresh run
+     * @param settings Population and operator settings
+     * @param genes Parameters to optimize, in genome order
+     * @param seed_values Starting genome (clamped; empty = random)
+     * @return false if there are no genes or a gene's range is empty
+     */
+    bool reset(const Settings& settings, const std::vector<Gene>& genes, const std::vector<int>& seed_values);
+
+    /**
+     * Next genome to evaluate
+     * @param candidate Output
+     * @return false once the evaluation budget has been proposed
+     */
+    bool propose(Candidate& candidate);
+
+    /**
+     * Record the fitness of a proposed candidate
+     * @return true if it became the best so far
+     */
+    bool report(const Candidate& candidate, double fitness);
+
+    /**
+     * Write the run state to a text checkpoint (via a temporary file, so a
+     * crash mid-write keeps the previous checkpoint)
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * Restore a run written by save(); the genes must match reset()'s
+     * @return false if the file is missing, malformed or for other genes
+     */
+    bool load(const std::string& path);
+
+    int get_evaluations() const { return evaluations_; }
+    int get_budget() const { return settings_.population_size * settings_.generations; }
+    int get_generation() const { return evaluations_ / settings_.population_size; }
+    bool has_best() const { return best_.id >= 0; }
+    const Member& get_best() const { return best_; }
+    const std::vector<Member>& get_population() const { return population_; }
+    const std::vector<Gene>& get_genes() const { return genes_; }
+    const Settings& settings() const { return settings_; }
+
+private:
+    int clamp_gene(size_t gene, int64_t value) const;
+    const Member& tournament();
+    std::vector<int> random_genome();
+
+    Settings settings_;
+    std::vector<Gene> genes_;
+    std::vector<int> seed_values_;
+    std::vector<Member> population_;    // Scored members, at most population_size
+    Member best_;
+    int proposed_ = 0;
+    int evaluations_ = 0;
+    std::mt19937 rng_;
+};
+
+} // namespace core
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "core/metrics.h"
+#include "video/frame_ref.h"
+
+namespace core {
+
+/**
+ * End-to-end display latency: camera timestamp to swap ("photon on screen")
+ *
+ * Each displayed frame contributes one sample per stage. Producer stages
+ * travel with the frame (video::FrameTiming); consume, upload and swap are
+ * stamped on the UI thread. Samples go into "latency.*" histograms of the
+ * MetricsRegistry (log-linear buckets, ~6% resolution), so percentiles cost
+ * O(1) memory no matter how long the session runs and exporters see them
+ * alongside every other metric.
+ *
+ * Sensor and host clocks are unrelated. Frames from a live camera carry
+ * their timestamp mapped onto the host clock (FrameTiming::camera_host_us,
+ * see core::ClockSync), which follows clock drift; other frames fall back
+ * to the smallest host-minus-sensor offset seen so far. Either way the
+ * event stage shows how much later than the fastest delivery each frame
+ * arrived, not the absolute USB/driver transport time.
+ *
+ * record() and reset() belong to the UI thread (they own the clock offset);
+ * reading is safe from anywhere.
+ */
+class LatencyStats {
+public:
+    enum class Stage {
+        EventToCallback,     // Window end -> frame generator callback (relative, see above)
+        Extract,             // Callback -> binary extraction done
+        Store,               // Extraction done -> handed to the frame buffer
+        Queue,               // Stored -> consumed by the display loop
+        Upload,              // Consumed -> texture upload / GPU processing done
+        Present,             // Upload done -> buffer swap returned (GPU finished, in low-latency mode)
+        HostTotal,           // Callback -> swap
+        Total,               // Last event -> swap
+        COUNT
+    };
+
+    static constexpr int STAGE_COUNT = static_cast<int>(Stage::COUNT);
+
+    struct Summary {
+        uint64_t count = 0;
+        double mean_us = 0.0;
+        int64_t p50_us = 0;
+        int64_t p95_us = 0;
+        int64_t p99_us = 0;
+        int64_t max_us = 0;
+    };
+
+    LatencyStats();
+    ~LatencyStats() = default;
+
+    // Non-copyable
+    LatencyStats(const LatencyStats&) = delete;
+    LatencyStats& operator=(const LatencyStats&) = delete;
+
+    /**
+     * Steady-clock time for stage stamps
+     * @return Microseconds since an arbitrary epoch
+     */
+    static int64_t now_us();
+
+    /**
+     * Short stage label for UI and CSV
+     */
+    static const char* stage_name(Stage stage);
+
+    /**
+     * Record one displayed frame
+     * @param timing Producer stamps carried with the frame
+     * @param consumed_us Display loop took the frame
+     * @param uploaded_us Upload (or GPU processing) finished
+     * @param swapped_us Buffer swap returned
+     */
+    void record(const video::FrameTiming& timing, int64_t consumed_us, int64_t uploaded_us, int64_t swapped_us);
+
+    /**
+     * Count, mean, p50/p95/p99 and max for one stage
+     */
+    Summary summary(Stage stage) const;
+
+    /**
+     * Occupied bucket range of one stage, for plotting
+     * @param stage Stage
+     * @param counts Output bucket counts (lowest to highest occupied bucket)
+     * @param low_us Lower edge of the first bucket
+     * @param high_us Upper edge of the last bucket
+     */
+    void get_histogram(Stage stage, std::vector<float>& counts, int64_t& low_us, int64_t& high_us) const;
+
+    /**
+     * Registry name of a stage's histogram (e.g. "latency.extract_us")
+     */
+    static const char* metric_name(Stage stage);
+
+    /**
+     * Frames recorded since the last reset
+     */
+    uint64_t get_frames() const { return frames_; }
+
+    /**
+     * Clear all histograms and the clock offset
+     */
+    void reset();
+
+    /**
+     * Write one row per stage: count, mean and percentiles (us)
+     * @param path Output file
+     * @return true if written
+     */
+    bool export_csv(const std::string& path) const;
+
+    /**
+     * Write every occupied bucket: stage, bucket edges (us), count
+     * @param path Output file
+     * @return true if written
+     */
+    bool export_histogram_csv(const std::string& path) const;
+
+private:
+    Histogram& histogram(Stage stage) const { return *histograms_[static_cast<int>(stage)]; }
+
+    std::array<Histogram*, STAGE_COUNT> histograms_{};   // Owned by MetricsRegistry
+    int64_t min_clock_offset_us_ = 0;
+    bool have_clock_offset_ = false;
+    uint64_t frames_ = 0;
+};
+
+} // namespace core
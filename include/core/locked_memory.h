@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include "core/metrics.h"
+
+namespace cv {
+class MatAllocator;
+}
+
+namespace core {
+
+/**
+ * Page-locked (and, where possible, large-page) memory for hot-path buffers
+ *
+ * The event rings and frame pools are touched on every batch and frame.
+ * After the station has been idle, Windows trims the working set and the
+ * first minute of a run takes a storm of soft page faults on exactly these
+ * buffers, which shows up as dropped batches. Buffers allocated here are
+ * never trimmed:
+ *
+ * - Blocks of at least one large page come from large pages (2 MB on x64;
+ *   MEM_LARGE_PAGES, or MAP_HUGETLB on Linux), which are never paged out
+ *   and need far fewer TLB entries. Needs the "Lock pages in memory"
+ *   privilege (SeLockMemoryPrivilege), enabled on first use.
+ * - Otherwise blocks are committed and locked (VirtualLock, growing the
+ *   process working-set minimum as needed; mlock on Linux).
+ * - Without the privilege or quota, blocks are committed and touched once,
+ *   so at least startup does not fault. Fallbacks are logged and counted.
+ *
+ * Blocks under MIN_LOCKED_BYTES, or everything while disabled, come from
+ * the ordinary heap. Allocations are rare (pool configure, ring warm-up),
+ * so each block is tracked in a map under a mutex.
+ *
+ * Published as memory.locked_mb and memory.large_page_mb.
+ *
+ * **Usage:**
+ * ```cpp
+ * LockedMemory::instance().configure(options);          // Before the pipeline allocates
+ * std::vector<EventCD, LockedAllocator<EventCD>> batch;  // STL containers
+ * mat.allocator = LockedMemory::instance().mat_allocator(); mat.create(size, type);  // cv::Mat
+ * ```
+ */
+class LockedMemory {
+public:
+    static constexpr size_t MIN_LOCKED_BYTES = 4096;
+
+    struct Options {
+        bool lock = true;           // false = ordinary heap for everything
+        bool large_pages = true;    // Try large pages for blocks of one large page or more
+    };
+
+    struct Stats {
+        size_t locked_bytes = 0;        // Locked, small pages
+        size_t large_page_bytes = 0;    // Large pages (always resident)
+        size_t pageable_bytes = 0;      // Wanted locking, got pageable memory
+        int64_t fallbacks = 0;          // Blocks that got less than asked for
+    };
+
+    static LockedMemory& instance();
+
+    // Non-copyable
+    LockedMemory(const LockedMemory&) = delete;
+    LockedMemory& operator=(const LockedMemory&) = delete;
+
+    /**
+     * Set the policy for later allocations (blocks already handed out keep theirs)
+     */
+    void configure(const Options& options);
+
+    /**
+     * Allocate a block (page-aligned unless it came from the heap)
+     * @throws std::bad_alloc if no memory at all is available
+     */
+    void* allocate(size_t bytes);
+
+    /**
+     * Free a block from allocate() (nullptr is ignored)
+     */
+    void release(void* block);
+
+    /**
+     * OpenCV allocator whose buffers come from allocate() (lives until exit)
+     */
+    cv::MatAllocator* mat_allocator();
+
+    Stats get_stats() const;
+
+private:
+    enum class Kind : uint8_t {
+        Heap,
+        Pageable,
+        Locked,
+        LargePage
+    };
+
+    struct Block {
+        size_t bytes = 0;   // Mapped size (rounded to the page size)
+        Kind kind = Kind::Heap;
+    };
+
+    LockedMemory();
+    ~LockedMemory() = default;
+
+    void* map_large(size_t bytes, size_t& mapped);
+    void* map_locked(size_t bytes, size_t& mapped, bool& locked);
+    void unmap(void* block, const Block& info);
+    void note_fallback(const char* what, const char* instead);
+    void publish();   // mutex_ held
+
+    std::atomic<bool> lock_{true};
+    std::atomic<bool> large_pages_{true};
+
+    mutable std::mutex mutex_;
+    std::unordered_map<void*, Block> blocks_;
+    Stats stats_;
+    bool large_pages_failed_ = false;   // Privilege or pages missing; not tried again
+
+    Gauge& locked_metric_;
+    Gauge& large_page_metric_;
+};
+
+/**
+ * STL allocator over LockedMemory
+ */
+template <typename T>
+struct LockedAllocator {
+    using value_type = T;
+
+    LockedAllocator() noexcept = default;
+    template <typename U>
+    LockedAllocator(const LockedAllocator<U>&) noexcept {}
+
+    T* allocate(size_t count) { return static_cast<T*>(LockedMemory::instance().allocate(count * sizeof(T))); }
+    void deallocate(T* block, size_t) noexcept { LockedMemory::instance().release(block); }
+};
+
+template <typename T, typename U>
+bool operator==(const LockedAllocator<T>&, const LockedAllocator<U>&) { return true; }
+
+template <typename T, typename U>
+bool operator!=(const LockedAllocator<T>&, const LockedAllocator<U>&) { return false; }
+
+} // namespace core
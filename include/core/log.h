@@ -0,0 +1,192 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace core {
+
+enum class LogLevel {
+    Debug = 0,      // Only with RuntimeSettings::debug_mode
+    Info = 1,       // stdout
+    Warning = 2,    // stderr
+    Error = 3       // stderr
+};
+
+/**
+ * Per-call-site rate limit, declared static next to the log line:
+ *
+ * ```
+ * static core::LogSite site(1000);
+ * core::LogLine(core::LogLevel::Warning, &site) << "Ring full, batch dropped";
+ * ```
+ *
+ * At most one line per interval gets through; the next one that does
+ * reports how many were suppressed in between.
+ */
+class LogSite {
+public:
+    explicit LogSite(int interval_ms) : interval_us_(static_cast<int64_t>(interval_ms) * 1000) {}
+
+    // Non-copyable
+    LogSite(const LogSite&) = delete;
+    LogSite& operator=(const LogSite&) = delete;
+
+    /**
+     * Claim the site for one line (lock-free)
+     * @param suppressed Set to the lines dropped since the last one allowed
+     * @return false if the last allowed line is less than one interval old
+     */
+    bool allow(uint32_t& suppressed);
+
+private:
+    const int64_t interval_us_;
+    std::atomic<int64_t> next_us_{0};
+    std::atomic<uint32_t> suppressed_{0};
+};
+
+/**
+ * Asynchronous console logger for hot and warm paths
+ *
+ * Each thread writes finished lines into its own fixed-size ring (no lock,
+ * no allocation after the first line); a background thread drains every
+ * ring and writes to std::cout / std::cerr. A full ring drops the line and
+ * counts it, so a logging thread never waits on the console.
+ *
+ * Until start() (and after stop()) lines are written synchronously, so
+ * tools that never start the logger still print.
+ */
+class Log {
+public:
+    static constexpr size_t LINE_CAPACITY = 240;   // Longer lines are truncated
+    static constexpr size_t RING_LINES = 256;      // Per thread, power of two
+
+    static Log& instance() {
+        static Log instance;
+        return instance;
+    }
+
+    // Non-copyable
+    Log(const Log&) = delete;
+    Log& operator=(const Log&) = delete;
+
+    /**
+     * Start the flush thread
+     * @param min_level Lines below this level are discarded at the call site
+     * @param flush_interval_ms Longest time a line waits in its ring
+     */
+    void start(LogLevel min_level, int flush_interval_ms = 20);
+
+    /**
+     * Flush everything queued and stop the flush thread (back to synchronous writes)
+     */
+    void stop();
+
+    bool is_running() const { return running_.load(std::memory_order_relaxed); }
+
+    void set_min_level(LogLevel level) { min_level_.store(static_cast<int>(level), std::memory_order_relaxed); }
+    bool is_enabled(LogLevel level) const {
+        return static_cast<int>(level) >= min_level_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Queue a finished line (called by LogLine)
+     */
+    void write(LogLevel level, const char* text, size_t length);
+
+    // Statistics
+    int64_t get_lines_dropped() const { return lines_dropped_.load(); }  // Rings were full
+
+private:
+    struct Line {
+        LogLevel level;
+        uint16_t length;
+        int64_t queued_us;
+        char text[LINE_CAPACITY];
+    };
+
+    // Single producer (owning thread), single consumer (flush thread)
+    struct Ring {
+        Line lines[RING_LINES];
+        alignas(64) std::atomic<size_t> head{0};  // Next slot to write
+        alignas(64) std::atomic<size_t> tail{0};  // Next slot to read
+    };
+
+    Log() = default;
+    ~Log();
+
+    Ring& thread_ring();
+    void flush_loop(int flush_interval_ms);
+    void flush_rings();
+    static void write_console(LogLevel level, const char* text, size_t length);
+
+    std::atomic<int> min_level_{static_cast<int>(LogLevel::Info)};
+    std::atomic<bool> running_{false};
+    std::atomic<int64_t> lines_dropped_{0};
+
+    std::mutex rings_mutex_;                      // Ring registration and flushing
+    std::vector<std::shared_ptr<Ring>> rings_;    // Also kept by the owning thread
+
+    std::thread thread_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stop_requested_ = false;
+};
+
+/**
+ * One log line, queued when it goes out of scope:
+ *
+ * ```
+ * core::LogLine(core::LogLevel::Error) << "Write failed: " << path;
+ * ```
+ *
+ * Formats into a fixed buffer on the stack. Disabled, rate-limited lines
+ * skip every operator<<.
+ */
+class LogLine {
+public:
+    explicit LogLine(LogLevel level, LogSite* site = nullptr);
+    ~LogLine();
+
+    // Non-copyable
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    LogLine& operator<<(const char* text);
+    LogLine& operator<<(const std::string& text) { append(text.data(), text.size()); return *this; }
+    LogLine& operator<<(char c) { append(&c, 1); return *this; }
+    LogLine& operator<<(bool value) { return *this << (value ? "true" : "false"); }
+    LogLine& operator<<(double value);
+    LogLine& operator<<(float value) { return *this << static_cast<double>(value); }
+
+    template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
+    LogLine& operator<<(T value) {
+        if (active_) {
+            if (std::is_signed<T>::value) {
+                append_signed(static_cast<long long>(value));
+            } else {
+                append_unsigned(static_cast<unsigned long long>(value));
+            }
+        }
+        return *this;
+    }
+
+private:
+    void append(const char* text, size_t length);
+    void append_signed(long long value);
+    void append_unsigned(unsigned long long value);
+
+    LogLevel level_;
+    bool active_;
+    uint32_t suppressed_ = 0;
+    size_t length_ = 0;
+    char buffer_[Log::LINE_CAPACITY];
+};
+
+} // namespace core
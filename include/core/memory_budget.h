@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "core/metrics.h"
+
+namespace core {
+
+/**
+ * One memory budget across the pools, caches and rings of the process
+ *
+ * Each buffer owner sized itself (image_cache_mb, burst_max_mb, pool
+ * slots, ...), so together they could outgrow the station's RAM, and an
+ * unattended multi-day run that starts paging misses frames. Owners now
+ * register a usage callback and, if they can give memory back, a shrink
+ * callback, in one of three tiers:
+ *
+ * - Cache: entries that can be decoded again; shrunk first, least
+ *   recently used entries first within each cache
+ * - History: rings that hold past data nobody is waiting on (e.g. an idle
+ *   burst ring); shrunk next
+ * - Critical: memory the live pipeline needs (frame pools, the flight
+ *   recorder); counted, never shrunk
+ *
+ * rebalance() sums the usage; over the budget it shrinks Cache, then
+ * History consumers down to the low watermark (LOW_WATERMARK_PERCENT of
+ * the budget). If that is not enough, backpressure holds until usage is
+ * back under the low watermark: non-critical producers (prefetch, arming a
+ * burst by hand, ...) call admit() first and do not start while it returns
+ * false.
+ *
+ * Published as memory.budget_mb, memory.used_mb, memory.<consumer>_mb and
+ * memory.backpressure; bytes given back are counted in
+ * memory.evicted_bytes, refused producers in memory.refused.
+ *
+ * **Usage:**
+ * ```cpp
+ * budget.register_consumer("image_cache", MemoryBudget::Tier::Cache,
+ *                          [] { return cache.bytes(); }, [](size_t bytes) { return cache.shrink(bytes); });
+ * budget.rebalance();                                  // Main loop, about once a second
+ * if (MemoryBudget::instance().admit()) { prefetch(); } // Any thread
+ * ```
+ */
+class MemoryBudget {
+public:
+    static constexpr int LOW_WATERMARK_PERCENT = 90;
+
+    enum class Tier {
+        Cache,
+        History,
+        Critical
+    };
+
+    /**
+     * One consumer's share, as of the last rebalance()
+     */
+    struct Usage {
+        std::string name;
+        Tier tier = Tier::Critical;
+        size_t bytes = 0;
+    };
+
+    using UsageFn = std::function<size_t()>;
+    using ShrinkFn = std::function<size_t(size_t)>;   // Bytes wanted back -> bytes actually freed
+
+    static MemoryBudget& instance();
+
+    // Non-copyable
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    /**
+     * Set the budget (0 = usage is reported but never enforced)
+     */
+    void configure(size_t budget_bytes);
+
+    size_t get_budget() const { return budget_.load(std::memory_order_relaxed); }
+
+    /**
+     * Add a consumer (shrink = nullptr for memory that cannot be given back)
+     * Callbacks run on the thread calling rebalance() and must be thread-safe
+     * against the consumer's own threads.
+     */
+    void register_consumer(const std::string& name, Tier tier, UsageFn usage, ShrinkFn shrink = nullptr);
+
+    /**
+     * Measure, shrink over the budget and update backpressure (one thread)
+     */
+    void rebalance();
+
+    /**
+     * Whether a non-critical producer may start (any thread; counts the refusal if not)
+     */
+    bool admit();
+
+    bool is_backpressured() const { return backpressure_.load(std::memory_order_relaxed); }
+
+    /**
+     * Total usage and per-consumer breakdown as of the last rebalance()
+     */
+    size_t get_used() const { return used_.load(std::memory_order_relaxed); }
+    std::vector<Usage> get_breakdown() const;
+
+    uint64_t get_evicted_bytes() const { return evicted_.load(std::memory_order_relaxed); }
+    uint64_t get_refused() const { return refused_.load(std::memory_order_relaxed); }
+
+    static const char* tier_name(Tier tier);
+
+private:
+    struct Consumer {
+        std::string name;
+        Tier tier = Tier::Critical;
+        UsageFn usage;
+        ShrinkFn shrink;
+        Gauge* gauge = nullptr;
+        size_t bytes = 0;
+    };
+
+    MemoryBudget();
+    ~MemoryBudget() = default;
+
+    size_t measure();   // consumers_mutex_ held
+
+    mutable std::mutex consumers_mutex_;
+    std::vector<Consumer> consumers_;
+
+    std::atomic<size_t> budget_{0};
+    std::atomic<size_t> used_{0};
+    std::atomic<bool> backpressure_{false};
+    std::atomic<uint64_t> evicted_{0};
+    std::atomic<uint64_t> refused_{0};
+
+    Gauge& budget_metric_;
+    Gauge& used_metric_;
+    Gauge& backpressure_metric_;
+    Counter& evicted_metric_;
+    Counter& refused_metric_;
+};
+
+} // namespace core
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace core {
+
+/**
+ * Log-linear bucket layout shared by all latency histograms
+ *
+ * Exact below 16, then 16 sub-buckets per power of two (~6% resolution).
+ * Values past 2^35 (~9.5 h in microseconds) land in the last bucket.
+ */
+namespace log_buckets {
+    constexpr int SUB_BITS = 4;
+    constexpr int SUB_COUNT = 1 << SUB_BITS;
+    constexpr int MAX_MSB = 35;
+    constexpr int COUNT = (MAX_MSB - SUB_BITS + 2) * SUB_COUNT;
+
+    int index(int64_t value);
+    int64_t low(int index);         // Inclusive lower edge
+    int64_t high(int index);        // Exclusive upper edge
+}
+
+/**
+ * Thread index used to pick a shard (assigned round-robin on first use)
+ */
+int metrics_shard();
+
+/**
+ * Monotonic counter sharded across threads
+ *
+ * add() is one relaxed fetch_add on a cache line owned (mostly) by the
+ * calling thread, so hot callbacks never contend; value() sums the shards.
+ */
+class Counter {
+public:
+    static constexpr int SHARD_COUNT = 16;
+
+    Counter() = default;
+
+    // Non-copyable
+    Counter(const Counter&) = delete;
+    Counter& operator=(const Counter&) = delete;
+
+    void add(int64_t n = 1) {
+        shards_[metrics_shard() % SHARD_COUNT].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    int64_t value() const;
+    void reset();
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<int64_t> value{0};
+    };
+    std::array<Shard, SHARD_COUNT> shards_;
+};
+
+/**
+ * Last-value metric (temperature, SNR, ...), one relaxed atomic store
+ */
+class Gauge {
+public:
+    Gauge() = default;
+
+    // Non-copyable
+    Gauge(const Gauge&) = delete;
+    Gauge& operator=(const Gauge&) = delete;
+
+    void set(double value) { value_.store(value, std::memory_order_relaxed); }
+    double value() const { return value_.load(std::memory_order_relaxed); }
+    bool has_value() const { return !std::isnan(value()); }
+    void reset() { value_.store(std::numeric_limits<double>::quiet_NaN(), std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value_{std::numeric_limits<double>::quiet_NaN()};  // NaN = never set
+};
+
+/**
+ * Fixed-bucket log-linear histogram, lock-free to record
+ *
+ * Each shard holds its own buckets, count, sum and max; record() touches
+ * two or three relaxed atomics of the caller's shard. Snapshots merge the
+ * shards and may be a few samples behind concurrent writers.
+ */
+class Histogram {
+public:
+    static constexpr int SHARD_COUNT = 4;
+
+    struct Snapshot {
+        std::array<uint64_t, log_buckets::COUNT> buckets{};
+        uint64_t count = 0;
+        int64_t sum = 0;
+        int64_t max = 0;
+
+        double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+
+        /**
+         * Upper edge of the bucket holding the given rank (clamped to max)
+         * @param fraction 0.5 = median, 0.99 = p99
+         */
+        int64_t percentile(double fraction) const;
+    };
+
+    Histogram() = default;
+
+    // Non-copyable
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    /**
+     * Add one sample (negative values count as 0)
+     */
+    void record(int64_t value);
+
+    Snapshot snapshot() const;
+    void reset();
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, log_buckets::COUNT> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<int64_t> sum{0};
+        std::atomic<int64_t> max{0};
+    };
+    std::array<Shard, SHARD_COUNT> shards_;
+};
+
+/**
+ * Process-wide registry of named counters and histograms
+ *
+ * Looking a metric up takes a lock, so callers fetch the reference once
+ * (e.g. into a static or a member) and record through it afterwards.
+ * Metrics are never removed, so references stay valid for the process
+ * lifetime.
+ *
+ * **Usage:**
+ * ```cpp
+ * static Counter& events = MetricsRegistry::instance().counter("events.ingested");
+ * events.add(batch_size);
+ * ```
+ */
+class MetricsRegistry {
+public:
+    struct Snapshot {
+        std::vector<std::pair<std::string, int64_t>> counters;               // Sorted by name
+        std::vector<std::pair<std::string, double>> gauges;                  // Set gauges only, sorted by name
+        std::vector<std::pair<std::string, Histogram::Snapshot>> histograms; // Sorted by name
+    };
+
+    static MetricsRegistry& instance();
+
+    // Non-copyable
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /**
+     * Get (registering on first use) a counter
+     * @param name Dotted name, e.g. "frames.displayed"
+     */
+    Counter& counter(const std::string& name);
+
+    /**
+     * Get (registering on first use) a gauge
+     * @param name Dotted name with unit suffix, e.g. "camera.temperature_c"
+     */
+    Gauge& gauge(const std::string& name);
+
+    /**
+     * Get (registering on first use) a histogram
+     * @param name Dotted name with unit suffix, e.g. "stage.accumulate_us"
+     */
+    Histogram& histogram(const std::string& name);
+
+    /**
+     * Read every metric (for UI and exporters)
+     */
+    Snapshot snapshot() const;
+
+    /**
+     * Zero every metric
+     */
+    void reset();
+
+    /**
+     * Write a snapshot as CSV: name, type, count/value, mean, p50, p95, p99, max
+     * @param path Output file
+     * @return true if written
+     */
+    bool export_csv(const std::string& path) const;
+
+private:
+    MetricsRegistry() = default;
+
+    mutable std::mutex mutex_;   // Registration and snapshots only
+    std::map<std::string, std::unique_ptr<Counter>> counters_;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges_;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms_;
+};
+
+} // namespace core
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include "core/metrics.h"
+
+namespace core {
+
+/**
+ * Publishes the MetricsRegistry for unattended test stations
+ *
+ * One background thread either serves a Prometheus scrape endpoint
+ * (text exposition format, GET /metrics) or pushes StatsD lines over UDP
+ * at a fixed interval. It only ever reads registry snapshots, so the
+ * camera, accumulation and UI threads are never blocked or slowed beyond
+ * the snapshot's relaxed loads.
+ *
+ * Mapping:
+ *   counters   -> Prometheus counter <prefix>_<name>_total / StatsD |c (delta since last push)
+ *   gauges     -> Prometheus gauge / StatsD |g
+ *   histograms -> Prometheus summary (p50/p95/p99, _sum, _count) / StatsD |g per quantile
+ *
+ * **Usage:**
+ * ```cpp
+ * MetricsExporter exporter;
+ * exporter.start({MetricsExporter::Mode::Prometheus, 9464});
+ * exporter.stop();
+ * ```
+ */
+class MetricsExporter {
+public:
+    enum class Mode {
+        Off = 0,
+        Prometheus = 1,     // TCP scrape endpoint
+        StatsD = 2          // UDP push
+    };
+
+    struct Options {
+        Mode mode = Mode::Off;
+        int port = 9464;                        // Prometheus listen port (all interfaces)
+        std::string statsd_host = "127.0.0.1";  // StatsD server (IPv4 address)
+        int statsd_port = 8125;
+        int interval_ms = 1000;                 // StatsD push period
+        std::string prefix = "rtcam";           // Prepended to every metric name
+    };
+
+    MetricsExporter() = default;
+    ~MetricsExporter();
+
+    // Non-copyable
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    /**
+     * Open the socket and start the exporter thread
+     * @param options Mode and endpoint
+     * @return true if running (false for Mode::Off or socket errors)
+     */
+    bool start(const Options& options);
+
+    /**
+     * Stop the thread and close the socket
+     */
+    void stop();
+
+    bool is_running() const { return running_.load(); }
+
+    /**
+     * Scrapes served (Prometheus) or datagrams sent (StatsD)
+     */
+    uint64_t get_exports() const { return exports_.load(std::memory_order_relaxed); }
+
+    /**
+     * Render a snapshot in the Prometheus text exposition format
+     */
+    static std::string format_prometheus(const MetricsRegistry::Snapshot& snapshot, const std::string& prefix);
+
+private:
+    void prometheus_loop();
+    void statsd_loop();
+    void statsd_push(const MetricsRegistry::Snapshot& snapshot);
+
+    Options options_;
+    intptr_t socket_ = -1;
+    bool winsock_started_ = false;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> exports_{0};
+
+    // StatsD only: counter values at the previous push (counters go out as deltas)
+    std::map<std::string, int64_t> last_counters_;
+};
+
+} // namespace core
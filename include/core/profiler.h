@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Profiler zones, compiled in only with -DRTCAM_PROFILER=ON (CMake option):
+ *
+ * ```
+ * void FrameBuffer::store_frame(...) {
+ *     PROFILE_ZONE("FrameBuffer::store_frame");
+ *     ...
+ * }
+ * ```
+ *
+ * Zone names must be string literals (only the pointer is recorded).
+ * Without the option both macros expand to nothing, so zones cost nothing
+ * in release builds.
+ */
+#if RTCAM_PROFILER
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) core::ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#define PROFILE_THREAD(name) core::Profiler::instance().set_thread_name(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#endif
+
+namespace core {
+
+/**
+ * Per-thread zone timeline written as Chrome trace JSON
+ *
+ * Each thread records finished zones into its own fixed-size ring (no
+ * lock, no allocation after the first zone); a background thread drains
+ * every ring into the trace file. A full ring drops the zone and counts it,
+ * so a profiled thread never waits on the file. Open the file in
+ * chrome://tracing or https://ui.perfetto.dev to see the SDK, accumulation,
+ * analysis and UI threads side by side.
+ *
+ * Zones are only recorded between start() and stop().
+ */
+class Profiler {
+public:
+    static constexpr size_t RING_ZONES = 16384;   // Per thread, power of two
+
+    static Profiler& instance() {
+        static Profiler instance;
+        return instance;
+    }
+
+    // Non-copyable
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    /**
+     * Open the trace file and start the writer thread
+     * @return false if the file cannot be created
+     */
+    bool start(const std::string& path, int flush_interval_ms = 100);
+
+    /**
+     * Write everything queued, close the JSON and stop the writer thread
+     */
+    void stop();
+
+    bool is_running() const { return running_.load(std::memory_order_relaxed); }
+
+    /**
+     * Name the calling thread in the trace (any time; the latest name wins)
+     */
+    void set_thread_name(const std::string& name);
+
+    /**
+     * Queue a finished zone (called by ProfileZone)
+     */
+    void record(const char* name, int64_t begin_ns, int64_t end_ns);
+
+    static int64_t now_ns();
+
+    // Statistics
+    int64_t get_zones_written() const { return zones_written_.load(); }
+    int64_t get_zones_dropped() const { return zones_dropped_.load(); }  // Rings were full
+
+private:
+    struct Zone {
+        const char* name;
+        int64_t begin_ns;
+        int64_t end_ns;
+    };
+
+    // Single producer (owning thread), single consumer (writer thread)
+    struct Ring {
+        Zone zones[RING_ZONES];
+        uint32_t thread_id = 0;
+        std::mutex name_mutex;
+        std::string name;
+        bool name_written = false;                // Writer thread only
+        alignas(64) std::atomic<size_t> head{0};  // Next slot to write
+        alignas(64) std::atomic<size_t> tail{0};  // Next slot to read
+    };
+
+    Profiler() = default;
+    ~Profiler();
+
+    Ring& thread_ring();
+    void flush_loop(int flush_interval_ms);
+    void flush_rings();
+
+    std::atomic<bool> running_{false};
+    std::atomic<int64_t> zones_written_{0};
+    std::atomic<int64_t> zones_dropped_{0};
+    std::atomic<uint32_t> next_thread_id_{1};
+
+    std::mutex rings_mutex_;                      // Ring registration and flushing
+    std::vector<std::shared_ptr<Ring>> rings_;    // Also kept by the owning thread
+
+    std::FILE* file_ = nullptr;                   // Writer thread (or start/stop) only
+    bool first_event_ = true;
+    int64_t origin_ns_ = 0;                       // Trace timestamps start at start()
+
+    std::thread thread_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stop_requested_ = false;
+};
+
+/**
+ * RAII zone: recorded when it goes out of scope (use PROFILE_ZONE)
+ */
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name)
+        : name_(Profiler::instance().is_running() ? name : nullptr),
+          begin_ns_(name_ ? Profiler::now_ns() : 0) {
+    }
+
+    ~ProfileZone() {
+        if (name_) {
+            Profiler::instance().record(name_, begin_ns_, Profiler::now_ns());
+        }
+    }
+
+    // Non-copyable
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* name_;
+    int64_t begin_ns_;
+};
+
+} // namespace core
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "core/metrics.h"
+
+namespace core {
+
+/**
+ * Load shedding of deferrable analysis work under pressure
+ *
+ * Work falls into two priority classes. Critical work - counting
+ * scattering pixels, hot pixel tracking, recording and the statistics
+ * derived from them - never asks and always runs, so reliability figures
+ * stay complete under overload. Deferrable work - heatmap refresh,
+ * visualizations, chart updates, thumbnails - calls admit() first and is
+ * skipped when it returns false; each skip is counted as
+ * qos.shed.<work>.
+ *
+ * Producers report pressure from any thread: the latency of a frame at its
+ * consumer (camera callback to analysis or display) and the depth of a
+ * queue against its capacity. Crossing a threshold enters Decimate (one
+ * deferrable call in `decimation` admitted), crossing twice the threshold
+ * enters Skip (none admitted). A level is left only after `hold_ms`
+ * without being warranted, so the load does not oscillate around the
+ * threshold. Skipped work must leave its output consistent for the next
+ * admitted call (e.g. the heatmap rebuilds in full after a skip).
+ *
+ * **Usage:**
+ * ```cpp
+ * QosScheduler::instance().report_latency(now_us - timing.callback_us);
+ * if (QosScheduler::instance().admit(QosScheduler::Work::Heatmap)) { refresh_heatmap(); }
+ * ```
+ */
+class QosScheduler {
+public:
+    enum class Work {
+        Heatmap,            // Scattering heatmap refresh
+        Visualization,      // Rendered views (time surface)
+        Chart,              // UI chart updates
+        Thumbnail,          // Capture gallery decodes
+        COUNT
+    };
+    static constexpr int WORK_COUNT = static_cast<int>(Work::COUNT);
+
+    enum class Level {
+        Normal,
+        Decimate,
+        Skip
+    };
+
+    struct Options {
+        bool enabled = false;
+        int latency_ms = 100;       // Frame latency that starts shedding
+        int queue_percent = 50;     // Queue fill that starts shedding
+        int decimation = 4;         // Deferrable calls per admitted one while decimating
+        int hold_ms = 1000;         // Time without pressure before a level is left
+    };
+
+    static QosScheduler& instance();
+
+    // Non-copyable
+    QosScheduler(const QosScheduler&) = delete;
+    QosScheduler& operator=(const QosScheduler&) = delete;
+
+    /**
+     * Set thresholds (any time; takes effect with the next report)
+     */
+    void configure(const Options& options);
+
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Report the latency of a frame at its consumer (any thread)
+     * @param latency_us Camera callback to consumption
+     */
+    void report_latency(int64_t latency_us);
+
+    /**
+     * Report the fill of a queue (any thread)
+     * @param depth Items waiting
+     * @param capacity Items the queue holds (0 = ignored)
+     */
+    void report_queue(size_t depth, size_t capacity);
+
+    /**
+     * Decide whether a deferrable call runs (any thread; counts the skip if not)
+     */
+    bool admit(Work work);
+
+    /**
+     * Current level (Normal when disabled)
+     */
+    Level get_level() const;
+
+    /**
+     * Calls skipped since start
+     */
+    uint64_t get_shed(Work work) const { return shed_[static_cast<int>(work)].load(std::memory_order_relaxed); }
+
+    static const char* work_name(Work work);
+    static const char* level_name(Level level);
+
+private:
+    QosScheduler();
+    ~QosScheduler() = default;
+
+    /**
+     * Record pressure against a threshold (ratio 1.0 = at the threshold)
+     */
+    void report_ratio(double ratio);
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<int64_t> latency_threshold_us_{100000};
+    std::atomic<int> queue_percent_{50};
+    std::atomic<int> decimation_{4};
+    std::atomic<int64_t> hold_us_{1000000};
+
+    // Each level holds until this time (LatencyStats::now_us(); 0 = never entered)
+    std::atomic<int64_t> decimate_until_us_{0};
+    std::atomic<int64_t> skip_until_us_{0};
+
+    std::array<std::atomic<uint64_t>, WORK_COUNT> calls_{};
+    std::array<std::atomic<uint64_t>, WORK_COUNT> shed_{};
+    std::array<Counter*, WORK_COUNT> shed_metrics_{};
+};
+
+} // namespace core
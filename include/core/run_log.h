@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace core {
+
+/**
+ * Columnar, append-only log of every analyzed frame
+ *
+ * Scattering statistics used to exist only as in-memory aggregates, exported
+ * to CSV on request, so the per-frame history of a run was lost. The run
+ * log keeps one row per frame: appended rows fill a block of BLOCK_ROWS
+ * rows held column by column, and a full block is handed to the writer
+ * thread, which writes each column as one contiguous array. Appending is a
+ * few stores under a mutex; the file is only touched by the writer.
+ *
+ * File layout (little-endian):
+ * - header: "RUNLOG1\0", u32 version, u32 block_rows, u32 column_count,
+ *   i64 start time (unix ms), then per column a u8 type and a u8 length
+ *   followed by the name
+ * - blocks: u32 BLOCK_MAGIC, u32 rows, then for each column in header order
+ *   rows values of its type
+ *
+ * Every block holds BLOCK_ROWS rows except the last, written by close(), so
+ * block offsets follow from the header and a reader can map whole columns
+ * without parsing rows (numpy.frombuffer per block). A block torn by a
+ * crash is shorter than its row count says and can be dropped.
+ *
+ * Unknown values are stored as -1. If the writer falls MAX_QUEUED_BLOCKS
+ * behind, further full blocks are dropped and counted (run_log.dropped_rows).
+ *
+ * **Usage:**
+ * ```cpp
+ * RunLog::instance().open("run_logs/run_2024-01-01T12-00-00.runlog");
+ * RunLog::Row row;
+ * row.frame_index = 42;
+ * RunLog::instance().append(row);   // Any thread; ignored while closed
+ * RunLog::instance().close();
+ * ```
+ */
+class RunLog {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t BLOCK_MAGIC = 0x4B4C4252;   // "RBLK"
+    static constexpr uint32_t BLOCK_ROWS = 4096;          // ~4 s at 1 kHz
+    static constexpr size_t MAX_QUEUED_BLOCKS = 8;
+
+    enum class Type : uint8_t { I64 = 0, I32 = 1, U32 = 2, U8 = 3 };
+
+    struct Column {
+        const char* name;
+        Type type;
+    };
+
+    static constexpr int COLUMN_COUNT = 10;
+    static constexpr Column COLUMNS[COLUMN_COUNT] = {
+        {"frame_index", Type::I64},         // Frames the camera generated before this one
+        {"camera", Type::U8},
+        {"camera_ts_us", Type::I64},        // Sensor timestamp (end of the window)
+        {"window_us", Type::U32},           // Span the frame covers
+        {"events", Type::I64},
+        {"on_events", Type::I64},
+        {"off_events", Type::I64},
+        {"active_pixels", Type::I32},       // Live pixels set
+        {"scattering_pixels", Type::I32},   // Live AND NOT reference
+        {"latency_us", Type::I32},          // Frame callback to end of analysis
+    };
+
+    /**
+     * One frame (-1 = unknown)
+     */
+    struct Row {
+        int64_t frame_index = -1;
+        int camera = 0;
+        int64_t camera_ts = -1;
+        uint32_t window_us = 0;
+        int64_t events = -1;
+        int64_t on_events = -1;
+        int64_t off_events = -1;
+        int32_t active_pixels = -1;
+        int32_t scattering_pixels = -1;
+        int32_t latency_us = -1;
+    };
+
+    static RunLog& instance();
+
+    // Non-copyable
+    RunLog(const RunLog&) = delete;
+    RunLog& operator=(const RunLog&) = delete;
+
+    /**
+     * Create the log file (parent directories included) and start the writer
+     * @param path Log file, replaced if it exists
+     * @return false if the file cannot be created
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Write the partial block, stop the writer and close the file
+     */
+    void close();
+
+    /**
+     * Add a row (any thread; ignored while closed)
+     */
+    void append(const Row& row);
+
+    /**
+     * Read a run log, one block in memory at a time
+     *
+     * Columns are matched by name, so a log with fewer or more columns
+     * still fills the ones both know (the rest stay -1). A torn last block
+     * is dropped.
+     * @param path Run log file
+     * @param fn Called for every row, in file order
+     * @param start_unix_ms Set to the run's start time (optional)
+     * @return false if the file cannot be read or is not a run log
+     */
+    static bool read(const std::string& path, const std::function<void(const Row&)>& fn,
+                     int64_t* start_unix_ms = nullptr);
+
+    bool is_open() const { return open_.load(std::memory_order_relaxed); }
+    const std::string& path() const { return path_; }
+    int64_t rows_written() const { return rows_written_.load(std::memory_order_relaxed); }
+
+private:
+    struct Block {
+        uint32_t rows = 0;
+        std::vector<int64_t> frame_index, camera_ts, events, on_events, off_events;
+        std::vector<uint8_t> camera;
+        std::vector<uint32_t> window_us;
+        std::vector<int32_t> active_pixels, scattering_pixels, latency_us;
+
+        Block();
+    };
+    using BlockPtr = std::unique_ptr<Block>;
+
+    RunLog() = default;
+    ~RunLog();
+
+    void writer_loop();
+    bool write_header();
+    bool write_block(const Block& block);
+
+    std::string path_;
+    std::ofstream file_;   // Writer thread only while open
+    std::atomic<bool> open_{false};
+
+    // Block being filled (guarded by append_mutex_)
+    std::mutex append_mutex_;
+    BlockPtr current_;
+
+    // Full blocks waiting for the writer and emptied ones for reuse (guarded by queue_mutex_)
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<BlockPtr> queued_;
+    std::vector<BlockPtr> free_;
+    bool stopping_ = false;
+    std::thread thread_;
+
+    std::atomic<int64_t> rows_written_{0};
+};
+
+} // namespace core
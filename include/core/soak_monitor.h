@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "core/metrics.h"
+
+namespace core {
+
+/**
+ * Resource growth tracking for long soak runs
+ *
+ * Reliability runs last 8-72 hours, long enough for a slow leak or an
+ * unbounded container to matter. Every interval_s the monitor samples the
+ * process (resident set, private bytes, OS handles), the live GL object
+ * count when the caller can take it, the allocation rate (with
+ * RTCAM_ALLOC_TRACKING) and the per-second rate of a list of throughput
+ * counters, and writes one CSV row. The first sample after warmup_s - once
+ * caches, pools and histories have filled - is the baseline. Growth past
+ * any max_*_growth threshold fails the run; the result is a pass/fail a
+ * build must get before it ships to the rigs.
+ *
+ * Values are also published as soak.rss_mb, soak.private_mb, soak.handles
+ * and soak.gl_objects for the exporters. Not thread-safe: poll() from one
+ * thread (the main loop, about once a second).
+ *
+ * **Usage:**
+ * ```cpp
+ * monitor.start(options);
+ * while (running) { if (!monitor.poll(gl_objects)) break; }   // Growth threshold exceeded
+ * monitor.stop();
+ * ```
+ */
+class SoakMonitor {
+public:
+    struct Options {
+        int interval_s = 60;
+        int warmup_s = 300;                     // Baseline is the first sample after this
+        double max_rss_growth_mb = 64.0;        // Over the baseline (0 = not checked)
+        double max_private_growth_mb = 64.0;
+        int max_handle_growth = 100;
+        int max_gl_growth = 32;
+        std::string csv_path;                   // One row per sample ("" = none)
+        std::vector<std::string> throughput_counters;   // MetricsRegistry counters, written as rates
+    };
+
+    struct ProcessStats {
+        double rss_mb = -1.0;                   // Resident set / working set
+        double private_mb = -1.0;               // Private committed (Windows) / anonymous resident (Linux)
+        int64_t handles = -1;                   // Handles (Windows) / open descriptors (Linux)
+    };
+
+    struct Summary {
+        int samples = 0;
+        bool baseline = false;                  // Warmup is over
+        double rss_growth_mb = 0.0;
+        double rss_slope_mb_per_h = 0.0;        // Least-squares slope since the baseline
+        double private_growth_mb = 0.0;
+        int64_t handle_growth = 0;
+        int64_t gl_growth = 0;
+    };
+
+    SoakMonitor() = default;
+    ~SoakMonitor();
+
+    // Non-copyable
+    SoakMonitor(const SoakMonitor&) = delete;
+    SoakMonitor& operator=(const SoakMonitor&) = delete;
+
+    /**
+     * Current process figures (-1 where the platform does not say)
+     */
+    static ProcessStats read_process();
+
+    /**
+     * Begin a run (the first sample is due one interval from now)
+     * @return false if the CSV cannot be created (sampling still runs)
+     */
+    bool start(const Options& options);
+
+    /**
+     * Close the CSV
+     */
+    void stop();
+
+    bool is_running() const { return running_; }
+
+    /**
+     * A sample is due; callers with costly inputs (the GL census) check first
+     */
+    bool is_due() const;
+
+    /**
+     * Take a sample if one is due
+     * @param gl_objects Live GL objects (-1 = unknown, e.g. headless)
+     * @return false once a growth threshold has been exceeded
+     */
+    bool poll(int64_t gl_objects = -1);
+
+    bool is_failed() const { return failed_; }
+    const std::string& get_failure() const { return failure_; }
+    Summary get_summary() const;
+
+private:
+    void sample(int64_t gl_objects, int64_t now_us);
+    void check(const char* what, double growth, double limit, const char* unit);
+
+    Options options_;
+    bool running_ = false;
+    std::ofstream csv_;
+    int64_t start_us_ = 0;
+    int64_t next_us_ = 0;
+    int64_t last_us_ = 0;
+
+    std::vector<int64_t> last_counts_;
+    uint64_t last_alloc_count_ = 0;
+    uint64_t last_alloc_bytes_ = 0;
+
+    // Baseline and slope since it (hours, MB)
+    bool have_baseline_ = false;
+    ProcessStats baseline_;
+    int64_t baseline_gl_ = -1;
+    ProcessStats latest_;
+    int64_t latest_gl_ = -1;
+    int samples_ = 0;
+    double sum_t_ = 0.0, sum_m_ = 0.0, sum_tt_ = 0.0, sum_tm_ = 0.0;
+    int slope_samples_ = 0;
+
+    bool failed_ = false;
+    std::string failure_;
+};
+
+} // namespace core
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace core {
+
+/**
+ * Pipeline stages whose threads can be placed on cores
+ *
+ * Stages with one thread per camera (decode, accumulation, analysis) pick
+ * their core by camera index; the others use entry 0.
+ */
+enum class ThreadStage {
+    Decode = 0,         // SDK decoding thread (or replay thread) of each camera
+    Accumulation = 1,   // Frame building thread of each camera (CameraManager)
+    Analysis = 2,       // Scattering worker of each camera
+    IO = 3,             // Image save queue and event recorder writer
+    UI = 4,             // Main thread (render loop, or the headless loop)
+    Count = 5
+};
+
+/**
+ * Scheduler priority classes (Windows thread priorities)
+ */
+enum class ThreadPriority {
+    Idle = 0,       // THREAD_PRIORITY_IDLE
+    Low = 1,        // THREAD_PRIORITY_BELOW_NORMAL
+    Normal = 2,     // THREAD_PRIORITY_NORMAL (not changed)
+    High = 3,       // THREAD_PRIORITY_ABOVE_NORMAL
+    Highest = 4,    // THREAD_PRIORITY_HIGHEST
+    Critical = 5    // THREAD_PRIORITY_TIME_CRITICAL
+};
+
+/**
+ * Core and priority assignment for a stage
+ */
+struct ThreadPlacement {
+    std::vector<int> cores;                          // Core per instance (missing or < 0 = not pinned)
+    ThreadPriority priority = ThreadPriority::Normal;
+    std::string mmcss_task;                          // Windows MMCSS task, e.g. "Pro Audio" ("" = none)
+};
+
+/**
+ * Process-wide thread placement table
+ *
+ * Filled once from the [Threads] config section before the pipeline
+ * starts; every pipeline thread then calls place_current_thread() as the
+ * first thing it does. Threads the SDK creates (decoding) place
+ * themselves on their first callback.
+ *
+ * With decode isolation, the decode cores are reserved: every other placed
+ * thread that is not pinned is kept off them, so the scheduler cannot
+ * migrate work onto the core the decoder needs. Cores are logical
+ * processors of the first processor group (0-63); to stay on one NUMA
+ * node, list cores of that node only.
+ *
+ * A stage with an MMCSS task (Windows) joins it: the Multimedia Class
+ * Scheduler boosts the thread into the real-time range while keeping a
+ * share of the CPU for the rest of the system, which a plain
+ * THREAD_PRIORITY_TIME_CRITICAL does not. The stage priority is then
+ * applied as the MMCSS relative priority. Registration lasts until the
+ * thread exits.
+ *
+ * Placement failures only warn: a thread that cannot be pinned runs
+ * unpinned, and one that cannot join its MMCSS task (service disabled,
+ * unknown task) gets the plain thread priority instead.
+ */
+class ThreadPlacements {
+public:
+    static ThreadPlacements& instance() {
+        static ThreadPlacements instance;
+        return instance;
+    }
+
+    // Non-copyable
+    ThreadPlacements(const ThreadPlacements&) = delete;
+    ThreadPlacements& operator=(const ThreadPlacements&) = delete;
+
+    /**
+     * Set the placement of a stage (before its threads start)
+     */
+    void set(ThreadStage stage, const ThreadPlacement& placement);
+
+    /**
+     * Get the placement of a stage
+     */
+    ThreadPlacement get(ThreadStage stage) const;
+
+    /**
+     * Reserve the decode cores for the decode threads
+     * @param isolate true = keep every other placed, unpinned thread off the decode cores
+     */
+    void set_isolate_decode(bool isolate);
+    bool is_decode_isolated() const;
+
+    /**
+     * Apply a stage's core and priority to the calling thread
+     * @param stage Stage the thread belongs to
+     * @param index Camera index for per-camera stages (0 otherwise)
+     * @return false if a requested core or priority could not be applied
+     */
+    bool place_current_thread(ThreadStage stage, int index = 0) const;
+
+    /**
+     * Parse a comma-separated core list ("2,4"; empty entries = not pinned)
+     */
+    static std::vector<int> parse_cores(const std::string& list);
+
+    /**
+     * Format a core list the way parse_cores() reads it
+     */
+    static std::string format_cores(const std::vector<int>& cores);
+
+    /**
+     * Parse a priority name (idle, low, normal, high, highest, critical)
+     * @return false if the name is unknown (priority unchanged)
+     */
+    static bool parse_priority(const std::string& name, ThreadPriority& priority);
+
+    static const char* priority_name(ThreadPriority priority);
+    static const char* stage_name(ThreadStage stage);
+
+private:
+    ThreadPlacements() = default;
+
+    /**
+     * Decode cores other stages must avoid (empty unless isolated)
+     */
+    std::vector<int> reserved_cores() const;
+
+    mutable std::mutex mutex_;
+    std::array<ThreadPlacement, static_cast<size_t>(ThreadStage::Count)> placements_;
+    bool isolate_decode_ = false;
+};
+
+} // namespace core
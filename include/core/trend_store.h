@@ -0,0 +1,198 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/metrics.h"
+
+namespace core {
+
+/**
+ * One aggregated time bucket (count 0 = no samples in that period)
+ */
+struct TrendBucket {
+    float min = 0.0f;
+    float max = 0.0f;
+    float mean = 0.0f;
+    uint32_t count = 0;
+};
+
+/**
+ * Multi-resolution history of one value
+ *
+ * Each tier aggregates the raw samples into fixed-period buckets
+ * (min/max/mean) kept in a ring: 1 s buckets for an hour, 1 min buckets for
+ * a day, 10 min buckets for a week. Bucket n of a tier covers
+ * [origin + n * period, origin + (n + 1) * period), so bucket times are
+ * implicit and periods without samples are stored as empty buckets.
+ *
+ * **Threading:** exactly one writer calls append(). Completed buckets are
+ * published with a release store of the tier's bucket count. Readers copy
+ * slots with relaxed atomic loads, then check how far the writer has
+ * started overwriting (seqlock style) and drop any slot it may have
+ * recycled meanwhile. Neither side ever blocks.
+ */
+class TrendSeries {
+public:
+    struct TierSpec {
+        int period_s;
+        size_t capacity;
+        const char* label;
+    };
+
+    static constexpr int TIER_COUNT = 3;
+    static constexpr TierSpec TIERS[TIER_COUNT] = {
+        {1, 3600, "1 h (1 s)"},
+        {60, 1440, "24 h (1 min)"},
+        {600, 1008, "7 days (10 min)"},
+    };
+
+    /**
+     * @param name Series name (also the key in the history file)
+     * @param origin_s Unix time of bucket 0 of every tier
+     */
+    TrendSeries(std::string name, int64_t origin_s);
+
+    // Non-copyable
+    TrendSeries(const TrendSeries&) = delete;
+    TrendSeries& operator=(const TrendSeries&) = delete;
+
+    const std::string& name() const { return name_; }
+    int64_t origin_s() const { return origin_s_; }
+
+    /**
+     * Add a sample (writer thread only, O(1) amortized)
+     * @param unix_s Sample time (seconds since epoch)
+     * @param value Sample value
+     */
+    void append(int64_t unix_s, double value);
+
+    /**
+     * Copy the newest completed buckets of a tier (any thread)
+     * @param tier Tier index
+     * @param buckets Output, oldest first (keeps its capacity between calls)
+     * @param max_buckets Upper bound on buckets returned (0 = whole tier)
+     * @return Bucket number of buckets.front() (its start is origin + n * period)
+     */
+    uint64_t read(int tier, std::vector<TrendBucket>& buckets, size_t max_buckets = 0) const;
+
+    /**
+     * Completed buckets of a tier since origin (changes when a new bucket is published)
+     */
+    uint64_t published(int tier) const { return tiers_[tier].published.load(std::memory_order_acquire); }
+
+    /**
+     * Serialize / restore the completed buckets (writer thread, or before it starts)
+     */
+    void save(std::ostream& out) const;
+    bool load(std::istream& in);
+
+private:
+    struct Slot {
+        std::atomic<float> min{0.0f};
+        std::atomic<float> max{0.0f};
+        std::atomic<float> mean{0.0f};
+        std::atomic<uint32_t> count{0};
+    };
+
+    struct Tier {
+        std::unique_ptr<Slot[]> slots;
+        size_t capacity = 0;
+        int period_s = 1;
+        std::atomic<uint64_t> published{0};   // Buckets completed
+        std::atomic<uint64_t> writing{0};     // Buckets written or being written (>= published)
+
+        // Writer only: bucket in progress
+        uint64_t current = 0;
+        double sum = 0.0;
+        float min = 0.0f;
+        float max = 0.0f;
+        uint32_t count = 0;
+    };
+
+    /**
+     * Publish the bucket in progress and empty buckets up to target (writer)
+     */
+    void advance(Tier& tier, uint64_t target);
+    static void store(Slot& slot, const TrendBucket& bucket);
+
+    std::string name_;
+    int64_t origin_s_;
+    std::array<Tier, TIER_COUNT> tiers_;
+};
+
+/**
+ * Samples event rate, scattering and sensor temperature into TrendSeries once a second
+ *
+ * The sampler thread is the single writer of every series: it reads the
+ * events.ingested counter (as a rate) and the scattering.percentage and
+ * camera.temperature_c gauges from the MetricsRegistry, so producers need
+ * no extra hooks. With a
+ * history file the store is restored on start() and written every minute
+ * and on stop(), so a long chart survives a restart.
+ *
+ * **Usage:**
+ * ```cpp
+ * TrendStore store;
+ * store.start("trend_history.bin");
+ * store.series(TrendStore::EventRate).read(0, buckets);
+ * store.stop();
+ * ```
+ */
+class TrendStore {
+public:
+    enum Series {
+        EventRate = 0,       // events/s
+        Scattering = 1,      // % of reference pixels
+        Temperature = 2,     // Sensor temperature in °C (camera 0)
+        SERIES_COUNT
+    };
+
+    static constexpr int SAVE_INTERVAL_S = 60;
+
+    TrendStore();
+    ~TrendStore();
+
+    // Non-copyable
+    TrendStore(const TrendStore&) = delete;
+    TrendStore& operator=(const TrendStore&) = delete;
+
+    /**
+     * Restore history (if any) and start the sampler thread
+     * @param history_path History file ("" = in memory only)
+     * @return true if running
+     */
+    bool start(const std::string& history_path);
+
+    /**
+     * Stop the sampler and write the history file
+     */
+    void stop();
+
+    bool is_running() const { return running_.load(); }
+    const TrendSeries& series(Series s) const { return *series_[s]; }
+    const std::string& get_history_path() const { return history_path_; }
+
+private:
+    void sample_loop();
+    bool load_history();
+    bool save_history() const;
+
+    int64_t origin_s_;
+    std::array<std::unique_ptr<TrendSeries>, SERIES_COUNT> series_;
+    std::string history_path_;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+};
+
+} // namespace core
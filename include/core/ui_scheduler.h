@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace core {
+
+/**
+ * Adaptive pacing of the viewer's render loop
+ *
+ * The loop renders as soon as a new frame or input arrives, but never
+ * faster than max_fps; with nothing new it only renders at idle_fps, and
+ * while the window is minimized frames no longer count as work. Waiting
+ * happens in the windowing system's event wait, so an idle UI sleeps
+ * instead of spinning at the refresh rate, and producers wake it through
+ * notify_frame().
+ *
+ * **Present pacing (low-latency mode):** with the swap interval at 0 the
+ * swap no longer blocks for vblank, so the scheduler paces presents
+ * itself: one per period (max_fps, or the monitor refresh when uncapped),
+ * starting each iteration only as long before the next present as the
+ * recent iterations took (a decaying peak of wait end to present). A frame
+ * that arrives early is consumed and uploaded just before it is shown
+ * instead of sitting in a texture until the next vblank.
+ *
+ * **Threading:** wait_for_next_frame() and on_presented() run on the UI thread only;
+ * notify_frame() may be called from any thread and only calls the wake
+ * function while the UI is actually waiting for a frame.
+ */
+class UiScheduler {
+public:
+    /// Block until an event arrives or timeout_s passes (0 = poll without blocking)
+    using WaitFunction = std::function<void(double timeout_s)>;
+
+    /// Interrupt a wait in progress (called from producer threads)
+    using WakeFunction = std::function<void()>;
+
+    UiScheduler() = default;
+    ~UiScheduler() = default;
+
+    // Non-copyable
+    UiScheduler(const UiScheduler&) = delete;
+    UiScheduler& operator=(const UiScheduler&) = delete;
+
+    /**
+     * Set the event wait and wake functions (before the loop starts)
+     */
+    void set_event_functions(WaitFunction wait, WakeFunction wake);
+
+    /**
+     * Set render rates (before the loop starts)
+     * @param max_fps Render cap while frames or input arrive (0 = uncapped, vsync only)
+     * @param idle_fps Render rate with nothing new (clamped to at least 1)
+     */
+    void set_rates(int max_fps, int idle_fps);
+
+    /**
+     * Pace presents instead of iteration starts (before the loop starts)
+     * @param enabled Low-latency mode (swap interval 0)
+     * @param refresh_hz Monitor refresh, the present period when max_fps is 0 (0 = unknown, 60 assumed)
+     */
+    void set_present_pacing(bool enabled, int refresh_hz);
+
+    /**
+     * Record that the iteration's buffer swap returned (UI thread)
+     *
+     * Feeds the work estimate that schedules the next iteration's start.
+     */
+    void on_presented();
+
+    /**
+     * Signal that a frame is ready for display (any thread)
+     */
+    void notify_frame();
+
+    /**
+     * Block until the next UI frame is due, processing window events meanwhile
+     *
+     * Replaces the per-iteration event poll at the top of the render loop.
+     * @param minimized Window is minimized (render at idle_fps only)
+     */
+    void wait_for_next_frame(bool minimized);
+
+    /**
+     * Frames rendered without a new camera frame (input or idle refresh)
+     */
+    uint64_t get_idle_frames() const { return idle_frames_; }
+
+    /**
+     * Predicted wait end to present time in low-latency mode (us, 0 = pacing off)
+     */
+    int64_t get_predicted_work_us() const { return pacing_ ? predicted_work_us_ : 0; }
+
+private:
+    static constexpr int64_t PACING_MARGIN_US = 500;  // Slack on top of the predicted work
+
+    static int64_t now_us();
+
+    /**
+     * Earliest start of the next iteration
+     */
+    int64_t earliest_start_us() const;
+
+    WaitFunction wait_;
+    WakeFunction wake_;
+    int max_fps_ = 60;
+    int idle_fps_ = 4;
+
+    std::atomic<bool> frame_ready_{false};
+    std::atomic<bool> waiting_{false};  // UI blocked in an idle wait that a frame should end
+
+    int64_t last_frame_us_ = 0;
+    uint64_t idle_frames_ = 0;
+
+    // Present pacing (UI thread)
+    bool pacing_ = false;
+    int refresh_hz_ = 60;
+    int64_t last_present_us_ = 0;
+    int64_t predicted_work_us_ = 0;
+};
+
+} // namespace core
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "bias_sweep.h"
+#include "core/genetic_optimizer.h"
+#include "video/frame_buffer.h"
+
+namespace Metavision {
+    class Device;
+    class I_LL_Biases;
+    class I_EventTrailFilterModule;
+    class I_AntiFlickerModule;
+}
+
+/**
+ * GAOptimizer - Tunes biases, trail filter and anti-flicker on the live camera
+ *
+ * Drives core::GeneticOptimizer through BiasSweep::measure(): the next
+ * candidate is bred and applied (and the sensor settles) while the frames
+ * of the previous one are still being analyzed, so the rig never waits on
+ * analysis. Candidates are scored by fitness() from the captured frames.
+ *
+ * Gene ranges come from the sensor (bias ranges, supported filter limits)
+ * and the current camera state seeds the first genome. Every result is
+ * appended to a CSV and checkpointed; with resume set, a run picks up from
+ * the checkpoint instead of starting over.
+ *
+ * **Usage:**
+ * ```cpp
+ * GAOptimizer ga(frame_buffer);
+ * ga.run(camera->get_device(), options, should_stop);
+ * ```
+ */
+class GAOptimizer {
+public:
+    struct Options {
+        core::GeneticOptimizer::Settings ga;
+        bool optimize_biases = true;        // bias_diff_on/off, bias_hpf, bias_refr
+        bool optimize_trail_filter = false; // Enable + threshold (type kept)
+        bool optimize_antiflicker = false;  // Enable + frequency band
+        BiasSweep::Options measure;         // Settle time, frames, reference (csv_path unused)
+        std::string csv_path = "ga_results.csv";
+        std::string checkpoint_path = "ga_checkpoint.txt";
+        bool resume = false;                // Continue from checkpoint_path if it matches
+    };
+
+    /**
+     * Create optimizer (does not start anything)
+     * @param source Frame buffer in queue mode that the camera path stores into
+     */
+    explicit GAOptimizer(video::FrameBuffer& source);
+
+    // Non-copyable
+    GAOptimizer(const GAOptimizer&) = delete;
+    GAOptimizer& operator=(const GAOptimizer&) = delete;
+
+    /**
+     * Run the optimization on the calling thread (blocks until done or stopped)
+     *
+     * On completion the best candidate is left applied; a stopped run
+     * restores the settings found at the start.
+     *
+     * @param device Camera device providing the facilities
+     * @param options Genes, GA settings, measurement and output
+     * @param should_stop Polled between frames; true aborts after the current step
+     * @return true if the evaluation budget was used up
+     */
+    bool run(Metavision::Device& device, const Options& options, const std::function<bool()>& should_stop);
+
+    /**
+     * Score of one measurement (higher is better): with a reference, minus
+     * scattering plus missing percent; otherwise the stability SNR in dB
+     */
+    static double fitness(const BiasSweep::StepResult& result);
+
+    const core::GeneticOptimizer& optimizer() const { return optimizer_; }
+
+private:
+    std::vector<core::GeneticOptimizer::Gene> build_genes(const Options& options);
+    std::vector<int> read_current() const;
+    bool apply(const std::vector<int>& values);
+    void on_result(const BiasSweep::StepResult& result);
+    void print_genome(const char* label, const std::vector<int>& values, double fitness) const;
+
+    BiasSweep sweep_;
+    Metavision::I_LL_Biases* biases_ = nullptr;
+    Metavision::I_EventTrailFilterModule* trail_filter_ = nullptr;
+    Metavision::I_AntiFlickerModule* antiflicker_ = nullptr;
+    std::string checkpoint_path_;
+
+    // Shared by the measuring thread (propose) and the analysis thread (report)
+    std::mutex mutex_;
+    core::GeneticOptimizer optimizer_;
+    std::map<int, core::GeneticOptimizer::Candidate> in_flight_;  // By measure() step
+    std::ofstream csv_;
+};
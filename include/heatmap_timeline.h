@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+namespace heatmap_timeline {
+
+/**
+ * Heatmap timeline file format (.rtheat): scattering counts over time as sparse deltas
+ *
+ * ScatteringData::scattering_count only holds the state at the end of a
+ * run. The timeline snapshots the count plane every few seconds and stores
+ * each snapshot as the pixels that changed since the previous one: their
+ * raster index (as the gap from the previous changed index) and the
+ * increment, both LEB128 varints. Counts only grow between resets, so a
+ * healthy sensor costs a few bytes per scattering pixel per snapshot
+ * instead of a dense 4-byte-per-pixel plane.
+ *
+ * Every KEYFRAME_EVERY-th snapshot (and the first one, and any snapshot
+ * after a count went down, i.e. a reset) is a keyframe: the same encoding
+ * against an all-zero plane. Any snapshot is rebuilt by replaying the
+ * deltas that follow the nearest keyframe at or before it.
+ *
+ * File layout (little-endian):
+ * - header: "RTHEAT1\0", u32 version, u32 width, u32 height, i64 start
+ *   time (unix ms)
+ * - records: u32 RECORD_MAGIC, u8 keyframe, i64 time (unix ms), i64 frames
+ *   analyzed, u32 changed pixels, u32 payload bytes, payload
+ *
+ * A record cut short by a crash ends the file for the reader.
+ *
+ * **Usage:**
+ * ```cpp
+ * HeatmapTimelineWriter writer;                  // Analysis thread
+ * writer.open("run_heatmap.rtheat", 1280, 720);
+ * writer.append(counts, frames_analyzed);        // Every N seconds
+ *
+ * HeatmapTimeline timeline;                      // Viewer
+ * timeline.open("run_heatmap.rtheat");
+ * timeline.reconstruct(timeline.size() / 2, counts);
+ * ```
+ */
+constexpr char FILE_MAGIC[8] = {'R', 'T', 'H', 'E', 'A', 'T', '1', '\0'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t RECORD_MAGIC = 0x54414548;   // "HEAT"
+constexpr int KEYFRAME_EVERY = 60;               // Snapshots per keyframe (10 min at 10 s)
+constexpr const char* EXTENSION = ".rtheat";
+
+} // namespace heatmap_timeline
+
+/**
+ * Writes count snapshots as a heatmap timeline (single thread)
+ */
+class HeatmapTimelineWriter {
+public:
+    HeatmapTimelineWriter() = default;
+    ~HeatmapTimelineWriter() { close(); }
+
+    // Non-copyable
+    HeatmapTimelineWriter(const HeatmapTimelineWriter&) = delete;
+    HeatmapTimelineWriter& operator=(const HeatmapTimelineWriter&) = delete;
+
+    /**
+     * Create the file (parent directories included) and write the header
+     * @return false if the file cannot be created
+     */
+    bool open(const std::string& path, int width, int height);
+
+    void close();
+
+    /**
+     * Add a snapshot
+     * @param counts Temporal counts (CV_32SC1, the size given to open)
+     * @param frames_analyzed Frames behind these counts
+     * @return false if closed, the size differs or the write failed
+     */
+    bool append(const cv::Mat& counts, int64_t frames_analyzed);
+
+    bool is_open() const { return file_.is_open(); }
+    const std::string& path() const { return path_; }
+    int64_t bytes_written() const { return bytes_written_; }
+
+private:
+    std::string path_;
+    std::ofstream file_;
+    cv::Mat previous_;                // Counts as of the last snapshot
+    int snapshots_ = 0;
+    int64_t bytes_written_ = 0;
+    std::vector<uint8_t> payload_;    // Reused encode buffer
+};
+
+/**
+ * Random access to the snapshots of a heatmap timeline
+ */
+class HeatmapTimeline {
+public:
+    struct Snapshot {
+        int64_t unix_ms = 0;
+        int64_t frames_analyzed = 0;
+        uint32_t changed_pixels = 0;
+        bool keyframe = false;
+        size_t payload_offset = 0;    // Into the loaded file
+        uint32_t payload_bytes = 0;
+    };
+
+    /**
+     * Load a timeline file and index its snapshots
+     * @return false if it cannot be read or is not a timeline
+     */
+    bool open(const std::string& path);
+
+    void close();
+
+    bool is_open() const { return width_ > 0; }
+    const std::string& path() const { return path_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int64_t start_unix_ms() const { return start_unix_ms_; }
+    size_t size() const { return snapshots_.size(); }
+    const Snapshot& snapshot(size_t index) const { return snapshots_[index]; }
+
+    /**
+     * Counts as of a snapshot
+     *
+     * Steps forward from the last reconstructed snapshot when that is
+     * cheaper than starting over from the nearest keyframe.
+     * @param index Snapshot index
+     * @param counts Output CV_32SC1 (owned by the caller, never shared with the cache)
+     * @return false if index is out of range or the payload is corrupt
+     */
+    bool reconstruct(size_t index, cv::Mat& counts);
+
+private:
+    bool apply(const Snapshot& snapshot, cv::Mat& counts) const;
+
+    std::string path_;
+    std::vector<uint8_t> data_;
+    std::vector<Snapshot> snapshots_;
+    int width_ = 0;
+    int height_ = 0;
+    int64_t start_unix_ms_ = 0;
+
+    // Last reconstruction, the starting point of the next one
+    cv::Mat current_;
+    int64_t current_index_ = -1;
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "image_manager.h"
+#include "video/binary_frame.h"
+
+/**
+ * ImageCache - Decoded captures for the Load Image path, with neighbour prefetch
+ *
+ * Every load used to decode the PNG and parse the JSON on the UI thread.
+ * The cache keeps recently loaded captures decoded, least recently used
+ * dropped first once max_bytes is exceeded. Binary (0/255) captures are
+ * kept bit-packed, 1/8 of their 8-bit size, and unpacked on a hit; other
+ * images are kept as CV_8UC1.
+ *
+ * prefetch_around() queues the captures next to a path in its directory
+ * (file name order, which is capture order for timestamped names) for a
+ * background thread, nearest first. A new call replaces what is still
+ * queued, so stepping quickly never builds a backlog. A load() of the file
+ * the thread is decoding waits for it instead of decoding it twice.
+ *
+ * Exported as image_cache.hits / image_cache.misses / image_cache.bytes.
+ * Prefetch stops while the MemoryBudget holds producers back.
+ *
+ * **Usage:**
+ * ```cpp
+ * auto& cache = ImageCache::instance();
+ * if (cache.load(path, metadata, image)) {
+ *     cache.prefetch_around(path);
+ * }
+ * std::string next = cache.neighbor(path, +1);   // "" at the end of the directory
+ * ```
+ */
+class ImageCache {
+public:
+    static ImageCache& instance();
+
+    // Non-copyable
+    ImageCache(const ImageCache&) = delete;
+    ImageCache& operator=(const ImageCache&) = delete;
+
+    /**
+     * Set the memory budget and prefetch depth (drops entries over the new budget)
+     * @param max_bytes Decoded bytes kept (0 = no caching)
+     * @param prefetch Captures prefetched on each side of the last load (0 = none)
+     */
+    void configure(size_t max_bytes, int prefetch);
+
+    /**
+     * Load a capture, from the cache if it is there
+     * @param path PNG path
+     * @param metadata Output metadata (from the JSON sidecar or the image)
+     * @param image Output CV_8UC1 image (owned by the caller)
+     * @return false if the image cannot be read
+     */
+    bool load(const std::string& path, ImageManager::ImageMetadata& metadata, cv::Mat& image);
+
+    /**
+     * Queue the neighbours of a capture for the prefetch thread
+     */
+    void prefetch_around(const std::string& path);
+
+    /**
+     * Capture `step` files away from path in its directory (PNG files in name order)
+     * @return Path, or "" past either end
+     */
+    std::string neighbor(const std::string& path, int step);
+
+    /**
+     * Stop the prefetch thread and drop every entry
+     */
+    void shutdown();
+
+    size_t bytes() const;
+
+    /**
+     * Drop least recently used entries until at least `bytes` are freed (MemoryBudget)
+     * @return Bytes actually freed
+     */
+    size_t shrink(size_t bytes);
+
+private:
+    struct Entry {
+        ImageManager::ImageMetadata metadata;
+        video::BinaryFrame bits;   // Set for 0/255 images
+        cv::Mat gray;              // Set otherwise
+        size_t bytes = 0;
+    };
+    using EntryPtr = std::shared_ptr<const Entry>;
+
+    ImageCache();
+    ~ImageCache();
+
+    static EntryPtr decode(const std::string& path);
+    EntryPtr find(const std::string& path);             // mutex_ held, marks the entry used
+    void insert(const std::string& path, EntryPtr entry); // mutex_ held
+    void worker_loop();
+
+    // Cached entries, front = most recently used
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::list<std::string> lru_;
+    std::unordered_map<std::string, std::pair<EntryPtr, std::list<std::string>::iterator>> entries_;
+    size_t bytes_ = 0;
+    size_t max_bytes_ = 256ull << 20;
+    int prefetch_ = 2;
+
+    // Prefetch queue and the file the worker is decoding (guarded by mutex_)
+    std::deque<std::string> pending_;
+    std::string decoding_;
+    bool stopping_ = false;
+    std::thread thread_;
+
+    // Sorted PNG listing of the last directory stepped through
+    std::mutex listing_mutex_;
+    std::filesystem::path listing_dir_;
+    std::filesystem::file_time_type listing_time_{};
+    std::vector<std::string> listing_;
+};
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <memory>
 #include <opencv2/core.hpp>
 #include <chrono>
+#include "video/binary_frame.h"
+#include "video/frame_ref.h"
 
 /**
  * ImageManager - Handles saving and loading images with metadata
@@ -10,9 +14,36 @@
  * Reliability testing application stores:
  * - PNG image (binary processed frame)
  * - JSON metadata (timestamp, camera settings, user comments)
+ *
+ * save_image() encodes on the calling thread; UI code should use
+ * save_image_async(), which hands the frame to ImageSaveQueue.
+ *
+ * References are loaded with load_binary(): packed once, then shared by
+ * handle between everything that compares against them.
  */
 class ImageManager {
 public:
+    /**
+     * Shared, immutable packed image (see load_binary)
+     */
+    using BinaryHandle = std::shared_ptr<const video::BinaryFrame>;
+
+    /**
+     * PNG speed/size tradeoff (config png_profile)
+     */
+    enum class PngProfile {
+        FAST = 0,       // zlib 1, RLE strategy
+        BALANCED = 1,   // zlib 3 (RLE strategy for 1-bit images)
+        SMALL = 2       // zlib 9, default strategy
+    };
+
+    /**
+     * PNG encoding options, captured on the calling thread
+     */
+    struct PngOptions {
+        PngProfile profile = PngProfile::BALANCED;
+        bool bilevel = true;    // Write 0/255 images as 1-bit depth
+    };
     /**
      * Metadata structure for saved images
      */
@@ -20,11 +51,19 @@ public:
         // Timestamp information
         std::string timestamp;              // ISO 8601 format: "2025-11-10T14:30:45"
         int64_t unix_timestamp_ms;          // Milliseconds since epoch
+        int64_t sensor_timestamp_us = 0;    // Sensor time of the frame (end of accumulation, 0 = unknown)
+        int64_t frame_unix_timestamp_ms = 0; // When the frame happened (sensor time via core::ClockSync, 0 = unknown)
 
         // Camera configuration (at time of capture)
         int binary_bit_1;                   // First bit position (0-7)
         int binary_bit_2;                   // Second bit position (0-7)
-        int accumulation_time_us;           // Frame accumulation in microseconds
+        int accumulation_time_us;           // Frame accumulation in microseconds (actual window when known)
+        int64_t frame_events = -1;          // Events accumulated into the frame (-1 = unknown)
+        int64_t frame_on_events = -1;       // ON events among them (-1 = unknown)
+        int event_bbox_x = 0;               // Bounding box of those events, sensor coords (width 0 = unknown)
+        int event_bbox_y = 0;
+        int event_bbox_width = 0;
+        int event_bbox_height = 0;
 
         // Camera biases (for reference)
         int bias_diff;
@@ -39,6 +78,10 @@ public:
         int image_height;
         int active_pixels;                  // Number of white pixels
         float pixel_density;                // Percentage of active pixels
+        uint64_t frame_hash = 0;            // XXH64 of the bit-packed frame (0 = not computed)
+
+        // Deduplicated capture: no PNG of its own, the pixels are those of an earlier capture
+        std::string duplicate_of;           // That capture's PNG, relative to this one's directory ("" = own PNG)
 
         // User annotation
         std::string comment;                // User comment/notes
@@ -62,19 +105,126 @@ public:
         const std::string& base_filename = "reliability_test"
     );
 
+    /**
+     * Save packed image with metadata (unpacked to 0/255 PNG)
+     * @param image Image to save (bit-packed binary frame)
+     * @param metadata Metadata structure
+     * @param directory Directory to save to
+     * @param base_filename Base filename (timestamp will be prepended)
+     * @return Full path of saved file, or empty string on error
+     */
+    static std::string save_image(
+        const video::BinaryFrame& image,
+        const ImageMetadata& metadata,
+        const std::string& directory,
+        const std::string& base_filename = "reliability_test"
+    );
+
+    /**
+     * Queue image with metadata for saving on the background I/O thread
+     *
+     * Captures of one base_filename form a deduplicated series (see ImageSaveQueue).
+     *
+     * @param image Image to save (ownership taken, pixels shared, not cloned)
+     * @param metadata Metadata structure
+     * @param directory Directory to save to
+     * @param base_filename Base filename (timestamp will be prepended)
+     * @return Full path the image will be written to, or empty string if the queue is full
+     */
+    static std::string save_image_async(
+        video::FrameRef image,
+        const ImageMetadata& metadata,
+        const std::string& directory,
+        const std::string& base_filename = "reliability_test"
+    );
+
+    /**
+     * Encode image as PNG
+     *
+     * Images holding only 0 and 255 are written with 1-bit depth (IMWRITE_PNG_BILEVEL)
+     * when options.bilevel is set; anything else stays 8-bit so no data is lost.
+     *
+     * @param filepath Destination path
+     * @param image Image to encode
+     * @param options Encoding options (default: from AppConfig)
+     * @return true if successful
+     */
+    static bool write_png(const std::string& filepath, const cv::Mat& image, const PngOptions& options);
+    static bool write_png(const std::string& filepath, const cv::Mat& image) {
+        return write_png(filepath, image, png_options());
+    }
+
+    /**
+     * Get PNG options from AppConfig (png_profile, png_bilevel)
+     */
+    static PngOptions png_options();
+
+    /**
+     * Build cv::imwrite parameters for a profile
+     * @param options Encoding options
+     * @param binary_content true if the image holds only 0 and 255
+     * @return Parameter list for cv::imwrite
+     */
+    static std::vector<int> png_params(const PngOptions& options, bool binary_content);
+
+    /**
+     * Check if a CV_8UC1 image holds only 0 and 255
+     */
+    static bool is_binary(const cv::Mat& image);
+
     /**
      * Load image with metadata
+     *
+     * A deduplicated capture (JSON sidecar only) loads the pixels of the PNG it refers to.
+     *
      * @param filepath Full path to image file
      * @param metadata Output metadata structure
      * @param image Output loaded image
+     * @param verbose Log each loaded file (errors are always reported)
      * @return true if successful
      */
     static bool load_image(
         const std::string& filepath,
         ImageMetadata& metadata,
-        cv::Mat& image
+        cv::Mat& image,
+        bool verbose = true
     );
 
+    /**
+     * Load a binary image (reference, comparison baseline) packed, through a small shared cache
+     *
+     * The file is decoded once and packed straight from the decoder's
+     * buffer (any non-zero pixel becomes 1); no 8-bit copy is kept. Entries
+     * are keyed by path and modification time, so every consumer of the
+     * same reference (the scattering worker of each camera, comparison
+     * references, sweeps) gets the same handle, and switching back to a
+     * reference used earlier costs no decode. An edited file is decoded
+     * again. The least recently used of BINARY_CACHE_ENTRIES is dropped.
+     *
+     * @param filepath Image path
+     * @return Packed image, or nullptr if the file cannot be read
+     */
+    static BinaryHandle load_binary(const std::string& filepath);
+
+    /**
+     * Drop every cached load_binary() entry (handles already returned stay valid)
+     */
+    static void clear_binary_cache();
+
+    /**
+     * Packed bytes held by the load_binary() cache
+     */
+    static size_t binary_cache_bytes();
+
+    /**
+     * Drop least recently used load_binary() entries nobody else holds until
+     * at least `bytes` are freed (MemoryBudget; entries in use would free nothing)
+     * @return Bytes actually freed
+     */
+    static size_t trim_binary_cache(size_t bytes);
+
+    static constexpr size_t BINARY_CACHE_ENTRIES = 8;
+
     /**
      * Generate current timestamp string
      * @return ISO 8601 formatted timestamp
@@ -95,6 +245,28 @@ public:
      */
     static ImageMetadata create_metadata(const cv::Mat& image, const std::string& comment);
 
+    /**
+     * Create metadata from current application state (packed image)
+     * @param image Current camera image (bit-packed, counted with popcount)
+     * @param comment User comment
+     * @return Populated metadata structure
+     */
+    static ImageMetadata create_metadata(const video::BinaryFrame& image, const std::string& comment);
+
+    /**
+     * Create metadata from current application state (stored frame)
+     * @param frame Current camera frame; its FrameTiming::active_pixels is used when the
+     *              frame builder counted them, the pixels are only scanned otherwise
+     * @param comment User comment
+     * @return Populated metadata structure
+     */
+    static ImageMetadata create_metadata(const video::FrameRef& frame, const std::string& comment);
+
+    /**
+     * Create metadata from current application state, image size and active pixel count
+     */
+    static ImageMetadata create_metadata(cv::Size size, int active_pixels, const std::string& comment);
+
     /**
      * Save metadata as JSON
      * @param filepath Path to JSON file
@@ -103,12 +275,10 @@ public:
      */
     static bool save_metadata_json(const std::string& filepath, const ImageMetadata& metadata);
 
-private:
-
     /**
      * Load metadata from JSON
      * @param filepath Path to JSON file
-     * @param metadata Output metadata structure
+     * @param metadata Output metadata structure (fields missing from the file are left as they are)
      * @return true if successful
      */
     static bool load_metadata_json(const std::string& filepath, ImageMetadata& metadata);
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "image_manager.h"
+#include "video/binary_frame.h"
+#include "video/frame_ref.h"
+
+/**
+ * ImageSaveQueue - Encodes and writes images on a background I/O thread
+ *
+ * PNG encoding and the metadata JSON write used to run on the ImGui thread,
+ * stalling the display for tens of milliseconds per save. submit() takes
+ * ownership of a FrameRef and returns immediately; the worker encodes and
+ * writes, then queues a Result for the UI to collect with poll_result().
+ *
+ * Frames are shared, never cloned: producers only ever write into free
+ * FramePool slots, so a frame held here cannot be overwritten. Each pending
+ * save does pin one slot, which is why the queue is small and bounded -
+ * submit() refuses new work instead of starving the camera path.
+ *
+ * **Deduplication** (capture_dedup_distance >= 0): captures submitted with
+ * a series name (automated captures) are packed and hashed (XXH64 over the
+ * bit-packed words). One that hashes equal to the last PNG stored in its
+ * series, or differs from it in at most capture_dedup_distance pixels
+ * (popcount of the XOR), gets no PNG: only its JSON sidecar is written,
+ * with duplicate_of naming the earlier PNG, and the catalog indexes it as
+ * a reference. Static targets then cost one hash per capture instead of a
+ * PNG encode and file.
+ *
+ * **Usage:**
+ * ```cpp
+ * ImageSaveQueue::instance().submit(frame_ref, "C:\\captures\\a.png", metadata);
+ * ImageSaveQueue::Result result;
+ * while (ImageSaveQueue::instance().poll_result(result)) { ... }  // UI thread
+ * ```
+ */
+class ImageSaveQueue {
+public:
+    static constexpr size_t MAX_PENDING = 4;    // Saves queued or in progress
+    static constexpr size_t MAX_RESULTS = 32;   // Oldest results dropped if never polled
+
+    /**
+     * Outcome of one save
+     */
+    struct Result {
+        std::string path;
+        bool success = false;
+        std::string error;        // Empty on success
+        double elapsed_ms = 0.0;  // Encode + write time on the worker
+        std::string duplicate_of; // Earlier PNG this capture was stored as a reference to ("" = own PNG)
+    };
+
+    static ImageSaveQueue& instance();
+
+    // Non-copyable
+    ImageSaveQueue(const ImageSaveQueue&) = delete;
+    ImageSaveQueue& operator=(const ImageSaveQueue&) = delete;
+
+    /**
+     * Queue an image for saving
+     * @param frame Frame to save (ownership taken, pixels shared)
+     * @param image_path Destination PNG path (parent directories are created)
+     * @param metadata Written as JSON next to the image if provided
+     * @param png PNG encoding options (default: current config, read on the calling thread)
+     * @param dedup_series Series deduplicated against its last stored PNG ("" = never; needs metadata)
+     * @return true if queued, false if the queue is full, shut down or frame is empty
+     */
+    bool submit(video::FrameRef frame, const std::string& image_path,
+                std::optional<ImageManager::ImageMetadata> metadata = std::nullopt,
+                ImageManager::PngOptions png = ImageManager::png_options(),
+                const std::string& dedup_series = "");
+
+    /**
+     * Take the oldest completed result (UI thread)
+     * @param result Output
+     * @return true if a result was available
+     */
+    bool poll_result(Result& result);
+
+    /**
+     * Finish every queued save, then stop the worker (further submits fail)
+     */
+    void shutdown();
+
+    // Statistics
+    size_t get_pending() const;
+    int64_t get_saved() const { return saved_.load(std::memory_order_relaxed); }
+    int64_t get_failed() const { return failed_.load(std::memory_order_relaxed); }
+    int64_t get_rejected() const { return rejected_.load(std::memory_order_relaxed); }
+    int64_t get_deduplicated() const { return deduplicated_.load(std::memory_order_relaxed); }
+
+private:
+    struct Job {
+        video::FrameRef frame;
+        std::string image_path;
+        std::optional<ImageManager::ImageMetadata> metadata;
+        ImageManager::PngOptions png;
+        std::string dedup_series;
+        int dedup_distance = -1;    // capture_dedup_distance at submit (-1 = off)
+    };
+
+    /**
+     * Last PNG stored in a deduplicated series (worker thread only)
+     */
+    struct Stored {
+        video::BinaryFrame bits;
+        uint64_t hash = 0;
+        std::string path;
+    };
+
+    ImageSaveQueue();
+    ~ImageSaveQueue();
+
+    void worker_loop();
+    Result run_job(Job& job);
+
+    /**
+     * Hash a job's frame into dedup_bits_ and find its series
+     * @return Series to deduplicate against, or nullptr if the job is not deduplicated
+     */
+    Stored* prepare_dedup(Job& job, const cv::Mat& image);
+
+    /**
+     * Check dedup_bits_ (hashed to hash) against the last PNG stored in a series
+     */
+    bool is_duplicate(const Stored& stored, uint64_t hash, int distance) const;
+
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Job> jobs_;
+    size_t in_progress_ = 0;
+    bool stopping_ = false;
+
+    std::mutex results_mutex_;
+    std::deque<Result> results_;
+
+    std::atomic<int64_t> saved_{0};
+    std::atomic<int64_t> failed_{0};
+    std::atomic<int64_t> rejected_{0};
+    std::atomic<int64_t> deduplicated_{0};
+
+    // Deduplication state (worker thread only)
+    std::unordered_map<std::string, Stored> last_stored_;
+    video::BinaryFrame dedup_bits_;
+};
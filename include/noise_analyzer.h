@@ -11,17 +11,86 @@
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgcodecs.hpp>
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <iosfwd>
 #include <string>
 #include <vector>
 #include <memory>
 
+// Forward declarations
+namespace video {
+    class ThreadPool;
+}
+
+/**
+ * @brief Signal statistics of each detected dot (struct of arrays, index = dot)
+ *
+ * SNR and contrast are taken against the image's global noise region, so a
+ * weak emitter or a dead patch of the target stands out from its neighbours.
+ */
+struct PerDotStatistics {
+    std::vector<float> x;              // Centre column
+    std::vector<float> y;              // Centre row
+    std::vector<float> radius;
+    std::vector<int> pixels;           // Dot pixels measured
+    std::vector<float> signal_mean;
+    std::vector<float> signal_std;
+    std::vector<float> snr_db;         // (dot mean - noise mean) / noise std, in dB
+    std::vector<float> contrast_ratio; // Dot mean / noise mean
+
+    size_t size() const { return x.size(); }
+
+    /**
+     * @brief Write one CSV row per dot
+     *
+     * @param out Destination
+     * @param source When set, a leading "file" column with this (already quoted) value
+     * @param header Write the header line first
+     */
+    void writeCsv(std::ostream& out, const std::string& source = "", bool header = true) const;
+};
+
+/**
+ * @brief Noise mean and std per block of the sensor (row-major grid)
+ *
+ * Only noise pixels count, so dots and their masks never bias a block;
+ * a block without noise pixels reads NaN. Edge blocks are clipped to the
+ * image.
+ */
+struct LocalNoiseMap {
+    int block_size = 0;                // Block side in pixels
+    int cols = 0;                      // Grid size in blocks
+    int rows = 0;
+    std::vector<int> pixels;           // Noise pixels measured per block
+    std::vector<float> noise_mean;
+    std::vector<float> noise_std;
+
+    size_t size() const { return pixels.size(); }
+
+    /**
+     * @brief Index of the block with the highest noise std (-1 if none has noise pixels)
+     */
+    int worstBlock() const;
+
+    /**
+     * @brief Write one CSV row per block
+     *
+     * @param out Destination
+     * @param source When set, a leading "file" column with this (already quoted) value
+     * @param header Write the header line first
+     */
+    void writeCsv(std::ostream& out, const std::string& source = "", bool header = true) const;
+};
+
 /**
  * @brief Results from noise analysis
  */
 struct NoiseAnalysisResults {
     // Detection results
     int num_dots_detected = 0;
-    std::vector<cv::Vec3f> detected_circles;  // (x, y, radius)
+    std::shared_ptr<const std::vector<cv::Vec3f>> detected_circles;  // (x, y, radius), shared with analyzer
 
     // Signal statistics
     double signal_mean = 0.0;
@@ -41,9 +110,29 @@ struct NoiseAnalysisResults {
     double snr_db = 0.0;           // Signal-to-Noise Ratio in decibels
     double contrast_ratio = 0.0;   // Signal mean / Noise mean
 
-    // Masks
-    cv::Mat signal_mask;  // Boolean mask for signal regions
-    cv::Mat noise_mask;   // Boolean mask for noise regions
+    // Per-dot statistics (analyzeNoise only; live analysis leaves this empty)
+    std::shared_ptr<const PerDotStatistics> per_dot;
+
+    // Local noise map (NoiseAnalyzer::setLocalNoiseBlockSize > 0 only)
+    std::shared_ptr<const LocalNoiseMap> local_noise;
+
+    // Live tracking (NoiseAnalyzer::trackLiveFrame only)
+    int num_dots_tracked = 0;      // Dots found again near their previous position
+    double mean_drift_px = 0.0;    // Mean centroid offset from where the dots were detected
+    double max_drift_px = 0.0;
+    bool redetected = false;       // Too many dots lost; detection ran again on this frame
+
+    // Lattice fit (DotDetectionParams::fit_lattice only)
+    int num_dots_predicted = 0;    // Dots placed by the grid where detection found none
+    int num_dots_rejected = 0;     // Detections off the grid, left out of the masks
+
+    // Masks (shared immutable buffer, never copied per analysis)
+    std::shared_ptr<const cv::Mat> signal_mask;  // Boolean mask for signal regions
+
+    /**
+     * @brief Derive noise mask (inverse of signal mask) on demand
+     */
+    cv::Mat noiseMask() const;
 
     /**
      * @brief Convert results to string for display
@@ -63,6 +152,61 @@ struct DotDetectionParams {
 
     // Morphological operations
     int morph_kernel_size = 3;        // Kernel size for morphological ops
+    bool gpu_morphology = false;      // Threshold + open + close through the morphology backend, if one is set
+
+    // Detector
+    bool use_contours = false;        // Trace contours (perimeter circularity) instead of labelling components
+    bool fit_lattice = false;         // Replace detections by a fitted regular grid (fills missed dots, drops strays)
+};
+
+/**
+ * @brief Regular dot grid fitted to detected centroids
+ *
+ * Dot (i, j) sits at origin + i * basis_u + j * basis_v. Index ranges cover
+ * the detections that fit the grid.
+ */
+struct DotLattice {
+    cv::Point2f origin;
+    cv::Point2f basis_u;
+    cv::Point2f basis_v;
+    float radius = 0.0f;               // Median radius of the fitted detections
+    int min_i = 0, max_i = -1;
+    int min_j = 0, max_j = -1;
+    int inliers = 0;                   // Detections within tolerance of a node
+    int outliers = 0;                  // Detections dropped as misdetections
+    int predicted = 0;                 // Nodes without a detection
+    float rms_residual_px = 0.0f;      // Inlier distance from their node
+
+    bool valid() const { return max_i >= min_i && max_j >= min_j; }
+    cv::Point2f node(int i, int j) const { return origin + basis_u * static_cast<float>(i) + basis_v * static_cast<float>(j); }
+};
+
+/**
+ * @brief SNR and contrast for every binary threshold (index = threshold_value)
+ *
+ * At threshold t the signal is every pixel >= t and the noise every pixel
+ * below, as the detector's thresholding splits the image. Entries are NaN
+ * where either side is empty or the noise has no spread.
+ */
+struct ThresholdSweep {
+    std::array<float, 256> snr_db;
+    std::array<float, 256> contrast_ratio;
+    std::array<int, 256> signal_pixels{};
+    int best_threshold = -1;          // Highest SNR with enough signal pixels and a noise majority
+    float best_snr_db = 0.0f;
+};
+
+/**
+ * @brief A detected dot followed across live frames
+ */
+struct TrackedDot {
+    cv::Point2f origin;              // Centroid when the dot was detected
+    float origin_radius = 0.0f;      // Radius when the dot was detected
+    cv::Point2f center;              // Latest sub-pixel centroid
+    float radius = 0.0f;             // Latest equivalent radius (sqrt(area / pi))
+    float drift_px = 0.0f;           // Distance from origin to center
+    double snr_db = 0.0;             // Dot against the ring of background around it
+    bool tracked = false;            // Found in the latest frame
 };
 
 /**
@@ -98,19 +242,47 @@ public:
     void setImage(const cv::Mat& image);
 
     /**
-     * @brief Detect dots using threshold-based contour detection
+     * @brief Detect dots using binary thresholding and blob analysis
      *
-     * This method uses binary thresholding and contour analysis to detect circular dots.
+     * This method uses binary thresholding and blob analysis to detect circular dots.
      * It's more robust than Hough circles for varying dot intensities.
      *
+     * By default the blobs come from one connected-components pass (area,
+     * bounding box and centroid per dot) and circularity is estimated from
+     * second moments; the label image then becomes the signal mask, so
+     * createMasks() draws nothing. params.use_contours selects the older
+     * findContours path.
+     *
+     * With params.fit_lattice the detections are replaced by the nodes of a
+     * fitted DotLattice (falling back to the detections if no grid fits).
+     *
      * @param params Detection parameters
      * @return Number of dots detected
      */
     int detectDotsThreshold(const DotDetectionParams& params = DotDetectionParams());
 
+    /**
+     * @brief Threshold + MORPH_OPEN + MORPH_CLOSE replacement (gray, threshold, kernel size, binary out)
+     *
+     * Returns false to fall back to the OpenCV path for that detection.
+     */
+    using MorphologyBackend = std::function<bool(const cv::Mat&, int, int, cv::Mat&)>;
+
+    /**
+     * @brief Route the detection cleanup through a backend when params.gpu_morphology is set
+     *
+     * The analyzer stays free of GL: the owner of a GL context (the viewer)
+     * installs video::gpu::GPUMorphologyChain here, and the backend must be
+     * called on that context's thread.
+     */
+    void setMorphologyBackend(MorphologyBackend backend) { m_morphology_backend = std::move(backend); }
+
     /**
      * @brief Create signal and noise masks from detected circles
      *
+     * Without dilation, dots found by the component detector are copied
+     * from the label image (the exact dot pixels); otherwise circles are drawn.
+     *
      * @param dilation_factor Factor to scale circle radius (>1 to include edges)
      * @return true if successful, false if no circles detected
      */
@@ -119,9 +291,15 @@ public:
     /**
      * @brief Analyze noise statistics
      *
+     * Region statistics come from the given signal/noise histograms when
+     * both are passed (e.g. from GPUHistogram::compute_masked() on the
+     * current image and getSignalMask()), else from a CPU sweep.
+     *
+     * @param signal_hist Histogram of the signal pixels (256 bins) or nullptr
+     * @param noise_hist Histogram of the noise pixels (256 bins) or nullptr
      * @return Analysis results
      */
-    NoiseAnalysisResults analyzeNoise();
+    NoiseAnalysisResults analyzeNoise(const uint32_t* signal_hist = nullptr, const uint32_t* noise_hist = nullptr);
 
     /**
      * @brief Complete processing pipeline
@@ -143,6 +321,74 @@ public:
      */
     NoiseAnalysisResults processCurrentImage(const DotDetectionParams& params = DotDetectionParams());
 
+    /**
+     * @brief SNR/contrast curve over all 256 thresholds from one histogram pass
+     *
+     * Prefix sums of the histogram's count, sum and sum of squares give both
+     * sides' mean and std at every threshold in O(256), instead of one
+     * processCurrentImage() per candidate.
+     *
+     * @param image Image to sweep (converted to grayscale if needed)
+     * @param min_signal_pixels Fewest signal pixels a recommended threshold may leave (e.g. min_area)
+     */
+    static ThresholdSweep sweepThresholds(const cv::Mat& image, int min_signal_pixels = 1);
+
+    /**
+     * @brief Check if dot geometry and masks are available for live analysis
+     */
+    bool hasGeometry() const;
+
+    /**
+     * @brief Analyze a live frame against the cached dot geometry
+     *
+     * Reuses the signal/noise masks from the last processCurrentImage()
+     * (no thresholding, morphology or contour search), so only the masked
+     * histogram sweep runs per frame. Suitable for a fixed test target.
+     *
+     * @param frame Live frame (same size as the image the dots were detected on)
+     * @return Analysis results (empty if no geometry or size mismatch)
+     */
+    NoiseAnalysisResults analyzeLiveFrame(const cv::Mat& frame);
+
+    /**
+     * @brief Analyze a live frame from signal/noise histograms computed elsewhere
+     *
+     * Same region statistics, SNR and contrast as analyzeLiveFrame() (no
+     * local noise map) without touching the frame, for histograms built on
+     * the GPU against getSignalMask() (GPUHistogram::compute_masked()).
+     *
+     * @param signal_hist Histogram of the signal pixels (256 bins)
+     * @param noise_hist Histogram of the noise pixels (256 bins)
+     * @return Analysis results (empty if no geometry)
+     */
+    NoiseAnalysisResults analyzeHistograms(const uint32_t signal_hist[256], const uint32_t noise_hist[256]) const;
+
+    /**
+     * @brief Analyze a live frame, following each dot from its previous position
+     *
+     * Each dot's centroid and radius are refined from the moments of the
+     * above-threshold pixels in a small window around where it was last seen,
+     * so the per-frame search costs O(dots), not O(sensor). The signal mask is
+     * redrawn only when a dot moves by half a pixel or more. When fewer than
+     * min_tracked_fraction of the dots are found, detection runs again on
+     * this frame with the last detection parameters.
+     *
+     * @param frame Live frame (same size as the image the dots were detected on)
+     * @param min_tracked_fraction Tracked share below which dots are re-detected
+     * @return Analysis results with tracking fields (empty if no geometry or size mismatch)
+     */
+    NoiseAnalysisResults trackLiveFrame(const cv::Mat& frame, float min_tracked_fraction = 0.5f);
+
+    /**
+     * @brief Grid of the last detection (invalid unless params.fit_lattice found one)
+     */
+    const DotLattice& getLattice() const { return m_lattice; }
+
+    /**
+     * @brief Per-dot state of the last trackLiveFrame() (drift and SNR per dot)
+     */
+    const std::vector<TrackedDot>& getTrackedDots() const { return m_tracks; }
+
     /**
      * @brief Get the loaded image
      */
@@ -161,7 +407,7 @@ public:
     /**
      * @brief Get noise mask
      */
-    const cv::Mat& getNoiseMask() const { return m_noise_mask; }
+    const cv::Mat& getNoiseMask() const;
 
     /**
      * @brief Create visualization of detection results
@@ -185,20 +431,208 @@ public:
      */
     cv::Mat visualizeNoise() const;
 
+    /**
+     * @brief Split region histograms of large images into row bands on the shared thread pool
+     *
+     * @param enabled Use the thread pool (results are identical either way)
+     */
+    void setParallel(bool enabled) { m_parallel = enabled; }
+
+    /**
+     * @brief Run the row bands on a pool of the caller's instead of the shared one
+     *
+     * @param pool Pool to use (nullptr = ThreadPool::shared()); must outlive the analyzer's use of it
+     */
+    void setThreadPool(video::ThreadPool* pool) { m_pool = pool; }
+
+    /**
+     * @brief Build a local noise map with every analysis (0 = off)
+     *
+     * Each analysis then builds integral images of value, value squared and
+     * pixel count over the noise mask (one SIMD pass), and its results carry
+     * the per-block grid at this block size. queryNoiseRegion() answers any
+     * other block size or rectangle from the same tables in O(1).
+     *
+     * @param block_size Block side in pixels
+     */
+    void setLocalNoiseBlockSize(int block_size) { m_local_block_size = std::max(0, block_size); }
+    int getLocalNoiseBlockSize() const { return m_local_block_size; }
+
+    /**
+     * @brief Noise statistics of a rectangle of the last analyzed frame, in O(1)
+     *
+     * @param rect Region (clipped to the image)
+     * @param mean Noise mean of the region
+     * @param std Noise std of the region
+     * @param num_pixels Noise pixels in the region
+     * @return false if no integral images were built or the region has no noise pixels
+     */
+    bool queryNoiseRegion(const cv::Rect& rect, double& mean, double& std, int& num_pixels) const;
+
+    /**
+     * @brief Local noise map of the last analyzed frame at any block size (O(1) per block)
+     *
+     * @return nullptr if no integral images were built
+     */
+    std::shared_ptr<LocalNoiseMap> computeLocalNoiseMap(int block_size) const;
+
 private:
     cv::Mat m_image;                          // Grayscale image
     cv::Mat m_signal_mask;                    // Boolean mask for signal
-    cv::Mat m_noise_mask;                     // Boolean mask for noise
+    mutable cv::Mat m_noise_mask;             // Inverse of signal mask, derived on first use
     std::vector<cv::Vec3f> m_detected_circles;  // Detected circles (x, y, radius)
 
+    // Immutable geometry handed to results (replaced, never modified, by createMasks)
+    std::shared_ptr<const cv::Mat> m_shared_signal_mask;
+    std::shared_ptr<const std::vector<cv::Vec3f>> m_shared_circles;
+
+    // Component detector output, consumed by createMasks (empty after contour detection)
+    cv::Mat m_labels;                         // CV_32S component labels of the last detection
+    cv::Mat m_component_stats;                // connectedComponentsWithStats rows per label
+    std::vector<int> m_accepted_labels;       // Labels kept as dots, in m_detected_circles order
+
+    /**
+     * @brief Drop masks and detection results (new image)
+     */
+    void clearGeometry();
+
+    /**
+     * @brief Contour tracing detector (DotDetectionParams::use_contours)
+     */
+    void detectContours(const cv::Mat& binary, const DotDetectionParams& params);
+
     /**
-     * @brief Calculate statistics for masked region
+     * @brief Connected-components detector with moment-based circularity
+     */
+    void detectComponents(const cv::Mat& binary, const DotDetectionParams& params);
+
+    // Lattice model (DotDetectionParams::fit_lattice)
+    struct MaskSpan {
+        int y;
+        int x0;                               // Inclusive column range
+        int x1;
+        int dot;                              // Index into m_detected_circles
+    };
+    DotLattice m_lattice;
+    bool m_lattice_active = false;            // m_detected_circles are m_lattice's nodes
+    std::vector<MaskSpan> m_lattice_spans;    // Disc rows of every node, built once per lattice
+    int m_span_radius = -1;                   // Disc radius the spans were built for
+    cv::Size m_span_size;                     // Image size the spans were clipped to
+    static constexpr size_t LATTICE_MIN_DOTS = 6;
+    static constexpr int LATTICE_NEIGHBOURS = 4;      // Nearest neighbours voting for the basis directions
+    static constexpr float LATTICE_TOLERANCE = 0.25f; // Inlier distance, as a share of the shorter basis
+
+    /**
+     * @brief Fit a DotLattice to m_detected_circles and replace them by its nodes
+     *
+     * The two basis directions are the strongest peaks of the folded angle
+     * histogram of nearest-neighbour vectors; each detection then gets integer
+     * indices and the model is refined by least squares over the inliers.
+     * A lattice matching the previous one keeps its span list.
+     *
+     * @return true if a grid was fitted
+     */
+    bool fitLattice();
+
+    /**
+     * @brief Build m_lattice_spans for a disc radius (no-op when already built for it)
+     */
+    void buildLatticeSpans(int radius);
+    cv::Mat m_live_gray;                      // Reused conversion buffer for live frames
+    bool m_parallel = true;
+    video::ThreadPool* m_pool = nullptr;      // nullptr = shared pool
+    static constexpr int64_t PARALLEL_MIN_PIXELS = 256 * 1024;
+
+    // Live tracking
+    DotDetectionParams m_params;              // Last detection parameters (re-detection, track threshold)
+    std::vector<TrackedDot> m_tracks;         // One per detected circle, reset by createMasks
+    static constexpr int TRACK_SEARCH_PX = 3;         // Largest centroid move between frames
+    static constexpr int TRACK_RING_PX = 3;           // Background ring width for per-dot SNR
+    static constexpr float TRACK_MIN_AREA_RATIO = 0.25f;  // Area below this share of the detected one = lost
+
+    /**
+     * @brief Grayscale view of a live frame (converted into m_live_gray if needed)
+     */
+    const cv::Mat& liveGray(const cv::Mat& frame);
+
+    /**
+     * @brief Refine one dot from the window around its last position
+     *
+     * @return true if the dot was found
+     */
+    bool refineTrack(const cv::Mat& gray, TrackedDot& dot) const;
+
+    /**
+     * @brief Redraw the signal mask at the tracked positions and publish it
+     */
+    void publishTrackedGeometry();
+
+    /**
+     * @brief Fill region statistics, SNR and contrast for an image using the cached masks
+     */
+    void computeRegionStatistics(const cv::Mat& image, NoiseAnalysisResults& results) const;
+
+    /**
+     * @brief Fill region statistics, SNR and contrast from the two region histograms
+     */
+    static void regionStatsFromHistograms(const uint32_t signal_hist[256], const uint32_t noise_hist[256],
+                                          NoiseAnalysisResults& results);
+
+    /**
+     * @brief Per-dot sums and sums of squares in one pass over a dot label map
+     *
+     * Uses the component label image when there is one, else draws the
+     * circles into m_dot_labels (value = dot index + 1). O(pixels) regardless
+     * of the dot count. Needs the global noise statistics already in results.
+     */
+    void computePerDotStatistics(const cv::Mat& image, NoiseAnalysisResults& results);
+    cv::Mat m_dot_labels;                     // Reused CV_32S map for circle geometry
+
+    /**
+     * @brief Per-dot table for the next result, recycled once no result holds it
+     */
+    std::shared_ptr<PerDotStatistics> acquirePerDotStatistics();
+
+    /**
+     * @brief Blank m_signal_mask at the image size, in place when no result still shares it
+     */
+    void resetSignalMask();
+
+    // Scratch workspace: sized on first use, then reused so repeated analyses of
+    // same-sized frames allocate nothing
+    cv::Mat m_binary;                         // Thresholded and cleaned image
+    cv::Mat m_kernel;                         // Morphology kernel for m_params.morph_kernel_size
+    MorphologyBackend m_morphology_backend;   // Optional fused threshold/open/close (see setMorphologyBackend)
+    cv::Mat m_centroids;                      // connectedComponentsWithStats centroids
+    std::vector<std::vector<cv::Point>> m_contours;  // findContours output (contour detector)
+    std::vector<int> m_dot_of_label;          // Component label -> dot index + 1
+    std::vector<uint64_t> m_dot_sum;          // Per-dot pixel sums (slot 0 = background)
+    std::vector<uint64_t> m_dot_sum_sq;
+    std::vector<int> m_dot_count;
+    mutable std::vector<std::array<uint32_t, 512>> m_hist_bands;  // Parallel region histograms
+    std::vector<std::shared_ptr<PerDotStatistics>> m_per_dot_pool;
+    static constexpr size_t PER_DOT_POOL_SIZE = 4;
+
+    // Local noise map
+    int m_local_block_size = 0;               // 0 = no integral images per analysis
+    cv::Mat m_noise_sum;                      // Masked integral images of the last analyzed frame
+    cv::Mat m_noise_sum_sq;
+    cv::Mat m_noise_count;
+
+    /**
+     * @brief Build the noise integral images of an image and attach the block grid to results
+     */
+    void computeLocalNoise(const cv::Mat& image, NoiseAnalysisResults& results);
+
+    /**
+     * @brief Calculate statistics for a region from its 8-bit histogram
+     *
+     * Mean, std, min and max are exact (integer moments).
      */
-    void calculateRegionStats(const cv::Mat& image,
-                             const cv::Mat& mask,
-                             double& mean,
-                             double& std,
-                             double& min_val,
-                             double& max_val,
-                             int& num_pixels) const;
+    static void calculateRegionStats(const uint32_t histogram[256],
+                                     double& mean,
+                                     double& std,
+                                     double& min_val,
+                                     double& max_val,
+                                     int& num_pixels);
 };
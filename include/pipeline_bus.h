@@ -0,0 +1,307 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "camera/event_processor.h"
+#include "core/metrics.h"
+#include "scattering_analyzer.h"
+#include "video/frame_ref.h"
+
+/**
+ * What a full subscription does with a new message
+ */
+enum class BusOverflow {
+    DropOldest,  // Keep the newest messages (display, streaming: stay current)
+    DropNewest   // Keep the oldest messages (recording: no gaps inside what was kept)
+};
+
+/**
+ * One subscriber's bounded queue on a BusChannel
+ *
+ * Filled by the publishing thread, drained by the subscriber's own thread
+ * with try_pop() or wait_pop(). Messages are handles (FrameRef,
+ * shared_ptr), so a queued message costs a reference, not a copy; a full
+ * queue applies its overflow policy and counts the message as dropped.
+ * Exported as bus.<channel>.<name>.dropped. An optional on_push hook runs
+ * on the publishing thread after each queued message, for consumers that
+ * schedule work rather than block in wait_pop() (see StageGraph).
+ */
+template <typename T>
+class BusSubscription {
+public:
+    BusSubscription(size_t capacity, BusOverflow overflow, core::Counter& dropped,
+                    std::function<void()> on_push = {})
+        : slots_(std::max<size_t>(capacity, 1)), overflow_(overflow), dropped_metric_(dropped),
+          on_push_(std::move(on_push)) {}
+
+    // Non-copyable
+    BusSubscription(const BusSubscription&) = delete;
+    BusSubscription& operator=(const BusSubscription&) = delete;
+
+    /**
+     * Take the oldest queued message
+     * @return false if the queue is empty
+     */
+    bool try_pop(T& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pop_locked(out);
+    }
+
+    /**
+     * Take the oldest queued message, waiting for one
+     * @param timeout_us Maximum wait
+     * @return false on timeout or notify()
+     */
+    bool wait_pop(T& out, int64_t timeout_us) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, std::chrono::microseconds(timeout_us), [this] { return size_ > 0 || woken_; });
+        woken_ = false;
+        return pop_locked(out);
+    }
+
+    /**
+     * Wake a thread blocked in wait_pop() (e.g. on shutdown)
+     */
+    void notify() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            woken_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    /**
+     * Messages waiting (queue occupancy)
+     */
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return size_;
+    }
+
+    size_t capacity() const { return slots_.size(); }
+
+    uint64_t get_received() const { return received_.load(std::memory_order_relaxed); }
+    uint64_t get_dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    template <typename> friend class BusChannel;
+
+    void push(const T& message) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (size_ == slots_.size()) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                dropped_metric_.add();
+                if (overflow_ == BusOverflow::DropNewest) {
+                    return;
+                }
+                slots_[head_] = T{};   // Release the handle now, not when the slot is reused
+                head_ = (head_ + 1) % slots_.size();
+                --size_;
+            }
+            slots_[(head_ + size_) % slots_.size()] = message;
+            ++size_;
+            received_.fetch_add(1, std::memory_order_relaxed);
+        }
+        cv_.notify_one();
+        if (on_push_) {
+            on_push_();
+        }
+    }
+
+    bool pop_locked(T& out) {
+        if (size_ == 0) {
+            return false;
+        }
+        out = std::move(slots_[head_]);
+        slots_[head_] = T{};
+        head_ = (head_ + 1) % slots_.size();
+        --size_;
+        return true;
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<T> slots_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+    bool woken_ = false;
+    const BusOverflow overflow_;
+    core::Counter& dropped_metric_;
+    const std::function<void()> on_push_;
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+/**
+ * Typed fan-out channel of the PipelineBus
+ *
+ * publish() hands the message to every subscription's queue and never
+ * blocks on a subscriber: the subscriber list is an immutable snapshot
+ * swapped on (un)subscribe, and each queue lock is held for one handle
+ * copy. With no subscriber, has_subscribers() is one relaxed load, so
+ * producers skip building the message altogether.
+ */
+template <typename T>
+class BusChannel {
+public:
+    using Subscription = BusSubscription<T>;
+
+    explicit BusChannel(std::string name) : name_(std::move(name)),
+        subscribers_(std::make_shared<const std::vector<std::shared_ptr<Subscription>>>()) {}
+
+    // Non-copyable
+    BusChannel(const BusChannel&) = delete;
+    BusChannel& operator=(const BusChannel&) = delete;
+
+    /**
+     * Add a subscriber with its own queue
+     * @param name Subscriber name (metrics: bus.<channel>.<name>.dropped)
+     * @param capacity Queued messages before the overflow policy applies
+     * @param overflow What a full queue drops
+     * @param on_push Called on the publishing thread after each queued message (must not block)
+     * @return Subscription to drain; keep it until unsubscribe()
+     */
+    std::shared_ptr<Subscription> subscribe(const std::string& name, size_t capacity, BusOverflow overflow,
+                                            std::function<void()> on_push = {}) {
+        auto subscription = std::make_shared<Subscription>(capacity, overflow,
+            core::MetricsRegistry::instance().counter("bus." + name_ + "." + name + ".dropped"), std::move(on_push));
+        std::lock_guard<std::mutex> lock(subscribe_mutex_);
+        auto next = std::make_shared<std::vector<std::shared_ptr<Subscription>>>(*std::atomic_load(&subscribers_));
+        next->push_back(subscription);
+        std::atomic_store(&subscribers_, std::shared_ptr<const std::vector<std::shared_ptr<Subscription>>>(next));
+        count_.store(static_cast<int>(next->size()), std::memory_order_relaxed);
+        return subscription;
+    }
+
+    /**
+     * Remove a subscriber (messages already queued stay poppable)
+     */
+    void unsubscribe(const std::shared_ptr<Subscription>& subscription) {
+        std::lock_guard<std::mutex> lock(subscribe_mutex_);
+        auto next = std::make_shared<std::vector<std::shared_ptr<Subscription>>>(*std::atomic_load(&subscribers_));
+        next->erase(std::remove(next->begin(), next->end(), subscription), next->end());
+        std::atomic_store(&subscribers_, std::shared_ptr<const std::vector<std::shared_ptr<Subscription>>>(next));
+        count_.store(static_cast<int>(next->size()), std::memory_order_relaxed);
+    }
+
+    bool has_subscribers() const { return count_.load(std::memory_order_relaxed) > 0; }
+
+    /**
+     * Queue a message for every subscriber (any thread, never blocks on a subscriber)
+     */
+    void publish(const T& message) {
+        const auto subscribers = std::atomic_load(&subscribers_);
+        for (const auto& subscription : *subscribers) {
+            subscription->push(message);
+        }
+    }
+
+    const std::string& name() const { return name_; }
+
+private:
+    const std::string name_;
+    std::mutex subscribe_mutex_;
+    std::shared_ptr<const std::vector<std::shared_ptr<Subscription>>> subscribers_;  // Swapped, never modified
+    std::atomic<int> count_{0};
+};
+
+/**
+ * In-process publish/subscribe bus for the pipeline's fan-out
+ *
+ * Four typed channels, published where the data is produced:
+ * - events: every ingested batch (frame coordinates, after the hot pixel
+ *   mask and noise filter), from each camera's accumulation thread
+ * - frames: every binary frame stored for display (FrameRef of the frame
+ *   pool slot or the accumulator's frame), from the frame callback
+ * - window_stats: every completed EventProcessor window, from the
+ *   accumulation thread
+ * - analysis: every scattering snapshot a ScatteringWorker publishes
+ *
+ * A consumer (display, analysis, recording, streaming, a tool) subscribes
+ * with its own queue depth and overflow policy and drains it on its own
+ * thread, instead of adding a callback, copy or lock to the camera path.
+ * Payloads are shared handles: frames pin their pool slot, and event
+ * batches come from a pool of EVENT_BUFFERS reused once no subscriber
+ * holds them, so subscriptions should stay shallow (a few messages).
+ * A batch published while every buffer is held is dropped and counted as
+ * bus.events.no_buffer.
+ *
+ * **Usage:**
+ * ```cpp
+ * auto frames = PipelineBus::instance().frames().subscribe("recorder", 4, BusOverflow::DropNewest);
+ * PipelineBus::FrameMessage message;
+ * while (running && frames->wait_pop(message, 100000)) { write(message.frame); }
+ * PipelineBus::instance().frames().unsubscribe(frames);
+ * ```
+ */
+class PipelineBus {
+public:
+    static constexpr int EVENT_BUFFERS = 16;
+
+    struct EventBatch {
+        int camera_index = 0;
+        std::vector<Metavision::EventCD> events;
+    };
+
+    struct EventMessage {
+        int camera_index = 0;
+        std::shared_ptr<const EventBatch> batch;
+    };
+
+    struct FrameMessage {
+        int camera_index = 0;
+        video::FrameRef frame;               // CV_8UC1 0/255 with FrameTiming set
+    };
+
+    struct WindowStatsMessage {
+        int camera_index = 0;
+        EventCamera::EventProcessor::WindowStats window;
+    };
+
+    struct AnalysisMessage {
+        int camera_index = 0;
+        std::shared_ptr<const ScatteringAnalyzer::ScatteringData> scattering;
+    };
+
+    static PipelineBus& instance();
+
+    // Non-copyable
+    PipelineBus(const PipelineBus&) = delete;
+    PipelineBus& operator=(const PipelineBus&) = delete;
+
+    BusChannel<EventMessage>& events() { return events_; }
+    BusChannel<FrameMessage>& frames() { return frames_; }
+    BusChannel<WindowStatsMessage>& window_stats() { return window_stats_; }
+    BusChannel<AnalysisMessage>& analysis() { return analysis_; }
+
+    /**
+     * Copy a batch into a pooled buffer and publish it (no-op without subscribers)
+     * @param camera_index Camera the events belong to
+     * @param begin First event
+     * @param end One past last event
+     */
+    void publish_events(int camera_index, const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+private:
+    PipelineBus();
+    ~PipelineBus() = default;
+
+    BusChannel<EventMessage> events_{"events"};
+    BusChannel<FrameMessage> frames_{"frames"};
+    BusChannel<WindowStatsMessage> window_stats_{"window_stats"};
+    BusChannel<AnalysisMessage> analysis_{"analysis"};
+
+    std::mutex event_buffers_mutex_;
+    std::vector<std::shared_ptr<EventBatch>> event_buffers_;
+    core::Counter& events_no_buffer_;
+};
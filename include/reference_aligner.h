@@ -0,0 +1,94 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include "video/binary_frame.h"
+
+/**
+ * ReferenceAligner - Estimates how far live frames have moved from the reference
+ *
+ * Scattering is live AND NOT reference, so a one-pixel mechanical shift of
+ * the target turns every dot edge into scattering. Live frames are OR-ed
+ * into an accumulation (one pass over packed words per frame); estimate()
+ * then runs, at most every few seconds:
+ *
+ * 1. Phase correlation of the accumulation and the reference, both area-
+ *    downsampled by DOWNSAMPLE, for a sub-pixel coarse shift.
+ * 2. A search of whole-pixel offsets within REFINE_RADIUS of the coarse
+ *    shift (and of the current offset), scoring each by the popcount of
+ *    live AND NOT shifted reference on the packed rows.
+ *
+ * The chosen offset is applied by shifting the packed reference once
+ * (BinaryFrame::shift), so per-frame scattering costs nothing extra.
+ * Not thread-safe: owned by the ScatteringWorker thread.
+ */
+class ReferenceAligner {
+public:
+    struct Estimate {
+        cv::Point2f shift;                 // Sub-pixel phase-correlation shift of live relative to reference
+        double response = 0.0;             // Phase-correlation peak (0-1, higher = more trustworthy)
+        cv::Point offset;                  // Whole-pixel offset to apply to the reference
+        int64_t unmatched_before = 0;      // Live pixels outside the reference at the current offset
+        int64_t unmatched_after = 0;       // Same at the chosen offset
+    };
+
+    /**
+     * Set the reference and clear the accumulation
+     * @param reference Packed reference (unshifted)
+     */
+    void set_reference(const video::BinaryFrame& reference);
+
+    /**
+     * Largest offset estimate() may return in either axis (pixels)
+     */
+    void set_max_shift(int max_shift_px) { max_shift_px_ = max_shift_px > 0 ? max_shift_px : 1; }
+
+    /**
+     * OR a live frame into the accumulation (ignored if its size differs)
+     */
+    void accumulate(const video::BinaryFrame& live);
+
+    /**
+     * Frames accumulated since the last estimate
+     */
+    int64_t accumulated_frames() const { return frames_; }
+
+    /**
+     * Estimate the offset from the accumulation, then clear it
+     *
+     * The offset only changes when it explains at least MIN_IMPROVEMENT of
+     * the unmatched live pixels better than current_offset, so noise does
+     * not make it jitter.
+     * @param current_offset Offset the reference is shifted by now
+     * @param out Estimate (offset = current_offset if nothing better was found)
+     * @return false if too few live pixels were accumulated
+     */
+    bool estimate(const cv::Point& current_offset, Estimate& out);
+
+private:
+    static constexpr int DOWNSAMPLE = 4;
+    static constexpr int REFINE_RADIUS = 2;
+    static constexpr int64_t MIN_ACTIVE_PIXELS = 64;
+    static constexpr double MIN_RESPONSE = 0.05;      // Below this the coarse shift is ignored
+    static constexpr double MIN_IMPROVEMENT = 0.05;   // Share of unmatched pixels a new offset must remove
+
+    /**
+     * Popcount of live AND NOT (reference shifted by offset)
+     */
+    int64_t unmatched(const cv::Point& offset);
+
+    /**
+     * Area-downsampled float copy of a packed frame for phase correlation
+     */
+    void downsample(const video::BinaryFrame& frame, cv::Mat& out);
+
+    video::BinaryFrame reference_;
+    video::BinaryFrame accumulation_;
+    video::BinaryFrame shifted_;           // Scratch for the offset search
+    cv::Mat reference_small_;              // CV_32F, downsampled once per reference
+    cv::Mat live_small_;
+    cv::Mat unpacked_;                     // Scratch CV_8UC1 for downsampling
+    cv::Mat window_;                       // Hanning window of the downsampled size
+    int max_shift_px_ = 16;
+    int64_t frames_ = 0;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "video/binary_frame.h"
+
+/**
+ * ReferenceBuilder - Scattering reference from a temporal majority vote
+ *
+ * A single captured frame is as noisy as any other, so its scattering
+ * pixels become part of the baseline. The builder counts, per pixel, how
+ * many of K packed live frames had it set, and keeps the pixels set in at
+ * least an occupancy fraction of them.
+ *
+ * Counters are bit-sliced: bit b of every pixel's count lives in plane b,
+ * packed like the frames, so adding a frame is a ripple-carry add of one
+ * bit across ceil(log2(K + 1)) planes (AND / XOR per word, 64 pixels at a
+ * time) and thresholding is a bitwise compare against the constant. K is at
+ * most MAX_FRAMES, so counters never overflow.
+ */
+class ReferenceBuilder {
+public:
+    static constexpr int MAX_FRAMES = 255;
+
+    /**
+     * Clear the counters and start counting
+     * @param width Frame width
+     * @param height Frame height
+     * @param frames Frames to accumulate (clamped to 1..MAX_FRAMES)
+     */
+    void start(int width, int height, int frames);
+
+    /**
+     * Count one frame (ignored once complete or if its size differs)
+     * @return true if this frame completed the set
+     */
+    bool add(const video::BinaryFrame& frame);
+
+    /**
+     * Threshold the counters into a reference
+     * @param occupancy Fraction of the counted frames a pixel must be set in (0-1)
+     * @param out Reference (pixels set in at least max(1, ceil(occupancy * frames)) frames)
+     * @return false if no frame has been counted
+     */
+    bool build(float occupancy, video::BinaryFrame& out) const;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int frames() const { return frames_; }
+    int target() const { return target_; }
+    bool complete() const { return target_ > 0 && frames_ >= target_; }
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    int target_ = 0;
+    int frames_ = 0;
+    int bits_ = 0;                  // Counter planes
+    size_t words_ = 0;              // Words per plane (same layout as BinaryFrame)
+    std::vector<uint64_t> planes_;  // bits_ planes, plane-major
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "scattering_analyzer.h"
+#include "video/line_defect_detector.h"
+#include "video/pixel_rate_monitor.h"
+#include "video/pixel_toggle_analyzer.h"
+
+/**
+ * RunReport - Writes the end-of-run report package on a background thread
+ *
+ * Closing a reliability run used to mean exporting CSVs and heatmap PNGs by
+ * hand and pasting them into a document. The owner gathers what only it
+ * can read cheaply (analyzer snapshots, flagged pixels, line defects, file
+ * paths) into Inputs and calls start(); everything slow happens on the
+ * report thread: reading the run log, replaying the heatmap timeline,
+ * loading a checkpoint when there is no snapshot, rendering plots and
+ * heatmaps into PNGs with OpenCV (no GL context) and writing the package:
+ *
+ * - index.html: run summary, then per camera the final heatmap, heatmap
+ *   snapshots over the run, event rate / scattering / latency time series
+ *   and hot-pixel, line-defect and region tables (a print stylesheet makes
+ *   the browser's "Print to PDF" the PDF version)
+ * - the PNGs it shows, and hot_pixels / series CSVs of the same numbers
+ *
+ * The camera is released before the report is started, so the next run on
+ * the rig can begin while this one is still being written.
+ *
+ * **Usage:**
+ * ```cpp
+ * RunReport::Inputs inputs;                      // Owner thread
+ * inputs.directory = run_stem + "_report";
+ * inputs.run_log = run_stem + ".runlog";
+ * inputs.cameras.push_back(camera);
+ * report.start(std::move(inputs));               // Never blocks on the writing
+ * report.wait();                                 // Before exiting
+ * ```
+ */
+class RunReport {
+public:
+    using Entries = std::vector<std::pair<std::string, std::string>>;   // Label, value
+
+    /**
+     * What one camera contributes
+     */
+    struct Camera {
+        int index = 0;
+        std::string serial;
+        std::shared_ptr<const ScatteringAnalyzer::ScatteringData> scattering;   // Final snapshot (null = none)
+        std::string checkpoint;                  // .rtshard used when there is no snapshot
+        std::string heatmap_timeline;            // .rtheat of the run ("" = none)
+        std::vector<video::FlaggedPixel> flagged;
+        std::vector<video::LineDefect> defects;
+        bool toggles_enabled = false;
+        video::ToggleClasses toggles;
+        Entries summary;                         // Extra per-camera figures (events, drops, ...)
+    };
+
+    struct Inputs {
+        std::string title = "Reliability run";
+        std::string directory;                   // Package directory (created)
+        std::string run_log;                     // .runlog ("" = no time series)
+        Entries summary;                         // Run-wide figures, in order
+        std::vector<std::string> files;          // Other artifacts linked from the report (missing ones skipped)
+        std::vector<Camera> cameras;
+    };
+
+    static constexpr size_t MAX_TABLE_ROWS = 100;       // Longer tables are cut (the CSVs keep every row)
+    static constexpr int TIMELINE_THUMBNAILS = 6;       // Heatmap snapshots shown across the run
+    static constexpr size_t MAX_PLOT_POINTS = 1500;     // Time series buckets per plot
+
+    RunReport() = default;
+    ~RunReport() { wait(); }
+
+    // Non-copyable
+    RunReport(const RunReport&) = delete;
+    RunReport& operator=(const RunReport&) = delete;
+
+    /**
+     * Start writing a report on the report thread
+     * @param inputs Everything the report shows (moved to the thread)
+     * @return false if the previous report is still being written
+     */
+    bool start(Inputs inputs);
+
+    /**
+     * Wait for the report being written, if any
+     */
+    void wait();
+
+    bool is_busy() const { return busy_.load(); }
+
+    /**
+     * index.html of the last report written ("" = none yet)
+     */
+    std::string get_last_report() const;
+
+    int64_t get_written() const { return written_.load(); }
+    int64_t get_failed() const { return failed_.load(); }
+
+    /**
+     * Write a report package on the calling thread
+     * @param inputs Report contents
+     * @param index_path Set to the package's index.html
+     * @return false if the directory or index.html cannot be written
+     */
+    static bool write(const Inputs& inputs, std::string& index_path);
+
+private:
+    std::thread thread_;
+    std::atomic<bool> busy_{false};
+
+    mutable std::mutex mutex_;
+    std::string last_report_;               // Guarded by mutex_
+
+    std::atomic<int64_t> written_{0};
+    std::atomic<int64_t> failed_{0};
+};
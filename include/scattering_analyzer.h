@@ -1,7 +1,20 @@
 #pragma once
 
 #include <opencv2/core.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
+#include "video/binary_frame.h"
+#include "video/run_frame.h"
+
+// Forward declarations
+namespace video {
+    class ThreadPool;
+}
+class AnalysisShard;
 
 /**
  * ScatteringAnalyzer - Detects and tracks noise pixels in event camera data
@@ -9,27 +22,200 @@
  * "Scattering" refers to pixels that appear in the live camera feed but were
  * NOT present in the reference/baseline image. These represent noise or
  * unreliable pixels that should be monitored for reliability testing.
+ *
+ * Temporal counts start in sparse mode (hash map of touched pixels), which
+ * suits healthy sensors where only a tiny fraction of pixels ever scatter,
+ * and switch to a dense accumulator once the touched fraction exceeds the
+ * density threshold. The dense plane is CV_16UC1 (2 bytes per pixel, so two
+ * cameras' planes stay in L3): a pixel that reaches 65535 stays saturated
+ * there and its excess is kept in a small overflow map.
+ *
+ * With the tile map enabled, the same scan also sums scattering per
+ * TILE x TILE block: each non-zero mask word spans four tiles, so it costs
+ * four 16-bit popcounts, giving a coarse density map to find where
+ * scattering concentrates before looking at individual pixels.
+ *
+ * Extra comparison references (set_comparison_references) are scored in one
+ * more sweep that loads each live word once and tests it against every
+ * reference word at that position, so comparing against N baselines costs
+ * one pass over the live frame rather than N analyzers re-reading it.
  */
 class ScatteringAnalyzer {
 public:
+    static constexpr int TILE = 16;        // Tile map block side in pixels (a packed word spans 4 tiles)
+    static constexpr int MAX_REFERENCES = 8;   // Analyzed reference plus comparison references
+    static constexpr int CLUSTER_BINS = 8;     // Cluster size histogram: 1, 2, 3-4, 5-8, ... 33-64, 65+ pixels
+
+    /**
+     * Packed reference shared between analyzers (ImageManager::load_binary hands these out)
+     */
+    using ReferenceHandle = std::shared_ptr<const video::BinaryFrame>;
+
+    /**
+     * Temporal count of a single pixel
+     */
+    struct PixelCount {
+        cv::Point location;
+        int32_t count;
+    };
+
+    /**
+     * Entry of the streaming top-K hot pixel list
+     */
+    struct HotPixel {
+        cv::Point location;
+        int32_t count;
+        int first_seen_frame;              // Frame index of first scattering
+        int last_seen_frame;               // Frame index of most recent scattering
+    };
+
+    /**
+     * Named rectangle with its own statistics (see set_regions)
+     */
+    struct Region {
+        std::string name;
+        cv::Rect rect;
+    };
+
+    /**
+     * Per-region counters, updated every analyzed frame
+     */
+    struct RegionStats {
+        std::string name;
+        cv::Rect rect;                     // Clipped to the frame (empty = outside)
+        int area = 0;                      // Pixels in rect
+        int reference_pixels = 0;          // Set reference pixels in rect
+
+        // Current frame
+        int live_pixels = 0;               // Set live pixels
+        int scattering_pixels = 0;         // Live AND NOT reference
+        int missing_pixels = 0;            // Reference AND NOT live
+        float scattering_percentage = 0.0f;  // Of area
+        float missing_percentage = 0.0f;     // Of reference_pixels
+
+        // Since start/reset
+        int64_t total_scattering_events = 0;
+        int64_t total_missing_events = 0;
+        int max_scattering_pixels = 0;     // Worst single frame
+        float average_scattering_per_frame = 0.0f;
+        float average_missing_per_frame = 0.0f;
+    };
+
+    /**
+     * Named baseline scored alongside the analyzed reference (see set_comparison_references)
+     */
+    struct Reference {
+        std::string name;
+        ReferenceHandle bits;              // Shared, never copied by the analyzer
+    };
+
+    /**
+     * Whole-frame counters against one reference, updated every analyzed frame
+     */
+    struct ReferenceStats {
+        std::string name;
+        int reference_pixels = 0;          // Set reference pixels
+
+        // Current frame
+        int scattering_pixels = 0;         // Live AND NOT reference
+        int missing_pixels = 0;            // Reference AND NOT live
+        float scattering_percentage = 0.0f;  // Of the frame
+        float missing_percentage = 0.0f;     // Of reference_pixels
+
+        // Since start/reset
+        int64_t total_scattering_events = 0;
+        int64_t total_missing_events = 0;
+        float average_scattering_per_frame = 0.0f;
+        float average_missing_per_frame = 0.0f;
+    };
+
+    /**
+     * Scattering of one bit plane of the live frame (see set_plane_sweep)
+     */
+    struct PlaneStats {
+        int live_pixels = 0;               // Pixels with this bit set
+        int scattering_pixels = 0;         // Bit set AND NOT reference
+        float scattering_percentage = 0.0f;
+        int64_t total_scattering_events = 0;
+        float average_scattering_per_frame = 0.0f;
+    };
+
+    /**
+     * 8-connected clusters of scattering pixels (see set_cluster_stats)
+     */
+    struct ClusterStats {
+        // Current frame
+        int clusters = 0;
+        int largest_pixels = 0;            // Pixels in the largest cluster
+        cv::Rect largest_rect;             // Its bounding box
+        std::array<int, CLUSTER_BINS> histogram{};    // Clusters per size bin (see cluster_bin)
+
+        // Since start/reset
+        int64_t total_clusters = 0;
+        int64_t total_single_pixel = 0;    // Clusters of one isolated pixel
+        int max_largest_pixels = 0;        // Largest cluster of any frame
+        float average_clusters_per_frame = 0.0f;
+        std::array<int64_t, CLUSTER_BINS> total_histogram{};
+    };
+
     struct ScatteringData {
         // Current frame analysis
-        cv::Mat scattering_mask;           // Binary mask: 255 = scattering pixel
+        video::BinaryFrame scattering_bits; // Packed mask: 1 = scattering pixel
+        cv::Mat scattering_mask;           // Binary mask: 255 = scattering pixel (filled by cv::Mat overload only)
         int current_scattering_pixels;     // Count of scattering pixels in current frame
         float current_scattering_percentage;
 
         // Temporal tracking
-        cv::Mat scattering_count;          // Accumulator: tracks how many times each pixel scattered
-        cv::Mat scattering_heatmap;        // Visualization (0-255 intensity)
+        cv::Mat scattering_count;          // Dense CV_32SC1 counts, filled for published snapshots only (see copy_counts_to)
+        cv::Mat scattering_heatmap;        // Visualization (0-255 intensity, scale refreshed as max grows)
         int frames_analyzed;               // Number of frames processed
 
         // Hot spot detection
         int max_scattering_count;          // Highest count for any single pixel
         cv::Point hot_spot_location;       // Location of most frequently scattering pixel
+        std::vector<HotPixel> hot_pixels;  // Top-K worst pixels, highest count first
 
         // Overall statistics
         int total_scattering_events;       // Sum of all scattering across all frames
         float average_scattering_per_frame;
+
+        // Confidence in average_scattering_per_frame (see set_confidence_target)
+        float scattering_std_per_frame = 0.0f;  // Sample standard deviation of per-frame counts (Welford)
+        float scattering_ci_half_width = 0.0f;  // 95 % interval is average +/- this (pixels per frame)
+        bool scattering_converged = false;      // Half-width within the target after the minimum frames
+
+        // Sliding window over the last window_frames frames (see set_window)
+        cv::Mat window_count;              // CV_16UC1 per-pixel count within the window (empty = disabled)
+        int window_frames;                 // Frames currently in the window (<= configured size)
+        int64_t window_scattering_events;  // Sum of scattering pixels within the window
+        float window_average_per_frame;
+
+        // Exponential decay (see set_decay)
+        cv::Mat decay_rate;                // CV_16UC1 per-pixel EWMA scattering probability, 65535 = 1.0 (empty = disabled)
+        float decay_scattering_per_frame;  // EWMA of current_scattering_pixels
+
+        // Regions of interest, in set_regions order (empty = none configured)
+        std::vector<RegionStats> regions;
+
+        // Bit planes of the live frame, index = bit (empty = plane sweep disabled)
+        std::vector<PlaneStats> planes;
+
+        // Connected scattering clusters (all zero while set_cluster_stats is off)
+        ClusterStats clusters;
+
+        // Side by side: [0] = the analyzed reference, then the comparison references
+        // (empty = no comparison references)
+        std::vector<ReferenceStats> references;
+
+        // Scattering per TILE x TILE block, tile (0, 0) at the top left (empty = tile map disabled)
+        cv::Mat tile_scattering;           // CV_16UC1 scattering pixels per tile, current frame
+        cv::Mat tile_scattering_total;     // CV_32SC1 since start/reset
+        cv::Point hot_tile;                // Tile with the highest total (tile coordinates)
+
+        // Reference alignment (see set_reference_offset and ReferenceAligner)
+        cv::Point reference_offset;        // Whole pixels the reference is shifted by
+        cv::Point2f alignment_shift;       // Last sub-pixel estimate
+        float alignment_response = 0.0f;   // Its phase-correlation peak (0 = never estimated)
     };
 
     ScatteringAnalyzer();
@@ -42,6 +228,23 @@ public:
      */
     bool start_analysis(const cv::Mat& reference_image);
 
+    /**
+     * Start new scattering analysis with a packed reference image
+     * @param reference_image The baseline image (bit-packed)
+     * @return true if analysis started successfully
+     */
+    bool start_analysis(const video::BinaryFrame& reference_image);
+
+    /**
+     * Start new scattering analysis with a shared packed reference
+     *
+     * The handle is kept rather than the frame copied, so analyzers started
+     * from the same reference (one per camera) hold a single original.
+     * @param reference_image The baseline image (bit-packed, not null)
+     * @return true if analysis started successfully
+     */
+    bool start_analysis(ReferenceHandle reference_image);
+
     /**
      * Analyze current frame for scattering pixels
      * @param live_image Current camera frame (binary, grayscale)
@@ -49,6 +252,94 @@ public:
      */
     bool analyze_frame(const cv::Mat& live_image);
 
+    /**
+     * Analyze a frame and each of its bit planes (plane sweep, no mask unpacking)
+     *
+     * The frame is split into 8 packed planes in one pass and the OR of the
+     * planes in the live mask is analyzed as usual. The planes are scored
+     * into ScatteringData::planes while set_plane_sweep is on.
+     *
+     * @param live_image Current camera frame (CV_8UC1)
+     * @return true if analysis successful
+     */
+    bool analyze_planes(const cv::Mat& live_image);
+
+    /**
+     * Analyze packed frame for scattering pixels (no unpacking)
+     *
+     * With an occupancy map, block rows empty in both this frame and the
+     * last mask are skipped outright and empty blocks only clear their mask word.
+     *
+     * @param live_image Current camera frame (bit-packed)
+     * @param blocks Blocks that may hold live pixels (FrameRef::block_map(), nullptr = anywhere)
+     * @return true if analysis successful
+     */
+    bool analyze_frame(const video::BinaryFrame& live_image, const video::BlockMap* blocks = nullptr);
+
+    /**
+     * Analyze one window given only its scattering pixels (event-driven, see video::ScatteringEventTap)
+     *
+     * The pixels were already tested against get_analyzed_reference() and
+     * are listed once each, so only they are counted and refreshed in the
+     * heatmap; the previous window's pixels are cleared from the mask.
+     * Requires supports_touched_input().
+     *
+     * @param keys Scattering pixels, key = y * width + x
+     * @return true if analysis successful
+     */
+    bool analyze_touched(const std::vector<uint32_t>& keys);
+
+    /**
+     * Analyze a very sparse frame given as runs (see video::RunFrame::prefer)
+     *
+     * Scattering is live AND NOT reference on runs, so the cost follows the
+     * frame's runs rather than its size; the pixels are then counted as by
+     * analyze_touched(). Requires supports_touched_input().
+     *
+     * @param live_runs Current camera frame (runs of set pixels)
+     * @return true if analysis successful
+     */
+    bool analyze_runs(const video::RunFrame& live_runs);
+
+    /**
+     * Check if the configured statistics can be kept from scattering pixels alone
+     *
+     * Regions, comparison references and the plane sweep need the live
+     * frame (missing pixels, other baselines, bit planes); the tile map and a
+     * polarity live mask are only filled from frames.
+     */
+    bool supports_touched_input() const {
+        return !plane_sweep_ && !tile_map_ && regions_.empty() && comparison_references_.empty() &&
+               live_mask_ == 0xFF;
+    }
+
+    /**
+     * Reference as analyzed, shifted by ScatteringData::reference_offset
+     */
+    const video::BinaryFrame& get_analyzed_reference() const { return reference_bits_; }
+
+    /**
+     * Shift the reference to follow the target (counts and statistics are kept)
+     *
+     * The packed reference is translated once, so per-frame analysis is
+     * unchanged; region reference counts are taken again.
+     * @param offset Whole-pixel translation from the original reference
+     */
+    void set_reference_offset(const cv::Point& offset);
+
+    /**
+     * Record the estimate an offset came from (reported in ScatteringData)
+     */
+    void set_alignment_estimate(const cv::Point2f& shift, float response);
+
+    /**
+     * Original (unshifted) packed reference
+     */
+    const video::BinaryFrame& get_reference() const {
+        return reference_original_ ? *reference_original_ : reference_bits_;
+    }
+    const ReferenceHandle& get_reference_handle() const { return reference_original_; }
+
     /**
      * Stop current analysis and reset
      */
@@ -86,12 +377,397 @@ public:
      */
     void reset_temporal_data();
 
+    /**
+     * Configure sparse count storage (takes effect on next start/reset)
+     * @param enabled Start in sparse mode
+     * @param density_threshold Touched-pixel fraction above which counts switch to dense
+     */
+    void set_sparse_mode(bool enabled, float density_threshold = 0.01f);
+
+    /**
+     * Skip heatmap refreshes while set (load shedding; counts and statistics are unaffected)
+     *
+     * The first refresh after a skipped one rebuilds the whole heatmap.
+     */
+    void set_heatmap_deferred(bool deferred) { heatmap_deferred_ = deferred; }
+
+    /**
+     * Configure sliding-window statistics (takes effect on next start/reset)
+     *
+     * Keeps one packed scattering mask per frame in a ring, so memory is
+     * window_frames * width * height / 8 bytes.
+     *
+     * @param window_frames Window length in frames (0 = disabled, max 65535)
+     */
+    void set_window(int window_frames);
+
+    /**
+     * Configure when the average scattering rate counts as converged
+     *
+     * The 95 % interval uses the larger of the Welford sample variance of
+     * per-frame counts and the binomial variance of the candidate pixels
+     * (outside the reference) each scattering independently at the average
+     * rate, so neither a short quiet stretch nor correlated bursts make it
+     * look tighter than it is. With no scattering at all the half-width is
+     * the Poisson rule-of-three bound 3 / frames.
+     * @param relative_half_width Converged once half-width <= this * average (0 = never)
+     * @param min_frames Frames required before converging
+     */
+    void set_confidence_target(float relative_half_width, int min_frames);
+
+    /**
+     * Configure exponential-decay statistics (takes effect on next start/reset)
+     * @param decay_shift EWMA weight of the newest frame is 2^-decay_shift (0 = disabled, max 15)
+     */
+    void set_decay(int decay_shift);
+
+    /**
+     * Set number of hot pixels tracked (takes effect on next start/reset)
+     * @param k Size of the top-K list
+     */
+    void set_hot_pixel_count(int k);
+
+    /**
+     * Set regions with independent statistics (takes effect on next start)
+     *
+     * Rectangles are clipped to the frame and may overlap. They are indexed
+     * once as per-row word spans, so all regions are counted in a single
+     * pass over the rows they cover instead of one pass per region.
+     *
+     * @param regions Regions in display order (empty = whole frame only)
+     */
+    void set_regions(std::vector<Region> regions) { regions_ = std::move(regions); }
+
+    /**
+     * Parse a region list of the form "name:x,y,w,h;name:x,y,w,h"
+     * @param spec Region list (empty = no regions)
+     * @param regions Output
+     * @return true if every entry parsed
+     */
+    static bool parse_regions(const std::string& spec, std::vector<Region>& regions);
+
+    /**
+     * Also score live frames against other baselines (takes effect on next start)
+     *
+     * Only whole-frame counts are kept per comparison reference; temporal
+     * counts, hot pixels, regions and tiles follow the analyzed reference.
+     * References of another size are skipped, and they shift with it (see
+     * set_reference_offset).
+     * @param references Up to MAX_REFERENCES - 1 baselines (empty = none)
+     */
+    void set_comparison_references(std::vector<Reference> references) { comparison_references_ = std::move(references); }
+
+    /**
+     * Also group scattering pixels into 8-connected clusters every frame (takes effect on next start/reset)
+     *
+     * Isolated pixels and blobs mean different things for reliability, and
+     * pixel counts alone cannot tell them apart. Clusters are labelled from
+     * row runs of the packed mask with union-find, so the cost follows the
+     * number of runs, not pixels.
+     *
+     * @param enabled Fill ScatteringData::clusters
+     */
+    void set_cluster_stats(bool enabled) { cluster_stats_ = enabled; }
+    bool get_cluster_stats() const { return cluster_stats_; }
+
+    /**
+     * Histogram bin of a cluster size (0 = 1 pixel, 1 = 2, 2 = 3-4, ... CLUSTER_BINS - 1 = the rest)
+     */
+    static int cluster_bin(int pixels);
+
+    /**
+     * Lower bound of a histogram bin, e.g. for labels
+     */
+    static int cluster_bin_min(int bin) { return bin == 0 ? 1 : (1 << (bin - 1)) + 1; }
+
+    /**
+     * Export the cluster size histogram as CSV (one row per bin)
+     * @param data Analysis data (e.g. a worker snapshot)
+     * @param filepath Output file path
+     * @return true if written successfully
+     */
+    static bool export_clusters_csv(const ScatteringData& data, const std::string& filepath);
+
+    /**
+     * Export per-reference statistics as CSV (one row per reference, analyzed reference first)
+     * @param data Analysis data (e.g. a worker snapshot)
+     * @param filepath Output file path
+     * @return true if written successfully
+     */
+    static bool export_references_csv(const ScatteringData& data, const std::string& filepath);
+
+    /**
+     * Also count scattering per TILE x TILE block (takes effect on next start/reset)
+     * @param enabled Fill ScatteringData::tile_scattering and tile_scattering_total
+     */
+    void set_tile_map(bool enabled) { tile_map_ = enabled; }
+    bool get_tile_map() const { return tile_map_; }
+
+    /**
+     * Export the tile map as CSV (tile_x,tile_y,x,y,total,current; non-zero totals only)
+     * @param data Analysis data (e.g. a worker snapshot)
+     * @param filepath Output file path
+     * @return true if written successfully
+     */
+    static bool export_tiles_csv(const ScatteringData& data, const std::string& filepath);
+
+    /**
+     * Colour-code tile totals, one pixel per tile (blue = low, red = high, black = none)
+     * @param data Analysis data (e.g. a worker snapshot)
+     * @return CV_8UC3 image (empty if the tile map is disabled)
+     */
+    static cv::Mat create_tile_visualization(const ScatteringData& data);
+
+    /**
+     * Export per-region statistics as CSV (one row per region)
+     * @param data Analysis data (e.g. a worker snapshot)
+     * @param filepath Output file path
+     * @return true if written successfully
+     */
+    static bool export_regions_csv(const ScatteringData& data, const std::string& filepath);
+
+    /**
+     * Split large frames into row bands on the shared thread pool
+     *
+     * Results are identical to the serial scan; frames below
+     * PARALLEL_MIN_PIXELS are always scanned serially.
+     *
+     * @param enabled Use the thread pool
+     */
+    void set_parallel(bool enabled) { parallel_ = enabled; }
+
+    /**
+     * Run the row bands on a pool of the caller's instead of the shared one
+     *
+     * @param pool Pool to use (nullptr = ThreadPool::shared()); must outlive the analyzer's use of it
+     */
+    void set_thread_pool(video::ThreadPool* pool) { pool_ = pool; }
+
+    /**
+     * Select which pixel bits of a cv::Mat live frame count as active
+     *
+     * With polarity planes (BinaryFrameAccumulator::ON_BIT / OFF_BIT) one
+     * polarity is analyzed on its own, picked out while packing the frame.
+     * The reference image is always packed as "non-zero = set".
+     *
+     * @param bit_mask Bits that mark a live pixel set (0xFF = any non-zero)
+     */
+    void set_live_mask(uint8_t bit_mask) { live_mask_ = bit_mask ? bit_mask : 0xFF; }
+    uint8_t get_live_mask() const { return live_mask_; }
+
+    /**
+     * Also score every bit plane of cv::Mat live frames (takes effect on next start/reset)
+     *
+     * Splitting out all 8 planes costs about as much as packing the live mask
+     * alone, so analyze_frame(cv::Mat) packs through analyze_planes when enabled.
+     *
+     * @param enabled Fill ScatteringData::planes
+     */
+    void set_plane_sweep(bool enabled) { plane_sweep_ = enabled; }
+    bool get_plane_sweep() const { return plane_sweep_; }
+
+    /**
+     * Check if temporal counts are currently stored sparsely
+     */
+    bool is_sparse() const { return sparse_; }
+
+    /**
+     * Get temporal count of one pixel
+     */
+    int get_count(int x, int y) const;
+
+    /**
+     * Write temporal counts as a dense CV_32SC1 image (either mode)
+     * @param dst Destination (reallocated only on size change)
+     */
+    void copy_counts_to(cv::Mat& dst) const;
+
+    /**
+     * Get all pixels with non-zero count in raster order
+     */
+    std::vector<PixelCount> get_touched_pixels() const;
+
+    /**
+     * Export non-zero temporal counts as CSV (x,y,count)
+     * @param filepath Output file path
+     * @return true if written successfully
+     */
+    bool export_counts_csv(const std::string& filepath) const;
+
+    /**
+     * Copy the mergeable part of the analysis state (see AnalysisShard)
+     *
+     * Counts, hot pixels, totals, the Welford moments and the per-frame
+     * counts still in the window; shards exported after reset_temporal_data
+     * on consecutive frame ranges merge into the state of one pass.
+     * @param shard Output (its noise summary and time range are kept)
+     */
+    void export_shard(AnalysisShard& shard) const;
+
+    /**
+     * Continue from an exported shard (e.g. a checkpoint after a crash)
+     *
+     * Replaces the temporal data like reset_temporal_data followed by the
+     * shard's frames: counts, hot pixels, totals and moments. The window
+     * and decay planes start empty, as they are not part of a shard.
+     * @param shard Exported against the same reference with the same settings
+     * @return false if not analyzing or the shard does not match (nothing changes)
+     */
+    bool import_shard(const AnalysisShard& shard);
+
 private:
     bool analyzing_;
-    cv::Mat reference_image_;
+    video::BinaryFrame reference_bits_;       // Reference as analyzed (shifted by data_.reference_offset)
+    ReferenceHandle reference_original_;       // As started (shared with whoever loaded it)
+    video::BinaryFrame live_bits_;        // Reused packing buffer for cv::Mat input
     ScatteringData data_;
+    int heatmap_scale_max_ = 0;           // max_scattering_count the heatmap is normalised to
+    bool heatmap_deferred_ = false;
+    bool heatmap_stale_ = false;          // A refresh was skipped: rebuild in full
+    std::vector<uint32_t> touched_keys_;  // Pixels analyze_touched set in the mask
+    bool mask_from_touched_ = false;      // Mask holds exactly touched_keys_
+    video::RunFrame reference_runs_;      // reference_bits_ as runs (analyze_runs)
+    video::RunFrame scattering_runs_;     // Reused analyze_runs result
+    std::vector<uint32_t> run_keys_;      // Its pixels as keys
+    video::BlockMap mask_blocks_;         // Blocks the mask may have set (last analyze_frame's live map)
+    bool mask_blocks_valid_ = false;
+
+    // Sparse temporal counts (key = y * width + x)
+    struct SparseCount {
+        int32_t count = 0;
+        int32_t first_seen = 0;
+    };
+    std::unordered_map<uint32_t, SparseCount> sparse_counts_;
+
+    // Dense temporal counts: saturating 16-bit plane plus what saturated pixels counted beyond it
+    static constexpr uint16_t COUNT_SATURATED = 0xFFFF;
+    cv::Mat dense_counts_;                // CV_16UC1
+    std::unordered_map<uint32_t, int32_t> count_overflow_;  // key = y * width + x -> count - COUNT_SATURATED
+    cv::Mat first_seen_;                  // Dense first-seen frame index (CV_32SC1)
+    bool sparse_ = true;
+    bool sparse_enabled_ = true;
+    float sparse_density_threshold_ = 0.01f;
+
+    // Streaming top-K: unsorted list plus its weakest entry, so a pixel only
+    // touches the list once its count beats hot_min_count_
+    std::vector<HotPixel> hot_pixels_;
+    int hot_pixel_k_ = 16;
+    int hot_min_index_ = 0;
+    int32_t hot_min_count_ = 0;
+    bool hot_pixels_changed_ = false;
+
+    // Sliding window: ring of past scattering masks and their pixel counts
+    int window_size_ = 0;
+    std::vector<video::BinaryFrame> window_ring_;
+    std::vector<int> window_ring_pixels_;
+    int window_head_ = 0;
+
+    int decay_shift_ = 0;
+
+    // Online mean / variance of per-frame scattering pixels (Welford)
+    double rate_mean_ = 0.0;
+    double rate_m2_ = 0.0;
+    int64_t candidate_pixels_ = 0;        // Pixels outside the reference (binomial trials per frame)
+    float ci_target_ = 0.0f;
+    int ci_min_frames_ = 300;
+    static constexpr double CI_Z = 1.96;
+
+    // Region index: spans of row y are region_spans_[region_row_begin_[y] .. region_row_begin_[y + 1])
+    struct RegionSpan {
+        int32_t word_begin;
+        int32_t word_end;                  // Exclusive
+        uint64_t first_mask;               // Valid bits of word_begin
+        uint64_t last_mask;                // Valid bits of word_end - 1
+        int32_t region;
+    };
+    std::vector<Region> regions_;
+    std::vector<RegionSpan> region_spans_;
+    std::vector<int32_t> region_row_begin_;
+    int region_y_begin_ = 0;               // Rows outside [begin, end) have no spans
+    int region_y_end_ = 0;
+
+    // Row-band scan: per-band partial results, merged in band order
+    struct HotCandidate {
+        cv::Point location;
+        int32_t count;
+        int32_t first_seen;
+    };
+    struct ScanBand {
+        int scattering_pixels = 0;
+        int max_count = 0;
+        cv::Point hot_spot;
+        std::vector<HotCandidate> candidates;  // Dense: pixels above the top-K threshold
+        std::vector<uint32_t> keys;            // Sparse, or dense and saturated: set bits, counted during the merge
+    };
+    std::vector<ScanBand> bands_;
+    bool parallel_ = true;
+    video::ThreadPool* pool_ = nullptr;     // nullptr = shared pool
+    uint8_t live_mask_ = 0xFF;
+    bool plane_sweep_ = false;
+    video::BinaryFrame plane_bits_[8];    // Reused split buffers, index = bit
+    bool tile_map_ = false;
+    std::vector<Reference> comparison_references_;      // As configured
+
+    // Cluster labelling: row runs of the mask, one union-find node per run
+    struct ClusterRun {
+        int32_t x_begin;
+        int32_t x_end;                     // Exclusive
+        int32_t node;
+    };
+    struct ClusterNode {
+        int32_t parent;
+        int32_t pixels;                    // Whole cluster once this node is a root
+        int32_t x_min, x_max, y_min, y_max;
+    };
+    bool cluster_stats_ = false;
+    std::vector<ClusterRun> cluster_runs_prev_;
+    std::vector<ClusterRun> cluster_runs_;
+    std::vector<ClusterNode> cluster_nodes_;
+    std::vector<video::BinaryFrame> comparison_bits_;   // Of the right size, shifted like reference_bits_
+    cv::Mat tile_frame_;                  // CV_16UC1, 4 tiles per mask word; tile_scattering views its valid columns
+    static constexpr int64_t PARALLEL_MIN_PIXELS = 256 * 1024;
+
+    // Renormalise heatmap once max grows past NUM/DEN of the current scale (~1.5%)
+    static constexpr int HEATMAP_RESCALE_NUM = 65;
+    static constexpr int HEATMAP_RESCALE_DEN = 64;
+
+    void scan_rows(const video::BinaryFrame& live_image, const video::BlockMap* blocks, int y_begin, int y_end,
+                   int& scattering_pixels, int& max_count, cv::Point& hot_spot);
+    void scan_bands(const video::BinaryFrame& live_image, const video::BlockMap* blocks, video::ThreadPool& pool,
+                    int& scattering_pixels, int& max_count, cv::Point& hot_spot);
 
+    // Row y has no live block and its mask words are already zero
+    bool skip_scan_row(const video::BlockMap* blocks, int y) const {
+        const int by = y >> video::BlockMap::ROW_SHIFT;
+        return blocks && !blocks->row_any(by) && mask_blocks_valid_ && !mask_blocks_.row_any(by);
+    }
     void update_statistics();
-    void update_heatmap();
-    void detect_hot_spots();
+    void update_confidence();
+    void reset_confidence();
+    void update_heatmap(const std::vector<uint32_t>* touched = nullptr);
+    void reset_counts();
+    void densify_counts();
+    void track_hot_pixel(const cv::Point& location, int32_t count,
+                         int32_t first_seen, int32_t frame_index);
+    void update_hot_min();
+    void publish_hot_pixels();
+    void reset_rolling_stats();
+    void update_window();
+    void update_decay();
+    void build_region_index();
+    void count_region_references();
+    void reset_region_stats();
+    void update_regions(const video::BinaryFrame& live_image);
+    void reset_plane_stats();
+    void update_planes();
+    void reset_tile_stats();
+    void update_tiles();
+    void build_comparison_references();
+    void count_comparison_references();
+    void reset_reference_stats();
+    void update_references(const video::BinaryFrame& live_image);
+    void reset_cluster_stats();
+    void update_clusters();
+    int32_t find_cluster(int32_t node);
+    void unite_clusters(int32_t a, int32_t b);
 };
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "checkpoint_writer.h"
+#include "heatmap_timeline.h"
+#include "reference_aligner.h"
+#include "reference_builder.h"
+#include "scattering_analyzer.h"
+#include "video/binary_frame.h"
+#include "video/frame_buffer.h"
+#include "video/run_frame.h"
+
+// Forward declarations
+namespace video {
+    class ScatteringEventTap;
+}
+
+/**
+ * ScatteringWorker - Runs ScatteringAnalyzer on a background thread
+ *
+ * Subscribes to a queue-mode FrameBuffer as an every-frame consumer, so
+ * analysis sees every generated binary frame independent of display FPS.
+ * The worker thread owns the analyzer and its accumulators; the UI only
+ * ever reads immutable snapshots of ScatteringData published at a fixed
+ * interval through a double-buffered handoff.
+ *
+ * **Usage:**
+ * ```cpp
+ * worker.start(reference_image);
+ * auto snapshot = worker.get_snapshot();   // UI thread, any time
+ * if (snapshot) draw(snapshot->scattering_heatmap);
+ * worker.stop();
+ * ```
+ */
+class ScatteringWorker {
+public:
+    using Snapshot = ScatteringAnalyzer::ScatteringData;
+
+    /**
+     * Create worker (does not start the thread)
+     * @param source Frame buffer in queue mode that the camera path stores into
+     * @param camera_index Camera the source belongs to (selects the analysis thread's core)
+     */
+    explicit ScatteringWorker(video::FrameBuffer& source, int camera_index = 0);
+    ~ScatteringWorker();
+
+    // Non-copyable
+    ScatteringWorker(const ScatteringWorker&) = delete;
+    ScatteringWorker& operator=(const ScatteringWorker&) = delete;
+
+    /**
+     * Start analysis against a reference image on the worker thread
+     * @param reference_image The baseline image (binary, grayscale)
+     * @return true if analysis started successfully
+     */
+    bool start(const cv::Mat& reference_image);
+
+    /**
+     * Start analysis against a shared packed reference on the worker thread
+     * @param reference_image The baseline image (e.g. from ImageManager::load_binary, shared, not copied)
+     * @return true if analysis started successfully
+     */
+    bool start(ScatteringAnalyzer::ReferenceHandle reference_image);
+
+    /**
+     * Start by building the reference from live frames on the worker thread
+     *
+     * The first frames (masked like live frames) are voted into a reference
+     * by ReferenceBuilder; analysis then starts against it on the same
+     * thread. No snapshot is published until the reference is built.
+     * @param frames Frames to vote over (1..ReferenceBuilder::MAX_FRAMES)
+     * @param occupancy Fraction of those frames a pixel must be set in (0-1)
+     * @return true if the worker thread started
+     */
+    bool start_building(int frames, float occupancy);
+
+    /**
+     * Check if the worker is still collecting frames for the reference
+     */
+    bool is_building_reference() const { return building_.load(); }
+
+    /**
+     * Reference built by start_building (CV_8UC1, 0/255)
+     * @return Reference, or nullptr if none was built since the last start
+     */
+    std::shared_ptr<const cv::Mat> get_built_reference() const;
+
+    /**
+     * Stop the worker thread and publish a final snapshot
+     */
+    void stop();
+
+    /**
+     * Check if the worker thread is running
+     */
+    bool is_running() const { return running_.load(); }
+
+    /**
+     * Request temporal data reset (applied on the worker thread)
+     */
+    void reset_temporal_data() { reset_requested_ = true; }
+
+    /**
+     * Get latest published snapshot (ZERO-COPY, immutable)
+     * @return Snapshot, or nullptr if analysis was never started
+     */
+    std::shared_ptr<const Snapshot> get_snapshot() const;
+
+    /**
+     * Configure rolling statistics (call while stopped; applies on next start)
+     * @param window_frames Sliding window length in frames (0 = disabled)
+     * @param decay_shift EWMA weight 2^-decay_shift (0 = disabled)
+     */
+    void set_rolling_stats(int window_frames, int decay_shift);
+
+    /**
+     * Set regions with independent statistics (call while stopped; applies on next start)
+     * @param regions Regions reported in Snapshot::regions
+     */
+    void set_regions(std::vector<ScatteringAnalyzer::Region> regions);
+
+    /**
+     * Select the pixel bits of live frames that count as active (call while stopped)
+     * @param bit_mask See ScatteringAnalyzer::set_live_mask (0xFF = any non-zero)
+     */
+    void set_live_mask(uint8_t bit_mask);
+
+    /**
+     * Score every bit plane of live frames into Snapshot::planes (call while stopped)
+     * @param enabled See ScatteringAnalyzer::set_plane_sweep
+     */
+    void set_plane_sweep(bool enabled);
+
+    /**
+     * Count scattering per tile into Snapshot::tile_scattering (call while stopped)
+     * @param enabled See ScatteringAnalyzer::set_tile_map
+     */
+    void set_tile_map(bool enabled);
+
+    /**
+     * Group scattering pixels into clusters into Snapshot::clusters (call while stopped)
+     * @param enabled See ScatteringAnalyzer::set_cluster_stats
+     */
+    void set_cluster_stats(bool enabled);
+
+    /**
+     * Score live frames against other baselines into Snapshot::references (call while stopped)
+     * @param references See ScatteringAnalyzer::set_comparison_references
+     */
+    void set_comparison_references(std::vector<ScatteringAnalyzer::Reference> references);
+
+    /**
+     * Follow a shifting target by re-estimating the reference offset (call while stopped)
+     *
+     * Live frames are accumulated and ReferenceAligner::estimate runs on this
+     * worker's thread every interval, never per frame. Not available with
+     * the plane sweep (its live mask is packed inside the analyzer).
+     * @param interval_ms Time between estimates (0 = reference stays where it is)
+     * @param max_shift_px Largest offset accepted in either axis
+     */
+    void set_alignment(int interval_ms, int max_shift_px);
+
+    /**
+     * Configure when the scattering rate counts as converged (call while stopped)
+     * @param relative_half_width See ScatteringAnalyzer::set_confidence_target (0 = never)
+     * @param min_frames Frames required before converging
+     */
+    void set_confidence_target(float relative_half_width, int min_frames);
+
+    /**
+     * Record the temporal counts as a heatmap timeline (call while stopped)
+     *
+     * The count plane is written as a sparse delta every interval on the
+     * worker thread, and once more on stop. The file is created (replaced)
+     * with the first snapshot of each start.
+     * @param path Timeline file ("" = none)
+     * @param interval_s Time between snapshots (0 = none)
+     */
+    void set_timeline(const std::string& path, int interval_s);
+    const std::string& get_timeline_path() const { return timeline_path_; }
+
+    /**
+     * Checkpoint the analysis state so a crashed run can resume (call while stopped)
+     *
+     * Every interval the worker exports a shard (one pass over the counts
+     * into a reused buffer) and hands it to a CheckpointWriter, which
+     * writes it on its own thread. A clean stop deletes the checkpoint.
+     * @param path Checkpoint file ("" = none)
+     * @param interval_s Time between checkpoints (0 = none)
+     * @param resume On start, continue from a checkpoint of the same reference and settings
+     */
+    void set_checkpoint(const std::string& path, int interval_s, bool resume);
+    const std::string& get_checkpoint_path() const { return checkpoint_path_; }
+
+    /**
+     * Analyze scattering pixels listed on the accumulation thread instead of frames (call while stopped)
+     *
+     * Once analysis starts (after the reference is built, when building), the
+     * analyzed reference is installed in the tap and each of its windows is
+     * passed to ScatteringAnalyzer::analyze_touched; frames are still consumed
+     * but not analyzed. Falls back to frames when the analyzer needs them
+     * (see ScatteringAnalyzer::supports_touched_input), with alignment, or
+     * when the tap's frame size differs from the reference.
+     * @param tap Camera's tap (nullptr = analyze frames)
+     */
+    void set_event_tap(video::ScatteringEventTap* tap);
+
+    /**
+     * Check if windows come from the event tap rather than frames
+     */
+    bool is_event_driven() const { return event_driven_.load(); }
+
+    /**
+     * Set how often snapshots are published to the UI
+     * @param interval_ms Minimum time between snapshots in milliseconds
+     */
+    void set_publish_interval_ms(int interval_ms) { publish_interval_ms_ = interval_ms; }
+
+    // Statistics
+    int64_t get_frames_analyzed() const { return frames_analyzed_.load(); }
+    int64_t get_frames_missed() const;   // Frames the queue dropped for this worker (tap windows when event-driven)
+
+private:
+    bool start_thread();
+    void worker_loop();
+    void build_reference(const cv::Mat& frame);
+    void publish_snapshot();
+    void update_alignment();
+    void log_frame(const video::FrameTiming& timing);   // One core::RunLog row
+    void write_timeline();
+    void resume_checkpoint();
+    void write_checkpoint();
+    void attach_event_tap();
+    void analyze_event_windows();
+
+    video::FrameBuffer& source_;
+    const int camera_index_;
+    ScatteringAnalyzer analyzer_;          // Worker thread only while running
+    video::BinaryFrame live_bits_;         // Reused packing buffer
+    video::RunFrame live_runs_;            // Reused for frames sparse enough for runs
+    std::atomic<int> consumer_id_{-1};
+    std::atomic<int64_t> frames_missed_{0};  // Final count once stopped
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> reset_requested_{false};
+    std::atomic<int> publish_interval_ms_{100};
+    std::chrono::steady_clock::time_point last_publish_;
+
+    // Reference alignment (worker thread only while running)
+    ReferenceAligner aligner_;
+    int align_interval_ms_ = 0;
+    std::chrono::steady_clock::time_point last_align_;
+
+    // Heatmap timeline (worker thread only while running)
+    HeatmapTimelineWriter timeline_;
+    std::string timeline_path_;
+    int timeline_interval_s_ = 0;
+    bool timeline_failed_ = false;
+    cv::Mat timeline_counts_;
+    std::chrono::steady_clock::time_point last_timeline_;
+
+    // Crash-safe checkpoints (worker thread only while running)
+    CheckpointWriter checkpoint_writer_;
+    std::string checkpoint_path_;
+    int checkpoint_interval_s_ = 0;
+    bool checkpoint_resume_ = false;
+    std::unique_ptr<AnalysisShard> checkpoint_shard_;   // Filled by the next export
+    std::chrono::steady_clock::time_point last_checkpoint_;
+
+    // Event-driven input (see set_event_tap)
+    video::ScatteringEventTap* event_tap_ = nullptr;
+    std::atomic<bool> event_driven_{false};
+    uint64_t tap_dropped_base_ = 0;        // Tap's dropped windows when it was attached
+    std::vector<uint32_t> touched_keys_;   // Reused window buffer (worker thread)
+
+    // Reference building (worker thread only while running)
+    ReferenceBuilder builder_;
+    float build_occupancy_ = 0.5f;
+    std::atomic<bool> building_{false};
+
+    // Double-buffered handoff: UI holds front_, worker refills back_ once
+    // the UI has let go of it
+    mutable std::mutex snapshot_mutex_;
+    std::shared_ptr<Snapshot> front_;
+    std::shared_ptr<Snapshot> back_;
+    std::shared_ptr<const cv::Mat> built_reference_;
+
+    std::atomic<int64_t> frames_analyzed_{0};
+};
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/latency_stats.h"
+#include "core/metrics.h"
+#include "pipeline_bus.h"
+#include "video/thread_pool.h"
+
+/**
+ * Declarative consumer stages on the PipelineBus
+ *
+ * A stage is a handler attached to one bus channel through its own bounded
+ * queue, run by the executor named in pipeline_stages (event_config.ini):
+ * - thread: a dedicated thread blocked in wait_pop() (lowest latency, one
+ *   core per stage)
+ * - pool: drained in batches on the graph's own worker pool, scheduled
+ *   when a message arrives (many light stages share a few threads)
+ * - gpu: drained from the render loop with run_gpu(), where the GL context
+ *   lives; without a render loop (headless) it runs on a dedicated thread
+ *
+ * The queue depth and overflow policy trade latency (shallow, drop oldest)
+ * against completeness (deep, drop newest) per stage, so a rig is retuned
+ * by editing the ini, not the code. Each stage exports
+ * stage.<name>.utilization (busy time per wall time, %),
+ * stage.<name>.queue (messages waiting) and stage.<name>.processed; a
+ * stage near 100% with a full queue is the bottleneck.
+ *
+ * **Usage:**
+ * ```cpp
+ * std::vector<StageGraph::StageSpec> specs;
+ * StageGraph::parse("log:window_log,pool,64,newest", specs);
+ * graph.add_stage(specs[0], PipelineBus::instance().window_stats(), [](const auto& m) { write(m); });
+ * graph.start(2, false);
+ * ```
+ */
+class StageGraph {
+public:
+    enum class Executor {
+        Thread,
+        Pool,
+        Gpu
+    };
+
+    struct StageSpec {
+        std::string name;                    // Unique; metrics stage.<name>.*
+        std::string kind;                    // What the stage does (interpreted by the caller)
+        Executor executor = Executor::Thread;
+        size_t depth = 4;                    // Queue depth on the bus channel
+        BusOverflow overflow = BusOverflow::DropOldest;
+    };
+
+    struct StageStats {
+        std::string name;
+        std::string kind;
+        Executor executor = Executor::Thread;
+        double utilization = 0.0;            // Busy time over the last sample() interval (%)
+        size_t queued = 0;
+        size_t capacity = 0;
+        uint64_t processed = 0;
+        uint64_t dropped = 0;                // Overflowed the queue
+    };
+
+    StageGraph() = default;
+    ~StageGraph();
+
+    // Non-copyable
+    StageGraph(const StageGraph&) = delete;
+    StageGraph& operator=(const StageGraph&) = delete;
+
+    /**
+     * Parse "name:kind,executor,depth[,oldest|newest]" entries separated by ';'
+     * @param spec Stage list (empty = no stages)
+     * @param specs Output, in order; malformed entries and repeated names are skipped
+     * @return false if any entry was skipped
+     */
+    static bool parse(const std::string& spec, std::vector<StageSpec>& specs);
+
+    static const char* executor_name(Executor executor);
+
+    /**
+     * Add a stage on a bus channel (before start())
+     * @param spec Stage description
+     * @param channel Channel the stage subscribes to while started
+     * @param handler Called once per message, on the stage's executor
+     */
+    template <typename T>
+    void add_stage(const StageSpec& spec, BusChannel<T>& channel, std::function<void(const T&)> handler) {
+        stages_.push_back(std::make_shared<BusStage<T>>(spec, channel, std::move(handler)));
+    }
+
+    /**
+     * Subscribe every stage and start its executor
+     * @param pool_threads Workers of the stage pool (0 = one per pool stage)
+     * @param render_loop A render loop will call run_gpu(); otherwise gpu stages get a thread
+     */
+    void start(int pool_threads, bool render_loop);
+
+    /**
+     * Unsubscribe every stage and wait for its executor (messages still queued are discarded)
+     */
+    void stop();
+
+    bool is_running() const { return running_.load(std::memory_order_relaxed); }
+    bool empty() const { return stages_.empty(); }
+
+    /**
+     * Drain the gpu stages (render loop thread)
+     * @param budget_us Stop taking messages after this long
+     */
+    void run_gpu(int64_t budget_us);
+
+    /**
+     * Update utilization and the stage.* metrics (call about once a second)
+     */
+    void sample();
+
+    /**
+     * Stage figures as of the last sample()
+     */
+    std::vector<StageStats> get_stats() const;
+
+private:
+    static constexpr int64_t WAIT_US = 100000;      // Thread stages recheck running_ this often
+    static constexpr int POOL_BATCH = 64;           // Messages per pool task, so stages share the workers
+
+    class Stage {
+    public:
+        explicit Stage(const StageSpec& spec);
+        virtual ~Stage() = default;
+
+        virtual void attach(std::function<void()> on_push) = 0;
+        virtual void detach() = 0;
+        virtual bool try_process() = 0;
+        virtual bool wait_process(int64_t timeout_us) = 0;
+        virtual void wake() = 0;
+        virtual size_t queued() const = 0;
+        virtual size_t capacity() const = 0;
+        virtual uint64_t dropped() const = 0;
+
+        StageSpec spec;
+        Executor effective = Executor::Thread;   // Executor actually used (gpu without a render loop = thread)
+        std::thread thread;
+        std::atomic<bool> scheduled{false};      // Pool: a drain task is queued or running
+        std::atomic<int64_t> busy_us{0};
+        std::atomic<uint64_t> processed{0};
+
+        // sample() only
+        int64_t last_busy_us = 0;
+        int64_t last_sample_us = 0;
+        double utilization = 0.0;
+        core::Gauge& utilization_gauge;
+        core::Gauge& queue_gauge;
+        core::Counter& processed_counter;
+    };
+
+    template <typename T>
+    class BusStage : public Stage {
+    public:
+        BusStage(const StageSpec& spec, BusChannel<T>& channel, std::function<void(const T&)> handler)
+            : Stage(spec), channel_(channel), handler_(std::move(handler)) {}
+
+        void attach(std::function<void()> on_push) override {
+            subscription_ = channel_.subscribe("stage_" + spec.name, spec.depth, spec.overflow, std::move(on_push));
+        }
+
+        void detach() override {
+            if (subscription_) {
+                channel_.unsubscribe(subscription_);
+            }
+        }
+
+        bool try_process() override {
+            T message;
+            if (!subscription_ || !subscription_->try_pop(message)) {
+                return false;
+            }
+            handle(message);
+            return true;
+        }
+
+        bool wait_process(int64_t timeout_us) override {
+            T message;
+            if (!subscription_ || !subscription_->wait_pop(message, timeout_us)) {
+                return false;
+            }
+            handle(message);
+            return true;
+        }
+
+        void wake() override {
+            if (subscription_) {
+                subscription_->notify();
+            }
+        }
+
+        size_t queued() const override { return subscription_ ? subscription_->size() : 0; }
+        size_t capacity() const override { return subscription_ ? subscription_->capacity() : spec.depth; }
+        uint64_t dropped() const override { return subscription_ ? subscription_->get_dropped() : 0; }
+
+    private:
+        void handle(const T& message) {
+            const int64_t begin_us = core::LatencyStats::now_us();
+            handler_(message);
+            busy_us.fetch_add(core::LatencyStats::now_us() - begin_us, std::memory_order_relaxed);
+            processed.fetch_add(1, std::memory_order_relaxed);
+            processed_counter.add();
+        }
+
+        BusChannel<T>& channel_;
+        std::function<void(const T&)> handler_;
+        std::shared_ptr<BusSubscription<T>> subscription_;
+    };
+
+    void schedule(const std::shared_ptr<Stage>& stage);
+    void drain(const std::shared_ptr<Stage>& stage);
+
+    std::vector<std::shared_ptr<Stage>> stages_;
+    std::mutex pool_mutex_;                      // schedule() against the pool going away in stop()
+    std::unique_ptr<video::ThreadPool> pool_;
+    std::atomic<bool> running_{false};
+    mutable std::mutex stats_mutex_;             // sample() against get_stats()
+};
@@ -0,0 +1,126 @@
+/**
+ * @file capture_gallery.h
+ * @brief Thumbnail gallery of the captures in the capture catalog
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <GL/glew.h>
+#include <opencv2/core.hpp>
+#include "capture_catalog.h"
+#include "video/thread_pool.h"
+
+namespace ui {
+
+/**
+ * @brief Grid of capture thumbnails, filtered by a catalog query
+ *
+ * Lists the CaptureCatalog entries matching the query (newest first) and
+ * shows a thumbnail for each visible one; clicking a thumbnail opens the
+ * capture in the viewer.
+ *
+ * Thumbnails are decoded on a pool of their own, at reduced resolution
+ * (IMREAD_REDUCED_GRAYSCALE_2/4/8, picked from the catalog's image size),
+ * then scaled to fit THUMB_SIZE. Each one is also written to the thumbnail
+ * directory next to the catalog index and read from there while it is
+ * newer than its capture. Jobs for thumbnails that scrolled out of view
+ * before a worker got to them are skipped.
+ *
+ * All thumbnails share one ATLAS_SIZE texture of THUMB_SIZE cells, so there
+ * is no texture per thumbnail. Finished thumbnails are copied into a CPU
+ * mirror of the atlas and the rows they touched go up in a single
+ * glTexSubImage2D per frame. When every cell is taken, the least recently
+ * shown thumbnail gives up its cell.
+ */
+class CaptureGallery {
+public:
+    static constexpr int THUMB_SIZE = 128;                   // Cell edge in pixels
+    static constexpr int ATLAS_SIZE = 2048;                  // Atlas edge: (2048 / 128)^2 = 256 cells
+    static constexpr int ATLAS_CELLS = (ATLAS_SIZE / THUMB_SIZE) * (ATLAS_SIZE / THUMB_SIZE);
+    static constexpr int MAX_RESULTS_PER_FRAME = 64;         // Decoded thumbnails placed per frame
+    static constexpr const char* THUMB_DIRECTORY = "capture_thumbs";
+
+    /**
+     * @param threads Decode threads (0 = hardware threads / 2)
+     * @param on_open Called with the PNG path of a clicked thumbnail (UI thread)
+     */
+    CaptureGallery(int threads, std::function<void(const std::string&)> on_open);
+    ~CaptureGallery();
+
+    // Non-copyable
+    CaptureGallery(const CaptureGallery&) = delete;
+    CaptureGallery& operator=(const CaptureGallery&) = delete;
+
+    /**
+     * Render the gallery window (UI thread, GL context current)
+     * @param open Window visibility, cleared by the close button
+     */
+    void render(bool* open);
+
+private:
+    enum class ThumbState { NONE, QUEUED, READY, FAILED };
+
+    struct Thumb {
+        ThumbState state = ThumbState::NONE;
+        int cell = -1;
+        int width = 0;               // Thumbnail size inside the cell
+        int height = 0;
+        uint64_t last_shown = 0;     // frame_ it was last drawn
+    };
+
+    struct Decoded {
+        std::string path;            // Catalog (relative) path
+        cv::Mat image;               // Empty if skipped or failed
+        bool skipped = false;
+    };
+
+    void refresh();
+    void draw_item(const CaptureCatalog::Entry& entry, std::unordered_set<std::string>& visible);
+    void request(const CaptureCatalog::Entry& entry);
+    void decode(const std::string& path, const std::string& source, const std::string& thumb_file,
+                int width, int height);
+    void place_results();
+    int acquire_cell();
+    void upload_atlas();
+
+    std::function<void(const std::string&)> on_open_;
+    std::unique_ptr<video::ThreadPool> pool_;
+    int max_in_flight_ = 1;
+    int in_flight_ = 0;
+
+    // Listing
+    std::string query_;
+    std::string query_error_;
+    std::vector<CaptureCatalog::Entry> items_;
+    size_t listed_catalog_size_ = 0;
+    bool stale_ = true;
+    std::chrono::steady_clock::time_point listed_at_;
+
+    // UI thread state
+    std::unordered_map<std::string, Thumb> thumbs_;
+    std::vector<std::string> cell_owner_;    // Thumb path per atlas cell ("" = free)
+    uint64_t frame_ = 0;
+
+    // Shared with the decode workers
+    std::mutex mutex_;
+    std::unordered_set<std::string> visible_;  // Shown in the last frame
+    std::vector<Decoded> results_;
+
+    // Atlas texture and its CPU mirror
+    GLuint texture_ = 0;
+    GLenum texture_format_ = GL_RED;         // GL_LUMINANCE without texture swizzle
+    std::vector<uint8_t> atlas_;
+    int dirty_begin_ = ATLAS_SIZE;           // Rows changed since the last upload
+    int dirty_end_ = 0;
+};
+
+} // namespace ui
@@ -5,9 +5,10 @@
 
 #pragma once
 
+#include <array>
 #include <vector>
-#include <deque>
 #include <chrono>
+#include <cstdint>
 #include <imgui.h>
 
 namespace ui {
@@ -27,6 +28,12 @@ struct ChartSettings {
  *
  * Shows events per second with a configurable rolling window
  * Auto-scales vertically with configurable min/max limits
+ *
+ * **PERFORMANCE:** History lives in fixed rings that store every sample
+ * twice, so the newest N samples are always contiguous and ImGui plots them
+ * in place. Coarser levels (1 s and 10 s averages) cover hour- and day-long
+ * windows. The window min/max come from monotonic queues, so neither
+ * update() nor render() scans the history.
  */
 class EventRateChart {
 public:
@@ -72,14 +79,53 @@ public:
     ChartSettings& get_mutable_settings() { return settings_; }
 
 private:
-    struct DataPoint {
-        std::chrono::steady_clock::time_point timestamp;
-        float rate;  // Events per second
+    /**
+     * Fixed-capacity history at one sample period
+     *
+     * Sample n is stored at n % capacity and n % capacity + capacity, so
+     * the newest count samples start at newest(count) without wrapping.
+     */
+    struct RateHistory {
+        float period_s = 0.0f;
+        size_t capacity = 0;
+        std::vector<float> values;   // 2 * capacity
+        uint64_t written = 0;        // Samples pushed since reset
+
+        // Finer samples not yet averaged into this level
+        double pending_sum = 0.0;
+        int pending_count = 0;
+
+        void push(float value);
+        size_t size() const { return written < capacity ? static_cast<size_t>(written) : capacity; }
+        float at(uint64_t sample) const { return values[sample % capacity]; }
+        const float* newest(size_t count) const { return values.data() + written % capacity + capacity - count; }
     };
 
-    // Chart data
-    std::deque<DataPoint> data_points_;
-    static constexpr size_t MAX_POINTS = 6000;  // Up to 600 seconds at 10Hz update
+    /**
+     * Min or max of the newest samples of one level (monotonic queue of sample numbers)
+     */
+    struct SlidingExtreme {
+        bool is_max = true;
+        std::vector<uint64_t> samples;   // Ring, capacity of the level
+        size_t head = 0;
+        size_t count = 0;
+
+        void reset(size_t capacity);
+        void push(const RateHistory& history, uint64_t sample, size_t window);
+        float value(const RateHistory& history) const { return count ? history.at(samples[head]) : 0.0f; }
+    };
+
+    // 100 ms samples for 10 min, 1 s averages for 1 h, 10 s averages for 24 h
+    static constexpr int LEVEL_COUNT = 3;
+    static constexpr int LEVEL_RATIO = 10;   // Samples of one level per sample of the next
+    std::array<RateHistory, LEVEL_COUNT> levels_;
+
+    // Window min/max of the level currently shown
+    SlidingExtreme window_max_;
+    SlidingExtreme window_min_;
+    int extremes_level_ = -1;
+    size_t extremes_window_ = 0;
+    uint64_t extremes_next_ = 0;       // Next sample of that level to feed in
 
     // Chart settings
     ChartSettings settings_;
@@ -99,9 +145,17 @@ private:
     static constexpr int UPDATE_INTERVAL_MS = 100;  // Update chart at 10Hz
 
     /**
-     * @brief Clean old data points outside the time window
+     * @brief Pick the finest level that covers the time window
+     * @param window Output number of samples of that level to show
+     * @return Level index
+     */
+    int select_level(size_t& window) const;
+
+    /**
+     * @brief Feed new samples of the shown level to the min/max queues
+     * (rebuilds them when the time window moves to another level or length)
      */
-    void cleanup_old_points();
+    void update_extremes();
 
     /**
      * @brief Update Y-axis scaling based on current data
@@ -0,0 +1,69 @@
+/**
+ * @file heatmap_timeline_panel.h
+ * @brief Scrubbing through the scattering heatmap timeline of a run
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <opencv2/core.hpp>
+#include "heatmap_timeline.h"
+#include "video/texture_manager.h"
+
+namespace ui {
+
+/**
+ * @brief Window with a slider over the snapshots of a heatmap timeline
+ *
+ * Opens a .rtheat file written by ScatteringWorker (the newest one in the
+ * run log directory by default) and shows the counts as of the selected
+ * snapshot as a JET heatmap. Moving the slider forward replays only the
+ * deltas since the shown snapshot; moving it back restarts from the
+ * nearest keyframe (HeatmapTimeline::reconstruct).
+ *
+ * The colour scale is fixed to the highest count of the last snapshot by
+ * default, so a pixel's colour is comparable across the whole run.
+ */
+class HeatmapTimelinePanel {
+public:
+    /**
+     * @param directory Where "Latest" looks for timelines (the run log directory)
+     */
+    explicit HeatmapTimelinePanel(std::string directory);
+    ~HeatmapTimelinePanel();
+
+    // Non-copyable
+    HeatmapTimelinePanel(const HeatmapTimelinePanel&) = delete;
+    HeatmapTimelinePanel& operator=(const HeatmapTimelinePanel&) = delete;
+
+    /**
+     * Render the window (UI thread, GL context current)
+     * @param open Window visibility, cleared by the close button
+     */
+    void render(bool* open);
+
+private:
+    bool open_timeline(const std::string& path);
+    std::string latest_timeline() const;
+    void show(int index);
+
+    std::string directory_;
+    std::string path_;
+    std::string error_;
+    HeatmapTimeline timeline_;
+
+    int index_ = 0;
+    int shown_index_ = -1;
+    bool fixed_scale_ = true;
+    int32_t final_max_ = 0;          // Highest count of the last snapshot
+
+    // Shown snapshot
+    cv::Mat counts_;
+    cv::Mat heatmap_;                // BGR
+    int scattering_pixels_ = 0;      // Non-zero counts
+    int32_t max_count_ = 0;
+    std::unique_ptr<video::TextureManager> texture_;
+};
+
+} // namespace ui
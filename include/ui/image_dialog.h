@@ -9,7 +9,9 @@
 
 #include <string>
 #include <functional>
+#include <vector>
 #include <opencv2/core.hpp>
+#include "capture_catalog.h"
 #include "image_manager.h"
 #include "video/texture_manager.h"
 
@@ -22,6 +24,11 @@ struct LoadDialogState {
     bool show_dialog = false;
     std::string filepath;
 
+    // Capture catalog search (kept across openings)
+    std::string query;
+    std::string query_error;
+    std::vector<CaptureCatalog::Entry> matches;
+
     void open() { show_dialog = true; }
     void reset() { filepath.clear(); }
 };
@@ -78,9 +85,11 @@ public:
      *
      * @param dialog_id Unique ID for this dialog (e.g., "SaveDialog_LeftViewer")
      * @param state Dialog state (persistent across frames)
-     * @param image_to_save Image to save
-     * @param saved_path Output - path where image was saved
-     * @return true if user saved the image this frame
+     * @param image_to_save Image to save (shared with the save queue, not cloned)
+     * @param saved_path Output - path the image is being written to
+     * @return true if user queued the image for saving this frame
+     *
+     * Completion and failures are reported through ImageSaveQueue::poll_result().
      */
     static bool show_save_dialog(
         const std::string& dialog_id,
@@ -90,6 +99,8 @@ public:
     );
 
 private:
+    static constexpr size_t MAX_SEARCH_RESULTS = 200;   // Catalog matches listed in the load dialog
+
     /**
      * @brief Open native Windows file browser for loading
      *
@@ -11,9 +11,16 @@
 #include <string>
 #include <memory>
 #include <chrono>
+#include <vector>
 #include <opencv2/core.hpp>
 #include "image_manager.h"
-#include "video/texture_manager.h"
+#include "video/texture_cache.h"
+#include "video/binary_frame.h"
+#include "video/gpu_compute.h"
+#include "video/event_activity.h"
+#include "video/pixel_rate_monitor.h"
+#include "video/event_interval_histogram.h"
+#include "video/video_exporter.h"
 #include "noise_analyzer.h"
 #include "ui/image_dialog.h"
 #include "ui/event_rate_chart.h"
@@ -77,12 +84,37 @@ public:
      */
     const cv::Mat& get_loaded_image() const { return loaded_image_; }
 
+    /**
+     * @brief Load a capture from disk and show it (through ImageCache)
+     * @param path PNG path
+     * @return false if it cannot be read
+     */
+    bool open_image(const std::string& path);
+
     /**
      * @brief Update event count for real-time rate calculation
      * @param event_count Number of events in current frame
      */
     void update_event_count(uint64_t event_count);
 
+    /**
+     * @brief Check if the last render read the camera frame (analysis open or save pending)
+     *
+     * Lets a display path that never builds a CPU frame skip it while nothing reads it.
+     */
+    bool wants_camera_frame() const {
+        return mode_ == ViewerMode::ACTIVE_CAMERA && (analysis_open_ || save_open_);
+    }
+
+    /**
+     * @brief Check if the camera texture must hold the full frame rather than a binned preview
+     *
+     * True while zoomed in (preview pixels would show) or comparing against a loaded image.
+     */
+    bool wants_full_resolution() const {
+        return view_zoom_ != 1.0f || compare_loaded_;
+    }
+
 private:
     // Identity
     std::string name_;
@@ -94,19 +126,56 @@ private:
     // Loaded image state
     cv::Mat loaded_image_;
     ImageManager::ImageMetadata loaded_metadata_;
-    std::unique_ptr<video::TextureManager> texture_;
+    video::TextureCache::Handle texture_;      // Shared with any view showing the same file
     std::string last_loaded_path_;
 
+    // Compare with loaded image: shader overlay of the live and loaded textures,
+    // counts from the bit-packed frames (one AND / ANDNOT / popcount pass)
+    bool compare_loaded_ = false;
+    std::unique_ptr<video::gpu::GPUCompareView> compare_view_;
+    video::BinaryFrame compare_loaded_bits_;   // Packed once per loaded image
+    video::BinaryFrame compare_live_bits_;     // Reused for every live frame
+    video::BinaryFrame::Overlap compare_counts_;
+
+    // Scrub-back history: paused, the decoded history frame stands in for the live one
+    bool history_paused_ = false;
+    int history_index_ = 0;                   // Frame shown (0 = oldest)
+    int history_shown_ = -1;                  // Index decoded into history_frame_ (-1 = none)
+    cv::Mat history_frame_;
+    video::TextureCache::Handle history_texture_;
+
+    // History video export: a few frames decoded and queued per UI frame while paused
+    static constexpr double HISTORY_EXPORT_BUDGET_MS = 4.0;   // Decode time per UI frame
+    std::unique_ptr<video::VideoExporter> history_export_;
+    int history_export_next_ = 0;             // Next history index to queue
+    int history_export_count_ = 0;            // Frames to export (cut short on resume)
+    cv::Mat history_export_frame_;
+    std::string history_export_status_;       // Outcome of the last export
+
     // Image dialogs
     LoadDialogState load_dialog_;
     SaveDialogState save_dialog_;
+    bool save_open_ = false;             // Save popup open as of the last render
 
     // Noise analysis state
+    bool analysis_open_ = false;         // Image Analysis header expanded as of the last render
     std::unique_ptr<NoiseAnalyzer> noise_analyzer_;
+    std::unique_ptr<video::gpu::GPUMorphologyChain> morphology_chain_;  // Detection cleanup on the GPU (on demand)
     NoiseAnalysisResults noise_results_;
     bool noise_analysis_complete_ = false;
+    bool live_noise_analysis_ = false;   // Re-measure SNR every frame using cached dot geometry
+    bool track_live_dots_ = false;       // Live SNR follows each dot (NoiseAnalyzer::trackLiveFrame)
     DotDetectionParams noise_params_;
-    std::unique_ptr<video::TextureManager> noise_viz_texture_;
+    int local_noise_block_ = 0;          // Local noise map block size in pixels (0 = off)
+    std::unique_ptr<ThresholdSweep> threshold_sweep_;  // Last SNR-vs-threshold curve (null until swept)
+    int analysis_polarity_ = 0;          // 0 = ON + OFF, 1 = ON only, 2 = OFF only (needs polarity planes)
+    cv::Mat polarity_lut_;               // Frame pixel -> 0/255 for the selected polarity bit
+    cv::Mat polarity_frame_;             // Camera frame reduced to one polarity
+    uint64_t noise_generation_ = 0;      // Bumped when an analysis produces new geometry
+    int noise_viz_mode_ = 0;             // 0 = detected circles, 1 = signal only, 2 = noise only
+    bool noise_viz_visible_ = false;
+    video::TextureCache::Handle noise_viz_textures_[3];  // One per mode, kept across switches
+    uint64_t noise_viz_generation_[3] = {};  // noise_generation_ each texture was built from
 
     // Focus adjust state
     bool show_focus_adjust_window_ = false;
@@ -120,11 +189,50 @@ private:
     // Event rate chart
     std::unique_ptr<EventRateChart> event_chart_;
 
+    // Row/column activity projections beside the live image
+    static constexpr float PROFILE_STRIP = 60.0f;  // Strip size in pixels
+    bool show_activity_profile_ = true;
+    video::ActivitySnapshot activity_;
+    std::vector<ImVec2> profile_points_;  // Scratch for polylines
+
+    // Zoom/pan: a UV window onto the full texture, nothing resized on the CPU
+    float view_zoom_ = 1.0f;                  // 1 = whole image fits the panel
+    ImVec2 view_center_ = ImVec2(0.5f, 0.5f); // Texture coordinate at the centre of the view
+    int view_width_ = 0;                      // Image size the view belongs to (reset when it changes)
+    int view_height_ = 0;
+    GLuint view_nearest_texture_ = 0;         // Last texture switched to nearest magnification
+    static constexpr float VIEW_MAX_ZOOM = 64.0f;
+    static constexpr float VIEW_ZOOM_STEP = 1.25f;   // Per mouse wheel notch
+    static constexpr float VIEW_GRID_MIN_PX = 8.0f;  // Screen pixels per image pixel before the grid shows
+
+    // Hot pixels flagged by the camera's PixelRateMonitor
+    std::vector<video::FlaggedPixel> flagged_pixels_;
+
+    // Inter-event intervals per pixel class, shown with the analog biases
+    video::IntervalHistograms interval_snapshot_;
+    std::vector<video::FlaggedPixel> interval_hot_pixels_;
+    int interval_hot_synced_ = -1;            // Hot pixel count last passed to the histograms
+
     /**
      * @brief Render mode dropdown and controls
      */
     void render_mode_controls();
 
+    /**
+     * @brief Render Pause / Live and, while paused, the history scrubber (decodes the selected frame)
+     */
+    void render_history_controls();
+
+    /**
+     * @brief Export the paused history to a lossless video in the capture directory
+     */
+    void start_history_export();
+
+    /**
+     * @brief Queue history frames for the exporter within the UI budget, and collect it when done
+     */
+    void pump_history_export();
+
     /**
      * @brief Render the current image (camera or loaded)
      *
@@ -136,6 +244,33 @@ private:
     void render_image(const cv::Mat& camera_frame, GLuint camera_tex_id,
                      int cam_width, int cam_height);
 
+    /**
+     * @brief Draw an image through the zoom/pan view
+     *
+     * The whole frame stays in the texture; zooming and panning only change
+     * the texture coordinates of the drawn quad, and magnification samples
+     * nearest-neighbour so single pixels stay sharp. Mouse wheel zooms about
+     * the cursor, dragging pans, double-click fits the whole image again.
+     * Zoomed in far enough, a pixel grid is drawn and the hovered pixel's
+     * coordinates (and value, if pixels matches the image) are shown.
+     *
+     * @param tex_id Texture holding the full image
+     * @param width Image width in pixels
+     * @param height Image height in pixels
+     * @param size Displayed size (the image fitted to the panel)
+     * @param pixels CPU copy for the value readout (may be empty)
+     */
+    void render_zoomable_image(GLuint tex_id, int width, int height, const ImVec2& size, const cv::Mat& pixels);
+
+    /**
+     * @brief Draw row (right) and column (below) event projections of the last window
+     *
+     * Call right after the camera ImGui::Image; uses activity_.
+     *
+     * @param img_size Displayed image size
+     */
+    void render_activity_projections(const ImVec2& img_size);
+
     /**
      * @brief Render noise analysis section
      *
@@ -148,6 +283,11 @@ private:
      */
     void render_filters();
 
+    /**
+     * @brief Render the inter-event interval histograms per pixel class (refractory tuning)
+     */
+    void render_interval_histograms();
+
     /**
      * @brief Render focus adjust status window
      */
@@ -158,6 +298,16 @@ private:
      */
     void handle_load_dialog();
 
+    /**
+     * @brief Show a loaded image (texture, compare bits) and prefetch its neighbours
+     */
+    void show_loaded_image(LoadResult& result);
+
+    /**
+     * @brief Load the capture `step` files away from the current one in its directory
+     */
+    void step_loaded_image(int step);
+
     /**
      * @brief Handle save image dialog
      *
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace video {
+
+/**
+ * Adaptive accumulation window driven by the event rate
+ *
+ * With a fixed window, bright scenes saturate frames (and waste work)
+ * while dark scenes leave them empty. After each frame, update() compares
+ * what the frame held against a target (events per frame, or the fraction
+ * of set pixels) and returns the window for the next frame, between the
+ * configured bounds.
+ *
+ * Both targets are made proportional to the window first: the event count
+ * already is, and occupancy is linearised as -ln(1 - occupancy) (each pixel
+ * is hit with probability 1 - exp(-rate * window)). The window then moves
+ * by ratio^GAIN of the log-domain error, at most MAX_STEP per frame, and
+ * holds inside a DEADBAND around the target so it settles instead of
+ * dithering between neighbouring values.
+ *
+ * update() runs on the accumulation thread; settings may be changed from
+ * any thread.
+ */
+class AccumulationController {
+public:
+    /// What the window is tuned for
+    enum class Target {
+        Events = 0,     // Events per frame
+        Occupancy = 1   // Fraction of pixels set in the frame
+    };
+
+    static constexpr double GAIN = 0.5;        // Fraction of the log error corrected per frame
+    static constexpr double DEADBAND = 0.1;    // Relative error left alone
+    static constexpr double MAX_STEP = 2.0;    // Largest window change per frame (either way)
+    static constexpr double MAX_OCCUPANCY = 0.99;  // Occupancy clamp before linearising
+
+    AccumulationController() = default;
+    ~AccumulationController() = default;
+
+    // Non-copyable
+    AccumulationController(const AccumulationController&) = delete;
+    AccumulationController& operator=(const AccumulationController&) = delete;
+
+    /**
+     * Set target and window bounds
+     * @param target Events or Occupancy
+     * @param value Events per frame, or occupancy in (0, 1)
+     * @param min_us Shortest window
+     * @param max_us Longest window
+     */
+    void configure(Target target, double value, int min_us, int max_us);
+
+    /**
+     * Enable or disable adaptation (the window stays where it is when disabled)
+     */
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    Target get_target() const { return static_cast<Target>(target_.load(std::memory_order_relaxed)); }
+
+    /**
+     * Choose the window of the next frame from the one just emitted
+     * @param window_us Span the emitted frame covered
+     * @param events Events accumulated into it
+     * @param occupancy Fraction of its pixels set (only read for the Occupancy target)
+     * @return Next window in microseconds, within the bounds
+     */
+    uint32_t update(uint32_t window_us, uint64_t events, double occupancy) const;
+
+private:
+    std::atomic<bool> enabled_{false};
+    std::atomic<int> target_{static_cast<int>(Target::Events)};
+    std::atomic<double> value_{10000.0};
+    std::atomic<int> min_us_{1000};
+    std::atomic<int> max_us_{100000};
+};
+
+} // namespace video
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "core/metrics.h"
+#include "video/analyzer_plugin.h"
+#include "video/frame_ref.h"
+#include "video/thread_pool.h"
+
+namespace video {
+
+/**
+ * Runs analyzer plugins (see analyzer_plugin.h) on the frame and event fan-out
+ *
+ * Frames are handed over as FrameRefs, so every plugin reads the same pool
+ * buffer the display and scattering worker see; nothing is copied. Event
+ * batches are copied once from the event ring slot (recycled as soon as the
+ * accumulation thread is done with it) into a buffer from a small reuse
+ * pool, shared by every plugin that takes events.
+ *
+ * Each plugin has its own pending queue of QUEUE_DEPTH items and is run as
+ * a strand on the host's own ThreadPool: at most one pool task per plugin,
+ * draining its queue, so a plugin is never called concurrently with itself
+ * and a slow one occupies one worker while the others keep running. A full
+ * queue drops its oldest item, so a stalled plugin pins at most
+ * QUEUE_DEPTH + 1 frames of the frame pool and never blocks a producer.
+ *
+ * Per plugin, plugin.<name>.processed / .dropped count items and
+ * plugin.<name>.run_us records the time spent in the plugin.
+ *
+ * **Usage:**
+ * ```cpp
+ * host.load("analyzers/edge_stats.dll");
+ * host.start(2);
+ * host.submit_frame(camera_index, frame_ref);          // Producer threads
+ * host.submit_events(camera_index, begin, end);
+ * host.stop();
+ * ```
+ */
+class AnalyzerHost {
+public:
+    static constexpr int QUEUE_DEPTH = 2;        // Pending items per plugin
+    static constexpr int EVENT_BUFFERS = 16;     // Event batches in flight across all plugins
+
+    AnalyzerHost() = default;
+    ~AnalyzerHost();
+
+    // Non-copyable
+    AnalyzerHost(const AnalyzerHost&) = delete;
+    AnalyzerHost& operator=(const AnalyzerHost&) = delete;
+
+    /**
+     * Load a plugin library and create its instance (before start())
+     * @param path Shared library exporting rtcam_analyzer_entry()
+     * @return false if it cannot be loaded, has another ABI version or declines in create()
+     */
+    bool load(const std::string& path);
+
+    /**
+     * Add a plugin compiled into the application (before start())
+     * @param analyzer Descriptor with static lifetime
+     */
+    bool add(const rtcam_analyzer* analyzer);
+
+    /**
+     * Start the analyzer pool
+     * @param threads Pool workers (0 = one per plugin)
+     * @return true if at least one plugin is running
+     */
+    bool start(int threads);
+
+    /**
+     * Stop the pool, destroy every instance and unload the libraries
+     */
+    void stop();
+
+    bool is_running() const { return running_.load(std::memory_order_relaxed); }
+    bool wants_events() const { return wants_events_; }
+    int plugin_count() const { return static_cast<int>(plugins_.size()); }
+
+    /**
+     * Queue a frame for every plugin that takes frames (producer threads, never blocks)
+     * @param camera_index Camera the frame belongs to
+     * @param frame Binary frame (CV_8UC1) with its FrameTiming set
+     */
+    void submit_frame(int camera_index, const FrameRef& frame);
+
+    /**
+     * Queue an event batch for every plugin that takes events (accumulation threads, never blocks)
+     */
+    void submit_events(int camera_index, const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+private:
+    struct EventBatch {
+        std::vector<Metavision::EventCD> events;
+        int camera_index = 0;
+    };
+
+    struct Work {
+        int camera_index = 0;
+        FrameRef frame;                                   // Set for frames
+        std::shared_ptr<const EventBatch> events;         // Set for event batches
+    };
+
+    struct Plugin {
+        const rtcam_analyzer* analyzer = nullptr;
+        void* library = nullptr;     // nullptr = compiled in
+        void* instance = nullptr;
+        std::string prefix;          // "plugin.<name>."
+        rtcam_host_api api{};
+
+        // Pending work, guarded by mutex (a ring of QUEUE_DEPTH)
+        std::mutex mutex;
+        std::array<Work, QUEUE_DEPTH> queue;
+        int head = 0;
+        int size = 0;
+        bool scheduled = false;      // A drain task is queued or running
+
+        // Strand only
+        std::unordered_map<std::string, core::Gauge*> gauges;
+        std::unordered_map<std::string, core::Counter*> counters;
+
+        core::Counter* processed = nullptr;
+        core::Counter* dropped = nullptr;
+        core::Histogram* run_us = nullptr;
+    };
+
+    bool add_plugin(const rtcam_analyzer* analyzer, void* library, const std::string& source);
+    void enqueue(Plugin& plugin, Work&& work);
+    void drain(Plugin& plugin);
+    void run(Plugin& plugin, const Work& work);
+    std::shared_ptr<EventBatch> acquire_event_buffer();
+
+    static void set_gauge(void* host, const char* name, double value);
+    static void add_counter(void* host, const char* name, int64_t delta);
+    static void unload(void* library);
+
+    std::vector<std::unique_ptr<Plugin>> plugins_;
+    std::unique_ptr<ThreadPool> pool_;
+    std::atomic<bool> running_{false};
+    bool wants_events_ = false;
+
+    // Reused event buffers: one is free when nothing but this list holds it
+    std::vector<std::shared_ptr<EventBatch>> event_buffers_;
+    std::mutex event_buffers_mutex_;
+};
+
+} // namespace video
@@ -0,0 +1,114 @@
+#pragma once
+
+/**
+ * Analyzer plugin ABI (see video::AnalyzerHost)
+ *
+ * A plugin is a shared library (DLL / .so) exporting one C function,
+ * rtcam_analyzer_entry(), that returns a static rtcam_analyzer descriptor.
+ * The host loads the libraries listed in analyzer_plugins, calls create()
+ * once, then feeds the instance read-only views of every binary frame and
+ * raw event batch, and calls destroy() on shutdown. Only plain C types
+ * cross the boundary, so plugins may be built with any compiler.
+ *
+ * **Threading:** calls for one instance are serialized (never concurrent),
+ * but may come from any thread of the host's analyzer pool. A plugin that
+ * falls behind loses its own oldest pending views; it never holds back the
+ * camera or other plugins.
+ *
+ * **Lifetime:** views (and the memory they point to) are only valid during
+ * the call. Frames are the pipeline's own buffers, shared and never copied:
+ * never write through a view and never keep its pointers.
+ *
+ * **Results:** publish through host->set_gauge() / host->add_counter().
+ * Names are prefixed with "plugin.<name>.", so they appear in the metrics
+ * registry, the Prometheus / StatsD exporter and the fleet reports.
+ *
+ * Minimal plugin:
+ * ```c
+ * static void* create(const rtcam_host_api* host) { return (void*)host; }
+ * static void destroy(void* self) {}
+ * static void on_frame(void* self, const rtcam_frame_view* frame) {
+ *     const rtcam_host_api* host = self;
+ *     host->set_gauge(host->host, "width", frame->width);
+ * }
+ * static const rtcam_analyzer analyzer = {
+ *     RTCAM_ANALYZER_ABI_VERSION, "example", create, destroy, on_frame, NULL};
+ * RTCAM_ANALYZER_EXPORT const rtcam_analyzer* rtcam_analyzer_entry(void) { return &analyzer; }
+ * ```
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RTCAM_ANALYZER_ABI_VERSION 1u
+#define RTCAM_ANALYZER_ENTRY "rtcam_analyzer_entry"
+
+#ifdef _WIN32
+#define RTCAM_ANALYZER_EXPORT __declspec(dllexport)
+#else
+#define RTCAM_ANALYZER_EXPORT __attribute__((visibility("default")))
+#endif
+
+/** Pixel layout of a frame view */
+enum rtcam_frame_format {
+    RTCAM_FRAME_U8 = 0,       /* One byte per pixel: 0 = background, non-zero = set */
+    RTCAM_FRAME_PACKED = 1    /* One bit per pixel in 64-bit words, least significant bit = leftmost pixel */
+};
+
+/** Read-only view of one binary frame */
+typedef struct rtcam_frame_view {
+    const uint8_t* data;      /* First row */
+    int32_t width;
+    int32_t height;
+    int64_t stride;           /* Bytes between rows */
+    uint32_t format;          /* rtcam_frame_format */
+    uint32_t camera_index;
+    int64_t timestamp_us;     /* Sensor time at the end of the frame's window */
+    uint32_t window_us;       /* Span the frame covers (0 = unknown) */
+    uint32_t reserved;
+    int64_t events;           /* Events accumulated into it (-1 = not counted) */
+} rtcam_frame_view;
+
+/** One CD event, laid out like Metavision::EventCD (16 bytes) */
+typedef struct rtcam_event {
+    uint16_t x;
+    uint16_t y;
+    int16_t p;                /* Polarity: 0 = OFF, 1 = ON */
+    int16_t reserved;
+    int64_t t;                /* Sensor time (us) */
+} rtcam_event;
+
+/** Read-only view of one raw event batch, in timestamp order */
+typedef struct rtcam_event_view {
+    const rtcam_event* events;
+    uint64_t count;
+    uint32_t camera_index;
+    uint32_t reserved;
+} rtcam_event_view;
+
+/** Services the host offers a plugin instance (valid until destroy()) */
+typedef struct rtcam_host_api {
+    uint32_t abi_version;
+    void* host;               /* Pass back as the first argument */
+    void (*set_gauge)(void* host, const char* name, double value);
+    void (*add_counter)(void* host, const char* name, int64_t delta);
+} rtcam_host_api;
+
+/** Plugin descriptor returned by rtcam_analyzer_entry() */
+typedef struct rtcam_analyzer {
+    uint32_t abi_version;     /* RTCAM_ANALYZER_ABI_VERSION the plugin was built against */
+    const char* name;         /* Short unique name, used in metric names */
+    void* (*create)(const rtcam_host_api* host);               /* NULL return = plugin disabled */
+    void (*destroy)(void* self);
+    void (*on_frame)(void* self, const rtcam_frame_view* frame);      /* May be NULL */
+    void (*on_events)(void* self, const rtcam_event_view* events);    /* May be NULL */
+} rtcam_analyzer;
+
+typedef const rtcam_analyzer* (*rtcam_analyzer_entry_fn)(void);
+
+#ifdef __cplusplus
+}
+#endif
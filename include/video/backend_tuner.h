@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "video/event_noise_filter.h"
+#include "video/simd_utils.h"
+
+namespace video {
+
+/**
+ * Startup benchmark that picks the fastest implementation of each kernel
+ *
+ * CPU feature flags only say which paths can run, not which is fastest:
+ * AVX-512 can lower the core clock, and on some parts the wider loads of
+ * a higher tier lose to a narrower one. run() times every tier of every
+ * simd::Kernel (and every EventNoiseFilter path) on a representative
+ * 1280x720 frame and event batch, dispatches each kernel to its fastest
+ * tier, and caches the choice in a small text file keyed by a hash of the
+ * CPU's identity (vendor, brand string, features, logical cores). Later
+ * starts on the same machine read the cache and skip the measurement; a
+ * different machine, or a new tuner version, measures again.
+ *
+ * A tier only replaces the default (the highest one) when it is at least
+ * MIN_GAIN faster, so timer noise does not flip choices between runs.
+ * Overrides ("kernel:tier;...", e.g. "bgr_to_gray:avx2;noise_filter:scalar")
+ * are applied last and win over both the cache and the measurement.
+ *
+ * Call once at startup, before the camera threads run.
+ */
+class BackendTuner {
+public:
+    static constexpr double MIN_GAIN = 0.05;        // 5%
+    static constexpr int TUNER_VERSION = 1;          // Bump when kernels or the benchmark change
+
+    struct Options {
+        std::string cache_path = "backend_tuning.txt";   // "" = measure every start, save nothing
+        std::string overrides;                            // "kernel:tier;..." (noise_filter: scalar/sse4.1/avx2)
+        bool measure = true;                              // false = cache and overrides only
+        int width = 1280;
+        int height = 720;
+        int round_us = 2000;                              // Minimum length of one timed round
+        int rounds = 3;                                   // Best round counts
+    };
+
+    struct Choice {
+        std::string kernel;                 // simd::kernel_name() or "noise_filter"
+        std::string backend;                // Tier or path dispatched
+        std::string timings;                // "scalar 812.0 us, avx2 95.1 us" (empty when from the cache)
+        bool overridden = false;
+    };
+
+    /**
+     * Apply the cached or measured choices, then the overrides
+     * @return false if nothing could be applied (defaults stay)
+     */
+    bool run(const Options& options);
+
+    /**
+     * Run every kernel once at its dispatched tier on a frame of the sensor size (after run())
+     *
+     * The first call of a kernel pays for its dispatch lookup, cold code and,
+     * for wide vectors, powering up the upper register halves; this moves
+     * that cost before streaming.
+     * @return Milliseconds taken
+     */
+    static double warm_up(int width, int height);
+
+    /**
+     * Hash identifying this machine's CPU for the cache (16 hex digits)
+     */
+    static std::string machine_id();
+
+    const std::vector<Choice>& get_choices() const { return choices_; }
+    bool is_from_cache() const { return from_cache_; }
+
+private:
+    bool load_cache(const std::string& path, const std::string& id);
+    bool save_cache(const std::string& path, const std::string& id) const;
+    void measure(const Options& options);
+    void apply_overrides(const std::string& overrides);
+
+    /**
+     * Best time per call over options.rounds rounds of at least options.round_us
+     */
+    template <typename Fn>
+    static double time_call_us(const Options& options, Fn&& fn);
+
+    static bool parse_path(const std::string& name, EventNoiseFilter::Path& path);
+
+    std::vector<Choice> choices_;
+    bool from_cache_ = false;
+};
+
+} // namespace video
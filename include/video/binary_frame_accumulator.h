@@ -0,0 +1,530 @@
+#pragma once
+
+#include "video/binary_frame.h"
+#include "video/block_map.h"
+#include "video/frame_ref.h"
+#include "video/thread_pool.h"
+#include <opencv2/core.hpp>
+#include <metavision/sdk/base/events/event_cd.h>
+#include <metavision/sdk/base/utils/timestamp.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace video {
+
+/**
+ * Direct event-to-binary-frame accumulator
+ *
+ * Replaces PeriodicFrameGenerationAlgorithm + per-frame bit extraction for
+ * the live binary view. Events are written straight into a single-channel
+ * CV_8UC1 frame (0 or 255) instead of a 3-channel palette frame that is
+ * later reduced with extractChannel + two LUTs + bitwise_or.
+ *
+ * Output is bit-identical to the old pipeline: the background, ON and OFF
+ * palette colours are reduced once through the configured bit mask, so
+ * each event is a single byte store.
+ *
+ * With polarity planes enabled, the low two bits of a set pixel also record
+ * which polarities fired in the window (OFF_BIT / ON_BIT, straight from
+ * EventCD::p in the same pass): set pixels are SET_BITS plus those bits
+ * (252-255) instead of 255, so every "non-zero = set" consumer is unchanged
+ * while BinaryFrame::assign_masked(frame, ON_BIT) picks out one polarity
+ * without another extraction. Each event is then a read-modify-write of
+ * its byte. An event of a polarity the bit mask hides still clears the
+ * pixel, as in the old pipeline.
+ *
+ * **PERFORMANCE:** Output frames come from a small recycled pool. A pool
+ * slot is only reused when nobody else (FrameBuffer, viewer) still holds
+ * a reference to it, so emitted frames can be shared zero-copy.
+ *
+ * With packed output enabled, the same pass also keeps a bit-packed copy
+ * of the frame (one bit read-modify-write per event), so coarser windows
+ * can be OR-reduced from it (see WindowPyramid) without packing 8-bit
+ * frames or touching events again.
+ *
+ * Each frame also carries the 64-row bands its events touched (one OR per
+ * event), so the display can re-upload only the bands that changed.
+ *
+ * The same pass keeps the frame's statistics (FrameStats): event and ON
+ * counts, the events' bounding box and the number of non-zero pixels,
+ * updated on every 0 <-> non-zero transition. Consumers read them instead
+ * of rescanning the frame with cv::countNonZero.
+ *
+ * With preview binning enabled, the same pass also ORs every event into a
+ * 2x2 or 4x4 binned preview (one byte OR per event into a frame 1/4 or
+ * 1/16 the size), which zoomed-out displays and remote viewers can use in
+ * place of the full frame. A preview pixel is set when any event of a
+ * visible polarity hit its block during the window.
+ *
+ * Frames are time-sliced by default (one per window, aligned to multiples
+ * of the accumulation time). Event-count slicing emits a frame every N
+ * events instead, optionally also when the frame has spanned the
+ * accumulation time, so frame density (and per-frame analysis cost) stays
+ * bounded under bursts. Batches are split in place at slice boundaries.
+ *
+ * **PARALLEL BANDS:** At extreme event rates one thread writing every
+ * event becomes the ceiling. With set_parallel_threads(), each window span
+ * of a large batch is bucketed once by row band (a stable copy, so events
+ * on the same pixel keep their order) and the bands are written by a
+ * private thread pool into disjoint rows of the same frame, packed frame
+ * and preview. No atomics are needed, and the frame is identical to the
+ * serial result; parallel_for() returning is the barrier before a window
+ * is emitted. Small spans stay on the calling thread.
+ *
+ * **PACKED INPUT:** A raw decoder (RawEventDecoder) may skip EventCD
+ * entirely and write vectors of up to 32 same-row events straight into the
+ * packed frame (write_packed(), one or two word updates per vector) when
+ * accepts_packed_input(). The 8-bit frame is then filled from the packed
+ * bits of the touched row bands just before it is emitted.
+ *
+ * Not thread-safe: process_events() must be called from a single thread
+ * (the SDK decoding thread).
+ */
+class BinaryFrameAccumulator {
+public:
+    /// Output callback: frame timestamp (end of window) and binary frame
+    using OutputCallback = std::function<void(Metavision::timestamp, cv::Mat&)>;
+
+    /// Pixel bits with polarity planes enabled
+    static constexpr uint8_t OFF_BIT = 0x01;    // An OFF (p = 0) event hit the pixel in this window
+    static constexpr uint8_t ON_BIT = 0x02;     // An ON (p = 1) event hit the pixel in this window
+    static constexpr uint8_t SET_BITS = 0xFC;   // Rest of a set pixel (background stays 0, or SET_BITS if white)
+
+    static constexpr int MAX_PREVIEW_BINNING = 4;   // Pixels per side of a preview block
+    static constexpr int MAX_PARALLEL_THREADS = 16;
+    static constexpr size_t PARALLEL_MIN_EVENTS = 16384;   // Smaller spans are not worth a fork/join
+
+    /// Statistics of a frame, kept while its events are written
+    struct FrameStats {
+        uint64_t events = 0;
+        uint64_t on_events = 0;         // OFF = events - on_events
+        int64_t active_pixels = 0;      // Non-zero pixels, as cv::countNonZero would report
+        int x_min = std::numeric_limits<int>::max();   // Bounding box of the events (inclusive), frame coords;
+        int y_min = std::numeric_limits<int>::max();   // empty (x_max < x_min) when there were none
+        int x_max = -1;
+        int y_max = -1;
+
+        bool has_box() const { return x_max >= x_min; }
+        cv::Rect box() const { return has_box() ? cv::Rect(x_min, y_min, x_max - x_min + 1, y_max - y_min + 1) : cv::Rect(); }
+
+        /**
+         * Add the counts and box of a span written separately (events are counted by the caller)
+         */
+        void merge_span(const FrameStats& span) {
+            on_events += span.on_events;
+            active_pixels += span.active_pixels;
+            x_min = std::min(x_min, span.x_min);
+            y_min = std::min(y_min, span.y_min);
+            x_max = std::max(x_max, span.x_max);
+            y_max = std::max(y_max, span.y_max);
+        }
+    };
+
+    /// When a frame is emitted
+    enum class SliceMode {
+        Time = 0,           // Every accumulation window (default)
+        Events = 1,         // Every slice_events events
+        EventsOrTime = 2    // slice_events events or the accumulation time since the frame's first event, first reached
+    };
+
+    /**
+     * Create accumulator
+     * @param width Sensor width
+     * @param height Sensor height
+     * @param accumulation_time_us Window length in microseconds
+     */
+    BinaryFrameAccumulator(int width, int height, uint32_t accumulation_time_us);
+    ~BinaryFrameAccumulator() = default;
+
+    // Non-copyable
+    BinaryFrameAccumulator(const BinaryFrameAccumulator&) = delete;
+    BinaryFrameAccumulator& operator=(const BinaryFrameAccumulator&) = delete;
+
+    /**
+     * Set the bits of the palette value that map to white
+     * @param bit_1 First bit position (0-7)
+     * @param bit_2 Second bit position (0-7)
+     */
+    void set_binary_bits(int bit_1, int bit_2);
+
+    /**
+     * Change window length and bit positions at the next window boundary
+     *
+     * The frame in progress is finished with the old settings; the next
+     * one starts with the new ones, aligned to multiples of the new window.
+     * @param accumulation_time_us New window length in microseconds
+     * @param bit_1 First bit position (0-7)
+     * @param bit_2 Second bit position (0-7)
+     */
+    void reconfigure(uint32_t accumulation_time_us, int bit_1, int bit_2);
+
+    /**
+     * Change only the window length at the next window boundary (bits unchanged)
+     *
+     * Called from the output callback, the new length applies to the very
+     * next frame, which starts at the boundary just reached rather than
+     * being realigned to multiples of the new length.
+     * @param accumulation_time_us New window length in microseconds
+     */
+    void set_accumulation_time(uint32_t accumulation_time_us);
+
+    /**
+     * Record per-pixel polarity in the low two bits of set pixels (see class comment)
+     * @param enabled true for polarity planes, false for plain 0/255 frames
+     */
+    void set_polarity_planes(bool enabled);
+    bool has_polarity_planes() const { return polarity_planes_; }
+
+    /**
+     * Choose how frames are sliced (see SliceMode)
+     * @param mode Time, Events or EventsOrTime
+     * @param slice_events Events per frame for the event-count modes
+     */
+    void set_slicing(SliceMode mode, uint32_t slice_events);
+    SliceMode get_slice_mode() const { return slice_mode_; }
+    uint32_t get_slice_events() const { return slice_events_; }
+
+    /**
+     * Also build a bit-packed copy of every frame while accumulating
+     * @param enabled true to maintain packed_frame()
+     */
+    void set_packed_output(bool enabled);
+    bool has_packed_output() const { return packed_output_; }
+
+    /**
+     * Get the bit-packed copy of the frame being emitted (set pixel = non-zero byte)
+     *
+     * Only valid inside the output callback, and only with packed output enabled.
+     */
+    const BinaryFrame& packed_frame() const { return packed_; }
+
+    /**
+     * Also OR-bin every frame into a preview while accumulating
+     * @param binning Pixels per side of a preview pixel: 2 or 4 (0 or 1 = off)
+     */
+    void set_preview_binning(int binning);
+    int get_preview_binning() const { return preview_shift_ ? 1 << preview_shift_ : 0; }
+
+    /**
+     * Get the binned preview of the frame being emitted (CV_8UC1 0/255)
+     *
+     * Only valid inside the output callback; the Mat may be kept, a pool
+     * slot is only reused once nobody else references it. Empty when
+     * binning is off, and with a white background (every block would read
+     * as set).
+     */
+    const cv::Mat& preview_frame() const;
+
+    /**
+     * Write large batches with several threads, split by row band (see class comment)
+     * @param threads Threads including the caller (0 or 1 = serial)
+     */
+    void set_parallel_threads(int threads);
+    int get_parallel_threads() const { return parallel_pool_ ? parallel_pool_->concurrency() : 1; }
+
+    /**
+     * Get the row bands events touched in the frame being emitted
+     *
+     * Only valid inside the output callback. Every pixel outside these bands
+     * is background, so displays can upload just the bands that changed.
+     */
+    const RowBands& row_bands() const { return row_bands_; }
+
+    /**
+     * Get the 64 x 8 blocks events touched in the frame being emitted
+     *
+     * Only read inside the output callback; the map itself is not reused
+     * while anyone holds it, so frames can carry it downstream.
+     * @return nullptr on a white background (every block differs from black)
+     */
+    std::shared_ptr<const BlockMap> block_map() const {
+        return bg_value_ ? nullptr : blocks_;
+    }
+
+    /**
+     * Get the time span the frame being emitted actually covers (us)
+     *
+     * Only valid inside the output callback. Differs from the accumulation
+     * time after a reconfigure, for event-count slices and catch-up frames.
+     */
+    uint32_t frame_window_us() const { return emitted_window_us_; }
+
+    /**
+     * Get the number of events accumulated into the frame being emitted
+     *
+     * Only valid inside the output callback.
+     */
+    uint64_t frame_events() const { return emitted_stats_.events; }
+
+    /**
+     * Get the number of ON events among frame_events() (OFF = the rest)
+     *
+     * Only valid inside the output callback.
+     */
+    uint64_t frame_on_events() const { return emitted_stats_.on_events; }
+
+    /**
+     * Get the statistics of the frame being emitted (see FrameStats)
+     *
+     * Only valid inside the output callback.
+     */
+    const FrameStats& frame_stats() const { return emitted_stats_; }
+
+    /**
+     * Set callback invoked for every completed window
+     * @param callback Output callback
+     */
+    void set_output_callback(OutputCallback callback);
+
+    /**
+     * Check if write_packed() may be used: packed output on, plain 0/255 frames
+     * on a black background, time slicing, no preview
+     */
+    bool accepts_packed_input() const {
+        return packed_output_ && packed_per_event_ && !polarity_planes_ && preview_shift_ == 0 &&
+               slice_mode_ == SliceMode::Time;
+    }
+
+    /**
+     * Packed input: move to a timestamp, emitting every window it closes
+     * @param ts Timestamp of the events written next (non-decreasing)
+     */
+    void advance_packed(Metavision::timestamp ts) {
+        if (ts >= next_flush_ts_) {
+            cross_window(ts);
+        }
+    }
+
+    /**
+     * Packed input: events of one polarity at (x + i, y) for every set bit i of mask
+     *
+     * Same result as process_events() with those events in any order, since
+     * they share a timestamp, a polarity and no pixel. Call advance_packed()
+     * with their timestamp first.
+     */
+    void write_packed(int x, int y, uint32_t mask, int p) {
+        if (y >= height_ || x >= width_) {
+            return;   // Outside the sensor
+        }
+        if (x > width_ - 32) {
+            mask &= (uint32_t(1) << (width_ - x)) - 1;   // Padding bits stay zero
+        }
+        if (mask == 0) {
+            return;
+        }
+        packed_input_ = true;
+        uint64_t* row = packed_.row(y) + (x >> 6);
+        const int shift = x & 63;
+        const uint64_t lo = uint64_t(mask) << shift;
+        const uint64_t before = row[0];
+        row[0] = (before & ~lo) | (lo & polarity_bits_[p]);
+        int64_t active = BinaryFrame::popcount(row[0]) - BinaryFrame::popcount(before);
+        if (shift > 32) {
+            const uint64_t hi = uint64_t(mask) >> (64 - shift);
+            const uint64_t before_hi = row[1];
+            row[1] = (before_hi & ~hi) | (hi & polarity_bits_[p]);
+            active += BinaryFrame::popcount(row[1]) - BinaryFrame::popcount(before_hi);
+        }
+        const uint64_t count = static_cast<uint64_t>(BinaryFrame::popcount(mask));
+        frame_stats_.events += count;
+        frame_stats_.on_events += p ? count : 0;
+        frame_stats_.active_pixels += active;
+        frame_stats_.x_min = std::min(frame_stats_.x_min, x + BinaryFrame::lowest_set_bit(mask));
+        frame_stats_.x_max = std::max(frame_stats_.x_max, x + BinaryFrame::highest_set_bit(mask));
+        frame_stats_.y_min = std::min(frame_stats_.y_min, y);
+        frame_stats_.y_max = std::max(frame_stats_.y_max, y);
+        row_bands_.bands |= uint64_t(1) << std::min(y / RowBands::BAND_ROWS, 63);
+        blocks_->mark(x + BinaryFrame::lowest_set_bit(mask), y);
+        blocks_->mark(x + BinaryFrame::highest_set_bit(mask), y);
+    }
+
+    /**
+     * Accumulate a batch of events, emitting frames at window boundaries
+     * @param begin First event
+     * @param end One past last event
+     */
+    void process_events(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Drop the frame in progress and restart window alignment
+     */
+    void reset();
+
+    /**
+     * Accumulate a batch into the frame in progress without emitting at window
+     * boundaries, collapsing a backlog into one catch-up frame
+     */
+    void process_catch_up(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Emit the catch-up frame and resume whole windows after it
+     * @param last_ts Timestamp of the last event accumulated
+     */
+    void end_catch_up(Metavision::timestamp last_ts);
+
+    uint32_t get_accumulation_time_us() const { return accumulation_time_us_; }
+
+private:
+    /**
+     * Recompute the per-polarity pixel values from the bit mask and mode
+     */
+    void update_pixel_values();
+
+    /**
+     * Event loop; Planes merges the event's polarity bit into the pixel,
+     * Packed mirrors the pixel into packed_, Preview ORs it into preview_
+     */
+    template <bool Planes, bool Packed, bool Preview>
+    void accumulate(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Write events of one window into the frame in progress (no boundary checks)
+     *
+     * Only touches the rows of its events, so spans of disjoint rows may run concurrently.
+     * @param bands ORed with the row bands written
+     * @param stats ON events, active pixel changes and box of the events written merged in (events not counted)
+     */
+    template <bool Planes, bool Packed, bool Preview>
+    void write_span(const Metavision::EventCD* begin, const Metavision::EventCD* end,
+                    uint64_t& bands, FrameStats& stats);
+
+    /**
+     * write_span() split by row band over the parallel pool
+     */
+    template <bool Planes, bool Packed, bool Preview>
+    void write_span_parallel(const Metavision::EventCD* begin, const Metavision::EventCD* end,
+                             uint64_t& bands, FrameStats& stats);
+
+    /**
+     * Emit the current frame and start a fresh window
+     * @param ts Timestamp of the emitted frame
+     */
+    void flush(Metavision::timestamp ts);
+
+    /**
+     * Packed input reached the next boundary: align the first window, or emit
+     * the frame and skip idle windows up to ts
+     */
+    void cross_window(Metavision::timestamp ts);
+
+    /**
+     * Set the 8-bit frame's pixels from the packed frame (touched row bands only)
+     */
+    void unpack_packed_input();
+
+    /**
+     * Cut a batch at event-count (and time-limit) slice boundaries, accumulating each span
+     */
+    template <bool Planes, bool Packed, bool Preview>
+    void accumulate_slices(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Run accumulate() or accumulate_slices() for one combination of modes
+     */
+    template <bool Planes, bool Packed, bool Preview>
+    void accumulate_modes(const Metavision::EventCD* begin, const Metavision::EventCD* end, bool slices);
+
+    /**
+     * Run accumulate() or accumulate_slices() instantiated for the current modes
+     * @param slices false to ignore event-count slicing (catch-up frame)
+     */
+    void dispatch(const Metavision::EventCD* begin, const Metavision::EventCD* end, bool slices);
+
+    /**
+     * Record the span and event count of the frame about to be emitted
+     * @param ts Timestamp of the emitted frame (end of its span)
+     */
+    void set_emitted(Metavision::timestamp ts);
+
+    /**
+     * Pick a pool frame nobody else references and clear it to background
+     */
+    void begin_frame();
+
+    /**
+     * Point frame at a pool slot nobody else references (a fresh buffer if every slot is held)
+     */
+    static void acquire(std::vector<cv::Mat>& pool, cv::Mat& frame, int rows, int cols);
+
+    /**
+     * Point blocks_ at a pool map nobody else holds (a fresh one if every map is held) and clear it
+     */
+    void acquire_blocks();
+
+    /**
+     * Apply reconfigure() settings between frames
+     * @param ts Timestamp of the frame just emitted
+     */
+    void apply_pending(Metavision::timestamp ts);
+
+    int width_;
+    int height_;
+    uint32_t accumulation_time_us_;
+
+    // Binary value for background, OFF (p=0) and ON (p=1) pixels
+    int bit_mask_ = 0;
+    uint8_t bg_value_ = 0;
+    uint8_t polarity_value_[2] = {255, 255};
+
+    // Polarity planes: pixel = (pixel & keep_mask_[p]) | polarity_value_[p]
+    bool polarity_planes_ = false;
+    uint8_t keep_mask_[2] = {0, 0};
+
+    // Packed output: bit of an event's pixel = polarity_bits_[p] (all ones if the pixel ends up set)
+    bool packed_output_ = false;
+    bool packed_per_event_ = false;   // false: white background, frame packed at emission instead
+    uint64_t polarity_bits_[2] = {0, 0};
+    BinaryFrame packed_;
+    bool packed_input_ = false;       // Frame in progress has write_packed() events not in current_
+
+    // Bands with an event in the frame in progress (one OR per event)
+    RowBands row_bands_;
+
+    // Blocks with an event in the frame in progress (one byte store per event)
+    std::vector<std::shared_ptr<BlockMap>> block_pool_;
+    std::shared_ptr<BlockMap> blocks_;
+
+    // Binned preview: block (y >> shift, x >> shift) |= preview_value_[p]; shift 0 = off
+    int preview_shift_ = 0;
+    uint8_t preview_value_[2] = {0, 0};
+    std::vector<cv::Mat> preview_pool_;
+    cv::Mat preview_;
+
+    // Parallel bands: rows [i * band_rows_, (i + 1) * band_rows_) go to task i
+    std::unique_ptr<ThreadPool> parallel_pool_;
+    int parallel_band_rows_ = 0;
+    std::vector<std::vector<Metavision::EventCD>> band_events_;   // Per-band copy, capacity kept
+    std::vector<uint64_t> band_bits_;
+    std::vector<FrameStats> band_stats_;
+
+    OutputCallback output_callback_;
+
+    static constexpr int POOL_SIZE = 16;  // Covers the frame queue plus display holders
+    std::vector<cv::Mat> pool_;
+    cv::Mat current_;
+
+    Metavision::timestamp next_flush_ts_ = -1;  // -1 = not aligned yet
+    Metavision::timestamp frame_start_ts_ = 0;  // Start of the frame in progress
+
+    // Frame in progress: statistics so far; frame being emitted: its span and statistics
+    FrameStats frame_stats_;
+    uint32_t emitted_window_us_ = 0;
+    FrameStats emitted_stats_;
+
+    // reconfigure() settings waiting for the next window boundary
+    bool pending_ = false;
+    uint32_t pending_accumulation_time_us_ = 0;
+    int pending_bit_mask_ = 0;
+    bool pending_align_ = true;  // Realign to the new window grid (false: just set_accumulation_time())
+
+    // Event-count slicing
+    SliceMode slice_mode_ = SliceMode::Time;
+    uint32_t slice_events_ = 1;
+    uint32_t slice_count_ = 0;  // Events in the frame in progress
+};
+
+} // namespace video
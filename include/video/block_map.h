@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace video {
+
+/**
+ * Two-level occupancy summary of a binary frame on a black background
+ *
+ * Level 1 has one byte per 64 x 8 block (one packed word wide, eight rows
+ * high), set by the frame builder when an event lands in the block; level 2
+ * has one byte per block row, built by finish(). Kernels test a block row
+ * first and skip its eight rows at once, then skip single empty blocks, so
+ * activity confined to a small area costs about its own size.
+ *
+ * Bytes rather than bits, so threads writing disjoint block rows never share
+ * a word. A frame without a map (nullptr) may have pixels set anywhere.
+ *
+ * **Usage:**
+ * ```cpp
+ * map.reset(width, height);
+ * map.mark(x, y);                 // Per event
+ * map.finish();                   // Before the frame is handed on
+ * if (!map.row_any(y >> BlockMap::ROW_SHIFT)) { ... }
+ * ```
+ */
+class BlockMap {
+public:
+    static constexpr int COL_SHIFT = 6;   // 64 columns per block (one packed word)
+    static constexpr int ROW_SHIFT = 3;   // 8 rows per block
+    static constexpr int BLOCK_ROWS = 1 << ROW_SHIFT;
+
+    /**
+     * Size for a frame and clear every block (storage is reused)
+     */
+    void reset(int width, int height) {
+        width_ = width;
+        height_ = height;
+        cols_ = (width + (1 << COL_SHIFT) - 1) >> COL_SHIFT;
+        rows_ = (height + BLOCK_ROWS - 1) >> ROW_SHIFT;
+        blocks_.assign(static_cast<size_t>(cols_) * rows_, 0);
+        row_any_.assign(static_cast<size_t>(rows_), 0);
+    }
+
+    // Level 1 (frame builder)
+    void mark(int x, int y) { blocks_[static_cast<size_t>(y >> ROW_SHIFT) * cols_ + (x >> COL_SHIFT)] = 1; }
+    uint8_t* data() { return blocks_.data(); }
+
+    /**
+     * Build level 2 from the marked blocks (once all events are in)
+     */
+    void finish() {
+        for (int by = 0; by < rows_; ++by) {
+            const uint8_t* row = blocks_.data() + static_cast<size_t>(by) * cols_;
+            row_any_[by] = std::any_of(row, row + cols_, [](uint8_t b) { return b != 0; });
+        }
+    }
+
+    bool row_any(int by) const { return row_any_[by] != 0; }
+    bool block(int bx, int by) const { return blocks_[static_cast<size_t>(by) * cols_ + bx] != 0; }
+
+    int cols() const { return cols_; }
+    int rows() const { return rows_; }
+    bool matches(int width, int height) const { return width == width_ && height == height_ && !blocks_.empty(); }
+
+    /**
+     * Count occupied blocks
+     */
+    int64_t count() const { return std::count(blocks_.begin(), blocks_.end(), uint8_t(1)); }
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    int cols_ = 0;
+    int rows_ = 0;
+    std::vector<uint8_t> blocks_;   // Level 1, row-major by block row
+    std::vector<uint8_t> row_any_;  // Level 2, one per block row
+};
+
+} // namespace video
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "video/binary_frame.h"
+#include "video/burst_file.h"
+
+namespace video {
+
+/**
+ * Captures every frame around a trigger into RAM, then writes one burst file
+ *
+ * While armed, the producer packs each frame into a preallocated ring of
+ * BinaryFrames (1 bit per pixel, no allocation, no encoding) that always
+ * holds the most recent pre_frames. trigger() lets post_frames more arrive,
+ * after which a writer thread saves the window as a single burst_file
+ * container with per-frame timestamps. PNG conversion happens only when
+ * requested through export_png(), long after the burst.
+ *
+ * States: Idle -> arm() -> Armed -> trigger() -> Triggered -> Flushing -> Idle
+ *
+ * arm_window() captures a window whose end is not known in frames (an
+ * external trigger gate): it starts Triggered with no pre-trigger frames,
+ * and finish() writes what was captured when the window closes.
+ *
+ * **Usage:**
+ * ```cpp
+ * burst.arm(frame_size, 500, 500, "C:\\bursts\\burst.rtbf");
+ * burst.push(frame, timestamp_us);   // Producer thread, every frame
+ * burst.trigger();                   // UI thread, when the failure shows
+ * burst.request_export();            // Later: PNGs of the last burst
+ * ```
+ */
+class BurstCapture {
+public:
+    enum class State {
+        Idle,
+        Armed,       // Filling the pre-trigger window
+        Triggered,   // Filling the post-trigger window
+        Flushing     // Writer thread saving the ring; frames are ignored
+    };
+
+    BurstCapture();
+    ~BurstCapture();
+
+    // Non-copyable
+    BurstCapture(const BurstCapture&) = delete;
+    BurstCapture& operator=(const BurstCapture&) = delete;
+
+    /**
+     * Allocate the ring and start buffering frames
+     * @param size Frame size (frames of any other size are ignored)
+     * @param pre_frames Frames kept from before the trigger
+     * @param post_frames Frames captured from the trigger on
+     * @param path Burst file written once the post-trigger window is full
+     * @return false if not idle or the window is empty
+     */
+    bool arm(cv::Size size, int pre_frames, int post_frames, const std::string& path);
+
+    /**
+     * Start capturing at the next frame until finish() (or max_frames)
+     * @param size Frame size (frames of any other size are ignored)
+     * @param max_frames Longest window; the burst is written once it is full
+     * @param path Burst file written when the window ends
+     * @return false if not idle or max_frames < 1
+     */
+    bool arm_window(cv::Size size, int max_frames, const std::string& path);
+
+    /**
+     * Write the frames captured so far now instead of after post_frames
+     * (Triggered; an armed capture without frames is disarmed)
+     */
+    void finish();
+
+    /**
+     * Stop buffering without writing anything (Armed / Triggered only)
+     */
+    void disarm();
+
+    /**
+     * Free the ring of an idle capture (the next arm() allocates it again)
+     * @return Bytes freed (0 unless Idle)
+     */
+    size_t release_ring();
+
+    /**
+     * Start the post-trigger window at the next frame
+     */
+    void trigger() { trigger_requested_ = true; }
+
+    /**
+     * Offer a frame to the ring (producer thread; no-op unless armed)
+     * @param frame CV_8UC1 binary frame, or a raw frame whose channel 0 is tested against bit_mask
+     * @param timestamp_us Sensor timestamp of the frame
+     * @param bit_mask Bits of channel 0 that mark a pixel set (0 = any non-zero value)
+     */
+    void push(const cv::Mat& frame, int64_t timestamp_us, uint8_t bit_mask = 0) {
+        if (capturing_.load(std::memory_order_acquire)) {
+            push_frame(frame, timestamp_us, bit_mask);
+        }
+    }
+
+    /**
+     * Convert the most recently written burst to PNGs on the writer thread
+     * (written next to it in a folder named after the file)
+     * @param png_params cv::imwrite parameters (empty = 1-bit, fastest zlib level)
+     * @return false if there is no burst file or the writer is busy
+     */
+    bool request_export(std::vector<int> png_params = {});
+
+    /**
+     * Convert a burst file to one PNG per frame (blocking)
+     * @param burst_path File written by BurstCapture
+     * @param directory Output directory (empty = next to the burst, in a folder named after it)
+     * @param png_params cv::imwrite parameters (empty = 1-bit, fastest zlib level)
+     * @return Number of PNGs written, -1 if the file could not be read
+     */
+    static int export_png(const std::string& burst_path, const std::string& directory = "",
+                          std::vector<int> png_params = {});
+
+    State get_state() const { return state_.load(std::memory_order_acquire); }
+    bool is_exporting() const { return exporting_.load(); }
+
+    // Statistics
+    int get_capacity() const { return static_cast<int>(slots_.size()); }
+    int get_buffered_frames() const;                    // Frames held in the ring right now
+    int get_post_frames_remaining() const;              // While triggered
+    size_t get_ring_bytes() const { return ring_bytes_.load(std::memory_order_relaxed); }   // RAM held by the ring
+    int64_t get_frames_ignored() const { return frames_ignored_.load(std::memory_order_relaxed); }
+    std::string get_last_file() const;                  // Empty until a burst is written
+    bool has_write_error() const { return write_error_.load(); }
+
+private:
+    struct Slot {
+        BinaryFrame frame;
+        int64_t timestamp_us = 0;
+        uint64_t sequence = 0;
+    };
+
+    void push_frame(const cv::Mat& frame, int64_t timestamp_us, uint8_t bit_mask);
+    void request_flush();   // ring_mutex_ held
+    void worker_loop();
+    bool write_burst();
+    static bool pack(const cv::Mat& frame, uint8_t bit_mask, BinaryFrame& out);
+
+    // Ring (written by the producer only while Armed / Triggered, read by the
+    // writer only while Flushing)
+    std::vector<Slot> slots_;
+    cv::Size size_;
+    int pre_frames_ = 0;
+    int post_frames_ = 0;
+    uint64_t write_seq_ = 0;       // Frames pushed since arm()
+    uint64_t trigger_seq_ = 0;     // First post-trigger frame
+    std::string path_;
+    std::mutex ring_mutex_;        // Producer vs. arm() / disarm(), never held while writing
+
+    std::atomic<State> state_{State::Idle};
+    std::atomic<bool> capturing_{false};        // Armed or Triggered (producer fast path)
+    std::atomic<bool> trigger_requested_{false};
+    std::atomic<uint64_t> buffered_seq_{0};     // write_seq_ mirror for the UI
+    std::atomic<uint64_t> trigger_seq_ui_{0};
+    std::atomic<int64_t> frames_ignored_{0};    // Wrong size/type while capturing
+    std::atomic<size_t> ring_bytes_{0};         // slots_ footprint, for other threads
+
+    // Writer thread
+    std::thread thread_;
+    std::mutex worker_mutex_;
+    std::condition_variable worker_cv_;
+    bool flush_requested_ = false;
+    bool export_requested_ = false;
+    std::vector<int> export_params_;
+    bool stopping_ = false;
+    std::atomic<bool> exporting_{false};
+    std::atomic<bool> write_error_{false};
+    mutable std::mutex file_mutex_;
+    std::string last_file_;
+};
+
+} // namespace video
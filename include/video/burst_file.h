@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace video {
+namespace burst_file {
+
+/**
+ * Burst capture container format (.rtbf)
+ *
+ * A 32-byte FileHeader followed by frame_count frames, each a 16-byte
+ * FrameRecord and then the frame's BinaryFrame words (height rows of
+ * words_per_row little-endian 64-bit words, LSB = leftmost pixel).
+ *
+ * Frames are stored exactly as BinaryFrame keeps them in memory, so saving
+ * is a straight write and loading a straight read - an HD frame is ~115 KB
+ * and needs no encoding at capture rate.
+ */
+
+constexpr char MAGIC[8] = {'R', 'T', 'C', 'B', 'S', 'T', '0', '1'};
+constexpr uint32_t VERSION = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint16_t width;
+    uint16_t height;
+    uint32_t words_per_row;
+    uint32_t frame_count;
+    uint32_t trigger_index;    // First frame at or after the trigger
+    uint32_t reserved;
+};
+static_assert(sizeof(FileHeader) == 32, "FileHeader must stay 32 bytes");
+
+struct FrameRecord {
+    int64_t timestamp_us;      // Sensor timestamp of the frame
+    uint64_t sequence;         // Frame number since the capture was armed
+};
+static_assert(sizeof(FrameRecord) == 16, "FrameRecord must stay 16 bytes");
+
+inline bool is_valid(const FileHeader& header) {
+    return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+           header.words_per_row == (header.width + 63u) / 64u;
+}
+
+} // namespace burst_file
+} // namespace video
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "video/binary_frame.h"
+
+namespace video {
+
+/**
+ * Dark-frame hot pixel calibration
+ *
+ * With the lens capped, a healthy pixel only fires on leakage and shot
+ * noise; pixels that keep firing are hot. start() arms an integration of
+ * the given sensor time: from the next batch on, every event adds one to a
+ * saturating uint16 counter of its pixel (2 bytes per pixel, no branch on
+ * the count). Once a batch reaches the end of the integration, counting
+ * stops and build_mask() derives the known-hot mask from the distribution
+ * of counts.
+ *
+ * A pixel is hot when its count exceeds all of: the median plus sigma
+ * robust standard deviations (1.4826 * MAD), the median plus sigma Poisson
+ * standard deviations (a dark sensor has MAD 0), and min_rate_hz over the
+ * integration time.
+ *
+ * update() must be called from a single thread (the accumulation thread);
+ * start(), the state getters and build_mask() may be used from any thread.
+ */
+class DarkFrameCalibrator {
+public:
+    struct Result {
+        int64_t duration_us = 0;        // Integrated sensor time
+        uint64_t events = 0;            // Events counted
+        double median_hz = 0.0;         // Median pixel rate
+        double mad_hz = 0.0;            // Median absolute deviation of the rates
+        double threshold_hz = 0.0;      // Rate above which a pixel is hot
+        int hot_pixels = 0;
+        int saturated_pixels = 0;       // Counters at their maximum (rate only known to be above it)
+    };
+
+    DarkFrameCalibrator() = default;
+    ~DarkFrameCalibrator() = default;
+
+    // Non-copyable
+    DarkFrameCalibrator(const DarkFrameCalibrator&) = delete;
+    DarkFrameCalibrator& operator=(const DarkFrameCalibrator&) = delete;
+
+    /**
+     * Set frame geometry and cancel any integration (not while update() runs)
+     * @param width Frame width
+     * @param height Frame height
+     */
+    void configure(int width, int height);
+
+    /**
+     * Start integrating from the next batch on (restarts one in progress)
+     * @param duration_us Sensor time to integrate
+     */
+    void start(int64_t duration_us);
+
+    /**
+     * Stop integrating without a result (applied on the next batch)
+     */
+    void cancel() { state_.store(Idle, std::memory_order_release); }
+
+    /**
+     * Count a batch of events
+     * @param begin First event (frame coordinates)
+     * @param end One past last event
+     */
+    void update(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    bool is_running() const;
+    bool is_done() const { return state_.load(std::memory_order_acquire) == Done; }
+
+    /**
+     * Fraction of the integration time covered so far (0-1)
+     */
+    double get_progress() const;
+
+    /**
+     * Derive the hot pixel mask from a finished integration
+     * @param sigma Standard deviations above the median
+     * @param min_rate_hz Rate a pixel must also exceed
+     * @param mask Output, set = hot pixel
+     * @param result Output
+     * @return false if no integration has finished
+     */
+    bool build_mask(float sigma, float min_rate_hz, BinaryFrame& mask, Result& result) const;
+
+private:
+    enum State : int {
+        Idle,
+        Armed,          // start() called, counting from the next batch
+        Counting,
+        Done            // counts_ final until the next start()
+    };
+
+    int width_ = 0;
+    int height_ = 0;
+    std::atomic<int> state_{Idle};
+    std::atomic<int64_t> duration_us_{0};
+    std::atomic<int64_t> elapsed_us_{0};
+    std::atomic<uint64_t> events_{0};
+
+    // Accumulation thread while Counting, read-only once Done
+    std::vector<uint16_t> counts_;
+    int64_t start_ts_ = 0;
+};
+
+} // namespace video
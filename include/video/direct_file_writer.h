@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace video {
+
+/**
+ * Sequential file writer that bypasses the page cache, with writes in flight
+ *
+ * Recordings and bursts are written once and not read back during the run.
+ * Going through the page cache (fwrite, std::ofstream) costs a copy per
+ * byte and, at hundreds of MB/s, evicts the data the rest of the station
+ * reads. This writer opens the file unbuffered (FILE_FLAG_NO_BUFFERING,
+ * O_DIRECT on Linux) and writes SECTOR-aligned blocks from a small set of
+ * locked, page-aligned buffers (core::LockedMemory): the caller fills one
+ * buffer while up to in_flight - 1 others are being written (overlapped
+ * I/O on Windows; Linux writes synchronously).
+ *
+ * The file is extended ahead of the writes in EXTENT_BYTES steps (or to the
+ * preallocated size), so the filesystem does not grow it on every write;
+ * with the "Perform volume maintenance tasks" right (SeManageVolumePrivilege)
+ * the extent is also marked valid, which keeps NTFS from serializing
+ * writes past the valid data length. close() trims the file to the bytes
+ * actually committed. If the volume refuses unbuffered I/O the file is
+ * written buffered instead, with the same interface.
+ *
+ * Only the last commit may be shorter than a sector multiple (it is padded
+ * on disk and trimmed by close()).
+ *
+ * **Usage:**
+ * ```cpp
+ * writer.open(path, options);
+ * std::memcpy(writer.buffer(), data, n); writer.commit(n);   // Zero-copy producer
+ * writer.append(record, sizeof(record));                    // Or copy in
+ * writer.close();                                           // Trimmed to the committed size
+ * ```
+ */
+class DirectFileWriter {
+public:
+    static constexpr size_t SECTOR = 4096;                  // Covers 512e and 4Kn drives
+    static constexpr uint64_t EXTENT_BYTES = 256ull << 20;  // File grown this far ahead of the writes
+
+    struct Options {
+        size_t buffer_bytes = 4 << 20;      // Per buffer (rounded up to SECTOR)
+        int in_flight = 4;                  // Buffers (one being filled, the rest being written)
+        uint64_t preallocate_bytes = 0;     // Initial file extent (0 = EXTENT_BYTES steps only)
+    };
+
+    DirectFileWriter();
+    ~DirectFileWriter();
+
+    // Non-copyable
+    DirectFileWriter(const DirectFileWriter&) = delete;
+    DirectFileWriter& operator=(const DirectFileWriter&) = delete;
+
+    /**
+     * Create (truncate) a file
+     * @return false if it cannot be created
+     */
+    bool open(const std::string& path, const Options& options);
+
+    bool is_open() const;
+
+    /**
+     * The buffer being filled (buffer_bytes, SECTOR-aligned; changes after commit())
+     */
+    uint8_t* buffer() { return buffers_[current_]; }
+    size_t buffer_bytes() const { return buffer_bytes_; }
+
+    /**
+     * Write the first `bytes` of buffer() and move to the next free buffer
+     * (waits for the oldest write if all are in flight)
+     * @return false on a write error (later commits fail too)
+     */
+    bool commit(size_t bytes);
+
+    /**
+     * Copy data in, committing each buffer as it fills
+     */
+    bool append(const void* data, size_t bytes);
+
+    /**
+     * Commit what append() left, wait for every write, trim and close
+     * @return false if any write failed
+     */
+    bool close();
+
+    uint64_t get_committed() const { return committed_; }
+    bool is_unbuffered() const { return unbuffered_; }
+    bool has_error() const { return error_; }
+
+private:
+    struct Request;   // One write in flight (platform part in the .cpp)
+
+    bool wait(Request& request);
+    bool reserve(uint64_t end);
+    void release_buffers();
+
+    std::string path_;
+    intptr_t handle_ = -1;              // HANDLE / file descriptor
+    bool unbuffered_ = false;
+    size_t buffer_bytes_ = 0;
+    std::vector<void*> blocks_;          // From LockedMemory
+    std::vector<uint8_t*> buffers_;     // blocks_ aligned to SECTOR
+    std::vector<std::unique_ptr<Request>> requests_;
+    size_t current_ = 0;
+    size_t fill_ = 0;                   // Bytes of buffer() filled by append()
+    uint64_t offset_ = 0;               // Next write position (sector-aligned)
+    uint64_t committed_ = 0;            // Logical file size
+    uint64_t extent_ = 0;               // File size reserved so far
+    bool valid_data_ = false;           // Extents may be marked valid (Windows)
+    bool tail_written_ = false;         // A short last block went out
+    bool error_ = false;
+};
+
+} // namespace video
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace video {
+
+/**
+ * Per-row and per-column event counts of one accumulation window
+ *
+ * Counts are split by polarity (OFF = p 0, ON = p 1). Index y of the row
+ * vectors is frame row y (sensor row origin_y + y), index x of the column
+ * vectors is frame column x (sensor column origin_x + x).
+ */
+struct ActivitySnapshot {
+    int width = 0;
+    int height = 0;
+    int origin_x = 0;              // Sensor column of frame column 0 (non-zero with an ROI)
+    int origin_y = 0;              // Sensor row of frame row 0
+    int64_t window_end_ts = 0;     // Sensor time closing the window (us)
+    uint64_t window_index = 0;     // Windows completed since configure(), 0 = none yet
+    uint64_t on_events = 0;
+    uint64_t off_events = 0;
+    std::vector<uint32_t> row_on;
+    std::vector<uint32_t> row_off;
+    std::vector<uint32_t> col_on;
+    std::vector<uint32_t> col_off;
+
+    /**
+     * Lines that stand out from the rest of the projection
+     */
+    struct LineStats {
+        double mean = 0.0;   // Events per line (ON + OFF)
+        int silent = 0;      // Lines with no events while the mean is high enough to expect some
+        int hot = 0;         // Lines with more than hot_factor times the mean
+        int first_silent = -1;
+        int first_hot = -1;
+    };
+
+    /**
+     * Find silent and hot lines in one projection
+     * @param on ON counts per line
+     * @param off OFF counts per line
+     * @param hot_factor Multiple of the mean that marks a line as hot
+     * @param min_mean Mean below which empty lines are not reported (sparse scenes)
+     */
+    static LineStats line_stats(const std::vector<uint32_t>& on, const std::vector<uint32_t>& off,
+                                double hot_factor = 8.0, double min_mean = 4.0);
+};
+
+/**
+ * Row/column activity profile of the CD stream
+ *
+ * Counts every event into fixed per-row and per-column ON/OFF arrays and
+ * publishes them once per accumulation window, so a dead or stuck readout
+ * line shows up in the projections without saving frames.
+ *
+ * Windows are aligned to multiples of the accumulation time, like the frame
+ * generators, so each published profile matches one displayed frame.
+ *
+ * **PERFORMANCE:** Each batch is split at window boundaries first, so the
+ * per-event loop is two branch-free increments (polarity selects the slot
+ * of an interleaved array, no per-event compare). Publishing copies only
+ * width + height entries per polarity.
+ *
+ * process() must be called from a single thread (the accumulation thread);
+ * get_snapshot() may be called from any thread.
+ */
+class EventActivityProfile {
+public:
+    static constexpr int MAX_DIMENSION = 2048;  // Largest supported sensor width or height
+
+    EventActivityProfile() = default;
+    ~EventActivityProfile() = default;
+
+    // Non-copyable
+    EventActivityProfile(const EventActivityProfile&) = delete;
+    EventActivityProfile& operator=(const EventActivityProfile&) = delete;
+
+    /**
+     * Set sensor geometry and window length (not while process() runs)
+     * @param width Frame width (at most MAX_DIMENSION)
+     * @param height Frame height (at most MAX_DIMENSION)
+     * @param accumulation_time_us Window length in microseconds
+     * @param origin_x Sensor column of frame column 0 (ROI offset, reported in snapshots only)
+     * @param origin_y Sensor row of frame row 0
+     * @return false if the sensor is larger than MAX_DIMENSION (profiling stays off)
+     */
+    bool configure(int width, int height, uint32_t accumulation_time_us, int origin_x = 0, int origin_y = 0);
+
+    /**
+     * Count a batch, publishing every window it completes
+     * @param begin First event
+     * @param end One past last event
+     */
+    void process(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Enable or disable counting (takes effect on the next batch)
+     */
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Copy the last completed window
+     * @param snapshot Output (vectors keep their capacity between calls)
+     * @return false if no window has completed yet
+     */
+    bool get_snapshot(ActivitySnapshot& snapshot) const;
+
+private:
+    /**
+     * Publish the window in progress and clear the counters
+     */
+    void publish(int64_t window_end_ts);
+
+    int width_ = 0;
+    int height_ = 0;
+    int64_t accumulation_time_us_ = 0;
+    std::atomic<bool> enabled_{true};
+
+    // Accumulation thread only; interleaved [line * 2 + polarity]
+    std::array<uint32_t, 2 * MAX_DIMENSION> rows_{};
+    std::array<uint32_t, 2 * MAX_DIMENSION> cols_{};
+    int64_t window_end_ts_ = -1;  // -1 = not aligned yet
+
+    // Last completed window
+    mutable std::mutex mutex_;
+    ActivitySnapshot published_;
+};
+
+} // namespace video
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "video/event_file.h"
+
+namespace video {
+
+/**
+ * Read-only, memory-mapped view of an event_file recording
+ *
+ * The whole file is mapped once; nothing is read until a range is decoded,
+ * so opening a multi-GB archive is instant and the OS pages in only the
+ * chunks that are actually touched.
+ *
+ * With a version 2 chunk index, seek() finds the chunk holding a timestamp
+ * by binary search and read_range() decodes only the chunks overlapping the
+ * requested window. Version 1 files fall back to decoding from the start.
+ * Version 3 (compressed) chunks are decoded one at a time into the cursor;
+ * without an intact index their headers are walked once on open instead.
+ *
+ * Timestamps are assumed non-decreasing, as delivered by the sensor.
+ *
+ * **Usage:**
+ * ```cpp
+ * EventArchive archive;
+ * archive.open("session.rtev");
+ * archive.read_range(t, t + 1000, events);   // One 1 ms frame window
+ *
+ * EventArchive::Cursor cursor;                 // Or stream from a timestamp
+ * archive.seek(t, cursor);
+ * while (archive.next(cursor, ev)) { ... }
+ * ```
+ */
+class EventArchive {
+public:
+    /**
+     * Read position for next() (one per reading thread)
+     */
+    struct Cursor {
+        size_t position = 0;                       // Next word (v1/v2) or chunk (v3)
+        int64_t time_base = 0;
+        std::vector<Metavision::EventCD> chunk;    // Decoded chunk (v3)
+        size_t chunk_pos = 0;
+        std::vector<uint8_t> scratch;
+    };
+
+    EventArchive() = default;
+    ~EventArchive();
+
+    // Non-copyable
+    EventArchive(const EventArchive&) = delete;
+    EventArchive& operator=(const EventArchive&) = delete;
+
+    /**
+     * Map a recording and locate its event words and index
+     * @param path Recording written by EventRecorder
+     * @return true if the file is a valid recording
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Unmap the file
+     */
+    void close();
+
+    bool is_open() const { return base_ != nullptr; }
+    const event_file::FileHeader& header() const { return header_; }
+    int width() const { return header_.width; }
+    int height() const { return header_.height; }
+    uint64_t event_count() const { return header_.event_count; }  // 0 if not closed cleanly
+    bool has_index() const { return index_count_ > 0; }
+    bool is_compressed() const { return event_file::is_compressed(header_); }
+    size_t chunk_count() const { return index_count_; }
+
+    /**
+     * First and last event timestamps (us)
+     */
+    int64_t start_timestamp() const { return header_.start_timestamp; }
+    int64_t end_timestamp() const { return end_timestamp_; }
+
+    /**
+     * Raw event words (time base and event words, see event_file.h; empty for version 3)
+     */
+    const uint64_t* words() const { return data_; }
+    size_t word_count() const { return data_words_; }
+
+    /**
+     * Find where to start decoding so that no event at or after timestamp is missed
+     * @param timestamp Target time (us)
+     * @param time_base Output time base in effect at the returned offset
+     * @return Word offset into words() (O(log n) with an index)
+     */
+    size_t seek(int64_t timestamp, int64_t& time_base) const;
+
+    /**
+     * Position a cursor so that no event at or after timestamp is missed
+     */
+    void seek(int64_t timestamp, Cursor& cursor) const;
+
+    /**
+     * Decode the next event
+     * @return false at the end of the recording
+     */
+    bool next(Cursor& cursor, Metavision::EventCD& ev) const;
+
+    /**
+     * Chunk holding the first event at or after timestamp (needs an index)
+     */
+    size_t find_chunk(int64_t timestamp) const;
+
+    /**
+     * Decode one whole chunk of an indexed recording (thread-safe; chunks
+     * are independent, so several can be decoded in parallel)
+     * @param events Output (cleared first; keeps its capacity)
+     * @param scratch Per-thread work buffer
+     * @return false if the chunk is corrupt or cannot be decoded by this build
+     */
+    bool decode_chunk(size_t chunk, std::vector<Metavision::EventCD>& events, std::vector<uint8_t>& scratch) const;
+
+    /**
+     * Decode events with t_begin <= t < t_end
+     * @param t_begin Window start (us, inclusive)
+     * @param t_end Window end (us, exclusive)
+     * @param events Output (cleared first; keeps its capacity between calls)
+     * @return Number of events decoded
+     */
+    size_t read_range(int64_t t_begin, int64_t t_end, std::vector<Metavision::EventCD>& events) const;
+
+private:
+    bool map_file(const std::string& path);
+    int64_t find_end_timestamp() const;
+    void scan_chunks(size_t end);
+    bool chunk_header(size_t chunk, event_file::ChunkHeader& header) const;
+
+    // Mapping
+    const uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#endif
+
+    event_file::FileHeader header_{};
+    const uint64_t* data_ = nullptr;
+    size_t data_words_ = 0;
+    const event_file::IndexEntry* index_ = nullptr;
+    size_t index_count_ = 0;
+    size_t chunk_bytes_ = 0;                            // v3: bytes of chunks after the FileHeader
+    std::vector<event_file::IndexEntry> scanned_index_; // v3 without an intact index
+    int64_t end_timestamp_ = 0;
+};
+
+} // namespace video
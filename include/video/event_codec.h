@@ -0,0 +1,60 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "video/event_file.h"
+
+namespace video {
+namespace event_codec {
+
+/**
+ * Compressed event chunks for event_file version 3
+ *
+ * Each event is two LEB128 varints:
+ *
+ *   zigzag(t - previous t)
+ *   zigzag(y - previous y) << 15 | x << 1 | p
+ *
+ * (previous t starts at the chunk's first timestamp, previous y at 0).
+ * At sensor rates most time deltas are 0 or 1 us and consecutive events
+ * tend to share a row, so a typical event takes 3-4 bytes against 16 for
+ * EventCD and 8 for a version 2 word. When built with RTCAM_LZ4 the varint
+ * stream is additionally LZ4-compressed if that makes it smaller.
+ *
+ * Chunks are independent, so any number of threads can encode or decode
+ * them in parallel (EventRecorder uses a small pool of its own).
+ */
+
+constexpr size_t MAX_EVENT_BYTES = 10 + 5;   // Worst-case varints per event
+
+/**
+ * True if this build can write and read LZ4 payloads
+ */
+bool has_lz4();
+
+/**
+ * Encode events into a chunk
+ * @param begin, end Events (at most event_file::CHUNK_EVENTS)
+ * @param lz4 Try LZ4 on top of the varints (ignored without RTCAM_LZ4)
+ * @param header Output chunk header (magic, counts, timestamps)
+ * @param payload Output bytes following the header (keeps its capacity)
+ * @param scratch Varint buffer when LZ4 is used (keeps its capacity)
+ */
+void encode_chunk(const Metavision::EventCD* begin, const Metavision::EventCD* end, bool lz4,
+                  event_file::ChunkHeader& header, std::vector<uint8_t>& payload, std::vector<uint8_t>& scratch);
+
+/**
+ * Decode a chunk
+ * @param header Chunk header
+ * @param payload header.payload_bytes bytes following it
+ * @param events Output (cleared first; keeps its capacity)
+ * @param scratch Decompressed varints for LZ4 chunks (keeps its capacity)
+ * @return false if the payload is corrupt or LZ4 is not available
+ */
+bool decode_chunk(const event_file::ChunkHeader& header, const uint8_t* payload,
+                  std::vector<Metavision::EventCD>& events, std::vector<uint8_t>& scratch);
+
+} // namespace event_codec
+} // namespace video
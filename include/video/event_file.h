@@ -0,0 +1,139 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <cstdint>
+#include <cstring>
+
+namespace video {
+namespace event_file {
+
+/**
+ * Compact raw event file format (.rtev)
+ *
+ * A 32-byte FileHeader followed by little-endian 64-bit words:
+ *
+ *   bit 63     = 0: CD event
+ *     bit 62      polarity
+ *     bits 61..48 y
+ *     bits 47..34 x
+ *     bits 33..0  timestamp offset from the current time base (us)
+ *
+ *   bit 63     = 1: time base
+ *     bits 62..0  absolute timestamp (us) later offsets are relative to
+ *
+ * Events take 8 bytes instead of sizeof(EventCD) = 16.
+ *
+ * Version 2 splits the event words into chunks of CHUNK_WORDS. Every chunk
+ * starts with a time base word, so decoding can begin at any chunk. After
+ * the last event word the file holds one IndexEntry per chunk followed by
+ * a FileTrailer, giving readers an O(log n) timestamp -> offset lookup.
+ * Version 1 files (no chunks, no index) can only be read sequentially.
+ *
+ * Version 3 stores compressed chunks of up to CHUNK_EVENTS events instead
+ * of words (see event_codec.h): each chunk is a ChunkHeader followed by its
+ * payload, so chunks encode and decode independently and the file can be
+ * re-indexed by walking the headers if the recording was not closed
+ * cleanly. IndexEntry::offset is then a byte offset.
+ */
+
+constexpr char MAGIC[8] = {'R', 'T', 'C', 'E', 'V', 'T', '0', '1'};
+constexpr char INDEX_MAGIC[8] = {'R', 'T', 'C', 'I', 'D', 'X', '0', '1'};
+constexpr char CHUNK_MAGIC[4] = {'R', 'T', 'C', 'K'};
+constexpr uint32_t VERSION = 3;
+constexpr uint32_t MIN_VERSION = 1;
+constexpr uint32_t VERSION_WORDS = 2;        // Last version made of event words
+constexpr size_t CHUNK_WORDS = 65536;  // 512 KiB of events per index entry
+constexpr size_t CHUNK_EVENTS = 65536; // Events per compressed chunk (version 3)
+constexpr uint32_t CHUNK_LZ4 = 1;      // Payload is LZ4 over the varint stream
+constexpr int OFFSET_BITS = 34;
+constexpr uint64_t OFFSET_MASK = (uint64_t(1) << OFFSET_BITS) - 1;
+constexpr uint64_t TIME_BASE_FLAG = uint64_t(1) << 63;
+constexpr size_t WORD_SIZE = sizeof(uint64_t);
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint16_t width;
+    uint16_t height;
+    int64_t start_timestamp;   // First time base (us)
+    uint64_t event_count;      // 0 if the recording was not closed cleanly
+};
+static_assert(sizeof(FileHeader) == 32, "FileHeader must stay 32 bytes");
+
+struct IndexEntry {
+    int64_t first_timestamp;   // Timestamp of the first event in the chunk
+    uint64_t offset;           // Chunk start after the FileHeader: words (v2) or bytes (v3)
+};
+static_assert(sizeof(IndexEntry) == 16, "IndexEntry must stay 16 bytes");
+
+struct ChunkHeader {
+    char magic[4];             // CHUNK_MAGIC
+    uint32_t flags;            // CHUNK_LZ4
+    uint32_t event_count;
+    uint32_t payload_bytes;    // Stored bytes following this header
+    uint32_t encoded_bytes;    // Varint stream size (= payload_bytes without LZ4)
+    uint32_t reserved;
+    int64_t first_timestamp;
+    int64_t last_timestamp;
+};
+static_assert(sizeof(ChunkHeader) == 40, "ChunkHeader must stay 40 bytes");
+
+struct FileTrailer {
+    char magic[8];             // INDEX_MAGIC
+    uint64_t index_offset;     // Byte offset of the first IndexEntry
+    uint64_t entry_count;
+};
+static_assert(sizeof(FileTrailer) == 24, "FileTrailer must stay 24 bytes");
+
+/**
+ * Check a header read from disk
+ */
+inline bool is_valid(const FileHeader& header) {
+    return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+           header.version >= MIN_VERSION && header.version <= VERSION;
+}
+
+inline bool is_valid(const FileTrailer& trailer) {
+    return std::memcmp(trailer.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0;
+}
+
+inline bool is_valid(const ChunkHeader& chunk) {
+    return std::memcmp(chunk.magic, CHUNK_MAGIC, sizeof(CHUNK_MAGIC)) == 0 &&
+           chunk.event_count <= CHUNK_EVENTS;
+}
+
+inline bool is_compressed(const FileHeader& header) {
+    return header.version > VERSION_WORDS;
+}
+
+inline uint64_t encode_time_base(int64_t timestamp) {
+    return TIME_BASE_FLAG | (static_cast<uint64_t>(timestamp) & ~TIME_BASE_FLAG);
+}
+
+/**
+ * Encode an event (caller guarantees 0 <= ev.t - time_base <= OFFSET_MASK)
+ */
+inline uint64_t encode_event(const Metavision::EventCD& ev, int64_t time_base) {
+    return (static_cast<uint64_t>(ev.p != 0) << 62) |
+           (static_cast<uint64_t>(ev.y & 0x3FFF) << 48) |
+           (static_cast<uint64_t>(ev.x & 0x3FFF) << OFFSET_BITS) |
+           (static_cast<uint64_t>(ev.t - time_base) & OFFSET_MASK);
+}
+
+inline bool is_time_base(uint64_t word) {
+    return (word & TIME_BASE_FLAG) != 0;
+}
+
+inline int64_t decode_time_base(uint64_t word) {
+    return static_cast<int64_t>(word & ~TIME_BASE_FLAG);
+}
+
+inline Metavision::EventCD decode_event(uint64_t word, int64_t time_base) {
+    return Metavision::EventCD(static_cast<unsigned short>((word >> OFFSET_BITS) & 0x3FFF),
+                               static_cast<unsigned short>((word >> 48) & 0x3FFF),
+                               static_cast<short>((word >> 62) & 1),
+                               time_base + static_cast<int64_t>(word & OFFSET_MASK));
+}
+
+} // namespace event_file
+} // namespace video
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <opencv2/core.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace video {
+
+/**
+ * Log-binned inter-event intervals, one histogram per pixel class
+ */
+struct IntervalHistograms {
+    static constexpr int CLASSES = 4;   // See EventIntervalHistogram::PixelClass
+    static constexpr int BINS = 24;     // Bin 0 = 0 us, bin b = [2^(b-1), 2^b) us, last bin = the rest (>= ~4.2 s)
+
+    std::array<std::array<uint64_t, BINS>, CLASSES> counts{};
+    std::array<uint64_t, CLASSES> first_events{};   // Events with no earlier one at their pixel
+    int64_t latest_ts = -1;                          // Sensor time of the last counted event
+
+    /**
+     * Lower edge of a bin in microseconds
+     */
+    static int64_t bin_min_us(int bin) { return bin == 0 ? 0 : int64_t(1) << (bin - 1); }
+
+    /**
+     * Interval below which a share of a class's intervals falls (bin resolution)
+     * @param pixel_class Class index
+     * @param fraction Share (0-1), e.g. 0.5 for the median
+     * @return Upper edge of the bin reaching the share in microseconds (-1 = no intervals)
+     */
+    int64_t quantile_us(int pixel_class, double fraction) const;
+};
+
+/**
+ * Online inter-event interval histograms for refractory tuning
+ *
+ * Keeps the last timestamp of every pixel (32-bit, the low bits of sensor
+ * time) and counts the interval to the previous event at the same pixel
+ * into IntervalHistograms::BINS log2 bins, aggregated per pixel class:
+ * dot (signal) pixels, background (noise) pixels and hot pixels, from
+ * set_class_masks() and set_hot_pixels(); everything else is Unclassified.
+ * The refractory bias shows up as the shortest interval a pixel can
+ * produce, so the low edge of each class's histogram moves with bias_refr.
+ *
+ * **PERFORMANCE:** per event one class-map read, one stamp read/write and
+ * one counter increment; the bin comes from a bit scan and never-seen
+ * pixels go to a discard bin, so the loop has no data-dependent branch.
+ * Counts are published once per batch.
+ *
+ * update() must be called from a single thread (the accumulation thread);
+ * class updates, snapshots and settings may be used from any thread.
+ */
+class EventIntervalHistogram {
+public:
+    enum PixelClass : uint8_t {
+        Unclassified = 0,
+        Signal = 1,
+        Noise = 2,
+        Hot = 3
+    };
+
+    static const char* class_name(int pixel_class);
+
+    EventIntervalHistogram() = default;
+    ~EventIntervalHistogram() = default;
+
+    // Non-copyable
+    EventIntervalHistogram(const EventIntervalHistogram&) = delete;
+    EventIntervalHistogram& operator=(const EventIntervalHistogram&) = delete;
+
+    /**
+     * Set frame geometry and clear stamps, counts and classes (not while update() runs)
+     * @param width Frame width
+     * @param height Frame height
+     */
+    void configure(int width, int height);
+
+    /**
+     * Count the intervals of a batch of events
+     * @param begin First event (frame coordinates)
+     * @param end One past last event
+     */
+    void update(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Enable or disable counting (takes effect on the next batch; stamps restart when re-enabled)
+     */
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Classify pixels from the noise analysis masks (applied on the next batch)
+     *
+     * Masks of another size are ignored. Hot pixels stay Hot.
+     * @param signal_mask CV_8UC1, non-zero = dot pixel
+     * @param noise_mask CV_8UC1, non-zero = background pixel
+     * @return false if either mask is not CV_8UC1 of the frame size
+     */
+    bool set_class_masks(const cv::Mat& signal_mask, const cv::Mat& noise_mask);
+
+    /**
+     * Mark pixels as Hot, over any mask class (applied on the next batch)
+     * @param pixels Frame coordinates (outside the frame are skipped)
+     */
+    void set_hot_pixels(const std::vector<cv::Point>& pixels);
+
+    /**
+     * Zero the counts (applied on the next batch), e.g. after a bias change
+     */
+    void reset_counts() { reset_requested_ = true; }
+
+    /**
+     * Copy the counts published after the last batch
+     */
+    void get_histograms(IntervalHistograms& out) const;
+
+    /**
+     * Pixels in each class of the map in use (index = PixelClass)
+     */
+    std::array<int, IntervalHistograms::CLASSES> get_class_pixels() const;
+
+private:
+    /**
+     * Rebuild the combined map from the masks and hot list, for the next batch (classes_mutex_ held)
+     */
+    void publish_classes();
+
+    int width_ = 0;
+    int height_ = 0;
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> reset_requested_{false};
+
+    // Class map hand-off, guarded by classes_mutex_
+    mutable std::mutex classes_mutex_;
+    std::vector<uint8_t> mask_classes_;    // From set_class_masks (empty = all Unclassified)
+    std::vector<int32_t> hot_keys_;        // From set_hot_pixels
+    std::vector<uint8_t> next_classes_;
+    std::array<int, IntervalHistograms::CLASSES> class_pixels_{};
+    std::atomic<bool> classes_changed_{false};
+
+    // Accumulation thread only
+    bool running_ = false;                 // Stamps valid (false after being disabled)
+    std::vector<uint32_t> stamps_;         // Low 32 bits of the last event time + 1 (0 = none yet)
+    std::vector<uint8_t> classes_;         // Per pixel class
+    // Counts per class; the extra last bin takes first events, which have no interval
+    std::array<std::array<uint64_t, IntervalHistograms::BINS + 1>, IntervalHistograms::CLASSES> working_{};
+    int64_t latest_ts_ = -1;
+
+    mutable std::mutex counts_mutex_;
+    IntervalHistograms published_;
+};
+
+} // namespace video
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace video {
+
+/**
+ * Software background-activity filter for CD events
+ *
+ * Keeps an event only if one of its 8 neighbours fired within the last
+ * threshold_us (nearest neighbour in time). Isolated noise events, which
+ * have no spatial support, are removed; edges and blobs pass. A pixel
+ * firing on its own never supports itself, so hot pixels are removed too.
+ * Unlike the sensor's trail filter this works on any recording, so the
+ * same replay can be compared with and without it.
+ *
+ * State is one uint32 per pixel: the time of its last event relative to a
+ * base timestamp (+1, 0 = never), in a flat row-major map with a border of
+ * never-firing pixels, so edge pixels need no bounds checks. The base is
+ * moved forward every ~35 minutes so relative times never wrap.
+ *
+ * **PERFORMANCE:** Per event: one store, eight neighbour compares and a
+ * branch-free compaction of the output; ~100 Mev/s on one core at
+ * 1280x720 (3.7 MB map, cache-resident). The neighbourhood check also
+ * exists as one AVX2 gather and as three unaligned SSE4.1 row loads, but
+ * the 8 neighbours sit in 3 cache lines and the scalar compares measured
+ * as fast or faster, so Auto picks scalar unless set_auto_path() names the
+ * path a startup benchmark found fastest on this machine (BackendTuner).
+ * All paths give identical output.
+ *
+ * filter() must be called from a single thread (the accumulation thread);
+ * the settings and counters may be used from any thread.
+ */
+class EventNoiseFilter {
+public:
+    enum class Path {
+        Auto,       // Fastest measured (set_auto_path(), scalar by default)
+        Scalar,
+        SSE41,
+        AVX2
+    };
+
+    EventNoiseFilter() = default;
+    ~EventNoiseFilter() = default;
+
+    // Non-copyable
+    EventNoiseFilter(const EventNoiseFilter&) = delete;
+    EventNoiseFilter& operator=(const EventNoiseFilter&) = delete;
+
+    /**
+     * Set frame geometry and clear the timestamp map (not while filter() runs)
+     * @param width Frame width
+     * @param height Frame height
+     * @param path Neighbourhood check to use (unsupported paths fall back)
+     * @return false if the size is invalid (everything passes)
+     */
+    bool configure(int width, int height, Path path = Path::Auto);
+
+    /**
+     * Filter a batch
+     * @param begin First event (frame coordinates)
+     * @param end One past last event
+     * @param out Kept events; may be begin for in-place filtering
+     * @return Number of events written to out
+     */
+    size_t filter(const Metavision::EventCD* begin, const Metavision::EventCD* end, Metavision::EventCD* out);
+
+    /**
+     * Enable or disable filtering (takes effect on the next batch)
+     */
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Support window: a neighbour event at most this long ago keeps an event
+     */
+    void set_threshold_us(uint32_t threshold_us) { threshold_us_ = threshold_us; }
+    uint32_t get_threshold_us() const { return threshold_us_.load(std::memory_order_relaxed); }
+
+    Path get_path() const { return path_; }
+    static const char* path_name(Path path);
+
+    /**
+     * Path that Auto resolves to in later configure() calls (Auto = scalar)
+     */
+    static void set_auto_path(Path path) { auto_path_ = path; }
+    static Path get_auto_path() { return auto_path_.load(std::memory_order_relaxed); }
+
+    /**
+     * Events seen / kept since configure() (while enabled)
+     */
+    uint64_t get_input_events() const { return input_events_.load(std::memory_order_relaxed); }
+    uint64_t get_passed_events() const { return passed_events_.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * Move the time base to keep relative times far from wrapping
+     */
+    void rebase(int64_t ts);
+
+    int width_ = 0;
+    int height_ = 0;
+    int stride_ = 0;                    // width + a border column each side + 1 spare for 4-wide row loads
+    Path path_ = Path::Scalar;
+    static std::atomic<Path> auto_path_;
+    std::atomic<bool> enabled_{false};
+    std::atomic<uint32_t> threshold_us_{2000};
+
+    // Filter thread only
+    std::vector<uint32_t> last_;        // (height + 2) * stride_, relative time + 1 (0 = never)
+    int64_t base_ts_ = -1;              // -1 = not set yet
+
+    std::atomic<uint64_t> input_events_{0};
+    std::atomic<uint64_t> passed_events_{0};
+};
+
+} // namespace video
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include "video/binary_frame.h"
+
+namespace video {
+
+/**
+ * Software hot pixel suppression at ingestion
+ *
+ * Drops the events of masked pixels (a calibrated hot pixel mask, or the
+ * part of it the sensor's digital event mask had no room for) before the
+ * noise filter, statistics and frame builder see them. The mask is kept
+ * as a BinaryFrame, so the test is one word load and one bit test per
+ * event: a 1280x720 mask is 115 KB and stays in L2.
+ *
+ * **PERFORMANCE:** Per event: a word load, a shift and a branch-free
+ * compaction of the output, as in EventNoiseFilter. With no pixel masked
+ * is_active() is false and the pipeline skips the pass entirely.
+ *
+ * filter() must be called from a single thread (the accumulation thread);
+ * set_mask(), the settings and counters may be used from any thread.
+ */
+class EventPixelMask {
+public:
+    EventPixelMask() = default;
+    ~EventPixelMask() = default;
+
+    // Non-copyable
+    EventPixelMask(const EventPixelMask&) = delete;
+    EventPixelMask& operator=(const EventPixelMask&) = delete;
+
+    /**
+     * Set frame geometry and unmask every pixel (not while filter() runs)
+     * @param width Frame width
+     * @param height Frame height
+     */
+    void configure(int width, int height);
+
+    /**
+     * Replace the masked pixels (applied on the next batch)
+     * @param mask Set = drop the pixel's events; another size than configured (or empty) masks nothing
+     */
+    void set_mask(const BinaryFrame& mask);
+
+    /**
+     * Filter a batch
+     * @param begin First event (frame coordinates)
+     * @param end One past last event
+     * @param out Kept events; may be begin for in-place filtering
+     * @return Number of events written to out
+     */
+    size_t filter(const Metavision::EventCD* begin, const Metavision::EventCD* end, Metavision::EventCD* out);
+
+    /**
+     * Enable or disable suppression (takes effect on the next batch)
+     */
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Enabled with at least one pixel masked (or a new mask pending), i.e. filter() is worth calling
+     */
+    bool is_active() const {
+        return is_enabled() && (masked_pixels_.load(std::memory_order_relaxed) > 0 ||
+                                mask_changed_.load(std::memory_order_acquire));
+    }
+
+    /**
+     * Pixels masked in the applied mask
+     */
+    int get_masked_pixels() const { return masked_pixels_.load(std::memory_order_relaxed); }
+
+    /**
+     * Events dropped since configure()
+     */
+    uint64_t get_suppressed() const { return suppressed_.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * Take over a pending set_mask() (filter thread)
+     */
+    void apply_pending();
+
+    int width_ = 0;
+    int height_ = 0;
+    std::atomic<bool> enabled_{false};
+
+    // Filter thread only
+    BinaryFrame mask_;
+
+    // Handed over from set_mask()
+    std::mutex pending_mutex_;
+    BinaryFrame pending_;
+    std::atomic<bool> mask_changed_{false};
+
+    std::atomic<int> masked_pixels_{0};
+    std::atomic<uint64_t> suppressed_{0};
+};
+
+} // namespace video
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "video/direct_file_writer.h"
+#include "video/event_file.h"
+#include "video/event_ring.h"
+#include "video/thread_pool.h"
+
+namespace video {
+
+/**
+ * Streams raw CD events to disk on a dedicated writer thread
+ *
+ * The SDK decoding thread only copies each batch into a preallocated
+ * EventRing slot (same hand-off as frame building); encoding to the compact
+ * event_file format and all disk I/O happen on the writer thread. A full
+ * ring drops and counts the batch instead of stalling decoding.
+ *
+ * Every event_file::CHUNK_WORDS words a chunk with its own time base is
+ * started and indexed; the index is appended when the recording stops.
+ *
+ * With compressor threads (version 3 files) the writer thread only gathers
+ * event_file::CHUNK_EVENTS events per chunk and posts it to a small pool of
+ * its own; chunks are varint-coded (and LZ4-compressed, see event_codec.h)
+ * in parallel and written in order as they complete. At most
+ * MAX_CHUNKS_PER_THREAD chunks per thread are in flight, so a disk or CPU
+ * that cannot keep up backs up into the ring (dropped and counted) rather
+ * than into unbounded memory.
+ *
+ * **PERFORMANCE:** Events are encoded straight into the 4 MiB buffers of a
+ * DirectFileWriter, which writes them past the page cache with several
+ * blocks in flight, so encoding overlaps the disk and a long recording does
+ * not push everything else out of memory. Optional preallocation reserves
+ * the file size up front so the filesystem does not extend it on every
+ * write. The small index, trailer and final header go through the cache
+ * once the data is closed.
+ *
+ * **Usage:**
+ * ```cpp
+ * recorder.start("session.rtev", 1280, 720);
+ * recorder.push(begin, end);   // decode thread
+ * recorder.stop();             // flushes and closes
+ * ```
+ */
+class EventRecorder {
+public:
+    static constexpr size_t BLOCK_BYTES = 4 << 20;
+    static constexpr int BLOCKS_IN_FLIGHT = 4;
+    static constexpr size_t MAX_CHUNKS_PER_THREAD = 3;
+
+    /**
+     * Create recorder (the ring is allocated up front, the file on start())
+     * @param ring_capacity Number of batch slots between decode and writer thread
+     * @param reserve_events Events preallocated per slot (slots grow to the
+     *                       SDK batch size after warm-up)
+     */
+    explicit EventRecorder(size_t ring_capacity = 256, size_t reserve_events = 4096);
+    ~EventRecorder();
+
+    // Non-copyable
+    EventRecorder(const EventRecorder&) = delete;
+    EventRecorder& operator=(const EventRecorder&) = delete;
+
+    /**
+     * Open a file and start the writer thread
+     * @param path Output file path
+     * @param width Sensor width (stored in the header)
+     * @param height Sensor height (stored in the header)
+     * @param preallocate_bytes File size to reserve up front (0 = none)
+     * @param compress_threads Compressor threads (0 = uncompressed version 2 words)
+     * @return true if recording started
+     */
+    bool start(const std::string& path, int width, int height, uint64_t preallocate_bytes = 0,
+               int compress_threads = 0);
+
+    /**
+     * Stop accepting events, flush everything queued and close the file
+     */
+    void stop();
+
+    /**
+     * Hand a batch to the writer thread (decode thread, never blocks)
+     *
+     * No-op while not recording.
+     */
+    void push(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+        if (recording_.load(std::memory_order_acquire)) {
+            ring_.try_push(begin, end);
+        }
+    }
+
+    bool is_recording() const { return recording_.load(std::memory_order_acquire); }
+    const std::string& get_path() const { return path_; }
+
+    // Statistics (for the current / last recording)
+    uint64_t get_events_written() const { return events_written_.load(std::memory_order_relaxed); }
+    uint64_t get_bytes_written() const { return bytes_written_.load(std::memory_order_relaxed); }
+    int64_t get_dropped_batches() const { return ring_.get_dropped_batches() - dropped_batches_base_; }
+    int64_t get_dropped_events() const { return ring_.get_dropped_events() - dropped_events_base_; }
+    bool has_write_error() const { return write_error_.load(std::memory_order_relaxed); }
+    bool is_compressed() const { return compress_threads_ > 0; }
+
+private:
+    struct ChunkJob {
+        std::vector<Metavision::EventCD> events;
+        event_file::ChunkHeader header{};
+        std::vector<uint8_t> payload;
+        std::vector<uint8_t> scratch;
+        bool done = false;                 // Guarded by jobs_mutex_
+    };
+
+    void writer_loop();
+    void encode(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+    void put_word(uint64_t word);
+    void flush_block();
+    void finish_file();
+    void gather(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+    void submit_chunk();
+    void write_chunks(size_t max_pending);
+
+    EventRing ring_;
+    std::thread thread_;
+    std::atomic<bool> recording_{false};   // Decode thread may push
+    std::atomic<bool> running_{false};     // Writer thread alive
+
+    // Writer thread only while running
+    DirectFileWriter writer_;
+    uint64_t* block_ = nullptr;            // writer_.buffer()
+    size_t block_fill_ = 0;                // Words in block_
+    event_file::FileHeader header_{};
+    int64_t time_base_ = 0;
+    bool has_time_base_ = false;
+    uint64_t data_words_ = 0;              // Words after the FileHeader
+    size_t chunk_words_ = 0;               // Words in the current chunk
+    std::vector<event_file::IndexEntry> index_;
+
+    // Compressed recordings (writer thread, except done flags)
+    int compress_threads_ = 0;
+    std::unique_ptr<ThreadPool> compressors_;
+    std::unique_ptr<ChunkJob> filling_;
+    std::deque<std::unique_ptr<ChunkJob>> jobs_;         // Posted, in file order
+    std::vector<std::unique_ptr<ChunkJob>> spare_jobs_;
+    std::mutex jobs_mutex_;
+    std::condition_variable jobs_cv_;
+
+    std::string path_;
+    int64_t dropped_batches_base_ = 0;
+    int64_t dropped_events_base_ = 0;
+
+    std::atomic<uint64_t> events_written_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<bool> write_error_{false};
+};
+
+} // namespace video
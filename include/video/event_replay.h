@@ -0,0 +1,171 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "video/event_archive.h"
+#include "video/thread_pool.h"
+
+namespace video {
+
+/**
+ * Replays an event_file recording as if it came from the camera
+ *
+ * A reader thread decodes the memory-mapped file (EventArchive) and hands
+ * CD batches to the same callback the camera's decoding thread would call,
+ * so everything downstream (accumulation, analysis, display) runs unchanged.
+ *
+ * Pacing follows the recorded timestamps:
+ *   speed 1.0  = real time
+ *   speed N    = N times faster than real time
+ *   speed 0    = as fast as the file and the callback allow
+ *
+ * With decode threads and a chunk index, chunks are decoded on a pool of
+ * their own up to LOOKAHEAD_PER_THREAD chunks per thread ahead of
+ * playback and handed on strictly in file (timestamp) order; the reader
+ * thread then only batches and paces. Single-threaded decoding of
+ * compressed chunks otherwise caps speed 0 near real time at high rates.
+ *
+ * **Usage:**
+ * ```cpp
+ * replay.open("session.rtev");
+ * replay.start([](const EventCD* b, const EventCD* e) { ... }, 4.0);
+ * replay.stop();
+ * ```
+ */
+class EventReplay {
+public:
+    using EventCallback = std::function<void(const Metavision::EventCD*, const Metavision::EventCD*)>;
+
+    static constexpr int64_t BATCH_US = 1000;          // Sensor time per delivered batch
+    static constexpr size_t MAX_BATCH_EVENTS = 65536;  // Cap for very dense slices
+    static constexpr size_t LOOKAHEAD_PER_THREAD = 2;  // Decoded chunks queued per decode thread
+
+    EventReplay() = default;
+    ~EventReplay();
+
+    // Non-copyable
+    EventReplay(const EventReplay&) = delete;
+    EventReplay& operator=(const EventReplay&) = delete;
+
+    /**
+     * Open a recording and read its header
+     * @param path Recording written by EventRecorder
+     * @return true if the file is a valid recording
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Start the reader thread
+     * @param callback Receives each batch (called on the reader thread)
+     * @param speed Playback speed (1.0 = real time, 0 = as fast as possible)
+     * @return true if started
+     */
+    bool start(EventCallback callback, double speed = 1.0);
+
+    /**
+     * Stop the reader thread (keeps the file open for another start())
+     */
+    void stop();
+
+    /**
+     * Change playback speed while running
+     */
+    void set_speed(double speed) { speed_ = speed; }
+    double get_speed() const { return speed_.load(); }
+
+    /**
+     * Restart from the beginning when the end of file is reached
+     */
+    void set_loop(bool loop) { loop_ = loop; }
+
+    /**
+     * Begin playback this far into the recording (applies on next start())
+     * @param offset_us Offset from the first event (uses the chunk index)
+     */
+    void set_start_offset_us(int64_t offset_us) { start_offset_us_ = offset_us; }
+
+    /**
+     * Decode chunks on this many threads ahead of playback (applies on next start())
+     * @param threads 0 = decode on the reader thread (also used without a chunk index)
+     */
+    void set_decode_threads(int threads) { decode_threads_ = threads; }
+
+    bool is_open() const { return archive_.is_open(); }
+    bool is_running() const { return running_.load(); }
+    bool is_finished() const { return finished_.load(); }
+    int width() const { return archive_.width(); }
+    int height() const { return archive_.height(); }
+    int64_t get_duration_us() const { return archive_.end_timestamp() - archive_.start_timestamp(); }
+    const std::string& get_path() const { return path_; }
+
+    // Statistics
+    uint64_t get_total_events() const { return archive_.event_count(); }  // 0 if not closed cleanly
+    uint64_t get_events_replayed() const { return events_replayed_.load(std::memory_order_relaxed); }
+    int64_t get_position_us() const { return position_us_.load(std::memory_order_relaxed); }
+    double get_events_per_second() const { return events_per_second_.load(std::memory_order_relaxed); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct DecodedChunk {
+        std::vector<Metavision::EventCD> events;
+        std::vector<uint8_t> scratch;
+        bool done = true;                  // Guarded by decode_mutex_
+    };
+
+    void replay_loop();
+    void rewind(int64_t timestamp);
+    bool next_event(Metavision::EventCD& ev);
+    void post_chunk(size_t chunk);
+    void drain_decoders();
+    void deliver_batch();
+    void pace(int64_t timestamp);
+
+    EventArchive archive_;
+    std::string path_;
+    int64_t start_offset_us_ = 0;
+    int decode_threads_ = 0;
+
+    std::thread thread_;
+    EventCallback callback_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> finished_{false};
+    std::atomic<double> speed_{1.0};
+    std::atomic<bool> loop_{false};
+
+    // Parallel chunk decoding (slots reused in chunk order)
+    std::unique_ptr<ThreadPool> decoders_;
+    std::vector<std::unique_ptr<DecodedChunk>> slots_;
+    std::mutex decode_mutex_;
+    std::condition_variable decode_cv_;
+
+    // Reader thread only
+    bool parallel_ = false;
+    EventArchive::Cursor cursor_;         // Sequential decoding
+    size_t next_chunk_ = 0;               // Next chunk to play (parallel)
+    size_t posted_ = 0;                   // Next chunk to decode (parallel)
+    DecodedChunk* current_ = nullptr;
+    size_t event_pos_ = 0;
+    std::vector<Metavision::EventCD> batch_;
+    Clock::time_point pace_wall_start_;
+    int64_t pace_ts_start_ = 0;
+    double pace_speed_ = 0.0;
+    bool pace_anchored_ = false;
+    Clock::time_point rate_start_;
+    uint64_t rate_events_ = 0;
+
+    std::atomic<uint64_t> events_replayed_{0};
+    std::atomic<int64_t> position_us_{0};
+    std::atomic<double> events_per_second_{0.0};
+};
+
+} // namespace video
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "core/locked_memory.h"
+
+namespace video {
+
+/**
+ * Bounded single-producer/single-consumer ring of EventCD batches
+ *
+ * Decouples the SDK decoding thread (producer) from frame building
+ * (consumer). The producer never blocks: if the ring is full the batch is
+ * dropped and counted, so USB decoding is never backed up by downstream work.
+ *
+ * **PERFORMANCE:** Slots keep their std::vector storage between uses, so
+ * after warm-up a push is a single memcpy into preallocated memory and no
+ * allocation happens on either side. Slot storage comes from
+ * core::LockedMemory, so an idle spell cannot get it trimmed from the
+ * working set.
+ *
+ * Exactly one thread may call try_push() and exactly one thread may call
+ * front()/pop().
+ */
+class EventRing {
+public:
+    using Batch = std::vector<Metavision::EventCD, core::LockedAllocator<Metavision::EventCD>>;
+
+    /**
+     * Create ring
+     * @param capacity Number of batch slots (rounded up to a power of two)
+     * @param reserve_events Events preallocated per slot
+     */
+    explicit EventRing(size_t capacity = 64, size_t reserve_events = 16384);
+    ~EventRing() = default;
+
+    // Non-copyable
+    EventRing(const EventRing&) = delete;
+    EventRing& operator=(const EventRing&) = delete;
+
+    /**
+     * Copy a batch into the ring (producer side, never blocks)
+     * @param begin First event
+     * @param end One past last event
+     * @return true if stored, false if the ring was full and the batch dropped
+     */
+    bool try_push(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Get the oldest batch without removing it (consumer side)
+     * @return Pointer to batch, or nullptr if ring is empty
+     */
+    const Batch* front() const;
+
+    /**
+     * Release the batch returned by front() (consumer side)
+     */
+    void pop();
+
+    /**
+     * Wait until a batch is available or the timeout expires (consumer side)
+     * @param timeout_us Maximum wait in microseconds
+     * @return true if a batch is available
+     */
+    bool wait_for_data(int64_t timeout_us);
+
+    /**
+     * Wake a consumer blocked in wait_for_data() (e.g. on shutdown)
+     */
+    void notify();
+
+    /**
+     * Discard all pending batches. Only safe while neither side is running.
+     */
+    void clear();
+
+    /**
+     * Write every slot's reserved storage once, so the first batches take no page faults.
+     * Only safe while neither side is running.
+     */
+    void prefault();
+
+    // Statistics
+    int64_t get_dropped_batches() const { return dropped_batches_.load(std::memory_order_relaxed); }
+    int64_t get_dropped_events() const { return dropped_events_.load(std::memory_order_relaxed); }
+    size_t size() const;
+    size_t capacity() const { return slots_.size(); }
+
+    /**
+     * Get the highest fill (in batches) seen since the last call, and start over
+     *
+     * A full ring counts as capacity. Meant for one periodic reader (e.g. a
+     * rate controller); a push racing the reset may be attributed to either
+     * interval.
+     */
+    size_t take_peak_size() { return peak_size_.exchange(0, std::memory_order_relaxed); }
+
+    /**
+     * Check if the next try_push() will succeed (producer side)
+     *
+     * Lets a producer that may wait (e.g. file replay) apply backpressure
+     * instead of dropping.
+     */
+    bool has_space() const { return size() < slots_.size(); }
+
+private:
+    std::vector<Batch> slots_;
+    size_t mask_;
+
+    // Producer writes head_, consumer writes tail_ (kept on separate cache lines)
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+
+    alignas(64) std::atomic<int64_t> dropped_batches_{0};
+    std::atomic<int64_t> dropped_events_{0};
+    std::atomic<size_t> peak_size_{0};
+
+    // Only used by the consumer to sleep while the ring is empty
+    std::mutex wait_mutex_;
+    std::condition_variable data_cv_;
+};
+
+} // namespace video
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <metavision/sdk/base/utils/timestamp.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace video {
+
+/**
+ * Hand-off of packed event windows from an accumulation thread to the GPU
+ *
+ * Events are packed into 4 bytes each (pack()) and grouped by accumulation
+ * window, aligned like the frame generators. When a window closes, its
+ * events become the completed window, replacing any the GL thread has not
+ * taken yet: the display only ever needs the newest one, so a slow display
+ * costs nothing upstream. take() swaps vectors, so after warm-up neither
+ * side allocates. gpu::GPUEventScatter turns a taken window into a frame.
+ *
+ * push() must be called from one thread (the accumulation thread); take()
+ * from one other thread (the GL thread).
+ */
+class EventScatterQueue {
+public:
+    static constexpr int X_BITS = 15;   // x in bits 0-14, y in bits 15-30, polarity in bit 31
+
+    EventScatterQueue() = default;
+    ~EventScatterQueue() = default;
+
+    // Non-copyable
+    EventScatterQueue(const EventScatterQueue&) = delete;
+    EventScatterQueue& operator=(const EventScatterQueue&) = delete;
+
+    static uint32_t pack(const Metavision::EventCD& ev) {
+        return static_cast<uint32_t>(ev.x) | static_cast<uint32_t>(ev.y) << X_BITS |
+               static_cast<uint32_t>(ev.p != 0) << 31;
+    }
+
+    /**
+     * Set the window length and drop the window in progress (accumulation thread, or before it runs)
+     * @param width Frame width (events outside are dropped)
+     * @param height Frame height
+     * @param window_us Window length in microseconds
+     */
+    void configure(int width, int height, uint32_t window_us);
+
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Pack a batch into the window in progress, completing windows it crosses (accumulation thread)
+     */
+    void push(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Take the newest completed window (GL thread)
+     * @param events Swapped with the window's packed events (its old storage is reused)
+     * @param window_end_ts Sensor time closing the window
+     * @return false if no window completed since the last call
+     */
+    bool take(std::vector<uint32_t>& events, Metavision::timestamp& window_end_ts);
+
+    int get_width() const { return width_.load(std::memory_order_relaxed); }
+    int get_height() const { return height_.load(std::memory_order_relaxed); }
+
+    /**
+     * Completed windows the GL thread never took
+     */
+    uint64_t get_skipped_windows() const { return skipped_.load(std::memory_order_relaxed); }
+
+private:
+    void complete_window();
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<int> width_{0};
+    std::atomic<int> height_{0};
+
+    // Accumulation thread
+    int64_t window_us_ = 1;
+    int64_t window_end_ts_ = -1;        // -1 = not aligned yet
+    std::vector<uint32_t> filling_;
+
+    // Hand-off, guarded by mutex_
+    std::mutex mutex_;
+    std::vector<uint32_t> completed_;
+    Metavision::timestamp completed_end_ts_ = 0;
+    bool completed_new_ = false;
+    std::atomic<uint64_t> skipped_{0};
+};
+
+} // namespace video
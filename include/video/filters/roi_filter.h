@@ -10,6 +10,10 @@ namespace video {
  *
  * Can either draw a rectangle around the ROI or crop the frame to show
  * only the ROI region.
+ *
+ * **PERFORMANCE:** Cropping never copies: the output is an ROI view of the
+ * source pixels. Drawing copies into the reused destination, or draws
+ * straight onto the frame when run in place.
  */
 class ROIFilter : public IVideoFilter {
 public:
@@ -38,13 +42,24 @@ public:
     void set_show_rectangle(bool show);
 
     // IVideoFilter interface
-    cv::Mat apply(const cv::Mat& input) override;
+    bool apply(const FrameRef& input, FrameRef& output) override;
+    bool apply_in_place(FrameRef& frame) override;
     void set_enabled(bool enabled) override;
     bool is_enabled() const override;
     std::string name() const override;
     std::string description() const override;
 
 private:
+    /**
+     * ROI clipped to a frame (empty = outside the frame)
+     */
+    cv::Rect clipped_roi(cv::Size size) const;
+
+    /**
+     * Draw the ROI rectangle and corner markers onto a frame
+     */
+    void draw(cv::Mat& frame) const;
+
     bool enabled_ = false;
     bool crop_to_roi_ = false;
     bool show_rectangle_ = false;
@@ -12,7 +12,14 @@ namespace video {
  * Subtracts the previous frame from the current frame to highlight changes.
  * Useful for motion detection and visualizing temporal differences.
  *
- * PERFORMANCE: Eliminates 3 clone() calls per frame using FrameRef.
+ * 8-bit frames are shown as (current - previous) / 2 + 128, so unchanged
+ * pixels are mid-gray. On binary (0/255) frames this is a 3-state view:
+ * black = pixel turned off, gray = unchanged, white = turned on.
+ *
+ * PERFORMANCE: No per-frame allocations. 8-bit frames take one integer
+ * SIMD pass (simd::frame_difference), other depths a single saturating
+ * addWeighted; apply() keeps a FrameRef to the input as the previous frame
+ * (no clone) and apply_in_place() ping-pongs between two retained buffers.
  */
 class SubtractionFilter : public IVideoFilter {
 public:
@@ -25,15 +32,27 @@ public:
     void reset();
 
     // IVideoFilter interface
-    cv::Mat apply(const cv::Mat& input) override;
+    bool apply(const FrameRef& input, FrameRef& output) override;
+    bool apply_in_place(FrameRef& frame) override;
     void set_enabled(bool enabled) override;
     bool is_enabled() const override;
     std::string name() const override;
     std::string description() const override;
 
 private:
+    /**
+     * Write the difference image of current and previous (same size and type) into out
+     */
+    static void subtract(const cv::Mat& current, const cv::Mat& previous, cv::Mat& out);
+
+    /**
+     * Check the previous frame can be subtracted from current (same size and type)
+     */
+    bool has_previous(const cv::Mat& current) const;
+
     bool enabled_ = false;
-    FrameRef previous_frame_;  // ZERO-COPY: Use FrameRef instead of cv::Mat
+    FrameRef previous_frame_;  // ZERO-COPY: Use FrameRef instead of cv::Mat (unfiltered)
+    cv::Mat spare_;            // apply_in_place() copy target, swapped with previous_frame_
     mutable std::mutex mutex_;
 };
 
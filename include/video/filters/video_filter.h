@@ -1,6 +1,7 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include "video/frame_ref.h"
 #include <string>
 
 namespace video {
@@ -9,18 +10,39 @@ namespace video {
  * Interface for pluggable video filters
  *
  * All image processing filters implement this interface, allowing them to be
- * chained together in a processing pipeline.
+ * chained together in a processing pipeline (see FrameProcessor).
+ *
+ * Filters never allocate a result of their own: apply() writes into a
+ * destination the caller owns (reusing its buffer when size and type
+ * match) and apply_in_place() rewrites a frame nobody else shares. A filter
+ * that only selects part of the frame returns an ROI view instead of a copy.
  */
 class IVideoFilter {
 public:
     virtual ~IVideoFilter() = default;
 
     /**
-     * Apply filter to frame
-     * @param input Input frame
-     * @return Processed frame (may be the same as input if filter is disabled)
+     * Apply filter into a destination frame
+     *
+     * output is written through output.write(), so its buffer is kept when
+     * size and type already match. A cropping filter may instead make
+     * output a view of input's pixels (no copy; output then aliases input).
+     *
+     * @param input Source frame (never modified)
+     * @param output Destination, not shared with any other FrameRef
+     * @return true if output holds the result, false to pass input through (e.g. disabled)
+     */
+    virtual bool apply(const FrameRef& input, FrameRef& output) = 0;
+
+    /**
+     * Apply filter in place
+     * @param frame Frame whose buffer is not shared with any other FrameRef, reader or view
+     * @return false if this filter cannot run in place or is disabled (frame and filter state untouched)
      */
-    virtual cv::Mat apply(const cv::Mat& input) = 0;
+    virtual bool apply_in_place(FrameRef& frame) {
+        (void)frame;
+        return false;
+    }
 
     /**
      * Enable or disable filter
@@ -45,6 +67,22 @@ public:
      * @return Human-readable description of what this filter does
      */
     virtual std::string description() const = 0;
+
+protected:
+    /**
+     * Writable destination pixels for apply()
+     *
+     * Drops a destination that is a view of (or shares its buffer with)
+     * another frame, e.g. a crop left over from an earlier call, so writing
+     * never reaches someone else's pixels. An owned buffer is kept for reuse.
+     */
+    static cv::Mat& destination(FrameRef& output) {
+        cv::Mat& out = output.write();
+        if (out.u && out.u->refcount > 1) {
+            out.release();
+        }
+        return out;
+    }
 };
 
 } // namespace video
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace video {
+
+/**
+ * Dominant flicker frequency of the event stream
+ */
+struct FlickerEstimate {
+    double frequency_hz = 0.0;  // Interpolated spectral peak
+    double strength = 0.0;      // Peak power over the median power of the searched band
+    double event_rate = 0.0;    // Mean events per second over the analysed span
+};
+
+/**
+ * Global event-rate spectrum for flicker detection
+ *
+ * update() counts every event into a histogram of BIN_US bins (one
+ * increment per event, bins advanced by comparison, not division). Each
+ * time BINS bins are filled, the histogram is handed off as the latest
+ * complete span. estimate() then runs a Hann-windowed real DFT of that span
+ * (cv::dft, BINS points, ~1 Hz resolution up to 2 kHz) and returns the
+ * strongest peak of the requested band, refined by parabolic interpolation.
+ *
+ * Lighting flicker modulates the whole scene, so the global rate carries it
+ * without any per-pixel state.
+ *
+ * update() must be called from a single thread (the accumulation thread);
+ * estimate() may be called from any thread.
+ */
+class FlickerEstimator {
+public:
+    static constexpr int64_t BIN_US = 250;  // 4 kHz sample rate
+    static constexpr int BINS = 4096;       // 1.024 s per span
+    static constexpr double STRONG_PEAK = 50.0;  // Strength of a real flicker line; Poisson noise alone stays near 10
+
+    FlickerEstimator() = default;
+    ~FlickerEstimator() = default;
+
+    // Non-copyable
+    FlickerEstimator(const FlickerEstimator&) = delete;
+    FlickerEstimator& operator=(const FlickerEstimator&) = delete;
+
+    /**
+     * Count a batch of events
+     * @param begin First event
+     * @param end One past last event
+     */
+    void update(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Enable or disable counting (takes effect on the next batch; a partial span is dropped)
+     */
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Find the dominant frequency of the latest complete span
+     * @param min_hz Lowest frequency searched
+     * @param max_hz Highest frequency searched (at most the 2 kHz Nyquist limit)
+     * @param out Estimate
+     * @return false if no span has completed since the last call or it held no events
+     */
+    bool estimate(double min_hz, double max_hz, FlickerEstimate& out);
+
+private:
+    /**
+     * Hand the filled histogram to estimate() and start a new span
+     */
+    void publish();
+
+    std::atomic<bool> enabled_{false};
+
+    // Accumulation thread only
+    std::vector<uint32_t> filling_;
+    int bin_ = 0;
+    int64_t bin_end_ts_ = -1;  // -1 = not started
+
+    mutable std::mutex mutex_;
+    std::vector<uint32_t> complete_;  // Latest full span
+    bool fresh_ = false;              // complete_ not estimated yet
+
+    // estimate() scratch (under mutex_)
+    std::vector<float> signal_;
+    std::vector<float> spectrum_;
+};
+
+} // namespace video
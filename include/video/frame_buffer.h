@@ -2,24 +2,52 @@
 
 #include <opencv2/opencv.hpp>
 #include <atomic>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
 #include <mutex>
+#include <memory>
 #include <optional>
 #include "video/frame_ref.h"
+#include "video/binary_frame.h"
 
 namespace video {
 
+/**
+ * What the producer does when a queue-mode FrameBuffer is full
+ */
+enum class FrameQueuePolicy {
+    DropNewest,  // Refuse the incoming frame
+    DropOldest,  // Overwrite the oldest frame; lagging consumers skip ahead
+    Block        // Wait up to the configured timeout for space, then drop newest
+};
+
 /**
  * Thread-safe frame storage with frame dropping (ZERO-COPY optimized)
  *
- * Implements a single-frame buffer that drops new frames if the previous
- * frame has not been consumed yet. This prevents frame queue buildup and
- * maintains real-time display.
+ * **Mailbox mode (default):** single-frame buffer that drops new frames if
+ * the previous frame has not been consumed yet. This prevents frame queue
+ * buildup and maintains real-time display.
+ *
+ * **Queue mode (configure_queue):** N-slot ring broadcast to several
+ * consumers, each with its own cursor. "Latest" consumers (display) jump to
+ * the newest frame and never hold the producer back; "every frame"
+ * consumers (analysis, capture) see frames in order and are the ones the
+ * full-queue policy applies to. Cursors are atomics and each slot has its
+ * own lock, so producer and consumers only meet on the same slot.
+ *
+ * Consumer 0 is always the latest-frame display consumer used by the
+ * legacy consume_frame() / get_frames_dropped() calls.
  *
  * **PERFORMANCE:** Uses FrameRef for zero-copy frame storage.
  * No clone() calls - frames shared via copy-on-write semantics.
+ * Queued frames keep their FramePool slot busy, so a pool feeding a queue
+ * needs more slots than the queue depth.
  */
 class FrameBuffer {
 public:
+    static constexpr int MAX_CONSUMERS = 4;
+
     FrameBuffer() = default;
     ~FrameBuffer() = default;
 
@@ -27,6 +55,50 @@ public:
     FrameBuffer(const FrameBuffer&) = delete;
     FrameBuffer& operator=(const FrameBuffer&) = delete;
 
+    /**
+     * Switch to bounded multi-frame queue mode (call before frames are stored)
+     *
+     * Resets cursors and statistics. Consumers other than the default
+     * display consumer must be registered again afterwards.
+     *
+     * @param capacity Number of slots (rounded up to a power of two, 0 = back to mailbox mode)
+     * @param policy What to do when an every-frame consumer is capacity frames behind
+     * @param block_timeout_us Maximum producer wait for FrameQueuePolicy::Block
+     */
+    void configure_queue(size_t capacity, FrameQueuePolicy policy,
+                         int64_t block_timeout_us = 10000);
+
+    /**
+     * Register an additional consumer (queue mode only)
+     * @param every_frame true to receive every frame in order, false to skip to the newest
+     * @return Consumer id for consume_frame(id), or -1 if not in queue mode / no free consumer
+     */
+    int register_consumer(bool every_frame);
+
+    /**
+     * Unregister a consumer added with register_consumer()
+     * @param consumer_id Consumer id (the default consumer 0 cannot be removed)
+     */
+    void unregister_consumer(int consumer_id);
+
+    /**
+     * Wait until a frame is available for a consumer (queue mode)
+     * @param consumer_id Consumer id
+     * @param timeout_us Maximum wait in microseconds
+     * @return true if consume_frame(consumer_id) will return a frame
+     */
+    bool wait_for_frame(int consumer_id, int64_t timeout_us);
+
+    /**
+     * Wake consumers blocked in wait_for_frame() (e.g. on shutdown)
+     */
+    void notify();
+
+    /**
+     * Check if queue mode is active
+     */
+    bool is_queue_mode() const { return capacity_ != 0; }
+
     /**
      * Store new frame (may drop if not consumed)
      * @param frame Frame to store (ZERO-COPY - uses move/share semantics)
@@ -51,6 +123,25 @@ public:
      */
     std::optional<FrameRef> consume_frame();
 
+    /**
+     * Consume next frame for a registered consumer (queue mode, ZERO-COPY)
+     * @param consumer_id Id from register_consumer() (0 = display consumer)
+     * @return FrameRef if one is available for this consumer, nullopt otherwise
+     */
+    std::optional<FrameRef> consume_frame(int consumer_id);
+
+    /**
+     * Store latest bit-packed binary frame (never dropped, replaces previous)
+     * @param frame Shared packed frame (zero-copy)
+     */
+    void store_binary_frame(std::shared_ptr<const BinaryFrame> frame);
+
+    /**
+     * Get latest bit-packed binary frame for analysis (does not consume)
+     * @return Latest packed frame, or nullptr if none stored
+     */
+    std::shared_ptr<const BinaryFrame> get_binary_frame() const;
+
     /**
      * Check if frame is ready
      * @return true if unconsumed frame is available
@@ -63,6 +154,25 @@ public:
      */
     int64_t get_frames_dropped() const;
 
+    /**
+     * Get number of frames a consumer never received (queue mode)
+     * @param consumer_id Consumer id
+     * @return Frames skipped, overwritten or refused while this consumer was registered
+     */
+    int64_t get_frames_dropped(int consumer_id) const;
+
+    /**
+     * Get number of frames a consumer has yet to read (queue mode)
+     * @param consumer_id Consumer id
+     * @return Frames waiting, at most the queue capacity
+     */
+    size_t get_backlog(int consumer_id) const;
+
+    /**
+     * Get queue capacity (0 = mailbox mode)
+     */
+    size_t get_capacity() const { return capacity_; }
+
     /**
      * Get number of frames generated
      * @return Total count of frames stored
@@ -70,7 +180,40 @@ public:
     int64_t get_frames_generated() const;
 
 private:
+    struct QueueSlot {
+        std::mutex mutex;
+        FrameRef frame;
+        uint64_t seq = 0;           // Sequence number of the frame held
+    };
+
+    struct Consumer {
+        std::atomic<bool> active{false};
+        std::atomic<uint64_t> cursor{0};   // Next sequence number to read
+        std::atomic<int64_t> dropped{0};
+        bool every_frame = false;
+    };
+
+    void push_queue(FrameRef&& frame_ref);
+    static void stamp_stored(FrameRef& frame_ref);  // Set FrameTiming::stored_us at publication
+    bool has_frame_for(int consumer_id) const;
+    uint64_t min_every_frame_cursor(uint64_t write_seq) const;
+    bool queue_full(uint64_t write_seq) const;
+
+    // Queue mode
+    std::unique_ptr<QueueSlot[]> slots_;
+    size_t capacity_ = 0;           // 0 = mailbox mode, otherwise power of two
+    FrameQueuePolicy policy_ = FrameQueuePolicy::DropNewest;
+    int64_t block_timeout_us_ = 10000;
+    std::atomic<uint64_t> write_seq_{0};  // Frames published so far
+    std::array<Consumer, MAX_CONSUMERS> consumers_;
+    std::mutex space_mutex_;
+    std::condition_variable space_cv_;
+    std::mutex wait_mutex_;
+    std::condition_variable data_cv_;
+
+    // Mailbox mode
     FrameRef current_frame_;
+    std::shared_ptr<const BinaryFrame> current_binary_;
     std::atomic<bool> frame_consumed_{true};
     std::atomic<int64_t> frames_dropped_{0};
     std::atomic<int64_t> frames_generated_{0};
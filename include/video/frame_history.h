@@ -0,0 +1,156 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "video/binary_frame.h"
+
+namespace video {
+
+/**
+ * Scrub-back history of the last seconds of live frames, compressed in RAM
+ *
+ * Every frame is packed to 1 bit per pixel, XORed with the previous one
+ * and the difference run-length encoded (runs of zero bytes, then literal
+ * bytes, as LEB128 varints); every KEY_INTERVAL frames a key frame is
+ * encoded against an empty frame instead, so a frame decodes from at most
+ * KEY_INTERVAL - 1 deltas. Sparse event frames shrink to a few bytes per
+ * set pixel against ~115 KB packed (HD), so seconds of frames at 1 kHz fit
+ * a few hundred MB.
+ *
+ * Encoded frames go into one byte arena allocated once (max_bytes); the
+ * oldest key frame group is dropped when the arena is full or the frames
+ * after it cover the whole window, so nothing is allocated per frame.
+ *
+ * freeze() stops recording so a paused viewer can scrub a stable history:
+ * frame indices do not move while frozen.
+ *
+ * **Usage:**
+ * ```cpp
+ * history.configure(5.0, 256 << 20);
+ * history.push(frame, timestamp_us);   // Producer thread, every frame
+ * history.freeze(true);                // UI: pause
+ * history.decode(history.get_frame_count() - 10, mat);
+ * ```
+ */
+class FrameHistory {
+public:
+    static constexpr int KEY_INTERVAL = 64;   // Frames per key frame group
+
+    FrameHistory() = default;
+
+    // Non-copyable
+    FrameHistory(const FrameHistory&) = delete;
+    FrameHistory& operator=(const FrameHistory&) = delete;
+
+    /**
+     * Set the window and memory cap, dropping any history (0 for either = off)
+     * @param seconds Sensor time kept behind the newest frame
+     * @param max_bytes Arena size, allocated with the first frame
+     */
+    void configure(double seconds, size_t max_bytes);
+
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Record a frame (producer thread; no-op while disabled or frozen)
+     * @param frame CV_8UC1 binary frame, or a raw frame whose channel 0 is tested against bit_mask
+     * @param timestamp_us Sensor timestamp of the frame
+     * @param bit_mask Bits of channel 0 that mark a pixel set (0 = any non-zero value)
+     */
+    void push(const cv::Mat& frame, int64_t timestamp_us, uint8_t bit_mask = 0) {
+        if (recording_.load(std::memory_order_acquire)) {
+            push_frame(frame, timestamp_us, bit_mask);
+        }
+    }
+
+    /**
+     * Stop (true) or resume (false) recording; resuming keeps the history
+     */
+    void freeze(bool frozen);
+    bool is_frozen() const { return frozen_.load(std::memory_order_relaxed); }
+
+    /**
+     * Drop every frame (the arena is kept)
+     */
+    void clear();
+
+    /**
+     * Free the arena unless frozen; recording stays off until configure()
+     * @return Bytes freed
+     */
+    size_t release();
+
+    /**
+     * Get the number of frames held (index 0 = oldest)
+     */
+    int get_frame_count() const;
+
+    /**
+     * Get the sensor timestamp of a frame
+     * @return -1 if index is out of range
+     */
+    int64_t get_timestamp(int index) const;
+
+    /**
+     * Decode a frame (UI thread; stepping forward from the last decoded frame applies one delta)
+     * @param index 0 = oldest, get_frame_count() - 1 = newest
+     * @param out Unpacked CV_8UC1 frame (0 / 255)
+     * @return false if index is out of range
+     */
+    bool decode(int index, cv::Mat& out);
+
+    // Statistics
+    size_t get_arena_bytes() const { return arena_bytes_.load(std::memory_order_relaxed); }   // RAM held
+    size_t get_stored_bytes() const { return stored_bytes_.load(std::memory_order_relaxed); } // Encoded frames
+    cv::Size get_size() const;
+    int64_t get_frames_dropped() const { return frames_dropped_.load(std::memory_order_relaxed); }   // Wrong type or too large
+
+private:
+    struct Entry {
+        int64_t timestamp_us = 0;
+        size_t offset = 0;      // In arena_
+        uint32_t bytes = 0;
+        bool key = false;
+    };
+
+    void push_frame(const cv::Mat& frame, int64_t timestamp_us, uint8_t bit_mask);
+    void reset_locked(cv::Size size);     // mutex_ held
+    void pop_group_locked();              // mutex_ held: oldest key frame and its deltas
+    size_t reserve_locked(size_t bytes);  // mutex_ held: arena offset for bytes, evicting what it overlaps
+
+    // Settings
+    int64_t window_us_ = 0;
+    size_t max_bytes_ = 0;
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> frozen_{false};
+    std::atomic<bool> recording_{false};  // Enabled and not frozen (producer fast path)
+
+    // History (producer appends, UI reads; both under mutex_)
+    mutable std::mutex mutex_;
+    std::unique_ptr<uint8_t[]> arena_;
+    size_t head_ = 0;                     // Next free arena byte
+    std::deque<Entry> entries_;
+    cv::Size size_;
+    int since_key_ = 0;                   // Frames appended since the last key frame
+
+    // Producer scratch
+    BinaryFrame current_;
+    BinaryFrame previous_;
+    std::vector<uint8_t> encoded_;
+    std::vector<uint8_t> literal_;        // Literal bytes of the pending run
+
+    // Decoder state (UI thread, under mutex_)
+    BinaryFrame decoded_;
+    int64_t decoded_timestamp_ = -1;      // Timestamp of the frame in decoded_ (-1 = none)
+
+    std::atomic<size_t> arena_bytes_{0};
+    std::atomic<size_t> stored_bytes_{0};
+    std::atomic<int64_t> frames_dropped_{0};
+};
+
+} // namespace video
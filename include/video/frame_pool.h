@@ -0,0 +1,102 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "video/frame_ref.h"
+
+namespace video {
+
+/**
+ * Fixed-size pool of preallocated frames (ZERO-ALLOCATION hot path)
+ *
+ * Each slot owns a preallocated cv::Mat (page-aligned, locked or on large
+ * pages where allowed, see core::LockedMemory) and a persistent FrameRef
+ * control block. acquire() hands out
+ * a slot nobody else references; the consumer returns it simply by
+ * dropping every FrameRef / cv::Mat that shares it.
+ *
+ * Because the producer always writes into a free slot, frames still queued
+ * or displayed can never alias the producer's scratch buffer.
+ *
+ * **Usage:**
+ * ```cpp
+ * FrameRef frame = pool.acquire();
+ * if (!frame.empty()) {
+ *     produce_into(FramePool::writable(frame));
+ *     frame_buffer.store_frame(std::move(frame));
+ * }
+ * ```
+ */
+class FramePool {
+public:
+    /**
+     * Create pool (slots are allocated on first acquire / configure)
+     * @param slot_count Number of frames that may be in flight at once
+     */
+    explicit FramePool(int slot_count = 8);
+    ~FramePool() = default;
+
+    // Non-copyable
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /**
+     * (Re)allocate all slots for a frame format (no-op if unchanged)
+     * @param size Frame size
+     * @param type OpenCV type (e.g. CV_8UC1)
+     */
+    void configure(cv::Size size, int type);
+
+    /**
+     * Configure for a frame format and write every free slot once, so the first frames take no page faults
+     *
+     * Locked and large-page slots are resident already; pageable ones (locking
+     * off or refused) are only committed by their first write.
+     */
+    void prefault(cv::Size size, int type);
+
+    /**
+     * Acquire a free slot (producer side)
+     * @return Frame reference, or empty FrameRef if every slot is in flight
+     */
+    FrameRef acquire();
+
+    /**
+     * Acquire a free slot, configuring the pool for size/type first
+     */
+    FrameRef acquire(cv::Size size, int type);
+
+    /**
+     * Writable access to a frame obtained from acquire()
+     *
+     * Only valid before the frame is published to other threads.
+     */
+    static cv::Mat& writable(FrameRef& frame);
+
+    // Statistics
+    int slot_count() const { return static_cast<int>(slots_.size()); }
+    size_t get_bytes() const { return bytes_.load(std::memory_order_relaxed); }   // Pixels of every slot
+    int64_t get_acquired() const { return acquired_.load(std::memory_order_relaxed); }
+    int64_t get_exhausted() const { return exhausted_.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * Check if nothing outside the pool references a slot
+     */
+    static bool is_free(const std::shared_ptr<FrameRef::FrameData>& slot);
+
+    std::vector<std::shared_ptr<FrameRef::FrameData>> slots_;
+    cv::Size size_;
+    int type_ = -1;
+    size_t next_ = 0;   // Round-robin start to spread reuse across slots
+    std::mutex mutex_;  // Guards configure/acquire (single producer, uncontended)
+
+    std::atomic<int64_t> acquired_{0};
+    std::atomic<int64_t> exhausted_{0};
+    std::atomic<size_t> bytes_{0};
+};
+
+} // namespace video
@@ -12,6 +12,12 @@ namespace video {
  * Frame processor - orchestrates filter pipeline
  *
  * Manages a collection of filters and applies them in sequence to process frames.
+ *
+ * **PERFORMANCE:** Frames flow through the chain as FrameRefs. Each stage
+ * owns a small pool of scratch frames that are reused once the caller has
+ * let go of them, and a stage runs in place whenever the frame it receives
+ * is a scratch buffer nobody else shares, so a steady-state chain makes no
+ * per-frame allocations or copies beyond what the filters themselves compute.
  */
 class FrameProcessor {
 public:
@@ -43,10 +49,16 @@ public:
 
     /**
      * Process frame through all enabled filters
-     * @param input Input frame
-     * @return Processed frame
+     *
+     * output shares a stage's scratch frame (or input itself when no filter
+     * changed it); release or overwrite it before the next call so the
+     * scratch frame can be reused rather than a new one grown.
+     *
+     * @param input Input frame (never modified)
+     * @param output Processed frame
+     * @return true if any filter changed the frame, false if output is input
      */
-    cv::Mat process(const cv::Mat& input);
+    bool process(const FrameRef& input, FrameRef& output);
 
     /**
      * Convert BGR to RGB (OpenCV uses BGR by default)
@@ -56,7 +68,22 @@ public:
     static cv::Mat bgr_to_rgb(const cv::Mat& frame);
 
 private:
-    std::vector<std::shared_ptr<IVideoFilter>> filters_;
+    struct Stage {
+        std::shared_ptr<IVideoFilter> filter;
+        std::vector<FrameRef> slots;    // Scratch outputs, grown only while all are in use
+    };
+
+    /**
+     * Find an unused scratch frame for a stage (grows the stage's slots if none is free)
+     */
+    static FrameRef& free_slot(Stage& stage);
+
+    /**
+     * Check a frame can be modified in place (no other FrameRef, reader or view shares its buffer)
+     */
+    static bool is_exclusive(const FrameRef& frame);
+
+    std::vector<Stage> stages_;
     mutable std::mutex mutex_;
 };
 
@@ -1,11 +1,102 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include <algorithm>
 #include <memory>
 #include <atomic>
+#include <cstdint>
+#include "video/block_map.h"
 
 namespace video {
 
+/**
+ * Producer-side hot-path timestamps carried with a frame (see core::LatencyStats)
+ *
+ * Host times are steady-clock microseconds, 0 = stage not reached. Written
+ * by the producer before the frame is stored, read by consumers after.
+ */
+struct FrameTiming {
+    int64_t camera_ts = 0;      // Sensor timestamp of the frame (end of accumulation, us)
+    int64_t camera_host_us = 0; // camera_ts on the host clock (core::ClockSync), 0 = no mapping
+    uint32_t window_us = 0;     // Span the frame actually covers (0 = unknown)
+    int64_t events = -1;        // Events accumulated into it (-1 = not counted)
+    int64_t on_events = -1;     // ON events among them (-1 = not counted)
+    int64_t active_pixels = -1; // Non-zero pixels of the frame (-1 = not counted)
+    int event_x = 0;            // Bounding box of the window's events, sensor coords (width 0 = unknown)
+    int event_y = 0;
+    int event_width = 0;
+    int event_height = 0;
+    int64_t frame_index = -1;   // Frames this camera generated before it (-1 = unknown)
+    int64_t callback_us = 0;    // Frame generator callback entered
+    int64_t extracted_us = 0;   // Binary extraction (or copy into the pool) finished
+    int64_t stored_us = 0;      // Handed to the frame buffer
+};
+
+/**
+ * Row bands of a frame that may differ from its uniform background
+ *
+ * Bit b covers rows [b * BAND_ROWS, (b + 1) * BAND_ROWS); bit 63 also covers
+ * every row below it. Two frames with the same background differ at most in
+ * the union of their bands, so a texture holding one is brought up to date
+ * by uploading only those rows. Filled in by BinaryFrameAccumulator from
+ * event y-coordinates; the default (ALL) means unknown.
+ */
+struct RowBands {
+    static constexpr int BAND_ROWS = 64;
+    static constexpr uint64_t ALL = ~uint64_t(0);
+    static constexpr int FULL_UPLOAD_PERCENT = 50;  // Changed rows above which one full upload is cheaper
+
+    uint64_t bands = ALL;
+    uint8_t background = 0;
+
+    /**
+     * Bands to upload to turn a texture holding `shown` into `next`
+     * @return 0 if both are all background, ALL if they are not comparable
+     *         or more than FULL_UPLOAD_PERCENT of the rows changed
+     */
+    static uint64_t upload_bands(const RowBands& shown, const RowBands& next, int height) {
+        if (shown.background != next.background) {
+            return ALL;
+        }
+        const uint64_t changed = shown.bands | next.bands;
+        return count_rows(changed, height) * 100 > height * FULL_UPLOAD_PERCENT ? ALL : changed;
+    }
+
+    /**
+     * Call fn(first_row, rows) for each run of consecutive bands in mask, clipped to height
+     */
+    template <typename Fn>
+    static void for_each_run(uint64_t mask, int height, Fn&& fn) {
+        int band = 0;
+        while (mask != 0 && band < 64) {
+            if (!(mask & 1)) {
+                mask >>= 1;
+                ++band;
+                continue;
+            }
+            const int first = band;
+            while (band < 64 && (mask & 1)) {
+                mask >>= 1;
+                ++band;
+            }
+            const int begin = first * BAND_ROWS;
+            const int end = band == 64 ? height : std::min(height, band * BAND_ROWS);
+            if (begin < end) {
+                fn(begin, end - begin);
+            }
+        }
+    }
+
+    /**
+     * Rows covered by mask, clipped to height
+     */
+    static int count_rows(uint64_t mask, int height) {
+        int rows = 0;
+        for_each_run(mask, height, [&rows](int, int count) { rows += count; });
+        return rows;
+    }
+};
+
 /**
  * Zero-copy frame reference with copy-on-write semantics
  *
@@ -18,6 +109,19 @@ namespace video {
  * - Reduces L3 cache thrashing
  * - Enables efficient frame sharing between threads
  *
+ * **Publication and copy-on-write rules:**
+ * - A producer fills a frame (FramePool::writable) before publishing it,
+ *   i.e. storing it in a FrameBuffer or handing a copy to another thread
+ * - Once published a frame is immutable: read() is a plain load, with no
+ *   atomic read-modify-write, so adding consumers adds no shared cache-line
+ *   traffic on the read side
+ * - write() modifies in place only while is_exclusive() holds (this handle
+ *   is the only owner and no bare cv::Mat shares the pixels); otherwise it
+ *   clones first, so other holders never see a change
+ * - Every consumer holds its own FrameRef (or cv::Mat) while it reads, so
+ *   ownership is the reclamation scheme: a FramePool slot is only reused
+ *   once every handle to it has been dropped
+ *
  * **Usage:**
  * ```cpp
  * // Zero-cost read access
@@ -47,9 +151,9 @@ public:
         : data_(std::make_shared<FrameData>(std::move(mat))) {}
 
     /**
-     * Default constructor (empty frame)
+     * Default constructor (empty frame, no allocation)
      */
-    FrameRef() : data_(std::make_shared<FrameData>()) {}
+    FrameRef() = default;
 
     /**
      * Copy constructor (shares data, no clone)
@@ -74,8 +178,9 @@ public:
     /**
      * Get read-only access to frame (zero copy)
      *
-     * Safe to call from multiple threads. Increments reader count
-     * to prevent copy-on-write from invalidating the reference.
+     * Safe from any number of threads; valid while this handle holds the
+     * frame. Published frames are never modified in place, so there is no
+     * reader bookkeeping.
      *
      * @return Const reference to cv::Mat
      */
@@ -84,29 +189,31 @@ public:
             static const cv::Mat empty_mat;
             return empty_mat;
         }
-        data_->readers_.fetch_add(1, std::memory_order_acquire);
         return data_->mat_;
     }
 
     /**
-     * Release read lock (call after done with read())
+     * Check if this handle may modify the frame in place
      *
-     * Must be called after each read() to allow proper copy-on-write.
+     * True when no other FrameRef shares the frame and no bare cv::Mat
+     * shares its pixels. Nobody else can gain a reference meanwhile (that
+     * takes a copy of this handle), and the check synchronizes with the
+     * other owners' last use before they dropped the frame.
      */
-    void release_read() const {
-        if (data_) {
-            data_->readers_.fetch_sub(1, std::memory_order_release);
+    bool is_exclusive() const {
+        if (!data_ || data_.use_count() != 1) {
+            return false;
         }
+        std::atomic_thread_fence(std::memory_order_acquire);  // Pairs with the release in the owners' drops
+        const cv::Mat& mat = data_->mat_;
+        return mat.u == nullptr || mat.u->refcount == 1;
     }
 
     /**
      * Get writable access to frame (copy-on-write if shared)
      *
-     * Automatically clones the frame if:
-     * - Multiple FrameRef instances share this data, OR
-     * - Active readers exist
-     *
-     * This ensures modifications don't affect other references.
+     * Clones the frame first unless is_exclusive(), so modifications
+     * never affect other references.
      *
      * @return Mutable reference to cv::Mat
      */
@@ -116,12 +223,18 @@ public:
             return data_->mat_;
         }
 
-        // Copy-on-write: clone if shared or has readers
-        if (!data_.unique() || data_->readers_.load(std::memory_order_acquire) > 0) {
+        // Copy-on-write: clone if anyone else can see the pixels
+        if (!is_exclusive()) {
             // Create new copy for this reference
-            data_ = std::make_shared<FrameData>(data_->mat_.clone());
+            auto copy = std::make_shared<FrameData>(data_->mat_.clone());
+            copy->timing_ = data_->timing_;
+            data_ = std::move(copy);
         }
 
+        data_->row_bands_ = RowBands{};  // Caller may change any row
+        data_->block_map_.reset();
+        data_->timing_.active_pixels = -1;
+        data_->preview_.release();       // Would no longer match
         return data_->mat_;
     }
 
@@ -158,10 +271,78 @@ public:
     }
 
     /**
-     * Get active reader count (for debugging)
+     * Get hot-path timestamps (zeros if empty)
+     */
+    FrameTiming timing() const {
+        return data_ ? data_->timing_ : FrameTiming{};
+    }
+
+    /**
+     * Attach hot-path timestamps (producer only, before the frame is stored)
+     */
+    void set_timing(const FrameTiming& timing) {
+        if (data_) {
+            data_->timing_ = timing;
+        }
+    }
+
+    /**
+     * Get the rows that may differ from the background (ALL if unknown or empty)
      */
-    int reader_count() const {
-        return data_ ? data_->readers_.load(std::memory_order_relaxed) : 0;
+    RowBands row_bands() const {
+        return data_ ? data_->row_bands_ : RowBands{};
+    }
+
+    /**
+     * Attach row bands (producer only, before the frame is stored)
+     */
+    void set_row_bands(const RowBands& bands) {
+        if (data_) {
+            data_->row_bands_ = bands;
+        }
+    }
+
+    /**
+     * Get the 64 x 8 blocks that may hold set pixels (see BlockMap)
+     * @return nullptr if unknown (any pixel may be set); valid while this reference lives
+     */
+    const BlockMap* block_map() const {
+        return data_ ? data_->block_map_.get() : nullptr;
+    }
+
+    /**
+     * Attach an occupancy map (producer only, before the frame is stored)
+     */
+    void set_block_map(std::shared_ptr<const BlockMap> map) {
+        if (data_) {
+            data_->block_map_ = std::move(map);
+        }
+    }
+
+    /**
+     * Get the binned display preview (empty if none)
+     */
+    const cv::Mat& preview() const {
+        static const cv::Mat empty_mat;
+        return data_ ? data_->preview_ : empty_mat;
+    }
+
+    /**
+     * Get the pixels per side of a preview pixel (0 = no preview)
+     */
+    int preview_binning() const {
+        return data_ && !data_->preview_.empty() ? data_->preview_binning_ : 0;
+    }
+
+    /**
+     * Attach a binned preview of the frame (producer only, before the frame is stored; shared, not copied)
+     * @param preview CV_8UC1 preview, each pixel covering binning x binning frame pixels
+     */
+    void set_preview(const cv::Mat& preview, int binning) {
+        if (data_) {
+            data_->preview_ = preview;
+            data_->preview_binning_ = binning;
+        }
     }
 
     /**
@@ -184,20 +365,35 @@ public:
     }
 
 private:
+    friend class FramePool;
+
     struct FrameData {
         cv::Mat mat_;
-        mutable std::atomic<int> readers_{0};
+        FrameTiming timing_;
+        RowBands row_bands_;
+        std::shared_ptr<const BlockMap> block_map_;   // Shared with the accumulator's pool
+        cv::Mat preview_;               // Binned copy for zoomed-out display and streaming
+        int preview_binning_ = 0;
 
         FrameData() = default;
         explicit FrameData(const cv::Mat& mat) : mat_(mat) {}
         explicit FrameData(cv::Mat&& mat) noexcept : mat_(std::move(mat)) {}
     };
 
+    /**
+     * Construct from existing control block (used by FramePool to recycle)
+     */
+    explicit FrameRef(std::shared_ptr<FrameData> data) noexcept
+        : data_(std::move(data)) {}
+
     std::shared_ptr<FrameData> data_;
 };
 
 /**
- * RAII read guard for automatic release
+ * Scoped read access to a frame
+ *
+ * Costs nothing beyond read(); the FrameRef it was built from must outlive
+ * it, which is what keeps the frame alive.
  *
  * Usage:
  * ```cpp
@@ -206,16 +402,12 @@ private:
  *     ReadGuard guard(frame_ref);
  *     const cv::Mat& mat = guard.get();
  *     // Use mat...
- * } // Automatically releases read lock
+ * }
  * ```
  */
 class ReadGuard {
 public:
-    explicit ReadGuard(const FrameRef& ref) : ref_(ref), mat_(ref.read()) {}
-
-    ~ReadGuard() {
-        ref_.release_read();
-    }
+    explicit ReadGuard(const FrameRef& ref) : mat_(ref.read()) {}
 
     // Non-copyable, non-movable
     ReadGuard(const ReadGuard&) = delete;
@@ -225,7 +417,6 @@ public:
     const cv::Mat* operator->() const { return &mat_; }
 
 private:
-    const FrameRef& ref_;
     const cv::Mat& mat_;
 };
 
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "video/binary_frame.h"
+
+namespace video {
+
+/**
+ * Streams binary frames to remote viewers over TCP
+ *
+ * submit() only parks a reference to the newest frame of each camera
+ * (no copy, no queue); a single server thread packs it to 1 bit per pixel
+ * and sends it to every connected client. A client is only given a frame
+ * once everything previously sent to it has left the socket, and at most
+ * max_fps frames per second per camera, so a slow link skips frames
+ * instead of queueing them and never holds up the camera path or other
+ * clients.
+ *
+ * Wire format (little-endian): each frame is a MessageHeader followed by
+ * payload_bytes of row-level run-length code. Rows are the BinaryFrame
+ * words (64 pixels, least significant bit = leftmost pixel); each row is a
+ * sequence of (uint16 zero_words, uint16 literal_words, literal words...)
+ * tokens covering exactly words_per_row = ceil(width / 64) words. A Key
+ * frame codes the frame itself; a Delta frame codes its XOR with the
+ * previous frame of the same camera sent on this connection. The server
+ * sends whichever is smaller, and always a Key first. decode() is the
+ * reference decoder. A binned preview (stream_preview) is sent in place of
+ * the frame with binning > 1: each of its pixels covers binning x binning
+ * sensor pixels.
+ *
+ * **PERFORMANCE:** Event frames are mostly empty words, so a 1280x720
+ * frame typically codes to a few KB (vs ~115 KB packed, ~900 KB 8-bit),
+ * and a delta of a static scene to a few bytes per row.
+ *
+ * **Usage:**
+ * ```cpp
+ * streamer.start({9500, 30, 4});
+ * streamer.submit(camera_index, timestamp_us, binary);  // frame callback
+ * streamer.stop();
+ * ```
+ */
+class FrameStreamer {
+public:
+    static constexpr uint32_t MAGIC = 0x46535452;  // "RTSF"
+    static constexpr int MAX_CAMERAS = 4;
+
+    enum class FrameType : uint8_t {
+        Key = 0,     // Frame itself
+        Delta = 1    // XOR with the previous frame of the camera on this connection
+    };
+
+    struct MessageHeader {
+        uint32_t magic;          // MAGIC
+        uint8_t type;            // FrameType
+        uint8_t camera_index;
+        uint16_t binning;        // Sensor pixels per side of a frame pixel (0 or 1 = full resolution)
+        int32_t width;
+        int32_t height;
+        int64_t timestamp_us;    // Sensor time of the frame
+        uint32_t sequence;       // Frame number of the camera (gaps = frames skipped for this client)
+        uint32_t payload_bytes;
+    };
+    static_assert(sizeof(MessageHeader) == 32, "MessageHeader must stay 32 bytes");
+
+    struct Options {
+        int port = 9500;         // Listen port (all interfaces)
+        int max_fps = 30;        // Per client and camera (0 = as fast as the link drains)
+        int max_clients = 4;
+    };
+
+    FrameStreamer() = default;
+    ~FrameStreamer();
+
+    // Non-copyable
+    FrameStreamer(const FrameStreamer&) = delete;
+    FrameStreamer& operator=(const FrameStreamer&) = delete;
+
+    /**
+     * Open the listen socket and start the server thread
+     * @return true if listening
+     */
+    bool start(const Options& options);
+
+    /**
+     * Disconnect every client and stop the thread
+     */
+    void stop();
+
+    bool is_running() const { return running_.load(); }
+
+    /**
+     * Offer the newest frame of a camera (any thread; shares the data, never blocks on the network)
+     * @param camera_index Camera the frame comes from
+     * @param timestamp_us Sensor time of the frame
+     * @param frame CV_8UC1 frame (non-zero = set); must not be written afterwards
+     * @param binning Sensor pixels per side of a frame pixel (1 = full resolution)
+     */
+    void submit(int camera_index, int64_t timestamp_us, const cv::Mat& frame, int binning = 1);
+
+    int get_client_count() const { return client_count_.load(std::memory_order_relaxed); }
+
+    /**
+     * Code a packed frame as a Key (reference == nullptr) or Delta payload
+     * @param out Payload (cleared first)
+     */
+    static void encode(const BinaryFrame& frame, const BinaryFrame* reference, std::vector<uint8_t>& out);
+
+    /**
+     * Apply a payload to frame: a Key replaces it, a Delta is XORed into it
+     * @param frame Previous frame of the camera (Delta) or any frame (Key; resized)
+     * @return false if the payload is malformed
+     */
+    static bool decode(const MessageHeader& header, const uint8_t* payload, BinaryFrame& frame);
+
+private:
+    struct Client {
+        intptr_t socket = -1;
+        std::vector<uint8_t> pending;    // Bytes not yet accepted by the socket
+        size_t sent = 0;                 // Of pending
+        uint32_t last_sequence[MAX_CAMERAS] = {};
+        int64_t next_send_us[MAX_CAMERAS] = {};
+        BinaryFrame reference[MAX_CAMERAS];  // Last frame sent per camera (empty = send a Key)
+    };
+
+    void run();
+    void accept_clients();
+    bool flush(Client& client);
+    void send_frame(Client& client, int camera, int64_t now_us);
+
+    Options options_;
+    intptr_t listener_ = -1;
+    bool winsock_started_ = false;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<int> client_count_{0};
+
+    // Newest frame per camera, handed from submit() to the server thread
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    cv::Mat latest_[MAX_CAMERAS];
+    int64_t latest_ts_[MAX_CAMERAS] = {};
+    int latest_binning_[MAX_CAMERAS] = {};
+    uint32_t latest_sequence_[MAX_CAMERAS] = {};
+
+    // Server thread only
+    std::vector<Client> clients_;
+    BinaryFrame packed_[MAX_CAMERAS];
+    int64_t packed_ts_[MAX_CAMERAS] = {};
+    int packed_binning_[MAX_CAMERAS] = {};
+    uint32_t packed_sequence_[MAX_CAMERAS] = {};   // 0 = nothing packed yet
+    std::vector<uint8_t> key_;
+    std::vector<uint8_t> delta_;
+};
+
+} // namespace video
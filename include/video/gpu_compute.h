@@ -2,6 +2,7 @@
 
 #include <GL/glew.h>
 #include <opencv2/opencv.hpp>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -33,20 +34,100 @@ GLuint compile_compute_shader(const char* source);
 bool check_compute_errors(GLuint shader, const char* type);
 
 /**
- * Upload cv::Mat to GPU texture using PBO for async transfer
+ * Keep linked programs as driver binaries in a directory (GL thread, before the first program)
  *
- * @param texture OpenGL texture ID
- * @param mat Input image (CV_8UC1 or CV_8UC3)
+ * Compiling and linking a program takes tens to hundreds of milliseconds on
+ * some drivers, paid on the first frame that needs it. With a cache, later
+ * starts load the binary with glProgramBinary instead. Files are keyed by a
+ * hash of the GLSL sources and the GL vendor, renderer and version, so an
+ * edited shader or a driver update compiles afresh; a binary the driver
+ * rejects is compiled and rewritten. Needs GL 4.1 or ARB_get_program_binary,
+ * otherwise every program is compiled.
+ *
+ * @param directory Cache directory, created on the first save ("" = compile every time)
+ */
+void set_program_cache_directory(const std::string& directory);
+
+/**
+ * Programs loaded from the cache and compiled since startup
  */
-void upload_texture_async(GLuint texture, const cv::Mat& mat);
+struct ProgramCacheStats {
+    int loaded = 0;
+    int compiled = 0;
+};
+ProgramCacheStats get_program_cache_stats();
 
 /**
- * Download GPU texture to cv::Mat using PBO for async transfer
+ * Immutable 8-bit texture with PBO upload and fenced PBO readback
  *
- * @param texture OpenGL texture ID
- * @param mat Output image (pre-allocated)
+ * Storage is allocated once with glTexStorage2D and only recreated when the
+ * size or format changes. Uploads go through an orphaned PBO ring so the
+ * driver never waits on a previous transfer; readbacks are packed into PBOs
+ * and fenced, so the caller decides whether to wait now or a frame later.
  */
-void download_texture_async(GLuint texture, cv::Mat& mat);
+class StreamingTexture {
+public:
+    StreamingTexture() = default;
+    ~StreamingTexture();
+
+    // Non-copyable
+    StreamingTexture(const StreamingTexture&) = delete;
+    StreamingTexture& operator=(const StreamingTexture&) = delete;
+
+    /**
+     * Allocate storage for a size/channel count (no-op if unchanged)
+     * @param width Texture width
+     * @param height Texture height
+     * @param channels 1 (GL_R8) or 3 (GL_RGB8, uploaded as BGR)
+     * @return true if storage is ready
+     */
+    bool ensure(int width, int height, int channels);
+
+    /**
+     * Upload an image of the allocated size through the PBO ring
+     */
+    bool upload(const cv::Mat& mat);
+
+    /**
+     * Start packing the texture into a readback PBO (NON-BLOCKING)
+     *
+     * If every readback slot is still pending, the oldest is discarded.
+     */
+    void begin_readback();
+
+    /**
+     * Copy the oldest pending readback into out
+     * @param out Destination (reallocated only on size/type change)
+     * @param wait Block until the GPU finishes (false = poll only)
+     * @return true if out was written
+     */
+    bool end_readback(cv::Mat& out, bool wait);
+
+    /**
+     * Number of readbacks started but not yet collected
+     */
+    int pending_readbacks() const { return pending_; }
+
+    void release();
+
+    GLuint id() const { return texture_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+private:
+    static constexpr int NUM_PBOS = 2;
+
+    GLuint texture_{0};
+    GLuint upload_pbo_[NUM_PBOS]{0, 0};
+    GLuint pack_pbo_[NUM_PBOS]{0, 0};
+    GLsync pack_fence_[NUM_PBOS]{nullptr, nullptr};
+    int upload_idx_{0};
+    int pack_write_{0};
+    int pending_{0};
+    int width_{0};
+    int height_{0};
+    int channels_{0};
+};
 
 /**
  * GPU Morphology Operations
@@ -71,26 +152,102 @@ public:
      * @param output Output image (CV_8UC1, pre-allocated)
      * @param op Operation type (ERODE or DILATE)
      * @param kernel_size Kernel size (must be odd, e.g., 3, 5, 7)
+     * @return true if output was written (false on error or, when readback
+     *         is deferred, on the first frame)
      */
-    void process(const cv::Mat& input, cv::Mat& output, Operation op, int kernel_size);
+    bool process(const cv::Mat& input, cv::Mat& output, Operation op, int kernel_size);
+
+    /**
+     * Defer readback by one frame: process() returns the previous frame's
+     * result so the GPU never has to finish while the CPU waits
+     */
+    void set_deferred_readback(bool deferred) { deferred_readback_ = deferred; }
 
 private:
     void init();
     void cleanup();
 
     GLuint program_{0};
-    GLuint input_texture_{0};
-    GLuint output_texture_{0};
-    int width_{0};
-    int height_{0};
+    GLint kernel_size_location_{-1};
+    GLint operation_location_{-1};
+    StreamingTexture input_;
+    StreamingTexture output_;
+    bool deferred_readback_{false};
     bool initialized_{false};
 };
 
+/**
+ * GPU Threshold + Open + Close Chain
+ *
+ * The dot detection cleanup (threshold, MORPH_OPEN, MORPH_CLOSE with a
+ * rectangular kernel) as one chain: the image is uploaded once, eight
+ * separable 1-D passes (erode, dilate, dilate, erode, each as a row pass
+ * and a column pass, the threshold fused into the first) ping-pong between
+ * two textures, and only the final binary image is read back. Each pass
+ * stages a 256-pixel line segment plus its halo in shared memory, so the
+ * cost per pixel is one load and a k-wide min/max instead of a (2k+1)^2
+ * image loop. Out-of-image pixels are ignored, as OpenCV's default
+ * morphology border does.
+ *
+ * Needs the same GL 4.3 features as GPUMorphology; call on the thread
+ * owning the GL context.
+ */
+class GPUMorphologyChain {
+public:
+    static constexpr int MAX_KERNEL = 63;   // Shared-memory halo limit
+
+    GPUMorphologyChain() = default;
+    ~GPUMorphologyChain();
+
+    // Non-copyable
+    GPUMorphologyChain(const GPUMorphologyChain&) = delete;
+    GPUMorphologyChain& operator=(const GPUMorphologyChain&) = delete;
+
+    static bool is_supported();
+
+    /**
+     * threshold(THRESH_BINARY) -> open -> close, as cv::threshold + cv::morphologyEx would
+     * @param gray Input image (CV_8UC1)
+     * @param threshold Pixels above this become 255 (negative: not run on the GPU)
+     * @param kernel_size Side of the square structuring element (1 to MAX_KERNEL)
+     * @param binary Output (CV_8UC1, 0/255; reallocated only on size change)
+     * @return false if the chain could not run (caller falls back to the CPU)
+     */
+    bool process(const cv::Mat& gray, int threshold, int kernel_size, cv::Mat& binary);
+
+    void release();
+
+private:
+    bool init_program();
+    void dispatch_pass(GLuint source, GLuint target, int axis, int operation, int threshold);
+
+    GLuint program_{0};
+    GLint axis_location_{-1};
+    GLint operation_location_{-1};
+    GLint kernel_size_location_{-1};
+    GLint threshold_location_{-1};
+    StreamingTexture input_;
+    StreamingTexture ping_;
+    StreamingTexture pong_;
+    bool program_failed_{false};
+};
+
 /**
  * GPU Histogram Computation
  *
  * Parallel histogram calculation using atomic operations.
  * Performance: 2ms → 0.1ms (20× faster than CPU)
+ *
+ * compute_masked() bins signal and noise pixels in one dispatch, with the
+ * signal mask as a second texture: each workgroup counts a 64x64 tile
+ * into a 512-bin histogram in shared memory and merges only its non-zero
+ * bins into the global one, so global atomics stay at a few hundred per
+ * tile. The histograms feed NoiseAnalyzer::analyzeHistograms() /
+ * analyzeNoise(), which derive mean, std, min and max exactly. A frame
+ * that is already an R8 texture (the display texture) needs no upload.
+ *
+ * One instance should compute either plain or masked histograms: the
+ * deferred readback ring holds the results of whichever ran last.
  */
 class GPUHistogram {
 public:
@@ -102,50 +259,712 @@ public:
      *
      * @param input Input image (CV_8UC1)
      * @param histogram Output histogram (256 bins)
+     * @return true if histogram was written (false on error or, when
+     *         readback is deferred, on the first frame)
      */
-    void compute(const cv::Mat& input, std::vector<uint32_t>& histogram);
+    bool compute(const cv::Mat& input, std::vector<uint32_t>& histogram);
+
+    /**
+     * Upload the signal mask for compute_masked() (once per dot geometry)
+     *
+     * @param mask CV_8UC1, non-zero = signal
+     * @return true if uploaded
+     */
+    bool set_mask(const cv::Mat& mask);
+
+    /**
+     * Compute signal and noise histograms in one dispatch
+     *
+     * @param input Input image (CV_8UC1, mask size)
+     * @param signal Output histogram of the pixels inside the mask (256 bins)
+     * @param noise Output histogram of the rest (256 bins)
+     * @return true if the histograms were written (see compute())
+     */
+    bool compute_masked(const cv::Mat& input, std::vector<uint32_t>& signal, std::vector<uint32_t>& noise);
+
+    /**
+     * Compute signal and noise histograms of a frame already on the GPU
+     *
+     * @param texture GL_R8 texture with immutable storage (e.g. TextureManager's display texture)
+     * @param width Texture width (must match the mask)
+     * @param height Texture height
+     * @param signal Output histogram of the pixels inside the mask (256 bins)
+     * @param noise Output histogram of the rest (256 bins)
+     * @return true if the histograms were written (see compute())
+     */
+    bool compute_masked(GLuint texture, int width, int height,
+                        std::vector<uint32_t>& signal, std::vector<uint32_t>& noise);
+
+    /**
+     * Defer readback by one frame: compute() returns the previous frame's histogram
+     */
+    void set_deferred_readback(bool deferred) { deferred_readback_ = deferred; }
 
 private:
+    static constexpr int NUM_READBACKS = 2;
+
+    static constexpr int MASKED_BINS = 512;  // Signal bins, then noise bins
+    static constexpr int MASKED_TILE = 64;   // Pixels per workgroup side (16x16 threads, 4x4 pixels each)
+
     void init();
     void cleanup();
 
+    /**
+     * Zero the SSBO before a dispatch
+     */
+    void clear_bins(int bins);
+
+    /**
+     * Copy the SSBO into the readback ring and collect the oldest result
+     * @return true if out (bins entries) was written
+     */
+    bool read_bins(int bins, uint32_t* out);
+
     GLuint program_{0};
-    GLuint input_texture_{0};
-    GLuint histogram_buffer_{0};  // SSBO for atomic histogram
-    int width_{0};
-    int height_{0};
+    GLuint masked_program_{0};
+    StreamingTexture input_;
+    StreamingTexture mask_;
+    GLuint histogram_buffer_{0};  // SSBO for atomic histogram (MASKED_BINS, plain uses the first 256)
+    GLuint readback_buffers_[NUM_READBACKS]{0, 0};
+    GLsync readback_fences_[NUM_READBACKS]{nullptr, nullptr};
+    int readback_write_{0};
+    int readback_pending_{0};
+    bool deferred_readback_{false};
     bool initialized_{false};
 };
 
 /**
  * GPU Fitness Evaluator for Genetic Algorithm
  *
- * Evaluates multiple genomes in parallel on GPU.
- * Performance: 50+ minute optimization → 2-3 minutes (50× faster)
+ * Evaluates a whole batch of frames in one dispatch: the frames are packed
+ * into one PBO and uploaded as the layers of an R8UI 2D texture array, each
+ * workgroup reduces its 16x16 tile in shared memory (tree reduction) and
+ * adds the tile's sums to its frame's slot in an SSBO with 32-bit integer
+ * atomics (64-bit sums carried across two words). No float atomics or
+ * vendor extensions are needed, and the results are exact.
  */
 class GPUFitnessEvaluator {
 public:
     GPUFitnessEvaluator();
     ~GPUFitnessEvaluator();
 
+    // Non-copyable
+    GPUFitnessEvaluator(const GPUFitnessEvaluator&) = delete;
+    GPUFitnessEvaluator& operator=(const GPUFitnessEvaluator&) = delete;
+
     /**
      * Evaluate multiple frames on GPU for fitness metrics
      *
-     * @param frames Input frames to evaluate
-     * @param metrics Output fitness metrics per frame
+     * @param frames Input frames to evaluate (CV_8UC1, all the same size)
+     * @param metrics Output fitness metric per frame, in input order
+     * @return true if metrics holds one value per frame
      */
-    void evaluate_batch(const std::vector<cv::Mat>& frames,
-                       std::vector<float>& metrics);
+    bool evaluate_batch(const std::vector<cv::Mat>& frames,
+                        std::vector<float>& metrics);
+
+    bool is_initialized() const { return initialized_; }
 
 private:
+    static constexpr int METRIC_WORDS = 5;  // sum lo/hi, sum_sq lo/hi, non-zero count
+
     void init();
     void cleanup();
+    bool ensure_resources(int width, int height, int layers, size_t frames);
+    bool upload(const std::vector<cv::Mat>& frames, size_t first, int count);
 
     GLuint program_{0};
-    GLuint input_texture_{0};
-    GLuint metrics_buffer_{0};  // SSBO for fitness results
+    GLint frame_offset_location_{-1};
+    GLint max_layers_{0};            // Frames per dispatch (array layers, z groups)
+    GLuint frames_texture_{0};       // GL_TEXTURE_2D_ARRAY, R8UI
+    GLuint upload_pbo_{0};
+    int width_{0};
+    int height_{0};
+    int layers_{0};
+    GLuint metrics_buffer_{0};       // SSBO, METRIC_WORDS per frame
+    size_t metrics_capacity_{0};     // Frames the SSBO can hold
     bool initialized_{false};
 };
 
+/**
+ * GPU-Resident Binary Pipeline
+ *
+ * Runs the live binary path on the GPU: the raw camera frame is uploaded
+ * once as an integer texture (R8UI / RGB8UI via PBO) and a single compute
+ * pass does the bit extraction + OR, the scattering AND-NOT against a
+ * reference with a per-pixel R32UI count increment, and a workgroup
+ * reduction of the frame statistics into an SSBO.
+ *
+ * The binary result is an R8 texture sampled directly for display; nothing
+ * is read back on the critical path. Statistics and (optionally) the binary
+ * image come back through fenced buffers one or more frames late.
+ *
+ * Requires OpenGL 4.3 (compute shaders, image load/store, SSBO, texture
+ * storage); check is_supported() and fall back to the CPU path otherwise.
+ * All methods must be called on the thread owning the GL context.
+ */
+class GPUBinaryPipeline {
+public:
+    struct Stats {
+        uint32_t active_pixels{0};          // Pixels with a selected bit set
+        uint32_t scattering_pixels{0};      // Active pixels outside the reference
+        uint32_t total_scattering_events{0};
+        uint32_t max_scattering_count{0};
+        int64_t frame_index{-1};            // Frame these stats belong to (-1 = none yet)
+    };
+
+    GPUBinaryPipeline();
+    ~GPUBinaryPipeline();
+
+    // Non-copyable
+    GPUBinaryPipeline(const GPUBinaryPipeline&) = delete;
+    GPUBinaryPipeline& operator=(const GPUBinaryPipeline&) = delete;
+
+    /**
+     * Check if the current GL context can run the pipeline
+     */
+    static bool is_supported();
+
+    /**
+     * Compile the program and create every texture and buffer for a frame size ahead of the first frame
+     * @param channels Channels of the raw frames (1 or 3)
+     * @return false if the program does not compile
+     */
+    bool prepare(int width, int height, int channels);
+
+    /**
+     * Upload a raw frame and run extraction / scattering / stats on the GPU
+     * @param frame Raw camera frame (CV_8UC1 or CV_8UC3, channel 0 is used)
+     * @param bit_mask Bits selected for the binary image
+     * @return true if the frame was dispatched
+     */
+    bool process(const cv::Mat& frame, uint8_t bit_mask);
+
+    /**
+     * Binary result (R8, 0/255, swizzled to gray) for direct display
+     */
+    GLuint get_binary_texture() const { return binary_texture_; }
+
+    /**
+     * Per-pixel scattering counts (R32UI)
+     */
+    GLuint get_count_texture() const { return count_texture_; }
+
+    /**
+     * Reference image (R8UI, 0 = not part of reference)
+     */
+    GLuint get_reference_texture() const { return reference_texture_; }
+
+    int get_width() const { return width_; }
+    int get_height() const { return height_; }
+
+    /**
+     * Enable asynchronous binary readback for CPU consumers
+     */
+    void set_binary_readback(bool enabled) { binary_readback_ = enabled; }
+
+    /**
+     * Fetch the newest completed binary readback (NON-BLOCKING)
+     * @param out Destination (CV_8UC1, reallocated only on size change)
+     * @return true if a new image was copied into out
+     */
+    bool read_binary(cv::Mat& out);
+
+    /**
+     * Upload a reference image (CV_8UC1, non-zero = reference pixel)
+     * and start counting scattering against it
+     */
+    bool set_reference(const cv::Mat& reference);
+
+    /**
+     * Use the current binary result as the reference (GPU-side copy)
+     */
+    bool set_reference_from_current();
+
+    /**
+     * Stop scattering tracking (counts are kept until reset())
+     */
+    void clear_reference() { has_reference_ = false; }
+
+    bool has_reference() const { return has_reference_; }
+
+    /**
+     * Latest statistics that have finished on the GPU (NON-BLOCKING)
+     */
+    Stats get_stats();
+
+    /**
+     * Zero scattering counts and statistics
+     */
+    void reset();
+
+    /**
+     * Release all GL objects (call before the context is destroyed)
+     */
+    void release();
+
+private:
+    static constexpr int NUM_SLOTS = 2;  // Readback / upload ring depth
+
+    struct ReadbackSlot {
+        GLuint buffer{0};
+        GLsync fence{nullptr};
+        int64_t frame_index{-1};
+    };
+
+    bool init_program();
+    bool ensure_resources(int width, int height, int channels);
+    void destroy_resources();
+    void clear_counts();
+    static bool fence_done(GLsync& fence);
+
+    GLuint program_{0};
+    GLint bit_mask_location_{-1};
+    GLint track_scattering_location_{-1};
+
+    GLuint source_texture_{0};     // R8UI or RGB8UI raw frame
+    GLuint binary_texture_{0};     // R8 display image
+    GLuint reference_texture_{0};  // R8UI reference
+    GLuint count_texture_{0};      // R32UI scattering counts
+    GLuint stats_buffer_{0};       // SSBO written by the shader
+    GLuint upload_pbo_[NUM_SLOTS]{0, 0};
+    int upload_idx_{0};
+
+    ReadbackSlot stats_slots_[NUM_SLOTS];
+    ReadbackSlot binary_slots_[NUM_SLOTS];
+    int stats_write_{0};
+    int binary_write_{0};
+    Stats last_stats_;
+    int64_t last_binary_frame_{-1};
+
+    int width_{0};
+    int height_{0};
+    int channels_{0};
+    int64_t frame_index_{0};
+    bool program_failed_{false};
+    bool binary_readback_{false};
+    bool has_reference_{false};
+};
+
+/**
+ * GPU Event Scatter
+ *
+ * Builds binary frames on the GPU from packed events (EventScatterQueue):
+ * each window's events are copied into a persistently mapped SSBO ring and
+ * a compute shader stores one texel per event into an R8 image, after a
+ * clear pass of its own. The frame is sampled directly for display and
+ * never exists on the CPU; the per-pixel work of a frame upload becomes
+ * per-event work on the GPU.
+ *
+ * The ring is split into fenced segments, so the CPU only writes a
+ * segment the GPU has finished reading; windows larger than a segment are
+ * dispatched in several chunks. Requires OpenGL 4.4 (or 4.3 with
+ * ARB_buffer_storage and ARB_clear_texture); check is_supported(). All
+ * methods must be called on the thread owning the GL context.
+ */
+class GPUEventScatter {
+public:
+    static constexpr int NUM_SEGMENTS = 3;
+    static constexpr size_t SEGMENT_EVENTS = size_t(1) << 20;   // 4 MB of packed events per segment
+
+    GPUEventScatter() = default;
+    ~GPUEventScatter();
+
+    // Non-copyable
+    GPUEventScatter(const GPUEventScatter&) = delete;
+    GPUEventScatter& operator=(const GPUEventScatter&) = delete;
+
+    /**
+     * Check if the current GL context can run the scatter pass
+     */
+    static bool is_supported();
+
+    /**
+     * Compile the program, map and touch the event ring and create the frame ahead of the first window
+     * @return false if the program does not compile or the ring cannot be mapped
+     */
+    bool prepare(int width, int height);
+
+    /**
+     * Clear the frame and scatter one window of packed events into it
+     * @param events Packed events (EventScatterQueue::pack)
+     * @param count Number of events
+     * @param width Frame width
+     * @param height Frame height
+     * @return true if the frame was rebuilt
+     */
+    bool scatter(const uint32_t* events, size_t count, int width, int height);
+
+    /**
+     * Binary frame (R8, 0/255, swizzled to gray) for direct display
+     */
+    GLuint get_texture() const { return frame_texture_; }
+
+    int get_width() const { return width_; }
+    int get_height() const { return height_; }
+
+    /**
+     * Events scattered into the current frame
+     */
+    size_t get_frame_events() const { return frame_events_; }
+
+    /**
+     * Release all GL objects (call before the context is destroyed)
+     */
+    void release();
+
+private:
+    bool init_program();
+    bool ensure_ring();
+    bool ensure_frame(int width, int height);
+    void destroy_frame();
+
+    GLuint program_{0};
+    GLint event_count_location_{-1};
+
+    GLuint ring_buffer_{0};           // Persistently mapped SSBO, NUM_SEGMENTS * SEGMENT_EVENTS words
+    uint32_t* ring_ptr_{nullptr};
+    GLsync segment_fences_[NUM_SEGMENTS]{nullptr, nullptr, nullptr};
+    int segment_{0};
+
+    GLuint frame_texture_{0};         // R8 frame, written as an image
+    int width_{0};
+    int height_{0};
+    size_t frame_events_{0};
+    bool program_failed_{false};
+};
+
+/**
+ * Shader-Based Binary Display
+ *
+ * Display path for GL 3.0 contexts: the raw frame is uploaded once as an
+ * integer texture (R8UI / RGB8UI via PBO) and a GLSL 1.30 fragment shader
+ * does the bit tests and colouring into an RGBA8 texture for ImGui::Image.
+ * Pixels with only bit 1, only bit 2 or both get their own colours; with a
+ * reference set, active pixels outside it are drawn as scattering and
+ * reference pixels that stayed dark as missing.
+ *
+ * Nothing is extracted on the CPU for display. All methods must be called
+ * on the thread owning the GL context.
+ */
+class GPUBinaryDisplay {
+public:
+    struct Style {
+        uint8_t bit1_mask{0};
+        uint8_t bit2_mask{0};
+        float bit1_color[3]{0.3f, 0.9f, 0.3f};
+        float bit2_color[3]{0.9f, 0.3f, 0.3f};
+        float both_color[3]{1.0f, 1.0f, 1.0f};
+        float reference_color[3]{0.15f, 0.25f, 0.6f};  // Reference pixel with no event (missing)
+        float scattering_color[3]{1.0f, 0.85f, 0.0f};  // Active pixel outside the reference
+        bool show_reference{true};
+    };
+
+    GPUBinaryDisplay() = default;
+    ~GPUBinaryDisplay();
+
+    // Non-copyable
+    GPUBinaryDisplay(const GPUBinaryDisplay&) = delete;
+    GPUBinaryDisplay& operator=(const GPUBinaryDisplay&) = delete;
+
+    /**
+     * Check if the current GL context can run the display shader
+     */
+    static bool is_supported();
+
+    /**
+     * Compile the shader and create the textures, framebuffer and PBOs ahead of the first frame
+     * @param channels Channels of the raw frames (1 or 3)
+     * @return false if the shader does not compile
+     */
+    bool prepare(int width, int height, int channels);
+
+    /**
+     * Upload a raw frame through the PBO ring
+     * @param frame Raw frame (CV_8UC1 or CV_8UC3, channel 0 is used)
+     * @return true if the frame was uploaded
+     */
+    bool upload(const cv::Mat& frame);
+
+    /**
+     * Colour the last uploaded frame into the display texture
+     * @return false if nothing has been uploaded or the shader failed
+     */
+    bool render(const Style& style);
+
+    /**
+     * Upload a reference image (CV_8UC1 of the frame size, non-zero = reference pixel)
+     */
+    bool set_reference(const cv::Mat& reference);
+
+    void clear_reference() { has_reference_ = false; }
+    bool has_reference() const { return has_reference_; }
+
+    /**
+     * Coloured result (RGBA8) for direct display
+     */
+    GLuint get_texture() const { return output_texture_; }
+
+    int get_width() const { return width_; }
+    int get_height() const { return height_; }
+
+    /**
+     * Release all GL objects (call before the context is destroyed)
+     */
+    void release();
+
+private:
+    static constexpr int NUM_PBOS = 2;
+
+    bool init_program();
+    bool ensure_resources(int width, int height, int channels);
+    void destroy_resources();
+
+    GLuint program_{0};
+    GLuint vertex_array_{0};       // Empty; the fullscreen triangle comes from gl_VertexID
+    GLint bit1_mask_location_{-1};
+    GLint bit2_mask_location_{-1};
+    GLint show_reference_location_{-1};
+    GLint color_locations_[5]{-1, -1, -1, -1, -1};  // bit1, bit2, both, reference, scattering
+
+    GLuint source_texture_{0};     // R8UI or RGB8UI raw frame
+    GLuint reference_texture_{0};  // R8UI reference
+    GLuint output_texture_{0};     // RGBA8 display image
+    GLuint framebuffer_{0};
+    GLuint upload_pbo_[NUM_PBOS]{0, 0};
+    int upload_idx_{0};
+
+    int width_{0};
+    int height_{0};
+    int channels_{0};
+    bool uploaded_{false};
+    bool program_failed_{false};
+    bool has_reference_{false};
+};
+
+/**
+ * GPU Scattering Overlay / Heatmap
+ *
+ * Shader counterpart of ScatteringAnalyzer::create_scattering_visualization
+ * and create_heatmap_visualization for the GPU pipeline: both views are
+ * drawn straight from the pipeline's textures into an RGBA8 texture, so no
+ * count image is converted, colour-mapped or uploaded on the CPU.
+ *
+ * The overlay paints live pixels outside the reference in the highlight
+ * colour. The heatmap maps count / max_count through a 256-entry JET
+ * colormap texture (the same table as cv::COLORMAP_JET); zero counts stay
+ * black. Needs GL 3.0; call on the thread owning the GL context.
+ */
+class GPUScatteringView {
+public:
+    enum class Mode {
+        OVERLAY = 0,
+        HEATMAP = 1
+    };
+
+    GPUScatteringView() = default;
+    ~GPUScatteringView();
+
+    // Non-copyable
+    GPUScatteringView(const GPUScatteringView&) = delete;
+    GPUScatteringView& operator=(const GPUScatteringView&) = delete;
+
+    /**
+     * Render a view of the pipeline's current state
+     * @param pipeline Source of the binary, reference and count textures
+     * @param mode Overlay or heatmap
+     * @param max_count Running maximum count the heatmap is normalised to
+     * @return true if the view texture was drawn
+     */
+    bool render(const GPUBinaryPipeline& pipeline, Mode mode, uint32_t max_count);
+
+    /**
+     * Set the overlay colour for scattering pixels (RGB, 0-1)
+     */
+    void set_highlight_color(float r, float g, float b);
+
+    /**
+     * Rendered view (RGBA8) for direct display
+     */
+    GLuint get_texture() const { return output_texture_; }
+
+    int get_width() const { return width_; }
+    int get_height() const { return height_; }
+
+    /**
+     * Release all GL objects (call before the context is destroyed)
+     */
+    void release();
+
+private:
+    bool init_program();
+    bool ensure_target(int width, int height);
+
+    GLuint program_{0};
+    GLuint vertex_array_{0};
+    GLuint colormap_texture_{0};   // 256 x 1 RGB8 JET table
+    GLint mode_location_{-1};
+    GLint max_count_location_{-1};
+    GLint track_scattering_location_{-1};
+    GLint highlight_location_{-1};
+    float highlight_[3]{1.0f, 0.0f, 1.0f};  // Magenta, as on the CPU path
+
+    GLuint output_texture_{0};
+    GLuint framebuffer_{0};
+    int width_{0};
+    int height_{0};
+    bool program_failed_{false};
+};
+
+/**
+ * GPU Compare View
+ *
+ * Composites a live display texture and a loaded image texture of the same
+ * size in one fragment pass: pixels lit in both, only live or only loaded
+ * each get a colour, the rest stay black. Reads the textures the viewer
+ * already shows, so nothing is composited or uploaded on the CPU per frame.
+ * Needs GL 3.0; call on the thread owning the GL context.
+ */
+class GPUCompareView {
+public:
+    struct Style {
+        float live_color[3]{0.2f, 0.9f, 0.2f};
+        float loaded_color[3]{0.9f, 0.2f, 0.2f};
+        float both_color[3]{1.0f, 1.0f, 1.0f};
+    };
+
+    GPUCompareView() = default;
+    ~GPUCompareView();
+
+    // Non-copyable
+    GPUCompareView(const GPUCompareView&) = delete;
+    GPUCompareView& operator=(const GPUCompareView&) = delete;
+
+    /**
+     * Render the overlay of two textures (a channel above half = lit)
+     * @param live_texture Live frame texture
+     * @param loaded_texture Loaded image texture (same size)
+     * @return true if the view texture was drawn
+     */
+    bool render(GLuint live_texture, GLuint loaded_texture, int width, int height, const Style& style);
+
+    /**
+     * Rendered view (RGBA8) for direct display
+     */
+    GLuint get_texture() const { return output_texture_; }
+
+    int get_width() const { return width_; }
+    int get_height() const { return height_; }
+
+    /**
+     * Release all GL objects (call before the context is destroyed)
+     */
+    void release();
+
+private:
+    bool init_program();
+    bool ensure_target(int width, int height);
+
+    GLuint program_{0};
+    GLuint vertex_array_{0};
+    GLint color_locations_[3]{-1, -1, -1};  // live, loaded, both
+
+    GLuint output_texture_{0};
+    GLuint framebuffer_{0};
+    int width_{0};
+    int height_{0};
+    bool program_failed_{false};
+};
+
+/**
+ * GPU Pass Timer
+ *
+ * Measures named passes (texture upload, compute dispatch, ImGui draw, ...)
+ * on the GPU timeline with GL_TIME_ELAPSED queries. Each pass owns a small
+ * ring of query objects that are only read once the driver reports the
+ * result available, so timing never stalls the pipeline; results arrive
+ * one to RING_SIZE - 1 frames late. If a pass's ring is full of pending
+ * queries, that frame's measurement is skipped.
+ *
+ * Elapsed-time queries cannot nest, so passes must not overlap. Needs GL
+ * 3.3 or ARB_timer_query; without it every call is a no-op. Call on the
+ * thread owning the GL context.
+ */
+class GPUPassTimer {
+public:
+    static constexpr int MAX_PASSES = 8;
+    static constexpr int RING_SIZE = 4;
+
+    struct Pass {
+        std::string name;
+        double last_ms = 0.0;    // Most recent result
+        double avg_ms = 0.0;     // Exponential moving average (~32 samples)
+        double max_ms = 0.0;     // Since start
+        uint64_t samples = 0;
+        uint64_t skipped = 0;    // Frames not measured because every query was pending
+    };
+
+    struct Sample {
+        int pass;
+        uint64_t elapsed_ns;
+    };
+
+    GPUPassTimer() = default;
+    ~GPUPassTimer();
+
+    // Non-copyable
+    GPUPassTimer(const GPUPassTimer&) = delete;
+    GPUPassTimer& operator=(const GPUPassTimer&) = delete;
+
+    /**
+     * Check for GL_TIME_ELAPSED support (GL 3.3 or ARB_timer_query)
+     */
+    static bool is_supported();
+
+    /**
+     * Register a pass (before timing starts)
+     * @return Pass index for begin(), or -1 if MAX_PASSES are registered
+     */
+    int add_pass(const std::string& name);
+
+    /**
+     * Start timing a pass (no-op if unsupported or another pass is open)
+     */
+    void begin(int pass);
+
+    /**
+     * Stop timing the open pass
+     */
+    void end();
+
+    /**
+     * Read every available result without blocking (call once per frame)
+     * @return Results completed by this call, oldest first per pass
+     */
+    const std::vector<Sample>& collect();
+
+    const std::vector<Pass>& get_passes() const { return passes_; }
+
+    /**
+     * Release all query objects (call before the context is destroyed)
+     */
+    void release();
+
+private:
+    struct Ring {
+        GLuint queries[RING_SIZE]{};
+        bool pending[RING_SIZE]{};
+        int next = 0;  // Slot the next begin() uses (oldest pending when the ring is full)
+    };
+
+    bool init();
+    void record(int pass, uint64_t elapsed_ns);
+
+    std::vector<Pass> passes_;
+    std::vector<Ring> rings_;
+    std::vector<Sample> samples_;
+    int open_pass_{-1};
+    int supported_{-1};  // -1 = not checked yet
+};
+
 } // namespace gpu
 } // namespace video
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "video/binary_frame.h"
+
+namespace video {
+
+/**
+ * Known hot pixels from a dark-frame calibration (.rthp)
+ *
+ * A 32-byte FileHeader followed by the mask's BinaryFrame words (height
+ * rows of words_per_row little-endian 64-bit words, LSB = leftmost pixel),
+ * as in the burst format: a 1280x720 mask is 115 KB and loads with one read.
+ */
+namespace hot_pixel_file {
+
+constexpr char MAGIC[8] = {'R', 'T', 'C', 'H', 'O', 'T', '0', '1'};
+constexpr uint32_t VERSION = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint16_t width;
+    uint16_t height;
+    uint32_t words_per_row;
+    uint32_t pixel_count;      // Hot pixels in the mask
+    uint32_t duration_ms;      // Dark integration time
+    float threshold_hz;        // Rate above which a pixel was marked
+};
+static_assert(sizeof(FileHeader) == 32, "FileHeader must stay 32 bytes");
+
+inline bool is_valid(const FileHeader& header) {
+    return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+           header.words_per_row == (header.width + 63u) / 64u;
+}
+
+} // namespace hot_pixel_file
+
+/**
+ * Calibration a mask was derived from
+ */
+struct HotPixelMaskInfo {
+    uint32_t duration_ms = 0;
+    float threshold_hz = 0.0f;
+    uint32_t pixel_count = 0;
+};
+
+/**
+ * Write a hot pixel mask
+ * @param path Output file
+ * @param mask Set = known hot pixel
+ * @param info Calibration details stored with it (pixel_count is taken from the mask)
+ * @return false if the file could not be written
+ */
+bool save_hot_pixel_mask(const std::string& path, const BinaryFrame& mask, const HotPixelMaskInfo& info);
+
+/**
+ * Read a hot pixel mask
+ * @param path Input file
+ * @param mask Output, sized from the file
+ * @param info Output
+ * @return false if missing, not a mask file or truncated
+ */
+bool load_hot_pixel_mask(const std::string& path, BinaryFrame& mask, HotPixelMaskInfo& info);
+
+} // namespace video
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <metavision/sdk/base/utils/timestamp.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "video/binary_frame.h"
+
+namespace video {
+
+/**
+ * Row or column that keeps firing as a whole
+ */
+struct LineDefect {
+    bool column = false;                // false = row
+    int index = 0;                      // Row (y) or column (x) in frame coordinates
+    int64_t first_ts = 0;               // Sensor time of the frame it was listed in (us)
+    int64_t last_ts = 0;                // ... and the latest
+    uint32_t frames_flagged = 0;        // Frames it stood out in since configure() / clear_defects()
+    uint32_t streak = 0;                // Consecutive frames up to the latest one (0 = quiet now)
+    float fill = 0.0f;                  // Fraction of its pixels set in the latest flagged frame
+};
+
+/**
+ * Row/column readout defect detector on bit-packed frames
+ *
+ * A failing row or column driver makes a whole line fire at once, which a
+ * per-pixel monitor (PixelRateMonitor) sees as many unrelated pixels. Each
+ * frame is projected onto its rows and columns: row sums are per-word
+ * popcounts, column sums come from a vertical bit-sliced counter (each
+ * packed row is added into COUNTER_BITS bit planes with a ripple carry,
+ * 64 columns per word operation, and the planes are spilled into column
+ * sums once per frame). A line is flagged when its sum exceeds both
+ * median + sigma * 1.4826 * MAD of its projection and min_fill of its
+ * length; the robust threshold ignores the defects themselves and the
+ * fill floor keeps sparse frames (MAD 0) from flagging every active line.
+ *
+ * Lines flagged in at least min_frames frames are listed with persistence
+ * counts; the list is sticky until clear_defects(). The first MAX_DEFECTS
+ * are kept.
+ *
+ * process() must be called from a single thread (the accumulation thread,
+ * from the frame callback); the defect list and settings may be used from
+ * any thread.
+ */
+class LineDefectDetector {
+public:
+    static constexpr int COUNTER_BITS = 8;   // Bit planes per column counter (255 rows between spills)
+    static constexpr int MAX_DEFECTS = 256;
+
+    LineDefectDetector() = default;
+    ~LineDefectDetector() = default;
+
+    // Non-copyable
+    LineDefectDetector(const LineDefectDetector&) = delete;
+    LineDefectDetector& operator=(const LineDefectDetector&) = delete;
+
+    /**
+     * Set frame geometry and clear persistence and defects (not while process() runs)
+     * @param width Frame width
+     * @param height Frame height
+     */
+    void configure(int width, int height);
+
+    /**
+     * Project a packed frame and update persistence
+     * @param ts Sensor time closing the frame
+     * @param frame Packed frame of the configured size (others are ignored)
+     */
+    void process(Metavision::timestamp ts, const BinaryFrame& frame);
+
+    /**
+     * Pack channel 0 of an 8-bit frame (non-zero = set), then process it
+     */
+    void process(Metavision::timestamp ts, const cv::Mat& frame);
+
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Set the robust threshold
+     * @param sigma MADs (scaled to standard deviations) above the median
+     * @param min_fill Fraction of the line that must fire (0-1)
+     * @param min_frames Frames a line must be flagged in before it is listed
+     */
+    void set_threshold(float sigma, float min_fill, int min_frames);
+    float get_sigma() const { return sigma_.load(std::memory_order_relaxed); }
+    float get_min_fill() const { return min_fill_.load(std::memory_order_relaxed); }
+    int get_min_frames() const { return min_frames_.load(std::memory_order_relaxed); }
+
+    /**
+     * Forget persistence and listed defects (applied on the next frame)
+     */
+    void clear_defects() { clear_requested_ = true; }
+
+    /**
+     * Lines listed since configure() or clear_defects(), including those past MAX_DEFECTS
+     */
+    int get_defect_count() const { return defect_count_.load(std::memory_order_relaxed); }
+
+    /**
+     * Frames projected since configure()
+     */
+    int64_t get_frames_processed() const { return frames_processed_.load(std::memory_order_relaxed); }
+
+    /**
+     * Copy the defect list (first MAX_DEFECTS, in the order they were listed)
+     * @param out Output (keeps its capacity between calls)
+     */
+    void get_defects(std::vector<LineDefect>& out) const;
+
+private:
+    static constexpr int32_t UNLISTED = -1;
+    static constexpr int32_t UNLISTED_OVERFLOW = -2;   // Counted past MAX_DEFECTS
+
+    struct LineState {
+        uint32_t frames_flagged = 0;
+        uint32_t streak = 0;
+        int32_t listed = UNLISTED;      // Position in defects_ (or UNLISTED / UNLISTED_OVERFLOW)
+    };
+
+    /**
+     * Add a packed row into the bit-sliced column counters
+     */
+    void add_row(const uint64_t* row);
+
+    /**
+     * Move the bit-sliced counters into column_sums_ and clear them
+     */
+    void spill_counters();
+
+    /**
+     * Flag lines above the robust threshold of their projection and update persistence
+     */
+    void update_lines(const std::vector<uint32_t>& sums, int length, bool column, std::vector<LineState>& states,
+                      Metavision::timestamp ts);
+
+    int width_ = 0;
+    int height_ = 0;
+    std::atomic<bool> enabled_{false};
+    std::atomic<float> sigma_{8.0f};
+    std::atomic<float> min_fill_{0.25f};
+    std::atomic<int> min_frames_{3};
+    std::atomic<bool> clear_requested_{false};
+    std::atomic<int> defect_count_{0};
+    std::atomic<int64_t> frames_processed_{0};
+
+    // Accumulation thread only
+    BinaryFrame packed_;                   // For cv::Mat input
+    std::vector<uint64_t> planes_;         // COUNTER_BITS planes of words_per_row words
+    int rows_in_planes_ = 0;
+    std::vector<uint32_t> row_sums_;
+    std::vector<uint32_t> column_sums_;
+    std::vector<uint32_t> scratch_;        // Median / MAD selection
+    std::vector<LineState> row_states_;
+    std::vector<LineState> column_states_;
+
+    mutable std::mutex defects_mutex_;
+    std::vector<LineDefect> defects_;
+};
+
+} // namespace video
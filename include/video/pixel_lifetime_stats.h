@@ -0,0 +1,147 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace video {
+
+/**
+ * Per-pixel counters of one sensor over its whole life, in a memory-mapped file
+ *
+ * One file per sensor (file_name() of its serial) holds a FileHeader and a
+ * row-major PixelRecord per pixel. The file is mapped read-write, so a
+ * merge only pages in the records it touches and the OS writes them back;
+ * nothing is loaded up front, and the layout is plain enough to query from
+ * other tools (e.g. a numpy memmap at HEADER_BYTES).
+ *
+ * A session merges its cumulative totals (scattering counts, hot-pixel
+ * flags, toggle counts, exposure time) at checkpoints and at its end. The
+ * totals merged so far are remembered, so each merge adds only what
+ * changed since the previous one; a source whose counts went down was
+ * restarted and counts from zero again.
+ *
+ * Not thread-safe: open, merge and read from one thread.
+ *
+ * **Usage:**
+ * ```cpp
+ * PixelLifetimeStats lifetime;
+ * lifetime.open(dir + "/" + PixelLifetimeStats::file_name(serial), serial, width, height);
+ * totals.scattering = &snapshot->scattering_count;
+ * lifetime.merge(totals);                    // Every checkpoint, and at the end
+ * ```
+ */
+class PixelLifetimeStats {
+public:
+    static constexpr uint32_t MAGIC = 0x534C5452;   // "RTLS"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t HEADER_BYTES = 128;
+
+    struct FileHeader {
+        uint32_t magic = MAGIC;
+        uint32_t version = VERSION;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t header_bytes = HEADER_BYTES;
+        uint32_t record_bytes = 0;          // sizeof(PixelRecord)
+        uint64_t sessions = 0;              // Sessions that merged anything
+        uint64_t exposure_us = 0;           // Streaming time over all sessions
+        int64_t created_unix_s = 0;
+        int64_t updated_unix_s = 0;         // Last merge
+        char serial[32] = {};               // Sensor serial (truncated, zero-padded)
+    };
+
+    struct PixelRecord {
+        uint64_t exposure_us = 0;           // Time the pixel was streamed
+        uint64_t scattering = 0;            // Frames it scattered in
+        uint64_t toggles = 0;               // Frame-to-frame toggles (PixelToggleAnalyzer)
+        uint32_t hot_flags = 0;             // Sessions the hot pixel monitor flagged it in
+        uint32_t reserved = 0;
+    };
+
+    /**
+     * Cumulative totals of the current session (null / empty = not collected)
+     */
+    struct SessionTotals {
+        int64_t exposure_us = 0;                        // Streaming time so far
+        const cv::Mat* scattering = nullptr;            // CV_32SC1 per-pixel scattering counts
+        const std::vector<uint32_t>* toggles = nullptr; // Row-major per-pixel toggle counts
+        std::vector<cv::Point> hot_pixels;              // Pixels flagged hot so far
+    };
+
+    PixelLifetimeStats() = default;
+    ~PixelLifetimeStats();
+
+    // Non-copyable
+    PixelLifetimeStats(const PixelLifetimeStats&) = delete;
+    PixelLifetimeStats& operator=(const PixelLifetimeStats&) = delete;
+
+    /**
+     * File name for a sensor's statistics ("lifetime_<serial>.rtls", unsafe characters replaced)
+     */
+    static std::string file_name(const std::string& serial);
+
+    /**
+     * Map a sensor's file, creating it (zeroed) if it does not exist
+     * @param path File path (the directory must exist)
+     * @param serial Sensor serial, stored in a new file
+     * @param width Frame width (must match an existing file)
+     * @param height Frame height
+     * @return false if the file cannot be mapped or belongs to another geometry
+     */
+    bool open(const std::string& path, const std::string& serial, int width, int height);
+
+    /**
+     * Write back and unmap the file
+     */
+    void close();
+
+    bool is_open() const { return base_ != nullptr; }
+
+    /**
+     * Add what changed since the previous merge of this session and write it back
+     * @param totals Cumulative session totals; sizes other than the file's are skipped
+     * @return false if not open
+     */
+    bool merge(const SessionTotals& totals);
+
+    const FileHeader& header() const { return *reinterpret_cast<const FileHeader*>(base_); }
+    int width() const { return is_open() ? static_cast<int>(header().width) : 0; }
+    int height() const { return is_open() ? static_cast<int>(header().height) : 0; }
+
+    /**
+     * Records of a row (width() entries, mapped in place)
+     */
+    const PixelRecord* row(int y) const { return records() + static_cast<size_t>(y) * header().width; }
+
+    /**
+     * Lifetime record of one pixel (mapped in place)
+     */
+    const PixelRecord& record(int x, int y) const { return row(y)[x]; }
+
+private:
+    PixelRecord* records() const { return reinterpret_cast<PixelRecord*>(base_ + HEADER_BYTES); }
+    FileHeader& mutable_header() { return *reinterpret_cast<FileHeader*>(base_); }
+
+    bool map_file(const std::string& path, size_t bytes);
+    void flush();
+
+    uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#endif
+
+    // Session totals already merged
+    bool session_counted_ = false;
+    int64_t merged_exposure_us_ = 0;
+    std::vector<uint32_t> merged_scattering_;
+    std::vector<uint32_t> merged_toggles_;
+    std::unordered_set<int64_t> merged_hot_;
+};
+
+} // namespace video
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "video/binary_frame.h"
+
+namespace video {
+
+/**
+ * Pixel whose event rate stands out from its neighbourhood
+ */
+struct FlaggedPixel {
+    int x = 0;                          // Frame column
+    int y = 0;                          // Frame row
+    int64_t flagged_ts = 0;             // Sensor time of the event that crossed the threshold (us)
+    float events_per_s = 0.0f;          // Pixel rate when flagged
+    float neighbour_events_per_s = 0.0f;  // Mean rate of its 8 neighbours when flagged
+};
+
+/**
+ * Online per-pixel event-rate estimator that flags emerging hot pixels
+ *
+ * Each pixel keeps a uint16 exponentially decaying event count: every event
+ * adds ONE (1.0 in 8.8 fixed point, saturating) and the count halves every
+ * half-life. Decay is lazy: a uint16 tick stamp per pixel records when the
+ * count was last brought up to date, and the next event of that pixel
+ * multiplies by a Q16 2^-(ticks / TICKS_PER_HALF_LIFE) table first. The
+ * count is then about the number of events in the last half-life / ln 2.
+ *
+ * When a pixel's count reaches MIN_EVENTS, its 8 neighbours are decayed
+ * (read-only) and averaged to lambda; the pixel is flagged once its count
+ * exceeds the Poisson bound lambda + sigma * sqrt(max(lambda, 1)). Flags are sticky
+ * until clear_flags(), and the first MAX_FLAGGED are listed with the time
+ * they were raised, so a pixel going bad mid-run is reported as it happens
+ * rather than after the fact from the heatmap maximum. Pixels of a known
+ * hot mask (set_known_hot(), from a dark-frame calibration) are never
+ * tested, so flags and the list only hold new failures.
+ *
+ * **PERFORMANCE:** O(events): a LUT multiply and a saturating add per
+ * event, plus 8 neighbour reads only for pixels active enough to be
+ * candidates. Each update() also scrubs one row of counts idle for more
+ * than the table spans, so tick stamps never alias after they wrap.
+ *
+ * update() must be called from a single thread (the accumulation thread);
+ * the flag list and settings may be used from any thread.
+ */
+class PixelRateMonitor {
+public:
+    static constexpr int TICKS_PER_HALF_LIFE = 8;
+    static constexpr int MAX_FLAGGED = 256;
+
+    PixelRateMonitor() = default;
+    ~PixelRateMonitor() = default;
+
+    // Non-copyable
+    PixelRateMonitor(const PixelRateMonitor&) = delete;
+    PixelRateMonitor& operator=(const PixelRateMonitor&) = delete;
+
+    /**
+     * Set frame geometry and clear rates and flags (not while update() runs)
+     * @param width Frame width
+     * @param height Frame height
+     * @return false if the size is invalid (monitor stays off)
+     */
+    bool configure(int width, int height);
+
+    /**
+     * Update rates from a batch of events and flag pixels that stand out
+     * @param begin First event (frame coordinates)
+     * @param end One past last event
+     */
+    void update(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Enable or disable updates (takes effect on the next batch; rates restart when re-enabled)
+     */
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Set the half-life of the rate estimate (applied on the next batch, rates restart)
+     * @param half_life_ms Half-life in milliseconds
+     */
+    void set_half_life_ms(int half_life_ms);
+    int get_half_life_ms() const { return half_life_ms_.load(std::memory_order_relaxed); }
+
+    /**
+     * Set how far above its neighbourhood a pixel must be (Poisson standard deviations)
+     */
+    void set_sigma(float sigma) { sigma_ = sigma > 0.0f ? sigma : 1.0f; }
+    float get_sigma() const { return sigma_.load(std::memory_order_relaxed); }
+
+    /**
+     * Forget all flags (applied on the next batch)
+     */
+    void clear_flags() { clear_requested_ = true; }
+
+    /**
+     * Exclude the pixels of a calibrated hot pixel mask from flagging (applied on the next batch)
+     * @param mask Set = known hot; another size than configured (or empty) excludes nothing
+     */
+    void set_known_hot(const BinaryFrame& mask);
+
+    /**
+     * Pixels excluded as known hot
+     */
+    int get_known_count() const { return known_count_.load(std::memory_order_relaxed); }
+
+    /**
+     * Pixels flagged since configure() or clear_flags(), including those past MAX_FLAGGED
+     */
+    int get_flagged_count() const { return flagged_count_.load(std::memory_order_relaxed); }
+
+    /**
+     * Copy the flag list (first MAX_FLAGGED, in the order they were raised)
+     * @param out Output (keeps its capacity between calls)
+     */
+    void get_flagged(std::vector<FlaggedPixel>& out) const;
+
+private:
+    static constexpr uint16_t ONE = 256;   // One event in 8.8 fixed point
+    static constexpr int MIN_EVENTS = 8;   // Counts below this are never tested
+    static constexpr uint8_t FLAGGED = 1;
+    static constexpr uint8_t KNOWN_HOT = 2;
+    static constexpr int LUT_TICKS = 16 * TICKS_PER_HALF_LIFE;  // 2^-16 of a full count rounds to 0
+
+    /**
+     * Bring a stored count up to now_tick (read-only)
+     */
+    uint32_t decayed(size_t index, uint16_t now_tick) const;
+
+    /**
+     * Test a pixel against its neighbourhood and flag it
+     */
+    void test_pixel(int x, int y, uint32_t count, uint16_t now_tick, int64_t ts);
+
+    /**
+     * Zero rates and stamps for a new tick length (flags are kept)
+     */
+    void restart(int half_life_ms);
+
+    /**
+     * Mark the known hot pixels in flags_, replacing the previous set (known_mutex_ held)
+     */
+    void apply_known_hot();
+
+    int width_ = 0;
+    int height_ = 0;
+    std::atomic<bool> enabled_{false};
+    std::atomic<int> half_life_ms_{1000};
+    std::atomic<float> sigma_{6.0f};
+    std::atomic<bool> clear_requested_{false};
+    std::atomic<int> flagged_count_{0};
+
+    // Accumulation thread only
+    std::vector<uint16_t> rates_;          // width_ * height_, 8.8 fixed-point decaying counts
+    std::vector<uint16_t> stamps_;         // Tick of the last update of each rate (wraps)
+    std::vector<uint8_t> flags_;           // FLAGGED or KNOWN_HOT: never tested again
+    std::array<uint32_t, LUT_TICKS> decay_lut_{};  // Q16 factor for an age of n ticks (n >= LUT_TICKS: 0)
+    int64_t tick_us_ = 0;                  // 0 = not started (restart on the next batch)
+    int applied_half_life_ms_ = 0;
+    int64_t tick_end_ts_ = -1;             // End of the current tick (us)
+    uint16_t now_tick_ = 0;
+    int64_t latest_ts_ = -1;
+    int scrub_row_ = 0;
+
+    mutable std::mutex flagged_mutex_;
+    std::vector<FlaggedPixel> flagged_;
+
+    // Known hot hand-off, guarded by known_mutex_
+    std::mutex known_mutex_;
+    BinaryFrame known_hot_;
+    std::atomic<bool> known_changed_{false};
+    std::atomic<int> known_count_{0};
+};
+
+} // namespace video
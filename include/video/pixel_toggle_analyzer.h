@@ -0,0 +1,169 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <metavision/sdk/base/utils/timestamp.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "video/binary_frame.h"
+
+namespace video {
+
+/**
+ * Pixel classes of the latest completed window
+ */
+struct ToggleClasses {
+    int64_t stuck = 0;                  // On for at least stuck_frames consecutive frames at the window end
+    int64_t flickering = 0;             // Toggled at least flicker_rate per frame, not stuck
+    int64_t normal = 0;                 // Set in some frame of the window, neither of the above
+    int64_t windows = 0;                // Windows classified since configure() / clear()
+    int64_t window_end_ts = 0;          // Sensor time closing the latest window (us)
+    int window_frames = 0;              // Frames in the latest window
+};
+
+/**
+ * Stuck / flickering pixel classifier on consecutive bit-packed frames
+ *
+ * A stuck pixel stays set frame after frame; a flickering one toggles
+ * between frames. Both look like an ordinary busy pixel to a per-frame
+ * count, so each frame is XORed with the previous one and two saturating
+ * per-pixel counters are kept as bit-sliced planes (COUNTER_BITS planes of
+ * one word per 64 pixels): the toggle count of the window, incremented
+ * where the XOR is set, and the on-streak, cleared where the frame is
+ * clear and incremented where it is set. A counter that reaches all ones
+ * holds there. Every update is a few word operations per 64 pixels in one
+ * pass over frames that were just packed.
+ *
+ * Every window_frames frames the planes are compared against the
+ * thresholds (bit-sliced, 64 pixels at a time), the class masks and counts
+ * are published, the toggle counters are added to per-pixel session
+ * totals and restart; the on-streaks carry over, so a pixel stuck across
+ * windows stays stuck.
+ *
+ * process() must be called from a single thread (the accumulation thread,
+ * from the frame callback); results and settings may be used from any
+ * thread.
+ */
+class PixelToggleAnalyzer {
+public:
+    static constexpr int COUNTER_BITS = 8;   // Bit planes per counter (saturate at 255)
+    static constexpr int MAX_COUNT = (1 << COUNTER_BITS) - 1;
+
+    PixelToggleAnalyzer() = default;
+    ~PixelToggleAnalyzer() = default;
+
+    // Non-copyable
+    PixelToggleAnalyzer(const PixelToggleAnalyzer&) = delete;
+    PixelToggleAnalyzer& operator=(const PixelToggleAnalyzer&) = delete;
+
+    /**
+     * Set frame geometry and clear counters and results (not while process() runs)
+     * @param width Frame width
+     * @param height Frame height
+     */
+    void configure(int width, int height);
+
+    /**
+     * Update the counters from a packed frame, classifying at the end of each window
+     * @param ts Sensor time closing the frame
+     * @param frame Packed frame of the configured size (others are ignored)
+     */
+    void process(Metavision::timestamp ts, const BinaryFrame& frame);
+
+    /**
+     * Pack channel 0 of an 8-bit frame (non-zero = set), then process it
+     */
+    void process(Metavision::timestamp ts, const cv::Mat& frame);
+
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Set the classification (applied from the next window)
+     * @param window_frames Frames per window (2 to MAX_COUNT)
+     * @param stuck_frames Consecutive set frames that make a pixel stuck (1 to MAX_COUNT)
+     * @param flicker_rate Toggles per frame of the window that make a pixel flicker (0-1)
+     */
+    void set_threshold(int window_frames, int stuck_frames, float flicker_rate);
+    int get_window_frames() const { return window_frames_.load(std::memory_order_relaxed); }
+    int get_stuck_frames() const { return stuck_frames_.load(std::memory_order_relaxed); }
+    float get_flicker_rate() const { return flicker_rate_.load(std::memory_order_relaxed); }
+
+    /**
+     * Restart counters and results (applied on the next frame)
+     */
+    void clear() { clear_requested_ = true; }
+
+    /**
+     * Pixels toggled between the two latest frames
+     */
+    int64_t get_last_toggles() const { return last_toggles_.load(std::memory_order_relaxed); }
+
+    /**
+     * Frames processed since configure()
+     */
+    int64_t get_frames_processed() const { return frames_processed_.load(std::memory_order_relaxed); }
+
+    /**
+     * Class counts of the latest completed window
+     */
+    ToggleClasses get_classes() const;
+
+    /**
+     * Copy the class masks of the latest completed window
+     * @return false if no window has completed
+     */
+    bool get_masks(BinaryFrame& stuck, BinaryFrame& flickering) const;
+
+    /**
+     * Copy the per-pixel toggle totals of the windows completed since configure() / clear()
+     * @param out Row-major, width * height entries (keeps its capacity between calls)
+     */
+    void get_session_toggles(std::vector<uint32_t>& out) const;
+
+private:
+    /**
+     * Saturating increment of the counters in planes where mask is set, for one word
+     */
+    static void increment(uint64_t* planes, size_t stride, uint64_t mask);
+
+    /**
+     * Mask of the counters in planes that are at least value, for one word
+     */
+    static uint64_t at_least(const uint64_t* planes, size_t stride, int value);
+
+    /**
+     * Compare the planes against the thresholds, publish and restart the window
+     */
+    void classify(Metavision::timestamp ts);
+
+    int width_ = 0;
+    int height_ = 0;
+    std::atomic<bool> enabled_{false};
+    std::atomic<int> window_frames_{100};
+    std::atomic<int> stuck_frames_{50};
+    std::atomic<float> flicker_rate_{0.2f};
+    std::atomic<bool> clear_requested_{false};
+    std::atomic<int64_t> last_toggles_{0};
+    std::atomic<int64_t> frames_processed_{0};
+
+    // Accumulation thread only
+    BinaryFrame packed_;                   // For cv::Mat input
+    BinaryFrame previous_;
+    bool has_previous_ = false;
+    std::vector<uint64_t> toggle_planes_;  // COUNTER_BITS planes of word_count words
+    std::vector<uint64_t> streak_planes_;
+    std::vector<uint64_t> active_;         // Set in some frame of the window
+    int frames_in_window_ = 0;
+    BinaryFrame stuck_scratch_;            // Built here, swapped into the results
+    BinaryFrame flicker_scratch_;
+
+    mutable std::mutex results_mutex_;
+    ToggleClasses classes_;
+    BinaryFrame stuck_mask_;
+    BinaryFrame flicker_mask_;
+    std::vector<uint32_t> session_toggles_;  // Toggle planes spilled at each window end
+};
+
+} // namespace video
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <metavision/sdk/base/utils/timestamp.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace video {
+
+class BinaryFrameAccumulator;
+
+/**
+ * Fused EVT 2.1 / EVT 3.0 decoder feeding the native binary accumulator
+ *
+ * Decodes raw device buffers (Camera::raw_data()) without materializing
+ * EventCD arrays. Both formats already carry events as row vectors: an
+ * EVT 2.1 word is a 32-pixel validity mask, an EVT 3.0 VECT_12/12/8 triple
+ * is one too. When the accumulator accepts_packed_input(), each vector goes
+ * into the packed frame as one or two masked word updates, so the cost is
+ * per raw word rather than per event. Otherwise (polarity planes, preview,
+ * event-count slicing, white background) events are decoded into a small
+ * cache-resident EventCD chunk and handed to process_events().
+ *
+ * Timestamps follow the SDK decoder: 64-bit with time-high wraparound and
+ * the same time shift (taken from the SDK decoder via set_time_shift(), or
+ * the first TIME_HIGH as the SDK does), so frames stay aligned with trigger
+ * events and ClockSync. Words split across buffers are carried over.
+ *
+ * Not thread-safe: decode() runs on the SDK decoding thread only.
+ */
+class RawEventDecoder {
+public:
+    enum class Format {
+        Unsupported = 0,
+        Evt21 = 1,      // 64-bit words, 32-pixel vectors
+        Evt3 = 2        // 16-bit words, stateful (row, vector base, time low/high)
+    };
+
+    static constexpr size_t CHUNK_EVENTS = 4096;   // EventCD chunk for accumulators without packed input
+
+    RawEventDecoder() = default;
+    ~RawEventDecoder() = default;
+
+    // Non-copyable
+    RawEventDecoder(const RawEventDecoder&) = delete;
+    RawEventDecoder& operator=(const RawEventDecoder&) = delete;
+
+    /**
+     * Map a device encoding name (I_HW_Identification::get_current_data_encoding_format) to a format
+     * @param encoding e.g. "EVT3" or "EVT21" (parameters after ';' are ignored)
+     */
+    static Format parse_format(const std::string& encoding);
+
+    static const char* format_name(Format format);
+
+    /**
+     * Set the stream format and sensor size, and forget all stream state
+     */
+    void configure(Format format, int width, int height);
+
+    /**
+     * Forget stream state (time base, carried bytes) when the device restarts
+     */
+    void reset();
+
+    Format get_format() const { return format_; }
+
+    /**
+     * Use the SDK decoder's time shift (subtracted from every timestamp)
+     */
+    void set_time_shift(Metavision::timestamp shift);
+    bool has_time_shift() const { return shift_set_; }
+
+    /**
+     * Decode one raw buffer into the accumulator
+     * @param data Raw bytes, as received from the device
+     * @param size Byte count (need not be a whole number of words)
+     * @param target Accumulator receiving the events
+     * @return CD events decoded
+     */
+    uint64_t decode(const uint8_t* data, size_t size, BinaryFrameAccumulator& target);
+
+    /**
+     * Timestamp of the last decoded word (shifted; -1 before the first TIME_HIGH)
+     */
+    Metavision::timestamp last_timestamp() const { return base_set_ ? time_ - shift_ : -1; }
+
+private:
+    template <class Sink>
+    uint64_t decode_words(const uint8_t* data, size_t size, Sink& sink, size_t& consumed);
+
+    template <class Sink>
+    uint64_t decode_evt21(const uint64_t* begin, const uint64_t* end, Sink& sink);
+
+    template <class Sink>
+    uint64_t decode_evt3(const uint16_t* begin, const uint16_t* end, Sink& sink, size_t& consumed);
+
+    /**
+     * Decode with the sink the accumulator supports, carrying a split word over
+     */
+    template <class Sink>
+    uint64_t decode_with(const uint8_t* data, size_t size, Sink& sink);
+
+    Format format_ = Format::Unsupported;
+    int width_ = 0;
+    int height_ = 0;
+
+    // Time base (unshifted), as the SDK decoders keep it
+    bool base_set_ = false;
+    bool shift_set_ = false;
+    Metavision::timestamp shift_ = 0;
+    uint64_t time_ = 0;
+
+    // EVT 3.0 state
+    int y_ = 0;
+    bool cd_row_ = false;       // Last row address was a CD row inside the sensor
+    int vector_x_ = 0;
+    int vector_p_ = 0;
+
+    std::vector<uint8_t> carry_;                  // Incomplete word(s) from the previous buffer
+    std::vector<Metavision::EventCD> chunk_;      // Fallback sink
+};
+
+} // namespace video
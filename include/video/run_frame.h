@@ -0,0 +1,159 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
+#include "video/binary_frame.h"
+#include "video/frame_ref.h"
+
+namespace video {
+
+/**
+ * Run-length binary image: per row, the sorted runs of set pixels
+ *
+ * Each run is a half-open column range [begin, end); runs in a row never
+ * overlap or touch. At low event rates a frame is a few hundred runs, so
+ * counting and combining cost O(runs) where BinaryFrame costs
+ * O(width * height / 64) regardless of content. Rows of the other operand
+ * are binary searched, so a dense reference does not make a sparse live
+ * frame slow.
+ *
+ * Dense frames are cheaper bit-packed; prefer() picks the representation
+ * from a frame's active pixel count (FrameTiming::active_pixels).
+ *
+ * **Usage:**
+ * ```cpp
+ * if (RunFrame::prefer(timing.active_pixels, frame.size())) {
+ *     live.assign_masked(frame, 0xFF, ref.row_bands(), ref.block_map());   // Empty bands and blocks are skipped
+ *     RunFrame::bitwise_andnot(live, reference, scattering);
+ * }
+ * ```
+ */
+class RunFrame {
+public:
+    struct Run {
+        int32_t begin = 0;   // First set column
+        int32_t end = 0;     // One past the last
+    };
+
+    /**
+     * Active pixels per frame pixel at or below which runs beat packed words
+     *
+     * A packed pass touches every word (1 per 64 pixels); runs cost a few
+     * word operations each and number at most the active pixels.
+     */
+    static constexpr double MAX_DENSITY = 1.0 / 256;
+
+    RunFrame() = default;
+
+    /**
+     * (Re)size to an empty frame
+     */
+    void create(int width, int height);
+
+    /**
+     * Remove all runs (size kept)
+     */
+    void clear();
+
+    /**
+     * Convert a packed frame (e.g. BinaryFrameAccumulator::packed_frame())
+     * @param bits Packed frame
+     * @param bands Rows that may hold set pixels (the accumulator's row_bands()); others become empty
+     */
+    void assign(const BinaryFrame& bits, const RowBands& bands = RowBands());
+
+    /**
+     * Convert channel 0 of an 8-bit image, setting pixels where (value & bit_mask) != 0
+     * @param mat 8-bit image with any channel count
+     * @param bit_mask Bits that mark a pixel set
+     * @param bands Rows that may differ from the frame background (FrameRef::row_bands())
+     * @param blocks Blocks that may hold set pixels (FrameRef::block_map(), nullptr = all)
+     * @return false if mat is empty, not 8-bit or bit_mask is 0
+     */
+    bool assign_masked(const cv::Mat& mat, uint8_t bit_mask, const RowBands& bands = RowBands(),
+                       const BlockMap* blocks = nullptr);
+
+    /**
+     * Expand to a packed frame (reallocated only if size differs)
+     */
+    void to_binary(BinaryFrame& out) const;
+
+    /**
+     * Unpack to CV_8UC1 (0 / 255)
+     */
+    void to_mat(cv::Mat& out) const;
+
+    // Row access
+    const Run* row_begin(int y) const { return runs_.data() + row_start_[y]; }
+    const Run* row_end(int y) const { return runs_.data() + row_start_[y + 1]; }
+    size_t run_count() const { return runs_.size(); }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    cv::Size size() const { return cv::Size(width_, height_); }
+    bool empty() const { return row_start_.empty(); }
+
+    /**
+     * Count set pixels
+     */
+    int64_t count() const;
+
+    /**
+     * Call fn(x, y) for every set pixel in raster order
+     */
+    template <typename Fn>
+    void for_each_pixel(Fn&& fn) const {
+        for (int y = 0; y < height_; ++y) {
+            for (const Run* run = row_begin(y); run != row_end(y); ++run) {
+                for (int x = run->begin; x < run->end; ++x) {
+                    fn(x, y);
+                }
+            }
+        }
+    }
+
+    /**
+     * out = a & ~b (out must not be a or b)
+     * @return false if sizes differ or out aliases an input
+     */
+    static bool bitwise_andnot(const RunFrame& a, const RunFrame& b, RunFrame& out);
+
+    /**
+     * out = a | b, for overlays (out must not be a or b)
+     * @return false if sizes differ or out aliases an input
+     */
+    static bool bitwise_or(const RunFrame& a, const RunFrame& b, RunFrame& out);
+
+    /**
+     * Count of (a & ~b) without materializing the result
+     * @return Number of pixels set in a but not in b (-1 if sizes differ)
+     */
+    static int64_t count_andnot(const RunFrame& a, const RunFrame& b);
+
+    /**
+     * Count all four combinations of a and b (BinaryFrame::overlap on runs)
+     * @return false if sizes differ
+     */
+    static bool overlap(const RunFrame& a, const RunFrame& b, BinaryFrame::Overlap& out);
+
+    /**
+     * Check if a frame is sparse enough for runs (at most MAX_DENSITY active)
+     * @param active_pixels Set pixels of the frame (-1 = not counted: false)
+     */
+    static bool prefer(int64_t active_pixels, cv::Size size) {
+        return active_pixels >= 0 && active_pixels <= static_cast<double>(size.area()) * MAX_DENSITY;
+    }
+
+private:
+    void begin_rows(int width, int height);   // Resize and drop all runs before rows are appended
+    void push(int32_t begin, int32_t end) { runs_.push_back({begin, end}); }
+    void end_row(int y) { row_start_[y + 1] = static_cast<uint32_t>(runs_.size()); }
+
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<Run> runs_;
+    std::vector<uint32_t> row_start_;   // height + 1 entries: row y is runs_[row_start_[y], row_start_[y + 1])
+};
+
+} // namespace video
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <metavision/sdk/base/utils/timestamp.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "video/binary_frame.h"
+
+namespace video {
+
+/**
+ * Event-driven scattering test on the accumulation thread
+ *
+ * Each event is tested against the bit-packed scattering reference while
+ * its batch is still in cache; events on reference pixels cost one bit
+ * test. Scattering pixels go into the window's touched list, deduplicated
+ * by a per-pixel generation stamp so a pixel that fires many times in a
+ * window is listed once and no per-window clear is needed. Windows are
+ * aligned like the frame generators, so one window matches one frame, and
+ * ScatteringAnalyzer::analyze_touched updates counts for the listed pixels
+ * only. For sparse scenes this replaces packing and sweeping every frame.
+ *
+ * Completed windows wait in a bounded FIFO: every window counts as a frame,
+ * so unlike EventScatterQueue none are replaced, only dropped (and counted)
+ * once the worker falls MAX_PENDING windows behind.
+ *
+ * push() must be called from one thread (the accumulation thread); take()
+ * and set_reference() from one other thread (the scattering worker).
+ */
+class ScatteringEventTap {
+public:
+    static constexpr size_t MAX_PENDING = 64;   // Completed windows held for the worker
+
+    ScatteringEventTap() = default;
+    ~ScatteringEventTap() = default;
+
+    // Non-copyable
+    ScatteringEventTap(const ScatteringEventTap&) = delete;
+    ScatteringEventTap& operator=(const ScatteringEventTap&) = delete;
+
+    /**
+     * Set the frame size and window length and drop the window in progress (accumulation thread, or before it runs)
+     * @param width Frame width (events outside are dropped)
+     * @param height Frame height
+     * @param window_us Window length in microseconds
+     */
+    void configure(int width, int height, uint32_t window_us);
+
+    /**
+     * Test events against a new reference from the next batch on (worker thread)
+     *
+     * Pending windows tested against the old one are discarded.
+     * @param reference Analyzed reference, of the configured frame size (nullptr = test nothing)
+     */
+    void set_reference(std::shared_ptr<const BinaryFrame> reference);
+
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Test a batch against the reference, completing windows it crosses (accumulation thread)
+     */
+    void push(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Take the oldest completed window (worker thread)
+     * @param keys Swapped with the window's scattering pixels, key = y * width + x (its old storage is reused)
+     * @param window_end_ts Sensor time closing the window
+     * @return false if no window is pending
+     */
+    bool take(std::vector<uint32_t>& keys, Metavision::timestamp& window_end_ts);
+
+    int get_width() const { return width_.load(std::memory_order_relaxed); }
+    int get_height() const { return height_.load(std::memory_order_relaxed); }
+
+    /**
+     * Completed windows dropped because the worker fell behind
+     */
+    uint64_t get_dropped_windows() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    void complete_window();
+    void restart_window();
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<int> width_{0};
+    std::atomic<int> height_{0};
+
+    // Reference hand-off, guarded by reference_mutex_
+    std::mutex reference_mutex_;
+    std::shared_ptr<const BinaryFrame> next_reference_;
+    std::atomic<bool> reference_changed_{false};
+
+    // Accumulation thread
+    std::shared_ptr<const BinaryFrame> reference_;
+    int64_t window_us_ = 1;
+    int64_t window_end_ts_ = -1;        // -1 = not aligned yet
+    std::vector<uint16_t> stamps_;      // Per pixel: generation_ of the window that listed it
+    uint16_t generation_ = 1;
+    std::vector<uint32_t> filling_;
+
+    // Hand-off, guarded by mutex_
+    struct Window {
+        std::vector<uint32_t> keys;
+        Metavision::timestamp end_ts = 0;
+    };
+    std::mutex mutex_;
+    std::deque<Window> pending_;
+    std::vector<std::vector<uint32_t>> spare_;   // Storage of taken windows, reused for filling_
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace video
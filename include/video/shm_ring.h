@@ -0,0 +1,100 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace video {
+namespace shm_ring {
+
+/**
+ * Shared-memory frame and event ring (see SharedMemoryPublisher)
+ *
+ * A named mapping ("Local\<name>" on Windows, "/<name>" under /dev/shm
+ * elsewhere) laid out as a 128-byte RingHeader, then frame_slots frame
+ * slots of frame_slot_bytes each at frames_offset, then event_slots event
+ * slots of event_slot_bytes each at events_offset. Every slot starts with a
+ * 64-byte SlotHeader followed by its payload; all offsets are multiples of
+ * 64. Integers are little-endian.
+ *
+ * Frame payload: height rows of stride bytes. FORMAT_U8 is one byte per
+ * pixel (0 = background, non-zero = set); FORMAT_PACKED is one bit per
+ * pixel in 64-bit words, least significant bit = leftmost pixel.
+ * Event payload: `events` Metavision::EventCD records of 16 bytes
+ * (uint16 x, uint16 y, int16 p, 2 bytes padding, int64 t in us), in frame
+ * coordinates.
+ *
+ * Publish n (counting from 0) goes to slot n % slots. frames_published /
+ * events_published count publishes started, so the newest complete one is
+ * usually count - 1. Slot headers are seqlocks: seq is 2n + 1 while publish
+ * n is written and 2n + 2 once it is complete. To read publish n:
+ *
+ *   s1 = seq (acquire); s1 == 2n + 2 or the slot is not (or no longer) n
+ *   read header fields and payload (or use them in place)
+ *   acquire fence; s2 = seq; the data is valid only if s2 == s1
+ *
+ * The writer never waits for readers: a reader that falls more than a ring
+ * behind sees seq move past 2n + 2 and has lost publish n, nothing else.
+ */
+
+constexpr char MAGIC[8] = {'R', 'T', 'C', 'S', 'H', 'M', '0', '1'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t ALIGN = 64;
+
+enum FrameFormat : uint32_t {
+    FORMAT_U8 = 0,
+    FORMAT_PACKED = 1
+};
+
+struct RingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_bytes;             // sizeof(RingHeader)
+    uint32_t frame_slots;
+    uint32_t frame_format;             // FrameFormat
+    uint64_t frame_slot_bytes;         // SlotHeader + largest frame payload, rounded up to ALIGN
+    uint64_t frames_offset;
+    uint32_t event_slots;              // 0 = events are not published
+    uint32_t event_slot_events;        // EventCD capacity of one event slot
+    uint64_t event_slot_bytes;
+    uint64_t events_offset;
+    int32_t width;                     // Largest frame the slots hold
+    int32_t height;
+    uint64_t total_bytes;
+    std::atomic<uint64_t> frames_published;
+    std::atomic<uint64_t> events_published;
+    uint32_t writer_pid;
+    std::atomic<uint32_t> writer_open;  // 0 once the writer has stopped
+    uint8_t reserved[24];
+};
+static_assert(sizeof(RingHeader) == 128, "RingHeader must stay 128 bytes");
+
+struct SlotHeader {
+    std::atomic<uint64_t> seq;         // Seqlock, see above (0 = never written)
+    uint64_t index;                    // Publish number n
+    int64_t timestamp_us;              // Frame: end of its window; batch: first event
+    int64_t events;                    // Frame: events accumulated (-1 = unknown); batch: events in the payload
+    uint32_t camera_index;
+    uint32_t window_us;                // Frame: span covered (0 = unknown); batch: last - first event
+    int32_t width;                     // Frame size (0 for batches)
+    int32_t height;
+    uint32_t stride;                   // Frame payload bytes per row (0 for batches)
+    uint32_t payload_bytes;
+    uint8_t reserved[8];
+};
+static_assert(sizeof(SlotHeader) == 64, "SlotHeader must stay 64 bytes");
+
+static_assert(sizeof(Metavision::EventCD) == 16, "Event payload layout assumes 16-byte EventCD");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Seqlocks must be lock-free to work across processes");
+
+inline bool is_valid(const RingHeader& header) {
+    return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION;
+}
+
+inline constexpr uint64_t align_up(uint64_t bytes) {
+    return (bytes + ALIGN - 1) / ALIGN * ALIGN;
+}
+
+} // namespace shm_ring
+} // namespace video
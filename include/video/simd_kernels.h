@@ -0,0 +1,283 @@
+#pragma once
+
+/**
+ * Helpers shared by the per-ISA kernel translation units of simd_utils
+ *
+ * Not part of the public API. simd_sse41.cpp, simd_avx2.cpp, simd_avx512.cpp
+ * and simd_neon.cpp are each compiled for their own instruction set (see
+ * CMakeLists.txt), so everything here lives in an anonymous namespace: an
+ * inline function built with -mavx2 in one unit must never be the copy the
+ * linker keeps for a unit that runs on any CPU.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include "video/simd_utils.h"
+
+namespace video {
+namespace simd {
+namespace internal {
+namespace {
+
+//-----------------------------------------------------------------------------
+// Fused Bit-Mask Extraction
+//-----------------------------------------------------------------------------
+
+// Kernels are templated on the mask: Mask = 0 takes bit_mask at run time,
+// otherwise it is an immediate the compiler folds into the loop.
+template <uint8_t Mask>
+inline void bit_mask_scalar_t(const uint8_t* src, size_t stride, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    const uint8_t mask = Mask ? Mask : bit_mask;
+    for (size_t i = 0; i < pixels; ++i) {
+        dst[i] = (src[i * stride] & mask) ? 255 : 0;
+    }
+}
+
+template <uint8_t Mask>
+inline void bit_mask_bgr_scalar_t(const uint8_t* bgr, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    bit_mask_scalar_t<Mask>(bgr, 3, dst, pixels, bit_mask);
+}
+
+template <uint8_t Mask>
+inline void bit_mask_gray_scalar_t(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    bit_mask_scalar_t<Mask>(src, 1, dst, pixels, bit_mask);
+}
+
+// One fixed-mask table entry per (bit1, bit2) pair, index bit1 * 8 + bit2;
+// bit1 == bit2 is the single-bit mode. (b1, b2) and (b2, b1) share the same
+// instantiations.
+template <size_t Pair>
+constexpr uint8_t pair_mask() {
+    return static_cast<uint8_t>((1u << (Pair / 8)) | (1u << (Pair % 8)));
+}
+
+// Table index of a one- or two-bit mask (lowest bit * 8 + highest bit), -1 otherwise
+inline int bit_pair_index(uint8_t bit_mask) {
+    if (bit_mask == 0) {
+        return -1;
+    }
+    int low = 0;
+    while (!((bit_mask >> low) & 1)) {
+        ++low;
+    }
+    int high = 7;
+    while (!((bit_mask >> high) & 1)) {
+        --high;
+    }
+    if ((bit_mask & ~((1 << low) | (1 << high))) != 0) {
+        return -1;  // Three or more bits: runtime-mask kernels only
+    }
+    return low * 8 + high;
+}
+
+//-----------------------------------------------------------------------------
+// Bit-Plane Split
+//-----------------------------------------------------------------------------
+
+// Local copy of the 8 plane pointers, so they stay in registers across the loop
+struct PlaneRows {
+    uint64_t* rows[8];
+    explicit PlaneRows(uint64_t* const* planes) {
+        for (int b = 0; b < 8; ++b) {
+            rows[b] = planes[b];
+        }
+    }
+};
+
+// Planes are written unrolled over the bit index, so the 8 planes are
+// independent and every shift count or bit constant is an immediate.
+using PlaneBits = std::make_index_sequence<8>;
+
+// Run block(pixels, word) per 64 pixels of a row. A short tail runs the same
+// block once on a zero-padded copy: zero pixels keep the padding bits clear,
+// and odd widths avoid up to 63 pixels of scalar work per row.
+template <size_t Channels, typename Block>
+inline void for_each_plane_word(const uint8_t* src, size_t pixels, Block block) {
+    size_t w = 0;
+    for (; (w + 1) * 64 <= pixels; ++w) {
+        block(src + w * 64 * Channels, w);
+    }
+    if (w * 64 < pixels) {
+        uint8_t pad[64 * Channels] = {};
+        std::memcpy(pad, src + w * 64 * Channels, (pixels - w * 64) * Channels);
+        block(pad, w);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Masked Histogram
+//-----------------------------------------------------------------------------
+
+// Bump 4 consecutive pixels into 4 separate banks (offset: 0 or 256 per pixel)
+#define HIST_BUMP4(p, j, o0, o1, o2, o3)      \
+    b0[(o0) | (p)[(j) + 0]]++;               \
+    b1[(o1) | (p)[(j) + 1]]++;               \
+    b2[(o2) | (p)[(j) + 2]]++;               \
+    b3[(o3) | (p)[(j) + 3]]++
+
+// One block whose mask classification is known: uniform blocks skip bit extraction
+inline void masked_histogram_block(const uint8_t* p, size_t n, uint32_t inside_bits,
+                                   uint32_t all_inside, uint32_t* banks) {
+    uint32_t* b0 = banks;
+    uint32_t* b1 = banks + HIST_BANK;
+    uint32_t* b2 = banks + 2 * HIST_BANK;
+    uint32_t* b3 = banks + 3 * HIST_BANK;
+
+    if (inside_bits == 0 || inside_bits == all_inside) {
+        const uint32_t off = inside_bits ? 256u : 0u;
+        for (size_t j = 0; j < n; j += 4) {
+            HIST_BUMP4(p, j, off, off, off, off);
+        }
+        return;
+    }
+
+    for (size_t j = 0; j < n; j += 4) {
+        HIST_BUMP4(p, j,
+                   ((inside_bits >> (j + 0)) & 1u) << 8,
+                   ((inside_bits >> (j + 1)) & 1u) << 8,
+                   ((inside_bits >> (j + 2)) & 1u) << 8,
+                   ((inside_bits >> (j + 3)) & 1u) << 8);
+    }
+}
+
+#undef HIST_BUMP4
+
+//-----------------------------------------------------------------------------
+// Masked Integral Images
+//-----------------------------------------------------------------------------
+
+// Scalar rows, continuing from running row totals (the SIMD kernels' tail)
+inline void masked_integral_row_from(const uint8_t* src, const uint8_t* mask, size_t begin, size_t pixels,
+                                     const IntegralRow& above, const IntegralRow& row,
+                                     uint32_t sum, uint32_t sum_sq, uint32_t count) {
+    for (size_t i = begin; i < pixels; ++i) {
+        const uint32_t v = mask[i] ? src[i] : 0u;
+        sum += v;
+        sum_sq += v * v;
+        count += mask[i] ? 1u : 0u;
+        row.sum[i] = above.sum[i] + sum;
+        row.sum_sq[i] = above.sum_sq[i] + sum_sq;
+        row.count[i] = above.count[i] + count;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Bit-Packed Frame Algebra
+//-----------------------------------------------------------------------------
+
+// A truth table the kernels take either as a run-time byte or, for the
+// tables below, as std::integral_constant so every tier compiles it in
+using RuntimeTable = uint8_t;
+
+template <typename Table>
+constexpr bool is_runtime_table() {
+    return std::is_same<Table, RuntimeTable>::value;
+}
+
+// Call fn(table) with the table as a constant when the frame operations use it
+template <typename Fn>
+inline auto with_fixed_table(uint8_t table, Fn fn) {
+    switch (table) {
+        case TERN_A: return fn(std::integral_constant<uint8_t, TERN_A>());
+        case TERN_A & TERN_B: return fn(std::integral_constant<uint8_t, (TERN_A & TERN_B)>());
+        case TERN_A | TERN_B: return fn(std::integral_constant<uint8_t, (TERN_A | TERN_B)>());
+        case TERN_A ^ TERN_B: return fn(std::integral_constant<uint8_t, (TERN_A ^ TERN_B)>());
+        case TERN_A & ~TERN_B: return fn(std::integral_constant<uint8_t, (TERN_A & ~TERN_B)>());
+        case TERN_A & ~(TERN_B | TERN_C):
+            return fn(std::integral_constant<uint8_t, (TERN_A & ~(TERN_B | TERN_C))>());
+        case TERN_A & TERN_B & TERN_C: return fn(std::integral_constant<uint8_t, (TERN_A & TERN_B & TERN_C)>());
+        case TERN_A | TERN_B | TERN_C: return fn(std::integral_constant<uint8_t, (TERN_A | TERN_B | TERN_C)>());
+        default: return fn(table);
+    }
+}
+
+// All-zero or all-one lane for bit i of a table
+inline uint64_t table_lane(uint8_t table, int i) {
+    return uint64_t(0) - ((table >> i) & 1u);
+}
+
+// One word of f(a, b, c): Shannon expansion on a, then b, then c. A constant
+// table makes every lane 0 or ~0 at compile time and the selects fold away.
+inline uint64_t ternary_word(uint64_t a, uint64_t b, uint64_t c, uint8_t table) {
+    auto select = [](uint64_t s, uint64_t one, uint64_t zero) { return (s & one) | (~s & zero); };
+    const uint64_t f00 = select(c, table_lane(table, 1), table_lane(table, 0));
+    const uint64_t f01 = select(c, table_lane(table, 3), table_lane(table, 2));
+    const uint64_t f10 = select(c, table_lane(table, 5), table_lane(table, 4));
+    const uint64_t f11 = select(c, table_lane(table, 7), table_lane(table, 6));
+    return select(a, select(b, f11, f10), select(b, f01, f00));
+}
+
+// Scalar loops over words [begin, words) (the SIMD kernels' tails)
+template <typename Table>
+inline void bitwise_ternary_from(const uint64_t* a, const uint64_t* b, const uint64_t* c, uint64_t* out,
+                                 size_t begin, size_t words, Table table) {
+    for (size_t i = begin; i < words; ++i) {
+        out[i] = ternary_word(a[i], b[i], c[i], table);
+    }
+}
+
+template <typename Table>
+inline int64_t count_ternary_from(const uint64_t* a, const uint64_t* b, const uint64_t* c,
+                                  size_t begin, size_t words, Table table) {
+    int64_t total = 0;
+    for (size_t i = begin; i < words; ++i) {
+        total += BinaryFrame::popcount(ternary_word(a[i], b[i], c[i], table));
+    }
+    return total;
+}
+
+/**
+ * Harley-Seal population count of vectors load(0) .. load(vectors - 1)
+ *
+ * A carry-save adder tree folds every 16 vectors into running ones, twos,
+ * fours and eights vectors plus one sixteens vector, so only one vector in
+ * 16 goes through the (comparatively slow) per-lane popcount. Ops provides
+ * Vector, zero(), csa(high, low, a, b, c) (high:low = a + b + c bitwise),
+ * popcount(v) (per 64-bit lane), add(x, y) (64-bit lanes) and sum(v).
+ */
+template <typename Ops, typename Load>
+inline int64_t harley_seal(size_t vectors, Load load) {
+    using Vector = typename Ops::Vector;
+    Vector sixteens_total = Ops::zero();
+    Vector ones = Ops::zero();
+    Vector twos = Ops::zero();
+    Vector fours = Ops::zero();
+    Vector eights = Ops::zero();
+    Vector twos_a, twos_b, fours_a, fours_b, eights_a, eights_b, sixteens;
+
+    size_t i = 0;
+    for (; i + 16 <= vectors; i += 16) {
+        Ops::csa(twos_a, ones, ones, load(i), load(i + 1));
+        Ops::csa(twos_b, ones, ones, load(i + 2), load(i + 3));
+        Ops::csa(fours_a, twos, twos, twos_a, twos_b);
+        Ops::csa(twos_a, ones, ones, load(i + 4), load(i + 5));
+        Ops::csa(twos_b, ones, ones, load(i + 6), load(i + 7));
+        Ops::csa(fours_b, twos, twos, twos_a, twos_b);
+        Ops::csa(eights_a, fours, fours, fours_a, fours_b);
+        Ops::csa(twos_a, ones, ones, load(i + 8), load(i + 9));
+        Ops::csa(twos_b, ones, ones, load(i + 10), load(i + 11));
+        Ops::csa(fours_a, twos, twos, twos_a, twos_b);
+        Ops::csa(twos_a, ones, ones, load(i + 12), load(i + 13));
+        Ops::csa(twos_b, ones, ones, load(i + 14), load(i + 15));
+        Ops::csa(fours_b, twos, twos, twos_a, twos_b);
+        Ops::csa(eights_b, fours, fours, fours_a, fours_b);
+        Ops::csa(sixteens, eights, eights, eights_a, eights_b);
+        sixteens_total = Ops::add(sixteens_total, Ops::popcount(sixteens));
+    }
+
+    Vector rest = Ops::zero();
+    for (; i < vectors; ++i) {
+        rest = Ops::add(rest, Ops::popcount(load(i)));
+    }
+    return 16 * Ops::sum(sixteens_total) + 8 * Ops::sum(Ops::popcount(eights)) +
+           4 * Ops::sum(Ops::popcount(fours)) + 2 * Ops::sum(Ops::popcount(twos)) +
+           Ops::sum(Ops::popcount(ones)) + Ops::sum(rest);
+}
+
+} // namespace
+} // namespace internal
+} // namespace simd
+} // namespace video
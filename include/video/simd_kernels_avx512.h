@@ -0,0 +1,52 @@
+#pragma once
+
+/**
+ * AVX-512F helpers shared by the AVX-512 kernel translation units
+ *
+ * Included only by units compiled for AVX-512F or above (simd_avx512.cpp,
+ * simd_avx512_vpopcnt.cpp). Anonymous namespace as in simd_kernels.h, so
+ * each unit keeps its own copy.
+ */
+
+#include "video/simd_kernels_x86.h"
+
+namespace video {
+namespace simd {
+namespace internal {
+namespace {
+
+// f(a, b, c) on 8 words: one VPTERNLOGQ for a constant table; a run-time
+// table (not an immediate) runs ternary_word's selects, each itself a
+// VPTERNLOGQ (0xCA = a ? b : c)
+template <typename Table>
+inline __m512i ternary_avx512(__m512i a, __m512i b, __m512i c, Table table) {
+    if constexpr (is_runtime_table<Table>()) {
+        auto lane = [table](int i) { return _mm512_set1_epi64(static_cast<long long>(table_lane(table, i))); };
+        auto select = [](__m512i s, __m512i one, __m512i zero) { return _mm512_ternarylogic_epi64(s, one, zero, 0xCA); };
+        const __m512i f00 = select(c, lane(1), lane(0));
+        const __m512i f01 = select(c, lane(3), lane(2));
+        const __m512i f10 = select(c, lane(5), lane(4));
+        const __m512i f11 = select(c, lane(7), lane(6));
+        return select(a, select(b, f11, f10), select(b, f01, f00));
+    } else {
+        return _mm512_ternarylogic_epi64(a, b, c, Table::value);
+    }
+}
+
+inline __m512i load_words_avx512(const uint64_t* p) {
+    return _mm512_loadu_si512(reinterpret_cast<const void*>(p));
+}
+
+// f(a, b, c) on the last words % 8 words, zero in the lanes past the end
+template <typename Table>
+inline __m512i ternary_tail_avx512(const uint64_t* a, const uint64_t* b, const uint64_t* c,
+                                   __mmask8 lanes, Table table) {
+    const __m512i r = ternary_avx512(_mm512_maskz_loadu_epi64(lanes, a), _mm512_maskz_loadu_epi64(lanes, b),
+                                     _mm512_maskz_loadu_epi64(lanes, c), table);
+    return _mm512_maskz_mov_epi64(lanes, r);   // f(0, 0, 0) may be 1
+}
+
+} // namespace
+} // namespace internal
+} // namespace simd
+} // namespace video
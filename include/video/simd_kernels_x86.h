@@ -0,0 +1,117 @@
+#pragma once
+
+/**
+ * SSE4.1-level helpers shared by the x86 kernel translation units
+ *
+ * Included only by units compiled for SSE4.1 or above (simd_sse41.cpp,
+ * simd_avx2.cpp, simd_avx512.cpp); the wider kernels reuse them for 16-pixel
+ * deinterleaves and for their tails. Anonymous namespace as in
+ * simd_kernels.h, so each unit keeps its own copy.
+ */
+
+#include <immintrin.h>
+#include "video/simd_kernels.h"
+
+namespace video {
+namespace simd {
+namespace internal {
+namespace {
+
+// Split 16 interleaved BGR pixels (48 bytes) into B, G and R registers via PSHUFB
+inline void deinterleave_bgr_16(const uint8_t* bgr, __m128i& b, __m128i& g, __m128i& r) {
+    const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgr));
+    const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgr + 16));
+    const __m128i a2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgr + 32));
+
+    const __m128i b0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i b1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m128i b2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+
+    const __m128i g0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i g1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+    const __m128i g2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+
+    const __m128i r0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i r1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i r2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+
+    b = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a0, b0), _mm_shuffle_epi8(a1, b1)), _mm_shuffle_epi8(a2, b2));
+    g = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a0, g0), _mm_shuffle_epi8(a1, g1)), _mm_shuffle_epi8(a2, g2));
+    r = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a0, r0), _mm_shuffle_epi8(a1, r1)), _mm_shuffle_epi8(a2, r2));
+}
+
+// Gather channel 0 of 16 BGR pixels (48 bytes) into one register
+inline __m128i gather_channel0_16(const uint8_t* bgr) {
+    const __m128i shuf_a = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i shuf_b = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m128i shuf_c = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgr));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgr + 16));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgr + 32));
+
+    return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, shuf_a), _mm_shuffle_epi8(b, shuf_b)),
+                        _mm_shuffle_epi8(c, shuf_c));
+}
+
+// Single-bit masks drop the AND: shifting the bit to the sign position
+// leaves one signed compare (per 16-bit lane; each byte's own bit lands in
+// its bit 7).
+
+template <uint8_t Mask>
+constexpr bool is_single_bit() {
+    return Mask != 0 && (Mask & (Mask - 1)) == 0;
+}
+
+template <uint8_t Mask>
+constexpr int single_bit_shift() {
+    int bit = 0;
+    while ((Mask >> bit) != 1) {
+        ++bit;
+    }
+    return 7 - bit;
+}
+
+// (v & mask) != 0 -> 0xFF, 16 pixels
+template <uint8_t Mask>
+inline __m128i bit_test_16(__m128i v, uint8_t bit_mask) {
+    if constexpr (is_single_bit<Mask>()) {
+        constexpr int shift = single_bit_shift<Mask>();
+        const __m128i shifted = shift ? _mm_slli_epi16(v, shift) : v;
+        return _mm_cmpgt_epi8(_mm_setzero_si128(), shifted);
+    } else {
+        const __m128i vmask = _mm_set1_epi8(static_cast<char>(Mask ? Mask : bit_mask));
+        const __m128i is_zero = _mm_cmpeq_epi8(_mm_and_si128(v, vmask), _mm_setzero_si128());
+        return _mm_xor_si128(is_zero, _mm_set1_epi8(-1));
+    }
+}
+
+// SSE4.1: Process 16 pixels at once
+template <uint8_t Mask>
+inline void bit_mask_bgr_sse41_t(const uint8_t* bgr, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        const __m128i ch0 = gather_channel0_16(bgr + i * 3);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), bit_test_16<Mask>(ch0, bit_mask));
+    }
+
+    // Handle remaining with scalar
+    bit_mask_bgr_scalar_t<Mask>(bgr + i * 3, dst + i, pixels - i, bit_mask);
+}
+
+// SSE4.1: Process 16 pixels at once
+template <uint8_t Mask>
+inline void bit_mask_gray_sse41_t(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), bit_test_16<Mask>(data, bit_mask));
+    }
+
+    bit_mask_gray_scalar_t<Mask>(src + i, dst + i, pixels - i, bit_mask);
+}
+
+} // namespace
+} // namespace internal
+} // namespace simd
+} // namespace video
@@ -1,7 +1,21 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include <metavision/sdk/base/events/event_cd.h>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <string>
+#include "video/binary_frame.h"
+
+// Kernel family of this build. x86-64 compiles the SSE4.1 / AVX2 / AVX-512BW
+// units and an AVX512_VPOPCNTDQ one (each for its own instruction set, picked
+// at run time), AArch64 the NEON one; any other target runs the scalar kernels only.
+#if defined(_M_X64) || defined(__x86_64__)
+#define RTCAM_SIMD_X86 1
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define RTCAM_SIMD_NEON 1
+#endif
 
 namespace video {
 namespace simd {
@@ -14,29 +28,109 @@ struct CPUFeatures {
     bool has_sse41{false};
     bool has_avx{false};
     bool has_avx2{false};
-    bool has_avx512{false};
+    bool has_avx512{false};     // AVX-512F
+    bool has_avx512bw{false};   // AVX-512BW (byte/word ops)
+    bool has_avx512vl{false};   // AVX-512VL (128/256-bit encodings)
+    bool has_avx512vpopcntdq{false};  // AVX512_VPOPCNTDQ (per-lane popcount)
+    bool has_neon{false};       // AArch64 Advanced SIMD
 };
 
 /**
  * Detect CPU SIMD capabilities
  *
- * Uses CPUID instruction to query CPU features.
- * Caches results for performance.
+ * x86: CPUID (MSVC intrinsics or GCC/Clang <cpuid.h>), with AVX and AVX-512
+ * reported only when XGETBV shows the OS saves their registers. AArch64:
+ * NEON is part of the baseline. Caches results for performance.
  *
  * @return Struct containing available SIMD instruction sets
  */
 const CPUFeatures& get_cpu_features();
 
+/**
+ * Raw CPUID leaf (EAX, EBX, ECX, EDX) on x86; leaves the CPU lacks read as zero
+ * @return false (all zero) on other architectures
+ */
+bool cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]);
+
+/**
+ * Instruction set tiers of the kernels below (AVX512 = AVX-512BW)
+ *
+ * A build has Scalar plus either the x86 tiers or NEON (see RTCAM_SIMD_X86);
+ * the others never report has_isa().
+ */
+enum class Isa : uint8_t {
+    Scalar,
+    SSE41,
+    AVX2,
+    AVX512,
+    NEON
+};
+constexpr int ISA_COUNT = static_cast<int>(Isa::NEON) + 1;
+
+/**
+ * Kernels with more than one implementation, each dispatched through its own tier
+ */
+enum class Kernel : uint8_t {
+    BgrToGray,
+    RangeFilter,
+    DualRangeFilter,
+    ExtractBitMask,
+    SplitBitPlanes,
+    MaskedHistogram,
+    MaskedIntegrals,
+    FrameDifference,
+    EventStats,
+    BitAlgebra,
+    COUNT
+};
+constexpr int KERNEL_COUNT = static_cast<int>(Kernel::COUNT);
+
+const char* kernel_name(Kernel kernel);
+const char* isa_name(Isa isa);
+
+/**
+ * Parse a kernel or tier name as printed by kernel_name() / isa_name()
+ * @return false if unknown
+ */
+bool parse_kernel(const std::string& name, Kernel& kernel);
+bool parse_isa(const std::string& name, Isa& isa);
+
+/**
+ * Check if a kernel has an implementation for a tier that this CPU can run
+ */
+bool has_isa(Kernel kernel, Isa isa);
+
+/**
+ * Highest tier of a kernel this CPU can run (the default dispatch)
+ */
+Isa max_isa(Kernel kernel);
+
+/**
+ * Tier a kernel currently dispatches to (any thread)
+ */
+Isa get_isa(Kernel kernel);
+
+/**
+ * Dispatch a kernel to a tier (any thread; takes effect on the next call)
+ *
+ * A tier the kernel lacks runs the next lower one it has; one the CPU
+ * lacks is capped at max_isa(). Lets a startup benchmark pick the fastest
+ * tier when the highest is not (AVX-512 frequency drops, split-load costs).
+ */
+void set_isa(Kernel kernel, Isa isa);
+
 /**
  * SIMD-accelerated BGR to grayscale conversion
  *
+ * Y = (29*B + 150*G + 77*R) >> 8. All paths deinterleave the 3 channels
+ * with byte shuffles and are bit-exact with the scalar implementation.
+ *
  * Automatically selects best implementation:
- * - AVX2 (16 pixels at once) if available
- * - SSE4.1 (8 pixels at once) if available
+ * - AVX-512BW (64 pixels at once) if available
+ * - AVX2 (32 pixels at once) if available
+ * - SSE4.1 / NEON (16 pixels at once) if available
  * - Scalar fallback
  *
- * **Performance:** 7.5× faster than OpenCV cvtColor with AVX2
- *
  * @param bgr Input BGR image (3 channels)
  * @param gray Output grayscale image (1 channel, pre-allocated)
  */
@@ -50,7 +144,8 @@ void bgr_to_gray(const cv::Mat& bgr, cv::Mat& gray);
  * - UP: [224-255] (Range 7)
  * - UP_DOWN: Both ranges
  *
- * Uses AVX2 parallel comparison (32 pixels at once) if available.
+ * Uses AVX2 parallel comparison (32 pixels at once) if available,
+ * SSE4.1 or NEON (16 pixels) otherwise.
  *
  * **Performance:** 8× faster than cv::inRange with AVX2
  *
@@ -64,7 +159,9 @@ void apply_range_filter(const cv::Mat& src, cv::Mat& dst, uint8_t low, uint8_t h
 /**
  * SIMD-accelerated dual-range filter (for UP_DOWN mode)
  *
- * Applies two range filters and combines results (OR operation).
+ * Evaluates both ranges and ORs them in registers in a single read/write
+ * sweep (no temporaries). Non-continuous Mats are processed row by row.
+ * AVX-512BW (64 pixels) / AVX2 (32) / SSE4.1 (16) / NEON (16) / scalar.
  *
  * @param src Input single-channel image
  * @param dst Output filtered image
@@ -77,15 +174,300 @@ void apply_dual_range_filter(const cv::Mat& src, cv::Mat& dst,
                               uint8_t low1, uint8_t high1,
                               uint8_t low2, uint8_t high2);
 
-// Internal implementations (exposed for testing)
+/**
+ * SIMD-accelerated fused bit-mask extraction
+ *
+ * Single pass replacement for extractChannel + two cv::LUT + bitwise_or:
+ * dst = (channel0 & bit_mask) ? 255 : 0
+ *
+ * Reads interleaved BGR (channel 0 only) or single-channel input once.
+ * AVX2 (32 pixels) / SSE4.1 (16 pixels, PSHUFB deinterleave) / NEON (16
+ * pixels, VLD3 deinterleave, one VTST per vector) / scalar. On x86, masks
+ * of one or two bits (every binary_bit_1/binary_bit_2 setting) run a kernel
+ * with the mask compiled in, picked from a table indexed by the bit pair;
+ * single-bit masks need one shift and one compare per vector.
+ *
+ * @param src Input image (CV_8UC3 or CV_8UC1)
+ * @param dst Output binary image (CV_8UC1, allocated if needed)
+ * @param bit_mask Bits that mark a pixel active, e.g. (1 << bit1) | (1 << bit2)
+ */
+void extract_bit_mask(const cv::Mat& src, cv::Mat& dst, uint8_t bit_mask);
+
+/**
+ * Split channel 0 into its eight bit planes in one pass
+ *
+ * planes[b] has pixel x set where bit b of the value is 1, so every
+ * extract_bit_mask mode is an OR of planes. Each 64-pixel block is loaded
+ * once and transposed: PMOVMSKB takes bit 7 of every byte, then a byte-wise
+ * add doubles the vector to move the next bit up (AVX2 / SSE4.1); NEON tests
+ * each bit with VTST and folds the lanes with weighted pairwise adds; the scalar
+ * fallback transposes 8x8 bit blocks in a 64-bit register. A full sweep costs
+ * about one extract_bit_mask pass and writes 1/8 of its output.
+ *
+ * @param src Input image (CV_8UC3 or CV_8UC1)
+ * @param planes Eight packed planes, index = bit (reallocated only on size change)
+ */
+void split_bit_planes(const cv::Mat& src, BinaryFrame planes[8]);
+
+/**
+ * Split 8-bit histogram by mask in a single sweep
+ *
+ * inside[v] counts pixels of value v where mask != 0, outside[v] the rest,
+ * so a region and its complement are measured together. The mask is
+ * classified 32 (AVX2) / 16 (SSE4.1) pixels at a time; bins are bumped in 4
+ * interleaved banks to avoid store-to-load stalls on repeated values.
+ *
+ * @param image Input single-channel image (CV_8UC1)
+ * @param mask Region mask (CV_8UC1, same size)
+ * @param inside Histogram of masked pixels (overwritten)
+ * @param outside Histogram of unmasked pixels (overwritten)
+ */
+void masked_histogram(const cv::Mat& image, const cv::Mat& mask,
+                      uint32_t inside[256], uint32_t outside[256]);
+
+/**
+ * Integral images of value, value squared and pixel count under a mask
+ *
+ * Tables are (rows + 1) x (cols + 1) with a zero first row and column, as
+ * cv::integral lays them out, so the sum over any rectangle is four reads.
+ * Pixels where mask == 0 contribute nothing. Each row is an in-register
+ * prefix sum of 8 pixels at a time (two shifted adds per 128-bit lane, then
+ * the low lane's total carried into the high one) plus the row above.
+ * Row prefixes are kept in 32 bits, so the SIMD path takes images up to
+ * 32768 columns and wider ones run scalar. AVX2 / scalar.
+ *
+ * @param image Input single-channel image (CV_8UC1)
+ * @param mask Region mask (CV_8UC1, same size)
+ * @param sum Sum of values (CV_32S, read as uint32; allocated if needed)
+ * @param sum_sq Sum of squared values (CV_64F, exact; allocated if needed)
+ * @param count Masked pixel count (CV_32S; allocated if needed)
+ */
+void masked_integrals(const cv::Mat& image, const cv::Mat& mask,
+                      cv::Mat& sum, cv::Mat& sum_sq, cv::Mat& count);
+
+/**
+ * SIMD-accelerated frame difference
+ *
+ * dst = (current - previous) / 2 + 128, rounded down, in one integer pass
+ * (PAVGB of current and ~previous; no widening, no saturation needed).
+ * Unchanged pixels read 128; on 0/255 binary frames the result has exactly
+ * three states: 0 = pixel turned off, 128 = unchanged, 255 = turned on.
+ * Any channel count; dst may alias current or previous.
+ * AVX2 (32 bytes) / SSE4.1 (16 bytes) / NEON (16 bytes, VRHADD) / scalar.
+ *
+ * @param current Current frame (CV_8U depth)
+ * @param previous Previous frame (same size and type)
+ * @param dst Output (allocated if needed, same size and type)
+ */
+void frame_difference(const cv::Mat& current, const cv::Mat& previous, cv::Mat& dst);
+
+/**
+ * Summary of a span of CD events (polarity, time range, bounding box)
+ */
+struct EventStats {
+    uint64_t events = 0;
+    uint64_t on_events = 0;     // p & 1 set; OFF = events - on_events
+    int64_t t_min = std::numeric_limits<int64_t>::max();
+    int64_t t_max = std::numeric_limits<int64_t>::min();
+    uint16_t x_min = 0xFFFF;    // Bounding box, inclusive (valid when events > 0)
+    uint16_t x_max = 0;
+    uint16_t y_min = 0xFFFF;
+    uint16_t y_max = 0;
+
+    bool empty() const { return events == 0; }
+
+    /**
+     * Fold another span into this one
+     */
+    void merge(const EventStats& other);
+};
+
+/**
+ * Event statistics of a batch in one pass over the EventCD array
+ *
+ * The array-of-structs layout is read in place: EventCD is 16 bytes (x, y,
+ * p in the low quadword, t in the high one), so four 256-bit loads hold
+ * eight events, and one 64-bit unpack per pair of loads separates the
+ * coordinate quadwords from the timestamps. Unsigned 16-bit min/max then
+ * tracks x and y in their own lanes, a masked 64-bit add counts ON events,
+ * and 64-bit compares track the time range. AVX2 / scalar.
+ *
+ * @param begin First event
+ * @param end One past last event
+ * @param stats Accumulated into (not reset)
+ * @param row_counts Optional per-row counts, incremented at y (rows at or past row_count are ignored)
+ * @param row_count Entries in row_counts
+ */
+void event_stats(const Metavision::EventCD* begin, const Metavision::EventCD* end, EventStats& stats,
+                 uint32_t* row_counts = nullptr, int row_count = 0);
+
+/**
+ * Truth tables of bitwise_ternary / count_ternary, in the VPTERNLOG convention
+ *
+ * Bit i of a table is the result for a = bit 2, b = bit 1, c = bit 0 of i, so
+ * a table is written as the function itself applied to these constants:
+ * scattering (live AND NOT reference) is TERN_A & ~TERN_B. Two-input
+ * functions ignore c (pass any array, e.g. b).
+ */
+constexpr uint8_t TERN_A = 0xF0;
+constexpr uint8_t TERN_B = 0xCC;
+constexpr uint8_t TERN_C = 0xAA;
+
+/**
+ * out = f(a, b, c) word by word over packed frames (BinaryFrame::data())
+ *
+ * AVX-512 applies any table in one VPTERNLOGQ per 8 words. AVX2 and scalar
+ * evaluate the table as selects; the tables the frame operations use (AND,
+ * OR, XOR, AND NOT, a AND NOT (b OR c), ...) are compiled as constants and
+ * fold to their few operations, others run about 7 selects per word.
+ * out may alias any input. AVX-512 / AVX2 / scalar.
+ *
+ * @param table Truth table (see TERN_A)
+ */
+void bitwise_ternary(const uint64_t* a, const uint64_t* b, const uint64_t* c, uint64_t* out,
+                     size_t words, uint8_t table);
+
+/**
+ * Count of set bits in f(a, b, c), without materializing it
+ *
+ * With AVX512_VPOPCNTDQ every 8 words are one VPTERNLOGQ and one VPOPCNTQ;
+ * AVX-512BW without it and AVX2 run the Harley-Seal carry-save adder tree
+ * (16 vectors reduced to one per-byte popcount, PSHUFB nibble lookup),
+ * whose adders are themselves VPTERNLOGQ on AVX-512. A full HD frame
+ * (32 K words) takes a few microseconds from L2. AVX-512 / AVX2 / scalar.
+ *
+ * @param table Truth table (see TERN_A)
+ * @return Set bits; padding bits are zero in every BinaryFrame, so tables
+ *         mapping all-zero inputs to 0 count pixels only
+ */
+int64_t count_ternary(const uint64_t* a, const uint64_t* b, const uint64_t* c, size_t words, uint8_t table);
+
+/**
+ * Count set bits of a packed frame (count_ternary of a alone)
+ */
+int64_t count_bits(const uint64_t* words, size_t count);
+
+// Internal implementations (exposed for testing). The x86 tiers live in
+// simd_sse41.cpp / simd_avx2.cpp / simd_avx512.cpp and NEON in simd_neon.cpp,
+// each compiled for its own instruction set; scalar kernels and dispatch are
+// in simd_utils.cpp.
 namespace internal {
+    // Masked histogram bank: 256 outside + 256 inside bins
+    constexpr size_t HIST_BANK = 512;
+
     void bgr_to_gray_scalar(const uint8_t* bgr, uint8_t* gray, size_t pixels);
+    void range_filter_scalar(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t low, uint8_t high);
+    void dual_range_filter_scalar(const uint8_t* src, uint8_t* dst, size_t pixels,
+                                  uint8_t low1, uint8_t high1, uint8_t low2, uint8_t high2);
+    void bit_mask_bgr_scalar(const uint8_t* bgr, uint8_t* dst, size_t pixels, uint8_t bit_mask);
+    void bit_mask_gray_scalar(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t bit_mask);
+
+    // planes[b] receives (pixels + 63) / 64 words, padding bits zero
+    void bit_planes_bgr_scalar(const uint8_t* bgr, uint64_t* const* planes, size_t pixels);
+    void bit_planes_gray_scalar(const uint8_t* src, uint64_t* const* planes, size_t pixels);
+
+    void frame_difference_scalar(const uint8_t* cur, const uint8_t* prev, uint8_t* dst, size_t pixels);
+
+    // banks: 4 x HIST_BANK bins (0-255 outside mask, 256-511 inside), accumulated
+    void masked_histogram_scalar(const uint8_t* src, const uint8_t* mask, size_t pixels, uint32_t* banks);
+
+    // One row of the masked integral tables, past their zero column
+    struct IntegralRow {
+        uint32_t* sum;
+        double* sum_sq;
+        uint32_t* count;
+    };
+
+    // row = above + masked prefix sums of this row
+    void masked_integral_row_scalar(const uint8_t* src, const uint8_t* mask, size_t pixels,
+                                    const IntegralRow& above, const IntegralRow& row);
+
+    void event_stats_scalar(const Metavision::EventCD* events, size_t count, EventStats& stats,
+                            uint32_t* row_counts, int row_count);
+
+    void bitwise_ternary_scalar(const uint64_t* a, const uint64_t* b, const uint64_t* c, uint64_t* out,
+                                size_t words, uint8_t table);
+    int64_t count_ternary_scalar(const uint64_t* a, const uint64_t* b, const uint64_t* c, size_t words,
+                                 uint8_t table);
+
+    // Bit-mask kernels of one tier with a one- or two-bit mask compiled in
+    // (they ignore their bit_mask argument)
+    struct BitMaskKernels {
+        using Row = void (*)(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t bit_mask);
+        Row bgr;
+        Row gray;
+    };
+
+#ifdef RTCAM_SIMD_X86
     void bgr_to_gray_sse41(const uint8_t* bgr, uint8_t* gray, size_t pixels);
     void bgr_to_gray_avx2(const uint8_t* bgr, uint8_t* gray, size_t pixels);
+    void bgr_to_gray_avx512(const uint8_t* bgr, uint8_t* gray, size_t pixels);
 
-    void range_filter_scalar(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t low, uint8_t high);
     void range_filter_sse41(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t low, uint8_t high);
     void range_filter_avx2(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t low, uint8_t high);
+
+    void dual_range_filter_sse41(const uint8_t* src, uint8_t* dst, size_t pixels,
+                                 uint8_t low1, uint8_t high1, uint8_t low2, uint8_t high2);
+    void dual_range_filter_avx2(const uint8_t* src, uint8_t* dst, size_t pixels,
+                                uint8_t low1, uint8_t high1, uint8_t low2, uint8_t high2);
+    void dual_range_filter_avx512(const uint8_t* src, uint8_t* dst, size_t pixels,
+                                  uint8_t low1, uint8_t high1, uint8_t low2, uint8_t high2);
+
+    void bit_mask_bgr_sse41(const uint8_t* bgr, uint8_t* dst, size_t pixels, uint8_t bit_mask);
+    void bit_mask_bgr_avx2(const uint8_t* bgr, uint8_t* dst, size_t pixels, uint8_t bit_mask);
+    void bit_mask_gray_sse41(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t bit_mask);
+    void bit_mask_gray_avx2(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t bit_mask);
+
+    /**
+     * Get the kernels specialized for a one- or two-bit mask
+     * @return Table entry for the bit pair, nullptr for 0 or more than two bits
+     */
+    const BitMaskKernels* fixed_bit_mask_sse41(uint8_t bit_mask);
+    const BitMaskKernels* fixed_bit_mask_avx2(uint8_t bit_mask);
+
+    void bit_planes_bgr_sse41(const uint8_t* bgr, uint64_t* const* planes, size_t pixels);
+    void bit_planes_bgr_avx2(const uint8_t* bgr, uint64_t* const* planes, size_t pixels);
+    void bit_planes_gray_sse41(const uint8_t* src, uint64_t* const* planes, size_t pixels);
+    void bit_planes_gray_avx2(const uint8_t* src, uint64_t* const* planes, size_t pixels);
+    void bit_planes_gray_avx512(const uint8_t* src, uint64_t* const* planes, size_t pixels);
+
+    void frame_difference_sse41(const uint8_t* cur, const uint8_t* prev, uint8_t* dst, size_t pixels);
+    void frame_difference_avx2(const uint8_t* cur, const uint8_t* prev, uint8_t* dst, size_t pixels);
+
+    void masked_histogram_sse41(const uint8_t* src, const uint8_t* mask, size_t pixels, uint32_t* banks);
+    void masked_histogram_avx2(const uint8_t* src, const uint8_t* mask, size_t pixels, uint32_t* banks);
+
+    void masked_integral_row_avx2(const uint8_t* src, const uint8_t* mask, size_t pixels,
+                                  const IntegralRow& above, const IntegralRow& row);
+
+    void event_stats_avx2(const Metavision::EventCD* events, size_t count, EventStats& stats,
+                          uint32_t* row_counts, int row_count);
+
+    void bitwise_ternary_avx2(const uint64_t* a, const uint64_t* b, const uint64_t* c, uint64_t* out,
+                              size_t words, uint8_t table);
+    void bitwise_ternary_avx512(const uint64_t* a, const uint64_t* b, const uint64_t* c, uint64_t* out,
+                                size_t words, uint8_t table);
+    int64_t count_ternary_avx2(const uint64_t* a, const uint64_t* b, const uint64_t* c, size_t words,
+                               uint8_t table);
+    int64_t count_ternary_avx512(const uint64_t* a, const uint64_t* b, const uint64_t* c, size_t words,
+                                 uint8_t table);
+
+    // simd_avx512_vpopcnt.cpp: only with has_avx512vpopcntdq
+    int64_t count_ternary_avx512_vpopcnt(const uint64_t* a, const uint64_t* b, const uint64_t* c, size_t words,
+                                         uint8_t table);
+#endif
+
+#ifdef RTCAM_SIMD_NEON
+    void bgr_to_gray_neon(const uint8_t* bgr, uint8_t* gray, size_t pixels);
+    void range_filter_neon(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t low, uint8_t high);
+    void dual_range_filter_neon(const uint8_t* src, uint8_t* dst, size_t pixels,
+                                uint8_t low1, uint8_t high1, uint8_t low2, uint8_t high2);
+    void bit_mask_bgr_neon(const uint8_t* bgr, uint8_t* dst, size_t pixels, uint8_t bit_mask);
+    void bit_mask_gray_neon(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t bit_mask);
+    void bit_planes_bgr_neon(const uint8_t* bgr, uint64_t* const* planes, size_t pixels);
+    void bit_planes_gray_neon(const uint8_t* src, uint64_t* const* planes, size_t pixels);
+    void frame_difference_neon(const uint8_t* cur, const uint8_t* prev, uint8_t* dst, size_t pixels);
+#endif
 }
 
 } // namespace simd
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "core/clock_sync.h"
+#include "video/binary_frame.h"
+
+namespace video {
+
+/**
+ * Merges the event streams of several cameras into one host-time order
+ *
+ * Stereo rigs and A/B sensor tests compare cameras window by window, which
+ * only means something if window N of every camera covers the same span of
+ * real time. Each camera's sensor clock starts at its own zero, so every
+ * batch is mapped to steady_clock microseconds through that camera's
+ * core::ClockSync (one offset per batch: drift within a batch is far below
+ * a microsecond) before it enters the merge.
+ *
+ * Every stream has a bounded look-ahead buffer of Options::buffer_events.
+ * The merge thread k-way merges the buffers with a heap up to the
+ * watermark, the oldest "newest event" of all streams: nothing older can
+ * still arrive, so the merged order is final. When one stream lags, the
+ * others fill their buffers up to the bound and their accumulation threads
+ * wait (back-pressure) for up to Options::max_wait_ms per batch before the
+ * rest of the batch is dropped and counted. A stream silent for
+ * Options::stall_ms no longer holds the watermark back, so a disconnected
+ * camera cannot stop the others.
+ *
+ * Merged events are cut into windows of Options::window_us on one host-time
+ * grid; each closed window is handed over as one BinaryFrame per stream.
+ * Frames are reused, so the window callback must copy what it keeps. Both
+ * callbacks run on the merge thread.
+ *
+ * submit() is called from each camera's accumulation thread (one thread per
+ * stream); start() and stop() from one other thread.
+ *
+ * **Usage:**
+ * ```cpp
+ * merger.start({size_0, size_1}, options, [](const StreamMerger::Window& window) {
+ *     BinaryFrame::count_xor(window.frames[0], window.frames[1]);     // Merge thread
+ * });
+ * merger.submit(camera_index, begin, end, clock_sync);                  // Accumulation threads
+ * merger.stop();
+ * ```
+ */
+class StreamMerger {
+public:
+    struct Options {
+        uint32_t window_us = 1000;        // Synchronized window length
+        size_t buffer_events = 1 << 20;   // Look-ahead per stream
+        int max_wait_ms = 20;             // Back-pressure wait for room before a batch is dropped
+        int stall_ms = 200;               // Silence before a stream stops holding the watermark
+    };
+
+    struct MergedEvent {
+        int64_t t = 0;          // Host time (steady_clock microseconds)
+        uint16_t x = 0;
+        uint16_t y = 0;
+        uint8_t p = 0;
+        uint8_t stream = 0;
+    };
+
+    struct Window {
+        int64_t end_us = 0;                 // Host time closing the window
+        std::vector<BinaryFrame> frames;    // One per stream, pixels that fired in the window
+        std::vector<int64_t> events;        // Events per stream in the window
+    };
+
+    using WindowCallback = std::function<void(const Window& window)>;
+    using EventsCallback = std::function<void(const MergedEvent* begin, const MergedEvent* end)>;
+
+    StreamMerger() = default;
+    ~StreamMerger();
+
+    // Non-copyable
+    StreamMerger(const StreamMerger&) = delete;
+    StreamMerger& operator=(const StreamMerger&) = delete;
+
+    /**
+     * Start the merge thread
+     * @param sizes Frame size of every stream (stream index = camera index)
+     * @param options Window length and buffer bounds
+     * @param on_window Called for every closed window
+     * @param on_events Called with every merged run of events, in host-time order (optional)
+     * @return false if already running or fewer than two streams
+     */
+    bool start(const std::vector<cv::Size>& sizes, const Options& options, WindowCallback on_window,
+               EventsCallback on_events = nullptr);
+
+    /**
+     * Stop the merge thread; events still buffered are discarded
+     */
+    void stop();
+
+    bool is_running() const { return running_.load(std::memory_order_relaxed); }
+
+    /**
+     * Map a batch to host time and append it to its stream's buffer (accumulation thread of that stream)
+     *
+     * Waits up to Options::max_wait_ms for room while the buffer is full.
+     * @param stream Stream index
+     * @param clock That camera's clock mapping (batches are counted as unmapped while it is not valid)
+     */
+    void submit(int stream, const Metavision::EventCD* begin, const Metavision::EventCD* end,
+                const core::ClockSync& clock);
+
+    int stream_count() const { return static_cast<int>(sizes_.size()); }
+    uint32_t get_window_us() const { return options_.window_us; }
+
+    // Statistics
+    int64_t get_windows() const { return windows_.load(std::memory_order_relaxed); }
+    int64_t get_merged_events() const { return merged_.load(std::memory_order_relaxed); }
+    int64_t get_dropped_events() const { return dropped_.load(std::memory_order_relaxed); }
+    int64_t get_unmapped_events() const { return unmapped_.load(std::memory_order_relaxed); }
+    int64_t get_late_events() const { return late_.load(std::memory_order_relaxed); }
+    int64_t get_waits() const { return waits_.load(std::memory_order_relaxed); }
+
+    /**
+     * Host-time spread between the newest events of the live streams (us)
+     */
+    int64_t get_skew_us() const { return skew_us_.load(std::memory_order_relaxed); }
+
+    /**
+     * Events buffered for a stream, waiting for the watermark
+     */
+    size_t get_buffered(int stream) const;
+
+private:
+    struct Stream {
+        std::vector<MergedEvent> buffer;   // Host-time order, guarded by mutex_
+        int64_t newest_us = 0;             // Host time of the newest buffered event
+        int64_t last_submit_us = 0;        // steady_clock at the last batch (0 = none yet)
+    };
+
+    void merge_loop();
+    int64_t watermark(int64_t now_us);
+    void merge(int64_t watermark_us);
+    void add_to_windows(const MergedEvent* begin, const MergedEvent* end);
+    void close_window();
+
+    std::vector<cv::Size> sizes_;
+    Options options_;
+    WindowCallback on_window_;
+    EventsCallback on_events_;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    mutable std::mutex mutex_;
+    std::condition_variable data_cv_;     // Batch submitted or stopping
+    std::condition_variable room_cv_;     // Buffers drained or stopping
+    std::vector<Stream> streams_;
+
+    // Merge thread
+    std::vector<std::vector<MergedEvent>> taken_;   // Per stream, events up to the watermark
+    std::vector<MergedEvent> merged_events_;
+    Window window_;
+    int64_t merged_until_us_ = 0;                   // Watermark of the last merge (0 = none yet)
+
+    std::atomic<int64_t> windows_{0};
+    std::atomic<int64_t> merged_{0};
+    std::atomic<int64_t> dropped_{0};
+    std::atomic<int64_t> unmapped_{0};
+    std::atomic<int64_t> late_{0};
+    std::atomic<int64_t> waits_{0};
+    std::atomic<int64_t> skew_us_{0};
+};
+
+} // namespace video
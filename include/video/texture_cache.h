@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "video/frame_ref.h"
+#include "video/texture_manager.h"
+
+namespace video {
+
+/**
+ * GPU textures shared by every view, keyed by the identity of the frame they hold
+ *
+ * Views (camera feed, viewer, compare overlay, zoom, noise visualization)
+ * hold a Handle instead of owning a TextureManager. acquire() points the
+ * handle at the texture already holding a frame when any view uploaded it,
+ * so a frame goes up to the GPU once however many views show it.
+ *
+ * **Identity:** Key::of() a FrameRef is its pixel buffer. A shared frame is
+ * never modified in place (FrameRef::write() copies), and the texture keeps
+ * a reference to it, so the address cannot be reused for other pixels while
+ * the entry is keyed by it. Key::of_file() is a file path and modification
+ * time, so two views loading the same capture (separate decoded copies)
+ * still share one texture.
+ *
+ * **Streaming:** When nothing holds the frame yet and the caller is the only
+ * holder of its current texture, the upload goes into that texture in
+ * place, keeping its R8 storage, PBO ring and dirty bands (see
+ * TextureManager). Otherwise an idle entry of the same size is reused, or a
+ * new one created.
+ *
+ * Entries no view holds stay idle, up to MAX_IDLE of them: they drop their
+ * CPU frame (no pool slot stays pinned), frame-keyed ones forget their key,
+ * and file-keyed ones can still be found again.
+ *
+ * UI thread only (GL context current).
+ *
+ * **Usage:**
+ * ```cpp
+ * TextureCache::Handle texture;
+ * cache.acquire(texture, frame);             // Uploads only if no view holds frame
+ * ImGui::Image((void*)(intptr_t)texture->get_texture_id(), size);
+ * ```
+ */
+class TextureCache {
+public:
+    static constexpr size_t MAX_IDLE = 4;
+
+    using Handle = std::shared_ptr<const TextureManager>;
+
+    /**
+     * Identity of the pixels a texture holds
+     */
+    struct Key {
+        uintptr_t source = 0;   // Pixel buffer address or file path hash (0 = none)
+        int64_t version = 0;    // File modification time
+        bool file = false;
+
+        static Key of(const FrameRef& frame);
+        static Key of_file(const std::string& path);
+
+        bool empty() const { return source == 0; }
+        bool operator==(const Key& other) const {
+            return source == other.source && version == other.version && file == other.file;
+        }
+    };
+
+    TextureCache() = default;
+
+    // Non-copyable
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    /**
+     * Get a texture that is not shared until something is uploaded to it
+     *
+     * For owners that expose a texture before the first frame arrives.
+     */
+    Handle reserve();
+
+    /**
+     * Create an idle texture of a frame size ahead of the first frame
+     *
+     * The first acquire() of that size streams into it (see Streaming)
+     * instead of allocating texture storage and PBOs mid-stream.
+     * @param channels Channels of the frames that will be uploaded (1 or 3)
+     */
+    void prepare(const cv::Size& size, int channels);
+
+    /**
+     * Point a handle at a texture holding a frame, uploading only if no entry holds it
+     * @param handle Caller's handle (empty, or its current texture)
+     * @param frame Frame to show
+     * @param key Identity of frame
+     * @return true if this call uploaded
+     */
+    bool acquire(Handle& handle, const FrameRef& frame, const Key& key);
+
+    /**
+     * Point a handle at a texture holding a frame, identified by its pixels (Key::of)
+     */
+    bool acquire(Handle& handle, const FrameRef& frame) { return acquire(handle, frame, Key::of(frame)); }
+
+    /**
+     * Find the texture holding a key
+     * @return Handle, or empty if no entry holds it
+     */
+    Handle find(const Key& key);
+
+    /**
+     * Release every entry's GL objects and frames (handles stay valid but empty)
+     */
+    void clear();
+
+    /**
+     * Frames uploaded / acquires served by a texture already holding the frame
+     */
+    uint64_t uploads() const { return uploads_; }
+    uint64_t hits() const { return hits_; }
+
+    /**
+     * Entries, held or idle
+     */
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        std::shared_ptr<TextureManager> texture;
+        Key key;
+        uint64_t last_used = 0;
+
+        bool idle() const { return texture.use_count() == 1; }   // Only the cache holds it
+    };
+
+    Entry* entry_of(const Handle& handle);
+    Entry* entry_for(const Handle& handle, const cv::Size& size);
+
+    /**
+     * Drop idle entries' frames and frame keys, then evict idle entries beyond MAX_IDLE
+     */
+    void trim();
+
+    std::vector<Entry> entries_;
+    uint64_t tick_ = 0;
+    uint64_t uploads_ = 0;
+    uint64_t hits_ = 0;
+};
+
+} // namespace video
@@ -11,6 +11,17 @@ namespace video {
  *
  * Handles GPU texture creation, uploading, and lifecycle management.
  * Uses FrameRef to eliminate unnecessary frame cloning.
+ *
+ * **R8 MODE:** Single-channel frames (the binary view) are uploaded into
+ * immutable GL_R8 storage allocated once, streamed with glTexSubImage2D
+ * from a ring of persistently mapped PBOs. A swizzle mask (R,R,R,1) shows
+ * the texture as grayscale, so no GRAY2RGB conversion is needed and upload
+ * bandwidth is a third of the RGB path. Falls back to the RGB path when the
+ * driver lacks buffer/texture storage, sync or swizzle support.
+ *
+ * **DIRTY BANDS:** Frames carrying RowBands (native binary frames) only
+ * upload the row bands that differ from the frame the texture holds (see
+ * RowBands::upload_bands).
  */
 class TextureManager {
 public:
@@ -33,6 +44,14 @@ public:
      */
     void upload_frame(const FrameRef& frame_ref);
 
+    /**
+     * Create the texture (and the R8 PBO ring) for a frame size ahead of the first frame
+     *
+     * The texture is cleared to black, so it can be shown before a frame arrives.
+     * @param channels Channels of the frames that will be uploaded (1 or 3)
+     */
+    void prepare(int width, int height, int channels);
+
     /**
      * Get OpenGL texture ID for rendering
      * @return Texture ID (0 if not yet created)
@@ -57,18 +76,78 @@ public:
      */
     FrameRef get_last_frame() const { return last_frame_; }
 
+    /**
+     * Drop the CPU reference to the last frame, keeping the texture (see TextureCache)
+     */
+    void release_frame() { last_frame_.reset(); }
+
     /**
      * Reset texture (deletes OpenGL texture)
      */
     void reset();
 
+    /**
+     * Enable/disable the R8 + PBO ring path for single-channel frames
+     * @param enabled true to use R8 uploads when supported (default)
+     */
+    void set_r8_upload_enabled(bool enabled) { r8_enabled_ = enabled; }
+
+    /**
+     * Check if the current texture uses R8 storage
+     */
+    bool is_r8_texture() const { return format_ == TextureFormat::R8; }
+
 private:
+    enum class TextureFormat { NONE, RGB, R8 };
+
+    static constexpr int PBO_RING_SIZE = 3;
+
+    struct PixelBuffer {
+        GLuint id = 0;
+        void* mapped = nullptr;
+        GLsync fence = nullptr;
+    };
+
     void ensure_texture_created();
 
+    /**
+     * Upload any frame through the RGB (glTexImage2D) path
+     */
+    void upload_rgb(const cv::Mat& frame);
+
+    /**
+     * Upload single-channel frame through the R8 + PBO ring path
+     * @param bands Rows that may differ from the background (RowBands::ALL = unknown)
+     * @return false if R8 path is unavailable (caller falls back to RGB)
+     */
+    bool upload_r8(const cv::Mat& frame, const RowBands& bands);
+
+    /**
+     * Allocate immutable R8 texture and persistent PBO ring for given size
+     */
+    bool create_r8_storage(int width, int height);
+
+    /**
+     * Release texture, PBOs and fences
+     */
+    void destroy_gl_objects();
+
+    /**
+     * Check driver support for the R8 path (queried once)
+     */
+    static bool r8_upload_supported();
+
     GLuint texture_id_ = 0;
     int width_ = 0;
     int height_ = 0;
+    TextureFormat format_ = TextureFormat::NONE;
     FrameRef last_frame_;  // Keep CPU copy for capture (zero-copy)
+
+    // R8 streaming state
+    bool r8_enabled_ = true;
+    PixelBuffer pbo_ring_[PBO_RING_SIZE];
+    int pbo_index_ = 0;
+    RowBands texture_bands_;  // Bands of the frame the texture holds (ALL = unknown)
 };
 
 } // namespace video
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace video {
+
+/**
+ * Work-stealing thread pool for data-parallel analysis kernels
+ *
+ * Each worker owns a task deque: it pops its own tasks from the front and,
+ * when empty, steals from the back of the others, so uneven bands (e.g. a
+ * noisy region of the sensor) balance out on their own. parallel_for() runs
+ * one task per index and the calling thread works through tasks too while
+ * it waits, so nested or concurrent calls from several analyzers can never
+ * deadlock the pool.
+ *
+ * **Usage:**
+ * ```cpp
+ * auto& pool = ThreadPool::shared();
+ * pool.parallel_for(band_count, [&](int band) { process(band); });
+ * ```
+ */
+class ThreadPool {
+public:
+    /**
+     * Start worker threads
+     * @param worker_count Workers besides the calling thread (-1 = hardware threads - 1)
+     */
+    explicit ThreadPool(int worker_count = -1);
+    ~ThreadPool();
+
+    // Non-copyable
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Process-wide pool shared by all analyzers
+     */
+    static ThreadPool& shared();
+
+    /**
+     * Threads that execute a parallel_for (workers + caller)
+     */
+    int concurrency() const { return static_cast<int>(workers_.size()) + 1; }
+
+    /**
+     * Run body(i) for i in [0, count) and wait for all of them
+     * @param count Number of tasks (typically row bands)
+     * @param body Called once per index, from any thread
+     */
+    void parallel_for(int count, const std::function<void(int)>& body);
+
+    /**
+     * Run a task on a worker without waiting for it
+     *
+     * Only for pools of their own (see AnalyzerHost): parallel_for() callers
+     * help with any queued task, so a long task posted to shared() could
+     * run inside an unrelated analyzer's parallel_for. Needs at least one
+     * worker; tasks still queued when the pool is destroyed never run.
+     * @param task Called once, from a worker thread
+     */
+    void post(std::function<void()> task);
+
+    /**
+     * Choose a row band height so a band's working set fits in L2
+     * @param rows Image height
+     * @param bytes_per_row Bytes touched per row (sum over all planes)
+     * @param band_bytes Target working set per band
+     * @return Rows per band (>= 1)
+     */
+    static int band_rows(int rows, size_t bytes_per_row, size_t band_bytes = DEFAULT_BAND_BYTES);
+
+    static constexpr size_t DEFAULT_BAND_BYTES = 256 * 1024;
+
+private:
+    using Task = std::function<void()>;
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void worker_loop(size_t index);
+    void push(Task task);
+    bool try_pop(size_t index, Task& task);   // Own front first, then steal others' back
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::atomic<size_t> next_queue_{0};
+    std::atomic<int> pending_{0};              // Tasks queued, not yet taken
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    bool stopping_ = false;
+};
+
+} // namespace video
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <metavision/sdk/base/events/event_cd.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace video {
+
+/**
+ * Per-pixel last-event timestamp plane for the time-surface display mode
+ *
+ * update() stores the timestamp of every event into its pixel's cell, so
+ * the plane is maintained in O(events) and is never cleared between
+ * windows; old pixels simply age. render() turns the plane into a CV_8UC1
+ * image at display time through an exponential decay LUT,
+ * 255 * exp(-age / decay_us), relative to the newest event seen. Recent
+ * activity is bright and transient noise shows up as short-lived sparkle
+ * rather than being merged into a binary window.
+ *
+ * Cells hold the low 32 bits of the timestamp (0 = never), so ages are
+ * computed modulo 2^32 us (~71 min). Each update() also scrubs one row of
+ * cells older than 2^31 us back to "never", which keeps stale cells from
+ * aliasing as fresh after a wrap. Time going backwards (replay restart)
+ * clears the plane once.
+ *
+ * **PERFORMANCE:** One relaxed 32-bit store per event plus width stores
+ * per batch for the scrub. render() is O(pixels) but runs at display rate
+ * only: one load, a multiply and a LUT lookup per pixel.
+ *
+ * update() must be called from a single thread (the accumulation thread);
+ * render() may run concurrently from another thread (the UI thread) and
+ * sees each cell either before or after an update, never torn.
+ */
+class TimeSurface {
+public:
+    TimeSurface() = default;
+    ~TimeSurface() = default;
+
+    // Non-copyable
+    TimeSurface(const TimeSurface&) = delete;
+    TimeSurface& operator=(const TimeSurface&) = delete;
+
+    /**
+     * Set frame geometry and clear the plane (not while update() or render() run)
+     * @param width Frame width
+     * @param height Frame height
+     * @return false if the size is invalid (surface stays empty)
+     */
+    bool configure(int width, int height);
+
+    /**
+     * Record a batch of events
+     * @param begin First event (frame coordinates)
+     * @param end One past last event
+     */
+    void update(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Render the decayed surface
+     * @param out Output, (re)allocated as CV_8UC1 of the frame size
+     * @param decay_us Decay time constant in microseconds
+     * @return false if nothing has been recorded yet
+     */
+    bool render(cv::Mat& out, uint32_t decay_us);
+
+    /**
+     * Enable or disable updates (takes effect on the next batch; the plane is kept)
+     */
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Newest event timestamp recorded (-1 = none)
+     */
+    int64_t get_latest_timestamp() const { return latest_ts_.load(std::memory_order_relaxed); }
+
+    int get_width() const { return width_; }
+    int get_height() const { return height_; }
+
+private:
+    static constexpr int LUT_SIZE = 1024;
+
+    /**
+     * Rebuild the decay LUT for a new time constant (render thread)
+     */
+    void build_lut(uint32_t decay_us);
+
+    int width_ = 0;
+    int height_ = 0;
+    std::atomic<bool> enabled_{false};
+    std::atomic<int64_t> latest_ts_{-1};
+
+    // Written by update(), read by render()
+    std::unique_ptr<std::atomic<uint32_t>[]> cells_;   // width_ * height_, low 32 bits of t (0 = never)
+
+    // Accumulation thread only
+    int scrub_row_ = 0;
+
+    // Render thread only
+    std::array<uint8_t, LUT_SIZE> lut_{};
+    uint32_t lut_decay_us_ = 0;                         // 0 = LUT not built
+    uint64_t lut_scale_ = 0;                            // LUT index = (age * lut_scale_) >> 32
+};
+
+} // namespace video
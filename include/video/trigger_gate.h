@@ -0,0 +1,105 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_ext_trigger.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+
+namespace video {
+
+/**
+ * Capture windows in camera time, opened and closed by external trigger events
+ *
+ * The decoding thread feeds the trigger-in events of its camera through
+ * on_triggers(): a rising edge opens a window at its sensor timestamp, and
+ * the window ends either at the next falling edge (window_us = 0) or
+ * window_us later. The accumulation thread then asks step() about each
+ * frame's time span, which tells it when a window begins, whether the frame
+ * lies in it, and when the previous window has ended.
+ *
+ * A window whose falling edge has not been decoded yet counts as open, so
+ * a frame decoded ahead of the edge is kept rather than lost.
+ *
+ * **Usage:**
+ * ```cpp
+ * gate.set_enabled(true, 0);                    // Before the camera starts
+ * gate.on_triggers(begin, end);                 // Decoding thread
+ * auto step = gate.step(frame_begin, frame_end); // Accumulation thread, every frame
+ * ```
+ */
+class TriggerGate {
+public:
+    static constexpr int64_t OPEN = std::numeric_limits<int64_t>::max();  // End not known yet
+    static constexpr size_t MAX_PENDING = 64;    // Windows queued ahead of the frames
+
+    /**
+     * What a frame means for the capture windows
+     */
+    struct Step {
+        bool closed = false;     // The window of earlier frames has ended (before this frame)
+        bool opened = false;     // This frame is the first of a new window
+        bool inside = false;     // This frame overlaps the current window
+        uint64_t window = 0;     // Window number (1 = first since enabled), valid when inside
+        int64_t begin_us = 0;    // Window start (sensor time), valid when inside
+    };
+
+    TriggerGate() = default;
+
+    // Non-copyable
+    TriggerGate(const TriggerGate&) = delete;
+    TriggerGate& operator=(const TriggerGate&) = delete;
+
+    /**
+     * Turn gating on or off and drop any pending window
+     * @param enabled Consume trigger events
+     * @param window_us Window length from the rising edge (0 = until the falling edge)
+     */
+    void set_enabled(bool enabled, int64_t window_us);
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Record a batch of trigger events (decoding thread)
+     */
+    void on_triggers(const Metavision::EventExtTrigger* begin, const Metavision::EventExtTrigger* end);
+
+    /**
+     * Place a frame against the windows (accumulation thread)
+     * @param frame_begin_us Sensor time the frame's window starts
+     * @param frame_end_us Sensor time of the frame (end of its window)
+     */
+    Step step(int64_t frame_begin_us, int64_t frame_end_us);
+
+    // Statistics
+    uint64_t get_windows_opened() const { return windows_opened_.load(std::memory_order_relaxed); }
+    uint64_t get_windows_dropped() const { return windows_dropped_.load(std::memory_order_relaxed); }
+    uint64_t get_frames_inside() const { return frames_inside_.load(std::memory_order_relaxed); }
+    bool is_window_open() const { return in_window_.load(std::memory_order_relaxed); }
+
+private:
+    struct Window {
+        uint64_t number = 0;
+        int64_t begin_us = 0;
+        int64_t end_us = OPEN;
+    };
+
+    std::atomic<bool> enabled_{false};
+    int64_t window_us_ = 0;
+
+    // Decoding thread -> accumulation thread (trigger rates are low; a mutex is enough)
+    std::mutex mutex_;
+    std::deque<Window> windows_;
+    uint64_t next_number_ = 1;
+    bool edge_high_ = false;         // Level after the last decoded edge
+
+    // Accumulation thread
+    uint64_t current_ = 0;           // Window the last inside frame belonged to (0 = none)
+
+    std::atomic<bool> in_window_{false};
+    std::atomic<uint64_t> windows_opened_{0};
+    std::atomic<uint64_t> windows_dropped_{0};   // Queue full: the oldest pending window was lost
+    std::atomic<uint64_t> frames_inside_{0};
+};
+
+} // namespace video
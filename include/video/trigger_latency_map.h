@@ -0,0 +1,133 @@
+#pragma once
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <metavision/sdk/base/events/event_ext_trigger.h>
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace video {
+
+/**
+ * Per-pixel response latency to a trigger-marked stimulus
+ *
+ * An external trigger marks each stimulus onset (rising edge on the main
+ * trigger input, fed from the decoding thread through on_triggers()). On
+ * the accumulation thread, the first event of every pixel within
+ * window_us of an onset is its response: the latency to the onset is
+ * added to the pixel's sum and sum of squares, so mean and jitter
+ * (standard deviation) maps build up over many cycles.
+ *
+ * **PERFORMANCE:** events outside a response window are cut off per batch
+ * by a binary search (batches are time-ordered). Inside one, each event
+ * costs one read of a flat uint32 plane holding the last cycle the pixel
+ * responded in; the sums are only written on a pixel's first event of a
+ * cycle. Planes are allocated on the first enabled batch.
+ *
+ * Trigger events come from the same decoding thread as the CD events and
+ * are queued before those reach the accumulation thread, so an onset is
+ * known by the time its events are counted.
+ *
+ * update() must be called from a single thread (the accumulation thread);
+ * build_maps() and the getters may be used from any thread.
+ */
+class TriggerLatencyMap {
+public:
+    static constexpr size_t MAX_PENDING = 1024;   // Onsets queued ahead of the events
+
+    /**
+     * Array-wide figures of the pixels with enough responses
+     */
+    struct Summary {
+        uint64_t cycles = 0;            // Onsets counted since the last reset
+        int pixels = 0;                 // Pixels with at least min_cycles responses
+        double mean_us = 0.0;           // Mean over those pixels of their mean latency
+        double median_us = 0.0;         // Median of their mean latencies
+        double p95_us = 0.0;            // 95th percentile of their mean latencies
+        double mean_jitter_us = 0.0;    // Mean of their latency standard deviations
+    };
+
+    TriggerLatencyMap() = default;
+    ~TriggerLatencyMap() = default;
+
+    // Non-copyable
+    TriggerLatencyMap(const TriggerLatencyMap&) = delete;
+    TriggerLatencyMap& operator=(const TriggerLatencyMap&) = delete;
+
+    /**
+     * Set frame geometry and drop the planes (not while update() runs)
+     * @param width Frame width
+     * @param height Frame height
+     */
+    void configure(int width, int height);
+
+    /**
+     * Turn the map on or off and drop pending onsets
+     * @param enabled Consume trigger events and count responses
+     * @param window_us Time after an onset in which a pixel's first event is its response
+     */
+    void set_enabled(bool enabled, int64_t window_us);
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    int64_t get_window_us() const { return window_us_.load(std::memory_order_relaxed); }
+
+    /**
+     * Record a batch of trigger events (decoding thread)
+     */
+    void on_triggers(const Metavision::EventExtTrigger* begin, const Metavision::EventExtTrigger* end);
+
+    /**
+     * Count the responses in a batch of events
+     * @param begin First event (frame coordinates)
+     * @param end One past last event
+     */
+    void update(const Metavision::EventCD* begin, const Metavision::EventCD* end);
+
+    /**
+     * Zero the sums and cycle count (applied on the next batch)
+     */
+    void reset() { reset_requested_ = true; }
+
+    uint64_t get_cycles() const { return cycles_.load(std::memory_order_relaxed); }
+    uint64_t get_responses() const { return responses_.load(std::memory_order_relaxed); }
+    uint64_t get_onsets_dropped() const { return onsets_dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * Build the mean and jitter maps
+     * @param min_cycles Responses a pixel needs to be mapped (others are NaN)
+     * @param mean_us Output, CV_32FC1 mean latency in microseconds
+     * @param jitter_us Output, CV_32FC1 latency standard deviation in microseconds
+     * @param summary Output
+     * @return false if nothing has been counted
+     */
+    bool build_maps(int min_cycles, cv::Mat& mean_us, cv::Mat& jitter_us, Summary& summary) const;
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    std::atomic<bool> enabled_{false};
+    std::atomic<int64_t> window_us_{20000};
+    std::atomic<bool> reset_requested_{false};
+    std::atomic<uint64_t> cycles_{0};
+    std::atomic<uint64_t> responses_{0};
+    std::atomic<uint64_t> onsets_dropped_{0};
+
+    // Decoding thread -> accumulation thread (trigger rates are low; a mutex is enough)
+    std::mutex onsets_mutex_;
+    std::vector<int64_t> onsets_;
+    bool edge_high_ = false;            // Level after the last decoded edge
+
+    // Accumulation thread; the planes are read under planes_mutex_ by build_maps()
+    std::vector<int64_t> batch_onsets_;
+    uint32_t cycle_ = 0;                // Current cycle (0 = none yet)
+    int64_t onset_us_ = 0;
+    int64_t window_end_us_ = 0;         // Responses counted before this
+    mutable std::mutex planes_mutex_;
+    std::vector<uint32_t> responded_;   // Last cycle each pixel responded in
+    std::vector<uint32_t> counts_;      // Responses per pixel
+    std::vector<uint64_t> sums_;        // Latency sums (us)
+    std::vector<uint64_t> sums_sq_;     // Latency square sums (us^2)
+};
+
+} // namespace video
@@ -2,8 +2,10 @@
 
 #include <opencv2/opencv.hpp>
 #include <GL/glew.h>
-#include <atomic>
 #include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
 #include "video/frame_ref.h"
 
 namespace video {
@@ -12,25 +14,40 @@ namespace video {
  * Triple-buffered renderer for zero-stall GPU uploads
  *
  * Decouples frame production from GPU upload and rendering using 3 rotating buffers:
- * - Write buffer: CPU producing next frame
- * - Upload buffer: Being transferred to GPU (async via PBO)
- * - Display buffer: GPU rendering current frame
+ * - Upload slot: Being transferred to GPU (async via PBO)
+ * - Display slot: GPU rendering current frame
+ * - Spare slot: Previous display slot, reusable once the GPU stops sampling it
  *
- * **Performance Impact:**
- * - Eliminates GPU stalls from synchronous glTexImage2D
- * - Allows CPU and GPU to work in parallel
- * - Consistent 16.67ms frame times (true 60 FPS)
- * - Zero frame drops under load
+ * GL fence syncs guard both directions: a slot is only shown once its upload
+ * fence has signalled, and a slot is only overwritten once the fence placed
+ * after the last draw that sampled it has signalled. Neither check blocks.
+ *
+ * Single-channel frames use GL_R8 textures with a grayscale swizzle when the
+ * driver supports it; colour frames use GL_RGB. R8 slots only re-upload the
+ * row bands that changed since the slot's previous frame (see RowBands).
  *
  * **Usage:**
  * ```cpp
  * TripleBufferRenderer renderer;
  * renderer.submit_frame(std::move(frame));  // Non-blocking
- * renderer.render(quad_vao);                 // Always has latest
+ * renderer.update();                         // Once per UI frame, before drawing
+ * ImGui::Image(renderer.get_texture_id(), ...);
+ * renderer.end_frame();                      // After the draw calls are issued
  * ```
  */
 class TripleBufferRenderer {
 public:
+    /**
+     * Upload latency statistics (submit -> upload completed on GPU)
+     */
+    struct UploadStats {
+        double last_latency_ms{0.0};
+        double avg_latency_ms{0.0};       // Exponential moving average
+        double max_latency_ms{0.0};
+        uint64_t frames_uploaded{0};
+        uint64_t frames_skipped{0};       // Superseded before an upload slot was free
+    };
+
     TripleBufferRenderer();
     ~TripleBufferRenderer();
 
@@ -41,8 +58,8 @@ public:
     /**
      * Submit frame for rendering (non-blocking)
      *
-     * Writes to the write buffer and atomically swaps with upload buffer
-     * when ready. Never blocks the caller.
+     * Replaces any pending frame that has not started uploading yet.
+     * Never blocks the caller.
      *
      * @param frame_ref Frame to render (zero-copy via FrameRef)
      */
@@ -55,11 +72,19 @@ public:
      */
     void submit_frame(FrameRef&& frame_ref);
 
+    /**
+     * Create the textures and PBOs for a frame size ahead of the first frame (GL thread)
+     *
+     * Each slot goes through one blank upload, so the driver's first-use work
+     * happens here; nothing is displayed until a submitted frame is uploaded.
+     * @param channels Channels of the frames that will be submitted (1 or 3)
+     */
+    void prepare(int width, int height, int channels);
+
     /**
      * Get texture ID for rendering
      *
-     * Returns the display buffer texture. Always returns valid texture
-     * even if no frames submitted yet.
+     * Returns the display slot texture (0 until the first upload completes).
      *
      * @return OpenGL texture ID for rendering
      */
@@ -72,42 +97,77 @@ public:
     int get_height() const { return height_; }
 
     /**
-     * Process pending uploads (call once per frame)
+     * Get the frame currently displayed (ZERO-COPY)
+     */
+    FrameRef get_display_frame() const;
+
+    /**
+     * Process pending uploads (call once per frame on the GL thread)
      *
-     * Checks if upload is complete and swaps buffers if ready.
-     * This is where the async PBO upload happens.
+     * Promotes a finished upload to display and starts uploading the
+     * newest pending frame into a slot the GPU is no longer sampling.
      */
     void update();
 
+    /**
+     * Mark the end of a UI frame (call after draw calls using the texture)
+     *
+     * Places a fence so the display slot is not overwritten while the GPU
+     * may still be sampling it.
+     */
+    void end_frame();
+
+    /**
+     * Get upload latency statistics
+     */
+    UploadStats get_stats() const;
+
     /**
      * Reset renderer (clears all buffers)
      */
     void reset();
 
 private:
+    using Clock = std::chrono::steady_clock;
+
     struct BufferSlot {
         FrameRef frame;
         GLuint texture{0};
-        GLuint pbo{0};  // Pixel Buffer Object for async upload
-        std::atomic<bool> ready{false};
-        std::atomic<uint64_t> timestamp{0};
+        GLuint pbo{0};                  // Pixel Buffer Object for async upload
+        GLsync upload_fence{nullptr};   // Signalled when PBO -> texture copy is done
+        GLsync render_fence{nullptr};   // Signalled when last draw sampling it is done
+        RowBands texture_bands;         // Bands of the frame the texture holds (ALL = unknown)
+        Clock::time_point submit_time;
     };
 
-    void ensure_gl_resources_created(int width, int height);
+    void ensure_gl_resources_created(int width, int height, int channels);
     void create_texture(GLuint& texture_id);
     void create_pbo(GLuint& pbo_id, size_t size);
     void async_upload_frame(BufferSlot& slot);
 
+    /**
+     * Non-blocking fence check; deletes the fence once signalled
+     * @return true if fence is null or signalled
+     */
+    static bool fence_done(GLsync& fence);
+
     static constexpr int NUM_BUFFERS = 3;
     std::array<BufferSlot, NUM_BUFFERS> buffers_;
 
-    // Atomic indices for lock-free rotation
-    std::atomic<int> write_idx_{0};     // CPU writes here
-    std::atomic<int> upload_idx_{1};    // GPU uploads from here
-    std::atomic<int> display_idx_{2};   // GPU renders from here
+    int upload_idx_{-1};    // Slot with an upload in flight (-1 = none)
+    int display_idx_{-1};   // Slot being shown (-1 = nothing yet)
+
+    // Pending frame from submit_frame (may come from another thread)
+    mutable std::mutex pending_mutex_;
+    FrameRef pending_frame_;
+    Clock::time_point pending_time_;
+    bool has_pending_{false};
 
+    UploadStats stats_;
     int width_{0};
     int height_{0};
+    int channels_{0};
+    bool use_r8_{false};
     bool initialized_{false};
 };
 
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "video/binary_frame.h"
+
+namespace cv {
+class VideoWriter;
+}
+
+namespace video {
+
+/**
+ * Encodes a sequence of binary frames into a lossless video on its own thread
+ *
+ * Sharing a run's frames used to mean zipping thousands of PNGs. Frames are
+ * pushed bit-packed into a small ring of recycled BinaryFrame slots; the
+ * encoder thread unpacks each into one reused 0/255 image and hands it to
+ * FFmpeg's FFV1 through cv::VideoWriter (HuffYUV in .avi if FFV1 is not
+ * available). Both are intra-only, so every frame is a key frame and
+ * players seek to any frame exactly; sparse event frames compress to a
+ * small fraction of their PNG size.
+ *
+ * The video's frame rate is nominal (players need one): the sensor
+ * timestamp of every frame goes to <stem>_timestamps.csv next to it.
+ *
+ * push() waits for a free slot when the encoder falls behind (the queue is
+ * bounded at QUEUE_FRAMES), or returns false right away with wait = false,
+ * so an offline producer is paced by the encoder and the UI never blocks.
+ *
+ * **Usage:**
+ * ```cpp
+ * VideoExporter exporter;
+ * exporter.open("run.mkv", size, 1e6 / window_us);
+ * exporter.push(frame, timestamp_us);          // Producer thread, in time order
+ * exporter.close();                            // Drains the queue
+ * ```
+ */
+class VideoExporter {
+public:
+    static constexpr size_t QUEUE_FRAMES = 16;   // Packed frames queued for the encoder
+
+    VideoExporter() = default;
+    ~VideoExporter();
+
+    // Non-copyable
+    VideoExporter(const VideoExporter&) = delete;
+    VideoExporter& operator=(const VideoExporter&) = delete;
+
+    /**
+     * Open the video and start the encoder thread
+     * @param path Output file (.mkv or .avi; parent directories are created)
+     * @param size Frame size
+     * @param fps Nominal frame rate written to the container
+     * @return false if no lossless encoder could open path (see get_error())
+     */
+    bool open(const std::string& path, cv::Size size, double fps);
+
+    /**
+     * Queue a packed frame
+     * @param frame Frame of the opened size (copied into a slot)
+     * @param timestamp_us Sensor timestamp, for the timestamp sidecar
+     * @param wait Wait for a free slot if the queue is full
+     * @return false if not open, finished, the size differs or (wait = false) the queue is full
+     */
+    bool push(const BinaryFrame& frame, int64_t timestamp_us, bool wait = true);
+
+    /**
+     * Queue a CV_8UC1 frame (any non-zero pixel is set), packing it into a slot
+     */
+    bool push(const cv::Mat& frame, int64_t timestamp_us, bool wait = true);
+
+    /**
+     * No more frames: the encoder finishes the queue and closes the file (never blocks)
+     */
+    void finish();
+
+    /**
+     * Finish, wait for the encoder and close the file
+     * @return false if the video or the timestamp sidecar could not be written
+     */
+    bool close();
+
+    bool is_open() const { return thread_.joinable(); }
+
+    /**
+     * True once the encoder has written every frame after finish()
+     */
+    bool is_done() const { return done_.load(); }
+
+    const std::string& get_path() const { return path_; }
+    const std::string& get_codec() const { return codec_; }
+    std::string get_error() const;
+
+    // Statistics
+    int64_t get_written() const { return written_.load(std::memory_order_relaxed); }
+    size_t get_pending() const;
+    double get_encode_seconds() const { return encode_ns_.load(std::memory_order_relaxed) / 1e9; }
+
+    /**
+     * Sensor time encoded per second of encoder time (> 1 = faster than real time)
+     */
+    double get_speed() const;
+
+    /**
+     * Path of the timestamp sidecar of a video
+     */
+    static std::string timestamps_path(const std::string& video_path);
+
+private:
+    struct Slot {
+        BinaryFrame frame;
+        int64_t timestamp_us = 0;
+    };
+
+    int acquire_slot(bool wait);      // Free slot index, or -1
+    void submit_slot(int index);
+    void encoder_loop();
+
+    std::unique_ptr<cv::VideoWriter> writer_;   // Encoder thread only once started
+    std::ofstream timestamps_;
+    std::string path_;
+    std::string codec_;
+    cv::Size size_;
+
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable ready_cv_;    // Frame queued or finishing
+    std::condition_variable free_cv_;     // Slot returned
+    std::vector<Slot> slots_;
+    std::vector<int> free_;
+    std::deque<int> ready_;
+    bool finishing_ = false;
+    std::string error_;                   // Guarded by mutex_
+
+    std::atomic<bool> done_{false};
+    std::atomic<int64_t> written_{0};
+    std::atomic<int64_t> encode_ns_{0};
+    std::atomic<int64_t> first_timestamp_{-1};
+    std::atomic<int64_t> last_timestamp_{-1};
+};
+
+} // namespace video
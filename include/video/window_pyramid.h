@@ -0,0 +1,94 @@
+#pragma once
+
+#include "video/binary_frame.h"
+#include <metavision/sdk/base/utils/timestamp.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace video {
+
+/**
+ * Coarser accumulation windows OR-reduced from fine binary frames
+ *
+ * Fed the bit-packed frame of every fine window (BinaryFrameAccumulator
+ * with packed output), each level ORs it into its own frame and emits that
+ * at its window boundary. A pixel of a 10 ms frame is set if any 1 ms frame
+ * inside it was set, which is what a 10 ms accumulation would show; the
+ * events are only touched once, at the finest window.
+ *
+ * Level windows are whole multiples of the fine window, aligned to
+ * multiples of their own length in sensor time (like the accumulator's
+ * windows), so a 100 ms frame always covers exactly ten 10 ms frames.
+ *
+ * **PERFORMANCE:** One OR per level per fine frame, 64 pixels per word:
+ * ~15 K words for an HD frame, against millions of events re-accumulated.
+ *
+ * Not thread-safe: push() must be called from a single thread (the
+ * camera's accumulation thread).
+ */
+class WindowPyramid {
+public:
+    /// Output callback: level index, frame timestamp (end of window) and packed frame
+    using OutputCallback = std::function<void(int level, Metavision::timestamp, const BinaryFrame&)>;
+
+    static constexpr int MAX_LEVELS = 4;
+
+    WindowPyramid() = default;
+
+    // Non-copyable
+    WindowPyramid(const WindowPyramid&) = delete;
+    WindowPyramid& operator=(const WindowPyramid&) = delete;
+
+    /**
+     * Set up the levels, dropping any frames in progress
+     * @param fine_window_us Window of the frames given to push()
+     * @param windows_us Coarser windows, rounded to multiples of fine_window_us
+     *                   (windows not longer than fine_window_us are ignored)
+     * @return Number of levels
+     */
+    int configure(int fine_window_us, const std::vector<int>& windows_us);
+
+    /**
+     * Set callback invoked for every completed coarse window
+     * @param callback Output callback
+     */
+    void set_output_callback(OutputCallback callback);
+
+    /**
+     * Add one fine frame
+     * @param ts End of the fine window (multiple of fine_window_us)
+     * @param fine Packed fine frame
+     */
+    void push(Metavision::timestamp ts, const BinaryFrame& fine);
+
+    /**
+     * Drop the frames in progress (sensor time restarted)
+     */
+    void reset();
+
+    int levels() const { return static_cast<int>(levels_.size()); }
+    int window_us(int level) const { return levels_[level].window_us; }
+
+    /**
+     * Parse a comma-separated window list ("10000,100000"), skipping empty items
+     */
+    static std::vector<int> parse_windows(const std::string& list);
+
+private:
+    struct Level {
+        int window_us = 0;
+        BinaryFrame frame;
+        Metavision::timestamp window_end = -1;  // -1 = nothing accumulated
+    };
+
+    /**
+     * Hand a level's frame to the callback and start an empty one
+     */
+    void emit(int index);
+
+    std::vector<Level> levels_;
+    OutputCallback output_callback_;
+};
+
+} // namespace video
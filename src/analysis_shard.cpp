@@ -0,0 +1,674 @@
+#include "analysis_shard.h"
+#include "noise_analyzer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void put_signed(std::vector<uint8_t>& out, int64_t value) {
+    put_varint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void put_double(std::vector<uint8_t>& out, double value) {
+    uint8_t bytes[sizeof(double)];
+    std::memcpy(bytes, &value, sizeof(bytes));
+    out.insert(out.end(), bytes, bytes + sizeof(bytes));
+}
+
+void put_string(std::vector<uint8_t>& out, const std::string& text) {
+    put_varint(out, text.size());
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+void put_moments(std::vector<uint8_t>& out, const AnalysisShard::Moments& moments) {
+    put_varint(out, static_cast<uint64_t>(moments.n));
+    put_double(out, moments.mean);
+    put_double(out, moments.m2);
+    put_double(out, moments.min);
+    put_double(out, moments.max);
+}
+
+void put_totals(std::vector<uint8_t>& out, const std::vector<AnalysisShard::Totals>& totals) {
+    put_varint(out, totals.size());
+    for (const AnalysisShard::Totals& entry : totals) {
+        put_string(out, entry.name);
+        put_varint(out, static_cast<uint64_t>(entry.scattering_events));
+        put_varint(out, static_cast<uint64_t>(entry.missing_events));
+        put_varint(out, static_cast<uint64_t>(entry.max_scattering_pixels));
+    }
+}
+
+/**
+ * Bounds-checked reader: any overrun clears ok and yields zeros from then on
+ */
+struct Reader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7) {
+            const uint8_t byte = *p++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    int64_t signed_varint() {
+        const uint64_t value = varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    // Element counts are bounded by the bytes left, so corrupt input cannot request huge allocations
+    size_t count(size_t min_bytes_each = 1) {
+        const uint64_t value = varint();
+        if (value > static_cast<uint64_t>(end - p) / min_bytes_each) {
+            ok = false;
+            return 0;
+        }
+        return static_cast<size_t>(value);
+    }
+
+    double real() {
+        double value = 0.0;
+        if (end - p < static_cast<ptrdiff_t>(sizeof(double))) {
+            ok = false;
+            return value;
+        }
+        std::memcpy(&value, p, sizeof(double));
+        p += sizeof(double);
+        return value;
+    }
+
+    std::string text() {
+        const size_t size = count();
+        std::string value(reinterpret_cast<const char*>(p), size);
+        p += size;
+        return value;
+    }
+
+    AnalysisShard::Moments moments() {
+        AnalysisShard::Moments value;
+        value.n = static_cast<int64_t>(varint());
+        value.mean = real();
+        value.m2 = real();
+        value.min = real();
+        value.max = real();
+        return value;
+    }
+
+    std::vector<AnalysisShard::Totals> totals() {
+        std::vector<AnalysisShard::Totals> value(count(4));
+        for (AnalysisShard::Totals& entry : value) {
+            entry.name = text();
+            entry.scattering_events = static_cast<int64_t>(varint());
+            entry.missing_events = static_cast<int64_t>(varint());
+            entry.max_scattering_pixels = static_cast<int64_t>(varint());
+        }
+        return value;
+    }
+};
+
+bool same_names(const std::vector<AnalysisShard::Totals>& a, const std::vector<AnalysisShard::Totals>& b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](const AnalysisShard::Totals& x, const AnalysisShard::Totals& y) {
+               return x.name == y.name;
+           });
+}
+
+void merge_totals(std::vector<AnalysisShard::Totals>& into, const std::vector<AnalysisShard::Totals>& later) {
+    for (size_t i = 0; i < into.size(); ++i) {
+        into[i].scattering_events += later[i].scattering_events;
+        into[i].missing_events += later[i].missing_events;
+        into[i].max_scattering_pixels = std::max(into[i].max_scattering_pixels, later[i].max_scattering_pixels);
+    }
+}
+
+bool hotter(const ScatteringAnalyzer::HotPixel& a, const ScatteringAnalyzer::HotPixel& b) {
+    return a.count != b.count ? a.count > b.count : a.first_seen_frame < b.first_seen_frame;
+}
+
+} // namespace
+
+void AnalysisShard::Moments::add(double x) {
+    ++n;
+    const double delta = x - mean;
+    mean += delta / n;
+    m2 += delta * (x - mean);
+    min = std::min(min, x);
+    max = std::max(max, x);
+}
+
+void AnalysisShard::Moments::merge(const Moments& other) {
+    if (other.n == 0) return;
+    if (n == 0) {
+        *this = other;
+        return;
+    }
+    const int64_t total = n + other.n;
+    const double delta = other.mean - mean;
+    mean += delta * other.n / total;
+    m2 += other.m2 + delta * delta * (static_cast<double>(n) * other.n / total);
+    n = total;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+}
+
+double AnalysisShard::Moments::stddev() const {
+    return std::sqrt(variance());
+}
+
+void AnalysisShard::NoiseSummary::add(const NoiseAnalysisResults& results) {
+    num_dots.add(results.num_dots_detected);
+    signal_mean.add(results.signal_mean);
+    signal_std.add(results.signal_std);
+    noise_mean.add(results.noise_mean);
+    noise_std.add(results.noise_std);
+    snr_db.add(results.snr_db);
+    contrast_ratio.add(results.contrast_ratio);
+}
+
+void AnalysisShard::NoiseSummary::merge(const NoiseSummary& other) {
+    num_dots.merge(other.num_dots);
+    signal_mean.merge(other.signal_mean);
+    signal_std.merge(other.signal_std);
+    noise_mean.merge(other.noise_mean);
+    noise_std.merge(other.noise_std);
+    snr_db.merge(other.snr_db);
+    contrast_ratio.merge(other.contrast_ratio);
+}
+
+bool AnalysisShard::is_compatible(const AnalysisShard& later) const {
+    return width == later.width && height == later.height && reference_hash == later.reference_hash &&
+           window_size == later.window_size &&
+           clusters_enabled == later.clusters_enabled && same_names(regions, later.regions) &&
+           same_names(references, later.references) && plane_events.size() == later.plane_events.size() &&
+           tile_total.size() == later.tile_total.size();
+}
+
+bool AnalysisShard::merge(const AnalysisShard& later) {
+    if (frames > 0 && later.frames > 0 && !is_compatible(later)) {
+        return false;
+    }
+
+    NoiseSummary merged_noise = noise;
+    merged_noise.merge(later.noise);
+    const bool has_range = begin_timestamp != 0 || end_timestamp != 0;
+    const int64_t begin = has_range ? begin_timestamp : later.begin_timestamp;
+    const int64_t end = std::max(end_timestamp, later.end_timestamp);
+
+    if (later.frames == 0) {
+        // Nothing to add to the scattering side
+    } else if (frames == 0) {
+        *this = later;
+    } else {
+        // Counts: union of two raster-ordered lists; the later shard's frames follow ours
+        std::vector<Pixel> merged;
+        merged.reserve(pixels.size() + later.pixels.size());
+        auto a = pixels.begin();
+        auto b = later.pixels.begin();
+        while (a != pixels.end() || b != later.pixels.end()) {
+            if (b == later.pixels.end() || (a != pixels.end() && a->key < b->key)) {
+                merged.push_back(*a++);
+            } else if (a == pixels.end() || b->key < a->key) {
+                merged.push_back({b->key, b->count, b->first_seen + frames});
+                ++b;
+            } else {
+                merged.push_back({a->key, a->count + b->count, a->first_seen});
+                ++a;
+                ++b;
+            }
+        }
+        hot_pixels = merge_hot_pixels(merged, later);
+        pixels.swap(merged);
+
+        window_tail.insert(window_tail.end(), later.window_tail.begin(), later.window_tail.end());
+        if (window_tail.size() > static_cast<size_t>(window_size)) {
+            window_tail.erase(window_tail.begin(), window_tail.end() - window_size);
+        }
+
+        frames += later.frames;
+        total_scattering_events += later.total_scattering_events;
+        rate.merge(later.rate);
+
+        total_clusters += later.total_clusters;
+        total_single_pixel += later.total_single_pixel;
+        max_largest_pixels = std::max(max_largest_pixels, later.max_largest_pixels);
+        for (int bin = 0; bin < ScatteringAnalyzer::CLUSTER_BINS; ++bin) {
+            cluster_histogram[bin] += later.cluster_histogram[bin];
+        }
+
+        merge_totals(regions, later.regions);
+        merge_totals(references, later.references);
+        for (size_t i = 0; i < plane_events.size(); ++i) {
+            plane_events[i] += later.plane_events[i];
+        }
+        if (!tile_total.empty()) {
+            cv::Mat sum;   // Not in place: copies of a shard share the Mat
+            cv::add(tile_total, later.tile_total, sum);
+            tile_total = sum;
+        }
+    }
+
+    noise = merged_noise;
+    begin_timestamp = begin;
+    end_timestamp = end;
+    return true;
+}
+
+std::vector<ScatteringAnalyzer::HotPixel> AnalysisShard::merge_hot_pixels(const std::vector<Pixel>& merged,
+                                                                           const AnalysisShard& later) const {
+    // Top-K of the merged counts, ranked like ScatteringAnalyzer::publish_hot_pixels
+    std::vector<ScatteringAnalyzer::HotPixel> hot;
+    hot.reserve(merged.size());
+    for (const Pixel& pixel : merged) {
+        hot.push_back({cv::Point(static_cast<int>(pixel.key % width), static_cast<int>(pixel.key / width)),
+                       static_cast<int32_t>(std::min<int64_t>(pixel.count, INT32_MAX)),
+                       static_cast<int>(pixel.first_seen), static_cast<int>(pixel.first_seen)});
+    }
+    const size_t k = std::min(hot.size(), static_cast<size_t>(std::max(hot_pixel_k, 1)));
+    std::partial_sort(hot.begin(), hot.begin() + k, hot.end(), hotter);
+    hot.resize(k);
+
+    auto find_hot = [](const std::vector<ScatteringAnalyzer::HotPixel>& list, const cv::Point& location) {
+        return std::find_if(list.begin(), list.end(),
+                            [&](const ScatteringAnalyzer::HotPixel& entry) { return entry.location == location; });
+    };
+    auto find_pixel = [](const std::vector<Pixel>& list, uint32_t key) {
+        auto it = std::lower_bound(list.begin(), list.end(), key,
+                                   [](const Pixel& pixel, uint32_t value) { return pixel.key < value; });
+        return it != list.end() && it->key == key ? &*it : nullptr;
+    };
+
+    // Last seen: latest shard first, exact from its top-K, else its first frame there
+    for (ScatteringAnalyzer::HotPixel& entry : hot) {
+        const uint32_t key = static_cast<uint32_t>(entry.location.y) * width + entry.location.x;
+        auto later_hot = find_hot(later.hot_pixels, entry.location);
+        if (later_hot != later.hot_pixels.end()) {
+            entry.last_seen_frame = later_hot->last_seen_frame + static_cast<int>(frames);
+        } else if (const Pixel* pixel = find_pixel(later.pixels, key)) {
+            entry.last_seen_frame = static_cast<int>(pixel->first_seen + frames);
+        } else {
+            auto earlier_hot = find_hot(hot_pixels, entry.location);
+            if (earlier_hot != hot_pixels.end()) {
+                entry.last_seen_frame = earlier_hot->last_seen_frame;
+            }
+        }
+    }
+    return hot;
+}
+
+void AnalysisShard::publish(ScatteringAnalyzer::ScatteringData& data) const {
+    data.frames_analyzed = static_cast<int>(frames);
+    data.total_scattering_events = static_cast<int>(total_scattering_events);
+    data.average_scattering_per_frame = frames > 0 ? static_cast<float>(total_scattering_events) / frames : 0.0f;
+    data.scattering_std_per_frame = static_cast<float>(rate.stddev());
+    if (rate.n >= 2) {
+        // Same interval as ScatteringAnalyzer::update_confidence
+        double half_width = 3.0 / rate.n;
+        if (rate.mean > 0.0) {
+            const double p = candidate_pixels > 0 ? std::min(rate.mean / candidate_pixels, 1.0) : 0.0;
+            half_width = 1.96 * std::sqrt(std::max(rate.variance(), candidate_pixels * p * (1.0 - p)) / rate.n);
+        }
+        data.scattering_ci_half_width = static_cast<float>(half_width);
+    }
+
+    data.scattering_count = cv::Mat::zeros(height, width, CV_32SC1);
+    for (const Pixel& pixel : pixels) {
+        data.scattering_count.ptr<int32_t>(static_cast<int>(pixel.key / width))[pixel.key % width] =
+            static_cast<int32_t>(std::min<int64_t>(pixel.count, INT32_MAX));
+    }
+    data.hot_pixels = hot_pixels;
+    data.max_scattering_count = hot_pixels.empty() ? 0 : hot_pixels.front().count;
+    data.hot_spot_location = hot_pixels.empty() ? cv::Point(0, 0) : hot_pixels.front().location;
+
+    data.window_frames = static_cast<int>(window_tail.size());
+    data.window_scattering_events = 0;
+    for (int32_t pixels_in_frame : window_tail) {
+        data.window_scattering_events += pixels_in_frame;
+    }
+    data.window_average_per_frame = window_tail.empty()
+        ? 0.0f : static_cast<float>(data.window_scattering_events) / window_tail.size();
+
+    ScatteringAnalyzer::ClusterStats& clusters = data.clusters;
+    clusters.total_clusters = total_clusters;
+    clusters.total_single_pixel = total_single_pixel;
+    clusters.max_largest_pixels = static_cast<int>(max_largest_pixels);
+    clusters.average_clusters_per_frame = frames > 0 ? static_cast<float>(total_clusters) / frames : 0.0f;
+    std::copy(cluster_histogram.begin(), cluster_histogram.end(), clusters.total_histogram.begin());
+
+    // Rectangles and reference pixels are kept when the layout matches
+    if (data.regions.size() != regions.size()) {
+        data.regions.assign(regions.size(), ScatteringAnalyzer::RegionStats{});
+    }
+    for (size_t i = 0; i < regions.size(); ++i) {
+        ScatteringAnalyzer::RegionStats& stats = data.regions[i];
+        stats.name = regions[i].name;
+        stats.total_scattering_events = regions[i].scattering_events;
+        stats.total_missing_events = regions[i].missing_events;
+        stats.max_scattering_pixels = static_cast<int>(regions[i].max_scattering_pixels);
+        stats.average_scattering_per_frame = frames > 0 ? static_cast<float>(regions[i].scattering_events) / frames : 0.0f;
+        stats.average_missing_per_frame = frames > 0 ? static_cast<float>(regions[i].missing_events) / frames : 0.0f;
+    }
+    if (data.references.size() != references.size()) {
+        data.references.assign(references.size(), ScatteringAnalyzer::ReferenceStats{});
+    }
+    for (size_t i = 0; i < references.size(); ++i) {
+        ScatteringAnalyzer::ReferenceStats& stats = data.references[i];
+        stats.name = references[i].name;
+        stats.total_scattering_events = references[i].scattering_events;
+        stats.total_missing_events = references[i].missing_events;
+        stats.average_scattering_per_frame = frames > 0 ? static_cast<float>(references[i].scattering_events) / frames : 0.0f;
+        stats.average_missing_per_frame = frames > 0 ? static_cast<float>(references[i].missing_events) / frames : 0.0f;
+    }
+    data.planes.resize(plane_events.size());
+    for (size_t i = 0; i < plane_events.size(); ++i) {
+        data.planes[i].total_scattering_events = plane_events[i];
+        data.planes[i].average_scattering_per_frame = frames > 0 ? static_cast<float>(plane_events[i]) / frames : 0.0f;
+    }
+
+    data.tile_scattering_total = tile_total.clone();
+    data.hot_tile = cv::Point(0, 0);
+    if (!tile_total.empty()) {
+        cv::minMaxLoc(tile_total, nullptr, nullptr, nullptr, &data.hot_tile);
+    }
+}
+
+bool AnalysisShard::export_summary_csv(const std::string& filepath) const {
+    std::ofstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "AnalysisShard: Cannot open " << filepath << " for writing" << std::endl;
+        return false;
+    }
+
+    ScatteringAnalyzer::ScatteringData data;
+    publish(data);
+
+    // Scalars use the first two columns; hot pixel rows fill the rest
+    file << "metric,value,x,y,first_seen_frame,last_seen_frame\n";
+    file << std::setprecision(10);
+    file << "begin_timestamp_us," << begin_timestamp << ",,,,\n";
+    file << "end_timestamp_us," << end_timestamp << ",,,,\n";
+    file << "frames_analyzed," << frames << ",,,,\n";
+    file << "total_scattering_events," << total_scattering_events << ",,,,\n";
+    file << "average_scattering_per_frame," << data.average_scattering_per_frame << ",,,,\n";
+    file << "scattering_std_per_frame," << data.scattering_std_per_frame << ",,,,\n";
+    file << "scattering_ci_half_width," << data.scattering_ci_half_width << ",,,,\n";
+    file << "touched_pixels," << pixels.size() << ",,,,\n";
+    if (window_size > 0) {
+        file << "window_frames," << data.window_frames << ",,,,\n";
+        file << "window_average_per_frame," << data.window_average_per_frame << ",,,,\n";
+    }
+    if (clusters_enabled) {
+        file << "total_clusters," << total_clusters << ",,,,\n";
+        file << "total_single_pixel_clusters," << total_single_pixel << ",,,,\n";
+        file << "max_largest_cluster_pixels," << max_largest_pixels << ",,,,\n";
+    }
+    for (const Totals& region : regions) {
+        file << "region_" << region.name << "_scattering_events," << region.scattering_events << ",,,,\n";
+    }
+
+    const std::pair<const char*, const Moments*> noise_rows[] = {
+        {"num_dots", &noise.num_dots}, {"signal_mean", &noise.signal_mean}, {"signal_std", &noise.signal_std},
+        {"noise_mean", &noise.noise_mean}, {"noise_std", &noise.noise_std}, {"snr_db", &noise.snr_db},
+        {"contrast_ratio", &noise.contrast_ratio}};
+    for (const auto& row : noise_rows) {
+        if (row.second->n == 0) continue;
+        file << row.first << "_mean," << row.second->mean << ",,,,\n";
+        file << row.first << "_std," << row.second->stddev() << ",,,,\n";
+        file << row.first << "_min," << row.second->min << ",,,,\n";
+        file << row.first << "_max," << row.second->max << ",,,,\n";
+    }
+
+    for (size_t i = 0; i < hot_pixels.size(); ++i) {
+        const ScatteringAnalyzer::HotPixel& hot = hot_pixels[i];
+        file << "hot_pixel_" << i + 1 << "," << hot.count << "," << hot.location.x << "," << hot.location.y << ","
+             << hot.first_seen_frame << "," << hot.last_seen_frame << "\n";
+    }
+    return file.good();
+}
+
+uint64_t AnalysisShard::hash_reference(const video::BinaryFrame& reference) {
+    uint64_t hash = 14695981039346656037ULL;
+    const uint64_t* words = reference.data();
+    for (size_t i = 0; i < reference.word_count(); ++i) {
+        hash = (hash ^ words[i]) * 1099511628211ULL;
+    }
+    return (hash ^ static_cast<uint64_t>(reference.width())) * 1099511628211ULL;
+}
+
+void AnalysisShard::serialize(std::vector<uint8_t>& out) const {
+    out.clear();
+    put_varint(out, static_cast<uint64_t>(width));
+    put_varint(out, static_cast<uint64_t>(height));
+    put_varint(out, reference_hash);
+    put_signed(out, begin_timestamp);
+    put_signed(out, end_timestamp);
+
+    put_varint(out, static_cast<uint64_t>(frames));
+    put_varint(out, static_cast<uint64_t>(total_scattering_events));
+    put_varint(out, static_cast<uint64_t>(candidate_pixels));
+    put_moments(out, rate);
+
+    // Raster gaps are mostly small, so a touched pixel costs a few bytes
+    put_varint(out, pixels.size());
+    uint32_t previous = 0;
+    for (const Pixel& pixel : pixels) {
+        put_varint(out, pixel.key - previous);
+        put_varint(out, static_cast<uint64_t>(pixel.count));
+        put_varint(out, static_cast<uint64_t>(pixel.first_seen));
+        previous = pixel.key;
+    }
+    put_varint(out, static_cast<uint64_t>(hot_pixel_k));
+    put_varint(out, hot_pixels.size());
+    for (const ScatteringAnalyzer::HotPixel& hot : hot_pixels) {
+        put_varint(out, static_cast<uint64_t>(hot.location.x));
+        put_varint(out, static_cast<uint64_t>(hot.location.y));
+        put_varint(out, static_cast<uint64_t>(hot.count));
+        put_varint(out, static_cast<uint64_t>(hot.first_seen_frame));
+        put_varint(out, static_cast<uint64_t>(hot.last_seen_frame));
+    }
+
+    put_varint(out, static_cast<uint64_t>(window_size));
+    put_varint(out, window_tail.size());
+    for (int32_t pixels_in_frame : window_tail) {
+        put_varint(out, static_cast<uint64_t>(pixels_in_frame));
+    }
+
+    put_varint(out, clusters_enabled ? 1 : 0);
+    put_varint(out, static_cast<uint64_t>(total_clusters));
+    put_varint(out, static_cast<uint64_t>(total_single_pixel));
+    put_varint(out, static_cast<uint64_t>(max_largest_pixels));
+    for (int64_t bin : cluster_histogram) {
+        put_varint(out, static_cast<uint64_t>(bin));
+    }
+
+    put_totals(out, regions);
+    put_totals(out, references);
+    put_varint(out, plane_events.size());
+    for (int64_t events : plane_events) {
+        put_varint(out, static_cast<uint64_t>(events));
+    }
+    put_varint(out, static_cast<uint64_t>(tile_total.rows));
+    put_varint(out, static_cast<uint64_t>(tile_total.cols));
+    for (int ty = 0; ty < tile_total.rows; ++ty) {
+        const int32_t* row = tile_total.ptr<int32_t>(ty);
+        for (int tx = 0; tx < tile_total.cols; ++tx) {
+            put_varint(out, static_cast<uint64_t>(row[tx]));
+        }
+    }
+
+    put_moments(out, noise.num_dots);
+    put_moments(out, noise.signal_mean);
+    put_moments(out, noise.signal_std);
+    put_moments(out, noise.noise_mean);
+    put_moments(out, noise.noise_std);
+    put_moments(out, noise.snr_db);
+    put_moments(out, noise.contrast_ratio);
+}
+
+bool AnalysisShard::deserialize(const uint8_t* data, size_t size) {
+    Reader in{data, data + size};
+    AnalysisShard shard;
+    shard.width = static_cast<int>(in.varint());
+    shard.height = static_cast<int>(in.varint());
+    shard.reference_hash = in.varint();
+    shard.begin_timestamp = in.signed_varint();
+    shard.end_timestamp = in.signed_varint();
+
+    shard.frames = static_cast<int64_t>(in.varint());
+    shard.total_scattering_events = static_cast<int64_t>(in.varint());
+    shard.candidate_pixels = static_cast<int64_t>(in.varint());
+    shard.rate = in.moments();
+
+    const uint64_t total_pixels = static_cast<uint64_t>(shard.width) * shard.height;
+    shard.pixels.resize(in.count(3));
+    uint64_t key = 0;
+    for (Pixel& pixel : shard.pixels) {
+        key += in.varint();
+        pixel.key = static_cast<uint32_t>(key);
+        pixel.count = static_cast<int64_t>(in.varint());
+        pixel.first_seen = static_cast<int64_t>(in.varint());
+        if (key >= total_pixels) {
+            in.ok = false;
+            break;
+        }
+    }
+    shard.hot_pixel_k = static_cast<int>(in.varint());
+    shard.hot_pixels.resize(in.count(5));
+    for (ScatteringAnalyzer::HotPixel& hot : shard.hot_pixels) {
+        hot.location.x = static_cast<int>(in.varint());
+        hot.location.y = static_cast<int>(in.varint());
+        hot.count = static_cast<int32_t>(in.varint());
+        hot.first_seen_frame = static_cast<int>(in.varint());
+        hot.last_seen_frame = static_cast<int>(in.varint());
+    }
+
+    shard.window_size = static_cast<int>(in.varint());
+    shard.window_tail.resize(in.count());
+    for (int32_t& pixels_in_frame : shard.window_tail) {
+        pixels_in_frame = static_cast<int32_t>(in.varint());
+    }
+
+    shard.clusters_enabled = in.varint() != 0;
+    shard.total_clusters = static_cast<int64_t>(in.varint());
+    shard.total_single_pixel = static_cast<int64_t>(in.varint());
+    shard.max_largest_pixels = static_cast<int64_t>(in.varint());
+    for (int64_t& bin : shard.cluster_histogram) {
+        bin = static_cast<int64_t>(in.varint());
+    }
+
+    shard.regions = in.totals();
+    shard.references = in.totals();
+    shard.plane_events.resize(in.count());
+    for (int64_t& events : shard.plane_events) {
+        events = static_cast<int64_t>(in.varint());
+    }
+    const size_t tile_rows = in.count();
+    const size_t tile_cols = in.count();
+    if (in.ok && tile_rows * tile_cols > 0) {
+        if (tile_rows * tile_cols > static_cast<size_t>(in.end - in.p)) {
+            return false;
+        }
+        shard.tile_total.create(static_cast<int>(tile_rows), static_cast<int>(tile_cols), CV_32SC1);
+        for (int ty = 0; ty < shard.tile_total.rows; ++ty) {
+            int32_t* row = shard.tile_total.ptr<int32_t>(ty);
+            for (int tx = 0; tx < shard.tile_total.cols; ++tx) {
+                row[tx] = static_cast<int32_t>(in.varint());
+            }
+        }
+    }
+
+    shard.noise.num_dots = in.moments();
+    shard.noise.signal_mean = in.moments();
+    shard.noise.signal_std = in.moments();
+    shard.noise.noise_mean = in.moments();
+    shard.noise.noise_std = in.moments();
+    shard.noise.snr_db = in.moments();
+    shard.noise.contrast_ratio = in.moments();
+
+    if (!in.ok || in.p != in.end) {
+        return false;
+    }
+    *this = std::move(shard);
+    return true;
+}
+
+bool AnalysisShard::save(const std::string& path) const {
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(parent, ec);
+    }
+    std::vector<uint8_t> body;
+    serialize(body);
+
+    // Write a temporary file first so a crash mid-write keeps the previous shard
+    const std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "AnalysisShard: Cannot open " << temp_path << " for writing" << std::endl;
+            return false;
+        }
+        file.write(analysis_shard::FILE_MAGIC, sizeof(analysis_shard::FILE_MAGIC));
+        file.write(reinterpret_cast<const char*>(&analysis_shard::VERSION), sizeof(analysis_shard::VERSION));
+        file.write(reinterpret_cast<const char*>(body.data()), static_cast<std::streamsize>(body.size()));
+        if (!file.good()) {
+            std::cerr << "AnalysisShard: Failed to write " << temp_path << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        std::cerr << "AnalysisShard: Cannot replace " << path << ": " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool AnalysisShard::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "AnalysisShard: Cannot open " << path << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    const size_t header_bytes = sizeof(analysis_shard::FILE_MAGIC) + sizeof(uint32_t);
+    uint32_t version = 0;
+    if (bytes.size() >= header_bytes) {
+        std::memcpy(&version, bytes.data() + sizeof(analysis_shard::FILE_MAGIC), sizeof(version));
+    }
+    if (bytes.size() < header_bytes ||
+        std::memcmp(bytes.data(), analysis_shard::FILE_MAGIC, sizeof(analysis_shard::FILE_MAGIC)) != 0 ||
+        version != analysis_shard::VERSION) {
+        std::cerr << "AnalysisShard: " << path << " is not a version " << analysis_shard::VERSION << " shard" << std::endl;
+        return false;
+    }
+    if (!deserialize(bytes.data() + header_bytes, bytes.size() - header_bytes)) {
+        std::cerr << "AnalysisShard: " << path << " is corrupt" << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -66,7 +66,8 @@ bool AppConfig::load(const std::string& filename) {
 
         // Trim key and value
         key = key.substr(0, key.find_last_not_of(" \t") + 1);
-        value = value.substr(value.find_first_not_of(" \t"));
+        const size_t value_start = value.find_first_not_of(" \t");
+        value = value_start == std::string::npos ? std::string() : value.substr(value_start);  // "key =" -> empty
 
         // Parse settings based on section
         if (section == "Camera") {
@@ -77,15 +78,229 @@ bool AppConfig::load(const std::string& filename) {
             else if (key == "bias_hpf") camera_settings_.bias_hpf = std::stoi(value);
             else if (key == "bias_refr") camera_settings_.bias_refr = std::stoi(value);
             else if (key == "accumulation_time_us") camera_settings_.accumulation_time_us = std::stoi(value);
+            else if (key == "native_accumulation") camera_settings_.native_accumulation = (value == "true" || value == "1");
+            else if (key == "polarity_planes") camera_settings_.polarity_planes = (value == "true" || value == "1");
+            else if (key == "preview_binning") camera_settings_.preview_binning = std::stoi(value);
+            else if (key == "accumulation_threads") camera_settings_.accumulation_threads = std::stoi(value);
+            else if (key == "raw_decode") camera_settings_.raw_decode = (value == "true" || value == "1");
+            else if (key == "slice_mode") camera_settings_.slice_mode = std::stoi(value);
+            else if (key == "slice_events") camera_settings_.slice_events = std::stoi(value);
+            else if (key == "accumulation_windows_us") camera_settings_.accumulation_windows_us = value;
+            else if (key == "accumulation_adaptive") camera_settings_.accumulation_adaptive = (value == "true" || value == "1");
+            else if (key == "accumulation_adaptive_target") camera_settings_.accumulation_adaptive_target = std::stoi(value);
+            else if (key == "accumulation_adaptive_events") camera_settings_.accumulation_adaptive_events = std::stoi(value);
+            else if (key == "accumulation_adaptive_occupancy") camera_settings_.accumulation_adaptive_occupancy = std::stof(value);
+            else if (key == "accumulation_adaptive_min_us") camera_settings_.accumulation_adaptive_min_us = std::stoi(value);
+            else if (key == "accumulation_adaptive_max_us") camera_settings_.accumulation_adaptive_max_us = std::stoi(value);
+            else if (key == "camera_count") camera_settings_.camera_count = std::stoi(value);
+            else if (key == "camera_serial_cache") camera_settings_.camera_serial_cache = value;
+            else if (key == "latency_budget_ms") camera_settings_.latency_budget_ms = std::stoi(value);
+            else if (key == "latency_shed_mode") camera_settings_.latency_shed_mode = std::stoi(value);
+            else if (key == "qos_enabled") camera_settings_.qos_enabled = (value == "true" || value == "1");
+            else if (key == "qos_latency_ms") camera_settings_.qos_latency_ms = std::stoi(value);
+            else if (key == "qos_queue_percent") camera_settings_.qos_queue_percent = std::stoi(value);
+            else if (key == "qos_decimation") camera_settings_.qos_decimation = std::stoi(value);
+            else if (key == "qos_hold_ms") camera_settings_.qos_hold_ms = std::stoi(value);
+            else if (key == "roi_enabled") camera_settings_.roi_enabled = (value == "true" || value == "1");
+            else if (key == "roi_x") camera_settings_.roi_x = std::stoi(value);
+            else if (key == "roi_y") camera_settings_.roi_y = std::stoi(value);
+            else if (key == "roi_width") camera_settings_.roi_width = std::stoi(value);
+            else if (key == "roi_height") camera_settings_.roi_height = std::stoi(value);
+            else if (key == "erc_auto") camera_settings_.erc_auto = (value == "true" || value == "1");
+            else if (key == "erc_min_kevps") camera_settings_.erc_min_kevps = std::stoi(value);
+            else if (key == "erc_max_kevps") camera_settings_.erc_max_kevps = std::stoi(value);
+            else if (key == "erc_high_water_percent") camera_settings_.erc_high_water_percent = std::stoi(value);
+            else if (key == "erc_low_water_percent") camera_settings_.erc_low_water_percent = std::stoi(value);
+            else if (key == "erc_interval_ms") camera_settings_.erc_interval_ms = std::stoi(value);
+            else if (key == "monitoring_interval_ms") camera_settings_.monitoring_interval_ms = std::stoi(value);
+            else if (key == "reconnect_stall_ms") camera_settings_.reconnect_stall_ms = std::stoi(value);
             else if (key == "binary_bit_1") camera_settings_.binary_bit_1 = std::stoi(value);
             else if (key == "binary_bit_2") camera_settings_.binary_bit_2 = std::stoi(value);
+            else if (key == "time_surface_display") camera_settings_.time_surface_display = (value == "true" || value == "1");
+            else if (key == "time_surface_decay_us") camera_settings_.time_surface_decay_us = std::stoi(value);
             else if (key == "trail_filter_enabled") camera_settings_.trail_filter_enabled = (value == "true" || value == "1");
             else if (key == "trail_filter_type") camera_settings_.trail_filter_type = std::stoi(value);
             else if (key == "trail_filter_threshold") camera_settings_.trail_filter_threshold = std::stoi(value);
+            else if (key == "noise_filter_enabled") camera_settings_.noise_filter_enabled = (value == "true" || value == "1");
+            else if (key == "noise_filter_threshold_us") camera_settings_.noise_filter_threshold_us = std::stoi(value);
+            else if (key == "pixel_rate_monitor_enabled") camera_settings_.pixel_rate_monitor_enabled = (value == "true" || value == "1");
+            else if (key == "pixel_rate_half_life_ms") camera_settings_.pixel_rate_half_life_ms = std::stoi(value);
+            else if (key == "pixel_rate_sigma") camera_settings_.pixel_rate_sigma = std::stof(value);
+            else if (key == "hot_pixel_mask_file") camera_settings_.hot_pixel_mask_file = value;
+            else if (key == "hot_pixel_suppress") camera_settings_.hot_pixel_suppress = (value == "true" || value == "1");
+            else if (key == "hot_pixel_suppress_hardware") camera_settings_.hot_pixel_suppress_hardware = (value == "true" || value == "1");
+            else if (key == "event_interval_histogram") camera_settings_.event_interval_histogram = (value == "true" || value == "1");
+            else if (key == "line_defect_enabled") camera_settings_.line_defect_enabled = (value == "true" || value == "1");
+            else if (key == "line_defect_sigma") camera_settings_.line_defect_sigma = std::stof(value);
+            else if (key == "line_defect_min_fill") camera_settings_.line_defect_min_fill = std::stof(value);
+            else if (key == "line_defect_min_frames") camera_settings_.line_defect_min_frames = std::stoi(value);
+            else if (key == "toggle_analysis_enabled") camera_settings_.toggle_analysis_enabled = (value == "true" || value == "1");
+            else if (key == "toggle_window_frames") camera_settings_.toggle_window_frames = std::stoi(value);
+            else if (key == "toggle_stuck_frames") camera_settings_.toggle_stuck_frames = std::stoi(value);
+            else if (key == "toggle_flicker_rate") camera_settings_.toggle_flicker_rate = std::stof(value);
+            else if (key == "antiflicker_auto") camera_settings_.antiflicker_auto = (value == "true" || value == "1");
+            else if (key == "antiflicker_auto_margin_hz") camera_settings_.antiflicker_auto_margin_hz = std::stoi(value);
             else if (key == "capture_directory") camera_settings_.capture_directory = value;
+            else if (key == "png_profile") camera_settings_.png_profile = std::stoi(value);
+            else if (key == "png_bilevel") camera_settings_.png_bilevel = (value == "true" || value == "1");
+            else if (key == "capture_dedup_distance") camera_settings_.capture_dedup_distance = std::stoi(value);
+            else if (key == "capture_catalog") camera_settings_.capture_catalog = (value == "true" || value == "1");
+            else if (key == "catalog_threads") camera_settings_.catalog_threads = std::stoi(value);
+            else if (key == "image_cache_mb") camera_settings_.image_cache_mb = std::stoi(value);
+            else if (key == "image_prefetch") camera_settings_.image_prefetch = std::stoi(value);
+            else if (key == "gallery_threads") camera_settings_.gallery_threads = std::stoi(value);
+            else if (key == "recording_directory") camera_settings_.recording_directory = value;
+            else if (key == "recording_preallocate_mb") camera_settings_.recording_preallocate_mb = std::stoi(value);
+            else if (key == "recording_compress_threads") camera_settings_.recording_compress_threads = std::stoi(value);
+            else if (key == "burst_pre_s") camera_settings_.burst_pre_s = std::stod(value);
+            else if (key == "burst_post_s") camera_settings_.burst_post_s = std::stod(value);
+            else if (key == "burst_max_mb") camera_settings_.burst_max_mb = std::stoi(value);
+            else if (key == "history_s") camera_settings_.history_s = std::stod(value);
+            else if (key == "history_max_mb") camera_settings_.history_max_mb = std::stoi(value);
+            else if (key == "memory_budget_mb") camera_settings_.memory_budget_mb = std::stoi(value);
+            else if (key == "trigger_capture") camera_settings_.trigger_capture = (value == "true" || value == "1");
+            else if (key == "trigger_window_us") camera_settings_.trigger_window_us = std::stoi(value);
+            else if (key == "trigger_latency_map") camera_settings_.trigger_latency_map = (value == "true" || value == "1");
+            else if (key == "trigger_latency_window_us") camera_settings_.trigger_latency_window_us = std::stoi(value);
+            else if (key == "trigger_latency_min_cycles") camera_settings_.trigger_latency_min_cycles = std::stoi(value);
+            else if (key == "merge_streams") camera_settings_.merge_streams = (value == "true" || value == "1");
+            else if (key == "merge_window_us") camera_settings_.merge_window_us = std::stoi(value);
+            else if (key == "merge_buffer_events") camera_settings_.merge_buffer_events = std::stoi(value);
+            else if (key == "merge_max_wait_ms") camera_settings_.merge_max_wait_ms = std::stoi(value);
         }
         else if (section == "Runtime") {
             if (key == "debug_mode") runtime_settings_.debug_mode = (value == "true" || value == "1");
+            else if (key == "triple_buffer_display") runtime_settings_.triple_buffer_display = (value == "true" || value == "1");
+            else if (key == "gpu_pipeline") runtime_settings_.gpu_pipeline = (value == "true" || value == "1");
+            else if (key == "shader_display") runtime_settings_.shader_display = (value == "true" || value == "1");
+            else if (key == "gpu_event_scatter") runtime_settings_.gpu_event_scatter = (value == "true" || value == "1");
+            else if (key == "ui_max_fps") runtime_settings_.ui_max_fps = std::stoi(value);
+            else if (key == "ui_idle_fps") runtime_settings_.ui_idle_fps = std::stoi(value);
+            else if (key == "low_latency_present") runtime_settings_.low_latency_present = (value == "true" || value == "1");
+            else if (key == "late_latch") runtime_settings_.late_latch = (value == "true" || value == "1");
+            else if (key == "replay_file") runtime_settings_.replay_file = value;
+            else if (key == "replay_speed") runtime_settings_.replay_speed = std::stod(value);
+            else if (key == "replay_loop") runtime_settings_.replay_loop = (value == "true" || value == "1");
+            else if (key == "replay_start_s") runtime_settings_.replay_start_s = std::stod(value);
+            else if (key == "replay_decode_threads") runtime_settings_.replay_decode_threads = std::stoi(value);
+            else if (key == "metrics_export") runtime_settings_.metrics_export = std::stoi(value);
+            else if (key == "metrics_port") runtime_settings_.metrics_port = std::stoi(value);
+            else if (key == "metrics_statsd_host") runtime_settings_.metrics_statsd_host = value;
+            else if (key == "metrics_statsd_port") runtime_settings_.metrics_statsd_port = std::stoi(value);
+            else if (key == "metrics_interval_ms") runtime_settings_.metrics_interval_ms = std::stoi(value);
+            else if (key == "metrics_prefix") runtime_settings_.metrics_prefix = value;
+            else if (key == "shm_publish") runtime_settings_.shm_publish = (value == "true" || value == "1");
+            else if (key == "shm_name") runtime_settings_.shm_name = value;
+            else if (key == "shm_frame_slots") runtime_settings_.shm_frame_slots = std::stoi(value);
+            else if (key == "shm_packed") runtime_settings_.shm_packed = (value == "true" || value == "1");
+            else if (key == "shm_event_slots") runtime_settings_.shm_event_slots = std::stoi(value);
+            else if (key == "shm_event_slot_events") runtime_settings_.shm_event_slot_events = std::stoi(value);
+            else if (key == "stream_enabled") runtime_settings_.stream_enabled = (value == "true" || value == "1");
+            else if (key == "stream_port") runtime_settings_.stream_port = std::stoi(value);
+            else if (key == "stream_max_fps") runtime_settings_.stream_max_fps = std::stoi(value);
+            else if (key == "stream_max_clients") runtime_settings_.stream_max_clients = std::stoi(value);
+            else if (key == "stream_preview") runtime_settings_.stream_preview = (value == "true" || value == "1");
+            else if (key == "analyzer_plugins") runtime_settings_.analyzer_plugins = value;
+            else if (key == "analyzer_threads") runtime_settings_.analyzer_threads = std::stoi(value);
+            else if (key == "pipeline_stages") runtime_settings_.pipeline_stages = value;
+            else if (key == "pipeline_stage_threads") runtime_settings_.pipeline_stage_threads = std::stoi(value);
+            else if (key == "backend_autotune") runtime_settings_.backend_autotune = (value == "true" || value == "1");
+            else if (key == "backend_cache") runtime_settings_.backend_cache = value;
+            else if (key == "backend_overrides") runtime_settings_.backend_overrides = value;
+            else if (key == "warmup") runtime_settings_.warmup = (value == "true" || value == "1");
+            else if (key == "shader_cache") runtime_settings_.shader_cache = value;
+            else if (key == "fleet_report") runtime_settings_.fleet_report = (value == "true" || value == "1");
+            else if (key == "fleet_host") runtime_settings_.fleet_host = value;
+            else if (key == "fleet_port") runtime_settings_.fleet_port = std::stoi(value);
+            else if (key == "fleet_station") runtime_settings_.fleet_station = value;
+            else if (key == "fleet_aggregate") runtime_settings_.fleet_aggregate = (value == "true" || value == "1");
+            else if (key == "fleet_shards") runtime_settings_.fleet_shards = std::stoi(value);
+            else if (key == "fleet_directory") runtime_settings_.fleet_directory = value;
+            else if (key == "fleet_stale_s") runtime_settings_.fleet_stale_s = std::stoi(value);
+            else if (key == "trend_history_file") runtime_settings_.trend_history_file = value;
+            else if (key == "run_log_directory") runtime_settings_.run_log_directory = value;
+            else if (key == "run_report") runtime_settings_.run_report = (value == "true" || value == "1");
+            else if (key == "flight_recorder") runtime_settings_.flight_recorder = (value == "true" || value == "1");
+            else if (key == "flight_directory") runtime_settings_.flight_directory = value;
+            else if (key == "flight_window_s") runtime_settings_.flight_window_s = std::stoi(value);
+            else if (key == "flight_spike_ms") runtime_settings_.flight_spike_ms = std::stoi(value);
+            else if (key == "flight_gap_ms") runtime_settings_.flight_gap_ms = std::stoi(value);
+            else if (key == "flight_cooldown_s") runtime_settings_.flight_cooldown_s = std::stoi(value);
+            else if (key == "headless") runtime_settings_.headless = (value == "true" || value == "1");
+            else if (key == "headless_reference") runtime_settings_.headless_reference = value;
+            else if (key == "headless_capture_interval_s") runtime_settings_.headless_capture_interval_s = std::stoi(value);
+            else if (key == "headless_duration_s") runtime_settings_.headless_duration_s = std::stoi(value);
+            else if (key == "soak") runtime_settings_.soak = (value == "true" || value == "1");
+            else if (key == "soak_interval_s") runtime_settings_.soak_interval_s = std::stoi(value);
+            else if (key == "soak_warmup_s") runtime_settings_.soak_warmup_s = std::stoi(value);
+            else if (key == "soak_max_rss_growth_mb") runtime_settings_.soak_max_rss_growth_mb = std::stod(value);
+            else if (key == "soak_max_private_growth_mb") runtime_settings_.soak_max_private_growth_mb = std::stod(value);
+            else if (key == "soak_max_handle_growth") runtime_settings_.soak_max_handle_growth = std::stoi(value);
+            else if (key == "soak_max_gl_growth") runtime_settings_.soak_max_gl_growth = std::stoi(value);
+            else if (key == "dark_calibration") runtime_settings_.dark_calibration = (value == "true" || value == "1");
+            else if (key == "dark_calibration_s") runtime_settings_.dark_calibration_s = std::stoi(value);
+            else if (key == "dark_calibration_sigma") runtime_settings_.dark_calibration_sigma = std::stof(value);
+            else if (key == "dark_calibration_min_rate_hz") runtime_settings_.dark_calibration_min_rate_hz = std::stof(value);
+            else if (key == "bias_sweep") runtime_settings_.bias_sweep = (value == "true" || value == "1");
+            else if (key == "sweep_bias_diff_on") runtime_settings_.sweep_bias_diff_on = value;
+            else if (key == "sweep_bias_diff_off") runtime_settings_.sweep_bias_diff_off = value;
+            else if (key == "sweep_bias_hpf") runtime_settings_.sweep_bias_hpf = value;
+            else if (key == "sweep_bias_refr") runtime_settings_.sweep_bias_refr = value;
+            else if (key == "sweep_settle_ms") runtime_settings_.sweep_settle_ms = std::stoi(value);
+            else if (key == "sweep_auto_settle") runtime_settings_.sweep_auto_settle = (value == "true" || value == "1");
+            else if (key == "sweep_settle_tolerance_percent") runtime_settings_.sweep_settle_tolerance_percent = std::stof(value);
+            else if (key == "sweep_frames") runtime_settings_.sweep_frames = std::stoi(value);
+            else if (key == "sweep_output") runtime_settings_.sweep_output = value;
+            else if (key == "ga_optimize") runtime_settings_.ga_optimize = (value == "true" || value == "1");
+            else if (key == "ga_resume") runtime_settings_.ga_resume = (value == "true" || value == "1");
+            else if (key == "ga_population") runtime_settings_.ga_population = std::stoi(value);
+            else if (key == "ga_generations") runtime_settings_.ga_generations = std::stoi(value);
+            else if (key == "ga_crossover_rate") runtime_settings_.ga_crossover_rate = std::stod(value);
+            else if (key == "ga_mutation_rate") runtime_settings_.ga_mutation_rate = std::stod(value);
+            else if (key == "ga_seed") runtime_settings_.ga_seed = std::stoi(value);
+            else if (key == "ga_optimize_biases") runtime_settings_.ga_optimize_biases = (value == "true" || value == "1");
+            else if (key == "ga_optimize_trail_filter") runtime_settings_.ga_optimize_trail_filter = (value == "true" || value == "1");
+            else if (key == "ga_optimize_antiflicker") runtime_settings_.ga_optimize_antiflicker = (value == "true" || value == "1");
+            else if (key == "ga_settle_ms") runtime_settings_.ga_settle_ms = std::stoi(value);
+            else if (key == "ga_frames") runtime_settings_.ga_frames = std::stoi(value);
+            else if (key == "ga_output") runtime_settings_.ga_output = value;
+            else if (key == "ga_checkpoint") runtime_settings_.ga_checkpoint = value;
+            else if (key == "scattering_regions") runtime_settings_.scattering_regions = value;
+            else if (key == "scattering_polarity") runtime_settings_.scattering_polarity = value;
+            else if (key == "scattering_plane_sweep") runtime_settings_.scattering_plane_sweep = (value == "true" || value == "1");
+            else if (key == "scattering_tile_map") runtime_settings_.scattering_tile_map = (value == "true" || value == "1");
+            else if (key == "scattering_clusters") runtime_settings_.scattering_clusters = (value == "true" || value == "1");
+            else if (key == "scattering_event_mode") runtime_settings_.scattering_event_mode = (value == "true" || value == "1");
+            else if (key == "scattering_compare_references") runtime_settings_.scattering_compare_references = value;
+            else if (key == "scattering_align_interval_ms") runtime_settings_.scattering_align_interval_ms = std::stoi(value);
+            else if (key == "scattering_align_max_px") runtime_settings_.scattering_align_max_px = std::stoi(value);
+            else if (key == "scattering_reference_frames") runtime_settings_.scattering_reference_frames = std::stoi(value);
+            else if (key == "scattering_reference_occupancy") runtime_settings_.scattering_reference_occupancy = std::stof(value);
+            else if (key == "scattering_ci_target") runtime_settings_.scattering_ci_target = std::stof(value);
+            else if (key == "scattering_ci_min_frames") runtime_settings_.scattering_ci_min_frames = std::stoi(value);
+            else if (key == "heatmap_timeline_interval_s") runtime_settings_.heatmap_timeline_interval_s = std::stoi(value);
+            else if (key == "scattering_checkpoint_interval_s") runtime_settings_.scattering_checkpoint_interval_s = std::stoi(value);
+            else if (key == "scattering_checkpoint_file") runtime_settings_.scattering_checkpoint_file = value;
+            else if (key == "scattering_checkpoint_resume") runtime_settings_.scattering_checkpoint_resume = (value == "true" || value == "1");
+            else if (key == "lifetime_stats_directory") runtime_settings_.lifetime_stats_directory = value;
+            else if (key == "lifetime_checkpoint_s") runtime_settings_.lifetime_checkpoint_s = std::stoi(value);
+        }
+        else if (section == "Threads") {
+            if (key == "decode_cores") thread_settings_.decode_cores = value;
+            else if (key == "decode_priority") thread_settings_.decode_priority = value;
+            else if (key == "decode_isolate") thread_settings_.decode_isolate = (value == "true" || value == "1");
+            else if (key == "accumulation_cores") thread_settings_.accumulation_cores = value;
+            else if (key == "accumulation_priority") thread_settings_.accumulation_priority = value;
+            else if (key == "analysis_cores") thread_settings_.analysis_cores = value;
+            else if (key == "analysis_priority") thread_settings_.analysis_priority = value;
+            else if (key == "io_core") thread_settings_.io_core = value;
+            else if (key == "io_priority") thread_settings_.io_priority = value;
+            else if (key == "ui_core") thread_settings_.ui_core = value;
+            else if (key == "ui_priority") thread_settings_.ui_priority = value;
+            else if (key == "decode_mmcss") thread_settings_.decode_mmcss = value;
+            else if (key == "accumulation_mmcss") thread_settings_.accumulation_mmcss = value;
+            else if (key == "lock_buffers") thread_settings_.lock_buffers = (value == "true" || value == "1");
+            else if (key == "large_pages") thread_settings_.large_pages = (value == "true" || value == "1");
         }
     }
 
@@ -117,19 +332,239 @@ bool AppConfig::save(const std::string& filename) {
     file << "bias_hpf = " << camera_settings_.bias_hpf << "\n";
     file << "bias_refr = " << camera_settings_.bias_refr << "\n";
     file << "accumulation_time_us = " << camera_settings_.accumulation_time_us << "\n";
+    file << "native_accumulation = " << (camera_settings_.native_accumulation ? "true" : "false") << "\n";
+    file << "polarity_planes = " << (camera_settings_.polarity_planes ? "true" : "false") << "\n";
+    file << "preview_binning = " << camera_settings_.preview_binning << "\n";
+    file << "accumulation_threads = " << camera_settings_.accumulation_threads << "\n";
+    file << "raw_decode = " << (camera_settings_.raw_decode ? "true" : "false") << "\n";
+    file << "slice_mode = " << camera_settings_.slice_mode << "\n";
+    file << "slice_events = " << camera_settings_.slice_events << "\n";
+    file << "accumulation_windows_us = " << camera_settings_.accumulation_windows_us << "\n";
+    file << "accumulation_adaptive = " << (camera_settings_.accumulation_adaptive ? "true" : "false") << "\n";
+    file << "accumulation_adaptive_target = " << camera_settings_.accumulation_adaptive_target << "\n";
+    file << "accumulation_adaptive_events = " << camera_settings_.accumulation_adaptive_events << "\n";
+    file << "accumulation_adaptive_occupancy = " << camera_settings_.accumulation_adaptive_occupancy << "\n";
+    file << "accumulation_adaptive_min_us = " << camera_settings_.accumulation_adaptive_min_us << "\n";
+    file << "accumulation_adaptive_max_us = " << camera_settings_.accumulation_adaptive_max_us << "\n";
+    file << "camera_count = " << camera_settings_.camera_count << "\n";
+    file << "camera_serial_cache = " << camera_settings_.camera_serial_cache << "\n";
+    file << "latency_budget_ms = " << camera_settings_.latency_budget_ms << "\n";
+    file << "latency_shed_mode = " << camera_settings_.latency_shed_mode << "\n";
+    file << "qos_enabled = " << (camera_settings_.qos_enabled ? "true" : "false") << "\n";
+    file << "qos_latency_ms = " << camera_settings_.qos_latency_ms << "\n";
+    file << "qos_queue_percent = " << camera_settings_.qos_queue_percent << "\n";
+    file << "qos_decimation = " << camera_settings_.qos_decimation << "\n";
+    file << "qos_hold_ms = " << camera_settings_.qos_hold_ms << "\n";
+    file << "roi_enabled = " << (camera_settings_.roi_enabled ? "true" : "false") << "\n";
+    file << "roi_x = " << camera_settings_.roi_x << "\n";
+    file << "roi_y = " << camera_settings_.roi_y << "\n";
+    file << "roi_width = " << camera_settings_.roi_width << "\n";
+    file << "roi_height = " << camera_settings_.roi_height << "\n";
+    file << "erc_auto = " << (camera_settings_.erc_auto ? "true" : "false") << "\n";
+    file << "erc_min_kevps = " << camera_settings_.erc_min_kevps << "\n";
+    file << "erc_max_kevps = " << camera_settings_.erc_max_kevps << "\n";
+    file << "erc_high_water_percent = " << camera_settings_.erc_high_water_percent << "\n";
+    file << "erc_low_water_percent = " << camera_settings_.erc_low_water_percent << "\n";
+    file << "erc_interval_ms = " << camera_settings_.erc_interval_ms << "\n";
+    file << "monitoring_interval_ms = " << camera_settings_.monitoring_interval_ms << "\n";
+    file << "reconnect_stall_ms = " << camera_settings_.reconnect_stall_ms << "\n";
     file << "binary_bit_1 = " << camera_settings_.binary_bit_1 << "\n";
     file << "binary_bit_2 = " << camera_settings_.binary_bit_2 << "\n";
+    file << "time_surface_display = " << (camera_settings_.time_surface_display ? "true" : "false") << "\n";
+    file << "time_surface_decay_us = " << camera_settings_.time_surface_decay_us << "\n";
     file << "trail_filter_enabled = " << (camera_settings_.trail_filter_enabled ? "true" : "false") << "\n";
     file << "trail_filter_type = " << camera_settings_.trail_filter_type << "\n";
     file << "trail_filter_threshold = " << camera_settings_.trail_filter_threshold << "\n";
+    file << "noise_filter_enabled = " << (camera_settings_.noise_filter_enabled ? "true" : "false") << "\n";
+    file << "noise_filter_threshold_us = " << camera_settings_.noise_filter_threshold_us << "\n";
+    file << "pixel_rate_monitor_enabled = " << (camera_settings_.pixel_rate_monitor_enabled ? "true" : "false") << "\n";
+    file << "pixel_rate_half_life_ms = " << camera_settings_.pixel_rate_half_life_ms << "\n";
+    file << "pixel_rate_sigma = " << camera_settings_.pixel_rate_sigma << "\n";
+    file << "hot_pixel_mask_file = " << camera_settings_.hot_pixel_mask_file << "\n";
+    file << "hot_pixel_suppress = " << (camera_settings_.hot_pixel_suppress ? "true" : "false") << "\n";
+    file << "hot_pixel_suppress_hardware = " << (camera_settings_.hot_pixel_suppress_hardware ? "true" : "false") << "\n";
+    file << "event_interval_histogram = " << (camera_settings_.event_interval_histogram ? "true" : "false") << "\n";
+    file << "line_defect_enabled = " << (camera_settings_.line_defect_enabled ? "true" : "false") << "\n";
+    file << "line_defect_sigma = " << camera_settings_.line_defect_sigma << "\n";
+    file << "line_defect_min_fill = " << camera_settings_.line_defect_min_fill << "\n";
+    file << "line_defect_min_frames = " << camera_settings_.line_defect_min_frames << "\n";
+    file << "toggle_analysis_enabled = " << (camera_settings_.toggle_analysis_enabled ? "true" : "false") << "\n";
+    file << "toggle_window_frames = " << camera_settings_.toggle_window_frames << "\n";
+    file << "toggle_stuck_frames = " << camera_settings_.toggle_stuck_frames << "\n";
+    file << "toggle_flicker_rate = " << camera_settings_.toggle_flicker_rate << "\n";
+    file << "antiflicker_auto = " << (camera_settings_.antiflicker_auto ? "true" : "false") << "\n";
+    file << "antiflicker_auto_margin_hz = " << camera_settings_.antiflicker_auto_margin_hz << "\n";
     if (!camera_settings_.capture_directory.empty()) {
         file << "capture_directory = " << camera_settings_.capture_directory << "\n";
     }
+    file << "png_profile = " << camera_settings_.png_profile << "\n";
+    file << "png_bilevel = " << (camera_settings_.png_bilevel ? "true" : "false") << "\n";
+    file << "capture_dedup_distance = " << camera_settings_.capture_dedup_distance << "\n";
+    file << "capture_catalog = " << (camera_settings_.capture_catalog ? "true" : "false") << "\n";
+    file << "catalog_threads = " << camera_settings_.catalog_threads << "\n";
+    file << "image_cache_mb = " << camera_settings_.image_cache_mb << "\n";
+    file << "image_prefetch = " << camera_settings_.image_prefetch << "\n";
+    file << "gallery_threads = " << camera_settings_.gallery_threads << "\n";
+    if (!camera_settings_.recording_directory.empty()) {
+        file << "recording_directory = " << camera_settings_.recording_directory << "\n";
+    }
+    file << "recording_preallocate_mb = " << camera_settings_.recording_preallocate_mb << "\n";
+    file << "recording_compress_threads = " << camera_settings_.recording_compress_threads << "\n";
+    file << "burst_pre_s = " << camera_settings_.burst_pre_s << "\n";
+    file << "burst_post_s = " << camera_settings_.burst_post_s << "\n";
+    file << "burst_max_mb = " << camera_settings_.burst_max_mb << "\n";
+    file << "history_s = " << camera_settings_.history_s << "\n";
+    file << "history_max_mb = " << camera_settings_.history_max_mb << "\n";
+    file << "memory_budget_mb = " << camera_settings_.memory_budget_mb << "\n";
+    file << "trigger_capture = " << (camera_settings_.trigger_capture ? "true" : "false") << "\n";
+    file << "trigger_window_us = " << camera_settings_.trigger_window_us << "\n";
+    file << "trigger_latency_map = " << (camera_settings_.trigger_latency_map ? "true" : "false") << "\n";
+    file << "trigger_latency_window_us = " << camera_settings_.trigger_latency_window_us << "\n";
+    file << "trigger_latency_min_cycles = " << camera_settings_.trigger_latency_min_cycles << "\n";
+    file << "merge_streams = " << (camera_settings_.merge_streams ? "true" : "false") << "\n";
+    file << "merge_window_us = " << camera_settings_.merge_window_us << "\n";
+    file << "merge_buffer_events = " << camera_settings_.merge_buffer_events << "\n";
+    file << "merge_max_wait_ms = " << camera_settings_.merge_max_wait_ms << "\n";
     file << "\n";
 
     // Write runtime settings
     file << "[Runtime]\n";
     file << "debug_mode = " << (runtime_settings_.debug_mode ? "true" : "false") << "\n";
+    file << "triple_buffer_display = " << (runtime_settings_.triple_buffer_display ? "true" : "false") << "\n";
+    file << "gpu_pipeline = " << (runtime_settings_.gpu_pipeline ? "true" : "false") << "\n";
+    file << "shader_display = " << (runtime_settings_.shader_display ? "true" : "false") << "\n";
+    file << "gpu_event_scatter = " << (runtime_settings_.gpu_event_scatter ? "true" : "false") << "\n";
+    file << "ui_max_fps = " << runtime_settings_.ui_max_fps << "\n";
+    file << "ui_idle_fps = " << runtime_settings_.ui_idle_fps << "\n";
+    file << "low_latency_present = " << (runtime_settings_.low_latency_present ? "true" : "false") << "\n";
+    file << "late_latch = " << (runtime_settings_.late_latch ? "true" : "false") << "\n";
+    if (!runtime_settings_.replay_file.empty()) {
+        file << "replay_file = " << runtime_settings_.replay_file << "\n";
+    }
+    file << "replay_speed = " << runtime_settings_.replay_speed << "\n";
+    file << "replay_loop = " << (runtime_settings_.replay_loop ? "true" : "false") << "\n";
+    file << "replay_start_s = " << runtime_settings_.replay_start_s << "\n";
+    file << "replay_decode_threads = " << runtime_settings_.replay_decode_threads << "\n";
+    file << "metrics_export = " << runtime_settings_.metrics_export << "\n";
+    file << "metrics_port = " << runtime_settings_.metrics_port << "\n";
+    file << "metrics_statsd_host = " << runtime_settings_.metrics_statsd_host << "\n";
+    file << "metrics_statsd_port = " << runtime_settings_.metrics_statsd_port << "\n";
+    file << "metrics_interval_ms = " << runtime_settings_.metrics_interval_ms << "\n";
+    file << "metrics_prefix = " << runtime_settings_.metrics_prefix << "\n";
+    file << "shm_publish = " << (runtime_settings_.shm_publish ? "true" : "false") << "\n";
+    file << "shm_name = " << runtime_settings_.shm_name << "\n";
+    file << "shm_frame_slots = " << runtime_settings_.shm_frame_slots << "\n";
+    file << "shm_packed = " << (runtime_settings_.shm_packed ? "true" : "false") << "\n";
+    file << "shm_event_slots = " << runtime_settings_.shm_event_slots << "\n";
+    file << "shm_event_slot_events = " << runtime_settings_.shm_event_slot_events << "\n";
+    file << "stream_enabled = " << (runtime_settings_.stream_enabled ? "true" : "false") << "\n";
+    file << "stream_port = " << runtime_settings_.stream_port << "\n";
+    file << "stream_max_fps = " << runtime_settings_.stream_max_fps << "\n";
+    file << "stream_max_clients = " << runtime_settings_.stream_max_clients << "\n";
+    file << "stream_preview = " << (runtime_settings_.stream_preview ? "true" : "false") << "\n";
+    file << "analyzer_plugins = " << runtime_settings_.analyzer_plugins << "\n";
+    file << "analyzer_threads = " << runtime_settings_.analyzer_threads << "\n";
+    file << "pipeline_stages = " << runtime_settings_.pipeline_stages << "\n";
+    file << "pipeline_stage_threads = " << runtime_settings_.pipeline_stage_threads << "\n";
+    file << "backend_autotune = " << (runtime_settings_.backend_autotune ? "true" : "false") << "\n";
+    file << "backend_cache = " << runtime_settings_.backend_cache << "\n";
+    file << "backend_overrides = " << runtime_settings_.backend_overrides << "\n";
+    file << "warmup = " << (runtime_settings_.warmup ? "true" : "false") << "\n";
+    file << "shader_cache = " << runtime_settings_.shader_cache << "\n";
+    file << "fleet_report = " << (runtime_settings_.fleet_report ? "true" : "false") << "\n";
+    file << "fleet_host = " << runtime_settings_.fleet_host << "\n";
+    file << "fleet_port = " << runtime_settings_.fleet_port << "\n";
+    file << "fleet_station = " << runtime_settings_.fleet_station << "\n";
+    file << "fleet_aggregate = " << (runtime_settings_.fleet_aggregate ? "true" : "false") << "\n";
+    file << "fleet_shards = " << runtime_settings_.fleet_shards << "\n";
+    file << "fleet_directory = " << runtime_settings_.fleet_directory << "\n";
+    file << "fleet_stale_s = " << runtime_settings_.fleet_stale_s << "\n";
+    file << "trend_history_file = " << runtime_settings_.trend_history_file << "\n";
+    file << "run_log_directory = " << runtime_settings_.run_log_directory << "\n";
+    file << "run_report = " << (runtime_settings_.run_report ? "true" : "false") << "\n";
+    file << "flight_recorder = " << (runtime_settings_.flight_recorder ? "true" : "false") << "\n";
+    file << "flight_directory = " << runtime_settings_.flight_directory << "\n";
+    file << "flight_window_s = " << runtime_settings_.flight_window_s << "\n";
+    file << "flight_spike_ms = " << runtime_settings_.flight_spike_ms << "\n";
+    file << "flight_gap_ms = " << runtime_settings_.flight_gap_ms << "\n";
+    file << "flight_cooldown_s = " << runtime_settings_.flight_cooldown_s << "\n";
+    file << "headless = " << (runtime_settings_.headless ? "true" : "false") << "\n";
+    file << "headless_reference = " << runtime_settings_.headless_reference << "\n";
+    file << "headless_capture_interval_s = " << runtime_settings_.headless_capture_interval_s << "\n";
+    file << "headless_duration_s = " << runtime_settings_.headless_duration_s << "\n";
+    file << "soak = " << (runtime_settings_.soak ? "true" : "false") << "\n";
+    file << "soak_interval_s = " << runtime_settings_.soak_interval_s << "\n";
+    file << "soak_warmup_s = " << runtime_settings_.soak_warmup_s << "\n";
+    file << "soak_max_rss_growth_mb = " << runtime_settings_.soak_max_rss_growth_mb << "\n";
+    file << "soak_max_private_growth_mb = " << runtime_settings_.soak_max_private_growth_mb << "\n";
+    file << "soak_max_handle_growth = " << runtime_settings_.soak_max_handle_growth << "\n";
+    file << "soak_max_gl_growth = " << runtime_settings_.soak_max_gl_growth << "\n";
+    file << "dark_calibration = " << (runtime_settings_.dark_calibration ? "true" : "false") << "\n";
+    file << "dark_calibration_s = " << runtime_settings_.dark_calibration_s << "\n";
+    file << "dark_calibration_sigma = " << runtime_settings_.dark_calibration_sigma << "\n";
+    file << "dark_calibration_min_rate_hz = " << runtime_settings_.dark_calibration_min_rate_hz << "\n";
+    file << "bias_sweep = " << (runtime_settings_.bias_sweep ? "true" : "false") << "\n";
+    file << "sweep_bias_diff_on = " << runtime_settings_.sweep_bias_diff_on << "\n";
+    file << "sweep_bias_diff_off = " << runtime_settings_.sweep_bias_diff_off << "\n";
+    file << "sweep_bias_hpf = " << runtime_settings_.sweep_bias_hpf << "\n";
+    file << "sweep_bias_refr = " << runtime_settings_.sweep_bias_refr << "\n";
+    file << "sweep_settle_ms = " << runtime_settings_.sweep_settle_ms << "\n";
+    file << "sweep_auto_settle = " << (runtime_settings_.sweep_auto_settle ? "true" : "false") << "\n";
+    file << "sweep_settle_tolerance_percent = " << runtime_settings_.sweep_settle_tolerance_percent << "\n";
+    file << "sweep_frames = " << runtime_settings_.sweep_frames << "\n";
+    file << "sweep_output = " << runtime_settings_.sweep_output << "\n";
+    file << "ga_optimize = " << (runtime_settings_.ga_optimize ? "true" : "false") << "\n";
+    file << "ga_resume = " << (runtime_settings_.ga_resume ? "true" : "false") << "\n";
+    file << "ga_population = " << runtime_settings_.ga_population << "\n";
+    file << "ga_generations = " << runtime_settings_.ga_generations << "\n";
+    file << "ga_crossover_rate = " << runtime_settings_.ga_crossover_rate << "\n";
+    file << "ga_mutation_rate = " << runtime_settings_.ga_mutation_rate << "\n";
+    file << "ga_seed = " << runtime_settings_.ga_seed << "\n";
+    file << "ga_optimize_biases = " << (runtime_settings_.ga_optimize_biases ? "true" : "false") << "\n";
+    file << "ga_optimize_trail_filter = " << (runtime_settings_.ga_optimize_trail_filter ? "true" : "false") << "\n";
+    file << "ga_optimize_antiflicker = " << (runtime_settings_.ga_optimize_antiflicker ? "true" : "false") << "\n";
+    file << "ga_settle_ms = " << runtime_settings_.ga_settle_ms << "\n";
+    file << "ga_frames = " << runtime_settings_.ga_frames << "\n";
+    file << "ga_output = " << runtime_settings_.ga_output << "\n";
+    file << "ga_checkpoint = " << runtime_settings_.ga_checkpoint << "\n";
+    file << "scattering_regions = " << runtime_settings_.scattering_regions << "\n";
+    file << "scattering_polarity = " << runtime_settings_.scattering_polarity << "\n";
+    file << "scattering_plane_sweep = " << (runtime_settings_.scattering_plane_sweep ? "true" : "false") << "\n";
+    file << "scattering_tile_map = " << (runtime_settings_.scattering_tile_map ? "true" : "false") << "\n";
+    file << "scattering_clusters = " << (runtime_settings_.scattering_clusters ? "true" : "false") << "\n";
+    file << "scattering_event_mode = " << (runtime_settings_.scattering_event_mode ? "true" : "false") << "\n";
+    file << "scattering_compare_references = " << runtime_settings_.scattering_compare_references << "\n";
+    file << "scattering_align_interval_ms = " << runtime_settings_.scattering_align_interval_ms << "\n";
+    file << "scattering_align_max_px = " << runtime_settings_.scattering_align_max_px << "\n";
+    file << "scattering_reference_frames = " << runtime_settings_.scattering_reference_frames << "\n";
+    file << "scattering_reference_occupancy = " << runtime_settings_.scattering_reference_occupancy << "\n";
+    file << "scattering_ci_target = " << runtime_settings_.scattering_ci_target << "\n";
+    file << "scattering_ci_min_frames = " << runtime_settings_.scattering_ci_min_frames << "\n";
+    file << "heatmap_timeline_interval_s = " << runtime_settings_.heatmap_timeline_interval_s << "\n";
+    file << "scattering_checkpoint_interval_s = " << runtime_settings_.scattering_checkpoint_interval_s << "\n";
+    file << "scattering_checkpoint_file = " << runtime_settings_.scattering_checkpoint_file << "\n";
+    file << "scattering_checkpoint_resume = " << (runtime_settings_.scattering_checkpoint_resume ? "true" : "false") << "\n";
+    file << "lifetime_stats_directory = " << runtime_settings_.lifetime_stats_directory << "\n";
+    file << "lifetime_checkpoint_s = " << runtime_settings_.lifetime_checkpoint_s << "\n";
+    file << "\n";
+
+    // Write thread placement
+    file << "[Threads]\n";
+    file << "decode_cores = " << thread_settings_.decode_cores << "\n";
+    file << "decode_priority = " << thread_settings_.decode_priority << "\n";
+    file << "decode_isolate = " << (thread_settings_.decode_isolate ? "true" : "false") << "\n";
+    file << "accumulation_cores = " << thread_settings_.accumulation_cores << "\n";
+    file << "accumulation_priority = " << thread_settings_.accumulation_priority << "\n";
+    file << "analysis_cores = " << thread_settings_.analysis_cores << "\n";
+    file << "analysis_priority = " << thread_settings_.analysis_priority << "\n";
+    file << "io_core = " << thread_settings_.io_core << "\n";
+    file << "io_priority = " << thread_settings_.io_priority << "\n";
+    file << "ui_core = " << thread_settings_.ui_core << "\n";
+    file << "ui_priority = " << thread_settings_.ui_priority << "\n";
+    file << "decode_mmcss = " << thread_settings_.decode_mmcss << "\n";
+    file << "accumulation_mmcss = " << thread_settings_.accumulation_mmcss << "\n";
+    file << "lock_buffers = " << (thread_settings_.lock_buffers ? "true" : "false") << "\n";
+    file << "large_pages = " << (thread_settings_.large_pages ? "true" : "false") << "\n";
 
     std::cout << "Configuration saved to: " << filename << std::endl;
     return true;
@@ -0,0 +1,230 @@
+#include "bias_step_response.h"
+#include "camera_manager.h"
+#include "camera/control_queue.h"
+#include <metavision/hal/facilities/i_ll_biases.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+// A write that has not run by then is treated as failed
+constexpr int WRITE_TIMEOUT_MS = 5000;
+
+// Extra wait for windows still in transport once the observation time is up
+constexpr int DELIVERY_SLACK_MS = 500;
+
+// Poisson floor of the settling band, in standard deviations
+constexpr double POISSON_SIGMAS = 4.0;
+
+int64_t steady_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct WriteStamp {
+    int64_t start_us = -1;      // steady_clock when the write started (-1 = failed)
+    int64_t duration_us = 0;
+};
+
+} // namespace
+
+BiasStepResponse::Result BiasStepResponse::measure(int camera_index, Metavision::I_LL_Biases* biases,
+                                                   const std::string& name, int value, const Options& options,
+                                                   const std::function<bool()>& should_stop) {
+    using WindowStats = EventCamera::EventProcessor::WindowStats;
+
+    Result result;
+    result.bias = name;
+    result.to = value;
+
+    auto& cam_mgr = CameraManager::instance();
+    if (!biases || camera_index < 0 || camera_index >= cam_mgr.num_pipelines()) {
+        std::cerr << "BiasStepResponse: No camera or bias facility" << std::endl;
+        return result;
+    }
+    try {
+        result.from = biases->get(name);
+    } catch (const std::exception& e) {
+        std::cerr << "BiasStepResponse: Failed to read " << name << ": " << e.what() << std::endl;
+        return result;
+    }
+
+    const EventCamera::EventProcessor& stats = cam_mgr.event_stats(camera_index);
+    const core::ClockSync& clock = cam_mgr.clock_sync(camera_index);
+
+    // Only windows completed from now on
+    std::vector<WindowStats> windows;
+    uint64_t seen = 0;
+    int64_t window_us = 1000;
+    {
+        WindowStats last;
+        if (stats.get_last_window(last)) {
+            seen = last.window_index;
+            window_us = std::max<int64_t>(last.window_us, 1);
+        }
+    }
+    // Poll well inside the history so no window is overwritten unseen
+    const auto poll = std::chrono::microseconds(
+        std::clamp<int64_t>(window_us * static_cast<int64_t>(EventCamera::EventProcessor::HISTORY) / 4, 1000, 20000));
+    auto collect_until = [&](int64_t deadline_us, int64_t until_ts) {
+        while (steady_us() < deadline_us) {
+            if (should_stop()) {
+                return false;
+            }
+            std::this_thread::sleep_for(poll);
+            seen = stats.get_windows_since(seen, windows);
+            if (until_ts >= 0 && !windows.empty() && windows.back().window_end_ts >= until_ts) {
+                break;
+            }
+        }
+        return true;
+    };
+
+    if (!collect_until(steady_us() + std::max(options.baseline_ms, 0) * 1000LL, -1)) {
+        return result;
+    }
+
+    // The write goes through the control thread like every other register access
+    auto stamp = std::make_shared<std::promise<WriteStamp>>();
+    std::future<WriteStamp> written = stamp->get_future();
+    const bool posted = EventCamera::ControlQueue::instance().post("bias.step", [stamp, biases, name, value] {
+        WriteStamp write;
+        const int64_t start_us = steady_us();
+        try {
+            if (CameraManager::write_biases(biases, {{name, value}}) >= 0) {
+                write.start_us = start_us;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "BiasStepResponse: Failed to set " << name << ": " << e.what() << std::endl;
+        }
+        write.duration_us = steady_us() - start_us;
+        stamp->set_value(write);
+    });
+    if (!posted || written.wait_for(std::chrono::milliseconds(WRITE_TIMEOUT_MS)) != std::future_status::ready) {
+        std::cerr << "BiasStepResponse: Write of " << name << " did not run" << std::endl;
+        return result;
+    }
+    const WriteStamp write = written.get();
+    if (write.start_us < 0) {
+        return result;
+    }
+    result.write_us = write.duration_us;
+
+    // Camera time of the write; without a clock fit, the newest window seen is the best estimate
+    if (clock.is_valid()) {
+        result.write_ts = clock.to_sensor_us(write.start_us);
+    } else {
+        seen = stats.get_windows_since(seen, windows);
+        if (windows.empty()) {
+            std::cerr << "BiasStepResponse: No events to time the write against" << std::endl;
+            return result;
+        }
+        result.write_ts = windows.back().window_end_ts;
+    }
+
+    const int64_t observe_us = std::max(options.observe_ms, 1) * 1000LL;
+    if (!collect_until(write.start_us + observe_us + DELIVERY_SLACK_MS * 1000LL, result.write_ts + observe_us)) {
+        return result;
+    }
+
+    analyze(windows, result.write_ts, options, result);
+    // At least one window delivered after the write, or the camera stopped rather than went quiet
+    result.measured = !windows.empty() && windows.back().window_end_ts > result.write_ts;
+    return result;
+}
+
+void BiasStepResponse::analyze(const std::vector<EventCamera::EventProcessor::WindowStats>& windows,
+                               int64_t write_ts, const Options& options, Result& result) {
+    result.windows = 0;
+    result.settled = false;
+    result.settle_us = -1;
+    if (windows.empty()) {
+        return;
+    }
+
+    int64_t window_us = 1;
+    for (const auto& window : windows) {
+        window_us = std::max(window_us, window.window_us);
+    }
+
+    // Baseline: events before the write over the time they span
+    uint64_t before_events = 0;
+    int64_t before_start = -1;
+    int64_t before_end = -1;
+
+    // Event count per window after the write; idle windows (a time gap between
+    // consecutive indices) count as zero, windows lost to a slow poll (an index gap) are skipped
+    std::vector<int64_t> ends;
+    std::vector<double> counts;
+    const EventCamera::EventProcessor::WindowStats* previous = nullptr;
+    for (const auto& window : windows) {
+        if (window.window_end_ts <= write_ts) {
+            before_events += window.stats.events;
+            if (before_start < 0) {
+                before_start = window.window_end_ts - window_us;
+            }
+            before_end = window.window_end_ts;
+        } else {
+            if (previous && window.window_index == previous->window_index + 1) {
+                for (int64_t end = previous->window_end_ts + window_us; end < window.window_end_ts; end += window_us) {
+                    if (end > write_ts) {
+                        ends.push_back(end);
+                        counts.push_back(0.0);
+                    }
+                }
+            }
+            ends.push_back(window.window_end_ts);
+            counts.push_back(static_cast<double>(window.stats.events));
+        }
+        previous = &window;
+    }
+    // Nothing delivered up to the end of the observation: the sensor went quiet
+    const int64_t observe_end = write_ts + std::max(options.observe_ms, 1) * 1000LL;
+    for (int64_t end = (ends.empty() ? write_ts : ends.back()) + window_us; end <= observe_end; end += window_us) {
+        ends.push_back(end);
+        counts.push_back(0.0);
+    }
+    if (before_end > before_start) {
+        result.rate_before_kevps = static_cast<double>(before_events) * 1000.0 / (before_end - before_start);
+    }
+    result.windows = static_cast<int>(counts.size());
+    if (counts.empty()) {
+        return;
+    }
+
+    // New steady state: mean of the tail
+    const int64_t tail_start = ends.back() - std::max(options.steady_ms, 1) * 1000LL;
+    double tail_sum = 0.0;
+    int tail_windows = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (ends[i] > tail_start) {
+            tail_sum += counts[i];
+            ++tail_windows;
+        }
+    }
+    const double steady = tail_sum / std::max(tail_windows, 1);
+    result.rate_after_kevps = steady * 1000.0 / window_us;
+
+    const double band = std::max(std::max(options.tolerance_percent, 0.0) / 100.0 * steady,
+                                 POISSON_SIGMAS * std::sqrt(std::max(steady, 1.0)));
+    size_t last_outside = counts.size();
+    for (size_t i = counts.size(); i-- > 0;) {
+        if (std::abs(counts[i] - steady) > band) {
+            last_outside = i;
+            break;
+        }
+    }
+
+    if (last_outside == counts.size()) {
+        // In the band from the first window on: settled within one window
+        result.settle_us = std::max<int64_t>(ends.front() - write_ts, 0);
+        result.settled = true;
+    } else {
+        result.settle_us = ends[last_outside] - write_ts;
+        result.settled = ends[last_outside] <= tail_start;
+    }
+}
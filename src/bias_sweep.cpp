@@ -0,0 +1,457 @@
+#include "bias_sweep.h"
+#include "camera_manager.h"
+#include "core/metrics.h"
+#include "video/thread_pool.h"
+#include <metavision/hal/facilities/i_ll_biases.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+
+// A mistyped range should fail loudly, not queue a week of settling
+constexpr size_t MAX_VALUES_PER_BIAS = 1000;
+
+// Capture gives up if the camera stops delivering frames
+constexpr int CAPTURE_TIMEOUT_MS = 5000;
+
+bool parse_int(const std::string& text, int& value) {
+    char trailing = 0;
+    return std::sscanf(text.c_str(), " %d %c", &value, &trailing) == 1;
+}
+
+} // namespace
+
+BiasSweep::BiasSweep(video::FrameBuffer& source) : source_(source) {
+}
+
+BiasSweep::~BiasSweep() {
+    if (analysis_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(handoff_mutex_);
+            finishing_ = true;
+        }
+        handoff_cv_.notify_all();
+        analysis_thread_.join();
+    }
+}
+
+bool BiasSweep::parse_values(const std::string& spec, int current, std::vector<int>& values) {
+    values.clear();
+    if (spec.find_first_not_of(" \t") == std::string::npos) {
+        values.push_back(current);
+        return true;
+    }
+
+    // Range: start:stop[:step], stop included when the step lands on it
+    if (spec.find(':') != std::string::npos) {
+        int start = 0, stop = 0, step = 0;
+        char trailing = 0;
+        const int fields = std::sscanf(spec.c_str(), " %d : %d : %d %c", &start, &stop, &step, &trailing);
+        if (fields == 2) {
+            step = stop >= start ? 1 : -1;
+        } else if (fields != 3) {
+            return false;
+        }
+        if (step == 0 || (stop - start) / step < 0) {
+            return false;
+        }
+        for (int v = start; step > 0 ? v <= stop : v >= stop; v += step) {
+            if (values.size() >= MAX_VALUES_PER_BIAS) return false;
+            values.push_back(v);
+        }
+        return true;
+    }
+
+    size_t begin = 0;
+    while (begin <= spec.size()) {
+        size_t end = spec.find(',', begin);
+        if (end == std::string::npos) end = spec.size();
+        int value = 0;
+        if (!parse_int(spec.substr(begin, end - begin), value) || values.size() >= MAX_VALUES_PER_BIAS) {
+            return false;
+        }
+        values.push_back(value);
+        begin = end + 1;
+    }
+    return true;
+}
+
+std::vector<BiasSweep::BiasPoint> BiasSweep::make_grid(const std::vector<int>& diff_on,
+                                                       const std::vector<int>& diff_off,
+                                                       const std::vector<int>& hpf,
+                                                       const std::vector<int>& refr) {
+    std::vector<BiasPoint> points;
+    points.reserve(diff_on.size() * diff_off.size() * hpf.size() * refr.size());
+    for (int on : diff_on) {
+        for (int off : diff_off) {
+            for (int h : hpf) {
+                for (int r : refr) {
+                    points.push_back({on, off, h, r});
+                }
+            }
+        }
+    }
+    return points;
+}
+
+bool BiasSweep::apply(Metavision::I_LL_Biases* biases, const BiasPoint& point) {
+    try {
+        // Neighbouring grid points usually differ in one bias, so most steps cost one write
+        return CameraManager::write_biases(biases, {
+            {"bias_diff_on", point.diff_on},
+            {"bias_diff_off", point.diff_off},
+            {"bias_hpf", point.hpf},
+            {"bias_refr", point.refr},
+        }) >= 0;
+    } catch (const std::exception& e) {
+        std::cerr << "BiasSweep: Failed to set biases: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool BiasSweep::run(const std::vector<BiasPoint>& points, const Options& options,
+                    Metavision::I_LL_Biases* biases, const std::function<bool()>& should_stop) {
+    if (!biases) {
+        std::cerr << "BiasSweep: Camera has no bias facility" << std::endl;
+        return false;
+    }
+    if (points.empty()) {
+        std::cerr << "BiasSweep: No bias points to sweep" << std::endl;
+        return false;
+    }
+
+    csv_.open(options.csv_path, std::ios::trunc);
+    if (!csv_.is_open()) {
+        std::cerr << "BiasSweep: Cannot open " << options.csv_path << " for writing" << std::endl;
+        return false;
+    }
+    csv_ << "step,bias_diff_on,bias_diff_off,bias_hpf,bias_refr,frames,event_rate_kevps,dropped_events,"
+            "active_mean_percent,active_stddev_percent,active_min_percent,active_max_percent,"
+            "ever_active_percent,toggle_percent,scattering_percent,missing_percent,"
+            "always_active_percent,snr_db\n";
+
+    // Restored when the sweep ends, however it ends
+    BiasPoint original;
+    try {
+        original = {biases->get("bias_diff_on"), biases->get("bias_diff_off"),
+                    biases->get("bias_hpf"), biases->get("bias_refr")};
+    } catch (const std::exception& e) {
+        std::cerr << "BiasSweep: Failed to read biases: " << e.what() << std::endl;
+        csv_.close();
+        return false;
+    }
+
+    results_.clear();
+    std::cout << "BiasSweep: " << points.size() << " points, " << options.settle_ms << " ms settle, "
+              << std::max(1, options.frames) << " frames each -> " << options.csv_path << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point sweep_start = Clock::now();
+
+    const bool completed = measure(
+        [&](int step) {
+            if (step >= static_cast<int>(points.size())) {
+                return StepStatus::Done;
+            }
+            const BiasPoint& point = points[step];
+            std::cout << "BiasSweep: point " << (step + 1) << "/" << points.size()
+                      << " (on " << point.diff_on << ", off " << point.diff_off
+                      << ", hpf " << point.hpf << ", refr " << point.refr << ")" << std::endl;
+            return apply(biases, point) ? StepStatus::Ready : StepStatus::Failed;
+        },
+        [&](const StepResult& result) {
+            StepResult row = result;
+            row.biases = points[row.step];
+            write_row(row);
+            results_.push_back(row);
+        },
+        options, should_stop);
+
+    csv_.close();
+    if (apply(biases, original)) {
+        std::cout << "BiasSweep: Restored original biases" << std::endl;
+    }
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - sweep_start).count();
+    std::cout << "BiasSweep: " << results_.size() << "/" << points.size() << " points measured in "
+              << elapsed << " s" << (completed ? "" : " (stopped early)") << std::endl;
+    return completed;
+}
+
+bool BiasSweep::measure(const StepFn& next_step, const ResultFn& on_result, const Options& options,
+                        const std::function<bool()>& should_stop) {
+    if (!source_.is_queue_mode()) {
+        std::cerr << "BiasSweep: Frame buffer is not in queue mode" << std::endl;
+        return false;
+    }
+
+    // Shared, not packed again for every measurement (the GA measures each individual)
+    reference_bits_ = options.reference;
+    reference_pixels_ = 0;
+    if (reference_bits_) {
+        if (reference_bits_->empty()) {
+            std::cerr << "BiasSweep: Reference image is empty" << std::endl;
+            return false;
+        }
+        reference_pixels_ = reference_bits_->count();
+    }
+
+    const int frames = std::max(1, options.frames);
+    pool_ = std::make_unique<video::FramePool>(2 * frames);
+    on_result_ = on_result;
+    has_pending_ = false;
+    finishing_ = false;
+
+    consumer_id_ = source_.register_consumer(true);
+    if (consumer_id_ < 0) {
+        pool_.reset();
+        return false;
+    }
+    analysis_thread_ = std::thread(&BiasSweep::analysis_loop, this);
+
+    using Clock = std::chrono::steady_clock;
+    bool completed = false;
+    Batch batch;
+
+    for (int i = 0; !should_stop(); ++i) {
+        const StepStatus status = next_step(i);
+        if (status != StepStatus::Ready) {
+            completed = (status == StepStatus::Done);
+            break;
+        }
+
+        // Settle: frames built meanwhile mix old and new settings, discard them
+        bool stopped = false;
+        const Clock::time_point settle_end = Clock::now() + std::chrono::milliseconds(std::max(options.settle_ms, 0));
+        while (Clock::now() < settle_end) {
+            if (should_stop()) {
+                stopped = true;
+                break;
+            }
+            source_.wait_for_frame(consumer_id_, 50000);
+            drain();
+        }
+        if (stopped) break;
+
+        // The pool holds two batches: wait until the one before the batch in
+        // analysis has given its slots back (usually long done while settling)
+        {
+            std::unique_lock<std::mutex> lock(handoff_mutex_);
+            handoff_cv_.wait(lock, [this] { return !has_pending_; });
+        }
+
+        batch.result = StepResult();
+        batch.result.step = i;
+        if (!capture(batch, options, should_stop)) {
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(handoff_mutex_);
+            std::swap(pending_, batch);
+            has_pending_ = true;
+        }
+        handoff_cv_.notify_all();
+        batch.frames.clear();
+    }
+
+    // Let the analysis thread finish what was handed over
+    {
+        std::lock_guard<std::mutex> lock(handoff_mutex_);
+        finishing_ = true;
+    }
+    handoff_cv_.notify_all();
+    analysis_thread_.join();
+
+    source_.unregister_consumer(consumer_id_);
+    consumer_id_ = -1;
+    pool_.reset();
+    on_result_ = nullptr;
+    return completed;
+}
+
+void BiasSweep::drain() {
+    while (source_.consume_frame(consumer_id_)) {
+    }
+}
+
+bool BiasSweep::capture(Batch& batch, const Options& options, const std::function<bool()>& should_stop) {
+    static core::Counter& events = core::MetricsRegistry::instance().counter("events.ingested");
+    static core::Counter& dropped = core::MetricsRegistry::instance().counter("events.dropped");
+
+    // Frames still queued were (partly) accumulated during the settle
+    drain();
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    const int64_t events_start = events.value();
+    const int64_t dropped_start = dropped.value();
+    const int frames = std::max(1, options.frames);
+    Clock::time_point last_frame = start;
+
+    batch.frames.clear();
+    while (static_cast<int>(batch.frames.size()) < frames) {
+        if (should_stop()) {
+            return false;
+        }
+        if (!source_.wait_for_frame(consumer_id_, 100000)) {
+            if (Clock::now() - last_frame > std::chrono::milliseconds(CAPTURE_TIMEOUT_MS)) {
+                std::cerr << "BiasSweep: No frames for " << CAPTURE_TIMEOUT_MS << " ms, aborting" << std::endl;
+                return false;
+            }
+            continue;
+        }
+
+        while (static_cast<int>(batch.frames.size()) < frames) {
+            auto frame_opt = source_.consume_frame(consumer_id_);
+            if (!frame_opt) break;
+            last_frame = Clock::now();
+
+            video::ReadGuard guard(*frame_opt);
+            if (guard->type() != CV_8UC1) {
+                continue;  // Not a binary display frame
+            }
+            video::FrameRef copy = pool_->acquire(guard->size(), CV_8UC1);
+            if (copy.empty()) {
+                continue;  // Cannot happen with two batches of slots, but never block
+            }
+            guard->copyTo(video::FramePool::writable(copy));
+            batch.frames.push_back(std::move(copy));
+        }
+    }
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    if (elapsed > 0.0) {
+        batch.result.event_rate_kevps = (events.value() - events_start) / elapsed / 1000.0;
+    }
+    batch.result.dropped_events = dropped.value() - dropped_start;
+    return true;
+}
+
+void BiasSweep::analysis_loop() {
+    Batch batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(handoff_mutex_);
+            handoff_cv_.wait(lock, [this] { return has_pending_ || finishing_; });
+            if (!has_pending_) {
+                break;
+            }
+            std::swap(batch, pending_);
+            has_pending_ = false;
+        }
+        handoff_cv_.notify_all();
+
+        analyze(batch);
+        if (on_result_) {
+            on_result_(batch.result);
+        }
+        batch.frames.clear();  // Slots go back to the pool
+    }
+}
+
+void BiasSweep::analyze(Batch& batch) {
+    StepResult& result = batch.result;
+    const int n = static_cast<int>(batch.frames.size());
+    result.frames = n;
+    if (n == 0) return;
+
+    if (static_cast<int>(packed_.size()) < n) {
+        packed_.resize(n);
+    }
+    std::vector<int64_t> active(n, 0);
+    std::vector<int64_t> scattering(n, 0);
+    std::vector<int64_t> missing(n, 0);
+
+    // Frames are independent: pack and count them across the pool
+    const video::BinaryFrame* reference = reference_bits_.get();
+    bool use_reference = reference != nullptr;
+    {
+        video::ReadGuard guard(batch.frames[0]);
+        if (use_reference && guard->size() != reference->size()) {
+            std::cerr << "BiasSweep: Reference size does not match the frames, scattering skipped" << std::endl;
+            use_reference = false;
+        }
+    }
+    video::ThreadPool::shared().parallel_for(n, [&](int i) {
+        video::ReadGuard guard(batch.frames[i]);
+        video::BinaryFrame& bits = packed_[i];
+        bits.assign(guard.get());
+        active[i] = bits.count();
+        if (use_reference) {
+            scattering[i] = video::BinaryFrame::count_andnot(bits, *reference);
+            missing[i] = video::BinaryFrame::count_andnot(*reference, bits);
+        }
+    });
+
+    const video::BinaryFrame& first = packed_[0];
+    const double pixels = static_cast<double>(first.width()) * first.height();
+    if (pixels <= 0.0) return;
+
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    int64_t min_active = active[0];
+    int64_t max_active = active[0];
+    int64_t toggles = 0;
+    ever_active_ = first;
+    always_active_ = first;
+    for (int i = 0; i < n; ++i) {
+        sum += static_cast<double>(active[i]);
+        sum_sq += static_cast<double>(active[i]) * active[i];
+        min_active = std::min(min_active, active[i]);
+        max_active = std::max(max_active, active[i]);
+        if (i > 0) {
+            // XOR popcount as the two one-sided differences
+            toggles += video::BinaryFrame::count_andnot(packed_[i], packed_[i - 1]) +
+                       video::BinaryFrame::count_andnot(packed_[i - 1], packed_[i]);
+            video::BinaryFrame::bitwise_or(ever_active_, packed_[i], ever_active_);
+            video::BinaryFrame::bitwise_and(always_active_, packed_[i], always_active_);
+        }
+    }
+
+    const double mean = sum / n;
+    result.active_mean_percent = mean / pixels * 100.0;
+    result.active_stddev_percent = std::sqrt(std::max(0.0, sum_sq / n - mean * mean)) / pixels * 100.0;
+    result.active_min_percent = min_active / pixels * 100.0;
+    result.active_max_percent = max_active / pixels * 100.0;
+    const int64_t ever = ever_active_.count();
+    const int64_t always = always_active_.count();
+    result.ever_active_percent = ever / pixels * 100.0;
+    result.always_active_percent = always / pixels * 100.0;
+    // Stable pixels against flickering ones; one pixel floor keeps it finite
+    result.snr_db = 10.0 * std::log10(std::max<int64_t>(always, 1) /
+                                      static_cast<double>(std::max<int64_t>(ever - always, 1)));
+    result.toggle_percent = n > 1 ? toggles / static_cast<double>(n - 1) / pixels * 100.0 : 0.0;
+
+    if (use_reference) {
+        int64_t scattering_sum = 0;
+        int64_t missing_sum = 0;
+        for (int i = 0; i < n; ++i) {
+            scattering_sum += scattering[i];
+            missing_sum += missing[i];
+        }
+        result.scattering_percent = scattering_sum / static_cast<double>(n) / pixels * 100.0;
+        result.missing_percent = reference_pixels_ > 0
+            ? missing_sum / static_cast<double>(n) / reference_pixels_ * 100.0 : 0.0;
+    }
+}
+
+void BiasSweep::write_row(const StepResult& r) {
+    csv_ << r.step << "," << r.biases.diff_on << "," << r.biases.diff_off << ","
+         << r.biases.hpf << "," << r.biases.refr << "," << r.frames << ","
+         << r.event_rate_kevps << "," << r.dropped_events << ","
+         << r.active_mean_percent << "," << r.active_stddev_percent << ","
+         << r.active_min_percent << "," << r.active_max_percent << ","
+         << r.ever_active_percent << "," << r.toggle_percent << ",";
+    // Empty cells when no reference was given
+    if (r.scattering_percent >= 0.0) {
+        csv_ << r.scattering_percent << "," << r.missing_percent;
+    } else {
+        csv_ << ",";
+    }
+    csv_ << "," << r.always_active_percent << "," << r.snr_db << "\n";
+    csv_.flush();  // A stopped sweep keeps every finished row
+}
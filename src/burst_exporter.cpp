@@ -0,0 +1,254 @@
+#include "burst_exporter.h"
+#include "core/thread_placement.h"
+#include "video/burst_file.h"
+#include "video/thread_pool.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/**
+ * Read a burst file's header
+ */
+bool read_header(const std::string& path, video::burst_file::FileHeader& header) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    const bool ok = std::fread(&header, sizeof(header), 1, file) == 1 && video::burst_file::is_valid(header);
+    std::fclose(file);
+    return ok;
+}
+
+} // namespace
+
+BurstExporter& BurstExporter::instance() {
+    static BurstExporter exporter;
+    return exporter;
+}
+
+BurstExporter::~BurstExporter() {
+    cancel();
+    wait();
+}
+
+std::vector<std::string> BurstExporter::list_bursts(const std::string& directory) {
+    std::vector<std::pair<fs::file_time_type, std::string>> found;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        if (entry.is_regular_file(ec) && entry.path().extension() == ".rtbf") {
+            found.emplace_back(entry.last_write_time(ec), entry.path().string());
+        }
+    }
+    std::sort(found.begin(), found.end());
+
+    std::vector<std::string> bursts;
+    for (auto& [time, path] : found) {
+        bursts.push_back(std::move(path));
+    }
+    return bursts;
+}
+
+bool BurstExporter::start(const std::vector<std::string>& bursts, int threads) {
+    if (busy_.load()) {
+        return false;
+    }
+    wait();   // Join the previous export's finished thread
+
+    // Headers only: the total is known before the first frame
+    std::vector<Burst> valid;
+    int64_t frames_total = 0;
+    cv::Size size;
+    for (const std::string& path : bursts) {
+        video::burst_file::FileHeader header{};
+        if (!read_header(path, header)) {
+            std::cerr << "BurstExporter: " << path << " is not a burst file, skipped" << std::endl;
+            continue;
+        }
+        valid.push_back(Burst{path, header.frame_count});
+        frames_total += header.frame_count;
+        size = cv::Size(header.width, header.height);
+    }
+    if (valid.empty()) {
+        return false;
+    }
+
+    // Config is read here, on the calling thread
+    const ImageManager::PngOptions png = ImageManager::png_options();
+    const ImageManager::ImageMetadata metadata = ImageManager::create_metadata(size, 0, "");
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    threads = std::max(threads, 1);
+
+    {
+        std::lock_guard<std::mutex> lock(progress_mutex_);
+        progress_ = Progress();
+        progress_.busy = true;
+        progress_.files_total = static_cast<int>(valid.size());
+        progress_.frames_total = frames_total;
+        started_ = std::chrono::steady_clock::now();
+    }
+    frames_done_.store(0);
+    failed_.store(0);
+    cancel_.store(false);
+    busy_.store(true);
+    thread_ = std::thread(&BurstExporter::run, this, std::move(valid), threads, png, metadata);
+    return true;
+}
+
+void BurstExporter::wait() {
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+BurstExporter::Progress BurstExporter::get_progress() const {
+    std::lock_guard<std::mutex> lock(progress_mutex_);
+    Progress progress = progress_;
+    progress.busy = busy_.load();
+    progress.frames_done = frames_done_.load(std::memory_order_relaxed);
+    progress.failed = failed_.load(std::memory_order_relaxed);
+    if (progress.busy) {
+        progress.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+    }
+    return progress;
+}
+
+void BurstExporter::run(std::vector<Burst> bursts, int threads, ImageManager::PngOptions png,
+                        ImageManager::ImageMetadata metadata) {
+    core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::IO);
+
+    // The reader is one thread; every pool worker encodes
+    video::ThreadPool pool(threads);
+    std::vector<Slot> slots(static_cast<size_t>(threads) * MAX_IN_FLIGHT_PER_THREAD);
+    {
+        std::lock_guard<std::mutex> lock(slot_mutex_);
+        free_slots_.clear();
+        for (Slot& slot : slots) {
+            free_slots_.push_back(&slot);
+        }
+    }
+
+    for (const Burst& burst : bursts) {
+        if (cancel_.load()) {
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(progress_mutex_);
+            progress_.current = burst.path;
+        }
+
+        FILE* file = std::fopen(burst.path.c_str(), "rb");
+        video::burst_file::FileHeader header{};
+        if (!file || std::fread(&header, sizeof(header), 1, file) != 1 || !video::burst_file::is_valid(header)) {
+            std::cerr << "BurstExporter: Failed to read " << burst.path << std::endl;
+            if (file) {
+                std::fclose(file);
+            }
+            failed_.fetch_add(burst.frames);
+            continue;
+        }
+
+        // Same folder and frame names as BurstCapture::export_png
+        const fs::path source(burst.path);
+        const fs::path out_dir = source.parent_path() / source.stem();
+        std::error_code ec;
+        fs::create_directories(out_dir, ec);
+
+        uint32_t i = 0;
+        for (; i < header.frame_count && !cancel_.load(); ++i) {
+            Slot* slot = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(slot_mutex_);
+                slot_cv_.wait(lock, [this] { return !free_slots_.empty(); });
+                slot = free_slots_.back();
+                free_slots_.pop_back();
+            }
+
+            if (slot->frame.width() != header.width || slot->frame.height() != header.height) {
+                slot->frame.create(header.width, header.height);
+            }
+            video::burst_file::FrameRecord record{};
+            if (std::fread(&record, sizeof(record), 1, file) != 1 ||
+                std::fread(slot->frame.data(), sizeof(uint64_t), slot->frame.word_count(), file) !=
+                    slot->frame.word_count()) {
+                std::cerr << "BurstExporter: " << burst.path << " is truncated at frame " << i << std::endl;
+                std::lock_guard<std::mutex> lock(slot_mutex_);
+                free_slots_.push_back(slot);
+                break;
+            }
+
+            const int offset = static_cast<int>(i) - static_cast<int>(header.trigger_index);
+            char name[64];
+            std::snprintf(name, sizeof(name), "%06u_%+05d_%lldus.png", i, offset,
+                          static_cast<long long>(record.timestamp_us));
+            slot->png_path = (out_dir / name).string();
+
+            slot->metadata = metadata;
+            slot->metadata.sensor_timestamp_us = record.timestamp_us;
+            slot->metadata.comment = "Burst " + source.filename().string() + " frame " + std::to_string(i) +
+                                     " (" + (offset >= 0 ? "+" : "") + std::to_string(offset) + " from trigger)";
+
+            pool.post([this, slot, &png] { encode(*slot, png); });
+        }
+        std::fclose(file);
+        if (i < header.frame_count) {
+            failed_.fetch_add(header.frame_count - i);   // Truncated or cancelled
+        }
+
+        std::lock_guard<std::mutex> lock(progress_mutex_);
+        ++progress_.files_done;
+        progress_.last_directory = out_dir.string();
+    }
+
+    // Every slot back = every queued frame written
+    {
+        std::unique_lock<std::mutex> lock(slot_mutex_);
+        slot_cv_.wait(lock, [this, &slots] { return free_slots_.size() == slots.size(); });
+    }
+
+    const Progress progress = get_progress();
+    std::cout << "Burst export: " << progress.frames_done << " frames from " << progress.files_done << " bursts in "
+              << progress.elapsed_s << " s";
+    if (progress.failed > 0) {
+        std::cout << " (" << progress.failed << " not written)";
+    }
+    std::cout << std::endl;
+    {
+        std::lock_guard<std::mutex> lock(progress_mutex_);
+        progress_.elapsed_s = progress.elapsed_s;
+        progress_.current.clear();
+    }
+    busy_.store(false);
+}
+
+void BurstExporter::encode(Slot& slot, const ImageManager::PngOptions& png) {
+    thread_local cv::Mat image;   // Per encoder thread, reused
+    slot.frame.to_mat(image);
+
+    ImageManager::ImageMetadata& metadata = slot.metadata;
+    metadata.image_width = image.cols;
+    metadata.image_height = image.rows;
+    metadata.active_pixels = static_cast<int>(slot.frame.count());
+    metadata.pixel_density = static_cast<float>(metadata.active_pixels) / (image.cols * image.rows) * 100.0f;
+
+    fs::path json_path(slot.png_path);
+    json_path.replace_extension(".json");
+    const bool ok = ImageManager::write_png(slot.png_path, image, png) &&
+                    ImageManager::save_metadata_json(json_path.string(), metadata);
+    (ok ? frames_done_ : failed_).fetch_add(1, std::memory_order_relaxed);
+    if (!ok) {
+        std::cerr << "BurstExporter: Failed to write " << slot.png_path << std::endl;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(slot_mutex_);
+        free_slots_.push_back(&slot);
+    }
+    slot_cv_.notify_all();
+}
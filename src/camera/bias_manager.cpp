@@ -1,4 +1,6 @@
 #include "camera/bias_manager.h"
+#include "camera/control_queue.h"
+#include "camera_manager.h"
 #include <imgui.h>
 #include <iostream>
 #include <cmath>
@@ -120,25 +122,29 @@ void BiasManager::apply_to_camera() {
         return;
     }
 
-    std::cout << "BiasManager: Applying biases to " << all_ll_biases_.size() << " camera(s)..." << std::endl;
+    std::map<std::string, int> values;
+    for (const auto& [name, range] : bias_ranges_) {
+        values[name] = range.current;
+    }
 
-    // Apply to all cameras
-    for (size_t cam_idx = 0; cam_idx < all_ll_biases_.size(); ++cam_idx) {
-        auto* camera_biases = all_ll_biases_[cam_idx];
-        if (!camera_biases) continue;
+    // Apply to all cameras, writing only the biases each sensor does not already hold
+    ControlQueue::instance().post("biases", [cameras = all_ll_biases_, values = std::move(values)] {
+        for (size_t cam_idx = 0; cam_idx < cameras.size(); ++cam_idx) {
+            auto* camera_biases = cameras[cam_idx];
+            if (!camera_biases) continue;
 
-        std::cout << "  Camera " << cam_idx << ":" << std::endl;
-        for (const auto& [name, range] : bias_ranges_) {
             try {
-                camera_biases->set(name, range.current);
-                std::cout << "    " << name << "=" << range.current << std::endl;
+                const int written = CameraManager::write_biases(camera_biases, values);
+                if (written < 0) {
+                    std::cerr << "BiasManager: Camera " << cam_idx << " refused some biases" << std::endl;
+                } else if (written > 0) {
+                    std::cout << "BiasManager: Camera " << cam_idx << ": " << written << " bias(es) changed" << std::endl;
+                }
             } catch (const std::exception& e) {
-                std::cerr << "    Warning: Could not set " << name << ": " << e.what() << std::endl;
+                std::cerr << "BiasManager: Could not set biases on camera " << cam_idx << ": " << e.what() << std::endl;
             }
         }
-    }
-
-    std::cout << "BiasManager: Biases applied successfully to all cameras" << std::endl;
+    });
 }
 
 void BiasManager::reset_to_defaults() {
@@ -0,0 +1,131 @@
+#include "camera/control_queue.h"
+#include "camera_manager.h"
+#include "core/metrics.h"
+#include "core/profiler.h"
+#include "core/thread_placement.h"
+#include <chrono>
+#include <iostream>
+
+namespace EventCamera {
+
+ControlQueue& ControlQueue::instance() {
+    static ControlQueue queue;
+    return queue;
+}
+
+ControlQueue::ControlQueue() {
+    thread_ = std::thread(&ControlQueue::worker_loop, this);
+}
+
+ControlQueue::~ControlQueue() {
+    shutdown();
+}
+
+bool ControlQueue::post(const std::string& key, Command command) {
+    if (!command) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return false;
+        }
+        if (!key.empty() && !commands_.empty() && commands_.back().key == key) {
+            commands_.back().command = std::move(command);   // Superseded before it ran
+            coalesced_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        if (commands_.size() >= MAX_PENDING) {
+            std::cerr << "ControlQueue: Queue full, dropping '" << commands_.front().key << "'" << std::endl;
+            commands_.pop_front();
+            failed_.fetch_add(1, std::memory_order_relaxed);
+        }
+        commands_.push_back(Entry{key, std::move(command)});
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void ControlQueue::drain() {
+    if (std::this_thread::get_id() == thread_.get_id()) {
+        return;   // Called from a command: waiting on ourselves would never end
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return commands_.empty() && in_progress_ == 0; });
+}
+
+void ControlQueue::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable() && std::this_thread::get_id() != thread_.get_id()) {
+        thread_.join();
+    }
+}
+
+bool ControlQueue::is_busy() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !commands_.empty() || in_progress_ != 0;
+}
+
+size_t ControlQueue::get_pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return commands_.size() + in_progress_;
+}
+
+void ControlQueue::worker_loop() {
+    core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::IO);
+    while (true) {
+        Entry entry;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !commands_.empty(); });
+            if (commands_.empty()) {
+                break;  // Stopping and fully drained
+            }
+            entry = std::move(commands_.front());
+            commands_.pop_front();
+            in_progress_ = 1;
+        }
+
+        run(entry);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_progress_ = 0;
+        }
+        idle_cv_.notify_all();
+    }
+    idle_cv_.notify_all();
+}
+
+void ControlQueue::run(Entry& entry) {
+    PROFILE_ZONE("ControlQueue::run");
+    static core::Counter& commands = core::MetricsRegistry::instance().counter("camera_control.commands");
+    static core::Counter& failures = core::MetricsRegistry::instance().counter("camera_control.failures");
+    static core::Histogram& command_us = core::MetricsRegistry::instance().histogram("camera_control.command_us");
+
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        // Facilities belong to the device the watchdog may be swapping
+        std::lock_guard<std::mutex> device_lock(CameraManager::instance().device_mutex());
+        entry.command();
+    } catch (const std::exception& e) {
+        failed_.fetch_add(1, std::memory_order_relaxed);
+        failures.add();
+        std::cerr << "ControlQueue: '" << entry.key << "' failed: " << e.what() << std::endl;
+    } catch (...) {
+        failed_.fetch_add(1, std::memory_order_relaxed);
+        failures.add();
+        std::cerr << "ControlQueue: '" << entry.key << "' failed" << std::endl;
+    }
+    command_us.record(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    commands.add();
+    executed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace EventCamera
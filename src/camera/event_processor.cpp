@@ -1,74 +1,130 @@
 #include "camera/event_processor.h"
-#include "core/app_state.h"
-#include <iostream>
+#include "core/metrics.h"
+#include <algorithm>
 #include <chrono>
 
 namespace EventCamera {
 
-EventProcessor::EventProcessor(core::AppState& state)
-    : state_(state) {
+namespace {
+
+/**
+ * Batch statistics metrics, looked up once so recording never touches the registry lock
+ */
+struct BatchMetrics {
+    core::Counter& on_events = core::MetricsRegistry::instance().counter("events.on");
+    core::Counter& off_events = core::MetricsRegistry::instance().counter("events.off");
+    core::Histogram& stats_us = core::MetricsRegistry::instance().histogram("stage.event_stats_us");
+    core::Histogram& batch_span_us = core::MetricsRegistry::instance().histogram("events.batch_span_us");
+};
+
+BatchMetrics& batch_metrics() {
+    static BatchMetrics instance;
+    return instance;
+}
+
+int64_t steady_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+void EventProcessor::configure(uint32_t accumulation_time_us) {
+    accumulation_time_us_ = std::max<uint32_t>(1, accumulation_time_us);
+    window_end_ts_ = -1;
+    window_ = video::simd::EventStats{};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    history_.fill(WindowStats{});
+    windows_ = 0;
 }
 
 void EventProcessor::process_events(const Metavision::EventCD* begin,
                                     const Metavision::EventCD* end) {
+    batch_ = video::simd::EventStats{};
     if (begin == end) {
         return;  // No events to process
     }
 
-    // Update event metrics
-    update_event_metrics(begin, end);
+    BatchMetrics& m = batch_metrics();
+    const int64_t start_us = steady_us();
 
-    // Check if events are too old
-    int64_t last_event_ts = (end - 1)->t;
-    if (is_batch_too_old(last_event_ts)) {
-        return;  // Skip old events
+    if (window_end_ts_ < 0) {
+        // Same alignment as the frame generators
+        window_end_ts_ = (begin->t / accumulation_time_us_ + 1) * accumulation_time_us_;
     }
 
-    // Events are processed by the frame generator which is set up separately
-    // This is just the metrics and validation logic
-}
-
-bool EventProcessor::is_batch_too_old(int64_t event_ts) const {
-    // Get current system time
-    auto now = std::chrono::steady_clock::now();
-    auto now_us = std::chrono::duration_cast<std::chrono::microseconds>(
-        now.time_since_epoch()).count();
-
-    // Convert event timestamp to system time
-    int64_t cam_start = state_.camera_state().get_camera_start_time_us();
-    if (cam_start == 0) {
-        return false;  // Can't determine age without start time
+    // One pass per window span; the batch totals are the merged spans
+    const Metavision::EventCD* it = begin;
+    while (it != end) {
+        // Timestamps are non-decreasing, so the window boundary is a binary search
+        const int64_t window_end = window_end_ts_;
+        const Metavision::EventCD* split = std::partition_point(it, end,
+            [window_end](const Metavision::EventCD& ev) { return ev.t < window_end; });
+
+        video::simd::EventStats span;
+        video::simd::event_stats(it, split, span);
+        window_.merge(span);
+        batch_.merge(span);
+        it = split;
+        if (split == end) {
+            break;
+        }
+
+        publish(window_end_ts_);
+        window_end_ts_ += accumulation_time_us_;
+
+        // Skip over idle gaps: no history entry per empty window
+        if (split->t >= window_end_ts_) {
+            window_end_ts_ = (split->t / accumulation_time_us_ + 1) * accumulation_time_us_;
+        }
     }
 
-    int64_t event_system_ts = cam_start + event_ts;
-    int64_t age_us = now_us - event_system_ts;
+    m.on_events.add(static_cast<int64_t>(batch_.on_events));
+    m.off_events.add(static_cast<int64_t>(batch_.events - batch_.on_events));
+    m.batch_span_us.record(batch_.t_max - batch_.t_min);
+    m.stats_us.record(steady_us() - start_us);
+}
 
-    // Consider events older than 5 seconds as too old
-    const int64_t MAX_EVENT_AGE_US = 5000000;  // 5 seconds
-    if (age_us > MAX_EVENT_AGE_US) {
-        std::cerr << "Warning: Skipping old event batch (age: "
-                 << (age_us / 1000000.0) << " seconds)" << std::endl;
-        return true;
+void EventProcessor::publish(int64_t window_end_ts) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        WindowStats& entry = history_[windows_ % HISTORY];
+        entry.window_end_ts = window_end_ts;
+        entry.window_us = accumulation_time_us_;
+        entry.window_index = ++windows_;
+        entry.stats = window_;
     }
+    window_ = video::simd::EventStats{};
+}
 
+bool EventProcessor::get_window(int64_t window_end_ts, WindowStats& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const WindowStats& entry : history_) {
+        if (entry.window_index != 0 && entry.window_end_ts == window_end_ts) {
+            out = entry;
+            return true;
+        }
+    }
     return false;
 }
 
-void EventProcessor::update_event_metrics(const Metavision::EventCD* begin,
-                                          const Metavision::EventCD* end) {
-    if (begin == end) {
-        return;
+bool EventProcessor::get_last_window(WindowStats& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (windows_ == 0) {
+        return false;
     }
+    out = history_[(windows_ - 1) % HISTORY];
+    return true;
+}
 
-    // Count events in batch
-    int64_t event_count = end - begin;
-
-    // Get timestamp of last event
-    int64_t last_event_ts = (end - 1)->t;
-
-    // Update metrics
-    state_.event_metrics().record_events(event_count, last_event_ts);
-    state_.event_metrics().record_event_timestamp(last_event_ts);
+uint64_t EventProcessor::get_windows_since(uint64_t after_index, std::vector<WindowStats>& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t oldest = windows_ > HISTORY ? windows_ - HISTORY + 1 : 1;
+    for (uint64_t index = std::max(after_index + 1, oldest); index <= windows_; ++index) {
+        out.push_back(history_[(index - 1) % HISTORY]);
+    }
+    return std::max(after_index, windows_);
 }
 
 } // namespace EventCamera
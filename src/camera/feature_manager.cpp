@@ -1,4 +1,5 @@
 #include "camera/feature_manager.h"
+#include "camera/control_queue.h"
 #include <algorithm>
 #include <iostream>
 
@@ -7,16 +8,18 @@ namespace EventCamera {
 void FeatureManager::register_feature(std::shared_ptr<IHardwareFeature> feature) {
     std::lock_guard<std::mutex> lock(mutex_);
     if (feature) {
-        features_.push_back(feature);
+        auto features = std::make_shared<FeatureList>(*features_);
+        features->push_back(feature);
+        std::atomic_store(&features_, std::shared_ptr<const FeatureList>(std::move(features)));
         std::cout << "Registered feature: " << feature->name() << std::endl;
     }
 }
 
 void FeatureManager::initialize_all(Metavision::Camera& camera) {
     std::lock_guard<std::mutex> lock(mutex_);
-    std::cout << "Initializing " << features_.size() << " features..." << std::endl;
+    std::cout << "Initializing " << features_->size() << " features..." << std::endl;
 
-    for (auto& feature : features_) {
+    for (auto& feature : *features_) {
         try {
             bool success = feature->initialize(camera);
             if (success) {
@@ -35,7 +38,7 @@ bool FeatureManager::add_camera(Metavision::Camera& camera) {
     std::cout << "Adding camera to all features..." << std::endl;
 
     bool all_success = true;
-    for (auto& feature : features_) {
+    for (auto& feature : *features_) {
         if (feature->is_available()) {
             try {
                 bool success = feature->add_camera(camera);
@@ -56,10 +59,13 @@ bool FeatureManager::add_camera(Metavision::Camera& camera) {
 }
 
 void FeatureManager::shutdown_all() {
+    // Queued writes still reference the facilities about to be released
+    ControlQueue::instance().drain();
+
     std::lock_guard<std::mutex> lock(mutex_);
     std::cout << "Shutting down features..." << std::endl;
 
-    for (auto& feature : features_) {
+    for (auto& feature : *features_) {
         try {
             feature->shutdown();
         } catch (const std::exception& e) {
@@ -71,16 +77,16 @@ void FeatureManager::shutdown_all() {
 
 void FeatureManager::clear() {
     std::lock_guard<std::mutex> lock(mutex_);
-    features_.clear();
+    std::atomic_store(&features_, std::make_shared<const FeatureList>());
     std::cout << "Feature manager cleared" << std::endl;
 }
 
 std::vector<std::shared_ptr<IHardwareFeature>>
 FeatureManager::get_features_by_category(FeatureCategory category) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const auto features = get_all_features();
     std::vector<std::shared_ptr<IHardwareFeature>> result;
 
-    for (auto& feature : features_) {
+    for (auto& feature : *features) {
         if (feature->category() == category) {
             result.push_back(feature);
         }
@@ -90,14 +96,14 @@ FeatureManager::get_features_by_category(FeatureCategory category) {
 }
 
 std::shared_ptr<IHardwareFeature> FeatureManager::get_feature(const std::string& name) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const auto features = get_all_features();
 
-    auto it = std::find_if(features_.begin(), features_.end(),
+    auto it = std::find_if(features->begin(), features->end(),
         [&name](const std::shared_ptr<IHardwareFeature>& feature) {
             return feature->name() == name;
         });
 
-    if (it != features_.end()) {
+    if (it != features->end()) {
         return *it;
     }
 
@@ -105,10 +111,11 @@ std::shared_ptr<IHardwareFeature> FeatureManager::get_feature(const std::string&
 }
 
 void FeatureManager::render_all_ui() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    // No lock: hardware writes are queued, so rendering never waits on the camera
+    const auto features = get_all_features();
 
     // Render features organized by category
-    for (auto& feature : features_) {
+    for (auto& feature : *features) {
         if (feature->is_available()) {
             try {
                 feature->render_ui();
@@ -121,9 +128,9 @@ void FeatureManager::render_all_ui() {
 }
 
 void FeatureManager::apply_all_settings() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const auto features = get_all_features();
 
-    for (auto& feature : features_) {
+    for (auto& feature : *features) {
         if (feature->is_available() && feature->is_enabled()) {
             try {
                 feature->apply_settings();
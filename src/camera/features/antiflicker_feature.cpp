@@ -1,4 +1,5 @@
 #include "camera/features/antiflicker_feature.h"
+#include "camera/control_queue.h"
 #include <imgui.h>
 #include <iostream>
 #include <algorithm>
@@ -21,9 +22,12 @@ bool AntiFlickerFeature::initialize(Metavision::Camera& camera) {
         uint32_t min_freq = antiflicker_->get_min_supported_frequency();
         uint32_t max_freq = antiflicker_->get_max_supported_frequency();
 
+        min_supported_freq_ = static_cast<int>(min_freq);
+        max_supported_freq_ = static_cast<int>(max_freq);
+
         // Set default frequency range for 100-150Hz
-        low_freq_ = std::max((int)min_freq, 100);
-        high_freq_ = std::min((int)max_freq, 150);
+        low_freq_ = std::max(min_supported_freq_, 100);
+        high_freq_ = std::min(max_supported_freq_, 150);
 
         std::cout << "AntiFlickerFeature: Initialized (freq range: " << min_freq
                  << " - " << max_freq << " Hz)" << std::endl;
@@ -63,18 +67,20 @@ void AntiFlickerFeature::enable(bool enabled) {
 
     enabled_ = enabled;
 
-    std::cout << "Anti-Flicker " << (enabled_ ? "enabling" : "disabling")
-              << " on " << all_antiflicker_.size() << " camera(s)..." << std::endl;
-
-    for (size_t i = 0; i < all_antiflicker_.size(); ++i) {
-        try {
-            all_antiflicker_[i]->enable(enabled_);
-            std::cout << "  Camera " << i << ": " << (enabled_ ? "enabled" : "disabled") << std::endl;
-        } catch (const std::exception& e) {
-            std::cerr << "  Camera " << i << ": Failed to " << (enabled ? "enable" : "disable")
-                     << ": " << e.what() << std::endl;
+    ControlQueue::instance().post("antiflicker.enable", [modules = all_antiflicker_, enabled] {
+        std::cout << "Anti-Flicker " << (enabled ? "enabling" : "disabling")
+                  << " on " << modules.size() << " camera(s)..." << std::endl;
+
+        for (size_t i = 0; i < modules.size(); ++i) {
+            try {
+                modules[i]->enable(enabled);
+                std::cout << "  Camera " << i << ": " << (enabled ? "enabled" : "disabled") << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "  Camera " << i << ": Failed to " << (enabled ? "enable" : "disable")
+                         << ": " << e.what() << std::endl;
+            }
         }
-    }
+    });
 }
 
 void AntiFlickerFeature::apply_settings() {
@@ -85,20 +91,24 @@ void AntiFlickerFeature::apply_settings() {
         Metavision::I_AntiFlickerModule::BAND_STOP :
         Metavision::I_AntiFlickerModule::BAND_PASS;
 
-    std::cout << "Anti-Flicker applying settings to " << all_antiflicker_.size() << " camera(s)..." << std::endl;
-
-    for (size_t i = 0; i < all_antiflicker_.size(); ++i) {
-        try {
-            all_antiflicker_[i]->set_filtering_mode(mode);
-            all_antiflicker_[i]->set_frequency_band(low_freq_, high_freq_);
-            all_antiflicker_[i]->set_duty_cycle(duty_cycle_);
-            std::cout << "  Camera " << i << ": mode=" << mode_
-                     << " freq=[" << low_freq_ << "," << high_freq_ << "]Hz"
-                     << " duty=" << duty_cycle_ << "%" << std::endl;
-        } catch (const std::exception& e) {
-            std::cerr << "  Camera " << i << ": Failed to apply settings: " << e.what() << std::endl;
+    ControlQueue::instance().post("antiflicker.settings",
+        [modules = all_antiflicker_, mode, mode_index = mode_, low = low_freq_, high = high_freq_,
+         duty = duty_cycle_] {
+        std::cout << "Anti-Flicker applying settings to " << modules.size() << " camera(s)..." << std::endl;
+
+        for (size_t i = 0; i < modules.size(); ++i) {
+            try {
+                modules[i]->set_filtering_mode(mode);
+                modules[i]->set_frequency_band(low, high);
+                modules[i]->set_duty_cycle(duty);
+                std::cout << "  Camera " << i << ": mode=" << mode_index
+                         << " freq=[" << low << "," << high << "]Hz"
+                         << " duty=" << duty << "%" << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "  Camera " << i << ": Failed to apply settings: " << e.what() << std::endl;
+            }
         }
-    }
+    });
 }
 
 void AntiFlickerFeature::set_filtering_mode(int mode) {
@@ -147,9 +157,9 @@ bool AntiFlickerFeature::render_ui() {
         ImGui::Spacing();
         ImGui::Text("Frequency Band:");
 
-        // Get supported frequency range
-        uint32_t min_freq = antiflicker_->get_min_supported_frequency();
-        uint32_t max_freq = antiflicker_->get_max_supported_frequency();
+        // Supported frequency range, read at initialize()
+        int min_freq = min_supported_freq_;
+        int max_freq = max_supported_freq_;
 
         bool freq_changed = false;
         freq_changed |= ImGui::SliderInt("Low Frequency (Hz)", &low_freq_, min_freq, max_freq);
@@ -176,29 +186,29 @@ bool AntiFlickerFeature::render_ui() {
         ImGui::TextWrapped("Common presets:");
         ImGui::SameLine();
         if (ImGui::SmallButton("50Hz")) {
-            low_freq_ = std::max((int)min_freq, 45);
-            high_freq_ = std::min((int)max_freq, 55);
+            low_freq_ = std::max(min_freq, 45);
+            high_freq_ = std::min(max_freq, 55);
             apply_settings();
             changed = true;
         }
         ImGui::SameLine();
         if (ImGui::SmallButton("60Hz")) {
-            low_freq_ = std::max((int)min_freq, 55);
-            high_freq_ = std::min((int)max_freq, 65);
+            low_freq_ = std::max(min_freq, 55);
+            high_freq_ = std::min(max_freq, 65);
             apply_settings();
             changed = true;
         }
         ImGui::SameLine();
         if (ImGui::SmallButton("100Hz")) {
-            low_freq_ = std::max((int)min_freq, 95);
-            high_freq_ = std::min((int)max_freq, 105);
+            low_freq_ = std::max(min_freq, 95);
+            high_freq_ = std::min(max_freq, 105);
             apply_settings();
             changed = true;
         }
         ImGui::SameLine();
         if (ImGui::SmallButton("120Hz")) {
-            low_freq_ = std::max((int)min_freq, 115);
-            high_freq_ = std::min((int)max_freq, 125);
+            low_freq_ = std::max(min_freq, 115);
+            high_freq_ = std::min(max_freq, 125);
             apply_settings();
             changed = true;
         }
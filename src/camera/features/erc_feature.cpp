@@ -1,4 +1,5 @@
 #include "camera/features/erc_feature.h"
+#include "camera/control_queue.h"
 #include <imgui.h>
 #include <iostream>
 
@@ -24,7 +25,10 @@ bool ERCFeature::initialize(Metavision::Camera& camera) {
         uint32_t max_rate = erc_->get_max_supported_cd_event_rate();
 
         // Set initial rate to middle of range if not already set
-        target_rate_kevps_ = (min_rate / 1000 + max_rate / 1000) / 2;
+        min_rate_kevps_ = static_cast<int>(min_rate / 1000);
+        max_rate_kevps_ = static_cast<int>(max_rate / 1000);
+        target_rate_kevps_ = (min_rate_kevps_ + max_rate_kevps_) / 2;
+        count_period_us_ = erc_->get_count_period();
 
         std::cout << "ERCFeature: Initialized (rate range: " << min_rate / 1000
                  << " - " << max_rate / 1000 << " kev/s)" << std::endl;
@@ -64,18 +68,20 @@ void ERCFeature::enable(bool enabled) {
 
     enabled_ = enabled;
 
-    std::cout << "ERC " << (enabled_ ? "enabling" : "disabling")
-              << " on " << all_erc_.size() << " camera(s)..." << std::endl;
+    ControlQueue::instance().post("erc.enable", [modules = all_erc_, enabled] {
+        std::cout << "ERC " << (enabled ? "enabling" : "disabling")
+                  << " on " << modules.size() << " camera(s)..." << std::endl;
 
-    for (size_t i = 0; i < all_erc_.size(); ++i) {
-        try {
-            all_erc_[i]->enable(enabled_);
-            std::cout << "  Camera " << i << ": " << (enabled_ ? "enabled" : "disabled") << std::endl;
-        } catch (const std::exception& e) {
-            std::cerr << "  Camera " << i << ": Failed to " << (enabled ? "enable" : "disable")
-                     << ": " << e.what() << std::endl;
+        for (size_t i = 0; i < modules.size(); ++i) {
+            try {
+                modules[i]->enable(enabled);
+                std::cout << "  Camera " << i << ": " << (enabled ? "enabled" : "disabled") << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "  Camera " << i << ": Failed to " << (enabled ? "enable" : "disable")
+                         << ": " << e.what() << std::endl;
+            }
         }
-    }
+    });
 }
 
 void ERCFeature::apply_settings() {
@@ -83,17 +89,19 @@ void ERCFeature::apply_settings() {
 
     uint32_t rate_ev_s = target_rate_kevps_ * 1000;
 
-    std::cout << "ERC applying settings to " << all_erc_.size() << " camera(s)..." << std::endl;
+    ControlQueue::instance().post("erc.rate", [modules = all_erc_, rate_ev_s] {
+        std::cout << "ERC applying settings to " << modules.size() << " camera(s)..." << std::endl;
 
-    for (size_t i = 0; i < all_erc_.size(); ++i) {
-        try {
-            all_erc_[i]->set_cd_event_rate(rate_ev_s);
-            std::cout << "  Camera " << i << ": rate=" << rate_ev_s << " ev/s ("
-                     << target_rate_kevps_ << " kev/s)" << std::endl;
-        } catch (const std::exception& e) {
-            std::cerr << "  Camera " << i << ": Failed to set event rate: " << e.what() << std::endl;
+        for (size_t i = 0; i < modules.size(); ++i) {
+            try {
+                modules[i]->set_cd_event_rate(rate_ev_s);
+                std::cout << "  Camera " << i << ": rate=" << rate_ev_s << " ev/s ("
+                         << rate_ev_s / 1000 << " kev/s)" << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "  Camera " << i << ": Failed to set event rate: " << e.what() << std::endl;
+            }
         }
-    }
+    });
 }
 
 void ERCFeature::set_event_rate_kevps(int rate_kevps) {
@@ -122,9 +130,9 @@ bool ERCFeature::render_ui() {
         ImGui::Spacing();
 
         if (enabled_) {
-            // Get hardware limits
-            uint32_t min_rate = erc_->get_min_supported_cd_event_rate() / 1000;  // kev/s
-            uint32_t max_rate = erc_->get_max_supported_cd_event_rate() / 1000;
+            // Hardware limits, read at initialize()
+            int min_rate = min_rate_kevps_;  // kev/s
+            int max_rate = max_rate_kevps_;
 
             // Rate slider
             int rate = target_rate_kevps_;
@@ -139,10 +147,9 @@ bool ERCFeature::render_ui() {
             ImGui::TextWrapped("Range: %d - %d kev/s", min_rate, max_rate);
 
             // Show count period
-            try {
-                uint32_t period = erc_->get_count_period();
-                ImGui::Text("Count Period: %d μs", period);
-            } catch (...) {}
+            if (count_period_us_ > 0) {
+                ImGui::Text("Count Period: %u μs", count_period_us_);
+            }
         }
 
         ImGui::TreePop();
@@ -1,4 +1,5 @@
 #include "camera/features/monitoring_feature.h"
+#include "camera/control_queue.h"
 #include <imgui.h>
 #include <iostream>
 
@@ -40,6 +41,9 @@ void MonitoringFeature::shutdown() {
     has_temperature_ = false;
     has_illumination_ = false;
     has_dead_time_ = false;
+
+    std::lock_guard<std::mutex> lock(readings_->mutex);
+    readings_->values.clear();
 }
 
 bool MonitoringFeature::is_available() const {
@@ -81,55 +85,101 @@ void MonitoringFeature::detect_capabilities() {
     }
 }
 
+void MonitoringFeature::request_poll() {
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_poll_ < POLL_INTERVAL) {
+        return;
+    }
+    last_poll_ = now;
+
+    ControlQueue::instance().post("monitoring.poll",
+        [modules = all_monitoring_, readings = readings_,
+         temperature = has_temperature_, illumination = has_illumination_, dead_time = has_dead_time_] {
+        std::vector<Reading> values(modules.size());
+        for (size_t i = 0; i < modules.size(); ++i) {
+            Reading& reading = values[i];
+            if (temperature) {
+                try {
+                    reading.temperature = modules[i]->get_temperature();
+                    reading.temperature_ok = true;
+                } catch (...) {}
+            }
+            if (illumination) {
+                try {
+                    reading.illumination = modules[i]->get_illumination();
+                    reading.illumination_ok = true;
+                } catch (...) {}
+            }
+            if (dead_time) {
+                try {
+                    reading.dead_time = modules[i]->get_pixel_dead_time();
+                    reading.dead_time_ok = true;
+                } catch (...) {}
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(readings->mutex);
+        readings->values = std::move(values);
+    });
+}
+
 bool MonitoringFeature::render_ui() {
     if (!is_available()) {
         return false;
     }
 
     if (ImGui::TreeNode("Hardware Monitoring")) {
+        request_poll();
+
+        std::vector<Reading> values;
+        {
+            std::lock_guard<std::mutex> lock(readings_->mutex);
+            values = readings_->values;
+        }
+        if (values.empty()) {
+            ImGui::TextDisabled("Reading sensors...");
+        }
+
         // Display information for each camera
-        for (size_t cam_idx = 0; cam_idx < all_monitoring_.size(); ++cam_idx) {
-            auto* mon = all_monitoring_[cam_idx];
+        for (size_t cam_idx = 0; cam_idx < values.size(); ++cam_idx) {
+            const Reading& reading = values[cam_idx];
 
-            if (all_monitoring_.size() > 1) {
+            if (values.size() > 1) {
                 ImGui::Text("Camera %zu:", cam_idx);
                 ImGui::Indent();
             }
 
             if (has_temperature_) {
-                try {
-                    int temp = mon->get_temperature();
-                    ImGui::Text("Temperature: %d°C", temp);
-                    if (temp > 60) {
+                if (reading.temperature_ok) {
+                    ImGui::Text("Temperature: %d°C", reading.temperature);
+                    if (reading.temperature > 60) {
                         ImGui::SameLine();
                         ImGui::TextColored(ImVec4(1, 0, 0, 1), "⚠ HOT");
                     }
-                } catch (...) {
+                } else {
                     ImGui::TextColored(ImVec4(1, 0.5f, 0, 1), "Temperature: Error");
                 }
             }
 
             if (has_illumination_) {
-                try {
-                    int illum = mon->get_illumination();
-                    ImGui::Text("Illumination: %d lux", illum);
-                } catch (...) {
+                if (reading.illumination_ok) {
+                    ImGui::Text("Illumination: %d lux", reading.illumination);
+                } else {
                     ImGui::TextColored(ImVec4(1, 0.5f, 0, 1), "Illumination: Error");
                 }
             }
 
             if (has_dead_time_) {
-                try {
-                    int dead_time = mon->get_pixel_dead_time();
-                    ImGui::Text("Pixel Dead Time: %d μs", dead_time);
-                } catch (...) {
+                if (reading.dead_time_ok) {
+                    ImGui::Text("Pixel Dead Time: %d μs", reading.dead_time);
+                } else {
                     ImGui::TextColored(ImVec4(1, 0.5f, 0, 1), "Pixel Dead Time: Error");
                 }
             }
 
-            if (all_monitoring_.size() > 1) {
+            if (values.size() > 1) {
                 ImGui::Unindent();
-                if (cam_idx < all_monitoring_.size() - 1) {
+                if (cam_idx < values.size() - 1) {
                     ImGui::Spacing();
                 }
             }
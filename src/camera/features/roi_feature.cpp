@@ -1,4 +1,5 @@
 #include "camera/features/roi_feature.h"
+#include "camera/control_queue.h"
 #include "video/filters/roi_filter.h"
 #include <imgui.h>
 #include <iostream>
@@ -58,18 +59,20 @@ void ROIFeature::enable(bool enabled) {
 
     enabled_ = enabled;
 
-    std::cout << "ROI " << (enabled_ ? "enabling" : "disabling")
-              << " on " << all_roi_.size() << " camera(s)..." << std::endl;
-
-    for (size_t i = 0; i < all_roi_.size(); ++i) {
-        try {
-            all_roi_[i]->enable(enabled_);
-            std::cout << "  Camera " << i << ": " << (enabled_ ? "enabled" : "disabled") << std::endl;
-        } catch (const std::exception& e) {
-            std::cerr << "  Camera " << i << ": Failed to " << (enabled ? "enable" : "disable")
-                     << ": " << e.what() << std::endl;
+    ControlQueue::instance().post("roi.enable", [modules = all_roi_, enabled] {
+        std::cout << "ROI " << (enabled ? "enabling" : "disabling")
+                  << " on " << modules.size() << " camera(s)..." << std::endl;
+
+        for (size_t i = 0; i < modules.size(); ++i) {
+            try {
+                modules[i]->enable(enabled);
+                std::cout << "  Camera " << i << ": " << (enabled ? "enabled" : "disabled") << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "  Camera " << i << ": Failed to " << (enabled ? "enable" : "disable")
+                         << ": " << e.what() << std::endl;
+            }
         }
-    }
+    });
 
     // If enabling, apply current window
     if (enabled_) {
@@ -89,17 +92,19 @@ void ROIFeature::apply_settings() {
 
     Metavision::I_ROI::Window window(x_, y_, width_, height_);
 
-    std::cout << "ROI applying settings to " << all_roi_.size() << " camera(s)..." << std::endl;
-
-    for (size_t i = 0; i < all_roi_.size(); ++i) {
-        try {
-            all_roi_[i]->set_window(window);
-            std::cout << "  Camera " << i << ": x=" << x_ << " y=" << y_
-                     << " w=" << width_ << " h=" << height_ << std::endl;
-        } catch (const std::exception& e) {
-            std::cerr << "  Camera " << i << ": Failed to apply settings: " << e.what() << std::endl;
+    ControlQueue::instance().post("roi.window", [modules = all_roi_, window] {
+        std::cout << "ROI applying settings to " << modules.size() << " camera(s)..." << std::endl;
+
+        for (size_t i = 0; i < modules.size(); ++i) {
+            try {
+                modules[i]->set_window(window);
+                std::cout << "  Camera " << i << ": x=" << window.x << " y=" << window.y
+                         << " w=" << window.width << " h=" << window.height << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "  Camera " << i << ": Failed to apply settings: " << e.what() << std::endl;
+            }
         }
-    }
+    });
 }
 
 void ROIFeature::set_mode(Metavision::I_ROI::Mode mode) {
@@ -107,17 +112,20 @@ void ROIFeature::set_mode(Metavision::I_ROI::Mode mode) {
 
     mode_ = (mode == Metavision::I_ROI::Mode::ROI) ? 0 : 1;
 
-    std::cout << "ROI setting mode to " << (mode_ == 0 ? "ROI" : "RONI")
-              << " on " << all_roi_.size() << " camera(s)..." << std::endl;
-
-    for (size_t i = 0; i < all_roi_.size(); ++i) {
-        try {
-            all_roi_[i]->set_mode(mode);
-            std::cout << "  Camera " << i << ": mode=" << (mode_ == 0 ? "ROI" : "RONI") << std::endl;
-        } catch (const std::exception& e) {
-            std::cerr << "  Camera " << i << ": Failed to set mode: " << e.what() << std::endl;
+    ControlQueue::instance().post("roi.mode", [modules = all_roi_, mode] {
+        const char* mode_name = (mode == Metavision::I_ROI::Mode::ROI) ? "ROI" : "RONI";
+        std::cout << "ROI setting mode to " << mode_name
+                  << " on " << modules.size() << " camera(s)..." << std::endl;
+
+        for (size_t i = 0; i < modules.size(); ++i) {
+            try {
+                modules[i]->set_mode(mode);
+                std::cout << "  Camera " << i << ": mode=" << mode_name << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "  Camera " << i << ": Failed to set mode: " << e.what() << std::endl;
+            }
         }
-    }
+    });
 }
 
 void ROIFeature::set_window(int x, int y, int width, int height) {
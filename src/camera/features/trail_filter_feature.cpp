@@ -1,4 +1,5 @@
 #include "camera/features/trail_filter_feature.h"
+#include "camera/control_queue.h"
 #include <imgui.h>
 #include <iostream>
 
@@ -19,6 +20,8 @@ bool TrailFilterFeature::initialize(Metavision::Camera& camera) {
         // Get reasonable defaults from hardware
         uint32_t min_thresh = trail_filter_->get_min_supported_threshold();
         uint32_t max_thresh = trail_filter_->get_max_supported_threshold();
+        min_threshold_us_ = min_thresh;
+        max_threshold_us_ = max_thresh;
 
         // Read current camera state (which was set from config in main.cpp)
         enabled_ = trail_filter_->is_enabled();
@@ -65,61 +68,58 @@ void TrailFilterFeature::shutdown() {
 void TrailFilterFeature::enable(bool enabled) {
     if (all_trail_filters_.empty()) return;
 
-    std::cout << "\n=== Trail Filter Toggle ===" << std::endl;
-    std::cout << "Changing enabled state from " << (enabled_ ? "ON" : "OFF")
-              << " to " << (enabled ? "ON" : "OFF") << std::endl;
-    std::cout << "Current settings: type=" << filter_type_
-              << ", threshold=" << threshold_us_ << "μs" << std::endl;
-
-    // Query camera state BEFORE change
-    for (size_t i = 0; i < all_trail_filters_.size(); ++i) {
-        try {
-            bool camera_enabled = all_trail_filters_[i]->is_enabled();
-            uint32_t camera_threshold = all_trail_filters_[i]->get_threshold();
-            auto camera_type = all_trail_filters_[i]->get_type();
-            int camera_type_idx = (camera_type == Metavision::I_EventTrailFilterModule::Type::TRAIL) ? 0 :
-                                  (camera_type == Metavision::I_EventTrailFilterModule::Type::STC_CUT_TRAIL) ? 1 : 2;
-            std::cout << "  Camera " << i << " BEFORE: "
-                     << (camera_enabled ? "enabled" : "disabled")
-                     << ", type=" << camera_type_idx
-                     << ", threshold=" << camera_threshold << "μs" << std::endl;
-        } catch (const std::exception& e) {
-            std::cerr << "  Camera " << i << " BEFORE: Failed to query state: " << e.what() << std::endl;
-        }
-    }
-
+    const bool was_enabled = enabled_;
     enabled_ = enabled;
 
-    std::cout << "Event Trail Filter " << (enabled_ ? "enabling" : "disabling")
-              << " on " << all_trail_filters_.size() << " camera(s)..." << std::endl;
+    ControlQueue::instance().post("trail.enable",
+        [modules = all_trail_filters_, enabled, was_enabled, type = filter_type_, threshold = threshold_us_] {
+        auto type_index = [](Metavision::I_EventTrailFilterModule::Type camera_type) {
+            return (camera_type == Metavision::I_EventTrailFilterModule::Type::TRAIL) ? 0 :
+                   (camera_type == Metavision::I_EventTrailFilterModule::Type::STC_CUT_TRAIL) ? 1 : 2;
+        };
+        auto print_state = [&](const char* when) {
+            for (size_t i = 0; i < modules.size(); ++i) {
+                try {
+                    bool camera_enabled = modules[i]->is_enabled();
+                    uint32_t camera_threshold = modules[i]->get_threshold();
+                    int camera_type_idx = type_index(modules[i]->get_type());
+
+                    std::cout << "  Camera " << i << " " << when << ": "
+                             << (camera_enabled ? "enabled" : "disabled")
+                             << ", type=" << camera_type_idx
+                             << ", threshold=" << camera_threshold << "μs" << std::endl;
+                } catch (const std::exception& e) {
+                    std::cerr << "  Camera " << i << " " << when << ": Failed to query state: " << e.what() << std::endl;
+                }
+            }
+        };
 
-    for (size_t i = 0; i < all_trail_filters_.size(); ++i) {
-        try {
-            all_trail_filters_[i]->enable(enabled_);
-            std::cout << "  Camera " << i << ": " << (enabled_ ? "enabled" : "disabled") << std::endl;
-        } catch (const std::exception& e) {
-            std::cerr << "  Camera " << i << ": Failed to " << (enabled ? "enable" : "disable")
-                     << ": " << e.what() << std::endl;
+        std::cout << "\n=== Trail Filter Toggle ===" << std::endl;
+        std::cout << "Changing enabled state from " << (was_enabled ? "ON" : "OFF")
+                  << " to " << (enabled ? "ON" : "OFF") << std::endl;
+        std::cout << "Current settings: type=" << type
+                  << ", threshold=" << threshold << "μs" << std::endl;
+
+        // Query camera state BEFORE change
+        print_state("BEFORE");
+
+        std::cout << "Event Trail Filter " << (enabled ? "enabling" : "disabling")
+                  << " on " << modules.size() << " camera(s)..." << std::endl;
+
+        for (size_t i = 0; i < modules.size(); ++i) {
+            try {
+                modules[i]->enable(enabled);
+                std::cout << "  Camera " << i << ": " << (enabled ? "enabled" : "disabled") << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "  Camera " << i << ": Failed to " << (enabled ? "enable" : "disable")
+                         << ": " << e.what() << std::endl;
+            }
         }
-    }
 
-    // Query camera state AFTER change
-    for (size_t i = 0; i < all_trail_filters_.size(); ++i) {
-        try {
-            bool camera_enabled = all_trail_filters_[i]->is_enabled();
-            uint32_t camera_threshold = all_trail_filters_[i]->get_threshold();
-            auto camera_type = all_trail_filters_[i]->get_type();
-            int camera_type_idx = (camera_type == Metavision::I_EventTrailFilterModule::Type::TRAIL) ? 0 :
-                                  (camera_type == Metavision::I_EventTrailFilterModule::Type::STC_CUT_TRAIL) ? 1 : 2;
-            std::cout << "  Camera " << i << " AFTER: "
-                     << (camera_enabled ? "enabled" : "disabled")
-                     << ", type=" << camera_type_idx
-                     << ", threshold=" << camera_threshold << "μs" << std::endl;
-        } catch (const std::exception& e) {
-            std::cerr << "  Camera " << i << " AFTER: Failed to query state: " << e.what() << std::endl;
-        }
-    }
-    std::cout << "==========================\n" << std::endl;
+        // Query camera state AFTER change
+        print_state("AFTER");
+        std::cout << "==========================\n" << std::endl;
+    });
 }
 
 void TrailFilterFeature::apply_settings() {
@@ -134,18 +134,21 @@ void TrailFilterFeature::apply_settings() {
         default: type = Metavision::I_EventTrailFilterModule::Type::TRAIL; break;
     }
 
-    std::cout << "Trail Filter applying settings to " << all_trail_filters_.size() << " camera(s)..." << std::endl;
-
-    for (size_t i = 0; i < all_trail_filters_.size(); ++i) {
-        try {
-            all_trail_filters_[i]->set_type(type);
-            all_trail_filters_[i]->set_threshold(threshold_us_);
-            std::cout << "  Camera " << i << ": type=" << filter_type_
-                     << " threshold=" << threshold_us_ << "μs" << std::endl;
-        } catch (const std::exception& e) {
-            std::cerr << "  Camera " << i << ": Failed to apply settings: " << e.what() << std::endl;
+    ControlQueue::instance().post("trail.settings",
+        [modules = all_trail_filters_, type, type_index = filter_type_, threshold = threshold_us_] {
+        std::cout << "Trail Filter applying settings to " << modules.size() << " camera(s)..." << std::endl;
+
+        for (size_t i = 0; i < modules.size(); ++i) {
+            try {
+                modules[i]->set_type(type);
+                modules[i]->set_threshold(threshold);
+                std::cout << "  Camera " << i << ": type=" << type_index
+                         << " threshold=" << threshold << "μs" << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "  Camera " << i << ": Failed to apply settings: " << e.what() << std::endl;
+            }
         }
-    }
+    });
 }
 
 void TrailFilterFeature::set_type(Metavision::I_EventTrailFilterModule::Type type) {
@@ -222,9 +225,9 @@ bool TrailFilterFeature::render_ui() {
 
         // Threshold Delay (converted to ms for display)
         ImGui::Text("Threshold Delay:");
-        try {
-            uint32_t min_thresh_us = trail_filter_->get_min_supported_threshold();
-            uint32_t max_thresh_us = trail_filter_->get_max_supported_threshold();
+        if (max_threshold_us_ > 0) {
+            uint32_t min_thresh_us = min_threshold_us_;
+            uint32_t max_thresh_us = max_threshold_us_;
 
             // Convert to ms for display (constrain slider to 1-100ms range)
             int min_thresh_ms = std::max(1, (int)(min_thresh_us / 1000));
@@ -253,7 +256,7 @@ bool TrailFilterFeature::render_ui() {
                               threshold_ms, threshold_us_, min_thresh_ms, max_thresh_ms);
             ImGui::Spacing();
             ImGui::TextWrapped("Lower threshold = more aggressive filtering");
-        } catch (const std::exception& e) {
+        } else {
             ImGui::TextWrapped("Error: Could not get threshold range");
         }
 
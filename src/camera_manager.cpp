@@ -1,8 +1,58 @@
 #include "camera_manager.h"
+#include "core/alloc_tracker.h"
+#include "core/log.h"
+#include "core/metrics.h"
+#include "core/profiler.h"
+#include "core/thread_placement.h"
+#include "pipeline_bus.h"
 #include <metavision/hal/device/device_discovery.h>
+#include <metavision/hal/facilities/i_digital_event_mask.h>
+#include <metavision/hal/facilities/i_erc_module.h>
+#include <metavision/hal/facilities/i_events_stream_decoder.h>
+#include <metavision/hal/facilities/i_hw_identification.h>
+#include <metavision/hal/facilities/i_ll_biases.h>
+#include <metavision/hal/facilities/i_monitoring.h>
+#include <metavision/hal/facilities/i_roi.h>
+#include <metavision/hal/facilities/i_trigger_in.h>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <stdexcept>
 
+namespace {
+
+/**
+ * Hot-path metrics, looked up once so recording never touches the registry lock
+ */
+struct CameraMetrics {
+    core::Counter& events_ingested = core::MetricsRegistry::instance().counter("events.ingested");
+    core::Counter& event_batches = core::MetricsRegistry::instance().counter("events.batches");
+    core::Counter& events_dropped = core::MetricsRegistry::instance().counter("events.dropped");
+    core::Counter& events_noise_filtered = core::MetricsRegistry::instance().counter("events.noise_filtered");
+    core::Counter& events_hot_masked = core::MetricsRegistry::instance().counter("events.hot_masked");
+    core::Counter& frames_generated = core::MetricsRegistry::instance().counter("frames.generated");
+    core::Histogram& accumulate_us = core::MetricsRegistry::instance().histogram("stage.accumulate_us");
+    core::Histogram& noise_filter_us = core::MetricsRegistry::instance().histogram("stage.noise_filter_us");
+    core::Histogram& batch_events = core::MetricsRegistry::instance().histogram("events.batch_size");
+    core::Histogram& lag_us = core::MetricsRegistry::instance().histogram("events.lag_us");
+    core::Counter& events_shed = core::MetricsRegistry::instance().counter("events.shed");
+    core::Counter& windows_shed = core::MetricsRegistry::instance().counter("frames.windows_shed");
+    core::Counter& catch_up_frames = core::MetricsRegistry::instance().counter("frames.catch_up");
+};
+
+
+CameraMetrics& metrics() {
+    static CameraMetrics instance;
+    return instance;
+}
+
+int64_t steady_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
 int CameraManager::initialize(const std::string& serial1, const std::string& serial2) {
     cameras_.clear();
 
@@ -118,53 +168,363 @@ std::unique_ptr<Metavision::Camera> CameraManager::open_first_available() {
     }
 }
 
-bool CameraManager::initialize_single_camera(int accumulation_time_us) {
+bool CameraManager::initialize_single_camera(int accumulation_time_us, bool native_binary,
+                                             int binary_bit_1, int binary_bit_2, const cv::Rect& roi) {
     std::cout << "Initializing single camera..." << std::endl;
+    return initialize_cameras(1, accumulation_time_us, native_binary, binary_bit_1, binary_bit_2, roi) > 0;
+}
 
+int CameraManager::initialize_cameras(int max_cameras, int accumulation_time_us, bool native_binary,
+                                      int binary_bit_1, int binary_bit_2, const cv::Rect& roi,
+                                      const std::vector<std::string>& preferred_serials) {
     try {
-        // List available cameras
-        auto available = list_available_cameras();
+        // Release any open device first, a preferred serial may be one of them
+        stop_accumulation_threads();
+        cameras_.clear();
+        replay_.reset();
+
+        // Known serials open directly; discovery (seconds on some rigs) only fills the gaps
+        const size_t requested = static_cast<size_t>(std::max(max_cameras, 1));
+        std::vector<std::string> available;
+        std::vector<std::unique_ptr<Metavision::Camera>> opened;
+        for (const auto& serial : preferred_serials) {
+            if (available.size() >= requested) {
+                break;
+            }
+            if (serial.empty() || std::find(available.begin(), available.end(), serial) != available.end()) {
+                continue;
+            }
+            if (auto camera = open_camera(serial)) {
+                std::cout << "Opened camera " << serial << " without discovery" << std::endl;
+                available.push_back(serial);
+                opened.push_back(std::move(camera));
+            }
+        }
+
+        if (available.size() < requested) {
+            const auto discovered = list_available_cameras();
+            std::cout << "Found " << discovered.size() << " camera(s)" << std::endl;
+            for (const auto& serial : discovered) {
+                if (available.size() >= requested) {
+                    break;
+                }
+                if (std::find(available.begin(), available.end(), serial) == available.end()) {
+                    available.push_back(serial);
+                    opened.push_back(nullptr);  // Opened below
+                }
+            }
+        }
 
         if (available.empty()) {
             std::cerr << "No cameras detected!" << std::endl;
-            return false;
+            reset_pipelines(1);
+            return 0;
         }
 
-        std::cout << "Found " << available.size() << " camera(s)" << std::endl;
-        std::cout << "Using first camera: " << available[0] << std::endl;
-
-        // Open first camera
-        auto camera = open_camera(available[0]);
-        if (!camera) {
-            std::cerr << "Failed to open camera" << std::endl;
-            return false;
+        const size_t wanted = available.size();
+        if (requested > wanted) {
+            std::cerr << max_cameras << " camera(s) requested, " << wanted << " available" << std::endl;
         }
 
-        // Get camera geometry
-        const auto& geom = camera->geometry();
-        std::cout << "Camera resolution: " << geom.width() << "x" << geom.height() << std::endl;
+        std::vector<std::unique_ptr<Pipeline>> pipelines;
 
-        // Create frame generator
-        frame_generator_ = std::make_unique<Metavision::PeriodicFrameGenerationAlgorithm>(
-            geom.width(), geom.height(), accumulation_time_us);
+        for (size_t i = 0; i < wanted; ++i) {
+            std::cout << "Using camera " << i << ": " << available[i] << std::endl;
 
-        std::cout << "Frame generator created (accumulation: " << accumulation_time_us << " μs)" << std::endl;
+            auto camera = opened[i] ? std::move(opened[i]) : open_camera(available[i]);
+            if (!camera) {
+                std::cerr << "Failed to open camera " << available[i] << std::endl;
+                continue;
+            }
 
-        // Store camera info
-        cameras_.clear();
-        cameras_.emplace_back(available[0], geom.width(), geom.height(), std::move(camera));
+            // Get camera geometry
+            const auto& geom = camera->geometry();
+            std::cout << "Camera resolution: " << geom.width() << "x" << geom.height() << std::endl;
 
-        std::cout << "Camera initialized successfully (not started yet)" << std::endl;
-        return true;
+            // Stream only the ROI when the sensor supports it
+            const cv::Rect window = clip_window(roi, geom.width(), geom.height());
+            const bool cropped = window.size() != cv::Size(geom.width(), geom.height());
+            const bool hardware_roi = cropped && set_hardware_roi(*camera, window);
+
+            // Each camera builds frames on its own pipeline
+            auto pipe = std::make_unique<Pipeline>();
+            pipe->index = static_cast<int>(pipelines.size());
+            create_frame_builder(*pipe, window, cv::Size(geom.width(), geom.height()), accumulation_time_us,
+                                 native_binary, binary_bit_1, binary_bit_2);
+            pipe->hardware_roi = hardware_roi;
+            pipelines.push_back(std::move(pipe));
+
+            // Store camera info
+            cameras_.emplace_back(available[i], geom.width(), geom.height(), std::move(camera));
+        }
+
+        if (cameras_.empty()) {
+            std::cerr << "Failed to open camera" << std::endl;
+            reset_pipelines(1);
+            return 0;
+        }
+        pipelines_ = std::move(pipelines);
+
+        std::cout << num_cameras() << " camera(s) initialized successfully (not started yet)" << std::endl;
+        return num_cameras();
 
     } catch (const std::exception& e) {
         std::cerr << "Camera initialization error: " << e.what() << std::endl;
+        cameras_.clear();
+        reset_pipelines(1);
+        return 0;
+    }
+}
+
+bool CameraManager::set_hardware_roi(Metavision::Camera& camera, const cv::Rect& window) {
+    auto* sensor_roi = camera.get_device().get_facility<Metavision::I_ROI>();
+    const bool hardware_roi = sensor_roi && sensor_roi->set_mode(Metavision::I_ROI::Mode::ROI) &&
+                              sensor_roi->set_window(Metavision::I_ROI::Window(window.x, window.y,
+                                                                               window.width, window.height)) &&
+                              sensor_roi->enable(true);
+    std::cout << "ROI " << window.width << "x" << window.height << " at (" << window.x << ", " << window.y
+              << ")" << (hardware_roi ? " set on the sensor" : ": no hardware ROI, cropping in software")
+              << std::endl;
+    return hardware_roi;
+}
+
+std::vector<std::unique_ptr<CameraManager::Pipeline>> CameraManager::make_pipelines(int count) {
+    std::vector<std::unique_ptr<Pipeline>> pipelines;
+    for (int i = 0; i < std::max(count, 1); ++i) {
+        pipelines.push_back(std::make_unique<Pipeline>());
+        pipelines.back()->index = i;
+    }
+    return pipelines;
+}
+
+void CameraManager::reset_pipelines(int count) {
+    pipelines_ = make_pipelines(count);
+}
+
+cv::Rect CameraManager::clip_window(const cv::Rect& roi, int width, int height) {
+    const cv::Rect sensor(0, 0, width, height);
+    cv::Rect requested = roi;
+    if (requested.width <= 0) requested.width = width - requested.x;    // To the right edge
+    if (requested.height <= 0) requested.height = height - requested.y; // To the bottom edge
+
+    const cv::Rect window = requested & sensor;
+    if (window != requested) {
+        std::cerr << "ROI " << requested.width << "x" << requested.height << " at (" << requested.x << ", "
+                  << requested.y << ") exceeds the " << width << "x" << height << " sensor"
+                  << (window.area() > 0 ? ", clipped" : ", using the full sensor") << std::endl;
+    }
+    return window.area() > 0 ? window : sensor;
+}
+
+void CameraManager::create_frame_builder(Pipeline& pipe, const cv::Rect& window, cv::Size sensor_size,
+                                         int accumulation_time_us, bool native_binary,
+                                         int binary_bit_1, int binary_bit_2) {
+    pipe.frame_generator.reset();
+    pipe.binary_accumulator.reset();
+    const int width = window.width;
+    const int height = window.height;
+    pipe.frame_size = window.size();
+    pipe.frame_origin = window.tl();
+    pipe.crop_to_window = window.size() != sensor_size;
+    pipe.hardware_roi = false;
+    pipe.activity.configure(width, height, accumulation_time_us, window.x, window.y);
+    pipe.event_stats.configure(static_cast<uint32_t>(std::max(accumulation_time_us, 1)));
+    pipe.bus_window_synced = false;   // Window indices restart
+    pipe.pixel_mask.configure(width, height);
+    pipe.noise_filter.configure(width, height);
+    pipe.time_surface.configure(width, height);
+    pipe.pixel_rates.configure(width, height);
+    pipe.intervals.configure(width, height);
+    pipe.dark_frames.configure(width, height);
+    pipe.line_defects.configure(width, height);
+    pipe.toggles.configure(width, height);
+    pipe.latency_map.configure(width, height);
+    pipe.scatter_queue.configure(width, height, static_cast<uint32_t>(std::max(accumulation_time_us, 1)));
+    pipe.scattering_tap.configure(width, height, static_cast<uint32_t>(std::max(accumulation_time_us, 1)));
+    pipe.accumulation_time_us = std::max(accumulation_time_us, 1);
+
+    // Built from these parameters, so nothing earlier is pending for this pipeline
+    {
+        std::lock_guard<std::mutex> lock(frame_config_mutex_);
+        frame_config_ = FrameConfig{pipe.accumulation_time_us, binary_bit_1, binary_bit_2};
+    }
+    pipe.frame_config_epoch = frame_config_epoch_.load();
+
+    if (native_binary) {
+        pipe.binary_accumulator = std::make_unique<video::BinaryFrameAccumulator>(
+            width, height, accumulation_time_us);
+        pipe.binary_accumulator->set_binary_bits(binary_bit_1, binary_bit_2);
+
+        std::cout << "Native binary accumulator created (accumulation: " << accumulation_time_us
+                  << " μs, bits: " << binary_bit_1 << ", " << binary_bit_2 << ")" << std::endl;
+    } else {
+        pipe.frame_generator = std::make_unique<Metavision::PeriodicFrameGenerationAlgorithm>(
+            width, height, accumulation_time_us);
+
+        std::cout << "Frame generator created (accumulation: " << accumulation_time_us << " μs)" << std::endl;
+    }
+}
+
+bool CameraManager::initialize_replay(const std::string& path, int accumulation_time_us, bool native_binary,
+                                      int binary_bit_1, int binary_bit_2, const cv::Rect& roi) {
+    std::cout << "Initializing replay source..." << std::endl;
+
+    auto replay = std::make_unique<video::EventReplay>();
+    if (!replay->open(path)) {
         return false;
     }
+
+    stop_accumulation_threads();
+    reset_pipelines(1);
+    create_frame_builder(pipeline(0), clip_window(roi, replay->width(), replay->height()),
+                         cv::Size(replay->width(), replay->height()), accumulation_time_us,
+                         native_binary, binary_bit_1, binary_bit_2);
+    cameras_.clear();
+    replay_ = std::move(replay);
+
+    std::cout << "Replay initialized successfully (not started yet)" << std::endl;
+    return true;
+}
+
+void CameraManager::on_cd_events(Pipeline& pipe, const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    PROFILE_ZONE("CameraManager::on_cd_events");
+    // The SDK owns the decoding thread, so it is placed from inside its first callback
+    if (!pipe.decode_placed) {
+        pipe.decode_placed = true;
+        core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::Decode, pipe.index);
+    }
+
+    if (begin == end) return;
+
+    if (!replay_) {
+        const int64_t now_us = steady_us();
+        pipe.clock_sync.add_sample((end - 1)->t, now_us);
+        pipe.last_event_us.store(now_us, std::memory_order_relaxed);
+    }
+
+    // Count events for focus adjust monitoring
+    uint64_t event_batch_count = std::distance(begin, end);
+    pipe.event_count.fetch_add(event_batch_count, std::memory_order_relaxed);
+    CameraMetrics& m = metrics();
+    m.events_ingested.add(static_cast<int64_t>(event_batch_count));
+    m.event_batches.add();
+    m.batch_events.record(static_cast<int64_t>(event_batch_count));
+
+    // Replay can wait, so it never loses events to a full ring
+    if (replay_) {
+        while (!pipe.event_ring.has_space() && pipe.accumulation_running.load()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    // Both drop (and count) the batch if their ring is full; only camera 0 is recorded
+    if (pipe.index == 0) {
+        recorder_.push(begin, end);
+    }
+    if (!pipe.event_ring.try_push(begin, end)) {
+        m.events_dropped.add(static_cast<int64_t>(event_batch_count));
+        static core::LogSite site(1000);
+        core::LogLine(core::LogLevel::Debug, &site)
+            << "Camera " << pipe.index << ": event ring full, dropped " << event_batch_count << " events";
+    }
 }
 
-bool CameraManager::start_single_camera(FrameCallback callback) {
-    if (cameras_.empty() || !frame_generator_) {
+void CameraManager::on_raw_data(Pipeline& pipe, Metavision::Camera& camera, const uint8_t* data, size_t size) {
+    PROFILE_ZONE("CameraManager::on_raw_data");
+    if (!pipe.decode_placed) {
+        pipe.decode_placed = true;
+        core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::Decode, pipe.index);
+    }
+
+    if (size == 0) return;
+
+    // What the accumulation thread does per batch, since it never sees these events
+    if (pipe.restart_pending.load(std::memory_order_relaxed) &&
+        pipe.restart_pending.exchange(false, std::memory_order_acquire)) {
+        restart_frame_builder(pipe);
+        pipe.raw_decoder.reset();
+        pipe.window_pyramid.reset();
+    }
+    const uint32_t epoch = frame_config_epoch_.load(std::memory_order_acquire);
+    if (epoch != pipe.frame_config_epoch) {
+        pipe.frame_config_epoch = epoch;
+        apply_frame_config(pipe);
+    }
+
+    // Same time origin as the SDK decoder (it has already seen this buffer), so triggers line up
+    if (!pipe.raw_decoder.has_time_shift()) {
+        if (auto* decoder = camera.get_device().get_facility<Metavision::I_EventsStreamDecoder>()) {
+            Metavision::timestamp shift = 0;
+            if (!decoder->is_time_shifting_enabled()) {
+                pipe.raw_decoder.set_time_shift(0);
+            } else if (decoder->get_timestamp_shift(shift)) {
+                pipe.raw_decoder.set_time_shift(shift);
+            }
+        }
+    }
+
+    // Includes the frame callback whenever this buffer closes a frame
+    CameraMetrics& m = metrics();
+    const int64_t now_us = steady_us();
+    const uint64_t decoded = pipe.raw_decoder.decode(data, size, *pipe.binary_accumulator);
+    m.accumulate_us.record(steady_us() - now_us);
+
+    const Metavision::timestamp last_ts = pipe.raw_decoder.last_timestamp();
+    if (last_ts >= 0) {
+        pipe.clock_sync.add_sample(last_ts, now_us);
+        pipe.last_event_us.store(now_us, std::memory_order_relaxed);
+    }
+
+    pipe.event_count.fetch_add(decoded, std::memory_order_relaxed);
+    m.events_ingested.add(static_cast<int64_t>(decoded));
+    m.event_batches.add();
+    m.batch_events.record(static_cast<int64_t>(decoded));
+}
+
+void CameraManager::attach_event_input(Metavision::Camera& camera, Pipeline& pipe) {
+    pipe.raw_decode = false;
+    if (raw_decode_requested_) {
+        std::string encoding = "unknown";
+        if (auto* identification = camera.get_device().get_facility<Metavision::I_HW_Identification>()) {
+            encoding = identification->get_current_data_encoding_format();
+        }
+        const video::RawEventDecoder::Format format = video::RawEventDecoder::parse_format(encoding);
+        if (pipe.scatter_queue.is_enabled()) {
+            core::LogLine(core::LogLevel::Warning) << "Camera " << pipe.index
+                                                   << ": GPU event scatter needs the event path, using SDK decoding";
+        } else if (!pipe.binary_accumulator || pipe.crop_to_window || pipe.frame_origin != cv::Point(0, 0)) {
+            core::LogLine(core::LogLevel::Warning) << "Camera " << pipe.index
+                                                   << ": raw decode needs uncropped native frames, using SDK decoding";
+        } else if (format == video::RawEventDecoder::Format::Unsupported) {
+            core::LogLine(core::LogLevel::Warning) << "Camera " << pipe.index << ": streams " << encoding
+                                                   << ", raw decode needs EVT 2.1 or EVT 3.0, using SDK decoding";
+        } else {
+            pipe.raw_decode = true;
+            pipe.raw_decoder.configure(format, pipe.frame_size.width, pipe.frame_size.height);
+            pipe.binary_accumulator->set_packed_output(true);   // Vectors land as word updates
+        }
+    }
+
+    if (pipe.raw_decode) {
+        Metavision::Camera* source = &camera;
+        camera.raw_data().add_callback([this, &pipe, source](const uint8_t* data, size_t size) {
+            on_raw_data(pipe, *source, data, size);
+        });
+        core::LogLine(core::LogLevel::Info)
+            << "Camera " << pipe.index << ": decoding "
+            << video::RawEventDecoder::format_name(pipe.raw_decoder.get_format())
+            << " straight into the accumulator (no recording, noise filter or event analysis)";
+        return;
+    }
+    camera.cd().add_callback([this, &pipe](const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+        on_cd_events(pipe, begin, end);
+    });
+}
+
+bool CameraManager::start_single_camera(FrameCallback callback, double replay_speed,
+                                        const ConfigureCallback& configure) {
+    const Pipeline& first = pipeline(0);
+    if ((cameras_.empty() && !replay_) || (!first.frame_generator && !first.binary_accumulator)) {
         std::cerr << "Camera not initialized. Call initialize_single_camera() first." << std::endl;
         return false;
     }
@@ -175,53 +535,1091 @@ bool CameraManager::start_single_camera(FrameCallback callback) {
         // Store callback
         frame_callback_ = callback;
 
-        // Set up frame generator output callback
-        frame_generator_->set_output_callback(
-            [this](const Metavision::timestamp ts, cv::Mat& frame) {
+        // Frame building runs on one thread per camera so the decoding threads never wait on it
+        stop_accumulation_threads();
+        for (auto& pipe_ptr : pipelines_) {
+            Pipeline& pipe = *pipe_ptr;
+
+            // Set up frame generator output callback
+            auto on_frame = [this, &pipe](const Metavision::timestamp ts, cv::Mat& frame) {
                 if (frame.empty()) return;
+                PROFILE_ZONE("CameraManager::on_frame");
+                pipe.last_frame_timestamp.store(ts, std::memory_order_relaxed);
+                if (pipe.binary_accumulator) {
+                    pipe.last_frame_window_us.store(pipe.binary_accumulator->frame_window_us(), std::memory_order_relaxed);
+                    pipe.last_frame_events.store(static_cast<int64_t>(pipe.binary_accumulator->frame_events()),
+                                                 std::memory_order_relaxed);
+                    pipe.last_frame_on_events.store(static_cast<int64_t>(pipe.binary_accumulator->frame_on_events()),
+                                                    std::memory_order_relaxed);
+                } else {
+                    pipe.last_frame_window_us.store(static_cast<uint32_t>(pipe.accumulation_time_us), std::memory_order_relaxed);
+                }
+                metrics().frames_generated.add();
+                if (publisher_.is_open() && pipe.binary_accumulator) {
+                    const video::BinaryFrameAccumulator& accumulator = *pipe.binary_accumulator;
+                    publisher_.publish_frame(pipe.index, ts, accumulator.frame_window_us(),
+                                             static_cast<int64_t>(accumulator.frame_events()), frame,
+                                             accumulator.has_packed_output() ? &accumulator.packed_frame() : nullptr);
+                }
                 if (frame_callback_) {
-                    frame_callback_(frame, 0);  // Camera index 0
+                    frame_callback_(frame, pipe.index);
+                }
+                if (pipe.line_defects.is_enabled() && pipe.binary_accumulator) {
+                    if (pipe.binary_accumulator->has_packed_output()) {
+                        pipe.line_defects.process(ts, pipe.binary_accumulator->packed_frame());
+                    } else {
+                        pipe.line_defects.process(ts, frame);
+                    }
+                }
+                if (pipe.toggles.is_enabled() && pipe.binary_accumulator) {
+                    if (pipe.binary_accumulator->has_packed_output()) {
+                        pipe.toggles.process(ts, pipe.binary_accumulator->packed_frame());
+                    } else {
+                        pipe.toggles.process(ts, frame);
+                    }
+                }
+                if (pipe.window_pyramid.levels() > 0) {
+                    pipe.window_pyramid.push(ts, pipe.binary_accumulator->packed_frame());
+                } else if (pipe.accumulation_control.is_enabled()) {
+                    adapt_accumulation_time(pipe, frame);
                 }
-            });
+            };
+            pipe.on_frame = on_frame;
+            if (pipe.binary_accumulator) {
+                pipe.binary_accumulator->set_output_callback(on_frame);
+            } else {
+                pipe.frame_generator->set_output_callback(on_frame);
+            }
 
-        // Set up event callback to feed events to frame generator
-        auto& camera = cameras_[0].camera;
-        camera->cd().add_callback(
-            [this](const Metavision::EventCD* begin, const Metavision::EventCD* end) {
-                if (begin == end) return;
+            pipe.window_pyramid.set_output_callback(
+                [this, &pipe](int level, Metavision::timestamp ts, const video::BinaryFrame& frame) {
+                    if (window_consumers_[level]) {
+                        window_consumers_[level](frame, ts, pipe.index);
+                    }
+                });
 
-                // Count events for focus adjust monitoring
-                uint64_t event_batch_count = std::distance(begin, end);
-                event_count_.fetch_add(event_batch_count, std::memory_order_relaxed);
+            // Sensor time restarts with the camera
+            pipe.clock_sync.reset();
+            pipe.window_pyramid.reset();
+            pipe.shed = Pipeline::Shed::None;
+            pipe.lag_us = 0;
 
-                if (frame_generator_) {
-                    frame_generator_->process_events(begin, end);
-                }
-            });
+            pipe.decode_placed = false;
+            pipe.event_ring.clear();
+            pipe.accumulation_running = true;
+            pipe.accumulation_thread = std::thread(&CameraManager::accumulation_loop, this, &pipe);
+        }
+
+        if (replay_) {
+            // Replay thread takes the place of the SDK decoding thread
+            Pipeline& pipe = pipeline(0);
+            auto on_events = [this, &pipe](const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+                on_cd_events(pipe, begin, end);
+            };
+            if (!replay_->start(on_events, replay_speed)) {
+                stop_accumulation_threads();
+                return false;
+            }
+            pipe.camera_started = true;
+            std::cout << "Replay started (speed: ";
+            if (replay_speed > 0.0) {
+                std::cout << replay_speed << "x)" << std::endl;
+            } else {
+                std::cout << "as fast as possible)" << std::endl;
+            }
+            return true;
+        }
+
+        // Set up event callbacks: each decoding thread hands events to its camera's accumulation thread
+        // (cameras opened by initialize() without a pipeline of their own are not started)
+        const size_t started = std::min(cameras_.size(), pipelines_.size());
+        for (size_t i = 0; i < started; ++i) {
+            Pipeline& pipe = pipeline(static_cast<int>(i));
+            attach_event_input(*cameras_[i].camera, pipe);
+            attach_trigger_in(*cameras_[i].camera, pipe);
+        }
 
         std::cout << "Camera callbacks configured (camera not started yet)" << std::endl;
 
-        // Now start the camera
-        std::cout << "Starting camera..." << std::endl;
-        camera->start();
-        camera_started_ = true;
+        // Now start the cameras, each already configured
+        for (size_t i = 0; i < started; ++i) {
+            if (configure) {
+                configure(static_cast<int>(i));
+            }
+            std::cout << "Starting camera " << cameras_[i].serial << "..." << std::endl;
+            pipeline(static_cast<int>(i)).last_event_us = steady_us();  // Stall grace starts now
+            cameras_[i].camera->start();
+            pipeline(static_cast<int>(i)).camera_started = true;
+        }
         std::cout << "Camera started successfully" << std::endl;
 
         return true;
 
     } catch (const std::exception& e) {
         std::cerr << "Error starting camera: " << e.what() << std::endl;
+        stop_accumulation_threads();
+        return false;
+    }
+}
+
+int CameraManager::write_biases(Metavision::I_LL_Biases* biases, const std::map<std::string, int>& values) {
+    if (!biases) {
+        return -1;
+    }
+
+    // One read of the whole bank instead of a get (or a blind set) per bias
+    const std::map<std::string, int> current = biases->get_all_biases();
+
+    int written = 0;
+    bool ok = true;
+    for (const auto& [name, value] : values) {
+        auto it = current.find(name);
+        if (it != current.end() && it->second == value) {
+            continue;
+        }
+        if (biases->set(name, value)) {
+            ++written;
+        } else {
+            ok = false;
+        }
+    }
+    return ok ? written : -1;
+}
+
+int CameraManager::write_pixel_masks(Metavision::I_DigitalEventMask* masks, const video::BinaryFrame& mask,
+                                     cv::Point origin, video::BinaryFrame& remaining) {
+    remaining = mask;
+    if (!masks) {
+        return -1;
+    }
+
+    const auto& slots = masks->get_pixel_masks();
+    size_t slot = 0;
+    bool ok = true;
+    for (int y = 0; y < mask.height() && slot < slots.size(); ++y) {
+        const uint64_t* row = mask.row(y);
+        for (int w = 0; w < mask.words_per_row() && slot < slots.size(); ++w) {
+            for (uint64_t bits = row[w]; bits && slot < slots.size(); bits &= bits - 1) {
+                const int x = w * 64 + video::BinaryFrame::lowest_set_bit(bits);
+                if (x >= mask.width()) {
+                    break;
+                }
+                if (slots[slot]->set_mask(static_cast<uint32_t>(x + origin.x), static_cast<uint32_t>(y + origin.y),
+                                          true)) {
+                    remaining.set(x, y, false);
+                    ++slot;
+                } else {
+                    ok = false;
+                }
+            }
+        }
+    }
+    const int programmed = static_cast<int>(slot);
+
+    // Release the slots a previous, larger mask used
+    for (; slot < slots.size(); ++slot) {
+        const auto current = slots[slot]->get_mask();
+        if (std::get<2>(current)) {
+            ok = slots[slot]->set_mask(std::get<0>(current), std::get<1>(current), false) && ok;
+        }
+    }
+    return ok ? programmed : -1;
+}
+
+bool CameraManager::start_recording(const std::string& path, uint64_t preallocate_bytes, int compress_threads) {
+    if (!is_camera_connected(0)) {
+        std::cerr << "Cannot record: camera not started" << std::endl;
+        return false;
+    }
+    return recorder_.start(path, cameras_[0].width, cameras_[0].height, preallocate_bytes, compress_threads);
+}
+
+bool CameraManager::start_publishing(video::SharedMemoryPublisher::Options options) {
+    if (!is_native_binary()) {
+        std::cerr << "Shared-memory publishing needs native accumulation" << std::endl;
+        return false;
+    }
+    options.width = 0;
+    options.height = 0;
+    for (const auto& pipe : pipelines_) {
+        options.width = std::max(options.width, pipe->frame_size.width);
+        options.height = std::max(options.height, pipe->frame_size.height);
+    }
+    return publisher_.start(options);
+}
+
+void CameraManager::prefault_event_rings() {
+    for (auto& pipe : pipelines_) {
+        pipe->event_ring.prefault();
+    }
+}
+
+bool CameraManager::start_merging(const video::StreamMerger::Options& options,
+                                  video::StreamMerger::WindowCallback on_window) {
+    if (pipelines_.size() < 2) {
+        std::cerr << "Stream merge needs two or more cameras" << std::endl;
+        return false;
+    }
+    if (raw_decode_requested_) {
+        std::cerr << "Stream merge needs the accumulation threads (raw decode is on)" << std::endl;
+        return false;
+    }
+    std::vector<cv::Size> sizes;
+    for (const auto& pipe : pipelines_) {
+        sizes.push_back(pipe->frame_size);
+    }
+    return merger_.start(sizes, options, std::move(on_window));
+}
+
+void CameraManager::set_trigger_capture(bool enabled, int64_t window_us) {
+    for (auto& pipe : pipelines_) {
+        pipe->trigger_gate.set_enabled(enabled, window_us);
+    }
+    if (enabled) {
+        std::cout << "Trigger capture enabled (window: "
+                  << (window_us > 0 ? std::to_string(window_us) + " us" : std::string("until falling edge")) << ")"
+                  << std::endl;
+    }
+}
+
+void CameraManager::set_trigger_latency(bool enabled, int64_t window_us) {
+    for (auto& pipe : pipelines_) {
+        pipe->latency_map.set_enabled(enabled, window_us);
+    }
+    if (enabled) {
+        std::cout << "Trigger latency map enabled (response window: " << window_us << " us)" << std::endl;
+    }
+}
+
+void CameraManager::attach_trigger_in(Metavision::Camera& camera, Pipeline& pipe) {
+    if (!pipe.trigger_gate.is_enabled() && !pipe.latency_map.is_enabled()) {
+        return;
+    }
+    auto* trigger_in = camera.get_device().get_facility<Metavision::I_TriggerIn>();
+    if (!trigger_in || !trigger_in->enable(Metavision::I_TriggerIn::Channel::Main)) {
+        core::LogLine(core::LogLevel::Warning) << "Camera " << pipe.index
+                                               << ": no trigger input, trigger capture and latency map off";
+        return;
+    }
+    // Same decoding thread as the CD events, so windows and onsets are known before the events they cover
+    camera.ext_trigger().add_callback(
+        [&pipe](const Metavision::EventExtTrigger* begin, const Metavision::EventExtTrigger* end) {
+            pipe.trigger_gate.on_triggers(begin, end);
+            pipe.latency_map.on_triggers(begin, end);
+        });
+}
+
+bool CameraManager::set_polarity_planes(bool enabled) {
+    if (!is_native_binary()) {
+        if (enabled) {
+            std::cerr << "Polarity planes need native accumulation, frames stay 0/255" << std::endl;
+        }
+        return false;
+    }
+    for (auto& pipe : pipelines_) {
+        pipe->binary_accumulator->set_polarity_planes(enabled);
+    }
+    if (enabled) {
+        std::cout << "Polarity planes enabled (set pixels carry ON/OFF bits)" << std::endl;
+    }
+    return true;
+}
+
+bool CameraManager::set_preview_binning(int binning) {
+    if (!is_native_binary()) {
+        if (binning > 1) {
+            std::cerr << "Preview binning needs native accumulation, no previews" << std::endl;
+        }
+        return false;
+    }
+    for (auto& pipe : pipelines_) {
+        pipe->binary_accumulator->set_preview_binning(binning);
+    }
+    const int effective = get_preview_binning();
+    if (effective != 0) {
+        std::cout << "Preview binning enabled (" << effective << "x" << effective << ")" << std::endl;
+    }
+    return true;
+}
+
+bool CameraManager::set_accumulation_threads(int threads) {
+    if (!is_native_binary()) {
+        if (threads > 1) {
+            std::cerr << "Parallel accumulation needs native accumulation, using one thread" << std::endl;
+        }
+        return false;
+    }
+    for (auto& pipe : pipelines_) {
+        pipe->binary_accumulator->set_parallel_threads(threads);
+    }
+    const int effective = pipeline(0).binary_accumulator->get_parallel_threads();
+    if (effective > 1) {
+        std::cout << "Parallel accumulation enabled (" << effective << " threads per camera)" << std::endl;
+    }
+    return true;
+}
+
+void CameraManager::set_frame_parameters(int accumulation_time_us, int binary_bit_1, int binary_bit_2) {
+    {
+        std::lock_guard<std::mutex> lock(frame_config_mutex_);
+        FrameConfig config{std::max(accumulation_time_us, 1), std::clamp(binary_bit_1, 0, 7), std::clamp(binary_bit_2, 0, 7)};
+        if (config.accumulation_time_us != frame_config_.accumulation_time_us && get_window_levels() > 0) {
+            // Coarse windows are multiples of the old window; a new one would straddle them
+            std::cerr << "Accumulation time stays " << frame_config_.accumulation_time_us
+                      << " μs while accumulation windows are built" << std::endl;
+            config.accumulation_time_us = frame_config_.accumulation_time_us;
+        }
+        frame_config_ = config;
+    }
+    frame_config_epoch_.fetch_add(1, std::memory_order_release);
+}
+
+void CameraManager::apply_frame_config(Pipeline& pipe) {
+    FrameConfig config;
+    {
+        std::lock_guard<std::mutex> lock(frame_config_mutex_);
+        config = frame_config_;
+    }
+
+    if (pipe.binary_accumulator) {
+        pipe.binary_accumulator->reconfigure(static_cast<uint32_t>(config.accumulation_time_us),
+                                             config.binary_bit_1, config.binary_bit_2);
+    } else if (config.accumulation_time_us != pipe.accumulation_time_us) {
+        pipe.accumulation_time_us = config.accumulation_time_us;
+        restart_frame_builder(pipe);  // The SDK generator's period is fixed at construction
+    }
+    pipe.accumulation_time_us = config.accumulation_time_us;
+    pipe.event_stats.configure(static_cast<uint32_t>(pipe.accumulation_time_us));
+    pipe.bus_window_synced = false;
+    pipe.scatter_queue.configure(pipe.frame_size.width, pipe.frame_size.height,
+                                 static_cast<uint32_t>(pipe.accumulation_time_us));
+    pipe.scattering_tap.configure(pipe.frame_size.width, pipe.frame_size.height,
+                                  static_cast<uint32_t>(pipe.accumulation_time_us));
+    core::LogLine(core::LogLevel::Info) << "Camera " << pipe.index << ": frames now " << config.accumulation_time_us
+                                        << " μs, bits " << config.binary_bit_1 << ", " << config.binary_bit_2;
+}
+
+void CameraManager::adapt_accumulation_time(Pipeline& pipe, const cv::Mat& frame) {
+    video::BinaryFrameAccumulator* accumulator = pipe.binary_accumulator.get();
+    if (!accumulator || accumulator->get_slice_mode() != video::BinaryFrameAccumulator::SliceMode::Time) {
+        return;
+    }
+
+    double occupancy = 0.0;
+    if (pipe.accumulation_control.get_target() == video::AccumulationController::Target::Occupancy) {
+        const double area = static_cast<double>(frame.total());
+        const double active = static_cast<double>(accumulator->frame_stats().active_pixels);
+        const double set = accumulator->row_bands().background ? area - active : active;
+        occupancy = area > 0.0 ? set / area : 0.0;
+    }
+
+    const uint32_t next_us = pipe.accumulation_control.update(accumulator->frame_window_us(),
+                                                              accumulator->frame_events(), occupancy);
+    if (next_us != accumulator->get_accumulation_time_us()) {
+        accumulator->set_accumulation_time(next_us);  // Applies to the frame that starts now
+        static core::Gauge& window_gauge = core::MetricsRegistry::instance().gauge("frames.window_us");
+        if (pipe.index == 0) {
+            window_gauge.set(static_cast<double>(next_us));
+        }
+    }
+}
+
+bool CameraManager::set_frame_slicing(video::BinaryFrameAccumulator::SliceMode mode, int slice_events) {
+    using SliceMode = video::BinaryFrameAccumulator::SliceMode;
+    if (!is_native_binary()) {
+        if (mode != SliceMode::Time) {
+            std::cerr << "Event-count slicing needs native accumulation, frames stay time-sliced" << std::endl;
+        }
+        return false;
+    }
+    for (auto& pipe : pipelines_) {
+        pipe->binary_accumulator->set_slicing(mode, static_cast<uint32_t>(std::max(slice_events, 1)));
+    }
+    const auto& accumulator = *pipeline(0).binary_accumulator;
+    if (mode == SliceMode::Events) {
+        std::cout << "Frames sliced every " << accumulator.get_slice_events() << " events" << std::endl;
+    } else if (mode == SliceMode::EventsOrTime) {
+        std::cout << "Frames sliced every " << accumulator.get_slice_events() << " events or "
+                  << accumulator.get_accumulation_time_us() << " μs, whichever comes first" << std::endl;
+    }
+    return true;
+}
+
+int CameraManager::set_accumulation_windows(const std::vector<int>& windows_us) {
+    if (!is_native_binary() ||
+        pipeline(0).binary_accumulator->get_slice_mode() != video::BinaryFrameAccumulator::SliceMode::Time) {
+        if (!windows_us.empty()) {
+            std::cerr << "Accumulation windows need time-sliced native accumulation, only regular frames are built"
+                      << std::endl;
+        }
+        return 0;
+    }
+
+    int levels = 0;
+    for (auto& pipe : pipelines_) {
+        levels = pipe->window_pyramid.configure(pipe->accumulation_time_us, windows_us);
+        pipe->binary_accumulator->set_packed_output(levels > 0);
+    }
+    if (levels > 0) {
+        std::cout << "Accumulation windows:";
+        for (int i = 0; i < levels; ++i) {
+            std::cout << " " << get_window_us(i) << " μs";
+        }
+        std::cout << " (OR-reduced from " << pipeline(0).accumulation_time_us << " μs frames)" << std::endl;
+    }
+    return levels;
+}
+
+void CameraManager::set_window_consumer(int level, WindowCallback consumer) {
+    if (level >= 0 && level < video::WindowPyramid::MAX_LEVELS) {
+        window_consumers_[level] = std::move(consumer);
+    }
+}
+
+void CameraManager::accumulation_loop(Pipeline* pipe) {
+    core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::Accumulation, pipe->index);
+
+    CameraMetrics& m = metrics();
+    core::Histogram& accumulate_us = m.accumulate_us;
+    video::EventRing& event_ring = pipe->event_ring;
+    while (pipe->accumulation_running.load()) {
+        if (!event_ring.wait_for_data(10000)) {
+            continue;
+        }
+
+        // Drain everything queued so far before sleeping again
+        while (const auto* batch = event_ring.front()) {
+            PROFILE_ZONE("CameraManager::accumulate_batch");
+            ALLOC_SCOPE("accumulate");
+            // Sensor time restarted with a reopened camera (see reopen_camera)
+            if (pipe->restart_pending.load(std::memory_order_relaxed) &&
+                pipe->restart_pending.exchange(false, std::memory_order_acquire)) {
+                restart_frame_builder(*pipe);
+                pipe->window_pyramid.reset();
+                pipe->event_stats.configure(static_cast<uint32_t>(pipe->accumulation_time_us));
+                pipe->bus_window_synced = false;
+                pipe->scatter_queue.configure(pipe->frame_size.width, pipe->frame_size.height,
+                                              static_cast<uint32_t>(pipe->accumulation_time_us));
+                pipe->scattering_tap.configure(pipe->frame_size.width, pipe->frame_size.height,
+                                               static_cast<uint32_t>(pipe->accumulation_time_us));
+                pipe->shed = Pipeline::Shed::None;
+                pipe->catch_up_batches = 0;
+                pipe->lag_us = 0;
+            }
+
+            const uint32_t epoch = frame_config_epoch_.load(std::memory_order_acquire);
+            if (epoch != pipe->frame_config_epoch) {
+                pipe->frame_config_epoch = epoch;
+                apply_frame_config(*pipe);
+            }
+
+            const Metavision::EventCD* end = batch->data() + batch->size();
+            const Metavision::EventCD* begin = shed_backlog(*pipe, batch->data(), end);
+            if (begin == end) {
+                event_ring.pop();
+                if (pipe->shed == Pipeline::Shed::CatchingUp && --pipe->catch_up_batches == 0) {
+                    end_catch_up(*pipe);
+                }
+                continue;
+            }
+            if (pipe->crop_to_window) {
+                crop_to_window(*pipe, begin, end);
+                begin = pipe->window_events.data();
+                end = begin + pipe->window_events.size();
+            }
+
+            // Drop known hot pixels first, so the noise filter never sees them as support;
+            // in place when the batch is already a private copy, else into filtered_events
+            if (pipe->pixel_mask.is_active() && begin != end) {
+                const size_t count = static_cast<size_t>(end - begin);
+                Metavision::EventCD* out = pipe->window_events.data();
+                if (begin != out) {
+                    if (pipe->filtered_events.size() < count) {
+                        pipe->filtered_events.resize(count);
+                    }
+                    out = pipe->filtered_events.data();
+                }
+                const size_t kept = pipe->pixel_mask.filter(begin, end, out);
+                m.events_hot_masked.add(static_cast<int64_t>(count - kept));
+                begin = out;
+                end = out + kept;
+            }
+
+            // Filter in place when the batch is already a private copy, else into filtered_events
+            if (pipe->noise_filter.is_enabled() && begin != end) {
+                const size_t count = static_cast<size_t>(end - begin);
+                Metavision::EventCD* out = pipe->window_events.data();
+                if (begin != out) {
+                    if (pipe->filtered_events.size() < count) {
+                        pipe->filtered_events.resize(count);
+                    }
+                    out = pipe->filtered_events.data();
+                }
+                const int64_t filter_start_us = steady_us();
+                const size_t kept = pipe->noise_filter.filter(begin, end, out);
+                m.noise_filter_us.record(steady_us() - filter_start_us);
+                m.events_noise_filtered.add(static_cast<int64_t>(count - kept));
+                begin = out;
+                end = out + kept;
+            }
+
+            // Before the frame builder, so a frame's window is summarized by the time its callback runs
+            pipe->event_stats.process_events(begin, end);
+            publish_window_stats(*pipe);
+
+            // Includes the frame callback whenever this batch closes a frame
+            const int64_t start_us = steady_us();
+            if (pipe->binary_accumulator) {
+                if (pipe->shed == Pipeline::Shed::CatchingUp) {
+                    pipe->binary_accumulator->process_catch_up(begin, end);
+                } else {
+                    pipe->binary_accumulator->process_events(begin, end);
+                }
+            } else if (pipe->frame_generator) {
+                pipe->frame_generator->process_events(begin, end);
+            }
+            accumulate_us.record(steady_us() - start_us);
+
+            // Second pass over a batch that is still in cache
+            pipe->activity.process(begin, end);
+            pipe->time_surface.update(begin, end);
+            pipe->pixel_rates.update(begin, end);
+            pipe->intervals.update(begin, end);
+            pipe->dark_frames.update(begin, end);
+            pipe->latency_map.update(begin, end);
+            pipe->flicker.update(begin, end);
+            if (pipe->scatter_queue.is_enabled()) {
+                pipe->scatter_queue.push(begin, end);
+            }
+            if (pipe->scattering_tap.is_enabled()) {
+                pipe->scattering_tap.push(begin, end);
+            }
+            publisher_.publish_events(pipe->index, begin, end);
+            analyzers_.submit_events(pipe->index, begin, end);
+            if (merger_.is_running()) {
+                merger_.submit(pipe->index, begin, end, pipe->clock_sync);
+            }
+            PipelineBus::instance().publish_events(pipe->index, begin, end);
+            event_ring.pop();
+            if (pipe->shed == Pipeline::Shed::CatchingUp && --pipe->catch_up_batches == 0) {
+                end_catch_up(*pipe);
+            }
+        }
+    }
+}
+
+void CameraManager::set_latency_budget(int budget_ms, LatencyShedMode mode) {
+    latency_budget_us_ = static_cast<int64_t>(std::max(budget_ms, 0)) * 1000;
+    latency_shed_mode_ = static_cast<int>(mode);
+    if (budget_ms > 0) {
+        std::cout << "Latency budget: " << budget_ms << " ms ("
+                  << (mode == LatencyShedMode::CatchUpFrame ? "catch-up frame" : "drop windows") << ")" << std::endl;
+    }
+}
+
+const Metavision::EventCD* CameraManager::shed_backlog(Pipeline& pipe, const Metavision::EventCD* begin,
+                                                       const Metavision::EventCD* end) {
+    if (begin == end) {
+        return begin;
+    }
+    if (pipe.shed == Pipeline::Shed::CatchingUp) {
+        pipe.shed_last_ts = (end - 1)->t;
+        return begin;
+    }
+
+    CameraMetrics& m = metrics();
+    const int64_t budget_us = latency_budget_us_.load(std::memory_order_relaxed);
+    int64_t lag_us = 0;
+    if (budget_us > 0 && pipe.clock_sync.is_valid()) {
+        lag_us = steady_us() - pipe.clock_sync.to_host_us((end - 1)->t);
+        pipe.lag_us.store(lag_us, std::memory_order_relaxed);
+        m.lag_us.record(std::max<int64_t>(lag_us, 0));
+    }
+
+    if (pipe.shed == Pipeline::Shed::Dropping) {
+        // Hysteresis: keep dropping until well inside the budget (or the budget is lifted)
+        if (budget_us > 0 && lag_us > budget_us / 2) {
+            m.events_shed.add(static_cast<int64_t>(end - begin));
+            pipe.shed_last_ts = (end - 1)->t;
+            return end;
+        }
+
+        // Resume at the next window boundary, so the next frame is a whole window
+        const int64_t window = pipe.accumulation_time_us;
+        const Metavision::timestamp boundary = (pipe.shed_last_ts / window + 1) * window;
+        const Metavision::EventCD* resume = std::lower_bound(begin, end, boundary,
+            [](const Metavision::EventCD& ev, Metavision::timestamp t) { return ev.t < t; });
+        m.events_shed.add(static_cast<int64_t>(resume - begin));
+        const int64_t windows = boundary / window - pipe.shed_first_ts / window;
+        pipe.shed_windows.fetch_add(windows, std::memory_order_relaxed);
+        m.windows_shed.add(windows);
+        restart_frame_builder(pipe);
+        pipe.shed = Pipeline::Shed::None;
+
+        static core::LogSite site(1000);
+        core::LogLine(core::LogLevel::Info, &site)
+            << "Camera " << pipe.index << ": caught up, " << windows << " accumulation windows dropped";
+        return resume;
+    }
+
+    if (budget_us <= 0 || lag_us <= budget_us) {
+        return begin;
+    }
+
+    pipe.shed_first_ts = begin->t;
+    pipe.shed_last_ts = (end - 1)->t;
+    static core::LogSite site(1000);
+    if (static_cast<LatencyShedMode>(latency_shed_mode_.load()) == LatencyShedMode::CatchUpFrame &&
+        pipe.binary_accumulator) {
+        pipe.shed = Pipeline::Shed::CatchingUp;
+        pipe.catch_up_batches = pipe.event_ring.size();  // Queued so far, this batch included
+        core::LogLine(core::LogLevel::Warning, &site)
+            << "Camera " << pipe.index << ": " << lag_us / 1000 << " ms behind (budget " << budget_us / 1000
+            << " ms), collapsing " << pipe.catch_up_batches << " batches into one frame";
+        return begin;
+    }
+
+    pipe.shed = Pipeline::Shed::Dropping;
+    m.events_shed.add(static_cast<int64_t>(end - begin));
+    core::LogLine(core::LogLevel::Warning, &site)
+        << "Camera " << pipe.index << ": " << lag_us / 1000 << " ms behind (budget " << budget_us / 1000
+        << " ms), dropping windows";
+    return end;
+}
+
+void CameraManager::end_catch_up(Pipeline& pipe) {
+    // Every window the frame spans beyond the one it is stamped with was collapsed away
+    const int64_t window = pipe.accumulation_time_us;
+    const int64_t collapsed = pipe.shed_last_ts / window - pipe.shed_first_ts / window;
+    pipe.binary_accumulator->end_catch_up(pipe.shed_last_ts);
+    pipe.shed_windows.fetch_add(collapsed, std::memory_order_relaxed);
+    CameraMetrics& m = metrics();
+    m.windows_shed.add(collapsed);
+    m.catch_up_frames.add();
+    pipe.shed = Pipeline::Shed::None;
+}
+
+void CameraManager::restart_frame_builder(Pipeline& pipe) {
+    if (pipe.binary_accumulator) {
+        pipe.binary_accumulator->reset();
+    } else if (pipe.frame_generator) {
+        // The SDK generator would emit a frame for every period of the gap; start a fresh one
+        pipe.frame_generator = std::make_unique<Metavision::PeriodicFrameGenerationAlgorithm>(
+            pipe.frame_size.width, pipe.frame_size.height, pipe.accumulation_time_us);
+        pipe.frame_generator->set_output_callback(pipe.on_frame);
+    }
+}
+
+void CameraManager::crop_to_window(Pipeline& pipe, const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    std::vector<Metavision::EventCD>& window_events = pipe.window_events;
+    window_events.clear();  // Keeps its capacity
+    window_events.reserve(static_cast<size_t>(end - begin));
+
+    // Unsigned differences wrap for events left of / above the window, so one compare per axis
+    const unsigned origin_x = static_cast<unsigned>(pipe.frame_origin.x);
+    const unsigned origin_y = static_cast<unsigned>(pipe.frame_origin.y);
+    const unsigned width = static_cast<unsigned>(pipe.frame_size.width);
+    const unsigned height = static_cast<unsigned>(pipe.frame_size.height);
+    for (const Metavision::EventCD* ev = begin; ev != end; ++ev) {
+        const unsigned x = ev->x - origin_x;
+        const unsigned y = ev->y - origin_y;
+        if (x < width && y < height) {
+            window_events.emplace_back(static_cast<unsigned short>(x), static_cast<unsigned short>(y), ev->p, ev->t);
+        }
+    }
+}
+
+void CameraManager::publish_window_stats(Pipeline& pipe) {
+    auto& channel = PipelineBus::instance().window_stats();
+    if (!channel.has_subscribers()) {
+        pipe.bus_window_synced = false;
+        return;
+    }
+    // A new subscriber starts at the next window, not with the history
+    if (!pipe.bus_window_synced) {
+        EventCamera::EventProcessor::WindowStats last;
+        pipe.bus_window_seen = pipe.event_stats.get_last_window(last) ? last.window_index : 0;
+        pipe.bus_window_synced = true;
+        return;
+    }
+    pipe.bus_windows.clear();
+    pipe.bus_window_seen = pipe.event_stats.get_windows_since(pipe.bus_window_seen, pipe.bus_windows);
+    for (const auto& window : pipe.bus_windows) {
+        PipelineBus::WindowStatsMessage message;
+        message.camera_index = pipe.index;
+        message.window = window;
+        channel.publish(message);
+    }
+}
+
+bool CameraManager::start_erc_control(const core::ErcController::Settings& settings, int interval_ms) {
+    stop_erc_control();
+
+    if (replay_ || !is_camera_connected(0)) {
+        std::cerr << "ERC control: needs a running camera" << std::endl;
+        return false;
+    }
+
+    auto* erc = cameras_[0].camera->get_device().get_facility<Metavision::I_ErcModule>();
+    if (!erc) {
+        std::cerr << "ERC control: sensor has no event rate controller" << std::endl;
         return false;
     }
+
+    core::ErcController controller;
+    try {
+        const int sensor_min = static_cast<int>(erc->get_min_supported_cd_event_rate() / 1000);
+        const int sensor_max = static_cast<int>(erc->get_max_supported_cd_event_rate() / 1000);
+        core::ErcController::Settings bounds = settings;
+        bounds.min_rate_kevps = std::max(bounds.min_rate_kevps, sensor_min);
+        bounds.max_rate_kevps = bounds.max_rate_kevps > 0 ? std::min(bounds.max_rate_kevps, sensor_max) : sensor_max;
+
+        // Start wide open: the first saturated interval brings the cap down to what fits
+        controller.reset(bounds, bounds.max_rate_kevps);
+        erc->set_cd_event_rate(static_cast<uint32_t>(controller.get_rate_kevps()) * 1000);
+        erc->enable(true);
+    } catch (const std::exception& e) {
+        std::cerr << "ERC control: failed to configure ERC: " << e.what() << std::endl;
+        return false;
+    }
+
+    erc_rate_kevps_ = controller.get_rate_kevps();
+    std::cout << "ERC control: " << controller.settings().min_rate_kevps << " - "
+              << controller.settings().max_rate_kevps << " kev/s, every " << interval_ms << " ms" << std::endl;
+
+    erc_running_ = true;
+    erc_thread_ = std::thread(&CameraManager::erc_control_loop, this, controller, std::max(interval_ms, 10));
+    return true;
+}
+
+void CameraManager::stop_erc_control() {
+    if (!erc_running_.exchange(false)) {
+        return;
+    }
+
+    erc_wake_cv_.notify_all();
+    if (erc_thread_.joinable()) {
+        erc_thread_.join();
+    }
+}
+
+void CameraManager::erc_control_loop(core::ErcController controller, int interval_ms) {
+    auto& registry = core::MetricsRegistry::instance();
+    core::Gauge& rate_gauge = registry.gauge("erc.rate_kevps");
+    core::Gauge& fill_gauge = registry.gauge("events.ring_peak_fill_percent");
+    core::Counter& adjustments = registry.counter("erc.adjustments");
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point last = Clock::now();
+    int64_t last_events = metrics().events_ingested.value();
+    video::EventRing& event_ring = pipeline(0).event_ring;
+    int64_t last_dropped = event_ring.get_dropped_events();
+    event_ring.take_peak_size();
+    rate_gauge.set(controller.get_rate_kevps());
+
+    while (erc_running_.load()) {
+        {
+            std::unique_lock<std::mutex> lock(erc_wake_mutex_);
+            erc_wake_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms),
+                                  [this] { return !erc_running_.load(); });
+        }
+        if (!erc_running_.load()) {
+            break;
+        }
+
+        // Ingested counts every delivered event, dropped or not
+        const Clock::time_point now = Clock::now();
+        const int64_t events = metrics().events_ingested.value();
+        const int64_t dropped = event_ring.get_dropped_events();
+        core::ErcController::Sample sample;
+        sample.interval_s = std::chrono::duration<double>(now - last).count();
+        sample.events = events - last_events;
+        sample.dropped_events = dropped - last_dropped;
+        sample.peak_fill_percent = static_cast<int>(event_ring.take_peak_size() * 100 / event_ring.capacity());
+        last = now;
+        last_events = events;
+        last_dropped = dropped;
+        fill_gauge.set(sample.peak_fill_percent);
+
+        const core::ErcController::Action action = controller.update(sample);
+        if (action == core::ErcController::Action::Hold) {
+            continue;
+        }
+
+        try {
+            // Fetched per write: the watchdog may have reopened the device since
+            std::lock_guard<std::mutex> device_lock(device_mutex_);
+            if (!is_camera_connected(0)) {
+                continue;
+            }
+            auto* erc = cameras_[0].camera->get_device().get_facility<Metavision::I_ErcModule>();
+            if (!erc) {
+                continue;
+            }
+            erc->set_cd_event_rate(static_cast<uint32_t>(controller.get_rate_kevps()) * 1000);
+        } catch (const std::exception& e) {
+            static core::LogSite site(10000);
+            core::LogLine(core::LogLevel::Error, &site) << "ERC control: failed to set event rate: " << e.what();
+            continue;
+        }
+        erc_rate_kevps_.store(controller.get_rate_kevps(), std::memory_order_relaxed);
+        rate_gauge.set(controller.get_rate_kevps());
+        adjustments.add();
+        if (action == core::ErcController::Action::Decrease) {
+            std::cout << "ERC control: saturated (" << sample.dropped_events << " dropped, ring peak "
+                      << sample.peak_fill_percent << " %), cap " << controller.get_rate_kevps() << " kev/s" << std::endl;
+        }
+    }
+}
+
+bool CameraManager::start_monitoring(int interval_ms) {
+    stop_monitoring();
+
+    if (replay_ || cameras_.empty()) {
+        return false;
+    }
+
+    monitoring_running_ = true;
+    monitoring_thread_ = std::thread(&CameraManager::monitoring_loop, this, std::max(interval_ms, 100));
+    return true;
+}
+
+void CameraManager::stop_monitoring() {
+    if (!monitoring_running_.exchange(false)) {
+        return;
+    }
+
+    monitoring_wake_cv_.notify_all();
+    if (monitoring_thread_.joinable()) {
+        monitoring_thread_.join();
+    }
+}
+
+CameraManager::MonitoringReading CameraManager::get_monitoring(int index) const {
+    MonitoringReading reading;
+    if (index < 0 || index >= num_pipelines()) {
+        return reading;
+    }
+    const Pipeline& pipe = pipeline(index);
+    reading.temperature_c = pipe.temperature_c.load(std::memory_order_relaxed);
+    reading.dead_time_us = pipe.dead_time_us.load(std::memory_order_relaxed);
+    reading.sampled_us = pipe.monitoring_us.load(std::memory_order_relaxed);
+    return reading;
+}
+
+void CameraManager::monitoring_loop(int interval_ms) {
+    auto& registry = core::MetricsRegistry::instance();
+    core::Gauge& temperature_gauge = registry.gauge("camera.temperature_c");
+    core::Gauge& dead_time_gauge = registry.gauge("camera.dead_time_us");
+
+    // A quantity that throws once is not read again (sensor without that probe);
+    // illumination is never read, it floods the HAL log on some sensors
+    struct Source {
+        bool temperature = true;
+        bool dead_time = true;
+    };
+    std::vector<Source> sources(std::min(num_cameras(), num_pipelines()));
+
+    while (monitoring_running_.load()) {
+        for (size_t i = 0; i < sources.size(); ++i) {
+            Source& source = sources[i];
+            Pipeline& pipe = pipeline(static_cast<int>(i));
+
+            // Fetched per sample: the watchdog may have reopened the device since
+            std::lock_guard<std::mutex> device_lock(device_mutex_);
+            if (!pipe.camera_started.load()) {
+                continue;
+            }
+            auto* monitoring = cameras_[i].camera->get_device().get_facility<Metavision::I_Monitoring>();
+            if (!monitoring) {
+                continue;
+            }
+
+            if (source.temperature) {
+                try {
+                    const float temperature = static_cast<float>(monitoring->get_temperature());
+                    pipe.temperature_c.store(temperature, std::memory_order_relaxed);
+                    if (i == 0) {
+                        temperature_gauge.set(temperature);
+                    }
+                } catch (...) {
+                    source.temperature = false;
+                    std::cout << "Monitoring: camera " << i << " has no temperature probe" << std::endl;
+                }
+            }
+            if (source.dead_time) {
+                try {
+                    const int dead_time = monitoring->get_pixel_dead_time();
+                    pipe.dead_time_us.store(dead_time, std::memory_order_relaxed);
+                    if (i == 0) {
+                        dead_time_gauge.set(dead_time);
+                    }
+                } catch (...) {
+                    source.dead_time = false;
+                    std::cout << "Monitoring: camera " << i << " does not report pixel dead time" << std::endl;
+                }
+            }
+            pipe.monitoring_us.store(steady_us(), std::memory_order_relaxed);
+        }
+
+        std::unique_lock<std::mutex> lock(monitoring_wake_mutex_);
+        monitoring_wake_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms),
+                                     [this] { return !monitoring_running_.load(); });
+    }
+}
+
+bool CameraManager::start_watchdog(int stall_ms, const ConfigureCallback& configure) {
+    stop_watchdog();
+
+    if (replay_ || cameras_.empty()) {
+        return false;
+    }
+
+    reconnect_configure_ = configure;
+    watchdog_running_ = true;
+    watchdog_thread_ = std::thread(&CameraManager::watchdog_loop, this, std::max(stall_ms, 500));
+    std::cout << "Camera watchdog: reopening after " << std::max(stall_ms, 500) << " ms without events" << std::endl;
+    return true;
+}
+
+void CameraManager::stop_watchdog() {
+    if (!watchdog_running_.exchange(false)) {
+        return;
+    }
+
+    watchdog_wake_cv_.notify_all();
+    if (watchdog_thread_.joinable()) {
+        watchdog_thread_.join();
+    }
+}
+
+bool CameraManager::is_reconnecting(int index) const {
+    return index >= 0 && index < num_pipelines() && pipeline(index).reconnecting.load(std::memory_order_relaxed);
+}
+
+void CameraManager::watchdog_loop(int stall_ms) {
+    core::Counter& reconnects = core::MetricsRegistry::instance().counter("camera.reconnects");
+    const int64_t stall_us = static_cast<int64_t>(stall_ms) * 1000;
+    const size_t watched = std::min(cameras_.size(), pipelines_.size());
+    std::vector<int64_t> next_attempt_us(watched, 0);
+
+    while (watchdog_running_.load()) {
+        {
+            std::unique_lock<std::mutex> lock(watchdog_wake_mutex_);
+            watchdog_wake_cv_.wait_for(lock, std::chrono::milliseconds(std::max(stall_ms / 4, 100)),
+                                       [this] { return !watchdog_running_.load(); });
+        }
+        if (!watchdog_running_.load()) {
+            break;
+        }
+
+        for (size_t i = 0; i < watched; ++i) {
+            Pipeline& pipe = pipeline(static_cast<int>(i));
+            const int64_t now_us = steady_us();
+
+            if (!pipe.reconnecting.load()) {
+                if (!pipe.camera_started.load() ||
+                    now_us - pipe.last_event_us.load(std::memory_order_relaxed) < stall_us) {
+                    continue;
+                }
+                core::LogLine(core::LogLevel::Warning) << "Camera " << i << ": no events for " << stall_ms
+                                                    << " ms, reopening " << cameras_[i].serial;
+                pipe.camera_started = false;
+                pipe.reconnecting = true;
+                next_attempt_us[i] = now_us;
+            }
+
+            if (now_us < next_attempt_us[i]) {
+                continue;
+            }
+            if (reopen_camera(static_cast<int>(i))) {
+                pipe.reconnecting = false;
+                reconnects.add();
+                core::LogLine(core::LogLevel::Info) << "Camera " << i << ": reopened " << cameras_[i].serial;
+            } else {
+                next_attempt_us[i] = steady_us() + stall_us;  // Device still gone; try again later
+            }
+        }
+    }
+}
+
+bool CameraManager::reopen_camera(int index) {
+    Pipeline& pipe = pipeline(index);
+    CameraInfo& info = cameras_[index];
+    std::lock_guard<std::mutex> device_lock(device_mutex_);
+
+    // Close the dead device first; its decoding thread ends with it
+    if (info.camera) {
+        try {
+            info.camera->stop();
+        } catch (const std::exception&) {
+            // Unplugged devices fail to stop; closing them is all that is left
+        }
+        info.camera.reset();
+    }
+
+    auto camera = open_camera(info.serial);
+    if (!camera) {
+        return false;
+    }
+
+    try {
+        if (pipe.hardware_roi) {
+            set_hardware_roi(*camera, cv::Rect(pipe.frame_origin, pipe.frame_size));
+        }
+        attach_event_input(*camera, pipe);
+        attach_trigger_in(*camera, pipe);
+        info.camera = std::move(camera);
+
+        if (reconnect_configure_) {
+            reconnect_configure_(index);
+        }
+        if (index == 0 && erc_running_.load()) {
+            if (auto* erc = info.camera->get_device().get_facility<Metavision::I_ErcModule>()) {
+                erc->set_cd_event_rate(static_cast<uint32_t>(erc_rate_kevps_.load()) * 1000);
+                erc->enable(true);
+            }
+        }
+
+        // Sensor time restarts with the device; nothing from it has been decoded yet
+        pipe.clock_sync.reset();
+        pipe.decode_placed = false;
+        pipe.restart_pending = true;
+        pipe.last_event_us = steady_us();
+        info.camera->start();
+        pipe.camera_started = true;
+        return true;
+    } catch (const std::exception& e) {
+        core::LogLine(core::LogLevel::Error) << "Camera " << index << ": reopen failed: " << e.what();
+        info.camera.reset();
+        return false;
+    }
+}
+
+void CameraManager::stop_accumulation_threads() {
+    for (auto& pipe : pipelines_) {
+        pipe->accumulation_running = false;
+        pipe->event_ring.notify();
+    }
+    for (auto& pipe : pipelines_) {
+        if (pipe->accumulation_thread.joinable()) {
+            pipe->accumulation_thread.join();
+        }
+    }
 }
 
 bool CameraManager::is_camera_connected(int index) const {
-    return index == 0 && !cameras_.empty() && camera_started_;
+    return index >= 0 && index < num_cameras() && index < num_pipelines() && pipeline(index).camera_started;
 }
 
 void CameraManager::shutdown() {
     std::cout << "Shutting down camera manager..." << std::endl;
 
+    // Touch the camera's facilities, so they go first
+    stop_watchdog();
+    stop_erc_control();
+    stop_monitoring();
+
     // Stop cameras
     for (auto& cam_info : cameras_) {
         if (cam_info.camera) {
@@ -234,10 +1632,27 @@ void CameraManager::shutdown() {
         }
     }
 
+    if (replay_) {
+        replay_->stop();
+    }
+
+    // Cameras are stopped, so no more batches arrive; let the consumers exit
+    recorder_.stop();
+    stop_accumulation_threads();
+    publisher_.stop();
+    analyzers_.stop();
+    merger_.stop();
+    for (const auto& pipe : pipelines_) {
+        if (pipe->event_ring.get_dropped_batches() > 0) {
+            std::cout << "Camera " << pipe->index << " event batches dropped: " << pipe->event_ring.get_dropped_batches()
+                      << " (" << pipe->event_ring.get_dropped_events() << " events)" << std::endl;
+        }
+    }
+
     // Clear resources
-    frame_generator_.reset();
+    reset_pipelines(1);
+    replay_.reset();
     cameras_.clear();
-    camera_started_ = false;
 
     std::cout << "Camera manager shutdown complete" << std::endl;
 }
@@ -0,0 +1,657 @@
+#include "capture_catalog.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// ============================================================================
+// Record format
+// ============================================================================
+//
+// Both files are a plain sequence of records:
+//   u32 RECORD_MAGIC, u32 payload bytes, u32 FNV-1a of the payload, payload
+// Payload fields in write_record() order; strings are u32 length + bytes.
+// Version 2 appends frame_hash and duplicate_of; version 1 records still load.
+
+constexpr uint32_t RECORD_MAGIC = 0x49435452;   // "RTCI"
+constexpr uint32_t RECORD_VERSION = 2;
+constexpr size_t RECORD_HEADER = 3 * sizeof(uint32_t);
+constexpr uint32_t MAX_PAYLOAD = 1u << 20;
+
+uint32_t fnv1a(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+class Writer {
+public:
+    template <typename T>
+    void put(T value) {
+        const size_t at = bytes.size();
+        bytes.resize(at + sizeof(T));
+        std::memcpy(bytes.data() + at, &value, sizeof(T));
+    }
+    void put(const std::string& value) {
+        put(static_cast<uint32_t>(value.size()));
+        bytes.insert(bytes.end(), value.begin(), value.end());
+    }
+    std::vector<uint8_t> bytes;
+};
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (size_ - at_ < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data_ + at_, sizeof(T));
+        at_ += sizeof(T);
+        return true;
+    }
+    bool get(std::string& value) {
+        uint32_t length = 0;
+        if (!get(length) || size_ - at_ < length) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(data_ + at_), length);
+        at_ += length;
+        return true;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t at_ = 0;
+};
+
+void write_record(std::ostream& out, const CaptureCatalog::Entry& entry) {
+    const auto& m = entry.metadata;
+    Writer payload;
+    payload.put(RECORD_VERSION);
+    payload.put(entry.path);
+    payload.put(m.timestamp);
+    payload.put<int64_t>(m.unix_timestamp_ms);
+    payload.put<int64_t>(m.sensor_timestamp_us);
+    payload.put<int64_t>(m.frame_unix_timestamp_ms);
+    payload.put<int32_t>(m.binary_bit_1);
+    payload.put<int32_t>(m.binary_bit_2);
+    payload.put<int32_t>(m.accumulation_time_us);
+    payload.put<int64_t>(m.frame_events);
+    payload.put<int32_t>(m.bias_diff);
+    payload.put<int32_t>(m.bias_diff_on);
+    payload.put<int32_t>(m.bias_diff_off);
+    payload.put<int32_t>(m.bias_fo);
+    payload.put<int32_t>(m.bias_hpf);
+    payload.put<int32_t>(m.bias_refr);
+    payload.put<int32_t>(m.image_width);
+    payload.put<int32_t>(m.image_height);
+    payload.put<int32_t>(m.active_pixels);
+    payload.put<float>(m.pixel_density);
+    payload.put(m.comment);
+    payload.put(m.app_version);
+    payload.put<uint64_t>(m.frame_hash);
+    payload.put(m.duplicate_of);
+
+    Writer header;
+    header.put(RECORD_MAGIC);
+    header.put(static_cast<uint32_t>(payload.bytes.size()));
+    header.put(fnv1a(payload.bytes.data(), payload.bytes.size()));
+    out.write(reinterpret_cast<const char*>(header.bytes.data()), static_cast<std::streamsize>(header.bytes.size()));
+    out.write(reinterpret_cast<const char*>(payload.bytes.data()), static_cast<std::streamsize>(payload.bytes.size()));
+}
+
+bool read_payload(const uint8_t* data, size_t size, CaptureCatalog::Entry& entry) {
+    auto& m = entry.metadata;
+    Reader in(data, size);
+    uint32_t version = 0;
+    int32_t i32[12] = {};
+    if (!in.get(version) || version < 1 || version > RECORD_VERSION ||
+        !in.get(entry.path) || !in.get(m.timestamp) ||
+        !in.get(m.unix_timestamp_ms) || !in.get(m.sensor_timestamp_us) || !in.get(m.frame_unix_timestamp_ms) ||
+        !in.get(i32[0]) || !in.get(i32[1]) || !in.get(i32[2]) || !in.get(m.frame_events)) {
+        return false;
+    }
+    for (int i = 3; i < 12; ++i) {
+        if (!in.get(i32[i])) {
+            return false;
+        }
+    }
+    if (!in.get(m.pixel_density) || !in.get(m.comment) || !in.get(m.app_version)) {
+        return false;
+    }
+    if (version >= 2 && (!in.get(m.frame_hash) || !in.get(m.duplicate_of))) {
+        return false;
+    }
+    m.binary_bit_1 = i32[0];
+    m.binary_bit_2 = i32[1];
+    m.accumulation_time_us = i32[2];
+    m.bias_diff = i32[3];
+    m.bias_diff_on = i32[4];
+    m.bias_diff_off = i32[5];
+    m.bias_fo = i32[6];
+    m.bias_hpf = i32[7];
+    m.bias_refr = i32[8];
+    m.image_width = i32[9];
+    m.image_height = i32[10];
+    m.active_pixels = i32[11];
+    return true;
+}
+
+// ============================================================================
+// Query fields (named like the JSON sidecar keys)
+// ============================================================================
+
+struct Field {
+    const char* name;
+    double (*number)(const CaptureCatalog::Entry&);        // nullptr for text fields
+    const std::string& (*text)(const CaptureCatalog::Entry&);
+};
+
+#define NUMBER_FIELD(key, member) \
+    { key, [](const CaptureCatalog::Entry& e) { return static_cast<double>(e.metadata.member); }, nullptr }
+#define TEXT_FIELD(key, expr) \
+    { key, nullptr, [](const CaptureCatalog::Entry& e) -> const std::string& { return expr; } }
+
+const Field FIELDS[] = {
+    TEXT_FIELD("path", e.path),
+    TEXT_FIELD("timestamp", e.metadata.timestamp),
+    TEXT_FIELD("comment", e.metadata.comment),
+    TEXT_FIELD("app_version", e.metadata.app_version),
+    TEXT_FIELD("duplicate_of", e.metadata.duplicate_of),
+    NUMBER_FIELD("unix_timestamp_ms", unix_timestamp_ms),
+    NUMBER_FIELD("sensor_timestamp_us", sensor_timestamp_us),
+    NUMBER_FIELD("frame_unix_timestamp_ms", frame_unix_timestamp_ms),
+    NUMBER_FIELD("binary_bit_1", binary_bit_1),
+    NUMBER_FIELD("binary_bit_2", binary_bit_2),
+    NUMBER_FIELD("accumulation_time_us", accumulation_time_us),
+    NUMBER_FIELD("frame_events", frame_events),
+    NUMBER_FIELD("bias_diff", bias_diff),
+    NUMBER_FIELD("bias_diff_on", bias_diff_on),
+    NUMBER_FIELD("bias_diff_off", bias_diff_off),
+    NUMBER_FIELD("bias_fo", bias_fo),
+    NUMBER_FIELD("bias_hpf", bias_hpf),
+    NUMBER_FIELD("bias_refr", bias_refr),
+    NUMBER_FIELD("width", image_width),
+    NUMBER_FIELD("height", image_height),
+    NUMBER_FIELD("active_pixels", active_pixels),
+    NUMBER_FIELD("pixel_density", pixel_density),
+};
+
+#undef NUMBER_FIELD
+#undef TEXT_FIELD
+
+constexpr int FIELD_COUNT = static_cast<int>(sizeof(FIELDS) / sizeof(FIELDS[0]));
+
+/**
+ * Split on whitespace; double quotes keep spaces in a value (comment~"hot pixel")
+ */
+std::vector<std::string> split_terms(const std::string& text) {
+    std::vector<std::string> terms;
+    std::string current;
+    bool quoted = false;
+    for (char c : text) {
+        if (c == '"') {
+            quoted = !quoted;
+        } else if (!quoted && std::isspace(static_cast<unsigned char>(c))) {
+            if (!current.empty()) {
+                terms.push_back(std::move(current));
+                current.clear();
+            }
+        } else {
+            current += c;
+        }
+    }
+    if (!current.empty()) {
+        terms.push_back(std::move(current));
+    }
+    return terms;
+}
+
+} // namespace
+
+// ============================================================================
+// Query
+// ============================================================================
+
+bool CaptureCatalog::Query::parse(const std::string& text, Query& out, std::string& error) {
+    using Op = Query::Op;
+    static const std::pair<const char*, Op> OPERATORS[] = {
+        {"<=", Op::LE}, {">=", Op::GE}, {"!=", Op::NE}, {"=", Op::EQ}, {"<", Op::LT}, {">", Op::GT}, {"~", Op::CONTAINS}
+    };
+
+    out.terms.clear();
+    for (const std::string& token : split_terms(text)) {
+        error = token;
+        const size_t name_end = token.find_first_of("<>=!~");
+        if (name_end == std::string::npos || name_end == 0) {
+            return false;
+        }
+        const std::string name = token.substr(0, name_end);
+
+        Term term;
+        term.field = -1;
+        for (int i = 0; i < FIELD_COUNT; ++i) {
+            if (name == FIELDS[i].name) {
+                term.field = i;
+            }
+        }
+        if (term.field < 0) {
+            return false;
+        }
+
+        size_t value_start = std::string::npos;
+        for (const auto& op : OPERATORS) {
+            if (token.compare(name_end, std::strlen(op.first), op.first) == 0) {
+                term.op = op.second;
+                value_start = name_end + std::strlen(op.first);
+                break;
+            }
+        }
+        if (value_start == std::string::npos) {
+            return false;
+        }
+        term.text = token.substr(value_start);
+
+        if (FIELDS[term.field].number != nullptr) {
+            std::string value = term.text;
+            if (!value.empty() && value.back() == '%') {
+                value.pop_back();   // pixel_density>2%
+            }
+            size_t used = 0;
+            try {
+                term.number = std::stod(value, &used);
+            } catch (const std::exception&) {
+                return false;
+            }
+            if (used != value.size() || term.op == Op::CONTAINS) {
+                return false;
+            }
+        } else if (term.op != Op::EQ && term.op != Op::NE && term.op != Op::CONTAINS) {
+            return false;
+        }
+        out.terms.push_back(std::move(term));
+    }
+    error.clear();
+    return true;
+}
+
+bool CaptureCatalog::Query::matches(const Entry& entry) const {
+    for (const Term& term : terms) {
+        const Field& field = FIELDS[term.field];
+        bool ok = false;
+        if (field.number != nullptr) {
+            const double value = field.number(entry);
+            switch (term.op) {
+                case Op::EQ: ok = value == term.number; break;
+                case Op::NE: ok = value != term.number; break;
+                case Op::LT: ok = value < term.number; break;
+                case Op::LE: ok = value <= term.number; break;
+                case Op::GT: ok = value > term.number; break;
+                case Op::GE: ok = value >= term.number; break;
+                case Op::CONTAINS: break;
+            }
+        } else {
+            const std::string& value = field.text(entry);
+            switch (term.op) {
+                case Op::EQ: ok = value == term.text; break;
+                case Op::NE: ok = value != term.text; break;
+                case Op::CONTAINS: ok = value.find(term.text) != std::string::npos; break;
+                default: break;
+            }
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// CaptureCatalog
+// ============================================================================
+
+CaptureCatalog& CaptureCatalog::instance() {
+    static CaptureCatalog catalog;
+    return catalog;
+}
+
+CaptureCatalog::~CaptureCatalog() {
+    close();
+}
+
+bool CaptureCatalog::open(const std::string& directory, int backfill_threads) {
+    close();
+
+    std::error_code ec;
+    const fs::path dir = fs::absolute(directory.empty() ? "." : directory, ec).lexically_normal();
+    fs::create_directories(dir, ec);
+    if (!fs::is_directory(dir)) {
+        std::cerr << "CaptureCatalog: Cannot use directory " << dir << std::endl;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        directory_ = dir.string();
+        entries_.clear();
+        by_path_.clear();
+    }
+
+    load_file((dir / SNAPSHOT_FILE).string(), false);
+    load_file((dir / LOG_FILE).string(), true);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    log_.open(dir / LOG_FILE, std::ios::binary | std::ios::app);
+    if (!log_.is_open()) {
+        std::cerr << "CaptureCatalog: Cannot open " << (dir / LOG_FILE) << std::endl;
+        entries_.clear();
+        by_path_.clear();
+        return false;
+    }
+    // Fold a non-empty log into the snapshot right away
+    log_records_ = 0;
+    if (fs::file_size(dir / LOG_FILE, ec) > 0) {
+        compact();
+    }
+    open_ = true;
+    std::cout << "CaptureCatalog: " << entries_.size() << " captures indexed in " << directory_ << std::endl;
+
+    if (backfill_threads >= 0) {
+        const int threads = backfill_threads > 0
+            ? backfill_threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        stop_backfill_ = false;
+        backfilling_ = true;
+        backfill_thread_ = std::thread(&CaptureCatalog::backfill, this, threads);
+    }
+    return true;
+}
+
+void CaptureCatalog::close() {
+    stop_backfill_ = true;
+    if (backfill_thread_.joinable()) {
+        backfill_thread_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (open_.load()) {
+        compact();
+        log_.close();
+        open_ = false;
+    }
+    entries_.clear();
+    by_path_.clear();
+}
+
+std::string CaptureCatalog::directory() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return open_.load() ? directory_ : std::string();
+}
+
+size_t CaptureCatalog::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void CaptureCatalog::add(const std::string& image_path, const ImageManager::ImageMetadata& metadata) {
+    if (!open_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::error_code ec;
+    const fs::path relative = fs::absolute(image_path, ec).lexically_normal().lexically_relative(directory_);
+    if (ec || relative.empty() || *relative.begin() == "..") {
+        return;   // Saved outside the capture directory
+    }
+
+    put(Entry{relative.generic_string(), metadata}, true);
+    if (++log_records_ >= COMPACT_EVERY) {
+        compact();
+    }
+}
+
+std::vector<CaptureCatalog::Entry> CaptureCatalog::find(const Query& query, size_t limit) const {
+    std::vector<const Entry*> matches;
+    std::vector<Entry> result;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Entry& entry : entries_) {
+        if (query.matches(entry)) {
+            matches.push_back(&entry);
+        }
+    }
+
+    const size_t count = limit > 0 ? std::min(limit, matches.size()) : matches.size();
+    std::partial_sort(matches.begin(), matches.begin() + count, matches.end(),
+        [](const Entry* a, const Entry* b) {
+            return a->metadata.unix_timestamp_ms > b->metadata.unix_timestamp_ms;
+        });
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        result.push_back(*matches[i]);
+    }
+    return result;
+}
+
+std::string CaptureCatalog::full_path(const Entry& entry) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const fs::path path = fs::path(directory_) / fs::path(entry.path);
+    if (!entry.metadata.duplicate_of.empty()) {
+        return (path.parent_path() / fs::path(entry.metadata.duplicate_of)).lexically_normal().string();
+    }
+    return path.string();
+}
+
+void CaptureCatalog::put(Entry&& entry, bool log) {
+    if (log) {
+        append(entry);
+    }
+    auto it = by_path_.find(entry.path);
+    if (it != by_path_.end()) {
+        entries_[it->second] = std::move(entry);
+    } else {
+        by_path_.emplace(entry.path, entries_.size());
+        entries_.push_back(std::move(entry));
+    }
+}
+
+bool CaptureCatalog::append(const Entry& entry) {
+    if (!log_.is_open()) {
+        return false;
+    }
+    write_record(log_, entry);
+    log_.flush();   // One record per save; a crash loses at most the record being written
+    return log_.good();
+}
+
+bool CaptureCatalog::compact() {
+    const fs::path dir(directory_);
+    const fs::path snapshot = dir / SNAPSHOT_FILE;
+    const fs::path temp = dir / (std::string(SNAPSHOT_FILE) + ".tmp");
+
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        for (const Entry& entry : entries_) {
+            write_record(out, entry);
+        }
+        out.close();
+        if (!out) {
+            std::cerr << "CaptureCatalog: Failed to write " << temp << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(temp, snapshot, ec);
+    if (ec) {
+        std::cerr << "CaptureCatalog: Failed to replace " << snapshot << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    // Everything in the log is in the snapshot now
+    log_.close();
+    log_.open(dir / LOG_FILE, std::ios::binary | std::ios::trunc);
+    log_.close();
+    log_.open(dir / LOG_FILE, std::ios::binary | std::ios::app);
+    log_records_ = 0;
+    return log_.is_open();
+}
+
+bool CaptureCatalog::load_file(const std::string& path, bool truncate_torn_tail) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t offset = 0;
+    while (data.size() - offset >= RECORD_HEADER) {
+        uint32_t header[3];
+        std::memcpy(header, data.data() + offset, sizeof(header));
+        const uint8_t* payload = data.data() + offset + RECORD_HEADER;
+        Entry entry;
+        if (header[0] != RECORD_MAGIC || header[1] > MAX_PAYLOAD ||
+            data.size() - offset - RECORD_HEADER < header[1] ||
+            fnv1a(payload, header[1]) != header[2] ||
+            !read_payload(payload, header[1], entry)) {
+            break;
+        }
+        put(std::move(entry), false);
+        offset += RECORD_HEADER + header[1];
+    }
+
+    if (offset != data.size()) {
+        std::cerr << "CaptureCatalog: Ignoring " << data.size() - offset << " unreadable bytes at the end of "
+                  << path << std::endl;
+        if (truncate_torn_tail) {
+            std::error_code ec;
+            fs::resize_file(path, offset, ec);
+        }
+    }
+    return true;
+}
+
+void CaptureCatalog::backfill(int threads) {
+    const fs::path dir(directory_);
+    std::vector<std::string> pending;   // Relative PNG paths with a JSON sidecar, not yet indexed
+    std::unordered_set<std::string> on_disk;
+
+    {
+        std::error_code ec;
+        fs::recursive_directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (; !ec && it != fs::recursive_directory_iterator() && !stop_backfill_.load(); it.increment(ec)) {
+            const fs::path& path = it->path();
+            if (!it->is_regular_file(ec)) {
+                continue;
+            }
+            if (path.extension() == ".json") {
+                // Sidecar without a PNG: a deduplicated capture, indexed under its would-be PNG path
+                fs::path png = path;
+                png.replace_extension(".png");
+                if (!fs::exists(png, ec)) {
+                    std::string relative = png.lexically_relative(dir).generic_string();
+                    if (by_path_.count(relative) == 0) {
+                        pending.push_back(relative);
+                    }
+                    on_disk.insert(std::move(relative));
+                }
+                continue;
+            }
+            if (path.extension() != ".png") {
+                continue;
+            }
+            std::string relative = path.lexically_relative(dir).generic_string();
+            if (by_path_.count(relative) == 0 && fs::exists(fs::path(path).replace_extension(".json"), ec)) {
+                pending.push_back(relative);
+            }
+            on_disk.insert(std::move(relative));
+        }
+        if (ec) {
+            std::cerr << "CaptureCatalog: Scan of " << dir << " stopped: " << ec.message() << std::endl;
+        }
+    }
+
+    // Each worker parses sidecars into its own batch and merges every BATCH entries
+    constexpr size_t BATCH = 256;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> added{0};
+    auto worker = [&]() {
+        std::vector<Entry> batch;
+        auto merge = [&]() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (Entry& entry : batch) {
+                put(std::move(entry), false);   // Reaches the disk with the compaction below
+            }
+            added += batch.size();
+            batch.clear();
+        };
+        for (size_t i = next++; i < pending.size() && !stop_backfill_.load(std::memory_order_relaxed); i = next++) {
+            Entry entry{pending[i], ImageManager::ImageMetadata{}};
+            const fs::path json = (dir / fs::path(pending[i])).replace_extension(".json");
+            std::error_code ec;
+            if (ImageManager::load_metadata_json(json.string(), entry.metadata) &&
+                (!entry.metadata.duplicate_of.empty() || fs::exists(dir / fs::path(pending[i]), ec))) {
+                batch.push_back(std::move(entry));
+                if (batch.size() == BATCH) {
+                    merge();
+                }
+            }
+        }
+        merge();
+    };
+
+    if (!pending.empty()) {
+        std::vector<std::thread> workers;
+        const int count = std::min<int>(threads, static_cast<int>((pending.size() + BATCH - 1) / BATCH));
+        for (int i = 1; i < count; ++i) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t removed = 0;
+    if (!stop_backfill_.load()) {
+        // A complete scan also drops captures deleted since they were indexed
+        // (saves that landed after the scan are not in on_disk, but exist)
+        std::vector<Entry> kept;
+        kept.reserve(entries_.size());
+        by_path_.clear();
+        for (Entry& entry : entries_) {
+            std::error_code ec;
+            const fs::path stored = dir / fs::path(entry.path);
+            const bool exists = entry.metadata.duplicate_of.empty()
+                ? fs::exists(stored, ec) : fs::exists(fs::path(stored).replace_extension(".json"), ec);
+            if (on_disk.count(entry.path) != 0 || exists) {
+                by_path_.emplace(entry.path, kept.size());
+                kept.push_back(std::move(entry));
+            }
+        }
+        removed = entries_.size() - kept.size();
+        entries_ = std::move(kept);
+    }
+    if (added > 0 || removed > 0) {
+        compact();
+        std::cout << "CaptureCatalog: Backfilled " << added << " captures, dropped " << removed
+                  << " missing, " << entries_.size() << " indexed" << std::endl;
+    }
+    backfilling_ = false;
+}
@@ -0,0 +1,68 @@
+#include "checkpoint_writer.h"
+#include "core/thread_placement.h"
+
+void CheckpointWriter::start(const std::string& path) {
+    stop();
+    path_ = path;
+    stop_requested_ = false;
+    written_ = 0;
+    failed_ = 0;
+    superseded_ = 0;
+    running_ = true;
+    thread_ = std::thread(&CheckpointWriter::writer_loop, this);
+}
+
+void CheckpointWriter::stop() {
+    if (!running_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_requested_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    running_ = false;
+}
+
+std::unique_ptr<AnalysisShard> CheckpointWriter::submit(std::unique_ptr<AnalysisShard> shard) {
+    std::unique_ptr<AnalysisShard> spare;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_) {
+            superseded_++;
+            spare = std::move(pending_);   // Never written: the newer shard covers it
+        } else {
+            spare = std::move(spare_);
+        }
+        pending_ = std::move(shard);
+    }
+    cv_.notify_one();
+    return spare ? std::move(spare) : std::make_unique<AnalysisShard>();
+}
+
+void CheckpointWriter::writer_loop() {
+    core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::IO);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return pending_ || stop_requested_; });
+        if (!pending_) {
+            break;   // Stop requested with nothing left to write
+        }
+
+        // Serialize and write unlocked: submit() only ever waits for the pointer swap
+        std::unique_ptr<AnalysisShard> shard = std::move(pending_);
+        lock.unlock();
+        if (shard->save(path_)) {
+            written_++;
+        } else {
+            failed_++;
+        }
+        lock.lock();
+        if (!spare_) {
+            spare_ = std::move(shard);
+        }
+    }
+}
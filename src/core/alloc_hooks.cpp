@@ -0,0 +1,46 @@
+/**
+ * Global operator new / delete replacements that feed core::AllocTracker
+ *
+ * Linked only into builds that count allocations (see alloc_tracker.h).
+ * Over-aligned new keeps the library implementation and is not counted.
+ */
+
+#include "core/alloc_tracker.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+struct MarkActive {
+    MarkActive() { core::AllocTracker::set_active(); }
+} mark_active;
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    core::AllocTracker::on_allocate(size);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    core::AllocTracker::on_allocate(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
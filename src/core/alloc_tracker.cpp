@@ -0,0 +1,91 @@
+#include "core/alloc_tracker.h"
+#include "core/metrics.h"
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <string>
+
+namespace core {
+
+namespace {
+
+thread_local AllocCounts t_counts;  // Trivial type: no TLS initializer on the allocation path
+std::atomic<uint64_t> g_count{0};
+std::atomic<uint64_t> g_bytes{0};
+std::atomic<bool> g_active{false};
+
+/**
+ * Counts Mat buffers, then hands them to the wrapped allocator
+ *
+ * The wrapped allocator stays the buffer's UMatData::currAllocator, so
+ * deallocation never passes through here.
+ */
+class CountingMatAllocator : public cv::MatAllocator {
+public:
+    explicit CountingMatAllocator(cv::MatAllocator* base) : base_(base) {}
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override {
+        cv::UMatData* u = base_->allocate(dims, sizes, type, data, step, flags, usage_flags);
+        if (u && !data) {
+            AllocTracker::on_allocate(u->size);  // Caller-owned data is only wrapped
+        }
+        return u;
+    }
+
+    bool allocate(cv::UMatData* data, cv::AccessFlag access_flags, cv::UMatUsageFlags usage_flags) const override {
+        return base_->allocate(data, access_flags, usage_flags);
+    }
+
+    void deallocate(cv::UMatData* data) const override {
+        base_->deallocate(data);
+    }
+
+private:
+    cv::MatAllocator* base_;
+};
+
+} // namespace
+
+void AllocTracker::on_allocate(size_t bytes) {
+    ++t_counts.count;
+    t_counts.bytes += bytes;
+    g_count.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+AllocCounts AllocTracker::thread_counts() {
+    return t_counts;
+}
+
+AllocCounts AllocTracker::process_counts() {
+    return {g_count.load(std::memory_order_relaxed), g_bytes.load(std::memory_order_relaxed)};
+}
+
+bool AllocTracker::is_active() {
+    return g_active.load(std::memory_order_relaxed);
+}
+
+void AllocTracker::set_active() {
+    g_active.store(true, std::memory_order_relaxed);
+}
+
+bool AllocTracker::install_mat_allocator() {
+    if (!is_active()) {
+        return false;
+    }
+    static CountingMatAllocator allocator(cv::Mat::getDefaultAllocator());  // Lives until exit, like OpenCV's own
+    cv::Mat::setDefaultAllocator(&allocator);
+    return true;
+}
+
+AllocStage::AllocStage(const char* name)
+    : count_(MetricsRegistry::instance().histogram("alloc." + std::string(name) + "_count")),
+      bytes_(MetricsRegistry::instance().histogram("alloc." + std::string(name) + "_bytes")) {
+}
+
+void AllocStage::record(const AllocCounts& delta) {
+    count_.record(static_cast<int64_t>(delta.count));
+    bytes_.record(static_cast<int64_t>(delta.bytes));
+}
+
+} // namespace core
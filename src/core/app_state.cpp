@@ -3,15 +3,26 @@
 namespace core {
 
 AppState::AppState() {
-    // Initialize video subsystems for single camera
+    texture_cache_ = std::make_unique<video::TextureCache>();
+
+    // Initialize video subsystems, one independent set per camera
     for (int i = 0; i < MAX_CAMERAS; ++i) {
         frame_buffers_[i] = std::make_unique<video::FrameBuffer>();
-        texture_managers_[i] = std::make_unique<video::TextureManager>();
+        frame_buffers_[i]->configure_queue(FRAME_QUEUE_DEPTH, video::FrameQueuePolicy::DropNewest);
+        frame_pools_[i] = std::make_unique<video::FramePool>(FRAME_POOL_SLOTS);
+        camera_textures_[i] = texture_cache_->reserve();
+        renderers_[i] = std::make_unique<video::TripleBufferRenderer>();
+        scattering_workers_[i] = std::make_unique<ScatteringWorker>(*frame_buffers_[i], i);
+        burst_captures_[i] = std::make_unique<video::BurstCapture>();
+        frame_histories_[i] = std::make_unique<video::FrameHistory>();
+        frame_logs_[i] = std::make_unique<FrameLog>();
     }
 
     // Initialize core subsystems
     display_settings_ = std::make_unique<DisplaySettings>();
     camera_state_ = std::make_unique<CameraState>();
+    frame_sync_ = std::make_unique<FrameSync>();
+    latency_stats_ = std::make_unique<LatencyStats>();
 }
 
 AppState::~AppState() = default;
@@ -20,8 +31,40 @@ video::FrameBuffer& AppState::frame_buffer(int camera_index) {
     return *frame_buffers_[camera_index];
 }
 
-video::TextureManager& AppState::texture_manager(int camera_index) {
-    return *texture_managers_[camera_index];
+video::FramePool& AppState::frame_pool(int camera_index) {
+    return *frame_pools_[camera_index];
+}
+
+const video::TextureManager& AppState::texture_manager(int camera_index) const {
+    return *camera_textures_[camera_index];
+}
+
+void AppState::upload_camera_frame(int camera_index, const video::FrameRef& frame) {
+    texture_cache_->acquire(camera_textures_[camera_index], frame);
+}
+
+video::TextureCache& AppState::texture_cache() {
+    return *texture_cache_;
+}
+
+video::TripleBufferRenderer& AppState::triple_buffer_renderer(int camera_index) {
+    return *renderers_[camera_index];
+}
+
+ScatteringWorker& AppState::scattering_worker(int camera_index) {
+    return *scattering_workers_[camera_index];
+}
+
+video::BurstCapture& AppState::burst_capture(int camera_index) {
+    return *burst_captures_[camera_index];
+}
+
+video::FrameHistory& AppState::frame_history(int camera_index) {
+    return *frame_histories_[camera_index];
+}
+
+FrameLog& AppState::frame_log(int camera_index) {
+    return *frame_logs_[camera_index];
 }
 
 DisplaySettings& AppState::display_settings() {
@@ -32,6 +75,25 @@ CameraState& AppState::camera_state() {
     return *camera_state_;
 }
 
+FrameSync& AppState::frame_sync() {
+    return *frame_sync_;
+}
+
+LatencyStats& AppState::latency_stats() {
+    return *latency_stats_;
+}
+
+void AppState::set_lossless_frame_queues(bool lossless) {
+    for (int i = 0; i < MAX_CAMERAS; ++i) {
+        if (lossless) {
+            frame_buffers_[i]->configure_queue(FRAME_QUEUE_DEPTH, video::FrameQueuePolicy::Block,
+                                               LOSSLESS_BLOCK_TIMEOUT_US);
+        } else {
+            frame_buffers_[i]->configure_queue(FRAME_QUEUE_DEPTH, video::FrameQueuePolicy::DropNewest);
+        }
+    }
+}
+
 bool AppState::is_running() const {
     return running_.load();
 }
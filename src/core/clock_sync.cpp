@@ -0,0 +1,152 @@
+#include "core/clock_sync.h"
+#include <algorithm>
+#include <cmath>
+
+namespace core {
+
+namespace {
+
+// Fewer buckets than this span too little time to tell drift from noise
+constexpr int MIN_DRIFT_POINTS = 16;
+
+} // namespace
+
+void ClockSync::add_sample(int64_t sensor_us, int64_t host_us) {
+    const int64_t offset = host_us - sensor_us;
+
+    if (bucket_.offset_us != NO_POINT && host_us >= bucket_end_us_) {
+        // Close the bucket: its minimum joins the fit
+        points_[next_point_] = bucket_;
+        next_point_ = (next_point_ + 1) % BUCKET_COUNT;
+        point_count_ = std::min(point_count_ + 1, BUCKET_COUNT);
+        bucket_.offset_us = NO_POINT;
+        refit();
+    }
+
+    if (bucket_.offset_us == NO_POINT) {
+        bucket_ = Point{sensor_us, offset};
+        bucket_end_us_ = host_us + BUCKET_US;
+    } else if (offset < bucket_.offset_us) {
+        bucket_ = Point{sensor_us, offset};
+    } else {
+        return;
+    }
+
+    // Until the first bucket closes, map with the best offset so far
+    if (point_count_ == 0) {
+        Model model;
+        model.reference_us = bucket_.sensor_us;
+        model.offset_us = static_cast<double>(bucket_.offset_us);
+        publish(model);
+    }
+}
+
+void ClockSync::reset() {
+    point_count_ = 0;
+    next_point_ = 0;
+    bucket_ = Point{0, NO_POINT};
+    bucket_end_us_ = 0;
+    fit_points_.store(0, std::memory_order_relaxed);
+    seq_.store(0, std::memory_order_release);
+}
+
+void ClockSync::refit() {
+    Model model;
+    fit_points_.store(point_count_, std::memory_order_relaxed);
+
+    if (point_count_ < MIN_DRIFT_POINTS) {
+        // Too short a baseline for drift: lowest offset seen, as a fixed mapping
+        const auto lowest = std::min_element(points_.begin(), points_.begin() + point_count_,
+            [](const Point& a, const Point& b) { return a.offset_us < b.offset_us; });
+        model.reference_us = lowest->sensor_us;
+        model.offset_us = static_cast<double>(lowest->offset_us);
+        publish(model);
+        return;
+    }
+
+    // Least squares around the mean, in doubles relative to the first point
+    const int64_t origin = points_[0].sensor_us;
+    double mean_x = 0.0;
+    double mean_y = 0.0;
+    for (int i = 0; i < point_count_; ++i) {
+        mean_x += static_cast<double>(points_[i].sensor_us - origin);
+        mean_y += static_cast<double>(points_[i].offset_us);
+    }
+    mean_x /= point_count_;
+    mean_y /= point_count_;
+
+    double sxx = 0.0;
+    double sxy = 0.0;
+    for (int i = 0; i < point_count_; ++i) {
+        const double dx = static_cast<double>(points_[i].sensor_us - origin) - mean_x;
+        sxx += dx * dx;
+        sxy += dx * (static_cast<double>(points_[i].offset_us) - mean_y);
+    }
+    model.drift = sxx > 0.0 ? sxy / sxx : 0.0;
+    model.reference_us = origin + static_cast<int64_t>(std::llround(mean_x));
+    model.offset_us = mean_y;
+
+    // Lower the line onto the least-delayed point: arrivals are never early,
+    // so the fit should bound them from below rather than pass through them
+    double lowest_residual = 0.0;
+    for (int i = 0; i < point_count_; ++i) {
+        const double fitted = model.offset_us + model.drift * static_cast<double>(points_[i].sensor_us - model.reference_us);
+        lowest_residual = std::min(lowest_residual, static_cast<double>(points_[i].offset_us) - fitted);
+    }
+    model.offset_us += lowest_residual;
+    publish(model);
+}
+
+void ClockSync::publish(const Model& model) {
+    const uint32_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq | 1, std::memory_order_relaxed);  // Odd: readers retry
+    std::atomic_thread_fence(std::memory_order_release);
+    reference_us_.store(model.reference_us, std::memory_order_relaxed);
+    offset_us_.store(model.offset_us, std::memory_order_relaxed);
+    drift_.store(model.drift, std::memory_order_relaxed);
+    seq_.store((seq | 1) + 1, std::memory_order_release);
+}
+
+ClockSync::Model ClockSync::load() const {
+    Model model;
+    for (;;) {
+        const uint32_t before = seq_.load(std::memory_order_acquire);
+        if (before == 0) {
+            return Model();
+        }
+        if (before & 1) {
+            continue;
+        }
+        model.reference_us = reference_us_.load(std::memory_order_relaxed);
+        model.offset_us = offset_us_.load(std::memory_order_relaxed);
+        model.drift = drift_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq_.load(std::memory_order_relaxed) == before) {
+            return model;
+        }
+    }
+}
+
+int64_t ClockSync::to_host_us(int64_t sensor_us) const {
+    if (!is_valid()) {
+        return 0;
+    }
+    const Model model = load();
+    return sensor_us + std::llround(model.offset_us + model.drift * static_cast<double>(sensor_us - model.reference_us));
+}
+
+int64_t ClockSync::to_sensor_us(int64_t host_us) const {
+    if (!is_valid()) {
+        return 0;
+    }
+    // host - reference - offset = (sensor - reference) * (1 + drift)
+    const Model model = load();
+    const double elapsed = static_cast<double>(host_us - model.reference_us) - model.offset_us;
+    return model.reference_us + std::llround(elapsed / (1.0 + model.drift));
+}
+
+double ClockSync::get_drift_ppm() const {
+    return load().drift * 1e6;
+}
+
+} // namespace core
@@ -71,6 +71,14 @@ DisplaySettings::DisplayMode DisplaySettings::get_display_mode() const {
     return static_cast<DisplayMode>(display_mode_.load());
 }
 
+void DisplaySettings::set_time_surface_decay_us(int decay_us) {
+    time_surface_decay_us_.store(decay_us);
+}
+
+int DisplaySettings::get_time_surface_decay_us() const {
+    return time_surface_decay_us_.load();
+}
+
 void DisplaySettings::set_red_pixel_percentage(float percentage) {
     red_pixel_percentage_.store(percentage);
 }
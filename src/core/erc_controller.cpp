@@ -0,0 +1,62 @@
+#include "core/erc_controller.h"
+#include <algorithm>
+
+namespace core {
+
+void ErcController::reset(const Settings& settings, int start_rate_kevps) {
+    settings_ = settings;
+    settings_.min_rate_kevps = std::max(1, settings_.min_rate_kevps);
+    settings_.max_rate_kevps = std::max(settings_.min_rate_kevps, settings_.max_rate_kevps);
+    settings_.low_water_percent = std::min(settings_.low_water_percent, settings_.high_water_percent);
+    rate_kevps_ = clamp(start_rate_kevps);
+    calm_intervals_ = 0;
+}
+
+ErcController::Action ErcController::update(const Sample& sample) {
+    if (sample.interval_s <= 0.0) {
+        return Action::Hold;
+    }
+
+    const double delivered_kevps = sample.events / sample.interval_s / 1000.0;
+
+    if (sample.dropped_events > 0 || sample.peak_fill_percent >= settings_.high_water_percent) {
+        // Aim below what actually got through, not just below the old cap,
+        // so one step is enough even when the cap was far too high
+        calm_intervals_ = 0;
+        const double base = std::min<double>(rate_kevps_, delivered_kevps);
+        const int target = clamp(static_cast<int64_t>(base * (100 - settings_.decrease_percent) / 100.0));
+        if (target >= rate_kevps_) {
+            return Action::Hold;  // Already at the floor
+        }
+        rate_kevps_ = target;
+        return Action::Decrease;
+    }
+
+    if (sample.peak_fill_percent > settings_.low_water_percent) {
+        calm_intervals_ = 0;
+        return Action::Hold;
+    }
+
+    // Raising only pays off if the cap is what limits the rate (a dark scene
+    // far below the cap would otherwise walk it to the maximum)
+    if (++calm_intervals_ < settings_.hold_intervals ||
+            delivered_kevps * 100.0 < static_cast<double>(rate_kevps_) * settings_.binding_percent) {
+        return Action::Hold;
+    }
+
+    calm_intervals_ = 0;
+    const int64_t step = std::max<int64_t>(1, static_cast<int64_t>(rate_kevps_) * settings_.increase_percent / 100);
+    const int target = clamp(rate_kevps_ + step);
+    if (target == rate_kevps_) {
+        return Action::Hold;  // Already at the ceiling
+    }
+    rate_kevps_ = target;
+    return Action::Increase;
+}
+
+int ErcController::clamp(int64_t rate_kevps) const {
+    return static_cast<int>(std::min<int64_t>(std::max<int64_t>(rate_kevps, settings_.min_rate_kevps),
+                                              settings_.max_rate_kevps));
+}
+
+} // namespace core
@@ -0,0 +1,381 @@
+#include "core/fleet_aggregator.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using socket_t = SOCKET;
+static inline void close_socket(socket_t s) { closesocket(s); }
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using socket_t = int;
+static inline void close_socket(socket_t s) { ::close(s); }
+#endif
+
+namespace core {
+
+namespace {
+
+constexpr intptr_t NO_SOCKET = -1;
+constexpr int POLL_MS = 200;        // Bounds how long stop() waits
+constexpr int SHARD_IDLE_MS = 10;   // Shard sleep when its ring is empty (reports arrive about once a second)
+
+socket_t as_socket(intptr_t s) { return static_cast<socket_t>(s); }
+
+bool wait_readable(socket_t s, int timeout_ms) {
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(s, &set);
+    timeval timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+    return select(static_cast<int>(s) + 1, &set, nullptr, nullptr, &timeout) > 0;
+}
+
+int64_t steady_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+FleetAggregator::~FleetAggregator() {
+    stop();
+}
+
+std::string FleetAggregator::sanitize(const std::string& id) {
+    std::string result = id.empty() ? "unknown" : id;
+    for (char& c : result) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') {
+            c = '_';
+        }
+    }
+    return result;
+}
+
+bool FleetAggregator::start(const Options& options) {
+    stop();
+    options_ = options;
+    options_.shards = std::clamp(options_.shards, 1, MAX_SHARDS);
+    options_.stale_s = std::max(options_.stale_s, 1);
+
+    if (!options_.directory.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(options_.directory, error);
+        if (error) {
+            std::cerr << "FleetAggregator: Cannot create " << options_.directory << ": " << error.message() << std::endl;
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        std::cerr << "FleetAggregator: WSAStartup failed" << std::endl;
+        return false;
+    }
+    winsock_started_ = true;
+#endif
+
+    socket_t s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == as_socket(NO_SOCKET)) {
+        std::cerr << "FleetAggregator: Failed to create socket" << std::endl;
+        stop();
+        return false;
+    }
+
+    // A dozen stations bursting at the same second fit in the kernel buffer
+    int buffer_bytes = 1 << 20;
+    setsockopt(s, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&buffer_bytes), sizeof(buffer_bytes));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(options_.port));
+    if (bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "FleetAggregator: Cannot listen on UDP port " << options_.port << std::endl;
+        close_socket(s);
+        stop();
+        return false;
+    }
+    socket_ = static_cast<intptr_t>(s);
+
+    received_ = 0;
+    dropped_ = 0;
+    rejected_ = 0;
+    running_ = true;
+    for (int i = 0; i < options_.shards; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->ring = std::make_unique<fleet::Report[]>(RING_CAPACITY);
+        shards_.push_back(std::move(shard));
+    }
+    for (auto& shard : shards_) {
+        shard->thread = std::thread(&FleetAggregator::shard_loop, this, std::ref(*shard));
+    }
+    receive_thread_ = std::thread(&FleetAggregator::receive_loop, this);
+
+    std::cout << "Fleet: aggregating station reports on UDP port " << options_.port << " (" << options_.shards
+              << " shards";
+    if (!options_.directory.empty()) {
+        std::cout << ", histories in " << options_.directory;
+    }
+    std::cout << ")" << std::endl;
+    return true;
+}
+
+void FleetAggregator::stop() {
+    running_ = false;
+    if (receive_thread_.joinable()) {
+        receive_thread_.join();
+    }
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+    shards_.clear();  // Closes the histories
+    if (socket_ != NO_SOCKET) {
+        close_socket(as_socket(socket_));
+        socket_ = NO_SOCKET;
+    }
+#ifdef _WIN32
+    if (winsock_started_) {
+        WSACleanup();
+    }
+#endif
+    winsock_started_ = false;
+}
+
+int FleetAggregator::get_sensor_count() const {
+    int count = 0;
+    for (const auto& shard : shards_) {
+        count += shard->sensor_count.load(std::memory_order_acquire);
+    }
+    return count;
+}
+
+void FleetAggregator::receive_loop() {
+    const socket_t s = as_socket(socket_);
+    const std::hash<std::string> hash;
+    uint8_t datagram[fleet::MAX_REPORT_BYTES + 1];
+    fleet::Report report;
+    int64_t next_publish_ms = steady_ms() + 1000;
+
+    while (running_.load()) {
+        if (steady_ms() >= next_publish_ms) {
+            publish_fleet();
+            next_publish_ms += 1000;
+        }
+        if (!wait_readable(s, POLL_MS)) {
+            continue;
+        }
+
+        const int size = static_cast<int>(recv(s, reinterpret_cast<char*>(datagram), sizeof(datagram), 0));
+        if (size <= 0 || !fleet::decode(datagram, static_cast<size_t>(size), report)) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        received_.fetch_add(1, std::memory_order_relaxed);
+
+        // Sensor key: its serial, or station and camera when the station could not read one
+        std::string id = fleet::get_id(report.header.sensor);
+        if (id.empty()) {
+            id = fleet::get_id(report.header.station) + "_cam" + std::to_string(report.header.camera_index);
+            fleet::set_id(report.header.sensor, id);
+        }
+
+        // Single producer: only this thread advances head
+        Shard& shard = *shards_[hash(id) % shards_.size()];
+        const uint64_t head = shard.head.load(std::memory_order_relaxed);
+        if (head - shard.tail.load(std::memory_order_acquire) >= RING_CAPACITY) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        shard.ring[head & (RING_CAPACITY - 1)] = report;
+        shard.head.store(head + 1, std::memory_order_release);
+    }
+}
+
+void FleetAggregator::shard_loop(Shard& shard) {
+    while (running_.load()) {
+        const uint64_t head = shard.head.load(std::memory_order_acquire);
+        uint64_t tail = shard.tail.load(std::memory_order_relaxed);
+        if (tail == head) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(SHARD_IDLE_MS));
+            continue;
+        }
+        for (; tail != head; ++tail) {
+            ingest(shard, shard.ring[tail & (RING_CAPACITY - 1)]);
+            shard.tail.store(tail + 1, std::memory_order_release);
+        }
+
+        // Histories are written in batches, whenever the ring runs dry
+        const int count = shard.sensor_count.load(std::memory_order_relaxed);
+        for (int i = 0; i < count; ++i) {
+            if (shard.sensors[i]->history.is_open()) {
+                shard.sensors[i]->history.flush();
+            }
+        }
+    }
+}
+
+FleetAggregator::Sensor* FleetAggregator::find_or_add(Shard& shard, const std::string& id) {
+    const int count = shard.sensor_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+        if (shard.sensors[i]->id == id) {
+            return shard.sensors[i].get();
+        }
+    }
+    if (count == MAX_SENSORS_PER_SHARD) {
+        return nullptr;
+    }
+
+    auto sensor = std::make_unique<Sensor>();
+    sensor->id = id;
+    const std::string name = sanitize(id);
+    auto& registry = MetricsRegistry::instance();
+    sensor->event_rate_gauge = &registry.gauge("fleet." + name + ".event_rate");
+    sensor->scattering_gauge = &registry.gauge("fleet." + name + ".scattering_percent");
+    sensor->temperature_gauge = &registry.gauge("fleet." + name + ".temperature_c");
+    sensor->hot_pixel_gauge = &registry.gauge("fleet." + name + ".hot_pixel_count");
+
+    if (!options_.directory.empty()) {
+        const std::filesystem::path path = std::filesystem::path(options_.directory) / (name + ".csv");
+        const bool fresh = !std::filesystem::exists(path);
+        sensor->history.open(path, std::ios::app);
+        if (!sensor->history) {
+            std::cerr << "FleetAggregator: Cannot open " << path.string() << std::endl;
+        } else if (fresh) {
+            sensor->history << "unix_ms,station,camera,sequence,event_rate,scattering_percent,scattering_per_frame,"
+                               "temperature_c,frames_analyzed,hot_pixels\n";
+        }
+    }
+
+    std::cout << "Fleet: new sensor " << id << std::endl;
+    shard.sensors[count] = std::move(sensor);
+    shard.sensor_count.store(count + 1, std::memory_order_release);
+    return shard.sensors[count].get();
+}
+
+void FleetAggregator::ingest(Shard& shard, const fleet::Report& report) {
+    const fleet::ReportHeader& header = report.header;
+    Sensor* sensor = find_or_add(shard, fleet::get_id(header.sensor));
+    if (sensor == nullptr) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Sequence gaps are datagrams lost on the way (a restarted station starts again from 0)
+    if (sensor->last_seen_ms.load(std::memory_order_relaxed) != 0 && header.sequence > sensor->last_sequence + 1) {
+        static Counter& lost = MetricsRegistry::instance().counter("fleet.reports_lost");
+        lost.add(header.sequence - sensor->last_sequence - 1);
+    }
+    sensor->last_sequence = header.sequence;
+
+    const bool has_scattering = (header.flags & fleet::HAS_SCATTERING) != 0;
+    const bool has_temperature = (header.flags & fleet::HAS_TEMPERATURE) != 0;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    sensor->event_rate.store(header.event_rate, std::memory_order_relaxed);
+    sensor->scattering_percent.store(has_scattering ? header.scattering_percent : nan, std::memory_order_relaxed);
+    sensor->temperature_c.store(has_temperature ? header.temperature_c : nan, std::memory_order_relaxed);
+    sensor->last_seen_ms.store(steady_ms(), std::memory_order_release);
+
+    sensor->event_rate_gauge->set(header.event_rate);
+    if (has_scattering) {
+        sensor->scattering_gauge->set(header.scattering_percent);
+        sensor->hot_pixel_gauge->set(header.hot_pixel_count);
+    }
+    if (has_temperature) {
+        sensor->temperature_gauge->set(header.temperature_c);
+    }
+
+    if (sensor->history.is_open()) {
+        std::ostream& out = sensor->history;
+        out << header.unix_ms << ',' << fleet::get_id(header.station) << ',' << header.camera_index << ','
+            << header.sequence << ',' << header.event_rate << ',';
+        if (has_scattering) {
+            out << header.scattering_percent << ',' << header.scattering_per_frame;
+        } else {
+            out << ',';
+        }
+        out << ',';
+        if (has_temperature) {
+            out << header.temperature_c;
+        }
+        out << ',' << header.frames_analyzed << ',';
+
+        // "x:y:count" separated by spaces, worst first
+        for (int i = 0; i < header.hot_pixel_count; ++i) {
+            const fleet::HotPixelEntry& pixel = report.hot_pixels[i];
+            out << (i == 0 ? "" : " ") << pixel.x << ':' << pixel.y << ':' << pixel.count;
+        }
+        out << '\n';
+    }
+}
+
+void FleetAggregator::publish_fleet() {
+    auto& registry = MetricsRegistry::instance();
+    static Gauge& sensors_gauge = registry.gauge("fleet.sensors");
+    static Gauge& event_rate_gauge = registry.gauge("fleet.event_rate_total");
+    static Gauge& scattering_mean_gauge = registry.gauge("fleet.scattering_percent_mean");
+    static Gauge& scattering_max_gauge = registry.gauge("fleet.scattering_percent_max");
+    static Gauge& temperature_max_gauge = registry.gauge("fleet.temperature_max_c");
+
+    const int64_t fresh_after = steady_ms() - static_cast<int64_t>(options_.stale_s) * 1000;
+    int live = 0;
+    int scattering_count = 0;
+    double event_rate = 0.0;
+    double scattering_sum = 0.0;
+    double scattering_max = 0.0;
+    double temperature_max = -std::numeric_limits<double>::infinity();
+
+    for (const auto& shard : shards_) {
+        const int count = shard->sensor_count.load(std::memory_order_acquire);
+        for (int i = 0; i < count; ++i) {
+            const Sensor& sensor = *shard->sensors[i];
+            if (sensor.last_seen_ms.load(std::memory_order_acquire) < fresh_after) {
+                continue;
+            }
+            ++live;
+            event_rate += sensor.event_rate.load(std::memory_order_relaxed);
+            const float scattering = sensor.scattering_percent.load(std::memory_order_relaxed);
+            if (!std::isnan(scattering)) {
+                scattering_sum += scattering;
+                scattering_max = std::max<double>(scattering_max, scattering);
+                ++scattering_count;
+            }
+            const float temperature = sensor.temperature_c.load(std::memory_order_relaxed);
+            if (!std::isnan(temperature)) {
+                temperature_max = std::max<double>(temperature_max, temperature);
+            }
+        }
+    }
+
+    sensors_gauge.set(live);
+    event_rate_gauge.set(event_rate);
+    if (scattering_count > 0) {
+        scattering_mean_gauge.set(scattering_sum / scattering_count);
+        scattering_max_gauge.set(scattering_max);
+    } else {
+        scattering_mean_gauge.reset();
+        scattering_max_gauge.reset();
+    }
+    if (std::isfinite(temperature_max)) {
+        temperature_max_gauge.set(temperature_max);
+    } else {
+        temperature_max_gauge.reset();
+    }
+}
+
+} // namespace core
@@ -0,0 +1,163 @@
+#include "core/fleet_report.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using socket_t = SOCKET;
+static inline void close_socket(socket_t s) { closesocket(s); }
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using socket_t = int;
+static inline void close_socket(socket_t s) { ::close(s); }
+#endif
+
+namespace core {
+
+namespace {
+
+constexpr intptr_t NO_SOCKET = -1;
+
+socket_t as_socket(intptr_t s) { return static_cast<socket_t>(s); }
+
+} // namespace
+
+// ============================================================================
+// Datagram format
+// ============================================================================
+
+namespace fleet {
+
+size_t encode(const Report& report, uint8_t* out) {
+    ReportHeader header = report.header;
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.hot_pixel_count = static_cast<uint16_t>(std::min<int>(header.hot_pixel_count, MAX_HOT_PIXELS));
+
+    std::memcpy(out, &header, sizeof(header));
+    const size_t hot_bytes = header.hot_pixel_count * sizeof(HotPixelEntry);
+    std::memcpy(out + sizeof(header), report.hot_pixels, hot_bytes);
+    return sizeof(header) + hot_bytes;
+}
+
+bool decode(const uint8_t* data, size_t size, Report& out) {
+    if (size < sizeof(ReportHeader)) {
+        return false;
+    }
+    std::memcpy(&out.header, data, sizeof(ReportHeader));
+    if (out.header.magic != MAGIC || out.header.version != VERSION ||
+        out.header.hot_pixel_count > MAX_HOT_PIXELS ||
+        size < sizeof(ReportHeader) + out.header.hot_pixel_count * sizeof(HotPixelEntry)) {
+        return false;
+    }
+    std::memcpy(out.hot_pixels, data + sizeof(ReportHeader), out.header.hot_pixel_count * sizeof(HotPixelEntry));
+    return true;
+}
+
+void set_id(char (&field)[ID_LENGTH], const std::string& value) {
+    std::memset(field, 0, ID_LENGTH);
+    std::memcpy(field, value.data(), std::min<size_t>(value.size(), ID_LENGTH));
+}
+
+std::string get_id(const char (&field)[ID_LENGTH]) {
+    return std::string(field, strnlen(field, ID_LENGTH));
+}
+
+} // namespace fleet
+
+// ============================================================================
+// FleetReporter
+// ============================================================================
+
+FleetReporter::~FleetReporter() {
+    stop();
+}
+
+bool FleetReporter::start(const Options& options) {
+    stop();
+    options_ = options;
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        std::cerr << "FleetReporter: WSAStartup failed" << std::endl;
+        return false;
+    }
+    winsock_started_ = true;
+#endif
+
+    socket_t s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == as_socket(NO_SOCKET)) {
+        std::cerr << "FleetReporter: Failed to create socket" << std::endl;
+        stop();
+        return false;
+    }
+
+    // Connected UDP: plain send() per report, an unreachable aggregator is just ignored
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(options_.port));
+    if (inet_pton(AF_INET, options_.host.c_str(), &addr.sin_addr) != 1 ||
+        connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "FleetReporter: Invalid aggregator address " << options_.host << ":" << options_.port << std::endl;
+        close_socket(s);
+        stop();
+        return false;
+    }
+    socket_ = static_cast<intptr_t>(s);
+
+    if (options_.station.empty()) {
+        char host[256] = {};
+        options_.station = gethostname(host, sizeof(host) - 1) == 0 && host[0] != '\0' ? host : "station";
+    }
+    sequences_.fill(0);
+    sent_ = 0;
+    std::cout << "Fleet: reporting as \"" << options_.station << "\" to " << options_.host << ":" << options_.port
+              << std::endl;
+    return true;
+}
+
+void FleetReporter::stop() {
+    if (socket_ != NO_SOCKET) {
+        close_socket(as_socket(socket_));
+        socket_ = NO_SOCKET;
+    }
+#ifdef _WIN32
+    if (winsock_started_) {
+        WSACleanup();
+    }
+#endif
+    winsock_started_ = false;
+}
+
+bool FleetReporter::send(fleet::Report& report) {
+    if (socket_ == NO_SOCKET) {
+        return false;
+    }
+    fleet::set_id(report.header.station, options_.station);
+    report.header.sequence = sequences_[static_cast<size_t>(report.header.camera_index) % sequences_.size()]++;
+    if (report.header.unix_ms == 0) {
+        report.header.unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    uint8_t datagram[fleet::MAX_REPORT_BYTES];
+    const size_t size = fleet::encode(report, datagram);
+    if (::send(as_socket(socket_), reinterpret_cast<const char*>(datagram), static_cast<int>(size), 0) !=
+        static_cast<int>(size)) {
+        return false;
+    }
+    sent_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace core
@@ -0,0 +1,319 @@
+#include "core/flight_recorder.h"
+#include "core/latency_stats.h"
+#include "core/log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace core {
+
+namespace {
+
+constexpr int64_t WATCHDOG_PERIOD_MS = 50;
+
+/**
+ * Interval between two stamps (-1 if either is missing)
+ */
+int32_t interval_us(int64_t from_us, int64_t to_us) {
+    if (from_us <= 0 || to_us <= 0 || to_us < from_us) {
+        return -1;
+    }
+    return static_cast<int32_t>(std::min<int64_t>(to_us - from_us, std::numeric_limits<int32_t>::max()));
+}
+
+uint32_t clamp_u32(size_t value) {
+    return static_cast<uint32_t>(std::min<size_t>(value, std::numeric_limits<uint32_t>::max()));
+}
+
+std::string file_timestamp() {
+    const std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::tm tm;
+#ifdef _WIN32
+    localtime_s(&tm, &now);
+#else
+    localtime_r(&now, &tm);
+#endif
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H-%M-%S", &tm);
+    return buffer;
+}
+
+const char* kind_name(FlightRecorder::Kind kind) {
+    switch (kind) {
+        case FlightRecorder::Kind::Frame: return "frame";
+        case FlightRecorder::Kind::Analysis: return "analysis";
+        case FlightRecorder::Kind::Drop: return "drop";
+    }
+    return "?";
+}
+
+} // namespace
+
+FlightRecorder& FlightRecorder::instance() {
+    static FlightRecorder recorder;
+    return recorder;
+}
+
+FlightRecorder::FlightRecorder()
+    : ring_(new Slot[RING_RECORDS]),
+      dumps_metric_(MetricsRegistry::instance().counter("flight.dumps")),
+      triggers_metric_(MetricsRegistry::instance().counter("flight.triggers")) {
+    static_assert((RING_RECORDS & (RING_RECORDS - 1)) == 0, "RING_RECORDS must be a power of two");
+}
+
+FlightRecorder::~FlightRecorder() {
+    stop();
+}
+
+void FlightRecorder::start(const Options& options) {
+    if (running_.load()) {
+        return;
+    }
+    options_ = options;
+    config_text_.clear();
+    if (!options_.config_path.empty()) {
+        std::ifstream file(options_.config_path);
+        std::ostringstream text;
+        text << file.rdbuf();
+        config_text_ = text.str();
+    }
+    last_frame_us_ = 0;
+    gap_reported_ = false;
+    last_dump_us_ = 0;
+
+    running_ = true;
+    watchdog_ = std::thread(&FlightRecorder::watchdog_loop, this);
+}
+
+void FlightRecorder::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    wake_cv_.notify_all();
+    if (watchdog_.joinable()) {
+        watchdog_.join();
+    }
+}
+
+uint16_t FlightRecorder::source_id(const std::string& name) {
+    std::lock_guard<std::mutex> lock(sources_mutex_);
+    auto it = std::find(sources_.begin(), sources_.end(), name);
+    if (it != sources_.end()) {
+        return static_cast<uint16_t>(it - sources_.begin());
+    }
+    sources_.push_back(name);
+    return static_cast<uint16_t>(sources_.size() - 1);
+}
+
+void FlightRecorder::write(const Record& record) {
+    const uint64_t n = head_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = ring_[n & (RING_RECORDS - 1)];
+    slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.record = record;
+    slot.sequence.store(2 * n + 2, std::memory_order_release);
+}
+
+void FlightRecorder::check_latency(int32_t total_us) {
+    if (options_.spike_ms > 0 && total_us > static_cast<int64_t>(options_.spike_ms) * 1000) {
+        trigger("spike");
+    }
+}
+
+void FlightRecorder::record_frame(const video::FrameTiming& timing, int64_t consumed_us,
+                                  int64_t uploaded_us, int64_t swapped_us) {
+    if (!running_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    Record record;
+    record.kind = Kind::Frame;
+    record.host_us = timing.callback_us > 0 ? timing.callback_us : consumed_us;
+    record.frame_index = timing.frame_index;
+    record.stage_us = {interval_us(timing.callback_us, timing.extracted_us),
+                       interval_us(timing.extracted_us, timing.stored_us),
+                       interval_us(timing.stored_us, consumed_us),
+                       interval_us(consumed_us, uploaded_us),
+                       interval_us(uploaded_us, swapped_us)};
+    record.total_us = interval_us(timing.callback_us, std::max({consumed_us, uploaded_us, swapped_us}));
+    write(record);
+
+    last_frame_us_.store(consumed_us, std::memory_order_relaxed);
+    check_latency(record.total_us);
+}
+
+void FlightRecorder::record_analysis(const video::FrameTiming& timing, int camera, int64_t done_us,
+                                     size_t backlog, size_t capacity) {
+    if (!running_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    Record record;
+    record.kind = Kind::Analysis;
+    record.host_us = timing.callback_us > 0 ? timing.callback_us : done_us;
+    record.frame_index = timing.frame_index;
+    record.camera = static_cast<uint8_t>(camera);
+    record.stage_us = {interval_us(timing.callback_us, timing.extracted_us),
+                       interval_us(timing.extracted_us, timing.stored_us),
+                       interval_us(timing.stored_us, done_us),
+                       -1,
+                       -1};
+    record.total_us = interval_us(timing.callback_us, done_us);
+    record.value = clamp_u32(backlog);
+    record.capacity = clamp_u32(capacity);
+    write(record);
+
+    last_frame_us_.store(done_us, std::memory_order_relaxed);
+    check_latency(record.total_us);
+}
+
+void FlightRecorder::record_drop(uint16_t source, int64_t count) {
+    if (!running_.load(std::memory_order_relaxed) || count <= 0) {
+        return;
+    }
+    Record record;
+    record.kind = Kind::Drop;
+    record.host_us = LatencyStats::now_us();
+    record.stage_us = {-1, -1, -1, -1, -1};
+    record.source = source;
+    record.value = static_cast<uint32_t>(std::min<int64_t>(count, std::numeric_limits<uint32_t>::max()));
+    write(record);
+}
+
+void FlightRecorder::trigger(const std::string& reason) {
+    if (!running_.load(std::memory_order_relaxed) || pending_.load(std::memory_order_acquire)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(trigger_mutex_);
+        if (pending_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        pending_reason_ = reason;
+        pending_us_ = LatencyStats::now_us();
+        pending_.store(true, std::memory_order_release);
+    }
+    triggers_metric_.add();
+}
+
+std::string FlightRecorder::get_last_dump() const {
+    std::lock_guard<std::mutex> lock(trigger_mutex_);
+    return last_dump_;
+}
+
+void FlightRecorder::watchdog_loop() {
+    for (;;) {
+        const bool running = running_.load();
+        const int64_t now_us = LatencyStats::now_us();
+
+        // A gap counts once until frames flow again; before the first frame there is nothing to miss
+        const int64_t last_us = last_frame_us_.load(std::memory_order_relaxed);
+        if (running && options_.gap_ms > 0 && last_us > 0) {
+            const bool gap = now_us - last_us > static_cast<int64_t>(options_.gap_ms) * 1000;
+            if (gap && !gap_reported_) {
+                trigger("gap");
+            }
+            gap_reported_ = gap;
+        }
+
+        if (pending_.load(std::memory_order_acquire)) {
+            std::string reason;
+            int64_t trigger_us = 0;
+            {
+                std::lock_guard<std::mutex> lock(trigger_mutex_);
+                reason = pending_reason_;
+                trigger_us = pending_us_;
+            }
+            // Let the recovery be recorded too, unless shutting down
+            if (!running || now_us - trigger_us >= static_cast<int64_t>(options_.post_trigger_ms) * 1000) {
+                const bool cooled = last_dump_us_ == 0 ||
+                    trigger_us - last_dump_us_ >= static_cast<int64_t>(options_.cooldown_s) * 1000000;
+                if (cooled && dumps_.load() < options_.max_dumps) {
+                    dump(reason, trigger_us);
+                    last_dump_us_ = trigger_us;
+                }
+                pending_.store(false, std::memory_order_release);
+            }
+        }
+
+        if (!running) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_cv_.wait_for(lock, std::chrono::milliseconds(WATCHDOG_PERIOD_MS), [this] { return !running_.load(); });
+    }
+}
+
+void FlightRecorder::dump(const std::string& reason, int64_t trigger_us) {
+    // Copy what is complete; a slot being rewritten under us reads as a changed sequence and is skipped
+    const int64_t begin_us = trigger_us - static_cast<int64_t>(options_.window_s) * 1000000;
+    std::vector<Record> records;
+    records.reserve(RING_RECORDS);
+    for (size_t i = 0; i < RING_RECORDS; ++i) {
+        const Slot& slot = ring_[i];
+        const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before == 0 || (before & 1) != 0) {
+            continue;
+        }
+        const Record record = slot.record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before || record.host_us < begin_us) {
+            continue;
+        }
+        records.push_back(record);
+    }
+    std::sort(records.begin(), records.end(),
+              [](const Record& a, const Record& b) { return a.host_us < b.host_us; });
+
+    std::vector<std::string> sources;
+    {
+        std::lock_guard<std::mutex> lock(sources_mutex_);
+        sources = sources_;
+    }
+
+    std::error_code error;
+    const std::filesystem::path directory = options_.directory.empty() ? "." : options_.directory;
+    std::filesystem::create_directories(directory, error);
+    const std::string stem = (directory / ("flight_" + file_timestamp() + "_" + reason)).string();
+
+    std::ofstream file(stem + ".csv");
+    if (!file.is_open()) {
+        LogLine(LogLevel::Error) << "Flight recorder: cannot write " << stem << ".csv";
+        return;
+    }
+    file << "# Flight recorder dump: " << reason << ", " << records.size() << " records over the last "
+         << options_.window_s << " s (time_ms relative to the trigger)\n";
+    file << "time_ms,kind,camera,source,frame_index,extract_us,store_us,queue_us,upload_us,present_us,"
+            "total_us,value,capacity\n";
+    char line[256];
+    for (const Record& record : records) {
+        const char* source = record.kind == Kind::Drop && record.source < sources.size()
+                                 ? sources[record.source].c_str() : "";
+        std::snprintf(line, sizeof(line), "%.3f,%s,%d,%s,%lld,%d,%d,%d,%d,%d,%d,%u,%u\n",
+                      (record.host_us - trigger_us) / 1000.0, kind_name(record.kind), record.camera, source,
+                      static_cast<long long>(record.frame_index), record.stage_us[0], record.stage_us[1],
+                      record.stage_us[2], record.stage_us[3], record.stage_us[4], record.total_us,
+                      record.value, record.capacity);
+        file << line;
+    }
+    file.close();
+
+    if (!config_text_.empty()) {
+        std::ofstream config(stem + ".ini");
+        config << config_text_;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(trigger_mutex_);
+        last_dump_ = stem + ".csv";
+    }
+    dumps_.fetch_add(1);
+    dumps_metric_.add();
+    LogLine(LogLevel::Warning) << "Flight recorder: " << reason << ", wrote " << records.size()
+                               << " records to " << stem << ".csv";
+}
+
+} // namespace core
@@ -0,0 +1,170 @@
+#include "core/frame_log.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+namespace core {
+
+namespace {
+
+size_t round_up_pow2(size_t value) {
+    size_t pow2 = 1;
+    while (pow2 < value) {
+        pow2 <<= 1;
+    }
+    return pow2;
+}
+
+template <typename T>
+void store(T* column, size_t slot, size_t capacity, T value) {
+    column[slot] = value;
+    column[slot + capacity] = value;
+}
+
+/**
+ * Copy the newest count values ending at row end (contiguous thanks to the mirror)
+ */
+template <typename T>
+void copy_newest(const T* column, uint64_t end, size_t count, size_t mask, std::vector<T>& out) {
+    const size_t capacity = mask + 1;
+    out.resize(count);
+    if (count > 0) {
+        std::memcpy(out.data(), column + (end & mask) + capacity - count, count * sizeof(T));
+    }
+}
+
+} // namespace
+
+FrameLog::FrameLog(size_t capacity)
+    : capacity_(round_up_pow2(std::max<size_t>(capacity, 2)))
+    , mask_(capacity_ - 1) {
+    camera_ts_ = std::make_unique<int64_t[]>(2 * capacity_);
+    host_us_ = std::make_unique<int64_t[]>(2 * capacity_);
+    for (auto& column : columns_) {
+        column = std::make_unique<int32_t[]>(2 * capacity_);
+    }
+}
+
+void FrameLog::append(const FrameRecord& record) {
+    const uint64_t n = published_.load(std::memory_order_relaxed);
+    const size_t slot = static_cast<size_t>(n & mask_);
+
+    // Readers copying row n - capacity see it recycled and drop it
+    writing_.store(n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    store(camera_ts_.get(), slot, capacity_, record.camera_ts);
+    store(host_us_.get(), slot, capacity_, record.host_us);
+    store(columns_[WindowUs].get(), slot, capacity_, record.window_us);
+    store(columns_[Events].get(), slot, capacity_, record.events);
+    store(columns_[OnEvents].get(), slot, capacity_, record.on_events);
+    store(columns_[OffEvents].get(), slot, capacity_, record.off_events);
+    store(columns_[ActivePixels].get(), slot, capacity_, record.active_pixels);
+    store(columns_[ScatteringPixels].get(), slot, capacity_, record.scattering_pixels);
+    store(columns_[LatencyUs].get(), slot, capacity_, record.latency_us);
+
+    published_.store(n + 1, std::memory_order_release);
+}
+
+void FrameLog::clear() {
+    writing_.store(0, std::memory_order_relaxed);
+    published_.store(0, std::memory_order_release);
+}
+
+size_t FrameLog::stale_rows(uint64_t first, size_t count) const {
+    // Rows the writer started recycling while we copied are not ours any more
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t writing = writing_.load(std::memory_order_relaxed);
+    const uint64_t valid_from = writing > capacity_ ? writing - capacity_ : 0;
+    return valid_from > first ? static_cast<size_t>(std::min<uint64_t>(valid_from - first, count)) : 0;
+}
+
+size_t FrameLog::read(Snapshot& snapshot, size_t max_rows) const {
+    const uint64_t end = published_.load(std::memory_order_acquire);
+    size_t count = static_cast<size_t>(std::min<uint64_t>(end, capacity_));
+    if (max_rows > 0) {
+        count = std::min(count, max_rows);
+    }
+    const uint64_t first = end - count;
+
+    copy_newest(camera_ts_.get(), end, count, mask_, snapshot.camera_ts);
+    copy_newest(host_us_.get(), end, count, mask_, snapshot.host_us);
+    for (int c = 0; c < COLUMN_COUNT; ++c) {
+        copy_newest(columns_[c].get(), end, count, mask_, snapshot.columns[c]);
+    }
+
+    const size_t stale = stale_rows(first, count);
+    if (stale > 0) {
+        snapshot.camera_ts.erase(snapshot.camera_ts.begin(), snapshot.camera_ts.begin() + stale);
+        snapshot.host_us.erase(snapshot.host_us.begin(), snapshot.host_us.begin() + stale);
+        for (auto& column : snapshot.columns) {
+            column.erase(column.begin(), column.begin() + stale);
+        }
+    }
+    snapshot.first = first + stale;
+    return count - stale;
+}
+
+uint64_t FrameLog::read_column(Column column, std::vector<int32_t>& values, size_t max_rows) const {
+    const uint64_t end = published_.load(std::memory_order_acquire);
+    size_t count = static_cast<size_t>(std::min<uint64_t>(end, capacity_));
+    if (max_rows > 0) {
+        count = std::min(count, max_rows);
+    }
+    const uint64_t first = end - count;
+
+    copy_newest(columns_[column].get(), end, count, mask_, values);
+    const size_t stale = stale_rows(first, count);
+    values.erase(values.begin(), values.begin() + stale);
+    return first + stale;
+}
+
+FrameLog::Summary FrameLog::summarize(const std::vector<int32_t>& values, std::vector<int32_t>& scratch) {
+    Summary summary;
+
+    // Branch-free over the contiguous column so the compiler vectorizes it; -1 rows are masked out
+    const int32_t* v = values.data();
+    const size_t n = values.size();
+    int64_t sum = 0;
+    int64_t counted = 0;
+    constexpr int32_t NONE = std::numeric_limits<int32_t>::max();
+    int32_t min = NONE;
+    int32_t max = -1;
+    for (size_t i = 0; i < n; ++i) {
+        const int32_t valid = v[i] >= 0;
+        sum += valid ? v[i] : 0;
+        counted += valid;
+        min = std::min(min, valid ? v[i] : NONE);
+        max = std::max(max, v[i]);
+    }
+    if (counted == 0) {
+        return summary;
+    }
+    summary.count = static_cast<size_t>(counted);
+    summary.min = min;
+    summary.max = max;
+    summary.mean = static_cast<double>(sum) / counted;
+
+    scratch.clear();
+    scratch.reserve(n);
+    std::copy_if(values.begin(), values.end(), std::back_inserter(scratch), [](int32_t x) { return x >= 0; });
+    const auto rank = [&scratch](double p) {
+        const size_t k = std::min(scratch.size() - 1, static_cast<size_t>(p * (scratch.size() - 1) + 0.5));
+        std::nth_element(scratch.begin(), scratch.begin() + k, scratch.end());
+        return scratch[k];
+    };
+    summary.p99 = rank(0.99);
+    summary.p50 = rank(0.50);
+    return summary;
+}
+
+size_t FrameLog::count_above(const std::vector<int32_t>& values, int32_t threshold) {
+    size_t count = 0;
+    for (const int32_t value : values) {
+        count += value > threshold;
+    }
+    return count;
+}
+
+} // namespace core
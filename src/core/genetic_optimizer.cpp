@@ -0,0 +1,268 @@
+#include "core/genetic_optimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace core {
+
+namespace {
+
+void write_member(std::ostream& out, const char* tag, const GeneticOptimizer::Member& member) {
+    out << tag << " " << member.id << " " << member.fitness;
+    for (int value : member.values) {
+        out << " " << value;
+    }
+    out << "\n";
+}
+
+bool read_member(std::istringstream& in, size_t genes, GeneticOptimizer::Member& member) {
+    if (!(in >> member.id >> member.fitness)) {
+        return false;
+    }
+    member.values.resize(genes);
+    for (size_t i = 0; i < genes; ++i) {
+        if (!(in >> member.values[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool GeneticOptimizer::reset(const Settings& settings, const std::vector<Gene>& genes,
+                             const std::vector<int>& seed_values) {
+    if (genes.empty()) {
+        return false;
+    }
+    for (const Gene& gene : genes) {
+        if (gene.max_value < gene.min_value) {
+            return false;
+        }
+    }
+
+    settings_ = settings;
+    settings_.population_size = std::max(2, settings_.population_size);
+    settings_.generations = std::max(1, settings_.generations);
+    settings_.tournament_size = std::max(1, settings_.tournament_size);
+    genes_ = genes;
+
+    seed_values_.clear();
+    if (seed_values.size() == genes_.size()) {
+        for (size_t i = 0; i < genes_.size(); ++i) {
+            seed_values_.push_back(clamp_gene(i, seed_values[i]));
+        }
+    }
+
+    const uint32_t seed = settings_.seed != 0 ? settings_.seed
+        : static_cast<uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    rng_.seed(seed);
+
+    population_.clear();
+    best_ = Member();
+    proposed_ = 0;
+    evaluations_ = 0;
+    return true;
+}
+
+bool GeneticOptimizer::propose(Candidate& candidate) {
+    if (genes_.empty() || proposed_ >= get_budget()) {
+        return false;
+    }
+    candidate.id = proposed_++;
+
+    // Initial population: the seed, then random genomes. Also the fallback
+    // while too few results are back to select from.
+    if (candidate.id < settings_.population_size || population_.size() < 2) {
+        candidate.values = (candidate.id == 0 && !seed_values_.empty()) ? seed_values_ : random_genome();
+        return true;
+    }
+
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const Member& first = tournament();
+    candidate.values = first.values;
+
+    if (unit(rng_) < settings_.crossover_rate) {
+        const Member& second = tournament();
+        for (size_t i = 0; i < genes_.size(); ++i) {
+            if (unit(rng_) < 0.5) {
+                candidate.values[i] = second.values[i];
+            }
+        }
+    }
+
+    for (size_t i = 0; i < genes_.size(); ++i) {
+        if (unit(rng_) >= settings_.mutation_rate) {
+            continue;
+        }
+        const double range = static_cast<double>(genes_[i].max_value) - genes_[i].min_value;
+        std::normal_distribution<double> step(0.0, std::max(1.0, range * settings_.mutation_scale));
+        candidate.values[i] = clamp_gene(i, candidate.values[i] + std::llround(step(rng_)));
+    }
+    return true;
+}
+
+bool GeneticOptimizer::report(const Candidate& candidate, double fitness) {
+    if (candidate.values.size() != genes_.size() || !std::isfinite(fitness)) {
+        return false;
+    }
+    evaluations_++;
+
+    Member member{candidate.values, fitness, candidate.id};
+    if (static_cast<int>(population_.size()) < settings_.population_size) {
+        population_.push_back(member);
+    } else {
+        auto worst = std::min_element(population_.begin(), population_.end(),
+                                      [](const Member& a, const Member& b) { return a.fitness < b.fitness; });
+        if (worst->fitness < fitness) {
+            *worst = member;
+        }
+    }
+
+    if (!has_best() || fitness > best_.fitness) {
+        best_ = member;
+        return true;
+    }
+    return false;
+}
+
+bool GeneticOptimizer::save(const std::string& path) const {
+    const std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "GeneticOptimizer: Cannot write " << temp_path << std::endl;
+            return false;
+        }
+        file << std::setprecision(17);
+        file << "# Genetic optimizer checkpoint\n";
+        for (const Gene& gene : genes_) {
+            file << "gene " << gene.name << " " << gene.min_value << " " << gene.max_value << "\n";
+        }
+        file << "settings " << settings_.population_size << " " << settings_.generations << "\n";
+        file << "evaluations " << evaluations_ << "\n";
+        if (has_best()) {
+            write_member(file, "best", best_);
+        }
+        for (const Member& member : population_) {
+            write_member(file, "member", member);
+        }
+        file << "rng " << rng_ << "\n";
+        if (!file.good()) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        std::cerr << "GeneticOptimizer: Cannot replace " << path << ": " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool GeneticOptimizer::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::vector<Gene> genes;
+    std::vector<Member> population;
+    Member best;
+    int evaluations = 0;
+    int population_size = 0;
+    int generations = 0;
+    std::mt19937 rng;
+    bool has_rng = false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream in(line);
+        std::string tag;
+        in >> tag;
+        if (tag == "gene") {
+            Gene gene;
+            if (!(in >> gene.name >> gene.min_value >> gene.max_value)) return false;
+            genes.push_back(gene);
+        } else if (tag == "settings") {
+            if (!(in >> population_size >> generations)) return false;
+        } else if (tag == "evaluations") {
+            if (!(in >> evaluations)) return false;
+        } else if (tag == "best") {
+            if (!read_member(in, genes.size(), best)) return false;
+        } else if (tag == "member") {
+            Member member;
+            if (!read_member(in, genes.size(), member)) return false;
+            population.push_back(member);
+        } else if (tag == "rng") {
+            if (!(in >> rng)) return false;
+            has_rng = true;
+        }
+    }
+
+    // A checkpoint is only meaningful for the same search space
+    if (!has_rng || genes.size() != genes_.size()) {
+        std::cerr << "GeneticOptimizer: " << path << " is incomplete or for different genes" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < genes.size(); ++i) {
+        if (genes[i].name != genes_[i].name || genes[i].min_value != genes_[i].min_value ||
+            genes[i].max_value != genes_[i].max_value) {
+            std::cerr << "GeneticOptimizer: " << path << " is for different genes" << std::endl;
+            return false;
+        }
+    }
+    if (population_size != settings_.population_size) {
+        std::cout << "GeneticOptimizer: Checkpoint population " << population_size
+                  << " differs from the configured " << settings_.population_size << std::endl;
+    }
+
+    if (static_cast<int>(population.size()) > settings_.population_size) {
+        std::sort(population.begin(), population.end(),
+                  [](const Member& a, const Member& b) { return a.fitness > b.fitness; });
+        population.resize(settings_.population_size);
+    }
+    population_ = std::move(population);
+    best_ = best;
+    evaluations_ = evaluations;
+    proposed_ = evaluations;  // Candidates in flight at save time are proposed again
+    rng_ = rng;
+    return true;
+}
+
+int GeneticOptimizer::clamp_gene(size_t gene, int64_t value) const {
+    return static_cast<int>(std::min<int64_t>(std::max<int64_t>(value, genes_[gene].min_value),
+                                              genes_[gene].max_value));
+}
+
+const GeneticOptimizer::Member& GeneticOptimizer::tournament() {
+    std::uniform_int_distribution<size_t> pick(0, population_.size() - 1);
+    const Member* winner = &population_[pick(rng_)];
+    for (int i = 1; i < settings_.tournament_size; ++i) {
+        const Member& contender = population_[pick(rng_)];
+        if (contender.fitness > winner->fitness) {
+            winner = &contender;
+        }
+    }
+    return *winner;
+}
+
+std::vector<int> GeneticOptimizer::random_genome() {
+    std::vector<int> values(genes_.size());
+    for (size_t i = 0; i < genes_.size(); ++i) {
+        std::uniform_int_distribution<int> value(genes_[i].min_value, genes_[i].max_value);
+        values[i] = value(rng_);
+    }
+    return values;
+}
+
+} // namespace core
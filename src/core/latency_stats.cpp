@@ -0,0 +1,159 @@
+#include "core/latency_stats.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace core {
+
+LatencyStats::LatencyStats() {
+    auto& registry = MetricsRegistry::instance();
+    for (int i = 0; i < STAGE_COUNT; ++i) {
+        histograms_[i] = &registry.histogram(metric_name(static_cast<Stage>(i)));
+    }
+}
+
+int64_t LatencyStats::now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* LatencyStats::stage_name(Stage stage) {
+    switch (stage) {
+        case Stage::EventToCallback: return "event->callback";
+        case Stage::Extract:         return "extract";
+        case Stage::Store:           return "store";
+        case Stage::Queue:           return "queue";
+        case Stage::Upload:          return "upload";
+        case Stage::Present:         return "present";
+        case Stage::HostTotal:       return "callback->swap";
+        case Stage::Total:           return "event->swap";
+        default:                     return "?";
+    }
+}
+
+const char* LatencyStats::metric_name(Stage stage) {
+    switch (stage) {
+        case Stage::EventToCallback: return "latency.event_to_callback_us";
+        case Stage::Extract:         return "latency.extract_us";
+        case Stage::Store:           return "latency.store_us";
+        case Stage::Queue:           return "latency.queue_us";
+        case Stage::Upload:          return "latency.upload_us";
+        case Stage::Present:         return "latency.present_us";
+        case Stage::HostTotal:       return "latency.callback_to_swap_us";
+        case Stage::Total:           return "latency.event_to_swap_us";
+        default:                     return "latency.unknown_us";
+    }
+}
+
+void LatencyStats::record(const video::FrameTiming& timing, int64_t consumed_us,
+                          int64_t uploaded_us, int64_t swapped_us) {
+    if (timing.callback_us == 0) {
+        return;  // Frame did not come through an instrumented producer
+    }
+
+    const int64_t extracted = timing.extracted_us ? timing.extracted_us : timing.callback_us;
+    const int64_t stored = timing.stored_us ? timing.stored_us : extracted;
+
+    histogram(Stage::Extract).record(extracted - timing.callback_us);
+    histogram(Stage::Store).record(stored - extracted);
+    histogram(Stage::Queue).record(consumed_us - stored);
+    histogram(Stage::Upload).record(uploaded_us - consumed_us);
+    histogram(Stage::Present).record(swapped_us - uploaded_us);
+    histogram(Stage::HostTotal).record(swapped_us - timing.callback_us);
+
+    if (timing.camera_host_us > 0) {
+        const int64_t event_to_callback = std::max<int64_t>(timing.callback_us - timing.camera_host_us, 0);
+        histogram(Stage::EventToCallback).record(event_to_callback);
+        histogram(Stage::Total).record(event_to_callback + swapped_us - timing.callback_us);
+    } else if (timing.camera_ts > 0) {
+        const int64_t offset = timing.callback_us - timing.camera_ts;
+        if (!have_clock_offset_ || offset < min_clock_offset_us_) {
+            min_clock_offset_us_ = offset;
+            have_clock_offset_ = true;
+        }
+        const int64_t event_to_callback = offset - min_clock_offset_us_;
+        histogram(Stage::EventToCallback).record(event_to_callback);
+        histogram(Stage::Total).record(event_to_callback + swapped_us - timing.callback_us);
+    }
+    frames_++;
+}
+
+LatencyStats::Summary LatencyStats::summary(Stage stage) const {
+    const Histogram::Snapshot snap = histogram(stage).snapshot();
+    Summary result;
+    result.count = snap.count;
+    result.mean_us = snap.mean();
+    result.p50_us = snap.percentile(0.50);
+    result.p95_us = snap.percentile(0.95);
+    result.p99_us = snap.percentile(0.99);
+    result.max_us = snap.max;
+    return result;
+}
+
+void LatencyStats::get_histogram(Stage stage, std::vector<float>& counts,
+                                 int64_t& low_us, int64_t& high_us) const {
+    const Histogram::Snapshot snap = histogram(stage).snapshot();
+    counts.clear();
+    low_us = 0;
+    high_us = 0;
+
+    int first = 0;
+    int last = log_buckets::COUNT - 1;
+    while (first <= last && snap.buckets[first] == 0) ++first;
+    while (last >= first && snap.buckets[last] == 0) --last;
+    if (first > last) {
+        return;
+    }
+
+    counts.reserve(last - first + 1);
+    for (int i = first; i <= last; ++i) {
+        counts.push_back(static_cast<float>(snap.buckets[i]));
+    }
+    low_us = log_buckets::low(first);
+    high_us = log_buckets::high(last);
+}
+
+void LatencyStats::reset() {
+    for (Histogram* h : histograms_) {
+        h->reset();
+    }
+    min_clock_offset_us_ = 0;
+    have_clock_offset_ = false;
+    frames_ = 0;
+}
+
+bool LatencyStats::export_csv(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << "stage,count,mean_us,p50_us,p95_us,p99_us,max_us\n";
+    for (int i = 0; i < STAGE_COUNT; ++i) {
+        const Summary s = summary(static_cast<Stage>(i));
+        file << stage_name(static_cast<Stage>(i)) << ',' << s.count << ',' << s.mean_us << ','
+             << s.p50_us << ',' << s.p95_us << ',' << s.p99_us << ',' << s.max_us << '\n';
+    }
+    return file.good();
+}
+
+bool LatencyStats::export_histogram_csv(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << "stage,bucket_low_us,bucket_high_us,count\n";
+    for (int i = 0; i < STAGE_COUNT; ++i) {
+        const Histogram::Snapshot snap = histograms_[i]->snapshot();
+        for (int b = 0; b < log_buckets::COUNT; ++b) {
+            if (snap.buckets[b] != 0) {
+                file << stage_name(static_cast<Stage>(i)) << ',' << log_buckets::low(b) << ','
+                     << log_buckets::high(b) << ',' << snap.buckets[b] << '\n';
+            }
+        }
+    }
+    return file.good();
+}
+
+} // namespace core
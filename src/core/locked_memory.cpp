@@ -0,0 +1,301 @@
+#include "core/locked_memory.h"
+#include "core/log.h"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace core {
+
+namespace {
+
+constexpr double MB = 1024.0 * 1024.0;
+
+#ifndef _WIN32
+constexpr size_t HUGE_PAGE_BYTES = 2 << 20;   // Default hugetlb size on x86-64
+#endif
+
+size_t page_size() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+size_t round_up(size_t bytes, size_t unit) {
+    return (bytes + unit - 1) / unit * unit;
+}
+
+#ifdef _WIN32
+/**
+ * Enable SeLockMemoryPrivilege in the process token (needed for MEM_LARGE_PAGES)
+ */
+bool enable_lock_privilege() {
+    HANDLE token = nullptr;
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) {
+        return false;
+    }
+    TOKEN_PRIVILEGES privileges{};
+    privileges.PrivilegeCount = 1;
+    privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+    bool ok = LookupPrivilegeValueA(nullptr, "SeLockMemoryPrivilege", &privileges.Privileges[0].Luid) &&
+              AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+              GetLastError() == ERROR_SUCCESS;   // ERROR_NOT_ALL_ASSIGNED: the account lacks the right
+    CloseHandle(token);
+    return ok;
+}
+
+/**
+ * Raise the working-set minimum (and maximum) so `bytes` more can be locked
+ */
+bool grow_working_set(size_t bytes) {
+    SIZE_T minimum = 0;
+    SIZE_T maximum = 0;
+    DWORD flags = 0;
+    if (!GetProcessWorkingSetSizeEx(GetCurrentProcess(), &minimum, &maximum, &flags)) {
+        return false;
+    }
+    minimum += bytes;
+    maximum = std::max<SIZE_T>(maximum, minimum + bytes);
+    return SetProcessWorkingSetSizeEx(GetCurrentProcess(), minimum, maximum, flags) != 0;
+}
+#endif
+
+/**
+ * Mat buffers from LockedMemory, otherwise laid out like OpenCV's default allocator
+ */
+class LockedMatAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag, cv::UMatUsageFlags) const override {
+        size_t total = CV_ELEM_SIZE(type);
+        for (int i = dims - 1; i >= 0; --i) {
+            if (step) {
+                if (data && step[i] != cv::Mat::AUTO_STEP) {
+                    total = step[i];
+                } else {
+                    step[i] = total;
+                }
+            }
+            total *= sizes[i];
+        }
+        cv::UMatData* u = new cv::UMatData(this);
+        u->data = u->origdata = static_cast<uchar*>(data ? data : LockedMemory::instance().allocate(total));
+        u->size = total;
+        if (data) {
+            u->flags |= cv::UMatData::USER_ALLOCATED;
+        }
+        return u;
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag, cv::UMatUsageFlags) const override {
+        return u != nullptr;
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        if (!u) {
+            return;
+        }
+        CV_Assert(u->urefcount == 0 && u->refcount == 0);
+        if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+            LockedMemory::instance().release(u->origdata);
+            u->origdata = nullptr;
+        }
+        delete u;
+    }
+};
+
+} // namespace
+
+LockedMemory& LockedMemory::instance() {
+    static LockedMemory memory;
+    return memory;
+}
+
+LockedMemory::LockedMemory()
+    : locked_metric_(MetricsRegistry::instance().gauge("memory.locked_mb")),
+      large_page_metric_(MetricsRegistry::instance().gauge("memory.large_page_mb")) {
+}
+
+void LockedMemory::configure(const Options& options) {
+    lock_ = options.lock;
+    large_pages_ = options.large_pages;
+}
+
+cv::MatAllocator* LockedMemory::mat_allocator() {
+    static LockedMatAllocator allocator;
+    return &allocator;
+}
+
+void* LockedMemory::allocate(size_t bytes) {
+    bytes = std::max<size_t>(bytes, 1);
+    Block info;
+    void* block = nullptr;
+
+    if (lock_.load(std::memory_order_relaxed) && bytes >= MIN_LOCKED_BYTES) {
+        if (large_pages_.load(std::memory_order_relaxed)) {
+            block = map_large(bytes, info.bytes);
+            info.kind = Kind::LargePage;
+        }
+        if (!block) {
+            bool locked = false;
+            block = map_locked(bytes, info.bytes, locked);
+            info.kind = locked ? Kind::Locked : Kind::Pageable;
+        }
+    }
+    if (!block) {
+        block = ::operator new(bytes);   // Throws std::bad_alloc
+        info = {bytes, Kind::Heap};
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    blocks_[block] = info;
+    switch (info.kind) {
+        case Kind::LargePage: stats_.large_page_bytes += info.bytes; break;
+        case Kind::Locked: stats_.locked_bytes += info.bytes; break;
+        case Kind::Pageable: stats_.pageable_bytes += info.bytes; break;
+        case Kind::Heap: break;
+    }
+    publish();
+    return block;
+}
+
+void LockedMemory::release(void* block) {
+    if (!block) {
+        return;
+    }
+    Block info;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = blocks_.find(block);
+        if (it == blocks_.end()) {
+            return;   // Not ours; freeing it as anything would corrupt the heap
+        }
+        info = it->second;
+        blocks_.erase(it);
+        switch (info.kind) {
+            case Kind::LargePage: stats_.large_page_bytes -= info.bytes; break;
+            case Kind::Locked: stats_.locked_bytes -= info.bytes; break;
+            case Kind::Pageable: stats_.pageable_bytes -= info.bytes; break;
+            case Kind::Heap: break;
+        }
+        publish();
+    }
+    unmap(block, info);
+}
+
+void* LockedMemory::map_large(size_t bytes, size_t& mapped) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (large_pages_failed_) {
+            return nullptr;
+        }
+    }
+#ifdef _WIN32
+    static const bool privileged = enable_lock_privilege();
+    const size_t large_page = GetLargePageMinimum();
+    if (large_page == 0 || bytes < large_page) {
+        return nullptr;
+    }
+    void* block = nullptr;
+    if (privileged) {
+        mapped = round_up(bytes, large_page);
+        block = VirtualAlloc(nullptr, mapped, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    }
+    if (!block) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            large_pages_failed_ = true;
+        }
+        note_fallback(privileged ? "no contiguous large pages free" : "no \"Lock pages in memory\" privilege",
+                      "small pages");
+    }
+    return block;
+#else
+    if (bytes < HUGE_PAGE_BYTES) {
+        return nullptr;
+    }
+    mapped = round_up(bytes, HUGE_PAGE_BYTES);
+    void* block = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (block == MAP_FAILED) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            large_pages_failed_ = true;
+        }
+        note_fallback("no hugetlb pages reserved (vm.nr_hugepages)", "small pages");
+        return nullptr;
+    }
+    return block;
+#endif
+}
+
+void* LockedMemory::map_locked(size_t bytes, size_t& mapped, bool& locked) {
+    mapped = round_up(bytes, page_size());
+#ifdef _WIN32
+    void* block = VirtualAlloc(nullptr, mapped, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (!block) {
+        return nullptr;
+    }
+    locked = VirtualLock(block, mapped) != 0;
+    if (!locked && GetLastError() == ERROR_WORKING_SET_QUOTA && grow_working_set(mapped)) {
+        locked = VirtualLock(block, mapped) != 0;
+    }
+#else
+    void* block = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (block == MAP_FAILED) {
+        return nullptr;
+    }
+    locked = mlock(block, mapped) == 0;
+#endif
+    if (!locked) {
+        // Fault every page in now rather than on the first frame
+        std::memset(block, 0, mapped);
+        note_fallback("cannot lock pages (working set quota / RLIMIT_MEMLOCK)", "pageable memory, prefaulted");
+    }
+    return block;
+}
+
+void LockedMemory::unmap(void* block, const Block& info) {
+    if (info.kind == Kind::Heap) {
+        ::operator delete(block);
+        return;
+    }
+#ifdef _WIN32
+    VirtualFree(block, 0, MEM_RELEASE);   // Also unlocks
+#else
+    munmap(block, info.bytes);
+#endif
+}
+
+void LockedMemory::note_fallback(const char* what, const char* instead) {
+    static LogSite site(60000);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.fallbacks;
+    }
+    LogLine(LogLevel::Warning, &site) << "Locked memory: " << what << ", using " << instead;
+}
+
+void LockedMemory::publish() {
+    locked_metric_.set(stats_.locked_bytes / MB);
+    large_page_metric_.set(stats_.large_page_bytes / MB);
+}
+
+LockedMemory::Stats LockedMemory::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace core
@@ -0,0 +1,222 @@
+#include "core/log.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace core {
+
+namespace {
+
+int64_t steady_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+// ============================================================================
+// LogSite
+// ============================================================================
+
+bool LogSite::allow(uint32_t& suppressed) {
+    const int64_t now = steady_us();
+    int64_t next = next_us_.load(std::memory_order_relaxed);
+    if (now < next || !next_us_.compare_exchange_strong(next, now + interval_us_, std::memory_order_relaxed)) {
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+// ============================================================================
+// LogLine
+// ============================================================================
+
+LogLine::LogLine(LogLevel level, LogSite* site)
+    : level_(level),
+      active_(Log::instance().is_enabled(level) && (!site || site->allow(suppressed_))) {
+}
+
+LogLine::~LogLine() {
+    if (!active_) {
+        return;
+    }
+    if (suppressed_ > 0) {
+        *this << " (" << suppressed_ << " similar suppressed)";
+    }
+    Log::instance().write(level_, buffer_, length_);
+}
+
+LogLine& LogLine::operator<<(const char* text) {
+    if (active_ && text) {
+        append(text, std::strlen(text));
+    }
+    return *this;
+}
+
+LogLine& LogLine::operator<<(double value) {
+    if (active_) {
+        char text[32];
+        const int length = std::snprintf(text, sizeof(text), "%g", value);  // Same as default ostream formatting
+        if (length > 0) {
+            append(text, static_cast<size_t>(length));
+        }
+    }
+    return *this;
+}
+
+void LogLine::append(const char* text, size_t length) {
+    if (!active_) {
+        return;
+    }
+    const size_t count = std::min(length, sizeof(buffer_) - length_);
+    std::memcpy(buffer_ + length_, text, count);
+    length_ += count;
+}
+
+void LogLine::append_signed(long long value) {
+    char text[24];
+    const auto result = std::to_chars(text, text + sizeof(text), value);
+    append(text, static_cast<size_t>(result.ptr - text));
+}
+
+void LogLine::append_unsigned(unsigned long long value) {
+    char text[24];
+    const auto result = std::to_chars(text, text + sizeof(text), value);
+    append(text, static_cast<size_t>(result.ptr - text));
+}
+
+// ============================================================================
+// Log
+// ============================================================================
+
+Log::~Log() {
+    stop();
+}
+
+void Log::start(LogLevel min_level, int flush_interval_ms) {
+    set_min_level(min_level);
+    if (running_.load()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_requested_ = false;
+    }
+    running_ = true;
+    thread_ = std::thread(&Log::flush_loop, this, std::max(flush_interval_ms, 1));
+}
+
+void Log::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_requested_ = true;
+    }
+    wake_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    flush_rings();  // Lines queued by threads that still saw the logger running
+}
+
+void Log::write(LogLevel level, const char* text, size_t length) {
+    if (!running_.load(std::memory_order_relaxed)) {
+        write_console(level, text, length);
+        if (level < LogLevel::Warning) {
+            std::cout.flush();
+        }
+        return;
+    }
+
+    Ring& ring = thread_ring();
+    const size_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= RING_LINES) {
+        lines_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;  // Never wait for the console
+    }
+    Line& line = ring.lines[head & (RING_LINES - 1)];
+    line.level = level;
+    line.length = static_cast<uint16_t>(std::min(length, LINE_CAPACITY));
+    line.queued_us = steady_us();
+    std::memcpy(line.text, text, line.length);
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+Log::Ring& Log::thread_ring() {
+    // Shared with rings_, so lines outlive the thread until flushed
+    thread_local std::shared_ptr<Ring> ring;
+    if (!ring) {
+        ring = std::make_shared<Ring>();
+        std::lock_guard<std::mutex> lock(rings_mutex_);  // Once per thread
+        rings_.push_back(ring);
+    }
+    return *ring;
+}
+
+void Log::flush_loop(int flush_interval_ms) {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    while (!stop_requested_) {
+        wake_.wait_for(lock, std::chrono::milliseconds(flush_interval_ms));
+        lock.unlock();
+        flush_rings();
+        lock.lock();
+    }
+}
+
+void Log::flush_rings() {
+    // Drop rings whose thread has exited and that are drained, then work on a
+    // copy so a thread registering its ring never waits for console writes
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<Ring>& ring) {
+            return ring.use_count() == 1 &&
+                   ring->head.load(std::memory_order_acquire) == ring->tail.load(std::memory_order_relaxed);
+        }), rings_.end());
+        rings = rings_;
+    }
+
+    // Merge the rings in queue order
+    static std::vector<Line> pending;  // Flush thread (or stop() after it joined) only
+    pending.clear();
+    for (const auto& ring : rings) {
+        size_t tail = ring->tail.load(std::memory_order_relaxed);
+        const size_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            pending.push_back(ring->lines[tail & (RING_LINES - 1)]);
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+    std::stable_sort(pending.begin(), pending.end(), [](const Line& a, const Line& b) {
+        return a.queued_us < b.queued_us;
+    });
+
+    for (const Line& line : pending) {
+        write_console(line.level, line.text, line.length);
+    }
+
+    static int64_t reported_dropped = 0;
+    const int64_t dropped = lines_dropped_.load();
+    if (dropped != reported_dropped) {
+        std::cerr << "Log: " << (dropped - reported_dropped) << " lines dropped (ring full)" << std::endl;
+        reported_dropped = dropped;
+    }
+    if (!pending.empty()) {
+        std::cout.flush();
+    }
+}
+
+void Log::write_console(LogLevel level, const char* text, size_t length) {
+    std::ostream& out = level >= LogLevel::Warning ? std::cerr : std::cout;
+    out.write(text, static_cast<std::streamsize>(length));
+    out.put('\n');
+}
+
+} // namespace core
@@ -0,0 +1,136 @@
+#include "core/memory_budget.h"
+#include <algorithm>
+#include "core/log.h"
+
+namespace core {
+
+namespace {
+
+constexpr double MB = 1024.0 * 1024.0;
+
+} // namespace
+
+MemoryBudget& MemoryBudget::instance() {
+    static MemoryBudget budget;
+    return budget;
+}
+
+MemoryBudget::MemoryBudget()
+    : budget_metric_(MetricsRegistry::instance().gauge("memory.budget_mb")),
+      used_metric_(MetricsRegistry::instance().gauge("memory.used_mb")),
+      backpressure_metric_(MetricsRegistry::instance().gauge("memory.backpressure")),
+      evicted_metric_(MetricsRegistry::instance().counter("memory.evicted_bytes")),
+      refused_metric_(MetricsRegistry::instance().counter("memory.refused")) {
+}
+
+void MemoryBudget::configure(size_t budget_bytes) {
+    budget_ = budget_bytes;
+    budget_metric_.set(budget_bytes / MB);
+    if (budget_bytes == 0) {
+        backpressure_ = false;
+    }
+}
+
+void MemoryBudget::register_consumer(const std::string& name, Tier tier, UsageFn usage, ShrinkFn shrink) {
+    Consumer consumer;
+    consumer.name = name;
+    consumer.tier = tier;
+    consumer.usage = std::move(usage);
+    consumer.shrink = tier == Tier::Critical ? nullptr : std::move(shrink);
+    consumer.gauge = &MetricsRegistry::instance().gauge("memory." + name + "_mb");
+
+    std::lock_guard<std::mutex> lock(consumers_mutex_);
+    consumers_.push_back(std::move(consumer));
+}
+
+size_t MemoryBudget::measure() {
+    size_t total = 0;
+    for (Consumer& consumer : consumers_) {
+        consumer.bytes = consumer.usage ? consumer.usage() : 0;
+        total += consumer.bytes;
+    }
+    return total;
+}
+
+void MemoryBudget::rebalance() {
+    std::lock_guard<std::mutex> lock(consumers_mutex_);
+    const size_t budget = budget_.load(std::memory_order_relaxed);
+    size_t used = measure();
+
+    if (budget > 0 && used > budget) {
+        const size_t low = budget / 100 * LOW_WATERMARK_PERCENT;
+        size_t freed = 0;
+        // Caches before histories; within a tier, in registration order
+        for (Tier tier : {Tier::Cache, Tier::History}) {
+            for (Consumer& consumer : consumers_) {
+                if (used - freed <= low) {
+                    break;
+                }
+                if (consumer.tier == tier && consumer.shrink) {
+                    freed += std::min(consumer.shrink(used - freed - low), used - freed);
+                }
+            }
+        }
+        if (freed > 0) {
+            evicted_.fetch_add(freed, std::memory_order_relaxed);
+            evicted_metric_.add(static_cast<int64_t>(freed));
+            used = measure();
+            static LogSite site(10000);
+            LogLine(LogLevel::Info, &site) << "Memory: over the " << static_cast<int>(budget / MB)
+                                           << " MB budget, freed " << static_cast<int>(freed / MB) << " MB";
+        }
+    }
+
+    // Entered over the budget, left under the low watermark, so producers do not flap at the line
+    const bool was_backpressured = backpressure_.load(std::memory_order_relaxed);
+    bool backpressure = false;
+    if (budget > 0) {
+        backpressure = was_backpressured ? used > budget / 100 * LOW_WATERMARK_PERCENT : used > budget;
+    }
+    if (backpressure != was_backpressured) {
+        backpressure_.store(backpressure, std::memory_order_relaxed);
+        if (backpressure) {
+            LogLine(LogLevel::Warning) << "Memory: " << static_cast<int>(used / MB) << " MB in use after eviction, budget "
+                                       << static_cast<int>(budget / MB) << " MB; holding back non-critical producers";
+        } else {
+            LogLine(LogLevel::Info) << "Memory: back under the budget, producers resumed";
+        }
+    }
+
+    used_.store(used, std::memory_order_relaxed);
+    used_metric_.set(used / MB);
+    backpressure_metric_.set(backpressure ? 1.0 : 0.0);
+    for (const Consumer& consumer : consumers_) {
+        consumer.gauge->set(consumer.bytes / MB);
+    }
+}
+
+bool MemoryBudget::admit() {
+    if (!backpressure_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    refused_.fetch_add(1, std::memory_order_relaxed);
+    refused_metric_.add();
+    return false;
+}
+
+std::vector<MemoryBudget::Usage> MemoryBudget::get_breakdown() const {
+    std::lock_guard<std::mutex> lock(consumers_mutex_);
+    std::vector<Usage> breakdown;
+    breakdown.reserve(consumers_.size());
+    for (const Consumer& consumer : consumers_) {
+        breakdown.push_back({consumer.name, consumer.tier, consumer.bytes});
+    }
+    return breakdown;
+}
+
+const char* MemoryBudget::tier_name(Tier tier) {
+    switch (tier) {
+        case Tier::Cache: return "cache";
+        case Tier::History: return "history";
+        case Tier::Critical: return "critical";
+    }
+    return "?";
+}
+
+} // namespace core
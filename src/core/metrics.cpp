@@ -0,0 +1,219 @@
+#include "core/metrics.h"
+#include <algorithm>
+#include <fstream>
+
+namespace core {
+
+// ============================================================================
+// Bucket layout
+// ============================================================================
+
+namespace log_buckets {
+
+int index(int64_t value) {
+    const uint64_t v = static_cast<uint64_t>(std::max<int64_t>(value, 0));
+    if (v < SUB_COUNT) {
+        return static_cast<int>(v);
+    }
+
+    int msb = SUB_BITS;
+    while (msb < 63 && (v >> (msb + 1)) != 0) {
+        ++msb;
+    }
+    if (msb > MAX_MSB) {
+        return COUNT - 1;
+    }
+    const int sub = static_cast<int>((v >> (msb - SUB_BITS)) & (SUB_COUNT - 1));
+    return (msb - SUB_BITS + 1) * SUB_COUNT + sub;
+}
+
+int64_t low(int index) {
+    if (index < SUB_COUNT) {
+        return index;
+    }
+    const int msb = index / SUB_COUNT + SUB_BITS - 1;
+    const int sub = index % SUB_COUNT;
+    return static_cast<int64_t>(SUB_COUNT + sub) << (msb - SUB_BITS);
+}
+
+int64_t high(int index) {
+    if (index < SUB_COUNT) {
+        return index + 1;
+    }
+    const int msb = index / SUB_COUNT + SUB_BITS - 1;
+    return low(index) + (int64_t(1) << (msb - SUB_BITS));
+}
+
+} // namespace log_buckets
+
+int metrics_shard() {
+    static std::atomic<int> next_shard{0};
+    thread_local const int shard = next_shard.fetch_add(1, std::memory_order_relaxed);
+    return shard;
+}
+
+// ============================================================================
+// Counter
+// ============================================================================
+
+int64_t Counter::value() const {
+    int64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Counter::reset() {
+    for (auto& shard : shards_) {
+        shard.value.store(0, std::memory_order_relaxed);
+    }
+}
+
+// ============================================================================
+// Histogram
+// ============================================================================
+
+void Histogram::record(int64_t value) {
+    value = std::max<int64_t>(value, 0);
+    Shard& shard = shards_[metrics_shard() % SHARD_COUNT];
+    shard.buckets[log_buckets::index(value)].fetch_add(1, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+
+    // Max rarely changes once warmed up, so the CAS loop almost never runs
+    int64_t current = shard.max.load(std::memory_order_relaxed);
+    while (value > current &&
+           !shard.max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot result;
+    for (const auto& shard : shards_) {
+        for (int i = 0; i < log_buckets::COUNT; ++i) {
+            result.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        result.count += shard.count.load(std::memory_order_relaxed);
+        result.sum += shard.sum.load(std::memory_order_relaxed);
+        result.max = std::max(result.max, shard.max.load(std::memory_order_relaxed));
+    }
+    return result;
+}
+
+void Histogram::reset() {
+    for (auto& shard : shards_) {
+        for (auto& bucket : shard.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        shard.count.store(0, std::memory_order_relaxed);
+        shard.sum.store(0, std::memory_order_relaxed);
+        shard.max.store(0, std::memory_order_relaxed);
+    }
+}
+
+int64_t Histogram::Snapshot::percentile(double fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    // Upper bucket edge, so budgets are checked conservatively
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * count + 0.5));
+    uint64_t seen = 0;
+    for (int i = 0; i < log_buckets::COUNT; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(log_buckets::high(i), max);
+        }
+    }
+    return max;
+}
+
+// ============================================================================
+// Registry
+// ============================================================================
+
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = counters_[name];
+    if (!slot) {
+        slot = std::make_unique<Counter>();
+    }
+    return *slot;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = gauges_[name];
+    if (!slot) {
+        slot = std::make_unique<Gauge>();
+    }
+    return *slot;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = histograms_[name];
+    if (!slot) {
+        slot = std::make_unique<Histogram>();
+    }
+    return *slot;
+}
+
+MetricsRegistry::Snapshot MetricsRegistry::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Snapshot result;
+    result.counters.reserve(counters_.size());
+    for (const auto& [name, counter] : counters_) {
+        result.counters.emplace_back(name, counter->value());
+    }
+    for (const auto& [name, gauge] : gauges_) {
+        if (gauge->has_value()) {
+            result.gauges.emplace_back(name, gauge->value());
+        }
+    }
+    result.histograms.reserve(histograms_.size());
+    for (const auto& [name, histogram] : histograms_) {
+        result.histograms.emplace_back(name, histogram->snapshot());
+    }
+    return result;
+}
+
+void MetricsRegistry::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : counters_) {
+        entry.second->reset();
+    }
+    for (auto& entry : histograms_) {
+        entry.second->reset();
+    }
+    // Gauges hold current state (temperature, SNR), not accumulated totals: keep them
+}
+
+bool MetricsRegistry::export_csv(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    const Snapshot snap = snapshot();
+    file << "name,type,count,mean,p50,p95,p99,max\n";
+    for (const auto& [name, value] : snap.counters) {
+        file << name << ",counter," << value << ",,,,,\n";
+    }
+    for (const auto& [name, value] : snap.gauges) {
+        file << name << ",gauge," << value << ",,,,,\n";
+    }
+    for (const auto& [name, h] : snap.histograms) {
+        file << name << ",histogram," << h.count << ',' << h.mean() << ',' << h.percentile(0.50) << ','
+             << h.percentile(0.95) << ',' << h.percentile(0.99) << ',' << h.max << '\n';
+    }
+    return file.good();
+}
+
+} // namespace core
@@ -0,0 +1,305 @@
+#include "core/metrics_exporter.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using socket_t = SOCKET;
+static inline void close_socket(socket_t s) { closesocket(s); }
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using socket_t = int;
+static inline void close_socket(socket_t s) { ::close(s); }
+#endif
+
+namespace core {
+
+namespace {
+
+constexpr intptr_t NO_SOCKET = -1;
+constexpr int POLL_MS = 200;                 // Bounds how long stop() waits
+constexpr size_t STATSD_MAX_DATAGRAM = 1400; // Stay under a typical MTU
+
+socket_t as_socket(intptr_t s) { return static_cast<socket_t>(s); }
+
+/**
+ * Wait until a socket is readable
+ * @return true if readable within timeout_ms
+ */
+bool wait_readable(socket_t s, int timeout_ms) {
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(s, &set);
+    timeval timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+    return select(static_cast<int>(s) + 1, &set, nullptr, nullptr, &timeout) > 0;
+}
+
+/**
+ * "events.batch_size" -> "rtcam_events_batch_size" (Prometheus allows [a-zA-Z0-9_:])
+ */
+std::string prometheus_name(const std::string& prefix, const std::string& name) {
+    std::string result = prefix.empty() ? name : prefix + "_" + name;
+    for (char& c : result) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_' && c != ':') {
+            c = '_';
+        }
+    }
+    return result;
+}
+
+std::string statsd_name(const std::string& prefix, const std::string& name) {
+    return prefix.empty() ? name : prefix + "." + name;
+}
+
+} // namespace
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::start(const Options& options) {
+    stop();
+    if (options.mode == Mode::Off) {
+        return false;
+    }
+    options_ = options;
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        std::cerr << "MetricsExporter: WSAStartup failed" << std::endl;
+        return false;
+    }
+    winsock_started_ = true;
+#endif
+
+    socket_t s;
+    if (options_.mode == Mode::Prometheus) {
+        s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (s == as_socket(NO_SOCKET)) {
+            std::cerr << "MetricsExporter: Failed to create socket" << std::endl;
+            stop();
+            return false;
+        }
+
+        int reuse = 1;
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(static_cast<uint16_t>(options_.port));
+        if (bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(s, 4) != 0) {
+            std::cerr << "MetricsExporter: Cannot listen on port " << options_.port << std::endl;
+            close_socket(s);
+            stop();
+            return false;
+        }
+    } else {
+        s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (s == as_socket(NO_SOCKET)) {
+            std::cerr << "MetricsExporter: Failed to create socket" << std::endl;
+            stop();
+            return false;
+        }
+
+        // Connected UDP: plain send() per datagram, unreachable server is just ignored
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(options_.statsd_port));
+        if (inet_pton(AF_INET, options_.statsd_host.c_str(), &addr.sin_addr) != 1 ||
+            connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::cerr << "MetricsExporter: Invalid StatsD address " << options_.statsd_host
+                      << ":" << options_.statsd_port << std::endl;
+            close_socket(s);
+            stop();
+            return false;
+        }
+    }
+    socket_ = static_cast<intptr_t>(s);
+
+    last_counters_.clear();
+    exports_ = 0;
+    running_ = true;
+    if (options_.mode == Mode::Prometheus) {
+        thread_ = std::thread(&MetricsExporter::prometheus_loop, this);
+        std::cout << "Metrics: Prometheus endpoint on port " << options_.port << " (/metrics)" << std::endl;
+    } else {
+        thread_ = std::thread(&MetricsExporter::statsd_loop, this);
+        std::cout << "Metrics: StatsD push to " << options_.statsd_host << ":" << options_.statsd_port
+                  << " every " << options_.interval_ms << " ms" << std::endl;
+    }
+    return true;
+}
+
+void MetricsExporter::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (socket_ != NO_SOCKET) {
+        close_socket(as_socket(socket_));
+        socket_ = NO_SOCKET;
+    }
+#ifdef _WIN32
+    if (winsock_started_) {
+        WSACleanup();
+    }
+#endif
+    winsock_started_ = false;
+}
+
+std::string MetricsExporter::format_prometheus(const MetricsRegistry::Snapshot& snapshot,
+                                               const std::string& prefix) {
+    std::ostringstream out;
+    for (const auto& [name, value] : snapshot.counters) {
+        const std::string metric = prometheus_name(prefix, name) + "_total";
+        out << "# TYPE " << metric << " counter\n" << metric << ' ' << value << '\n';
+    }
+    for (const auto& [name, value] : snapshot.gauges) {
+        const std::string metric = prometheus_name(prefix, name);
+        out << "# TYPE " << metric << " gauge\n" << metric << ' ' << value << '\n';
+    }
+    for (const auto& [name, h] : snapshot.histograms) {
+        const std::string metric = prometheus_name(prefix, name);
+        out << "# TYPE " << metric << " summary\n"
+            << metric << "{quantile=\"0.5\"} " << h.percentile(0.50) << '\n'
+            << metric << "{quantile=\"0.95\"} " << h.percentile(0.95) << '\n'
+            << metric << "{quantile=\"0.99\"} " << h.percentile(0.99) << '\n'
+            << metric << "_sum " << h.sum << '\n'
+            << metric << "_count " << h.count << '\n';
+    }
+    return out.str();
+}
+
+void MetricsExporter::prometheus_loop() {
+    const socket_t listener = as_socket(socket_);
+
+    while (running_.load()) {
+        if (!wait_readable(listener, POLL_MS)) {
+            continue;
+        }
+        socket_t client = accept(listener, nullptr, nullptr);
+        if (client == as_socket(NO_SOCKET)) {
+            continue;
+        }
+
+        // Only the request line matters; a slow client gets dropped, never waited on
+        char request[1024] = {};
+        if (wait_readable(client, 1000)) {
+            recv(client, request, sizeof(request) - 1, 0);
+        }
+
+        std::string body;
+        std::string status = "200 OK";
+        if (std::strncmp(request, "GET /metrics", 12) == 0 || std::strncmp(request, "GET / ", 6) == 0) {
+            body = format_prometheus(MetricsRegistry::instance().snapshot(), options_.prefix);
+        } else {
+            status = "404 Not Found";
+            body = "Try /metrics\n";
+        }
+
+        std::ostringstream response;
+        response << "HTTP/1.1 " << status << "\r\n"
+                 << "Content-Type: text/plain; version=0.0.4\r\n"
+                 << "Content-Length: " << body.size() << "\r\n"
+                 << "Connection: close\r\n\r\n"
+                 << body;
+        const std::string data = response.str();
+
+        size_t sent = 0;
+        while (sent < data.size()) {
+            const int n = send(client, data.data() + sent, static_cast<int>(data.size() - sent), 0);
+            if (n <= 0) {
+                break;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        close_socket(client);
+        exports_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void MetricsExporter::statsd_push(const MetricsRegistry::Snapshot& snapshot) {
+    std::vector<std::string> lines;
+    std::ostringstream line;
+
+    auto emit = [&](const std::string& name, const auto& value, const char* type) {
+        line.str("");
+        line << statsd_name(options_.prefix, name) << ':' << value << '|' << type;
+        lines.push_back(line.str());
+    };
+
+    for (const auto& [name, value] : snapshot.counters) {
+        int64_t& last = last_counters_[name];
+        const int64_t delta = value - last;
+        last = value;
+        if (delta > 0) {
+            emit(name, delta, "c");
+        }
+    }
+    for (const auto& [name, value] : snapshot.gauges) {
+        emit(name, value, "g");
+    }
+    for (const auto& [name, h] : snapshot.histograms) {
+        if (h.count == 0) {
+            continue;
+        }
+        emit(name + ".p50", h.percentile(0.50), "g");
+        emit(name + ".p95", h.percentile(0.95), "g");
+        emit(name + ".p99", h.percentile(0.99), "g");
+    }
+
+    // Pack lines into MTU-sized datagrams
+    const socket_t s = as_socket(socket_);
+    std::string datagram;
+    auto flush = [&]() {
+        if (!datagram.empty()) {
+            send(s, datagram.data(), static_cast<int>(datagram.size()), 0);
+            exports_.fetch_add(1, std::memory_order_relaxed);
+            datagram.clear();
+        }
+    };
+    for (const std::string& l : lines) {
+        if (!datagram.empty() && datagram.size() + 1 + l.size() > STATSD_MAX_DATAGRAM) {
+            flush();
+        }
+        if (!datagram.empty()) {
+            datagram += '\n';
+        }
+        datagram += l;
+    }
+    flush();
+}
+
+void MetricsExporter::statsd_loop() {
+    const auto interval = std::chrono::milliseconds(std::max(options_.interval_ms, 100));
+    auto next = std::chrono::steady_clock::now() + interval;
+
+    while (running_.load()) {
+        // Sleep in short slices so stop() stays responsive
+        const auto now = std::chrono::steady_clock::now();
+        if (now < next) {
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                next - now, std::chrono::milliseconds(POLL_MS)));
+            continue;
+        }
+        next += interval;
+        statsd_push(MetricsRegistry::instance().snapshot());
+    }
+}
+
+} // namespace core
@@ -0,0 +1,156 @@
+#include "core/profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace core {
+
+Profiler::~Profiler() {
+    stop();
+}
+
+int64_t Profiler::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool Profiler::start(const std::string& path, int flush_interval_ms) {
+    if (running_.load()) {
+        return true;
+    }
+
+    file_ = std::fopen(path.c_str(), "w");
+    if (!file_) {
+        std::cerr << "Profiler: cannot create " << path << std::endl;
+        return false;
+    }
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file_);
+    first_event_ = true;
+    origin_ns_ = now_ns();
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        for (const auto& ring : rings_) {
+            ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);  // Drop stale zones
+            std::lock_guard<std::mutex> name_lock(ring->name_mutex);
+            ring->name_written = false;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_requested_ = false;
+    }
+    running_ = true;
+    thread_ = std::thread(&Profiler::flush_loop, this, std::max(flush_interval_ms, 1));
+    std::cout << "Profiler: writing trace to " << path << std::endl;
+    return true;
+}
+
+void Profiler::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_requested_ = true;
+    }
+    wake_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    flush_rings();  // Zones queued by threads that still saw the profiler running
+
+    std::fputs("\n]}\n", file_);
+    std::fclose(file_);
+    file_ = nullptr;
+
+    if (zones_dropped_.load() > 0) {
+        std::cerr << "Profiler: " << zones_dropped_.load() << " zones dropped (ring full)" << std::endl;
+    }
+}
+
+void Profiler::set_thread_name(const std::string& name) {
+    Ring& ring = thread_ring();
+    std::lock_guard<std::mutex> lock(ring.name_mutex);
+    ring.name = name;
+    ring.name_written = false;
+}
+
+void Profiler::record(const char* name, int64_t begin_ns, int64_t end_ns) {
+    if (!running_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    Ring& ring = thread_ring();
+    const size_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= RING_ZONES) {
+        zones_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;  // Never wait for the file
+    }
+    ring.zones[head & (RING_ZONES - 1)] = {name, begin_ns, end_ns};
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+Profiler::Ring& Profiler::thread_ring() {
+    // Shared with rings_, so zones outlive the thread until written
+    thread_local std::shared_ptr<Ring> ring;
+    if (!ring) {
+        ring = std::make_shared<Ring>();
+        ring->thread_id = next_thread_id_.fetch_add(1);
+        std::lock_guard<std::mutex> lock(rings_mutex_);  // Once per thread
+        rings_.push_back(ring);
+    }
+    return *ring;
+}
+
+void Profiler::flush_loop(int flush_interval_ms) {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    while (!stop_requested_) {
+        wake_.wait_for(lock, std::chrono::milliseconds(flush_interval_ms));
+        lock.unlock();
+        flush_rings();
+        lock.lock();
+    }
+}
+
+void Profiler::flush_rings() {
+    // Drop rings whose thread has exited and that are drained, then work on a
+    // copy so a thread registering its ring never waits for file writes
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<Ring>& ring) {
+            return ring.use_count() == 1 &&
+                   ring->head.load(std::memory_order_acquire) == ring->tail.load(std::memory_order_relaxed);
+        }), rings_.end());
+        rings = rings_;
+    }
+
+    // Trace viewers sort by timestamp, so rings are written one after another
+    for (const auto& ring : rings) {
+        {
+            std::lock_guard<std::mutex> lock(ring->name_mutex);
+            if (!ring->name_written && !ring->name.empty()) {
+                std::fprintf(file_, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                             first_event_ ? "" : ",\n", ring->thread_id, ring->name.c_str());
+                first_event_ = false;
+                ring->name_written = true;
+            }
+        }
+
+        size_t tail = ring->tail.load(std::memory_order_relaxed);
+        const size_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const Zone& zone = ring->zones[tail & (RING_ZONES - 1)];
+            std::fprintf(file_, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                         first_event_ ? "" : ",\n", zone.name, ring->thread_id,
+                         (zone.begin_ns - origin_ns_) / 1000.0, (zone.end_ns - zone.begin_ns) / 1000.0);
+            first_event_ = false;
+        }
+        zones_written_.fetch_add(static_cast<int64_t>(head - ring->tail.load(std::memory_order_relaxed)),
+                                 std::memory_order_relaxed);
+        ring->tail.store(tail, std::memory_order_release);
+    }
+    std::fflush(file_);
+}
+
+} // namespace core
@@ -0,0 +1,114 @@
+#include "core/qos_scheduler.h"
+#include <algorithm>
+#include <string>
+#include "core/latency_stats.h"
+#include "core/log.h"
+
+namespace core {
+
+QosScheduler& QosScheduler::instance() {
+    static QosScheduler scheduler;
+    return scheduler;
+}
+
+QosScheduler::QosScheduler() {
+    for (int i = 0; i < WORK_COUNT; ++i) {
+        shed_metrics_[i] = &MetricsRegistry::instance().counter(std::string("qos.shed.") + work_name(static_cast<Work>(i)));
+    }
+}
+
+void QosScheduler::configure(const Options& options) {
+    latency_threshold_us_ = static_cast<int64_t>(std::max(options.latency_ms, 1)) * 1000;
+    queue_percent_ = std::clamp(options.queue_percent, 1, 100);
+    decimation_ = std::max(options.decimation, 1);
+    hold_us_ = static_cast<int64_t>(std::max(options.hold_ms, 0)) * 1000;
+    enabled_ = options.enabled;
+}
+
+void QosScheduler::report_latency(int64_t latency_us) {
+    if (!is_enabled() || latency_us <= 0) {
+        return;
+    }
+    report_ratio(static_cast<double>(latency_us) / latency_threshold_us_.load(std::memory_order_relaxed));
+}
+
+void QosScheduler::report_queue(size_t depth, size_t capacity) {
+    if (!is_enabled() || capacity == 0) {
+        return;
+    }
+    const double percent = 100.0 * static_cast<double>(depth) / static_cast<double>(capacity);
+    report_ratio(percent / queue_percent_.load(std::memory_order_relaxed));
+}
+
+void QosScheduler::report_ratio(double ratio) {
+    if (ratio < 1.0) {
+        return;
+    }
+    const int64_t now_us = LatencyStats::now_us();
+    const int64_t until_us = now_us + hold_us_.load(std::memory_order_relaxed);
+    const bool was_shedding = decimate_until_us_.load(std::memory_order_relaxed) > now_us;
+
+    // Several reporters may race; the later deadline is as good as any
+    decimate_until_us_.store(until_us, std::memory_order_relaxed);
+    if (ratio >= 2.0) {
+        skip_until_us_.store(until_us, std::memory_order_relaxed);
+    }
+    if (!was_shedding) {
+        static LogSite site(5000);
+        LogLine(LogLevel::Warning, &site) << "QoS: pressure " << static_cast<int>(ratio * 100.0)
+                                          << "% of threshold, shedding deferrable work";
+    }
+}
+
+QosScheduler::Level QosScheduler::get_level() const {
+    if (!is_enabled()) {
+        return Level::Normal;
+    }
+    const int64_t now_us = LatencyStats::now_us();
+    if (skip_until_us_.load(std::memory_order_relaxed) > now_us) {
+        return Level::Skip;
+    }
+    if (decimate_until_us_.load(std::memory_order_relaxed) > now_us) {
+        return Level::Decimate;
+    }
+    return Level::Normal;
+}
+
+bool QosScheduler::admit(Work work) {
+    const int index = static_cast<int>(work);
+    const Level level = get_level();
+    if (level == Level::Normal) {
+        return true;
+    }
+
+    // Decimating keeps every n-th call of each kind of work, so each still moves
+    const uint64_t call = calls_[index].fetch_add(1, std::memory_order_relaxed);
+    if (level == Level::Decimate && call % static_cast<uint64_t>(decimation_.load(std::memory_order_relaxed)) == 0) {
+        return true;
+    }
+    shed_[index].fetch_add(1, std::memory_order_relaxed);
+    shed_metrics_[index]->add();
+    return false;
+}
+
+const char* QosScheduler::work_name(Work work) {
+    switch (work) {
+        case Work::Heatmap: return "heatmap";
+        case Work::Visualization: return "visualization";
+        case Work::Chart: return "chart";
+        case Work::Thumbnail: return "thumbnail";
+        case Work::COUNT: break;
+    }
+    return "?";
+}
+
+const char* QosScheduler::level_name(Level level) {
+    switch (level) {
+        case Level::Normal: return "normal";
+        case Level::Decimate: return "decimate";
+        case Level::Skip: return "skip";
+    }
+    return "?";
+}
+
+} // namespace core
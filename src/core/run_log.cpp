@@ -0,0 +1,341 @@
+#include "core/run_log.h"
+#include "core/log.h"
+#include "core/metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+namespace core {
+
+namespace {
+
+constexpr char FILE_MAGIC[8] = {'R', 'U', 'N', 'L', 'O', 'G', '1', '\0'};
+
+template <typename T>
+void write_pod(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool read_pod(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+size_t type_size(RunLog::Type type) {
+    switch (type) {
+    case RunLog::Type::I64: return sizeof(int64_t);
+    case RunLog::Type::I32: return sizeof(int32_t);
+    case RunLog::Type::U32: return sizeof(uint32_t);
+    default: return sizeof(uint8_t);
+    }
+}
+
+int64_t decode(RunLog::Type type, const uint8_t* p) {
+    switch (type) {
+    case RunLog::Type::I64: { int64_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+    case RunLog::Type::I32: { int32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+    case RunLog::Type::U32: { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+    default: return *p;
+    }
+}
+
+template <typename T>
+void write_column(std::ostream& out, const std::vector<T>& column, uint32_t rows) {
+    out.write(reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(rows * sizeof(T)));
+}
+
+Counter& rows_metric() {
+    static Counter& counter = MetricsRegistry::instance().counter("run_log.rows");
+    return counter;
+}
+
+Counter& dropped_metric() {
+    static Counter& counter = MetricsRegistry::instance().counter("run_log.dropped_rows");
+    return counter;
+}
+
+} // namespace
+
+constexpr RunLog::Column RunLog::COLUMNS[RunLog::COLUMN_COUNT];
+
+RunLog::Block::Block()
+    : frame_index(BLOCK_ROWS)
+    , camera_ts(BLOCK_ROWS)
+    , events(BLOCK_ROWS)
+    , on_events(BLOCK_ROWS)
+    , off_events(BLOCK_ROWS)
+    , camera(BLOCK_ROWS)
+    , window_us(BLOCK_ROWS)
+    , active_pixels(BLOCK_ROWS)
+    , scattering_pixels(BLOCK_ROWS)
+    , latency_us(BLOCK_ROWS) {}
+
+RunLog& RunLog::instance() {
+    static RunLog log;
+    return log;
+}
+
+RunLog::~RunLog() {
+    close();
+}
+
+bool RunLog::open(const std::string& path) {
+    close();
+
+    std::error_code ec;
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_ || !write_header()) {
+        LogLine(LogLevel::Warning) << "Run log: cannot create " << path;
+        file_.close();
+        return false;
+    }
+
+    path_ = path;
+    rows_written_ = 0;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_ = false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(append_mutex_);
+        current_ = std::make_unique<Block>();
+        open_ = true;
+    }
+    thread_ = std::thread(&RunLog::writer_loop, this);
+    LogLine(LogLevel::Info) << "Run log: writing " << path;
+    return true;
+}
+
+void RunLog::close() {
+    BlockPtr partial;
+    {
+        std::lock_guard<std::mutex> lock(append_mutex_);
+        if (!open_.exchange(false)) {
+            return;
+        }
+        partial = std::move(current_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (partial && partial->rows > 0) {
+            queued_.push_back(std::move(partial));   // Not limited: nothing follows it
+        }
+        stopping_ = true;
+    }
+    queue_cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    file_.close();
+    free_.clear();
+    LogLine(LogLevel::Info) << "Run log: " << rows_written_.load() << " rows in " << path_;
+}
+
+void RunLog::append(const Row& row) {
+    if (!open_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(append_mutex_);
+    if (!current_) {
+        return;   // Closed meanwhile
+    }
+    Block& block = *current_;
+    const uint32_t i = block.rows++;
+    block.frame_index[i] = row.frame_index;
+    block.camera[i] = static_cast<uint8_t>(row.camera);
+    block.camera_ts[i] = row.camera_ts;
+    block.window_us[i] = row.window_us;
+    block.events[i] = row.events;
+    block.on_events[i] = row.on_events;
+    block.off_events[i] = row.off_events;
+    block.active_pixels[i] = row.active_pixels;
+    block.scattering_pixels[i] = row.scattering_pixels;
+    block.latency_us[i] = row.latency_us;
+    if (block.rows < BLOCK_ROWS) {
+        return;
+    }
+
+    // Full: hand it to the writer and continue in a recycled block
+    {
+        std::lock_guard<std::mutex> queue_lock(queue_mutex_);
+        if (queued_.size() >= MAX_QUEUED_BLOCKS) {
+            dropped_metric().add(block.rows);
+            block.rows = 0;
+            return;
+        }
+        queued_.push_back(std::move(current_));
+        if (!free_.empty()) {
+            current_ = std::move(free_.back());
+            free_.pop_back();
+        }
+    }
+    queue_cv_.notify_one();
+    if (!current_) {
+        current_ = std::make_unique<Block>();
+    }
+}
+
+void RunLog::writer_loop() {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    while (true) {
+        queue_cv_.wait(lock, [this] { return stopping_ || !queued_.empty(); });
+        if (queued_.empty()) {
+            return;   // Stopping, everything written
+        }
+
+        BlockPtr block = std::move(queued_.front());
+        queued_.pop_front();
+        lock.unlock();
+        const bool written = write_block(*block);
+        lock.lock();
+
+        if (written) {
+            rows_written_ += block->rows;
+            rows_metric().add(block->rows);
+        } else {
+            dropped_metric().add(block->rows);
+        }
+        block->rows = 0;
+        free_.push_back(std::move(block));
+    }
+}
+
+bool RunLog::write_header() {
+    const int64_t start_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    file_.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+    write_pod(file_, VERSION);
+    write_pod(file_, BLOCK_ROWS);
+    write_pod(file_, static_cast<uint32_t>(COLUMN_COUNT));
+    write_pod(file_, start_ms);
+    for (const Column& column : COLUMNS) {
+        const uint8_t length = static_cast<uint8_t>(std::strlen(column.name));
+        write_pod(file_, static_cast<uint8_t>(column.type));
+        write_pod(file_, length);
+        file_.write(column.name, length);
+    }
+    file_.flush();
+    return static_cast<bool>(file_);
+}
+
+bool RunLog::write_block(const Block& block) {
+    // Same order as COLUMNS
+    write_pod(file_, BLOCK_MAGIC);
+    write_pod(file_, block.rows);
+    write_column(file_, block.frame_index, block.rows);
+    write_column(file_, block.camera, block.rows);
+    write_column(file_, block.camera_ts, block.rows);
+    write_column(file_, block.window_us, block.rows);
+    write_column(file_, block.events, block.rows);
+    write_column(file_, block.on_events, block.rows);
+    write_column(file_, block.off_events, block.rows);
+    write_column(file_, block.active_pixels, block.rows);
+    write_column(file_, block.scattering_pixels, block.rows);
+    write_column(file_, block.latency_us, block.rows);
+    file_.flush();
+    if (!file_) {
+        static LogSite site(10000);
+        LogLine(LogLevel::Warning, &site) << "Run log: write to " << path_ << " failed";
+        file_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool RunLog::read(const std::string& path, const std::function<void(const Row&)>& fn, int64_t* start_unix_ms) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(FILE_MAGIC)];
+    uint32_t version = 0;
+    uint32_t block_rows = 0;
+    uint32_t column_count = 0;
+    int64_t start_ms = 0;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0 ||
+        !read_pod(file, version) || version != VERSION || !read_pod(file, block_rows) ||
+        !read_pod(file, column_count) || !read_pod(file, start_ms)) {
+        return false;
+    }
+
+    // Stored columns mapped onto COLUMNS (-1 = unknown to this build, skipped)
+    struct Stored {
+        Type type;
+        int field;
+    };
+    std::vector<Stored> stored(column_count);
+    for (Stored& column : stored) {
+        uint8_t type = 0;
+        uint8_t length = 0;
+        if (!read_pod(file, type) || !read_pod(file, length) || type > static_cast<uint8_t>(Type::U8)) {
+            return false;
+        }
+        std::string name(length, '\0');
+        if (!file.read(&name[0], length)) {
+            return false;
+        }
+        column.type = static_cast<Type>(type);
+        column.field = -1;
+        for (int c = 0; c < COLUMN_COUNT; ++c) {
+            if (name == COLUMNS[c].name) {
+                column.field = c;
+            }
+        }
+    }
+    if (start_unix_ms) {
+        *start_unix_ms = start_ms;
+    }
+
+    std::vector<int64_t> values[COLUMN_COUNT];
+    std::vector<uint8_t> raw;
+    uint32_t block_magic = 0;
+    uint32_t rows = 0;
+    while (read_pod(file, block_magic) && block_magic == BLOCK_MAGIC && read_pod(file, rows) && rows <= block_rows) {
+        for (auto& column : values) {
+            column.assign(rows, -1);
+        }
+        bool complete = true;
+        for (const Stored& column : stored) {
+            const size_t size = type_size(column.type);
+            raw.resize(static_cast<size_t>(rows) * size);
+            if (!file.read(reinterpret_cast<char*>(raw.data()), static_cast<std::streamsize>(raw.size()))) {
+                complete = false;
+                break;
+            }
+            if (column.field < 0) {
+                continue;
+            }
+            int64_t* out = values[column.field].data();
+            for (uint32_t r = 0; r < rows; ++r) {
+                out[r] = decode(column.type, raw.data() + r * size);
+            }
+        }
+        if (!complete) {
+            break;   // Torn by a crash
+        }
+
+        // Same order as COLUMNS
+        Row row;
+        for (uint32_t r = 0; r < rows; ++r) {
+            row.frame_index = values[0][r];
+            row.camera = static_cast<int>(std::max<int64_t>(values[1][r], 0));
+            row.camera_ts = values[2][r];
+            row.window_us = static_cast<uint32_t>(std::max<int64_t>(values[3][r], 0));
+            row.events = values[4][r];
+            row.on_events = values[5][r];
+            row.off_events = values[6][r];
+            row.active_pixels = static_cast<int32_t>(values[7][r]);
+            row.scattering_pixels = static_cast<int32_t>(values[8][r]);
+            row.latency_us = static_cast<int32_t>(values[9][r]);
+            fn(row);
+        }
+    }
+    return true;
+}
+
+} // namespace core
@@ -0,0 +1,269 @@
+#include "core/soak_monitor.h"
+#include "core/alloc_tracker.h"
+#include "core/latency_stats.h"
+#include "core/log.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+namespace core {
+
+namespace {
+
+constexpr double MB = 1024.0 * 1024.0;
+
+Gauge& rss_gauge() {
+    static Gauge& gauge = MetricsRegistry::instance().gauge("soak.rss_mb");
+    return gauge;
+}
+
+Gauge& private_gauge() {
+    static Gauge& gauge = MetricsRegistry::instance().gauge("soak.private_mb");
+    return gauge;
+}
+
+Gauge& handles_gauge() {
+    static Gauge& gauge = MetricsRegistry::instance().gauge("soak.handles");
+    return gauge;
+}
+
+Gauge& gl_gauge() {
+    static Gauge& gauge = MetricsRegistry::instance().gauge("soak.gl_objects");
+    return gauge;
+}
+
+} // namespace
+
+SoakMonitor::~SoakMonitor() {
+    stop();
+}
+
+SoakMonitor::ProcessStats SoakMonitor::read_process() {
+    ProcessStats stats;
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS_EX counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters),
+                             sizeof(counters))) {
+        stats.rss_mb = counters.WorkingSetSize / MB;
+        stats.private_mb = counters.PrivateUsage / MB;
+    }
+    DWORD handles = 0;
+    if (GetProcessHandleCount(GetCurrentProcess(), &handles)) {
+        stats.handles = handles;
+    }
+#else
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        long long kb = 0;
+        if (std::sscanf(line.c_str(), "VmRSS: %lld kB", &kb) == 1) {
+            stats.rss_mb = kb / 1024.0;
+        } else if (std::sscanf(line.c_str(), "RssAnon: %lld kB", &kb) == 1) {
+            stats.private_mb = kb / 1024.0;
+        }
+    }
+    std::error_code error;
+    int64_t descriptors = 0;
+    for (std::filesystem::directory_iterator it("/proc/self/fd", error), end; !error && it != end; it.increment(error)) {
+        ++descriptors;
+    }
+    if (!error) {
+        stats.handles = descriptors;
+    }
+#endif
+    return stats;
+}
+
+bool SoakMonitor::start(const Options& options) {
+    stop();
+    options_ = options;
+    options_.interval_s = std::max(options_.interval_s, 1);
+    running_ = true;
+    failed_ = false;
+    failure_.clear();
+    have_baseline_ = false;
+    samples_ = 0;
+    slope_samples_ = 0;
+    sum_t_ = sum_m_ = sum_tt_ = sum_tm_ = 0.0;
+    latest_ = ProcessStats{};
+    latest_gl_ = -1;
+
+    start_us_ = LatencyStats::now_us();
+    last_us_ = start_us_;
+    next_us_ = start_us_ + static_cast<int64_t>(options_.interval_s) * 1000000;
+
+    last_counts_.clear();
+    for (const std::string& name : options_.throughput_counters) {
+        last_counts_.push_back(MetricsRegistry::instance().counter(name).value());
+    }
+    const AllocCounts allocs = AllocTracker::process_counts();
+    last_alloc_count_ = allocs.count;
+    last_alloc_bytes_ = allocs.bytes;
+
+    if (options_.csv_path.empty()) {
+        return true;
+    }
+    std::error_code error;
+    const std::filesystem::path parent = std::filesystem::path(options_.csv_path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, error);
+    }
+    csv_.open(options_.csv_path, std::ios::trunc);
+    if (!csv_.is_open()) {
+        LogLine(LogLevel::Error) << "Soak: cannot write " << options_.csv_path;
+        return false;
+    }
+    csv_ << "elapsed_s,rss_mb,private_mb,handles,gl_objects,allocs_per_s,alloc_mb_per_s";
+    for (const std::string& name : options_.throughput_counters) {
+        csv_ << "," << name << "_per_s";
+    }
+    csv_ << "\n";
+    csv_.flush();
+    return true;
+}
+
+void SoakMonitor::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    if (csv_.is_open()) {
+        csv_.close();
+    }
+}
+
+bool SoakMonitor::is_due() const {
+    return running_ && LatencyStats::now_us() >= next_us_;
+}
+
+bool SoakMonitor::poll(int64_t gl_objects) {
+    if (!running_) {
+        return !failed_;
+    }
+    const int64_t now_us = LatencyStats::now_us();
+    if (now_us >= next_us_) {
+        // Fixed cadence; a late poll does not shift later samples
+        while (next_us_ <= now_us) {
+            next_us_ += static_cast<int64_t>(options_.interval_s) * 1000000;
+        }
+        sample(gl_objects, now_us);
+    }
+    return !failed_;
+}
+
+void SoakMonitor::sample(int64_t gl_objects, int64_t now_us) {
+    const ProcessStats stats = read_process();
+    const double elapsed_s = (now_us - start_us_) / 1e6;
+    const double interval_s = std::max((now_us - last_us_) / 1e6, 1e-3);
+    last_us_ = now_us;
+    latest_ = stats;
+    latest_gl_ = gl_objects;
+    ++samples_;
+
+    rss_gauge().set(stats.rss_mb);
+    private_gauge().set(stats.private_mb);
+    handles_gauge().set(static_cast<double>(stats.handles));
+    if (gl_objects >= 0) {
+        gl_gauge().set(static_cast<double>(gl_objects));
+    }
+
+    const AllocCounts allocs = AllocTracker::process_counts();
+    const double allocs_per_s = AllocTracker::is_active() ? (allocs.count - last_alloc_count_) / interval_s : -1.0;
+    const double alloc_mb_per_s = AllocTracker::is_active() ? (allocs.bytes - last_alloc_bytes_) / MB / interval_s : -1.0;
+    last_alloc_count_ = allocs.count;
+    last_alloc_bytes_ = allocs.bytes;
+
+    if (csv_.is_open()) {
+        char row[192];
+        std::snprintf(row, sizeof(row), "%.0f,%.2f,%.2f,%lld,%lld,%.0f,%.3f", elapsed_s, stats.rss_mb,
+                      stats.private_mb, static_cast<long long>(stats.handles), static_cast<long long>(gl_objects),
+                      allocs_per_s, alloc_mb_per_s);
+        csv_ << row;
+        for (size_t i = 0; i < options_.throughput_counters.size(); ++i) {
+            const int64_t count = MetricsRegistry::instance().counter(options_.throughput_counters[i]).value();
+            csv_ << "," << (count - last_counts_[i]) / interval_s;
+            last_counts_[i] = count;
+        }
+        csv_ << "\n";
+        csv_.flush();   // A crashed soak keeps every row written so far
+    }
+
+    if (elapsed_s < options_.warmup_s) {
+        return;
+    }
+    if (!have_baseline_) {
+        have_baseline_ = true;
+        baseline_ = stats;
+        baseline_gl_ = gl_objects;
+        LogLine(LogLevel::Info) << "Soak: baseline after " << static_cast<int>(elapsed_s) << " s: RSS "
+                                << static_cast<int>(stats.rss_mb) << " MB, private "
+                                << static_cast<int>(stats.private_mb) << " MB, " << stats.handles << " handles";
+    }
+
+    if (stats.rss_mb >= 0.0) {
+        const double hours = elapsed_s / 3600.0;
+        sum_t_ += hours;
+        sum_m_ += stats.rss_mb;
+        sum_tt_ += hours * hours;
+        sum_tm_ += hours * stats.rss_mb;
+        ++slope_samples_;
+    }
+
+    if (failed_) {
+        return;
+    }
+    const Summary summary = get_summary();
+    if (baseline_.rss_mb >= 0.0) {
+        check("RSS", summary.rss_growth_mb, options_.max_rss_growth_mb, "MB");
+    }
+    if (baseline_.private_mb >= 0.0) {
+        check("private bytes", summary.private_growth_mb, options_.max_private_growth_mb, "MB");
+    }
+    if (baseline_.handles >= 0) {
+        check("handles", static_cast<double>(summary.handle_growth), options_.max_handle_growth, "");
+    }
+    if (baseline_gl_ >= 0 && gl_objects >= 0) {
+        check("GL objects", static_cast<double>(summary.gl_growth), options_.max_gl_growth, "");
+    }
+}
+
+void SoakMonitor::check(const char* what, double growth, double limit, const char* unit) {
+    if (failed_ || limit <= 0.0 || growth <= limit) {
+        return;
+    }
+    failed_ = true;
+    std::ostringstream text;
+    text << what << " grew " << growth << (unit[0] ? " " : "") << unit << " over the baseline (limit " << limit
+         << (unit[0] ? " " : "") << unit << ")";
+    failure_ = text.str();
+    LogLine(LogLevel::Error) << "Soak: FAILED, " << failure_;
+}
+
+SoakMonitor::Summary SoakMonitor::get_summary() const {
+    Summary summary;
+    summary.samples = samples_;
+    summary.baseline = have_baseline_;
+    if (!have_baseline_) {
+        return summary;
+    }
+    summary.rss_growth_mb = latest_.rss_mb - baseline_.rss_mb;
+    summary.private_growth_mb = latest_.private_mb - baseline_.private_mb;
+    summary.handle_growth = latest_.handles - baseline_.handles;
+    summary.gl_growth = (baseline_gl_ >= 0 && latest_gl_ >= 0) ? latest_gl_ - baseline_gl_ : 0;
+    const double denominator = slope_samples_ * sum_tt_ - sum_t_ * sum_t_;
+    if (slope_samples_ >= 2 && denominator > 0.0) {
+        summary.rss_slope_mb_per_h = (slope_samples_ * sum_tm_ - sum_t_ * sum_m_) / denominator;
+    }
+    return summary;
+}
+
+} // namespace core
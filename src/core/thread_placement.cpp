@@ -0,0 +1,271 @@
+#include "core/thread_placement.h"
+#include "core/profiler.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace core {
+
+namespace {
+
+// One processor group (Windows affinity masks are 64 bits wide)
+constexpr int MAX_CORES = 64;
+
+int core_count() {
+    return std::min(static_cast<int>(std::thread::hardware_concurrency()), MAX_CORES);
+}
+
+/**
+ * Restrict the calling thread to the cores set in mask
+ */
+bool set_affinity(uint64_t mask) {
+    if (mask == 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(mask)) != 0;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int core = 0; core < MAX_CORES; ++core) {
+        if (mask & (uint64_t(1) << core)) {
+            CPU_SET(core, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+}
+
+#ifdef _WIN32
+/**
+ * avrt.dll entry points, loaded on first use (no import, so a missing DLL is just a fallback)
+ */
+struct Avrt {
+    using SetCharacteristics = HANDLE(WINAPI*)(LPCSTR, LPDWORD);
+    using SetPriority = BOOL(WINAPI*)(HANDLE, int);
+    SetCharacteristics set_characteristics = nullptr;
+    SetPriority set_priority = nullptr;
+};
+
+const Avrt& avrt() {
+    static const Avrt functions = [] {
+        Avrt loaded;
+        if (HMODULE module = LoadLibraryA("avrt.dll")) {
+            loaded.set_characteristics = reinterpret_cast<Avrt::SetCharacteristics>(
+                reinterpret_cast<void*>(GetProcAddress(module, "AvSetMmThreadCharacteristicsA")));
+            loaded.set_priority = reinterpret_cast<Avrt::SetPriority>(
+                reinterpret_cast<void*>(GetProcAddress(module, "AvSetMmThreadPriority")));
+        }
+        return loaded;
+    }();
+    return functions;
+}
+
+/**
+ * Join the calling thread to an MMCSS task at a relative priority
+ */
+bool join_mmcss(const std::string& task, ThreadPriority priority) {
+    const Avrt& functions = avrt();
+    if (!functions.set_characteristics) {
+        return false;
+    }
+    DWORD task_index = 0;
+    HANDLE handle = functions.set_characteristics(task.c_str(), &task_index);
+    if (!handle) {
+        return false;
+    }
+    // AVRT_PRIORITY: very low -2, low -1, normal 0, high 1, critical 2
+    static constexpr int AVRT_PRIORITY[] = {-2, -1, 0, 1, 1, 2};
+    if (priority != ThreadPriority::Normal && functions.set_priority) {
+        functions.set_priority(handle, AVRT_PRIORITY[static_cast<int>(priority)]);
+    }
+    return true;
+}
+#endif
+
+bool set_priority(ThreadPriority priority) {
+    if (priority == ThreadPriority::Normal) {
+        return true;
+    }
+#ifdef _WIN32
+    static constexpr int WIN_PRIORITY[] = {
+        THREAD_PRIORITY_IDLE, THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL,
+        THREAD_PRIORITY_ABOVE_NORMAL, THREAD_PRIORITY_HIGHEST, THREAD_PRIORITY_TIME_CRITICAL
+    };
+    return SetThreadPriority(GetCurrentThread(), WIN_PRIORITY[static_cast<int>(priority)]) != 0;
+#else
+    return false;  // Priority classes need privileges outside Windows; keep the default
+#endif
+}
+
+} // namespace
+
+void ThreadPlacements::set(ThreadStage stage, const ThreadPlacement& placement) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    placements_[static_cast<size_t>(stage)] = placement;
+}
+
+ThreadPlacement ThreadPlacements::get(ThreadStage stage) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return placements_[static_cast<size_t>(stage)];
+}
+
+void ThreadPlacements::set_isolate_decode(bool isolate) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    isolate_decode_ = isolate;
+}
+
+bool ThreadPlacements::is_decode_isolated() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return isolate_decode_;
+}
+
+std::vector<int> ThreadPlacements::reserved_cores() const {
+    if (!isolate_decode_) {
+        return {};
+    }
+    std::vector<int> cores;
+    for (int core : placements_[static_cast<size_t>(ThreadStage::Decode)].cores) {
+        if (core >= 0) {
+            cores.push_back(core);
+        }
+    }
+    return cores;
+}
+
+bool ThreadPlacements::place_current_thread(ThreadStage stage, int index) const {
+    PROFILE_THREAD(std::string(stage_name(stage)) + " " + std::to_string(index));
+
+    ThreadPlacement placement;
+    std::vector<int> reserved;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        placement = placements_[static_cast<size_t>(stage)];
+        if (stage != ThreadStage::Decode) {
+            reserved = reserved_cores();
+        }
+    }
+
+    const size_t slot = static_cast<size_t>(std::max(index, 0));
+    const int core = slot < placement.cores.size() ? placement.cores[slot] : -1;
+    const int cores = core_count();
+    bool ok = true;
+
+    if (core >= 0) {
+        if (std::find(reserved.begin(), reserved.end(), core) != reserved.end()) {
+            std::cerr << "Threads: " << stage_name(stage) << " " << index << " pinned to isolated decode core "
+                      << core << std::endl;
+        }
+        ok = core < cores && set_affinity(uint64_t(1) << core);
+        if (ok) {
+            std::cout << "Threads: " << stage_name(stage) << " " << index << " pinned to core " << core << std::endl;
+        } else {
+            std::cerr << "Threads: cannot pin " << stage_name(stage) << " " << index << " to core " << core
+                      << " (" << cores << " cores), left unpinned" << std::endl;
+        }
+    } else if (!reserved.empty()) {
+        // Anywhere but the decode cores
+        uint64_t mask = cores >= MAX_CORES ? ~uint64_t(0) : (uint64_t(1) << cores) - 1;
+        for (int reserved_core : reserved) {
+            if (reserved_core < MAX_CORES) {
+                mask &= ~(uint64_t(1) << reserved_core);
+            }
+        }
+        ok = set_affinity(mask);
+        if (!ok) {
+            std::cerr << "Threads: cannot keep " << stage_name(stage) << " " << index
+                      << " off the decode cores" << std::endl;
+        }
+    }
+
+#ifdef _WIN32
+    if (!placement.mmcss_task.empty()) {
+        if (join_mmcss(placement.mmcss_task, placement.priority)) {
+            std::cout << "Threads: " << stage_name(stage) << " " << index << " joined MMCSS task \""
+                      << placement.mmcss_task << "\"" << std::endl;
+            return ok;
+        }
+        std::cerr << "Threads: cannot join MMCSS task \"" << placement.mmcss_task << "\" for " << stage_name(stage)
+                  << " " << index << ", using the thread priority" << std::endl;
+    }
+#endif
+    if (!set_priority(placement.priority)) {
+        std::cerr << "Threads: cannot set " << stage_name(stage) << " priority "
+                  << priority_name(placement.priority) << ", left at normal" << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+std::vector<int> ThreadPlacements::parse_cores(const std::string& list) {
+    std::vector<int> cores;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        item.erase(0, item.find_first_not_of(" \t"));
+        cores.push_back(item.empty() ? -1 : std::atoi(item.c_str()));
+    }
+    return cores;
+}
+
+std::string ThreadPlacements::format_cores(const std::vector<int>& cores) {
+    std::string list;
+    for (size_t i = 0; i < cores.size(); ++i) {
+        if (i > 0) {
+            list += ",";
+        }
+        if (cores[i] >= 0) {
+            list += std::to_string(cores[i]);
+        }
+    }
+    return list;
+}
+
+bool ThreadPlacements::parse_priority(const std::string& name, ThreadPriority& priority) {
+    for (int i = 0; i <= static_cast<int>(ThreadPriority::Critical); ++i) {
+        if (name == priority_name(static_cast<ThreadPriority>(i))) {
+            priority = static_cast<ThreadPriority>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* ThreadPlacements::priority_name(ThreadPriority priority) {
+    switch (priority) {
+        case ThreadPriority::Idle: return "idle";
+        case ThreadPriority::Low: return "low";
+        case ThreadPriority::Normal: return "normal";
+        case ThreadPriority::High: return "high";
+        case ThreadPriority::Highest: return "highest";
+        case ThreadPriority::Critical: return "critical";
+    }
+    return "normal";
+}
+
+const char* ThreadPlacements::stage_name(ThreadStage stage) {
+    switch (stage) {
+        case ThreadStage::Decode: return "decode";
+        case ThreadStage::Accumulation: return "accumulation";
+        case ThreadStage::Analysis: return "analysis";
+        case ThreadStage::IO: return "io";
+        case ThreadStage::UI: return "ui";
+        case ThreadStage::Count: break;
+    }
+    return "unknown";
+}
+
+} // namespace core
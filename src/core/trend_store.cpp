@@ -0,0 +1,354 @@
+#include "core/trend_store.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace core {
+
+namespace {
+
+constexpr char HISTORY_MAGIC[8] = {'R', 'T', 'T', 'R', 'E', 'N', 'D', '\0'};
+constexpr uint32_t HISTORY_VERSION = 1;
+
+// Largest tier period: every tier's buckets start on the origin
+constexpr int64_t ORIGIN_ALIGN_S = 600;
+
+int64_t unix_now_s() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+template <typename T>
+void write_pod(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool read_pod(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+} // namespace
+
+// ============================================================================
+// TrendSeries
+// ============================================================================
+
+constexpr TrendSeries::TierSpec TrendSeries::TIERS[TrendSeries::TIER_COUNT];
+
+TrendSeries::TrendSeries(std::string name, int64_t origin_s)
+    : name_(std::move(name))
+    , origin_s_(origin_s) {
+    for (int i = 0; i < TIER_COUNT; ++i) {
+        tiers_[i].capacity = TIERS[i].capacity;
+        tiers_[i].period_s = TIERS[i].period_s;
+        tiers_[i].slots = std::make_unique<Slot[]>(TIERS[i].capacity);
+    }
+}
+
+void TrendSeries::store(Slot& slot, const TrendBucket& bucket) {
+    slot.min.store(bucket.min, std::memory_order_relaxed);
+    slot.max.store(bucket.max, std::memory_order_relaxed);
+    slot.mean.store(bucket.mean, std::memory_order_relaxed);
+    slot.count.store(bucket.count, std::memory_order_relaxed);
+}
+
+void TrendSeries::advance(Tier& tier, uint64_t target) {
+    // After a long gap only the last capacity buckets are still reachable
+    const uint64_t first_empty = std::max(tier.current + 1, target > tier.capacity ? target - tier.capacity : 0);
+
+    tier.writing.store(target, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (first_empty == tier.current + 1) {
+        TrendBucket bucket;
+        if (tier.count > 0) {
+            bucket.min = tier.min;
+            bucket.max = tier.max;
+            bucket.mean = static_cast<float>(tier.sum / tier.count);
+            bucket.count = tier.count;
+        }
+        store(tier.slots[tier.current % tier.capacity], bucket);
+    }
+    for (uint64_t n = first_empty; n < target; ++n) {
+        store(tier.slots[n % tier.capacity], TrendBucket{});
+    }
+
+    tier.published.store(target, std::memory_order_release);
+    tier.current = target;
+    tier.sum = 0.0;
+    tier.count = 0;
+}
+
+void TrendSeries::append(int64_t unix_s, double value) {
+    if (unix_s < origin_s_) {
+        return;
+    }
+
+    const float v = static_cast<float>(value);
+    for (Tier& tier : tiers_) {
+        // A clock stepped backwards folds into the bucket in progress
+        const uint64_t n = static_cast<uint64_t>((unix_s - origin_s_) / tier.period_s);
+        if (n > tier.current) {
+            advance(tier, n);
+        }
+
+        if (tier.count == 0) {
+            tier.min = v;
+            tier.max = v;
+        } else {
+            tier.min = std::min(tier.min, v);
+            tier.max = std::max(tier.max, v);
+        }
+        tier.sum += value;
+        ++tier.count;
+    }
+}
+
+uint64_t TrendSeries::read(int tier_index, std::vector<TrendBucket>& buckets, size_t max_buckets) const {
+    const Tier& tier = tiers_[tier_index];
+    const uint64_t end = tier.published.load(std::memory_order_acquire);
+
+    size_t available = static_cast<size_t>(std::min<uint64_t>(end, tier.capacity));
+    if (max_buckets > 0) {
+        available = std::min(available, max_buckets);
+    }
+    uint64_t first = end - available;
+
+    buckets.resize(available);
+    for (size_t i = 0; i < available; ++i) {
+        const Slot& slot = tier.slots[(first + i) % tier.capacity];
+        buckets[i].min = slot.min.load(std::memory_order_relaxed);
+        buckets[i].max = slot.max.load(std::memory_order_relaxed);
+        buckets[i].mean = slot.mean.load(std::memory_order_relaxed);
+        buckets[i].count = slot.count.load(std::memory_order_relaxed);
+    }
+
+    // Slots the writer started recycling while we copied are not ours any more
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t writing = tier.writing.load(std::memory_order_relaxed);
+    const uint64_t valid_from = writing > tier.capacity ? writing - tier.capacity : 0;
+    if (valid_from > first) {
+        const size_t stale = static_cast<size_t>(std::min<uint64_t>(valid_from - first, available));
+        buckets.erase(buckets.begin(), buckets.begin() + stale);
+        first += stale;
+    }
+    return first;
+}
+
+void TrendSeries::save(std::ostream& out) const {
+    const uint32_t name_length = static_cast<uint32_t>(name_.size());
+    write_pod(out, name_length);
+    out.write(name_.data(), name_length);
+
+    std::vector<TrendBucket> buckets;
+    for (int i = 0; i < TIER_COUNT; ++i) {
+        const uint64_t first = read(i, buckets);
+        const uint64_t count = buckets.size();
+        write_pod(out, tiers_[i].period_s);
+        write_pod(out, static_cast<uint64_t>(tiers_[i].capacity));
+        write_pod(out, first);
+        write_pod(out, count);
+        out.write(reinterpret_cast<const char*>(buckets.data()), count * sizeof(TrendBucket));
+    }
+}
+
+bool TrendSeries::load(std::istream& in) {
+    uint32_t name_length = 0;
+    if (!read_pod(in, name_length) || name_length != name_.size()) {
+        return false;
+    }
+    std::string name(name_length, '\0');
+    if (!in.read(&name[0], name_length) || name != name_) {
+        return false;
+    }
+
+    std::vector<TrendBucket> buckets;
+    for (Tier& tier : tiers_) {
+        int period_s = 0;
+        uint64_t capacity = 0;
+        uint64_t first = 0;
+        uint64_t count = 0;
+        if (!read_pod(in, period_s) || !read_pod(in, capacity) || !read_pod(in, first) || !read_pod(in, count) ||
+            period_s != tier.period_s || capacity != tier.capacity || count > capacity) {
+            return false;
+        }
+
+        buckets.resize(static_cast<size_t>(count));
+        if (!in.read(reinterpret_cast<char*>(buckets.data()), count * sizeof(TrendBucket))) {
+            return false;
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+            store(tier.slots[(first + i) % tier.capacity], buckets[i]);
+        }
+
+        // Next sample after the restart opens the bucket following the saved ones
+        tier.current = first + count;
+        tier.sum = 0.0;
+        tier.count = 0;
+        tier.writing.store(tier.current, std::memory_order_relaxed);
+        tier.published.store(tier.current, std::memory_order_release);
+    }
+    return true;
+}
+
+// ============================================================================
+// TrendStore
+// ============================================================================
+
+TrendStore::TrendStore()
+    : origin_s_(unix_now_s() / ORIGIN_ALIGN_S * ORIGIN_ALIGN_S) {
+    series_[EventRate] = std::make_unique<TrendSeries>("event_rate", origin_s_);
+    series_[Scattering] = std::make_unique<TrendSeries>("scattering_percentage", origin_s_);
+    series_[Temperature] = std::make_unique<TrendSeries>("temperature_c", origin_s_);
+}
+
+TrendStore::~TrendStore() {
+    stop();
+}
+
+bool TrendStore::start(const std::string& history_path) {
+    stop();
+    history_path_ = history_path;
+    if (!history_path_.empty()) {
+        load_history();
+    }
+
+    running_ = true;
+    thread_ = std::thread(&TrendStore::sample_loop, this);
+    return true;
+}
+
+void TrendStore::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    wake_cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (!history_path_.empty()) {
+        save_history();
+    }
+}
+
+void TrendStore::sample_loop() {
+    auto& registry = MetricsRegistry::instance();
+    const Counter& events = registry.counter("events.ingested");
+    const Gauge& scattering = registry.gauge("scattering.percentage");
+    const Gauge& temperature = registry.gauge("camera.temperature_c");
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point last_sample = Clock::now();
+    int64_t last_events = events.value();
+    int64_t last_save_s = unix_now_s();
+
+    while (running_.load()) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_for(lock, std::chrono::seconds(1), [this] { return !running_.load(); });
+        }
+        if (!running_.load()) {
+            break;
+        }
+
+        const Clock::time_point now = Clock::now();
+        const double elapsed = std::chrono::duration<double>(now - last_sample).count();
+        const int64_t total = events.value();
+        const int64_t unix_s = unix_now_s();
+        last_sample = now;
+
+        if (elapsed > 0.0) {
+            series_[EventRate]->append(unix_s, (total - last_events) / elapsed);
+        }
+        last_events = total;
+
+        // Only while scattering analysis runs (the worker clears the gauge on stop)
+        if (scattering.has_value()) {
+            series_[Scattering]->append(unix_s, scattering.value());
+        }
+
+        // Set by the camera's monitoring thread (CameraManager::start_monitoring)
+        if (temperature.has_value()) {
+            series_[Temperature]->append(unix_s, temperature.value());
+        }
+
+        if (!history_path_.empty() && unix_s - last_save_s >= SAVE_INTERVAL_S) {
+            save_history();
+            last_save_s = unix_s;
+        }
+    }
+}
+
+bool TrendStore::load_history() {
+    std::ifstream file(history_path_, std::ios::binary);
+    if (!file.is_open()) {
+        return false;  // First run
+    }
+
+    char magic[sizeof(HISTORY_MAGIC)] = {};
+    uint32_t version = 0;
+    int64_t origin_s = 0;
+    uint32_t series_count = 0;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, HISTORY_MAGIC, sizeof(magic)) != 0 ||
+        !read_pod(file, version) || version != HISTORY_VERSION ||
+        !read_pod(file, origin_s) || !read_pod(file, series_count) || series_count == 0 || series_count > SERIES_COUNT ||
+        origin_s % ORIGIN_ALIGN_S != 0 || origin_s > unix_now_s()) {
+        std::cerr << "TrendStore: Ignoring incompatible history file " << history_path_ << std::endl;
+        return false;
+    }
+
+    // Rebuild on the saved origin so bucket numbers keep their meaning; series
+    // added since the file was written start empty
+    std::array<std::unique_ptr<TrendSeries>, SERIES_COUNT> loaded;
+    for (int i = 0; i < SERIES_COUNT; ++i) {
+        loaded[i] = std::make_unique<TrendSeries>(series_[i]->name(), origin_s);
+        if (static_cast<uint32_t>(i) < series_count && !loaded[i]->load(file)) {
+            std::cerr << "TrendStore: Ignoring damaged history file " << history_path_ << std::endl;
+            return false;
+        }
+    }
+
+    origin_s_ = origin_s;
+    series_ = std::move(loaded);
+    std::cout << "TrendStore: Restored history from " << history_path_ << std::endl;
+    return true;
+}
+
+bool TrendStore::save_history() const {
+    // Write a temporary file first so a crash mid-write keeps the previous history
+    const std::string temp_path = history_path_ + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "TrendStore: Failed to write " << temp_path << std::endl;
+            return false;
+        }
+
+        file.write(HISTORY_MAGIC, sizeof(HISTORY_MAGIC));
+        write_pod(file, HISTORY_VERSION);
+        write_pod(file, origin_s_);
+        write_pod(file, static_cast<uint32_t>(SERIES_COUNT));
+        for (const auto& series : series_) {
+            series->save(file);
+        }
+        if (!file.good()) {
+            std::cerr << "TrendStore: Failed to write " << temp_path << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, history_path_, ec);
+    if (ec) {
+        std::cerr << "TrendStore: Failed to replace " << history_path_ << ": " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace core
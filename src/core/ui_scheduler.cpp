@@ -0,0 +1,102 @@
+#include "core/ui_scheduler.h"
+#include <algorithm>
+#include <chrono>
+
+namespace core {
+
+int64_t UiScheduler::now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void UiScheduler::set_event_functions(WaitFunction wait, WakeFunction wake) {
+    wait_ = std::move(wait);
+    wake_ = std::move(wake);
+}
+
+void UiScheduler::set_rates(int max_fps, int idle_fps) {
+    max_fps_ = std::max(max_fps, 0);
+    idle_fps_ = std::max(idle_fps, 1);
+}
+
+void UiScheduler::set_present_pacing(bool enabled, int refresh_hz) {
+    pacing_ = enabled;
+    refresh_hz_ = refresh_hz > 0 ? refresh_hz : 60;
+    last_present_us_ = 0;
+    predicted_work_us_ = 0;
+}
+
+void UiScheduler::on_presented() {
+    if (!pacing_) {
+        return;
+    }
+    last_present_us_ = now_us();
+
+    // Decaying peak: jumps up to a slow iteration, relaxes by 1/16 per present
+    const int64_t work = last_present_us_ - last_frame_us_;
+    predicted_work_us_ = work >= predicted_work_us_ ? work
+                                                    : predicted_work_us_ - (predicted_work_us_ - work) / 16;
+}
+
+int64_t UiScheduler::earliest_start_us() const {
+    if (!pacing_) {
+        return max_fps_ > 0 ? last_frame_us_ + 1000000 / max_fps_ : 0;
+    }
+    // Next present lands one period after the last; start just early enough to make it
+    const int64_t period = 1000000 / (max_fps_ > 0 ? max_fps_ : refresh_hz_);
+    return last_present_us_ + period - predicted_work_us_ - PACING_MARGIN_US;
+}
+
+void UiScheduler::notify_frame() {
+    frame_ready_.store(true);
+
+    // Only the producer that ends a wait posts a wake event; the rest are free
+    if (waiting_.load(std::memory_order_relaxed) && waiting_.exchange(false) && wake_) {
+        wake_();
+    }
+}
+
+void UiScheduler::wait_for_next_frame(bool minimized) {
+    if (!wait_) {
+        return;
+    }
+
+    // 1. Pace to max_fps (or the present period); input arriving meanwhile is handled and counts for this frame
+    bool waited = false;
+    const int64_t earliest = earliest_start_us();
+    for (int64_t now = now_us(); now < earliest; now = now_us()) {
+        wait_((earliest - now) / 1e6);
+        waited = true;
+    }
+
+    // 2. Nothing new yet: sleep until a frame, input or the idle refresh
+    bool frame = !minimized && frame_ready_.exchange(false);
+    if (!frame) {
+        const int64_t idle_deadline = last_frame_us_ + 1000000 / idle_fps_;
+        const int64_t now = now_us();
+        if (now < idle_deadline) {
+            // Frames don't end the wait while minimized (nothing is shown)
+            waiting_.store(!minimized);
+
+            // A frame stored between the exchange above and the flag is seen here
+            if (minimized || !frame_ready_.load()) {
+                wait_((idle_deadline - now) / 1e6);
+                waited = true;
+            }
+            waiting_.store(false);
+        }
+        frame = !minimized && frame_ready_.exchange(false);
+    }
+
+    // Events still have to be processed when no wait ran this iteration
+    if (!waited) {
+        wait_(0.0);
+    }
+
+    if (!frame) {
+        ++idle_frames_;
+    }
+    last_frame_us_ = now_us();
+}
+
+} // namespace core
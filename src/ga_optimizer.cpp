@@ -0,0 +1,290 @@
+#include "ga_optimizer.h"
+#include "camera_manager.h"
+#include <metavision/hal/device/device.h>
+#include <metavision/hal/facilities/i_ll_biases.h>
+#include <metavision/hal/facilities/i_event_trail_filter_module.h>
+#include <metavision/hal/facilities/i_antiflicker_module.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+const char* const OPTIMIZED_BIASES[] = {"bias_diff_on", "bias_diff_off", "bias_hpf", "bias_refr"};
+
+// Score given to a step that captured nothing, so it is never bred from
+constexpr double FAILED_FITNESS = -1000.0;
+
+/**
+ * Anti-flicker needs low < high; crossover and mutation can break that
+ */
+void repair_band(uint32_t& low, uint32_t& high, uint32_t max_hz) {
+    if (low > high) std::swap(low, high);
+    if (low == high) {
+        if (high < max_hz) high++;
+        else low--;
+    }
+}
+
+} // namespace
+
+GAOptimizer::GAOptimizer(video::FrameBuffer& source) : sweep_(source) {
+}
+
+std::vector<core::GeneticOptimizer::Gene> GAOptimizer::build_genes(const Options& options) {
+    std::vector<core::GeneticOptimizer::Gene> genes;
+
+    if (options.optimize_biases && biases_) {
+        for (const char* name : OPTIMIZED_BIASES) {
+            try {
+                Metavision::LL_Bias_Info info;
+                if (biases_->get_bias_info(name, info) && info.is_modifiable()) {
+                    const auto range = info.get_bias_range();
+                    genes.push_back({name, range.first, range.second});
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "GAOptimizer: No range for " << name << ": " << e.what() << std::endl;
+            }
+        }
+    }
+
+    if (options.optimize_trail_filter && trail_filter_) {
+        try {
+            const int min_us = static_cast<int>(trail_filter_->get_min_supported_threshold());
+            const int max_us = static_cast<int>(trail_filter_->get_max_supported_threshold());
+            genes.push_back({"trail_filter_enabled", 0, 1});
+            genes.push_back({"trail_filter_threshold", min_us, max_us});
+        } catch (const std::exception& e) {
+            std::cerr << "GAOptimizer: Trail filter limits unavailable: " << e.what() << std::endl;
+        }
+    }
+
+    if (options.optimize_antiflicker && antiflicker_) {
+        try {
+            const int min_hz = static_cast<int>(antiflicker_->get_min_supported_frequency());
+            const int max_hz = static_cast<int>(antiflicker_->get_max_supported_frequency());
+            genes.push_back({"antiflicker_enabled", 0, 1});
+            genes.push_back({"antiflicker_low_hz", min_hz, max_hz});
+            genes.push_back({"antiflicker_high_hz", min_hz, max_hz});
+        } catch (const std::exception& e) {
+            std::cerr << "GAOptimizer: Anti-flicker limits unavailable: " << e.what() << std::endl;
+        }
+    }
+    return genes;
+}
+
+std::vector<int> GAOptimizer::read_current() const {
+    const auto& genes = optimizer_.get_genes();
+    std::vector<int> values(genes.size(), 0);
+    try {
+        for (size_t i = 0; i < genes.size(); ++i) {
+            const std::string& name = genes[i].name;
+            if (name == "trail_filter_enabled") values[i] = trail_filter_->is_enabled() ? 1 : 0;
+            else if (name == "trail_filter_threshold") values[i] = static_cast<int>(trail_filter_->get_threshold());
+            else if (name == "antiflicker_enabled") values[i] = antiflicker_->is_enabled() ? 1 : 0;
+            else if (name == "antiflicker_low_hz") values[i] = static_cast<int>(antiflicker_->get_band_low_frequency());
+            else if (name == "antiflicker_high_hz") values[i] = static_cast<int>(antiflicker_->get_band_high_frequency());
+            else values[i] = biases_->get(name);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "GAOptimizer: Failed to read camera settings: " << e.what() << std::endl;
+        return {};
+    }
+    return values;
+}
+
+bool GAOptimizer::apply(const std::vector<int>& values) {
+    const auto& genes = optimizer_.get_genes();
+    bool ok = true;
+    int trail_enabled = -1;
+    int antiflicker_enabled = -1;
+    uint32_t band_low = 0, band_high = 0;
+    bool has_band = false;
+    std::map<std::string, int> bias_values;
+
+    try {
+        for (size_t i = 0; i < genes.size(); ++i) {
+            const std::string& name = genes[i].name;
+            if (name == "trail_filter_enabled") trail_enabled = values[i];
+            else if (name == "trail_filter_threshold") ok &= trail_filter_->set_threshold(static_cast<uint32_t>(values[i]));
+            else if (name == "antiflicker_enabled") antiflicker_enabled = values[i];
+            else if (name == "antiflicker_low_hz") { band_low = static_cast<uint32_t>(values[i]); has_band = true; }
+            else if (name == "antiflicker_high_hz") band_high = static_cast<uint32_t>(values[i]);
+            else bias_values[name] = values[i];
+        }
+
+        // Biases in one pass that skips the ones this candidate shares with the last
+        if (!bias_values.empty()) {
+            ok &= CameraManager::write_biases(biases_, bias_values) >= 0;
+        }
+
+        // Enables last, so a filter never runs with the previous step's settings
+        if (trail_enabled >= 0) {
+            ok &= trail_filter_->enable(trail_enabled != 0);
+        }
+        if (has_band) {
+            repair_band(band_low, band_high, antiflicker_->get_max_supported_frequency());
+            ok &= antiflicker_->set_frequency_band(band_low, band_high);
+        }
+        if (antiflicker_enabled >= 0) {
+            ok &= antiflicker_->enable(antiflicker_enabled != 0);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "GAOptimizer: Failed to apply settings: " << e.what() << std::endl;
+        return false;
+    }
+    return ok;
+}
+
+double GAOptimizer::fitness(const BiasSweep::StepResult& result) {
+    if (result.frames == 0) {
+        return FAILED_FITNESS;
+    }
+    if (result.scattering_percent >= 0.0) {
+        return -(result.scattering_percent + result.missing_percent);
+    }
+    return result.snr_db;
+}
+
+bool GAOptimizer::run(Metavision::Device& device, const Options& options,
+                      const std::function<bool()>& should_stop) {
+    biases_ = device.get_facility<Metavision::I_LL_Biases>();
+    trail_filter_ = device.get_facility<Metavision::I_EventTrailFilterModule>();
+    antiflicker_ = device.get_facility<Metavision::I_AntiFlickerModule>();
+    checkpoint_path_ = options.checkpoint_path;
+
+    const std::vector<core::GeneticOptimizer::Gene> genes = build_genes(options);
+    if (!optimizer_.reset(options.ga, genes, {})) {
+        std::cerr << "GAOptimizer: Nothing to optimize (no enabled parameter is supported by the camera)"
+                  << std::endl;
+        return false;
+    }
+
+    // Restored when a run is stopped; also the seed of a fresh run
+    const std::vector<int> original = read_current();
+    if (original.empty()) {
+        return false;
+    }
+    optimizer_.reset(options.ga, genes, original);
+
+    bool resumed = false;
+    if (options.resume && !checkpoint_path_.empty()) {
+        resumed = optimizer_.load(checkpoint_path_);
+        if (resumed) {
+            std::cout << "GAOptimizer: Resumed " << checkpoint_path_ << " at evaluation "
+                      << optimizer_.get_evaluations() << "/" << optimizer_.get_budget() << std::endl;
+        } else {
+            std::cout << "GAOptimizer: No usable checkpoint at " << checkpoint_path_ << ", starting fresh" << std::endl;
+        }
+    }
+
+    csv_.open(options.csv_path, resumed ? std::ios::app : std::ios::trunc);
+    if (!csv_.is_open()) {
+        std::cerr << "GAOptimizer: Cannot open " << options.csv_path << " for writing" << std::endl;
+        return false;
+    }
+    if (!resumed) {
+        csv_ << "evaluation,generation,candidate";
+        for (const auto& gene : genes) {
+            csv_ << "," << gene.name;
+        }
+        csv_ << ",fitness,best_fitness,frames,event_rate_kevps,dropped_events,active_mean_percent,"
+                "toggle_percent,scattering_percent,missing_percent,snr_db\n";
+    }
+
+    std::cout << "GAOptimizer: " << genes.size() << " genes, population " << options.ga.population_size
+              << ", budget " << optimizer_.get_budget() << " evaluations, " << options.measure.settle_ms
+              << " ms settle, " << std::max(1, options.measure.frames) << " frames each -> "
+              << options.csv_path << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    const int start_evaluations = optimizer_.get_evaluations();
+    in_flight_.clear();
+
+    const bool completed = sweep_.measure(
+        [&](int step) {
+            core::GeneticOptimizer::Candidate candidate;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!optimizer_.propose(candidate)) {
+                    return BiasSweep::StepStatus::Done;
+                }
+                in_flight_[step] = candidate;
+            }
+            return apply(candidate.values) ? BiasSweep::StepStatus::Ready : BiasSweep::StepStatus::Failed;
+        },
+        [this](const BiasSweep::StepResult& result) { on_result(result); },
+        options.measure, should_stop);
+    csv_.close();
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    const int evaluated = optimizer_.get_evaluations() - start_evaluations;
+    std::cout << "GAOptimizer: " << evaluated << " evaluations in " << elapsed << " s";
+    if (evaluated > 0) {
+        std::cout << " (" << elapsed / evaluated << " s each)";
+    }
+    std::cout << (completed ? "" : ", stopped early (resume from the checkpoint)") << std::endl;
+
+    if (completed && optimizer_.has_best()) {
+        const auto& best = optimizer_.get_best();
+        if (apply(best.values)) {
+            print_genome("Best (applied)", best.values, best.fitness);
+        }
+    } else if (apply(original)) {
+        std::cout << "GAOptimizer: Restored original settings" << std::endl;
+    }
+    return completed;
+}
+
+void GAOptimizer::on_result(const BiasSweep::StepResult& result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = in_flight_.find(result.step);
+    if (it == in_flight_.end()) {
+        return;
+    }
+    const core::GeneticOptimizer::Candidate candidate = it->second;
+    in_flight_.erase(it);
+
+    const double score = fitness(result);
+    const bool improved = optimizer_.report(candidate, score);
+    const int evaluation = optimizer_.get_evaluations();
+
+    csv_ << evaluation << "," << (evaluation - 1) / optimizer_.settings().population_size << ","
+         << candidate.id;
+    for (int value : candidate.values) {
+        csv_ << "," << value;
+    }
+    csv_ << "," << score << "," << optimizer_.get_best().fitness << "," << result.frames << ","
+         << result.event_rate_kevps << "," << result.dropped_events << ","
+         << result.active_mean_percent << "," << result.toggle_percent << ",";
+    if (result.scattering_percent >= 0.0) {
+        csv_ << result.scattering_percent << "," << result.missing_percent;
+    } else {
+        csv_ << ",";
+    }
+    csv_ << "," << result.snr_db << "\n";
+    csv_.flush();  // A stopped run keeps every finished row
+
+    // After every result: a stop loses at most the candidates still in flight
+    if (!checkpoint_path_.empty()) {
+        optimizer_.save(checkpoint_path_);
+    }
+
+    std::cout << "GAOptimizer: evaluation " << evaluation << "/" << optimizer_.get_budget()
+              << " (generation " << optimizer_.get_generation() << ") fitness " << score
+              << ", best " << optimizer_.get_best().fitness << std::endl;
+    if (improved) {
+        print_genome("New best", candidate.values, score);
+    }
+}
+
+void GAOptimizer::print_genome(const char* label, const std::vector<int>& values, double fitness) const {
+    // Printed as key = value lines; the bias and trail filter names match event_config.ini
+    std::cout << "GAOptimizer: " << label << ", fitness " << fitness << ":" << std::endl;
+    const auto& genes = optimizer_.get_genes();
+    for (size_t i = 0; i < genes.size() && i < values.size(); ++i) {
+        std::cout << "  " << genes[i].name << " = " << values[i] << std::endl;
+    }
+}
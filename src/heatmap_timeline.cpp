@@ -0,0 +1,278 @@
+#include "heatmap_timeline.h"
+#include "core/profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+// magic, keyframe flag, time, frames analyzed, changed pixels, payload bytes
+constexpr size_t RECORD_HEADER_BYTES = 4 + 1 + 8 + 8 + 4 + 4;
+
+int64_t unix_now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+template <typename T>
+void write_pod(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool read_pod(const std::vector<uint8_t>& data, size_t& offset, T& value) {
+    if (data.size() - offset < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        const uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Encode counts against base (nullptr = all zeros)
+ * @return Changed pixels, or -1 if a count is below its base (base is stale)
+ */
+int64_t encode(const cv::Mat& counts, const cv::Mat* base, std::vector<uint8_t>& out) {
+    out.clear();
+    int64_t changed = 0;
+    int64_t previous = -1;
+    for (int y = 0; y < counts.rows; ++y) {
+        const int32_t* row = counts.ptr<int32_t>(y);
+        const int32_t* base_row = base ? base->ptr<int32_t>(y) : nullptr;
+        for (int x = 0; x < counts.cols; ++x) {
+            const int32_t from = base_row ? base_row[x] : 0;
+            if (row[x] == from) {
+                continue;
+            }
+            if (row[x] < from) {
+                return -1;
+            }
+            const int64_t index = int64_t(y) * counts.cols + x;
+            put_varint(out, static_cast<uint64_t>(index - previous));
+            put_varint(out, static_cast<uint64_t>(row[x] - from));
+            previous = index;
+            ++changed;
+        }
+    }
+    return changed;
+}
+
+} // namespace
+
+// ============================================================================
+// HeatmapTimelineWriter
+// ============================================================================
+
+bool HeatmapTimelineWriter::open(const std::string& path, int width, int height) {
+    close();
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    std::error_code ec;
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        std::cerr << "Heatmap timeline: cannot create " << path << std::endl;
+        return false;
+    }
+
+    file_.write(heatmap_timeline::FILE_MAGIC, sizeof(heatmap_timeline::FILE_MAGIC));
+    write_pod(file_, heatmap_timeline::VERSION);
+    write_pod(file_, static_cast<uint32_t>(width));
+    write_pod(file_, static_cast<uint32_t>(height));
+    write_pod(file_, unix_now_ms());
+    file_.flush();
+
+    path_ = path;
+    previous_ = cv::Mat::zeros(height, width, CV_32SC1);
+    snapshots_ = 0;
+    bytes_written_ = static_cast<int64_t>(file_.tellp());
+    return static_cast<bool>(file_);
+}
+
+void HeatmapTimelineWriter::close() {
+    if (file_.is_open()) {
+        file_.close();
+        std::cout << "Heatmap timeline: " << snapshots_ << " snapshots, " << bytes_written_ / 1024 << " KiB in "
+                  << path_ << std::endl;
+    }
+    previous_.release();
+}
+
+bool HeatmapTimelineWriter::append(const cv::Mat& counts, int64_t frames_analyzed) {
+    PROFILE_ZONE("HeatmapTimelineWriter::append");
+    if (!file_.is_open() || counts.type() != CV_32SC1 || counts.size() != previous_.size()) {
+        return false;
+    }
+
+    bool keyframe = snapshots_ % heatmap_timeline::KEYFRAME_EVERY == 0;
+    int64_t changed = encode(counts, keyframe ? nullptr : &previous_, payload_);
+    if (changed < 0) {
+        keyframe = true;   // Counts were reset since the last snapshot
+        changed = encode(counts, nullptr, payload_);
+    }
+
+    write_pod(file_, heatmap_timeline::RECORD_MAGIC);
+    write_pod(file_, static_cast<uint8_t>(keyframe ? 1 : 0));
+    write_pod(file_, unix_now_ms());
+    write_pod(file_, frames_analyzed);
+    write_pod(file_, static_cast<uint32_t>(changed));
+    write_pod(file_, static_cast<uint32_t>(payload_.size()));
+    file_.write(reinterpret_cast<const char*>(payload_.data()), static_cast<std::streamsize>(payload_.size()));
+    file_.flush();
+    if (!file_) {
+        std::cerr << "Heatmap timeline: write to " << path_ << " failed" << std::endl;
+        file_.close();
+        return false;
+    }
+
+    counts.copyTo(previous_);
+    ++snapshots_;
+    bytes_written_ += static_cast<int64_t>(RECORD_HEADER_BYTES + payload_.size());
+    return true;
+}
+
+// ============================================================================
+// HeatmapTimeline
+// ============================================================================
+
+bool HeatmapTimeline::open(const std::string& path) {
+    close();
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    const std::streamsize size = file.tellg();
+    file.seekg(0);
+    std::vector<uint8_t> data(static_cast<size_t>(std::max<std::streamsize>(size, 0)));
+    if (!file.read(reinterpret_cast<char*>(data.data()), size)) {
+        return false;
+    }
+
+    size_t offset = 0;
+    char magic[sizeof(heatmap_timeline::FILE_MAGIC)];
+    uint32_t version = 0, width = 0, height = 0;
+    int64_t start_ms = 0;
+    if (!read_pod(data, offset, magic) ||
+        std::memcmp(magic, heatmap_timeline::FILE_MAGIC, sizeof(magic)) != 0 ||
+        !read_pod(data, offset, version) || version != heatmap_timeline::VERSION ||
+        !read_pod(data, offset, width) || !read_pod(data, offset, height) || !read_pod(data, offset, start_ms) ||
+        width == 0 || height == 0) {
+        std::cerr << "Heatmap timeline: " << path << " is not a timeline file" << std::endl;
+        return false;
+    }
+
+    // Index the records; a torn one ends the file
+    while (true) {
+        uint32_t record_magic = 0;
+        uint8_t keyframe = 0;
+        Snapshot snapshot;
+        if (!read_pod(data, offset, record_magic) || record_magic != heatmap_timeline::RECORD_MAGIC ||
+            !read_pod(data, offset, keyframe) || !read_pod(data, offset, snapshot.unix_ms) ||
+            !read_pod(data, offset, snapshot.frames_analyzed) || !read_pod(data, offset, snapshot.changed_pixels) ||
+            !read_pod(data, offset, snapshot.payload_bytes) || data.size() - offset < snapshot.payload_bytes) {
+            break;
+        }
+        snapshot.keyframe = keyframe != 0;
+        snapshot.payload_offset = offset;
+        offset += snapshot.payload_bytes;
+        snapshots_.push_back(snapshot);
+    }
+
+    path_ = path;
+    data_ = std::move(data);
+    width_ = static_cast<int>(width);
+    height_ = static_cast<int>(height);
+    start_unix_ms_ = start_ms;
+    return true;
+}
+
+void HeatmapTimeline::close() {
+    path_.clear();
+    data_.clear();
+    snapshots_.clear();
+    width_ = 0;
+    height_ = 0;
+    current_.release();
+    current_index_ = -1;
+}
+
+bool HeatmapTimeline::reconstruct(size_t index, cv::Mat& counts) {
+    PROFILE_ZONE("HeatmapTimeline::reconstruct");
+    if (index >= snapshots_.size()) {
+        return false;
+    }
+
+    size_t keyframe = index;
+    while (keyframe > 0 && !snapshots_[keyframe].keyframe) {
+        --keyframe;
+    }
+
+    // Stepping forward from the last result replays fewer deltas than the keyframe would
+    size_t from = keyframe;
+    if (current_index_ >= static_cast<int64_t>(keyframe) && current_index_ <= static_cast<int64_t>(index)) {
+        from = static_cast<size_t>(current_index_) + 1;
+    } else {
+        current_.create(height_, width_, CV_32SC1);
+        current_.setTo(0);
+    }
+    for (size_t i = from; i <= index; ++i) {
+        if (!apply(snapshots_[i], current_)) {
+            current_index_ = -1;
+            return false;
+        }
+    }
+    current_index_ = static_cast<int64_t>(index);
+    current_.copyTo(counts);
+    return true;
+}
+
+bool HeatmapTimeline::apply(const Snapshot& snapshot, cv::Mat& counts) const {
+    if (snapshot.keyframe) {
+        counts.setTo(0);
+    }
+
+    int32_t* values = counts.ptr<int32_t>();   // Continuous: created here
+    const int64_t total = int64_t(width_) * height_;
+    const uint8_t* p = data_.data() + snapshot.payload_offset;
+    const uint8_t* end = p + snapshot.payload_bytes;
+    int64_t index = -1;
+    for (uint32_t i = 0; i < snapshot.changed_pixels; ++i) {
+        uint64_t gap = 0, value = 0;
+        if (!get_varint(p, end, gap) || !get_varint(p, end, value) || gap == 0 ||
+            gap > static_cast<uint64_t>(total - 1 - index)) {
+            return false;
+        }
+        index += static_cast<int64_t>(gap);
+        values[index] += static_cast<int32_t>(value);
+    }
+    return true;
+}
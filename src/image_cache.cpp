@@ -0,0 +1,260 @@
+#include "image_cache.h"
+#include "core/memory_budget.h"
+#include "core/metrics.h"
+#include "core/profiler.h"
+#include <algorithm>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/**
+ * One spelling per file, so "a/../b.png" and an absolute path share an entry
+ */
+std::string key_of(const std::string& path) {
+    std::error_code ec;
+    fs::path absolute = fs::absolute(path, ec);
+    return (ec ? fs::path(path) : absolute).lexically_normal().string();
+}
+
+core::Counter& hits() {
+    static core::Counter& counter = core::MetricsRegistry::instance().counter("image_cache.hits");
+    return counter;
+}
+
+core::Counter& misses() {
+    static core::Counter& counter = core::MetricsRegistry::instance().counter("image_cache.misses");
+    return counter;
+}
+
+core::Gauge& bytes_gauge() {
+    static core::Gauge& gauge = core::MetricsRegistry::instance().gauge("image_cache.bytes");
+    return gauge;
+}
+
+} // namespace
+
+ImageCache& ImageCache::instance() {
+    static ImageCache cache;
+    return cache;
+}
+
+ImageCache::ImageCache() {
+    thread_ = std::thread(&ImageCache::worker_loop, this);
+}
+
+ImageCache::~ImageCache() {
+    shutdown();
+}
+
+void ImageCache::configure(size_t max_bytes, int prefetch) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_bytes_ = max_bytes;
+    prefetch_ = std::max(prefetch, 0);
+    while (bytes_ > max_bytes_ && !lru_.empty()) {
+        auto it = entries_.find(lru_.back());
+        bytes_ -= it->second.first->bytes;
+        entries_.erase(it);
+        lru_.pop_back();
+    }
+    bytes_gauge().set(static_cast<double>(bytes_));
+}
+
+void ImageCache::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        pending_.clear();
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+size_t ImageCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+size_t ImageCache::shrink(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t freed = 0;
+    while (freed < bytes && !lru_.empty()) {
+        auto oldest = entries_.find(lru_.back());
+        freed += oldest->second.first->bytes;
+        entries_.erase(oldest);
+        lru_.pop_back();
+    }
+    bytes_ -= freed;
+    bytes_gauge().set(static_cast<double>(bytes_));
+    return freed;
+}
+
+bool ImageCache::load(const std::string& path, ImageManager::ImageMetadata& metadata, cv::Mat& image) {
+    PROFILE_ZONE("ImageCache::load");
+    const std::string key = key_of(path);
+
+    EntryPtr entry;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // The prefetch thread is already decoding it: wait rather than decode it twice
+        cv_.wait(lock, [&] { return decoding_ != key || stopping_; });
+        entry = find(key);
+    }
+
+    if (entry) {
+        hits().add();
+    } else {
+        misses().add();
+        entry = decode(path);
+        if (!entry) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        insert(key, entry);
+    }
+
+    // Copied out so the caller owns its image and the entry stays shareable
+    metadata = entry->metadata;
+    if (!entry->bits.empty()) {
+        entry->bits.to_mat(image);
+    } else {
+        image = entry->gray.clone();
+    }
+    return true;
+}
+
+void ImageCache::prefetch_around(const std::string& path) {
+    int depth = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        depth = max_bytes_ > 0 ? prefetch_ : 0;
+    }
+    if (depth == 0 || !core::MemoryBudget::instance().admit()) {
+        return;
+    }
+
+    // Nearest first, forward before backward (the usual review direction)
+    std::deque<std::string> wanted;
+    for (int step = 1; step <= depth; ++step) {
+        for (int direction : {1, -1}) {
+            std::string neighbour = neighbor(path, step * direction);
+            if (!neighbour.empty()) {
+                wanted.push_back(key_of(neighbour));
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ = std::move(wanted);   // Whatever is left from the previous step is no longer wanted
+    }
+    cv_.notify_all();
+}
+
+std::string ImageCache::neighbor(const std::string& path, int step) {
+    const fs::path file(key_of(path));
+    const fs::path dir = file.parent_path();
+
+    std::lock_guard<std::mutex> lock(listing_mutex_);
+    std::error_code ec;
+    const fs::file_time_type dir_time = fs::last_write_time(dir, ec);
+
+    // Listed again only when the directory changes (a save adds a file)
+    if (dir != listing_dir_ || dir_time != listing_time_) {
+        listing_.clear();
+        for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->path().extension() == ".png") {
+                listing_.push_back(it->path().lexically_normal().string());
+            }
+        }
+        std::sort(listing_.begin(), listing_.end());
+        listing_dir_ = dir;
+        listing_time_ = dir_time;
+    }
+
+    const auto it = std::lower_bound(listing_.begin(), listing_.end(), file.string());
+    if (it == listing_.end() || *it != file.string()) {
+        return "";
+    }
+    const int64_t index = (it - listing_.begin()) + static_cast<int64_t>(step);
+    if (index < 0 || index >= static_cast<int64_t>(listing_.size())) {
+        return "";
+    }
+    return listing_[static_cast<size_t>(index)];
+}
+
+ImageCache::EntryPtr ImageCache::decode(const std::string& path) {
+    auto entry = std::make_shared<Entry>();
+    cv::Mat image;
+    if (!ImageManager::load_image(path, entry->metadata, image, false)) {
+        return nullptr;
+    }
+    if (ImageManager::is_binary(image)) {
+        entry->bits.assign(image);
+        entry->bytes = entry->bits.word_count() * sizeof(uint64_t);
+    } else {
+        entry->gray = image;
+        entry->bytes = image.total() * image.elemSize();
+    }
+    return entry;
+}
+
+ImageCache::EntryPtr ImageCache::find(const std::string& key) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.second);
+    return it->second.first;
+}
+
+void ImageCache::insert(const std::string& key, EntryPtr entry) {
+    if (entry->bytes > max_bytes_ || entries_.count(key) != 0) {
+        return;
+    }
+    lru_.push_front(key);
+    entries_.emplace(key, std::make_pair(entry, lru_.begin()));
+    bytes_ += entry->bytes;
+
+    while (bytes_ > max_bytes_) {
+        auto oldest = entries_.find(lru_.back());
+        bytes_ -= oldest->second.first->bytes;
+        entries_.erase(oldest);
+        lru_.pop_back();
+    }
+    bytes_gauge().set(static_cast<double>(bytes_));
+}
+
+void ImageCache::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (stopping_) {
+            return;
+        }
+
+        const std::string key = std::move(pending_.front());
+        pending_.pop_front();
+        if (entries_.count(key) != 0) {
+            continue;
+        }
+
+        decoding_ = key;
+        lock.unlock();
+        EntryPtr entry = decode(key);
+        lock.lock();
+        if (entry) {
+            insert(key, entry);
+        }
+        decoding_.clear();
+        cv_.notify_all();   // A load() may be waiting for this file
+    }
+}
@@ -1,15 +1,39 @@
 #include "image_manager.h"
 #include "app_config.h"
+#include "capture_catalog.h"
+#include "image_save_queue.h"
+#include "core/profiler.h"
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <filesystem>
 #include <iostream>
+#include <list>
+#include <mutex>
 
 namespace fs = std::filesystem;
 
+namespace {
+
+/**
+ * load_binary() entries, front = most recently used
+ */
+struct BinaryCacheEntry {
+    std::string path;
+    fs::file_time_type mtime;
+    uintmax_t size = 0;
+    ImageManager::BinaryHandle bits;
+};
+
+std::mutex binary_cache_mutex;
+std::list<BinaryCacheEntry> binary_cache;
+
+} // namespace
+
 std::string ImageManager::generate_timestamp() {
     auto now = std::chrono::system_clock::now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
@@ -33,6 +57,23 @@ int64_t ImageManager::get_unix_timestamp_ms() {
 }
 
 ImageManager::ImageMetadata ImageManager::create_metadata(const cv::Mat& image, const std::string& comment) {
+    return create_metadata(image.size(), cv::countNonZero(image), comment);
+}
+
+ImageManager::ImageMetadata ImageManager::create_metadata(const video::BinaryFrame& image, const std::string& comment) {
+    return create_metadata(image.size(), static_cast<int>(image.count()), comment);
+}
+
+ImageManager::ImageMetadata ImageManager::create_metadata(const video::FrameRef& frame, const std::string& comment) {
+    const int64_t counted = frame.timing().active_pixels;
+    if (counted >= 0) {
+        return create_metadata(frame.size(), static_cast<int>(counted), comment);
+    }
+    video::ReadGuard guard(frame);
+    return create_metadata(guard.get(), comment);
+}
+
+ImageManager::ImageMetadata ImageManager::create_metadata(cv::Size size, int active_pixels, const std::string& comment) {
     ImageMetadata metadata;
 
     // Timestamp
@@ -54,10 +95,10 @@ ImageManager::ImageMetadata ImageManager::create_metadata(const cv::Mat& image,
     metadata.bias_refr = config.camera_settings().bias_refr;
 
     // Image statistics
-    metadata.image_width = image.cols;
-    metadata.image_height = image.rows;
-    metadata.active_pixels = cv::countNonZero(image);
-    metadata.pixel_density = (float)metadata.active_pixels / (image.cols * image.rows) * 100.0f;
+    metadata.image_width = size.width;
+    metadata.image_height = size.height;
+    metadata.active_pixels = active_pixels;
+    metadata.pixel_density = (float)metadata.active_pixels / (size.width * size.height) * 100.0f;
 
     // User comment
     metadata.comment = comment;
@@ -85,11 +126,7 @@ std::string ImageManager::save_image(
         fs::path metadata_path = dir_path / (filename + ".json");
 
         // Save image as PNG
-        std::vector<int> compression_params;
-        compression_params.push_back(cv::IMWRITE_PNG_COMPRESSION);
-        compression_params.push_back(3);  // Compression level 0-9
-
-        if (!cv::imwrite(image_path.string(), image, compression_params)) {
+        if (!write_png(image_path.string(), image)) {
             std::cerr << "Failed to save image: " << image_path << std::endl;
             return "";
         }
@@ -100,6 +137,8 @@ std::string ImageManager::save_image(
         if (!save_metadata_json(metadata_path.string(), metadata)) {
             std::cerr << "Warning: Failed to save metadata" << std::endl;
             // Continue anyway - image is saved
+        } else {
+            CaptureCatalog::instance().add(image_path.string(), metadata);
         }
 
         std::cout << "Metadata saved: " << metadata_path << std::endl;
@@ -112,7 +151,95 @@ std::string ImageManager::save_image(
     }
 }
 
+std::string ImageManager::save_image(
+    const video::BinaryFrame& image,
+    const ImageMetadata& metadata,
+    const std::string& directory,
+    const std::string& base_filename
+) {
+    if (image.empty()) {
+        std::cerr << "Cannot save empty image" << std::endl;
+        return "";
+    }
+    return save_image(image.to_mat(), metadata, directory, base_filename);
+}
+
+std::string ImageManager::save_image_async(
+    video::FrameRef image,
+    const ImageMetadata& metadata,
+    const std::string& directory,
+    const std::string& base_filename
+) {
+    // Same naming as save_image; the worker creates the directory
+    fs::path image_path = fs::path(directory) / (metadata.timestamp + "_" + base_filename + ".png");
+    if (!ImageSaveQueue::instance().submit(std::move(image), image_path.string(), metadata,
+                                           png_options(), base_filename)) {
+        return "";
+    }
+    return image_path.string();
+}
+
+ImageManager::PngOptions ImageManager::png_options() {
+    const auto& cam_settings = AppConfig::instance().camera_settings();
+    PngOptions options;
+    options.profile = static_cast<PngProfile>(std::clamp(cam_settings.png_profile, 0, 2));
+    options.bilevel = cam_settings.png_bilevel;
+    return options;
+}
+
+std::vector<int> ImageManager::png_params(const PngOptions& options, bool binary_content) {
+    int level = 3;
+    int strategy = cv::IMWRITE_PNG_STRATEGY_DEFAULT;
+    switch (options.profile) {
+    case PngProfile::FAST:
+        level = 1;
+        strategy = cv::IMWRITE_PNG_STRATEGY_RLE;
+        break;
+    case PngProfile::BALANCED:
+        // Sparse 1-bit rows are long runs of zero bytes; RLE finds them at a fraction of the cost
+        level = 3;
+        strategy = binary_content ? cv::IMWRITE_PNG_STRATEGY_RLE : cv::IMWRITE_PNG_STRATEGY_DEFAULT;
+        break;
+    case PngProfile::SMALL:
+        level = 9;
+        strategy = cv::IMWRITE_PNG_STRATEGY_DEFAULT;
+        break;
+    }
+
+    // Strategy must follow compression: OpenCV resets it when the level is set
+    std::vector<int> params = {cv::IMWRITE_PNG_COMPRESSION, level, cv::IMWRITE_PNG_STRATEGY, strategy};
+    if (binary_content && options.bilevel) {
+        params.push_back(cv::IMWRITE_PNG_BILEVEL);
+        params.push_back(1);
+    }
+    return params;
+}
+
+bool ImageManager::is_binary(const cv::Mat& image) {
+    if (image.empty() || image.type() != CV_8UC1) {
+        return false;
+    }
+
+    for (int y = 0; y < image.rows; ++y) {
+        const uint8_t* row = image.ptr<uint8_t>(y);
+        for (int x = 0; x < image.cols; ++x) {
+            if (static_cast<uint8_t>(row[x] + 1) > 1) {
+                return false;  // Neither 0 nor 255
+            }
+        }
+    }
+    return true;
+}
+
+bool ImageManager::write_png(const std::string& filepath, const cv::Mat& image, const PngOptions& options) {
+    PROFILE_ZONE("ImageManager::write_png");
+    // Bilevel keeps only the low bit of each byte, so only 0/255 content may use it
+    const bool binary_content = options.bilevel && is_binary(image);
+    return cv::imwrite(filepath, image, png_params(options, binary_content));
+}
+
 bool ImageManager::save_metadata_json(const std::string& filepath, const ImageMetadata& metadata) {
+    PROFILE_ZONE("ImageManager::save_metadata_json");
     try {
         std::ofstream file(filepath);
         if (!file.is_open()) {
@@ -123,10 +250,29 @@ bool ImageManager::save_metadata_json(const std::string& filepath, const ImageMe
         file << "{\n";
         file << "  \"timestamp\": \"" << metadata.timestamp << "\",\n";
         file << "  \"unix_timestamp_ms\": " << metadata.unix_timestamp_ms << ",\n";
+        if (metadata.sensor_timestamp_us > 0) {
+            file << "  \"sensor_timestamp_us\": " << metadata.sensor_timestamp_us << ",\n";
+        }
+        if (metadata.frame_unix_timestamp_ms > 0) {
+            file << "  \"frame_unix_timestamp_ms\": " << metadata.frame_unix_timestamp_ms << ",\n";
+        }
         file << "  \"camera_config\": {\n";
         file << "    \"binary_bit_1\": " << metadata.binary_bit_1 << ",\n";
         file << "    \"binary_bit_2\": " << metadata.binary_bit_2 << ",\n";
-        file << "    \"accumulation_time_us\": " << metadata.accumulation_time_us << "\n";
+        file << "    \"accumulation_time_us\": " << metadata.accumulation_time_us;
+        if (metadata.frame_events >= 0) {
+            file << ",\n    \"frame_events\": " << metadata.frame_events;
+        }
+        if (metadata.frame_on_events >= 0) {
+            file << ",\n    \"frame_on_events\": " << metadata.frame_on_events;
+        }
+        if (metadata.event_bbox_width > 0) {
+            file << ",\n    \"event_bbox_x\": " << metadata.event_bbox_x;
+            file << ",\n    \"event_bbox_y\": " << metadata.event_bbox_y;
+            file << ",\n    \"event_bbox_width\": " << metadata.event_bbox_width;
+            file << ",\n    \"event_bbox_height\": " << metadata.event_bbox_height;
+        }
+        file << "\n";
         file << "  },\n";
         file << "  \"camera_biases\": {\n";
         file << "    \"bias_diff\": " << metadata.bias_diff << ",\n";
@@ -140,8 +286,17 @@ bool ImageManager::save_metadata_json(const std::string& filepath, const ImageMe
         file << "    \"width\": " << metadata.image_width << ",\n";
         file << "    \"height\": " << metadata.image_height << ",\n";
         file << "    \"active_pixels\": " << metadata.active_pixels << ",\n";
-        file << "    \"pixel_density\": " << metadata.pixel_density << "\n";
+        file << "    \"pixel_density\": " << metadata.pixel_density;
+        if (metadata.frame_hash != 0) {
+            char hash[17];
+            std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(metadata.frame_hash));
+            file << ",\n    \"frame_hash\": \"" << hash << "\"";
+        }
+        file << "\n";
         file << "  },\n";
+        if (!metadata.duplicate_of.empty()) {
+            file << "  \"duplicate_of\": \"" << metadata.duplicate_of << "\",\n";
+        }
         file << "  \"comment\": \"" << metadata.comment << "\",\n";
         file << "  \"app_version\": \"" << metadata.app_version << "\"\n";
         file << "}\n";
@@ -155,22 +310,116 @@ bool ImageManager::save_metadata_json(const std::string& filepath, const ImageMe
     }
 }
 
+ImageManager::BinaryHandle ImageManager::load_binary(const std::string& filepath) {
+    PROFILE_ZONE("ImageManager::load_binary");
+    std::error_code ec;
+    const fs::path path = fs::absolute(filepath, ec);
+    const std::string key = ec ? filepath : path.lexically_normal().string();
+    const fs::file_time_type mtime = fs::last_write_time(filepath, ec);
+    if (ec) {
+        std::cerr << "Failed to load image: " << filepath << std::endl;
+        return nullptr;
+    }
+    const uintmax_t size = fs::file_size(filepath, ec);
+
+    {
+        std::lock_guard<std::mutex> lock(binary_cache_mutex);
+        for (auto it = binary_cache.begin(); it != binary_cache.end(); ++it) {
+            if (it->path != key) {
+                continue;
+            }
+            if (it->mtime == mtime && it->size == size) {
+                binary_cache.splice(binary_cache.begin(), binary_cache, it);
+                return it->bits;
+            }
+            binary_cache.erase(it);   // Changed on disk
+            break;
+        }
+    }
+
+    // Decoded outside the lock; two first loads of one file both decode, one entry is kept
+    auto bits = std::make_shared<video::BinaryFrame>();
+    {
+        const cv::Mat image = cv::imread(filepath, cv::IMREAD_GRAYSCALE);
+        if (!bits->assign(image)) {
+            std::cerr << "Failed to load image: " << filepath << std::endl;
+            return nullptr;
+        }
+    }
+    BinaryHandle handle = std::move(bits);
+
+    std::lock_guard<std::mutex> lock(binary_cache_mutex);
+    for (auto it = binary_cache.begin(); it != binary_cache.end(); ++it) {
+        if (it->path == key) {
+            binary_cache.erase(it);
+            break;
+        }
+    }
+    binary_cache.push_front({key, mtime, size, handle});
+    if (binary_cache.size() > BINARY_CACHE_ENTRIES) {
+        binary_cache.pop_back();
+    }
+    return handle;
+}
+
+void ImageManager::clear_binary_cache() {
+    std::lock_guard<std::mutex> lock(binary_cache_mutex);
+    binary_cache.clear();
+}
+
+size_t ImageManager::binary_cache_bytes() {
+    std::lock_guard<std::mutex> lock(binary_cache_mutex);
+    size_t bytes = 0;
+    for (const BinaryCacheEntry& entry : binary_cache) {
+        bytes += entry.bits->word_count() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+size_t ImageManager::trim_binary_cache(size_t bytes) {
+    std::lock_guard<std::mutex> lock(binary_cache_mutex);
+    size_t freed = 0;
+    for (auto it = binary_cache.end(); it != binary_cache.begin() && freed < bytes;) {
+        --it;
+        if (it->bits.use_count() == 1) {
+            freed += it->bits->word_count() * sizeof(uint64_t);
+            it = binary_cache.erase(it);
+        }
+    }
+    return freed;
+}
+
 bool ImageManager::load_image(
     const std::string& filepath,
     ImageMetadata& metadata,
-    cv::Mat& image
+    cv::Mat& image,
+    bool verbose
 ) {
+    PROFILE_ZONE("ImageManager::load_image");
     try {
         fs::path image_path(filepath);
 
+        // A deduplicated capture has only its sidecar, naming the PNG with its pixels
+        std::string pixels_path = filepath;
+        std::error_code ec;
+        if (!fs::exists(image_path, ec)) {
+            ImageMetadata sidecar;
+            if (load_metadata_json(fs::path(image_path).replace_extension(".json").string(), sidecar) &&
+                !sidecar.duplicate_of.empty()) {
+                pixels_path = (image_path.parent_path() / fs::path(sidecar.duplicate_of)).string();
+            }
+        }
+
         // Load image
-        image = cv::imread(filepath, cv::IMREAD_GRAYSCALE);
+        image = cv::imread(pixels_path, cv::IMREAD_GRAYSCALE);
         if (image.empty()) {
             std::cerr << "Failed to load image: " << filepath << std::endl;
             return false;
         }
 
-        std::cout << "Image loaded: " << filepath << std::endl;
+        if (verbose) {
+            std::cout << "Image loaded: " << filepath << std::endl;
+        }
 
         // Try to load metadata (optional - image can exist without metadata)
         fs::path metadata_path = image_path;
@@ -178,7 +427,9 @@ bool ImageManager::load_image(
 
         if (fs::exists(metadata_path)) {
             if (load_metadata_json(metadata_path.string(), metadata)) {
-                std::cout << "Metadata loaded: " << metadata_path << std::endl;
+                if (verbose) {
+                    std::cout << "Metadata loaded: " << metadata_path << std::endl;
+                }
             } else {
                 std::cerr << "Warning: Could not parse metadata file" << std::endl;
                 // Fill in basic info from image
@@ -188,7 +439,9 @@ bool ImageManager::load_image(
                 metadata.pixel_density = (float)metadata.active_pixels / (image.cols * image.rows) * 100.0f;
             }
         } else {
-            std::cout << "No metadata file found (this is OK for older images)" << std::endl;
+            if (verbose) {
+                std::cout << "No metadata file found (this is OK for older images)" << std::endl;
+            }
             // Fill in basic info from image
             metadata.image_width = image.cols;
             metadata.image_height = image.rows;
@@ -232,9 +485,17 @@ bool ImageManager::load_metadata_json(const std::string& filepath, ImageMetadata
             // Parse fields
             if (key == "timestamp") metadata.timestamp = value;
             else if (key == "unix_timestamp_ms") metadata.unix_timestamp_ms = std::stoll(value);
+            else if (key == "sensor_timestamp_us") metadata.sensor_timestamp_us = std::stoll(value);
+            else if (key == "frame_unix_timestamp_ms") metadata.frame_unix_timestamp_ms = std::stoll(value);
             else if (key == "binary_bit_1") metadata.binary_bit_1 = std::stoi(value);
             else if (key == "binary_bit_2") metadata.binary_bit_2 = std::stoi(value);
             else if (key == "accumulation_time_us") metadata.accumulation_time_us = std::stoi(value);
+            else if (key == "frame_events") metadata.frame_events = std::stoll(value);
+            else if (key == "frame_on_events") metadata.frame_on_events = std::stoll(value);
+            else if (key == "event_bbox_x") metadata.event_bbox_x = std::stoi(value);
+            else if (key == "event_bbox_y") metadata.event_bbox_y = std::stoi(value);
+            else if (key == "event_bbox_width") metadata.event_bbox_width = std::stoi(value);
+            else if (key == "event_bbox_height") metadata.event_bbox_height = std::stoi(value);
             else if (key == "bias_diff") metadata.bias_diff = std::stoi(value);
             else if (key == "bias_diff_on") metadata.bias_diff_on = std::stoi(value);
             else if (key == "bias_diff_off") metadata.bias_diff_off = std::stoi(value);
@@ -245,6 +506,8 @@ bool ImageManager::load_metadata_json(const std::string& filepath, ImageMetadata
             else if (key == "height") metadata.image_height = std::stoi(value);
             else if (key == "active_pixels") metadata.active_pixels = std::stoi(value);
             else if (key == "pixel_density") metadata.pixel_density = std::stof(value);
+            else if (key == "frame_hash") metadata.frame_hash = std::stoull(value, nullptr, 16);
+            else if (key == "duplicate_of") metadata.duplicate_of = value;
             else if (key == "comment") metadata.comment = value;
             else if (key == "app_version") metadata.app_version = value;
         }
@@ -0,0 +1,201 @@
+#include "image_save_queue.h"
+#include "app_config.h"
+#include "capture_catalog.h"
+#include "core/profiler.h"
+#include "core/thread_placement.h"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+ImageSaveQueue& ImageSaveQueue::instance() {
+    static ImageSaveQueue queue;
+    return queue;
+}
+
+ImageSaveQueue::ImageSaveQueue() {
+    thread_ = std::thread(&ImageSaveQueue::worker_loop, this);
+}
+
+ImageSaveQueue::~ImageSaveQueue() {
+    shutdown();
+}
+
+bool ImageSaveQueue::submit(video::FrameRef frame, const std::string& image_path,
+                            std::optional<ImageManager::ImageMetadata> metadata,
+                            ImageManager::PngOptions png, const std::string& dedup_series) {
+    if (frame.empty() || image_path.empty()) {
+        std::cerr << "ImageSaveQueue: Nothing to save" << std::endl;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return false;
+        }
+        if (jobs_.size() + in_progress_ >= MAX_PENDING) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "ImageSaveQueue: Queue full, not saving " << image_path << std::endl;
+            return false;
+        }
+        Job job{std::move(frame), image_path, std::move(metadata), png, dedup_series};
+        if (!dedup_series.empty()) {
+            job.dedup_distance = AppConfig::instance().camera_settings().capture_dedup_distance;
+        }
+        jobs_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+bool ImageSaveQueue::poll_result(Result& result) {
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    if (results_.empty()) {
+        return false;
+    }
+    result = std::move(results_.front());
+    results_.pop_front();
+    return true;
+}
+
+void ImageSaveQueue::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+size_t ImageSaveQueue::get_pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.size() + in_progress_;
+}
+
+void ImageSaveQueue::worker_loop() {
+    core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::IO);
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (jobs_.empty()) {
+                break;  // Stopping and fully drained
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            in_progress_ = 1;
+        }
+
+        Result result = run_job(job);
+        job.frame.reset();  // Return the pool slot before reporting
+
+        (result.success ? saved_ : failed_).fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(results_mutex_);
+            if (results_.size() == MAX_RESULTS) {
+                results_.pop_front();
+            }
+            results_.push_back(std::move(result));
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_progress_ = 0;
+    }
+}
+
+ImageSaveQueue::Result ImageSaveQueue::run_job(Job& job) {
+    PROFILE_ZONE("ImageSaveQueue::run_job");
+    const auto start = std::chrono::steady_clock::now();
+    Result result;
+    result.path = job.image_path;
+
+    try {
+        fs::path image_path(job.image_path);
+        if (image_path.has_parent_path()) {
+            fs::create_directories(image_path.parent_path());
+        }
+
+        video::ReadGuard guard(job.frame);
+        Stored* series = prepare_dedup(job, guard.get());
+        if (series && is_duplicate(*series, job.metadata->frame_hash, job.dedup_distance)) {
+            // Sidecar only, pointing at the PNG that holds these pixels
+            const fs::path earlier = fs::absolute(series->path).lexically_normal();
+            job.metadata->duplicate_of =
+                earlier.lexically_relative(fs::absolute(image_path).lexically_normal().parent_path()).generic_string();
+            fs::path metadata_path = image_path;
+            metadata_path.replace_extension(".json");
+            if (ImageManager::save_metadata_json(metadata_path.string(), *job.metadata)) {
+                result.success = true;
+                result.duplicate_of = series->path;
+                deduplicated_.fetch_add(1, std::memory_order_relaxed);
+                CaptureCatalog::instance().add(job.image_path, *job.metadata);
+                std::cout << "Capture stored as duplicate of " << series->path << ": " << metadata_path << std::endl;
+            } else {
+                result.error = "Failed to save metadata JSON";
+            }
+        } else if (!ImageManager::write_png(job.image_path, guard.get(), job.png)) {
+            result.error = "Failed to encode or write image";
+        } else {
+            result.success = true;
+            std::cout << "Image saved: " << job.image_path << std::endl;
+            if (series) {
+                std::swap(series->bits, dedup_bits_);   // The stored frame's buffer is reused next
+                series->hash = job.metadata->frame_hash;
+                series->path = job.image_path;
+            }
+
+            if (job.metadata) {
+                fs::path metadata_path = image_path;
+                metadata_path.replace_extension(".json");
+                if (ImageManager::save_metadata_json(metadata_path.string(), *job.metadata)) {
+                    std::cout << "Metadata saved: " << metadata_path << std::endl;
+                    CaptureCatalog::instance().add(job.image_path, *job.metadata);
+                } else {
+                    // Image is saved; report the missing sidecar without failing the save
+                    result.error = "Failed to save metadata JSON";
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        result.success = false;
+        result.error = e.what();
+    }
+
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    if (!result.error.empty()) {
+        std::cerr << "ImageSaveQueue: " << job.image_path << ": " << result.error << std::endl;
+    }
+    return result;
+}
+
+ImageSaveQueue::Stored* ImageSaveQueue::prepare_dedup(Job& job, const cv::Mat& image) {
+    if (job.dedup_series.empty() || job.dedup_distance < 0 || !job.metadata ||
+        image.type() != CV_8UC1 || !ImageManager::is_binary(image)) {
+        return nullptr;   // Only 0/255 frames pack without losing anything
+    }
+    dedup_bits_.assign(image);
+    job.metadata->frame_hash = dedup_bits_.hash();
+    return &last_stored_[job.dedup_series];
+}
+
+bool ImageSaveQueue::is_duplicate(const Stored& stored, uint64_t hash, int distance) const {
+    std::error_code ec;
+    if (stored.path.empty() || stored.bits.size() != dedup_bits_.size() || !fs::exists(stored.path, ec)) {
+        return false;
+    }
+    if (stored.hash == hash) {
+        return true;
+    }
+    if (distance <= 0) {
+        return false;
+    }
+    const int64_t differing = video::BinaryFrame::count_xor(stored.bits, dedup_bits_);
+    return differing >= 0 && differing <= distance;
+}
@@ -5,9 +5,25 @@
  * Displays live camera feed with integrated noise analysis and filter controls.
  */
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <filesystem>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 // OpenGL/GLFW/ImGui
 #include <GL/glew.h>
@@ -19,19 +35,57 @@
 // OpenCV
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
 
 // Metavision SDK
 #include <metavision/sdk/driver/camera.h>
 #include <metavision/hal/facilities/i_ll_biases.h>
 #include <metavision/hal/facilities/i_erc_module.h>
 #include <metavision/hal/facilities/i_antiflicker_module.h>
+#include <metavision/hal/facilities/i_digital_event_mask.h>
 #include <metavision/hal/facilities/i_event_trail_filter_module.h>
 
 // Local headers
 #include "camera_manager.h"
+#include "pipeline_bus.h"
+#include "stage_graph.h"
 #include "app_config.h"
+#include "camera/control_queue.h"
 #include "ui/viewer_panel.h"
+#include "ui/capture_gallery.h"
+#include "ui/heatmap_timeline_panel.h"
+#include "core/alloc_tracker.h"
 #include "core/app_state.h"
+#include "core/locked_memory.h"
+#include "core/log.h"
+#include "core/metrics.h"
+#include "core/fleet_aggregator.h"
+#include "core/fleet_report.h"
+#include "core/flight_recorder.h"
+#include "core/memory_budget.h"
+#include "core/metrics_exporter.h"
+#include "core/profiler.h"
+#include "core/qos_scheduler.h"
+#include "core/thread_placement.h"
+#include "core/trend_store.h"
+#include "core/run_log.h"
+#include "core/soak_monitor.h"
+#include "core/ui_scheduler.h"
+#include "video/simd_utils.h"
+#include "video/backend_tuner.h"
+#include "video/gpu_compute.h"
+#include "video/frame_streamer.h"
+#include "image_manager.h"
+#include "image_save_queue.h"
+#include "burst_exporter.h"
+#include "capture_catalog.h"
+#include "image_cache.h"
+#include "bias_sweep.h"
+#include "bias_step_response.h"
+#include "video/hot_pixel_mask.h"
+#include "video/pixel_lifetime_stats.h"
+#include "ga_optimizer.h"
+#include "run_report.h"
 
 // Force usage of discrete GPU on laptops
 #ifdef _WIN32
@@ -47,77 +101,558 @@ extern "C" {
 
 std::unique_ptr<core::AppState> app_state;
 std::unique_ptr<ui::ViewerPanel> viewer;
+std::unique_ptr<ui::CaptureGallery> gallery;
+std::unique_ptr<ui::HeatmapTimelinePanel> heatmap_timeline_panel;
 
-// Binary bit storage for camera frame
+// Binary image for camera frame
 struct BinaryBitStorage {
-    cv::Mat bit1;
-    cv::Mat bit2;
     cv::Mat combined;
 };
 static BinaryBitStorage camera_bits;
 
+// Optional GPU-resident binary pipeline (UI thread / GL context only)
+static std::unique_ptr<video::gpu::GPUBinaryPipeline> gpu_pipeline;
+static std::atomic<bool> gpu_pipeline_active{false};  // Read by the camera thread
+static video::gpu::GPUScatteringView gpu_scattering_view;  // Overlay / heatmap of the pipeline's counts
+static int gpu_view_mode = 0;  // 0 = binary, 1 = scattering overlay, 2 = heatmap
+
+// Optional shader-coloured display for GL 3.0 contexts (UI thread / GL context only)
+static std::unique_ptr<video::gpu::GPUBinaryDisplay> shader_display;
+static std::atomic<bool> shader_display_active{false};  // Read by the camera thread
+static video::FrameRef shader_frame;  // Frame on screen, kept for on-demand CPU extraction
+
+// Optional display frames scattered from event windows by a compute shader (UI thread / GL context only)
+static std::unique_ptr<video::gpu::GPUEventScatter> gpu_event_scatter;
+static std::vector<uint32_t> scatter_events;  // Window taken from the camera manager's queue (storage reused)
+
+// Set by SIGINT/SIGTERM (headless mode has no window to close)
+static volatile std::sig_atomic_t stop_requested = 0;
+
 // UI state
 static bool show_help_window = false;
+static bool show_gpu_timing = false;
+static bool show_gallery = false;
+static bool show_heatmap_timeline = false;
+static ImageSaveQueue::Result last_save_result;  // Most recent background save outcome
+
+// GPU-side duration of each display pass, read back a few frames late (exported as gpu.<pass>_us)
+static video::gpu::GPUPassTimer gpu_timer;
+static int gpu_pass_upload = -1;   // TextureManager / TripleBufferRenderer upload
+static int gpu_pass_compute = -1;  // GPU pipeline upload + dispatch
+static int gpu_pass_shader = -1;   // Shader display / scattering view draw
+static int gpu_pass_imgui = -1;    // ImGui draw data
+static std::vector<core::Histogram*> gpu_pass_metrics;
+
+// Paces the main loop: renders on new frames or input, sleeps at the idle rate otherwise
+static core::UiScheduler ui_scheduler;
+
+// Prometheus / StatsD publisher for unattended stations (reads registry snapshots only)
+static core::MetricsExporter metrics_exporter;
+
+// Compressed binary frames for remote viewers (newest frame per camera, skipped when a link is slow)
+static video::FrameStreamer frame_streamer;
+
+// Consumer stages declared in pipeline_stages; a stream stage takes over frame_streamer.submit
+static StageGraph stage_graph;
+static std::atomic<bool> stream_stage_active{false};
+
+// Long-run event rate / scattering history (1 s, 1 min and 10 min buckets)
+static core::TrendStore trend_store;
+
+// Station reports to a fleet aggregator (fleet_report)
+static core::FleetReporter fleet_reporter;
+
+// Resource growth of a soak run (soak)
+static core::SoakMonitor soak_monitor;
+
+// Frame counters recorded on the hot path (registered once)
+static core::Counter& frames_displayed_metric = core::MetricsRegistry::instance().counter("frames.displayed");
+static core::Counter& frames_pool_dropped_metric = core::MetricsRegistry::instance().counter("frames.dropped.pool");
+static core::Counter& frames_late_latched_metric = core::MetricsRegistry::instance().counter("frames.late_latched");
+
+// Coarse accumulation windows (accumulation_windows_us): latest active pixel share per camera and level
+struct WindowView {
+    std::atomic<double> active_percent{0.0};  // Written by the camera's accumulation thread
+    core::Gauge* gauge = nullptr;
+};
+static std::array<std::array<WindowView, video::WindowPyramid::MAX_LEVELS>, core::AppState::MAX_CAMERAS> window_views;
+
+// Run log path without its extension; other per-run files share it ("" = run log off)
+static std::string run_archive_stem;
+static std::chrono::steady_clock::time_point run_started;
+
+// End-of-run report package beside the run log (run_report)
+static RunReport run_report;
+
+// Frames generated per camera so far (FrameTiming::frame_index)
+static std::array<std::atomic<int64_t>, core::AppState::MAX_CAMERAS> frames_generated{};
+
+// Known hot pixels programmed into each camera's digital event mask (written by the camera-control thread)
+static std::array<std::atomic<int>, core::AppState::MAX_CAMERAS> hardware_masked_pixels{};
+
+// Cameras 0 and 1 compared on the synchronized windows of the stream merge (written on the merge thread)
+static std::atomic<int64_t> merge_active[2] = {};       // Pixels of the last window
+static std::atomic<int64_t> merge_coincident{0};        // Pixels active on both in the last window
+static std::atomic<double> merge_agreement{0.0};        // Running mean of coincident / active on either
 
 // ============================================================================
 // Binary Image Processing
 // ============================================================================
 
 /**
- * Create lookup table for bit extraction
+ * Directory for event recordings and bursts (recording_directory, else capture_directory)
+ */
+std::filesystem::path recording_output_directory() {
+    const auto& cam_settings = AppConfig::instance().camera_settings();
+    std::filesystem::path directory = !cam_settings.recording_directory.empty()
+        ? cam_settings.recording_directory
+        : cam_settings.capture_directory;
+
+    std::error_code ec;
+    if (!directory.empty()) {
+        std::filesystem::create_directories(directory, ec);
+    }
+    return directory;
+}
+
+/**
+ * Start a frame's latency trace (camera thread, frame generator callback)
+ * @param camera_index Camera the frame comes from (display sync follows camera 0)
+ */
+video::FrameTiming begin_frame_timing(int camera_index) {
+    video::FrameTiming timing;
+    timing.callback_us = core::LatencyStats::now_us();
+    timing.camera_ts = CameraManager::instance().get_last_frame_timestamp(camera_index);
+    timing.window_us = CameraManager::instance().get_last_frame_window_us(camera_index);
+    timing.events = CameraManager::instance().get_last_frame_events(camera_index);
+    timing.on_events = CameraManager::instance().get_last_frame_on_events(camera_index);
+    timing.frame_index = frames_generated[camera_index].fetch_add(1, std::memory_order_relaxed);
+    timing.camera_host_us = CameraManager::instance().clock_sync(camera_index).to_host_us(timing.camera_ts);
+
+    // The native accumulator counts while it builds the frame; its box is exact for event-count slices too
+    video::BinaryFrameAccumulator::FrameStats stats;
+    const bool counted = CameraManager::instance().get_frame_stats(stats, camera_index);
+    if (counted) {
+        timing.active_pixels = stats.active_pixels;
+        if (stats.has_box()) {
+            timing.event_x = stats.x_min;
+            timing.event_y = stats.y_min;
+            timing.event_width = stats.x_max - stats.x_min + 1;
+            timing.event_height = stats.y_max - stats.y_min + 1;
+        }
+    }
+
+    // The statistics stage runs ahead of the generator, so the window closed by this frame is published
+    EventCamera::EventProcessor::WindowStats window;
+    if (!counted && CameraManager::instance().event_stats(camera_index).get_window(timing.camera_ts, window) &&
+        !window.stats.empty()) {
+        timing.event_x = window.stats.x_min;
+        timing.event_y = window.stats.y_min;
+        timing.event_width = window.stats.x_max - window.stats.x_min + 1;
+        timing.event_height = window.stats.y_max - window.stats.y_min + 1;
+        if (timing.events < 0) {
+            timing.events = static_cast<int64_t>(window.stats.events);   // SDK generator path counts nothing itself
+            timing.on_events = static_cast<int64_t>(window.stats.on_events);
+        }
+    }
+    if (camera_index == 0) {
+        app_state->frame_sync().on_frame_generated(timing.camera_ts, timing.callback_us);
+    }
+    return timing;
+}
+
+/**
+ * Open and close trigger-gated bursts around a frame (camera thread; no-op unless trigger_capture)
+ *
+ * Each trigger window becomes one burst file holding the frames that
+ * overlap it; call before the frame is pushed to the burst capture.
  */
-static cv::Mat create_bit_extraction_lut(int bit_position) {
-    cv::Mat lut(1, 256, CV_8U);
-    int bit_value = 1 << bit_position;
+void gate_burst_capture(int camera_index, const video::FrameTiming& timing, cv::Size size) {
+    video::TriggerGate& gate = CameraManager::instance().trigger_gate(camera_index);
+    if (!gate.is_enabled()) {
+        return;
+    }
 
-    for (int i = 0; i < 256; ++i) {
-        lut.at<uint8_t>(i) = (i & bit_value) ? 255 : 0;
+    const video::TriggerGate::Step step = gate.step(timing.camera_ts - timing.window_us, timing.camera_ts);
+    auto& burst = app_state->burst_capture(camera_index);
+    if (step.closed) {
+        burst.finish();
+    }
+    if (step.opened) {
+        const auto& cam_settings = AppConfig::instance().camera_settings();
+        const double frame_bytes = ((size.width + 63) / 64) * 8.0 * size.height;
+        const int max_frames = static_cast<int>(std::max(cam_settings.burst_max_mb, 1) * 1024.0 * 1024.0 / frame_bytes);
+        const std::string name = "trigger_" + ImageManager::generate_timestamp() +
+            (camera_index == 0 ? std::string() : "_cam" + std::to_string(camera_index)) +
+            "_" + std::to_string(step.window) + ".rtbf";
+        if (!burst.arm_window(size, std::max(max_frames, 1), (recording_output_directory() / name).string())) {
+            static core::Counter& missed = core::MetricsRegistry::instance().counter("trigger.windows_missed");
+            missed.add();
+            static core::LogSite site(1000);
+            core::LogLine(core::LogLevel::Warning, &site) << "Camera " << camera_index << ": trigger window "
+                << step.window << " missed, the previous burst is still being written";
+        }
+    }
+}
+
+/**
+ * Share a binary frame with PipelineBus frame subscribers (no-op without any)
+ */
+void publish_frame(int camera_index, const video::FrameRef& frame) {
+    auto& channel = PipelineBus::instance().frames();
+    if (!channel.has_subscribers()) {
+        return;
     }
+    PipelineBus::FrameMessage message;
+    message.camera_index = camera_index;
+    message.frame = frame;
+    channel.publish(message);
+}
+
+/**
+ * Append a frame's metadata to its camera's frame log (camera thread, once extracted)
+ */
+void log_frame(int camera_index, const video::FrameTiming& timing) {
+    static const core::Gauge& scattering_pixels = core::MetricsRegistry::instance().gauge("scattering.pixels");
+    auto clamp32 = [](int64_t value) {
+        return static_cast<int32_t>(std::min<int64_t>(value, std::numeric_limits<int32_t>::max()));
+    };
 
-    return lut;
+    core::FrameRecord record;
+    record.camera_ts = timing.camera_ts;
+    record.host_us = timing.camera_host_us ? timing.camera_host_us : timing.callback_us;
+    record.window_us = timing.window_us ? clamp32(timing.window_us) : -1;
+    record.events = timing.events >= 0 ? clamp32(timing.events) : -1;
+    if (timing.events >= 0 && timing.on_events >= 0) {
+        record.on_events = clamp32(timing.on_events);
+        record.off_events = clamp32(timing.events - timing.on_events);
+    }
+    record.active_pixels = timing.active_pixels >= 0 ? clamp32(timing.active_pixels) : -1;
+    // The worker publishes camera 0's result only, a frame or two behind
+    if (camera_index == 0 && scattering_pixels.has_value()) {
+        record.scattering_pixels = clamp32(static_cast<int64_t>(scattering_pixels.value()));
+    }
+    if (timing.camera_host_us > 0 && timing.extracted_us >= timing.camera_host_us) {
+        record.latency_us = clamp32(timing.extracted_us - timing.camera_host_us);
+    }
+    app_state->frame_log(camera_index).append(record);
 }
 
 /**
  * Process camera frame: extract binary bits and combine
  */
-void process_camera_frame(const cv::Mat& frame) {
+void process_camera_frame(const cv::Mat& frame, int camera_index) {
+    PROFILE_ZONE("process_camera_frame");
+    ALLOC_SCOPE("process_frame");
     if (frame.empty() || !app_state) return;
+    video::FrameTiming timing = begin_frame_timing(camera_index);
 
-    // Get bit positions from config
+    // Bit positions are read every frame so runtime changes take effect
     int bit1_pos = static_cast<int>(app_state->display_settings().get_binary_stream_mode());
     int bit2_pos = static_cast<int>(app_state->display_settings().get_binary_stream_mode_2());
+    uint8_t bit_mask = static_cast<uint8_t>((1 << bit1_pos) | (1 << bit2_pos));
+
+    // Burst ring packs straight from the raw frame, so it sees every frame
+    // even when the display pool is exhausted
+    gate_burst_capture(camera_index, timing, frame.size());
+    app_state->burst_capture(camera_index).push(frame, timing.camera_ts, bit_mask);
+    app_state->frame_history(camera_index).push(frame, timing.camera_ts, bit_mask);
+
+    // Write into a free pool slot so frames still queued or displayed are never overwritten
+    video::FrameRef binary = app_state->frame_pool(camera_index).acquire(frame.size(), CV_8UC1);
+    if (binary.empty()) {
+        frames_pool_dropped_metric.add();
+        static core::LogSite site(1000);
+        core::LogLine(core::LogLevel::Debug, &site) << "Camera " << camera_index << ": frame pool exhausted, frame dropped";
+        return;  // Every slot in flight - drop frame (counted by the pool)
+    }
+
+    // Single fused pass: reads channel 0 of the BGR frame and writes
+    // (pixel & mask) ? 255 : 0, replacing extractChannel + 2x LUT + OR
+    video::simd::extract_bit_mask(frame, video::FramePool::writable(binary), bit_mask);
+    timing.extracted_us = core::LatencyStats::now_us();
+    binary.set_timing(timing);
+    log_frame(camera_index, timing);
+
+    if (!stream_stage_active.load(std::memory_order_relaxed)) {
+        frame_streamer.submit(camera_index, timing.camera_ts, binary.unsafe_get());  // Its Mat handle keeps the slot out of the pool
+    }
+    CameraManager::instance().analyzers().submit_frame(camera_index, binary);
+    publish_frame(camera_index, binary);
+
+    // Store in frame buffer for display (single-channel binary image)
+    app_state->frame_buffer(camera_index).store_frame(std::move(binary));
+    if (camera_index == 0) ui_scheduler.notify_frame();  // The viewer shows camera 0
+}
 
-    // Event camera frames are grayscale, but may have 3 channels with duplicate data
-    // Extract first channel to ensure single-channel processing
-    cv::Mat gray_frame;
-    if (frame.channels() == 3) {
-        // Extract just the first channel (all channels should be identical for grayscale)
-        cv::extractChannel(frame, gray_frame, 0);
+/**
+ * Store the raw camera frame for the GPU pipeline or shader display (bits are tested on the GPU, camera 0 only)
+ */
+void store_raw_frame(const cv::Mat& frame) {
+    PROFILE_ZONE("store_raw_frame");
+    ALLOC_SCOPE("store_raw");
+    if (frame.empty() || !app_state) return;
+    video::FrameTiming timing = begin_frame_timing(0);
+
+    gate_burst_capture(0, timing, frame.size());
+    auto& burst = app_state->burst_capture(0);
+    auto& history = app_state->frame_history(0);
+    if (burst.get_state() != video::BurstCapture::State::Idle || history.is_enabled()) {
+        int bit1_pos = static_cast<int>(app_state->display_settings().get_binary_stream_mode());
+        int bit2_pos = static_cast<int>(app_state->display_settings().get_binary_stream_mode_2());
+        uint8_t bit_mask = static_cast<uint8_t>((1 << bit1_pos) | (1 << bit2_pos));
+        burst.push(frame, timing.camera_ts, bit_mask);
+        history.push(frame, timing.camera_ts, bit_mask);
+    }
+
+    // The camera reuses its frame buffer, so copy into a free pool slot
+    video::FrameRef raw = app_state->frame_pool(0).acquire(frame.size(), frame.type());
+    if (raw.empty()) {
+        frames_pool_dropped_metric.add();
+        static core::LogSite site(1000);
+        core::LogLine(core::LogLevel::Debug, &site) << "Camera 0: frame pool exhausted, raw frame dropped";
+        return;  // Every slot in flight - drop frame (counted by the pool)
+    }
+    frame.copyTo(video::FramePool::writable(raw));
+    timing.extracted_us = core::LatencyStats::now_us();  // Extraction itself runs on the GPU
+    raw.set_timing(timing);
+    log_frame(0, timing);
+
+    app_state->frame_buffer(0).store_frame(std::move(raw));
+    ui_scheduler.notify_frame();
+}
+
+/**
+ * Store a frame from the native binary accumulator (already CV_8UC1 0/255)
+ */
+void store_binary_frame(const cv::Mat& frame, int camera_index) {
+    PROFILE_ZONE("store_binary_frame");
+    ALLOC_SCOPE("store_binary");
+    if (frame.empty() || !app_state) return;
+    video::FrameTiming timing = begin_frame_timing(camera_index);
+
+    gate_burst_capture(camera_index, timing, frame.size());
+    app_state->burst_capture(camera_index).push(frame, timing.camera_ts);
+    app_state->frame_history(camera_index).push(frame, timing.camera_ts);
+
+    // Built in the accumulation pass; stands in for the frame on a zoomed-out display or a remote link
+    const cv::Mat preview = CameraManager::instance().get_frame_preview(camera_index);
+    const int binning = CameraManager::instance().get_preview_binning();
+    if (stream_stage_active.load(std::memory_order_relaxed)) {
+        // Submitted by the stream stage from the frames channel
+    } else if (!preview.empty() && AppConfig::instance().runtime_settings().stream_preview) {
+        frame_streamer.submit(camera_index, timing.camera_ts, preview, binning);
     } else {
-        gray_frame = frame;
+        frame_streamer.submit(camera_index, timing.camera_ts, frame);
+    }
+
+    // No per-frame processing needed; the display copy of the frame
+    // (camera_bits.combined) is refreshed on the UI thread when consumed
+    video::FrameRef ref(frame);
+    timing.extracted_us = core::LatencyStats::now_us();
+    ref.set_timing(timing);
+    log_frame(camera_index, timing);
+    ref.set_row_bands(CameraManager::instance().get_frame_row_bands(camera_index));  // Lets the display upload changed bands only
+    ref.set_block_map(CameraManager::instance().get_frame_block_map(camera_index));  // Lets analysis skip empty blocks
+    if (!preview.empty()) {
+        ref.set_preview(preview, binning);
     }
+    CameraManager::instance().analyzers().submit_frame(camera_index, ref);
+    publish_frame(camera_index, ref);
+    app_state->frame_buffer(camera_index).store_frame(std::move(ref));
+    if (camera_index == 0) ui_scheduler.notify_frame();
+}
 
-    // Extract both bits using LUT
-    static cv::Mat lut1 = create_bit_extraction_lut(bit1_pos);
-    static cv::Mat lut2 = create_bit_extraction_lut(bit2_pos);
+/**
+ * Render the time surface in place of a consumed frame (UI thread, TIME_SURFACE display mode)
+ * @param timing Latency trace of the consumed frame, carried over to the rendered one
+ * @return Frame to upload (empty until the surface has recorded an event)
+ */
+video::FrameRef render_time_surface_frame(const video::FrameTiming& timing) {
+    static cv::Mat surface;
 
-    cv::LUT(gray_frame, lut1, camera_bits.bit1);
-    cv::LUT(gray_frame, lut2, camera_bits.bit2);
+    // Shed under pressure: the last surface stays on screen
+    if (!surface.empty() && !core::QosScheduler::instance().admit(core::QosScheduler::Work::Visualization)) {
+        video::FrameRef ref(surface);
+        ref.set_timing(timing);
+        return ref;
+    }
 
-    // Combine with OR operation (single-channel OR)
-    cv::bitwise_or(camera_bits.bit1, camera_bits.bit2, camera_bits.combined);
+    // Never overwrite an image the display backend still holds
+    if (!surface.empty() && surface.u->refcount > 1) {
+        surface.release();
+    }
+    const int decay_us = app_state->display_settings().get_time_surface_decay_us();
+    if (!CameraManager::instance().time_surface().render(surface, static_cast<uint32_t>(std::max(decay_us, 1)))) {
+        return video::FrameRef();
+    }
+    video::FrameRef ref(surface);
+    ref.set_timing(timing);
+    return ref;
+}
 
-    // Verify we have single-channel output
-    static bool once = true;
-    if (once) {
-        std::cout << "Bit1 channels=" << camera_bits.bit1.channels() << std::endl;
-        std::cout << "Bit2 channels=" << camera_bits.bit2.channels() << std::endl;
-        std::cout << "Combined channels=" << camera_bits.combined.channels() << std::endl;
-        once = false;
+/**
+ * Bit masks for the shader display (UI thread)
+ */
+video::gpu::GPUBinaryDisplay::Style shader_display_style() {
+    video::gpu::GPUBinaryDisplay::Style style;
+    auto& cam_mgr = CameraManager::instance();
+    if (cam_mgr.is_native_binary()) {
+        // Native frames are already binary; with polarity planes bit 1 = ON and bit 2 = OFF
+        const bool planes = cam_mgr.has_polarity_planes();
+        style.bit1_mask = planes ? video::BinaryFrameAccumulator::ON_BIT : 0xFF;
+        style.bit2_mask = planes ? video::BinaryFrameAccumulator::OFF_BIT : 0xFF;
+    } else {
+        style.bit1_mask = static_cast<uint8_t>(1 << static_cast<int>(app_state->display_settings().get_binary_stream_mode()));
+        style.bit2_mask = static_cast<uint8_t>(1 << static_cast<int>(app_state->display_settings().get_binary_stream_mode_2()));
     }
+    return style;
+}
 
-    // Store in frame buffer for display (single-channel binary image)
-    app_state->frame_buffer(0).store_frame(camera_bits.combined);
+/**
+ * Rebuild the viewer's binary frame from the frame the shader display shows (UI thread)
+ *
+ * The shader display never extracts on the CPU, so this only runs while the
+ * viewer reads the frame (analysis, save) or a reference is taken.
+ */
+void refresh_shader_camera_bits() {
+    if (shader_frame.empty()) return;
+
+    if (CameraManager::instance().is_native_binary()) {
+        camera_bits.combined = shader_frame.unsafe_get();  // Already binary, shared
+        return;
+    }
+
+    // Never overwrite a binary image the viewer still shares
+    if (!camera_bits.combined.empty() && camera_bits.combined.u->refcount > 1) {
+        camera_bits.combined.release();
+    }
+    const auto style = shader_display_style();
+    video::ReadGuard guard(shader_frame);
+    video::simd::extract_bit_mask(guard.get(), camera_bits.combined,
+                                  static_cast<uint8_t>(style.bit1_mask | style.bit2_mask));
+}
+
+/**
+ * Display backend picked at startup (UI thread)
+ */
+struct DisplayBackend {
+    bool gpu_pipeline = false;   // GPU pipeline extracts and displays
+    bool shader = false;         // Fragment shader colours the raw frame
+    bool event_scatter = false;  // Compute shader builds the displayed frame from events
+    bool triple_buffer = false;  // TripleBufferRenderer (else synchronous TextureManager)
+};
+
+/**
+ * Latency stamps of the frame displayed this iteration
+ */
+struct DisplayedFrame {
+    video::FrameTiming timing;
+    int64_t consumed_us = 0;   // 0 = no new frame this iteration
+    int64_t uploaded_us = 0;   // 0 = upload still pending (triple buffer)
+};
+
+/**
+ * Take the newest camera frame and hand it to the display backend (UI thread)
+ *
+ * The triple-buffered backend only gets the frame submitted; its upload
+ * happens in TripleBufferRenderer::update().
+ * @param time_surface_view Show the time surface instead of the frame
+ * @param shown Replaced by the consumed frame's stamps
+ * @return false if no new frame was available (shown untouched)
+ */
+bool latch_display_frame(const DisplayBackend& backend, bool time_surface_view, DisplayedFrame& shown) {
+    auto frame_opt = app_state->frame_buffer(0).consume_frame();
+    if (!frame_opt.has_value()) {
+        return false;
+    }
+    shown = DisplayedFrame{};
+    shown.consumed_us = core::LatencyStats::now_us();
+    shown.timing = frame_opt->timing();
+    if (shown.timing.callback_us > 0) {
+        core::QosScheduler::instance().report_latency(shown.consumed_us - shown.timing.callback_us);
+    }
+
+    if (backend.gpu_pipeline) {
+        // Raw frame goes to the GPU once; display samples the result directly
+        int bit1_pos = static_cast<int>(app_state->display_settings().get_binary_stream_mode());
+        int bit2_pos = static_cast<int>(app_state->display_settings().get_binary_stream_mode_2());
+        uint8_t bit_mask = static_cast<uint8_t>((1 << bit1_pos) | (1 << bit2_pos));
+        {
+            video::ReadGuard guard(*frame_opt);
+            gpu_timer.begin(gpu_pass_compute);
+            gpu_pipeline->process(guard.get(), bit_mask);
+            gpu_timer.end();
+        }
+        if (gpu_view_mode != 0) {
+            // Drawn from the count and reference textures; normalised by the running max
+            const auto mode = gpu_view_mode == 2 ? video::gpu::GPUScatteringView::Mode::HEATMAP
+                                                 : video::gpu::GPUScatteringView::Mode::OVERLAY;
+            gpu_timer.begin(gpu_pass_shader);
+            gpu_scattering_view.render(*gpu_pipeline, mode, gpu_pipeline->get_stats().max_scattering_count);
+            gpu_timer.end();
+        }
+        shown.uploaded_us = core::LatencyStats::now_us();
+    } else if (backend.event_scatter) {
+        // The screen shows the newest window the GPU built from events; the CPU frame is the viewer's
+        video::EventScatterQueue& queue = CameraManager::instance().event_scatter_queue();
+        Metavision::timestamp window_end_ts = 0;
+        if (queue.take(scatter_events, window_end_ts)) {
+            gpu_timer.begin(gpu_pass_compute);
+            gpu_event_scatter->scatter(scatter_events.data(), scatter_events.size(),
+                                       queue.get_width(), queue.get_height());
+            gpu_timer.end();
+        }
+        shown.uploaded_us = core::LatencyStats::now_us();
+        camera_bits.combined = frame_opt->unsafe_get();
+    } else if (backend.shader) {
+        // Raw frame goes to the GPU once; the fragment shader does the bit tests
+        {
+            video::ReadGuard guard(*frame_opt);
+            gpu_timer.begin(gpu_pass_upload);
+            shader_display->upload(guard.get());
+            gpu_timer.end();
+        }
+        gpu_timer.begin(gpu_pass_shader);
+        shader_display->render(shader_display_style());
+        gpu_timer.end();
+        shown.uploaded_us = core::LatencyStats::now_us();
+        shader_frame = std::move(*frame_opt);
+
+        // CPU copy only while the viewer reads it; otherwise drop it so no pool slot stays pinned
+        if (viewer && viewer->wants_camera_frame()) {
+            refresh_shader_camera_bits();
+        } else {
+            camera_bits.combined.release();
+        }
+    } else {
+        // The time surface replaces the frame on screen only; the viewer keeps the binary frame
+        video::FrameRef surface_frame;
+        if (time_surface_view) {
+            surface_frame = render_time_surface_frame(frame_opt->timing());
+        }
+        // Zoomed out, the binned preview looks the same on screen for a fraction of the upload
+        if (surface_frame.empty() && frame_opt->preview_binning() > 1 &&
+            !(viewer && viewer->wants_full_resolution())) {
+            surface_frame = video::FrameRef(frame_opt->preview());
+            surface_frame.set_timing(frame_opt->timing());
+        }
+        const video::FrameRef& displayed = surface_frame.empty() ? frame_opt.value() : surface_frame;
+
+        if (backend.triple_buffer) {
+            // Non-blocking: the render loop uploads in update()
+            app_state->triple_buffer_renderer(0).submit_frame(displayed);
+        } else {
+            gpu_timer.begin(gpu_pass_upload);
+            app_state->upload_camera_frame(0, displayed);
+            gpu_timer.end();
+            shown.uploaded_us = core::LatencyStats::now_us();
+        }
+
+        // Frame is shared, not copied, into the viewer (UI thread only)
+        camera_bits.combined = frame_opt->unsafe_get();
+    }
+    return true;
 }
 
 // ============================================================================
@@ -126,32 +661,44 @@ void process_camera_frame(const cv::Mat& frame) {
 
 /**
  * Apply initial camera settings from config (biases, filters, etc.)
+ *
+ * Runs before the camera streams (start_single_camera's configure step), so
+ * the session never starts with the sensor's default biases.
+ *
+ * @param camera_index Camera to configure (every camera gets the same settings)
  */
-void apply_initial_camera_settings() {
+void apply_initial_camera_settings(int camera_index) {
     auto& config = AppConfig::instance();
     auto& cam_mgr = CameraManager::instance();
 
-    if (!cam_mgr.is_camera_connected(0)) {
-        std::cerr << "Cannot apply settings: camera not connected" << std::endl;
+    if (camera_index < 0 || camera_index >= cam_mgr.num_cameras()) {
+        std::cerr << "Cannot apply settings: camera " << camera_index << " not opened" << std::endl;
         return;
     }
 
     try {
-        auto& camera = cam_mgr.get_camera(0).camera;
+        auto& camera = cam_mgr.get_camera(camera_index).camera;
         if (!camera) return;
 
-        std::cout << "Applying initial camera settings from config..." << std::endl;
+        std::cout << "Applying initial camera settings from config (camera " << camera_index << ")..." << std::endl;
 
-        // Apply analog biases
+        // Apply analog biases (only those that differ from the sensor's)
         auto* ll_biases = camera->get_device().get_facility<Metavision::I_LL_Biases>();
         if (ll_biases) {
-            ll_biases->set("bias_diff", config.camera_settings().bias_diff);
-            ll_biases->set("bias_diff_on", config.camera_settings().bias_diff_on);
-            ll_biases->set("bias_diff_off", config.camera_settings().bias_diff_off);
-            ll_biases->set("bias_fo", config.camera_settings().bias_fo);
-            ll_biases->set("bias_hpf", config.camera_settings().bias_hpf);
-            ll_biases->set("bias_refr", config.camera_settings().bias_refr);
-            std::cout << "  - Applied analog biases" << std::endl;
+            const auto& cam_settings = config.camera_settings();
+            const int written = CameraManager::write_biases(ll_biases, {
+                {"bias_diff", cam_settings.bias_diff},
+                {"bias_diff_on", cam_settings.bias_diff_on},
+                {"bias_diff_off", cam_settings.bias_diff_off},
+                {"bias_fo", cam_settings.bias_fo},
+                {"bias_hpf", cam_settings.bias_hpf},
+                {"bias_refr", cam_settings.bias_refr},
+            });
+            if (written >= 0) {
+                std::cout << "  - Applied analog biases (" << written << " changed)" << std::endl;
+            } else {
+                std::cerr << "  - Some analog biases were refused by the sensor" << std::endl;
+            }
         }
 
         // Apply trail filter
@@ -177,157 +724,3078 @@ void apply_initial_camera_settings() {
 }
 
 /**
- * Initialize camera
+ * Configure the software noise filter from config (after the frame builder exists)
  */
-bool initialize_camera() {
-    try {
-        auto& config = AppConfig::instance();
+void apply_noise_filter_settings() {
+    const auto& cam_settings = AppConfig::instance().camera_settings();
+    auto& cam_mgr = CameraManager::instance();
+    for (int i = 0; i < cam_mgr.num_pipelines(); ++i) {
+        auto& pipeline_filter = cam_mgr.noise_filter(i);
+        pipeline_filter.set_threshold_us(static_cast<uint32_t>(std::max(cam_settings.noise_filter_threshold_us, 0)));
+        pipeline_filter.set_enabled(cam_settings.noise_filter_enabled);
+    }
+    const auto& filter = cam_mgr.noise_filter();
+    if (cam_settings.noise_filter_enabled) {
+        std::cout << "Software noise filter: " << filter.get_threshold_us() << " us ("
+                  << video::EventNoiseFilter::path_name(filter.get_path()) << ")" << std::endl;
+    }
+}
+
+/**
+ * Hot pixel mask file of a camera: hot_pixel_mask_file, with "_cam<N>" before the extension for N > 0
+ */
+std::string hot_pixel_mask_path(int index) {
+    std::filesystem::path path = AppConfig::instance().camera_settings().hot_pixel_mask_file;
+    if (index > 0) {
+        path.replace_filename(path.stem().string() + "_cam" + std::to_string(index) + path.extension().string());
+    }
+    return path.string();
+}
+
+/**
+ * Drop a camera's known hot pixels (hot_pixel_suppress)
+ *
+ * With hot_pixel_suppress_hardware the sensor's digital event mask takes as
+ * many pixels as it has slots (on the camera-control thread); whatever it
+ * cannot take, or all of them without the facility, goes to the pipeline's
+ * ingestion mask.
+ *
+ * @param index Camera index
+ * @param mask Known hot pixels in frame coordinates (empty = release the mask)
+ */
+void suppress_hot_pixels(int index, const video::BinaryFrame& mask) {
+    const auto& cam_settings = AppConfig::instance().camera_settings();
+    auto& cam_mgr = CameraManager::instance();
+    if (!cam_settings.hot_pixel_suppress || index >= core::AppState::MAX_CAMERAS) {
+        return;
+    }
+    cam_mgr.pixel_mask(index).set_enabled(true);
+    const bool hardware = cam_settings.hot_pixel_suppress_hardware && !cam_mgr.is_replay() &&
+                          index < cam_mgr.num_cameras() && cam_mgr.is_camera_connected(index);
+    if (!hardware) {
+        cam_mgr.pixel_mask(index).set_mask(mask);
+        if (!mask.empty()) {
+            std::cout << "Hot pixel suppression: camera " << index << ": " << mask.count() << " pixels at ingestion"
+                      << std::endl;
+        }
+        return;
+    }
+
+    // Register writes run on the camera-control thread, not in the caller
+    const cv::Point origin = cam_mgr.get_frame_origin(index);
+    EventCamera::ControlQueue::instance().post("hot_pixels.mask", [index, mask, origin] {
         auto& cam_mgr = CameraManager::instance();
+        video::BinaryFrame remaining = mask;
+        if (cam_mgr.is_camera_connected(index)) {
+            auto* masks = cam_mgr.get_camera(index).camera->get_device().get_facility<Metavision::I_DigitalEventMask>();
+            try {
+                CameraManager::write_pixel_masks(masks, mask, origin, remaining);
+            } catch (const std::exception& e) {
+                std::cerr << "Hot pixel suppression: failed to program the sensor mask: " << e.what() << std::endl;
+                remaining = mask;   // Masking a pixel twice is harmless, missing one is not
+            }
+        }
+        const int64_t in_hardware = mask.count() - remaining.count();
+        hardware_masked_pixels[index] = static_cast<int>(in_hardware);
+        cam_mgr.pixel_mask(index).set_mask(remaining);
+        if (!mask.empty()) {
+            std::cout << "Hot pixel suppression: camera " << index << ": " << in_hardware << " pixels in the sensor mask, "
+                      << remaining.count() << " at ingestion" << std::endl;
+        }
+    });
+}
 
-        if (!cam_mgr.initialize_single_camera(config.camera_settings().accumulation_time_us)) {
-            std::cerr << "Failed to initialize camera" << std::endl;
-            return false;
+/**
+ * Hand every camera's calibrated hot pixel mask (if saved) to its rate monitor and, with hot_pixel_suppress, drop its events
+ */
+void apply_known_hot_pixels() {
+    if (AppConfig::instance().camera_settings().hot_pixel_mask_file.empty()) {
+        return;
+    }
+    auto& cam_mgr = CameraManager::instance();
+    for (int i = 0; i < cam_mgr.num_pipelines(); ++i) {
+        // A dark calibration must see the hot pixels it is looking for
+        if (AppConfig::instance().runtime_settings().dark_calibration) {
+            suppress_hot_pixels(i, video::BinaryFrame());
+            cam_mgr.pixel_mask(i).set_enabled(false);
+            continue;
+        }
+        video::BinaryFrame mask;
+        video::HotPixelMaskInfo info;
+        const std::string path = hot_pixel_mask_path(i);
+        if (!video::load_hot_pixel_mask(path, mask, info)) {
+            continue;
+        }
+        const cv::Size frame_size = cam_mgr.get_frame_size(i);
+        if (mask.size() != frame_size) {
+            std::cerr << "Hot pixel mask " << path << " is " << mask.width() << "x" << mask.height()
+                      << ", camera " << i << " frames are " << frame_size.width << "x" << frame_size.height
+                      << " - ignored (calibrate again)" << std::endl;
+            continue;
         }
+        cam_mgr.pixel_rates(i).set_known_hot(mask);
+        suppress_hot_pixels(i, mask);
+        std::cout << "Known hot pixels: " << info.pixel_count << " from " << path << " (" << info.duration_ms / 1000
+                  << " s dark, > " << info.threshold_hz << " ev/s)" << std::endl;
+    }
+}
 
-        std::cout << "Camera initialized successfully" << std::endl;
-        return true;
+/**
+ * Configure the per-pixel rate monitor, interval histograms and line defect detector of every camera from config
+ */
+void apply_pixel_rate_settings() {
+    const auto& cam_settings = AppConfig::instance().camera_settings();
+    auto& cam_mgr = CameraManager::instance();
+    for (int i = 0; i < cam_mgr.num_pipelines(); ++i) {
+        auto& monitor = cam_mgr.pixel_rates(i);
+        monitor.set_half_life_ms(cam_settings.pixel_rate_half_life_ms);
+        monitor.set_sigma(cam_settings.pixel_rate_sigma);
+        monitor.set_enabled(cam_settings.pixel_rate_monitor_enabled);
+        cam_mgr.event_intervals(i).set_enabled(cam_settings.event_interval_histogram);
+    }
+    apply_known_hot_pixels();
+    if (cam_settings.pixel_rate_monitor_enabled) {
+        std::cout << "Hot pixel monitor: " << cam_mgr.pixel_rates().get_half_life_ms() << " ms half-life, "
+                  << cam_mgr.pixel_rates().get_sigma() << " sigma" << std::endl;
+    }
+
+    for (int i = 0; i < cam_mgr.num_pipelines(); ++i) {
+        auto& detector = cam_mgr.line_defects(i);
+        detector.set_threshold(cam_settings.line_defect_sigma, cam_settings.line_defect_min_fill,
+                               cam_settings.line_defect_min_frames);
+        detector.set_enabled(cam_settings.line_defect_enabled);
+    }
+    if (cam_settings.line_defect_enabled) {
+        std::cout << "Line defect detector: " << cam_mgr.line_defects().get_sigma() << " sigma, "
+                  << cam_mgr.line_defects().get_min_fill() * 100.0f << " % fill, "
+                  << cam_mgr.line_defects().get_min_frames() << " frames" << std::endl;
+    }
+
+    for (int i = 0; i < cam_mgr.num_pipelines(); ++i) {
+        auto& analyzer = cam_mgr.pixel_toggles(i);
+        analyzer.set_threshold(cam_settings.toggle_window_frames, cam_settings.toggle_stuck_frames,
+                               cam_settings.toggle_flicker_rate);
+        analyzer.set_enabled(cam_settings.toggle_analysis_enabled);
+    }
+    if (cam_settings.toggle_analysis_enabled) {
+        std::cout << "Pixel toggle analysis: " << cam_mgr.pixel_toggles().get_window_frames() << " frame windows, stuck after "
+                  << cam_mgr.pixel_toggles().get_stuck_frames() << " frames, flicker at "
+                  << cam_mgr.pixel_toggles().get_flicker_rate() << " toggles/frame" << std::endl;
+    }
+}
+
+/**
+ * Turn the flicker estimator of every camera on or off from config
+ */
+void apply_flicker_settings() {
+    const auto& cam_settings = AppConfig::instance().camera_settings();
+    auto& cam_mgr = CameraManager::instance();
+    for (int i = 0; i < cam_mgr.num_pipelines(); ++i) {
+        cam_mgr.flicker(i).set_enabled(cam_settings.antiflicker_auto);
+    }
+    if (cam_settings.antiflicker_auto) {
+        std::cout << "Anti-flicker band: automatic (+/- " << cam_settings.antiflicker_auto_margin_hz << " Hz)"
+                  << std::endl;
+    }
+}
+
+/**
+ * Open the shared-memory ring for external readers from config (after the frame builder exists)
+ */
+void apply_shared_memory_settings() {
+    const auto& runtime = AppConfig::instance().runtime_settings();
+    auto& cam_mgr = CameraManager::instance();
+    if (!runtime.shm_publish) {
+        return;
+    }
+    video::SharedMemoryPublisher::Options options;
+    options.name = runtime.shm_name;
+    options.frame_slots = runtime.shm_frame_slots;
+    options.packed = runtime.shm_packed;
+    options.event_slots = runtime.shm_event_slots;
+    options.event_slot_events = runtime.shm_event_slot_events;
+    cam_mgr.start_publishing(options);
+}
+
+/**
+ * Merge every camera's events in host time from config (after the frame builders exist, two or more cameras)
+ */
+void apply_stream_merge() {
+    const auto& cam_settings = AppConfig::instance().camera_settings();
+    auto& cam_mgr = CameraManager::instance();
+    if (!cam_settings.merge_streams || cam_mgr.num_pipelines() < 2) {
+        return;
+    }
+    video::StreamMerger::Options options;
+    options.window_us = static_cast<uint32_t>(std::max(
+        cam_settings.merge_window_us > 0 ? cam_settings.merge_window_us : cam_settings.accumulation_time_us, 1));
+    options.buffer_events = static_cast<size_t>(std::max(cam_settings.merge_buffer_events, 1));
+    options.max_wait_ms = cam_settings.merge_max_wait_ms;
+    cam_mgr.start_merging(options, [](const video::StreamMerger::Window& window) {
+        const int64_t a = window.frames[0].count();
+        const int64_t b = window.frames[1].count();
+        const int64_t differing = video::BinaryFrame::count_xor(window.frames[0], window.frames[1]);
+        if (differing < 0) {
+            return;  // Sensors of different sizes: no pixel correspondence
+        }
+        const int64_t both = (a + b - differing) / 2;
+        merge_active[0].store(a, std::memory_order_relaxed);
+        merge_active[1].store(b, std::memory_order_relaxed);
+        merge_coincident.store(both, std::memory_order_relaxed);
+        if (both + differing > 0) {
+            const double agreement = static_cast<double>(both) / (both + differing);
+            const double mean = merge_agreement.load(std::memory_order_relaxed);
+            merge_agreement.store(mean + 0.01 * (agreement - mean), std::memory_order_relaxed);
+        }
+    });
+}
+
+/**
+ * Load and start the analyzer plugins listed in config (';'-separated library paths)
+ */
+void start_analyzer_plugins() {
+    const auto& runtime = AppConfig::instance().runtime_settings();
+    auto& analyzers = CameraManager::instance().analyzers();
+
+    std::stringstream list(runtime.analyzer_plugins);
+    std::string path;
+    while (std::getline(list, path, ';')) {
+        const size_t first = path.find_first_not_of(" \t");
+        if (first == std::string::npos) {
+            continue;
+        }
+        analyzers.load(path.substr(first, path.find_last_not_of(" \t") - first + 1));
+    }
+    analyzers.start(runtime.analyzer_threads);
+}
+
+/**
+ * Build and start the consumer stages listed in pipeline_stages
+ *
+ * Stage kinds:
+ * - stream: frames channel -> remote viewers (replaces the direct submit; needs stream_enabled)
+ * - window_log: window_stats channel -> stage_<name>_<timestamp>.csv in the capture directory
+ * @param render_loop The UI loop drains gpu stages; otherwise they get a thread
+ */
+void start_pipeline_stages(bool render_loop) {
+    const auto& runtime = AppConfig::instance().runtime_settings();
+    std::vector<StageGraph::StageSpec> specs;
+    StageGraph::parse(runtime.pipeline_stages, specs);
+
+    auto& bus = PipelineBus::instance();
+    bool stream_stage = false;
+    for (const StageGraph::StageSpec& spec : specs) {
+        if (spec.kind == "stream") {
+            if (!runtime.stream_enabled || stream_stage) {
+                std::cerr << "Stage " << spec.name << ": needs stream_enabled = 1 and one stream stage, skipped" << std::endl;
+                continue;
+            }
+            stream_stage = true;
+            stage_graph.add_stage<PipelineBus::FrameMessage>(spec, bus.frames(), [](const PipelineBus::FrameMessage& message) {
+                const video::FrameRef& frame = message.frame;
+                const int64_t timestamp_us = frame.timing().camera_ts;
+                if (!frame.preview().empty() && AppConfig::instance().runtime_settings().stream_preview) {
+                    frame_streamer.submit(message.camera_index, timestamp_us, frame.preview(), frame.preview_binning());
+                } else {
+                    frame_streamer.submit(message.camera_index, timestamp_us, frame.read());
+                }
+            });
+        } else if (spec.kind == "window_log") {
+            const std::filesystem::path path = recording_output_directory() /
+                ("stage_" + spec.name + "_" + ImageManager::generate_timestamp() + ".csv");
+            auto file = std::make_shared<std::ofstream>(path);
+            if (!file->is_open()) {
+                std::cerr << "Stage " << spec.name << ": cannot open " << path.string() << ", skipped" << std::endl;
+                continue;
+            }
+            *file << "camera,window_index,window_end_ts,window_us,events,on_events,x_min,x_max,y_min,y_max\n";
+            stage_graph.add_stage<PipelineBus::WindowStatsMessage>(spec, bus.window_stats(),
+                [file](const PipelineBus::WindowStatsMessage& message) {
+                    const auto& window = message.window;
+                    const auto& stats = window.stats;
+                    *file << message.camera_index << "," << window.window_index << "," << window.window_end_ts << ","
+                          << window.window_us << "," << stats.events << "," << stats.on_events << ",";
+                    if (stats.empty()) {
+                        *file << ",,,\n";
+                    } else {
+                        *file << stats.x_min << "," << stats.x_max << "," << stats.y_min << "," << stats.y_max << "\n";
+                    }
+                });
+        } else {
+            std::cerr << "Stage " << spec.name << ": unknown kind \"" << spec.kind << "\", skipped" << std::endl;
+        }
+    }
+
+    stage_graph.start(runtime.pipeline_stage_threads, render_loop);
+    stream_stage_active = stream_stage && stage_graph.is_running();
+}
+
+/**
+ * Change accumulation time and binary bits while running (display, config and every frame builder)
+ */
+void apply_frame_parameters(int accumulation_time_us, int bit_1, int bit_2) {
+    auto& cam_settings = AppConfig::instance().camera_settings();
+    cam_settings.accumulation_time_us = std::clamp(accumulation_time_us, 100, 100000);
+    cam_settings.binary_bit_1 = std::clamp(bit_1, 0, 7);
+    cam_settings.binary_bit_2 = std::clamp(bit_2, 0, 7);
+
+    // The SDK generator path and the GPU pipeline read the bits from here every frame
+    auto& display = app_state->display_settings();
+    display.set_binary_stream_mode(static_cast<core::DisplaySettings::BinaryStreamMode>(cam_settings.binary_bit_1));
+    display.set_binary_stream_mode_2(static_cast<core::DisplaySettings::BinaryStreamMode>(cam_settings.binary_bit_2));
+
+    CameraManager::instance().set_frame_parameters(cam_settings.accumulation_time_us,
+                                                   cam_settings.binary_bit_1, cam_settings.binary_bit_2);
+}
+
+/**
+ * Switch native frames to event-count slicing from config (after the frame builder exists)
+ */
+void apply_frame_slicing() {
+    const auto& cam_settings = AppConfig::instance().camera_settings();
+    const int mode = std::clamp(cam_settings.slice_mode, 0, 2);
+    if (mode != cam_settings.slice_mode) {
+        std::cerr << "slice_mode = " << cam_settings.slice_mode << " out of range, using " << mode << std::endl;
+    }
+    CameraManager::instance().set_frame_slicing(static_cast<video::BinaryFrameAccumulator::SliceMode>(mode),
+                                                cam_settings.slice_events);
+}
+
+/**
+ * Start or stop adapting the accumulation time of every camera from config
+ * (after slicing and accumulation windows are set up)
+ */
+void apply_adaptive_accumulation() {
+    auto& cam_mgr = CameraManager::instance();
+    const auto& cam_settings = AppConfig::instance().camera_settings();
+    bool enabled = cam_settings.accumulation_adaptive;
+    if (enabled && (!cam_mgr.is_native_binary() || cam_settings.slice_mode != 0 || cam_mgr.get_window_levels() > 0)) {
+        std::cerr << "Adaptive accumulation needs time-sliced native frames without accumulation windows, "
+                  << "window stays " << cam_settings.accumulation_time_us << " μs" << std::endl;
+        enabled = false;
+    }
+
+    const auto target = cam_settings.accumulation_adaptive_target == 1 ? video::AccumulationController::Target::Occupancy
+                                                                       : video::AccumulationController::Target::Events;
+    const double value = target == video::AccumulationController::Target::Occupancy
+                             ? static_cast<double>(cam_settings.accumulation_adaptive_occupancy)
+                             : static_cast<double>(cam_settings.accumulation_adaptive_events);
+    for (int i = 0; i < cam_mgr.num_pipelines(); ++i) {
+        auto& control = cam_mgr.accumulation_control(i);
+        const bool was_enabled = control.is_enabled();
+        control.configure(target, value, cam_settings.accumulation_adaptive_min_us,
+                          cam_settings.accumulation_adaptive_max_us);
+        control.set_enabled(enabled);
+        if (was_enabled && !enabled) {
+            // Back to the configured window
+            cam_mgr.set_frame_parameters(cam_settings.accumulation_time_us, cam_settings.binary_bit_1,
+                                         cam_settings.binary_bit_2);
+        }
+    }
+    if (enabled) {
+        std::cout << "Adaptive accumulation: " << cam_settings.accumulation_adaptive_min_us << "-"
+                  << cam_settings.accumulation_adaptive_max_us << " μs, target " << value
+                  << (target == video::AccumulationController::Target::Occupancy ? " of pixels set" : " events")
+                  << " per frame" << std::endl;
+    }
+}
+
+/**
+ * Build the coarse accumulation windows from config and hook up their consumers
+ * (after the frame builder exists)
+ */
+void apply_accumulation_windows() {
+    auto& cam_mgr = CameraManager::instance();
+    const auto& cam_settings = AppConfig::instance().camera_settings();
+    const int levels = cam_mgr.set_accumulation_windows(
+        video::WindowPyramid::parse_windows(cam_settings.accumulation_windows_us));
+
+    auto& registry = core::MetricsRegistry::instance();
+    for (int level = 0; level < levels; ++level) {
+        const std::string name = "frames.window_" + std::to_string(cam_mgr.get_window_us(level)) + "us";
+        for (int i = 0; i < core::AppState::MAX_CAMERAS; ++i) {
+            window_views[i][level].gauge = &registry.gauge(
+                i == 0 ? name + ".active_percent" : name + ".camera" + std::to_string(i) + ".active_percent");
+        }
+
+        // Runs on each camera's accumulation thread, once per window
+        cam_mgr.set_window_consumer(level, [level](const video::BinaryFrame& frame, Metavision::timestamp, int camera_index) {
+            const double pixels = static_cast<double>(frame.width()) * frame.height();
+            const double percent = pixels > 0 ? 100.0 * static_cast<double>(frame.count()) / pixels : 0.0;
+            WindowView& view = window_views[camera_index][level];
+            view.active_percent.store(percent, std::memory_order_relaxed);
+            view.gauge->set(percent);
+        });
+    }
+}
+
+/**
+ * Live-frame bits the scattering analysis counts as active for a polarity name
+ * @param polarity "both", "on" or "off" (on/off need polarity planes)
+ */
+uint8_t scattering_live_mask(const std::string& polarity) {
+    if (polarity != "on" && polarity != "off") {
+        return 0xFF;
+    }
+    if (!CameraManager::instance().has_polarity_planes()) {
+        std::cerr << "scattering_polarity = " << polarity << " needs polarity_planes, analyzing both" << std::endl;
+        return 0xFF;
+    }
+    return polarity == "on" ? video::BinaryFrameAccumulator::ON_BIT : video::BinaryFrameAccumulator::OFF_BIT;
+}
+
+/**
+ * Check if every running scattering worker reports a converged rate
+ * @return false if no worker is analyzing
+ */
+bool scattering_converged(core::AppState& state, int camera_count) {
+    bool any = false;
+    for (int i = 0; i < camera_count; ++i) {
+        ScatteringWorker& worker = state.scattering_worker(i);
+        if (!worker.is_running()) {
+            continue;
+        }
+        auto snapshot = worker.get_snapshot();
+        if (worker.is_building_reference() || !snapshot || !snapshot->scattering_converged) {
+            return false;
+        }
+        any = true;
+    }
+    return any;
+}
+
+/**
+ * Fill the thread placement table from [Threads] (before any pipeline thread starts)
+ */
+void apply_thread_settings() {
+    const auto& threads = AppConfig::instance().thread_settings();
+    auto& placements = core::ThreadPlacements::instance();
+
+    auto set_stage = [&placements](core::ThreadStage stage, const std::string& cores, const std::string& priority,
+                                   const std::string& mmcss_task = "") {
+        core::ThreadPlacement placement;
+        placement.cores = core::ThreadPlacements::parse_cores(cores);
+        placement.mmcss_task = mmcss_task;
+        if (!core::ThreadPlacements::parse_priority(priority, placement.priority)) {
+            std::cerr << "Unknown " << core::ThreadPlacements::stage_name(stage) << " priority '" << priority
+                      << "', using normal" << std::endl;
+        }
+        placements.set(stage, placement);
+    };
+    set_stage(core::ThreadStage::Decode, threads.decode_cores, threads.decode_priority, threads.decode_mmcss);
+    set_stage(core::ThreadStage::Accumulation, threads.accumulation_cores, threads.accumulation_priority,
+              threads.accumulation_mmcss);
+    set_stage(core::ThreadStage::Analysis, threads.analysis_cores, threads.analysis_priority);
+    set_stage(core::ThreadStage::IO, threads.io_core, threads.io_priority);
+    set_stage(core::ThreadStage::UI, threads.ui_core, threads.ui_priority);
+    placements.set_isolate_decode(threads.decode_isolate);
+
+    // Before any ring or pool allocates
+    core::LockedMemory::Options memory;
+    memory.lock = threads.lock_buffers;
+    memory.large_pages = threads.large_pages;
+    core::LockedMemory::instance().configure(memory);
+}
+
+/**
+ * Dispatch each SIMD kernel to the fastest tier on this machine (before any pipeline thread starts)
+ */
+void tune_backends() {
+    const auto& runtime = AppConfig::instance().runtime_settings();
+    video::BackendTuner::Options options;
+    options.cache_path = runtime.backend_cache;
+    options.overrides = runtime.backend_overrides;
+    options.measure = runtime.backend_autotune && !runtime.fleet_aggregate;
+
+    video::BackendTuner tuner;
+    if (!tuner.run(options)) {
+        return;
+    }
+    std::cout << "Backends (" << (tuner.is_from_cache() ? "cached" : "measured") << "):";
+    for (const auto& choice : tuner.get_choices()) {
+        std::cout << " " << choice.kernel << "=" << choice.backend << (choice.overridden ? "*" : "");
+    }
+    std::cout << std::endl;
+    if (!tuner.is_from_cache()) {
+        for (const auto& choice : tuner.get_choices()) {
+            if (!choice.timings.empty()) {
+                std::cout << "  " << choice.kernel << ": " << choice.timings << std::endl;
+            }
+        }
+    }
+}
+
+/**
+ * Fault in pools, event rings, GL resources and kernels before the camera streams
+ *
+ * Otherwise the first frames pay for page faults, driver-side texture and
+ * PBO allocation, shader compilation and the SIMD dispatch, and the frame
+ * time histograms open with a spike that is not the pipeline's.
+ * @param gl GL context current (GUI); headless only warms CPU-side state
+ */
+void warm_up_pipeline(bool gl) {
+    const auto& runtime = AppConfig::instance().runtime_settings();
+    auto& cam_mgr = CameraManager::instance();
+    if (!runtime.warmup || !app_state || cam_mgr.num_pipelines() == 0) {
+        return;
+    }
+    const auto started = std::chrono::steady_clock::now();
+
+    // Raw color frames only travel the pool when a GPU backend extracts from them
+    const bool native = cam_mgr.is_native_binary();
+    const bool raw_frames = !native && (gpu_pipeline_active || shader_display_active);
+    const int cameras = std::min(cam_mgr.num_pipelines(), static_cast<int>(core::AppState::MAX_CAMERAS));
+    for (int i = 0; i < cameras; ++i) {
+        app_state->frame_pool(i).prefault(cam_mgr.get_frame_size(i), raw_frames && i == 0 ? CV_8UC3 : CV_8UC1);
+    }
+    cam_mgr.prefault_event_rings();
+
+    const cv::Size size = cam_mgr.get_frame_size(0);
+    const double kernels_ms = video::BackendTuner::warm_up(size.width, size.height);
+
+    if (gl) {
+        if (gpu_pipeline_active && !native) {
+            gpu_pipeline->prepare(size.width, size.height, 3);
+        }
+        if (shader_display_active) {
+            shader_display->prepare(size.width, size.height, native ? 1 : 3);
+        }
+        if (gpu_event_scatter) {
+            gpu_event_scatter->prepare(size.width, size.height);
+        } else if (runtime.triple_buffer_display) {
+            app_state->triple_buffer_renderer(0).prepare(size.width, size.height, 1);
+        } else {
+            for (int i = 0; i < cameras; ++i) {
+                app_state->texture_cache().prepare(cam_mgr.get_frame_size(i), 1);
+            }
+        }
+        glFinish();   // Driver work happens now, not on the first displayed frame
+    }
+
+    const auto programs = video::gpu::get_program_cache_stats();
+    const auto total_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+    std::cout << "Warm-up: " << total_ms << " ms (kernels " << static_cast<int64_t>(std::lround(kernels_ms)) << " ms";
+    if (gl) {
+        std::cout << ", programs: " << programs.loaded << " cached, " << programs.compiled << " compiled";
+    }
+    std::cout << ")" << std::endl;
+}
+
+/**
+ * Serials opened by the previous session, in camera order (camera_serial_cache)
+ */
+std::vector<std::string> load_cached_serials() {
+    std::vector<std::string> serials;
+    const std::string& path = AppConfig::instance().camera_settings().camera_serial_cache;
+    if (path.empty()) {
+        return serials;
+    }
+
+    std::ifstream file(path);
+    std::string serial;
+    while (std::getline(file, serial)) {
+        if (!serial.empty()) {
+            serials.push_back(serial);
+        }
+    }
+    return serials;
+}
+
+/**
+ * Remember the opened cameras for the next start (camera_serial_cache)
+ */
+void save_cached_serials() {
+    const std::string& path = AppConfig::instance().camera_settings().camera_serial_cache;
+    if (path.empty()) {
+        return;
+    }
+
+    std::ofstream file(path, std::ios::trunc);
+    for (const auto& camera : CameraManager::instance().get_cameras()) {
+        file << camera.serial << "\n";
+    }
+    if (!file.good()) {
+        std::cerr << "Failed to write camera serial cache " << path << std::endl;
+    }
+}
+
+/**
+ * Initialize camera
+ */
+bool initialize_camera() {
+    try {
+        auto& config = AppConfig::instance();
+        auto& cam_mgr = CameraManager::instance();
+
+        const auto& cam_settings = config.camera_settings();
+        const auto& runtime = config.runtime_settings();
+        const cv::Rect roi = cam_settings.roi_enabled
+            ? cv::Rect(cam_settings.roi_x, cam_settings.roi_y, cam_settings.roi_width, cam_settings.roi_height)
+            : cv::Rect();
+        if (!runtime.replay_file.empty()) {
+            if (!cam_mgr.initialize_replay(runtime.replay_file,
+                                           cam_settings.accumulation_time_us,
+                                           cam_settings.native_accumulation,
+                                           cam_settings.binary_bit_1,
+                                           cam_settings.binary_bit_2,
+                                           roi)) {
+                std::cerr << "Failed to open replay file" << std::endl;
+                return false;
+            }
+            cam_mgr.replay()->set_loop(runtime.replay_loop);
+            cam_mgr.replay()->set_start_offset_us(static_cast<int64_t>(runtime.replay_start_s * 1e6));
+            cam_mgr.replay()->set_decode_threads(std::max(runtime.replay_decode_threads, 0));
+            cam_mgr.set_polarity_planes(cam_settings.polarity_planes);
+            cam_mgr.set_preview_binning(cam_settings.preview_binning);
+            cam_mgr.set_accumulation_threads(cam_settings.accumulation_threads);
+            apply_frame_slicing();
+            apply_accumulation_windows();
+            apply_adaptive_accumulation();
+            apply_noise_filter_settings();
+            apply_pixel_rate_settings();
+            apply_flicker_settings();
+            apply_shared_memory_settings();
+            return true;
+        }
+
+        // Every camera gets its own frame path in AppState, so that bounds the count
+        const int camera_count = std::clamp(cam_settings.camera_count, 1, core::AppState::MAX_CAMERAS);
+        if (camera_count != cam_settings.camera_count) {
+            std::cerr << "camera_count = " << cam_settings.camera_count << " out of range, using "
+                      << camera_count << std::endl;
+        }
+        if (cam_mgr.initialize_cameras(camera_count,
+                                       cam_settings.accumulation_time_us,
+                                       cam_settings.native_accumulation,
+                                       cam_settings.binary_bit_1,
+                                       cam_settings.binary_bit_2,
+                                       roi,
+                                       load_cached_serials()) == 0) {
+            std::cerr << "Failed to initialize camera" << std::endl;
+            return false;
+        }
+        save_cached_serials();
+        cam_mgr.set_latency_budget(cam_settings.latency_budget_ms,
+                                   static_cast<CameraManager::LatencyShedMode>(cam_settings.latency_shed_mode));
+
+        cam_mgr.set_polarity_planes(cam_settings.polarity_planes);
+        cam_mgr.set_preview_binning(cam_settings.preview_binning);
+        cam_mgr.set_accumulation_threads(cam_settings.accumulation_threads);
+        // Raw decode skips the event stages, the scattering event tap, dark calibration, the latency map and the stream merge among them
+        cam_mgr.set_raw_decode(cam_settings.raw_decode && cam_settings.native_accumulation &&
+                               !AppConfig::instance().runtime_settings().scattering_event_mode &&
+                               !AppConfig::instance().runtime_settings().dark_calibration &&
+                               !cam_settings.trigger_latency_map && !cam_settings.merge_streams);
+        cam_mgr.set_trigger_capture(cam_settings.trigger_capture, cam_settings.trigger_window_us);
+        cam_mgr.set_trigger_latency(cam_settings.trigger_latency_map, cam_settings.trigger_latency_window_us);
+        apply_frame_slicing();
+        apply_accumulation_windows();
+        apply_adaptive_accumulation();
+        apply_noise_filter_settings();
+        apply_pixel_rate_settings();
+        apply_flicker_settings();
+        apply_shared_memory_settings();
+        apply_stream_merge();
+        std::cout << "Camera initialized successfully" << std::endl;
+        return true;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Camera initialization error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+/**
+ * Start the initialized camera (or replay) with the frame callback
+ * @param configured Initial settings already applied (skips the pre-start configure step)
+ * @return true if frames are flowing
+ */
+bool start_camera(bool configured = false) {
+    std::cout << "\nStarting camera..." << std::endl;
+
+    auto& cam_mgr = CameraManager::instance();
+    const double replay_speed = AppConfig::instance().runtime_settings().replay_speed;
+
+    // Unpaced replay outruns the UI; let the frame queue wait for analysis instead of dropping
+    if (cam_mgr.is_replay() && replay_speed <= 0.0) {
+        app_state->set_lossless_frame_queues(true);
+    }
+
+    // Runs on each camera's own accumulation thread
+    auto callback = [&cam_mgr](const cv::Mat& frame, int camera_index) {
+        if (cam_mgr.is_native_binary()) {
+            store_binary_frame(frame, camera_index);
+        } else if ((gpu_pipeline_active || shader_display_active) && camera_index == 0) {
+            store_raw_frame(frame);
+        } else {
+            process_camera_frame(frame, camera_index);
+        }
+    };
+
+    CameraManager::ConfigureCallback configure;
+    if (!configured) {
+        configure = apply_initial_camera_settings;
+    }
+    if (!cam_mgr.start_single_camera(callback, replay_speed, configure)) {
+        std::cerr << "Failed to start camera" << std::endl;
+        return false;
+    }
+    if (!cam_mgr.is_replay()) {
+        std::cout << "Camera started successfully" << std::endl;
+
+        const auto& cam_settings = AppConfig::instance().camera_settings();
+        if (cam_settings.erc_auto) {
+            core::ErcController::Settings erc;
+            erc.min_rate_kevps = cam_settings.erc_min_kevps;
+            erc.max_rate_kevps = cam_settings.erc_max_kevps;
+            erc.high_water_percent = cam_settings.erc_high_water_percent;
+            erc.low_water_percent = cam_settings.erc_low_water_percent;
+            cam_mgr.start_erc_control(erc, cam_settings.erc_interval_ms);
+        }
+        if (cam_settings.monitoring_interval_ms > 0) {
+            cam_mgr.start_monitoring(cam_settings.monitoring_interval_ms);
+        }
+
+        // The sweep and the optimizer drive the biases themselves; a reopen would undo them
+        const auto& runtime = AppConfig::instance().runtime_settings();
+        if (cam_settings.reconnect_stall_ms > 0 && !runtime.bias_sweep && !runtime.ga_optimize) {
+            cam_mgr.start_watchdog(cam_settings.reconnect_stall_ms, apply_initial_camera_settings);
+        }
+    }
+    return true;
+}
+
+/**
+ * Start a raw event recording in the configured recording directory
+ */
+void start_event_recording() {
+    const auto& cam_settings = AppConfig::instance().camera_settings();
+    std::filesystem::path path = recording_output_directory() /
+        ("events_" + ImageManager::generate_timestamp() + ".rtev");
+    uint64_t preallocate_bytes = static_cast<uint64_t>(std::max(cam_settings.recording_preallocate_mb, 0)) << 20;
+    CameraManager::instance().start_recording(path.string(), preallocate_bytes,
+                                              std::max(cam_settings.recording_compress_threads, 0));
+}
+
+/**
+ * Arm burst capture with the configured pre/post-trigger windows
+ */
+void arm_burst_capture() {
+    const auto& cam_settings = AppConfig::instance().camera_settings();
+    const cv::Size size = CameraManager::instance().get_frame_size();
+    if (size.area() <= 0 || cam_settings.accumulation_time_us <= 0) {
+        return;
+    }
+    if (!core::MemoryBudget::instance().admit()) {
+        std::cout << "Burst not armed: over memory_budget_mb = " << cam_settings.memory_budget_mb << std::endl;
+        return;
+    }
+
+    // One frame per accumulation period
+    const double fps = 1e6 / cam_settings.accumulation_time_us;
+    double pre_frames = std::max(0.0, cam_settings.burst_pre_s) * fps;
+    double post_frames = std::max(1.0, std::max(0.0, cam_settings.burst_post_s) * fps);
+
+    // Shrink both windows evenly to fit the RAM cap
+    const double frame_bytes = ((size.width + 63) / 64) * 8.0 * size.height;
+    const double max_frames = std::max(cam_settings.burst_max_mb, 1) * 1024.0 * 1024.0 / frame_bytes;
+    if (pre_frames + post_frames > max_frames) {
+        const double scale = max_frames / (pre_frames + post_frames);
+        pre_frames *= scale;
+        post_frames = std::max(1.0, post_frames * scale);
+        std::cout << "Burst window reduced to fit burst_max_mb = " << cam_settings.burst_max_mb << std::endl;
+    }
+
+    std::filesystem::path path = recording_output_directory() /
+        ("burst_" + ImageManager::generate_timestamp() + ".rtbf");
+    app_state->burst_capture(0).arm(size, static_cast<int>(pre_frames), static_cast<int>(post_frames),
+                                    path.string());
+}
+
+/**
+ * Register the large buffers with the memory budget (once, after AppState exists)
+ *
+ * Capture caches go first when over budget, then idle burst rings and the
+ * scrub-back history; frame pools and the flight recorder ring are counted
+ * but never shrunk.
+ */
+void register_memory_consumers() {
+    auto& budget = core::MemoryBudget::instance();
+    using Tier = core::MemoryBudget::Tier;
+    budget.register_consumer("image_cache", Tier::Cache,
+                             [] { return ImageCache::instance().bytes(); },
+                             [](size_t bytes) { return ImageCache::instance().shrink(bytes); });
+    budget.register_consumer("reference_cache", Tier::Cache,
+                             [] { return ImageManager::binary_cache_bytes(); },
+                             [](size_t bytes) { return ImageManager::trim_binary_cache(bytes); });
+    budget.register_consumer("burst_rings", Tier::History,
+                             [] {
+                                 size_t total = 0;
+                                 for (int i = 0; i < core::AppState::MAX_CAMERAS; ++i) {
+                                     total += app_state->burst_capture(i).get_ring_bytes();
+                                 }
+                                 return total;
+                             },
+                             [](size_t bytes) {
+                                 size_t freed = 0;
+                                 for (int i = 0; i < core::AppState::MAX_CAMERAS && freed < bytes; ++i) {
+                                     freed += app_state->burst_capture(i).release_ring();
+                                 }
+                                 return freed;
+                             });
+    budget.register_consumer("frame_history", Tier::History,
+                             [] {
+                                 size_t total = 0;
+                                 for (int i = 0; i < core::AppState::MAX_CAMERAS; ++i) {
+                                     total += app_state->frame_history(i).get_arena_bytes();
+                                 }
+                                 return total;
+                             },
+                             [](size_t bytes) {
+                                 size_t freed = 0;
+                                 for (int i = 0; i < core::AppState::MAX_CAMERAS && freed < bytes; ++i) {
+                                     freed += app_state->frame_history(i).release();
+                                 }
+                                 return freed;
+                             });
+    budget.register_consumer("frame_pools", Tier::Critical, [] {
+        size_t total = 0;
+        for (int i = 0; i < core::AppState::MAX_CAMERAS; ++i) {
+            total += app_state->frame_pool(i).get_bytes();
+        }
+        return total;
+    });
+    budget.register_consumer("flight_recorder", Tier::Critical, [] {
+        return core::FlightRecorder::instance().is_running() ? core::FlightRecorder::instance().get_ring_bytes() : 0;
+    });
+}
+
+/**
+ * Once a second, publish slow-changing station state as gauges (UI thread)
+ *
+ * Sensor temperature is not read here: the monitoring thread publishes it
+ * (CameraManager::start_monitoring), so the UI never waits on USB.
+ */
+/**
+ * Live GL textures, buffers and framebuffers (soak growth check; needs a current context)
+ *
+ * Names are small integers handed out lowest-free-first and reused once
+ * deleted, so probing a fixed range finds every live object and a leak shows
+ * as a count that keeps growing. A few thousand glIs* calls, once a minute.
+ */
+int64_t count_gl_objects() {
+    constexpr GLuint MAX_NAME = 4096;
+    int64_t live = 0;
+    for (GLuint name = 1; name <= MAX_NAME; ++name) {
+        live += glIsTexture(name) == GL_TRUE;
+        live += glIsBuffer(name) == GL_TRUE;
+        live += glIsFramebuffer(name) == GL_TRUE;
+    }
+    return live;
+}
+
+/**
+ * Print the soak result and close its CSV
+ * @return Process exit code: 2 if a growth limit was exceeded, else 0
+ */
+int finish_soak() {
+    if (!soak_monitor.is_running()) {
+        return 0;
+    }
+    const core::SoakMonitor::Summary summary = soak_monitor.get_summary();
+    soak_monitor.stop();
+    std::cout << "Soak: " << summary.samples << " samples";
+    if (summary.baseline) {
+        std::cout << ", RSS " << std::showpos << summary.rss_growth_mb << " MB (" << summary.rss_slope_mb_per_h
+                  << " MB/h), private " << summary.private_growth_mb << " MB, handles " << summary.handle_growth
+                  << ", GL objects " << summary.gl_growth << std::noshowpos;
+    } else {
+        std::cout << ", ended before the baseline (soak_warmup_s)";
+    }
+    std::cout << ": " << (soak_monitor.is_failed() ? "FAILED, " + soak_monitor.get_failure() : "PASSED") << std::endl;
+    return soak_monitor.is_failed() ? 2 : 0;
+}
+
+/**
+ * Gather the run report's inputs while the cameras are still up (owner thread)
+ *
+ * Only copies: the flagged pixels, line defects and file paths. The
+ * analyzer snapshots are taken by start_run_report.
+ */
+RunReport::Inputs gather_run_report() {
+    const auto& config = AppConfig::instance();
+    auto& cam_mgr = CameraManager::instance();
+    const std::string stem = std::filesystem::path(run_archive_stem).filename().string();
+    const double duration_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_started).count();
+
+    RunReport::Inputs inputs;
+    inputs.title = "Reliability run " + stem;
+    inputs.directory = run_archive_stem + "_report";
+    inputs.run_log = run_archive_stem + ".runlog";
+    inputs.summary = {
+        {"Run", stem},
+        {"Duration", std::to_string(static_cast<int64_t>(duration_s / 60)) + " min " +
+                         std::to_string(static_cast<int64_t>(duration_s) % 60) + " s"},
+        {"Source", config.runtime_settings().replay_file.empty() ? "Camera" : config.runtime_settings().replay_file},
+    };
+    inputs.files = {inputs.run_log, run_archive_stem + "_soak.csv"};
+
+    const int camera_count = std::min(cam_mgr.num_pipelines(), core::AppState::MAX_CAMERAS);
+    for (int i = 0; i < camera_count; ++i) {
+        RunReport::Camera camera;
+        camera.index = i;
+        if (i < cam_mgr.num_cameras()) {
+            camera.serial = cam_mgr.get_camera(i).serial;
+        }
+        camera.summary = {
+            {"Frames generated", std::to_string(frames_generated[i].load())},
+            {"Events", std::to_string(cam_mgr.get_event_count(i))},
+            {"Events dropped", std::to_string(cam_mgr.get_dropped_events(i))},
+        };
+        if (cam_mgr.pixel_rates(i).is_enabled()) {
+            cam_mgr.pixel_rates(i).get_flagged(camera.flagged);
+        }
+        if (cam_mgr.line_defects(i).is_enabled()) {
+            cam_mgr.line_defects(i).get_defects(camera.defects);
+        }
+        camera.toggles_enabled = cam_mgr.pixel_toggles(i).is_enabled();
+        if (camera.toggles_enabled) {
+            camera.toggles = cam_mgr.pixel_toggles(i).get_classes();
+        }
+        const auto& scattering = app_state->scattering_worker(i);
+        camera.heatmap_timeline = scattering.get_timeline_path();
+        camera.checkpoint = scattering.get_checkpoint_path();
+        inputs.files.push_back(camera.heatmap_timeline);
+        inputs.cameras.push_back(std::move(camera));
+    }
+    return inputs;
+}
+
+/**
+ * Take the latest analyzer snapshots and write the report on its own thread
+ */
+void start_run_report(RunReport::Inputs inputs) {
+    for (RunReport::Camera& camera : inputs.cameras) {
+        camera.scattering = app_state->scattering_worker(camera.index).get_snapshot();
+    }
+    const std::string directory = inputs.directory;
+    if (run_report.start(std::move(inputs))) {
+        std::cout << "Run report: writing " << directory << std::endl;
+    }
+}
+
+void sample_station_metrics() {
+    using Clock = std::chrono::steady_clock;
+    static Clock::time_point last_sample = Clock::now();
+    static int64_t last_events = 0;
+
+    const Clock::time_point now = Clock::now();
+    const double elapsed = std::chrono::duration<double>(now - last_sample).count();
+    if (elapsed < 1.0) {
+        return;
+    }
+    last_sample = now;
+
+    auto& registry = core::MetricsRegistry::instance();
+    static core::Counter& events = registry.counter("events.ingested");
+    static core::Gauge& event_rate = registry.gauge("events.rate_per_s");
+    static core::Gauge& clock_drift = registry.gauge("camera.clock_drift_ppm");
+    static core::Gauge& flagged_pixels = registry.gauge("pixels.flagged");
+    static core::Gauge& flagged_lines = registry.gauge("lines.flagged");
+    static core::Gauge& stuck_pixels = registry.gauge("pixels.stuck");
+    static core::Gauge& flickering_pixels = registry.gauge("pixels.flickering");
+    static core::Gauge& hw_masked_pixels = registry.gauge("pixels.hw_masked");
+    static core::Gauge& sw_masked_pixels = registry.gauge("pixels.sw_masked");
+
+    const int64_t total = events.value();
+    event_rate.set((total - last_events) / elapsed);
+    last_events = total;
+
+    // The GL census only where a context is current (the windowed loop)
+    if (soak_monitor.is_due()) {
+        soak_monitor.poll(glfwGetCurrentContext() ? count_gl_objects() : -1);
+    }
+
+    auto& cam_mgr = CameraManager::instance();
+    if (cam_mgr.clock_sync().is_valid()) {
+        clock_drift.set(cam_mgr.clock_sync().get_drift_ppm());
+    }
+    if (cam_mgr.num_pipelines() > 0 && cam_mgr.pixel_rates().is_enabled()) {
+        int flagged = 0;
+        for (int i = 0; i < cam_mgr.num_pipelines(); ++i) {
+            flagged += cam_mgr.pixel_rates(i).get_flagged_count();
+        }
+        flagged_pixels.set(flagged);
+    }
+    if (cam_mgr.num_pipelines() > 0 && AppConfig::instance().camera_settings().hot_pixel_suppress) {
+        int hardware = 0;
+        int software = 0;
+        for (int i = 0; i < cam_mgr.num_pipelines() && i < core::AppState::MAX_CAMERAS; ++i) {
+            hardware += hardware_masked_pixels[i].load(std::memory_order_relaxed);
+            software += cam_mgr.pixel_mask(i).get_masked_pixels();
+        }
+        hw_masked_pixels.set(hardware);
+        sw_masked_pixels.set(software);
+    }
+    if (cam_mgr.num_pipelines() > 0 && cam_mgr.line_defects().is_enabled()) {
+        int flagged = 0;
+        for (int i = 0; i < cam_mgr.num_pipelines(); ++i) {
+            flagged += cam_mgr.line_defects(i).get_defect_count();
+        }
+        flagged_lines.set(flagged);
+    }
+    if (cam_mgr.num_pipelines() > 0 && cam_mgr.pixel_toggles().is_enabled()) {
+        int64_t stuck = 0;
+        int64_t flickering = 0;
+        for (int i = 0; i < cam_mgr.num_pipelines(); ++i) {
+            const video::ToggleClasses classes = cam_mgr.pixel_toggles(i).get_classes();
+            stuck += classes.stuck;
+            flickering += classes.flickering;
+        }
+        stuck_pixels.set(static_cast<double>(stuck));
+        flickering_pixels.set(static_cast<double>(flickering));
+    }
+    if (stage_graph.is_running()) {
+        stage_graph.sample();
+    }
+    if (core::QosScheduler::instance().is_enabled()) {
+        static core::Gauge& qos_level = registry.gauge("qos.level");
+        qos_level.set(static_cast<double>(core::QosScheduler::instance().get_level()));
+    }
+    core::MemoryBudget::instance().rebalance();
+}
+
+/**
+ * Send one station report per camera to the fleet aggregator (fleet_report)
+ *
+ * Once a second: the camera's event rate, latest scattering figures and
+ * worst hot pixels from its scattering worker, and its sensor temperature.
+ */
+void report_fleet_metrics() {
+    using Clock = std::chrono::steady_clock;
+    static Clock::time_point last_report = Clock::now();
+    static std::vector<uint64_t> last_events;
+
+    if (!fleet_reporter.is_running() || !app_state) {
+        return;
+    }
+    const Clock::time_point now = Clock::now();
+    const double elapsed = std::chrono::duration<double>(now - last_report).count();
+    if (elapsed < 1.0) {
+        return;
+    }
+    last_report = now;
+
+    auto& cam_mgr = CameraManager::instance();
+    const int camera_count = std::min(cam_mgr.num_pipelines(), core::AppState::MAX_CAMERAS);
+    last_events.resize(static_cast<size_t>(camera_count), 0);
+    for (int i = 0; i < camera_count; ++i) {
+        core::fleet::Report report{};
+        if (i < cam_mgr.num_cameras()) {
+            core::fleet::set_id(report.header.sensor, cam_mgr.get_camera(i).serial);
+        }
+        report.header.camera_index = i;
+
+        const uint64_t events = cam_mgr.get_event_count(i);
+        report.header.event_rate = static_cast<float>((events - last_events[i]) / elapsed);
+        last_events[i] = events;
+
+        const float temperature = cam_mgr.get_monitoring(i).temperature_c;
+        if (!std::isnan(temperature)) {
+            report.header.temperature_c = temperature;
+            report.header.flags |= core::fleet::HAS_TEMPERATURE;
+        }
+
+        if (auto snapshot = app_state->scattering_worker(i).get_snapshot()) {
+            report.header.scattering_percent = snapshot->current_scattering_percentage;
+            report.header.scattering_per_frame = snapshot->average_scattering_per_frame;
+            report.header.frames_analyzed = snapshot->frames_analyzed;
+            report.header.flags |= core::fleet::HAS_SCATTERING;
+
+            const size_t hot = std::min<size_t>(snapshot->hot_pixels.size(), core::fleet::MAX_HOT_PIXELS);
+            for (size_t k = 0; k < hot; ++k) {
+                const auto& pixel = snapshot->hot_pixels[k];
+                report.hot_pixels[k] = {static_cast<uint16_t>(pixel.location.x),
+                                        static_cast<uint16_t>(pixel.location.y), pixel.count};
+            }
+            report.header.hot_pixel_count = static_cast<uint16_t>(hot);
+        }
+        fleet_reporter.send(report);
+    }
+}
+
+/**
+ * Program the anti-flicker band from the measured flicker frequency (antiflicker_auto)
+ *
+ * Estimates once per completed span of camera 0's event rate. A strong line
+ * in the sensor's supported range outside the band already programmed (and
+ * not a harmonic of it, which survives a band stop on the fundamental)
+ * becomes a band stop of +/- antiflicker_auto_margin_hz on every camera.
+ */
+void update_antiflicker_auto() {
+    const auto& cam_settings = AppConfig::instance().camera_settings();
+    auto& cam_mgr = CameraManager::instance();
+    if (!cam_settings.antiflicker_auto || cam_mgr.num_pipelines() == 0) {
+        return;
+    }
+
+    // Band programmed so far (0 = none); the filter keeps it once flicker is gone from the stream
+    static double band_center_hz = 0.0;
+    static uint32_t band_low_hz = 0;
+    static uint32_t band_high_hz = 0;
+
+    video::FlickerEstimate estimate;
+    if (!cam_mgr.flicker(0).estimate(20.0, 1900.0, estimate)) {
+        return;  // No new span yet
+    }
+    static core::Gauge& frequency = core::MetricsRegistry::instance().gauge("flicker.frequency_hz");
+    static core::Gauge& strength = core::MetricsRegistry::instance().gauge("flicker.strength");
+    frequency.set(estimate.frequency_hz);
+    strength.set(estimate.strength);
+    if (estimate.strength < video::FlickerEstimator::STRONG_PEAK) {
+        return;
+    }
+
+    const double f = estimate.frequency_hz;
+    if (band_center_hz > 0.0) {
+        const double harmonic = std::round(f / band_center_hz);
+        const bool in_band = f >= band_low_hz && f <= band_high_hz;
+        const bool is_harmonic = harmonic >= 2.0 &&
+                                 std::abs(f - harmonic * band_center_hz) <= cam_settings.antiflicker_auto_margin_hz;
+        if (in_band || is_harmonic) {
+            return;
+        }
+    }
+
+    // Only now touch the devices: a new line was found
+    const int margin = std::max(cam_settings.antiflicker_auto_margin_hz, 1);
+    const uint32_t band_low = static_cast<uint32_t>(std::max(0.0, std::floor(f - margin)));
+    const uint32_t band_high = static_cast<uint32_t>(std::ceil(f + margin));
+
+    // Remembered even when nothing could be programmed, so the same line is reported once
+    band_center_hz = f;
+    band_low_hz = band_low;
+    band_high_hz = band_high;
+
+    // Register writes run on the camera-control thread, not in the render loop
+    const double peak_strength = estimate.strength;
+    EventCamera::ControlQueue::instance().post("antiflicker.auto", [f, band_low, band_high, peak_strength] {
+        auto& cam_mgr = CameraManager::instance();
+        uint32_t low = band_low;
+        uint32_t high = band_high;
+        int programmed = 0;
+        int available = 0;
+        for (int i = 0; i < cam_mgr.num_cameras(); ++i) {
+            if (!cam_mgr.is_camera_connected(i)) {
+                continue;
+            }
+            auto* module = cam_mgr.get_camera(i).camera->get_device().get_facility<Metavision::I_AntiFlickerModule>();
+            if (!module) {
+                continue;
+            }
+            ++available;
+            try {
+                const uint32_t min_hz = module->get_min_supported_frequency();
+                const uint32_t max_hz = module->get_max_supported_frequency();
+                if (f < min_hz || f > max_hz) {
+                    continue;  // The filter cannot reach this line
+                }
+                low = std::max(low, min_hz);
+                high = std::min(high, max_hz);
+                module->set_filtering_mode(Metavision::I_AntiFlickerModule::BAND_STOP);
+                if (module->set_frequency_band(low, high) && module->enable(true)) {
+                    ++programmed;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Flicker: failed to program anti-flicker band: " << e.what() << std::endl;
+            }
+        }
+
+        if (available == 0) {
+            core::LogLine(core::LogLevel::Info) << "Flicker: " << f << " Hz (strength " << peak_strength
+                                                << "), no anti-flicker filter to program";
+            return;
+        }
+        core::LogLine(core::LogLevel::Info) << "Flicker: " << f << " Hz (strength " << peak_strength
+                                            << "), anti-flicker band stop " << low << "-" << high << " Hz on "
+                                            << programmed << " camera(s)";
+    });
+}
+
+/**
+ * Stamp a capture with when its frame happened rather than when it is saved,
+ * and with the window it actually covered
+ * @param timing Latency trace of the captured frame (sensor time, host mapping, window and events)
+ */
+void stamp_capture_time(ImageManager::ImageMetadata& metadata, const video::FrameTiming& timing) {
+    metadata.sensor_timestamp_us = timing.camera_ts;
+    if (timing.window_us > 0) {
+        metadata.accumulation_time_us = static_cast<int>(timing.window_us);  // Span actually covered, not the setting
+    }
+    metadata.frame_events = timing.events;
+    metadata.frame_on_events = timing.on_events;
+    if (timing.event_width > 0) {
+        metadata.event_bbox_x = timing.event_x;
+        metadata.event_bbox_y = timing.event_y;
+        metadata.event_bbox_width = timing.event_width;
+        metadata.event_bbox_height = timing.event_height;
+    }
+    if (timing.camera_host_us > 0) {
+        const int64_t age_us = core::LatencyStats::now_us() - timing.camera_host_us;
+        metadata.frame_unix_timestamp_ms = ImageManager::get_unix_timestamp_ms() - age_us / 1000;
+    }
+}
+
+/**
+ * Write latency percentiles and histograms next to the recordings
+ */
+void dump_latency_csv() {
+    const std::filesystem::path base = recording_output_directory() /
+        ("latency_" + ImageManager::generate_timestamp());
+    const auto& latency = app_state->latency_stats();
+    const std::string summary_path = base.string() + ".csv";
+    const std::string histogram_path = base.string() + "_histogram.csv";
+
+    if (latency.export_csv(summary_path) && latency.export_histogram_csv(histogram_path)) {
+        std::cout << "Latency written to " << summary_path << std::endl;
+    } else {
+        std::cerr << "Failed to write latency CSV to " << base.parent_path() << std::endl;
+    }
+}
+
+// ============================================================================
+// UI Rendering
+// ============================================================================
+
+#if RTCAM_ALLOC_TRACKING
+/**
+ * Render per-call allocations of each ALLOC_SCOPE stage (alloc.<stage>_count / _bytes)
+ */
+void render_allocation_section() {
+    if (!ImGui::CollapsingHeader("Allocations")) {
+        return;
+    }
+
+    const auto snapshot = core::MetricsRegistry::instance().snapshot();
+    if (ImGui::BeginTable("allocations", 4, ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Stage");
+        ImGui::TableSetupColumn("allocs/call");
+        ImGui::TableSetupColumn("bytes/call");
+        ImGui::TableSetupColumn("max");
+        ImGui::TableHeadersRow();
+
+        // Histograms are sorted by name, so each stage's _bytes directly precedes its _count
+        const std::string prefix = "alloc.";
+        const std::string bytes_suffix = "_bytes";
+        const auto& histograms = snapshot.histograms;
+        for (size_t i = 0; i + 1 < histograms.size(); ++i) {
+            const std::string& name = histograms[i].first;
+            if (name.compare(0, prefix.size(), prefix) != 0 || name.size() <= prefix.size() + bytes_suffix.size() ||
+                name.compare(name.size() - bytes_suffix.size(), bytes_suffix.size(), bytes_suffix) != 0) {
+                continue;
+            }
+            const std::string stage = name.substr(prefix.size(), name.size() - prefix.size() - bytes_suffix.size());
+            if (histograms[i + 1].first != prefix + stage + "_count") {
+                continue;
+            }
+            const auto& bytes = histograms[i].second;
+            const auto& count = histograms[i + 1].second;
+            if (count.count == 0) {
+                continue;
+            }
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(stage.c_str());
+            ImGui::TableNextColumn();
+            // Anything above zero on a hot-path stage is a regression
+            const ImVec4 colour = count.sum > 0 ? ImVec4(1.0f, 0.6f, 0.3f, 1.0f) : ImVec4(0.5f, 1.0f, 0.5f, 1.0f);
+            ImGui::TextColored(colour, "%.2f", count.mean());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", bytes.mean());
+            ImGui::TableNextColumn();
+            ImGui::Text("%lld", static_cast<long long>(count.max));
+        }
+        ImGui::EndTable();
+    }
+    ImGui::TextDisabled("Process total: %llu allocations",
+                        static_cast<unsigned long long>(core::AllocTracker::process_counts().count));
+}
+#endif
+
+/**
+ * Render every registered counter and histogram (MetricsRegistry snapshot)
+ */
+void render_metrics_section() {
+    if (!ImGui::CollapsingHeader("Metrics")) {
+        return;
+    }
+
+    auto& registry = core::MetricsRegistry::instance();
+    const auto snapshot = registry.snapshot();
+
+    for (const auto& [name, value] : snapshot.counters) {
+        ImGui::Text("%s", name.c_str());
+        ImGui::SameLine(170);
+        ImGui::Text("%lld", static_cast<long long>(value));
+    }
+    for (const auto& [name, h] : snapshot.histograms) {
+        if (h.count == 0) {
+            continue;
+        }
+        ImGui::Text("%s", name.c_str());
+        ImGui::SameLine(170);
+        ImGui::Text("p50 %lld  p99 %lld", static_cast<long long>(h.percentile(0.50)),
+                    static_cast<long long>(h.percentile(0.99)));
+    }
+
+    if (ImGui::Button("Reset##metrics", ImVec2(80, 0))) {
+        registry.reset();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Dump CSV##metrics", ImVec2(-1, 0))) {
+        const std::filesystem::path path = recording_output_directory() /
+            ("metrics_" + ImageManager::generate_timestamp() + ".csv");
+        if (registry.export_csv(path.string())) {
+            std::cout << "Metrics written to " << path << std::endl;
+        } else {
+            std::cerr << "Failed to write " << path << std::endl;
+        }
+    }
+}
+
+/**
+ * Render long-run trends of event rate, scattering and sensor temperature
+ */
+void render_trends_section() {
+    if (!trend_store.is_running() || !ImGui::CollapsingHeader("Trends")) {
+        return;
+    }
+
+    static int tier = 0;
+    const char* tier_labels[core::TrendSeries::TIER_COUNT];
+    for (int i = 0; i < core::TrendSeries::TIER_COUNT; ++i) {
+        tier_labels[i] = core::TrendSeries::TIERS[i].label;
+    }
+    ImGui::Combo("Range##trends", &tier, tier_labels, core::TrendSeries::TIER_COUNT);
+
+    struct SeriesView {
+        const char* label;
+        double scale;          // Display unit per stored unit
+        const char* unit;
+        std::vector<core::TrendBucket> buckets;
+        std::vector<float> means;
+        uint64_t published = UINT64_MAX;
+        int tier = -1;
+    };
+    static SeriesView views[core::TrendStore::SERIES_COUNT] = {
+        {"Event rate", 1e-3, "kev/s"},
+        {"Scattering", 1.0, "%"},
+        {"Temperature", 1.0, "°C"},
+    };
+
+    for (int i = 0; i < core::TrendStore::SERIES_COUNT; ++i) {
+        const auto& series = trend_store.series(static_cast<core::TrendStore::Series>(i));
+        SeriesView& view = views[i];
+
+        // Re-read only when a bucket closed (once a second at most)
+        const uint64_t published = series.published(tier);
+        if (published != view.published || tier != view.tier) {
+            view.published = published;
+            view.tier = tier;
+            series.read(tier, view.buckets);
+
+            // Nothing before the first sample; later gaps plot as 0
+            auto first = std::find_if(view.buckets.begin(), view.buckets.end(),
+                                      [](const core::TrendBucket& b) { return b.count > 0; });
+            view.buckets.erase(view.buckets.begin(), first);
+            view.means.resize(view.buckets.size());
+            for (size_t j = 0; j < view.buckets.size(); ++j) {
+                view.means[j] = static_cast<float>(view.buckets[j].mean * view.scale);
+            }
+        }
+
+        if (view.buckets.empty()) {
+            ImGui::TextDisabled("%s: no data yet", view.label);
+            continue;
+        }
+
+        float lo = FLT_MAX;
+        float hi = -FLT_MAX;
+        for (const auto& bucket : view.buckets) {
+            if (bucket.count > 0) {
+                lo = std::min(lo, bucket.min);
+                hi = std::max(hi, bucket.max);
+            }
+        }
+        char overlay[128];
+        snprintf(overlay, sizeof(overlay), "%s %.2f %s (min %.2f, max %.2f)", view.label,
+                 view.means.back(), view.unit, lo * view.scale, hi * view.scale);
+        ImGui::PlotLines(("##trend" + std::to_string(i)).c_str(), view.means.data(),
+                         static_cast<int>(view.means.size()), 0, overlay, 0.0f, FLT_MAX, ImVec2(-1, 60));
+    }
+
+    if (!trend_store.get_history_path().empty()) {
+        ImGui::TextDisabled("Saved to %s", trend_store.get_history_path().c_str());
+    }
+}
+
+/**
+ * Render end-to-end latency percentiles (camera timestamp to swap)
+ */
+void render_latency_section() {
+    if (!app_state || !ImGui::CollapsingHeader("Latency")) {
+        return;
+    }
+
+    auto& latency = app_state->latency_stats();
+    ImGui::Text("%llu frames", static_cast<unsigned long long>(latency.get_frames()));
+    if (ui_scheduler.get_predicted_work_us() > 0) {
+        ImGui::Text("Low-latency present: starts %.1f ms ahead, %llu late-latched",
+                    ui_scheduler.get_predicted_work_us() / 1000.0,
+                    static_cast<unsigned long long>(frames_late_latched_metric.value()));
+    }
+
+    if (ImGui::BeginTable("latency", 4, ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Stage (ms)");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableHeadersRow();
+        for (int i = 0; i < core::LatencyStats::STAGE_COUNT; ++i) {
+            const auto stage = static_cast<core::LatencyStats::Stage>(i);
+            const auto summary = latency.summary(stage);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(core::LatencyStats::stage_name(stage));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", summary.p50_us / 1000.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", summary.p95_us / 1000.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", summary.p99_us / 1000.0);
+        }
+        ImGui::EndTable();
+    }
+
+    // Log-spaced buckets of the full event-to-swap latency
+    static std::vector<float> buckets;
+    int64_t low_us = 0;
+    int64_t high_us = 0;
+    latency.get_histogram(core::LatencyStats::Stage::Total, buckets, low_us, high_us);
+    if (!buckets.empty()) {
+        char label[64];
+        snprintf(label, sizeof(label), "%.2f - %.2f ms", low_us / 1000.0, high_us / 1000.0);
+        ImGui::PlotHistogram("##latency_hist", buckets.data(), static_cast<int>(buckets.size()),
+                             0, label, 0.0f, FLT_MAX, ImVec2(-1, 60));
+    }
+
+    if (ImGui::Button("Reset", ImVec2(80, 0))) {
+        latency.reset();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Dump CSV", ImVec2(-1, 0))) {
+        dump_latency_csv();
+    }
+}
+
+/**
+ * Render percentiles of the newest frames from the camera's frame log (no camera thread involved)
+ */
+void render_frame_log_section() {
+    if (!app_state || !ImGui::CollapsingHeader("Recent Frames")) {
+        return;
+    }
+
+    static int camera = 0;
+    static int frames = 1000;
+    const int cameras = std::min(CameraManager::instance().num_pipelines(), static_cast<int>(core::AppState::MAX_CAMERAS));
+    if (cameras > 1) {
+        ImGui::SetNextItemWidth(80);
+        ImGui::Combo("##frame_log_camera", &camera, "Camera 0\0Camera 1\0");
+        ImGui::SameLine();
+    }
+    camera = std::min(camera, std::max(cameras - 1, 0));
+    const core::FrameLog& log = app_state->frame_log(camera);
+    ImGui::SetNextItemWidth(-1);
+    ImGui::SliderInt("##frame_log_frames", &frames, 10, static_cast<int>(log.capacity()), "Last %d frames",
+                     ImGuiSliderFlags_Logarithmic);
+
+    static core::FrameLog::Snapshot recent;
+    static std::vector<int32_t> scratch;
+    if (log.read(recent, static_cast<size_t>(frames)) < 2) {
+        ImGui::TextDisabled("No frames yet");
+        return;
+    }
+    const int64_t span_us = recent.host_us.back() - recent.host_us.front();
+    if (span_us > 0) {
+        ImGui::Text("%zu frames over %.2f s (%.1f fps)", recent.size(), span_us / 1e6,
+                    (recent.size() - 1) * 1e6 / span_us);
+    }
+
+    struct Row {
+        core::FrameLog::Column column;
+        const char* label;
+        double scale;
+        const char* format;
+    };
+    static const Row rows[] = {
+        {core::FrameLog::Events, "Events", 1.0, "%.0f"},
+        {core::FrameLog::OnEvents, "ON", 1.0, "%.0f"},
+        {core::FrameLog::OffEvents, "OFF", 1.0, "%.0f"},
+        {core::FrameLog::ActivePixels, "Active px", 1.0, "%.0f"},
+        {core::FrameLog::ScatteringPixels, "Scattering px", 1.0, "%.0f"},
+        {core::FrameLog::WindowUs, "Window (ms)", 1e-3, "%.2f"},
+        {core::FrameLog::LatencyUs, "Latency (ms)", 1e-3, "%.2f"},
+    };
+    if (ImGui::BeginTable("frame_log", 4, ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Per frame");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("max");
+        ImGui::TableHeadersRow();
+        for (const Row& row : rows) {
+            const auto summary = core::FrameLog::summarize(recent.column(row.column), scratch);
+            if (summary.count == 0) {
+                continue;   // Not counted on this path
+            }
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(row.label);
+            ImGui::TableNextColumn();
+            ImGui::Text(row.format, summary.p50 * row.scale);
+            ImGui::TableNextColumn();
+            ImGui::Text(row.format, summary.p99 * row.scale);
+            ImGui::TableNextColumn();
+            ImGui::Text(row.format, summary.max * row.scale);
+        }
+        ImGui::EndTable();
+    }
+
+    // Events per frame, read in place from the snapshot column
+    const std::vector<int32_t>& events = recent.column(core::FrameLog::Events);
+    ImGui::PlotLines("##frame_log_events",
+                     [](void* data, int i) {
+                         return static_cast<float>(std::max(static_cast<const int32_t*>(data)[i], 0));
+                     },
+                     const_cast<int32_t*>(events.data()), static_cast<int>(events.size()), 0, "events / frame",
+                     0.0f, FLT_MAX, ImVec2(-1, 60));
+}
+
+/**
+ * Render simple status panel
+ */
+void render_status_panel() {
+    PROFILE_ZONE("render_status_panel");
+    ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(280, 120), ImGuiCond_FirstUseEver);
+
+    ImGui::Begin("Status");
+
+    // Help button
+    if (ImGui::Button("Help [F1]", ImVec2(-1, 25))) {
+        show_help_window = !show_help_window;
+    }
+    if (ImGui::Button("Capture Gallery [F3]", ImVec2(-1, 25))) {
+        show_gallery = !show_gallery;
+    }
+    if (ImGui::Button("Heatmap Timeline [F4]", ImVec2(-1, 25))) {
+        show_heatmap_timeline = !show_heatmap_timeline;
+    }
+
+    // Report of the run so far; written on its own thread, the UI keeps running
+    if (!run_archive_stem.empty()) {
+        if (run_report.is_busy()) {
+            ImGui::TextDisabled("Writing run report...");
+        } else {
+            if (ImGui::Button("Write Run Report", ImVec2(-1, 25))) {
+                start_run_report(gather_run_report());
+            }
+            const std::string last = run_report.get_last_report();
+            if (!last.empty() && ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Last: %s", last.c_str());
+            }
+        }
+    }
+
+    ImGui::Separator();
+
+    // Camera status
+    ImGui::Text("Camera:");
+    ImGui::SameLine(100);
+    auto& cam_mgr = CameraManager::instance();
+    if (cam_mgr.is_camera_connected(0)) {
+        ImGui::TextColored(ImVec4(0, 1, 0, 1), "Connected");
+    } else if (cam_mgr.is_reconnecting(0)) {
+        ImGui::TextColored(ImVec4(1, 0.6f, 0, 1), "Reconnecting...");
+    } else if (const auto* replay = cam_mgr.replay()) {
+        ImGui::TextColored(ImVec4(0, 0.8f, 1, 1), replay->is_finished() ? "Replay (done)" : "Replay");
+        ImGui::Text("Position:");
+        ImGui::SameLine(100);
+        ImGui::Text("%.2f s, %.1f Mev/s", replay->get_position_us() / 1e6,
+                    replay->get_events_per_second() / 1e6);
+    } else {
+        ImGui::TextColored(ImVec4(1, 0, 0, 1), "Disconnected");
+    }
+
+    // Synchronized windows across cameras (see apply_stream_merge)
+    const video::StreamMerger& merger = cam_mgr.merger();
+    if (merger.is_running()) {
+        ImGui::Text("Sync:");
+        ImGui::SameLine(100);
+        ImGui::Text("%lld windows, skew %.2f ms", static_cast<long long>(merger.get_windows()),
+                    merger.get_skew_us() / 1000.0);
+        ImGui::Text("Cam 0 | 1:");
+        ImGui::SameLine(100);
+        ImGui::Text("%lld | %lld px, %lld both", static_cast<long long>(merge_active[0].load()),
+                    static_cast<long long>(merge_active[1].load()), static_cast<long long>(merge_coincident.load()));
+        ImGui::SetItemTooltip("Pixels of the last synchronized window; agreement (both / either) %.1f %%",
+                              merge_agreement.load() * 100.0);
+        if (merger.get_dropped_events() > 0 || merger.get_late_events() > 0) {
+            ImGui::TextColored(ImVec4(1, 0.6f, 0, 1), "%lld events dropped, %lld late (a camera lags)",
+                               static_cast<long long>(merger.get_dropped_events()),
+                               static_cast<long long>(merger.get_late_events()));
+        }
+    }
+
+    // Binary bit and accumulation configuration, applied live at the next window
+    ImGui::Text("Binary Bits:");
+    ImGui::SameLine(100);
+    if (app_state) {
+        int bits[2] = {static_cast<int>(app_state->display_settings().get_binary_stream_mode()),
+                       static_cast<int>(app_state->display_settings().get_binary_stream_mode_2())};
+        int accumulation_us = AppConfig::instance().camera_settings().accumulation_time_us;
+        ImGui::SetNextItemWidth(100);
+        const bool bits_changed = ImGui::InputInt2("##binary_bits", bits);
+        ImGui::Text("Window:");
+        ImGui::SameLine(100);
+        ImGui::SetNextItemWidth(130);
+        const bool window_changed = ImGui::InputInt("μs##accumulation", &accumulation_us, 100, 1000,
+                                                    ImGuiInputTextFlags_EnterReturnsTrue);
+        if (bits_changed || window_changed) {
+            apply_frame_parameters(accumulation_us, bits[0], bits[1]);
+        }
+
+        // Time surface: per-pixel recency instead of the binary window (display only)
+        if (!gpu_pipeline_active && !shader_display_active) {
+            auto& display = app_state->display_settings();
+            bool time_surface = display.get_display_mode() == core::DisplaySettings::DisplayMode::TIME_SURFACE;
+            if (ImGui::Checkbox("Time surface", &time_surface)) {
+                display.set_display_mode(time_surface ? core::DisplaySettings::DisplayMode::TIME_SURFACE
+                                                      : core::DisplaySettings::DisplayMode::OR_BEFORE_PROCESSING);
+                AppConfig::instance().camera_settings().time_surface_display = time_surface;
+            }
+            if (time_surface) {
+                float decay_ms = display.get_time_surface_decay_us() / 1000.0f;
+                if (ImGui::SliderFloat("Decay", &decay_ms, 0.1f, 1000.0f, "%.1f ms", ImGuiSliderFlags_Logarithmic)) {
+                    display.set_time_surface_decay_us(static_cast<int>(decay_ms * 1000.0f));
+                    AppConfig::instance().camera_settings().time_surface_decay_us = display.get_time_surface_decay_us();
+                }
+                ImGui::SetItemTooltip("Time for a pixel to fade to 1/e brightness after its last event");
+            }
+        }
+    }
+
+    // GPU pipeline statistics (read back asynchronously, a frame or two late)
+    if (gpu_pipeline_active && gpu_pipeline) {
+        auto stats = gpu_pipeline->get_stats();
+        ImGui::Text("GPU:");
+        ImGui::SameLine(100);
+        ImGui::Text("%u active px", stats.active_pixels);
+        if (gpu_pipeline->has_reference()) {
+            ImGui::Text("Scattering:");
+            ImGui::SameLine(100);
+            ImGui::Text("%u px, max %u", stats.scattering_pixels, stats.max_scattering_count);
+        }
+        const char* view_items[] = {"Binary", "Scattering", "Heatmap"};
+        ImGui::Text("View:");
+        ImGui::SameLine(100);
+        ImGui::SetNextItemWidth(130);
+        ImGui::Combo("##gpu_view", &gpu_view_mode, view_items, IM_ARRAYSIZE(view_items));
+        if (ImGui::Button("Set GPU reference")) {
+            gpu_pipeline->reset();
+            gpu_pipeline->set_reference_from_current();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Clear")) {
+            gpu_pipeline->clear_reference();
+            gpu_pipeline->reset();
+        }
+    }
+
+    // Scattering overlay of the shader display (reference taken from the frame on screen)
+    else if (shader_display_active && shader_display) {
+        ImGui::Text("Overlay:");
+        ImGui::SameLine(100);
+        ImGui::Text("%s", shader_display->has_reference() ? "reference set" : "no reference");
+        if (ImGui::Button("Set display reference")) {
+            refresh_shader_camera_bits();
+            if (!camera_bits.combined.empty() && shader_display->set_reference(camera_bits.combined)) {
+                shader_display->render(shader_display_style());
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Clear##display_reference")) {
+            shader_display->clear_reference();
+            shader_display->render(shader_display_style());
+        }
+    }
+
+    // Display upload latency (triple-buffered backend only)
+    else if (app_state && AppConfig::instance().runtime_settings().triple_buffer_display) {
+        auto stats = app_state->triple_buffer_renderer(0).get_stats();
+        ImGui::Text("Upload:");
+        ImGui::SameLine(100);
+        ImGui::Text("%.2f ms avg, %.2f ms max", stats.avg_latency_ms, stats.max_latency_ms);
+    }
+
+    // Event batches the accumulation thread could not keep up with
+    int64_t dropped_events = cam_mgr.get_dropped_events();
+    if (dropped_events > 0) {
+        ImGui::Text("Dropped:");
+        ImGui::SameLine(100);
+        ImGui::TextColored(ImVec4(1, 0.6f, 0, 1), "%lld events", static_cast<long long>(dropped_events));
+    }
+
+    // Windows shed to stay within the latency budget
+    const core::ClockSync& clock_sync = cam_mgr.clock_sync();
+    if (clock_sync.get_fit_points() > 0) {
+        ImGui::Text("Clock:");
+        ImGui::SameLine(100);
+        ImGui::Text("%+.2f ppm drift (%d s fit)", clock_sync.get_drift_ppm(),
+                    static_cast<int>(clock_sync.get_fit_points() * core::ClockSync::BUCKET_US / 1000000));
+    }
+    if (cam_mgr.get_latency_budget_ms() > 0) {
+        ImGui::Text("Lag:");
+        ImGui::SameLine(100);
+        ImGui::Text("%.1f ms (budget %d ms)", cam_mgr.get_latency_lag_us() / 1000.0, cam_mgr.get_latency_budget_ms());
+        const int64_t shed_windows = cam_mgr.get_shed_windows();
+        if (shed_windows > 0) {
+            ImGui::Text("Shed:");
+            ImGui::SameLine(100);
+            ImGui::TextColored(ImVec4(1, 0.6f, 0, 1), "%lld windows", static_cast<long long>(shed_windows));
+        }
+    }
+    const auto& qos = core::QosScheduler::instance();
+    if (qos.is_enabled()) {
+        using Work = core::QosScheduler::Work;
+        const core::QosScheduler::Level level = qos.get_level();
+        ImGui::Text("QoS:");
+        ImGui::SameLine(100);
+        if (level == core::QosScheduler::Level::Normal) {
+            ImGui::Text("normal");
+        } else {
+            ImGui::TextColored(ImVec4(1, 0.6f, 0, 1), "%s", core::QosScheduler::level_name(level));
+        }
+        ImGui::SetItemTooltip("Deferrable work shed so far: heatmap %llu, visualization %llu, chart %llu, thumbnails %llu\n"
+                              "Scattering counts, hot pixels and recording are never shed",
+                              static_cast<unsigned long long>(qos.get_shed(Work::Heatmap)),
+                              static_cast<unsigned long long>(qos.get_shed(Work::Visualization)),
+                              static_cast<unsigned long long>(qos.get_shed(Work::Chart)),
+                              static_cast<unsigned long long>(qos.get_shed(Work::Thumbnail)));
+    }
+    {
+        const auto& budget = core::MemoryBudget::instance();
+        const double used_mb = budget.get_used() / (1024.0 * 1024.0);
+        ImGui::Text("Memory:");
+        ImGui::SameLine(100);
+        if (budget.get_budget() == 0) {
+            ImGui::Text("%.0f MB", used_mb);
+        } else if (budget.is_backpressured()) {
+            ImGui::TextColored(ImVec4(1, 0.6f, 0, 1), "%.0f / %.0f MB, holding back", used_mb,
+                               budget.get_budget() / (1024.0 * 1024.0));
+        } else {
+            ImGui::Text("%.0f / %.0f MB", used_mb, budget.get_budget() / (1024.0 * 1024.0));
+        }
+        if (ImGui::BeginItemTooltip()) {
+            for (const core::MemoryBudget::Usage& usage : budget.get_breakdown()) {
+                ImGui::Text("%-16s %-9s %8.1f MB", usage.name.c_str(), core::MemoryBudget::tier_name(usage.tier),
+                            usage.bytes / (1024.0 * 1024.0));
+            }
+            ImGui::Text("Evicted %.0f MB, producers refused %llu times",
+                        budget.get_evicted_bytes() / (1024.0 * 1024.0),
+                        static_cast<unsigned long long>(budget.get_refused()));
+            ImGui::EndTooltip();
+        }
+    }
+
+    // Coarse accumulation windows
+    if (cam_mgr.get_window_levels() > 0) {
+        ImGui::Text("Windows:");
+        for (int level = 0; level < cam_mgr.get_window_levels(); ++level) {
+            ImGui::SameLine(level == 0 ? 100.0f : 0.0f);
+            ImGui::Text("%g ms %.1f %%", cam_mgr.get_window_us(level) / 1000.0,
+                        window_views[0][level].active_percent.load(std::memory_order_relaxed));
+        }
+    }
+
+    // Raw event recording
+    if (cam_mgr.is_camera_connected(0)) {
+        const auto& recorder = cam_mgr.recorder();
+        if (recorder.is_recording()) {
+            if (ImGui::Button("Stop Recording", ImVec2(-1, 0))) {
+                cam_mgr.stop_recording();
+            }
+            ImGui::Text("Recording:");
+            ImGui::SameLine(100);
+            // Against 16 bytes per EventCD in memory
+            const double bytes = static_cast<double>(recorder.get_bytes_written());
+            ImGui::Text("%.1f MiB (%.1fx)", bytes / (1024.0 * 1024.0),
+                        bytes > 0 ? recorder.get_events_written() * sizeof(Metavision::EventCD) / bytes : 0.0);
+        } else if (ImGui::Button("Record Events", ImVec2(-1, 0))) {
+            start_event_recording();
+        }
+
+        // Batches the writer thread could not keep up with (current / last recording)
+        if (recorder.get_dropped_batches() > 0) {
+            ImGui::Text("Rec dropped:");
+            ImGui::SameLine(100);
+            ImGui::TextColored(ImVec4(1, 0.6f, 0, 1), "%lld batches",
+                               static_cast<long long>(recorder.get_dropped_batches()));
+        }
+        if (recorder.has_write_error()) {
+            ImGui::TextColored(ImVec4(1, 0, 0, 1), "Recording write failed");
+        }
+    }
+
+    // Burst capture: every frame around a trigger, held in RAM then saved as one file
+    if (app_state && (cam_mgr.is_camera_connected(0) || cam_mgr.is_replay())) {
+        auto& burst = app_state->burst_capture(0);
+        const video::TriggerGate& gate = CameraManager::instance().trigger_gate(0);
+        if (gate.is_enabled()) {
+            // Bursts follow the trigger input; arming by hand would take its ring
+            ImGui::Text("Trigger:");
+            ImGui::SameLine(100);
+            ImGui::Text("%llu windows, %s", static_cast<unsigned long long>(gate.get_windows_opened()),
+                        gate.is_window_open() ? "capturing" : "waiting");
+        }
+        switch (burst.get_state()) {
+        case video::BurstCapture::State::Idle:
+            if (!gate.is_enabled() && ImGui::Button("Arm Burst", ImVec2(-1, 0))) {
+                arm_burst_capture();
+            }
+            break;
+        case video::BurstCapture::State::Armed:
+            if (ImGui::Button("Trigger Burst", ImVec2(140, 0))) {
+                burst.trigger();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Disarm", ImVec2(-1, 0))) {
+                burst.disarm();
+            }
+            ImGui::Text("Burst:");
+            ImGui::SameLine(100);
+            ImGui::Text("%d / %d frames (%.0f MiB)", burst.get_buffered_frames(), burst.get_capacity(),
+                        burst.get_ring_bytes() / (1024.0 * 1024.0));
+            break;
+        case video::BurstCapture::State::Triggered:
+            ImGui::Text("Burst:");
+            ImGui::SameLine(100);
+            ImGui::TextColored(ImVec4(1, 0.6f, 0, 1), "Triggered, %d frames left",
+                               burst.get_post_frames_remaining());
+            break;
+        case video::BurstCapture::State::Flushing:
+            ImGui::Text("Burst:");
+            ImGui::SameLine(100);
+            ImGui::Text("Writing...");
+            break;
+        }
+
+        if (burst.get_frames_ignored() > 0) {
+            ImGui::TextColored(ImVec4(1, 0.6f, 0, 1), "Burst ignored %lld frames (size changed)",
+                               static_cast<long long>(burst.get_frames_ignored()));
+        }
+        if (burst.has_write_error()) {
+            ImGui::TextColored(ImVec4(1, 0, 0, 1), "Burst write failed");
+        }
+
+        // PNG conversion happens only on request, never at capture rate
+        auto& burst_exporter = BurstExporter::instance();
+        const std::string last_burst = burst.get_last_file();
+        if (!last_burst.empty() && burst.get_state() == video::BurstCapture::State::Idle) {
+            ImGui::TextWrapped("Last burst: %s", std::filesystem::path(last_burst).filename().string().c_str());
+            if (!burst_exporter.is_busy()) {
+                if (ImGui::Button("Export Burst PNGs", ImVec2(140, 0))) {
+                    burst_exporter.start({last_burst});
+                }
+                ImGui::SetItemTooltip("One PNG and metadata JSON per frame, in a folder named after the burst");
+                ImGui::SameLine();
+                if (ImGui::Button("Export All Bursts", ImVec2(-1, 0))) {
+                    burst_exporter.start(BurstExporter::list_bursts(recording_output_directory().string()));
+                }
+                ImGui::SetItemTooltip("Every burst in the recording directory, oldest first");
+            }
+        }
+        const BurstExporter::Progress export_progress = burst_exporter.get_progress();
+        if (export_progress.busy) {
+            char overlay[96];
+            std::snprintf(overlay, sizeof(overlay), "%lld / %lld frames, burst %d / %d",
+                          static_cast<long long>(export_progress.frames_done),
+                          static_cast<long long>(export_progress.frames_total),
+                          std::min(export_progress.files_done + 1, export_progress.files_total),
+                          export_progress.files_total);
+            ImGui::ProgressBar(export_progress.frames_total > 0
+                                   ? static_cast<float>(export_progress.frames_done) / export_progress.frames_total
+                                   : 0.0f,
+                               ImVec2(-70, 0), overlay);
+            ImGui::SameLine();
+            if (ImGui::Button("Cancel##burst_export", ImVec2(-1, 0))) {
+                burst_exporter.cancel();
+            }
+        } else if (export_progress.files_total > 0) {
+            ImGui::Text("Exported %lld frames in %.1f s (%.0f / s)", static_cast<long long>(export_progress.frames_done),
+                        export_progress.elapsed_s, export_progress.frames_done / std::max(export_progress.elapsed_s, 1e-3));
+            if (export_progress.failed > 0) {
+                ImGui::TextColored(ImVec4(1, 0.6f, 0, 1), "%lld frames not exported",
+                                   static_cast<long long>(export_progress.failed));
+            }
+        }
+    }
+
+    // Background image saves (viewer Save dialog, Capture Frame)
+    auto& save_queue = ImageSaveQueue::instance();
+    while (save_queue.poll_result(last_save_result)) {
+    }
+    size_t pending_saves = save_queue.get_pending();
+    if (pending_saves > 0) {
+        ImGui::Text("Saving:");
+        ImGui::SameLine(100);
+        ImGui::Text("%zu image(s)", pending_saves);
+    }
+    if (!last_save_result.path.empty()) {
+        std::string filename = std::filesystem::path(last_save_result.path).filename().string();
+        if (!last_save_result.success) {
+            ImGui::TextColored(ImVec4(1, 0, 0, 1), "Save failed: %s", filename.c_str());
+        } else if (!last_save_result.error.empty()) {
+            ImGui::TextColored(ImVec4(1, 0.6f, 0, 1), "Saved %s (no metadata)", filename.c_str());
+        } else if (!last_save_result.duplicate_of.empty()) {
+            ImGui::Text("Saved %s (same as %s)", filename.c_str(),
+                        std::filesystem::path(last_save_result.duplicate_of).filename().string().c_str());
+        } else {
+            ImGui::Text("Saved %s (%.0f ms)", filename.c_str(), last_save_result.elapsed_ms);
+        }
+    }
+    if (save_queue.get_deduplicated() > 0) {
+        ImGui::Text("Deduplicated:");
+        ImGui::SameLine(100);
+        ImGui::Text("%lld capture(s) stored as references", static_cast<long long>(save_queue.get_deduplicated()));
+    }
+    if (save_queue.get_rejected() > 0) {
+        ImGui::TextColored(ImVec4(1, 0.6f, 0, 1), "Save queue full: %lld skipped",
+                           static_cast<long long>(save_queue.get_rejected()));
+    }
+
+    render_latency_section();
+    render_frame_log_section();
+    render_trends_section();
+    render_metrics_section();
+#if RTCAM_ALLOC_TRACKING
+    render_allocation_section();
+#endif
+
+    ImGui::End();
+}
+
+/**
+ * Render camera viewer (single viewer with all controls)
+ */
+void render_camera_views() {
+    PROFILE_ZONE("render_camera_views");
+    ImGui::SetNextWindowPos(ImVec2(310, 20), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(900, 800), ImGuiCond_FirstUseEver);
+
+    ImGui::Begin("Camera View", nullptr, ImGuiWindowFlags_NoScrollbar);
+
+    // Get camera texture info
+    GLuint camera_tex_id = 0;
+    int cam_width = 0;
+    int cam_height = 0;
+    if (gpu_pipeline_active && gpu_pipeline) {
+        // Binary result is sampled straight from the compute output, views from their render target
+        camera_tex_id = gpu_pipeline->get_binary_texture();
+        if (gpu_view_mode != 0 && gpu_scattering_view.get_texture() != 0) {
+            camera_tex_id = gpu_scattering_view.get_texture();
+        }
+        cam_width = gpu_pipeline->get_width();
+        cam_height = gpu_pipeline->get_height();
+    } else if (gpu_event_scatter && gpu_event_scatter->get_texture() != 0) {
+        // Scattered from event windows by the compute shader
+        camera_tex_id = gpu_event_scatter->get_texture();
+        cam_width = gpu_event_scatter->get_width();
+        cam_height = gpu_event_scatter->get_height();
+    } else if (shader_display_active && shader_display) {
+        // Coloured by the fragment shader from the raw frame
+        camera_tex_id = shader_display->get_texture();
+        cam_width = shader_display->get_width();
+        cam_height = shader_display->get_height();
+    } else if (app_state && AppConfig::instance().runtime_settings().triple_buffer_display) {
+        auto& renderer = app_state->triple_buffer_renderer(0);
+        if (renderer.get_texture_id() > 0) {
+            camera_tex_id = renderer.get_texture_id();
+            cam_width = renderer.get_width();
+            cam_height = renderer.get_height();
+        }
+    } else if (app_state && app_state->texture_manager(0).get_texture_id() > 0) {
+        camera_tex_id = app_state->texture_manager(0).get_texture_id();
+        cam_width = app_state->texture_manager(0).get_width();
+        cam_height = app_state->texture_manager(0).get_height();
+    }
+    if (!gpu_pipeline_active && !shader_display_active && camera_tex_id > 0 && !camera_bits.combined.empty()) {
+        // The texture may hold the binned preview; the viewer works in frame pixels
+        cam_width = camera_bits.combined.cols;
+        cam_height = camera_bits.combined.rows;
+    }
+
+    // Render viewer (includes image display, noise analysis, and filters)
+    if (viewer) {
+        viewer->render(camera_bits.combined, camera_tex_id, cam_width, cam_height);
+    }
+
+    ImGui::End();
+}
+
+/**
+ * Render help window
+ */
+/**
+ * Record finished GPU timer queries into the metrics registry (UI thread)
+ */
+void collect_gpu_timing() {
+    for (const auto& sample : gpu_timer.collect()) {
+        gpu_pass_metrics[sample.pass]->record(static_cast<int64_t>(sample.elapsed_ns / 1000));
+    }
+}
+
+/**
+ * Small overlay with the GPU time of each display pass [F2]
+ */
+void render_gpu_timing_overlay() {
+    if (!show_gpu_timing) return;
+
+    ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - 10, 10), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowBgAlpha(0.6f);
+    const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+                                   ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav;
+    if (ImGui::Begin("GPU Timing", &show_gpu_timing, flags)) {
+        if (!video::gpu::GPUPassTimer::is_supported()) {
+            ImGui::Text("GPU timer queries unavailable (need GL 3.3)");
+        } else if (ImGui::BeginTable("##gpu_timing", 4, ImGuiTableFlags_SizingFixedFit)) {
+            ImGui::TableSetupColumn("Pass");
+            ImGui::TableSetupColumn("Last");
+            ImGui::TableSetupColumn("Avg");
+            ImGui::TableSetupColumn("Max");
+            ImGui::TableHeadersRow();
+            for (const auto& pass : gpu_timer.get_passes()) {
+                if (pass.samples == 0) continue;  // Not used by this display backend
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(pass.name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f ms", pass.last_ms);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f ms", pass.avg_ms);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f ms", pass.max_ms);
+            }
+            ImGui::EndTable();
+        }
+    }
+    ImGui::End();
+}
+
+void render_help_window() {
+    if (!show_help_window) return;
+
+    ImGui::SetNextWindowPos(ImVec2(400, 100), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(800, 600), ImGuiCond_FirstUseEver);
+
+    if (ImGui::Begin("Help", &show_help_window)) {
+        ImGui::TextColored(ImVec4(0.5f, 1.0f, 0.5f, 1.0f), "Reliability Testing Camera - Help");
+        ImGui::Separator();
+        ImGui::Spacing();
+
+        ImGui::TextWrapped(
+            "This application allows you to view and analyze event camera feeds for reliability testing.\n\n"
+        );
+
+        if (ImGui::CollapsingHeader("Camera View", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::BulletText("Active Camera: View live camera feed");
+            ImGui::BulletText("Load Image: Load a saved image for analysis");
+            ImGui::BulletText("Save Image: Save current camera frame with metadata");
+            ImGui::BulletText("Capture Gallery: Thumbnails of the catalogued captures; click one to load it");
+        }
+
+        if (ImGui::CollapsingHeader("Image Analysis", ImGuiTreeNodeFlags_DefaultOpen)) {
+            ImGui::TextWrapped("Analyzes images to detect circular dots (signal) and measure background noise.");
+            ImGui::BulletText("Adjust detection parameters to tune sensitivity");
+            ImGui::BulletText("Run analysis to get SNR, contrast ratio, and statistics");
+            ImGui::BulletText("Export results to text file for reporting");
+            ImGui::BulletText("Run Focus Adjust: Monitor event rate in real-time");
+        }
+
+        if (ImGui::CollapsingHeader("Camera Settings")) {
+            ImGui::TextWrapped("Adjust camera biases and trail filter settings in real-time.");
+            ImGui::BulletText("Analog Bias Filters: Control event detection sensitivity");
+            ImGui::BulletText("ON/OFF Thresholds: Adjust brightness change sensitivity");
+            ImGui::BulletText("High-Pass Filter: Remove DC noise component");
+            ImGui::BulletText("Refractory Period: Prevent pixel re-triggering");
+            ImGui::BulletText("Trail Filter: Filter transient events and flickering");
+            ImGui::BulletText("Click 'Apply' buttons to send changes to camera");
+        }
+
+        if (ImGui::CollapsingHeader("Binary Image Mode")) {
+            ImGui::TextWrapped(
+                "The camera extracts specific bits from the 8-bit image for reliability testing.\n"
+                "Configured in event_config.ini (binary_bit_1 and binary_bit_2).\n\n"
+                "Current configuration displayed in Status panel."
+            );
+        }
+
+        if (ImGui::CollapsingHeader("Keyboard Shortcuts")) {
+            ImGui::BulletText("F1: Toggle this help window");
+            ImGui::BulletText("F2: Toggle the GPU timing overlay");
+            ImGui::BulletText("F3: Toggle the capture gallery");
+            ImGui::BulletText("F4: Toggle the heatmap timeline of the latest headless run");
+            ImGui::BulletText("Left / Right: Previous / next capture in a viewer showing a loaded image");
+            ImGui::BulletText("ESC: Close application");
+        }
+
+        ImGui::Spacing();
+        ImGui::Separator();
+        ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f),
+            "For detailed documentation, see README.md");
+    }
+    ImGui::End();
+}
+
+// ============================================================================
+// Headless Mode
+// ============================================================================
+
+static void handle_stop_signal(int) {
+    stop_requested = 1;
+}
+
+/**
+ * Stop the background services shared by windowed and headless runs
+ */
+void shutdown_pipeline() {
+    core::FlightRecorder::instance().stop();   // First: stopping the pipeline would read as a stream gap
+    metrics_exporter.stop();
+    stage_graph.stop();
+    stream_stage_active = false;
+    frame_streamer.stop();
+    fleet_reporter.stop();
+    trend_store.stop();
+
+    if (app_state) {
+        for (int i = 0; i < core::AppState::MAX_CAMERAS; ++i) {
+            app_state->scattering_worker(i).stop();
+        }
+    }
+    core::RunLog::instance().close();   // After the workers: their last rows go in the final block
+    EventCamera::ControlQueue::instance().shutdown();   // Queued register writes need the devices
+    CameraManager::instance().shutdown();
+
+    // Finish saves still queued so nothing the user asked for is lost
+    ImageSaveQueue::instance().shutdown();
+    BurstExporter::instance().cancel();   // Frames already read are still written
+    BurstExporter::instance().wait();
+    CaptureCatalog::instance().close();
+    ImageCache::instance().shutdown();
+
+    // Zones recorded during shutdown are still written
+    core::Profiler::instance().stop();
+
+    // Last, so the pipeline's final lines are flushed
+    core::Log::instance().stop();
+}
+
+/**
+ * Integrate events with the lens capped and save each camera's hot pixel mask
+ *
+ * Runs in place of the headless loop once the camera streams, like the bias
+ * sweep. The software noise filter is turned off so isolated hot pixel
+ * events are counted; the masks are saved to hot_pixel_mask_file and handed
+ * to the rate monitors right away.
+ *
+ * @return Process exit code
+ */
+int run_dark_calibration() {
+    const auto& config = AppConfig::instance();
+    const auto& runtime = config.runtime_settings();
+    auto& cam_mgr = CameraManager::instance();
+
+    if (config.camera_settings().hot_pixel_mask_file.empty()) {
+        std::cerr << "Dark calibration: hot_pixel_mask_file is empty, nowhere to save the mask" << std::endl;
+        return 1;
+    }
+    const int camera_count = cam_mgr.num_pipelines();
+    const int64_t duration_us = std::max(runtime.dark_calibration_s, 1) * 1000000LL;
+    for (int i = 0; i < camera_count; ++i) {
+        cam_mgr.noise_filter(i).set_enabled(false);
+        cam_mgr.dark_frames(i).start(duration_us);
+    }
+    std::cout << "Dark calibration: integrating " << duration_us / 1000000 << " s, keep the lens capped" << std::endl;
+
+    // Sensor time drives the integration; give up if the cameras stop delivering
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point deadline = Clock::now() + std::chrono::microseconds(duration_us) + std::chrono::seconds(10);
+    Clock::time_point next_report = Clock::now() + std::chrono::seconds(5);
+    auto all_done = [&] {
+        for (int i = 0; i < camera_count; ++i) {
+            if (!cam_mgr.dark_frames(i).is_done()) {
+                return false;
+            }
+        }
+        return true;
+    };
+    while (!all_done()) {
+        if (stop_requested != 0 || Clock::now() > deadline) {
+            std::cerr << "Dark calibration: " << (stop_requested != 0 ? "stopped" : "cameras stopped delivering")
+                      << ", no mask saved" << std::endl;
+            for (int i = 0; i < camera_count; ++i) {
+                cam_mgr.dark_frames(i).cancel();
+            }
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (Clock::now() >= next_report) {
+            std::cout << "Dark calibration: " << std::lround(cam_mgr.dark_frames().get_progress() * 100.0) << " %"
+                      << std::endl;
+            next_report += std::chrono::seconds(5);
+        }
+    }
+
+    bool saved = true;
+    for (int i = 0; i < camera_count; ++i) {
+        video::BinaryFrame mask;
+        video::DarkFrameCalibrator::Result result;
+        cam_mgr.dark_frames(i).build_mask(runtime.dark_calibration_sigma, runtime.dark_calibration_min_rate_hz,
+                                          mask, result);
+        video::HotPixelMaskInfo info;
+        info.duration_ms = static_cast<uint32_t>(result.duration_us / 1000);
+        info.threshold_hz = static_cast<float>(result.threshold_hz);
+        const std::string path = hot_pixel_mask_path(i);
+        std::cout << "Dark calibration: camera " << i << ": " << result.events << " events, median "
+                  << result.median_hz << " ev/s, MAD " << result.mad_hz << " ev/s, threshold "
+                  << result.threshold_hz << " ev/s -> " << result.hot_pixels << " hot pixels";
+        if (result.saturated_pixels > 0) {
+            std::cout << " (" << result.saturated_pixels << " saturated)";
+        }
+        std::cout << std::endl;
+        if (!video::save_hot_pixel_mask(path, mask, info)) {
+            saved = false;
+            continue;
+        }
+        cam_mgr.pixel_rates(i).set_known_hot(mask);
+        std::cout << "Dark calibration: saved " << path << std::endl;
+    }
+    return saved ? 0 : 1;
+}
+
+/**
+ * Measure the bias sweep's settle time from bias steps
+ *
+ * Each bias with more than one value is stepped to the value farthest from
+ * its current one (the largest step the sweep makes) and back; the slowest
+ * step plus 25 % and one window is the settle time.
+ *
+ * @param biases Bias facility of camera 0
+ * @param lists Swept values per bias name
+ * @param fallback_ms Kept when a step is not measured or does not settle
+ * @return Settle time in milliseconds
+ */
+int measure_sweep_settle_ms(Metavision::I_LL_Biases* biases,
+                            const std::vector<std::pair<std::string, std::vector<int>>>& lists, int fallback_ms) {
+    const auto& config = AppConfig::instance();
+    BiasStepResponse::Options options;
+    options.tolerance_percent = config.runtime_settings().sweep_settle_tolerance_percent;
+    options.observe_ms = std::max(2 * fallback_ms, 1000);
+    options.steady_ms = options.observe_ms / 4;
+    const auto should_stop = [] { return stop_requested != 0; };
+
+    bool settled = true;
+    int64_t slowest_us = 0;
+    for (const auto& [name, values] : lists) {
+        if (values.size() < 2 || !settled) {
+            continue;
+        }
+        int current = 0;
+        try {
+            current = biases->get(name);
+        } catch (const std::exception& e) {
+            std::cerr << "Bias sweep: failed to read " << name << ": " << e.what() << std::endl;
+            return fallback_ms;
+        }
+        const int target = *std::max_element(values.begin(), values.end(), [current](int a, int b) {
+            return std::abs(a - current) < std::abs(b - current);
+        });
+        if (target == current) {
+            continue;
+        }
+
+        // There and back, so the sweep starts from the configured biases
+        for (const int value : {target, current}) {
+            const BiasStepResponse::Result step = BiasStepResponse::measure(0, biases, name, value, options, should_stop);
+            std::cout << "Bias sweep: step " << name << " " << step.from << " -> " << value;
+            if (!step.measured) {
+                std::cout << " not measured" << std::endl;
+                settled = false;
+                continue;
+            }
+            std::cout << ", " << std::llround(step.rate_before_kevps) << " -> "
+                      << std::llround(step.rate_after_kevps) << " kev/s, ";
+            if (step.settled) {
+                std::cout << "settled in " << step.settle_us / 1000 << " ms" << std::endl;
+                slowest_us = std::max(slowest_us, step.settle_us);
+            } else {
+                std::cout << "not settled within " << options.observe_ms << " ms" << std::endl;
+                settled = false;
+            }
+        }
+        try {
+            CameraManager::write_biases(biases, {{name, current}});   // In case the step back failed
+        } catch (const std::exception& e) {
+            std::cerr << "Bias sweep: failed to restore " << name << ": " << e.what() << std::endl;
+        }
+    }
+
+    if (!settled) {
+        std::cout << "Bias sweep: keeping sweep_settle_ms = " << fallback_ms << std::endl;
+        return fallback_ms;
+    }
+    const int64_t window_us = std::max(config.camera_settings().accumulation_time_us, 1);
+    const int settle_ms = static_cast<int>((slowest_us * 5 / 4 + window_us + 999) / 1000);
+    std::cout << "Bias sweep: measured settle time " << settle_ms << " ms (configured " << fallback_ms << " ms)"
+              << std::endl;
+    return settle_ms;
+}
+
+/**
+ * Step the biases through the configured grid and write one CSV row per point
+ *
+ * Runs in place of the headless loop once the camera streams; the biases
+ * configured before the sweep are restored at the end.
+ *
+ * @return Process exit code
+ */
+int run_bias_sweep() {
+    const auto& config = AppConfig::instance();
+    const auto& runtime = config.runtime_settings();
+    const auto& cam_settings = config.camera_settings();
+    auto& cam_mgr = CameraManager::instance();
+
+    if (cam_mgr.is_replay() || !cam_mgr.is_camera_connected(0)) {
+        std::cerr << "Bias sweep: needs a live camera" << std::endl;
+        return 1;
+    }
+
+    std::vector<int> diff_on, diff_off, hpf, refr;
+    if (!BiasSweep::parse_values(runtime.sweep_bias_diff_on, cam_settings.bias_diff_on, diff_on) ||
+        !BiasSweep::parse_values(runtime.sweep_bias_diff_off, cam_settings.bias_diff_off, diff_off) ||
+        !BiasSweep::parse_values(runtime.sweep_bias_hpf, cam_settings.bias_hpf, hpf) ||
+        !BiasSweep::parse_values(runtime.sweep_bias_refr, cam_settings.bias_refr, refr)) {
+        std::cerr << "Bias sweep: invalid sweep_bias_* list (expected start:stop[:step] or a,b,c)" << std::endl;
+        return 1;
+    }
+
+    BiasSweep::Options options;
+    options.settle_ms = runtime.sweep_settle_ms;
+    options.frames = runtime.sweep_frames;
+    std::filesystem::path output = runtime.sweep_output;
+    if (output.is_relative() && !cam_settings.capture_directory.empty()) {
+        output = std::filesystem::path(cam_settings.capture_directory) / output;
+    }
+    options.csv_path = output.string();
+    if (!runtime.headless_reference.empty()) {
+        options.reference = ImageManager::load_binary(runtime.headless_reference);
+        if (!options.reference) {
+            std::cerr << "Bias sweep: failed to load reference " << runtime.headless_reference << std::endl;
+            return 1;
+        }
+    }
+
+    auto* biases = cam_mgr.get_camera(0).camera->get_device().get_facility<Metavision::I_LL_Biases>();
+    if (runtime.sweep_auto_settle && biases) {
+        options.settle_ms = measure_sweep_settle_ms(biases, {
+            {"bias_diff_on", diff_on},
+            {"bias_diff_off", diff_off},
+            {"bias_hpf", hpf},
+            {"bias_refr", refr},
+        }, runtime.sweep_settle_ms);
+    }
+    BiasSweep sweep(app_state->frame_buffer(0));
+    const bool completed = sweep.run(BiasSweep::make_grid(diff_on, diff_off, hpf, refr), options, biases,
+                                     [] { return stop_requested != 0; });
+    return completed ? 0 : 1;
+}
+
+/**
+ * Tune the camera with the genetic optimizer, then leave the best settings applied
+ *
+ * Runs in place of the headless loop once the camera streams, like the bias
+ * sweep; a stopped run can continue from its checkpoint with --ga-resume.
+ *
+ * @return Process exit code
+ */
+int run_ga_optimizer() {
+    const auto& config = AppConfig::instance();
+    const auto& runtime = config.runtime_settings();
+    const auto& cam_settings = config.camera_settings();
+    auto& cam_mgr = CameraManager::instance();
+
+    if (cam_mgr.is_replay() || !cam_mgr.is_camera_connected(0)) {
+        std::cerr << "GA: needs a live camera" << std::endl;
+        return 1;
+    }
+
+    auto in_capture_directory = [&cam_settings](const std::string& file) {
+        std::filesystem::path path = file;
+        if (!path.empty() && path.is_relative() && !cam_settings.capture_directory.empty()) {
+            path = std::filesystem::path(cam_settings.capture_directory) / path;
+        }
+        return path.string();
+    };
+
+    GAOptimizer::Options options;
+    options.ga.population_size = runtime.ga_population;
+    options.ga.generations = runtime.ga_generations;
+    options.ga.crossover_rate = runtime.ga_crossover_rate;
+    options.ga.mutation_rate = runtime.ga_mutation_rate;
+    options.ga.seed = static_cast<uint32_t>(runtime.ga_seed);
+    options.optimize_biases = runtime.ga_optimize_biases;
+    options.optimize_trail_filter = runtime.ga_optimize_trail_filter;
+    options.optimize_antiflicker = runtime.ga_optimize_antiflicker;
+    options.measure.settle_ms = runtime.ga_settle_ms;
+    options.measure.frames = runtime.ga_frames;
+    options.csv_path = in_capture_directory(runtime.ga_output);
+    options.checkpoint_path = in_capture_directory(runtime.ga_checkpoint);
+    options.resume = runtime.ga_resume;
+    if (!runtime.headless_reference.empty()) {
+        options.measure.reference = ImageManager::load_binary(runtime.headless_reference);
+        if (!options.measure.reference) {
+            std::cerr << "GA: failed to load reference " << runtime.headless_reference << std::endl;
+            return 1;
+        }
+    }
+
+    GAOptimizer optimizer(app_state->frame_buffer(0));
+    const bool completed = optimizer.run(cam_mgr.get_camera(0).camera->get_device(), options,
+                                         [] { return stop_requested != 0; });
+    return completed ? 0 : 1;
+}
+
+/**
+ * Aggregate the station reports of a whole fleet instead of running a camera
+ *
+ * Runs until SIGINT/SIGTERM (or headless_duration_s). Fleet and per-sensor
+ * gauges reach dashboards through the metrics exporter; histories go to
+ * fleet_directory.
+ *
+ * @return Process exit code
+ */
+int run_aggregator() {
+    const auto& runtime = AppConfig::instance().runtime_settings();
+
+    std::signal(SIGINT, handle_stop_signal);
+    std::signal(SIGTERM, handle_stop_signal);
+
+    // Relative history directories live next to the recordings
+    std::filesystem::path directory = runtime.fleet_directory;
+    if (!directory.empty() && directory.is_relative()) {
+        directory = recording_output_directory() / directory;
+    }
+
+    core::FleetAggregator aggregator;
+    core::FleetAggregator::Options options;
+    options.port = runtime.fleet_port;
+    options.shards = runtime.fleet_shards;
+    options.directory = directory.string();
+    options.stale_s = runtime.fleet_stale_s;
+    if (!aggregator.start(options)) {
+        std::cerr << "Aggregator: cannot receive station reports, exiting" << std::endl;
+        shutdown_pipeline();
+        return 1;
+    }
+    if (!metrics_exporter.is_running()) {
+        std::cout << "Aggregator: metrics_export is off, fleet gauges are not published" << std::endl;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    Clock::time_point next_status = start + std::chrono::seconds(10);
+    while (stop_requested == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        const Clock::time_point now = Clock::now();
+        if (now >= next_status) {
+            std::cout << "Aggregator: " << aggregator.get_sensor_count() << " sensors, "
+                      << aggregator.get_received() << " reports (" << aggregator.get_dropped() << " dropped, "
+                      << aggregator.get_rejected() << " rejected)" << std::endl;
+            next_status = now + std::chrono::seconds(10);
+        }
+        if (runtime.headless_duration_s > 0 && now - start >= std::chrono::seconds(runtime.headless_duration_s)) {
+            break;
+        }
+    }
+
+    aggregator.stop();
+    shutdown_pipeline();
+    return 0;
+}
+
+/**
+ * Run ingestion, extraction, scattering and periodic capture without a window
+ *
+ * Paced by the camera: the loop sleeps in FrameBuffer::wait_for_frame()
+ * instead of glfwSwapBuffers(), so nothing throttles the pipeline to the
+ * display refresh. Metrics reach the outside through the exporter.
+ *
+ * @param camera_connected Result of initialize_camera()
+ * @return Process exit code
+ */
+int run_headless(bool camera_connected) {
+    const auto& config = AppConfig::instance();
+    const auto& runtime = config.runtime_settings();
+    auto& cam_mgr = CameraManager::instance();
+
+    std::signal(SIGINT, handle_stop_signal);
+    std::signal(SIGTERM, handle_stop_signal);
+
+    if (camera_connected) {
+        warm_up_pipeline(false);
+    }
+    if (!camera_connected || !start_camera()) {
+        std::cerr << "Headless: no camera or replay source, exiting" << std::endl;
+        shutdown_pipeline();
+        return 1;
+    }
+
+    if (runtime.dark_calibration) {
+        const int exit_code = run_dark_calibration();
+        shutdown_pipeline();
+        return exit_code;
+    }
+    if (runtime.bias_sweep) {
+        const int exit_code = run_bias_sweep();
+        shutdown_pipeline();
+        return exit_code;
+    }
+    if (runtime.ga_optimize) {
+        const int exit_code = run_ga_optimizer();
+        shutdown_pipeline();
+        return exit_code;
+    }
+
+    // Every camera streams into its own frame buffer and is analyzed on its own worker
+    const int camera_count = std::min(cam_mgr.num_pipelines(), core::AppState::MAX_CAMERAS);
+    auto camera_suffix = [](int index) { return index == 0 ? std::string() : "_cam" + std::to_string(index); };
+
+    // Scattering against a saved reference runs on its own worker, as in the viewer
+    std::vector<ScatteringAnalyzer::Region> regions;
+    ScatteringAnalyzer::parse_regions(runtime.scattering_regions, regions);
+    // Loaded packed once; every camera's worker shares the handle
+    ImageManager::BinaryHandle reference;
+    if (!runtime.headless_reference.empty()) {
+        reference = ImageManager::load_binary(runtime.headless_reference);
+        if (!reference) {
+            std::cerr << "Headless: failed to load reference " << runtime.headless_reference << std::endl;
+        }
+    }
+    std::vector<ScatteringAnalyzer::Reference> comparison_references;
+    std::stringstream compare_list(runtime.scattering_compare_references);
+    for (std::string path; std::getline(compare_list, path, ';');) {
+        path.erase(0, path.find_first_not_of(" \t"));
+        path.erase(path.find_last_not_of(" \t") + 1);
+        if (path.empty()) {
+            continue;
+        }
+        ScatteringAnalyzer::Reference compare{std::filesystem::path(path).stem().string(),
+                                              ImageManager::load_binary(path)};
+        if (!compare.bits) {
+            std::cerr << "Headless: failed to load comparison reference " << path << std::endl;
+            continue;
+        }
+        comparison_references.push_back(std::move(compare));
+    }
+    const uint8_t live_mask = scattering_live_mask(runtime.scattering_polarity);
+    for (int i = 0; i < camera_count; ++i) {
+        auto& scattering = app_state->scattering_worker(i);
+        scattering.set_regions(regions);
+        scattering.set_live_mask(live_mask);
+        scattering.set_plane_sweep(runtime.scattering_plane_sweep);
+        scattering.set_tile_map(runtime.scattering_tile_map);
+        scattering.set_cluster_stats(runtime.scattering_clusters);
+        scattering.set_comparison_references(comparison_references);
+        scattering.set_event_tap(runtime.scattering_event_mode ? &cam_mgr.scattering_event_tap(i) : nullptr);
+        scattering.set_alignment(runtime.scattering_align_interval_ms, runtime.scattering_align_max_px);
+        scattering.set_confidence_target(runtime.scattering_ci_target, runtime.scattering_ci_min_frames);
+        if (!run_archive_stem.empty()) {
+            scattering.set_timeline(run_archive_stem + "_heatmap" + camera_suffix(i) + heatmap_timeline::EXTENSION,
+                                    runtime.heatmap_timeline_interval_s);
+        }
+        if (!runtime.scattering_checkpoint_file.empty()) {
+            std::filesystem::path checkpoint = runtime.scattering_checkpoint_file;
+            if (checkpoint.is_relative()) {
+                checkpoint = recording_output_directory() / checkpoint;
+            }
+            checkpoint.replace_filename(checkpoint.stem().string() + camera_suffix(i) + checkpoint.extension().string());
+            scattering.set_checkpoint(checkpoint.string(), runtime.scattering_checkpoint_interval_s,
+                                      runtime.scattering_checkpoint_resume);
+        }
+        if (reference && scattering.start(reference)) {
+            std::cout << "Headless: camera " << i << " scattering against " << runtime.headless_reference << std::endl;
+        } else if (runtime.headless_reference.empty() && runtime.scattering_reference_frames > 0) {
+            scattering.start_building(runtime.scattering_reference_frames, runtime.scattering_reference_occupancy);
+        }
+    }
+
+    // After the pipeline threads start, so none of them inherits the UI core
+    core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::UI);
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    const auto capture_interval = std::chrono::seconds(std::max(runtime.headless_capture_interval_s, 0));
+    Clock::time_point next_capture = start + capture_interval;
+    Clock::time_point next_status = start + std::chrono::seconds(10);
+    Clock::time_point last_status = start;
+
+    struct HeadlessCamera {
+        video::FrameRef latest;  // Also pins the frame the next periodic capture saves
+        uint64_t frames = 0;
+        uint64_t last_events = 0;
+        size_t flags_logged = 0;  // Hot-pixel flags already logged
+        size_t defects_logged = 0;  // Line defects already logged
+    };
+    std::vector<video::FlaggedPixel> flagged;
+    std::vector<video::LineDefect> defects;
+    std::vector<HeadlessCamera> cameras(static_cast<size_t>(camera_count));
+    for (int i = 0; i < camera_count; ++i) {
+        cameras[i].last_events = cam_mgr.get_event_count(i);
+    }
+
+    // Lifetime statistics per sensor serial (replay has none)
+    std::vector<std::unique_ptr<video::PixelLifetimeStats>> lifetime(static_cast<size_t>(camera_count));
+    if (!runtime.lifetime_stats_directory.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(runtime.lifetime_stats_directory, ec);
+        for (int i = 0; i < std::min(camera_count, cam_mgr.num_cameras()); ++i) {
+            const std::string& serial = cam_mgr.get_camera(i).serial;
+            const std::filesystem::path path = std::filesystem::path(runtime.lifetime_stats_directory) /
+                                               video::PixelLifetimeStats::file_name(serial);
+            const cv::Size size = cam_mgr.get_frame_size(i);
+            auto stats = std::make_unique<video::PixelLifetimeStats>();
+            if (stats->open(path.string(), serial, size.width, size.height)) {
+                std::cout << "Headless: camera " << i << " lifetime statistics " << path.string() << " ("
+                          << stats->header().sessions << " earlier sessions)" << std::endl;
+                lifetime[i] = std::move(stats);
+            }
+        }
+    }
+    std::vector<uint32_t> session_toggles;
+    auto merge_lifetime = [&]() {
+        const int64_t exposure_us =
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        for (int i = 0; i < camera_count; ++i) {
+            if (!lifetime[i]) {
+                continue;
+            }
+            video::PixelLifetimeStats::SessionTotals totals;
+            totals.exposure_us = exposure_us;
+            auto snapshot = app_state->scattering_worker(i).get_snapshot();
+            if (snapshot) {
+                totals.scattering = &snapshot->scattering_count;
+            }
+            if (cam_mgr.pixel_toggles(i).is_enabled()) {
+                cam_mgr.pixel_toggles(i).get_session_toggles(session_toggles);
+                totals.toggles = &session_toggles;
+            }
+            if (cam_mgr.pixel_rates(i).is_enabled()) {
+                cam_mgr.pixel_rates(i).get_flagged(flagged);
+                for (const auto& pixel : flagged) {
+                    totals.hot_pixels.emplace_back(pixel.x, pixel.y);
+                }
+            }
+            lifetime[i]->merge(totals);
+        }
+    };
+    const auto lifetime_interval = std::chrono::seconds(std::max(runtime.lifetime_checkpoint_s, 0));
+    Clock::time_point next_lifetime = start + lifetime_interval;
+
+    std::cout << "Headless: running";
+    if (camera_count > 1) {
+        std::cout << " " << camera_count << " cameras";
+    }
+    if (runtime.headless_duration_s > 0) {
+        std::cout << " for " << runtime.headless_duration_s << " s";
+    }
+    if (capture_interval.count() > 0) {
+        std::cout << ", capture every " << capture_interval.count() << " s";
+    }
+    std::cout << " (Ctrl+C to stop)" << std::endl;
+
+    while (!stop_requested && app_state->is_running()) {
+        // Paced by camera 0; the others are drained without waiting
+        for (int i = 0; i < camera_count; ++i) {
+            auto& frame_buffer = app_state->frame_buffer(i);
+            if (i > 0 || frame_buffer.wait_for_frame(0, 100000)) {
+                if (auto frame_opt = frame_buffer.consume_frame()) {
+                    cameras[i].latest = std::move(*frame_opt);
+                    ++cameras[i].frames;
+                }
+            }
+        }
+
+        sample_station_metrics();
+        report_fleet_metrics();
+        update_antiflicker_auto();
+        const Clock::time_point now = Clock::now();
+
+        // Hot pixels as they are flagged, not only in the final list
+        for (int i = 0; i < camera_count; ++i) {
+            auto& monitor = cam_mgr.pixel_rates(i);
+            if (!monitor.is_enabled() || static_cast<size_t>(monitor.get_flagged_count()) <= cameras[i].flags_logged) {
+                continue;
+            }
+            monitor.get_flagged(flagged);
+            for (size_t f = cameras[i].flags_logged; f < flagged.size(); ++f) {
+                core::LogLine(core::LogLevel::Warning)
+                    << "Hot pixel: camera " << i << " (" << flagged[f].x << ", " << flagged[f].y << ") at "
+                    << flagged[f].flagged_ts / 1000 << " ms, " << flagged[f].events_per_s << " ev/s vs "
+                    << flagged[f].neighbour_events_per_s << " ev/s around it";
+            }
+            cameras[i].flags_logged = std::max(flagged.size(), static_cast<size_t>(monitor.get_flagged_count()));
+        }
 
-    } catch (const std::exception& e) {
-        std::cerr << "Camera initialization error: " << e.what() << std::endl;
-        return false;
-    }
-}
+        // Line defects as they are reported
+        for (int i = 0; i < camera_count; ++i) {
+            auto& detector = cam_mgr.line_defects(i);
+            if (!detector.is_enabled() ||
+                static_cast<size_t>(detector.get_defect_count()) <= cameras[i].defects_logged) {
+                continue;
+            }
+            detector.get_defects(defects);
+            for (size_t d = cameras[i].defects_logged; d < defects.size(); ++d) {
+                core::LogLine(core::LogLevel::Warning)
+                    << "Line defect: camera " << i << (defects[d].column ? " column " : " row ") << defects[d].index
+                    << " at " << defects[d].first_ts / 1000 << " ms, " << defects[d].fill * 100.0f << " % set in "
+                    << defects[d].frames_flagged << " frames";
+            }
+            cameras[i].defects_logged = std::max(defects.size(), static_cast<size_t>(detector.get_defect_count()));
+        }
 
-// ============================================================================
-// UI Rendering
-// ============================================================================
+        if (capture_interval.count() > 0 && now >= next_capture) {
+            next_capture += capture_interval;
+            for (int i = 0; i < camera_count; ++i) {
+                const video::FrameRef& latest = cameras[i].latest;
+                if (latest.empty()) {
+                    continue;
+                }
+                ImageManager::ImageMetadata metadata = ImageManager::create_metadata(latest, "Headless periodic capture");
+                stamp_capture_time(metadata, latest.timing());
+                const std::string path = ImageManager::save_image_async(
+                    latest, metadata, config.camera_settings().capture_directory, "headless" + camera_suffix(i));
+                if (path.empty()) {
+                    std::cerr << "Headless: capture skipped (save queue full)" << std::endl;
+                }
+            }
+        }
 
-/**
- * Render simple status panel
- */
-void render_status_panel() {
-    ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
-    ImGui::SetNextWindowSize(ImVec2(280, 120), ImGuiCond_FirstUseEver);
+        if (now >= next_status) {
+            const double elapsed = std::chrono::duration<double>(now - last_status).count();
+            for (int i = 0; i < camera_count; ++i) {
+                HeadlessCamera& camera = cameras[i];
+                const uint64_t events = cam_mgr.get_event_count(i);
+                std::cout << "Headless: ";
+                if (camera_count > 1) {
+                    std::cout << "camera " << i << ": ";
+                }
+                std::cout << camera.frames << " frames, "
+                          << (events - camera.last_events) / elapsed / 1e6 << " Mev/s, "
+                          << cam_mgr.get_dropped_events(i) << " events dropped";
+                if (cam_mgr.get_latency_budget_ms() > 0) {
+                    std::cout << ", " << cam_mgr.get_shed_windows(i) << " windows shed (lag "
+                              << cam_mgr.get_latency_lag_us(i) / 1000 << " ms)";
+                }
+                if (cam_mgr.pixel_rates(i).is_enabled()) {
+                    std::cout << ", " << cam_mgr.pixel_rates(i).get_flagged_count() << " hot pixels";
+                }
+                for (int level = 0; level < cam_mgr.get_window_levels(); ++level) {
+                    std::cout << (level == 0 ? ", active " : " / ") << cam_mgr.get_window_us(level) / 1000.0 << " ms "
+                              << window_views[i][level].active_percent.load(std::memory_order_relaxed) << " %";
+                }
+                auto& scattering = app_state->scattering_worker(i);
+                if (scattering.is_building_reference()) {
+                    std::cout << ", building scattering reference";
+                } else if (scattering.is_running()) {
+                    if (auto snapshot = scattering.get_snapshot()) {
+                        std::cout << ", scattering " << snapshot->current_scattering_percentage << " %, "
+                                  << snapshot->average_scattering_per_frame << " +/- "
+                                  << snapshot->scattering_ci_half_width << " px/frame";
+                        if (runtime.scattering_clusters) {
+                            std::cout << ", " << snapshot->clusters.clusters << " clusters (largest "
+                                      << snapshot->clusters.largest_pixels << " px)";
+                        }
+                        if (snapshot->reference_offset != cv::Point(0, 0)) {
+                            std::cout << " (reference offset " << snapshot->reference_offset.x << ", "
+                                      << snapshot->reference_offset.y << ")";
+                        }
+                        for (const auto& region : snapshot->regions) {
+                            std::cout << "\n  " << region.name << ": " << region.scattering_percentage
+                                      << " % scattering, " << region.missing_percentage << " % missing";
+                        }
+                        for (const auto& compared : snapshot->references) {
+                            std::cout << "\n  vs " << compared.name << ": " << compared.scattering_percentage
+                                      << " % scattering, " << compared.missing_percentage << " % missing, "
+                                      << compared.average_scattering_per_frame << " px/frame";
+                        }
+                    }
+                }
+                std::cout << std::endl;
+                camera.last_events = events;
+            }
+            last_status = now;
+            next_status = now + std::chrono::seconds(10);
+        }
 
-    ImGui::Begin("Status");
+        if (lifetime_interval.count() > 0 && now >= next_lifetime) {
+            next_lifetime += lifetime_interval;
+            merge_lifetime();
+        }
 
-    // Help button
-    if (ImGui::Button("Help [F1]", ImVec2(-1, 25))) {
-        show_help_window = !show_help_window;
+        if (runtime.headless_duration_s > 0 && now - start >= std::chrono::seconds(runtime.headless_duration_s)) {
+            break;
+        }
+        if (runtime.scattering_ci_target > 0.0f && scattering_converged(*app_state, camera_count)) {
+            std::cout << "Headless: scattering rate converged after "
+                      << std::chrono::duration_cast<std::chrono::seconds>(now - start).count() << " s" << std::endl;
+            break;
+        }
+        if (cam_mgr.is_replay() && cam_mgr.replay()->is_finished()) {
+            break;
+        }
+        if (soak_monitor.is_failed()) {
+            break;   // The verdict is in; more hours add nothing
+        }
     }
 
-    ImGui::Separator();
-
-    // Camera status
-    ImGui::Text("Camera:");
-    ImGui::SameLine(100);
-    auto& cam_mgr = CameraManager::instance();
-    if (cam_mgr.is_camera_connected(0)) {
-        ImGui::TextColored(ImVec4(0, 1, 0, 1), "Connected");
-    } else {
-        ImGui::TextColored(ImVec4(1, 0, 0, 1), "Disconnected");
+    // Events of known hot pixels never ingested
+    for (int i = 0; i < camera_count; ++i) {
+        const auto& pixel_mask = cam_mgr.pixel_mask(i);
+        if (!pixel_mask.is_enabled()) {
+            continue;
+        }
+        std::cout << "Camera " << i << ": " << pixel_mask.get_suppressed() << " hot pixel events dropped at ingestion ("
+                  << pixel_mask.get_masked_pixels() << " pixels";
+        if (i < core::AppState::MAX_CAMERAS && hardware_masked_pixels[i] > 0) {
+            std::cout << ", " << hardware_masked_pixels[i] << " more masked in the sensor";
+        }
+        std::cout << ")" << std::endl;
     }
 
-    // Binary bit configuration
-    ImGui::Text("Binary Bits:");
-    ImGui::SameLine(100);
-    if (app_state) {
-        int bit1 = static_cast<int>(app_state->display_settings().get_binary_stream_mode());
-        int bit2 = static_cast<int>(app_state->display_settings().get_binary_stream_mode_2());
-        ImGui::Text("%d, %d", bit1, bit2);
+    if (core::QosScheduler::instance().is_enabled()) {
+        const auto& qos = core::QosScheduler::instance();
+        std::cout << "QoS shed:";
+        for (int w = 0; w < core::QosScheduler::WORK_COUNT; ++w) {
+            const auto work = static_cast<core::QosScheduler::Work>(w);
+            std::cout << " " << core::QosScheduler::work_name(work) << " " << qos.get_shed(work);
+        }
+        std::cout << std::endl;
     }
 
-    ImGui::End();
-}
+    const auto& budget = core::MemoryBudget::instance();
+    if (budget.get_evicted_bytes() > 0 || budget.get_refused() > 0) {
+        std::cout << "Memory budget: " << budget.get_evicted_bytes() / (1024 * 1024) << " MB evicted, "
+                  << budget.get_refused() << " producer start(s) refused" << std::endl;
+    }
 
-/**
- * Render camera viewer (single viewer with all controls)
- */
-void render_camera_views() {
-    ImGui::SetNextWindowPos(ImVec2(310, 20), ImGuiCond_FirstUseEver);
-    ImGui::SetNextWindowSize(ImVec2(900, 800), ImGuiCond_FirstUseEver);
+    if (core::FlightRecorder::instance().get_dumps() > 0) {
+        std::cout << "Flight recorder: " << core::FlightRecorder::instance().get_dumps() << " stall dump(s), last "
+                  << core::FlightRecorder::instance().get_last_dump() << std::endl;
+    }
 
-    ImGui::Begin("Camera View", nullptr, ImGuiWindowFlags_NoScrollbar);
+    // Utilization is as of the last one-second sample
+    for (const StageGraph::StageStats& stage : stage_graph.get_stats()) {
+        std::cout << "Stage " << stage.name << " (" << stage.kind << ", " << StageGraph::executor_name(stage.executor)
+                  << "): " << stage.processed << " processed, " << stage.dropped << " dropped, "
+                  << static_cast<int>(stage.utilization + 0.5) << "% busy, queue "
+                  << stage.queued << "/" << stage.capacity << std::endl;
+    }
 
-    // Get camera texture info
-    GLuint camera_tex_id = 0;
-    int cam_width = 0;
-    int cam_height = 0;
-    if (app_state && app_state->texture_manager(0).get_texture_id() > 0) {
-        camera_tex_id = app_state->texture_manager(0).get_texture_id();
-        cam_width = app_state->texture_manager(0).get_width();
-        cam_height = app_state->texture_manager(0).get_height();
+    // Every hot pixel flagged during the run
+    for (int i = 0; i < camera_count; ++i) {
+        auto& monitor = cam_mgr.pixel_rates(i);
+        if (!monitor.is_enabled()) {
+            continue;
+        }
+        monitor.get_flagged(flagged);
+        const std::filesystem::path path = std::filesystem::path(config.camera_settings().capture_directory) /
+                                           ("flagged_pixels" + camera_suffix(i) + ".csv");
+        std::ofstream file(path);
+        file << "x,y,flagged_ts_us,events_per_s,neighbour_events_per_s\n";
+        for (const auto& pixel : flagged) {
+            file << pixel.x << "," << pixel.y << "," << pixel.flagged_ts << "," << pixel.events_per_s << ","
+                 << pixel.neighbour_events_per_s << "\n";
+        }
+        std::cout << monitor.get_flagged_count() << " hot pixels flagged";
+        if (monitor.get_known_count() > 0) {
+            std::cout << " (" << monitor.get_known_count() << " known from calibration not counted)";
+        }
+        std::cout << ", written to " << path.string() << std::endl;
     }
 
-    // Render viewer (includes image display, noise analysis, and filters)
-    if (viewer) {
-        viewer->render(camera_bits.combined, camera_tex_id, cam_width, cam_height);
+    // Every row and column reported during the run
+    for (int i = 0; i < camera_count; ++i) {
+        auto& detector = cam_mgr.line_defects(i);
+        if (!detector.is_enabled()) {
+            continue;
+        }
+        detector.get_defects(defects);
+        const std::filesystem::path path = std::filesystem::path(config.camera_settings().capture_directory) /
+                                           ("line_defects" + camera_suffix(i) + ".csv");
+        std::ofstream file(path);
+        file << "kind,index,first_ts_us,last_ts_us,frames_flagged,streak,fill\n";
+        for (const auto& defect : defects) {
+            file << (defect.column ? "column" : "row") << "," << defect.index << "," << defect.first_ts << ","
+                 << defect.last_ts << "," << defect.frames_flagged << "," << defect.streak << "," << defect.fill << "\n";
+        }
+        std::cout << detector.get_defect_count() << " line defects in " << detector.get_frames_processed()
+                  << " frames, written to " << path.string() << std::endl;
     }
 
-    ImGui::End();
-}
+    // Latency maps to the trigger onsets: every mapped pixel, with the array-wide figures
+    for (int i = 0; i < camera_count; ++i) {
+        auto& latency = cam_mgr.trigger_latency(i);
+        if (!latency.is_enabled()) {
+            continue;
+        }
+        cv::Mat mean_us;
+        cv::Mat jitter_us;
+        video::TriggerLatencyMap::Summary summary;
+        if (!latency.build_maps(config.camera_settings().trigger_latency_min_cycles, mean_us, jitter_us, summary)) {
+            std::cout << "Trigger latency: no onsets seen" << std::endl;
+            continue;
+        }
+        const std::filesystem::path path = std::filesystem::path(config.camera_settings().capture_directory) /
+                                           ("trigger_latency" + camera_suffix(i) + ".csv");
+        std::ofstream file(path);
+        file << "x,y,mean_us,jitter_us\n";
+        for (int y = 0; y < mean_us.rows; ++y) {
+            const float* mean_row = mean_us.ptr<float>(y);
+            const float* jitter_row = jitter_us.ptr<float>(y);
+            for (int x = 0; x < mean_us.cols; ++x) {
+                if (!std::isnan(mean_row[x])) {
+                    file << x << "," << y << "," << mean_row[x] << "," << jitter_row[x] << "\n";
+                }
+            }
+        }
+        std::cout << "Trigger latency: " << summary.cycles << " onsets, " << summary.pixels << " pixels mapped, mean "
+                  << summary.mean_us << " us (median " << summary.median_us << ", p95 " << summary.p95_us
+                  << "), jitter " << summary.mean_jitter_us << " us, written to " << path.string() << std::endl;
+    }
 
-/**
- * Render help window
- */
-void render_help_window() {
-    if (!show_help_window) return;
+    // Pixel classes of the last toggle window
+    for (int i = 0; i < camera_count; ++i) {
+        auto& analyzer = cam_mgr.pixel_toggles(i);
+        if (!analyzer.is_enabled()) {
+            continue;
+        }
+        const video::ToggleClasses classes = analyzer.get_classes();
+        std::cout << "Pixel toggles" << (camera_count > 1 ? " (camera " + std::to_string(i) + ")" : std::string())
+                  << ": " << classes.stuck << " stuck, " << classes.flickering << " flickering, " << classes.normal
+                  << " normal over the last " << classes.window_frames << " frames (" << classes.windows
+                  << " windows)" << std::endl;
+    }
 
-    ImGui::SetNextWindowPos(ImVec2(400, 100), ImGuiCond_FirstUseEver);
-    ImGui::SetNextWindowSize(ImVec2(800, 600), ImGuiCond_FirstUseEver);
+    // The session's totals go into each sensor's lifetime file before the pipelines are torn down
+    merge_lifetime();
+    for (int i = 0; i < camera_count; ++i) {
+        if (lifetime[i]) {
+            std::cout << "Lifetime statistics: camera " << i << " at " << lifetime[i]->header().sessions
+                      << " sessions, " << lifetime[i]->header().exposure_us / 3600000000.0 << " h" << std::endl;
+            lifetime[i].reset();
+        }
+    }
 
-    if (ImGui::Begin("Help", &show_help_window)) {
-        ImGui::TextColored(ImVec4(0.5f, 1.0f, 0.5f, 1.0f), "Reliability Testing Camera - Help");
-        ImGui::Separator();
-        ImGui::Spacing();
+    // Gathered while the monitors are up; written once the camera is released for the next run
+    const bool reporting = runtime.run_report && !run_archive_stem.empty();
+    RunReport::Inputs report;
+    if (reporting) {
+        report = gather_run_report();
+    }
 
-        ImGui::TextWrapped(
-            "This application allows you to view and analyze event camera feeds for reliability testing.\n\n"
-        );
+    const int exit_code = finish_soak();
+    std::cout << "\nShutting down..." << std::endl;
+    cameras.clear();
+    shutdown_pipeline();
+    if (reporting) {
+        start_run_report(std::move(report));
+    }
 
-        if (ImGui::CollapsingHeader("Camera View", ImGuiTreeNodeFlags_DefaultOpen)) {
-            ImGui::BulletText("Active Camera: View live camera feed");
-            ImGui::BulletText("Load Image: Load a saved image for analysis");
-            ImGui::BulletText("Save Image: Save current camera frame with metadata");
+    // Voted references, reusable as headless_reference
+    for (int i = 0; i < camera_count; ++i) {
+        if (auto built = app_state->scattering_worker(i).get_built_reference()) {
+            const std::filesystem::path path = std::filesystem::path(config.camera_settings().capture_directory) /
+                                               ("scattering_reference" + camera_suffix(i) + ".png");
+            if (cv::imwrite(path.string(), *built)) {
+                std::cout << "Scattering reference saved to " << path.string() << std::endl;
+            }
         }
+    }
 
-        if (ImGui::CollapsingHeader("Image Analysis", ImGuiTreeNodeFlags_DefaultOpen)) {
-            ImGui::TextWrapped("Analyzes images to detect circular dots (signal) and measure background noise.");
-            ImGui::BulletText("Adjust detection parameters to tune sensitivity");
-            ImGui::BulletText("Run analysis to get SNR, contrast ratio, and statistics");
-            ImGui::BulletText("Export results to text file for reporting");
-            ImGui::BulletText("Run Focus Adjust: Monitor event rate in real-time");
+    // Final per-region totals (the workers published their last snapshot on stop)
+    if (!regions.empty()) {
+        for (int i = 0; i < camera_count; ++i) {
+            if (auto snapshot = app_state->scattering_worker(i).get_snapshot()) {
+                const std::filesystem::path path = std::filesystem::path(config.camera_settings().capture_directory) /
+                                                   ("scattering_regions" + camera_suffix(i) + ".csv");
+                ScatteringAnalyzer::export_regions_csv(*snapshot, path.string());
+            }
         }
+    }
 
-        if (ImGui::CollapsingHeader("Camera Settings")) {
-            ImGui::TextWrapped("Adjust camera biases and trail filter settings in real-time.");
-            ImGui::BulletText("Analog Bias Filters: Control event detection sensitivity");
-            ImGui::BulletText("ON/OFF Thresholds: Adjust brightness change sensitivity");
-            ImGui::BulletText("High-Pass Filter: Remove DC noise component");
-            ImGui::BulletText("Refractory Period: Prevent pixel re-triggering");
-            ImGui::BulletText("Trail Filter: Filter transient events and flickering");
-            ImGui::BulletText("Click 'Apply' buttons to send changes to camera");
+    // Side-by-side totals against every baseline
+    if (!comparison_references.empty()) {
+        for (int i = 0; i < camera_count; ++i) {
+            auto snapshot = app_state->scattering_worker(i).get_snapshot();
+            if (snapshot && !snapshot->references.empty()) {
+                const std::filesystem::path path = std::filesystem::path(config.camera_settings().capture_directory) /
+                                                   ("scattering_references" + camera_suffix(i) + ".csv");
+                ScatteringAnalyzer::export_references_csv(*snapshot, path.string());
+            }
         }
+    }
 
-        if (ImGui::CollapsingHeader("Binary Image Mode")) {
-            ImGui::TextWrapped(
-                "The camera extracts specific bits from the 8-bit image for reliability testing.\n"
-                "Configured in event_config.ini (binary_bit_1 and binary_bit_2).\n\n"
-                "Current configuration displayed in Status panel."
-            );
+    // How scattering is spread: isolated pixels versus blobs
+    if (runtime.scattering_clusters) {
+        for (int i = 0; i < camera_count; ++i) {
+            if (auto snapshot = app_state->scattering_worker(i).get_snapshot()) {
+                const std::filesystem::path path = std::filesystem::path(config.camera_settings().capture_directory) /
+                                                   ("scattering_clusters" + camera_suffix(i) + ".csv");
+                ScatteringAnalyzer::export_clusters_csv(*snapshot, path.string());
+            }
         }
+    }
 
-        if (ImGui::CollapsingHeader("Keyboard Shortcuts")) {
-            ImGui::BulletText("F1: Toggle this help window");
-            ImGui::BulletText("ESC: Close application");
+    // Coarse scattering density, for finding the tiles worth a per-pixel look
+    if (runtime.scattering_tile_map) {
+        for (int i = 0; i < camera_count; ++i) {
+            if (auto snapshot = app_state->scattering_worker(i).get_snapshot()) {
+                const std::filesystem::path dir(config.camera_settings().capture_directory);
+                ScatteringAnalyzer::export_tiles_csv(*snapshot, (dir / ("scattering_tiles" + camera_suffix(i) + ".csv")).string());
+                const cv::Mat tiles = ScatteringAnalyzer::create_tile_visualization(*snapshot);
+                if (!tiles.empty()) {
+                    cv::imwrite((dir / ("scattering_tiles" + camera_suffix(i) + ".png")).string(), tiles);
+                }
+            }
         }
-
-        ImGui::Spacing();
-        ImGui::Separator();
-        ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f),
-            "For detailed documentation, see README.md");
     }
-    ImGui::End();
+    if (run_report.is_busy()) {
+        std::cout << "Run report: finishing (camera already released)" << std::endl;
+    }
+    run_report.wait();
+    std::cout << "Shutdown complete" << std::endl;
+    return exit_code;
 }
 
 // ============================================================================
@@ -353,6 +3821,68 @@ int main(int argc, char* argv[]) {
         std::cerr << "Warning: Failed to load config, using defaults" << std::endl;
     }
 
+    // Command line overrides: --replay <file> [--speed <x>] [--start <seconds>]
+    //                           --headless [--duration <seconds>]
+    //                           --bias-sweep (runs headless)
+    //                           --dark-calibration (runs headless)
+    //                           --ga [--ga-resume] (runs headless)
+    //                           --aggregate (fleet aggregator, no camera)
+    //                           --soak (resource growth check, replays loop)
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--replay" && has_value) {
+            config.runtime_settings().replay_file = argv[++i];
+        } else if (arg == "--speed" && has_value) {
+            config.runtime_settings().replay_speed = std::atof(argv[++i]);
+        } else if (arg == "--start" && has_value) {
+            config.runtime_settings().replay_start_s = std::atof(argv[++i]);
+        } else if (arg == "--headless") {
+            config.runtime_settings().headless = true;
+        } else if (arg == "--dark-calibration") {
+            config.runtime_settings().dark_calibration = true;
+            config.runtime_settings().headless = true;
+        } else if (arg == "--bias-sweep") {
+            config.runtime_settings().bias_sweep = true;
+            config.runtime_settings().headless = true;
+        } else if (arg == "--ga" || arg == "--ga-resume") {
+            config.runtime_settings().ga_optimize = true;
+            config.runtime_settings().ga_resume = config.runtime_settings().ga_resume || arg == "--ga-resume";
+            config.runtime_settings().headless = true;
+        } else if (arg == "--soak") {
+            config.runtime_settings().soak = true;
+        } else if (arg == "--aggregate") {
+            config.runtime_settings().fleet_aggregate = true;
+        } else if (arg == "--duration" && has_value) {
+            config.runtime_settings().headless_duration_s = std::atoi(argv[++i]);
+        }
+    }
+
+    // A soak drives the replay at a fixed rate for as long as the run lasts
+    if (config.runtime_settings().soak && !config.runtime_settings().replay_file.empty()) {
+        config.runtime_settings().replay_loop = true;
+        if (config.runtime_settings().replay_speed <= 0.0) {
+            config.runtime_settings().replay_speed = 1.0;
+        }
+    }
+
+    apply_thread_settings();
+    tune_backends();
+
+    // Hot-path diagnostics go through the asynchronous logger from here on
+    core::Log::instance().start(config.runtime_settings().debug_mode ? core::LogLevel::Debug : core::LogLevel::Info);
+
+#if RTCAM_ALLOC_TRACKING
+    // Mat buffers come from OpenCV's allocator, not operator new
+    core::AllocTracker::install_mat_allocator();
+#endif
+
+#if RTCAM_PROFILER
+    // Profiling builds always trace; the file opens in chrome://tracing or ui.perfetto.dev
+    core::Profiler::instance().start((recording_output_directory() /
+        ("trace_" + ImageManager::generate_timestamp() + ".json")).string());
+#endif
+
     // Display capture directory
     if (!config.camera_settings().capture_directory.empty()) {
         std::cout << "Capture directory: " << config.camera_settings().capture_directory << std::endl;
@@ -370,15 +3900,143 @@ int main(int argc, char* argv[]) {
     app_state->display_settings().set_binary_stream_mode_2(
         static_cast<core::DisplaySettings::BinaryStreamMode>(config.camera_settings().binary_bit_2)
     );
+    if (config.camera_settings().time_surface_display) {
+        app_state->display_settings().set_display_mode(core::DisplaySettings::DisplayMode::TIME_SURFACE);
+    }
+    app_state->display_settings().set_time_surface_decay_us(config.camera_settings().time_surface_decay_us);
 
-    // Initialize viewer panel
-    viewer = std::make_unique<ui::ViewerPanel>("Camera Viewer");
+    // Optional metrics publishing for unattended runs
+    const auto& runtime = config.runtime_settings();
+    if (runtime.metrics_export != 0) {
+        core::MetricsExporter::Options export_options;
+        export_options.mode = static_cast<core::MetricsExporter::Mode>(runtime.metrics_export);
+        export_options.port = runtime.metrics_port;
+        export_options.statsd_host = runtime.metrics_statsd_host;
+        export_options.statsd_port = runtime.metrics_statsd_port;
+        export_options.interval_ms = runtime.metrics_interval_ms;
+        export_options.prefix = runtime.metrics_prefix;
+        metrics_exporter.start(export_options);
+    }
+    if (runtime.fleet_aggregate) {
+        return run_aggregator();
+    }
+    if (runtime.stream_enabled) {
+        video::FrameStreamer::Options stream_options;
+        stream_options.port = runtime.stream_port;
+        stream_options.max_fps = runtime.stream_max_fps;
+        stream_options.max_clients = runtime.stream_max_clients;
+        frame_streamer.start(stream_options);
+    }
+    if (runtime.fleet_report) {
+        core::FleetReporter::Options fleet_options;
+        fleet_options.host = runtime.fleet_host;
+        fleet_options.port = runtime.fleet_port;
+        fleet_options.station = runtime.fleet_station;
+        fleet_reporter.start(fleet_options);
+    }
 
-    // Initialize camera
-    bool camera_connected = initialize_camera();
-    if (!camera_connected) {
-        std::cerr << "Warning: Camera not connected. Running in simulation mode." << std::endl;
+    // Relative history files live next to the recordings
+    std::filesystem::path trend_path = runtime.trend_history_file;
+    if (!trend_path.empty() && trend_path.is_relative()) {
+        trend_path = recording_output_directory() / trend_path;
+    }
+    trend_store.start(trend_path.string());
+    if (!runtime.run_log_directory.empty()) {
+        std::filesystem::path run_log_dir = runtime.run_log_directory;
+        if (run_log_dir.is_relative()) {
+            run_log_dir = recording_output_directory() / run_log_dir;
+        }
+        run_archive_stem = (run_log_dir / ("run_" + ImageManager::generate_timestamp())).string();
+        run_started = std::chrono::steady_clock::now();
+        core::RunLog::instance().open(run_archive_stem + ".runlog");
+    }
+    if (runtime.flight_recorder) {
+        std::filesystem::path flight_dir = runtime.flight_directory;
+        if (flight_dir.is_relative()) {
+            flight_dir = recording_output_directory() / flight_dir;
+        }
+        core::FlightRecorder::Options flight_options;
+        flight_options.directory = flight_dir.string();
+        flight_options.window_s = runtime.flight_window_s;
+        flight_options.spike_ms = runtime.flight_spike_ms;
+        flight_options.gap_ms = runtime.replay_file.empty() ? runtime.flight_gap_ms : 0;   // Replay pauses and ends
+        flight_options.cooldown_s = runtime.flight_cooldown_s;
+
+        // The effective configuration of this run goes beside every dump
+        std::error_code error;
+        std::filesystem::create_directories(flight_dir, error);
+        const std::string config_path = (flight_dir / "flight_config.ini").string();
+        if (config.save(config_path)) {
+            flight_options.config_path = config_path;
+        }
+        core::FlightRecorder::instance().start(flight_options);
+    }
+    {
+        const auto& cam_settings = config.camera_settings();
+        core::QosScheduler::Options qos_options;
+        qos_options.enabled = cam_settings.qos_enabled;
+        qos_options.latency_ms = cam_settings.qos_latency_ms;
+        qos_options.queue_percent = cam_settings.qos_queue_percent;
+        qos_options.decimation = cam_settings.qos_decimation;
+        qos_options.hold_ms = cam_settings.qos_hold_ms;
+        core::QosScheduler::instance().configure(qos_options);
     }
+    start_analyzer_plugins();
+    start_pipeline_stages(!(runtime.headless || runtime.bias_sweep || runtime.ga_optimize || runtime.dark_calibration));
+    if (runtime.soak) {
+        core::SoakMonitor::Options soak_options;
+        soak_options.interval_s = runtime.soak_interval_s;
+        soak_options.warmup_s = runtime.soak_warmup_s;
+        soak_options.max_rss_growth_mb = runtime.soak_max_rss_growth_mb;
+        soak_options.max_private_growth_mb = runtime.soak_max_private_growth_mb;
+        soak_options.max_handle_growth = runtime.soak_max_handle_growth;
+        soak_options.max_gl_growth = runtime.soak_max_gl_growth;
+        soak_options.csv_path = run_archive_stem.empty()
+            ? (recording_output_directory() / ("soak_" + ImageManager::generate_timestamp() + ".csv")).string()
+            : run_archive_stem + "_soak.csv";
+        soak_options.throughput_counters = {"events.ingested", "events.dropped", "frames.generated",
+                                            "frames.displayed", "frames.dropped.queue", "run_log.rows"};
+        for (const StageGraph::StageStats& stage : stage_graph.get_stats()) {
+            soak_options.throughput_counters.push_back("stage." + stage.name + ".processed");
+        }
+        soak_monitor.start(soak_options);
+        std::cout << "Soak: sampling every " << runtime.soak_interval_s << " s to " << soak_options.csv_path
+                  << ", baseline after " << runtime.soak_warmup_s << " s" << std::endl;
+    }
+    ImageCache::instance().configure(static_cast<size_t>(std::max(config.camera_settings().image_cache_mb, 0)) << 20,
+                                     config.camera_settings().image_prefetch);
+    core::MemoryBudget::instance().configure(static_cast<size_t>(std::max(config.camera_settings().memory_budget_mb, 0)) << 20);
+    register_memory_consumers();
+    if (config.camera_settings().capture_catalog) {
+        CaptureCatalog::instance().open(config.camera_settings().capture_directory,
+                                        config.camera_settings().catalog_threads);
+    }
+
+    // Headless runs have nothing to overlap with, so they open the camera in line
+    if (runtime.headless || runtime.bias_sweep || runtime.ga_optimize || runtime.dark_calibration) {
+        return run_headless(initialize_camera());
+    }
+
+    // Scrub-back history for the viewer (camera 0 only; headless runs have nothing to scrub)
+    app_state->frame_history(0).configure(config.camera_settings().history_s,
+                                          static_cast<size_t>(std::max(config.camera_settings().history_max_mb, 0)) << 20);
+
+    // Camera open and bias programming take seconds; do them while the window and GL context come up
+    std::future<bool> camera_ready = std::async(std::launch::async, [] {
+        if (!initialize_camera()) {
+            return false;
+        }
+        auto& cam_mgr = CameraManager::instance();
+        if (!cam_mgr.is_replay()) {
+            for (int i = 0; i < cam_mgr.num_cameras(); ++i) {
+                apply_initial_camera_settings(i);
+            }
+        }
+        return true;
+    });
+
+    // Initialize viewer panel
+    viewer = std::make_unique<ui::ViewerPanel>("Camera Viewer");
 
     // Initialize GLFW
     glfwSetErrorCallback(glfw_error_callback);
@@ -400,13 +4058,40 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     glfwMakeContextCurrent(window);
-    glfwSwapInterval(1); // Enable vsync
+
+    // Low latency: no vsync wait in the swap; the scheduler paces presents to the refresh instead
+    const bool low_latency_present = config.runtime_settings().low_latency_present;
+    glfwSwapInterval(low_latency_present ? 0 : 1);
+    const GLFWvidmode* video_mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+
+    // The loop waits in glfwWaitEventsTimeout; frame callbacks end the wait with an empty event
+    ui_scheduler.set_rates(config.runtime_settings().ui_max_fps, config.runtime_settings().ui_idle_fps);
+    ui_scheduler.set_present_pacing(low_latency_present, video_mode ? video_mode->refreshRate : 0);
+    ui_scheduler.set_event_functions(
+        [](double timeout_s) {
+            if (timeout_s > 0.0) glfwWaitEventsTimeout(timeout_s);
+            else glfwPollEvents();
+        },
+        [] { glfwPostEmptyEvent(); });
 
     // Initialize GLEW
     if (glewInit() != GLEW_OK) {
         std::cerr << "Failed to initialize GLEW" << std::endl;
         return 1;
     }
+    video::gpu::set_program_cache_directory(config.runtime_settings().shader_cache);
+
+    // Timer passes never overlap, so one elapsed-time query is open at a time
+    gpu_pass_upload = gpu_timer.add_pass("upload");
+    gpu_pass_compute = gpu_timer.add_pass("compute");
+    gpu_pass_shader = gpu_timer.add_pass("shader");
+    gpu_pass_imgui = gpu_timer.add_pass("imgui");
+    for (const auto& pass : gpu_timer.get_passes()) {
+        gpu_pass_metrics.push_back(&core::MetricsRegistry::instance().histogram("gpu." + pass.name + "_us"));
+    }
+    if (!video::gpu::GPUPassTimer::is_supported()) {
+        std::cout << "GPU timer queries unavailable (need OpenGL 3.3 or ARB_timer_query)" << std::endl;
+    }
 
     // Setup ImGui
     IMGUI_CHECKVERSION();
@@ -420,48 +4105,141 @@ int main(int argc, char* argv[]) {
 
     std::cout << "UI initialized successfully" << std::endl;
 
-    // Start camera if connected
-    if (camera_connected) {
-        std::cout << "\nStarting camera..." << std::endl;
+    // Clicking a thumbnail loads the capture into the viewer
+    gallery = std::make_unique<ui::CaptureGallery>(config.camera_settings().gallery_threads,
+        [](const std::string& path) {
+            if (viewer) {
+                viewer->open_image(path);
+            }
+        });
 
-        auto& cam_mgr = CameraManager::instance();
-        auto callback = [](const cv::Mat& frame, int camera_index) {
-            process_camera_frame(frame);
-        };
+    // Timelines are written by headless runs into the run log directory
+    heatmap_timeline_panel = std::make_unique<ui::HeatmapTimelinePanel>(
+        !run_archive_stem.empty() ? std::filesystem::path(run_archive_stem).parent_path().string()
+                                  : recording_output_directory().string());
+
+    // GPU pipeline needs compute shaders, which the 3.0 context hint doesn't guarantee
+    if (config.runtime_settings().gpu_pipeline) {
+        if (video::gpu::GPUBinaryPipeline::is_supported()) {
+            gpu_pipeline = std::make_unique<video::gpu::GPUBinaryPipeline>();
+            gpu_pipeline->set_binary_readback(true);  // Viewer analysis still needs a CPU copy
+            gpu_pipeline_active = true;
+        } else {
+            std::cerr << "GPU pipeline requires OpenGL 4.3, using CPU path" << std::endl;
+        }
+    }
+
+    // Shader display covers GL 3.0 contexts; the GPU pipeline already displays its own result
+    if (config.runtime_settings().shader_display && !gpu_pipeline_active) {
+        if (video::gpu::GPUBinaryDisplay::is_supported()) {
+            shader_display = std::make_unique<video::gpu::GPUBinaryDisplay>();
+            shader_display_active = true;
+        } else {
+            std::cerr << "Shader display requires OpenGL 3.0, using CPU path" << std::endl;
+        }
+    }
+
+    // Start camera if connected (already configured by the worker)
+    bool camera_connected = camera_ready.get();
+    if (!camera_connected) {
+        std::cerr << "Warning: Camera not connected. Running in simulation mode." << std::endl;
+    }
 
-        if (!cam_mgr.start_single_camera(callback)) {
-            std::cerr << "Failed to start camera" << std::endl;
-            camera_connected = false;
+    // Event scatter replaces the frame upload; the other GPU backends display their own result
+    if (config.runtime_settings().gpu_event_scatter && !gpu_pipeline_active && !shader_display_active &&
+        camera_connected) {
+        if (video::gpu::GPUEventScatter::is_supported()) {
+            gpu_event_scatter = std::make_unique<video::gpu::GPUEventScatter>();
+            CameraManager::instance().set_event_scatter(true);  // Before the accumulation threads start
         } else {
-            std::cout << "Camera started successfully" << std::endl;
-            apply_initial_camera_settings();
+            std::cerr << "GPU event scatter requires OpenGL 4.4, using CPU path" << std::endl;
         }
     }
+    if (camera_connected) {
+        warm_up_pipeline(true);
+        camera_connected = start_camera(true);
+    }
+
+    // After the pipeline threads start, so none of them inherits the UI core
+    core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::UI);
 
     // Main loop
     std::cout << "\nEntering main loop..." << std::endl;
+    const bool use_triple_buffer = config.runtime_settings().triple_buffer_display;
+    const bool use_gpu_pipeline = gpu_pipeline_active && !CameraManager::instance().is_native_binary();
+    const bool use_shader_display = shader_display_active;
+    const bool use_event_scatter = gpu_event_scatter != nullptr;
+    std::cout << "Display backend: "
+              << (use_gpu_pipeline ? "GPU pipeline" : use_event_scatter ? "GPU event scatter" :
+                  use_shader_display ? "shader" :
+                  use_triple_buffer ? "triple-buffered" : "synchronous")
+              << std::endl;
+    if (!use_gpu_pipeline) {
+        gpu_pipeline_active = false;  // Native binary frames need no extraction
+    }
+    DisplayBackend display_backend;
+    display_backend.gpu_pipeline = use_gpu_pipeline;
+    display_backend.event_scatter = use_event_scatter;
+    display_backend.shader = use_shader_display;
+    display_backend.triple_buffer = use_triple_buffer;
+
+    // The triple buffer picks its texture before the UI is drawn, so a late frame could not replace it
+    const bool late_latch = low_latency_present && config.runtime_settings().late_latch && !use_triple_buffer;
+    if (low_latency_present) {
+        std::cout << "Low-latency presentation" << (late_latch ? " with late latch" : "") << std::endl;
+    }
 
     try {
         while (!glfwWindowShouldClose(window)) {
-            glfwPollEvents();
+            {
+                PROFILE_ZONE("ui.wait");
+                ui_scheduler.wait_for_next_frame(glfwGetWindowAttrib(window, GLFW_ICONIFIED) != 0);
+            }
+            {
+                PROFILE_ZONE("ui.gpu_stages");
+                stage_graph.run_gpu(2000);   // At most 2 ms, so a backed-up stage never stalls the display
+            }
 
             // Start ImGui frame
             ImGui_ImplOpenGL3_NewFrame();
             ImGui_ImplGlfw_NewFrame();
             ImGui::NewFrame();
 
+            // Latency trace of the frame displayed this iteration
+            DisplayedFrame shown;
+
+            // The surface is only maintained while shown (the GPU pipeline displays its own texture)
+            const bool time_surface_view = camera_connected && app_state && !use_gpu_pipeline && !use_shader_display &&
+                !use_event_scatter && app_state->display_settings().get_display_mode() == core::DisplaySettings::DisplayMode::TIME_SURFACE;
+
             // Update texture from frame buffer
             if (camera_connected && app_state) {
-                auto frame_opt = app_state->frame_buffer(0).consume_frame();
-                if (frame_opt.has_value()) {
-                    app_state->texture_manager(0).upload_frame(frame_opt.value());
+                PROFILE_ZONE("ui.update_display");
+                CameraManager::instance().time_surface().set_enabled(time_surface_view);
+
+                latch_display_frame(display_backend, time_surface_view, shown);
+
+                if (use_gpu_pipeline) {
+                    // Never overwrite a binary image the viewer still shares
+                    if (!camera_bits.combined.empty() && camera_bits.combined.u->refcount > 1) {
+                        camera_bits.combined.release();
+                    }
+                    gpu_pipeline->read_binary(camera_bits.combined);
+                } else if (use_triple_buffer) {
+                    gpu_timer.begin(gpu_pass_upload);
+                    app_state->triple_buffer_renderer(0).update();
+                    gpu_timer.end();
+                    if (shown.consumed_us != 0) {
+                        shown.uploaded_us = core::LatencyStats::now_us();
+                    }
                 }
 
                 // Update event count for the viewer panel chart
                 // The camera manager's get_event_count returns cumulative count
                 // The viewer's update_event_count expects incremental count
                 // So we pass the cumulative count and let the viewer handle it
-                if (viewer) {
+                // A shed update leaves last_count alone, so the next one carries the events
+                if (viewer && core::QosScheduler::instance().admit(core::QosScheduler::Work::Chart)) {
                     static uint64_t last_count = 0;
                     uint64_t current_count = CameraManager::instance().get_event_count();
                     uint64_t event_delta = current_count - last_count;
@@ -470,19 +4248,49 @@ int main(int argc, char* argv[]) {
                 }
             }
 
+            sample_station_metrics();
+            report_fleet_metrics();
+            update_antiflicker_auto();
+            collect_gpu_timing();
+
             // Render UI
             render_status_panel();
             render_camera_views();
             render_help_window();
+            render_gpu_timing_overlay();
+            if (gallery) {
+                gallery->render(&show_gallery);
+            }
+            if (heatmap_timeline_panel) {
+                heatmap_timeline_panel->render(&show_heatmap_timeline);
+            }
 
             // Handle keyboard shortcuts
             if (ImGui::IsKeyPressed(ImGuiKey_F1)) {
                 show_help_window = !show_help_window;
             }
+            if (ImGui::IsKeyPressed(ImGuiKey_F2)) {
+                show_gpu_timing = !show_gpu_timing;
+            }
+            if (ImGui::IsKeyPressed(ImGuiKey_F3)) {
+                show_gallery = !show_gallery;
+            }
+            if (ImGui::IsKeyPressed(ImGuiKey_F4)) {
+                show_heatmap_timeline = !show_heatmap_timeline;
+            }
             if (ImGui::IsKeyPressed(ImGuiKey_Escape)) {
                 glfwSetWindowShouldClose(window, true);
             }
 
+            // Late latch: a frame stored while the UI was built replaces the one uploaded above
+            if (late_latch && camera_connected && app_state && app_state->frame_buffer(0).has_unconsumed_frame()) {
+                PROFILE_ZONE("ui.late_latch");
+                const bool replaced = shown.consumed_us != 0;
+                if (latch_display_frame(display_backend, time_surface_view, shown) && replaced) {
+                    frames_late_latched_metric.add();
+                }
+            }
+
             // Rendering
             ImGui::Render();
             int display_w, display_h;
@@ -490,9 +4298,38 @@ int main(int argc, char* argv[]) {
             glViewport(0, 0, display_w, display_h);
             glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
             glClear(GL_COLOR_BUFFER_BIT);
-            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            {
+                PROFILE_ZONE("ui.draw");
+                gpu_timer.begin(gpu_pass_imgui);
+                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+                gpu_timer.end();
+            }
+
+            // Fence the displayed slot so it is not reused while the GPU samples it
+            if (use_triple_buffer && !use_gpu_pipeline && app_state) {
+                app_state->triple_buffer_renderer(0).end_frame();
+            }
+
+            {
+                PROFILE_ZONE("ui.swap");
+                glfwSwapBuffers(window);
+                if (low_latency_present) {
+                    // Nothing queues ahead in the driver, and the stamp below covers the GPU finishing the frame
+                    glFinish();
+                }
+            }
+            ui_scheduler.on_presented();
 
-            glfwSwapBuffers(window);
+            // Swap return is the closest host-side proxy for photons on screen
+            if (shown.consumed_us != 0 && app_state) {
+                const int64_t swapped_us = core::LatencyStats::now_us();
+                app_state->latency_stats().record(shown.timing, shown.consumed_us,
+                                                  shown.uploaded_us ? shown.uploaded_us : shown.consumed_us, swapped_us);
+                core::FlightRecorder::instance().record_frame(shown.timing, shown.consumed_us,
+                                                              shown.uploaded_us, swapped_us);
+                app_state->frame_sync().on_frame_displayed(swapped_us);
+                frames_displayed_metric.add();
+            }
         }
     } catch (const std::exception& e) {
         std::cerr << "ERROR: Fatal exception in main loop: " << e.what() << std::endl;
@@ -500,9 +4337,36 @@ int main(int argc, char* argv[]) {
     }
 
     // Cleanup
+    const bool reporting = config.runtime_settings().run_report && !run_archive_stem.empty();
+    RunReport::Inputs report;
+    if (reporting) {
+        run_report.wait();   // A report asked for from the UI
+        report = gather_run_report();
+    }
+    const int exit_code = finish_soak();
     std::cout << "\nShutting down..." << std::endl;
 
-    CameraManager::instance().shutdown();
+    shader_frame = video::FrameRef();
+    shutdown_pipeline();
+    if (reporting) {
+        start_run_report(std::move(report));
+    }
+
+    // Release GL objects while the context is still current
+    if (app_state) {
+        app_state->triple_buffer_renderer(0).reset();
+        app_state->texture_cache().clear();
+    }
+    gpu_pipeline_active = false;
+    gpu_scattering_view.release();
+    gpu_timer.release();
+    gpu_pipeline.reset();
+    shader_display_active = false;
+    shader_display.reset();
+    CameraManager::instance().set_event_scatter(false);
+    gpu_event_scatter.reset();
+    gallery.reset();
+    heatmap_timeline_panel.reset();
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -511,6 +4375,8 @@ int main(int argc, char* argv[]) {
     glfwDestroyWindow(window);
     glfwTerminate();
 
+    // The window is gone: nothing waits on the report but the process exit
+    run_report.wait();
     std::cout << "Shutdown complete" << std::endl;
-    return 0;
+    return exit_code;
 }
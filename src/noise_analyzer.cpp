@@ -4,10 +4,35 @@
  */
 
 #include "noise_analyzer.h"
+#include "core/alloc_tracker.h"
+#include "core/profiler.h"
+#include "video/simd_utils.h"
+#include "video/thread_pool.h"
 #include <cmath>
+#include <limits>
+#include <ostream>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+
+/**
+ * @brief Release a scratch buffer that someone else still references
+ *
+ * Results and callers may hold headers onto the analyzer's buffers; those
+ * must keep their contents, so only an exclusively owned buffer is written
+ * in place and a shared one is detached (the next create() allocates anew).
+ */
+void detachIfShared(cv::Mat& mat) {
+    if (mat.u && mat.u->refcount > 1) {
+        mat.release();
+    }
+}
+
+} // namespace
 
 // ============================================================================
 // NoiseAnalysisResults Implementation
@@ -19,6 +44,9 @@ std::string NoiseAnalysisResults::toString() const {
     oss << "Noise Analysis Results\n";
     oss << "=====================\n";
     oss << "Detected dots: " << num_dots_detected << "\n";
+    if (num_dots_predicted > 0 || num_dots_rejected > 0) {
+        oss << "  Lattice: " << num_dots_predicted << " predicted, " << num_dots_rejected << " rejected\n";
+    }
     oss << "\nSignal Statistics:\n";
     oss << "  Mean: " << signal_mean << "\n";
     oss << "  Std Dev: " << signal_std << "\n";
@@ -32,9 +60,74 @@ std::string NoiseAnalysisResults::toString() const {
     oss << "\nQuality Metrics:\n";
     oss << "  SNR: " << snr_db << " dB\n";
     oss << "  Contrast Ratio: " << contrast_ratio << "\n";
+    if (local_noise) {
+        const int worst = local_noise->worstBlock();
+        if (worst >= 0) {
+            const size_t index = static_cast<size_t>(worst);
+            oss << "\nLocal Noise (" << local_noise->cols << "x" << local_noise->rows << " blocks of "
+                << local_noise->block_size << " px):\n";
+            oss << "  Worst Std Dev: " << local_noise->noise_std[index] << " at block ("
+                << worst % local_noise->cols << ", " << worst / local_noise->cols << ")\n";
+        }
+    }
+    if (per_dot && per_dot->size() > 0) {
+        const auto weakest = std::min_element(per_dot->snr_db.begin(), per_dot->snr_db.end());
+        const size_t index = static_cast<size_t>(weakest - per_dot->snr_db.begin());
+        oss << "\nPer-Dot SNR:\n";
+        oss << "  Weakest: " << *weakest << " dB at (" << per_dot->x[index] << ", " << per_dot->y[index] << ")\n";
+    }
     return oss.str();
 }
 
+void PerDotStatistics::writeCsv(std::ostream& out, const std::string& source, bool header) const {
+    if (header) {
+        out << (source.empty() ? "" : "file,") << "dot,x,y,radius,pixels,signal_mean,signal_std,snr_db,contrast_ratio\n";
+    }
+    out << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < size(); ++i) {
+        if (!source.empty()) {
+            out << source << ',';
+        }
+        out << i << ',' << x[i] << ',' << y[i] << ',' << radius[i] << ',' << pixels[i] << ','
+            << signal_mean[i] << ',' << signal_std[i] << ',' << snr_db[i] << ',' << contrast_ratio[i] << '\n';
+    }
+}
+
+int LocalNoiseMap::worstBlock() const {
+    int worst = -1;
+    for (size_t i = 0; i < size(); ++i) {
+        if (pixels[i] > 0 && (worst < 0 || noise_std[i] > noise_std[static_cast<size_t>(worst)])) {
+            worst = static_cast<int>(i);
+        }
+    }
+    return worst;
+}
+
+void LocalNoiseMap::writeCsv(std::ostream& out, const std::string& source, bool header) const {
+    if (header) {
+        out << (source.empty() ? "" : "file,") << "block_x,block_y,x,y,block_size,pixels,noise_mean,noise_std\n";
+    }
+    out << std::fixed << std::setprecision(3);
+    for (int by = 0; by < rows; ++by) {
+        for (int bx = 0; bx < cols; ++bx) {
+            const size_t i = static_cast<size_t>(by) * cols + bx;
+            if (!source.empty()) {
+                out << source << ',';
+            }
+            out << bx << ',' << by << ',' << bx * block_size << ',' << by * block_size << ',' << block_size << ','
+                << pixels[i] << ',' << noise_mean[i] << ',' << noise_std[i] << '\n';
+        }
+    }
+}
+
+cv::Mat NoiseAnalysisResults::noiseMask() const {
+    cv::Mat noise;
+    if (signal_mask && !signal_mask->empty()) {
+        cv::bitwise_not(*signal_mask, noise);
+    }
+    return noise;
+}
+
 // ============================================================================
 // NoiseAnalyzer Implementation
 // ============================================================================
@@ -56,54 +149,75 @@ bool NoiseAnalyzer::loadImage(const std::string& image_path) {
     m_image = img;
 
     // Clear previous analysis results
-    m_signal_mask = cv::Mat();
-    m_noise_mask = cv::Mat();
-    m_detected_circles.clear();
+    clearGeometry();
 
     return true;
 }
 
 void NoiseAnalyzer::setImage(const cv::Mat& image) {
-    // Convert to grayscale if needed
+    // Convert to grayscale if needed, into the previous buffer unless a caller still shows it
+    detachIfShared(m_image);
     if (image.channels() == 3) {
         cv::cvtColor(image, m_image, cv::COLOR_BGR2GRAY);
     } else if (image.channels() == 4) {
         cv::cvtColor(image, m_image, cv::COLOR_BGRA2GRAY);
     } else {
-        m_image = image.clone();
+        image.copyTo(m_image);
     }
 
     // Clear previous analysis results
-    m_signal_mask = cv::Mat();
-    m_noise_mask = cv::Mat();
-    m_detected_circles.clear();
+    clearGeometry();
 }
 
 int NoiseAnalyzer::detectDotsThreshold(const DotDetectionParams& params) {
+    PROFILE_ZONE("NoiseAnalyzer::detectDotsThreshold");
     if (m_image.empty()) {
         return 0;
     }
 
-    // Step 1: Apply binary threshold
-    cv::Mat binary;
-    cv::threshold(m_image, binary, params.threshold_value, 255, cv::THRESH_BINARY);
+    // Steps 1-2 in one fused chain when a backend is set (one upload, one readback)
+    const bool fused = params.gpu_morphology && m_morphology_backend &&
+                       m_morphology_backend(m_image, params.threshold_value, params.morph_kernel_size, m_binary);
+    if (!fused) {
+        // Step 1: Apply binary threshold (scratch buffer reused across detections)
+        cv::threshold(m_image, m_binary, params.threshold_value, 255, cv::THRESH_BINARY);
+
+        // Step 2: Morphological operations to clean up
+        if (m_kernel.empty() || m_kernel.rows != params.morph_kernel_size) {
+            m_kernel = cv::getStructuringElement(
+                cv::MORPH_RECT,
+                cv::Size(params.morph_kernel_size, params.morph_kernel_size)
+            );
+        }
+        cv::morphologyEx(m_binary, m_binary, cv::MORPH_OPEN, m_kernel);
+        cv::morphologyEx(m_binary, m_binary, cv::MORPH_CLOSE, m_kernel);
+    }
+
+    // Step 3: Find and filter blobs
+    m_params = params;
+    m_detected_circles.clear();
+    m_accepted_labels.clear();
+    if (params.use_contours) {
+        m_labels.release();
+        m_component_stats.release();
+        detectContours(m_binary, params);
+    } else {
+        detectComponents(m_binary, params);  // Label image is rewritten in place
+    }
 
-    // Step 2: Morphological operations to clean up
-    cv::Mat kernel = cv::getStructuringElement(
-        cv::MORPH_RECT,
-        cv::Size(params.morph_kernel_size, params.morph_kernel_size)
-    );
-    cv::morphologyEx(binary, binary, cv::MORPH_OPEN, kernel);
-    cv::morphologyEx(binary, binary, cv::MORPH_CLOSE, kernel);
+    m_lattice_active = false;
+    if (params.fit_lattice) {
+        fitLattice();
+    }
 
-    // Step 3: Find contours
-    std::vector<std::vector<cv::Point>> contours;
-    cv::findContours(binary, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    return static_cast<int>(m_detected_circles.size());
+}
 
-    // Step 4: Filter contours and extract circles
-    m_detected_circles.clear();
+void NoiseAnalyzer::detectContours(const cv::Mat& binary, const DotDetectionParams& params) {
+    // Kept between detections: findContours resizes the point lists in place
+    cv::findContours(binary, m_contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
 
-    for (const auto& contour : contours) {
+    for (const auto& contour : m_contours) {
         double area = cv::contourArea(contour);
 
         // Filter by area
@@ -127,11 +241,354 @@ int NoiseAnalyzer::detectDotsThreshold(const DotDetectionParams& params) {
             m_detected_circles.push_back(cv::Vec3f(center.x, center.y, radius));
         }
     }
+}
 
-    return static_cast<int>(m_detected_circles.size());
+void NoiseAnalyzer::detectComponents(const cv::Mat& binary, const DotDetectionParams& params) {
+    const int count = cv::connectedComponentsWithStats(binary, m_labels, m_component_stats, m_centroids, 8, CV_32S);
+
+    // Label 0 is the background
+    for (int label = 1; label < count; ++label) {
+        const int* stat = m_component_stats.ptr<int>(label);
+        const int area = stat[cv::CC_STAT_AREA];
+        if (area < params.min_area || area > params.max_area) {
+            continue;
+        }
+
+        // Central second moments over the blob's bounding box only
+        const int left = stat[cv::CC_STAT_LEFT];
+        const int top = stat[cv::CC_STAT_TOP];
+        const double cx = m_centroids.at<double>(label, 0);
+        const double cy = m_centroids.at<double>(label, 1);
+        double mu20 = 0.0, mu02 = 0.0, mu11 = 0.0;
+        for (int y = top; y < top + stat[cv::CC_STAT_HEIGHT]; ++y) {
+            const int* row = m_labels.ptr<int>(y);
+            const double dy = y - cy;
+            for (int x = left; x < left + stat[cv::CC_STAT_WIDTH]; ++x) {
+                if (row[x] == label) {
+                    const double dx = x - cx;
+                    mu20 += dx * dx;
+                    mu02 += dy * dy;
+                    mu11 += dx * dy;
+                }
+            }
+        }
+
+        // Covariance eigenvalues: their ratio is the axis ratio squared, and a
+        // filled ellipse has area 4*pi*sqrt(det); holes and ragged edges spread
+        // the moments and lower the fill term. Both are 1 for a disc.
+        const double a = mu20 / area + 1.0 / 12.0;  // + pixel extent, so tiny dots are not penalised
+        const double b = mu02 / area + 1.0 / 12.0;
+        const double c = mu11 / area;
+        const double root = std::sqrt((a - b) * (a - b) + 4.0 * c * c);
+        const double major = (a + b + root) / 2.0;
+        const double minor = (a + b - root) / 2.0;
+        if (major <= 0.0 || minor <= 0.0) {
+            continue;
+        }
+        const double roundness = std::sqrt(minor / major);
+        const double fill = std::min(1.0, area / (4.0 * CV_PI * std::sqrt(major * minor)));
+        const float circularity = static_cast<float>(roundness * fill);
+
+        if (circularity > params.circularity_threshold) {
+            // Enclosing radius of the equivalent ellipse (2 sigma along the major axis)
+            m_detected_circles.push_back(cv::Vec3f(static_cast<float>(cx), static_cast<float>(cy),
+                                                   static_cast<float>(2.0 * std::sqrt(major))));
+            m_accepted_labels.push_back(label);
+        }
+    }
+}
+
+bool NoiseAnalyzer::fitLattice() {
+    PROFILE_ZONE("NoiseAnalyzer::fitLattice");
+    const std::vector<cv::Vec3f>& dots = m_detected_circles;
+    const size_t n = dots.size();
+    if (n < LATTICE_MIN_DOTS) {
+        return false;
+    }
+    const auto position = [&](size_t d) { return cv::Point2f(dots[d][0], dots[d][1]); };
+
+    // Steps to the nearest neighbours, folded into one half-plane (a step and its negation are the same)
+    std::vector<cv::Point2f> steps;
+    steps.reserve(n * LATTICE_NEIGHBOURS);
+    std::vector<std::pair<float, size_t>> distances(n - 1);
+    std::vector<float> nearest(n);
+    for (size_t a = 0; a < n; ++a) {
+        size_t k = 0;
+        for (size_t b = 0; b < n; ++b) {
+            if (b != a) {
+                const cv::Point2f d = position(b) - position(a);
+                distances[k++] = {d.dot(d), b};
+            }
+        }
+        const size_t neighbours = std::min<size_t>(LATTICE_NEIGHBOURS, distances.size());
+        std::partial_sort(distances.begin(), distances.begin() + static_cast<std::ptrdiff_t>(neighbours), distances.end());
+        nearest[a] = std::sqrt(distances[0].first);
+        for (size_t k2 = 0; k2 < neighbours; ++k2) {
+            cv::Point2f step = position(distances[k2].second) - position(a);
+            if (step.y < 0.0f || (step.y == 0.0f && step.x < 0.0f)) {
+                step = -step;
+            }
+            steps.push_back(step);
+        }
+    }
+    std::nth_element(nearest.begin(), nearest.begin() + static_cast<std::ptrdiff_t>(n / 2), nearest.end());
+    const float spacing = nearest[n / 2];
+    if (spacing <= 0.0f) {
+        return false;
+    }
+
+    // Direction votes in 1-degree bins over [0, 180), ignoring steps across gaps
+    constexpr int BINS = 180;
+    std::array<int, BINS> votes{};
+    std::vector<int> step_bin(steps.size(), -1);
+    for (size_t s = 0; s < steps.size(); ++s) {
+        const float length = std::sqrt(steps[s].dot(steps[s]));
+        if (length <= 0.0f || length > 2.0f * spacing) {
+            continue;
+        }
+        const double angle = std::atan2(steps[s].y, steps[s].x);   // [0, pi]
+        step_bin[s] = std::min(BINS - 1, static_cast<int>(angle * BINS / CV_PI));
+        ++votes[static_cast<size_t>(step_bin[s])];
+    }
+    const auto bin_distance = [](int a, int b) { const int d = std::abs(a - b); return std::min(d, BINS - d); };
+    const auto window_votes = [&](int bin) {
+        int total = 0;
+        for (int d = -2; d <= 2; ++d) {
+            total += votes[static_cast<size_t>((bin + d + BINS) % BINS)];
+        }
+        return total;
+    };
+    int first = 0;
+    for (int bin = 1; bin < BINS; ++bin) {
+        if (window_votes(bin) > window_votes(first)) {
+            first = bin;
+        }
+    }
+    int second = -1;
+    for (int bin = 0; bin < BINS; ++bin) {
+        if (bin_distance(bin, first) >= 20 && window_votes(bin) > 0 &&
+                (second < 0 || window_votes(bin) > window_votes(second))) {
+            second = bin;
+        }
+    }
+    if (second < 0) {
+        return false;   // A single row of dots
+    }
+    const auto mean_step = [&](int peak) {
+        cv::Point2f sum(0.0f, 0.0f);
+        cv::Point2f reference;
+        int count = 0;
+        for (size_t s = 0; s < steps.size(); ++s) {
+            if (step_bin[s] < 0 || bin_distance(step_bin[s], peak) > 3) {
+                continue;
+            }
+            cv::Point2f step = steps[s];
+            if (count == 0) {
+                reference = step;
+            } else if (step.dot(reference) < 0.0f) {
+                step = -step;   // Folded to the other end of the half-plane
+            }
+            sum += step;
+            ++count;
+        }
+        return sum * (1.0f / static_cast<float>(count));
+    };
+
+    // Index origin: the detection nearest the middle of the pattern
+    cv::Point2f middle(0.0f, 0.0f);
+    for (size_t d = 0; d < n; ++d) {
+        middle += position(d);
+    }
+    middle *= 1.0f / static_cast<float>(n);
+    size_t centre = 0;
+    for (size_t d = 1; d < n; ++d) {
+        const cv::Point2f a = position(d) - middle;
+        const cv::Point2f b = position(centre) - middle;
+        if (a.dot(a) < b.dot(b)) {
+            centre = d;
+        }
+    }
+
+    DotLattice lattice;
+    lattice.origin = position(centre);
+    lattice.basis_u = mean_step(first);
+    lattice.basis_v = mean_step(second);
+
+    // Assign grid indices, then refine origin and basis by least squares over the inliers
+    std::vector<cv::Point2i> index(n);
+    std::vector<float> residual(n);
+    constexpr int REFINE_PASSES = 3;
+    for (int pass = 0; ; ++pass) {
+        const cv::Point2f u = lattice.basis_u;
+        const cv::Point2f v = lattice.basis_v;
+        const float det = u.x * v.y - u.y * v.x;
+        if (std::abs(det) < 1e-3f) {
+            return false;
+        }
+        const float tolerance = LATTICE_TOLERANCE * std::sqrt(std::min(u.dot(u), v.dot(v)));
+
+        cv::Matx33d normal = cv::Matx33d::zeros();
+        cv::Vec3d rhs_x(0.0, 0.0, 0.0);
+        cv::Vec3d rhs_y(0.0, 0.0, 0.0);
+        size_t inliers = 0;
+        for (size_t d = 0; d < n; ++d) {
+            const cv::Point2f offset = position(d) - lattice.origin;
+            index[d] = cv::Point2i(cvRound((offset.x * v.y - offset.y * v.x) / det),
+                                   cvRound((u.x * offset.y - u.y * offset.x) / det));
+            const cv::Point2f error = position(d) - lattice.node(index[d].x, index[d].y);
+            residual[d] = std::sqrt(error.dot(error));
+            if (residual[d] > tolerance) {
+                residual[d] = -1.0f;   // Misdetection
+                continue;
+            }
+            const cv::Vec3d row(1.0, index[d].x, index[d].y);
+            normal += row * row.t();
+            rhs_x += row * static_cast<double>(dots[d][0]);
+            rhs_y += row * static_cast<double>(dots[d][1]);
+            ++inliers;
+        }
+        if (inliers < LATTICE_MIN_DOTS) {
+            return false;
+        }
+        if (pass == REFINE_PASSES) {
+            break;
+        }
+
+        cv::Vec3d fit_x, fit_y;
+        if (!cv::solve(normal, rhs_x, fit_x, cv::DECOMP_LU) || !cv::solve(normal, rhs_y, fit_y, cv::DECOMP_LU)) {
+            return false;   // Inliers on one line
+        }
+        lattice.origin = cv::Point2f(static_cast<float>(fit_x[0]), static_cast<float>(fit_y[0]));
+        lattice.basis_u = cv::Point2f(static_cast<float>(fit_x[1]), static_cast<float>(fit_y[1]));
+        lattice.basis_v = cv::Point2f(static_cast<float>(fit_x[2]), static_cast<float>(fit_y[2]));
+    }
+
+    // Extent, radius and fit quality from the inliers
+    lattice.min_i = lattice.min_j = std::numeric_limits<int>::max();
+    lattice.max_i = lattice.max_j = std::numeric_limits<int>::min();
+    std::vector<float> radii;
+    radii.reserve(n);
+    double squared_error = 0.0;
+    for (size_t d = 0; d < n; ++d) {
+        if (residual[d] < 0.0f) {
+            continue;
+        }
+        lattice.min_i = std::min(lattice.min_i, index[d].x);
+        lattice.max_i = std::max(lattice.max_i, index[d].x);
+        lattice.min_j = std::min(lattice.min_j, index[d].y);
+        lattice.max_j = std::max(lattice.max_j, index[d].y);
+        radii.push_back(dots[d][2]);
+        squared_error += static_cast<double>(residual[d]) * residual[d];
+    }
+    lattice.inliers = static_cast<int>(radii.size());
+    lattice.outliers = static_cast<int>(n - radii.size());
+    lattice.rms_residual_px = static_cast<float>(std::sqrt(squared_error / static_cast<double>(radii.size())));
+    std::nth_element(radii.begin(), radii.begin() + static_cast<std::ptrdiff_t>(radii.size() / 2), radii.end());
+    lattice.radius = radii[radii.size() / 2];
+
+    const int64_t nodes = static_cast<int64_t>(lattice.max_i - lattice.min_i + 1) * (lattice.max_j - lattice.min_j + 1);
+    if (lattice.max_i == lattice.min_i || lattice.max_j == lattice.min_j || nodes > 16 * static_cast<int64_t>(n)) {
+        return false;   // Degenerate, or inliers too sparse to trust the grid
+    }
+
+    // Index from the grid corner, so refits of the same target compare node for node
+    lattice.origin = lattice.node(lattice.min_i, lattice.min_j);
+    lattice.max_i -= lattice.min_i;
+    lattice.max_j -= lattice.min_j;
+    for (size_t d = 0; d < n; ++d) {
+        index[d] -= cv::Point2i(lattice.min_i, lattice.min_j);
+    }
+    lattice.min_i = lattice.min_j = 0;
+
+    // Nodes with a detection; the rest are predicted
+    const int columns = lattice.max_i + 1;
+    std::vector<char> detected(static_cast<size_t>(nodes), 0);
+    for (size_t d = 0; d < n; ++d) {
+        if (residual[d] >= 0.0f) {
+            detected[static_cast<size_t>(index[d].y * columns + index[d].x)] = 1;
+        }
+    }
+
+    // The same grid as last time (same target, same setup) keeps its span list
+    const auto same_node = [&](int i, int j) {
+        const cv::Point2f d = lattice.node(i, j) - m_lattice.node(i, j);
+        return d.dot(d) < 0.01f;
+    };
+    const bool same = m_lattice.valid() && m_span_size == m_image.size() &&
+        lattice.min_i == m_lattice.min_i && lattice.max_i == m_lattice.max_i &&
+        lattice.min_j == m_lattice.min_j && lattice.max_j == m_lattice.max_j &&
+        static_cast<int>(lattice.radius) == static_cast<int>(m_lattice.radius) &&
+        same_node(lattice.min_i, lattice.min_j) && same_node(lattice.max_i, lattice.min_j) &&
+        same_node(lattice.min_i, lattice.max_j) && same_node(lattice.max_i, lattice.max_j);
+    if (same) {
+        m_lattice.inliers = lattice.inliers;
+        m_lattice.outliers = lattice.outliers;
+        m_lattice.rms_residual_px = lattice.rms_residual_px;
+    } else {
+        m_lattice = lattice;
+        m_lattice_spans.clear();
+        m_span_radius = -1;
+    }
+
+    // Replace the detections by the grid nodes inside the image
+    m_detected_circles.clear();
+    m_lattice.predicted = 0;
+    for (int j = m_lattice.min_j; j <= m_lattice.max_j; ++j) {
+        for (int i = m_lattice.min_i; i <= m_lattice.max_i; ++i) {
+            const cv::Point2f p = m_lattice.node(i, j);
+            if (p.x < 0.0f || p.y < 0.0f || p.x >= m_image.cols || p.y >= m_image.rows) {
+                continue;
+            }
+            m_detected_circles.emplace_back(p.x, p.y, m_lattice.radius);
+            if (!detected[static_cast<size_t>(j * columns + i)]) {
+                ++m_lattice.predicted;
+            }
+        }
+    }
+    m_labels.release();
+    m_component_stats.release();
+    m_accepted_labels.clear();
+    m_lattice_active = true;
+    return true;
+}
+
+void NoiseAnalyzer::buildLatticeSpans(int radius) {
+    if (radius == m_span_radius && m_span_size == m_image.size()) {
+        return;
+    }
+    m_lattice_spans.clear();
+    m_span_radius = radius;
+    m_span_size = m_image.size();
+    if (radius < 0) {
+        return;
+    }
+
+    // Half-width of the disc per row offset, the same for every node
+    std::vector<int> half(static_cast<size_t>(radius) + 1);
+    for (int dy = 0; dy <= radius; ++dy) {
+        half[static_cast<size_t>(dy)] = static_cast<int>(std::sqrt(static_cast<double>(radius * radius - dy * dy)));
+    }
+    m_lattice_spans.reserve(m_detected_circles.size() * static_cast<size_t>(2 * radius + 1));
+    for (size_t d = 0; d < m_detected_circles.size(); ++d) {
+        const int cx = static_cast<int>(m_detected_circles[d][0]);
+        const int cy = static_cast<int>(m_detected_circles[d][1]);
+        for (int dy = -radius; dy <= radius; ++dy) {
+            const int y = cy + dy;
+            if (y < 0 || y >= m_image.rows) {
+                continue;
+            }
+            const int w = half[static_cast<size_t>(std::abs(dy))];
+            const int x0 = std::max(0, cx - w);
+            const int x1 = std::min(m_image.cols - 1, cx + w);
+            if (x0 <= x1) {
+                m_lattice_spans.push_back({y, x0, x1, static_cast<int>(d)});
+            }
+        }
+    }
 }
 
 bool NoiseAnalyzer::createMasks(float dilation_factor) {
+    PROFILE_ZONE("NoiseAnalyzer::createMasks");
     if (m_image.empty()) {
         return false;
     }
@@ -141,90 +598,286 @@ bool NoiseAnalyzer::createMasks(float dilation_factor) {
     }
 
     // Create blank signal mask
-    m_signal_mask = cv::Mat::zeros(m_image.size(), CV_8U);
+    resetSignalMask();
 
-    // Fill in detected circles
-    for (const auto& circle : m_detected_circles) {
-        cv::Point center(static_cast<int>(circle[0]), static_cast<int>(circle[1]));
-        int radius = static_cast<int>(circle[2] * dilation_factor);
-        cv::circle(m_signal_mask, center, radius, cv::Scalar(255), -1);
+    if (m_lattice_active) {
+        // Precomputed disc rows of the grid nodes
+        buildLatticeSpans(static_cast<int>(m_lattice.radius * dilation_factor));
+        for (const MaskSpan& span : m_lattice_spans) {
+            std::memset(m_signal_mask.ptr<uint8_t>(span.y) + span.x0, 255, static_cast<size_t>(span.x1 - span.x0 + 1));
+        }
+    } else if (dilation_factor == 1.0f && !m_labels.empty()) {
+        // The dots' own pixels, visited through their bounding boxes
+        for (const int label : m_accepted_labels) {
+            const int* stat = m_component_stats.ptr<int>(label);
+            for (int y = stat[cv::CC_STAT_TOP]; y < stat[cv::CC_STAT_TOP] + stat[cv::CC_STAT_HEIGHT]; ++y) {
+                const int* labels = m_labels.ptr<int>(y);
+                uint8_t* mask = m_signal_mask.ptr<uint8_t>(y);
+                for (int x = stat[cv::CC_STAT_LEFT]; x < stat[cv::CC_STAT_LEFT] + stat[cv::CC_STAT_WIDTH]; ++x) {
+                    if (labels[x] == label) {
+                        mask[x] = 255;
+                    }
+                }
+            }
+        }
+    } else {
+        // Fill in detected circles
+        for (const auto& circle : m_detected_circles) {
+            cv::Point center(static_cast<int>(circle[0]), static_cast<int>(circle[1]));
+            int radius = static_cast<int>(circle[2] * dilation_factor);
+            cv::circle(m_signal_mask, center, radius, cv::Scalar(255), -1);
+        }
     }
 
-    // Noise mask is inverse of signal mask
-    m_noise_mask = cv::Mat::zeros(m_image.size(), CV_8U);
-    cv::bitwise_not(m_signal_mask, m_noise_mask);
+    // Noise mask is the inverse of the signal mask and derived only when asked for
+    m_noise_mask.release();
+
+    // Publish immutable geometry; earlier results keep the previous buffers
+    m_shared_signal_mask = std::make_shared<const cv::Mat>(m_signal_mask);
+    m_shared_circles = std::make_shared<const std::vector<cv::Vec3f>>(m_detected_circles);
+
+    // Tracking starts over from the new detection
+    m_tracks.clear();
+    m_tracks.reserve(m_detected_circles.size());
+    for (const auto& circle : m_detected_circles) {
+        TrackedDot dot;
+        dot.origin = cv::Point2f(circle[0], circle[1]);
+        dot.origin_radius = circle[2];
+        dot.center = dot.origin;
+        dot.radius = circle[2];
+        dot.tracked = true;
+        m_tracks.push_back(dot);
+    }
 
     return true;
 }
 
-void NoiseAnalyzer::calculateRegionStats(const cv::Mat& image,
-                                        const cv::Mat& mask,
+void NoiseAnalyzer::calculateRegionStats(const uint32_t histogram[256],
                                         double& mean,
                                         double& std,
                                         double& min_val,
                                         double& max_val,
-                                        int& num_pixels) const {
-    // Extract pixels using mask
-    std::vector<double> pixels;
-    pixels.reserve(cv::countNonZero(mask));
-
-    for (int y = 0; y < image.rows; ++y) {
-        const uint8_t* img_row = image.ptr<uint8_t>(y);
-        const uint8_t* mask_row = mask.ptr<uint8_t>(y);
-
-        for (int x = 0; x < image.cols; ++x) {
-            if (mask_row[x] > 0) {
-                pixels.push_back(static_cast<double>(img_row[x]));
-            }
-        }
+                                        int& num_pixels) {
+    // Exact integer moments from the 256-bin histogram
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t sum_sq = 0;
+    int lowest = -1;
+    int highest = -1;
+
+    for (int v = 0; v < 256; ++v) {
+        const uint64_t n = histogram[v];
+        if (n == 0) continue;
+        if (lowest < 0) lowest = v;
+        highest = v;
+        count += n;
+        sum += n * v;
+        sum_sq += n * v * v;
     }
 
-    num_pixels = static_cast<int>(pixels.size());
+    num_pixels = static_cast<int>(count);
 
-    if (num_pixels == 0) {
+    if (count == 0) {
         mean = std = min_val = max_val = 0.0;
         return;
     }
 
-    // Calculate mean
-    double sum = 0.0;
-    min_val = pixels[0];
-    max_val = pixels[0];
+    mean = static_cast<double>(sum) / count;
+    min_val = lowest;
+    max_val = highest;
+
+    // Population variance: (n * sum_sq - sum^2) / n^2, numerator fits in 64 bits for 8-bit data
+    const double numerator = static_cast<double>(count * sum_sq - sum * sum);
+    std = std::sqrt(numerator / (static_cast<double>(count) * count));
+}
+
+NoiseAnalysisResults NoiseAnalyzer::analyzeNoise(const uint32_t* signal_hist, const uint32_t* noise_hist) {
+    PROFILE_ZONE("NoiseAnalyzer::analyzeNoise");
+    ALLOC_SCOPE("noise_analysis");
+    NoiseAnalysisResults results;
+
+    if (m_image.empty() || !m_shared_signal_mask) {
+        return results;
+    }
+
+    results.num_dots_detected = static_cast<int>(m_shared_circles->size());
+    results.detected_circles = m_shared_circles;
+    if (m_lattice_active) {
+        results.num_dots_predicted = m_lattice.predicted;
+        results.num_dots_rejected = m_lattice.outliers;
+    }
+
+    if (signal_hist && noise_hist) {
+        regionStatsFromHistograms(signal_hist, noise_hist, results);
+    } else {
+        computeRegionStatistics(m_image, results);
+    }
+    computePerDotStatistics(m_image, results);
+    if (m_local_block_size > 0) {
+        computeLocalNoise(m_image, results);
+    }
+
+    // Share masks with results (no per-analysis allocation)
+    results.signal_mask = m_shared_signal_mask;
+
+    return results;
+}
+
+void NoiseAnalyzer::computePerDotStatistics(const cv::Mat& image, NoiseAnalysisResults& results) {
+    PROFILE_ZONE("NoiseAnalyzer::computePerDotStatistics");
+    const size_t dots = m_detected_circles.size();
+
+    // Label map plus label -> (dot index + 1); circles are drawn with that value directly
+    const cv::Mat* labels = &m_labels;
+    std::vector<int>& dot_of_label = m_dot_of_label;
+    dot_of_label.clear();
+    if (!m_labels.empty()) {
+        dot_of_label.assign(static_cast<size_t>(m_component_stats.rows), 0);
+        for (size_t i = 0; i < m_accepted_labels.size(); ++i) {
+            dot_of_label[static_cast<size_t>(m_accepted_labels[i])] = static_cast<int>(i) + 1;
+        }
+    } else if (m_lattice_active) {
+        buildLatticeSpans(static_cast<int>(m_lattice.radius));
+        m_dot_labels.create(image.size(), CV_32S);
+        m_dot_labels.setTo(0);
+        for (const MaskSpan& span : m_lattice_spans) {
+            std::fill(m_dot_labels.ptr<int>(span.y) + span.x0, m_dot_labels.ptr<int>(span.y) + span.x1 + 1, span.dot + 1);
+        }
+        labels = &m_dot_labels;
+    } else {
+        m_dot_labels.create(image.size(), CV_32S);
+        m_dot_labels.setTo(0);
+        for (size_t i = 0; i < dots; ++i) {
+            const cv::Vec3f& circle = m_detected_circles[i];
+            cv::circle(m_dot_labels, cv::Point(static_cast<int>(circle[0]), static_cast<int>(circle[1])),
+                       static_cast<int>(circle[2]), cv::Scalar(static_cast<double>(i + 1)), -1);
+        }
+        labels = &m_dot_labels;
+    }
+
+    // One sweep: integer sums per dot (slot 0 = background, ignored)
+    std::vector<uint64_t>& sum = m_dot_sum;
+    std::vector<uint64_t>& sum_sq = m_dot_sum_sq;
+    std::vector<int>& count = m_dot_count;
+    sum.assign(dots + 1, 0);
+    sum_sq.assign(dots + 1, 0);
+    count.assign(dots + 1, 0);
+    const bool remap = !dot_of_label.empty();
+    for (int y = 0; y < image.rows; ++y) {
+        const uint8_t* pixels = image.ptr<uint8_t>(y);
+        const int* row = labels->ptr<int>(y);
+        for (int x = 0; x < image.cols; ++x) {
+            const int label = row[x];
+            if (label == 0) {
+                continue;
+            }
+            const int dot = remap ? dot_of_label[static_cast<size_t>(label)] : label;
+            const uint32_t v = pixels[x];
+            sum[dot] += v;
+            sum_sq[dot] += v * v;
+            ++count[dot];
+        }
+    }
 
-    for (double val : pixels) {
-        sum += val;
-        if (val < min_val) min_val = val;
-        if (val > max_val) max_val = val;
+    std::shared_ptr<PerDotStatistics> stats = acquirePerDotStatistics();
+    stats->x.resize(dots);
+    stats->y.resize(dots);
+    stats->radius.resize(dots);
+    stats->pixels.resize(dots);
+    stats->signal_mean.resize(dots);
+    stats->signal_std.resize(dots);
+    stats->snr_db.resize(dots);
+    stats->contrast_ratio.resize(dots);
+    for (size_t i = 0; i < dots; ++i) {
+        const size_t slot = i + 1;
+        const double n = count[slot];
+        const double mean = n > 0 ? static_cast<double>(sum[slot]) / n : 0.0;
+        const double variance = n > 0 ? std::max(0.0, static_cast<double>(sum_sq[slot]) / n - mean * mean) : 0.0;
+
+        stats->x[i] = m_detected_circles[i][0];
+        stats->y[i] = m_detected_circles[i][1];
+        stats->radius[i] = m_detected_circles[i][2];
+        stats->pixels[i] = count[slot];
+        stats->signal_mean[i] = static_cast<float>(mean);
+        stats->signal_std[i] = static_cast<float>(std::sqrt(variance));
+        stats->snr_db[i] = results.noise_std > 0.0
+            ? static_cast<float>(20.0 * std::log10(std::max(mean - results.noise_mean, 1e-6) / results.noise_std))
+            : std::numeric_limits<float>::infinity();
+        stats->contrast_ratio[i] = results.noise_mean > 0.0
+            ? static_cast<float>(mean / results.noise_mean)
+            : std::numeric_limits<float>::infinity();
     }
-    mean = sum / num_pixels;
+    results.per_dot = std::move(stats);
+}
 
-    // Calculate standard deviation
-    double variance = 0.0;
-    for (double val : pixels) {
-        double diff = val - mean;
-        variance += diff * diff;
+std::shared_ptr<PerDotStatistics> NoiseAnalyzer::acquirePerDotStatistics() {
+    // A pooled table nobody else references any more is overwritten in place
+    for (const std::shared_ptr<PerDotStatistics>& stats : m_per_dot_pool) {
+        if (stats.use_count() == 1) {
+            return stats;
+        }
+    }
+    m_per_dot_pool.push_back(std::make_shared<PerDotStatistics>());
+    if (m_per_dot_pool.size() > PER_DOT_POOL_SIZE) {
+        m_per_dot_pool.erase(m_per_dot_pool.begin());  // Oldest stays alive in its results only
     }
-    std = std::sqrt(variance / num_pixels);
+    return m_per_dot_pool.back();
 }
 
-NoiseAnalysisResults NoiseAnalyzer::analyzeNoise() {
-    NoiseAnalysisResults results;
+void NoiseAnalyzer::resetSignalMask() {
+    // Drop our own reference first: the buffer is then reused unless a result still holds it
+    m_shared_signal_mask.reset();
+    m_noise_mask.release();
+    detachIfShared(m_signal_mask);
+    m_signal_mask.create(m_image.size(), CV_8U);
+    m_signal_mask.setTo(0);
+}
 
-    if (m_image.empty() || m_signal_mask.empty() || m_noise_mask.empty()) {
-        return results;
+void NoiseAnalyzer::computeRegionStatistics(const cv::Mat& image, NoiseAnalysisResults& results) const {
+    // Noise mask is the complement of the signal mask, so one sweep over the
+    // image yields both region histograms
+    uint32_t signal_hist[256];
+    uint32_t noise_hist[256];
+    const cv::Mat& mask = *m_shared_signal_mask;
+
+    video::ThreadPool& pool = m_pool ? *m_pool : video::ThreadPool::shared();
+    if (!m_parallel || pool.concurrency() < 2 ||
+            static_cast<int64_t>(image.total()) < PARALLEL_MIN_PIXELS) {
+        video::simd::masked_histogram(image, mask, signal_hist, noise_hist);
+    } else {
+        // Row bands sized so image + mask rows stay in L2; bins are summed afterwards
+        const int rows_per_band = video::ThreadPool::band_rows(image.rows, static_cast<size_t>(image.cols) * 2);
+        const int band_count = (image.rows + rows_per_band - 1) / rows_per_band;
+        std::vector<std::array<uint32_t, 512>>& bands = m_hist_bands;
+        bands.resize(static_cast<size_t>(band_count));
+
+        pool.parallel_for(band_count, [&](int b) {
+            const cv::Range rows(b * rows_per_band, std::min(image.rows, (b + 1) * rows_per_band));
+            video::simd::masked_histogram(image.rowRange(rows), mask.rowRange(rows),
+                                          bands[b].data(), bands[b].data() + 256);
+        });
+
+        std::fill(signal_hist, signal_hist + 256, 0u);
+        std::fill(noise_hist, noise_hist + 256, 0u);
+        for (const auto& band : bands) {
+            for (int v = 0; v < 256; ++v) {
+                signal_hist[v] += band[v];
+                noise_hist[v] += band[256 + v];
+            }
+        }
     }
 
-    results.num_dots_detected = static_cast<int>(m_detected_circles.size());
-    results.detected_circles = m_detected_circles;
+    regionStatsFromHistograms(signal_hist, noise_hist, results);
+}
 
-    // Calculate signal statistics
-    calculateRegionStats(m_image, m_signal_mask,
+void NoiseAnalyzer::regionStatsFromHistograms(const uint32_t signal_hist[256], const uint32_t noise_hist[256],
+                                              NoiseAnalysisResults& results) {
+    calculateRegionStats(signal_hist,
                         results.signal_mean, results.signal_std,
                         results.signal_min, results.signal_max,
                         results.num_signal_pixels);
 
-    // Calculate noise statistics
-    calculateRegionStats(m_image, m_noise_mask,
+    calculateRegionStats(noise_hist,
                         results.noise_mean, results.noise_std,
                         results.noise_min, results.noise_max,
                         results.num_noise_pixels);
@@ -243,14 +896,390 @@ NoiseAnalysisResults NoiseAnalyzer::analyzeNoise() {
     } else {
         results.contrast_ratio = std::numeric_limits<double>::infinity();
     }
+}
+
+void NoiseAnalyzer::computeLocalNoise(const cv::Mat& image, NoiseAnalysisResults& results) {
+    PROFILE_ZONE("NoiseAnalyzer::computeLocalNoise");
+    video::simd::masked_integrals(image, getNoiseMask(), m_noise_sum, m_noise_sum_sq, m_noise_count);
+    results.local_noise = computeLocalNoiseMap(m_local_block_size);
+}
+
+bool NoiseAnalyzer::queryNoiseRegion(const cv::Rect& rect, double& mean, double& std, int& num_pixels) const {
+    mean = std = 0.0;
+    num_pixels = 0;
+    if (m_noise_count.empty()) {
+        return false;
+    }
+    const cv::Rect r = rect & cv::Rect(0, 0, m_noise_count.cols - 1, m_noise_count.rows - 1);
+    if (r.empty()) {
+        return false;
+    }
+
+    // Four corners of each table; unsigned wraparound cancels out for the 32-bit sums
+    const int x0 = r.x, y0 = r.y, x1 = r.x + r.width, y1 = r.y + r.height;
+    const auto box = [&](const cv::Mat& table) {
+        const uint32_t* top = table.ptr<uint32_t>(y0);
+        const uint32_t* bottom = table.ptr<uint32_t>(y1);
+        return bottom[x1] - top[x1] - bottom[x0] + top[x0];
+    };
+    const uint32_t count = box(m_noise_count);
+    if (count == 0) {
+        return false;
+    }
+    const double sum = box(m_noise_sum);
+    const double* top_sq = m_noise_sum_sq.ptr<double>(y0);
+    const double* bottom_sq = m_noise_sum_sq.ptr<double>(y1);
+    const double sum_sq = bottom_sq[x1] - top_sq[x1] - bottom_sq[x0] + top_sq[x0];
+
+    num_pixels = static_cast<int>(count);
+    mean = sum / count;
+    std = std::sqrt(std::max(0.0, sum_sq / count - mean * mean));
+    return true;
+}
+
+std::shared_ptr<LocalNoiseMap> NoiseAnalyzer::computeLocalNoiseMap(int block_size) const {
+    if (m_noise_count.empty() || block_size <= 0) {
+        return nullptr;
+    }
+    const int width = m_noise_count.cols - 1;
+    const int height = m_noise_count.rows - 1;
+
+    auto map = std::make_shared<LocalNoiseMap>();
+    map->block_size = block_size;
+    map->cols = (width + block_size - 1) / block_size;
+    map->rows = (height + block_size - 1) / block_size;
+    const size_t blocks = static_cast<size_t>(map->cols) * map->rows;
+    map->pixels.resize(blocks);
+    map->noise_mean.resize(blocks);
+    map->noise_std.resize(blocks);
+
+    for (int by = 0; by < map->rows; ++by) {
+        for (int bx = 0; bx < map->cols; ++bx) {
+            const size_t i = static_cast<size_t>(by) * map->cols + bx;
+            double mean = 0.0, std = 0.0;
+            int num_pixels = 0;
+            const bool measured = queryNoiseRegion(cv::Rect(bx * block_size, by * block_size, block_size, block_size),
+                                                   mean, std, num_pixels);
+            map->pixels[i] = num_pixels;
+            map->noise_mean[i] = measured ? static_cast<float>(mean) : std::numeric_limits<float>::quiet_NaN();
+            map->noise_std[i] = measured ? static_cast<float>(std) : std::numeric_limits<float>::quiet_NaN();
+        }
+    }
+    return map;
+}
+
+const cv::Mat& NoiseAnalyzer::getNoiseMask() const {
+    if (m_noise_mask.empty() && !m_signal_mask.empty()) {
+        cv::bitwise_not(m_signal_mask, m_noise_mask);
+    }
+    return m_noise_mask;
+}
+
+void NoiseAnalyzer::clearGeometry() {
+    m_signal_mask = cv::Mat();
+    m_noise_mask = cv::Mat();
+    m_detected_circles.clear();
+    m_labels.release();
+    m_component_stats.release();
+    m_accepted_labels.clear();
+    m_shared_signal_mask.reset();
+    m_shared_circles.reset();
+    m_tracks.clear();
+    m_lattice = DotLattice();
+    m_lattice_active = false;
+    m_lattice_spans.clear();
+    m_span_radius = -1;
+    m_noise_sum.release();
+    m_noise_sum_sq.release();
+    m_noise_count.release();
+}
+
+ThresholdSweep NoiseAnalyzer::sweepThresholds(const cv::Mat& image, int min_signal_pixels) {
+    PROFILE_ZONE("NoiseAnalyzer::sweepThresholds");
+    ThresholdSweep sweep;
+    sweep.snr_db.fill(std::numeric_limits<float>::quiet_NaN());
+    sweep.contrast_ratio.fill(std::numeric_limits<float>::quiet_NaN());
+    if (image.empty()) {
+        return sweep;
+    }
+
+    cv::Mat gray = image;
+    if (image.channels() == 3) {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    } else if (image.channels() == 4) {
+        cv::cvtColor(image, gray, cv::COLOR_BGRA2GRAY);
+    }
+    if (gray.depth() != CV_8U) {
+        return sweep;
+    }
+
+    uint64_t histogram[256] = {};
+    for (int y = 0; y < gray.rows; ++y) {
+        const uint8_t* row = gray.ptr<uint8_t>(y);
+        for (int x = 0; x < gray.cols; ++x) {
+            ++histogram[row[x]];
+        }
+    }
+
+    // below_*[t] = moments of pixels < t (the noise side of threshold t)
+    uint64_t below_count[257] = {};
+    uint64_t below_sum[257] = {};
+    uint64_t below_sum_sq[257] = {};
+    for (int v = 0; v < 256; ++v) {
+        const uint64_t n = histogram[v];
+        below_count[v + 1] = below_count[v] + n;
+        below_sum[v + 1] = below_sum[v] + n * v;
+        below_sum_sq[v + 1] = below_sum_sq[v] + n * v * v;
+    }
+    const uint64_t total = below_count[256];
+
+    for (int t = 0; t < 256; ++t) {
+        const uint64_t noise_n = below_count[t];
+        const uint64_t signal_n = total - noise_n;
+        sweep.signal_pixels[t] = static_cast<int>(signal_n);
+        if (noise_n == 0 || signal_n == 0) {
+            continue;
+        }
+        const double noise_mean = static_cast<double>(below_sum[t]) / noise_n;
+        const double noise_var = static_cast<double>(below_sum_sq[t]) / noise_n - noise_mean * noise_mean;
+        const double signal_mean = static_cast<double>(below_sum[256] - below_sum[t]) / signal_n;
+        if (noise_mean > 0.0) {
+            sweep.contrast_ratio[t] = static_cast<float>(signal_mean / noise_mean);
+        }
+        if (noise_var <= 0.0) {
+            continue;
+        }
+        const double snr = 20.0 * std::log10(std::max(signal_mean - noise_mean, 1e-6) / std::sqrt(noise_var));
+        sweep.snr_db[t] = static_cast<float>(snr);
+
+        // Dots are the minority: a threshold inside the background splits it and fakes a tiny noise std
+        if (signal_n >= static_cast<uint64_t>(std::max(1, min_signal_pixels)) && noise_n >= signal_n &&
+                (sweep.best_threshold < 0 || snr > sweep.best_snr_db)) {
+            sweep.best_threshold = t;
+            sweep.best_snr_db = static_cast<float>(snr);
+        }
+    }
+    return sweep;
+}
+
+bool NoiseAnalyzer::hasGeometry() const {
+    return m_shared_signal_mask && !m_shared_circles->empty();
+}
+
+NoiseAnalysisResults NoiseAnalyzer::analyzeLiveFrame(const cv::Mat& frame) {
+    ALLOC_SCOPE("noise_live");
+    NoiseAnalysisResults results;
+
+    if (frame.empty() || !hasGeometry()) {
+        return results;
+    }
+
+    const cv::Mat& gray = liveGray(frame);
+    if (gray.size() != m_shared_signal_mask->size() || gray.type() != CV_8UC1) {
+        return results;  // Camera format changed since dots were detected
+    }
+
+    results.num_dots_detected = static_cast<int>(m_shared_circles->size());
+    results.detected_circles = m_shared_circles;
+    computeRegionStatistics(gray, results);
+    if (m_local_block_size > 0) {
+        computeLocalNoise(gray, results);
+    }
+
+    // Share the cached masks (no per-frame clone)
+    results.signal_mask = m_shared_signal_mask;
+
+    return results;
+}
+
+NoiseAnalysisResults NoiseAnalyzer::analyzeHistograms(const uint32_t signal_hist[256],
+                                                      const uint32_t noise_hist[256]) const {
+    NoiseAnalysisResults results;
+    if (!hasGeometry()) {
+        return results;
+    }
+
+    results.num_dots_detected = static_cast<int>(m_shared_circles->size());
+    results.detected_circles = m_shared_circles;
+    regionStatsFromHistograms(signal_hist, noise_hist, results);
+    results.signal_mask = m_shared_signal_mask;
+    return results;
+}
+
+NoiseAnalysisResults NoiseAnalyzer::trackLiveFrame(const cv::Mat& frame, float min_tracked_fraction) {
+    PROFILE_ZONE("NoiseAnalyzer::trackLiveFrame");
+    ALLOC_SCOPE("noise_track");
+    NoiseAnalysisResults results;
+
+    if (frame.empty() || !hasGeometry()) {
+        return results;
+    }
+
+    const cv::Mat& gray = liveGray(frame);
+    if (gray.size() != m_shared_signal_mask->size() || gray.type() != CV_8UC1) {
+        return results;  // Camera format changed since dots were detected
+    }
+
+    int tracked = 0;
+    bool moved = false;
+    for (size_t i = 0; i < m_tracks.size(); ++i) {
+        TrackedDot& dot = m_tracks[i];
+        if (!refineTrack(gray, dot)) {
+            continue;
+        }
+        ++tracked;
+        const cv::Vec3f& drawn = m_detected_circles[i];
+        if (std::abs(dot.center.x - drawn[0]) >= 0.5f || std::abs(dot.center.y - drawn[1]) >= 0.5f ||
+            std::abs(dot.radius - drawn[2]) >= 0.5f) {
+            moved = true;
+        }
+    }
+
+    if (tracked < min_tracked_fraction * static_cast<float>(m_tracks.size())) {
+        // Target moved or changed too much to follow: full detection on this frame
+        setImage(gray);
+        results = processCurrentImage(m_params);
+        results.num_dots_tracked = results.num_dots_detected;
+        results.redetected = true;
+        return results;
+    }
+
+    if (moved) {
+        publishTrackedGeometry();
+    }
 
-    // Store masks in results
-    results.signal_mask = m_signal_mask.clone();
-    results.noise_mask = m_noise_mask.clone();
+    results.num_dots_detected = static_cast<int>(m_shared_circles->size());
+    results.detected_circles = m_shared_circles;
+    computeRegionStatistics(gray, results);
+    if (m_local_block_size > 0) {
+        computeLocalNoise(gray, results);
+    }
+    results.signal_mask = m_shared_signal_mask;
+
+    results.num_dots_tracked = tracked;
+    double drift_sum = 0.0;
+    for (const TrackedDot& dot : m_tracks) {
+        drift_sum += dot.drift_px;
+        results.max_drift_px = std::max(results.max_drift_px, static_cast<double>(dot.drift_px));
+    }
+    results.mean_drift_px = m_tracks.empty() ? 0.0 : drift_sum / static_cast<double>(m_tracks.size());
 
     return results;
 }
 
+const cv::Mat& NoiseAnalyzer::liveGray(const cv::Mat& frame) {
+    // Reuse the grayscale buffer across frames
+    if (frame.channels() == 3) {
+        cv::cvtColor(frame, m_live_gray, cv::COLOR_BGR2GRAY);
+        return m_live_gray;
+    }
+    if (frame.channels() == 4) {
+        cv::cvtColor(frame, m_live_gray, cv::COLOR_BGRA2GRAY);
+        return m_live_gray;
+    }
+    return frame;
+}
+
+bool NoiseAnalyzer::refineTrack(const cv::Mat& gray, TrackedDot& dot) const {
+    // Window: the search disc plus the background ring around the dot
+    const float search_radius = dot.radius + TRACK_SEARCH_PX;
+    const int half = static_cast<int>(std::ceil(search_radius)) + TRACK_RING_PX + 1;
+    const cv::Rect window = cv::Rect(cvRound(dot.center.x) - half, cvRound(dot.center.y) - half,
+                                     2 * half + 1, 2 * half + 1) & cv::Rect(0, 0, gray.cols, gray.rows);
+    if (window.empty()) {
+        dot.tracked = false;
+        return false;
+    }
+
+    // Intensity-weighted moments of the above-threshold pixels near the last position
+    const float search_sq = search_radius * search_radius;
+    double m0 = 0.0, mx = 0.0, my = 0.0;
+    int area = 0;
+    for (int y = window.y; y < window.y + window.height; ++y) {
+        const uint8_t* row = gray.ptr<uint8_t>(y);
+        const float dy = static_cast<float>(y) - dot.center.y;
+        for (int x = window.x; x < window.x + window.width; ++x) {
+            const float dx = static_cast<float>(x) - dot.center.x;
+            if (row[x] < m_params.threshold_value || dx * dx + dy * dy > search_sq) {
+                continue;
+            }
+            m0 += row[x];
+            mx += static_cast<double>(row[x]) * x;
+            my += static_cast<double>(row[x]) * y;
+            ++area;
+        }
+    }
+
+    const float detected_area = static_cast<float>(CV_PI) * dot.origin_radius * dot.origin_radius;
+    if (m0 <= 0.0 || area < TRACK_MIN_AREA_RATIO * detected_area) {
+        dot.tracked = false;
+        return false;
+    }
+
+    const cv::Point2f center(static_cast<float>(mx / m0), static_cast<float>(my / m0));
+    if (cv::norm(center - dot.center) > TRACK_SEARCH_PX) {
+        dot.tracked = false;  // Jumped further than a dot moves between frames: a neighbour or noise
+        return false;
+    }
+
+    dot.center = center;
+    dot.radius = std::sqrt(static_cast<float>(area) / static_cast<float>(CV_PI));
+    dot.drift_px = static_cast<float>(cv::norm(dot.center - dot.origin));
+    dot.tracked = true;
+
+    // Per-dot SNR: the disc against the ring just outside it
+    const float signal_sq = dot.radius * dot.radius;
+    const float ring_inner_sq = (dot.radius + 1.0f) * (dot.radius + 1.0f);
+    const float ring_outer_sq = (dot.radius + 1.0f + TRACK_RING_PX) * (dot.radius + 1.0f + TRACK_RING_PX);
+    double signal_sum = 0.0, noise_sum = 0.0, noise_sum_sq = 0.0;
+    int signal_count = 0, noise_count = 0;
+    for (int y = window.y; y < window.y + window.height; ++y) {
+        const uint8_t* row = gray.ptr<uint8_t>(y);
+        const float dy = static_cast<float>(y) - dot.center.y;
+        for (int x = window.x; x < window.x + window.width; ++x) {
+            const float dx = static_cast<float>(x) - dot.center.x;
+            const float d_sq = dx * dx + dy * dy;
+            if (d_sq <= signal_sq) {
+                signal_sum += row[x];
+                ++signal_count;
+            } else if (d_sq >= ring_inner_sq && d_sq <= ring_outer_sq) {
+                noise_sum += row[x];
+                noise_sum_sq += static_cast<double>(row[x]) * row[x];
+                ++noise_count;
+            }
+        }
+    }
+
+    if (signal_count > 0 && noise_count > 0) {
+        const double signal_mean = signal_sum / signal_count;
+        const double noise_mean = noise_sum / noise_count;
+        const double noise_std = std::sqrt(std::max(0.0, noise_sum_sq / noise_count - noise_mean * noise_mean));
+        dot.snr_db = noise_std > 0.0 ? 20.0 * std::log10(std::max(signal_mean - noise_mean, 1e-6) / noise_std)
+                                     : std::numeric_limits<double>::infinity();
+    }
+
+    return true;
+}
+
+void NoiseAnalyzer::publishTrackedGeometry() {
+    // Lost dots keep their last position; the label image no longer matches
+    resetSignalMask();
+    for (size_t i = 0; i < m_tracks.size(); ++i) {
+        const TrackedDot& dot = m_tracks[i];
+        m_detected_circles[i] = cv::Vec3f(dot.center.x, dot.center.y, dot.radius);
+        cv::circle(m_signal_mask, cv::Point(cvRound(dot.center.x), cvRound(dot.center.y)),
+                   cvRound(dot.radius), cv::Scalar(255), -1);
+    }
+    m_labels.release();
+    m_component_stats.release();
+    m_accepted_labels.clear();
+    m_noise_mask.release();
+    m_lattice_active = false;   // Dots moved off the grid nodes
+
+    m_shared_signal_mask = std::make_shared<const cv::Mat>(m_signal_mask);
+    m_shared_circles = std::make_shared<const std::vector<cv::Vec3f>>(m_detected_circles);
+}
+
 NoiseAnalysisResults NoiseAnalyzer::processImage(const std::string& image_path,
                                                 const DotDetectionParams& params) {
     NoiseAnalysisResults results;
@@ -321,7 +1350,7 @@ cv::Mat NoiseAnalyzer::visualizeSignal() const {
 }
 
 cv::Mat NoiseAnalyzer::visualizeNoise() const {
-    if (m_image.empty() || m_noise_mask.empty()) {
+    if (m_image.empty() || getNoiseMask().empty()) {
         return cv::Mat();
     }
 
@@ -0,0 +1,43 @@
+#include "pipeline_bus.h"
+
+PipelineBus& PipelineBus::instance() {
+    static PipelineBus bus;
+    return bus;
+}
+
+PipelineBus::PipelineBus()
+    : events_no_buffer_(core::MetricsRegistry::instance().counter("bus.events.no_buffer")) {
+    event_buffers_.reserve(EVENT_BUFFERS);
+    for (int i = 0; i < EVENT_BUFFERS; ++i) {
+        event_buffers_.push_back(std::make_shared<EventBatch>());
+    }
+}
+
+void PipelineBus::publish_events(int camera_index, const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    if (!events_.has_subscribers() || begin == end) {
+        return;
+    }
+
+    // A buffer no subscriber still holds; its capacity is kept between batches
+    std::shared_ptr<EventBatch> batch;
+    {
+        std::lock_guard<std::mutex> lock(event_buffers_mutex_);
+        for (auto& buffer : event_buffers_) {
+            if (buffer.use_count() == 1) {
+                batch = buffer;
+                break;
+            }
+        }
+    }
+    if (!batch) {
+        events_no_buffer_.add();
+        return;
+    }
+    batch->camera_index = camera_index;
+    batch->events.assign(begin, end);
+
+    EventMessage message;
+    message.camera_index = camera_index;
+    message.batch = std::move(batch);
+    events_.publish(message);
+}
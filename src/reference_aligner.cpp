@@ -0,0 +1,104 @@
+#include "reference_aligner.h"
+#include "core/profiler.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+
+void ReferenceAligner::set_reference(const video::BinaryFrame& reference) {
+    reference_ = reference;
+    accumulation_.create(reference.width(), reference.height());
+    frames_ = 0;
+
+    downsample(reference_, reference_small_);
+    if (reference_small_.cols >= 2 && reference_small_.rows >= 2) {
+        cv::createHanningWindow(window_, reference_small_.size(), CV_32F);
+    } else {
+        window_.release();
+    }
+}
+
+void ReferenceAligner::accumulate(const video::BinaryFrame& live) {
+    if (live.size() != accumulation_.size() || live.empty()) {
+        return;
+    }
+    uint64_t* acc = accumulation_.data();
+    const uint64_t* src = live.data();
+    for (size_t i = 0; i < accumulation_.word_count(); ++i) {
+        acc[i] |= src[i];
+    }
+    ++frames_;
+}
+
+bool ReferenceAligner::estimate(const cv::Point& current_offset, Estimate& out) {
+    PROFILE_ZONE("ReferenceAligner::estimate");
+    out = Estimate();
+    out.offset = current_offset;
+
+    if (frames_ == 0 || reference_.empty() || accumulation_.count() < MIN_ACTIVE_PIXELS) {
+        accumulation_.clear();
+        frames_ = 0;
+        return false;
+    }
+
+    // Coarse: phase correlation at reduced resolution (sub-pixel peak)
+    cv::Point coarse = current_offset;
+    if (!window_.empty()) {
+        downsample(accumulation_, live_small_);
+        const cv::Point2d shift = cv::phaseCorrelate(reference_small_, live_small_, window_, &out.response);
+        out.shift = cv::Point2f(static_cast<float>(shift.x * DOWNSAMPLE), static_cast<float>(shift.y * DOWNSAMPLE));
+        if (out.response >= MIN_RESPONSE) {
+            coarse = cv::Point(cvRound(out.shift.x), cvRound(out.shift.y));
+        }
+    }
+
+    // Fine: whole-pixel search on the packed rows around the coarse shift and the current offset
+    out.unmatched_before = unmatched(current_offset);
+    cv::Point best = current_offset;
+    int64_t best_unmatched = out.unmatched_before;
+    for (const cv::Point& center : {coarse, current_offset}) {
+        for (int oy = -REFINE_RADIUS; oy <= REFINE_RADIUS; ++oy) {
+            for (int ox = -REFINE_RADIUS; ox <= REFINE_RADIUS; ++ox) {
+                const cv::Point candidate(center.x + ox, center.y + oy);
+                if (std::abs(candidate.x) > max_shift_px_ || std::abs(candidate.y) > max_shift_px_ ||
+                    candidate == current_offset) {
+                    continue;
+                }
+                const int64_t count = unmatched(candidate);
+                if (count < best_unmatched) {
+                    best_unmatched = count;
+                    best = candidate;
+                }
+            }
+        }
+        if (coarse == current_offset) {
+            break;  // Same neighbourhood twice
+        }
+    }
+
+    // Hysteresis: keep the current offset unless the new one is clearly better
+    if (best != current_offset &&
+        static_cast<double>(out.unmatched_before - best_unmatched) >= MIN_IMPROVEMENT * out.unmatched_before) {
+        out.offset = best;
+        out.unmatched_after = best_unmatched;
+    } else {
+        out.unmatched_after = out.unmatched_before;
+    }
+
+    accumulation_.clear();
+    frames_ = 0;
+    return true;
+}
+
+int64_t ReferenceAligner::unmatched(const cv::Point& offset) {
+    video::BinaryFrame::shift(reference_, offset.x, offset.y, shifted_);
+    return video::BinaryFrame::count_andnot(accumulation_, shifted_);
+}
+
+void ReferenceAligner::downsample(const video::BinaryFrame& frame, cv::Mat& out) {
+    frame.to_mat(unpacked_);
+    cv::Mat small;
+    cv::resize(unpacked_, small, cv::Size(std::max(1, frame.width() / DOWNSAMPLE),
+                                          std::max(1, frame.height() / DOWNSAMPLE)),
+               0, 0, cv::INTER_AREA);
+    small.convertTo(out, CV_32F, 1.0 / 255.0);
+}
@@ -0,0 +1,68 @@
+#include "reference_builder.h"
+#include <algorithm>
+#include <cmath>
+
+void ReferenceBuilder::start(int width, int height, int frames) {
+    width_ = std::max(0, width);
+    height_ = std::max(0, height);
+    target_ = std::clamp(frames, 1, MAX_FRAMES);
+    frames_ = 0;
+
+    bits_ = 1;
+    while ((1 << bits_) <= target_) {
+        ++bits_;
+    }
+    words_ = static_cast<size_t>((width_ + 63) / 64) * height_;
+    planes_.assign(words_ * bits_, 0);
+}
+
+bool ReferenceBuilder::add(const video::BinaryFrame& frame) {
+    if (complete() || frame.width() != width_ || frame.height() != height_) {
+        return false;
+    }
+
+    // Ripple-carry add of one bit per pixel; stops early once no word carries
+    const uint64_t* src = frame.data();
+    for (size_t i = 0; i < words_; ++i) {
+        uint64_t carry = src[i];
+        for (int b = 0; b < bits_ && carry; ++b) {
+            uint64_t& plane = planes_[b * words_ + i];
+            const uint64_t next = plane & carry;
+            plane ^= carry;
+            carry = next;
+        }
+    }
+
+    ++frames_;
+    return complete();
+}
+
+bool ReferenceBuilder::build(float occupancy, video::BinaryFrame& out) const {
+    if (frames_ == 0) {
+        return false;
+    }
+
+    const int threshold = std::clamp(static_cast<int>(std::ceil(occupancy * frames_)), 1, frames_);
+    if (out.width() != width_ || out.height() != height_) {
+        out.create(width_, height_);
+    }
+
+    // count >= threshold, most significant plane first: a pixel is decided
+    // greater at the first bit where it has 1 and the threshold 0
+    uint64_t* dst = out.data();
+    for (size_t i = 0; i < words_; ++i) {
+        uint64_t greater = 0;
+        uint64_t equal = ~uint64_t(0);
+        for (int b = bits_ - 1; b >= 0; --b) {
+            const uint64_t plane = planes_[b * words_ + i];
+            if ((threshold >> b) & 1) {
+                equal &= plane;
+            } else {
+                greater |= equal & plane;
+                equal &= ~plane;
+            }
+        }
+        dst[i] = greater | equal;  // Padding stays zero: its counts are zero and threshold >= 1
+    }
+    return true;
+}
@@ -0,0 +1,566 @@
+#include "run_report.h"
+#include "analysis_shard.h"
+#include "heatmap_timeline.h"
+#include "core/log.h"
+#include "core/run_log.h"
+#include "core/thread_placement.h"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+namespace {
+
+/**
+ * Per-second totals of one camera's run log rows
+ */
+struct SecondBucket {
+    int64_t frames = 0;
+    int64_t events = 0;
+    int64_t scattering_sum = 0;
+    int64_t scattering_frames = 0;
+    int32_t latency_max_us = -1;
+};
+
+struct CameraSeries {
+    int64_t first_ts = -1;                   // Sensor time of the first row (us)
+    std::vector<SecondBucket> seconds;
+};
+
+/**
+ * One plotted curve: x in seconds since the start of the run
+ */
+struct Series {
+    std::vector<double> t;
+    std::vector<double> values;
+};
+
+std::string escape(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        default: out += c;
+        }
+    }
+    return out;
+}
+
+std::string format_number(double value) {
+    char text[32];
+    const double magnitude = std::fabs(value);
+    if (magnitude >= 1e9) {
+        std::snprintf(text, sizeof(text), "%.2fG", value / 1e9);
+    } else if (magnitude >= 1e6) {
+        std::snprintf(text, sizeof(text), "%.2fM", value / 1e6);
+    } else if (magnitude >= 1e4) {
+        std::snprintf(text, sizeof(text), "%.1fk", value / 1e3);
+    } else if (magnitude >= 100 || value == std::floor(value)) {
+        std::snprintf(text, sizeof(text), "%.0f", value);
+    } else {
+        std::snprintf(text, sizeof(text), "%.2f", value);
+    }
+    return text;
+}
+
+std::string format_elapsed(double seconds) {
+    char text[32];
+    const int64_t s = static_cast<int64_t>(seconds + 0.5);
+    if (s >= 3600) {
+        std::snprintf(text, sizeof(text), "%lldh%02lld", static_cast<long long>(s / 3600),
+                      static_cast<long long>(s % 3600 / 60));
+    } else {
+        std::snprintf(text, sizeof(text), "%lld:%02lld", static_cast<long long>(s / 60),
+                      static_cast<long long>(s % 60));
+    }
+    return text;
+}
+
+std::string camera_suffix(int index) {
+    return "_cam" + std::to_string(index);
+}
+
+/**
+ * Counts as a JET heatmap (zero counts black), scaled to max_count
+ */
+cv::Mat render_heatmap(const cv::Mat& counts, int max_count) {
+    cv::Mat normalized;
+    counts.convertTo(normalized, CV_8UC1, max_count > 0 ? 255.0 / max_count : 0.0);
+    cv::Mat heatmap;
+    cv::applyColorMap(normalized, heatmap, cv::COLORMAP_JET);
+    heatmap.setTo(cv::Scalar::all(0), counts == 0);
+    return heatmap;
+}
+
+/**
+ * Line plot on a white canvas (axes, four value ticks, five time ticks)
+ */
+cv::Mat render_plot(const Series& series, const std::string& title) {
+    constexpr int WIDTH = 960;
+    constexpr int HEIGHT = 280;
+    constexpr int LEFT = 70;
+    constexpr int RIGHT = 20;
+    constexpr int TOP = 34;
+    constexpr int BOTTOM = 36;
+    const cv::Scalar axis_colour(160, 160, 160);
+    const cv::Scalar text_colour(40, 40, 40);
+    const int font = cv::FONT_HERSHEY_SIMPLEX;
+
+    cv::Mat plot(HEIGHT, WIDTH, CV_8UC3, cv::Scalar::all(255));
+    cv::putText(plot, title, cv::Point(LEFT, 22), font, 0.55, text_colour, 1, cv::LINE_AA);
+    const cv::Rect area(LEFT, TOP, WIDTH - LEFT - RIGHT, HEIGHT - TOP - BOTTOM);
+    cv::rectangle(plot, area, axis_colour, 1);
+    if (series.t.empty()) {
+        cv::putText(plot, "no data", cv::Point(area.x + area.width / 2 - 30, area.y + area.height / 2), font, 0.5,
+                    text_colour, 1, cv::LINE_AA);
+        return plot;
+    }
+
+    const double t0 = series.t.front();
+    const double t1 = std::max(series.t.back(), t0 + 1.0);
+    const double v0 = std::min(0.0, *std::min_element(series.values.begin(), series.values.end()));
+    double v1 = *std::max_element(series.values.begin(), series.values.end());
+    if (v1 <= v0) {
+        v1 = v0 + 1.0;
+    }
+    auto to_pixel = [&](double t, double v) {
+        return cv::Point(area.x + static_cast<int>((t - t0) / (t1 - t0) * (area.width - 1)),
+                         area.y + area.height - 1 - static_cast<int>((v - v0) / (v1 - v0) * (area.height - 1)));
+    };
+
+    for (int k = 0; k <= 4; ++k) {
+        const double v = v0 + (v1 - v0) * k / 4;
+        const int y = to_pixel(t0, v).y;
+        cv::line(plot, cv::Point(area.x, y), cv::Point(area.x + area.width - 1, y), cv::Scalar::all(230), 1);
+        cv::putText(plot, format_number(v), cv::Point(6, y + 4), font, 0.4, text_colour, 1, cv::LINE_AA);
+    }
+    for (int k = 0; k <= 4; ++k) {
+        const double t = t0 + (t1 - t0) * k / 4;
+        const int x = to_pixel(t, v0).x;
+        cv::putText(plot, format_elapsed(t), cv::Point(std::min(x - 14, WIDTH - 56), HEIGHT - 12), font, 0.4,
+                    text_colour, 1, cv::LINE_AA);
+    }
+
+    std::vector<cv::Point> points;
+    points.reserve(series.t.size());
+    for (size_t i = 0; i < series.t.size(); ++i) {
+        points.push_back(to_pixel(series.t[i], series.values[i]));
+    }
+    cv::polylines(plot, points, false, cv::Scalar(180, 90, 20), 1, cv::LINE_AA);
+    return plot;
+}
+
+/**
+ * Up to TIMELINE_THUMBNAILS snapshots side by side, all scaled to the last one's maximum
+ */
+cv::Mat render_timeline_strip(const std::string& path) {
+    HeatmapTimeline timeline;
+    if (!timeline.open(path) || timeline.size() == 0) {
+        return cv::Mat();
+    }
+
+    const size_t count = std::min<size_t>(timeline.size(), RunReport::TIMELINE_THUMBNAILS);
+    std::vector<size_t> indices;
+    for (size_t k = 0; k < count; ++k) {
+        indices.push_back(count == 1 ? timeline.size() - 1 : (timeline.size() - 1) * (k + 1) / count);
+    }
+    cv::Mat counts;
+    if (!timeline.reconstruct(indices.back(), counts)) {
+        return cv::Mat();
+    }
+    double max_count = 0.0;
+    cv::minMaxLoc(counts, nullptr, &max_count);
+
+    constexpr int THUMB_WIDTH = 240;
+    const int thumb_height = std::max(1, THUMB_WIDTH * timeline.height() / std::max(timeline.width(), 1));
+    std::vector<cv::Mat> thumbnails;
+    for (size_t index : indices) {
+        if (!timeline.reconstruct(index, counts)) {
+            break;
+        }
+        cv::Mat thumb;
+        cv::resize(render_heatmap(counts, static_cast<int>(max_count)), thumb, cv::Size(THUMB_WIDTH, thumb_height),
+                   0.0, 0.0, cv::INTER_AREA);
+        cv::Mat framed(thumb_height + 24, THUMB_WIDTH + 4, CV_8UC3, cv::Scalar::all(255));
+        thumb.copyTo(framed(cv::Rect(2, 0, THUMB_WIDTH, thumb_height)));
+        const double elapsed_s = (timeline.snapshot(index).unix_ms - timeline.start_unix_ms()) / 1000.0;
+        cv::putText(framed, format_elapsed(elapsed_s), cv::Point(4, thumb_height + 17), cv::FONT_HERSHEY_SIMPLEX,
+                    0.45, cv::Scalar::all(40), 1, cv::LINE_AA);
+        thumbnails.push_back(framed);
+    }
+    cv::Mat strip;
+    if (!thumbnails.empty()) {
+        cv::hconcat(thumbnails, strip);
+    }
+    return strip;
+}
+
+/**
+ * Per-second buckets of every camera in the run log (sensor time, rows without one skipped)
+ */
+std::map<int, CameraSeries> read_series(const std::string& path) {
+    std::map<int, CameraSeries> cameras;
+    if (path.empty()) {
+        return cameras;
+    }
+    core::RunLog::read(path, [&](const core::RunLog::Row& row) {
+        if (row.camera_ts < 0) {
+            return;
+        }
+        CameraSeries& camera = cameras[row.camera];
+        if (camera.first_ts < 0) {
+            camera.first_ts = row.camera_ts;
+        }
+        if (row.camera_ts < camera.first_ts) {
+            return;   // Sensor clock restarted (reconnect)
+        }
+        const size_t second = static_cast<size_t>((row.camera_ts - camera.first_ts) / 1000000);
+        if (second >= camera.seconds.size()) {
+            camera.seconds.resize(second + 1);
+        }
+        SecondBucket& bucket = camera.seconds[second];
+        ++bucket.frames;
+        bucket.events += std::max<int64_t>(row.events, 0);
+        if (row.scattering_pixels >= 0) {
+            bucket.scattering_sum += row.scattering_pixels;
+            ++bucket.scattering_frames;
+        }
+        bucket.latency_max_us = std::max(bucket.latency_max_us, row.latency_us);
+    });
+    return cameras;
+}
+
+bool write_png(const std::filesystem::path& directory, const std::string& name, const cv::Mat& image) {
+    try {
+        return !image.empty() && cv::imwrite((directory / name).string(), image);
+    } catch (const cv::Exception&) {
+        return false;
+    }
+}
+
+void write_entries(std::ostream& html, const RunReport::Entries& entries) {
+    if (entries.empty()) {
+        return;
+    }
+    html << "<table class=\"kv\">\n";
+    for (const auto& [label, value] : entries) {
+        html << "<tr><th>" << escape(label) << "</th><td>" << escape(value) << "</td></tr>\n";
+    }
+    html << "</table>\n";
+}
+
+void write_cut_note(std::ostream& html, size_t rows, const std::string& csv) {
+    if (rows > RunReport::MAX_TABLE_ROWS) {
+        html << "<p class=\"note\">First " << RunReport::MAX_TABLE_ROWS << " of " << rows << " rows";
+        if (!csv.empty()) {
+            html << "; all in <a href=\"" << escape(csv) << "\">" << escape(csv) << "</a>";
+        }
+        html << ".</p>\n";
+    }
+}
+
+/**
+ * Time series plots and CSV of one camera, merged into at most MAX_PLOT_POINTS buckets
+ */
+void write_series(std::ostream& html, const std::filesystem::path& directory, int index,
+                  const CameraSeries& series) {
+    const size_t seconds = series.seconds.size();
+    const size_t step = std::max<size_t>(1, (seconds + RunReport::MAX_PLOT_POINTS - 1) / RunReport::MAX_PLOT_POINTS);
+    Series rate;
+    Series scattering;
+    Series latency;
+    const std::string csv_name = "series" + camera_suffix(index) + ".csv";
+    std::ofstream csv(directory / csv_name);
+    csv << "t_s,frames,events_per_s,scattering_per_frame,latency_max_us\n";
+    for (size_t begin = 0; begin < seconds; begin += step) {
+        SecondBucket merged;
+        const size_t end = std::min(begin + step, seconds);
+        for (size_t s = begin; s < end; ++s) {
+            const SecondBucket& bucket = series.seconds[s];
+            merged.frames += bucket.frames;
+            merged.events += bucket.events;
+            merged.scattering_sum += bucket.scattering_sum;
+            merged.scattering_frames += bucket.scattering_frames;
+            merged.latency_max_us = std::max(merged.latency_max_us, bucket.latency_max_us);
+        }
+        if (merged.frames == 0) {
+            continue;   // Stream gap
+        }
+        const double t = static_cast<double>(begin);
+        const double events_per_s = static_cast<double>(merged.events) / (end - begin);
+        rate.t.push_back(t);
+        rate.values.push_back(events_per_s / 1e6);
+        csv << begin << "," << merged.frames << "," << events_per_s << ",";
+        if (merged.scattering_frames > 0) {
+            const double per_frame = static_cast<double>(merged.scattering_sum) / merged.scattering_frames;
+            scattering.t.push_back(t);
+            scattering.values.push_back(per_frame);
+            csv << per_frame;
+        }
+        csv << ",";
+        if (merged.latency_max_us >= 0) {
+            latency.t.push_back(t);
+            latency.values.push_back(merged.latency_max_us / 1000.0);
+            csv << merged.latency_max_us;
+        }
+        csv << "\n";
+    }
+
+    html << "<h3>Time series</h3>\n";
+    const struct {
+        const Series& series;
+        const char* name;
+        const char* title;
+    } plots[] = {
+        {rate, "events", "Event rate (Mev/s)"},
+        {scattering, "scattering", "Scattering pixels per frame"},
+        {latency, "latency", "Worst frame latency (ms)"},
+    };
+    for (const auto& plot : plots) {
+        if (plot.series.t.empty()) {
+            continue;
+        }
+        const std::string name = std::string(plot.name) + camera_suffix(index) + ".png";
+        if (write_png(directory, name, render_plot(plot.series, plot.title))) {
+            html << "<img src=\"" << name << "\" alt=\"" << plot.title << "\">\n";
+        }
+    }
+    html << "<p class=\"note\">Sensor time; " << step << " s per point. Numbers in <a href=\"" << csv_name
+         << "\">" << csv_name << "</a>.</p>\n";
+}
+
+void write_scattering(std::ostream& html, const std::filesystem::path& directory, int index,
+                      const ScatteringAnalyzer::ScatteringData& data) {
+    html << "<h3>Scattering</h3>\n";
+    RunReport::Entries entries = {
+        {"Frames analyzed", std::to_string(data.frames_analyzed)},
+        {"Scattering events", std::to_string(data.total_scattering_events)},
+        {"Per frame", format_number(data.average_scattering_per_frame) + " +/- " +
+                          format_number(data.scattering_ci_half_width) + " px (95 %)"},
+        {"Worst pixel", "(" + std::to_string(data.hot_spot_location.x) + ", " +
+                            std::to_string(data.hot_spot_location.y) + "), " +
+                            std::to_string(data.max_scattering_count) + " frames"},
+    };
+    write_entries(html, entries);
+
+    if (!data.scattering_count.empty() &&
+        write_png(directory, "heatmap" + camera_suffix(index) + ".png",
+                  render_heatmap(data.scattering_count, data.max_scattering_count))) {
+        html << "<img class=\"heatmap\" src=\"heatmap" << camera_suffix(index) << ".png\" alt=\"Final heatmap\">\n";
+    }
+
+    if (!data.hot_pixels.empty()) {
+        const std::string csv_name = "hot_pixels" + camera_suffix(index) + ".csv";
+        std::ofstream csv(directory / csv_name);
+        csv << "x,y,count,first_seen_frame,last_seen_frame\n";
+        html << "<h3>Hot pixels (scattering)</h3>\n<table>\n"
+             << "<tr><th>#</th><th>x</th><th>y</th><th>Frames</th><th>First</th><th>Last</th></tr>\n";
+        for (size_t i = 0; i < data.hot_pixels.size(); ++i) {
+            const auto& pixel = data.hot_pixels[i];
+            csv << pixel.location.x << "," << pixel.location.y << "," << pixel.count << "," << pixel.first_seen_frame
+                << "," << pixel.last_seen_frame << "\n";
+            if (i < RunReport::MAX_TABLE_ROWS) {
+                html << "<tr><td>" << i + 1 << "</td><td>" << pixel.location.x << "</td><td>" << pixel.location.y
+                     << "</td><td>" << pixel.count << "</td><td>" << pixel.first_seen_frame << "</td><td>"
+                     << pixel.last_seen_frame << "</td></tr>\n";
+            }
+        }
+        html << "</table>\n";
+        write_cut_note(html, data.hot_pixels.size(), csv_name);
+    }
+
+    if (!data.regions.empty()) {
+        html << "<h3>Regions</h3>\n<table>\n"
+             << "<tr><th>Region</th><th>Area</th><th>Scattering events</th><th>Per frame</th>"
+             << "<th>Missing per frame</th><th>Worst frame</th></tr>\n";
+        for (const auto& region : data.regions) {
+            html << "<tr><td>" << escape(region.name) << "</td><td>" << region.area << "</td><td>"
+                 << region.total_scattering_events << "</td><td>" << format_number(region.average_scattering_per_frame)
+                 << "</td><td>" << format_number(region.average_missing_per_frame) << "</td><td>"
+                 << region.max_scattering_pixels << "</td></tr>\n";
+        }
+        html << "</table>\n";
+    }
+}
+
+void write_monitors(std::ostream& html, const RunReport::Camera& camera) {
+    if (!camera.flagged.empty()) {
+        html << "<h3>Hot pixels (event rate)</h3>\n<table>\n"
+             << "<tr><th>x</th><th>y</th><th>Flagged at</th><th>ev/s</th><th>Neighbours ev/s</th></tr>\n";
+        for (size_t i = 0; i < std::min(camera.flagged.size(), RunReport::MAX_TABLE_ROWS); ++i) {
+            const auto& pixel = camera.flagged[i];
+            html << "<tr><td>" << pixel.x << "</td><td>" << pixel.y << "</td><td>"
+                 << format_elapsed(pixel.flagged_ts / 1e6) << "</td><td>" << format_number(pixel.events_per_s)
+                 << "</td><td>" << format_number(pixel.neighbour_events_per_s) << "</td></tr>\n";
+        }
+        html << "</table>\n";
+        write_cut_note(html, camera.flagged.size(), std::string());
+    }
+
+    if (!camera.defects.empty()) {
+        html << "<h3>Line defects</h3>\n<table>\n"
+             << "<tr><th>Line</th><th>First</th><th>Last</th><th>Frames</th><th>Fill</th></tr>\n";
+        for (size_t i = 0; i < std::min(camera.defects.size(), RunReport::MAX_TABLE_ROWS); ++i) {
+            const auto& defect = camera.defects[i];
+            html << "<tr><td>" << (defect.column ? "column " : "row ") << defect.index << "</td><td>"
+                 << format_elapsed(defect.first_ts / 1e6) << "</td><td>" << format_elapsed(defect.last_ts / 1e6)
+                 << "</td><td>" << defect.frames_flagged << "</td><td>" << format_number(defect.fill * 100.0f)
+                 << " %</td></tr>\n";
+        }
+        html << "</table>\n";
+        write_cut_note(html, camera.defects.size(), std::string());
+    }
+
+    if (camera.toggles_enabled && camera.toggles.windows > 0) {
+        html << "<h3>Pixel toggles</h3>\n";
+        write_entries(html, {
+            {"Stuck", std::to_string(camera.toggles.stuck)},
+            {"Flickering", std::to_string(camera.toggles.flickering)},
+            {"Normal", std::to_string(camera.toggles.normal)},
+            {"Window", std::to_string(camera.toggles.window_frames) + " frames (" +
+                           std::to_string(camera.toggles.windows) + " windows)"},
+        });
+    }
+}
+
+const char* STYLE =
+    "body{font-family:sans-serif;margin:24px;color:#222}"
+    "h1{margin-bottom:4px}h2{border-bottom:1px solid #ccc;margin-top:32px}"
+    "table{border-collapse:collapse;margin:8px 0}th,td{border:1px solid #ccc;padding:2px 8px;text-align:right}"
+    "table.kv th{text-align:left;background:#f4f4f4}img{display:block;margin:8px 0;max-width:100%}"
+    "img.heatmap{image-rendering:pixelated}.note{color:#666;font-size:90%}"
+    "@media print{h2{page-break-before:always}img{page-break-inside:avoid}}";
+
+} // namespace
+
+bool RunReport::start(Inputs inputs) {
+    if (busy_.exchange(true)) {
+        return false;
+    }
+    if (thread_.joinable()) {
+        thread_.join();   // Finished: busy_ was clear
+    }
+    thread_ = std::thread([this, inputs = std::move(inputs)]() {
+        core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::IO);
+        const auto begin = std::chrono::steady_clock::now();
+        std::string index_path;
+        if (write(inputs, index_path)) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                last_report_ = index_path;
+            }
+            written_++;
+            core::LogLine(core::LogLevel::Info)
+                << "Run report: " << index_path << " in "
+                << std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() << " s";
+        } else {
+            failed_++;
+            core::LogLine(core::LogLevel::Warning) << "Run report: cannot write " << inputs.directory;
+        }
+        busy_ = false;
+    });
+    return true;
+}
+
+void RunReport::wait() {
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::string RunReport::get_last_report() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_report_;
+}
+
+bool RunReport::write(const Inputs& inputs, std::string& index_path) {
+    namespace fs = std::filesystem;
+    const fs::path directory(inputs.directory);
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    const fs::path index = directory / "index.html";
+    std::ofstream html(index);
+    if (!html) {
+        return false;
+    }
+
+    const std::time_t now = std::time(nullptr);
+    char generated[32] = {};
+    std::strftime(generated, sizeof(generated), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+    html << "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>" << escape(inputs.title)
+         << "</title>\n<style>" << STYLE << "</style></head><body>\n"
+         << "<h1>" << escape(inputs.title) << "</h1>\n<p class=\"note\">Generated " << generated << "</p>\n";
+    write_entries(html, inputs.summary);
+
+    const std::map<int, CameraSeries> series = read_series(inputs.run_log);
+    for (const Camera& camera : inputs.cameras) {
+        html << "<h2>Camera " << camera.index;
+        if (!camera.serial.empty()) {
+            html << " (" << escape(camera.serial) << ")";
+        }
+        html << "</h2>\n";
+        write_entries(html, camera.summary);
+
+        // Final analyzer state, or the last checkpoint of a run that never stopped cleanly
+        std::shared_ptr<const ScatteringAnalyzer::ScatteringData> scattering = camera.scattering;
+        if (!scattering && !camera.checkpoint.empty() && fs::exists(camera.checkpoint, ec)) {
+            AnalysisShard shard;
+            if (shard.load(camera.checkpoint)) {
+                auto data = std::make_shared<ScatteringAnalyzer::ScatteringData>();
+                shard.publish(*data);
+                scattering = data;
+                html << "<p class=\"note\">From checkpoint " << escape(camera.checkpoint) << ".</p>\n";
+            }
+        }
+        if (scattering && scattering->frames_analyzed > 0) {
+            write_scattering(html, directory, camera.index, *scattering);
+        }
+
+        if (!camera.heatmap_timeline.empty()) {
+            const std::string name = "heatmap_timeline" + camera_suffix(camera.index) + ".png";
+            if (write_png(directory, name, render_timeline_strip(camera.heatmap_timeline))) {
+                html << "<h3>Heatmap over the run</h3>\n<img src=\"" << name << "\" alt=\"Heatmap snapshots\">\n";
+            }
+        }
+
+        const auto found = series.find(camera.index);
+        if (found != series.end()) {
+            write_series(html, directory, camera.index, found->second);
+        }
+        write_monitors(html, camera);
+    }
+
+    // Relative links, so the package can be moved together with the run's files
+    bool listed = false;
+    for (const std::string& file : inputs.files) {
+        if (file.empty() || !fs::exists(file, ec)) {
+            continue;
+        }
+        if (!listed) {
+            html << "<h2>Files</h2>\n<ul>\n";
+            listed = true;
+        }
+        const fs::path relative = fs::relative(file, directory, ec);
+        const std::string href = (ec || relative.empty() ? fs::path(file) : relative).generic_string();
+        html << "<li><a href=\"" << escape(href) << "\">" << escape(fs::path(file).filename().string())
+             << "</a></li>\n";
+    }
+    if (listed) {
+        html << "</ul>\n";
+    }
+    html << "</body></html>\n";
+
+    html.close();
+    index_path = index.string();
+    return static_cast<bool>(html);
+}
@@ -1,8 +1,32 @@
 #include "scattering_analyzer.h"
+#include "analysis_shard.h"
+#include "core/alloc_tracker.h"
+#include "core/log.h"
+#include "core/profiler.h"
+#include "video/simd_utils.h"
+#include "video/thread_pool.h"
 #include <opencv2/imgproc.hpp>
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 
+namespace {
+
+/**
+ * Add the set bits of a mask word to the 4 tiles it spans (16 pixels each)
+ */
+inline void add_tile_counts(uint16_t* tiles, uint64_t word) {
+    static_assert(ScatteringAnalyzer::TILE * 4 == 64, "A mask word must span exactly 4 tiles");
+    tiles[0] += static_cast<uint16_t>(video::BinaryFrame::popcount(word & 0xFFFF));
+    tiles[1] += static_cast<uint16_t>(video::BinaryFrame::popcount((word >> 16) & 0xFFFF));
+    tiles[2] += static_cast<uint16_t>(video::BinaryFrame::popcount((word >> 32) & 0xFFFF));
+    tiles[3] += static_cast<uint16_t>(video::BinaryFrame::popcount(word >> 48));
+}
+
+} // namespace
+
 ScatteringAnalyzer::ScatteringAnalyzer() : analyzing_(false) {
 }
 
@@ -17,13 +41,43 @@ bool ScatteringAnalyzer::start_analysis(const cv::Mat& reference_image) {
         return false;
     }
 
-    // Store reference image
-    reference_image_ = reference_image.clone();
+    return start_analysis(video::BinaryFrame::from_mat(reference_image));
+}
+
+bool ScatteringAnalyzer::start_analysis(const video::BinaryFrame& reference_image) {
+    return start_analysis(std::make_shared<const video::BinaryFrame>(reference_image));
+}
+
+bool ScatteringAnalyzer::start_analysis(ReferenceHandle reference_image) {
+    if (!reference_image || reference_image->empty()) {
+        std::cerr << "ScatteringAnalyzer: Cannot start with empty reference image" << std::endl;
+        return false;
+    }
+
+    // Keep the shared original; reference_bits_ is the working copy that alignment shifts
+    reference_original_ = std::move(reference_image);
+    reference_bits_ = *reference_original_;
+    reference_runs_.assign(reference_bits_);
+    data_.reference_offset = cv::Point(0, 0);
+    data_.alignment_shift = cv::Point2f(0.0f, 0.0f);
+    data_.alignment_response = 0.0f;
+    const cv::Size size = reference_bits_.size();
 
     // Initialize data structures
-    data_.scattering_mask = cv::Mat::zeros(reference_image.size(), CV_8UC1);
-    data_.scattering_count = cv::Mat::zeros(reference_image.size(), CV_32SC1);
-    data_.scattering_heatmap = cv::Mat::zeros(reference_image.size(), CV_8UC1);
+    data_.scattering_bits.create(size.width, size.height);
+    touched_keys_.clear();
+    mask_from_touched_ = false;
+    mask_blocks_valid_ = false;
+    data_.scattering_mask = cv::Mat::zeros(size, CV_8UC1);
+    data_.scattering_heatmap = cv::Mat::zeros(size, CV_8UC1);
+    candidate_pixels_ = int64_t(size.width) * size.height - reference_bits_.count();
+    reset_counts();
+    reset_rolling_stats();
+    build_region_index();
+    reset_plane_stats();
+    reset_tile_stats();
+    build_comparison_references();
+    reset_cluster_stats();
 
     // Reset counters
     data_.current_scattering_pixels = 0;
@@ -33,73 +87,506 @@ bool ScatteringAnalyzer::start_analysis(const cv::Mat& reference_image) {
     data_.hot_spot_location = cv::Point(0, 0);
     data_.total_scattering_events = 0;
     data_.average_scattering_per_frame = 0.0f;
+    reset_confidence();
+    heatmap_scale_max_ = 0;
 
     analyzing_ = true;
     std::cout << "Scattering analysis started with reference image "
-              << reference_image.cols << "x" << reference_image.rows << std::endl;
+              << size.width << "x" << size.height << std::endl;
     return true;
 }
 
 bool ScatteringAnalyzer::analyze_frame(const cv::Mat& live_image) {
+    PROFILE_ZONE("ScatteringAnalyzer::analyze_frame");
+    ALLOC_SCOPE("scattering");
+    // Called per frame: a persistent mismatch must not flood the console
+    static core::LogSite not_started_site(1000);
+    static core::LogSite mismatch_site(1000);
     if (!analyzing_) {
-        std::cerr << "ScatteringAnalyzer: Analysis not started" << std::endl;
+        core::LogLine(core::LogLevel::Error, &not_started_site) << "ScatteringAnalyzer: Analysis not started";
         return false;
     }
 
-    if (live_image.empty() || live_image.size() != reference_image_.size()) {
-        std::cerr << "ScatteringAnalyzer: Live image size mismatch" << std::endl;
+    if (plane_sweep_) {
+        if (!analyze_planes(live_image)) {
+            return false;
+        }
+    } else {
+        if (live_image.empty() || live_image.type() != CV_8UC1 || live_image.size() != reference_bits_.size() ||
+            !live_bits_.assign_masked(live_image, live_mask_)) {
+            core::LogLine(core::LogLevel::Error, &mismatch_site)
+                << "ScatteringAnalyzer: Live image size mismatch (" << live_image.cols << "x" << live_image.rows
+                << ", reference " << reference_bits_.width() << "x" << reference_bits_.height() << ")";
+            return false;
+        }
+
+        if (!analyze_frame(live_bits_)) {
+            return false;
+        }
+    }
+
+    // Legacy callers read the unpacked mask
+    data_.scattering_bits.to_mat(data_.scattering_mask);
+    return true;
+}
+
+bool ScatteringAnalyzer::analyze_planes(const cv::Mat& live_image) {
+    PROFILE_ZONE("ScatteringAnalyzer::analyze_planes");
+    static core::LogSite not_started_site(1000);
+    static core::LogSite mismatch_site(1000);
+    if (!analyzing_) {
+        core::LogLine(core::LogLevel::Error, &not_started_site) << "ScatteringAnalyzer: Analysis not started";
+        return false;
+    }
+
+    if (live_image.empty() || live_image.type() != CV_8UC1 || live_image.size() != reference_bits_.size()) {
+        core::LogLine(core::LogLevel::Error, &mismatch_site)
+            << "ScatteringAnalyzer: Live image size mismatch (" << live_image.cols << "x" << live_image.rows
+            << ", reference " << reference_bits_.width() << "x" << reference_bits_.height() << ")";
         return false;
     }
 
-    // Detect scattering pixels: active in live but NOT in reference
-    // scattering_mask = live AND NOT reference
-    cv::Mat not_reference;
-    cv::bitwise_not(reference_image_, not_reference);
-    cv::bitwise_and(live_image, not_reference, data_.scattering_mask);
+    // One transpose pass yields every plane; the live mask is then a word-wise OR
+    video::simd::split_bit_planes(live_image, plane_bits_);
+    if (live_bits_.size() != reference_bits_.size()) {
+        live_bits_.create(reference_bits_.width(), reference_bits_.height());
+    }
+    uint64_t* live = live_bits_.data();
+    const size_t words = live_bits_.word_count();
+    std::fill(live, live + words, 0);
+    for (int b = 0; b < 8; ++b) {
+        if (!((live_mask_ >> b) & 1)) continue;
+        const uint64_t* plane = plane_bits_[b].data();
+        for (size_t i = 0; i < words; ++i) {
+            live[i] |= plane[i];
+        }
+    }
 
-    // Count scattering pixels in current frame
-    data_.current_scattering_pixels = cv::countNonZero(data_.scattering_mask);
-    int total_pixels = live_image.cols * live_image.rows;
+    if (!analyze_frame(live_bits_)) {
+        return false;
+    }
+    update_planes();
+    return true;
+}
+
+bool ScatteringAnalyzer::analyze_frame(const video::BinaryFrame& live_image, const video::BlockMap* blocks) {
+    PROFILE_ZONE("ScatteringAnalyzer::analyze_frame");
+    ALLOC_SCOPE("scattering");
+    static core::LogSite not_started_site(1000);
+    static core::LogSite mismatch_site(1000);
+    if (!analyzing_) {
+        core::LogLine(core::LogLevel::Error, &not_started_site) << "ScatteringAnalyzer: Analysis not started";
+        return false;
+    }
+
+    if (live_image.empty() || live_image.size() != reference_bits_.size()) {
+        core::LogLine(core::LogLevel::Error, &mismatch_site)
+            << "ScatteringAnalyzer: Live image size mismatch (" << live_image.width() << "x" << live_image.height()
+            << ", reference " << reference_bits_.width() << "x" << reference_bits_.height() << ")";
+        return false;
+    }
+
+    // Single fused pass over packed words: scattering = live AND NOT reference,
+    // then bump the temporal count of each set bit and track the running max.
+    // Counts only ever grow, so the hot spot never needs a full rescan.
+    video::BinaryFrame& mask = data_.scattering_bits;
+    int scattering_pixels = 0;
+    int max_count = data_.max_scattering_count;
+    cv::Point hot_spot = data_.hot_spot_location;
+    hot_pixels_changed_ = false;
+    mask_from_touched_ = false;   // Every word is rewritten
+    if (!tile_frame_.empty()) {
+        tile_frame_.setTo(0);
+    }
+    if (blocks && !blocks->matches(mask.width(), mask.height())) {
+        blocks = nullptr;
+    }
+
+    // Large frames are split into row bands across the pool
+    video::ThreadPool& pool = pool_ ? *pool_ : video::ThreadPool::shared();
+    if (parallel_ && pool.concurrency() > 1 &&
+            static_cast<int64_t>(mask.width()) * mask.height() >= PARALLEL_MIN_PIXELS) {
+        scan_bands(live_image, blocks, pool, scattering_pixels, max_count, hot_spot);
+    } else {
+        scan_rows(live_image, blocks, 0, mask.height(), scattering_pixels, max_count, hot_spot);
+    }
+
+    // The mask now has bits only where this frame's map has blocks
+    mask_blocks_valid_ = blocks != nullptr;
+    if (blocks) {
+        mask_blocks_ = *blocks;
+    }
+
+    data_.max_scattering_count = max_count;
+    data_.hot_spot_location = hot_spot;
+    if (hot_pixels_changed_) {
+        publish_hot_pixels();
+    }
+
+    // Too many touched pixels for the hash map to pay off: switch to dense for good
+    if (sparse_ && sparse_counts_.size() >
+            static_cast<size_t>(sparse_density_threshold_ * mask.width() * mask.height())) {
+        densify_counts();
+    }
+    data_.current_scattering_pixels = scattering_pixels;
+    int total_pixels = mask.width() * mask.height();
     data_.current_scattering_percentage =
         (float)data_.current_scattering_pixels / total_pixels * 100.0f;
 
-    // Update temporal tracking
-    // Increment count for each pixel that is scattering
-    for (int y = 0; y < data_.scattering_mask.rows; ++y) {
-        const uint8_t* mask_row = data_.scattering_mask.ptr<uint8_t>(y);
-        int32_t* count_row = data_.scattering_count.ptr<int32_t>(y);
+    data_.frames_analyzed++;
+    update_statistics();
+    update_window();
+    update_decay();
+    update_regions(live_image);
+    update_references(live_image);
+    update_tiles();
+    update_clusters();
+    update_heatmap();
 
-        for (int x = 0; x < data_.scattering_mask.cols; ++x) {
-            if (mask_row[x] > 0) {
-                count_row[x]++;
-            }
+    return true;
+}
+
+bool ScatteringAnalyzer::analyze_touched(const std::vector<uint32_t>& keys) {
+    PROFILE_ZONE("ScatteringAnalyzer::analyze_touched");
+    ALLOC_SCOPE("scattering");
+    static core::LogSite not_started_site(1000);
+    static core::LogSite unsupported_site(1000);
+    if (!analyzing_) {
+        core::LogLine(core::LogLevel::Error, &not_started_site) << "ScatteringAnalyzer: Analysis not started";
+        return false;
+    }
+    if (!supports_touched_input()) {
+        core::LogLine(core::LogLevel::Error, &unsupported_site)
+            << "ScatteringAnalyzer: Regions, comparison references, plane sweep, tile map and polarity masks need frames";
+        return false;
+    }
+
+    // Only the previous window's pixels can be set, so clear those instead of the whole mask
+    video::BinaryFrame& mask = data_.scattering_bits;
+    const uint32_t width = static_cast<uint32_t>(mask.width());
+    if (mask_from_touched_) {
+        for (uint32_t key : touched_keys_) {
+            mask.set(static_cast<int>(key % width), static_cast<int>(key / width), false);
         }
+    } else {
+        mask.clear();
     }
+    touched_keys_.assign(keys.begin(), keys.end());
+    mask_from_touched_ = true;
+    mask_blocks_valid_ = false;
+
+    // Same counting as scan_rows, driven by the list instead of mask words
+    const int32_t frame_index = data_.frames_analyzed;
+    int max_count = data_.max_scattering_count;
+    cv::Point hot_spot = data_.hot_spot_location;
+    hot_pixels_changed_ = false;
+    for (uint32_t key : keys) {
+        const int x = static_cast<int>(key % width);
+        const int y = static_cast<int>(key / width);
+        mask.set(x, y, true);
+
+        int32_t count;
+        int32_t first_seen;
+        if (!sparse_) {
+            uint16_t& cell = dense_counts_.ptr<uint16_t>(y)[x];
+            int32_t& first = first_seen_.ptr<int32_t>(y)[x];
+            count = cell != COUNT_SATURATED ? ++cell : COUNT_SATURATED + ++count_overflow_[key];
+            if (count == 1) first = frame_index;
+            first_seen = first;
+        } else {
+            SparseCount& entry = sparse_counts_[key];
+            count = ++entry.count;
+            if (count == 1) entry.first_seen = frame_index;
+            first_seen = entry.first_seen;
+        }
+
+        if (count > max_count) {
+            max_count = count;
+            hot_spot = cv::Point(x, y);
+        }
+        if (count > hot_min_count_) {
+            track_hot_pixel(cv::Point(x, y), count, first_seen, frame_index);
+        }
+    }
+
+    data_.max_scattering_count = max_count;
+    data_.hot_spot_location = hot_spot;
+    if (hot_pixels_changed_) {
+        publish_hot_pixels();
+    }
+    if (sparse_ && sparse_counts_.size() >
+            static_cast<size_t>(sparse_density_threshold_ * mask.width() * mask.height())) {
+        densify_counts();
+    }
+    data_.current_scattering_pixels = static_cast<int>(keys.size());
+    data_.current_scattering_percentage =
+        (float)data_.current_scattering_pixels / (mask.width() * mask.height()) * 100.0f;
 
     data_.frames_analyzed++;
     update_statistics();
-    update_heatmap();
-    detect_hot_spots();
+    update_window();
+    update_decay();
+    update_clusters();
+    update_heatmap(&keys);
 
     return true;
 }
 
+bool ScatteringAnalyzer::analyze_runs(const video::RunFrame& live_runs) {
+    PROFILE_ZONE("ScatteringAnalyzer::analyze_runs");
+    ALLOC_SCOPE("scattering");
+    static core::LogSite mismatch_site(1000);
+    if (analyzing_ && live_runs.size() != reference_runs_.size()) {
+        core::LogLine(core::LogLevel::Error, &mismatch_site)
+            << "ScatteringAnalyzer: Live image size mismatch (" << live_runs.width() << "x" << live_runs.height()
+            << ", reference " << reference_runs_.width() << "x" << reference_runs_.height() << ")";
+        return false;
+    }
+
+    // Scattering runs expand to the same key list the event tap produces
+    run_keys_.clear();
+    if (analyzing_) {
+        video::RunFrame::bitwise_andnot(live_runs, reference_runs_, scattering_runs_);
+        const uint32_t width = static_cast<uint32_t>(scattering_runs_.width());
+        scattering_runs_.for_each_pixel([this, width](int x, int y) {
+            run_keys_.push_back(static_cast<uint32_t>(y) * width + static_cast<uint32_t>(x));
+        });
+    }
+    return analyze_touched(run_keys_);   // Reports not started / unsupported configurations
+}
+
+void ScatteringAnalyzer::scan_rows(const video::BinaryFrame& live_image, const video::BlockMap* blocks, int y_begin, int y_end,
+                                   int& scattering_pixels, int& max_count, cv::Point& hot_spot) {
+    video::BinaryFrame& mask = data_.scattering_bits;
+    const int words_per_row = mask.words_per_row();
+    const int32_t frame_index = data_.frames_analyzed;
+
+    for (int y = y_begin; y < y_end; ++y) {
+        if (skip_scan_row(blocks, y)) {
+            continue;
+        }
+        const int by = y >> video::BlockMap::ROW_SHIFT;
+        const uint64_t* live_row = live_image.row(y);
+        const uint64_t* ref_row = reference_bits_.row(y);
+        uint64_t* mask_row = mask.row(y);
+        uint16_t* count_row = sparse_ ? nullptr : dense_counts_.ptr<uint16_t>(y);
+        int32_t* first_row = sparse_ ? nullptr : first_seen_.ptr<int32_t>(y);
+        uint16_t* tile_row = tile_frame_.empty() ? nullptr : tile_frame_.ptr<uint16_t>(y / TILE);
+        const uint32_t row_key = static_cast<uint32_t>(y) * mask.width();
+
+        for (int w = 0; w < words_per_row; ++w) {
+            if (blocks && !blocks->block(w, by)) {
+                mask_row[w] = 0;   // No event in this block
+                continue;
+            }
+            uint64_t word = live_row[w] & ~ref_row[w];  // Padding bits are zero in both
+            mask_row[w] = word;
+            if (tile_row && word) {
+                add_tile_counts(tile_row + w * 4, word);
+            }
+
+            // Only set bits are visited, so sparse noise costs far less than a per-pixel sweep
+            while (word) {
+                const int x = w * 64 + video::BinaryFrame::lowest_set_bit(word);
+                int32_t count;
+                int32_t first_seen;
+                if (count_row) {
+                    uint16_t& cell = count_row[x];
+                    count = cell != COUNT_SATURATED ? ++cell : COUNT_SATURATED + ++count_overflow_[row_key + x];
+                    if (count == 1) first_row[x] = frame_index;
+                    first_seen = first_row[x];
+                } else {
+                    SparseCount& entry = sparse_counts_[row_key + x];
+                    count = ++entry.count;
+                    if (count == 1) entry.first_seen = frame_index;
+                    first_seen = entry.first_seen;
+                }
+
+                if (count > max_count) {
+                    max_count = count;
+                    hot_spot = cv::Point(x, y);
+                }
+                // Most pixels fail this check, so the top-K list is rarely touched
+                if (count > hot_min_count_) {
+                    track_hot_pixel(cv::Point(x, y), count, first_seen, frame_index);
+                }
+                word &= word - 1;  // Clear lowest set bit
+                ++scattering_pixels;
+            }
+        }
+    }
+}
+
+void ScatteringAnalyzer::scan_bands(const video::BinaryFrame& live_image, const video::BlockMap* blocks, video::ThreadPool& pool,
+                                    int& scattering_pixels, int& max_count, cv::Point& hot_spot) {
+    video::BinaryFrame& mask = data_.scattering_bits;
+    const int words_per_row = mask.words_per_row();
+    const int32_t frame_index = data_.frames_analyzed;
+
+    // Live, reference and mask words plus the dense count and first-seen rows
+    const size_t bytes_per_row = static_cast<size_t>(words_per_row) * sizeof(uint64_t) * 3 +
+                                 (sparse_ ? 0 : static_cast<size_t>(mask.width()) * (sizeof(uint16_t) + sizeof(int32_t)));
+    int rows_per_band = video::ThreadPool::band_rows(mask.height(), bytes_per_row);
+    if (!tile_frame_.empty()) {
+        rows_per_band = (rows_per_band + TILE - 1) / TILE * TILE;  // A tile row belongs to one band
+    }
+    const int band_count = (mask.height() + rows_per_band - 1) / rows_per_band;
+    if (static_cast<int>(bands_.size()) < band_count) {
+        bands_.resize(band_count);
+    }
+
+    // Bands only read these; the top-K list and hash map are touched in the merge
+    const int32_t hot_min_snapshot = hot_min_count_;
+    const int max_snapshot = max_count;
+    const cv::Point hot_spot_snapshot = hot_spot;
+
+    pool.parallel_for(band_count, [&](int b) {
+        ScanBand& band = bands_[b];
+        band.scattering_pixels = 0;
+        band.max_count = max_snapshot;
+        band.hot_spot = hot_spot_snapshot;
+        band.candidates.clear();
+        band.keys.clear();
+
+        const int y_end = std::min(mask.height(), (b + 1) * rows_per_band);
+        for (int y = b * rows_per_band; y < y_end; ++y) {
+            if (skip_scan_row(blocks, y)) {
+                continue;
+            }
+            const int by = y >> video::BlockMap::ROW_SHIFT;
+            const uint64_t* live_row = live_image.row(y);
+            const uint64_t* ref_row = reference_bits_.row(y);
+            uint64_t* mask_row = mask.row(y);
+            uint16_t* count_row = sparse_ ? nullptr : dense_counts_.ptr<uint16_t>(y);
+            int32_t* first_row = sparse_ ? nullptr : first_seen_.ptr<int32_t>(y);
+            uint16_t* tile_row = tile_frame_.empty() ? nullptr : tile_frame_.ptr<uint16_t>(y / TILE);
+            const uint32_t row_key = static_cast<uint32_t>(y) * mask.width();
+
+            for (int w = 0; w < words_per_row; ++w) {
+                if (blocks && !blocks->block(w, by)) {
+                    mask_row[w] = 0;
+                    continue;
+                }
+                uint64_t word = live_row[w] & ~ref_row[w];
+                mask_row[w] = word;
+                band.scattering_pixels += video::BinaryFrame::popcount(word);
+                if (tile_row && word) {
+                    add_tile_counts(tile_row + w * 4, word);
+                }
+
+                while (word) {
+                    const int x = w * 64 + video::BinaryFrame::lowest_set_bit(word);
+                    word &= word - 1;
+                    if (!count_row || count_row[x] == COUNT_SATURATED) {
+                        band.keys.push_back(row_key + x);  // Hash maps are not thread-safe
+                        continue;
+                    }
+
+                    const int32_t count = ++count_row[x];
+                    if (count == 1) first_row[x] = frame_index;
+                    if (count > band.max_count) {
+                        band.max_count = count;
+                        band.hot_spot = cv::Point(x, y);
+                    }
+                    // The threshold only rises during the merge, so this is a superset
+                    if (count > hot_min_snapshot) {
+                        band.candidates.push_back({cv::Point(x, y), count, first_row[x]});
+                    }
+                }
+            }
+        }
+    });
+
+    // Merge in raster order so max, hot spot and top-K match the serial scan
+    for (int b = 0; b < band_count; ++b) {
+        const ScanBand& band = bands_[b];
+        scattering_pixels += band.scattering_pixels;
+
+        if (sparse_) {
+            for (uint32_t key : band.keys) {
+                SparseCount& entry = sparse_counts_[key];
+                const int32_t count = ++entry.count;
+                if (count == 1) entry.first_seen = frame_index;
+
+                const cv::Point location(static_cast<int>(key % mask.width()),
+                                         static_cast<int>(key / mask.width()));
+                if (count > max_count) {
+                    max_count = count;
+                    hot_spot = location;
+                }
+                if (count > hot_min_count_) {
+                    track_hot_pixel(location, count, entry.first_seen, frame_index);
+                }
+            }
+            continue;
+        }
+
+        if (band.max_count > max_count) {
+            max_count = band.max_count;
+            hot_spot = band.hot_spot;
+        }
+        for (const HotCandidate& candidate : band.candidates) {
+            if (candidate.count > hot_min_count_) {
+                track_hot_pixel(candidate.location, candidate.count, candidate.first_seen, frame_index);
+            }
+        }
+
+        // Saturated pixels: above every unsaturated count, so raster order among them is enough
+        for (uint32_t key : band.keys) {
+            const int32_t count = COUNT_SATURATED + ++count_overflow_[key];
+            const cv::Point location(static_cast<int>(key % mask.width()),
+                                     static_cast<int>(key / mask.width()));
+            if (count > max_count) {
+                max_count = count;
+                hot_spot = location;
+            }
+            if (count > hot_min_count_) {
+                track_hot_pixel(location, count, first_seen_.ptr<int32_t>(location.y)[location.x], frame_index);
+            }
+        }
+    }
+}
+
 void ScatteringAnalyzer::stop_analysis() {
     analyzing_ = false;
     std::cout << "Scattering analysis stopped after " << data_.frames_analyzed << " frames" << std::endl;
     std::cout << "Total scattering events: " << data_.total_scattering_events << std::endl;
     std::cout << "Average per frame: " << data_.average_scattering_per_frame << std::endl;
+    for (const RegionStats& region : data_.regions) {
+        std::cout << "  Region " << region.name << ": " << region.total_scattering_events
+                  << " scattering, " << region.average_scattering_per_frame << " per frame, "
+                  << region.average_missing_per_frame << " missing per frame" << std::endl;
+    }
+    if (cluster_stats_) {
+        std::cout << "  Clusters: " << data_.clusters.total_clusters << " ("
+                  << data_.clusters.total_single_pixel << " single pixels), "
+                  << data_.clusters.average_clusters_per_frame << " per frame, largest "
+                  << data_.clusters.max_largest_pixels << " pixels" << std::endl;
+    }
+    for (size_t b = 0; b < data_.planes.size(); ++b) {
+        std::cout << "  Bit plane " << b << ": " << data_.planes[b].total_scattering_events
+                  << " scattering, " << data_.planes[b].average_scattering_per_frame << " per frame" << std::endl;
+    }
 }
 
 void ScatteringAnalyzer::reset_temporal_data() {
     if (!analyzing_) return;
 
-    data_.scattering_count = cv::Mat::zeros(reference_image_.size(), CV_32SC1);
-    data_.scattering_heatmap = cv::Mat::zeros(reference_image_.size(), CV_8UC1);
+    reset_counts();
+    reset_rolling_stats();
+    reset_region_stats();
+    reset_plane_stats();
+    reset_tile_stats();
+    reset_reference_stats();
+    reset_cluster_stats();
+    data_.scattering_heatmap = cv::Mat::zeros(reference_bits_.size(), CV_8UC1);
     data_.frames_analyzed = 0;
     data_.max_scattering_count = 0;
+    data_.hot_spot_location = cv::Point(0, 0);
     data_.total_scattering_events = 0;
     data_.average_scattering_per_frame = 0.0f;
+    reset_confidence();
+    heatmap_scale_max_ = 0;
 
     std::cout << "Scattering temporal data reset" << std::endl;
 }
@@ -108,6 +595,7 @@ cv::Mat ScatteringAnalyzer::create_scattering_visualization(
     const cv::Mat& live_image,
     const cv::Scalar& highlight_color
 ) const {
+    PROFILE_ZONE("ScatteringAnalyzer::create_scattering_visualization");
     if (live_image.empty()) {
         return cv::Mat();
     }
@@ -121,12 +609,16 @@ cv::Mat ScatteringAnalyzer::create_scattering_visualization(
     }
 
     // Highlight scattering pixels
-    for (int y = 0; y < data_.scattering_mask.rows; ++y) {
-        const uint8_t* mask_row = data_.scattering_mask.ptr<uint8_t>(y);
+    const video::BinaryFrame& mask = data_.scattering_bits;
+    if (mask.size() != visualization.size()) {
+        return visualization;
+    }
+
+    for (int y = 0; y < mask.height(); ++y) {
         cv::Vec3b* vis_row = visualization.ptr<cv::Vec3b>(y);
 
-        for (int x = 0; x < data_.scattering_mask.cols; ++x) {
-            if (mask_row[x] > 0) {
+        for (int x = 0; x < mask.width(); ++x) {
+            if (mask.get(x, y)) {
                 // Replace pixel with highlight color
                 vis_row[x] = cv::Vec3b(
                     static_cast<uint8_t>(highlight_color[0]),
@@ -141,25 +633,29 @@ cv::Mat ScatteringAnalyzer::create_scattering_visualization(
 }
 
 cv::Mat ScatteringAnalyzer::create_heatmap_visualization() const {
-    if (data_.scattering_count.empty() || data_.max_scattering_count == 0) {
-        return cv::Mat::zeros(reference_image_.size(), CV_8UC3);
+    PROFILE_ZONE("ScatteringAnalyzer::create_heatmap_visualization");
+    if (reference_bits_.empty() || data_.max_scattering_count == 0) {
+        return cv::Mat::zeros(reference_bits_.size(), CV_8UC3);
     }
 
+    cv::Mat counts;
+    copy_counts_to(counts);
+
     // Normalize count to 0-255 range
     cv::Mat normalized;
     double max_val = static_cast<double>(data_.max_scattering_count);
-    data_.scattering_count.convertTo(normalized, CV_8UC1, 255.0 / max_val);
+    counts.convertTo(normalized, CV_8UC1, 255.0 / max_val);
 
     // Apply color map (blue = low, red = high)
     cv::Mat heatmap;
     cv::applyColorMap(normalized, heatmap, cv::COLORMAP_JET);
 
     // Set zero-count pixels to black
-    for (int y = 0; y < data_.scattering_count.rows; ++y) {
-        const int32_t* count_row = data_.scattering_count.ptr<int32_t>(y);
+    for (int y = 0; y < counts.rows; ++y) {
+        const int32_t* count_row = counts.ptr<int32_t>(y);
         cv::Vec3b* heat_row = heatmap.ptr<cv::Vec3b>(y);
 
-        for (int x = 0; x < data_.scattering_count.cols; ++x) {
+        for (int x = 0; x < counts.cols; ++x) {
             if (count_row[x] == 0) {
                 heat_row[x] = cv::Vec3b(0, 0, 0);  // Black for no scattering
             }
@@ -170,40 +666,1140 @@ cv::Mat ScatteringAnalyzer::create_heatmap_visualization() const {
 }
 
 void ScatteringAnalyzer::update_statistics() {
-    // Calculate total scattering events across all pixels and frames
-    data_.total_scattering_events = 0;
-    for (int y = 0; y < data_.scattering_count.rows; ++y) {
-        const int32_t* count_row = data_.scattering_count.ptr<int32_t>(y);
-        for (int x = 0; x < data_.scattering_count.cols; ++x) {
-            data_.total_scattering_events += count_row[x];
-        }
-    }
+    // Total scattering events across all pixels and frames equals the sum of
+    // per-frame counts, so accumulate instead of re-summing scattering_count
+    data_.total_scattering_events += data_.current_scattering_pixels;
 
     // Calculate average
     if (data_.frames_analyzed > 0) {
         data_.average_scattering_per_frame =
             (float)data_.total_scattering_events / data_.frames_analyzed;
     }
+    update_confidence();
 }
 
-void ScatteringAnalyzer::update_heatmap() {
-    if (data_.scattering_count.empty()) return;
+void ScatteringAnalyzer::update_confidence() {
+    const int64_t n = data_.frames_analyzed;
+    if (n <= 0) return;
 
-    // Simple heatmap: normalize counts to 0-255
-    double max_val = static_cast<double>(data_.max_scattering_count);
-    if (max_val > 0) {
-        data_.scattering_count.convertTo(data_.scattering_heatmap, CV_8UC1, 255.0 / max_val);
+    // Welford: numerically stable running mean and sum of squared deviations
+    const double x = data_.current_scattering_pixels;
+    const double delta = x - rate_mean_;
+    rate_mean_ += delta / n;
+    rate_m2_ += delta * (x - rate_mean_);
+    if (n < 2) return;
+
+    const double sample_var = rate_m2_ / (n - 1);
+    double half_width;
+    if (rate_mean_ > 0.0) {
+        const double p = candidate_pixels_ > 0 ? std::min(rate_mean_ / candidate_pixels_, 1.0) : 0.0;
+        const double binomial_var = candidate_pixels_ * p * (1.0 - p);
+        half_width = CI_Z * std::sqrt(std::max(sample_var, binomial_var) / n);
+    } else {
+        half_width = 3.0 / n;  // Rule of three: no events seen in n frames
+    }
+
+    data_.scattering_std_per_frame = static_cast<float>(std::sqrt(sample_var));
+    data_.scattering_ci_half_width = static_cast<float>(half_width);
+    data_.scattering_converged = ci_target_ > 0.0f && n >= ci_min_frames_ && rate_mean_ > 0.0 &&
+                                 half_width <= ci_target_ * rate_mean_;
+}
+
+void ScatteringAnalyzer::reset_confidence() {
+    rate_mean_ = 0.0;
+    rate_m2_ = 0.0;
+    data_.scattering_std_per_frame = 0.0f;
+    data_.scattering_ci_half_width = 0.0f;
+    data_.scattering_converged = false;
+}
+
+void ScatteringAnalyzer::set_confidence_target(float relative_half_width, int min_frames) {
+    ci_target_ = std::max(0.0f, relative_half_width);
+    ci_min_frames_ = std::max(2, min_frames);
+}
+
+void ScatteringAnalyzer::update_heatmap(const std::vector<uint32_t>* touched) {
+    if (data_.scattering_heatmap.empty() || data_.max_scattering_count == 0) return;
+    if (heatmap_deferred_) {
+        heatmap_stale_ = true;   // An incremental refresh would miss the skipped frames' pixels
+        return;
+    }
+    if (heatmap_stale_) {
+        heatmap_scale_max_ = 0;
+        heatmap_stale_ = false;
+    }
+
+    // Full renormalisation only when the max has grown enough to visibly shift
+    // the 0-255 scale; otherwise just refresh the pixels that scattered this frame
+    const int max_count = data_.max_scattering_count;
+    if (heatmap_scale_max_ == 0 ||
+        int64_t(max_count) * HEATMAP_RESCALE_DEN > int64_t(heatmap_scale_max_) * HEATMAP_RESCALE_NUM) {
+        heatmap_scale_max_ = max_count;
+        const float scale = 255.0f / heatmap_scale_max_;
+        const int width = data_.scattering_heatmap.cols;
+        if (!sparse_) {
+            dense_counts_.convertTo(data_.scattering_heatmap, CV_8UC1, scale);
+            for (const auto& entry : count_overflow_) {
+                data_.scattering_heatmap.ptr<uint8_t>(static_cast<int>(entry.first / width))[entry.first % width] =
+                    cv::saturate_cast<uint8_t>((COUNT_SATURATED + entry.second) * scale);
+            }
+            return;
+        }
+
+        // Sparse: untouched pixels stay 0, only rewrite the touched ones
+        for (const auto& entry : sparse_counts_) {
+            const int y = static_cast<int>(entry.first / width);
+            const int x = static_cast<int>(entry.first % width);
+            data_.scattering_heatmap.ptr<uint8_t>(y)[x] = cv::saturate_cast<uint8_t>(entry.second.count * scale);
+        }
+        return;
+    }
+
+    const float scale = 255.0f / heatmap_scale_max_;
+    if (touched) {
+        const uint32_t width = static_cast<uint32_t>(data_.scattering_heatmap.cols);
+        for (uint32_t key : *touched) {
+            const int x = static_cast<int>(key % width);
+            const int y = static_cast<int>(key / width);
+            data_.scattering_heatmap.ptr<uint8_t>(y)[x] = cv::saturate_cast<uint8_t>(get_count(x, y) * scale);
+        }
+        return;
+    }
+
+    const video::BinaryFrame& mask = data_.scattering_bits;
+    for (int y = 0; y < mask.height(); ++y) {
+        const uint64_t* mask_row = mask.row(y);
+        uint8_t* heat_row = data_.scattering_heatmap.ptr<uint8_t>(y);
+
+        for (int w = 0; w < mask.words_per_row(); ++w) {
+            uint64_t word = mask_row[w];
+            while (word) {
+                const int x = w * 64 + video::BinaryFrame::lowest_set_bit(word);
+                heat_row[x] = cv::saturate_cast<uint8_t>(get_count(x, y) * scale);
+                word &= word - 1;
+            }
+        }
+    }
+}
+
+void ScatteringAnalyzer::set_sparse_mode(bool enabled, float density_threshold) {
+    sparse_enabled_ = enabled;
+    sparse_density_threshold_ = std::max(0.0f, density_threshold);
+}
+
+void ScatteringAnalyzer::reset_counts() {
+    sparse_counts_.clear();
+    count_overflow_.clear();
+    sparse_ = sparse_enabled_;
+    if (sparse_) {
+        dense_counts_.release();
+        first_seen_.release();
+    } else {
+        dense_counts_ = cv::Mat::zeros(reference_bits_.size(), CV_16UC1);
+        first_seen_ = cv::Mat::zeros(reference_bits_.size(), CV_32SC1);
+    }
+
+    hot_pixels_.clear();
+    hot_min_index_ = 0;
+    hot_min_count_ = 0;
+    data_.hot_pixels.clear();
+}
+
+void ScatteringAnalyzer::densify_counts() {
+    dense_counts_ = cv::Mat::zeros(reference_bits_.size(), CV_16UC1);
+    first_seen_ = cv::Mat::zeros(reference_bits_.size(), CV_32SC1);
+    count_overflow_.clear();
+    const int width = reference_bits_.width();
+    for (const auto& entry : sparse_counts_) {
+        const int y = static_cast<int>(entry.first / width);
+        const int x = static_cast<int>(entry.first % width);
+        dense_counts_.ptr<uint16_t>(y)[x] = static_cast<uint16_t>(std::min<int32_t>(entry.second.count, COUNT_SATURATED));
+        if (entry.second.count > COUNT_SATURATED) {
+            count_overflow_[entry.first] = entry.second.count - COUNT_SATURATED;
+        }
+        first_seen_.ptr<int32_t>(y)[x] = entry.second.first_seen;
+    }
+
+    std::unordered_map<uint32_t, SparseCount>().swap(sparse_counts_);  // Free buckets too
+    sparse_ = false;
+    std::cout << "Scattering counts switched to dense mode after "
+              << data_.frames_analyzed << " frames" << std::endl;
+}
+
+int ScatteringAnalyzer::get_count(int x, int y) const {
+    if (!sparse_) {
+        if (dense_counts_.empty()) {
+            return 0;
+        }
+        const uint16_t count = dense_counts_.at<uint16_t>(y, x);
+        if (count != COUNT_SATURATED) {
+            return count;
+        }
+        auto it = count_overflow_.find(static_cast<uint32_t>(y) * reference_bits_.width() + x);
+        return COUNT_SATURATED + (it != count_overflow_.end() ? it->second : 0);
+    }
+    auto it = sparse_counts_.find(static_cast<uint32_t>(y) * reference_bits_.width() + x);
+    return it != sparse_counts_.end() ? it->second.count : 0;
+}
+
+void ScatteringAnalyzer::copy_counts_to(cv::Mat& dst) const {
+    const int width = reference_bits_.width();
+    if (!sparse_) {
+        dense_counts_.convertTo(dst, CV_32SC1);
+        for (const auto& entry : count_overflow_) {
+            dst.ptr<int32_t>(static_cast<int>(entry.first / width))[entry.first % width] += entry.second;
+        }
+        return;
+    }
+
+    dst.create(reference_bits_.size(), CV_32SC1);
+    dst.setTo(0);
+    for (const auto& entry : sparse_counts_) {
+        dst.ptr<int32_t>(static_cast<int>(entry.first / width))[entry.first % width] = entry.second.count;
+    }
+}
+
+std::vector<ScatteringAnalyzer::PixelCount> ScatteringAnalyzer::get_touched_pixels() const {
+    std::vector<PixelCount> pixels;
+
+    if (sparse_) {
+        const int width = reference_bits_.width();
+        pixels.reserve(sparse_counts_.size());
+        for (const auto& entry : sparse_counts_) {
+            pixels.push_back({cv::Point(static_cast<int>(entry.first % width),
+                                        static_cast<int>(entry.first / width)), entry.second.count});
+        }
+        // Raster order, same as the dense scan below
+        std::sort(pixels.begin(), pixels.end(), [](const PixelCount& a, const PixelCount& b) {
+            return a.location.y != b.location.y ? a.location.y < b.location.y
+                                                 : a.location.x < b.location.x;
+        });
+        return pixels;
+    }
+
+    for (int y = 0; y < dense_counts_.rows; ++y) {
+        const uint16_t* count_row = dense_counts_.ptr<uint16_t>(y);
+        for (int x = 0; x < dense_counts_.cols; ++x) {
+            if (count_row[x] == COUNT_SATURATED) {
+                pixels.push_back({cv::Point(x, y), get_count(x, y)});
+            } else if (count_row[x] != 0) {
+                pixels.push_back({cv::Point(x, y), count_row[x]});
+            }
+        }
+    }
+    return pixels;
+}
+
+bool ScatteringAnalyzer::export_counts_csv(const std::string& filepath) const {
+    std::ofstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "ScatteringAnalyzer: Cannot open " << filepath << " for writing" << std::endl;
+        return false;
+    }
+
+    // Only pixels that ever scattered are written
+    file << "x,y,count\n";
+    for (const PixelCount& pixel : get_touched_pixels()) {
+        file << pixel.location.x << "," << pixel.location.y << "," << pixel.count << "\n";
+    }
+
+    std::cout << "Scattering counts exported to: " << filepath << std::endl;
+    return true;
+}
+
+void ScatteringAnalyzer::export_shard(AnalysisShard& shard) const {
+    const int width = reference_bits_.width();
+    shard.width = width;
+    shard.height = reference_bits_.height();
+    shard.reference_hash = AnalysisShard::hash_reference(get_reference());
+    shard.frames = data_.frames_analyzed;
+    shard.total_scattering_events = data_.total_scattering_events;
+    shard.candidate_pixels = candidate_pixels_;
+    shard.rate = AnalysisShard::Moments();
+    shard.rate.n = data_.frames_analyzed;
+    shard.rate.mean = rate_mean_;
+    shard.rate.m2 = rate_m2_;
+
+    // Raster order in either mode, first-seen frame included
+    shard.pixels.clear();
+    if (sparse_) {
+        shard.pixels.reserve(sparse_counts_.size());
+        for (const auto& entry : sparse_counts_) {
+            shard.pixels.push_back({entry.first, entry.second.count, entry.second.first_seen});
+        }
+        std::sort(shard.pixels.begin(), shard.pixels.end(),
+                  [](const AnalysisShard::Pixel& a, const AnalysisShard::Pixel& b) { return a.key < b.key; });
+    } else {
+        for (int y = 0; y < dense_counts_.rows; ++y) {
+            const uint16_t* count_row = dense_counts_.ptr<uint16_t>(y);
+            const int32_t* first_row = first_seen_.ptr<int32_t>(y);
+            for (int x = 0; x < dense_counts_.cols; ++x) {
+                if (count_row[x] != 0) {
+                    shard.pixels.push_back({static_cast<uint32_t>(y) * width + x, get_count(x, y), first_row[x]});
+                }
+            }
+        }
+    }
+    shard.hot_pixel_k = hot_pixel_k_;
+    shard.hot_pixels = data_.hot_pixels;
+
+    // Oldest first: the ring is full once window_frames reaches its size
+    shard.window_size = window_size_;
+    shard.window_tail.clear();
+    for (int i = 0; i < data_.window_frames; ++i) {
+        shard.window_tail.push_back(window_ring_pixels_[(window_head_ - data_.window_frames + i + window_size_) % window_size_]);
+    }
+
+    shard.clusters_enabled = cluster_stats_;
+    shard.total_clusters = data_.clusters.total_clusters;
+    shard.total_single_pixel = data_.clusters.total_single_pixel;
+    shard.max_largest_pixels = data_.clusters.max_largest_pixels;
+    std::copy(data_.clusters.total_histogram.begin(), data_.clusters.total_histogram.end(),
+              shard.cluster_histogram.begin());
+
+    shard.regions.clear();
+    for (const RegionStats& stats : data_.regions) {
+        shard.regions.push_back({stats.name, stats.total_scattering_events, stats.total_missing_events,
+                                 stats.max_scattering_pixels});
+    }
+    shard.references.clear();
+    for (const ReferenceStats& stats : data_.references) {
+        shard.references.push_back({stats.name, stats.total_scattering_events, stats.total_missing_events, 0});
+    }
+    shard.plane_events.clear();
+    for (const PlaneStats& stats : data_.planes) {
+        shard.plane_events.push_back(stats.total_scattering_events);
+    }
+    shard.tile_total = data_.tile_scattering_total.clone();
+}
+
+bool ScatteringAnalyzer::import_shard(const AnalysisShard& shard) {
+    if (!analyzing_) return false;
+    const int width = reference_bits_.width();
+    const int height = reference_bits_.height();
+    const bool regions_match = shard.regions.size() == data_.regions.size() &&
+        std::equal(shard.regions.begin(), shard.regions.end(), data_.regions.begin(),
+                   [](const AnalysisShard::Totals& a, const RegionStats& b) { return a.name == b.name; });
+    const bool references_match = shard.references.size() == data_.references.size() &&
+        std::equal(shard.references.begin(), shard.references.end(), data_.references.begin(),
+                   [](const AnalysisShard::Totals& a, const ReferenceStats& b) { return a.name == b.name; });
+    if (shard.width != width || shard.height != height ||
+        shard.reference_hash != AnalysisShard::hash_reference(get_reference()) || !regions_match ||
+        !references_match || shard.plane_events.size() != data_.planes.size() ||
+        shard.tile_total.size() != data_.tile_scattering_total.size() || shard.frames > INT32_MAX) {
+        return false;
+    }
+
+    reset_temporal_data();
+    data_.frames_analyzed = static_cast<int>(shard.frames);
+
+    // Counts go in sparse and switch to dense under the same rule as analysis
+    for (const AnalysisShard::Pixel& pixel : shard.pixels) {
+        SparseCount& entry = sparse_counts_[pixel.key];
+        entry.count = static_cast<int32_t>(std::min<int64_t>(pixel.count, INT32_MAX));
+        entry.first_seen = static_cast<int32_t>(pixel.first_seen);
+    }
+    if (!sparse_ || sparse_counts_.size() > static_cast<size_t>(sparse_density_threshold_ * width * height)) {
+        densify_counts();
+    }
+
+    hot_pixels_ = shard.hot_pixels;
+    if (static_cast<int>(hot_pixels_.size()) > hot_pixel_k_) {
+        hot_pixels_.resize(hot_pixel_k_);   // Highest first, so the weakest go
+    }
+    update_hot_min();
+    publish_hot_pixels();
+
+    data_.total_scattering_events = static_cast<int>(shard.total_scattering_events);
+    data_.average_scattering_per_frame =
+        shard.frames > 0 ? static_cast<float>(shard.total_scattering_events) / shard.frames : 0.0f;
+    data_.max_scattering_count = data_.hot_pixels.empty() ? 0 : data_.hot_pixels.front().count;
+    data_.hot_spot_location = data_.hot_pixels.empty() ? cv::Point(0, 0) : data_.hot_pixels.front().location;
+    rate_mean_ = shard.rate.mean;
+    rate_m2_ = shard.rate.m2;
+    data_.scattering_std_per_frame = static_cast<float>(shard.rate.stddev());
+
+    ClusterStats& clusters = data_.clusters;
+    clusters.total_clusters = shard.total_clusters;
+    clusters.total_single_pixel = shard.total_single_pixel;
+    clusters.max_largest_pixels = static_cast<int>(shard.max_largest_pixels);
+    clusters.average_clusters_per_frame =
+        shard.frames > 0 ? static_cast<float>(shard.total_clusters) / shard.frames : 0.0f;
+    std::copy(shard.cluster_histogram.begin(), shard.cluster_histogram.end(), clusters.total_histogram.begin());
+
+    for (size_t i = 0; i < shard.regions.size(); ++i) {
+        RegionStats& stats = data_.regions[i];
+        stats.total_scattering_events = shard.regions[i].scattering_events;
+        stats.total_missing_events = shard.regions[i].missing_events;
+        stats.max_scattering_pixels = static_cast<int>(shard.regions[i].max_scattering_pixels);
+    }
+    for (size_t i = 0; i < shard.references.size(); ++i) {
+        data_.references[i].total_scattering_events = shard.references[i].scattering_events;
+        data_.references[i].total_missing_events = shard.references[i].missing_events;
+    }
+    for (size_t i = 0; i < shard.plane_events.size(); ++i) {
+        data_.planes[i].total_scattering_events = shard.plane_events[i];
+    }
+    if (!shard.tile_total.empty()) {
+        shard.tile_total.copyTo(data_.tile_scattering_total);
+        double max_total = 0.0;
+        cv::minMaxLoc(data_.tile_scattering_total, nullptr, &max_total, nullptr, &data_.hot_tile);
+    }
+
+    update_heatmap();   // Full rebuild: the scale was reset
+    return true;
+}
+
+void ScatteringAnalyzer::set_hot_pixel_count(int k) {
+    hot_pixel_k_ = std::max(1, k);
+}
+
+void ScatteringAnalyzer::track_hot_pixel(const cv::Point& location, int32_t count,
+                                         int32_t first_seen, int32_t frame_index) {
+    hot_pixels_changed_ = true;
+
+    // Already tracked: counts only grow, so it just moves up
+    for (size_t i = 0; i < hot_pixels_.size(); ++i) {
+        HotPixel& hot = hot_pixels_[i];
+        if (hot.location == location) {
+            hot.count = count;
+            hot.last_seen_frame = frame_index;
+            if (static_cast<int>(i) == hot_min_index_) {
+                update_hot_min();
+            }
+            return;
+        }
+    }
+
+    HotPixel hot{location, count, first_seen, frame_index};
+    if (static_cast<int>(hot_pixels_.size()) < hot_pixel_k_) {
+        hot_pixels_.push_back(hot);
+    } else {
+        hot_pixels_[hot_min_index_] = hot;  // Evict current weakest entry
+    }
+    update_hot_min();
+}
+
+void ScatteringAnalyzer::update_hot_min() {
+    // List not full yet: every scattering pixel is a candidate
+    if (static_cast<int>(hot_pixels_.size()) < hot_pixel_k_) {
+        hot_min_count_ = 0;
+        return;
+    }
+
+    hot_min_index_ = 0;
+    for (size_t i = 1; i < hot_pixels_.size(); ++i) {
+        if (hot_pixels_[i].count < hot_pixels_[hot_min_index_].count) {
+            hot_min_index_ = static_cast<int>(i);
+        }
+    }
+    hot_min_count_ = hot_pixels_[hot_min_index_].count;
+}
+
+void ScatteringAnalyzer::publish_hot_pixels() {
+    // K is small, so a sort per changed frame is cheaper than keeping a heap ordered
+    data_.hot_pixels = hot_pixels_;
+    std::sort(data_.hot_pixels.begin(), data_.hot_pixels.end(),
+              [](const HotPixel& a, const HotPixel& b) {
+                  return a.count != b.count ? a.count > b.count
+                                            : a.first_seen_frame < b.first_seen_frame;
+              });
+}
+
+void ScatteringAnalyzer::set_window(int window_frames) {
+    window_size_ = std::min(std::max(0, window_frames), 65535);  // Fits CV_16UC1 counts
+}
+
+void ScatteringAnalyzer::set_decay(int decay_shift) {
+    decay_shift_ = std::min(std::max(0, decay_shift), 15);
+}
+
+void ScatteringAnalyzer::reset_rolling_stats() {
+    const cv::Size size = reference_bits_.size();
+
+    window_ring_.clear();
+    window_ring_pixels_.clear();
+    window_head_ = 0;
+    data_.window_frames = 0;
+    data_.window_scattering_events = 0;
+    data_.window_average_per_frame = 0.0f;
+    if (window_size_ > 0) {
+        window_ring_.resize(window_size_);
+        window_ring_pixels_.assign(window_size_, 0);
+        data_.window_count = cv::Mat::zeros(size, CV_16UC1);
+    } else {
+        data_.window_count.release();
+    }
+
+    data_.decay_scattering_per_frame = 0.0f;
+    if (decay_shift_ > 0) {
+        data_.decay_rate = cv::Mat::zeros(size, CV_16UC1);
+    } else {
+        data_.decay_rate.release();
+    }
+}
+
+void ScatteringAnalyzer::update_window() {
+    if (window_size_ == 0) return;
+
+    const video::BinaryFrame& mask = data_.scattering_bits;
+    video::BinaryFrame& oldest = window_ring_[window_head_];
+
+    // Retire the frame leaving the window: only its set bits are touched
+    if (data_.window_frames == window_size_) {
+        for (int y = 0; y < oldest.height(); ++y) {
+            const uint64_t* old_row = oldest.row(y);
+            uint16_t* window_row = data_.window_count.ptr<uint16_t>(y);
+            for (int w = 0; w < oldest.words_per_row(); ++w) {
+                uint64_t word = old_row[w];
+                while (word) {
+                    window_row[w * 64 + video::BinaryFrame::lowest_set_bit(word)]--;
+                    word &= word - 1;
+                }
+            }
+        }
+        data_.window_scattering_events -= window_ring_pixels_[window_head_];
+    } else {
+        data_.window_frames++;
+    }
+
+    // Add the newest frame and keep its mask for when it leaves
+    for (int y = 0; y < mask.height(); ++y) {
+        const uint64_t* mask_row = mask.row(y);
+        uint16_t* window_row = data_.window_count.ptr<uint16_t>(y);
+        for (int w = 0; w < mask.words_per_row(); ++w) {
+            uint64_t word = mask_row[w];
+            while (word) {
+                window_row[w * 64 + video::BinaryFrame::lowest_set_bit(word)]++;
+                word &= word - 1;
+            }
+        }
+    }
+    oldest = mask;  // Reuses the slot's word storage after the first lap
+    window_ring_pixels_[window_head_] = data_.current_scattering_pixels;
+    data_.window_scattering_events += data_.current_scattering_pixels;
+    window_head_ = (window_head_ + 1) % window_size_;
+
+    data_.window_average_per_frame =
+        (float)data_.window_scattering_events / data_.window_frames;
+}
+
+void ScatteringAnalyzer::update_decay() {
+    if (decay_shift_ == 0) return;
+
+    // Fixed-point EWMA: r += ((bit ? 65535 : 0) - r) * 2^-k, decay rounded up
+    // so idle pixels reach exactly 0
+    const int k = decay_shift_;
+    const int round = (1 << k) - 1;
+    const video::BinaryFrame& mask = data_.scattering_bits;
+    const int width = mask.width();
+
+    for (int y = 0; y < mask.height(); ++y) {
+        const uint64_t* mask_row = mask.row(y);
+        uint16_t* rate_row = data_.decay_rate.ptr<uint16_t>(y);
+
+        for (int w = 0; w < mask.words_per_row(); ++w) {
+            const uint64_t word = mask_row[w];
+            const int x0 = w * 64;
+            const int n = std::min(64, width - x0);
+            uint16_t* rate = rate_row + x0;
+
+            if (word == 0) {
+                // Common case: plain decay, auto-vectorises
+                for (int i = 0; i < n; ++i) {
+                    rate[i] = static_cast<uint16_t>(rate[i] - ((rate[i] + round) >> k));
+                }
+                continue;
+            }
+
+            for (int i = 0; i < n; ++i) {
+                if ((word >> i) & 1u) {
+                    rate[i] = static_cast<uint16_t>(rate[i] + ((65535 - rate[i]) >> k));
+                } else {
+                    rate[i] = static_cast<uint16_t>(rate[i] - ((rate[i] + round) >> k));
+                }
+            }
+        }
     }
+
+    const float alpha = 1.0f / (1 << k);
+    data_.decay_scattering_per_frame = (data_.frames_analyzed == 1)
+        ? static_cast<float>(data_.current_scattering_pixels)
+        : data_.decay_scattering_per_frame +
+              alpha * (data_.current_scattering_pixels - data_.decay_scattering_per_frame);
 }
 
-void ScatteringAnalyzer::detect_hot_spots() {
-    if (data_.scattering_count.empty()) return;
+bool ScatteringAnalyzer::parse_regions(const std::string& spec, std::vector<Region>& regions) {
+    regions.clear();
+    bool ok = true;
+
+    size_t begin = 0;
+    while (begin < spec.size()) {
+        size_t end = spec.find(';', begin);
+        if (end == std::string::npos) end = spec.size();
+        const std::string entry = spec.substr(begin, end - begin);
+        begin = end + 1;
+        if (entry.find_first_not_of(" \t") == std::string::npos) continue;
+
+        const size_t colon = entry.find(':');
+        const size_t name_begin = entry.find_first_not_of(" \t");
+        int x = 0, y = 0, width = 0, height = 0;
+        char trailing = 0;
+        if (colon == std::string::npos || name_begin >= colon ||
+                std::sscanf(entry.c_str() + colon + 1, " %d , %d , %d , %d %c",
+                            &x, &y, &width, &height, &trailing) != 4 ||
+                width <= 0 || height <= 0) {
+            std::cerr << "ScatteringAnalyzer: Ignoring region \"" << entry
+                      << "\" (expected name:x,y,width,height)" << std::endl;
+            ok = false;
+            continue;
+        }
+
+        const size_t name_end = entry.find_last_not_of(" \t", colon - 1);
+        regions.push_back({entry.substr(name_begin, name_end - name_begin + 1), cv::Rect(x, y, width, height)});
+    }
+    return ok;
+}
+
+bool ScatteringAnalyzer::export_regions_csv(const ScatteringData& data, const std::string& filepath) {
+    std::ofstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "ScatteringAnalyzer: Cannot open " << filepath << " for writing" << std::endl;
+        return false;
+    }
+
+    file << "name,x,y,width,height,area,reference_pixels,frames,"
+            "total_scattering_events,average_scattering_per_frame,max_scattering_pixels,"
+            "total_missing_events,average_missing_per_frame\n";
+    for (const RegionStats& region : data.regions) {
+        file << region.name << "," << region.rect.x << "," << region.rect.y << ","
+             << region.rect.width << "," << region.rect.height << ","
+             << region.area << "," << region.reference_pixels << "," << data.frames_analyzed << ","
+             << region.total_scattering_events << "," << region.average_scattering_per_frame << ","
+             << region.max_scattering_pixels << ","
+             << region.total_missing_events << "," << region.average_missing_per_frame << "\n";
+    }
+
+    std::cout << "Scattering region statistics exported to: " << filepath << std::endl;
+    return true;
+}
+
+void ScatteringAnalyzer::build_region_index() {
+    const cv::Rect frame_rect(cv::Point(0, 0), reference_bits_.size());
+    const int height = reference_bits_.height();
+
+    data_.regions.assign(regions_.size(), RegionStats());
+    region_spans_.clear();
+    region_row_begin_.assign(height + 1, 0);
+    region_y_begin_ = height;
+    region_y_end_ = 0;
+
+    // Spans per row first, then a prefix sum gives each row its slice of region_spans_
+    for (size_t i = 0; i < regions_.size(); ++i) {
+        RegionStats& stats = data_.regions[i];
+        stats.name = regions_[i].name;
+        stats.rect = regions_[i].rect & frame_rect;
+        stats.area = stats.rect.area();
+        if (stats.rect.empty()) {
+            std::cerr << "ScatteringAnalyzer: Region " << stats.name << " lies outside the "
+                      << frame_rect.width << "x" << frame_rect.height << " frame" << std::endl;
+            continue;
+        }
+        for (int y = stats.rect.y; y < stats.rect.y + stats.rect.height; ++y) {
+            region_row_begin_[y + 1]++;
+        }
+        region_y_begin_ = std::min(region_y_begin_, stats.rect.y);
+        region_y_end_ = std::max(region_y_end_, stats.rect.y + stats.rect.height);
+    }
+    for (int y = 0; y < height; ++y) {
+        region_row_begin_[y + 1] += region_row_begin_[y];
+    }
+
+    region_spans_.resize(region_row_begin_[height]);
+    std::vector<int32_t> next(region_row_begin_.begin(), region_row_begin_.end() - 1);
+    for (size_t i = 0; i < regions_.size(); ++i) {
+        RegionStats& stats = data_.regions[i];
+        if (stats.rect.empty()) continue;
+
+        const int x_end = stats.rect.x + stats.rect.width;
+        RegionSpan span;
+        span.word_begin = stats.rect.x / 64;
+        span.word_end = (x_end - 1) / 64 + 1;
+        span.first_mask = ~0ULL << (stats.rect.x % 64);
+        span.last_mask = ~0ULL >> (63 - (x_end - 1) % 64);
+        span.region = static_cast<int32_t>(i);
 
-    // Find pixel with highest scattering count
-    double min_val, max_val;
-    cv::Point min_loc, max_loc;
-    cv::minMaxLoc(data_.scattering_count, &min_val, &max_val, &min_loc, &max_loc);
+        for (int y = stats.rect.y; y < stats.rect.y + stats.rect.height; ++y) {
+            region_spans_[next[y]++] = span;
+        }
+    }
+
+    // The reference only changes with its offset, so its count is taken here
+    count_region_references();
+
+    if (!regions_.empty()) {
+        std::cout << "Scattering analysis tracking " << regions_.size() << " regions ("
+                  << region_spans_.size() << " row spans)" << std::endl;
+    }
+}
+
+void ScatteringAnalyzer::count_region_references() {
+    for (RegionStats& stats : data_.regions) {
+        stats.reference_pixels = 0;
+    }
+    for (int y = region_y_begin_; y < region_y_end_; ++y) {
+        const uint64_t* ref_row = reference_bits_.row(y);
+        for (int32_t i = region_row_begin_[y]; i < region_row_begin_[y + 1]; ++i) {
+            const RegionSpan& span = region_spans_[i];
+            int reference_pixels = 0;
+            for (int w = span.word_begin; w < span.word_end; ++w) {
+                uint64_t valid = ~0ULL;
+                if (w == span.word_begin) valid &= span.first_mask;
+                if (w == span.word_end - 1) valid &= span.last_mask;
+                reference_pixels += video::BinaryFrame::popcount(ref_row[w] & valid);
+            }
+            data_.regions[span.region].reference_pixels += reference_pixels;
+        }
+    }
+}
+
+void ScatteringAnalyzer::set_reference_offset(const cv::Point& offset) {
+    if (!reference_original_ || offset == data_.reference_offset) {
+        return;
+    }
+    if (offset == cv::Point(0, 0)) {
+        reference_bits_ = *reference_original_;
+    } else {
+        video::BinaryFrame::shift(*reference_original_, offset.x, offset.y, reference_bits_);
+    }
+    reference_runs_.assign(reference_bits_);
+    data_.reference_offset = offset;
+    candidate_pixels_ = int64_t(reference_bits_.width()) * reference_bits_.height() - reference_bits_.count();
+    count_region_references();
+
+    // Comparison references are of the same target, so they move with it
+    for (size_t r = 0; r < comparison_bits_.size(); ++r) {
+        const video::BinaryFrame& original = *comparison_references_[r].bits;
+        if (offset == cv::Point(0, 0)) {
+            comparison_bits_[r] = original;
+        } else {
+            video::BinaryFrame::shift(original, offset.x, offset.y, comparison_bits_[r]);
+        }
+    }
+    count_comparison_references();
+}
+
+void ScatteringAnalyzer::set_alignment_estimate(const cv::Point2f& shift, float response) {
+    data_.alignment_shift = shift;
+    data_.alignment_response = response;
+}
+
+void ScatteringAnalyzer::reset_region_stats() {
+    // Keep what the index fixed at start, clear the counters
+    for (RegionStats& stats : data_.regions) {
+        RegionStats cleared;
+        cleared.name = std::move(stats.name);
+        cleared.rect = stats.rect;
+        cleared.area = stats.area;
+        cleared.reference_pixels = stats.reference_pixels;
+        stats = std::move(cleared);
+    }
+}
+
+void ScatteringAnalyzer::update_regions(const video::BinaryFrame& live_image) {
+    if (data_.regions.empty()) return;
+
+    for (RegionStats& stats : data_.regions) {
+        stats.live_pixels = 0;
+        stats.scattering_pixels = 0;
+        stats.missing_pixels = 0;
+    }
 
-    data_.max_scattering_count = static_cast<int>(max_val);
-    data_.hot_spot_location = max_loc;
+    // One sweep over the covered rows serves every region; the scattering
+    // words were already written by the scan, so only popcounts remain
+    const video::BinaryFrame& mask = data_.scattering_bits;
+    for (int y = region_y_begin_; y < region_y_end_; ++y) {
+        const uint64_t* live_row = live_image.row(y);
+        const uint64_t* ref_row = reference_bits_.row(y);
+        const uint64_t* mask_row = mask.row(y);
+
+        for (int s = region_row_begin_[y]; s < region_row_begin_[y + 1]; ++s) {
+            const RegionSpan& span = region_spans_[s];
+            int live = 0;
+            int scattering = 0;
+            int missing = 0;
+            for (int w = span.word_begin; w < span.word_end; ++w) {
+                uint64_t valid = ~0ULL;
+                if (w == span.word_begin) valid &= span.first_mask;
+                if (w == span.word_end - 1) valid &= span.last_mask;
+                live += video::BinaryFrame::popcount(live_row[w] & valid);
+                scattering += video::BinaryFrame::popcount(mask_row[w] & valid);
+                missing += video::BinaryFrame::popcount(ref_row[w] & ~live_row[w] & valid);
+            }
+
+            RegionStats& stats = data_.regions[span.region];
+            stats.live_pixels += live;
+            stats.scattering_pixels += scattering;
+            stats.missing_pixels += missing;
+        }
+    }
+
+    for (RegionStats& stats : data_.regions) {
+        stats.scattering_percentage = stats.area > 0 ? (float)stats.scattering_pixels / stats.area * 100.0f : 0.0f;
+        stats.missing_percentage = stats.reference_pixels > 0
+            ? (float)stats.missing_pixels / stats.reference_pixels * 100.0f : 0.0f;
+        stats.total_scattering_events += stats.scattering_pixels;
+        stats.total_missing_events += stats.missing_pixels;
+        stats.max_scattering_pixels = std::max(stats.max_scattering_pixels, stats.scattering_pixels);
+        stats.average_scattering_per_frame = (float)stats.total_scattering_events / data_.frames_analyzed;
+        stats.average_missing_per_frame = (float)stats.total_missing_events / data_.frames_analyzed;
+    }
+}
+
+void ScatteringAnalyzer::reset_plane_stats() {
+    data_.planes.assign(plane_sweep_ ? 8 : 0, PlaneStats{});
+}
+
+void ScatteringAnalyzer::update_planes() {
+    if (data_.planes.empty()) return;
+
+    // All planes in one sweep, reading each reference word once
+    int live[8] = {};
+    int scattering[8] = {};
+    const uint64_t* ref = reference_bits_.data();
+    const uint64_t* planes[8];
+    for (int b = 0; b < 8; ++b) {
+        planes[b] = plane_bits_[b].data();
+    }
+    const size_t words = reference_bits_.word_count();
+    for (size_t i = 0; i < words; ++i) {
+        const uint64_t not_ref = ~ref[i];
+        for (int b = 0; b < 8; ++b) {
+            live[b] += video::BinaryFrame::popcount(planes[b][i]);
+            scattering[b] += video::BinaryFrame::popcount(planes[b][i] & not_ref);
+        }
+    }
+
+    const int total_pixels = reference_bits_.width() * reference_bits_.height();
+    for (int b = 0; b < 8; ++b) {
+        PlaneStats& stats = data_.planes[b];
+        stats.live_pixels = live[b];
+        stats.scattering_pixels = scattering[b];
+        stats.scattering_percentage = (float)scattering[b] / total_pixels * 100.0f;
+        stats.total_scattering_events += scattering[b];
+        stats.average_scattering_per_frame = (float)stats.total_scattering_events / data_.frames_analyzed;
+    }
+}
+
+void ScatteringAnalyzer::reset_tile_stats() {
+    if (!tile_map_ || reference_bits_.empty()) {
+        tile_frame_.release();
+        data_.tile_scattering.release();
+        data_.tile_scattering_total.release();
+        data_.hot_tile = cv::Point(0, 0);
+        return;
+    }
+
+    // Padding bits are zero, so the columns past the last tile just stay 0
+    const int tiles_x = (reference_bits_.width() + TILE - 1) / TILE;
+    const int tiles_y = (reference_bits_.height() + TILE - 1) / TILE;
+    tile_frame_ = cv::Mat::zeros(tiles_y, reference_bits_.words_per_row() * 4, CV_16UC1);
+    data_.tile_scattering = tile_frame_(cv::Rect(0, 0, tiles_x, tiles_y));
+    data_.tile_scattering_total = cv::Mat::zeros(tiles_y, tiles_x, CV_32SC1);
+    data_.hot_tile = cv::Point(0, 0);
+}
+
+void ScatteringAnalyzer::update_tiles() {
+    if (tile_frame_.empty()) return;
+
+    cv::add(data_.tile_scattering_total, data_.tile_scattering, data_.tile_scattering_total, cv::noArray(), CV_32S);
+    double max_total = 0.0;
+    cv::minMaxLoc(data_.tile_scattering_total, nullptr, &max_total, nullptr, &data_.hot_tile);
+}
+
+bool ScatteringAnalyzer::export_tiles_csv(const ScatteringData& data, const std::string& filepath) {
+    if (data.tile_scattering_total.empty()) {
+        return false;
+    }
+    std::ofstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "ScatteringAnalyzer: Cannot open " << filepath << " for writing" << std::endl;
+        return false;
+    }
+
+    file << "tile_x,tile_y,x,y,total_scattering_events,current_scattering_pixels\n";
+    for (int ty = 0; ty < data.tile_scattering_total.rows; ++ty) {
+        const int32_t* total_row = data.tile_scattering_total.ptr<int32_t>(ty);
+        const uint16_t* current_row = data.tile_scattering.ptr<uint16_t>(ty);
+        for (int tx = 0; tx < data.tile_scattering_total.cols; ++tx) {
+            if (total_row[tx] == 0) continue;
+            file << tx << "," << ty << "," << tx * TILE << "," << ty * TILE << ","
+                 << total_row[tx] << "," << current_row[tx] << "\n";
+        }
+    }
+
+    std::cout << "Scattering tile map exported to: " << filepath << std::endl;
+    return true;
+}
+
+cv::Mat ScatteringAnalyzer::create_tile_visualization(const ScatteringData& data) {
+    if (data.tile_scattering_total.empty()) {
+        return cv::Mat();
+    }
+
+    double max_total = 0.0;
+    cv::minMaxLoc(data.tile_scattering_total, nullptr, &max_total);
+    cv::Mat normalized;
+    data.tile_scattering_total.convertTo(normalized, CV_8UC1, max_total > 0.0 ? 255.0 / max_total : 0.0);
+
+    cv::Mat tiles;
+    cv::applyColorMap(normalized, tiles, cv::COLORMAP_JET);
+    tiles.setTo(cv::Scalar(0, 0, 0), data.tile_scattering_total == 0);  // Black for no scattering
+    return tiles;
+}
+
+void ScatteringAnalyzer::build_comparison_references() {
+    comparison_bits_.clear();
+    data_.references.clear();
+    if (comparison_references_.empty()) {
+        return;
+    }
+
+    data_.references.emplace_back();
+    data_.references[0].name = "reference";
+    for (const Reference& reference : comparison_references_) {
+        if (static_cast<int>(data_.references.size()) >= MAX_REFERENCES) {
+            std::cerr << "ScatteringAnalyzer: More than " << MAX_REFERENCES - 1
+                      << " comparison references, ignoring '" << reference.name << "'" << std::endl;
+            continue;
+        }
+        if (!reference.bits || reference.bits->size() != reference_bits_.size()) {
+            const cv::Size size = reference.bits ? reference.bits->size() : cv::Size();
+            std::cerr << "ScatteringAnalyzer: Comparison reference '" << reference.name << "' is "
+                      << size.width << "x" << size.height << ", not "
+                      << reference_bits_.width() << "x" << reference_bits_.height() << "; skipped" << std::endl;
+            continue;
+        }
+        comparison_bits_.push_back(*reference.bits);
+        data_.references.emplace_back();
+        data_.references.back().name = reference.name;
+    }
+    if (comparison_bits_.empty()) {
+        data_.references.clear();
+        return;
+    }
+    count_comparison_references();
+}
+
+void ScatteringAnalyzer::count_comparison_references() {
+    if (data_.references.empty()) return;
+
+    data_.references[0].reference_pixels = static_cast<int>(reference_bits_.count());
+    for (size_t r = 0; r < comparison_bits_.size(); ++r) {
+        data_.references[r + 1].reference_pixels = static_cast<int>(comparison_bits_[r].count());
+    }
+}
+
+void ScatteringAnalyzer::reset_reference_stats() {
+    for (ReferenceStats& stats : data_.references) {
+        ReferenceStats cleared;
+        cleared.name = std::move(stats.name);
+        cleared.reference_pixels = stats.reference_pixels;
+        stats = std::move(cleared);
+    }
+}
+
+void ScatteringAnalyzer::update_references(const video::BinaryFrame& live_image) {
+    if (data_.references.empty()) return;
+
+    // Each live word is loaded once and tested against every reference word at its position
+    const int count = static_cast<int>(data_.references.size());
+    const uint64_t* refs[MAX_REFERENCES] = {reference_bits_.data()};
+    for (size_t r = 0; r < comparison_bits_.size(); ++r) {
+        refs[r + 1] = comparison_bits_[r].data();
+    }
+    int scattering[MAX_REFERENCES] = {};
+    int missing[MAX_REFERENCES] = {};
+    const uint64_t* live = live_image.data();
+    const size_t words = live_image.word_count();
+    for (size_t i = 0; i < words; ++i) {
+        const uint64_t word = live[i];
+        for (int r = 0; r < count; ++r) {
+            const uint64_t ref = refs[r][i];
+            scattering[r] += video::BinaryFrame::popcount(word & ~ref);
+            missing[r] += video::BinaryFrame::popcount(ref & ~word);
+        }
+    }
+
+    const int total_pixels = live_image.width() * live_image.height();
+    for (int r = 0; r < count; ++r) {
+        ReferenceStats& stats = data_.references[r];
+        stats.scattering_pixels = scattering[r];
+        stats.missing_pixels = missing[r];
+        stats.scattering_percentage = (float)scattering[r] / total_pixels * 100.0f;
+        stats.missing_percentage = stats.reference_pixels > 0 ? (float)missing[r] / stats.reference_pixels * 100.0f : 0.0f;
+        stats.total_scattering_events += scattering[r];
+        stats.total_missing_events += missing[r];
+        stats.average_scattering_per_frame = (float)stats.total_scattering_events / data_.frames_analyzed;
+        stats.average_missing_per_frame = (float)stats.total_missing_events / data_.frames_analyzed;
+    }
+}
+
+bool ScatteringAnalyzer::export_references_csv(const ScatteringData& data, const std::string& filepath) {
+    std::ofstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "ScatteringAnalyzer: Cannot open " << filepath << " for writing" << std::endl;
+        return false;
+    }
+
+    file << "name,reference_pixels,frames,total_scattering_events,average_scattering_per_frame,"
+            "total_missing_events,average_missing_per_frame\n";
+    for (const ReferenceStats& reference : data.references) {
+        file << reference.name << "," << reference.reference_pixels << "," << data.frames_analyzed << ","
+             << reference.total_scattering_events << "," << reference.average_scattering_per_frame << ","
+             << reference.total_missing_events << "," << reference.average_missing_per_frame << "\n";
+    }
+
+    std::cout << "Scattering reference comparison exported to: " << filepath << std::endl;
+    return true;
+}
+
+void ScatteringAnalyzer::reset_cluster_stats() {
+    data_.clusters = ClusterStats();
+    cluster_runs_prev_.clear();
+    cluster_runs_.clear();
+    cluster_nodes_.clear();
+}
+
+int ScatteringAnalyzer::cluster_bin(int pixels) {
+    int bin = 0;
+    for (int rest = pixels - 1; rest > 0 && bin < CLUSTER_BINS - 1; rest >>= 1) {
+        ++bin;
+    }
+    return bin;
+}
+
+int32_t ScatteringAnalyzer::find_cluster(int32_t node) {
+    // Path halving: every other node on the way points to its grandparent
+    while (cluster_nodes_[node].parent != node) {
+        cluster_nodes_[node].parent = cluster_nodes_[cluster_nodes_[node].parent].parent;
+        node = cluster_nodes_[node].parent;
+    }
+    return node;
+}
+
+void ScatteringAnalyzer::unite_clusters(int32_t a, int32_t b) {
+    a = find_cluster(a);
+    b = find_cluster(b);
+    if (a == b) return;
+    if (b < a) std::swap(a, b);   // The earlier (upper) run stays the root
+
+    ClusterNode& root = cluster_nodes_[a];
+    const ClusterNode& child = cluster_nodes_[b];
+    cluster_nodes_[b].parent = a;
+    root.pixels += child.pixels;
+    root.x_min = std::min(root.x_min, child.x_min);
+    root.x_max = std::max(root.x_max, child.x_max);
+    root.y_min = std::min(root.y_min, child.y_min);
+    root.y_max = std::max(root.y_max, child.y_max);
+}
+
+void ScatteringAnalyzer::update_clusters() {
+    if (!cluster_stats_) return;
+    PROFILE_ZONE("ScatteringAnalyzer::update_clusters");
+
+    const video::BinaryFrame& mask = data_.scattering_bits;
+    const int words_per_row = mask.words_per_row();
+    cluster_nodes_.clear();
+    cluster_runs_prev_.clear();
+
+    for (int y = 0; y < mask.height(); ++y) {
+        // Runs of set bits, joined across word boundaries (padding bits are zero)
+        const uint64_t* row = mask.row(y);
+        cluster_runs_.clear();
+        int32_t open_end = -1;
+        for (int w = 0; w < words_per_row; ++w) {
+            uint64_t bits = row[w];
+            while (bits) {
+                const int begin = video::BinaryFrame::lowest_set_bit(bits);
+                const uint64_t gaps = ~bits & (~uint64_t(0) << begin);
+                const int end = gaps ? video::BinaryFrame::lowest_set_bit(gaps) : 64;
+                const int32_t x_begin = w * 64 + begin;
+                const int32_t x_end = w * 64 + end;
+                if (x_begin == open_end) {
+                    cluster_runs_.back().x_end = x_end;
+                } else {
+                    cluster_runs_.push_back({x_begin, x_end, 0});
+                }
+                open_end = x_end;
+                bits = end == 64 ? 0 : bits & (~uint64_t(0) << end);
+            }
+        }
+
+        // One node per run, joined to every run of the row above it touches (8-connected)
+        size_t first = 0;
+        for (ClusterRun& run : cluster_runs_) {
+            run.node = static_cast<int32_t>(cluster_nodes_.size());
+            cluster_nodes_.push_back({run.node, run.x_end - run.x_begin, run.x_begin, run.x_end - 1, y, y});
+
+            while (first < cluster_runs_prev_.size() && cluster_runs_prev_[first].x_end < run.x_begin) {
+                ++first;
+            }
+            for (size_t p = first; p < cluster_runs_prev_.size() && cluster_runs_prev_[p].x_begin <= run.x_end; ++p) {
+                unite_clusters(cluster_runs_prev_[p].node, run.node);
+            }
+        }
+        std::swap(cluster_runs_prev_, cluster_runs_);
+    }
+
+    ClusterStats& stats = data_.clusters;
+    stats.clusters = 0;
+    stats.largest_pixels = 0;
+    stats.largest_rect = cv::Rect();
+    stats.histogram.fill(0);
+    for (int32_t n = 0; n < static_cast<int32_t>(cluster_nodes_.size()); ++n) {
+        const ClusterNode& node = cluster_nodes_[n];
+        if (node.parent != n) continue;   // Roots hold whole clusters
+
+        ++stats.clusters;
+        ++stats.histogram[cluster_bin(node.pixels)];
+        if (node.pixels > stats.largest_pixels) {
+            stats.largest_pixels = node.pixels;
+            stats.largest_rect = cv::Rect(node.x_min, node.y_min, node.x_max - node.x_min + 1,
+                                          node.y_max - node.y_min + 1);
+        }
+    }
+
+    stats.total_clusters += stats.clusters;
+    stats.total_single_pixel += stats.histogram[0];
+    for (int b = 0; b < CLUSTER_BINS; ++b) {
+        stats.total_histogram[b] += stats.histogram[b];
+    }
+    stats.max_largest_pixels = std::max(stats.max_largest_pixels, stats.largest_pixels);
+    if (data_.frames_analyzed > 0) {
+        stats.average_clusters_per_frame = (float)stats.total_clusters / data_.frames_analyzed;
+    }
+}
+
+bool ScatteringAnalyzer::export_clusters_csv(const ScatteringData& data, const std::string& filepath) {
+    std::ofstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "ScatteringAnalyzer: Cannot open " << filepath << " for writing" << std::endl;
+        return false;
+    }
+
+    const ClusterStats& stats = data.clusters;
+    file << "min_pixels,max_pixels,total_clusters,fraction,current_clusters\n";
+    for (int b = 0; b < CLUSTER_BINS; ++b) {
+        file << cluster_bin_min(b) << ",";
+        if (b < CLUSTER_BINS - 1) {
+            file << cluster_bin_min(b + 1) - 1;
+        }
+        file << "," << stats.total_histogram[b] << ","
+             << (stats.total_clusters > 0 ? (double)stats.total_histogram[b] / stats.total_clusters : 0.0) << ","
+             << stats.histogram[b] << "\n";
+    }
+
+    std::cout << "Scattering cluster histogram exported to: " << filepath << std::endl;
+    return true;
 }
@@ -0,0 +1,593 @@
+#include "scattering_worker.h"
+#include "core/flight_recorder.h"
+#include "core/log.h"
+#include "core/latency_stats.h"
+#include "core/metrics.h"
+#include "core/qos_scheduler.h"
+#include "core/run_log.h"
+#include "core/thread_placement.h"
+#include "pipeline_bus.h"
+#include "video/scattering_event_tap.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+ScatteringWorker::ScatteringWorker(video::FrameBuffer& source, int camera_index)
+    : source_(source), camera_index_(camera_index) {
+}
+
+ScatteringWorker::~ScatteringWorker() {
+    stop();
+}
+
+bool ScatteringWorker::start(const cv::Mat& reference_image) {
+    // Empty unless CV_8UC1, which start_analysis reports
+    return start(std::make_shared<const video::BinaryFrame>(video::BinaryFrame::from_mat(reference_image)));
+}
+
+bool ScatteringWorker::start(ScatteringAnalyzer::ReferenceHandle reference_image) {
+    stop();
+
+    if (!source_.is_queue_mode()) {
+        std::cerr << "ScatteringWorker: Frame buffer is not in queue mode" << std::endl;
+        return false;
+    }
+
+    if (!analyzer_.start_analysis(std::move(reference_image))) {
+        return false;
+    }
+
+    if (!start_thread()) {
+        analyzer_.stop_analysis();
+        return false;
+    }
+    return true;
+}
+
+bool ScatteringWorker::start_building(int frames, float occupancy) {
+    stop();
+
+    if (!source_.is_queue_mode()) {
+        std::cerr << "ScatteringWorker: Frame buffer is not in queue mode" << std::endl;
+        return false;
+    }
+
+    // Sized by the first binary frame that arrives
+    builder_.start(0, 0, frames);
+    build_occupancy_ = std::clamp(occupancy, 0.0f, 1.0f);
+    building_ = true;
+    if (!start_thread()) {
+        building_ = false;
+        return false;
+    }
+    std::cout << "Scattering worker building reference from " << builder_.target() << " frames ("
+              << build_occupancy_ * 100.0f << " % occupancy)" << std::endl;
+    return true;
+}
+
+bool ScatteringWorker::start_thread() {
+    consumer_id_ = source_.register_consumer(true);
+    if (consumer_id_.load() < 0) {
+        return false;
+    }
+
+    frames_analyzed_ = 0;
+    frames_missed_ = 0;
+    reset_requested_ = false;
+    timeline_failed_ = false;
+    last_timeline_ = std::chrono::steady_clock::now();
+    if (checkpoint_interval_s_ > 0) {
+        checkpoint_writer_.start(checkpoint_path_);
+        if (!checkpoint_shard_) {
+            checkpoint_shard_ = std::make_unique<AnalysisShard>();
+        }
+        last_checkpoint_ = std::chrono::steady_clock::now();
+    }
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        built_reference_.reset();
+    }
+    if (!building_.load()) {
+        if (align_interval_ms_ > 0) {
+            aligner_.set_reference(analyzer_.get_reference());
+            last_align_ = std::chrono::steady_clock::now();
+        }
+        resume_checkpoint();
+        attach_event_tap();
+        publish_snapshot();
+    }
+
+    running_ = true;
+    thread_ = std::thread(&ScatteringWorker::worker_loop, this);
+    std::cout << "Scattering worker started (consumer " << consumer_id_.load() << ")" << std::endl;
+    return true;
+}
+
+void ScatteringWorker::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    source_.notify();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    // A clean stop leaves nothing to resume (stopping while building keeps an earlier run's checkpoint)
+    if (checkpoint_writer_.is_running()) {
+        checkpoint_writer_.stop();
+        if (!building_.load()) {
+            std::error_code ec;
+            std::filesystem::remove(checkpoint_path_, ec);
+        }
+    }
+    if (event_tap_) {
+        event_tap_->set_enabled(false);
+        event_tap_->set_reference(nullptr);
+    }
+
+    const int consumer_id = consumer_id_.exchange(-1);
+    frames_missed_ = source_.get_frames_dropped(consumer_id);
+    source_.unregister_consumer(consumer_id);
+
+    if (building_.exchange(false)) {
+        std::cout << "Scattering worker stopped while building the reference (" << builder_.frames() << " of "
+                  << builder_.target() << " frames)" << std::endl;
+        return;
+    }
+
+    if (timeline_.is_open()) {
+        write_timeline();   // Final counts
+        timeline_.close();
+    }
+    analyzer_.stop_analysis();
+    publish_snapshot();
+
+    // Nothing is measured any more: show a gap in trends and exports, not the last value
+    core::MetricsRegistry::instance().gauge("scattering.percentage").reset();
+    if (event_driven_.exchange(false)) {
+        frames_missed_ = static_cast<int64_t>(event_tap_->get_dropped_windows() - tap_dropped_base_);
+    }
+    std::cout << "Scattering worker stopped after " << frames_analyzed_.load()
+              << " frames (" << frames_missed_.load() << " missed)" << std::endl;
+}
+
+void ScatteringWorker::set_event_tap(video::ScatteringEventTap* tap) {
+    if (running_.load()) {
+        std::cerr << "ScatteringWorker: Stop the worker before changing the event tap" << std::endl;
+        return;
+    }
+    event_tap_ = tap;
+}
+
+void ScatteringWorker::attach_event_tap() {
+    event_driven_ = false;
+    if (!event_tap_) {
+        return;
+    }
+    const video::BinaryFrame& reference = analyzer_.get_analyzed_reference();
+    const char* reason = nullptr;
+    if (align_interval_ms_ > 0) {
+        reason = "alignment moves the reference";
+    } else if (!analyzer_.supports_touched_input()) {
+        reason = "regions, comparison references, plane sweep, tile map or polarity need frames";
+    } else if (reference.width() != event_tap_->get_width() || reference.height() != event_tap_->get_height()) {
+        reason = "the reference is not of the camera's frame size";
+    }
+    if (reason) {
+        core::LogLine(core::LogLevel::Warning)
+            << "Scattering: camera " << camera_index_ << " analyzes frames, " << reason;
+        return;
+    }
+
+    // The tap tests against its own copy: the analyzer's is only read on this thread
+    tap_dropped_base_ = event_tap_->get_dropped_windows();
+    event_tap_->set_reference(std::make_shared<const video::BinaryFrame>(reference));
+    event_tap_->set_enabled(true);
+    event_driven_ = true;
+    core::LogLine(core::LogLevel::Info) << "Scattering: camera " << camera_index_ << " analyzes events per window";
+}
+
+void ScatteringWorker::analyze_event_windows() {
+    Metavision::timestamp window_end_ts = 0;
+    auto& qos = core::QosScheduler::instance();
+    while (event_tap_->take(touched_keys_, window_end_ts)) {
+        analyzer_.set_heatmap_deferred(!qos.admit(core::QosScheduler::Work::Heatmap));
+        if (analyzer_.analyze_touched(touched_keys_)) {
+            frames_analyzed_++;
+        }
+    }
+}
+
+void ScatteringWorker::worker_loop() {
+    core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::Analysis, camera_index_);
+    while (running_.load()) {
+        if (source_.wait_for_frame(consumer_id_, 10000)) {
+            if (reset_requested_.exchange(false)) {
+                analyzer_.reset_temporal_data();
+            }
+
+            // Drain everything queued so far before sleeping again
+            while (auto frame_opt = source_.consume_frame(consumer_id_)) {
+                video::ReadGuard guard(*frame_opt);
+                if (building_.load()) {
+                    build_reference(guard.get());
+                    continue;
+                }
+                if (event_driven_.load()) {
+                    continue;  // Windows come from the event tap
+                }
+                if (guard->size() != analyzer_.get_data().scattering_bits.size() ||
+                    guard->type() != CV_8UC1) {
+                    continue;  // Not a binary frame of the reference size
+                }
+
+                // Counting always runs; only the heatmap refresh may be shed under pressure
+                auto& qos = core::QosScheduler::instance();
+                analyzer_.set_heatmap_deferred(!qos.admit(core::QosScheduler::Work::Heatmap));
+
+                // The plane sweep packs the live mask itself, from the same pass
+                bool analyzed;
+                if (analyzer_.get_plane_sweep()) {
+                    analyzed = analyzer_.analyze_planes(guard.get());
+                } else if (align_interval_ms_ <= 0 && analyzer_.supports_touched_input() &&
+                           video::RunFrame::prefer(frame_opt->timing().active_pixels, guard->size())) {
+                    // Very sparse frame: runs from the touched row bands only, no pass over every word
+                    analyzed = live_runs_.assign_masked(guard.get(), analyzer_.get_live_mask(), frame_opt->row_bands(),
+                                                        frame_opt->block_map()) &&
+                               analyzer_.analyze_runs(live_runs_);
+                } else {
+                    // Blocks the accumulator saw no event in are neither packed nor scanned
+                    analyzed = live_bits_.assign_masked(guard.get(), analyzer_.get_live_mask(), frame_opt->block_map()) &&
+                               analyzer_.analyze_frame(live_bits_, frame_opt->block_map());
+                    if (analyzed && align_interval_ms_ > 0) {
+                        aligner_.accumulate(live_bits_);
+                    }
+                }
+                if (analyzed) {
+                    frames_analyzed_++;
+                    if (core::RunLog::instance().is_open()) {
+                        log_frame(frame_opt->timing());
+                    }
+                }
+                const int64_t done_us = core::LatencyStats::now_us();
+                const size_t backlog = source_.get_backlog(consumer_id_);
+                core::FlightRecorder::instance().record_analysis(frame_opt->timing(), camera_index_, done_us,
+                                                                 backlog, source_.get_capacity());
+                if (qos.is_enabled()) {
+                    const int64_t callback_us = frame_opt->timing().callback_us;
+                    if (callback_us > 0) {
+                        qos.report_latency(done_us - callback_us);
+                    }
+                    qos.report_queue(backlog, source_.get_capacity());
+                }
+            }
+        }
+
+        if (building_.load()) {
+            continue;  // Nothing to publish or align yet
+        }
+        if (event_driven_.load()) {
+            analyze_event_windows();
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (align_interval_ms_ > 0 && now - last_align_ >= std::chrono::milliseconds(align_interval_ms_)) {
+            update_alignment();
+            last_align_ = now;
+        }
+        if (now - last_publish_ >= std::chrono::milliseconds(publish_interval_ms_.load())) {
+            publish_snapshot();
+        }
+        if (timeline_interval_s_ > 0 && now - last_timeline_ >= std::chrono::seconds(timeline_interval_s_)) {
+            write_timeline();
+            last_timeline_ = now;
+        }
+        if (checkpoint_interval_s_ > 0 && now - last_checkpoint_ >= std::chrono::seconds(checkpoint_interval_s_)) {
+            write_checkpoint();
+            last_checkpoint_ = now;
+        }
+    }
+}
+
+void ScatteringWorker::set_timeline(const std::string& path, int interval_s) {
+    timeline_path_ = path;
+    timeline_interval_s_ = path.empty() ? 0 : std::max(interval_s, 0);
+}
+
+void ScatteringWorker::write_timeline() {
+    if (timeline_failed_) {
+        return;
+    }
+    analyzer_.copy_counts_to(timeline_counts_);
+    if (timeline_counts_.empty()) {
+        return;
+    }
+    if (!timeline_.is_open() && !timeline_.open(timeline_path_, timeline_counts_.cols, timeline_counts_.rows)) {
+        timeline_failed_ = true;   // Reported by the writer; not retried until the next start
+        return;
+    }
+    timeline_failed_ = !timeline_.append(timeline_counts_, frames_analyzed_.load());
+}
+
+void ScatteringWorker::set_checkpoint(const std::string& path, int interval_s, bool resume) {
+    if (running_.load()) {
+        std::cerr << "ScatteringWorker: Stop the worker before changing checkpoints" << std::endl;
+        return;
+    }
+    checkpoint_path_ = path;
+    checkpoint_interval_s_ = path.empty() ? 0 : std::max(interval_s, 0);
+    checkpoint_resume_ = resume && !path.empty();
+}
+
+void ScatteringWorker::resume_checkpoint() {
+    std::error_code ec;
+    if (checkpoint_path_.empty() || !std::filesystem::exists(checkpoint_path_, ec)) {
+        return;
+    }
+    if (!checkpoint_resume_) {
+        core::LogLine(core::LogLevel::Warning)
+            << "Scattering: camera " << camera_index_ << " replaces the checkpoint " << checkpoint_path_
+            << " of an earlier run (scattering_checkpoint_resume = true continues from it)";
+        return;
+    }
+
+    AnalysisShard shard;
+    if (!shard.load(checkpoint_path_) || !analyzer_.import_shard(shard)) {
+        core::LogLine(core::LogLevel::Warning)
+            << "Scattering: camera " << camera_index_ << " starts over, " << checkpoint_path_
+            << " is unreadable or was taken against another reference or settings";
+        return;
+    }
+    core::LogLine(core::LogLevel::Info)
+        << "Scattering: camera " << camera_index_ << " resumed from " << checkpoint_path_ << " ("
+        << shard.frames << " frames, " << shard.total_scattering_events << " scattering events)";
+}
+
+void ScatteringWorker::write_checkpoint() {
+    // Only the export runs here; serialization and the write are on the writer's thread
+    analyzer_.export_shard(*checkpoint_shard_);
+    checkpoint_shard_ = checkpoint_writer_.submit(std::move(checkpoint_shard_));
+}
+
+void ScatteringWorker::log_frame(const video::FrameTiming& timing) {
+    core::RunLog::Row row;
+    row.frame_index = timing.frame_index;
+    row.camera = camera_index_;
+    row.camera_ts = timing.camera_ts;
+    row.window_us = timing.window_us;
+    row.events = timing.events;
+    row.on_events = timing.on_events;
+    if (timing.events >= 0 && timing.on_events >= 0) {
+        row.off_events = timing.events - timing.on_events;
+    }
+    if (timing.active_pixels >= 0 && analyzer_.get_live_mask() == 0xFF) {
+        row.active_pixels = static_cast<int32_t>(timing.active_pixels);  // Counted while the frame was built
+    } else if (!analyzer_.get_plane_sweep()) {
+        row.active_pixels = static_cast<int32_t>(live_bits_.count());  // Packed inside the analyzer otherwise
+    }
+    row.scattering_pixels = analyzer_.get_data().current_scattering_pixels;
+    if (timing.callback_us > 0) {
+        row.latency_us = static_cast<int32_t>(core::LatencyStats::now_us() - timing.callback_us);
+    }
+    core::RunLog::instance().append(row);
+}
+
+void ScatteringWorker::build_reference(const cv::Mat& frame) {
+    if (frame.type() != CV_8UC1 || frame.empty()) {
+        return;
+    }
+    if (builder_.frames() == 0 && (frame.cols != builder_.width() || frame.rows != builder_.height())) {
+        builder_.start(frame.cols, frame.rows, builder_.target());
+    }
+    if (!live_bits_.assign_masked(frame, analyzer_.get_live_mask()) || !builder_.add(live_bits_)) {
+        return;  // Other size, or more frames to come
+    }
+
+    video::BinaryFrame reference;
+    builder_.build(build_occupancy_, reference);
+    auto image = std::make_shared<cv::Mat>();
+    reference.to_mat(*image);
+    core::LogLine(core::LogLevel::Info)
+        << "Scattering: camera " << camera_index_ << " reference built from " << builder_.frames() << " frames, "
+        << reference.count() << " pixels set";
+
+    if (!analyzer_.start_analysis(std::make_shared<const video::BinaryFrame>(std::move(reference)))) {
+        return;  // Stays idle until stopped
+    }
+    building_ = false;
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        built_reference_ = std::move(image);
+    }
+    if (align_interval_ms_ > 0) {
+        aligner_.set_reference(analyzer_.get_reference());
+        last_align_ = std::chrono::steady_clock::now();
+    }
+    resume_checkpoint();
+    attach_event_tap();
+    publish_snapshot();
+}
+
+void ScatteringWorker::update_alignment() {
+    const cv::Point current = analyzer_.get_data().reference_offset;
+    ReferenceAligner::Estimate estimate;
+    if (!aligner_.estimate(current, estimate)) {
+        return;  // Too little activity since the last estimate
+    }
+
+    analyzer_.set_alignment_estimate(estimate.shift, static_cast<float>(estimate.response));
+    if (estimate.offset != current) {
+        analyzer_.set_reference_offset(estimate.offset);
+        core::LogLine(core::LogLevel::Info)
+            << "Scattering: camera " << camera_index_ << " reference offset (" << estimate.offset.x << ", "
+            << estimate.offset.y << "), unmatched live pixels " << estimate.unmatched_before << " -> "
+            << estimate.unmatched_after;
+    }
+
+    static core::Gauge& offset_x = core::MetricsRegistry::instance().gauge("scattering.align_dx");
+    static core::Gauge& offset_y = core::MetricsRegistry::instance().gauge("scattering.align_dy");
+    offset_x.set(estimate.offset.x);
+    offset_y.set(estimate.offset.y);
+}
+
+void ScatteringWorker::publish_snapshot() {
+    // Reuse the back buffer only once no UI reader still holds it
+    if (!back_ || back_.use_count() > 1) {
+        back_ = std::make_shared<Snapshot>();
+    }
+
+    const Snapshot& src = analyzer_.get_data();
+    Snapshot& dst = *back_;
+
+    // Deep copy into existing allocations (copyTo only reallocates on size change)
+    dst.scattering_bits = src.scattering_bits;
+    dst.scattering_bits.to_mat(dst.scattering_mask);
+    analyzer_.copy_counts_to(dst.scattering_count);  // Always dense for the UI
+    src.scattering_heatmap.copyTo(dst.scattering_heatmap);
+    dst.current_scattering_pixels = src.current_scattering_pixels;
+    dst.current_scattering_percentage = src.current_scattering_percentage;
+
+    // Same cadence as the UI sees it
+    static core::Gauge& percentage = core::MetricsRegistry::instance().gauge("scattering.percentage");
+    static core::Gauge& pixels = core::MetricsRegistry::instance().gauge("scattering.pixels");
+    static core::Gauge& max_count = core::MetricsRegistry::instance().gauge("scattering.max_count");
+    percentage.set(src.current_scattering_percentage);
+    pixels.set(src.current_scattering_pixels);
+    max_count.set(src.max_scattering_count);
+    dst.frames_analyzed = src.frames_analyzed;
+    dst.max_scattering_count = src.max_scattering_count;
+    dst.hot_spot_location = src.hot_spot_location;
+    dst.hot_pixels = src.hot_pixels;
+    dst.total_scattering_events = src.total_scattering_events;
+    dst.average_scattering_per_frame = src.average_scattering_per_frame;
+    dst.scattering_std_per_frame = src.scattering_std_per_frame;
+    dst.scattering_ci_half_width = src.scattering_ci_half_width;
+    dst.scattering_converged = src.scattering_converged;
+    src.window_count.copyTo(dst.window_count);
+    dst.window_frames = src.window_frames;
+    dst.window_scattering_events = src.window_scattering_events;
+    dst.window_average_per_frame = src.window_average_per_frame;
+    src.decay_rate.copyTo(dst.decay_rate);
+    dst.decay_scattering_per_frame = src.decay_scattering_per_frame;
+    dst.regions = src.regions;
+    dst.planes = src.planes;
+    dst.clusters = src.clusters;
+    dst.references = src.references;
+    src.tile_scattering.copyTo(dst.tile_scattering);
+    src.tile_scattering_total.copyTo(dst.tile_scattering_total);
+    dst.hot_tile = src.hot_tile;
+    dst.reference_offset = src.reference_offset;
+    dst.alignment_shift = src.alignment_shift;
+    dst.alignment_response = src.alignment_response;
+
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        std::swap(front_, back_);
+    }
+    last_publish_ = std::chrono::steady_clock::now();
+
+    // A subscriber holding the snapshot keeps it from being reused as the back buffer
+    auto& channel = PipelineBus::instance().analysis();
+    if (channel.has_subscribers()) {
+        PipelineBus::AnalysisMessage message;
+        message.camera_index = camera_index_;
+        message.scattering = front_;
+        channel.publish(message);
+    }
+}
+
+void ScatteringWorker::set_rolling_stats(int window_frames, int decay_shift) {
+    if (running_.load()) {
+        std::cerr << "ScatteringWorker: Stop the worker before changing rolling statistics" << std::endl;
+        return;
+    }
+    analyzer_.set_window(window_frames);
+    analyzer_.set_decay(decay_shift);
+}
+
+void ScatteringWorker::set_regions(std::vector<ScatteringAnalyzer::Region> regions) {
+    if (running_.load()) {
+        std::cerr << "ScatteringWorker: Stop the worker before changing regions" << std::endl;
+        return;
+    }
+    analyzer_.set_regions(std::move(regions));
+}
+
+void ScatteringWorker::set_live_mask(uint8_t bit_mask) {
+    if (running_.load()) {
+        std::cerr << "ScatteringWorker: Stop the worker before changing the live mask" << std::endl;
+        return;
+    }
+    analyzer_.set_live_mask(bit_mask);
+}
+
+void ScatteringWorker::set_plane_sweep(bool enabled) {
+    if (running_.load()) {
+        std::cerr << "ScatteringWorker: Stop the worker before changing the plane sweep" << std::endl;
+        return;
+    }
+    analyzer_.set_plane_sweep(enabled);
+}
+
+void ScatteringWorker::set_tile_map(bool enabled) {
+    if (running_.load()) {
+        std::cerr << "ScatteringWorker: Stop the worker before changing the tile map" << std::endl;
+        return;
+    }
+    analyzer_.set_tile_map(enabled);
+}
+
+void ScatteringWorker::set_cluster_stats(bool enabled) {
+    if (running_.load()) {
+        std::cerr << "ScatteringWorker: Stop the worker before changing cluster statistics" << std::endl;
+        return;
+    }
+    analyzer_.set_cluster_stats(enabled);
+}
+
+void ScatteringWorker::set_comparison_references(std::vector<ScatteringAnalyzer::Reference> references) {
+    if (running_.load()) {
+        std::cerr << "ScatteringWorker: Stop the worker before changing comparison references" << std::endl;
+        return;
+    }
+    analyzer_.set_comparison_references(std::move(references));
+}
+
+void ScatteringWorker::set_alignment(int interval_ms, int max_shift_px) {
+    if (running_.load()) {
+        std::cerr << "ScatteringWorker: Stop the worker before changing alignment" << std::endl;
+        return;
+    }
+    align_interval_ms_ = std::max(interval_ms, 0);
+    aligner_.set_max_shift(max_shift_px);
+}
+
+std::shared_ptr<const ScatteringWorker::Snapshot> ScatteringWorker::get_snapshot() const {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    return front_;
+}
+
+void ScatteringWorker::set_confidence_target(float relative_half_width, int min_frames) {
+    if (running_.load()) {
+        std::cerr << "ScatteringWorker: Stop the worker before changing the confidence target" << std::endl;
+        return;
+    }
+    analyzer_.set_confidence_target(relative_half_width, min_frames);
+}
+
+std::shared_ptr<const cv::Mat> ScatteringWorker::get_built_reference() const {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    return built_reference_;
+}
+
+int64_t ScatteringWorker::get_frames_missed() const {
+    const int consumer_id = consumer_id_.load();
+    if (consumer_id < 0) {
+        return frames_missed_.load();
+    }
+    if (event_driven_.load()) {
+        return static_cast<int64_t>(event_tap_->get_dropped_windows() - tap_dropped_base_);  // Windows, not frames
+    }
+    return source_.get_frames_dropped(consumer_id);
+}
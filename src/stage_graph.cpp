@@ -0,0 +1,218 @@
+#include "stage_graph.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+StageGraph::Stage::Stage(const StageSpec& stage_spec)
+    : spec(stage_spec),
+      utilization_gauge(core::MetricsRegistry::instance().gauge("stage." + stage_spec.name + ".utilization")),
+      queue_gauge(core::MetricsRegistry::instance().gauge("stage." + stage_spec.name + ".queue")),
+      processed_counter(core::MetricsRegistry::instance().counter("stage." + stage_spec.name + ".processed")) {}
+
+StageGraph::~StageGraph() {
+    stop();
+}
+
+bool StageGraph::parse(const std::string& spec, std::vector<StageSpec>& specs) {
+    specs.clear();
+    bool ok = true;
+
+    size_t begin = 0;
+    while (begin < spec.size()) {
+        size_t end = spec.find(';', begin);
+        if (end == std::string::npos) end = spec.size();
+        const std::string entry = spec.substr(begin, end - begin);
+        begin = end + 1;
+        if (entry.find_first_not_of(" \t") == std::string::npos) continue;
+
+        const size_t colon = entry.find(':');
+        const size_t name_begin = entry.find_first_not_of(" \t");
+        char kind[64] = {};
+        char executor[16] = {};
+        int depth = 0;
+        char overflow[16] = {};
+        const int fields = colon == std::string::npos ? 0 :
+            std::sscanf(entry.c_str() + colon + 1, " %63[^, \t] , %15[^, \t] , %d , %15[^, \t]",
+                        kind, executor, &depth, overflow);
+
+        StageSpec stage;
+        const std::string executor_text = executor;
+        const std::string overflow_text = overflow;
+        bool valid = colon != std::string::npos && name_begin < colon && fields >= 3 && depth > 0;
+        if (executor_text == "thread") stage.executor = Executor::Thread;
+        else if (executor_text == "pool") stage.executor = Executor::Pool;
+        else if (executor_text == "gpu") stage.executor = Executor::Gpu;
+        else valid = false;
+        if (fields < 4 || overflow_text == "oldest") stage.overflow = BusOverflow::DropOldest;
+        else if (overflow_text == "newest") stage.overflow = BusOverflow::DropNewest;
+        else valid = false;
+
+        if (valid) {
+            const size_t name_end = entry.find_last_not_of(" \t", colon - 1);
+            stage.name = entry.substr(name_begin, name_end - name_begin + 1);
+            stage.kind = kind;
+            stage.depth = static_cast<size_t>(depth);
+            valid = std::none_of(specs.begin(), specs.end(),
+                                 [&stage](const StageSpec& other) { return other.name == stage.name; });
+        }
+        if (!valid) {
+            std::cerr << "StageGraph: Ignoring stage \"" << entry
+                      << "\" (expected unique name:kind,thread|pool|gpu,depth[,oldest|newest])" << std::endl;
+            ok = false;
+            continue;
+        }
+        specs.push_back(stage);
+    }
+    return ok;
+}
+
+const char* StageGraph::executor_name(Executor executor) {
+    switch (executor) {
+        case Executor::Thread: return "thread";
+        case Executor::Pool: return "pool";
+        case Executor::Gpu: return "gpu";
+    }
+    return "?";
+}
+
+void StageGraph::start(int pool_threads, bool render_loop) {
+    if (running_.load() || stages_.empty()) {
+        return;
+    }
+
+    int pool_stages = 0;
+    for (const auto& stage : stages_) {
+        stage->effective = (stage->spec.executor == Executor::Gpu && !render_loop) ? Executor::Thread : stage->spec.executor;
+        pool_stages += stage->effective == Executor::Pool;
+    }
+    if (pool_stages > 0) {
+        pool_ = std::make_unique<video::ThreadPool>(std::max(pool_threads > 0 ? pool_threads : pool_stages, 1));
+    }
+
+    running_ = true;
+    const int64_t now_us = core::LatencyStats::now_us();
+    for (const auto& stage : stages_) {
+        stage->last_sample_us = now_us;
+        stage->last_busy_us = stage->busy_us.load(std::memory_order_relaxed);
+        if (stage->effective == Executor::Pool) {
+            std::weak_ptr<Stage> weak = stage;
+            stage->attach([this, weak] {
+                if (auto locked = weak.lock()) {
+                    schedule(locked);
+                }
+            });
+        } else {
+            stage->attach({});
+        }
+        if (stage->effective == Executor::Thread) {
+            Stage* raw = stage.get();
+            stage->thread = std::thread([this, raw] {
+                while (running_.load(std::memory_order_relaxed)) {
+                    raw->wait_process(WAIT_US);
+                }
+            });
+        }
+    }
+
+    std::cout << "Pipeline stages:";
+    for (const auto& stage : stages_) {
+        std::cout << " " << stage->spec.name << "(" << stage->spec.kind << ", " << executor_name(stage->effective)
+                  << ", depth " << stage->spec.depth << ")";
+    }
+    std::cout << std::endl;
+}
+
+void StageGraph::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    for (const auto& stage : stages_) {
+        stage->detach();
+        stage->wake();
+    }
+    for (const auto& stage : stages_) {
+        if (stage->thread.joinable()) {
+            stage->thread.join();
+        }
+        // A drain task still running finishes its batch; queued ones see running_ and return
+        while (stage->scheduled.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    // Joined outside the lock: a worker finishing drain() may still be in schedule()
+    std::unique_ptr<video::ThreadPool> pool;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        pool = std::move(pool_);
+    }
+    pool.reset();
+}
+
+void StageGraph::schedule(const std::shared_ptr<Stage>& stage) {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (!running_.load() || !pool_ || stage->scheduled.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    pool_->post([this, stage] { drain(stage); });
+}
+
+void StageGraph::drain(const std::shared_ptr<Stage>& stage) {
+    for (int n = 0; n < POOL_BATCH && running_.load(std::memory_order_relaxed) && stage->try_process(); ++n) {
+    }
+    stage->scheduled.store(false, std::memory_order_release);
+
+    // A message pushed while the flag was still set scheduled nothing; so does a batch cut short
+    if (stage->queued() > 0) {
+        schedule(stage);
+    }
+}
+
+void StageGraph::run_gpu(int64_t budget_us) {
+    if (!running_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    const int64_t deadline_us = core::LatencyStats::now_us() + budget_us;
+    for (const auto& stage : stages_) {
+        if (stage->effective != Executor::Gpu) {
+            continue;
+        }
+        while (core::LatencyStats::now_us() < deadline_us && stage->try_process()) {
+        }
+    }
+}
+
+void StageGraph::sample() {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    const int64_t now_us = core::LatencyStats::now_us();
+    for (const auto& stage : stages_) {
+        const int64_t busy_us = stage->busy_us.load(std::memory_order_relaxed);
+        const int64_t wall_us = now_us - stage->last_sample_us;
+        if (wall_us > 0) {
+            stage->utilization = std::min(100.0, 100.0 * (busy_us - stage->last_busy_us) / wall_us);
+        }
+        stage->last_busy_us = busy_us;
+        stage->last_sample_us = now_us;
+        stage->utilization_gauge.set(stage->utilization);
+        stage->queue_gauge.set(static_cast<double>(stage->queued()));
+    }
+}
+
+std::vector<StageGraph::StageStats> StageGraph::get_stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    std::vector<StageStats> stats;
+    stats.reserve(stages_.size());
+    for (const auto& stage : stages_) {
+        StageStats entry;
+        entry.name = stage->spec.name;
+        entry.kind = stage->spec.kind;
+        entry.executor = stage->effective;
+        entry.utilization = stage->utilization;
+        entry.queued = stage->queued();
+        entry.capacity = stage->capacity();
+        entry.processed = stage->processed.load(std::memory_order_relaxed);
+        entry.dropped = stage->dropped();
+        stats.push_back(entry);
+    }
+    return stats;
+}
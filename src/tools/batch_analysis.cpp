@@ -0,0 +1,353 @@
+/**
+ * Batch Analysis Tool
+ *
+ * Headless re-scoring of saved captures: runs noise analysis and (optionally)
+ * scattering against a reference over every ImageManager PNG+JSON pair in a
+ * directory and writes one consolidated CSV.
+ *
+ * Files are processed in parallel; each worker thread owns its own
+ * NoiseAnalyzer and ScatteringAnalyzer, so nothing is shared between workers
+ * except the next-file counter. Rows are written in sorted file order
+ * regardless of which worker finished first.
+ *
+ * Usage:
+ *   batch_analysis <directory> [--reference <png>] [--output <csv>] [--threads <n>]
+ *                  [--recursive] [--threshold <0-255>] [--min-area <px>] [--max-area <px>]
+ *                  [--lattice] [--per-dot <csv>]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "image_manager.h"
+#include "noise_analyzer.h"
+#include "scattering_analyzer.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    fs::path directory;
+    fs::path reference;
+    fs::path output;
+    int threads = 0;            // 0 = all cores
+    bool recursive = false;
+    fs::path per_dot_output;    // Empty = no per-dot CSV
+    DotDetectionParams detection;
+};
+
+/**
+ * One CSV row
+ */
+struct FileResult {
+    bool loaded = false;
+    bool has_metadata = false;
+    ImageManager::ImageMetadata metadata{};
+    NoiseAnalysisResults noise;
+    bool scattering_valid = false;
+    int scattering_pixels = 0;
+    float scattering_percentage = 0.0f;
+    std::string error;
+};
+
+void print_usage() {
+    std::cout << "Usage: batch_analysis <directory> [options]\n"
+              << "  --reference <png>   Reference image for scattering (binary, same size)\n"
+              << "  --output <csv>      Output file (default: <directory>/batch_analysis.csv)\n"
+              << "  --threads <n>       Worker threads (default: all cores)\n"
+              << "  --recursive         Include subdirectories\n"
+              << "  --threshold <v>     Dot detection threshold 0-255 (default 128)\n"
+              << "  --min-area <px>     Minimum dot area (default 50)\n"
+              << "  --max-area <px>     Maximum dot area (default 2000)\n"
+              << "  --contours          Trace dot contours instead of labelling components\n"
+              << "  --lattice           Fit a regular dot grid (fills missed dots, drops strays)\n"
+              << "  --per-dot <csv>     Also write SNR and contrast of every dot of every image\n";
+}
+
+bool parse_args(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--reference" && has_value) {
+            options.reference = argv[++i];
+        } else if (arg == "--output" && has_value) {
+            options.output = argv[++i];
+        } else if (arg == "--threads" && has_value) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--recursive") {
+            options.recursive = true;
+        } else if (arg == "--threshold" && has_value) {
+            options.detection.threshold_value = std::atoi(argv[++i]);
+        } else if (arg == "--min-area" && has_value) {
+            options.detection.min_area = std::atoi(argv[++i]);
+        } else if (arg == "--max-area" && has_value) {
+            options.detection.max_area = std::atoi(argv[++i]);
+        } else if (arg == "--contours") {
+            options.detection.use_contours = true;
+        } else if (arg == "--lattice") {
+            options.detection.fit_lattice = true;
+        } else if (arg == "--per-dot" && has_value) {
+            options.per_dot_output = argv[++i];
+        } else if (!arg.empty() && arg[0] != '-' && options.directory.empty()) {
+            options.directory = arg;
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (options.directory.empty()) {
+        return false;
+    }
+    if (options.output.empty()) {
+        options.output = options.directory / "batch_analysis.csv";
+    }
+    return true;
+}
+
+/**
+ * Collect PNG files (sorted, so the CSV order is stable)
+ */
+std::vector<fs::path> find_images(const Options& options) {
+    std::vector<fs::path> files;
+    std::error_code ec;
+
+    auto consider = [&](const fs::directory_entry& entry) {
+        if (!entry.is_regular_file()) {
+            return;
+        }
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (ext == ".png" && fs::absolute(entry.path(), ec) != fs::absolute(options.reference, ec)) {
+            files.push_back(entry.path());
+        }
+    };
+
+    if (options.recursive) {
+        for (const auto& entry : fs::recursive_directory_iterator(options.directory, ec)) {
+            consider(entry);
+        }
+    } else {
+        for (const auto& entry : fs::directory_iterator(options.directory, ec)) {
+            consider(entry);
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+/**
+ * Analyze files[i] for every i handed out by next_index
+ */
+void worker(const std::vector<fs::path>& files, const Options& options, const ImageManager::BinaryHandle& reference,
+            std::vector<FileResult>& results, std::atomic<size_t>& next_index, std::atomic<size_t>& done) {
+    // Per-worker analyzers: no locking on the hot path
+    NoiseAnalyzer noise_analyzer;
+    ScatteringAnalyzer scattering_analyzer;
+    noise_analyzer.setParallel(false);      // Already one file per core
+    scattering_analyzer.set_parallel(false);
+    const bool use_reference = reference && scattering_analyzer.start_analysis(reference);
+
+    for (size_t i = next_index.fetch_add(1); i < files.size(); i = next_index.fetch_add(1)) {
+        FileResult& result = results[i];
+        cv::Mat image;
+
+        if (!ImageManager::load_image(files[i].string(), result.metadata, image, false)) {
+            result.error = "load failed";
+        } else {
+            result.loaded = true;
+            result.has_metadata = !result.metadata.timestamp.empty();
+
+            // Same pipeline as processImage(), without decoding the file a second time
+            noise_analyzer.setImage(image);
+            result.noise = noise_analyzer.processCurrentImage(options.detection);
+
+            // Temporal counts accumulate per worker and are not reported;
+            // only this frame's scattering is
+            if (use_reference) {
+                if (image.size() != reference->size()) {
+                    result.error = "size differs from reference";
+                } else if (scattering_analyzer.analyze_frame(image)) {
+                    const auto& data = scattering_analyzer.get_data();
+                    result.scattering_valid = true;
+                    result.scattering_pixels = data.current_scattering_pixels;
+                    result.scattering_percentage = data.current_scattering_percentage;
+                }
+            }
+        }
+
+        const size_t finished = done.fetch_add(1) + 1;
+        if (finished % 100 == 0) {
+            std::cout << "  " << finished << " / " << files.size() << std::endl;
+        }
+    }
+}
+
+/**
+ * Quote a CSV field (comments may contain commas, quotes or newlines)
+ */
+std::string csv_quote(const std::string& value) {
+    std::string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    quoted += '"';
+    return quoted;
+}
+
+bool write_csv(const fs::path& path, const std::vector<fs::path>& files,
+               const std::vector<FileResult>& results, const Options& options) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << "file,timestamp,binary_bit_1,binary_bit_2,accumulation_time_us,width,height,"
+            "active_pixels,pixel_density,num_dots,signal_mean,signal_std,num_signal_pixels,"
+            "noise_mean,noise_std,num_noise_pixels,snr_db,contrast_ratio,"
+            "scattering_pixels,scattering_percentage,comment,error\n";
+    file << std::fixed << std::setprecision(4);
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        const FileResult& r = results[i];
+        const auto& m = r.metadata;
+        file << csv_quote(fs::relative(files[i], options.directory).string()) << ',';
+
+        if (r.loaded) {
+            if (r.has_metadata) {
+                file << csv_quote(m.timestamp) << ',' << m.binary_bit_1 << ',' << m.binary_bit_2 << ','
+                     << m.accumulation_time_us << ',';
+            } else {
+                file << ",,,,";
+            }
+            file << m.image_width << ',' << m.image_height << ',' << m.active_pixels << ','
+                 << m.pixel_density << ',' << r.noise.num_dots_detected << ','
+                 << r.noise.signal_mean << ',' << r.noise.signal_std << ',' << r.noise.num_signal_pixels << ','
+                 << r.noise.noise_mean << ',' << r.noise.noise_std << ',' << r.noise.num_noise_pixels << ','
+                 << r.noise.snr_db << ',' << r.noise.contrast_ratio << ',';
+            if (r.scattering_valid) {
+                file << r.scattering_pixels << ',' << r.scattering_percentage << ',';
+            } else {
+                file << ",,";
+            }
+            file << csv_quote(m.comment) << ',';
+        } else {
+            file << std::string(20, ',');
+        }
+        file << csv_quote(r.error) << '\n';
+    }
+    return file.good();
+}
+
+/**
+ * One row per dot, every image in file order
+ */
+bool write_per_dot_csv(const fs::path& path, const std::vector<fs::path>& files,
+                       const std::vector<FileResult>& results, const Options& options) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    PerDotStatistics().writeCsv(file, "file", true);
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (results[i].noise.per_dot) {
+            results[i].noise.per_dot->writeCsv(
+                file, csv_quote(fs::relative(files[i], options.directory).string()), false);
+        }
+    }
+    return file.good();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_args(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+    if (!fs::is_directory(options.directory)) {
+        std::cerr << "Not a directory: " << options.directory << std::endl;
+        return 1;
+    }
+
+    // Packed once and shared by every worker's analyzer
+    ImageManager::BinaryHandle reference;
+    if (!options.reference.empty()) {
+        reference = ImageManager::load_binary(options.reference.string());
+        if (!reference) {
+            std::cerr << "Failed to load reference image: " << options.reference << std::endl;
+            return 1;
+        }
+    }
+
+    const std::vector<fs::path> files = find_images(options);
+    if (files.empty()) {
+        std::cerr << "No PNG files found in " << options.directory << std::endl;
+        return 1;
+    }
+
+    int threads = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::max(1, std::min(threads, static_cast<int>(files.size())));
+
+    // Parallelism is across files; OpenCV's own thread pool would only oversubscribe
+    cv::setNumThreads(1);
+
+    std::cout << "Analyzing " << files.size() << " images with " << threads << " threads";
+    if (reference) {
+        std::cout << " (scattering reference: " << options.reference.filename() << ")";
+    }
+    std::cout << std::endl;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<FileResult> results(files.size());
+    std::atomic<size_t> next_index{0};
+    std::atomic<size_t> done{0};
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back(worker, std::cref(files), std::cref(options), std::cref(reference),
+                             std::ref(results), std::ref(next_index), std::ref(done));
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    const double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto failed = std::count_if(results.begin(), results.end(),
+                                      [](const FileResult& r) { return !r.loaded; });
+
+    if (!write_csv(options.output, files, results, options)) {
+        std::cerr << "Failed to write " << options.output << std::endl;
+        return 1;
+    }
+
+    if (!options.per_dot_output.empty() && !write_per_dot_csv(options.per_dot_output, files, results, options)) {
+        std::cerr << "Failed to write " << options.per_dot_output << std::endl;
+        return 1;
+    }
+
+    std::cout << "Done: " << files.size() << " images in " << elapsed_s << " s ("
+              << files.size() / std::max(elapsed_s, 1e-9) << " images/s), " << failed << " failed" << std::endl;
+    std::cout << "Results written to " << options.output << std::endl;
+    return static_cast<size_t>(failed) == files.size() ? 1 : 0;
+}
@@ -0,0 +1,1269 @@
+/**
+ * Pipeline Benchmark
+ *
+ * Measures the frame hot path without a camera: a synthetic EventCD source
+ * (configurable rate, spatial distribution, hot pixels and flicker) feeds
+ * the optional software noise filter and the real frame builder (PeriodicFrameGenerationAlgorithm or the native
+ * BinaryFrameAccumulator), the same per-frame stages as
+ * process_camera_frame() / store_binary_frame() in main.cpp (FramePool slot,
+ * fused bit extraction, FrameBuffer publication), the row/column activity
+ * profile, and ScatteringAnalyzer + NoiseAnalyzer on every published frame.
+ *
+ * Producer and consumer stages are driven from one thread, so the numbers
+ * are per-stage cost rather than scheduling luck (the analyzers may still
+ * fan out to their thread pool, as in the app). Event generation is
+ * excluded from all timings. Heap allocations and cv::Mat buffers are
+ * counted through core::AllocTracker (alloc_hooks.cpp is always linked
+ * here), so a stage that starts allocating per frame shows up immediately.
+ *
+ * Usage:
+ *   pipeline_bench [--rate <Mev/s>] [--duration <s>] [--size <w>x<h>] [--accumulation <us>]
+ *                  [--distribution uniform|gaussian|dots] [--hot-pixels <n>] [--hot-rate <Hz>]
+ *                  [--flicker <Hz>] [--flicker-depth <0-1>] [--batch <events>]
+ *                  [--native-binary] [--polarity-planes] [--bits <b1> <b2>] [--seed <n>]
+ *                  [--noise-filter <us>] [--filter-path scalar|sse41|avx2]
+ *                  [--time-surface <decay_us>] [--windows <us,us,...>]
+ *                  [--slice-events <n>] [--slice-or-time]
+ *                  [--ramp <Mev/s>] [--ramp-factor <x>] [--ramp-max <Mev/s>] [--ring <batches>]
+ *                  [--report <csv>] [--threads <n>]
+ *                  [--matrix] [--sizes <WxH,...>] [--rates <Mev/s,...>] [--thread-counts <n,...>]
+ *
+ * With --ramp, the rate steps up from the given start (each step --duration
+ * of sensor time) until the first thread saturates. Measured stage times
+ * are replayed against the sensor clock as the app's threads would see
+ * them: batches queue in an event ring of --ring slots in front of the
+ * accumulation thread, and frames in a latest-only buffer in front of the
+ * analysis thread. Each step records ring fill and drops, dropped frames,
+ * frame latency percentiles and the CPU share of every stage, and the
+ * report names the stage that saturated first. Ingestion (USB transfer
+ * and decode) is not part of the synthetic stream.
+ *
+ * --threads runs the parallel stages (native accumulator bands, scattering
+ * and noise row bands) on that many threads, from a pool of the bench's
+ * own. --matrix sweeps resolutions, rates and thread counts (native
+ * accumulator, --duration per cell) and reports the speedup and parallel
+ * efficiency of each parallel stage against the first thread count, the
+ * load of the accumulation and analysis threads, and whether the sensor
+ * keeps up in real time.
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <metavision/sdk/base/events/event_cd.h>
+#include <metavision/sdk/core/algorithms/periodic_frame_generation_algorithm.h>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "core/alloc_tracker.h"
+#include "noise_analyzer.h"
+#include "scattering_analyzer.h"
+#include "video/binary_frame_accumulator.h"
+#include "video/event_activity.h"
+#include "video/event_noise_filter.h"
+#include "video/time_surface.h"
+#include "video/window_pyramid.h"
+#include "video/frame_buffer.h"
+#include "video/frame_pool.h"
+#include "video/simd_utils.h"
+#include "video/thread_pool.h"
+
+namespace {
+
+// ============================================================================
+// Options
+// ============================================================================
+
+enum class Distribution { Uniform, Gaussian, Dots };
+
+struct Options {
+    double rate_mev = 10.0;         // Mean event rate (Mev/s of sensor time)
+    double duration_s = 5.0;        // Sensor time to simulate
+    int width = 1280;
+    int height = 720;
+    int accumulation_us = 10000;
+    Distribution distribution = Distribution::Dots;
+    int hot_pixels = 0;
+    double hot_rate_hz = 1000.0;    // Per hot pixel
+    double flicker_hz = 0.0;        // 0 = steady scene
+    double flicker_depth = 1.0;     // Fraction of the scene rate that flickers
+    size_t batch = 4096;            // Events per process_events() call (SDK decode batches are similar)
+    bool native_binary = false;
+    bool polarity_planes = false;   // Native accumulator records ON/OFF bits per pixel
+    int bit_1 = 5;
+    int bit_2 = 6;
+    uint64_t seed = 1;
+    uint32_t noise_filter_us = 0;   // Software noise filter window (0 = off)
+    video::EventNoiseFilter::Path filter_path = video::EventNoiseFilter::Path::Auto;
+    uint32_t time_surface_decay_us = 0;  // Time-surface view decay (0 = off)
+    std::vector<int> windows_us;    // Coarse windows OR-reduced from the native frames (empty = off)
+    uint32_t slice_events = 0;      // Native frames every N events (0 = time slicing)
+    bool slice_or_time = false;     // ... or after the accumulation time, whichever comes first
+    double ramp_start_mev = 0.0;    // Rate ramp from this rate (0 = single run at rate_mev)
+    double ramp_factor = 1.5;       // Rate multiplier per step
+    double ramp_max_mev = 500.0;    // Stop here if nothing saturated
+    int ring_batches = 64;          // Event ring slots in front of the accumulation thread (as in the app)
+    std::string report_path;        // Ramp steps / matrix cells as CSV (empty = console only)
+    int threads = 0;                // Parallel stage threads (0 = serial accumulator, shared analysis pool)
+    bool matrix = false;            // Sweep sizes x rates x thread counts
+    std::vector<cv::Size> matrix_sizes{{640, 480}, {1280, 720}, {1920, 1080}, {2560, 1440}, {3840, 2160}};
+    std::vector<double> matrix_rates{10.0, 30.0, 100.0};
+    std::vector<int> matrix_threads;  // Empty = 1, 2, 4, ... up to the hardware threads
+};
+
+/**
+ * Split a comma-separated list
+ */
+std::vector<std::string> split_list(const std::string& list) {
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= list.size()) {
+        const size_t comma = std::min(list.find(',', start), list.size());
+        if (comma > start) {
+            items.push_back(list.substr(start, comma - start));
+        }
+        start = comma + 1;
+    }
+    return items;
+}
+
+// Dot grid shared by the "dots" distribution and the noise analysis target
+constexpr int DOT_SPACING = 64;
+constexpr int DOT_RADIUS = 8;
+constexpr double DOT_EVENT_FRACTION = 0.9;  // Rest is uniform background
+
+void print_usage() {
+    std::cout << "Usage: pipeline_bench [options]\n"
+              << "  --rate <Mev/s>          Mean event rate (default 10)\n"
+              << "  --duration <s>          Sensor time to simulate (default 5)\n"
+              << "  --size <w>x<h>          Sensor size (default 1280x720)\n"
+              << "  --accumulation <us>     Frame window (default 10000)\n"
+              << "  --distribution <kind>   uniform, gaussian or dots (default dots)\n"
+              << "  --hot-pixels <n>        Pixels firing on their own (default 0)\n"
+              << "  --hot-rate <Hz>         Events per second per hot pixel (default 1000)\n"
+              << "  --flicker <Hz>          Modulate the scene rate at this frequency (default off)\n"
+              << "  --flicker-depth <0-1>   Modulation depth (default 1)\n"
+              << "  --batch <events>        Events per frame builder call (default 4096)\n"
+              << "  --native-binary         Use the native binary accumulator instead of the SDK generator\n"
+              << "  --polarity-planes       Native accumulator with per-pixel ON/OFF bits (implies --native-binary)\n"
+              << "  --bits <b1> <b2>        Binary bit positions (default 5 6)\n"
+              << "  --seed <n>              Random seed (default 1)\n"
+              << "  --noise-filter <us>     Run the software noise filter with this window (default off)\n"
+              << "  --filter-path <kind>    Noise filter check: scalar, sse41 or avx2 (default auto)\n"
+              << "  --time-surface <us>     Maintain the time surface and render it per analyzed frame (default off)\n"
+              << "  --windows <us,...>      Also build these coarse windows from packed frames (implies --native-binary)\n"
+              << "  --slice-events <n>      Emit a frame every n events (implies --native-binary)\n"
+              << "  --slice-or-time         With --slice-events, also emit after the accumulation time\n"
+              << "  --ramp <Mev/s>          Step the rate up from here until a thread saturates (--duration per step)\n"
+              << "  --ramp-factor <x>       Rate multiplier per ramp step (default 1.5)\n"
+              << "  --ramp-max <Mev/s>      Highest ramp rate (default 500)\n"
+              << "  --ring <batches>        Event ring slots in the ramp model (default 64)\n"
+              << "  --report <csv>          Write the ramp steps or matrix cells to this file\n"
+              << "  --threads <n>           Threads for the parallel stages (accumulator bands, analyzer row bands)\n"
+              << "  --matrix                Sweep sizes x rates x thread counts (native accumulator, --duration per cell)\n"
+              << "  --sizes <WxH,...>       Matrix resolutions (default 640x480,1280x720,1920x1080,2560x1440,3840x2160)\n"
+              << "  --rates <Mev/s,...>     Matrix rates (default 10,30,100)\n"
+              << "  --thread-counts <n,...> Matrix thread counts (default 1,2,4,... up to the hardware threads)\n";
+}
+
+bool parse_args(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--rate" && has_value) {
+            options.rate_mev = std::atof(argv[++i]);
+        } else if (arg == "--duration" && has_value) {
+            options.duration_s = std::atof(argv[++i]);
+        } else if (arg == "--size" && has_value) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2) {
+                std::cerr << "Invalid size: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--accumulation" && has_value) {
+            options.accumulation_us = std::atoi(argv[++i]);
+        } else if (arg == "--distribution" && has_value) {
+            const std::string kind = argv[++i];
+            if (kind == "uniform") {
+                options.distribution = Distribution::Uniform;
+            } else if (kind == "gaussian") {
+                options.distribution = Distribution::Gaussian;
+            } else if (kind == "dots") {
+                options.distribution = Distribution::Dots;
+            } else {
+                std::cerr << "Unknown distribution: " << kind << std::endl;
+                return false;
+            }
+        } else if (arg == "--hot-pixels" && has_value) {
+            options.hot_pixels = std::atoi(argv[++i]);
+        } else if (arg == "--hot-rate" && has_value) {
+            options.hot_rate_hz = std::atof(argv[++i]);
+        } else if (arg == "--flicker" && has_value) {
+            options.flicker_hz = std::atof(argv[++i]);
+        } else if (arg == "--flicker-depth" && has_value) {
+            options.flicker_depth = std::atof(argv[++i]);
+        } else if (arg == "--batch" && has_value) {
+            options.batch = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--native-binary") {
+            options.native_binary = true;
+        } else if (arg == "--polarity-planes") {
+            options.native_binary = true;
+            options.polarity_planes = true;
+        } else if (arg == "--bits" && i + 2 < argc) {
+            options.bit_1 = std::atoi(argv[++i]);
+            options.bit_2 = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && has_value) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--noise-filter" && has_value) {
+            options.noise_filter_us = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--time-surface" && has_value) {
+            options.time_surface_decay_us = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--windows" && has_value) {
+            options.native_binary = true;
+            options.windows_us = video::WindowPyramid::parse_windows(argv[++i]);
+        } else if (arg == "--slice-events" && has_value) {
+            options.native_binary = true;
+            options.slice_events = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--slice-or-time") {
+            options.slice_or_time = true;
+        } else if (arg == "--ramp" && has_value) {
+            options.ramp_start_mev = std::atof(argv[++i]);
+        } else if (arg == "--ramp-factor" && has_value) {
+            options.ramp_factor = std::atof(argv[++i]);
+        } else if (arg == "--ramp-max" && has_value) {
+            options.ramp_max_mev = std::atof(argv[++i]);
+        } else if (arg == "--ring" && has_value) {
+            options.ring_batches = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--report" && has_value) {
+            options.report_path = argv[++i];
+        } else if (arg == "--threads" && has_value) {
+            options.threads = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--matrix") {
+            options.matrix = true;
+        } else if (arg == "--sizes" && has_value) {
+            options.matrix_sizes.clear();
+            for (const std::string& item : split_list(argv[++i])) {
+                cv::Size size;
+                if (std::sscanf(item.c_str(), "%dx%d", &size.width, &size.height) != 2 ||
+                    size.width <= 0 || size.height <= 0) {
+                    std::cerr << "Invalid size: " << item << std::endl;
+                    return false;
+                }
+                options.matrix_sizes.push_back(size);
+            }
+        } else if (arg == "--rates" && has_value) {
+            options.matrix_rates.clear();
+            for (const std::string& item : split_list(argv[++i])) {
+                options.matrix_rates.push_back(std::atof(item.c_str()));
+            }
+        } else if (arg == "--thread-counts" && has_value) {
+            options.matrix_threads.clear();
+            for (const std::string& item : split_list(argv[++i])) {
+                options.matrix_threads.push_back(std::max(1, std::atoi(item.c_str())));
+            }
+        } else if (arg == "--filter-path" && has_value) {
+            const std::string kind = argv[++i];
+            if (kind == "scalar") {
+                options.filter_path = video::EventNoiseFilter::Path::Scalar;
+            } else if (kind == "sse41" || kind == "sse4.1") {
+                options.filter_path = video::EventNoiseFilter::Path::SSE41;
+            } else if (kind == "avx2") {
+                options.filter_path = video::EventNoiseFilter::Path::AVX2;
+            } else {
+                std::cerr << "Unknown filter path: " << kind << std::endl;
+                return false;
+            }
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage();
+            return false;
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            print_usage();
+            return false;
+        }
+    }
+
+    if (options.rate_mev <= 0.0 || options.duration_s <= 0.0 || options.width <= 0 || options.height <= 0 ||
+        options.accumulation_us <= 0 || options.hot_pixels < 0 || options.bit_1 < 0 || options.bit_1 > 7 ||
+        options.bit_2 < 0 || options.bit_2 > 7) {
+        std::cerr << "Rate, duration, size and accumulation must be positive, hot pixels >= 0, bits 0-7" << std::endl;
+        return false;
+    }
+    if (options.ramp_start_mev < 0.0 || (options.ramp_start_mev > 0.0 && options.ramp_factor <= 1.0)) {
+        std::cerr << "Ramp start must be positive and the ramp factor above 1" << std::endl;
+        return false;
+    }
+    if (options.matrix) {
+        options.native_binary = true;   // Only the native accumulator has parallel bands
+        if (options.matrix_threads.empty()) {
+            const int hardware = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+            for (int threads = 1; threads < hardware; threads *= 2) {
+                options.matrix_threads.push_back(threads);
+            }
+            options.matrix_threads.push_back(hardware);
+        }
+        if (options.matrix_sizes.empty() || options.matrix_rates.empty() ||
+            std::any_of(options.matrix_rates.begin(), options.matrix_rates.end(), [](double r) { return r <= 0.0; })) {
+            std::cerr << "The matrix needs at least one size and positive rates" << std::endl;
+            return false;
+        }
+    }
+    options.flicker_depth = std::clamp(options.flicker_depth, 0.0, 1.0);
+    return true;
+}
+
+// ============================================================================
+// Synthetic event source
+// ============================================================================
+
+/**
+ * Poisson event stream with a configurable scene
+ *
+ * Inter-event gaps are exponential at the mean rate. With flicker, the
+ * scene part of the stream is thinned by a raised sine so the mean rate
+ * stays as configured. Hot pixels are mixed in at their own fixed rate and
+ * are not modulated. Timestamps are non-decreasing, as from the sensor.
+ */
+class SyntheticEventSource {
+public:
+    explicit SyntheticEventSource(const Options& options)
+        : options_(options)
+        , rng_(options.seed)
+        , x_dist_(0, options.width - 1)
+        , y_dist_(0, options.height - 1) {
+        const double rate = options.rate_mev * 1e6;
+        hot_fraction_ = std::min(1.0, options.hot_pixels * options.hot_rate_hz / rate);
+
+        // Thinning keeps (1 - depth / 2) of the candidates on average
+        const double scene_rate = rate * (1.0 - hot_fraction_);
+        const double keep = options.flicker_hz > 0.0 ? 1.0 - options.flicker_depth / 2.0 : 1.0;
+        const double candidate_rate = scene_rate / std::max(keep, 1e-6) + rate * hot_fraction_;
+        mean_gap_us_ = 1e6 / candidate_rate;
+        hot_candidate_fraction_ = rate * hot_fraction_ / candidate_rate;
+
+        for (int i = 0; i < options.hot_pixels; ++i) {
+            hot_.push_back({static_cast<uint16_t>(x_dist_(rng_)), static_cast<uint16_t>(y_dist_(rng_))});
+        }
+        for (int y = DOT_SPACING / 2; y < options.height; y += DOT_SPACING) {
+            for (int x = DOT_SPACING / 2; x < options.width; x += DOT_SPACING) {
+                dots_.push_back({static_cast<uint16_t>(x), static_cast<uint16_t>(y)});
+            }
+        }
+    }
+
+    /**
+     * Fill the next batch (reuses the vector's capacity)
+     * @param events Output batch
+     * @param count Events to generate
+     */
+    void next(std::vector<Metavision::EventCD>& events, size_t count) {
+        events.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            events[i] = next_event();
+        }
+    }
+
+    double time_us() const { return time_us_; }
+
+private:
+    struct Pixel {
+        uint16_t x;
+        uint16_t y;
+    };
+
+    Metavision::EventCD next_event() {
+        for (;;) {
+            time_us_ += -std::log(1.0 - unit_(rng_)) * mean_gap_us_;
+            const auto t = static_cast<Metavision::timestamp>(time_us_);
+            const short p = static_cast<short>(rng_() & 1u);
+
+            if (unit_(rng_) < hot_candidate_fraction_) {
+                const Pixel& hot = hot_[rng_() % hot_.size()];
+                return Metavision::EventCD(hot.x, hot.y, p, t);
+            }
+
+            if (options_.flicker_hz > 0.0) {
+                constexpr double TWO_PI = 6.283185307179586;
+                const double phase = TWO_PI * options_.flicker_hz * time_us_ * 1e-6;
+                const double keep = 1.0 - options_.flicker_depth * 0.5 * (1.0 + std::sin(phase));
+                if (unit_(rng_) >= keep) {
+                    continue;
+                }
+            }
+
+            const Pixel pixel = scene_pixel();
+            return Metavision::EventCD(pixel.x, pixel.y, p, t);
+        }
+    }
+
+    Pixel scene_pixel() {
+        switch (options_.distribution) {
+        case Distribution::Gaussian: {
+            std::normal_distribution<double> gx(options_.width / 2.0, options_.width / 8.0);
+            std::normal_distribution<double> gy(options_.height / 2.0, options_.height / 8.0);
+            const int x = std::clamp(static_cast<int>(gx(rng_)), 0, options_.width - 1);
+            const int y = std::clamp(static_cast<int>(gy(rng_)), 0, options_.height - 1);
+            return {static_cast<uint16_t>(x), static_cast<uint16_t>(y)};
+        }
+        case Distribution::Dots:
+            if (!dots_.empty() && unit_(rng_) < DOT_EVENT_FRACTION) {
+                const Pixel& dot = dots_[rng_() % dots_.size()];
+                std::uniform_int_distribution<int> offset(-DOT_RADIUS, DOT_RADIUS);
+                const int x = std::clamp(dot.x + offset(rng_), 0, options_.width - 1);
+                const int y = std::clamp(dot.y + offset(rng_), 0, options_.height - 1);
+                return {static_cast<uint16_t>(x), static_cast<uint16_t>(y)};
+            }
+            [[fallthrough]];
+        case Distribution::Uniform:
+        default:
+            return {static_cast<uint16_t>(x_dist_(rng_)), static_cast<uint16_t>(y_dist_(rng_))};
+        }
+    }
+
+    const Options& options_;
+    std::mt19937_64 rng_;
+    std::uniform_real_distribution<double> unit_{0.0, 1.0};
+    std::uniform_int_distribution<int> x_dist_;
+    std::uniform_int_distribution<int> y_dist_;
+    std::vector<Pixel> hot_;
+    std::vector<Pixel> dots_;
+    double hot_fraction_ = 0.0;
+    double hot_candidate_fraction_ = 0.0;
+    double mean_gap_us_ = 1.0;
+    double time_us_ = 0.0;
+};
+
+/**
+ * Test target for the noise analysis: the dot grid the "dots" scene fires on
+ */
+cv::Mat make_dot_target(const Options& options) {
+    cv::Mat target(options.height, options.width, CV_8UC1, cv::Scalar(0));
+    for (int y = DOT_SPACING / 2; y < options.height; y += DOT_SPACING) {
+        for (int x = DOT_SPACING / 2; x < options.width; x += DOT_SPACING) {
+            cv::circle(target, cv::Point(x, y), DOT_RADIUS, cv::Scalar(255), cv::FILLED);
+        }
+    }
+    return target;
+}
+
+// ============================================================================
+// Stage accounting
+// ============================================================================
+
+enum Stage {
+    Filter = 0,       // Software noise filter (in place, only with --noise-filter)
+    Accumulate,       // Frame builder, excluding the frame callback
+    Extract,          // Pool slot + fused bit extraction (or zero-copy wrap for native binary)
+    Publish,          // FrameBuffer::store_frame
+    Windows,          // OR into the coarse windows (only with --windows)
+    Activity,         // Row/column profile
+    Surface,          // Time-surface update (only with --time-surface)
+    Scattering,       // ScatteringAnalyzer::analyze_frame
+    Noise,            // NoiseAnalyzer::analyzeLiveFrame
+    Render,           // Time-surface render at display time (only with --time-surface)
+    STAGE_COUNT
+};
+
+constexpr const char* STAGE_NAMES[STAGE_COUNT] = {
+    "filter", "accumulate", "extract", "publish", "windows", "activity", "surface", "scattering", "noise", "render",
+};
+
+struct StageTotals {
+    int64_t ns = 0;
+    uint64_t allocations = 0;
+    uint64_t allocated_bytes = 0;
+    uint64_t calls = 0;
+};
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Adds elapsed time and allocations to a stage when it goes out of scope
+ */
+class StageTimer {
+public:
+    explicit StageTimer(StageTotals& totals)
+        : totals_(totals)
+        , start_ns_(now_ns())
+        , start_allocations_(core::AllocTracker::process_counts()) {}
+
+    ~StageTimer() {
+        totals_.ns += now_ns() - start_ns_;
+        const core::AllocCounts allocations = core::AllocTracker::process_counts();
+        totals_.allocations += allocations.count - start_allocations_.count;
+        totals_.allocated_bytes += allocations.bytes - start_allocations_.bytes;
+        ++totals_.calls;
+    }
+
+    // Non-copyable
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    StageTotals& totals_;
+    int64_t start_ns_;
+    core::AllocCounts start_allocations_;  // Process-wide, so the analyzers' pool threads count too
+};
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+struct Pipeline {
+    explicit Pipeline(const Options& options)
+        : bit_mask(static_cast<uint8_t>((1 << options.bit_1) | (1 << options.bit_2))) {}
+
+    std::array<StageTotals, STAGE_COUNT> stages{};
+    uint8_t bit_mask;
+    video::FramePool frame_pool{16};
+    video::FrameBuffer frame_buffer;
+    video::EventActivityProfile activity;
+    video::EventNoiseFilter filter;
+    video::TimeSurface surface;
+    video::WindowPyramid pyramid;
+    cv::Mat surface_frame;
+    ScatteringAnalyzer scattering;
+    NoiseAnalyzer noise;
+    uint32_t decay_us = 0;
+    uint64_t frames_built = 0;
+    uint64_t frames_analyzed = 0;
+    uint64_t frames_pool_dropped = 0;
+    uint64_t window_frames = 0;
+    Metavision::timestamp last_frame_ts = 0;
+    float last_scattering_percentage = 0.0f;
+
+    /**
+     * Frame builder callback: the process_camera_frame() stages
+     * @param packed Packed copy from the native accumulator (nullptr without --windows)
+     */
+    void on_frame(Metavision::timestamp ts, cv::Mat& frame, bool native_binary, const video::BinaryFrame* packed) {
+        if (frame.empty()) {
+            return;
+        }
+        ++frames_built;
+        last_frame_ts = ts;
+
+        video::FrameRef ref;
+        {
+            StageTimer timer(stages[Extract]);
+            if (native_binary) {
+                ref = video::FrameRef(frame);
+            } else {
+                ref = frame_pool.acquire(frame.size(), CV_8UC1);
+                if (ref.empty()) {
+                    ++frames_pool_dropped;
+                    return;
+                }
+                video::simd::extract_bit_mask(frame, video::FramePool::writable(ref), bit_mask);
+            }
+        }
+        {
+            StageTimer timer(stages[Publish]);
+            frame_buffer.store_frame(std::move(ref));
+        }
+        if (packed) {
+            StageTimer timer(stages[Windows]);
+            pyramid.push(ts, *packed);
+        }
+    }
+
+    /**
+     * Consumer side: analysis of the newest published frame
+     * @return false if no frame was pending
+     */
+    bool analyze_pending() {
+        auto frame_opt = frame_buffer.consume_frame();
+        if (!frame_opt || frame_opt->empty()) {
+            return false;
+        }
+        ++frames_analyzed;
+
+        video::ReadGuard guard(*frame_opt);
+        const cv::Mat& frame = guard.get();
+        {
+            StageTimer timer(stages[Scattering]);
+            if (!scattering.is_analyzing()) {
+                scattering.start_analysis(frame);  // First frame is the reference
+            } else {
+                scattering.analyze_frame(frame);
+                last_scattering_percentage = scattering.get_data().current_scattering_percentage;
+            }
+        }
+        {
+            StageTimer timer(stages[Noise]);
+            noise.analyzeLiveFrame(frame);
+        }
+        if (surface.is_enabled()) {
+            StageTimer timer(stages[Render]);
+            surface.render(surface_frame, decay_us);
+        }
+        return true;
+    }
+};
+
+void print_report(const Options& options, const Pipeline& pipeline, uint64_t events, int64_t wall_ns) {
+    const double wall_s = wall_ns * 1e-9;
+    const double frames = static_cast<double>(std::max<uint64_t>(pipeline.frames_built, 1));
+    const double analyzed = static_cast<double>(std::max<uint64_t>(pipeline.frames_analyzed, 1));
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "\nEvents:   " << events << " in " << std::setprecision(3) << wall_s << " s ("
+              << std::setprecision(1) << events / wall_s / 1e6 << " Mev/s, "
+              << std::setprecision(2) << options.duration_s / wall_s << "x real time)\n"
+              << std::setprecision(1)
+              << "Frames:   " << pipeline.frames_built << " built (" << pipeline.frames_built / wall_s << " fps), "
+              << pipeline.frames_analyzed << " analyzed, " << pipeline.frames_pool_dropped << " dropped (pool)\n"
+              << "Scatter:  " << std::setprecision(2) << pipeline.last_scattering_percentage
+              << " % of reference pixels in the last frame\n";
+    if (pipeline.filter.is_enabled()) {
+        const uint64_t input = std::max<uint64_t>(pipeline.filter.get_input_events(), 1);
+        std::cout << "Filter:   " << std::setprecision(1)
+                  << 100.0 * pipeline.filter.get_passed_events() / input << " % of events kept ("
+                  << video::EventNoiseFilter::path_name(pipeline.filter.get_path()) << ", "
+                  << pipeline.filter.get_threshold_us() << " us)\n";
+    }
+    if (pipeline.pyramid.levels() > 0) {
+        std::cout << "Windows:  " << pipeline.window_frames << " coarse frames (";
+        for (int i = 0; i < pipeline.pyramid.levels(); ++i) {
+            std::cout << (i > 0 ? ", " : "") << pipeline.pyramid.window_us(i) << " us";
+        }
+        std::cout << ")\n";
+    }
+    std::cout << "\n";
+
+    std::cout << std::left << std::setw(12) << "Stage"
+              << std::right << std::setw(14) << "ns/frame"
+              << std::setw(12) << "ns/event"
+              << std::setw(14) << "allocs/frame"
+              << std::setw(14) << "bytes/frame"
+              << std::setw(10) << "share" << "\n";
+
+    int64_t total_ns = 0;
+    for (const auto& stage : pipeline.stages) {
+        total_ns += stage.ns;
+    }
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        const StageTotals& stage = pipeline.stages[s];
+        // Analysis stages run once per consumed frame, the rest once per built frame
+        const double per = (s == Scattering || s == Noise || s == Render) ? analyzed : frames;
+        std::cout << std::left << std::setw(12) << STAGE_NAMES[s] << std::right
+                  << std::setprecision(0) << std::setw(14) << stage.ns / per
+                  << std::setprecision(2) << std::setw(12) << static_cast<double>(stage.ns) / std::max<uint64_t>(events, 1)
+                  << std::setw(14) << stage.allocations / per
+                  << std::setprecision(0) << std::setw(14) << stage.allocated_bytes / per
+                  << std::setprecision(1) << std::setw(9) << (total_ns > 0 ? 100.0 * stage.ns / total_ns : 0.0) << "%\n";
+    }
+}
+
+/**
+ * One configured pipeline: event source, frame builder and the stages around it
+ */
+struct Bench {
+    explicit Bench(const Options& bench_options)
+        : options(bench_options)
+        , source(options)
+        , pipeline(options) {
+        pipeline.activity.configure(options.width, options.height, options.accumulation_us);
+        pipeline.filter.configure(options.width, options.height, options.filter_path);
+        pipeline.filter.set_threshold_us(options.noise_filter_us);
+        pipeline.filter.set_enabled(options.noise_filter_us > 0);
+        pipeline.surface.configure(options.width, options.height);
+        pipeline.surface.set_enabled(options.time_surface_decay_us > 0);
+        pipeline.decay_us = options.time_surface_decay_us;
+        if (options.threads > 0) {
+            pool = std::make_unique<video::ThreadPool>(options.threads - 1);
+            pipeline.scattering.set_thread_pool(pool.get());
+            pipeline.noise.setThreadPool(pool.get());
+        }
+
+        // Dot geometry comes from the target, as if detected on a saved capture
+        pipeline.noise.setImage(make_dot_target(options));
+        pipeline.noise.processCurrentImage();
+
+        if (options.native_binary) {
+            binary_accumulator = std::make_unique<video::BinaryFrameAccumulator>(
+                options.width, options.height, options.accumulation_us);
+            binary_accumulator->set_binary_bits(options.bit_1, options.bit_2);
+            binary_accumulator->set_polarity_planes(options.polarity_planes);
+            binary_accumulator->set_parallel_threads(options.threads);
+            if (options.slice_events > 0) {
+                using SliceMode = video::BinaryFrameAccumulator::SliceMode;
+                binary_accumulator->set_slicing(options.slice_or_time ? SliceMode::EventsOrTime : SliceMode::Events,
+                                                options.slice_events);
+            }
+            // Coarse windows need the time grid, so they are skipped with event-count slicing
+            const bool windows = options.slice_events == 0 &&
+                                 pipeline.pyramid.configure(options.accumulation_us, options.windows_us) > 0;
+            binary_accumulator->set_packed_output(windows);
+            pipeline.pyramid.set_output_callback([this](int, Metavision::timestamp, const video::BinaryFrame&) {
+                ++pipeline.window_frames;
+            });
+            video::BinaryFrameAccumulator* accumulator = binary_accumulator.get();
+            binary_accumulator->set_output_callback([this, accumulator, windows](Metavision::timestamp ts, cv::Mat& frame) {
+                pipeline.on_frame(ts, frame, true, windows ? &accumulator->packed_frame() : nullptr);
+            });
+        } else {
+            frame_generator = std::make_unique<Metavision::PeriodicFrameGenerationAlgorithm>(
+                options.width, options.height, options.accumulation_us);
+            frame_generator->set_output_callback([this](Metavision::timestamp ts, cv::Mat& frame) {
+                pipeline.on_frame(ts, frame, false, nullptr);
+            });
+        }
+        batch.reserve(options.batch);
+    }
+
+    // Non-copyable, non-movable (the frame callbacks hold this)
+    Bench(const Bench&) = delete;
+    Bench& operator=(const Bench&) = delete;
+
+    /**
+     * Generate the next batch (not timed)
+     * @return Events in the batch
+     */
+    size_t next_batch() {
+        source.next(batch, options.batch);
+        return batch.size();
+    }
+
+    /**
+     * Accumulation-thread stages on the current batch: filter, frame builder
+     * (with its frame callbacks), activity profile and time surface
+     */
+    void process_batch() {
+        const Metavision::EventCD* begin = batch.data();
+        const Metavision::EventCD* end = begin + batch.size();
+
+        if (pipeline.filter.is_enabled()) {
+            StageTimer timer(pipeline.stages[Filter]);
+            end = begin + pipeline.filter.filter(begin, end, batch.data());
+        }
+
+        // Frame callbacks run inside process_events(); take them back out of the builder's share
+        const StageTotals callbacks_before[] = {pipeline.stages[Extract], pipeline.stages[Publish],
+                                                pipeline.stages[Windows]};
+        {
+            StageTimer timer(pipeline.stages[Accumulate]);
+            if (binary_accumulator) {
+                binary_accumulator->process_events(begin, end);
+            } else {
+                frame_generator->process_events(begin, end);
+            }
+        }
+        for (int i = 0; i < 3; ++i) {
+            const StageTotals& after = pipeline.stages[Extract + i];
+            pipeline.stages[Accumulate].ns -= after.ns - callbacks_before[i].ns;
+            pipeline.stages[Accumulate].allocations -= after.allocations - callbacks_before[i].allocations;
+            pipeline.stages[Accumulate].allocated_bytes -= after.allocated_bytes - callbacks_before[i].allocated_bytes;
+        }
+
+        {
+            StageTimer timer(pipeline.stages[Activity]);
+            pipeline.activity.process(begin, end);
+        }
+        if (pipeline.surface.is_enabled()) {
+            StageTimer timer(pipeline.stages[Surface]);
+            pipeline.surface.update(begin, end);
+        }
+    }
+
+    Options options;  // First: the source keeps a reference to it
+    SyntheticEventSource source;
+    std::unique_ptr<video::ThreadPool> pool;  // Before the pipeline, which uses it until destroyed
+    Pipeline pipeline;
+    std::unique_ptr<Metavision::PeriodicFrameGenerationAlgorithm> frame_generator;
+    std::unique_ptr<video::BinaryFrameAccumulator> binary_accumulator;
+    std::vector<Metavision::EventCD> batch;
+};
+
+void print_header(const Options& options, const char* title) {
+    const char* distribution_names[] = {"uniform", "gaussian", "dots"};
+    std::cout << title << ": " << options.width << "x" << options.height << ", ";
+    if (options.ramp_start_mev > 0.0) {
+        std::cout << options.ramp_start_mev << "-" << options.ramp_max_mev << " Mev/s (x" << options.ramp_factor << ")";
+    } else {
+        std::cout << options.rate_mev << " Mev/s";
+    }
+    std::cout << " " << distribution_names[static_cast<int>(options.distribution)]
+              << ", " << options.hot_pixels << " hot pixels";
+    if (options.flicker_hz > 0.0) {
+        std::cout << ", " << options.flicker_hz << " Hz flicker";
+    }
+    std::cout << ", " << options.accumulation_us << " us windows, "
+              << (options.polarity_planes ? "native binary accumulator with polarity planes"
+                  : options.native_binary ? "native binary accumulator" : "SDK frame generator")
+              << (options.slice_events > 0 ? " sliced every " + std::to_string(options.slice_events) + " events"
+                  + (options.slice_or_time ? " or window" : "") : std::string())
+              << (options.threads > 0 ? ", " + std::to_string(options.threads) + " threads" : std::string())
+              << ", " << options.duration_s << " s sensor time" << (options.ramp_start_mev > 0.0 ? " per step" : "")
+              << std::endl;
+}
+
+/**
+ * Run the whole duration, analyzing the newest frame after every batch
+ * @param events Output, events generated
+ * @param wall_ns Output, time spent in the stages (generation excluded)
+ */
+void drive(Bench& bench, uint64_t& events, int64_t& wall_ns) {
+    const double end_us = bench.options.duration_s * 1e6;
+    events = 0;
+    wall_ns = 0;
+    while (bench.source.time_us() < end_us) {
+        events += bench.next_batch();  // Not timed
+        const int64_t batch_start_ns = now_ns();
+        bench.process_batch();
+        bench.pipeline.analyze_pending();
+        wall_ns += now_ns() - batch_start_ns;
+    }
+}
+
+int run(const Options& options) {
+    Bench bench(options);
+    print_header(options, "Pipeline benchmark");
+
+    uint64_t events = 0;
+    int64_t wall_ns = 0;
+    drive(bench, events, wall_ns);
+
+    print_report(options, bench.pipeline, events, wall_ns);
+    return bench.pipeline.frames_built > 0 ? 0 : 1;
+}
+
+// ============================================================================
+// Rate ramp
+// ============================================================================
+
+enum class Saturation { None, Accumulation, Analysis };
+
+constexpr const char* SATURATION_NAMES[] = {"none", "accumulation", "analysis"};
+
+// Stages on the accumulation thread; the rest run on the analysis thread
+constexpr bool on_accumulation_thread(int stage) {
+    return stage != Scattering && stage != Noise && stage != Render;
+}
+
+struct RampStep {
+    double rate_mev = 0.0;
+    uint64_t events = 0;
+    uint64_t events_dropped = 0;        // Batches that found the event ring full
+    int ring_peak = 0;                  // Most batches waiting for the accumulation thread
+    uint64_t frames = 0;
+    uint64_t frames_dropped = 0;        // Replaced in the latest-only buffer before analysis
+    double latency_p50_us = 0.0;        // Frame end (sensor time) to analysis done
+    double latency_p95_us = 0.0;
+    double latency_p99_us = 0.0;
+    double accumulation_busy = 0.0;     // Fraction of sensor time the thread was busy
+    double analysis_busy = 0.0;
+    std::array<double, STAGE_COUNT> stage_cpu{};  // Fraction of one core per stage
+    Saturation saturated = Saturation::None;
+};
+
+/**
+ * Frames in front of the analysis thread: FrameBuffer keeps only the newest
+ */
+struct AnalysisQueue {
+    struct Frame {
+        double ready_us;    // Published (accumulation thread done with its batch)
+        double sensor_us;   // Frame timestamp
+        double service_us;  // Measured analysis time
+    };
+
+    double free_us = 0.0;
+    bool has_pending = false;
+    Frame pending{};
+    uint64_t dropped = 0;
+    double busy_us = 0.0;
+    std::vector<double> latencies_us;
+
+    void publish(const Frame& frame) {
+        if (has_pending) {
+            if (std::max(pending.ready_us, free_us) <= frame.ready_us) {
+                analyze(pending);
+            } else {
+                ++dropped;  // Still waiting when the newer frame replaced it
+            }
+        }
+        pending = frame;
+        has_pending = true;
+    }
+
+    void finish() {
+        if (has_pending) {
+            analyze(pending);
+            has_pending = false;
+        }
+    }
+
+private:
+    void analyze(const Frame& frame) {
+        free_us = std::max(frame.ready_us, free_us) + frame.service_us;
+        busy_us += frame.service_us;
+        latencies_us.push_back(free_us - frame.sensor_us);
+    }
+};
+
+double percentile(std::vector<double>& values, double fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(values.size() * fraction));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+/**
+ * Run one ramp step: the stages are measured batch by batch, then replayed
+ * against the sensor clock with the app's queues in front of each thread
+ */
+RampStep run_step(const Options& options, double rate_mev) {
+    Options step_options = options;
+    step_options.rate_mev = rate_mev;
+    // About half a millisecond of events per batch, so queueing resolves below a frame
+    step_options.batch = std::min(options.batch, static_cast<size_t>(std::max(rate_mev * 500.0, 1.0)));
+    auto bench = std::make_unique<Bench>(step_options);
+    Pipeline& pipeline = bench->pipeline;
+
+    RampStep step;
+    step.rate_mev = rate_mev;
+    const double end_us = options.duration_s * 1e6;
+    std::deque<double> ring;            // Start times of the batches still waiting
+    double accumulation_free_us = 0.0;
+    AnalysisQueue analysis;
+    auto stage_ns = [&pipeline](bool accumulation) {
+        int64_t ns = 0;
+        for (int s = 0; s < STAGE_COUNT; ++s) {
+            if (on_accumulation_thread(s) == accumulation) {
+                ns += pipeline.stages[s].ns;
+            }
+        }
+        return ns;
+    };
+
+    while (bench->source.time_us() < end_us) {
+        const size_t count = bench->next_batch();  // Not timed
+        const double arrival_us = bench->source.time_us();
+        step.events += count;
+
+        const uint64_t frames_before = pipeline.frames_built;
+        const int64_t accumulation_before = stage_ns(true);
+        bench->process_batch();
+        const double accumulation_us = (stage_ns(true) - accumulation_before) * 1e-3;
+        const uint64_t built = pipeline.frames_built - frames_before;
+
+        const int64_t analysis_before = stage_ns(false);
+        const bool analyzed = pipeline.analyze_pending();
+        const double analysis_us = (stage_ns(false) - analysis_before) * 1e-3;
+
+        // Accumulation thread: the batch waits in the ring behind earlier ones
+        while (!ring.empty() && ring.front() <= arrival_us) {
+            ring.pop_front();
+        }
+        if (static_cast<int>(ring.size()) >= options.ring_batches) {
+            step.events_dropped += count;
+            continue;  // Measured, but the app would never have seen it
+        }
+        const double start_us = std::max(arrival_us, accumulation_free_us);
+        if (start_us > arrival_us) {
+            ring.push_back(start_us);
+        }
+        step.ring_peak = std::max(step.ring_peak, static_cast<int>(ring.size()));
+        accumulation_free_us = start_us + accumulation_us;
+
+        // Frames built within one batch replace each other before the analysis thread can look
+        step.frames += built;
+        if (built > 1) {
+            step.frames_dropped += built - 1;
+        }
+        if (analyzed) {
+            analysis.publish({accumulation_free_us, static_cast<double>(pipeline.last_frame_ts), analysis_us});
+        }
+    }
+    analysis.finish();
+
+    const double sensor_us = std::max(end_us, 1.0);
+    step.frames_dropped += analysis.dropped;
+    step.latency_p50_us = percentile(analysis.latencies_us, 0.50);
+    step.latency_p95_us = percentile(analysis.latencies_us, 0.95);
+    step.latency_p99_us = percentile(analysis.latencies_us, 0.99);
+    step.accumulation_busy = stage_ns(true) * 1e-3 / sensor_us;
+    step.analysis_busy = analysis.busy_us / sensor_us;
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        step.stage_cpu[s] = pipeline.stages[s].ns * 1e-3 / sensor_us;
+    }
+
+    // The ERC controller steps in at half a ring; dropped events are past saving
+    if (step.events_dropped > 0 || step.ring_peak * 2 >= options.ring_batches) {
+        step.saturated = Saturation::Accumulation;
+    } else if (step.analysis_busy >= 0.95 ||
+               step.frames_dropped * 100 > std::max<uint64_t>(step.frames, 1)) {
+        step.saturated = Saturation::Analysis;
+    }
+    return step;
+}
+
+void write_ramp_csv(const std::string& path, const std::vector<RampStep>& steps) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return;
+    }
+    file << "rate_mev,events,events_dropped,ring_peak,frames,frames_dropped,latency_p50_us,latency_p95_us,"
+            "latency_p99_us,accumulation_busy_pct,analysis_busy_pct";
+    for (const char* name : STAGE_NAMES) {
+        file << "," << name << "_cpu_pct";
+    }
+    file << ",saturated\n";
+    for (const RampStep& step : steps) {
+        file << step.rate_mev << "," << step.events << "," << step.events_dropped << "," << step.ring_peak << ","
+             << step.frames << "," << step.frames_dropped << "," << step.latency_p50_us << ","
+             << step.latency_p95_us << "," << step.latency_p99_us << "," << 100.0 * step.accumulation_busy << ","
+             << 100.0 * step.analysis_busy;
+        for (double cpu : step.stage_cpu) {
+            file << "," << 100.0 * cpu;
+        }
+        file << "," << SATURATION_NAMES[static_cast<int>(step.saturated)] << "\n";
+    }
+}
+
+int run_ramp(const Options& options) {
+    print_header(options, "Pipeline rate ramp");
+    std::cout << "Event ring of " << options.ring_batches << " batches, saturated at half fill or any drop\n\n"
+              << std::right << std::setw(9) << "Mev/s" << std::setw(10) << "ring"
+              << std::setw(10) << "ev drop" << std::setw(10) << "fr drop"
+              << std::setw(10) << "p50 ms" << std::setw(10) << "p95 ms" << std::setw(10) << "p99 ms"
+              << std::setw(10) << "accum" << std::setw(10) << "analysis" << "\n";
+
+    std::vector<RampStep> steps;
+    for (double rate = options.ramp_start_mev; rate <= options.ramp_max_mev * 1.0001; rate *= options.ramp_factor) {
+        steps.push_back(run_step(options, rate));
+        const RampStep& step = steps.back();
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(9) << step.rate_mev << std::setw(10) << step.ring_peak
+                  << std::setw(9) << 100.0 * step.events_dropped / std::max<uint64_t>(step.events, 1) << "%"
+                  << std::setw(9) << 100.0 * step.frames_dropped / std::max<uint64_t>(step.frames, 1) << "%"
+                  << std::setprecision(2)
+                  << std::setw(10) << step.latency_p50_us * 1e-3 << std::setw(10) << step.latency_p95_us * 1e-3
+                  << std::setw(10) << step.latency_p99_us * 1e-3 << std::setprecision(0)
+                  << std::setw(9) << 100.0 * step.accumulation_busy << "%"
+                  << std::setw(9) << 100.0 * step.analysis_busy << "%" << std::endl;
+        if (step.saturated != Saturation::None) {
+            break;
+        }
+    }
+    if (!options.report_path.empty()) {
+        write_ramp_csv(options.report_path, steps);
+    }
+
+    const RampStep& last = steps.back();
+    std::cout << "\n";
+    if (last.saturated == Saturation::None) {
+        std::cout << "No saturation up to " << std::setprecision(1) << last.rate_mev << " Mev/s\n";
+    } else {
+        // The busiest stage of the saturated thread is the one to work on
+        const bool accumulation = last.saturated == Saturation::Accumulation;
+        int bottleneck = -1;
+        for (int s = 0; s < STAGE_COUNT; ++s) {
+            if (on_accumulation_thread(s) == accumulation &&
+                (bottleneck < 0 || last.stage_cpu[s] > last.stage_cpu[bottleneck])) {
+                bottleneck = s;
+            }
+        }
+        std::cout << "Saturated at " << std::setprecision(1) << last.rate_mev << " Mev/s: "
+                  << SATURATION_NAMES[static_cast<int>(last.saturated)] << " thread, bottleneck stage '"
+                  << STAGE_NAMES[bottleneck] << "' (" << std::setprecision(0) << 100.0 * last.stage_cpu[bottleneck]
+                  << "% of a core)\n";
+        if (steps.size() > 1) {
+            std::cout << "Sustained: " << std::setprecision(1) << steps[steps.size() - 2].rate_mev << " Mev/s\n";
+        } else {
+            std::cout << "Already saturated at the start rate\n";
+        }
+    }
+
+    std::cout << "\nCPU per stage at the last step (% of one core):\n";
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        if (last.stage_cpu[s] <= 0.0) {
+            continue;
+        }
+        std::cout << "  " << std::left << std::setw(12) << STAGE_NAMES[s] << std::right << std::setprecision(1)
+                  << std::setw(7) << 100.0 * last.stage_cpu[s] << "%  ("
+                  << (on_accumulation_thread(s) ? "accumulation" : "analysis") << ")\n";
+    }
+    return steps.front().frames > 0 ? 0 : 1;
+}
+
+// ============================================================================
+// Scaling matrix
+// ============================================================================
+
+// Stages that split their work over the threads
+constexpr Stage PARALLEL_STAGES[] = {Accumulate, Scattering, Noise};
+constexpr double MIN_EFFICIENCY = 0.5;   // Below this, more threads are not worth it
+
+struct MatrixCell {
+    cv::Size size;
+    double rate_mev = 0.0;
+    int threads = 0;
+    std::array<int64_t, STAGE_COUNT> stage_ns{};
+    double accumulation_load = 0.0;     // Busy fraction of sensor time, accumulation thread
+    double analysis_load = 0.0;         // ... and analysis thread
+    uint64_t frames_analyzed = 0;
+};
+
+MatrixCell run_cell(const Options& options, cv::Size size, double rate_mev, int threads) {
+    Options cell_options = options;
+    cell_options.width = size.width;
+    cell_options.height = size.height;
+    cell_options.rate_mev = rate_mev;
+    cell_options.threads = threads;
+    auto bench = std::make_unique<Bench>(cell_options);
+
+    uint64_t events = 0;
+    int64_t wall_ns = 0;
+    drive(*bench, events, wall_ns);
+
+    MatrixCell cell;
+    cell.size = size;
+    cell.rate_mev = rate_mev;
+    cell.threads = threads;
+    cell.frames_analyzed = bench->pipeline.frames_analyzed;
+    const double sensor_ns = std::max(options.duration_s * 1e9, 1.0);
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        cell.stage_ns[s] = bench->pipeline.stages[s].ns;
+        (on_accumulation_thread(s) ? cell.accumulation_load : cell.analysis_load) += cell.stage_ns[s] / sensor_ns;
+    }
+    return cell;
+}
+
+double speedup(const MatrixCell& base, const MatrixCell& cell, Stage stage) {
+    return cell.stage_ns[stage] > 0 ? static_cast<double>(base.stage_ns[stage]) / cell.stage_ns[stage] : 0.0;
+}
+
+void write_matrix_csv(const std::string& path, const std::vector<MatrixCell>& cells) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return;
+    }
+    file << "width,height,rate_mev,threads,accumulation_load_pct,analysis_load_pct";
+    for (Stage stage : PARALLEL_STAGES) {
+        file << "," << STAGE_NAMES[stage] << "_ms," << STAGE_NAMES[stage] << "_speedup,"
+             << STAGE_NAMES[stage] << "_efficiency_pct";
+    }
+    file << "\n";
+
+    // Speedups are against the first thread count of the same size and rate
+    const MatrixCell* base = nullptr;
+    for (const MatrixCell& cell : cells) {
+        if (!base || base->size != cell.size || base->rate_mev != cell.rate_mev) {
+            base = &cell;
+        }
+        file << cell.size.width << "," << cell.size.height << "," << cell.rate_mev << "," << cell.threads << ","
+             << 100.0 * cell.accumulation_load << "," << 100.0 * cell.analysis_load;
+        for (Stage stage : PARALLEL_STAGES) {
+            const double gain = speedup(*base, cell, stage);
+            file << "," << cell.stage_ns[stage] * 1e-6 << "," << gain << ","
+                 << 100.0 * gain * base->threads / cell.threads;
+        }
+        file << "\n";
+    }
+}
+
+int run_matrix(const Options& options) {
+    std::cout << "Pipeline scaling matrix: " << options.matrix_sizes.size() << " sizes x "
+              << options.matrix_rates.size() << " rates x " << options.matrix_threads.size() << " thread counts, "
+              << options.accumulation_us << " us windows, native binary accumulator, " << options.duration_s
+              << " s sensor time per cell" << std::endl;
+
+    std::vector<MatrixCell> cells;
+    for (const cv::Size& size : options.matrix_sizes) {
+        for (double rate : options.matrix_rates) {
+            std::cout << "\n" << size.width << "x" << size.height << ", " << std::setprecision(1) << std::fixed
+                      << rate << " Mev/s\n"
+                      << std::right << std::setw(9) << "threads";
+            for (Stage stage : PARALLEL_STAGES) {
+                std::cout << std::setw(22) << STAGE_NAMES[stage];
+            }
+            std::cout << std::setw(10) << "accum" << std::setw(10) << "analysis" << "\n";
+
+            const size_t first = cells.size();
+            for (int threads : options.matrix_threads) {
+                cells.push_back(run_cell(options, size, rate, threads));
+                const MatrixCell& base = cells[first];
+                const MatrixCell& cell = cells.back();
+                std::cout << std::setw(9) << threads;
+                for (Stage stage : PARALLEL_STAGES) {
+                    const double gain = speedup(base, cell, stage);
+                    std::cout << std::setprecision(1) << std::setw(9) << cell.stage_ns[stage] * 1e-6 << " ms"
+                              << std::setprecision(2) << std::setw(6) << gain << "x"
+                              << std::setprecision(0) << std::setw(3) << 100.0 * gain * base.threads / threads << "%";
+                }
+                std::cout << std::setw(9) << 100.0 * cell.accumulation_load << "%"
+                          << std::setw(9) << 100.0 * cell.analysis_load << "%" << std::endl;
+            }
+
+            // Each stage scales up to the last thread count still above the efficiency floor
+            const MatrixCell& base = cells[first];
+            std::cout << "  scales to:";
+            for (Stage stage : PARALLEL_STAGES) {
+                int scales_to = base.threads;
+                for (size_t c = first; c < cells.size(); ++c) {
+                    if (speedup(base, cells[c], stage) * base.threads / cells[c].threads >= MIN_EFFICIENCY) {
+                        scales_to = cells[c].threads;
+                    }
+                }
+                std::cout << " " << STAGE_NAMES[stage] << " " << scales_to;
+            }
+            std::cout << " threads (efficiency >= " << std::setprecision(0) << 100.0 * MIN_EFFICIENCY << "%)\n";
+
+            // Real time needs both threads below one core's worth of sensor time
+            int fits_at = 0;
+            for (size_t c = first; c < cells.size() && fits_at == 0; ++c) {
+                if (cells[c].accumulation_load < 1.0 && cells[c].analysis_load < 1.0) {
+                    fits_at = cells[c].threads;
+                }
+            }
+            if (fits_at > 0) {
+                std::cout << "  real time from " << fits_at << " threads\n";
+            } else {
+                const MatrixCell& last = cells.back();
+                std::cout << "  NOT real time at " << last.threads << " threads ("
+                          << (last.accumulation_load >= 1.0 ? "accumulation" : "analysis") << " thread at "
+                          << 100.0 * std::max(last.accumulation_load, last.analysis_load) << "%)\n";
+            }
+        }
+    }
+
+    if (!options.report_path.empty()) {
+        write_matrix_csv(options.report_path, cells);
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_args(argc, argv, options)) {
+        return 1;
+    }
+    core::AllocTracker::install_mat_allocator();
+    if (options.matrix) {
+        return run_matrix(options);
+    }
+    return options.ramp_start_mev > 0.0 ? run_ramp(options) : run(options);
+}
@@ -0,0 +1,527 @@
+/**
+ * Offline Re-accumulation Tool
+ *
+ * Rebuilds the frames of an event recording (.rtev) at any window, slicing
+ * mode and bit-plane selection, runs noise analysis and (optionally)
+ * scattering against a reference on every frame and writes one CSV row
+ * per frame.
+ *
+ * The time range is cut into spans that are whole multiples of the window
+ * and handed out to worker threads; each worker seeks to its span through
+ * the chunk index and owns its own BinaryFrameAccumulator, NoiseAnalyzer
+ * and ScatteringAnalyzer, so nothing is shared except the next-span
+ * counter. Time-sliced frames are aligned to multiples of the window, so
+ * they are the same frames a single pass would build. Event-count slices
+ * restart at every span boundary (the partial slice at the end of a span
+ * is dropped). Rows are written in time order regardless of which worker
+ * finished first.
+ *
+ * Every span also leaves an AnalysisShard (scattering counts, hot pixels,
+ * totals and noise moments of that span alone); the shards are merged in
+ * time order into a run summary, which matches a single pass. With
+ * --shard the merged state is saved, so a recording split by --begin-s /
+ * --end-s across machines (at multiples of the window) is reduced later
+ * with --merge.
+ *
+ * With --video the frames are also encoded, in time order, into a lossless
+ * video (VideoExporter): each span keeps its frames bit-packed until every
+ * earlier span has been handed to the encoder, and the worker finishing
+ * the next span in order feeds them, waiting while the encoder's queue is
+ * full.
+ *
+ * Usage:
+ *   reaccumulate <recording.rtev> --window-us <us> [--bits <b1>,<b2>] [--slice-mode <0-2>]
+ *                [--slice-events <n>] [--begin-s <s>] [--end-s <s>] [--reference <png>]
+ *                [--threshold <0-255>] [--min-area <px>] [--max-area <px>] [--no-noise]
+ *                [--threads <n>] [--output <csv>] [--shard <rtshard>]
+ *                [--video <mkv>]
+ *   reaccumulate --merge <a.rtshard> --merge <b.rtshard> ... [--output <csv>] [--shard <rtshard>]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "analysis_shard.h"
+#include "image_manager.h"
+#include "noise_analyzer.h"
+#include "scattering_analyzer.h"
+#include "video/binary_frame_accumulator.h"
+#include "video/event_archive.h"
+#include "video/video_exporter.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using SliceMode = video::BinaryFrameAccumulator::SliceMode;
+
+constexpr size_t BATCH_EVENTS = 4096;       // Events per process_events() call, like SDK batches
+constexpr int SPANS_PER_THREAD = 8;         // Smaller spans balance uneven event density
+constexpr int64_t MIN_SPAN_WINDOWS = 16;
+
+struct Options {
+    fs::path recording;
+    fs::path reference;
+    fs::path output;
+    fs::path shard;                 // Merged state to save (empty = none)
+    fs::path video;                 // Lossless video of the frames (empty = none)
+    std::vector<fs::path> merge;    // Shards to reduce instead of re-accumulating
+    uint32_t window_us = 0;
+    int bit_1 = 5;
+    int bit_2 = 6;
+    SliceMode slice_mode = SliceMode::Time;
+    uint32_t slice_events = 100000;
+    double begin_s = 0.0;           // Offsets from the first event
+    double end_s = -1.0;            // < 0 = end of recording
+    bool noise = true;
+    int threads = 0;                // 0 = all cores
+    DotDetectionParams detection;
+};
+
+/**
+ * One CSV row
+ */
+struct FrameRow {
+    int64_t end_timestamp = 0;
+    uint32_t window_us = 0;
+    uint64_t events = 0;
+    uint64_t on_events = 0;
+    int active_pixels = 0;
+    NoiseAnalysisResults noise;
+    bool scattering_valid = false;
+    int scattering_pixels = 0;
+    float scattering_percentage = 0.0f;
+};
+
+/**
+ * Time span [begin, end) of one unit of work
+ */
+struct Span {
+    int64_t begin = 0;
+    int64_t end = 0;
+    std::vector<FrameRow> rows;
+    AnalysisShard shard;
+    std::vector<video::BinaryFrame> frames;   // --video only: one per row until encoded
+};
+
+/**
+ * Hands finished spans to the video encoder in time order
+ */
+struct VideoSink {
+    video::VideoExporter exporter;
+    std::mutex mutex;
+    std::vector<bool> finished;
+    size_t next = 0;                // First span not yet encoded
+
+    /**
+     * Mark spans[index] finished and encode every span that is now next in order
+     */
+    void finish_span(std::vector<Span>& spans, size_t index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished[index] = true;
+        for (; next < spans.size() && finished[next]; ++next) {
+            Span& span = spans[next];
+            for (size_t i = 0; i < span.frames.size(); ++i) {
+                exporter.push(span.frames[i], span.rows[i].end_timestamp);   // Waits while the queue is full
+            }
+            std::vector<video::BinaryFrame>().swap(span.frames);
+        }
+    }
+};
+
+void print_usage() {
+    std::cout << "Usage: reaccumulate <recording.rtev> --window-us <us> [options]\n"
+              << "  --window-us <us>    Accumulation window (required)\n"
+              << "  --bits <b1>,<b2>    Palette bits mapped to white (default 5,6)\n"
+              << "  --slice-mode <m>    0 = every window, 1 = every --slice-events events,\n"
+              << "                      2 = whichever comes first (default 0)\n"
+              << "  --slice-events <n>  Events per frame for slice modes 1 and 2 (default 100000)\n"
+              << "  --begin-s <s>       Start this far into the recording\n"
+              << "  --end-s <s>         Stop this far into the recording (default: end)\n"
+              << "  --reference <png>   Reference image for scattering (binary, sensor size)\n"
+              << "  --threshold <v>     Dot detection threshold 0-255 (default 128)\n"
+              << "  --min-area <px>     Minimum dot area (default 50)\n"
+              << "  --max-area <px>     Maximum dot area (default 2000)\n"
+              << "  --no-noise          Skip noise analysis (frame counts and scattering only)\n"
+              << "  --threads <n>       Worker threads (default: all cores)\n"
+              << "  --output <csv>      Output file (default: <recording>_<window>us.csv); run totals\n"
+              << "                      go to <output>_summary.csv\n"
+              << "  --shard <rtshard>   Also save the merged analysis state\n"
+              << "  --video <mkv>       Also encode the frames into a lossless (FFV1) video, with\n"
+              << "                      sensor timestamps in <video>_timestamps.csv\n"
+              << "  --merge <rtshard>   Merge saved shards in the order given (repeat; no recording)\n";
+}
+
+bool parse_args(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--window-us" && has_value) {
+            options.window_us = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 0));
+        } else if (arg == "--bits" && has_value) {
+            const std::string bits = argv[++i];
+            const size_t comma = bits.find(',');
+            if (comma == std::string::npos) {
+                std::cerr << "--bits expects <b1>,<b2>" << std::endl;
+                return false;
+            }
+            options.bit_1 = std::clamp(std::atoi(bits.substr(0, comma).c_str()), 0, 7);
+            options.bit_2 = std::clamp(std::atoi(bits.substr(comma + 1).c_str()), 0, 7);
+        } else if (arg == "--slice-mode" && has_value) {
+            options.slice_mode = static_cast<SliceMode>(std::clamp(std::atoi(argv[++i]), 0, 2));
+        } else if (arg == "--slice-events" && has_value) {
+            options.slice_events = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 1));
+        } else if (arg == "--begin-s" && has_value) {
+            options.begin_s = std::atof(argv[++i]);
+        } else if (arg == "--end-s" && has_value) {
+            options.end_s = std::atof(argv[++i]);
+        } else if (arg == "--reference" && has_value) {
+            options.reference = argv[++i];
+        } else if (arg == "--threshold" && has_value) {
+            options.detection.threshold_value = std::atoi(argv[++i]);
+        } else if (arg == "--min-area" && has_value) {
+            options.detection.min_area = std::atoi(argv[++i]);
+        } else if (arg == "--max-area" && has_value) {
+            options.detection.max_area = std::atoi(argv[++i]);
+        } else if (arg == "--no-noise") {
+            options.noise = false;
+        } else if (arg == "--threads" && has_value) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--output" && has_value) {
+            options.output = argv[++i];
+        } else if (arg == "--shard" && has_value) {
+            options.shard = argv[++i];
+        } else if (arg == "--video" && has_value) {
+            options.video = argv[++i];
+        } else if (arg == "--merge" && has_value) {
+            options.merge.push_back(argv[++i]);
+        } else if (!arg.empty() && arg[0] != '-' && options.recording.empty()) {
+            options.recording = arg;
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (!options.merge.empty()) {
+        if (options.output.empty()) {
+            options.output = "merged.csv";
+        }
+        return options.recording.empty();
+    }
+    if (options.recording.empty() || options.window_us == 0) {
+        return false;
+    }
+    if (options.output.empty()) {
+        options.output = options.recording;
+        options.output.replace_filename(options.recording.stem().string() + "_" +
+                                        std::to_string(options.window_us) + "us.csv");
+    }
+    return true;
+}
+
+/**
+ * Cut [begin, end) into spans of whole windows
+ */
+std::vector<Span> make_spans(int64_t begin, int64_t end, uint32_t window_us, int threads) {
+    // Windows are aligned to multiples of their length, as in the live accumulator
+    begin = begin / window_us * window_us;
+    const int64_t windows = (end - begin + window_us - 1) / window_us;
+    const int64_t per_span = std::max<int64_t>(MIN_SPAN_WINDOWS,
+                                               (windows + threads * SPANS_PER_THREAD - 1) / (threads * SPANS_PER_THREAD));
+
+    std::vector<Span> spans;
+    for (int64_t t = begin; t < end; t += per_span * window_us) {
+        Span span;
+        span.begin = t;
+        span.end = std::min<int64_t>(t + per_span * window_us, begin + windows * window_us);
+        spans.push_back(std::move(span));
+    }
+    return spans;
+}
+
+/**
+ * Rebuild and analyze spans[i] for every i handed out by next_index
+ */
+void worker(const video::EventArchive& archive, const Options& options, const ImageManager::BinaryHandle& reference,
+            std::vector<Span>& spans, std::atomic<size_t>& next_index, std::atomic<size_t>& done,
+            VideoSink* video_sink) {
+    // Per-worker accumulator and analyzers: no locking on the hot path
+    video::BinaryFrameAccumulator accumulator(archive.width(), archive.height(), options.window_us);
+    accumulator.set_binary_bits(options.bit_1, options.bit_2);
+    accumulator.set_slicing(options.slice_mode, options.slice_events);
+    NoiseAnalyzer noise_analyzer;
+    ScatteringAnalyzer scattering_analyzer;
+    noise_analyzer.setParallel(false);      // Already one span per core
+    scattering_analyzer.set_parallel(false);
+    const bool use_reference = reference && scattering_analyzer.start_analysis(reference);
+
+    Span* span = nullptr;
+    accumulator.set_output_callback([&](Metavision::timestamp ts, cv::Mat& frame) {
+        if (ts > span->end) {
+            return;   // Empty windows up to the event that closed the span
+        }
+        FrameRow row;
+        row.end_timestamp = ts;
+        row.window_us = accumulator.frame_window_us();
+        row.events = accumulator.frame_events();
+        row.on_events = accumulator.frame_on_events();
+        row.active_pixels = accumulator.frame_stats().active_pixels;
+        if (options.noise) {
+            noise_analyzer.setImage(frame);
+            row.noise = noise_analyzer.processCurrentImage(options.detection);
+            row.noise.detected_circles.reset();
+            span->shard.add_noise(row.noise);
+        }
+        if (use_reference && scattering_analyzer.analyze_frame(frame)) {
+            const auto& data = scattering_analyzer.get_data();
+            row.scattering_valid = true;
+            row.scattering_pixels = data.current_scattering_pixels;
+            row.scattering_percentage = data.current_scattering_percentage;
+        }
+        span->rows.push_back(std::move(row));
+        if (video_sink) {
+            span->frames.emplace_back().assign(frame);
+        }
+    });
+
+    video::EventArchive::Cursor cursor;
+    std::vector<Metavision::EventCD> batch;
+    batch.reserve(BATCH_EVENTS);
+    for (size_t i = next_index.fetch_add(1); i < spans.size(); i = next_index.fetch_add(1)) {
+        span = &spans[i];
+        accumulator.reset();
+        if (use_reference) {
+            scattering_analyzer.reset_temporal_data();   // Each span's shard covers that span only
+        }
+        archive.seek(span->begin, cursor);
+
+        // The first event at or past the end closes the span's last window
+        Metavision::EventCD ev;
+        while (archive.next(cursor, ev)) {
+            if (ev.t < span->begin) {
+                continue;
+            }
+            batch.push_back(ev);
+            if (ev.t >= span->end) {
+                break;
+            }
+            if (batch.size() == BATCH_EVENTS) {
+                accumulator.process_events(batch.data(), batch.data() + batch.size());
+                batch.clear();
+            }
+        }
+        accumulator.process_events(batch.data(), batch.data() + batch.size());
+        batch.clear();
+        if (use_reference) {
+            scattering_analyzer.export_shard(span->shard);
+        }
+        span->shard.begin_timestamp = span->begin;
+        span->shard.end_timestamp = span->end;
+        if (video_sink) {
+            video_sink->finish_span(spans, i);
+        }
+
+        const size_t finished = done.fetch_add(1) + 1;
+        if (finished % std::max<size_t>(spans.size() / 10, 1) == 0) {
+            std::cout << "  " << finished << " / " << spans.size() << " spans" << std::endl;
+        }
+    }
+}
+
+bool write_csv(const fs::path& path, const std::vector<Span>& spans, int64_t start_timestamp) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << "frame,end_timestamp_us,time_s,window_us,events,on_events,active_pixels,"
+            "num_dots,signal_mean,signal_std,noise_mean,noise_std,snr_db,contrast_ratio,"
+            "scattering_pixels,scattering_percentage\n";
+    file << std::fixed << std::setprecision(4);
+
+    size_t frame = 0;
+    for (const Span& span : spans) {
+        for (const FrameRow& r : span.rows) {
+            file << frame++ << ',' << r.end_timestamp << ',' << (r.end_timestamp - start_timestamp) / 1e6 << ','
+                 << r.window_us << ',' << r.events << ',' << r.on_events << ',' << r.active_pixels << ','
+                 << r.noise.num_dots_detected << ',' << r.noise.signal_mean << ',' << r.noise.signal_std << ','
+                 << r.noise.noise_mean << ',' << r.noise.noise_std << ',' << r.noise.snr_db << ','
+                 << r.noise.contrast_ratio << ',';
+            if (r.scattering_valid) {
+                file << r.scattering_pixels << ',' << r.scattering_percentage << '\n';
+            } else {
+                file << ",\n";
+            }
+        }
+    }
+    return file.good();
+}
+
+fs::path summary_path(const fs::path& output) {
+    fs::path path = output;
+    path.replace_filename(output.stem().string() + "_summary.csv");
+    return path;
+}
+
+/**
+ * Write the run summary and, if requested, the merged shard
+ */
+bool write_totals(const Options& options, const AnalysisShard& total) {
+    const fs::path summary = summary_path(options.output);
+    if (!total.export_summary_csv(summary.string())) {
+        std::cerr << "Failed to write " << summary << std::endl;
+        return false;
+    }
+    std::cout << "Summary written to " << summary << std::endl;
+    if (!options.shard.empty()) {
+        if (!total.save(options.shard.string())) {
+            std::cerr << "Failed to write " << options.shard << std::endl;
+            return false;
+        }
+        std::cout << "Shard written to " << options.shard << std::endl;
+    }
+    return true;
+}
+
+/**
+ * Reduce saved shards (e.g. from several machines) in the order given
+ */
+int merge_shards(const Options& options) {
+    AnalysisShard total;
+    for (const fs::path& path : options.merge) {
+        AnalysisShard shard;
+        if (!shard.load(path.string())) {
+            return 1;
+        }
+        if (!total.merge(shard)) {
+            std::cerr << path << " does not match the earlier shards (sensor size, regions or settings)" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Merged " << options.merge.size() << " shards: " << total.frames << " frames, "
+              << total.noise.snr_db.n << " noise results" << std::endl;
+    return write_totals(options, total) ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_args(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+    if (!options.merge.empty()) {
+        return merge_shards(options);
+    }
+
+    video::EventArchive archive;
+    if (!archive.open(options.recording.string())) {
+        return 1;
+    }
+    if (!archive.has_index()) {
+        std::cout << "No chunk index: every worker decodes from the start, expect little speed-up" << std::endl;
+    }
+
+    // Packed once and shared by every worker's analyzer
+    ImageManager::BinaryHandle reference;
+    if (!options.reference.empty()) {
+        reference = ImageManager::load_binary(options.reference.string());
+        if (!reference) {
+            std::cerr << "Failed to load reference image: " << options.reference << std::endl;
+            return 1;
+        }
+        if (reference->width() != archive.width() || reference->height() != archive.height()) {
+            std::cerr << "Reference is not " << archive.width() << "x" << archive.height() << std::endl;
+            return 1;
+        }
+    }
+
+    const int64_t begin = archive.start_timestamp() + static_cast<int64_t>(std::max(options.begin_s, 0.0) * 1e6);
+    const int64_t end = options.end_s < 0.0
+        ? archive.end_timestamp() + 1
+        : std::min(archive.end_timestamp() + 1, archive.start_timestamp() + static_cast<int64_t>(options.end_s * 1e6));
+    if (end <= begin) {
+        std::cerr << "Empty time range" << std::endl;
+        return 1;
+    }
+
+    int threads = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::max(threads, 1);
+    std::vector<Span> spans = make_spans(begin, end, options.window_us, threads);
+    threads = std::min(threads, static_cast<int>(spans.size()));
+
+    // Parallelism is across spans; OpenCV's own thread pool would only oversubscribe
+    cv::setNumThreads(1);
+
+    std::cout << "Re-accumulating " << (end - begin) / 1e6 << " s of " << options.recording.filename().string()
+              << " at " << options.window_us << " us (bits " << options.bit_1 << "," << options.bit_2
+              << ", slice mode " << static_cast<int>(options.slice_mode) << ") in " << spans.size()
+              << " spans on " << threads << " threads" << std::endl;
+
+    std::unique_ptr<VideoSink> video_sink;
+    if (!options.video.empty()) {
+        video_sink = std::make_unique<VideoSink>();
+        video_sink->finished.assign(spans.size(), false);
+        if (!video_sink->exporter.open(options.video.string(), cv::Size(archive.width(), archive.height()),
+                                       1e6 / options.window_us)) {
+            return 1;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<size_t> next_index{0};
+    std::atomic<size_t> done{0};
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back(worker, std::cref(archive), std::cref(options), std::cref(reference),
+                             std::ref(spans), std::ref(next_index), std::ref(done), video_sink.get());
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    const double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t frames = 0;
+    AnalysisShard total;
+    for (const Span& span : spans) {
+        frames += span.rows.size();
+        total.merge(span.shard);   // Same analyzer settings in every span
+    }
+
+    if (!write_csv(options.output, spans, archive.start_timestamp())) {
+        std::cerr << "Failed to write " << options.output << std::endl;
+        return 1;
+    }
+    if (!write_totals(options, total)) {
+        return 1;
+    }
+    if (video_sink) {
+        if (!video_sink->exporter.close()) {
+            return 1;
+        }
+        std::cout << "Video written to " << options.video << " (" << video_sink->exporter.get_codec() << ", "
+                  << video_sink->exporter.get_speed() << "x real time encoding)" << std::endl;
+    }
+
+    std::cout << "Done: " << frames << " frames in " << elapsed_s << " s ("
+              << (end - begin) / 1e6 / std::max(elapsed_s, 1e-9) << "x real time)" << std::endl;
+    std::cout << "Results written to " << options.output << std::endl;
+    return frames > 0 ? 0 : 1;
+}
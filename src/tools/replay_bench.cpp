@@ -0,0 +1,670 @@
+/**
+ * Replay Benchmark
+ *
+ * End-to-end performance regression suite: a fixed set of reference event
+ * recordings (.rtev) is replayed through the whole pipeline as fast as it
+ * goes - archive decode (ingestion), recording (EventRecorder push),
+ * the native frame builder (accumulation), pool slot copy and FrameBuffer
+ * publication (extraction), ScatteringAnalyzer and NoiseAnalyzer on the
+ * newest published frame - and every stage is timed per call.
+ *
+ * Results (events/s, ns/event, per-call p50/p95/p99, allocations per call,
+ * and frame latency from ingestion to analysis) go to a JSON file and are
+ * compared against the stored baseline of this machine profile. A stage
+ * that got slower or allocates more than the tolerance allows is flagged
+ * and the exit code is 2, so a pipeline change that undoes another's gains
+ * fails the run instead of going unnoticed.
+ *
+ * Baselines are results this tool wrote (--update-baseline), one file per
+ * profile: timings are only comparable on the same hardware. The default
+ * profile is the CPU brand and thread count. Each recording is replayed
+ * --repeat times and the fastest pass is kept, which takes most of the
+ * scheduling noise out of the comparison.
+ *
+ * Usage:
+ *   replay_bench <a.rtev> [<b.rtev> ...] | --suite <dir>
+ *                [--window-us <us>] [--bits <b1>,<b2>] [--repeat <n>] [--output <json>]
+ *                [--baselines <dir>] [--profile <name>] [--tolerance <percent>]
+ *                [--update-baseline] [--scratch <dir>]
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "core/alloc_tracker.h"
+#include "noise_analyzer.h"
+#include "scattering_analyzer.h"
+#include "video/binary_frame_accumulator.h"
+#include "video/event_archive.h"
+#include "video/event_recorder.h"
+#include "video/frame_buffer.h"
+#include "video/frame_pool.h"
+#include "video/simd_utils.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t BATCH_EVENTS = 4096;       // Events per process_events() call, like SDK batches
+
+// Floors below which a slowdown is measurement noise, whatever the percentage
+constexpr double MIN_NS_PER_EVENT_DELTA = 0.5;
+constexpr double MIN_LATENCY_DELTA_US = 2.0;
+constexpr double MIN_ALLOCS_DELTA = 0.5;
+
+// ============================================================================
+// Options
+// ============================================================================
+
+struct Options {
+    std::vector<fs::path> recordings;
+    fs::path output;                // Result JSON (default: replay_<profile>.json)
+    fs::path baselines = "bench_baselines";
+    fs::path scratch;               // Recording stage output (default: temp directory)
+    std::string profile;            // Machine profile (default: CPU brand and threads)
+    uint32_t window_us = 10000;
+    int bit_1 = 5;
+    int bit_2 = 6;
+    int repeat = 3;
+    double tolerance = 10.0;        // Percent
+    bool update_baseline = false;
+};
+
+void print_usage() {
+    std::cout << "Usage: replay_bench <a.rtev> [<b.rtev> ...] | --suite <dir> [options]\n"
+              << "  --suite <dir>         Replay every .rtev in a directory (name order)\n"
+              << "  --window-us <us>      Accumulation window (default 10000)\n"
+              << "  --bits <b1>,<b2>      Palette bits mapped to white (default 5,6)\n"
+              << "  --repeat <n>          Passes per recording, fastest kept (default 3)\n"
+              << "  --output <json>       Result file (default: replay_<profile>.json)\n"
+              << "  --baselines <dir>     Baseline directory (default: bench_baselines)\n"
+              << "  --profile <name>      Machine profile (default: CPU brand and thread count)\n"
+              << "  --tolerance <pct>     Allowed slowdown / allocation growth (default 10)\n"
+              << "  --update-baseline     Store this result as the profile's baseline\n"
+              << "  --scratch <dir>       Where the recording stage writes (default: temp directory)\n";
+}
+
+bool parse_args(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--suite" && has_value) {
+            std::error_code ec;
+            std::vector<fs::path> suite;
+            for (const auto& entry : fs::directory_iterator(argv[++i], ec)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".rtev") {
+                    suite.push_back(entry.path());
+                }
+            }
+            if (ec) {
+                std::cerr << "Cannot read suite directory " << argv[i] << std::endl;
+                return false;
+            }
+            std::sort(suite.begin(), suite.end());
+            options.recordings.insert(options.recordings.end(), suite.begin(), suite.end());
+        } else if (arg == "--window-us" && has_value) {
+            options.window_us = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 1));
+        } else if (arg == "--bits" && has_value) {
+            const std::string bits = argv[++i];
+            const size_t comma = bits.find(',');
+            if (comma == std::string::npos) {
+                std::cerr << "--bits expects <b1>,<b2>" << std::endl;
+                return false;
+            }
+            options.bit_1 = std::clamp(std::atoi(bits.substr(0, comma).c_str()), 0, 7);
+            options.bit_2 = std::clamp(std::atoi(bits.substr(comma + 1).c_str()), 0, 7);
+        } else if (arg == "--repeat" && has_value) {
+            options.repeat = std::max(std::atoi(argv[++i]), 1);
+        } else if (arg == "--output" && has_value) {
+            options.output = argv[++i];
+        } else if (arg == "--baselines" && has_value) {
+            options.baselines = argv[++i];
+        } else if (arg == "--profile" && has_value) {
+            options.profile = argv[++i];
+        } else if (arg == "--tolerance" && has_value) {
+            options.tolerance = std::max(std::atof(argv[++i]), 0.0);
+        } else if (arg == "--update-baseline") {
+            options.update_baseline = true;
+        } else if (arg == "--scratch" && has_value) {
+            options.scratch = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            return false;
+        } else if (!arg.empty() && arg[0] != '-') {
+            options.recordings.push_back(arg);
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    return !options.recordings.empty();
+}
+
+/**
+ * CPU brand and hardware threads, reduced to a file name ("cpu" where CPUID has no brand)
+ */
+std::string default_profile() {
+    std::string brand;
+    uint32_t regs[4];
+    if (video::simd::cpuid(0x80000000u, 0, regs) && regs[0] >= 0x80000004u) {
+        for (uint32_t leaf = 0x80000002u; leaf <= 0x80000004u; ++leaf) {
+            video::simd::cpuid(leaf, 0, regs);
+            brand.append(reinterpret_cast<const char*>(regs), sizeof(regs));
+        }
+    }
+    std::string profile;
+    for (char c : brand) {
+        const bool ok = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        if (ok) {
+            profile += c;
+        } else if (c != '\0' && !profile.empty() && profile.back() != '_') {
+            profile += '_';
+        }
+    }
+    while (!profile.empty() && profile.back() == '_') {
+        profile.pop_back();
+    }
+    if (profile.empty()) {
+        profile = "cpu";
+    }
+    return profile + "_" + std::to_string(std::max(std::thread::hardware_concurrency(), 1u)) + "t";
+}
+
+// ============================================================================
+// Stage accounting
+// ============================================================================
+
+enum Stage {
+    Ingest = 0,     // Archive decode into SDK-sized batches
+    Record,         // EventRecorder::push (the writer thread runs alongside)
+    Accumulate,     // Native frame builder, excluding the frame callback
+    Extract,        // Pool slot copy + FrameBuffer::store_frame
+    Scattering,     // ScatteringAnalyzer::analyze_frame
+    Noise,          // NoiseAnalyzer::analyzeLiveFrame
+    STAGE_COUNT
+};
+
+constexpr const char* STAGE_NAMES[STAGE_COUNT] = {
+    "ingest", "record", "accumulate", "extract", "scattering", "noise",
+};
+
+struct StageSamples {
+    int64_t ns = 0;
+    uint64_t allocations = 0;
+    std::vector<int64_t> call_ns;
+};
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Adds one call's time and allocations to a stage when it goes out of scope
+ */
+class StageTimer {
+public:
+    explicit StageTimer(StageSamples& samples)
+        : samples_(samples)
+        , start_ns_(now_ns())
+        , start_allocations_(core::AllocTracker::process_counts().count) {}
+
+    ~StageTimer() {
+        const int64_t elapsed = now_ns() - start_ns_;
+        samples_.ns += elapsed;
+        samples_.call_ns.push_back(elapsed);
+        samples_.allocations += core::AllocTracker::process_counts().count - start_allocations_;
+    }
+
+    // Non-copyable
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    StageSamples& samples_;
+    int64_t start_ns_;
+    uint64_t start_allocations_;
+};
+
+/**
+ * Figures of one stage as written to and read from the JSON files
+ */
+struct StageResult {
+    double ns_per_event = 0.0;
+    double p50_us = 0.0;
+    double p95_us = 0.0;
+    double p99_us = 0.0;
+    double allocs_per_call = 0.0;
+    uint64_t calls = 0;
+};
+
+struct RecordingResult {
+    std::string name;
+    uint64_t events = 0;
+    uint64_t frames = 0;
+    uint64_t frames_analyzed = 0;
+    double wall_s = 0.0;
+    double mev_per_s = 0.0;
+    double latency_p50_us = 0.0;        // Batch ingested -> its newest frame analyzed
+    double latency_p95_us = 0.0;
+    double latency_p99_us = 0.0;
+    uint64_t recorder_dropped_events = 0;
+    std::array<StageResult, STAGE_COUNT> stages{};
+};
+
+double percentile_us(std::vector<int64_t>& ns, double fraction) {
+    if (ns.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(ns.size() - 1, static_cast<size_t>(ns.size() * fraction));
+    std::nth_element(ns.begin(), ns.begin() + index, ns.end());
+    return ns[index] * 1e-3;
+}
+
+// ============================================================================
+// Replay
+// ============================================================================
+
+/**
+ * One pass over a recording through every stage
+ * @return false if the recording cannot be opened
+ */
+bool replay(const Options& options, const fs::path& path, const fs::path& scratch_file, RecordingResult& result) {
+    video::EventArchive archive;
+    if (!archive.open(path.string())) {
+        std::cerr << "Cannot open recording " << path << std::endl;
+        return false;
+    }
+
+    std::array<StageSamples, STAGE_COUNT> stages;
+    std::vector<int64_t> frame_latency_ns;
+    uint64_t frames = 0;
+    uint64_t analyzed = 0;
+
+    video::FramePool frame_pool{16};
+    video::FrameBuffer frame_buffer;
+    ScatteringAnalyzer scattering;
+    NoiseAnalyzer noise;
+    video::EventRecorder recorder;
+    recorder.start(scratch_file.string(), archive.width(), archive.height());
+
+    video::BinaryFrameAccumulator accumulator(archive.width(), archive.height(), options.window_us);
+    accumulator.set_binary_bits(options.bit_1, options.bit_2);
+    accumulator.set_output_callback([&](Metavision::timestamp, cv::Mat& frame) {
+        if (frame.empty()) {
+            return;
+        }
+        ++frames;
+        StageTimer timer(stages[Extract]);
+        video::FrameRef ref = frame_pool.acquire(frame.size(), frame.type());
+        if (ref.empty()) {
+            return;
+        }
+        frame.copyTo(video::FramePool::writable(ref));
+        frame_buffer.store_frame(std::move(ref));
+    });
+
+    video::EventArchive::Cursor cursor;
+    archive.seek(archive.start_timestamp(), cursor);
+    std::vector<Metavision::EventCD> batch;
+    batch.reserve(BATCH_EVENTS);
+    uint64_t events = 0;
+    const int64_t start_ns = now_ns();
+    bool more = true;
+    while (more) {
+        const int64_t batch_start_ns = now_ns();
+        batch.clear();
+        {
+            StageTimer timer(stages[Ingest]);
+            Metavision::EventCD ev;
+            while (batch.size() < BATCH_EVENTS && (more = archive.next(cursor, ev))) {
+                batch.push_back(ev);
+            }
+        }
+        if (batch.empty()) {
+            break;
+        }
+        events += batch.size();
+        const Metavision::EventCD* begin = batch.data();
+        const Metavision::EventCD* end = begin + batch.size();
+
+        {
+            StageTimer timer(stages[Record]);
+            recorder.push(begin, end);
+        }
+
+        // Frame callbacks run inside process_events(); take them back out of the builder's share
+        const int64_t extract_before = stages[Extract].ns;
+        const uint64_t extract_allocations_before = stages[Extract].allocations;
+        {
+            StageTimer timer(stages[Accumulate]);
+            accumulator.process_events(begin, end);
+        }
+        stages[Accumulate].ns -= stages[Extract].ns - extract_before;
+        stages[Accumulate].call_ns.back() -= stages[Extract].ns - extract_before;
+        stages[Accumulate].allocations -= stages[Extract].allocations - extract_allocations_before;
+
+        // Consumer side: only the newest frame is analyzed, as on the analysis thread
+        auto frame_opt = frame_buffer.consume_frame();
+        if (!frame_opt || frame_opt->empty()) {
+            continue;
+        }
+        video::ReadGuard guard(*frame_opt);
+        const cv::Mat& frame = guard.get();
+        if (!scattering.is_analyzing()) {
+            // First frame: scattering reference and dot geometry, outside the timings
+            scattering.start_analysis(frame);
+            noise.setImage(frame);
+            noise.processCurrentImage();
+            continue;
+        }
+        ++analyzed;
+        {
+            StageTimer timer(stages[Scattering]);
+            scattering.analyze_frame(frame);
+        }
+        {
+            StageTimer timer(stages[Noise]);
+            noise.analyzeLiveFrame(frame);
+        }
+        frame_latency_ns.push_back(now_ns() - batch_start_ns);
+    }
+    const int64_t wall_ns = now_ns() - start_ns;
+    recorder.stop();  // Flush outside the timings; drops show the writer fell behind
+
+    result = RecordingResult();
+    result.name = path.filename().string();
+    result.events = events;
+    result.frames = frames;
+    result.frames_analyzed = analyzed;
+    result.wall_s = wall_ns * 1e-9;
+    result.mev_per_s = wall_ns > 0 ? events * 1e3 / wall_ns : 0.0;
+    result.latency_p50_us = percentile_us(frame_latency_ns, 0.50);
+    result.latency_p95_us = percentile_us(frame_latency_ns, 0.95);
+    result.latency_p99_us = percentile_us(frame_latency_ns, 0.99);
+    result.recorder_dropped_events = static_cast<uint64_t>(std::max<int64_t>(recorder.get_dropped_events(), 0));
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        StageSamples& samples = stages[s];
+        StageResult& stage = result.stages[s];
+        stage.calls = samples.call_ns.size();
+        stage.ns_per_event = static_cast<double>(samples.ns) / std::max<uint64_t>(events, 1);
+        stage.allocs_per_call = static_cast<double>(samples.allocations) / std::max<uint64_t>(stage.calls, 1);
+        stage.p50_us = percentile_us(samples.call_ns, 0.50);
+        stage.p95_us = percentile_us(samples.call_ns, 0.95);
+        stage.p99_us = percentile_us(samples.call_ns, 0.99);
+    }
+    std::error_code ec;
+    fs::remove(scratch_file, ec);
+    return true;
+}
+
+// ============================================================================
+// Results and baselines
+// ============================================================================
+
+bool write_json(const fs::path& path, const std::string& profile, const Options& options,
+                const std::vector<RecordingResult>& results) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // One key per line, so the baseline reader needs no JSON library
+    file << std::fixed << std::setprecision(3);
+    file << "{\n";
+    file << "  \"profile\": \"" << profile << "\",\n";
+    file << "  \"window_us\": " << options.window_us << ",\n";
+    file << "  \"recordings\": [\n";
+    for (size_t r = 0; r < results.size(); ++r) {
+        const RecordingResult& result = results[r];
+        file << "    {\n";
+        file << "      \"recording\": \"" << result.name << "\",\n";
+        file << "      \"events\": " << result.events << ",\n";
+        file << "      \"frames\": " << result.frames << ",\n";
+        file << "      \"frames_analyzed\": " << result.frames_analyzed << ",\n";
+        file << "      \"wall_s\": " << result.wall_s << ",\n";
+        file << "      \"mev_per_s\": " << result.mev_per_s << ",\n";
+        file << "      \"latency_p50_us\": " << result.latency_p50_us << ",\n";
+        file << "      \"latency_p95_us\": " << result.latency_p95_us << ",\n";
+        file << "      \"latency_p99_us\": " << result.latency_p99_us << ",\n";
+        file << "      \"recorder_dropped_events\": " << result.recorder_dropped_events << ",\n";
+        file << "      \"stages\": [\n";
+        for (int s = 0; s < STAGE_COUNT; ++s) {
+            const StageResult& stage = result.stages[s];
+            file << "        {\n";
+            file << "          \"stage\": \"" << STAGE_NAMES[s] << "\",\n";
+            file << "          \"calls\": " << stage.calls << ",\n";
+            file << "          \"ns_per_event\": " << stage.ns_per_event << ",\n";
+            file << "          \"p50_us\": " << stage.p50_us << ",\n";
+            file << "          \"p95_us\": " << stage.p95_us << ",\n";
+            file << "          \"p99_us\": " << stage.p99_us << ",\n";
+            file << "          \"allocs_per_call\": " << stage.allocs_per_call << "\n";
+            file << "        }" << (s + 1 < STAGE_COUNT ? "," : "") << "\n";
+        }
+        file << "      ]\n";
+        file << "    }" << (r + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n";
+    file << "}\n";
+    return static_cast<bool>(file);
+}
+
+/**
+ * Read a result written by write_json()
+ * @return Recordings by name (empty if the file is missing or unreadable)
+ */
+std::map<std::string, RecordingResult> read_json(const fs::path& path) {
+    std::map<std::string, RecordingResult> results;
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return results;
+    }
+
+    RecordingResult* recording = nullptr;
+    StageResult* stage = nullptr;
+    std::string line;
+    try {
+        while (std::getline(file, line)) {
+            const size_t colon = line.find(':');
+            if (colon == std::string::npos) {
+                continue;
+            }
+            std::string key = line.substr(0, colon);
+            std::string value = line.substr(colon + 1);
+
+            // Remove whitespace, quotes, and commas
+            auto clean = [](std::string& s) {
+                s.erase(0, s.find_first_not_of(" \t\n\r\""));
+                s.erase(s.find_last_not_of(" \t\n\r\",") + 1);
+            };
+            clean(key);
+            clean(value);
+
+            if (key == "recording") {
+                recording = &results[value];
+                recording->name = value;
+                stage = nullptr;
+            } else if (!recording) {
+                continue;
+            } else if (key == "stage") {
+                const auto* name = std::find(std::begin(STAGE_NAMES), std::end(STAGE_NAMES), value);
+                stage = name != std::end(STAGE_NAMES) ? &recording->stages[name - std::begin(STAGE_NAMES)] : nullptr;
+            } else if (stage) {
+                if (key == "calls") stage->calls = std::stoull(value);
+                else if (key == "ns_per_event") stage->ns_per_event = std::stod(value);
+                else if (key == "p50_us") stage->p50_us = std::stod(value);
+                else if (key == "p95_us") stage->p95_us = std::stod(value);
+                else if (key == "p99_us") stage->p99_us = std::stod(value);
+                else if (key == "allocs_per_call") stage->allocs_per_call = std::stod(value);
+            } else {
+                if (key == "events") recording->events = std::stoull(value);
+                else if (key == "mev_per_s") recording->mev_per_s = std::stod(value);
+                else if (key == "latency_p95_us") recording->latency_p95_us = std::stod(value);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error parsing baseline " << path << ": " << e.what() << std::endl;
+        results.clear();
+    }
+    return results;
+}
+
+/**
+ * Flag a figure that grew past the tolerance and the noise floor
+ */
+bool regressed(double current, double baseline, double tolerance, double floor) {
+    return current > baseline * (1.0 + tolerance / 100.0) && current - baseline > floor;
+}
+
+/**
+ * Compare against the baseline and print every regression
+ * @return Number of regressions
+ */
+int compare(const std::vector<RecordingResult>& results, const std::map<std::string, RecordingResult>& baseline,
+            double tolerance) {
+    int regressions = 0;
+    auto flag = [&regressions](const std::string& what, double current, double before, const char* unit) {
+        std::cout << std::fixed << "  REGRESSION " << what << ": " << std::setprecision(2) << before << " -> "
+                  << current << unit;
+        if (before > 0.0) {
+            std::cout << " (+" << std::setprecision(1) << 100.0 * (current - before) / before << "%)";
+        }
+        std::cout << "\n";
+        ++regressions;
+    };
+
+    for (const RecordingResult& result : results) {
+        const auto found = baseline.find(result.name);
+        if (found == baseline.end()) {
+            std::cout << "  " << result.name << ": no baseline\n";
+            continue;
+        }
+        const RecordingResult& before = found->second;
+        if (before.events != result.events) {
+            std::cout << "  " << result.name << ": " << before.events << " events in the baseline, "
+                      << result.events << " now - recording changed, not compared\n";
+            continue;
+        }
+        if (regressed(result.latency_p95_us, before.latency_p95_us, tolerance, MIN_LATENCY_DELTA_US)) {
+            flag(result.name + " frame latency p95", result.latency_p95_us, before.latency_p95_us, " us");
+        }
+        for (int s = 0; s < STAGE_COUNT; ++s) {
+            const StageResult& now = result.stages[s];
+            const StageResult& then = before.stages[s];
+            const std::string what = result.name + " " + STAGE_NAMES[s];
+            if (regressed(now.ns_per_event, then.ns_per_event, tolerance, MIN_NS_PER_EVENT_DELTA)) {
+                flag(what + " ns/event", now.ns_per_event, then.ns_per_event, " ns");
+            }
+            if (regressed(now.p95_us, then.p95_us, tolerance, MIN_LATENCY_DELTA_US)) {
+                flag(what + " p95", now.p95_us, then.p95_us, " us");
+            }
+            if (regressed(now.allocs_per_call, then.allocs_per_call, tolerance, MIN_ALLOCS_DELTA)) {
+                flag(what + " allocs/call", now.allocs_per_call, then.allocs_per_call, "");
+            }
+        }
+    }
+    return regressions;
+}
+
+void print_result(const RecordingResult& result) {
+    std::cout << std::fixed << std::setprecision(1)
+              << "  " << result.events << " events, " << result.frames << " frames (" << result.frames_analyzed
+              << " analyzed) in " << std::setprecision(3) << result.wall_s << " s, " << std::setprecision(1)
+              << result.mev_per_s << " Mev/s, frame latency p50/p95/p99 " << result.latency_p50_us << " / "
+              << result.latency_p95_us << " / " << result.latency_p99_us << " us\n";
+    if (result.recorder_dropped_events > 0) {
+        std::cout << "  recorder dropped " << result.recorder_dropped_events << " events (writer slower than replay)\n";
+    }
+    std::cout << "  " << std::left << std::setw(12) << "stage" << std::right << std::setw(10) << "ns/event"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p95 us" << std::setw(10) << "p99 us"
+              << std::setw(13) << "allocs/call" << "\n";
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        const StageResult& stage = result.stages[s];
+        std::cout << "  " << std::left << std::setw(12) << STAGE_NAMES[s] << std::right << std::setprecision(2)
+                  << std::setw(10) << stage.ns_per_event << std::setprecision(1) << std::setw(10) << stage.p50_us
+                  << std::setw(10) << stage.p95_us << std::setw(10) << stage.p99_us << std::setprecision(2)
+                  << std::setw(13) << stage.allocs_per_call << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_args(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+    core::AllocTracker::install_mat_allocator();
+
+    const std::string profile = options.profile.empty() ? default_profile() : options.profile;
+    if (options.output.empty()) {
+        options.output = "replay_" + profile + ".json";
+    }
+    const fs::path scratch_dir = options.scratch.empty() ? fs::temp_directory_path() : options.scratch;
+    std::cout << "Replay benchmark: " << options.recordings.size() << " recordings, profile " << profile << ", "
+              << options.window_us << " us windows, best of " << options.repeat << std::endl;
+
+    std::vector<RecordingResult> results;
+    for (const fs::path& path : options.recordings) {
+        std::cout << "\n" << path.filename().string() << std::endl;
+        const fs::path scratch_file = scratch_dir / ("replay_bench_" + path.stem().string() + ".rtev");
+        RecordingResult best;
+        for (int pass = 0; pass < options.repeat; ++pass) {
+            RecordingResult result;
+            if (!replay(options, path, scratch_file, result)) {
+                return 1;
+            }
+            if (pass == 0 || result.wall_s < best.wall_s) {
+                best = std::move(result);
+            }
+        }
+        print_result(best);
+        results.push_back(std::move(best));
+    }
+
+    if (!write_json(options.output, profile, options, results)) {
+        std::cerr << "Cannot write " << options.output << std::endl;
+        return 1;
+    }
+    std::cout << "\nResults: " << options.output.string() << std::endl;
+
+    const fs::path baseline_path = options.baselines / (profile + ".json");
+    if (options.update_baseline) {
+        std::error_code ec;
+        fs::create_directories(options.baselines, ec);
+        if (!write_json(baseline_path, profile, options, results)) {
+            std::cerr << "Cannot write baseline " << baseline_path << std::endl;
+            return 1;
+        }
+        std::cout << "Baseline updated: " << baseline_path.string() << std::endl;
+        return 0;
+    }
+
+    const auto baseline = read_json(baseline_path);
+    if (baseline.empty()) {
+        std::cout << "No baseline for profile " << profile << " in " << options.baselines.string()
+                  << " (store one with --update-baseline)" << std::endl;
+        return 0;
+    }
+    std::cout << "Against " << baseline_path.string() << " (tolerance " << options.tolerance << "%):\n";
+    const int regressions = compare(results, baseline, options.tolerance);
+    if (regressions > 0) {
+        std::cout << regressions << " regression(s)" << std::endl;
+        return 2;
+    }
+    std::cout << "No regressions" << std::endl;
+    return 0;
+}
@@ -0,0 +1,674 @@
+/**
+ * SIMD Kernel Benchmark
+ *
+ * Runs every video::simd::internal variant (scalar / SSE4.1 / AVX2 /
+ * AVX-512 on x86, scalar / NEON on AArch64) and the public dispatcher over a range of frame shapes: sensor
+ * sizes, odd widths that leave vector tails, a misaligned base pointer and
+ * non-continuous ROIs (row stride wider than the row). Each variant's
+ * output is compared with the scalar reference, and the bytes around every
+ * output row are checked for overruns, before it is timed.
+ *
+ * Reports GB/s (bytes read + written) and cycles per pixel per variant (TSC
+ * on x86, the virtual counter's ticks on AArch64),
+ * so it is visible which path wins on a given workstation. Exits non-zero
+ * if any variant disagrees with the scalar reference.
+ *
+ * Usage:
+ *   simd_bench [--kernel <name>] [--quick]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#include <intrin.h>  // __rdtsc, _ReadStatusReg
+#elif defined(__x86_64__)
+#include <x86intrin.h>  // __rdtsc
+#endif
+
+#include <opencv2/core.hpp>
+
+#include "video/simd_utils.h"
+
+namespace {
+
+using video::simd::CPUFeatures;
+namespace internal = video::simd::internal;
+
+// Masked histogram: 4 banks of 512 bins (see simd_utils.cpp)
+constexpr size_t HIST_BANKS = 4 * 512;
+
+constexpr uint8_t GUARD_BYTE = 0xA5;     // Fill around output rows to catch overruns
+constexpr size_t GUARD_BYTES = 64;
+constexpr uint64_t PLANE_GUARD_WORD = 0xA5A5A5A5A5A5A5A5ULL;
+constexpr int64_t MIN_BATCH_NS = 2000000; // Each timing sample runs at least 2 ms
+constexpr int TIMING_SAMPLES = 5;         // Best of
+
+/**
+ * Frame shape under test
+ */
+struct Shape {
+    std::string name;
+    int width;
+    int height;
+    size_t row_padding;   // Extra bytes per row (> 0 = non-continuous ROI)
+    size_t misalign;      // Byte offset of the first pixel from a 64-byte boundary
+};
+
+/**
+ * Buffers for one shape: inputs, a mask and an output image with guard bytes
+ */
+struct Frame {
+    Shape shape;
+    int src_channels = 1;
+    size_t src_stride = 0;
+    size_t mask_stride = 0;
+    size_t dst_stride = 0;
+    std::vector<uint8_t> src_storage;
+    std::vector<uint8_t> mask_storage;
+    std::vector<uint8_t> dst_storage;
+    uint8_t* src = nullptr;
+    uint8_t* mask = nullptr;
+    uint8_t* dst = nullptr;
+    std::vector<uint32_t> banks = std::vector<uint32_t>(HIST_BANKS);
+    video::BinaryFrame planes[8];
+    video::BinaryFrame packed[3];   // Inputs of the bit algebra kernels
+
+    bool continuous() const { return shape.row_padding == 0; }
+    size_t pixels() const { return static_cast<size_t>(shape.width) * shape.height; }
+
+    static uint8_t* aligned(std::vector<uint8_t>& storage, size_t misalign) {
+        const auto base = reinterpret_cast<uintptr_t>(storage.data()) + GUARD_BYTES;
+        return reinterpret_cast<uint8_t*>((base + 63) / 64 * 64 + misalign);
+    }
+
+    void allocate(const Shape& s, int channels, std::mt19937& rng) {
+        shape = s;
+        src_channels = channels;
+        src_stride = static_cast<size_t>(s.width) * channels + s.row_padding;
+        mask_stride = static_cast<size_t>(s.width) + s.row_padding;
+        dst_stride = static_cast<size_t>(s.width) + s.row_padding;
+
+        const size_t slack = 2 * GUARD_BYTES + 64 + s.misalign;
+        src_storage.assign(src_stride * s.height + slack, 0);
+        mask_storage.assign(mask_stride * s.height + slack, 0);
+        dst_storage.assign(dst_stride * s.height + slack, GUARD_BYTE);
+        src = aligned(src_storage, s.misalign);
+        mask = aligned(mask_storage, s.misalign);
+        dst = aligned(dst_storage, s.misalign);
+
+        std::uniform_int_distribution<int> byte(0, 255);
+        for (auto& v : src_storage) v = static_cast<uint8_t>(byte(rng));
+        for (auto& v : mask_storage) v = byte(rng) < 128 ? 0 : 255;
+        // Long uniform runs exercise the histogram's whole-block fast path
+        for (int y = 0; y < s.height / 4; ++y) {
+            std::memset(mask + y * mask_stride, (y & 1) ? 255 : 0, s.width);
+        }
+        for (video::BinaryFrame& plane : planes) {
+            plane.create(s.width, s.height);
+        }
+        for (video::BinaryFrame& input : packed) {
+            input.create(s.width, s.height);
+            for (int y = 0; y < s.height; ++y) {
+                for (int x = 0; x < s.width; ++x) {
+                    input.set(x, y, byte(rng) < 64);
+                }
+            }
+        }
+    }
+
+    void clear_output() {
+        std::fill(dst_storage.begin(), dst_storage.end(), GUARD_BYTE);
+        std::fill(banks.begin(), banks.end(), 0u);
+        // Padding bits set: a word a variant skipped cannot match the reference
+        for (video::BinaryFrame& plane : planes) {
+            std::fill(plane.data(), plane.data() + plane.word_count(), PLANE_GUARD_WORD);
+        }
+    }
+
+    /**
+     * Check that nothing outside the output rows was written
+     */
+    bool guards_intact() const {
+        const uint8_t* first = dst_storage.data();
+        const uint8_t* last = dst_storage.data() + dst_storage.size();
+        for (const uint8_t* p = first; p < dst; ++p) {
+            if (*p != GUARD_BYTE) return false;
+        }
+        for (int y = 0; y < shape.height; ++y) {
+            const uint8_t* pad = dst + y * dst_stride + shape.width;
+            const uint8_t* pad_end = (y + 1 < shape.height) ? dst + (y + 1) * dst_stride : last;
+            for (const uint8_t* p = pad; p < pad_end; ++p) {
+                if (*p != GUARD_BYTE) return false;
+            }
+        }
+        return true;
+    }
+
+    cv::Mat src_mat() const {
+        return cv::Mat(shape.height, shape.width, CV_8UC(src_channels), src, src_stride);
+    }
+    cv::Mat mask_mat() const { return cv::Mat(shape.height, shape.width, CV_8UC1, mask, mask_stride); }
+    cv::Mat dst_mat() const { return cv::Mat(shape.height, shape.width, CV_8UC1, dst, dst_stride); }
+};
+
+/**
+ * One implementation of a kernel
+ *
+ * run() processes the whole frame: one call over all pixels when the frame
+ * is continuous, row by row otherwise (the public API does the same).
+ */
+struct Variant {
+    std::string name;
+    std::function<bool(const CPUFeatures&)> supported;
+    std::function<void(Frame&)> run;
+};
+
+/**
+ * A kernel family: scalar reference first, then the SIMD variants, then the dispatcher
+ */
+struct Kernel {
+    std::string name;
+    int src_channels;
+    bool reads_mask;
+    bool histogram;             // Output is the bin array, not an image
+    std::vector<Variant> variants;
+    bool bit_planes = false;    // Output is Frame::planes, not an image
+    bool packed = false;        // Reads Frame::packed (1 bit per pixel), not the image
+};
+
+using RowFn = std::function<void(Frame& f, const uint8_t* src, const uint8_t* mask, uint8_t* dst, size_t pixels)>;
+
+/**
+ * Wrap a row kernel into a whole-frame run
+ */
+std::function<void(Frame&)> over_rows(RowFn fn) {
+    return [fn](Frame& f) {
+        if (f.continuous()) {
+            fn(f, f.src, f.mask, f.dst, f.pixels());
+            return;
+        }
+        for (int y = 0; y < f.shape.height; ++y) {
+            fn(f, f.src + y * f.src_stride, f.mask + y * f.mask_stride, f.dst + y * f.dst_stride,
+               static_cast<size_t>(f.shape.width));
+        }
+    };
+}
+
+bool always(const CPUFeatures&) { return true; }
+#ifdef RTCAM_SIMD_X86
+bool has_sse41(const CPUFeatures& f) { return f.has_sse41; }
+bool has_avx2(const CPUFeatures& f) { return f.has_avx2; }
+bool has_avx512bw(const CPUFeatures& f) { return f.has_avx512bw; }
+bool has_avx512vpopcntdq(const CPUFeatures& f) { return f.has_avx512vpopcntdq; }
+#endif
+#ifdef RTCAM_SIMD_NEON
+bool has_neon(const CPUFeatures& f) { return f.has_neon; }
+#endif
+
+// Parameters matching the UP_DOWN binary stream mode
+constexpr uint8_t RANGE_LOW = 96, RANGE_HIGH = 127;
+constexpr uint8_t RANGE2_LOW = 224, RANGE2_HIGH = 255;
+constexpr uint8_t BIT_MASK = (1 << 5) | (1 << 6);
+
+// Scattering outside two references: a AND NOT (b OR c)
+constexpr uint8_t TERNARY_TABLE = video::simd::TERN_A & ~(video::simd::TERN_B | video::simd::TERN_C);
+
+std::vector<Kernel> make_kernels() {
+    std::vector<Kernel> kernels;
+
+    {
+        Kernel k{"bgr_to_gray", 3, false, false, {}};
+        auto row = [](void (*fn)(const uint8_t*, uint8_t*, size_t)) {
+            return over_rows([fn](Frame&, const uint8_t* s, const uint8_t*, uint8_t* d, size_t n) { fn(s, d, n); });
+        };
+        k.variants = {
+            {"scalar", always, row(internal::bgr_to_gray_scalar)},
+#ifdef RTCAM_SIMD_X86
+            {"sse41", has_sse41, row(internal::bgr_to_gray_sse41)},
+            {"avx2", has_avx2, row(internal::bgr_to_gray_avx2)},
+            {"avx512", has_avx512bw, row(internal::bgr_to_gray_avx512)},
+#endif
+#ifdef RTCAM_SIMD_NEON
+            {"neon", has_neon, row(internal::bgr_to_gray_neon)},
+#endif
+            {"dispatch", always, [](Frame& f) {
+                cv::Mat dst = f.dst_mat();
+                video::simd::bgr_to_gray(f.src_mat(), dst);
+            }},
+        };
+        kernels.push_back(std::move(k));
+    }
+    {
+        Kernel k{"range_filter", 1, false, false, {}};
+        auto row = [](void (*fn)(const uint8_t*, uint8_t*, size_t, uint8_t, uint8_t)) {
+            return over_rows([fn](Frame&, const uint8_t* s, const uint8_t*, uint8_t* d, size_t n) {
+                fn(s, d, n, RANGE_LOW, RANGE_HIGH);
+            });
+        };
+        k.variants = {
+            {"scalar", always, row(internal::range_filter_scalar)},
+#ifdef RTCAM_SIMD_X86
+            {"sse41", has_sse41, row(internal::range_filter_sse41)},
+            {"avx2", has_avx2, row(internal::range_filter_avx2)},
+#endif
+#ifdef RTCAM_SIMD_NEON
+            {"neon", has_neon, row(internal::range_filter_neon)},
+#endif
+            {"dispatch", always, [](Frame& f) {
+                cv::Mat dst = f.dst_mat();
+                video::simd::apply_range_filter(f.src_mat(), dst, RANGE_LOW, RANGE_HIGH);
+            }},
+        };
+        kernels.push_back(std::move(k));
+    }
+    {
+        Kernel k{"dual_range_filter", 1, false, false, {}};
+        auto row = [](void (*fn)(const uint8_t*, uint8_t*, size_t, uint8_t, uint8_t, uint8_t, uint8_t)) {
+            return over_rows([fn](Frame&, const uint8_t* s, const uint8_t*, uint8_t* d, size_t n) {
+                fn(s, d, n, RANGE_LOW, RANGE_HIGH, RANGE2_LOW, RANGE2_HIGH);
+            });
+        };
+        k.variants = {
+            {"scalar", always, row(internal::dual_range_filter_scalar)},
+#ifdef RTCAM_SIMD_X86
+            {"sse41", has_sse41, row(internal::dual_range_filter_sse41)},
+            {"avx2", has_avx2, row(internal::dual_range_filter_avx2)},
+            {"avx512", has_avx512bw, row(internal::dual_range_filter_avx512)},
+#endif
+#ifdef RTCAM_SIMD_NEON
+            {"neon", has_neon, row(internal::dual_range_filter_neon)},
+#endif
+            {"dispatch", always, [](Frame& f) {
+                cv::Mat dst = f.dst_mat();
+                video::simd::apply_dual_range_filter(f.src_mat(), dst,
+                                                     RANGE_LOW, RANGE_HIGH, RANGE2_LOW, RANGE2_HIGH);
+            }},
+        };
+        kernels.push_back(std::move(k));
+    }
+    for (int channels : {3, 1}) {
+        Kernel k{channels == 3 ? "bit_mask_bgr" : "bit_mask_gray", channels, false, false, {}};
+        auto row = [](void (*fn)(const uint8_t*, uint8_t*, size_t, uint8_t)) {
+            return over_rows([fn](Frame&, const uint8_t* s, const uint8_t*, uint8_t* d, size_t n) {
+                fn(s, d, n, BIT_MASK);
+            });
+        };
+#ifdef RTCAM_SIMD_X86
+        // "_fixed": the same kernels with BIT_MASK compiled in (what the dispatcher runs for bit pairs)
+        const internal::BitMaskKernels& sse41_fixed = *internal::fixed_bit_mask_sse41(BIT_MASK);
+        const internal::BitMaskKernels& avx2_fixed = *internal::fixed_bit_mask_avx2(BIT_MASK);
+#endif
+        if (channels == 3) {
+            k.variants = {
+                {"scalar", always, row(internal::bit_mask_bgr_scalar)},
+#ifdef RTCAM_SIMD_X86
+                {"sse41", has_sse41, row(internal::bit_mask_bgr_sse41)},
+                {"avx2", has_avx2, row(internal::bit_mask_bgr_avx2)},
+                {"sse41_fixed", has_sse41, row(sse41_fixed.bgr)},
+                {"avx2_fixed", has_avx2, row(avx2_fixed.bgr)},
+#endif
+#ifdef RTCAM_SIMD_NEON
+                {"neon", has_neon, row(internal::bit_mask_bgr_neon)},
+#endif
+            };
+        } else {
+            k.variants = {
+                {"scalar", always, row(internal::bit_mask_gray_scalar)},
+#ifdef RTCAM_SIMD_X86
+                {"sse41", has_sse41, row(internal::bit_mask_gray_sse41)},
+                {"avx2", has_avx2, row(internal::bit_mask_gray_avx2)},
+                {"sse41_fixed", has_sse41, row(sse41_fixed.gray)},
+                {"avx2_fixed", has_avx2, row(avx2_fixed.gray)},
+#endif
+#ifdef RTCAM_SIMD_NEON
+                {"neon", has_neon, row(internal::bit_mask_gray_neon)},
+#endif
+            };
+        }
+        k.variants.push_back({"dispatch", always, [](Frame& f) {
+            cv::Mat dst = f.dst_mat();
+            video::simd::extract_bit_mask(f.src_mat(), dst, BIT_MASK);
+        }});
+        kernels.push_back(std::move(k));
+    }
+    for (int channels : {3, 1}) {
+        // Plane rows are word aligned, so always row by row
+        Kernel k{channels == 3 ? "bit_planes_bgr" : "bit_planes_gray", channels, false, false, {}};
+        k.bit_planes = true;
+        auto row = [](void (*fn)(const uint8_t*, uint64_t* const*, size_t)) {
+            return [fn](Frame& f) {
+                uint64_t* rows[8];
+                for (int y = 0; y < f.shape.height; ++y) {
+                    for (int b = 0; b < 8; ++b) {
+                        rows[b] = f.planes[b].row(y);
+                    }
+                    fn(f.src + y * f.src_stride, rows, static_cast<size_t>(f.shape.width));
+                }
+            };
+        };
+        if (channels == 3) {
+            k.variants = {
+                {"scalar", always, row(internal::bit_planes_bgr_scalar)},
+#ifdef RTCAM_SIMD_X86
+                {"sse41", has_sse41, row(internal::bit_planes_bgr_sse41)},
+                {"avx2", has_avx2, row(internal::bit_planes_bgr_avx2)},
+#endif
+#ifdef RTCAM_SIMD_NEON
+                {"neon", has_neon, row(internal::bit_planes_bgr_neon)},
+#endif
+            };
+        } else {
+            k.variants = {
+                {"scalar", always, row(internal::bit_planes_gray_scalar)},
+#ifdef RTCAM_SIMD_X86
+                {"sse41", has_sse41, row(internal::bit_planes_gray_sse41)},
+                {"avx2", has_avx2, row(internal::bit_planes_gray_avx2)},
+                {"avx512", has_avx512bw, row(internal::bit_planes_gray_avx512)},
+#endif
+#ifdef RTCAM_SIMD_NEON
+                {"neon", has_neon, row(internal::bit_planes_gray_neon)},
+#endif
+            };
+        }
+        k.variants.push_back({"dispatch", always, [](Frame& f) {
+            video::simd::split_bit_planes(f.src_mat(), f.planes);
+        }});
+        kernels.push_back(std::move(k));
+    }
+    {
+        Kernel k{"masked_histogram", 1, true, true, {}};
+        auto row = [](void (*fn)(const uint8_t*, const uint8_t*, size_t, uint32_t*)) {
+            return over_rows([fn](Frame& f, const uint8_t* s, const uint8_t* m, uint8_t*, size_t n) {
+                fn(s, m, n, f.banks.data());
+            });
+        };
+        k.variants = {
+            {"scalar", always, row(internal::masked_histogram_scalar)},
+#ifdef RTCAM_SIMD_X86
+            {"sse41", has_sse41, row(internal::masked_histogram_sse41)},
+            {"avx2", has_avx2, row(internal::masked_histogram_avx2)},
+#endif
+            {"dispatch", always, [](Frame& f) {
+                // Stored as bank 0 so the comparison below sees merged bins
+                video::simd::masked_histogram(f.src_mat(), f.mask_mat(), f.banks.data() + 256, f.banks.data());
+            }},
+        };
+        kernels.push_back(std::move(k));
+    }
+    {
+        // The binary mask stands in for the previous frame
+        Kernel k{"frame_difference", 1, true, false, {}};
+        auto row = [](void (*fn)(const uint8_t*, const uint8_t*, uint8_t*, size_t)) {
+            return over_rows([fn](Frame&, const uint8_t* s, const uint8_t* m, uint8_t* d, size_t n) {
+                fn(s, m, d, n);
+            });
+        };
+        k.variants = {
+            {"scalar", always, row(internal::frame_difference_scalar)},
+#ifdef RTCAM_SIMD_X86
+            {"sse41", has_sse41, row(internal::frame_difference_sse41)},
+            {"avx2", has_avx2, row(internal::frame_difference_avx2)},
+#endif
+#ifdef RTCAM_SIMD_NEON
+            {"neon", has_neon, row(internal::frame_difference_neon)},
+#endif
+            {"dispatch", always, [](Frame& f) {
+                cv::Mat dst = f.dst_mat();
+                video::simd::frame_difference(f.src_mat(), f.mask_mat(), dst);
+            }},
+        };
+        kernels.push_back(std::move(k));
+    }
+    {
+        // planes[0] = f(a, b, c); its count goes to the first word of planes[1]
+        Kernel k{"bit_algebra", 1, false, false, {}};
+        k.bit_planes = true;
+        k.packed = true;
+        using TernaryFn = void (*)(const uint64_t*, const uint64_t*, const uint64_t*, uint64_t*, size_t, uint8_t);
+        using CountFn = int64_t (*)(const uint64_t*, const uint64_t*, const uint64_t*, size_t, uint8_t);
+        auto pair = [](TernaryFn ternary, CountFn count) {
+            return [ternary, count](Frame& f) {
+                const size_t words = f.packed[0].word_count();
+                ternary(f.packed[0].data(), f.packed[1].data(), f.packed[2].data(), f.planes[0].data(), words,
+                        TERNARY_TABLE);
+                f.planes[1].data()[0] = static_cast<uint64_t>(
+                    count(f.packed[0].data(), f.packed[1].data(), f.packed[2].data(), words, TERNARY_TABLE));
+            };
+        };
+        k.variants = {
+            {"scalar", always, pair(internal::bitwise_ternary_scalar, internal::count_ternary_scalar)},
+#ifdef RTCAM_SIMD_X86
+            {"avx2", has_avx2, pair(internal::bitwise_ternary_avx2, internal::count_ternary_avx2)},
+            {"avx512", has_avx512bw, pair(internal::bitwise_ternary_avx512, internal::count_ternary_avx512)},
+            {"avx512_vpopcnt", has_avx512vpopcntdq,
+             pair(internal::bitwise_ternary_avx512, internal::count_ternary_avx512_vpopcnt)},
+#endif
+            {"dispatch", always, pair(video::simd::bitwise_ternary, video::simd::count_ternary)},
+        };
+        kernels.push_back(std::move(k));
+    }
+    return kernels;
+}
+
+std::vector<Shape> make_shapes(bool quick) {
+    std::vector<Shape> shapes = {
+        {"1280x720", 1280, 720, 0, 0},
+        {"1280x720 +1", 1280, 720, 0, 1},          // Misaligned base pointer
+        {"1277x719", 1277, 719, 0, 0},             // Vector tail on every path
+        {"ROI 1000x600", 1000, 600, 283, 3},       // Non-continuous rows
+        {"ROI 33x17", 33, 17, 7, 5},               // Shorter than one AVX-512 block per row
+    };
+    if (!quick) {
+        shapes.insert(shapes.begin(), {"640x480", 640, 480, 0, 0});
+        shapes.push_back({"1920x1080", 1920, 1080, 0, 0});
+        shapes.push_back({"7x3", 7, 3, 0, 0});     // Scalar tail only
+    }
+    return shapes;
+}
+
+/**
+ * Result of a kernel on a frame, in a form every variant can be compared by
+ */
+std::vector<uint8_t> capture_output(const Kernel& kernel, const Frame& f) {
+    std::vector<uint8_t> out;
+    if (kernel.histogram) {
+        // Variants may spread counts over the 4 banks differently; compare merged bins
+        std::vector<uint32_t> merged(512, 0u);
+        for (size_t b = 0; b < 4; ++b) {
+            for (size_t v = 0; v < 512; ++v) {
+                merged[v] += f.banks[b * 512 + v];
+            }
+        }
+        out.resize(merged.size() * sizeof(uint32_t));
+        std::memcpy(out.data(), merged.data(), out.size());
+        return out;
+    }
+    if (kernel.bit_planes) {
+        for (const video::BinaryFrame& plane : f.planes) {
+            const uint8_t* words = reinterpret_cast<const uint8_t*>(plane.data());
+            out.insert(out.end(), words, words + plane.word_count() * sizeof(uint64_t));
+        }
+        return out;
+    }
+    out.reserve(f.pixels());
+    for (int y = 0; y < f.shape.height; ++y) {
+        const uint8_t* row = f.dst + y * f.dst_stride;
+        out.insert(out.end(), row, row + f.shape.width);
+    }
+    return out;
+}
+
+// Cycle counter for the cyc/px column: TSC on x86, CNTVCT_EL0 on AArch64
+uint64_t read_cycles() {
+#if defined(_MSC_VER) && defined(_M_ARM64)
+    return static_cast<uint64_t>(_ReadStatusReg(ARM64_CNTVCT));
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#elif defined(_M_X64) || defined(__x86_64__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+struct Timing {
+    double ns_per_call = 0.0;
+    double cycles_per_call = 0.0;
+};
+
+Timing time_variant(const Variant& variant, Frame& f) {
+    using Clock = std::chrono::steady_clock;
+
+    // Grow the batch until one sample is long enough to time reliably
+    int reps = 1;
+    for (;;) {
+        const auto start = Clock::now();
+        for (int r = 0; r < reps; ++r) variant.run(f);
+        const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        if (ns >= MIN_BATCH_NS || reps >= (1 << 20)) break;
+        reps *= 2;
+    }
+
+    Timing best;
+    best.ns_per_call = 1e300;
+    for (int sample = 0; sample < TIMING_SAMPLES; ++sample) {
+        const uint64_t tsc_start = read_cycles();
+        const auto start = Clock::now();
+        for (int r = 0; r < reps; ++r) variant.run(f);
+        const auto stop = Clock::now();
+        const uint64_t tsc_stop = read_cycles();
+
+        const double ns = std::chrono::duration<double, std::nano>(stop - start).count() / reps;
+        if (ns < best.ns_per_call) {
+            best.ns_per_call = ns;
+            best.cycles_per_call = static_cast<double>(tsc_stop - tsc_start) / reps;
+        }
+    }
+    return best;
+}
+
+const char* dispatch_path(const Kernel& kernel, const CPUFeatures& f) {
+    if (f.has_neon) {
+        const bool has_neon_variant = std::any_of(kernel.variants.begin(), kernel.variants.end(),
+                                                  [](const Variant& v) { return v.name == "neon"; });
+        return has_neon_variant ? "neon" : "scalar";
+    }
+    const bool has_avx512_variant = std::any_of(kernel.variants.begin(), kernel.variants.end(),
+                                                [](const Variant& v) { return v.name == "avx512"; });
+    if (has_avx512_variant && f.has_avx512bw) return "avx512";
+    if (f.has_avx2) return "avx2";
+    if (f.has_sse41) return "sse41";
+    return "scalar";
+}
+
+/**
+ * Check and time every variant of a kernel on one shape
+ * @return Number of variants that disagreed with the scalar reference
+ */
+int run_kernel_on_shape(const Kernel& kernel, const Shape& shape, const CPUFeatures& features, std::mt19937& rng) {
+    Frame frame;
+    frame.allocate(shape, kernel.src_channels, rng);
+
+    const double pixels = static_cast<double>(frame.pixels());
+    // 8 bit planes write one byte per pixel, like an image; bit algebra reads
+    // three packed frames twice and writes one
+    const double bytes = kernel.packed ? pixels * 7 / 8
+                                       : pixels * (kernel.src_channels + (kernel.reads_mask ? 1 : 0) +
+                                                   (kernel.histogram ? 0 : 1));
+
+    std::vector<uint8_t> reference;
+    int failures = 0;
+    for (const Variant& variant : kernel.variants) {
+        if (!variant.supported(features)) {
+            std::cout << "  " << std::left << std::setw(14) << shape.name << std::setw(14) << variant.name
+                      << "(not supported on this CPU)\n";
+            continue;
+        }
+        // bgr_to_gray and apply_range_filter take continuous frames only
+        if (variant.name == "dispatch" && !frame.continuous() &&
+            (kernel.name == "bgr_to_gray" || kernel.name == "range_filter")) {
+            continue;
+        }
+
+        frame.clear_output();
+        variant.run(frame);
+        const std::vector<uint8_t> output = capture_output(kernel, frame);
+        bool ok = kernel.histogram || frame.guards_intact();
+        if (reference.empty()) {
+            reference = output;  // Scalar runs first
+        } else {
+            ok = ok && output == reference;
+        }
+
+        const Timing timing = time_variant(variant, frame);
+        std::cout << "  " << std::left << std::setw(14) << shape.name << std::setw(14) << variant.name
+                  << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(9) << bytes / timing.ns_per_call << " GB/s"
+                  << std::setprecision(3) << std::setw(9) << timing.cycles_per_call / pixels << " cyc/px"
+                  << (ok ? "" : "   MISMATCH") << "\n";
+        if (!ok) {
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string only;
+    bool quick = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--kernel" && i + 1 < argc) {
+            only = argv[++i];
+        } else if (arg == "--quick") {
+            quick = true;
+        } else {
+            std::cout << "Usage: simd_bench [--kernel <name>] [--quick]\n"
+                      << "  Kernels: bgr_to_gray, range_filter, dual_range_filter, bit_mask_bgr,\n"
+                      << "           bit_mask_gray, bit_planes_bgr, bit_planes_gray, masked_histogram,\n"
+                      << "           frame_difference, bit_algebra\n";
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    const CPUFeatures& features = video::simd::get_cpu_features();
+    const std::vector<Shape> shapes = make_shapes(quick);
+    std::mt19937 rng(12345);
+
+    int failures = 0;
+    int kernels_run = 0;
+    for (const Kernel& kernel : make_kernels()) {
+        if (!only.empty() && kernel.name != only) {
+            continue;
+        }
+        ++kernels_run;
+        std::cout << "\n" << kernel.name << " (dispatch uses " << dispatch_path(kernel, features) << ")\n";
+        for (const Shape& shape : shapes) {
+            failures += run_kernel_on_shape(kernel, shape, features, rng);
+        }
+    }
+
+    if (kernels_run == 0) {
+        std::cerr << "Unknown kernel: " << only << std::endl;
+        return 1;
+    }
+    if (failures > 0) {
+        std::cout << "\n" << failures << " variant(s) disagree with the scalar reference" << std::endl;
+        return 1;
+    }
+    std::cout << "\nAll variants match the scalar reference" << std::endl;
+    return 0;
+}
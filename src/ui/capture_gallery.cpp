@@ -0,0 +1,379 @@
+/**
+ * @file capture_gallery.cpp
+ * @brief Thumbnail gallery of the captures in the capture catalog
+ */
+
+#include "ui/capture_gallery.h"
+#include "core/profiler.h"
+#include "core/qos_scheduler.h"
+#include "imgui.h"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace ui {
+
+namespace {
+
+constexpr int CELLS_PER_ROW = CaptureGallery::ATLAS_SIZE / CaptureGallery::THUMB_SIZE;
+constexpr auto RELIST_INTERVAL = std::chrono::seconds(1);   // While the catalog grows
+
+/**
+ * Thumbnail file name: a hash of the catalog path, so nested directories flatten
+ */
+std::string thumb_name(const std::string& path) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : path) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.png", static_cast<unsigned long long>(hash));
+    return name;
+}
+
+} // namespace
+
+CaptureGallery::CaptureGallery(int threads, std::function<void(const std::string&)> on_open)
+    : on_open_(std::move(on_open)),
+      cell_owner_(ATLAS_CELLS),
+      atlas_(static_cast<size_t>(ATLAS_SIZE) * ATLAS_SIZE, 0) {
+    const int workers = threads > 0 ? threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 2);
+    pool_ = std::make_unique<video::ThreadPool>(workers);
+    max_in_flight_ = workers * 4;   // Enough to keep every worker busy, few enough to skip when scrolling
+}
+
+CaptureGallery::~CaptureGallery() {
+    pool_.reset();   // Joins the workers before the state they write goes away
+    if (texture_ != 0) {
+        glDeleteTextures(1, &texture_);
+    }
+}
+
+// ============================================================================
+// Render
+// ============================================================================
+
+void CaptureGallery::render(bool* open) {
+    if (!*open) {
+        return;
+    }
+    PROFILE_ZONE("CaptureGallery::render");
+    ++frame_;
+    place_results();
+    upload_atlas();
+
+    std::unordered_set<std::string> visible;
+    ImGui::SetNextWindowSize(ImVec2(900, 700), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Capture Gallery", open)) {
+        auto& catalog = CaptureCatalog::instance();
+        if (!catalog.is_open()) {
+            ImGui::TextWrapped("The gallery lists the capture catalog, which is off (capture_catalog in the config).");
+        } else {
+            ImGui::PushItemWidth(400);
+            static char query_buffer[256] = "";
+            std::snprintf(query_buffer, sizeof(query_buffer), "%s", query_.c_str());
+            const bool submitted = ImGui::InputText("##GalleryQuery", query_buffer, sizeof(query_buffer),
+                ImGuiInputTextFlags_EnterReturnsTrue);
+            query_ = query_buffer;
+            ImGui::PopItemWidth();
+            ImGui::SameLine();
+            if (ImGui::Button("Filter") || submitted) {
+                stale_ = true;
+            }
+            ImGui::SetItemTooltip("Catalog query, e.g. bias_hpf=100 pixel_density>2%%; empty = every capture");
+
+            // Follow new captures, at most once a second while the backfill is adding thousands
+            const auto now = std::chrono::steady_clock::now();
+            if (stale_ || (catalog.size() != listed_catalog_size_ && now - listed_at_ >= RELIST_INTERVAL)) {
+                refresh();
+            }
+
+            if (!query_error_.empty()) {
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Cannot parse: %s", query_error_.c_str());
+            } else {
+                ImGui::Text("%zu captures%s, %d thumbnails decoding", items_.size(),
+                    catalog.is_backfilling() ? " (indexing)" : "", in_flight_);
+            }
+            ImGui::Separator();
+
+            ImGui::BeginChild("##GalleryGrid");
+            const ImGuiStyle& style = ImGui::GetStyle();
+            const float cell_width = THUMB_SIZE + style.ItemSpacing.x;
+            const int columns = std::max(1, static_cast<int>((ImGui::GetContentRegionAvail().x + style.ItemSpacing.x) / cell_width));
+            const int rows = static_cast<int>((items_.size() + columns - 1) / columns);
+
+            // Only the rows on screen are laid out (and decoded)
+            ImGuiListClipper clipper;
+            clipper.Begin(rows, THUMB_SIZE + ImGui::GetTextLineHeightWithSpacing() + style.ItemSpacing.y);
+            while (clipper.Step()) {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                    for (int column = 0; column < columns; ++column) {
+                        const size_t index = static_cast<size_t>(row) * columns + column;
+                        if (index >= items_.size()) {
+                            break;
+                        }
+                        if (column > 0) {
+                            ImGui::SameLine();
+                        }
+                        draw_item(items_[index], visible);
+                    }
+                }
+            }
+            ImGui::EndChild();
+        }
+    }
+    ImGui::End();
+
+    // Queued jobs for anything no longer on screen are skipped
+    std::lock_guard<std::mutex> lock(mutex_);
+    visible_.swap(visible);
+}
+
+void CaptureGallery::refresh() {
+    auto& catalog = CaptureCatalog::instance();
+    CaptureCatalog::Query query;
+    if (CaptureCatalog::Query::parse(query_, query, query_error_)) {
+        items_ = catalog.find(query, 0);
+    } else {
+        items_.clear();
+    }
+    listed_catalog_size_ = catalog.size();
+    listed_at_ = std::chrono::steady_clock::now();
+    stale_ = false;
+}
+
+void CaptureGallery::draw_item(const CaptureCatalog::Entry& entry, std::unordered_set<std::string>& visible) {
+    Thumb& thumb = thumbs_[entry.path];
+    thumb.last_shown = frame_;
+    visible.insert(entry.path);
+
+    ImGui::PushID(entry.path.c_str());
+    ImGui::BeginGroup();
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const ImVec2 cell(static_cast<float>(THUMB_SIZE), static_cast<float>(THUMB_SIZE));
+    if (ImGui::InvisibleButton("##thumb", cell) && on_open_) {
+        on_open_(CaptureCatalog::instance().full_path(entry));
+    }
+    const bool hovered = ImGui::IsItemHovered();
+
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    const ImVec2 cell_end(origin.x + cell.x, origin.y + cell.y);
+    draw_list->AddRectFilled(origin, cell_end, IM_COL32(30, 30, 30, 255));
+    if (thumb.state == ThumbState::READY) {
+        const float atlas = static_cast<float>(ATLAS_SIZE);
+        const float cx = static_cast<float>((thumb.cell % CELLS_PER_ROW) * THUMB_SIZE);
+        const float cy = static_cast<float>((thumb.cell / CELLS_PER_ROW) * THUMB_SIZE);
+        const ImVec2 p0(origin.x + (THUMB_SIZE - thumb.width) * 0.5f, origin.y + (THUMB_SIZE - thumb.height) * 0.5f);
+        draw_list->AddImage((void*)(intptr_t)texture_, p0, ImVec2(p0.x + thumb.width, p0.y + thumb.height),
+            ImVec2(cx / atlas, cy / atlas), ImVec2((cx + thumb.width) / atlas, (cy + thumb.height) / atlas));
+    } else if (thumb.state == ThumbState::FAILED) {
+        draw_list->AddText(ImVec2(origin.x + 8, origin.y + 8), IM_COL32(255, 100, 100, 255), "unreadable");
+    } else if (thumb.state == ThumbState::NONE && in_flight_ < max_in_flight_ &&
+               core::QosScheduler::instance().admit(core::QosScheduler::Work::Thumbnail)) {
+        request(entry);   // A shed request is asked again next frame
+    }
+    if (hovered) {
+        draw_list->AddRect(origin, cell_end, IM_COL32(255, 255, 0, 255));
+        const auto& m = entry.metadata;
+        ImGui::SetTooltip("%s\n%s\ndensity %.3f%%  active %d\nhpf %d  diff_on %d  diff_off %d  refr %d%s%s",
+            entry.path.c_str(), m.timestamp.c_str(), m.pixel_density, m.active_pixels,
+            m.bias_hpf, m.bias_diff_on, m.bias_diff_off, m.bias_refr,
+            m.comment.empty() ? "" : "\n", m.comment.c_str());
+    }
+
+    ImGui::Text("%.2f%%", entry.metadata.pixel_density);
+    ImGui::EndGroup();
+    ImGui::PopID();
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+void CaptureGallery::request(const CaptureCatalog::Entry& entry) {
+    auto& catalog = CaptureCatalog::instance();
+    const std::string source = catalog.full_path(entry);
+    const std::string thumb_file = (fs::path(catalog.directory()) / THUMB_DIRECTORY / thumb_name(entry.path)).string();
+    const int width = entry.metadata.image_width;
+    const int height = entry.metadata.image_height;
+    const std::string path = entry.path;
+
+    {
+        // Visible from now on, so the job is not skipped before this frame ends
+        std::lock_guard<std::mutex> lock(mutex_);
+        visible_.insert(path);
+    }
+    thumbs_[path].state = ThumbState::QUEUED;
+    ++in_flight_;
+    pool_->post([this, path, source, thumb_file, width, height] {
+        decode(path, source, thumb_file, width, height);
+    });
+}
+
+void CaptureGallery::decode(const std::string& path, const std::string& source, const std::string& thumb_file,
+                            int width, int height) {
+    Decoded result;
+    result.path = path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.skipped = visible_.count(path) == 0;
+    }
+
+    if (!result.skipped) {
+        PROFILE_ZONE("CaptureGallery::decode");
+        // The cached thumbnail is good while it is newer than its capture
+        std::error_code source_error, thumb_error;
+        const auto source_time = fs::last_write_time(source, source_error);
+        const auto thumb_time = fs::last_write_time(thumb_file, thumb_error);
+        if (!source_error && !thumb_error && thumb_time >= source_time) {
+            result.image = cv::imread(thumb_file, cv::IMREAD_GRAYSCALE);
+        }
+
+        if (result.image.empty() && !source_error) {
+            // Let the decoder shrink the image when it is several thumbnails wide
+            const int longest = std::max(width, height);
+            int flags = cv::IMREAD_GRAYSCALE;
+            if (longest >= 8 * THUMB_SIZE) {
+                flags = cv::IMREAD_REDUCED_GRAYSCALE_8;
+            } else if (longest >= 4 * THUMB_SIZE) {
+                flags = cv::IMREAD_REDUCED_GRAYSCALE_4;
+            } else if (longest >= 2 * THUMB_SIZE) {
+                flags = cv::IMREAD_REDUCED_GRAYSCALE_2;
+            }
+            cv::Mat decoded = cv::imread(source, flags);
+            if (!decoded.empty()) {
+                const double scale = std::min({1.0, static_cast<double>(THUMB_SIZE) / decoded.cols,
+                                               static_cast<double>(THUMB_SIZE) / decoded.rows});
+                const cv::Size size(std::max(1, static_cast<int>(std::lround(decoded.cols * scale))),
+                                    std::max(1, static_cast<int>(std::lround(decoded.rows * scale))));
+                cv::resize(decoded, result.image, size, 0, 0, cv::INTER_AREA);
+
+                std::error_code ec;
+                fs::create_directories(fs::path(thumb_file).parent_path(), ec);
+                cv::imwrite(thumb_file, result.image);   // Best effort: a read-only share just decodes again
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    results_.push_back(std::move(result));
+}
+
+// ============================================================================
+// Atlas
+// ============================================================================
+
+void CaptureGallery::place_results() {
+    std::vector<Decoded> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const size_t count = std::min<size_t>(results_.size(), MAX_RESULTS_PER_FRAME);
+        ready.assign(std::make_move_iterator(results_.begin()), std::make_move_iterator(results_.begin() + count));
+        results_.erase(results_.begin(), results_.begin() + count);
+    }
+
+    for (Decoded& result : ready) {
+        --in_flight_;
+        Thumb& thumb = thumbs_[result.path];
+        if (result.skipped) {
+            thumb.state = ThumbState::NONE;   // Decoded when it scrolls back into view
+            continue;
+        }
+        if (result.image.empty() || result.image.type() != CV_8UC1 ||
+            result.image.cols > THUMB_SIZE || result.image.rows > THUMB_SIZE) {
+            thumb.state = ThumbState::FAILED;
+            continue;
+        }
+        const int cell = acquire_cell();
+        if (cell < 0) {
+            thumb.state = ThumbState::NONE;
+            continue;
+        }
+
+        // Clear the whole cell so nothing of its previous owner bleeds in at the edges
+        const int x0 = (cell % CELLS_PER_ROW) * THUMB_SIZE;
+        const int y0 = (cell / CELLS_PER_ROW) * THUMB_SIZE;
+        for (int y = 0; y < THUMB_SIZE; ++y) {
+            uint8_t* row = atlas_.data() + static_cast<size_t>(y0 + y) * ATLAS_SIZE + x0;
+            std::fill(row, row + THUMB_SIZE, uint8_t(0));
+            if (y < result.image.rows) {
+                std::copy_n(result.image.ptr<uint8_t>(y), result.image.cols, row);
+            }
+        }
+        dirty_begin_ = std::min(dirty_begin_, y0);
+        dirty_end_ = std::max(dirty_end_, y0 + THUMB_SIZE);
+
+        cell_owner_[cell] = result.path;
+        thumb.cell = cell;
+        thumb.width = result.image.cols;
+        thumb.height = result.image.rows;
+        thumb.state = ThumbState::READY;
+    }
+}
+
+int CaptureGallery::acquire_cell() {
+    // Anything drawn last frame is still on screen and keeps its cell
+    int oldest = -1;
+    uint64_t oldest_shown = frame_ - 1;
+    for (int cell = 0; cell < ATLAS_CELLS; ++cell) {
+        if (cell_owner_[cell].empty()) {
+            return cell;
+        }
+        const uint64_t shown = thumbs_[cell_owner_[cell]].last_shown;
+        if (shown < oldest_shown) {
+            oldest_shown = shown;
+            oldest = cell;
+        }
+    }
+    if (oldest >= 0) {
+        Thumb& evicted = thumbs_[cell_owner_[oldest]];
+        evicted.state = ThumbState::NONE;
+        evicted.cell = -1;
+        cell_owner_[oldest].clear();
+    }
+    return oldest;
+}
+
+void CaptureGallery::upload_atlas() {
+    if (dirty_begin_ >= dirty_end_) {
+        return;
+    }
+    PROFILE_ZONE("CaptureGallery::upload_atlas");
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (texture_ == 0) {
+        glGenTextures(1, &texture_);
+        glBindTexture(GL_TEXTURE_2D, texture_);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        if (GLEW_VERSION_3_3 || GLEW_ARB_texture_swizzle) {
+            // One byte per pixel shown as gray
+            const GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+            texture_format_ = GL_RED;
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_SIZE, ATLAS_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, atlas_.data());
+        } else {
+            texture_format_ = GL_LUMINANCE;
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE8, ATLAS_SIZE, ATLAS_SIZE, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
+                         atlas_.data());
+        }
+    } else {
+        // One upload for every thumbnail placed since the last frame
+        glBindTexture(GL_TEXTURE_2D, texture_);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, dirty_begin_, ATLAS_SIZE, dirty_end_ - dirty_begin_,
+                        texture_format_, GL_UNSIGNED_BYTE, atlas_.data() + static_cast<size_t>(dirty_begin_) * ATLAS_SIZE);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    dirty_begin_ = ATLAS_SIZE;
+    dirty_end_ = 0;
+}
+
+} // namespace ui
@@ -6,10 +6,28 @@
 #include "ui/event_rate_chart.h"
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
 
 namespace ui {
 
+namespace {
+
+// Samples kept per level: 10 min at 100 ms, 1 h at 1 s, 24 h at 10 s
+constexpr size_t LEVEL_CAPACITY[] = {6000, 3600, 8640};
+
+} // namespace
+
 EventRateChart::EventRateChart() {
+    float period_s = UPDATE_INTERVAL_MS / 1000.0f;
+    for (int level = 0; level < LEVEL_COUNT; ++level) {
+        levels_[level].period_s = period_s;
+        levels_[level].capacity = LEVEL_CAPACITY[level];
+        levels_[level].values.assign(2 * LEVEL_CAPACITY[level], 0.0f);
+        period_s *= LEVEL_RATIO;
+    }
+    window_max_.is_max = true;
+    window_min_.is_max = false;
+
     last_update_time_ = std::chrono::steady_clock::now();
     last_chart_update_ = last_update_time_;
     // Initialize with default settings
@@ -17,6 +35,41 @@ EventRateChart::EventRateChart() {
     reset();
 }
 
+void EventRateChart::RateHistory::push(float value) {
+    const size_t slot = static_cast<size_t>(written % capacity);
+    values[slot] = value;
+    values[slot + capacity] = value;
+    ++written;
+}
+
+void EventRateChart::SlidingExtreme::reset(size_t capacity) {
+    samples.assign(capacity, 0);
+    head = 0;
+    count = 0;
+}
+
+void EventRateChart::SlidingExtreme::push(const RateHistory& history, uint64_t sample, size_t window) {
+    const size_t capacity = samples.size();
+    const float value = history.at(sample);
+
+    // Drop candidates the new sample dominates (from the back)
+    while (count > 0) {
+        const float back = history.at(samples[(head + count - 1) % capacity]);
+        if (is_max ? back > value : back < value) {
+            break;
+        }
+        --count;
+    }
+    samples[(head + count) % capacity] = sample;
+    ++count;
+
+    // Drop candidates that left the window (from the front)
+    while (samples[head] + window <= sample) {
+        head = (head + 1) % capacity;
+        --count;
+    }
+}
+
 void EventRateChart::update(uint64_t event_count) {
     auto now = std::chrono::steady_clock::now();
 
@@ -35,12 +88,19 @@ void EventRateChart::update(uint64_t event_count) {
         float time_seconds = time_diff / 1000.0f;
         current_rate_ = event_diff / time_seconds;
 
-        // Add data point
-        data_points_.push_back({now, current_rate_});
-
-        // Limit number of points
-        if (data_points_.size() > MAX_POINTS) {
-            data_points_.pop_front();
+        // Add data point, and roll averages up into the coarser levels
+        float value = current_rate_;
+        levels_[0].push(value);
+        for (int level = 1; level < LEVEL_COUNT; ++level) {
+            RateHistory& coarse = levels_[level];
+            coarse.pending_sum += value;
+            if (++coarse.pending_count < LEVEL_RATIO) {
+                break;
+            }
+            value = static_cast<float>(coarse.pending_sum / coarse.pending_count);
+            coarse.pending_sum = 0.0;
+            coarse.pending_count = 0;
+            coarse.push(value);
         }
     }
 
@@ -48,49 +108,39 @@ void EventRateChart::update(uint64_t event_count) {
     last_update_time_ = now;
     last_chart_update_ = now;
 
-    // Clean old points and update scaling
-    cleanup_old_points();
+    // Track window min/max and update scaling
+    update_extremes();
     update_scaling();
 }
 
 void EventRateChart::render(float width, float height) {
-    if (data_points_.empty()) {
+    size_t count = 0;
+    const RateHistory& history = levels_[select_level(count)];
+    if (count == 0) {
         ImGui::Text("No event data");
         return;
     }
 
-    // Prepare data for plotting
-    std::vector<float> values;
-    values.reserve(data_points_.size());
-
-    for (const auto& point : data_points_) {
-        values.push_back(point.rate);
-    }
-
     // Calculate time range
-    auto now = std::chrono::steady_clock::now();
-    float time_range = 0.0f;
-    if (data_points_.size() > 1) {
-        auto time_diff = std::chrono::duration_cast<std::chrono::milliseconds>(
-            data_points_.back().timestamp - data_points_.front().timestamp).count();
-        time_range = time_diff / 1000.0f;
-    }
+    const float time_range = count * history.period_s;
 
     // Format overlay text
     char overlay_text[256];
     snprintf(overlay_text, sizeof(overlay_text),
-             "Rate: %.1f kev/s | Time: %.1fs | Scale: %.1f kev/s",
+             "Rate: %.1f kev/s | Time: %.0fs | Min/Max: %.1f/%.1f | Scale: %.1f kev/s",
              current_rate_ / 1000.0f,
              std::min(time_range, settings_.time_window),
+             window_min_.value(history) / 1000.0f,
+             window_max_.value(history) / 1000.0f,
              y_scale_ / 1000.0f);
 
-    // Draw the plot
+    // Draw the plot (newest samples are contiguous, no copy)
     ImGui::PushStyleColor(ImGuiCol_PlotLines, ImVec4(0.0f, 1.0f, 0.0f, 1.0f));
     ImGui::PushStyleColor(ImGuiCol_PlotLinesHovered, ImVec4(0.0f, 1.0f, 0.0f, 1.0f));
 
     ImGui::PlotLines("##EventRate",
-                     values.data(),
-                     static_cast<int>(values.size()),
+                     history.newest(count),
+                     static_cast<int>(count),
                      0,
                      overlay_text,
                      0.0f,
@@ -124,7 +174,17 @@ void EventRateChart::render(float width, float height) {
 }
 
 void EventRateChart::reset() {
-    data_points_.clear();
+    for (auto& level : levels_) {
+        level.written = 0;
+        level.pending_sum = 0.0;
+        level.pending_count = 0;
+    }
+    extremes_level_ = -1;  // Rebuilt on next update
+    extremes_window_ = 0;
+    extremes_next_ = 0;
+    window_max_.count = 0;
+    window_min_.count = 0;
+
     last_event_count_ = 0;
     current_rate_ = 0.0f;
     max_rate_ = settings_.min_rate;
@@ -134,33 +194,49 @@ void EventRateChart::reset() {
     last_chart_update_ = last_update_time_;
 }
 
-void EventRateChart::cleanup_old_points() {
-    auto now = std::chrono::steady_clock::now();
+int EventRateChart::select_level(size_t& window) const {
+    int level = 0;
+    while (level < LEVEL_COUNT - 1 &&
+           levels_[level].capacity * levels_[level].period_s < settings_.time_window) {
+        ++level;
+    }
 
-    // Remove points older than configured time window
-    while (!data_points_.empty()) {
-        auto age = std::chrono::duration_cast<std::chrono::seconds>(
-            now - data_points_.front().timestamp).count();
+    const RateHistory& history = levels_[level];
+    const size_t wanted = static_cast<size_t>(std::ceil(settings_.time_window / history.period_s));
+    window = std::min({std::max<size_t>(wanted, 1), history.capacity, history.size()});
+    return level;
+}
 
-        if (age > settings_.time_window) {
-            data_points_.pop_front();
-        } else {
-            break;
-        }
+void EventRateChart::update_extremes() {
+    size_t window = 0;
+    const int level = select_level(window);
+    const RateHistory& history = levels_[level];
+    const size_t wanted = static_cast<size_t>(std::ceil(settings_.time_window / history.period_s));
+    const size_t span = std::min(std::max<size_t>(wanted, 1), history.capacity);
+
+    // Different level or window length: rebuild from the samples in view
+    if (level != extremes_level_ || span != extremes_window_) {
+        extremes_level_ = level;
+        extremes_window_ = span;
+        window_max_.reset(history.capacity);
+        window_min_.reset(history.capacity);
+        extremes_next_ = history.written - window;
+    }
+
+    for (; extremes_next_ < history.written; ++extremes_next_) {
+        window_max_.push(history, extremes_next_, extremes_window_);
+        window_min_.push(history, extremes_next_, extremes_window_);
     }
 }
 
 void EventRateChart::update_scaling() {
-    if (data_points_.empty()) {
+    if (levels_[0].written == 0) {
         return;
     }
 
     if (settings_.autoscale) {
-        // Find maximum rate in current data
-        float current_max = settings_.min_rate;
-        for (const auto& point : data_points_) {
-            current_max = std::max(current_max, point.rate);
-        }
+        // Maximum rate in the time window
+        float current_max = std::max(settings_.min_rate, window_max_.value(levels_[extremes_level_]));
 
         // Add 20% headroom
         y_scale_target_ = current_max * 1.2f;
@@ -184,4 +260,4 @@ void EventRateChart::update_scaling() {
     }
 }
 
-} // namespace ui
\ No newline at end of file
+} // namespace ui
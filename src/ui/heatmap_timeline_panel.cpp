@@ -0,0 +1,169 @@
+/**
+ * @file heatmap_timeline_panel.cpp
+ * @brief Scrubbing through the scattering heatmap timeline of a run
+ */
+
+#include "ui/heatmap_timeline_panel.h"
+#include "core/profiler.h"
+#include "imgui.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace ui {
+
+HeatmapTimelinePanel::HeatmapTimelinePanel(std::string directory)
+    : directory_(std::move(directory)) {
+}
+
+HeatmapTimelinePanel::~HeatmapTimelinePanel() = default;
+
+void HeatmapTimelinePanel::render(bool* open) {
+    if (!*open) {
+        return;
+    }
+    PROFILE_ZONE("HeatmapTimelinePanel::render");
+
+    // First opening: the newest run
+    if (path_.empty() && error_.empty()) {
+        const std::string latest = latest_timeline();
+        if (latest.empty() || !open_timeline(latest)) {
+            error_ = "No heatmap timeline in " + (directory_.empty() ? std::string(".") : directory_);
+        }
+    }
+
+    ImGui::SetNextWindowSize(ImVec2(800, 650), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Heatmap Timeline", open)) {
+        static char path_buffer[512] = "";
+        std::snprintf(path_buffer, sizeof(path_buffer), "%s", path_.c_str());
+        ImGui::PushItemWidth(450);
+        const bool submitted = ImGui::InputText("##TimelinePath", path_buffer, sizeof(path_buffer),
+            ImGuiInputTextFlags_EnterReturnsTrue);
+        ImGui::PopItemWidth();
+        ImGui::SameLine();
+        if (ImGui::Button("Open") || submitted) {
+            if (!open_timeline(path_buffer)) {
+                error_ = std::string("Cannot read ") + path_buffer;
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Latest")) {
+            const std::string latest = latest_timeline();
+            if (latest.empty() || !open_timeline(latest)) {
+                error_ = "No heatmap timeline in " + (directory_.empty() ? std::string(".") : directory_);
+            }
+        }
+
+        if (!error_.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", error_.c_str());
+        }
+
+        if (timeline_.is_open() && timeline_.size() > 0) {
+            const int last = static_cast<int>(timeline_.size()) - 1;
+            if (ImGui::ArrowButton("##TimelinePrev", ImGuiDir_Left)) {
+                index_ = std::max(index_ - 1, 0);
+            }
+            ImGui::SameLine();
+            ImGui::PushItemWidth(-80);
+            ImGui::SliderInt("##TimelineIndex", &index_, 0, last, "Snapshot %d");
+            ImGui::PopItemWidth();
+            ImGui::SameLine();
+            if (ImGui::ArrowButton("##TimelineNext", ImGuiDir_Right)) {
+                index_ = std::min(index_ + 1, last);
+            }
+            ImGui::SameLine();
+            if (ImGui::Checkbox("Fixed", &fixed_scale_)) {
+                shown_index_ = -1;   // Recolour
+            }
+            ImGui::SetItemTooltip("Scale colours to the highest count of the whole run instead of this snapshot");
+            show(index_);
+
+            const HeatmapTimeline::Snapshot& snapshot = timeline_.snapshot(static_cast<size_t>(index_));
+            ImGui::Text("t = %.0f s, %lld frames, %d scattering px, max %d (%u changed%s)",
+                        (snapshot.unix_ms - timeline_.start_unix_ms()) / 1000.0,
+                        static_cast<long long>(snapshot.frames_analyzed), scattering_pixels_, max_count_,
+                        snapshot.changed_pixels, snapshot.keyframe ? ", keyframe" : "");
+
+            if (texture_ && texture_->get_texture_id() != 0) {
+                const float avail = ImGui::GetContentRegionAvail().x;
+                const float scale = avail / static_cast<float>(timeline_.width());
+                ImGui::Image((void*)(intptr_t)texture_->get_texture_id(),
+                             ImVec2(avail, timeline_.height() * scale));
+            }
+        } else if (timeline_.is_open()) {
+            ImGui::TextDisabled("No snapshots yet");
+        }
+    }
+    ImGui::End();
+}
+
+bool HeatmapTimelinePanel::open_timeline(const std::string& path) {
+    if (!timeline_.open(path)) {
+        return false;
+    }
+    path_ = path;
+    error_.clear();
+    shown_index_ = -1;
+    index_ = timeline_.size() > 0 ? static_cast<int>(timeline_.size()) - 1 : 0;
+
+    // Counts only grow between resets, so the last snapshot bounds the fixed scale
+    final_max_ = 0;
+    if (timeline_.size() > 0 && timeline_.reconstruct(timeline_.size() - 1, counts_)) {
+        double max_value = 0.0;
+        cv::minMaxLoc(counts_, nullptr, &max_value);
+        final_max_ = static_cast<int32_t>(max_value);
+    }
+    return true;
+}
+
+std::string HeatmapTimelinePanel::latest_timeline() const {
+    std::error_code ec;
+    fs::path newest;
+    fs::file_time_type newest_time{};
+    const fs::path dir = directory_.empty() ? fs::path(".") : fs::path(directory_);
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() != heatmap_timeline::EXTENSION) {
+            continue;
+        }
+        const fs::file_time_type time = fs::last_write_time(it->path(), ec);
+        if (!ec && (newest.empty() || time > newest_time)) {
+            newest = it->path();
+            newest_time = time;
+        }
+    }
+    return newest.string();
+}
+
+void HeatmapTimelinePanel::show(int index) {
+    if (index == shown_index_) {
+        return;
+    }
+    if (!timeline_.reconstruct(static_cast<size_t>(index), counts_)) {
+        error_ = "Snapshot " + std::to_string(index) + " is corrupt";
+        shown_index_ = index;
+        return;
+    }
+    shown_index_ = index;
+
+    double max_value = 0.0;
+    cv::minMaxLoc(counts_, nullptr, &max_value);
+    max_count_ = static_cast<int32_t>(max_value);
+    scattering_pixels_ = cv::countNonZero(counts_);
+
+    // Same colouring as ScatteringAnalyzer::create_heatmap_visualization
+    const int32_t scale_max = fixed_scale_ ? std::max(final_max_, max_count_) : max_count_;
+    cv::Mat normalized;
+    counts_.convertTo(normalized, CV_8UC1, scale_max > 0 ? 255.0 / scale_max : 0.0);
+    cv::applyColorMap(normalized, heatmap_, cv::COLORMAP_JET);
+    heatmap_.setTo(cv::Scalar::all(0), counts_ == 0);
+
+    if (!texture_) {
+        texture_ = std::make_unique<video::TextureManager>();
+    }
+    texture_->upload_frame(heatmap_);
+}
+
+} // namespace ui
@@ -5,6 +5,8 @@
 
 #include "ui/image_dialog.h"
 #include "app_config.h"
+#include "image_cache.h"
+#include "image_save_queue.h"
 #include "imgui.h"
 #include <iostream>
 #include <opencv2/imgproc.hpp>
@@ -134,6 +136,53 @@ bool ImageDialog::show_load_dialog(
         ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f),
             "Click Browse to select a file, or enter the full path manually");
 
+        // Search the capture catalog instead of browsing
+        auto& catalog = CaptureCatalog::instance();
+        if (catalog.is_open()) {
+            ImGui::Separator();
+            ImGui::Text("Search captures (%zu indexed%s):", catalog.size(),
+                catalog.is_backfilling() ? ", scanning" : "");
+            ImGui::PushItemWidth(400);
+            static char query_buffer[256] = "";
+            strncpy_s(query_buffer, sizeof(query_buffer), state.query.c_str(), sizeof(query_buffer) - 1);
+            std::string query_id = "##Query_" + dialog_id;
+            const bool submitted = ImGui::InputText(query_id.c_str(), query_buffer, sizeof(query_buffer),
+                ImGuiInputTextFlags_EnterReturnsTrue);
+            state.query = query_buffer;
+            ImGui::PopItemWidth();
+            ImGui::SameLine();
+            if (ImGui::Button("Search") || submitted) {
+                CaptureCatalog::Query query;
+                if (CaptureCatalog::Query::parse(state.query, query, state.query_error)) {
+                    state.matches = catalog.find(query, MAX_SEARCH_RESULTS);
+                } else {
+                    state.matches.clear();
+                }
+            }
+            ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f),
+                "e.g. bias_hpf=100 pixel_density>2%% comment~\"hot pixel\"");
+
+            if (!state.query_error.empty()) {
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Cannot parse: %s", state.query_error.c_str());
+            } else if (!state.matches.empty()) {
+                std::string list_id = "##Matches_" + dialog_id;
+                if (ImGui::BeginListBox(list_id.c_str(), ImVec2(400, 160))) {
+                    for (const auto& entry : state.matches) {
+                        const std::string path = catalog.full_path(entry);
+                        char label[512];
+                        snprintf(label, sizeof(label), "%s  %.2f%%  hpf %d", entry.path.c_str(),
+                            entry.metadata.pixel_density, entry.metadata.bias_hpf);
+                        if (ImGui::Selectable(label, state.filepath == path)) {
+                            state.filepath = path;
+                        }
+                    }
+                    ImGui::EndListBox();
+                }
+                ImGui::Text("%zu match%s (newest first)", state.matches.size(),
+                    state.matches.size() == 1 ? "" : "es");
+            }
+        }
+
         ImGui::Separator();
 
         // Load button
@@ -141,7 +190,7 @@ bool ImageDialog::show_load_dialog(
             if (!state.filepath.empty()) {
                 std::cout << "Attempting to load: " << state.filepath << std::endl;
 
-                if (ImageManager::load_image(state.filepath, result.metadata, result.image)) {
+                if (ImageCache::instance().load(state.filepath, result.metadata, result.image)) {
                     std::cout << "Image loaded successfully" << std::endl;
                     std::cout << "  Size: " << result.image.cols << "x" << result.image.rows << std::endl;
                     std::cout << "  Channels: " << result.image.channels() << std::endl;
@@ -261,27 +310,14 @@ bool ImageDialog::show_save_dialog(
                     // Create metadata with user comment
                     auto metadata = ImageManager::create_metadata(image_to_save, state.comment);
 
-                    // Try to write the image directly to the specified path
-                    try {
-                        if (cv::imwrite(state.filepath, image_to_save)) {
-                            saved_path = state.filepath;
-                            std::cout << "Image saved: " << saved_path << std::endl;
-
-                            // Save metadata JSON alongside the image
-                            std::string json_path = state.filepath.substr(0, state.filepath.find_last_of('.')) + ".json";
-                            if (ImageManager::save_metadata_json(json_path, metadata)) {
-                                std::cout << "Metadata saved: " << json_path << std::endl;
-                            } else {
-                                std::cerr << "Warning: Failed to save metadata JSON" << std::endl;
-                            }
-
-                            saved_this_frame = true;
-                            state.reset();  // Clear for next use
-                        } else {
-                            std::cerr << "Failed to save image to: " << state.filepath << std::endl;
-                        }
-                    } catch (const std::exception& e) {
-                        std::cerr << "Error saving image: " << e.what() << std::endl;
+                    // Encode and write on the I/O thread; the FrameRef shares the
+                    // pixels, which producers never overwrite while referenced
+                    if (ImageSaveQueue::instance().submit(video::FrameRef(image_to_save), state.filepath, metadata)) {
+                        saved_path = state.filepath;
+                        saved_this_frame = true;
+                        state.reset();  // Clear for next use
+                    } else {
+                        std::cerr << "Failed to queue image for saving: " << state.filepath << std::endl;
                     }
                 } else {
                     std::cerr << "No filepath specified" << std::endl;
@@ -1,13 +1,14 @@
 #include "ui/settings_panel.h"
 #include "core/app_state.h"
 #include "camera_manager.h"
+#include "image_save_queue.h"
 #include "camera/features/trail_filter_feature.h"
 #include "camera/features/erc_feature.h"
 #include "camera/features/antiflicker_feature.h"
+#include "camera/control_queue.h"
 #include <imgui.h>
 #include <iostream>
 #include <chrono>
-#include <opencv2/imgcodecs.hpp>
 #include <iomanip>
 #include <sstream>
 #include <cmath>
@@ -509,21 +510,12 @@ void SettingsPanel::capture_frame() {
         video::FrameRef frame_ref = state_.texture_manager(i).get_last_frame();
 
         if (!frame_ref.empty()) {
-            // Extract cv::Mat for saving
-            video::ReadGuard guard(frame_ref);
-            cv::Mat frame = guard.get().clone();
+            // Hand the frame itself to the I/O thread (no clone, no encode here)
             std::string full_path = base_path + filename_base + suffixes[i] + ".png";
-            std::cout << "Attempting to save Camera " << i << " to: " << full_path << std::endl;
-
-            try {
-                bool success = cv::imwrite(full_path, frame);
-                if (success) {
-                    std::cout << "Camera " << i << " frame captured successfully: " << full_path << std::endl;
-                } else {
-                    std::cerr << "cv::imwrite returned false - failed to save Camera " << i << ": " << full_path << std::endl;
-                }
-            } catch (const std::exception& e) {
-                std::cerr << "Exception while capturing frame from Camera " << i << ": " << e.what() << std::endl;
+            if (ImageSaveQueue::instance().submit(std::move(frame_ref), full_path)) {
+                std::cout << "Camera " << i << " frame queued for saving: " << full_path << std::endl;
+            } else {
+                std::cerr << "Failed to queue Camera " << i << " frame: " << full_path << std::endl;
             }
         } else {
             std::cout << "No frame available to capture from Camera " << i << " (frame is empty)" << std::endl;
@@ -605,53 +597,64 @@ void SettingsPanel::apply_digital_features_to_all_cameras() {
     std::cout << "Applying digital features to all cameras..." << std::endl;
     state_.feature_manager().apply_all_settings();
 
-    // Now we need to manually copy the same settings to other cameras
-    // Get Camera 0's feature states
-    auto& cam0 = state_.camera_state().camera_manager()->get_camera(0);
+    // Now we need to manually copy the same settings to other cameras.
+    // Queued behind the writes above, so Camera 0 already holds the new state.
+    CameraManager* cam_mgr = state_.camera_state().camera_manager();
     int num_cameras = state_.camera_state().num_cameras();
 
-    for (int i = 1; i < num_cameras; ++i) {
-        auto& cam = state_.camera_state().camera_manager()->get_camera(i);
-        std::cout << "Syncing features from Camera 0 to Camera " << i << "..." << std::endl;
-
-        // Sync Trail Filter
-        auto* trail_filter_src = cam0.camera->get_device().get_facility<Metavision::I_EventTrailFilterModule>();
-        auto* trail_filter_dst = cam.camera->get_device().get_facility<Metavision::I_EventTrailFilterModule>();
-        if (trail_filter_src && trail_filter_dst) {
-            try {
-                trail_filter_dst->set_type(trail_filter_src->get_type());
-                trail_filter_dst->set_threshold(trail_filter_src->get_threshold());
-                trail_filter_dst->enable(trail_filter_src->is_enabled());
-                std::cout << "  Trail Filter synced to Camera " << i << std::endl;
-            } catch (const std::exception& e) {
-                std::cerr << "  Failed to sync Trail Filter to Camera " << i << ": " << e.what() << std::endl;
-            }
+    EventCamera::ControlQueue::instance().post("features.sync", [cam_mgr, num_cameras] {
+        if (!cam_mgr->is_camera_connected(0)) {
+            return;
         }
+        // Get Camera 0's feature states
+        auto& cam0 = cam_mgr->get_camera(0);
 
-        // Sync ERC
-        auto* erc_src = cam0.camera->get_device().get_facility<Metavision::I_ErcModule>();
-        auto* erc_dst = cam.camera->get_device().get_facility<Metavision::I_ErcModule>();
-        if (erc_src && erc_dst) {
-            try {
-                erc_dst->enable(erc_src->is_enabled());
-                std::cout << "  ERC synced to Camera " << i << std::endl;
-            } catch (const std::exception& e) {
-                std::cerr << "  Failed to sync ERC to Camera " << i << ": " << e.what() << std::endl;
+        for (int i = 1; i < num_cameras; ++i) {
+            if (!cam_mgr->is_camera_connected(i)) {
+                continue;
+            }
+            auto& cam = cam_mgr->get_camera(i);
+            std::cout << "Syncing features from Camera 0 to Camera " << i << "..." << std::endl;
+
+            // Sync Trail Filter
+            auto* trail_filter_src = cam0.camera->get_device().get_facility<Metavision::I_EventTrailFilterModule>();
+            auto* trail_filter_dst = cam.camera->get_device().get_facility<Metavision::I_EventTrailFilterModule>();
+            if (trail_filter_src && trail_filter_dst) {
+                try {
+                    trail_filter_dst->set_type(trail_filter_src->get_type());
+                    trail_filter_dst->set_threshold(trail_filter_src->get_threshold());
+                    trail_filter_dst->enable(trail_filter_src->is_enabled());
+                    std::cout << "  Trail Filter synced to Camera " << i << std::endl;
+                } catch (const std::exception& e) {
+                    std::cerr << "  Failed to sync Trail Filter to Camera " << i << ": " << e.what() << std::endl;
+                }
+            }
+
+            // Sync ERC
+            auto* erc_src = cam0.camera->get_device().get_facility<Metavision::I_ErcModule>();
+            auto* erc_dst = cam.camera->get_device().get_facility<Metavision::I_ErcModule>();
+            if (erc_src && erc_dst) {
+                try {
+                    erc_dst->enable(erc_src->is_enabled());
+                    std::cout << "  ERC synced to Camera " << i << std::endl;
+                } catch (const std::exception& e) {
+                    std::cerr << "  Failed to sync ERC to Camera " << i << ": " << e.what() << std::endl;
+                }
             }
-        }
 
-        // Sync Anti-Flicker
-        auto* antiflicker_src = cam0.camera->get_device().get_facility<Metavision::I_AntiFlickerModule>();
-        auto* antiflicker_dst = cam.camera->get_device().get_facility<Metavision::I_AntiFlickerModule>();
-        if (antiflicker_src && antiflicker_dst) {
-            try {
-                antiflicker_dst->enable(antiflicker_src->is_enabled());
-                std::cout << "  Anti-Flicker synced to Camera " << i << std::endl;
-            } catch (const std::exception& e) {
-                std::cerr << "  Failed to sync Anti-Flicker to Camera " << i << ": " << e.what() << std::endl;
+            // Sync Anti-Flicker
+            auto* antiflicker_src = cam0.camera->get_device().get_facility<Metavision::I_AntiFlickerModule>();
+            auto* antiflicker_dst = cam.camera->get_device().get_facility<Metavision::I_AntiFlickerModule>();
+            if (antiflicker_src && antiflicker_dst) {
+                try {
+                    antiflicker_dst->enable(antiflicker_src->is_enabled());
+                    std::cout << "  Anti-Flicker synced to Camera " << i << std::endl;
+                } catch (const std::exception& e) {
+                    std::cerr << "  Failed to sync Anti-Flicker to Camera " << i << ": " << e.what() << std::endl;
+                }
             }
         }
-    }
+    });
 }
 
 } // namespace ui
@@ -5,12 +5,18 @@
 
 #include "ui/viewer_panel.h"
 #include "app_config.h"
+#include "image_cache.h"
 #include "imgui.h"
 #include "core/app_state.h"
 #include "camera_manager.h"
+#include "camera/control_queue.h"
+#include "core/metrics.h"
 #include <metavision/hal/facilities/i_ll_biases.h>
 #include <metavision/hal/facilities/i_event_trail_filter_module.h>
 #include <metavision/hal/facilities/i_erc_module.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -23,6 +29,47 @@ extern std::unique_ptr<core::AppState> app_state;
 
 namespace ui {
 
+namespace {
+
+/**
+ * Latest SNR figures for the metrics exporters
+ */
+void publish_noise_metrics(const NoiseAnalysisResults& results) {
+    auto& registry = core::MetricsRegistry::instance();
+    static core::Gauge& snr = registry.gauge("noise.snr_db");
+    static core::Gauge& contrast = registry.gauge("noise.contrast_ratio");
+    static core::Gauge& dots = registry.gauge("noise.dots");
+    snr.set(results.snr_db);
+    contrast.set(results.contrast_ratio);
+    dots.set(results.num_dots_detected);
+}
+
+void publish_tracking_metrics(const NoiseAnalysisResults& results) {
+    auto& registry = core::MetricsRegistry::instance();
+    static core::Gauge& tracked = registry.gauge("noise.dots_tracked");
+    static core::Gauge& drift_mean = registry.gauge("noise.drift_mean_px");
+    static core::Gauge& drift_max = registry.gauge("noise.drift_max_px");
+    static core::Counter& redetections = registry.counter("noise.redetections");
+    tracked.set(results.num_dots_tracked);
+    drift_mean.set(results.mean_drift_px);
+    drift_max.set(results.max_drift_px);
+    if (results.redetected) {
+        redetections.add();
+    }
+}
+
+/**
+ * Dot and background masks as pixel classes of the inter-event interval histograms
+ */
+void publish_interval_classes(const NoiseAnalyzer& analyzer) {
+    auto& cam_mgr = CameraManager::instance();
+    if (cam_mgr.num_pipelines() > 0) {
+        cam_mgr.event_intervals().set_class_masks(analyzer.getSignalMask(), analyzer.getNoiseMask());
+    }
+}
+
+} // namespace
+
 // ============================================================================
 // Constructor / Destructor
 // ============================================================================
@@ -93,10 +140,20 @@ void ViewerPanel::render(const cv::Mat& camera_frame, GLuint camera_texture_id,
     // Mode controls (dropdown, buttons)
     render_mode_controls();
 
+    // Paused: the scrubbed history frame stands in for the live one (display, analysis, save)
+    const bool history = mode_ == ViewerMode::ACTIVE_CAMERA && history_paused_ && history_texture_ &&
+                         !history_frame_.empty();
+    const cv::Mat& frame = history ? history_frame_ : camera_frame;
+    if (history) {
+        camera_texture_id = history_texture_->get_texture_id();
+        camera_width = history_frame_.cols;
+        camera_height = history_frame_.rows;
+    }
+
     ImGui::Separator();
 
     // Display image
-    render_image(camera_frame, camera_texture_id, camera_width, camera_height);
+    render_image(frame, camera_texture_id, camera_width, camera_height);
 
     // Event rate chart (only show for camera mode)
     if (mode_ == ViewerMode::ACTIVE_CAMERA && event_chart_) {
@@ -110,7 +167,7 @@ void ViewerPanel::render(const cv::Mat& camera_frame, GLuint camera_texture_id,
 
     // Noise analysis section
     ImGui::Separator();
-    render_noise_analysis(camera_frame);
+    render_noise_analysis(frame);
 
     // Filters section
     ImGui::Separator();
@@ -118,7 +175,7 @@ void ViewerPanel::render(const cv::Mat& camera_frame, GLuint camera_texture_id,
 
     // Handle dialogs
     handle_load_dialog();
-    handle_save_dialog(camera_frame);
+    handle_save_dialog(frame);
 
     // Render focus adjust window if open
     render_focus_adjust_window();
@@ -159,8 +216,173 @@ void ViewerPanel::render_mode_controls() {
             mode_ = ViewerMode::ACTIVE_CAMERA;
             loaded_image_ = cv::Mat();
             texture_.reset();
+            compare_loaded_bits_ = video::BinaryFrame();
+            compare_loaded_ = false;
             selected_mode_index_ = 0;
         }
+
+        // Step through the captures in the loaded image's directory (also Left / Right arrow)
+        const bool focused = ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) &&
+                             !ImGui::GetIO().WantTextInput;
+        if (ImGui::Button("< Prev") || (focused && ImGui::IsKeyPressed(ImGuiKey_LeftArrow))) {
+            step_loaded_image(-1);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Next >") || (focused && ImGui::IsKeyPressed(ImGuiKey_RightArrow))) {
+            step_loaded_image(1);
+        }
+    }
+
+    // Live frame over the loaded image
+    if (mode_ == ViewerMode::ACTIVE_CAMERA && !compare_loaded_bits_.empty()) {
+        ImGui::Checkbox("Compare with Loaded Image", &compare_loaded_);
+        ImGui::SetItemTooltip("Overlay the live frame on the loaded image: both white, live only green, loaded only red");
+    }
+
+    if (mode_ == ViewerMode::ACTIVE_CAMERA) {
+        render_history_controls();
+    }
+}
+
+void ViewerPanel::render_history_controls() {
+    auto& history = app_state->frame_history(0);
+    pump_history_export();
+    if (!history.is_enabled() && !history_paused_) {
+        return;  // history_s = 0 or released by the memory budget
+    }
+
+    if (ImGui::Button(history_paused_ ? "Live" : "Pause")) {
+        history_paused_ = !history_paused_;
+        history.freeze(history_paused_);
+        history_index_ = history.get_frame_count() - 1;  // Start at the newest frame
+        history_shown_ = -1;
+        if (!history_paused_) {
+            history_frame_.release();
+            if (history_export_ && history_export_next_ < history_export_count_) {
+                // Indices move once recording resumes: keep what is queued
+                history_export_count_ = history_export_next_;
+                history_export_->finish();
+            }
+        }
+    }
+    ImGui::SetItemTooltip("Freeze the last seconds of frames and step back through them (Left / Right arrow)");
+
+    if (!history_paused_) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("History: %d frames (%.1f MiB)", history.get_frame_count(),
+                            history.get_stored_bytes() / (1024.0 * 1024.0));
+        return;
+    }
+
+    const int count = history.get_frame_count();
+    if (count == 0) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.0f, 1.0f), "History is empty");
+        return;
+    }
+
+    const bool focused = ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) &&
+                         !ImGui::GetIO().WantTextInput;
+    ImGui::SameLine();
+    if (ImGui::Button("<") || (focused && ImGui::IsKeyPressed(ImGuiKey_LeftArrow))) {
+        --history_index_;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button(">") || (focused && ImGui::IsKeyPressed(ImGuiKey_RightArrow))) {
+        ++history_index_;
+    }
+    ImGui::SameLine();
+    ImGui::PushItemWidth(200);
+    std::string slider_id = "##History_" + name_;
+    ImGui::SliderInt(slider_id.c_str(), &history_index_, 0, count - 1);
+    ImGui::PopItemWidth();
+    history_index_ = std::clamp(history_index_, 0, count - 1);
+
+    // Sensor time relative to the newest frame
+    ImGui::SameLine();
+    const int64_t offset_us = history.get_timestamp(history_index_) - history.get_timestamp(count - 1);
+    ImGui::Text("%d / %d  %.1f ms", history_index_ + 1, count, offset_us / 1000.0);
+
+    ImGui::SameLine();
+    if (history_export_) {
+        ImGui::Text("Exporting %lld / %d", static_cast<long long>(history_export_->get_written()),
+                    history_export_count_);
+    } else if (ImGui::Button("Export Video")) {
+        start_history_export();
+    }
+    ImGui::SetItemTooltip("Encode every history frame into a lossless (FFV1) video in the capture directory");
+    if (!history_export_status_.empty()) {
+        ImGui::TextDisabled("%s", history_export_status_.c_str());
+    }
+
+    if (history_index_ != history_shown_) {
+        history_frame_.release();  // The texture keeps a reference to the frame it shows
+        if (history.decode(history_index_, history_frame_)) {
+            app_state->texture_cache().acquire(history_texture_, video::FrameRef(history_frame_));
+            history_shown_ = history_index_;
+        }
+    }
+}
+
+void ViewerPanel::start_history_export() {
+    auto& history = app_state->frame_history(0);
+    const int count = history.get_frame_count();
+    if (count == 0) {
+        return;
+    }
+
+    // Nominal rate from the mean frame interval; exact times go to the sidecar
+    const int64_t span_us = history.get_timestamp(count - 1) - history.get_timestamp(0);
+    const double fps = (count > 1 && span_us > 0) ? (count - 1) * 1e6 / span_us : 30.0;
+    const std::filesystem::path path = std::filesystem::path(AppConfig::instance().camera_settings().capture_directory) /
+        ("history_" + ImageManager::generate_timestamp() + ".mkv");
+
+    auto exporter = std::make_unique<video::VideoExporter>();
+    if (!exporter->open(path.string(), history.get_size(), fps)) {
+        history_export_status_ = "Export failed: " + exporter->get_error();
+        return;
+    }
+    history_export_ = std::move(exporter);
+    history_export_next_ = 0;
+    history_export_count_ = count;
+    history_export_status_.clear();
+}
+
+void ViewerPanel::pump_history_export() {
+    if (!history_export_) {
+        return;
+    }
+
+    auto& history = app_state->frame_history(0);
+    const auto start = std::chrono::steady_clock::now();
+    while (history_export_next_ < history_export_count_ &&
+           std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() <
+               HISTORY_EXPORT_BUDGET_MS) {
+        if (!history.decode(history_export_next_, history_export_frame_)) {
+            history_export_count_ = history_export_next_;   // History dropped meanwhile
+            break;
+        }
+        if (!history_export_->push(history_export_frame_, history.get_timestamp(history_export_next_), false)) {
+            break;   // Encoder queue full: the same frame is retried next UI frame
+        }
+        ++history_export_next_;
+    }
+    if (history_export_next_ >= history_export_count_) {
+        history_export_->finish();
+    }
+
+    if (history_export_->is_done()) {
+        char status[512];
+        if (history_export_->close()) {
+            std::snprintf(status, sizeof(status), "Video saved: %s (%lld frames, %.1fx real time)",
+                          history_export_->get_path().c_str(),
+                          static_cast<long long>(history_export_->get_written()), history_export_->get_speed());
+        } else {
+            std::snprintf(status, sizeof(status), "Export failed: %s", history_export_->get_error().c_str());
+        }
+        history_export_status_ = status;
+        history_export_.reset();
+        history_export_frame_.release();
     }
 }
 
@@ -192,13 +414,24 @@ void ViewerPanel::render_image(const cv::Mat& camera_frame, GLuint camera_tex_id
                 img_size.x = img_size.y * aspect_ratio;
             }
 
-            ImGui::Image((void*)(intptr_t)tex_id, img_size);
+            render_zoomable_image(tex_id, loaded_image_.cols, loaded_image_.rows, img_size, loaded_image_);
         } else {
             ImGui::TextColored(ImVec4(1, 1, 0, 1), "Preparing texture...");
         }
     } else if (mode_ == ViewerMode::ACTIVE_CAMERA) {
         // Show live camera feed with aspect ratio preserved
         if (camera_tex_id > 0 && cam_width > 0 && cam_height > 0) {
+            // Leave room for the projections when a profile matches this image; they
+            // cover the whole sensor, so they are hidden while zoomed in or paused
+            const bool profile = show_activity_profile_ && view_zoom_ == 1.0f && !history_paused_ &&
+                                 CameraManager::instance().activity().get_snapshot(activity_) &&
+                                 activity_.width == cam_width && activity_.height == cam_height;
+            if (profile) {
+                const float spacing = ImGui::GetStyle().ItemSpacing.x;
+                available_size.x = std::max(1.0f, available_size.x - PROFILE_STRIP - spacing);
+                available_size.y = std::max(1.0f, available_size.y - PROFILE_STRIP - spacing);
+            }
+
             // Calculate proper size maintaining aspect ratio
             float img_width = static_cast<float>(cam_width);
             float img_height = static_cast<float>(cam_height);
@@ -214,7 +447,36 @@ void ViewerPanel::render_image(const cv::Mat& camera_frame, GLuint camera_tex_id
                 img_size.x = img_size.y * aspect_ratio;
             }
 
-            ImGui::Image((void*)(intptr_t)camera_tex_id, img_size);
+            // Compare: composite in a fragment shader from the two textures already on the GPU
+            GLuint display_tex_id = camera_tex_id;
+            const bool compare = compare_loaded_ && texture_ && texture_->get_texture_id() > 0 &&
+                                 loaded_image_.cols == cam_width && loaded_image_.rows == cam_height;
+            if (compare && video::gpu::GPUBinaryDisplay::is_supported()) {
+                if (!compare_view_) {
+                    compare_view_ = std::make_unique<video::gpu::GPUCompareView>();
+                }
+                if (compare_view_->render(camera_tex_id, texture_->get_texture_id(), cam_width, cam_height,
+                                          video::gpu::GPUCompareView::Style())) {
+                    display_tex_id = compare_view_->get_texture();
+                }
+            }
+
+            render_zoomable_image(display_tex_id, cam_width, cam_height, img_size, camera_frame);
+            if (profile) {
+                render_activity_projections(img_size);
+            }
+
+            if (compare && compare_live_bits_.assign(camera_frame) &&
+                video::BinaryFrame::overlap(compare_live_bits_, compare_loaded_bits_, compare_counts_)) {
+                const double total = static_cast<double>(cam_width) * cam_height;
+                ImGui::Text("Both: %lld (%.2f%%)  Live only: %lld (%.2f%%)  Loaded only: %lld (%.2f%%)  Neither: %lld",
+                            static_cast<long long>(compare_counts_.both), 100.0 * compare_counts_.both / total,
+                            static_cast<long long>(compare_counts_.a_only), 100.0 * compare_counts_.a_only / total,
+                            static_cast<long long>(compare_counts_.b_only), 100.0 * compare_counts_.b_only / total,
+                            static_cast<long long>(compare_counts_.neither));
+            } else if (compare_loaded_ && !compare) {
+                ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.0f, 1.0f), "Loaded image size differs from the camera frame");
+            }
         } else {
             ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), "No camera feed");
         }
@@ -223,12 +485,194 @@ void ViewerPanel::render_image(const cv::Mat& camera_frame, GLuint camera_tex_id
     }
 }
 
+void ViewerPanel::render_zoomable_image(GLuint tex_id, int width, int height, const ImVec2& size,
+                                        const cv::Mat& pixels) {
+    if (width != view_width_ || height != view_height_) {
+        view_width_ = width;
+        view_height_ = height;
+        view_zoom_ = 1.0f;
+        view_center_ = ImVec2(0.5f, 0.5f);
+    }
+
+    // Binary pixels must not be smeared over their neighbours when magnified
+    if (tex_id != view_nearest_texture_) {
+        GLint previous = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+        glBindTexture(GL_TEXTURE_2D, tex_id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previous));
+        view_nearest_texture_ = tex_id;
+    }
+
+    // The item is an invisible button so dragging pans instead of moving the window
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton("##ImageView", size, ImGuiButtonFlags_MouseButtonLeft | ImGuiButtonFlags_MouseButtonMiddle);
+    const bool hovered = ImGui::IsItemHovered();
+    ImGui::SetItemKeyOwner(ImGuiKey_MouseWheelY);   // Wheel zooms instead of scrolling the panel
+
+    // Keep the view inside the image
+    auto clamp_center = [this]() {
+        const float half = 0.5f / view_zoom_;
+        view_center_.x = std::clamp(view_center_.x, half, 1.0f - half);
+        view_center_.y = std::clamp(view_center_.y, half, 1.0f - half);
+    };
+
+    const ImGuiIO& io = ImGui::GetIO();
+    const ImVec2 mouse_fraction((io.MousePos.x - origin.x) / size.x, (io.MousePos.y - origin.y) / size.y);
+    if (hovered && io.MouseWheel != 0.0f) {
+        // Zoom about the cursor: the texel under it stays put
+        const float zoom = std::clamp(view_zoom_ * std::pow(VIEW_ZOOM_STEP, io.MouseWheel), 1.0f, VIEW_MAX_ZOOM);
+        const ImVec2 anchor(view_center_.x + (mouse_fraction.x - 0.5f) / view_zoom_,
+                            view_center_.y + (mouse_fraction.y - 0.5f) / view_zoom_);
+        view_zoom_ = zoom;
+        view_center_ = ImVec2(anchor.x - (mouse_fraction.x - 0.5f) / zoom, anchor.y - (mouse_fraction.y - 0.5f) / zoom);
+        clamp_center();
+    }
+    if (ImGui::IsItemActive() && (io.MouseDelta.x != 0.0f || io.MouseDelta.y != 0.0f)) {
+        view_center_.x -= io.MouseDelta.x / (size.x * view_zoom_);
+        view_center_.y -= io.MouseDelta.y / (size.y * view_zoom_);
+        clamp_center();
+    }
+    if (hovered && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+        view_zoom_ = 1.0f;
+        view_center_ = ImVec2(0.5f, 0.5f);
+    }
+
+    const float half = 0.5f / view_zoom_;
+    const ImVec2 uv0(view_center_.x - half, view_center_.y - half);
+    const ImVec2 uv1(view_center_.x + half, view_center_.y + half);
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    const ImVec2 corner(origin.x + size.x, origin.y + size.y);
+    draw_list->AddImage((void*)(intptr_t)tex_id, origin, corner, uv0, uv1);
+    if (view_zoom_ == 1.0f) {
+        return;
+    }
+
+    // Pixel grid once pixels are large enough to tell apart (at most size / VIEW_GRID_MIN_PX lines)
+    const float px_x = size.x * view_zoom_ / width;   // Screen pixels per image pixel
+    const float px_y = size.y * view_zoom_ / height;
+    if (px_x >= VIEW_GRID_MIN_PX && px_y >= VIEW_GRID_MIN_PX) {
+        const ImU32 grid_color = IM_COL32(90, 90, 90, 160);
+        draw_list->PushClipRect(origin, corner, true);
+        const float first_x = uv0.x * width;
+        const float first_y = uv0.y * height;
+        for (float x = std::ceil(first_x); (x - first_x) * px_x <= size.x; x += 1.0f) {
+            const float sx = origin.x + (x - first_x) * px_x;
+            draw_list->AddLine(ImVec2(sx, origin.y), ImVec2(sx, corner.y), grid_color);
+        }
+        for (float y = std::ceil(first_y); (y - first_y) * px_y <= size.y; y += 1.0f) {
+            const float sy = origin.y + (y - first_y) * px_y;
+            draw_list->AddLine(ImVec2(origin.x, sy), ImVec2(corner.x, sy), grid_color);
+        }
+        draw_list->PopClipRect();
+    }
+
+    char label[32];
+    std::snprintf(label, sizeof(label), "%.1fx", view_zoom_);
+    draw_list->AddText(ImVec2(origin.x + 4.0f, origin.y + 4.0f), IM_COL32(255, 255, 0, 255), label);
+
+    if (hovered) {
+        const int x = std::clamp(static_cast<int>((uv0.x + mouse_fraction.x / view_zoom_) * width), 0, width - 1);
+        const int y = std::clamp(static_cast<int>((uv0.y + mouse_fraction.y / view_zoom_) * height), 0, height - 1);
+        if (pixels.cols == width && pixels.rows == height && pixels.depth() == CV_8U) {
+            if (pixels.channels() == 1) {
+                ImGui::SetTooltip("(%d, %d) = %d", x, y, pixels.at<uint8_t>(y, x));
+            } else {
+                const uint8_t* bgr = pixels.ptr<uint8_t>(y) + x * pixels.channels();
+                ImGui::SetTooltip("(%d, %d) = B %d G %d R %d", x, y, bgr[0], bgr[1], bgr[2]);
+            }
+        } else {
+            ImGui::SetTooltip("(%d, %d)", x, y);
+        }
+    }
+}
+
+void ViewerPanel::render_activity_projections(const ImVec2& img_size) {
+    const ImU32 bg_color = IM_COL32(30, 30, 30, 255);
+    const ImU32 on_color = IM_COL32(80, 220, 80, 255);
+    const ImU32 off_color = IM_COL32(230, 80, 80, 255);
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+    // Shared scale so ON and OFF compare directly across both strips
+    uint32_t peak = 1;
+    for (const auto* counts : {&activity_.row_on, &activity_.row_off, &activity_.col_on, &activity_.col_off}) {
+        for (uint32_t c : *counts) peak = std::max(peak, c);
+    }
+
+    // Polyline over one projection; vertical = rows along y, else columns along x
+    auto draw_projection = [&](const std::vector<uint32_t>& counts, ImVec2 origin, float length,
+                               bool vertical, ImU32 color) {
+        const size_t lines = counts.size();
+        profile_points_.resize(lines);
+        for (size_t i = 0; i < lines; ++i) {
+            const float along = (i + 0.5f) / lines * length;
+            const float across = static_cast<float>(counts[i]) / peak * PROFILE_STRIP;
+            profile_points_[i] = vertical ? ImVec2(origin.x + across, origin.y + along)
+                                          : ImVec2(origin.x + along, origin.y + PROFILE_STRIP - across);
+        }
+        draw_list->AddPolyline(profile_points_.data(), static_cast<int>(lines), color, ImDrawFlags_None, 1.0f);
+    };
+
+    // Hovered line of a strip, or -1
+    auto hovered_line = [](ImVec2 origin, float length, int lines, bool vertical) {
+        if (!ImGui::IsItemHovered()) return -1;
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+        const float pos = vertical ? mouse.y - origin.y : mouse.x - origin.x;
+        return std::clamp(static_cast<int>(pos / length * lines), 0, lines - 1);
+    };
+
+    // Rows: strip to the right of the image
+    ImGui::SameLine();
+    const ImVec2 row_origin = ImGui::GetCursorScreenPos();
+    ImGui::Dummy(ImVec2(PROFILE_STRIP, img_size.y));
+    draw_list->AddRectFilled(row_origin, ImVec2(row_origin.x + PROFILE_STRIP, row_origin.y + img_size.y), bg_color);
+    draw_projection(activity_.row_off, row_origin, img_size.y, true, off_color);
+    draw_projection(activity_.row_on, row_origin, img_size.y, true, on_color);
+    const int row = hovered_line(row_origin, img_size.y, activity_.height, true);
+    if (row >= 0) {
+        ImGui::SetTooltip("Row %d: ON %u, OFF %u", activity_.origin_y + row,
+                          activity_.row_on[row], activity_.row_off[row]);
+    }
+
+    // Columns: strip below the image
+    const ImVec2 col_origin = ImGui::GetCursorScreenPos();
+    ImGui::Dummy(ImVec2(img_size.x, PROFILE_STRIP));
+    draw_list->AddRectFilled(col_origin, ImVec2(col_origin.x + img_size.x, col_origin.y + PROFILE_STRIP), bg_color);
+    draw_projection(activity_.col_off, col_origin, img_size.x, false, off_color);
+    draw_projection(activity_.col_on, col_origin, img_size.x, false, on_color);
+    const int col = hovered_line(col_origin, img_size.x, activity_.width, false);
+    if (col >= 0) {
+        ImGui::SetTooltip("Column %d: ON %u, OFF %u", activity_.origin_x + col,
+                          activity_.col_on[col], activity_.col_off[col]);
+    }
+
+    // Readout failures show up as silent (or stuck, hot) lines; reported in sensor coordinates
+    auto rows = video::ActivitySnapshot::line_stats(activity_.row_on, activity_.row_off);
+    auto cols = video::ActivitySnapshot::line_stats(activity_.col_on, activity_.col_off);
+    for (int* line : {&rows.first_silent, &rows.first_hot}) {
+        if (*line >= 0) *line += activity_.origin_y;
+    }
+    for (int* line : {&cols.first_silent, &cols.first_hot}) {
+        if (*line >= 0) *line += activity_.origin_x;
+    }
+    ImGui::Text("Window: ON %llu / OFF %llu events", static_cast<unsigned long long>(activity_.on_events),
+                static_cast<unsigned long long>(activity_.off_events));
+    if (rows.silent + rows.hot + cols.silent + cols.hot > 0) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f),
+                           "| Rows: %d silent (first %d), %d hot (first %d) | Cols: %d silent (first %d), %d hot (first %d)",
+                           rows.silent, rows.first_silent, rows.hot, rows.first_hot,
+                           cols.silent, cols.first_silent, cols.hot, cols.first_hot);
+    }
+}
+
 // ============================================================================
 // Noise Analysis
 // ============================================================================
 
 void ViewerPanel::render_noise_analysis(const cv::Mat& camera_frame) {
-    if (ImGui::CollapsingHeader("Image Analysis", ImGuiTreeNodeFlags_None)) {
+    analysis_open_ = ImGui::CollapsingHeader("Image Analysis", ImGuiTreeNodeFlags_None);
+    if (analysis_open_) {
         // Get the current image to analyze
         cv::Mat current_image;
         std::string image_source;
@@ -240,6 +684,27 @@ void ViewerPanel::render_noise_analysis(const cv::Mat& camera_frame) {
             image_source = "Camera feed (Bit 0 OR Bit 7)";
         }
 
+        // One polarity: the frame's ON/OFF bits (same event pass as the frame) become a 0/255 image
+        cv::Mat live_frame = camera_frame;
+        if (mode_ == ViewerMode::ACTIVE_CAMERA && CameraManager::instance().has_polarity_planes()) {
+            const char* polarity_items[] = { "ON + OFF", "ON only", "OFF only" };
+            ImGui::Combo("Polarity", &analysis_polarity_, polarity_items, 3);
+            ImGui::SetItemTooltip("Analyze events of one polarity only");
+
+            if (analysis_polarity_ != 0 && !camera_frame.empty() && camera_frame.type() == CV_8UC1) {
+                const uint8_t bit = analysis_polarity_ == 1 ? video::BinaryFrameAccumulator::ON_BIT
+                                                            : video::BinaryFrameAccumulator::OFF_BIT;
+                polarity_lut_.create(1, 256, CV_8UC1);
+                for (int i = 0; i < 256; ++i) {
+                    polarity_lut_.at<uint8_t>(i) = (i & bit) ? 255 : 0;
+                }
+                cv::LUT(camera_frame, polarity_lut_, polarity_frame_);
+                live_frame = polarity_frame_;
+                current_image = polarity_frame_;
+                image_source = analysis_polarity_ == 1 ? "Camera feed (ON events)" : "Camera feed (OFF events)";
+            }
+        }
+
         bool has_image = !current_image.empty();
 
         // Show what image source will be analyzed
@@ -253,6 +718,32 @@ void ViewerPanel::render_noise_analysis(const cv::Mat& camera_frame) {
             ImGui::SliderInt("Threshold", &noise_params_.threshold_value, 0, 255);
             ImGui::SetItemTooltip("Binary threshold for detecting bright dots (0-255)");
 
+            ImGui::BeginDisabled(!has_image);
+            if (ImGui::Button("Sweep Threshold")) {
+                threshold_sweep_ = std::make_unique<ThresholdSweep>(
+                    NoiseAnalyzer::sweepThresholds(current_image, noise_params_.min_area));
+            }
+            ImGui::EndDisabled();
+            ImGui::SetItemTooltip("SNR for every threshold from one histogram of the current image");
+            if (threshold_sweep_) {
+                // Undefined points (one side empty) plot at 0 dB
+                float curve[256];
+                for (int t = 0; t < 256; ++t) {
+                    curve[t] = std::isfinite(threshold_sweep_->snr_db[t]) ? threshold_sweep_->snr_db[t] : 0.0f;
+                }
+                ImGui::PlotLines("##snr_sweep", curve, 256, 0, "SNR (dB) vs threshold", FLT_MAX, FLT_MAX,
+                                 ImVec2(0, 60));
+                if (threshold_sweep_->best_threshold >= 0) {
+                    ImGui::Text("Best: %d (%.1f dB)", threshold_sweep_->best_threshold, threshold_sweep_->best_snr_db);
+                    ImGui::SameLine();
+                    if (ImGui::SmallButton("Apply")) {
+                        noise_params_.threshold_value = threshold_sweep_->best_threshold;
+                    }
+                } else {
+                    ImGui::TextDisabled("No threshold leaves enough signal pixels");
+                }
+            }
+
             ImGui::SliderInt("Min Dot Area", &noise_params_.min_area, 1, 500);
             ImGui::SetItemTooltip("Minimum dot size in pixels");
 
@@ -262,6 +753,20 @@ void ViewerPanel::render_noise_analysis(const cv::Mat& camera_frame) {
             ImGui::SliderFloat("Circularity", &noise_params_.circularity_threshold, 0.0f, 1.0f);
             ImGui::SetItemTooltip("Minimum circularity (0-1, where 1 is perfect circle)");
 
+            ImGui::Checkbox("Contour Detector", &noise_params_.use_contours);
+            ImGui::SetItemTooltip("Trace dot outlines (slower) instead of labelling connected components");
+
+            ImGui::Checkbox("Fit Lattice", &noise_params_.fit_lattice);
+            ImGui::SetItemTooltip("Fit a regular grid to the dots: missed dots are filled in, stray detections dropped");
+
+            ImGui::BeginDisabled(!video::gpu::GPUMorphologyChain::is_supported());
+            ImGui::Checkbox("GPU Morphology", &noise_params_.gpu_morphology);
+            ImGui::EndDisabled();
+            ImGui::SetItemTooltip("Threshold, open and close in one compute chain with a single readback (OpenGL 4.3)");
+
+            ImGui::SliderInt("Local Noise Block", &local_noise_block_, 0, 256);
+            ImGui::SetItemTooltip("Noise mean/std per block of this many pixels, from integral images (0 = off)");
+
             ImGui::TreePop();
         }
 
@@ -270,12 +775,26 @@ void ViewerPanel::render_noise_analysis(const cv::Mat& camera_frame) {
         if (ImGui::Button("Run Noise Analysis", ImVec2(200, 30))) {
             if (!noise_analyzer_) {
                 noise_analyzer_ = std::make_unique<NoiseAnalyzer>();
+                // Detection runs here on the UI thread, which owns the GL context
+                noise_analyzer_->setMorphologyBackend(
+                    [this](const cv::Mat& gray, int threshold, int kernel_size, cv::Mat& binary) {
+                        if (!morphology_chain_) {
+                            morphology_chain_ = std::make_unique<video::gpu::GPUMorphologyChain>();
+                        }
+                        return morphology_chain_->process(gray, threshold, kernel_size, binary);
+                    });
             }
 
             // Set the image and process
+            noise_analyzer_->setLocalNoiseBlockSize(local_noise_block_);
             noise_analyzer_->setImage(current_image);
             noise_results_ = noise_analyzer_->processCurrentImage(noise_params_);
             noise_analysis_complete_ = true;
+            ++noise_generation_;
+            publish_noise_metrics(noise_results_);
+            if (mode_ == ViewerMode::ACTIVE_CAMERA) {
+                publish_interval_classes(*noise_analyzer_);
+            }
 
             std::cout << "Noise analysis complete for " << name_ << std::endl;
             std::cout << noise_results_.toString() << std::endl;
@@ -304,13 +823,54 @@ void ViewerPanel::render_noise_analysis(const cv::Mat& camera_frame) {
             ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.0f, 1.0f), "(Camera required)");
         }
 
+        // Live SNR: dots detected once, only the masked statistics run per frame
+        bool can_run_live = noise_analyzer_ && noise_analyzer_->hasGeometry() &&
+                            mode_ == ViewerMode::ACTIVE_CAMERA;
+        ImGui::BeginDisabled(!can_run_live);
+        ImGui::Checkbox("Live SNR", &live_noise_analysis_);
+        ImGui::EndDisabled();
+        ImGui::SetItemTooltip("Keep the detected dot positions and update statistics on every camera frame");
+        ImGui::SameLine();
+        ImGui::BeginDisabled(!can_run_live);
+        ImGui::Checkbox("Track Dots", &track_live_dots_);
+        ImGui::EndDisabled();
+        ImGui::SetItemTooltip("Follow each dot from its previous position (sub-pixel); re-detect when most are lost");
+
+        if (live_noise_analysis_ && can_run_live && !live_frame.empty()) {
+            noise_analyzer_->setLocalNoiseBlockSize(local_noise_block_);
+            NoiseAnalysisResults live_results = track_live_dots_
+                ? noise_analyzer_->trackLiveFrame(live_frame)
+                : noise_analyzer_->analyzeLiveFrame(live_frame);
+            if (live_results.num_dots_detected > 0) {
+                noise_results_ = std::move(live_results);
+                publish_noise_metrics(noise_results_);
+                if (noise_results_.redetected) {
+                    ++noise_generation_;
+                    publish_interval_classes(*noise_analyzer_);
+                }
+                if (track_live_dots_) {
+                    publish_tracking_metrics(noise_results_);
+                }
+            }
+        }
+
         // Display results if analysis is complete
         if (noise_analysis_complete_) {
             ImGui::Spacing();
             ImGui::Separator();
-            ImGui::TextColored(ImVec4(0, 1, 0, 1), "Analysis Results:");
+            ImGui::TextColored(ImVec4(0, 1, 0, 1), live_noise_analysis_ && can_run_live
+                               ? "Analysis Results (live):" : "Analysis Results:");
 
             ImGui::Text("Detected Dots: %d", noise_results_.num_dots_detected);
+            if (noise_results_.num_dots_predicted > 0 || noise_results_.num_dots_rejected > 0) {
+                ImGui::Text("Lattice: %d predicted, %d rejected",
+                            noise_results_.num_dots_predicted, noise_results_.num_dots_rejected);
+            }
+            if (live_noise_analysis_ && track_live_dots_ && can_run_live) {
+                ImGui::Text("Tracked: %d  Drift: %.2f px mean, %.2f px max",
+                            noise_results_.num_dots_tracked, noise_results_.mean_drift_px,
+                            noise_results_.max_drift_px);
+            }
 
             if (ImGui::TreeNode("Signal Statistics")) {
                 ImGui::Text("Mean:     %.2f", noise_results_.signal_mean);
@@ -342,51 +902,67 @@ void ViewerPanel::render_noise_analysis(const cv::Mat& camera_frame) {
                 ImGui::TreePop();
             }
 
+            const int worst_block = noise_results_.local_noise ? noise_results_.local_noise->worstBlock() : -1;
+            if (worst_block >= 0 && ImGui::TreeNode("Local Noise")) {
+                const LocalNoiseMap& map = *noise_results_.local_noise;
+                const size_t index = static_cast<size_t>(worst_block);
+                ImGui::Text("Grid:     %d x %d blocks of %d px", map.cols, map.rows, map.block_size);
+                ImGui::Text("Worst:    block (%d, %d)", worst_block % map.cols, worst_block / map.cols);
+                ImGui::Text("Std Dev:  %.2f (global %.2f)", map.noise_std[index], noise_results_.noise_std);
+                ImGui::Text("Mean:     %.2f (global %.2f)", map.noise_mean[index], noise_results_.noise_mean);
+                ImGui::TreePop();
+            }
+
             // Visualization options
             if (ImGui::TreeNode("Visualization")) {
-                static int viz_mode = 0;
                 const char* viz_items[] = { "Detected Circles", "Signal Only", "Noise Only" };
-                ImGui::Combo("Visualization Mode", &viz_mode, viz_items, IM_ARRAYSIZE(viz_items));
+                ImGui::Combo("Visualization Mode", &noise_viz_mode_, viz_items, IM_ARRAYSIZE(viz_items));
 
                 if (ImGui::Button("Show Visualization", ImVec2(200, 30))) {
-                    if (noise_analyzer_) {
-                        cv::Mat viz_image;
+                    noise_viz_visible_ = true;
+                }
 
-                        if (viz_mode == 0) {
-                            viz_image = noise_analyzer_->visualizeDetection(true);
-                        } else if (viz_mode == 1) {
+                // Each mode's texture is rebuilt only after a new analysis, so switching is free
+                if (noise_viz_visible_ && noise_analyzer_) {
+                    auto& texture = noise_viz_textures_[noise_viz_mode_];
+                    if (noise_viz_generation_[noise_viz_mode_] != noise_generation_) {
+                        cv::Mat viz_image;
+                        if (noise_viz_mode_ == 0) {
+                            viz_image = noise_analyzer_->getImage();  // Circles are drawn as an overlay
+                        } else if (noise_viz_mode_ == 1) {
                             viz_image = noise_analyzer_->visualizeSignal();
-                        } else if (viz_mode == 2) {
+                        } else {
                             viz_image = noise_analyzer_->visualizeNoise();
                         }
 
-                        // Upload to texture for display
+                        // Grayscale goes up as-is (R8 texture shown through a swizzle)
                         if (!viz_image.empty()) {
-                            if (!noise_viz_texture_) {
-                                noise_viz_texture_ = std::make_unique<video::TextureManager>();
-                            }
+                            app_state->texture_cache().acquire(texture, video::FrameRef(viz_image));
+                        }
+                        noise_viz_generation_[noise_viz_mode_] = noise_generation_;
+                    }
 
-                            // Convert grayscale to BGR if needed (TextureManager expects 3-channel images)
-                            cv::Mat texture_image;
-                            if (viz_image.channels() == 1) {
-                                cv::cvtColor(viz_image, texture_image, cv::COLOR_GRAY2BGR);
-                            } else {
-                                texture_image = viz_image;
+                    if (texture && texture->get_texture_id() > 0 && texture->get_width() > 0) {
+                        ImGui::Spacing();
+                        const float scale = 300.0f / texture->get_width();  // Fixed-width preview
+                        const ImVec2 viz_size(300.0f, texture->get_height() * scale);
+                        const ImVec2 origin = ImGui::GetCursorScreenPos();
+                        GLuint viz_tex_id = texture->get_texture_id();
+                        ImGui::Image((void*)(intptr_t)viz_tex_id, viz_size);
+
+                        if (noise_viz_mode_ == 0 && noise_results_.detected_circles) {
+                            ImDrawList* draw_list = ImGui::GetWindowDrawList();
+                            draw_list->PushClipRect(origin, ImVec2(origin.x + viz_size.x, origin.y + viz_size.y), true);
+                            for (const auto& circle : *noise_results_.detected_circles) {
+                                const ImVec2 center(origin.x + circle[0] * scale, origin.y + circle[1] * scale);
+                                draw_list->AddCircle(center, std::max(circle[2] * scale, 1.0f), IM_COL32(0, 255, 0, 255));
+                                draw_list->AddCircleFilled(center, 1.0f, IM_COL32(255, 0, 0, 255));
                             }
-
-                            noise_viz_texture_->upload_frame(texture_image);
+                            draw_list->PopClipRect();
                         }
                     }
                 }
 
-                // Display visualization if available
-                if (noise_viz_texture_ && noise_viz_texture_->get_texture_id() > 0) {
-                    ImGui::Spacing();
-                    ImVec2 viz_size(300, 200);  // Fixed size for visualization preview
-                    GLuint viz_tex_id = noise_viz_texture_->get_texture_id();
-                    ImGui::Image((void*)(intptr_t)viz_tex_id, viz_size);
-                }
-
                 ImGui::TreePop();
             }
 
@@ -398,20 +974,36 @@ void ViewerPanel::render_noise_analysis(const cv::Mat& camera_frame) {
                 std::tm tm_buf;
                 localtime_s(&tm_buf, &time_t);
 
-                std::ostringstream filename;
-                filename << "noise_analysis_"
-                         << std::put_time(&tm_buf, "%Y%m%d_%H%M%S")
-                         << ".txt";
+                std::ostringstream stem;
+                stem << "noise_analysis_" << std::put_time(&tm_buf, "%Y%m%d_%H%M%S");
 
                 // Write results to file
-                std::ofstream file(filename.str());
+                std::ofstream file(stem.str() + ".txt");
                 if (file.is_open()) {
                     file << noise_results_.toString();
                     file.close();
-                    std::cout << "Noise analysis results exported to: " << filename.str() << std::endl;
+                    std::cout << "Noise analysis results exported to: " << stem.str() << ".txt" << std::endl;
+                }
+
+                // Per-dot statistics alongside (full analyses only)
+                if (noise_results_.per_dot && noise_results_.per_dot->size() > 0) {
+                    std::ofstream dots(stem.str() + "_dots.csv");
+                    if (dots.is_open()) {
+                        noise_results_.per_dot->writeCsv(dots);
+                        std::cout << "Per-dot statistics exported to: " << stem.str() << "_dots.csv" << std::endl;
+                    }
+                }
+
+                // Local noise grid alongside (block size set)
+                if (noise_results_.local_noise && noise_results_.local_noise->size() > 0) {
+                    std::ofstream blocks(stem.str() + "_local_noise.csv");
+                    if (blocks.is_open()) {
+                        noise_results_.local_noise->writeCsv(blocks);
+                        std::cout << "Local noise map exported to: " << stem.str() << "_local_noise.csv" << std::endl;
+                    }
                 }
             }
-            ImGui::SetItemTooltip("Export analysis results to text file with timestamp");
+            ImGui::SetItemTooltip("Export analysis results to text file with timestamp (and per-dot / local noise CSVs)");
         }
     }
 }
@@ -420,6 +1012,79 @@ void ViewerPanel::render_noise_analysis(const cv::Mat& camera_frame) {
 // Filters Section
 // ============================================================================
 
+void ViewerPanel::render_interval_histograms() {
+    auto& cam_mgr = CameraManager::instance();
+    if (cam_mgr.num_pipelines() == 0 || !ImGui::TreeNode("Inter-Event Intervals")) {
+        return;
+    }
+    auto& config = AppConfig::instance();
+    auto& intervals = cam_mgr.event_intervals();
+
+    bool enabled = config.camera_settings().event_interval_histogram;
+    if (ImGui::Checkbox("Count Intervals", &enabled)) {
+        config.camera_settings().event_interval_histogram = enabled;
+        intervals.set_enabled(enabled);
+    }
+    ImGui::SetItemTooltip("Keep the last timestamp of every pixel and histogram the time between its events");
+    if (!enabled) {
+        ImGui::TreePop();
+        return;
+    }
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Reset##intervals")) {
+        intervals.reset_counts();
+    }
+
+    // Hot pixels come from the rate monitor; re-sent only when its list changes
+    const auto& monitor = cam_mgr.pixel_rates();
+    const int hot_count = monitor.get_flagged_count();
+    if (hot_count != interval_hot_synced_) {
+        monitor.get_flagged(interval_hot_pixels_);
+        std::vector<cv::Point> hot;
+        hot.reserve(interval_hot_pixels_.size());
+        for (const auto& pixel : interval_hot_pixels_) {
+            hot.emplace_back(pixel.x, pixel.y);
+        }
+        intervals.set_hot_pixels(hot);
+        interval_hot_synced_ = hot_count;
+    }
+
+    intervals.get_histograms(interval_snapshot_);
+    const auto class_pixels = intervals.get_class_pixels();
+    if (class_pixels[video::EventIntervalHistogram::Signal] == 0 &&
+        class_pixels[video::EventIntervalHistogram::Noise] == 0) {
+        ImGui::TextDisabled("Run noise analysis on a camera frame to split dots from background");
+    }
+
+    using Histograms = video::IntervalHistograms;
+    for (int c = 0; c < Histograms::CLASSES; ++c) {
+        float values[Histograms::BINS];
+        uint64_t total = 0;
+        for (int b = 0; b < Histograms::BINS; ++b) {
+            values[b] = static_cast<float>(interval_snapshot_.counts[c][b]);
+            total += interval_snapshot_.counts[c][b];
+        }
+        if (total == 0 && class_pixels[c] == 0) {
+            continue;
+        }
+
+        ImGui::Text("%s: %d px, %llu intervals", video::EventIntervalHistogram::class_name(c), class_pixels[c],
+                    static_cast<unsigned long long>(total));
+        if (total > 0) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(p10 < %lld us, median < %lld us)",
+                                static_cast<long long>(interval_snapshot_.quantile_us(c, 0.1)),
+                                static_cast<long long>(interval_snapshot_.quantile_us(c, 0.5)));
+        }
+        ImGui::PushID(c);
+        ImGui::PlotHistogram("##intervals", values, Histograms::BINS, 0, nullptr, 0.0f, FLT_MAX, ImVec2(-1, 50));
+        ImGui::PopID();
+    }
+    ImGui::TextDisabled("Bins: 0 us, then powers of two up to %lld us and over",
+                        static_cast<long long>(Histograms::bin_min_us(Histograms::BINS - 1)));
+    ImGui::TreePop();
+}
+
 void ViewerPanel::render_filters() {
     if (ImGui::CollapsingHeader("Camera Settings", ImGuiTreeNodeFlags_None)) {
         auto& cam_mgr = CameraManager::instance();
@@ -467,25 +1132,37 @@ void ViewerPanel::render_filters() {
 
             ImGui::Spacing();
             if (ImGui::Button("Apply Bias Changes", ImVec2(200, 30))) {
-                // Apply biases to camera
-                try {
-                    auto& camera = cam_mgr.get_camera(0).camera;
-                    if (camera) {
+                // Apply biases to camera (on the camera-control thread)
+                const auto& settings = config.camera_settings();
+                if (cam_mgr.num_pipelines() > 0) {
+                    cam_mgr.event_intervals().reset_counts();   // Intervals under the new biases only
+                }
+                EventCamera::ControlQueue::instance().post("viewer.biases",
+                    [diff_on = settings.bias_diff_on, diff_off = settings.bias_diff_off,
+                     hpf = settings.bias_hpf, refr = settings.bias_refr] {
+                    auto& cam_mgr = CameraManager::instance();
+                    if (!cam_mgr.is_camera_connected(0)) {
+                        return;
+                    }
+                    try {
+                        auto& camera = cam_mgr.get_camera(0).camera;
                         auto* ll_biases = camera->get_device().get_facility<Metavision::I_LL_Biases>();
                         if (ll_biases) {
-                            ll_biases->set("bias_diff_on", config.camera_settings().bias_diff_on);
-                            ll_biases->set("bias_diff_off", config.camera_settings().bias_diff_off);
-                            ll_biases->set("bias_hpf", config.camera_settings().bias_hpf);
-                            ll_biases->set("bias_refr", config.camera_settings().bias_refr);
+                            ll_biases->set("bias_diff_on", diff_on);
+                            ll_biases->set("bias_diff_off", diff_off);
+                            ll_biases->set("bias_hpf", hpf);
+                            ll_biases->set("bias_refr", refr);
                             std::cout << "Applied bias settings to camera" << std::endl;
                         }
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error applying biases: " << e.what() << std::endl;
                     }
-                } catch (const std::exception& e) {
-                    std::cerr << "Error applying biases: " << e.what() << std::endl;
-                }
+                });
             }
             ImGui::SetItemTooltip("Apply current bias settings to the camera hardware");
 
+            render_interval_histograms();
+
             ImGui::TreePop();
         }
 
@@ -514,36 +1191,127 @@ void ViewerPanel::render_filters() {
 
             ImGui::Spacing();
             if (ImGui::Button("Apply Trail Filter", ImVec2(200, 30))) {
-                // Apply trail filter to camera
-                try {
-                    auto& camera = cam_mgr.get_camera(0).camera;
-                    if (camera) {
+                // Apply trail filter to camera (on the camera-control thread)
+                const auto& settings = config.camera_settings();
+                EventCamera::ControlQueue::instance().post("viewer.trail_filter",
+                    [enabled = settings.trail_filter_enabled, type_index = settings.trail_filter_type,
+                     threshold = settings.trail_filter_threshold] {
+                    auto& cam_mgr = CameraManager::instance();
+                    if (!cam_mgr.is_camera_connected(0)) {
+                        return;
+                    }
+                    try {
+                        auto& camera = cam_mgr.get_camera(0).camera;
                         auto* trail_filter = camera->get_device().get_facility<Metavision::I_EventTrailFilterModule>();
                         if (trail_filter) {
-                            trail_filter->enable(config.camera_settings().trail_filter_enabled);
-                            if (config.camera_settings().trail_filter_enabled) {
+                            trail_filter->enable(enabled);
+                            if (enabled) {
                                 using FilterType = Metavision::I_EventTrailFilterModule::Type;
-                                FilterType type = static_cast<FilterType>(config.camera_settings().trail_filter_type);
-                                trail_filter->set_type(type);
-                                trail_filter->set_threshold(config.camera_settings().trail_filter_threshold);
+                                trail_filter->set_type(static_cast<FilterType>(type_index));
+                                trail_filter->set_threshold(threshold);
                             }
                             std::cout << "Applied trail filter settings to camera" << std::endl;
                         }
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error applying trail filter: " << e.what() << std::endl;
                     }
-                } catch (const std::exception& e) {
-                    std::cerr << "Error applying trail filter: " << e.what() << std::endl;
-                }
+                });
             }
             ImGui::SetItemTooltip("Apply current trail filter settings to the camera hardware");
 
             ImGui::TreePop();
         }
 
+        // Software Noise Filter
+        if (ImGui::TreeNode("Software Noise Filter")) {
+            ImGui::TextWrapped("Drop events with no neighbour activity, on the host (works on recordings).");
+            ImGui::Spacing();
+
+            auto& noise_filter = CameraManager::instance().noise_filter();
+            bool noise_enabled = config.camera_settings().noise_filter_enabled;
+            if (ImGui::Checkbox("Enable Noise Filter", &noise_enabled)) {
+                config.camera_settings().noise_filter_enabled = noise_enabled;
+                noise_filter.set_enabled(noise_enabled);
+            }
+
+            int noise_threshold = config.camera_settings().noise_filter_threshold_us;
+            if (ImGui::SliderInt("Window (us)", &noise_threshold, 100, 50000)) {
+                config.camera_settings().noise_filter_threshold_us = noise_threshold;
+                noise_filter.set_threshold_us(static_cast<uint32_t>(noise_threshold));
+            }
+            ImGui::SetItemTooltip("An event is kept if a neighbouring pixel fired within this window");
+
+            const uint64_t input = noise_filter.get_input_events();
+            if (noise_enabled && input > 0) {
+                ImGui::Text("Kept: %.1f%% of %llu events", 100.0 * noise_filter.get_passed_events() / input,
+                            static_cast<unsigned long long>(input));
+            }
+
+            ImGui::TreePop();
+        }
+
+        // Hot Pixel Monitor
+        if (ImGui::TreeNode("Hot Pixel Monitor")) {
+            ImGui::TextWrapped("Flag pixels whose event rate jumps above their neighbours during the run.");
+            ImGui::Spacing();
+
+            auto& monitor = CameraManager::instance().pixel_rates();
+            bool monitor_enabled = config.camera_settings().pixel_rate_monitor_enabled;
+            if (ImGui::Checkbox("Enable Monitor", &monitor_enabled)) {
+                config.camera_settings().pixel_rate_monitor_enabled = monitor_enabled;
+                monitor.set_enabled(monitor_enabled);
+            }
+
+            int half_life_ms = config.camera_settings().pixel_rate_half_life_ms;
+            if (ImGui::SliderInt("Half-life (ms)", &half_life_ms, 50, 10000, "%d", ImGuiSliderFlags_Logarithmic)) {
+                config.camera_settings().pixel_rate_half_life_ms = half_life_ms;
+                monitor.set_half_life_ms(half_life_ms);
+            }
+            ImGui::SetItemTooltip("How quickly each pixel's rate estimate forgets old events (restarts the estimate)");
+
+            float sigma = config.camera_settings().pixel_rate_sigma;
+            if (ImGui::SliderFloat("Sigma", &sigma, 2.0f, 20.0f, "%.1f")) {
+                config.camera_settings().pixel_rate_sigma = sigma;
+                monitor.set_sigma(sigma);
+            }
+            ImGui::SetItemTooltip("Poisson standard deviations above the 8 neighbours that flag a pixel");
+
+            if (monitor_enabled) {
+                monitor.get_flagged(flagged_pixels_);
+                ImGui::Text("Flagged: %d", monitor.get_flagged_count());
+                ImGui::SameLine();
+                if (ImGui::SmallButton("Clear")) {
+                    monitor.clear_flags();
+                }
+                if (monitor.get_known_count() > 0) {
+                    ImGui::TextDisabled("%d known hot pixels (dark calibration) not flagged", monitor.get_known_count());
+                }
+                const auto& pixel_mask = CameraManager::instance().pixel_mask();
+                if (pixel_mask.is_enabled()) {
+                    ImGui::TextDisabled("%d pixels masked at ingestion, %llu events dropped", pixel_mask.get_masked_pixels(),
+                                        static_cast<unsigned long long>(pixel_mask.get_suppressed()));
+                }
+                for (const auto& pixel : flagged_pixels_) {
+                    ImGui::Text("(%d, %d) at %.1f s: %.0f ev/s vs %.1f", pixel.x, pixel.y, pixel.flagged_ts / 1e6,
+                                pixel.events_per_s, pixel.neighbour_events_per_s);
+                }
+            }
+
+            ImGui::TreePop();
+        }
+
         // Chart Settings
         if (ImGui::TreeNode("Chart Settings")) {
             ImGui::TextWrapped("Configure the event rate chart display settings.");
             ImGui::Spacing();
 
+            // Projections cost a second pass over each batch; off stops the counting too
+            if (ImGui::Checkbox("Row/column projections", &show_activity_profile_)) {
+                CameraManager::instance().activity().set_enabled(show_activity_profile_);
+            }
+            ImGui::SetItemTooltip("Per-row (right) and per-column (below) ON/OFF event counts of the last window");
+            ImGui::Spacing();
+
             // Only show if we have a chart
             if (event_chart_) {
                 auto& settings = event_chart_->get_mutable_settings();
@@ -551,10 +1319,12 @@ void ViewerPanel::render_filters() {
                 // Time window slider
                 ImGui::Text("Time Window:");
                 float time_window = settings.time_window;
-                if (ImGui::SliderFloat("##TimeWindow", &time_window, 10.0f, 600.0f, "%.0f seconds")) {
+                if (ImGui::SliderFloat("##TimeWindow", &time_window, 10.0f, 86400.0f, "%.0f seconds",
+                                       ImGuiSliderFlags_Logarithmic)) {
                     settings.time_window = time_window;
                 }
-                ImGui::SetItemTooltip("How many seconds of history to display (10-600 seconds)");
+                ImGui::SetItemTooltip("How many seconds of history to display (10 s - 24 h; "
+                                      "beyond 10 min the chart shows 1 s, beyond 1 h 10 s averages)");
 
                 ImGui::Spacing();
 
@@ -633,40 +1403,57 @@ void ViewerPanel::handle_load_dialog() {
 
     if (ImageDialog::show_load_dialog(dialog_id, load_dialog_, result)) {
         // Image was successfully loaded this frame
-        loaded_image_ = result.image.clone();
-        loaded_metadata_ = result.metadata;
-        last_loaded_path_ = result.filepath;
-        mode_ = ViewerMode::LOADED_IMAGE;
-
-        std::cout << "Image data stored in " << name_ << " state" << std::endl;
-
-        // Create texture manager if not exists
-        if (!texture_) {
-            std::cout << "Creating new texture manager..." << std::endl;
-            texture_ = std::make_unique<video::TextureManager>();
-        }
-
-        // Upload loaded image to texture
-        std::cout << "Uploading image to GPU texture..." << std::endl;
-        try {
-            // Convert grayscale to BGR if needed (TextureManager expects 3-channel images)
-            cv::Mat texture_image;
-            if (loaded_image_.channels() == 1) {
-                std::cout << "Converting grayscale to BGR for texture..." << std::endl;
-                cv::cvtColor(loaded_image_, texture_image, cv::COLOR_GRAY2BGR);
-            } else {
-                texture_image = loaded_image_;
-            }
+        show_loaded_image(result);
+    }
+}
 
-            texture_->upload_frame(texture_image);
-            std::cout << "Texture upload successful" << std::endl;
-        } catch (const std::exception& e) {
-            std::cerr << "ERROR uploading texture: " << e.what() << std::endl;
-        }
+void ViewerPanel::step_loaded_image(int step) {
+    const std::string path = ImageCache::instance().neighbor(last_loaded_path_, step);
+    if (!path.empty()) {
+        open_image(path);
+    }
+}
+
+bool ViewerPanel::open_image(const std::string& path) {
+    LoadResult result;
+    result.filepath = path;
+    if (!ImageCache::instance().load(path, result.metadata, result.image)) {
+        return false;
+    }
+    show_loaded_image(result);
+    return true;
+}
 
-        std::cout << "Image loaded to " << name_ << ": " << result.filepath << std::endl;
-        std::cout << "  Resolution: " << result.metadata.image_width << "x" << result.metadata.image_height << std::endl;
+void ViewerPanel::show_loaded_image(LoadResult& result) {
+    // The image is the caller's own copy (ImageCache never hands out shared pixels)
+    loaded_image_ = std::move(result.image);
+    loaded_metadata_ = result.metadata;
+    last_loaded_path_ = result.filepath;
+    mode_ = ViewerMode::LOADED_IMAGE;
+
+    // Decode the captures either side while this one is on screen
+    ImageCache::instance().prefetch_around(last_loaded_path_);
+
+    try {
+        // One texture per file however many views load it; grayscale goes up as R8
+        app_state->texture_cache().acquire(texture_, video::FrameRef(loaded_image_),
+                                           video::TextureCache::Key::of_file(last_loaded_path_));
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR uploading texture: " << e.what() << std::endl;
     }
+
+    // Packed once for compare counts
+    cv::Mat loaded_gray = loaded_image_;
+    if (loaded_image_.channels() == 3) {
+        cv::cvtColor(loaded_image_, loaded_gray, cv::COLOR_BGR2GRAY);
+    }
+    if (!compare_loaded_bits_.assign(loaded_gray)) {
+        compare_loaded_bits_ = video::BinaryFrame();
+        compare_loaded_ = false;
+    }
+
+    std::cout << "Image loaded to " << name_ << ": " << result.filepath << std::endl;
+    std::cout << "  Resolution: " << result.metadata.image_width << "x" << result.metadata.image_height << std::endl;
 }
 
 void ViewerPanel::handle_save_dialog(const cv::Mat& camera_frame) {
@@ -682,9 +1469,10 @@ void ViewerPanel::handle_save_dialog(const cv::Mat& camera_frame) {
     std::string saved_path;
 
     if (ImageDialog::show_save_dialog(dialog_id, save_dialog_, image_to_save, saved_path)) {
-        // Image was successfully saved this frame
-        std::cout << "Image saved from " << name_ << ": " << saved_path << std::endl;
+        // Written in the background; the outcome arrives via ImageSaveQueue
+        std::cout << "Image queued for saving from " << name_ << ": " << saved_path << std::endl;
     }
+    save_open_ = ImGui::IsPopupOpen(dialog_id.c_str());
 }
 
 // ============================================================================
@@ -0,0 +1,47 @@
+#include "video/accumulation_controller.h"
+#include <algorithm>
+#include <cmath>
+
+namespace video {
+
+void AccumulationController::configure(Target target, double value, int min_us, int max_us) {
+    min_us = std::max(min_us, 1);
+    max_us = std::max(max_us, min_us);
+    if (target == Target::Occupancy) {
+        value = std::clamp(value, 0.001, MAX_OCCUPANCY);
+    } else {
+        value = std::max(value, 1.0);
+    }
+    target_ = static_cast<int>(target);
+    value_ = value;
+    min_us_ = min_us;
+    max_us_ = max_us;
+}
+
+uint32_t AccumulationController::update(uint32_t window_us, uint64_t events, double occupancy) const {
+    const double min_us = min_us_.load(std::memory_order_relaxed);
+    const double max_us = max_us_.load(std::memory_order_relaxed);
+    const double target = value_.load(std::memory_order_relaxed);
+    const double current = std::clamp(static_cast<double>(std::max<uint32_t>(window_us, 1)), min_us, max_us);
+
+    // Measured and wanted amounts, both proportional to the window
+    double measured;
+    double wanted;
+    if (get_target() == Target::Occupancy) {
+        measured = -std::log1p(-std::clamp(occupancy, 0.0, MAX_OCCUPANCY));
+        wanted = -std::log1p(-target);
+    } else {
+        measured = static_cast<double>(events);
+        wanted = target;
+    }
+
+    // Empty frame: open up as fast as allowed
+    const double ratio = measured > 0.0 ? wanted / measured : MAX_STEP;
+    if (std::abs(ratio - 1.0) <= DEADBAND) {
+        return static_cast<uint32_t>(current);
+    }
+    const double step = std::clamp(std::pow(ratio, GAIN), 1.0 / MAX_STEP, MAX_STEP);
+    return static_cast<uint32_t>(std::lround(std::clamp(current * step, min_us, max_us)));
+}
+
+} // namespace video
@@ -0,0 +1,291 @@
+#include "video/analyzer_host.h"
+#include "core/latency_stats.h"
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace video {
+
+// Event views point straight into EventCD buffers
+static_assert(sizeof(rtcam_event) == sizeof(Metavision::EventCD), "rtcam_event must match Metavision::EventCD");
+static_assert(offsetof(rtcam_event, x) == offsetof(Metavision::EventCD, x) &&
+              offsetof(rtcam_event, y) == offsetof(Metavision::EventCD, y) &&
+              offsetof(rtcam_event, p) == offsetof(Metavision::EventCD, p) &&
+              offsetof(rtcam_event, t) == offsetof(Metavision::EventCD, t),
+              "rtcam_event must match Metavision::EventCD");
+
+AnalyzerHost::~AnalyzerHost() {
+    stop();
+}
+
+bool AnalyzerHost::load(const std::string& path) {
+#ifdef _WIN32
+    HMODULE library = LoadLibraryA(path.c_str());
+    if (library == nullptr) {
+        std::cerr << "AnalyzerHost: Cannot load " << path << " (error " << GetLastError() << ")" << std::endl;
+        return false;
+    }
+    auto entry = reinterpret_cast<rtcam_analyzer_entry_fn>(GetProcAddress(library, RTCAM_ANALYZER_ENTRY));
+#else
+    void* library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (library == nullptr) {
+        std::cerr << "AnalyzerHost: Cannot load " << path << ": " << dlerror() << std::endl;
+        return false;
+    }
+    auto entry = reinterpret_cast<rtcam_analyzer_entry_fn>(dlsym(library, RTCAM_ANALYZER_ENTRY));
+#endif
+    if (entry == nullptr) {
+        std::cerr << "AnalyzerHost: " << path << " does not export " << RTCAM_ANALYZER_ENTRY << std::endl;
+        unload(library);
+        return false;
+    }
+    if (!add_plugin(entry(), library, path)) {
+        unload(library);
+        return false;
+    }
+    return true;
+}
+
+bool AnalyzerHost::add(const rtcam_analyzer* analyzer) {
+    return add_plugin(analyzer, nullptr, "built-in");
+}
+
+bool AnalyzerHost::add_plugin(const rtcam_analyzer* analyzer, void* library, const std::string& source) {
+    if (running_.load()) {
+        std::cerr << "AnalyzerHost: Plugins must be added before start()" << std::endl;
+        return false;
+    }
+    if (analyzer == nullptr || analyzer->abi_version != RTCAM_ANALYZER_ABI_VERSION || analyzer->name == nullptr ||
+        analyzer->create == nullptr || analyzer->destroy == nullptr) {
+        std::cerr << "AnalyzerHost: " << source << " is not an analyzer for ABI version "
+                  << RTCAM_ANALYZER_ABI_VERSION << std::endl;
+        return false;
+    }
+
+    auto plugin = std::make_unique<Plugin>();
+    plugin->analyzer = analyzer;
+    plugin->library = library;
+    plugin->prefix = std::string("plugin.") + analyzer->name + ".";
+    plugin->api.abi_version = RTCAM_ANALYZER_ABI_VERSION;
+    plugin->api.host = plugin.get();
+    plugin->api.set_gauge = &AnalyzerHost::set_gauge;
+    plugin->api.add_counter = &AnalyzerHost::add_counter;
+
+    plugin->instance = analyzer->create(&plugin->api);
+    if (plugin->instance == nullptr) {
+        std::cerr << "AnalyzerHost: " << analyzer->name << " (" << source << ") declined to start" << std::endl;
+        return false;
+    }
+
+    auto& registry = core::MetricsRegistry::instance();
+    plugin->processed = &registry.counter(plugin->prefix + "processed");
+    plugin->dropped = &registry.counter(plugin->prefix + "dropped");
+    plugin->run_us = &registry.histogram(plugin->prefix + "run_us");
+
+    std::cout << "Analyzer plugin: " << analyzer->name << " (" << source << ")" << std::endl;
+    plugins_.push_back(std::move(plugin));
+    return true;
+}
+
+bool AnalyzerHost::start(int threads) {
+    if (plugins_.empty() || running_.load()) {
+        return running_.load();
+    }
+
+    wants_events_ = std::any_of(plugins_.begin(), plugins_.end(),
+        [](const std::unique_ptr<Plugin>& plugin) { return plugin->analyzer->on_events != nullptr; });
+    if (wants_events_) {
+        event_buffers_.clear();
+        for (int i = 0; i < EVENT_BUFFERS; ++i) {
+            event_buffers_.push_back(std::make_shared<EventBatch>());
+        }
+    }
+
+    const int workers = threads > 0 ? threads : static_cast<int>(plugins_.size());
+    pool_ = std::make_unique<ThreadPool>(std::max(workers, 1));
+    running_ = true;
+    std::cout << "Analyzer plugins: " << plugins_.size() << " on " << pool_->concurrency() - 1 << " threads"
+              << std::endl;
+    return true;
+}
+
+void AnalyzerHost::stop() {
+    running_ = false;
+
+    // Joins the workers; a running drain returns after its current item
+    pool_.reset();
+
+    for (auto& plugin : plugins_) {
+        plugin->analyzer->destroy(plugin->instance);
+        if (plugin->library != nullptr) {
+            unload(plugin->library);
+        }
+    }
+    plugins_.clear();
+    event_buffers_.clear();
+    wants_events_ = false;
+}
+
+void AnalyzerHost::unload(void* library) {
+#ifdef _WIN32
+    FreeLibrary(static_cast<HMODULE>(library));
+#else
+    dlclose(library);
+#endif
+}
+
+void AnalyzerHost::submit_frame(int camera_index, const FrameRef& frame) {
+    if (!running_.load(std::memory_order_relaxed) || frame.empty()) {
+        return;
+    }
+    for (auto& plugin : plugins_) {
+        if (plugin->analyzer->on_frame != nullptr) {
+            Work work;
+            work.camera_index = camera_index;
+            work.frame = frame;  // Shares the pool slot
+            enqueue(*plugin, std::move(work));
+        }
+    }
+}
+
+void AnalyzerHost::submit_events(int camera_index, const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    if (!wants_events_ || begin == end || !running_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // The ring slot is recycled once this batch is done, so plugins share one copy
+    std::shared_ptr<EventBatch> batch = acquire_event_buffer();
+    if (!batch) {
+        for (auto& plugin : plugins_) {
+            if (plugin->analyzer->on_events != nullptr) {
+                plugin->dropped->add();
+            }
+        }
+        return;
+    }
+    batch->events.assign(begin, end);
+    batch->camera_index = camera_index;
+
+    for (auto& plugin : plugins_) {
+        if (plugin->analyzer->on_events != nullptr) {
+            Work work;
+            work.camera_index = camera_index;
+            work.events = batch;
+            enqueue(*plugin, std::move(work));
+        }
+    }
+}
+
+std::shared_ptr<AnalyzerHost::EventBatch> AnalyzerHost::acquire_event_buffer() {
+    std::lock_guard<std::mutex> lock(event_buffers_mutex_);
+    for (auto& buffer : event_buffers_) {
+        if (buffer.use_count() == 1) {
+            return buffer;
+        }
+    }
+    return nullptr;  // Every buffer still queued at some plugin
+}
+
+void AnalyzerHost::enqueue(Plugin& plugin, Work&& work) {
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lock(plugin.mutex);
+        if (plugin.size == QUEUE_DEPTH) {
+            // Behind: the oldest item goes, so a stalled plugin only ever pins QUEUE_DEPTH items
+            plugin.queue[plugin.head] = Work{};
+            plugin.head = (plugin.head + 1) % QUEUE_DEPTH;
+            --plugin.size;
+            plugin.dropped->add();
+        }
+        plugin.queue[(plugin.head + plugin.size) % QUEUE_DEPTH] = std::move(work);
+        ++plugin.size;
+        if (!plugin.scheduled) {
+            plugin.scheduled = true;
+            schedule = true;
+        }
+    }
+    if (schedule) {
+        pool_->post([this, &plugin] { drain(plugin); });
+    }
+}
+
+void AnalyzerHost::drain(Plugin& plugin) {
+    Work work;
+    while (running_.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> lock(plugin.mutex);
+            if (plugin.size == 0) {
+                plugin.scheduled = false;
+                return;
+            }
+            work = std::move(plugin.queue[plugin.head]);
+            plugin.queue[plugin.head] = Work{};
+            plugin.head = (plugin.head + 1) % QUEUE_DEPTH;
+            --plugin.size;
+        }
+        run(plugin, work);
+        work = Work{};  // Hand the frame back to the pool before waiting for the lock again
+    }
+    std::lock_guard<std::mutex> lock(plugin.mutex);
+    plugin.scheduled = false;
+}
+
+void AnalyzerHost::run(Plugin& plugin, const Work& work) {
+    const int64_t start_us = core::LatencyStats::now_us();
+    if (work.events) {
+        rtcam_event_view view{};
+        view.events = reinterpret_cast<const rtcam_event*>(work.events->events.data());
+        view.count = work.events->events.size();
+        view.camera_index = static_cast<uint32_t>(work.camera_index);
+        plugin.analyzer->on_events(plugin.instance, &view);
+    } else {
+        ReadGuard guard(work.frame);
+        const cv::Mat& mat = guard.get();
+        if (mat.empty() || mat.type() != CV_8UC1) {
+            return;
+        }
+        const FrameTiming timing = work.frame.timing();
+        rtcam_frame_view view{};
+        view.data = mat.data;
+        view.width = mat.cols;
+        view.height = mat.rows;
+        view.stride = static_cast<int64_t>(mat.step[0]);
+        view.format = RTCAM_FRAME_U8;
+        view.camera_index = static_cast<uint32_t>(work.camera_index);
+        view.timestamp_us = timing.camera_ts;
+        view.window_us = timing.window_us;
+        view.events = timing.events;
+        plugin.analyzer->on_frame(plugin.instance, &view);
+    }
+    plugin.processed->add();
+    plugin.run_us->record(core::LatencyStats::now_us() - start_us);
+}
+
+void AnalyzerHost::set_gauge(void* host, const char* name, double value) {
+    Plugin& plugin = *static_cast<Plugin*>(host);
+    auto it = plugin.gauges.find(name);
+    if (it == plugin.gauges.end()) {
+        it = plugin.gauges.emplace(name, &core::MetricsRegistry::instance().gauge(plugin.prefix + name)).first;
+    }
+    it->second->set(value);
+}
+
+void AnalyzerHost::add_counter(void* host, const char* name, int64_t delta) {
+    Plugin& plugin = *static_cast<Plugin*>(host);
+    auto it = plugin.counters.find(name);
+    if (it == plugin.counters.end()) {
+        it = plugin.counters.emplace(name, &core::MetricsRegistry::instance().counter(plugin.prefix + name)).first;
+    }
+    it->second->add(delta);
+}
+
+} // namespace video
@@ -0,0 +1,403 @@
+#include "video/backend_tuner.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace video {
+
+namespace {
+
+std::string trim(const std::string& text) {
+    const size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    const size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+void append_timing(std::string& timings, const char* name, double us) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%s%s %.1f us", timings.empty() ? "" : ", ", name, us);
+    timings += buffer;
+}
+
+/**
+ * Representative inputs for every kernel at one frame size
+ */
+struct Workload {
+    cv::Mat bgr, gray, binary, previous, mask;
+    std::vector<Metavision::EventCD> events;
+    std::vector<uint32_t> row_counts;
+    BinaryFrame live_bits, reference_bits, scattering_bits;
+
+    // Outputs, reused between calls
+    cv::Mat out, sum, sum_sq, count;
+    BinaryFrame planes[8];
+    uint32_t inside[256], outside[256];
+
+    Workload(int width, int height) {
+        // A raw camera frame: bit-encoded BGR with ~5% of the pixels active
+        cv::RNG rng(0x5eed);
+        cv::Mat noise(height, width, CV_8UC1);
+        rng.fill(noise, cv::RNG::UNIFORM, 0, 256);
+        cv::Mat active = noise < 13;
+        bgr = cv::Mat(height, width, CV_8UC3, cv::Scalar::all(0));
+        cv::Mat bits(height, width, CV_8UC1);
+        rng.fill(bits, cv::RNG::UNIFORM, 0, 256);
+        cv::Mat channels[3] = {bits, bits, bits};
+        cv::Mat full;
+        cv::merge(channels, 3, full);
+        full.copyTo(bgr, active);
+
+        cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
+        binary = active.clone();                        // 0/255
+        previous = (noise < 13) | (noise > 250);        // Frame-to-frame flicker
+        mask = cv::Mat(height, width, CV_8UC1, cv::Scalar(0));
+        cv::rectangle(mask, cv::Rect(width / 4, height / 4, width / 2, height / 2), cv::Scalar(255), cv::FILLED);
+
+        // One accumulation window of events, sorted by time as the camera delivers them
+        const size_t event_count = static_cast<size_t>(cv::countNonZero(active));
+        events.reserve(event_count);
+        for (size_t i = 0; i < event_count; ++i) {
+            events.emplace_back(static_cast<unsigned short>(rng.uniform(0, width)),
+                                static_cast<unsigned short>(rng.uniform(0, height)),
+                                static_cast<short>(rng.uniform(0, 2)),
+                                static_cast<Metavision::timestamp>(i * 10000 / std::max<size_t>(event_count, 1)));
+        }
+        row_counts.resize(static_cast<size_t>(height));
+
+        // Scattering on packed frames: live AND NOT reference, then its count
+        live_bits = BinaryFrame::from_mat(binary);
+        reference_bits = BinaryFrame::from_mat(previous);
+        scattering_bits.create(width, height);
+    }
+
+    void run(simd::Kernel kernel) {
+        switch (kernel) {
+            case simd::Kernel::BgrToGray: simd::bgr_to_gray(bgr, gray); break;
+            case simd::Kernel::RangeFilter: simd::apply_range_filter(gray, out, 96, 127); break;
+            case simd::Kernel::DualRangeFilter: simd::apply_dual_range_filter(gray, out, 96, 127, 224, 255); break;
+            case simd::Kernel::ExtractBitMask: simd::extract_bit_mask(bgr, out, (1 << 5) | (1 << 6)); break;
+            case simd::Kernel::SplitBitPlanes: simd::split_bit_planes(bgr, planes); break;
+            case simd::Kernel::MaskedHistogram: simd::masked_histogram(gray, mask, inside, outside); break;
+            case simd::Kernel::MaskedIntegrals: simd::masked_integrals(gray, mask, sum, sum_sq, count); break;
+            case simd::Kernel::FrameDifference: simd::frame_difference(binary, previous, out); break;
+            case simd::Kernel::EventStats: {
+                simd::EventStats stats;
+                simd::event_stats(events.data(), events.data() + events.size(), stats,
+                                  row_counts.data(), static_cast<int>(row_counts.size()));
+                break;
+            }
+            case simd::Kernel::BitAlgebra: {
+                const uint64_t* ref = reference_bits.data();
+                simd::bitwise_ternary(live_bits.data(), ref, ref, scattering_bits.data(), live_bits.word_count(),
+                                      simd::TERN_A & ~simd::TERN_B);
+                simd::count_bits(scattering_bits.data(), scattering_bits.word_count());
+                break;
+            }
+            case simd::Kernel::COUNT: break;
+        }
+    }
+};
+
+} // namespace
+
+std::string BackendTuner::machine_id() {
+    std::string identity;
+    uint32_t cpu_info[4] = {};
+
+    // Vendor ("GenuineIntel") from leaf 0, in EBX, EDX, ECX order
+    if (simd::cpuid(0, 0, cpu_info)) {
+        char vendor[13] = {};
+        std::memcpy(vendor, &cpu_info[1], 4);
+        std::memcpy(vendor + 4, &cpu_info[3], 4);
+        std::memcpy(vendor + 8, &cpu_info[2], 4);
+        identity += vendor;
+
+        // Brand string from the extended leaves, when present
+        simd::cpuid(0x80000000u, 0, cpu_info);
+        if (cpu_info[0] >= 0x80000004u) {
+            char brand[49] = {};
+            for (uint32_t leaf = 0; leaf < 3; ++leaf) {
+                simd::cpuid(0x80000002u + leaf, 0, cpu_info);
+                std::memcpy(brand + leaf * 16, cpu_info, 16);
+            }
+            identity += brand;
+        }
+
+        // Family/model/stepping and feature bits, so a microcode-masked feature counts as a different machine
+        simd::cpuid(1, 0, cpu_info);
+        identity += std::to_string(cpu_info[0]) + "/" + std::to_string(cpu_info[2]) + "/" + std::to_string(cpu_info[3]);
+    } else {
+        // No CPUID: the architecture and its SIMD tier stand in for the CPU model
+        identity += simd::get_cpu_features().has_neon ? "aarch64/neon" : "generic";
+    }
+    identity += "/" + std::to_string(std::thread::hardware_concurrency());
+    identity += "/v" + std::to_string(TUNER_VERSION);
+
+    // FNV-1a, 64-bit
+    uint64_t hash = 14695981039346656037ull;
+    for (const unsigned char c : identity) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    return hex;
+}
+
+bool BackendTuner::run(const Options& options) {
+    choices_.clear();
+    from_cache_ = false;
+
+    const std::string id = machine_id();
+    if (!options.cache_path.empty() && load_cache(options.cache_path, id)) {
+        from_cache_ = true;
+    } else if (options.measure) {
+        measure(options);
+        if (!options.cache_path.empty() && !save_cache(options.cache_path, id)) {
+            std::cerr << "BackendTuner: Could not write " << options.cache_path << std::endl;
+        }
+    }
+
+    apply_overrides(options.overrides);
+    return !choices_.empty();
+}
+
+double BackendTuner::warm_up(int width, int height) {
+    const auto begin = std::chrono::steady_clock::now();
+    Workload workload(std::max(width, 64), std::max(height, 8));
+    for (int k = 0; k < simd::KERNEL_COUNT; ++k) {
+        workload.run(static_cast<simd::Kernel>(k));   // At the tier run() dispatched
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+template <typename Fn>
+double BackendTuner::time_call_us(const Options& options, Fn&& fn) {
+    using Clock = std::chrono::steady_clock;
+    fn();   // Warm caches and, for wide vectors, the upper register halves
+
+    double best_us = 0.0;
+    for (int round = 0; round < std::max(options.rounds, 1); ++round) {
+        // Long enough for a frequency drop under wide vectors to show in the timing
+        int calls = 0;
+        const Clock::time_point begin = Clock::now();
+        double elapsed_us = 0.0;
+        do {
+            fn();
+            ++calls;
+            elapsed_us = std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+        } while (elapsed_us < options.round_us);
+
+        const double per_call_us = elapsed_us / calls;
+        if (round == 0 || per_call_us < best_us) {
+            best_us = per_call_us;
+        }
+    }
+    return best_us;
+}
+
+void BackendTuner::measure(const Options& options) {
+    const int width = std::max(options.width, 64);
+    const int height = std::max(options.height, 8);
+    Workload workload(width, height);
+    const std::vector<Metavision::EventCD>& events = workload.events;
+
+    for (int k = 0; k < simd::KERNEL_COUNT; ++k) {
+        const simd::Kernel kernel = static_cast<simd::Kernel>(k);
+        auto call = [&]() { workload.run(kernel); };
+
+        Choice choice;
+        choice.kernel = simd::kernel_name(kernel);
+        const simd::Isa fallback = simd::max_isa(kernel);
+        simd::Isa best = fallback;
+        double best_us = 0.0;
+        double fallback_us = 0.0;
+        for (int tier = 0; tier < simd::ISA_COUNT; ++tier) {
+            const simd::Isa isa = static_cast<simd::Isa>(tier);
+            if (!simd::has_isa(kernel, isa)) {
+                continue;
+            }
+            simd::set_isa(kernel, isa);
+            const double us = time_call_us(options, call);
+            append_timing(choice.timings, simd::isa_name(isa), us);
+            if (isa == fallback) fallback_us = us;
+            if (best_us == 0.0 || us < best_us) {
+                best = isa;
+                best_us = us;
+            }
+        }
+        // The default tier stays unless another beats it clearly
+        if (best != fallback && best_us > fallback_us * (1.0 - MIN_GAIN)) {
+            best = fallback;
+        }
+        simd::set_isa(kernel, best);
+        choice.backend = simd::isa_name(best);
+        choices_.push_back(choice);
+    }
+
+    // Noise filter paths; each call moves the batch one window later, as the live stream does
+    Choice choice;
+    choice.kernel = "noise_filter";
+    EventNoiseFilter filter;
+    filter.set_enabled(true);
+    std::vector<Metavision::EventCD> kept(events.size());
+    EventNoiseFilter::Path best = EventNoiseFilter::Path::Scalar;
+    double best_us = 0.0;
+    double scalar_us = 0.0;
+    const EventNoiseFilter::Path paths[] = {EventNoiseFilter::Path::Scalar, EventNoiseFilter::Path::SSE41,
+                                            EventNoiseFilter::Path::AVX2};
+    for (const EventNoiseFilter::Path path : paths) {
+        filter.configure(width, height, path);
+        if (filter.get_path() != path) {
+            continue;   // Not supported here
+        }
+        std::vector<Metavision::EventCD> batch = events;
+        const double us = time_call_us(options, [&]() {
+            for (auto& event : batch) {
+                event.t += 10000;
+            }
+            filter.filter(batch.data(), batch.data() + batch.size(), kept.data());
+        });
+        append_timing(choice.timings, EventNoiseFilter::path_name(path), us);
+        if (path == EventNoiseFilter::Path::Scalar) scalar_us = us;
+        if (best_us == 0.0 || us < best_us) {
+            best = path;
+            best_us = us;
+        }
+    }
+    // Scalar is the default here: the vector paths must earn their place
+    if (best != EventNoiseFilter::Path::Scalar && best_us > scalar_us * (1.0 - MIN_GAIN)) {
+        best = EventNoiseFilter::Path::Scalar;
+    }
+    EventNoiseFilter::set_auto_path(best);
+    choice.backend = EventNoiseFilter::path_name(best);
+    choices_.push_back(choice);
+}
+
+bool BackendTuner::load_cache(const std::string& path, const std::string& id) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::vector<std::pair<std::string, std::string>> entries;
+    bool matched = false;
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        const std::string key = trim(line.substr(0, eq));
+        const std::string value = trim(line.substr(eq + 1));
+        if (key == "machine") {
+            matched = value == id;
+        } else {
+            entries.emplace_back(key, value);
+        }
+    }
+    if (!matched) {
+        return false;
+    }
+
+    // A cache naming a kernel or tier this build does not have is stale: measure again
+    std::vector<std::pair<simd::Kernel, simd::Isa>> tiers;
+    EventNoiseFilter::Path noise_path = EventNoiseFilter::Path::Scalar;
+    for (const auto& entry : entries) {
+        simd::Kernel kernel;
+        simd::Isa isa;
+        if (entry.first == "noise_filter") {
+            if (!parse_path(entry.second, noise_path)) return false;
+        } else if (simd::parse_kernel(entry.first, kernel) && simd::parse_isa(entry.second, isa)) {
+            tiers.emplace_back(kernel, isa);
+        } else {
+            return false;
+        }
+    }
+    if (tiers.size() != static_cast<size_t>(simd::KERNEL_COUNT)) {
+        return false;
+    }
+
+    for (const auto& tier : tiers) {
+        simd::set_isa(tier.first, tier.second);
+        Choice choice;
+        choice.kernel = simd::kernel_name(tier.first);
+        choice.backend = simd::isa_name(simd::get_isa(tier.first));
+        choices_.push_back(choice);
+    }
+    EventNoiseFilter::set_auto_path(noise_path);
+    Choice choice;
+    choice.kernel = "noise_filter";
+    choice.backend = EventNoiseFilter::path_name(noise_path);
+    choices_.push_back(choice);
+    return true;
+}
+
+bool BackendTuner::save_cache(const std::string& path, const std::string& id) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << "# Backend tuning cache (written at startup; delete to measure again)\n";
+    file << "machine = " << id << "\n";
+    for (const Choice& choice : choices_) {
+        file << "# " << choice.timings << "\n";
+        file << choice.kernel << " = " << choice.backend << "\n";
+    }
+    return file.good();
+}
+
+void BackendTuner::apply_overrides(const std::string& overrides) {
+    std::stringstream stream(overrides);
+    std::string entry;
+    while (std::getline(stream, entry, ';')) {
+        entry = trim(entry);
+        if (entry.empty()) continue;
+        const size_t colon = entry.find(':');
+        const std::string name = colon == std::string::npos ? entry : trim(entry.substr(0, colon));
+        const std::string value = colon == std::string::npos ? "" : trim(entry.substr(colon + 1));
+
+        Choice choice;
+        choice.kernel = name;
+        choice.overridden = true;
+        simd::Kernel kernel;
+        simd::Isa isa;
+        EventNoiseFilter::Path noise_path;
+        if (name == "noise_filter" && parse_path(value, noise_path)) {
+            EventNoiseFilter::set_auto_path(noise_path);
+            choice.backend = EventNoiseFilter::path_name(noise_path);
+        } else if (simd::parse_kernel(name, kernel) && simd::parse_isa(value, isa)) {
+            simd::set_isa(kernel, isa);
+            choice.backend = simd::isa_name(simd::get_isa(kernel));    // Capped to what runs here
+        } else {
+            std::cerr << "BackendTuner: Ignoring override \"" << entry
+                      << "\" (expected kernel:scalar|sse41|avx2|avx512 or noise_filter:scalar|sse4.1|avx2)" << std::endl;
+            continue;
+        }
+
+        auto existing = std::find_if(choices_.begin(), choices_.end(),
+                                     [&name](const Choice& other) { return other.kernel == name; });
+        if (existing != choices_.end()) {
+            choice.timings = existing->timings;
+            *existing = choice;
+        } else {
+            choices_.push_back(choice);
+        }
+    }
+}
+
+bool BackendTuner::parse_path(const std::string& name, EventNoiseFilter::Path& path) {
+    if (name == "scalar") path = EventNoiseFilter::Path::Scalar;
+    else if (name == "sse4.1" || name == "sse41") path = EventNoiseFilter::Path::SSE41;
+    else if (name == "avx2") path = EventNoiseFilter::Path::AVX2;
+    else return false;
+    return true;
+}
+
+} // namespace video
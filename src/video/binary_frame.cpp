@@ -0,0 +1,346 @@
+#include "video/binary_frame.h"
+#include <algorithm>
+#include <cstdlib>
+#include "video/simd_utils.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace video {
+
+BinaryFrame::BinaryFrame(int width, int height) {
+    create(width, height);
+}
+
+void BinaryFrame::create(int width, int height) {
+    width_ = std::max(0, width);
+    height_ = std::max(0, height);
+    words_per_row_ = (width_ + 63) / 64;
+    words_.assign(static_cast<size_t>(words_per_row_) * height_, 0);
+}
+
+void BinaryFrame::clear() {
+    std::fill(words_.begin(), words_.end(), 0);
+}
+
+BinaryFrame BinaryFrame::from_mat(const cv::Mat& mat) {
+    BinaryFrame frame;
+    frame.assign(mat);
+    return frame;
+}
+
+bool BinaryFrame::assign(const cv::Mat& mat) {
+    if (mat.empty() || mat.type() != CV_8UC1) {
+        return false;
+    }
+
+    if (mat.cols != width_ || mat.rows != height_) {
+        create(mat.cols, mat.rows);
+    }
+
+    for (int y = 0; y < height_; ++y) {
+        const uint8_t* src = mat.ptr<uint8_t>(y);
+        uint64_t* dst = row(y);
+
+        for (int w = 0; w < words_per_row_; ++w) {
+            const int x0 = w * 64;
+            const int n = std::min(64, width_ - x0);
+            uint64_t word = 0;
+            for (int i = 0; i < n; ++i) {
+                word |= uint64_t(src[x0 + i] != 0) << i;
+            }
+            dst[w] = word;
+        }
+    }
+    return true;
+}
+
+bool BinaryFrame::assign_masked(const cv::Mat& mat, uint8_t bit_mask, const BlockMap* blocks) {
+    if (mat.empty() || mat.depth() != CV_8U || bit_mask == 0) {
+        return false;
+    }
+
+    if (mat.cols != width_ || mat.rows != height_) {
+        create(mat.cols, mat.rows);
+    }
+
+    if (blocks && !blocks->matches(width_, height_)) {
+        blocks = nullptr;
+    }
+
+    const int step = mat.channels();
+    for (int y = 0; y < height_; ++y) {
+        const uint8_t* src = mat.ptr<uint8_t>(y);
+        uint64_t* dst = row(y);
+        const int by = y >> BlockMap::ROW_SHIFT;
+        if (blocks && !blocks->row_any(by)) {
+            std::fill(dst, dst + words_per_row_, 0);
+            continue;
+        }
+
+        for (int w = 0; w < words_per_row_; ++w) {
+            if (blocks && !blocks->block(w, by)) {
+                dst[w] = 0;
+                continue;
+            }
+            const int x0 = w * 64;
+            const int n = std::min(64, width_ - x0);
+            uint64_t word = 0;
+            if (step == 1) {
+                // Single channel (polarity planes): unit stride, same loop shape as assign()
+                for (int i = 0; i < n; ++i) {
+                    word |= uint64_t((src[x0 + i] & bit_mask) != 0) << i;
+                }
+            } else {
+                for (int i = 0; i < n; ++i) {
+                    word |= uint64_t((src[(x0 + i) * step] & bit_mask) != 0) << i;
+                }
+            }
+            dst[w] = word;
+        }
+    }
+    return true;
+}
+
+void BinaryFrame::to_mat(cv::Mat& out) const {
+    out.create(height_, width_, CV_8UC1);
+
+    for (int y = 0; y < height_; ++y) {
+        const uint64_t* src = row(y);
+        uint8_t* dst = out.ptr<uint8_t>(y);
+
+        for (int w = 0; w < words_per_row_; ++w) {
+            const int x0 = w * 64;
+            const int n = std::min(64, width_ - x0);
+            const uint64_t word = src[w];
+            for (int i = 0; i < n; ++i) {
+                dst[x0 + i] = ((word >> i) & 1u) ? 255 : 0;
+            }
+        }
+    }
+}
+
+cv::Mat BinaryFrame::to_mat() const {
+    cv::Mat out;
+    to_mat(out);
+    return out;
+}
+
+int BinaryFrame::popcount(uint64_t word) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<int>(__popcnt64(word));
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+int BinaryFrame::lowest_set_bit(uint64_t word) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index = 0;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int index = 0;
+    while (!((word >> index) & 1u)) ++index;
+    return index;
+#endif
+}
+
+int BinaryFrame::highest_set_bit(uint64_t word) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index = 0;
+    _BitScanReverse64(&index, word);
+    return static_cast<int>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(word);
+#else
+    int index = 63;
+    while (!((word >> index) & 1u)) --index;
+    return index;
+#endif
+}
+
+int64_t BinaryFrame::count() const {
+    return simd::count_bits(words_.data(), words_.size());
+}
+
+bool BinaryFrame::bitwise_and(const BinaryFrame& a, const BinaryFrame& b, BinaryFrame& out) {
+    if (a.size() != b.size()) return false;
+    if (out.size() != a.size()) out.create(a.width_, a.height_);
+
+    const uint64_t* wb = b.words_.data();
+    simd::bitwise_ternary(a.words_.data(), wb, wb, out.words_.data(), a.words_.size(), simd::TERN_A & simd::TERN_B);
+    return true;
+}
+
+bool BinaryFrame::bitwise_or(const BinaryFrame& a, const BinaryFrame& b, BinaryFrame& out) {
+    if (a.size() != b.size()) return false;
+    if (out.size() != a.size()) out.create(a.width_, a.height_);
+
+    const uint64_t* wb = b.words_.data();
+    simd::bitwise_ternary(a.words_.data(), wb, wb, out.words_.data(), a.words_.size(), simd::TERN_A | simd::TERN_B);
+    return true;
+}
+
+bool BinaryFrame::bitwise_andnot(const BinaryFrame& a, const BinaryFrame& b, BinaryFrame& out) {
+    if (a.size() != b.size()) return false;
+    if (out.size() != a.size()) out.create(a.width_, a.height_);
+
+    // Padding stays zero because a's padding is zero
+    const uint64_t* wb = b.words_.data();
+    simd::bitwise_ternary(a.words_.data(), wb, wb, out.words_.data(), a.words_.size(), simd::TERN_A & ~simd::TERN_B);
+    return true;
+}
+
+int64_t BinaryFrame::count_andnot(const BinaryFrame& a, const BinaryFrame& b) {
+    if (a.size() != b.size()) return -1;
+
+    const uint64_t* wb = b.words_.data();
+    return simd::count_ternary(a.words_.data(), wb, wb, a.words_.size(), simd::TERN_A & ~simd::TERN_B);
+}
+
+int64_t BinaryFrame::count_xor(const BinaryFrame& a, const BinaryFrame& b) {
+    if (a.size() != b.size()) return -1;
+
+    const uint64_t* wb = b.words_.data();
+    return simd::count_ternary(a.words_.data(), wb, wb, a.words_.size(), simd::TERN_A ^ simd::TERN_B);
+}
+
+namespace {
+
+// XXH64 constants
+constexpr uint64_t XXH_PRIME_1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t XXH_PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t XXH_PRIME_3 = 0x165667B19E3779F9ull;
+constexpr uint64_t XXH_PRIME_4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t XXH_PRIME_5 = 0x27D4EB2F165667C5ull;
+
+inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t xxh_round(uint64_t acc, uint64_t lane) {
+    acc += lane * XXH_PRIME_2;
+    return rotl64(acc, 31) * XXH_PRIME_1;
+}
+
+inline uint64_t xxh_merge(uint64_t acc, uint64_t value) {
+    acc ^= xxh_round(0, value);
+    return acc * XXH_PRIME_1 + XXH_PRIME_4;
+}
+
+} // namespace
+
+uint64_t BinaryFrame::hash(uint64_t seed) const {
+    const uint64_t* p = words_.data();
+    const size_t count = words_.size();
+    size_t i = 0;
+    uint64_t h;
+
+    // Four independent lanes of 32-byte stripes
+    if (count >= 4) {
+        uint64_t v1 = seed + XXH_PRIME_1 + XXH_PRIME_2;
+        uint64_t v2 = seed + XXH_PRIME_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME_1;
+        for (; i + 4 <= count; i += 4) {
+            v1 = xxh_round(v1, p[i]);
+            v2 = xxh_round(v2, p[i + 1]);
+            v3 = xxh_round(v3, p[i + 2]);
+            v4 = xxh_round(v4, p[i + 3]);
+        }
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh_merge(h, v1);
+        h = xxh_merge(h, v2);
+        h = xxh_merge(h, v3);
+        h = xxh_merge(h, v4);
+    } else {
+        h = seed + XXH_PRIME_5;
+    }
+    h += static_cast<uint64_t>(count) * sizeof(uint64_t);
+
+    for (; i < count; ++i) {
+        h ^= xxh_round(0, p[i]);
+        h = rotl64(h, 27) * XXH_PRIME_1 + XXH_PRIME_4;
+    }
+
+    // Avalanche
+    h ^= h >> 33;
+    h *= XXH_PRIME_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME_3;
+    h ^= h >> 32;
+    return h;
+}
+
+bool BinaryFrame::shift(const BinaryFrame& src, int dx, int dy, BinaryFrame& out) {
+    if (&src == &out) return false;
+    if (out.size() != src.size()) {
+        out.create(src.width_, src.height_);
+    }
+    if (src.empty()) return true;
+
+    const int words = src.words_per_row_;
+    const int word_shift = std::abs(dx) / 64;
+    const int bit_shift = std::abs(dx) % 64;
+    const uint64_t last_mask = (src.width_ % 64) ? (uint64_t(1) << (src.width_ % 64)) - 1 : ~uint64_t(0);
+
+    // Word w of the source row, zero outside the row
+    auto word_at = [words](const uint64_t* row, int w) -> uint64_t {
+        return (w >= 0 && w < words) ? row[w] : 0;
+    };
+
+    for (int y = 0; y < src.height_; ++y) {
+        uint64_t* dst = out.row(y);
+        const int sy = y - dy;
+        if (sy < 0 || sy >= src.height_) {
+            std::fill(dst, dst + words, uint64_t(0));
+            continue;
+        }
+
+        const uint64_t* row = src.row(sy);
+        for (int w = 0; w < words; ++w) {
+            uint64_t word;
+            if (dx >= 0) {
+                // Pixels move to higher x (higher bits)
+                word = word_at(row, w - word_shift) << bit_shift;
+                if (bit_shift) word |= word_at(row, w - word_shift - 1) >> (64 - bit_shift);
+            } else {
+                word = word_at(row, w + word_shift) >> bit_shift;
+                if (bit_shift) word |= word_at(row, w + word_shift + 1) << (64 - bit_shift);
+            }
+            dst[w] = word;
+        }
+        dst[words - 1] &= last_mask;  // Keep padding zero
+    }
+    return true;
+}
+
+bool BinaryFrame::overlap(const BinaryFrame& a, const BinaryFrame& b, Overlap& out) {
+    if (a.size() != b.size()) return false;
+
+    // Three vectorized counting passes; both frames stay in cache between them
+    const uint64_t* wa = a.words_.data();
+    const uint64_t* wb = b.words_.data();
+    const size_t words = a.words_.size();
+    const int64_t both = simd::count_ternary(wa, wb, wb, words, simd::TERN_A & simd::TERN_B);
+    const int64_t a_only = simd::count_bits(wa, words) - both;
+    const int64_t b_only = simd::count_bits(wb, words) - both;
+
+    // Padding bits are zero in both frames, so they never reach the three counts
+    out.both = both;
+    out.a_only = a_only;
+    out.b_only = b_only;
+    out.neither = static_cast<int64_t>(a.width_) * a.height_ - both - a_only - b_only;
+    return true;
+}
+
+} // namespace video
@@ -0,0 +1,507 @@
+#include "video/binary_frame_accumulator.h"
+#include <metavision/sdk/core/utils/colors.h>
+#include <algorithm>
+#include <limits>
+
+namespace video {
+
+BinaryFrameAccumulator::BinaryFrameAccumulator(int width, int height, uint32_t accumulation_time_us)
+    : width_(width)
+    , height_(height)
+    , accumulation_time_us_(std::max<uint32_t>(1, accumulation_time_us)) {
+    pool_.reserve(POOL_SIZE);
+    for (int i = 0; i < POOL_SIZE; ++i) {
+        pool_.emplace_back(height_, width_, CV_8UC1);
+    }
+    block_pool_.reserve(POOL_SIZE);
+    for (int i = 0; i < POOL_SIZE; ++i) {
+        block_pool_.push_back(std::make_shared<BlockMap>());
+    }
+    set_binary_bits(5, 6);
+}
+
+void BinaryFrameAccumulator::set_binary_bits(int bit_1, int bit_2) {
+    bit_mask_ = (1 << std::clamp(bit_1, 0, 7)) | (1 << std::clamp(bit_2, 0, 7));
+    update_pixel_values();
+}
+
+void BinaryFrameAccumulator::reconfigure(uint32_t accumulation_time_us, int bit_1, int bit_2) {
+    pending_accumulation_time_us_ = std::max<uint32_t>(1, accumulation_time_us);
+    pending_bit_mask_ = (1 << std::clamp(bit_1, 0, 7)) | (1 << std::clamp(bit_2, 0, 7));
+    pending_align_ = true;
+    pending_ = true;
+    if (next_flush_ts_ < 0) {
+        apply_pending(-1);  // No window open yet
+    }
+}
+
+void BinaryFrameAccumulator::set_accumulation_time(uint32_t accumulation_time_us) {
+    if (!pending_) {
+        pending_bit_mask_ = bit_mask_;
+        pending_align_ = false;
+    }
+    pending_accumulation_time_us_ = std::max<uint32_t>(1, accumulation_time_us);
+    pending_ = true;
+    if (next_flush_ts_ < 0) {
+        apply_pending(-1);  // No window open yet
+    }
+}
+
+void BinaryFrameAccumulator::apply_pending(Metavision::timestamp ts) {
+    pending_ = false;
+    accumulation_time_us_ = pending_accumulation_time_us_;
+    if (pending_bit_mask_ != bit_mask_) {
+        bit_mask_ = pending_bit_mask_;
+        update_pixel_values();
+    }
+    if (ts >= 0 && slice_mode_ == SliceMode::Time) {
+        // Next boundary on the new grid, where the window after ts may come out short once,
+        // or a whole new window from ts when only the length changes
+        next_flush_ts_ = pending_align_ ? (ts / accumulation_time_us_ + 1) * accumulation_time_us_
+                                        : ts + accumulation_time_us_;
+    }
+}
+
+void BinaryFrameAccumulator::set_polarity_planes(bool enabled) {
+    polarity_planes_ = enabled;
+    update_pixel_values();
+}
+
+void BinaryFrameAccumulator::set_slicing(SliceMode mode, uint32_t slice_events) {
+    slice_mode_ = mode;
+    slice_events_ = std::max<uint32_t>(1, slice_events);
+}
+
+void BinaryFrameAccumulator::set_packed_output(bool enabled) {
+    packed_output_ = enabled;
+    if (enabled && packed_.empty()) {
+        packed_.create(width_, height_);
+    }
+    update_pixel_values();
+}
+
+void BinaryFrameAccumulator::set_preview_binning(int binning) {
+    const int shift = binning >= MAX_PREVIEW_BINNING ? 2 : binning >= 2 ? 1 : 0;
+    if (shift == preview_shift_) {
+        return;
+    }
+    preview_shift_ = shift;
+    preview_pool_.clear();
+    preview_.release();
+    if (shift != 0) {
+        const int rows = (height_ + (1 << shift) - 1) >> shift;
+        const int cols = (width_ + (1 << shift) - 1) >> shift;
+        preview_pool_.reserve(POOL_SIZE);
+        for (int i = 0; i < POOL_SIZE; ++i) {
+            preview_pool_.emplace_back(rows, cols, CV_8UC1);
+        }
+        if (next_flush_ts_ >= 0) {
+            acquire(preview_pool_, preview_, rows, cols);
+            preview_.setTo(0);  // Starts mid-window: events before now are missing from this one
+        }
+    }
+}
+
+void BinaryFrameAccumulator::set_parallel_threads(int threads) {
+    threads = std::clamp(threads, 1, MAX_PARALLEL_THREADS);
+    if (threads == get_parallel_threads()) {
+        return;
+    }
+    parallel_pool_.reset();
+    band_events_.clear();
+    if (threads == 1) {
+        return;
+    }
+    parallel_pool_ = std::make_unique<ThreadPool>(threads - 1);
+
+    // A few bands per thread so work stealing evens out busy regions; whole preview
+    // blocks and occupancy block rows per band, so no two bands write the same byte
+    const int align = std::max(MAX_PREVIEW_BINNING, BlockMap::BLOCK_ROWS);
+    const int bands = std::min(threads * 4, std::max(height_ / align, 1));
+    parallel_band_rows_ = (height_ + bands - 1) / bands;
+    parallel_band_rows_ = (parallel_band_rows_ + align - 1) / align * align;
+    const size_t band_count = static_cast<size_t>((height_ + parallel_band_rows_ - 1) / parallel_band_rows_);
+    band_events_.resize(band_count);
+    band_bits_.assign(band_count, 0);
+    band_stats_.assign(band_count, FrameStats{});
+}
+
+const cv::Mat& BinaryFrameAccumulator::preview_frame() const {
+    static const cv::Mat none;
+    return bg_value_ == 0 ? preview_ : none;
+}
+
+void BinaryFrameAccumulator::update_pixel_values() {
+    const int mask = bit_mask_;
+
+    // Same palette the SDK frame generator uses; the old pipeline read channel 0 (blue)
+    using Metavision::ColorPalette;
+    using Metavision::ColorType;
+    const uint8_t bg = Metavision::get_bgr_color(ColorPalette::Dark, ColorType::Background)[0];
+    const uint8_t off = Metavision::get_bgr_color(ColorPalette::Dark, ColorType::Negative)[0];
+    const uint8_t on = Metavision::get_bgr_color(ColorPalette::Dark, ColorType::Positive)[0];
+
+    bg_value_ = (bg & mask) ? 255 : 0;
+    polarity_value_[0] = (off & mask) ? 255 : 0;
+    polarity_value_[1] = (on & mask) ? 255 : 0;
+    keep_mask_[0] = keep_mask_[1] = 0;
+
+    if (polarity_planes_) {
+        bg_value_ &= SET_BITS;
+        for (int p = 0; p < 2; ++p) {
+            const bool set = polarity_value_[p] != 0;
+            polarity_value_[p] = set ? static_cast<uint8_t>(SET_BITS | (p ? ON_BIT : OFF_BIT)) : 0;
+            keep_mask_[p] = set ? static_cast<uint8_t>(OFF_BIT | ON_BIT) : 0;  // Hidden polarity clears the pixel
+        }
+    }
+
+    // An event leaves its pixel non-zero exactly when its polarity value is
+    polarity_bits_[0] = polarity_value_[0] ? ~uint64_t(0) : 0;
+    polarity_bits_[1] = polarity_value_[1] ? ~uint64_t(0) : 0;
+
+    // A white background would need a full fill per window; pack the finished frame instead
+    packed_per_event_ = bg_value_ == 0;
+
+    // Preview blocks are 0/255 whatever the frame encoding; with a white background there is none
+    preview_value_[0] = polarity_value_[0] ? 255 : 0;
+    preview_value_[1] = polarity_value_[1] ? 255 : 0;
+}
+
+void BinaryFrameAccumulator::set_output_callback(OutputCallback callback) {
+    output_callback_ = std::move(callback);
+}
+
+void BinaryFrameAccumulator::process_events(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    if (begin == end) return;
+
+    if (next_flush_ts_ < 0) {
+        // Align windows to multiples of the accumulation time, like the SDK generator
+        next_flush_ts_ = (begin->t / accumulation_time_us_ + 1) * accumulation_time_us_;
+        frame_start_ts_ = next_flush_ts_ - accumulation_time_us_;
+        begin_frame();
+    }
+
+    dispatch(begin, end, slice_mode_ != SliceMode::Time);
+}
+
+void BinaryFrameAccumulator::dispatch(const Metavision::EventCD* begin, const Metavision::EventCD* end, bool slices) {
+    using Loop = void (BinaryFrameAccumulator::*)(const Metavision::EventCD*, const Metavision::EventCD*, bool);
+    static constexpr Loop loops[8] = {
+        &BinaryFrameAccumulator::accumulate_modes<false, false, false>,
+        &BinaryFrameAccumulator::accumulate_modes<false, false, true>,
+        &BinaryFrameAccumulator::accumulate_modes<false, true, false>,
+        &BinaryFrameAccumulator::accumulate_modes<false, true, true>,
+        &BinaryFrameAccumulator::accumulate_modes<true, false, false>,
+        &BinaryFrameAccumulator::accumulate_modes<true, false, true>,
+        &BinaryFrameAccumulator::accumulate_modes<true, true, false>,
+        &BinaryFrameAccumulator::accumulate_modes<true, true, true>,
+    };
+    const bool packed = packed_output_ && packed_per_event_;
+    const bool preview = !preview_.empty();
+    (this->*loops[(polarity_planes_ ? 4 : 0) | (packed ? 2 : 0) | (preview ? 1 : 0)])(begin, end, slices);
+}
+
+template <bool Planes, bool Packed, bool Preview>
+void BinaryFrameAccumulator::accumulate_modes(const Metavision::EventCD* begin, const Metavision::EventCD* end,
+                                              bool slices) {
+    if (slices) {
+        accumulate_slices<Planes, Packed, Preview>(begin, end);
+    } else {
+        accumulate<Planes, Packed, Preview>(begin, end);
+    }
+}
+
+template <bool Planes, bool Packed, bool Preview>
+void BinaryFrameAccumulator::accumulate_slices(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    const bool time_limit = slice_mode_ == SliceMode::EventsOrTime;
+
+    for (const Metavision::EventCD* it = begin; it != end;) {
+        if (slice_count_ == 0) {
+            // The time limit runs from the frame's first event, not from a window grid
+            next_flush_ts_ = time_limit ? it->t + static_cast<Metavision::timestamp>(accumulation_time_us_)
+                                        : std::numeric_limits<Metavision::timestamp>::max();
+            frame_start_ts_ = it->t;
+        }
+
+        // Span up to the count limit, cut short at the time limit (timestamps are sorted)
+        const Metavision::EventCD* span_end =
+            it + std::min<size_t>(slice_events_ - slice_count_, static_cast<size_t>(end - it));
+        if (time_limit) {
+            span_end = std::lower_bound(it, span_end, next_flush_ts_,
+                [](const Metavision::EventCD& event, Metavision::timestamp ts) { return event.t < ts; });
+        }
+
+        // No event of the span reaches next_flush_ts_, so this never emits
+        accumulate<Planes, Packed, Preview>(it, span_end);
+        slice_count_ += static_cast<uint32_t>(span_end - it);
+        const Metavision::timestamp last_ts = span_end != it ? (span_end - 1)->t : 0;
+        it = span_end;
+
+        if (slice_count_ >= slice_events_) {
+            flush(last_ts + 1);  // Stamped just past its last event
+            slice_count_ = 0;
+        } else if (it != end) {
+            flush(next_flush_ts_);  // Next event is past the time limit
+            slice_count_ = 0;
+        }
+    }
+}
+
+template <bool Planes, bool Packed, bool Preview>
+void BinaryFrameAccumulator::accumulate(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    for (auto it = begin; it != end;) {
+        if (it->t >= next_flush_ts_) {
+            flush(next_flush_ts_);
+
+            // Skip over idle gaps: emit one background frame, not one per empty window
+            if (it->t >= next_flush_ts_) {
+                next_flush_ts_ = (it->t / accumulation_time_us_ + 1) * accumulation_time_us_;
+                frame_start_ts_ = next_flush_ts_ - accumulation_time_us_;
+            }
+        }
+
+        // Rest of the window (timestamps are sorted)
+        const Metavision::timestamp flush_ts = next_flush_ts_;
+        const Metavision::EventCD* span_end = std::partition_point(it, end,
+            [flush_ts](const Metavision::EventCD& event) { return event.t < flush_ts; });
+
+        if (parallel_pool_ && static_cast<size_t>(span_end - it) >= PARALLEL_MIN_EVENTS) {
+            write_span_parallel<Planes, Packed, Preview>(it, span_end, row_bands_.bands, frame_stats_);
+        } else {
+            write_span<Planes, Packed, Preview>(it, span_end, row_bands_.bands, frame_stats_);
+        }
+        frame_stats_.events += static_cast<uint64_t>(span_end - it);
+        it = span_end;
+    }
+}
+
+template <bool Planes, bool Packed, bool Preview>
+void BinaryFrameAccumulator::write_span_parallel(const Metavision::EventCD* begin, const Metavision::EventCD* end,
+                                                 uint64_t& bands, FrameStats& stats) {
+    // One pass buckets the span; order within a band (and so per pixel) is kept
+    for (auto& band : band_events_) {
+        band.clear();
+    }
+    const int band_rows = parallel_band_rows_;
+    for (auto it = begin; it != end; ++it) {
+        band_events_[it->y / band_rows].push_back(*it);
+    }
+
+    parallel_pool_->parallel_for(static_cast<int>(band_events_.size()), [this](int i) {
+        const auto& events = band_events_[i];
+        band_bits_[i] = 0;
+        band_stats_[i] = FrameStats{};
+        write_span<Planes, Packed, Preview>(events.data(), events.data() + events.size(),
+                                            band_bits_[i], band_stats_[i]);
+    });
+
+    for (size_t i = 0; i < band_events_.size(); ++i) {
+        bands |= band_bits_[i];
+        stats.merge_span(band_stats_[i]);
+    }
+}
+
+template <bool Planes, bool Packed, bool Preview>
+void BinaryFrameAccumulator::write_span(const Metavision::EventCD* begin, const Metavision::EventCD* end,
+                                        uint64_t& bands_out, FrameStats& stats) {
+    uint8_t* data = current_.data;
+    const size_t step = current_.step[0];
+    uint64_t* bits = packed_.data();
+    const size_t words_per_row = static_cast<size_t>(packed_.words_per_row());
+    uint8_t* preview = preview_.data;
+    const size_t preview_step = Preview ? preview_.step[0] : 0;
+    const int shift = preview_shift_;
+    uint8_t* blocks = blocks_->data();
+    const size_t block_cols = static_cast<size_t>(blocks_->cols());
+    uint64_t bands = 0;
+    FrameStats span;
+
+    for (auto it = begin; it != end; ++it) {
+        const int p = it->p & 1;
+        span.on_events += static_cast<uint64_t>(p);
+        uint8_t& pixel = data[it->y * step + it->x];
+        const uint8_t before = pixel;
+        if (Planes) {
+            pixel = static_cast<uint8_t>((before & keep_mask_[p]) | polarity_value_[p]);
+        } else {
+            pixel = polarity_value_[p];
+        }
+        span.active_pixels += int64_t(pixel != 0) - int64_t(before != 0);
+        span.x_min = std::min<int>(span.x_min, it->x);
+        span.x_max = std::max<int>(span.x_max, it->x);
+        span.y_min = std::min<int>(span.y_min, it->y);
+        span.y_max = std::max<int>(span.y_max, it->y);
+        if (Packed) {
+            const uint64_t bit = uint64_t(1) << (it->x & 63);
+            uint64_t& word = bits[it->y * words_per_row + (it->x >> 6)];
+            word = (word & ~bit) | (bit & polarity_bits_[p]);
+        }
+        if (Preview) {
+            preview[(it->y >> shift) * preview_step + (it->x >> shift)] |= preview_value_[p];
+        }
+        bands |= uint64_t(1) << std::min(it->y / RowBands::BAND_ROWS, 63);
+        blocks[(it->y >> BlockMap::ROW_SHIFT) * block_cols + (it->x >> BlockMap::COL_SHIFT)] = 1;
+    }
+    bands_out |= bands;
+    stats.merge_span(span);
+}
+
+void BinaryFrameAccumulator::reset() {
+    next_flush_ts_ = -1;
+    slice_count_ = 0;
+    current_.release();
+    preview_.release();
+    if (pending_) {
+        apply_pending(-1);
+    }
+}
+
+void BinaryFrameAccumulator::process_catch_up(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    if (begin == end) return;
+
+    if (next_flush_ts_ < 0) {
+        begin_frame();
+    }
+    next_flush_ts_ = std::numeric_limits<Metavision::timestamp>::max();  // No boundary until end_catch_up()
+    dispatch(begin, end, false);
+}
+
+void BinaryFrameAccumulator::end_catch_up(Metavision::timestamp last_ts) {
+    if (next_flush_ts_ < 0) return;
+
+    // Stamped with the end of the last window it covers, like a regular frame
+    const Metavision::timestamp window_end = (last_ts / accumulation_time_us_ + 1) * accumulation_time_us_;
+    if (packed_output_ && !packed_per_event_) {
+        packed_.assign(current_);
+    }
+    if (packed_input_) {
+        unpack_packed_input();
+    }
+    set_emitted(window_end);
+    if (output_callback_) {
+        output_callback_(window_end, current_);
+    }
+    next_flush_ts_ = window_end + accumulation_time_us_;
+    frame_start_ts_ = window_end;
+    slice_count_ = 0;
+    if (pending_) {
+        apply_pending(window_end);
+    }
+    begin_frame();
+}
+
+void BinaryFrameAccumulator::cross_window(Metavision::timestamp ts) {
+    if (next_flush_ts_ < 0) {
+        // Same alignment as process_events()
+        next_flush_ts_ = (ts / accumulation_time_us_ + 1) * accumulation_time_us_;
+        frame_start_ts_ = next_flush_ts_ - accumulation_time_us_;
+        begin_frame();
+        return;
+    }
+
+    flush(next_flush_ts_);
+
+    // Skip over idle gaps: emit one background frame, not one per empty window
+    if (ts >= next_flush_ts_) {
+        next_flush_ts_ = (ts / accumulation_time_us_ + 1) * accumulation_time_us_;
+        frame_start_ts_ = next_flush_ts_ - accumulation_time_us_;
+    }
+}
+
+void BinaryFrameAccumulator::unpack_packed_input() {
+    // current_ was cleared to the (black) background; only set bits need a store
+    const int words_per_row = packed_.words_per_row();
+    for (uint64_t bands = row_bands_.bands; bands != 0; bands &= bands - 1) {
+        const int band = BinaryFrame::lowest_set_bit(bands);
+        const int row_end = std::min(band == 63 ? height_ : (band + 1) * RowBands::BAND_ROWS, height_);
+        for (int y = band * RowBands::BAND_ROWS; y < row_end; ++y) {
+            const uint64_t* src = packed_.row(y);
+            uint8_t* dst = current_.ptr<uint8_t>(y);
+            for (int w = 0; w < words_per_row; ++w) {
+                for (uint64_t word = src[w]; word != 0; word &= word - 1) {
+                    dst[w * 64 + BinaryFrame::lowest_set_bit(word)] = polarity_value_[1] | polarity_value_[0];
+                }
+            }
+        }
+    }
+    packed_input_ = false;
+}
+
+void BinaryFrameAccumulator::flush(Metavision::timestamp ts) {
+    if (packed_output_ && !packed_per_event_) {
+        packed_.assign(current_);
+    }
+    if (packed_input_) {
+        unpack_packed_input();
+    }
+    set_emitted(ts);
+    if (output_callback_) {
+        output_callback_(ts, current_);
+    }
+    next_flush_ts_ += accumulation_time_us_;
+    frame_start_ts_ = ts;
+    if (pending_) {
+        apply_pending(ts);
+    }
+    begin_frame();
+}
+
+void BinaryFrameAccumulator::set_emitted(Metavision::timestamp ts) {
+    emitted_window_us_ = static_cast<uint32_t>(std::clamp<Metavision::timestamp>(
+        ts - frame_start_ts_, 0, std::numeric_limits<uint32_t>::max()));
+    emitted_stats_ = frame_stats_;
+    blocks_->finish();
+}
+
+void BinaryFrameAccumulator::acquire(std::vector<cv::Mat>& pool, cv::Mat& frame, int rows, int cols) {
+    // Drop our own handle first so refcount reflects outside holders only
+    frame.release();
+
+    for (auto& slot : pool) {
+        if (slot.u && slot.u->refcount == 1) {
+            frame = slot;
+            break;
+        }
+    }
+
+    // Every slot still in use downstream: hand out a fresh buffer
+    if (frame.empty()) {
+        frame.create(rows, cols, CV_8UC1);
+    }
+}
+
+void BinaryFrameAccumulator::acquire_blocks() {
+    blocks_.reset();
+    for (auto& map : block_pool_) {
+        if (map.use_count() == 1) {
+            blocks_ = map;
+            break;
+        }
+    }
+    if (!blocks_) {
+        blocks_ = std::make_shared<BlockMap>();
+    }
+    blocks_->reset(width_, height_);
+}
+
+void BinaryFrameAccumulator::begin_frame() {
+    acquire(pool_, current_, height_, width_);
+    acquire_blocks();
+    current_.setTo(bg_value_);
+    if (preview_shift_ != 0) {
+        const int rows = (height_ + (1 << preview_shift_) - 1) >> preview_shift_;
+        const int cols = (width_ + (1 << preview_shift_) - 1) >> preview_shift_;
+        acquire(preview_pool_, preview_, rows, cols);
+        preview_.setTo(0);
+    }
+    frame_stats_ = FrameStats{};
+    frame_stats_.active_pixels = bg_value_ ? int64_t(width_) * height_ : 0;
+    row_bands_.bands = 0;
+    row_bands_.background = bg_value_;
+    packed_input_ = false;
+    if (packed_output_ && packed_per_event_) {
+        packed_.clear();
+    }
+}
+
+} // namespace video
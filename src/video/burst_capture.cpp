@@ -0,0 +1,350 @@
+#include "video/burst_capture.h"
+#include "core/thread_placement.h"
+#include "video/direct_file_writer.h"
+#include <opencv2/imgcodecs.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <new>
+
+namespace fs = std::filesystem;
+
+namespace video {
+
+BurstCapture::BurstCapture() {
+    thread_ = std::thread(&BurstCapture::worker_loop, this);
+}
+
+BurstCapture::~BurstCapture() {
+    {
+        std::lock_guard<std::mutex> lock(worker_mutex_);
+        stopping_ = true;
+    }
+    worker_cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();  // A burst still waiting to be written is flushed first
+    }
+}
+
+bool BurstCapture::arm(cv::Size size, int pre_frames, int post_frames, const std::string& path) {
+    if (size.area() <= 0 || pre_frames < 0 || post_frames < 1 || path.empty()) {
+        std::cerr << "BurstCapture: Invalid burst window" << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(ring_mutex_);
+    if (state_.load() != State::Idle) {
+        std::cerr << "BurstCapture: Already armed or still writing the last burst" << std::endl;
+        return false;
+    }
+
+    // Allocate every slot up front so the producer never allocates
+    const size_t capacity = static_cast<size_t>(pre_frames) + static_cast<size_t>(post_frames);
+    if (slots_.size() != capacity || size_ != size) {
+        try {
+            slots_.clear();
+            slots_.resize(capacity);
+            for (Slot& slot : slots_) {
+                slot.frame.create(size.width, size.height);
+            }
+        } catch (const std::bad_alloc&) {
+            slots_.clear();
+            slots_.shrink_to_fit();
+            ring_bytes_ = 0;
+            std::cerr << "BurstCapture: Not enough memory for " << capacity << " frames" << std::endl;
+            return false;
+        }
+        ring_bytes_ = capacity * slots_.front().frame.word_count() * sizeof(uint64_t);
+    }
+
+    size_ = size;
+    pre_frames_ = pre_frames;
+    post_frames_ = post_frames;
+    path_ = path;
+    write_seq_ = 0;
+    trigger_seq_ = 0;
+    buffered_seq_ = 0;
+    trigger_seq_ui_ = 0;
+    frames_ignored_ = 0;
+    trigger_requested_ = false;
+    write_error_ = false;
+
+    state_ = State::Armed;
+    capturing_.store(true, std::memory_order_release);
+    std::cout << "Burst capture armed: " << pre_frames << " + " << post_frames << " frames ("
+              << get_ring_bytes() / (1024.0 * 1024.0) << " MiB)" << std::endl;
+    return true;
+}
+
+bool BurstCapture::arm_window(cv::Size size, int max_frames, const std::string& path) {
+    if (!arm(size, 0, max_frames, path)) {
+        return false;
+    }
+    trigger();   // The first frame pushed opens the window
+    return true;
+}
+
+void BurstCapture::finish() {
+    std::lock_guard<std::mutex> lock(ring_mutex_);
+    const State state = state_.load();
+    if (state == State::Triggered && write_seq_ > trigger_seq_) {
+        request_flush();
+    } else if (state == State::Armed || state == State::Triggered) {
+        capturing_ = false;
+        state_ = State::Idle;   // Nothing in the window to write
+    }
+}
+
+void BurstCapture::request_flush() {
+    // Window complete: hand the ring to the writer thread
+    capturing_.store(false, std::memory_order_release);
+    state_.store(State::Flushing, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> worker_lock(worker_mutex_);
+        flush_requested_ = true;
+    }
+    worker_cv_.notify_one();
+}
+
+void BurstCapture::disarm() {
+    std::lock_guard<std::mutex> lock(ring_mutex_);
+    const State state = state_.load();
+    if (state == State::Armed || state == State::Triggered) {
+        capturing_ = false;
+        state_ = State::Idle;
+        std::cout << "Burst capture disarmed" << std::endl;
+    }
+}
+
+bool BurstCapture::pack(const cv::Mat& frame, uint8_t bit_mask, BinaryFrame& out) {
+    return bit_mask == 0 ? out.assign(frame) : out.assign_masked(frame, bit_mask);
+}
+
+void BurstCapture::push_frame(const cv::Mat& frame, int64_t timestamp_us, uint8_t bit_mask) {
+    std::lock_guard<std::mutex> lock(ring_mutex_);
+    State state = state_.load(std::memory_order_acquire);
+    if (state != State::Armed && state != State::Triggered) {
+        return;  // Disarmed since the fast-path check
+    }
+
+    if (frame.size() != size_) {
+        frames_ignored_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // The frame that sees the trigger is the first post-trigger frame
+    if (state == State::Armed && trigger_requested_.exchange(false)) {
+        trigger_seq_ = write_seq_;
+        trigger_seq_ui_.store(trigger_seq_, std::memory_order_relaxed);
+        state = State::Triggered;
+        state_.store(state, std::memory_order_release);
+    }
+
+    Slot& slot = slots_[write_seq_ % slots_.size()];
+    if (!pack(frame, bit_mask, slot.frame)) {
+        frames_ignored_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    slot.timestamp_us = timestamp_us;
+    slot.sequence = write_seq_;
+    ++write_seq_;
+    buffered_seq_.store(write_seq_, std::memory_order_relaxed);
+
+    if (state == State::Triggered && write_seq_ - trigger_seq_ >= static_cast<uint64_t>(post_frames_)) {
+        request_flush();
+    }
+}
+
+bool BurstCapture::request_export(std::vector<int> png_params) {
+    if (get_last_file().empty() || exporting_.load()) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(worker_mutex_);
+        if (export_requested_) {
+            return false;
+        }
+        export_requested_ = true;
+        export_params_ = std::move(png_params);
+        exporting_ = true;
+    }
+    worker_cv_.notify_one();
+    return true;
+}
+
+int BurstCapture::get_buffered_frames() const {
+    const uint64_t pushed = buffered_seq_.load(std::memory_order_relaxed);
+    return static_cast<int>(std::min<uint64_t>(pushed, slots_.size()));
+}
+
+int BurstCapture::get_post_frames_remaining() const {
+    if (get_state() != State::Triggered) {
+        return 0;
+    }
+    const uint64_t captured = buffered_seq_.load(std::memory_order_relaxed) -
+                              trigger_seq_ui_.load(std::memory_order_relaxed);
+    return std::max(0, post_frames_ - static_cast<int>(captured));
+}
+
+size_t BurstCapture::release_ring() {
+    std::lock_guard<std::mutex> lock(ring_mutex_);
+    if (state_.load() != State::Idle || slots_.empty()) {
+        return 0;
+    }
+    const size_t freed = ring_bytes_.exchange(0);
+    slots_.clear();
+    slots_.shrink_to_fit();
+    return freed;
+}
+
+std::string BurstCapture::get_last_file() const {
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    return last_file_;
+}
+
+void BurstCapture::worker_loop() {
+    core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::IO);
+    while (true) {
+        bool flush = false;
+        bool do_export = false;
+        std::vector<int> export_params;
+        {
+            std::unique_lock<std::mutex> lock(worker_mutex_);
+            worker_cv_.wait(lock, [this] { return stopping_ || flush_requested_ || export_requested_; });
+            flush = flush_requested_;
+            do_export = export_requested_ && !flush;  // Export whatever is newest once written
+            flush_requested_ = false;
+            export_requested_ = export_requested_ && !do_export;
+            if (do_export) {
+                export_params = std::move(export_params_);
+            }
+            if (!flush && !do_export && stopping_) {
+                break;
+            }
+        }
+
+        if (flush) {
+            if (write_burst()) {
+                std::lock_guard<std::mutex> lock(file_mutex_);
+                last_file_ = path_;
+            }
+            state_.store(State::Idle, std::memory_order_release);
+        }
+
+        if (do_export) {
+            export_png(get_last_file(), "", std::move(export_params));
+            exporting_ = false;
+        }
+    }
+}
+
+bool BurstCapture::write_burst() {
+    // Only the writer touches the ring while Flushing
+    const uint64_t end = write_seq_;
+    const uint64_t count = std::min<uint64_t>(end, slots_.size());
+    const uint64_t first = end - count;
+
+    burst_file::FileHeader header{};
+    std::memcpy(header.magic, burst_file::MAGIC, sizeof(header.magic));
+    header.version = burst_file::VERSION;
+    header.width = static_cast<uint16_t>(size_.width);
+    header.height = static_cast<uint16_t>(size_.height);
+    header.words_per_row = static_cast<uint32_t>(slots_.front().frame.words_per_row());
+    header.frame_count = static_cast<uint32_t>(count);
+    header.trigger_index = static_cast<uint32_t>(trigger_seq_ - first);
+
+    std::error_code ec;
+    fs::path path(path_);
+    if (path.has_parent_path()) {
+        fs::create_directories(path.parent_path(), ec);
+    }
+
+    // Size is known up front: one extent, written past the page cache
+    const uint64_t frame_bytes = slots_.front().frame.word_count() * sizeof(uint64_t);
+    DirectFileWriter::Options options;
+    options.preallocate_bytes = sizeof(header) + count * (sizeof(burst_file::FrameRecord) + frame_bytes);
+    DirectFileWriter file;
+    if (!file.open(path_, options)) {
+        std::cerr << "BurstCapture: Failed to create " << path_ << std::endl;
+        write_error_ = true;
+        return false;
+    }
+
+    bool ok = file.append(&header, sizeof(header));
+    for (uint64_t seq = first; ok && seq < end; ++seq) {
+        const Slot& slot = slots_[seq % slots_.size()];
+        const burst_file::FrameRecord record{slot.timestamp_us, slot.sequence};
+        ok = file.append(&record, sizeof(record)) &&
+             file.append(slot.frame.data(), slot.frame.word_count() * sizeof(uint64_t));
+    }
+    ok = file.close() && ok;
+
+    if (!ok) {
+        std::cerr << "BurstCapture: Write failed: " << path_ << std::endl;
+        write_error_ = true;
+        return false;
+    }
+
+    std::cout << "Burst saved: " << path_ << " (" << count << " frames, trigger at frame "
+              << header.trigger_index << ")" << std::endl;
+    return true;
+}
+
+int BurstCapture::export_png(const std::string& burst_path, const std::string& directory,
+                             std::vector<int> png_params) {
+    FILE* file = std::fopen(burst_path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "BurstCapture: Failed to open " << burst_path << std::endl;
+        return -1;
+    }
+
+    burst_file::FileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || !burst_file::is_valid(header)) {
+        std::cerr << "BurstCapture: " << burst_path << " is not a burst file" << std::endl;
+        std::fclose(file);
+        return -1;
+    }
+
+    const fs::path source(burst_path);
+    const fs::path out_dir = directory.empty() ? source.parent_path() / source.stem() : fs::path(directory);
+    std::error_code ec;
+    fs::create_directories(out_dir, ec);
+
+    BinaryFrame frame(header.width, header.height);
+    cv::Mat image;
+    if (png_params.empty()) {
+        // Frames are 0/255 by construction, so 1-bit output is always lossless
+        png_params = {cv::IMWRITE_PNG_COMPRESSION, 1, cv::IMWRITE_PNG_STRATEGY, cv::IMWRITE_PNG_STRATEGY_RLE,
+                      cv::IMWRITE_PNG_BILEVEL, 1};
+    }
+    int written = 0;
+
+    for (uint32_t i = 0; i < header.frame_count; ++i) {
+        burst_file::FrameRecord record{};
+        if (std::fread(&record, sizeof(record), 1, file) != 1 ||
+            std::fread(frame.data(), sizeof(uint64_t), frame.word_count(), file) != frame.word_count()) {
+            std::cerr << "BurstCapture: " << burst_path << " is truncated at frame " << i << std::endl;
+            break;
+        }
+
+        // Offset from the trigger in the name keeps the pre/post split visible
+        char name[64];
+        std::snprintf(name, sizeof(name), "%06u_%+05d_%lldus.png", i,
+                      static_cast<int>(i) - static_cast<int>(header.trigger_index),
+                      static_cast<long long>(record.timestamp_us));
+
+        frame.to_mat(image);
+        if (!cv::imwrite((out_dir / name).string(), image, png_params)) {
+            std::cerr << "BurstCapture: Failed to write " << (out_dir / name) << std::endl;
+            break;
+        }
+        ++written;
+    }
+    std::fclose(file);
+
+    std::cout << "Burst exported: " << written << " PNGs to " << out_dir << std::endl;
+    return written;
+}
+
+} // namespace video
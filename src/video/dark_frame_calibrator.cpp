@@ -0,0 +1,122 @@
+#include "video/dark_frame_calibrator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace video {
+
+void DarkFrameCalibrator::configure(int width, int height) {
+    width_ = std::max(width, 0);
+    height_ = std::max(height, 0);
+    counts_.assign(static_cast<size_t>(width_) * height_, 0);
+    state_.store(Idle, std::memory_order_release);
+    elapsed_us_ = 0;
+    events_ = 0;
+}
+
+void DarkFrameCalibrator::start(int64_t duration_us) {
+    duration_us_ = std::max<int64_t>(duration_us, 1);
+    elapsed_us_ = 0;
+    events_ = 0;
+    state_.store(Armed, std::memory_order_release);
+}
+
+bool DarkFrameCalibrator::is_running() const {
+    const int state = state_.load(std::memory_order_acquire);
+    return state == Armed || state == Counting;
+}
+
+double DarkFrameCalibrator::get_progress() const {
+    const int64_t duration = duration_us_.load(std::memory_order_relaxed);
+    if (is_done()) {
+        return 1.0;
+    }
+    return duration > 0 ? std::min(1.0, static_cast<double>(elapsed_us_.load(std::memory_order_relaxed)) / duration) : 0.0;
+}
+
+void DarkFrameCalibrator::update(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    int state = state_.load(std::memory_order_acquire);
+    if ((state != Armed && state != Counting) || begin == end || counts_.empty()) {
+        return;
+    }
+    if (state == Armed) {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        start_ts_ = begin->t;
+        // A cancel() or start() in between wins
+        if (!state_.compare_exchange_strong(state, Counting, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+
+    // Only events inside the integration time; timestamps are non-decreasing
+    const int64_t stop_ts = start_ts_ + duration_us_.load(std::memory_order_relaxed);
+    const Metavision::EventCD* split = std::partition_point(begin, end,
+        [stop_ts](const Metavision::EventCD& ev) { return ev.t < stop_ts; });
+
+    const unsigned width = static_cast<unsigned>(width_);
+    const unsigned height = static_cast<unsigned>(height_);
+    uint16_t* counts = counts_.data();
+    uint64_t counted = 0;
+    for (const Metavision::EventCD* ev = begin; ev != split; ++ev) {
+        const unsigned x = ev->x;
+        const unsigned y = ev->y;
+        if (x >= width || y >= height) {
+            continue;
+        }
+        // Saturating increment without a branch on the count
+        uint16_t& count = counts[static_cast<size_t>(y) * width + x];
+        count = static_cast<uint16_t>(count + (count != 0xFFFF));
+        ++counted;
+    }
+    events_.fetch_add(counted, std::memory_order_relaxed);
+
+    if (split != end) {
+        elapsed_us_ = stop_ts - start_ts_;
+        int counting = Counting;
+        state_.compare_exchange_strong(counting, Done, std::memory_order_acq_rel);
+    } else {
+        elapsed_us_ = (end - 1)->t - start_ts_;
+    }
+}
+
+bool DarkFrameCalibrator::build_mask(float sigma, float min_rate_hz, BinaryFrame& mask, Result& result) const {
+    if (!is_done()) {
+        return false;
+    }
+    result = Result();
+    result.duration_us = elapsed_us_.load(std::memory_order_relaxed);
+    result.events = events_.load(std::memory_order_relaxed);
+    const double seconds = std::max<int64_t>(result.duration_us, 1) * 1e-6;
+
+    // Median and MAD by selection, so the hot pixels themselves never move the threshold
+    std::vector<uint16_t> scratch(counts_.begin(), counts_.end());
+    const size_t mid = scratch.size() / 2;
+    std::nth_element(scratch.begin(), scratch.begin() + mid, scratch.end());
+    const double median = scratch[mid];
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        scratch[i] = static_cast<uint16_t>(std::abs(static_cast<int>(counts_[i]) - static_cast<int>(median)));
+    }
+    std::nth_element(scratch.begin(), scratch.begin() + mid, scratch.end());
+    const double mad = scratch[mid];
+
+    const double limit = std::max({median + sigma * 1.4826 * mad,
+                                   median + sigma * std::sqrt(std::max(median, 1.0)),
+                                   static_cast<double>(min_rate_hz) * seconds});
+    result.median_hz = median / seconds;
+    result.mad_hz = mad / seconds;
+    result.threshold_hz = limit / seconds;
+
+    mask.create(width_, height_);
+    for (int y = 0; y < height_; ++y) {
+        const uint16_t* row = counts_.data() + static_cast<size_t>(y) * width_;
+        for (int x = 0; x < width_; ++x) {
+            if (row[x] > limit) {
+                mask.set(x, y, true);
+                ++result.hot_pixels;
+                result.saturated_pixels += row[x] == 0xFFFF;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace video
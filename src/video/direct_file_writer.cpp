@@ -0,0 +1,292 @@
+#include "video/direct_file_writer.h"
+#include "core/locked_memory.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace video {
+
+namespace {
+
+uint64_t round_up(uint64_t bytes, uint64_t unit) {
+    return (bytes + unit - 1) / unit * unit;
+}
+
+#ifdef _WIN32
+/**
+ * Enable a privilege in the process token (false if the account lacks it)
+ */
+bool enable_privilege(const char* name) {
+    HANDLE token = nullptr;
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) {
+        return false;
+    }
+    TOKEN_PRIVILEGES privileges{};
+    privileges.PrivilegeCount = 1;
+    privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+    bool ok = LookupPrivilegeValueA(nullptr, name, &privileges.Privileges[0].Luid) &&
+              AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+              GetLastError() == ERROR_SUCCESS;
+    CloseHandle(token);
+    return ok;
+}
+#endif
+
+} // namespace
+
+struct DirectFileWriter::Request {
+#ifdef _WIN32
+    Request() { overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr); }
+    ~Request() {
+        if (overlapped.hEvent) {
+            CloseHandle(overlapped.hEvent);
+        }
+    }
+    OVERLAPPED overlapped{};
+#endif
+    size_t bytes = 0;   // Write in flight (0 = none)
+};
+
+DirectFileWriter::DirectFileWriter() = default;
+
+DirectFileWriter::~DirectFileWriter() {
+    close();
+}
+
+bool DirectFileWriter::is_open() const {
+    return handle_ != -1;
+}
+
+bool DirectFileWriter::open(const std::string& path, const Options& options) {
+    close();
+    path_ = path;
+    current_ = 0;
+    fill_ = 0;
+    offset_ = 0;
+    committed_ = 0;
+    extent_ = 0;
+    tail_written_ = false;
+    error_ = false;
+
+#ifdef _WIN32
+    static const bool manage_volume = enable_privilege("SeManageVolumePrivilege");
+    valid_data_ = manage_volume;
+    const DWORD flags = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED;
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                              flags | FILE_FLAG_NO_BUFFERING, nullptr);
+    unbuffered_ = file != INVALID_HANDLE_VALUE;
+    if (!unbuffered_) {
+        file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, flags, nullptr);
+    }
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    handle_ = reinterpret_cast<intptr_t>(file);
+#else
+    valid_data_ = false;
+    int file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    unbuffered_ = file >= 0;
+    if (!unbuffered_) {
+        file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);   // e.g. tmpfs
+    }
+    if (file < 0) {
+        return false;
+    }
+    handle_ = file;
+#endif
+
+    // Over-allocated by a sector so alignment holds even when LockedMemory falls back to the heap
+    buffer_bytes_ = static_cast<size_t>(round_up(std::max(options.buffer_bytes, SECTOR), SECTOR));
+    const int count = std::max(options.in_flight, 2);
+    try {
+        for (int i = 0; i < count; ++i) {
+            void* block = core::LockedMemory::instance().allocate(buffer_bytes_ + SECTOR);
+            blocks_.push_back(block);
+            buffers_.push_back(reinterpret_cast<uint8_t*>(round_up(reinterpret_cast<uintptr_t>(block), SECTOR)));
+            requests_.push_back(std::make_unique<Request>());
+        }
+    } catch (const std::bad_alloc&) {
+        std::cerr << "DirectFileWriter: Not enough memory for " << count << " write buffers" << std::endl;
+        error_ = true;
+        close();
+        return false;
+    }
+
+    if (options.preallocate_bytes > 0 && !reserve(round_up(options.preallocate_bytes, SECTOR))) {
+        std::cerr << "DirectFileWriter: Preallocation failed, continuing without" << std::endl;
+    }
+    return true;
+}
+
+bool DirectFileWriter::reserve(uint64_t end) {
+    if (end <= extent_) {
+        return true;
+    }
+#ifdef _WIN32
+    HANDLE file = reinterpret_cast<HANDLE>(handle_);
+    // A full step ahead if there is room, else just what this write needs
+    for (uint64_t target : {std::max(end, extent_ + EXTENT_BYTES), end}) {
+        FILE_END_OF_FILE_INFO eof{};
+        eof.EndOfFile.QuadPart = static_cast<LONGLONG>(target);
+        if (!SetFileInformationByHandle(file, FileEndOfFileInfo, &eof, sizeof(eof))) {
+            continue;
+        }
+        if (valid_data_ && !SetFileValidData(file, static_cast<LONGLONG>(target))) {
+            valid_data_ = false;   // e.g. not NTFS; writes past the valid data are then serialized
+        }
+        extent_ = target;
+        return true;
+    }
+    return false;
+#else
+    // Blocks only (the size stays); where unsupported the filesystem grows the file per write
+    const uint64_t target = std::max(end, extent_ + EXTENT_BYTES);
+    fallocate(static_cast<int>(handle_), FALLOC_FL_KEEP_SIZE, static_cast<off_t>(extent_),
+              static_cast<off_t>(target - extent_));
+    extent_ = target;
+    return true;
+#endif
+}
+
+bool DirectFileWriter::commit(size_t bytes) {
+    fill_ = 0;
+    if (bytes == 0) {
+        return !error_;
+    }
+    if (!is_open() || error_ || tail_written_ || bytes > buffer_bytes_) {
+        error_ = true;   // Writing after a short block would leave padding inside the file
+        return false;
+    }
+
+    uint8_t* data = buffers_[current_];
+    const size_t padded = static_cast<size_t>(round_up(bytes, SECTOR));
+    if (padded != bytes) {
+        tail_written_ = true;
+        std::memset(data + bytes, 0, padded - bytes);
+    }
+    const size_t write_bytes = unbuffered_ ? padded : bytes;
+    if (!reserve(offset_ + write_bytes)) {
+        std::cerr << "DirectFileWriter: Cannot extend " << path_ << " (disk full?)" << std::endl;
+        error_ = true;
+        return false;
+    }
+
+#ifdef _WIN32
+    Request& request = *requests_[current_];
+    HANDLE event = request.overlapped.hEvent;
+    request.overlapped = OVERLAPPED{};
+    request.overlapped.hEvent = event;
+    request.overlapped.Offset = static_cast<DWORD>(offset_);
+    request.overlapped.OffsetHigh = static_cast<DWORD>(offset_ >> 32);
+    if (!WriteFile(reinterpret_cast<HANDLE>(handle_), data, static_cast<DWORD>(write_bytes), nullptr,
+                   &request.overlapped) && GetLastError() != ERROR_IO_PENDING) {
+        error_ = true;
+        return false;
+    }
+    request.bytes = write_bytes;
+#else
+    for (size_t done = 0; done < write_bytes;) {
+        const ssize_t written = pwrite(static_cast<int>(handle_), data + done, write_bytes - done,
+                                       static_cast<off_t>(offset_ + done));
+        if (written <= 0) {
+            error_ = true;
+            return false;
+        }
+        done += static_cast<size_t>(written);
+    }
+#endif
+    offset_ += write_bytes;
+    committed_ += bytes;
+
+    // The next buffer is filled only once its previous write is done
+    current_ = (current_ + 1) % buffers_.size();
+    return wait(*requests_[current_]);
+}
+
+bool DirectFileWriter::wait(Request& request) {
+    if (request.bytes == 0) {
+        return true;
+    }
+    bool ok = true;
+#ifdef _WIN32
+    DWORD written = 0;
+    ok = GetOverlappedResult(reinterpret_cast<HANDLE>(handle_), &request.overlapped, &written, TRUE) &&
+         written == request.bytes;
+#endif
+    request.bytes = 0;
+    if (!ok) {
+        error_ = true;
+    }
+    return ok;
+}
+
+bool DirectFileWriter::append(const void* data, size_t bytes) {
+    if (!is_open() || error_) {
+        return false;
+    }
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+    while (bytes > 0) {
+        const size_t chunk = std::min(bytes, buffer_bytes_ - fill_);
+        std::memcpy(buffers_[current_] + fill_, source, chunk);
+        fill_ += chunk;
+        source += chunk;
+        bytes -= chunk;
+        if (fill_ == buffer_bytes_ && !commit(fill_)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DirectFileWriter::close() {
+    if (!is_open()) {
+        release_buffers();
+        return !error_;
+    }
+    if (fill_ > 0) {
+        commit(fill_);
+    }
+    for (auto& request : requests_) {
+        wait(*request);
+    }
+
+    // Drop the extent reserved ahead and the padding of the last block
+#ifdef _WIN32
+    HANDLE file = reinterpret_cast<HANDLE>(handle_);
+    FILE_END_OF_FILE_INFO eof{};
+    eof.EndOfFile.QuadPart = static_cast<LONGLONG>(committed_);
+    if (!SetFileInformationByHandle(file, FileEndOfFileInfo, &eof, sizeof(eof))) {
+        error_ = true;
+    }
+    CloseHandle(file);
+#else
+    if (ftruncate(static_cast<int>(handle_), static_cast<off_t>(committed_)) != 0) {
+        error_ = true;
+    }
+    ::close(static_cast<int>(handle_));
+#endif
+    handle_ = -1;
+    release_buffers();
+    return !error_;
+}
+
+void DirectFileWriter::release_buffers() {
+    for (void* block : blocks_) {
+        core::LockedMemory::instance().release(block);
+    }
+    blocks_.clear();
+    buffers_.clear();
+    requests_.clear();
+}
+
+} // namespace video
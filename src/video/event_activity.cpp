@@ -0,0 +1,172 @@
+#include "video/event_activity.h"
+#include <algorithm>
+#include <iostream>
+
+namespace video {
+
+namespace {
+
+static_assert((EventActivityProfile::MAX_DIMENSION & (EventActivityProfile::MAX_DIMENSION - 1)) == 0,
+              "MAX_DIMENSION must be a power of two");
+
+/**
+ * Split an interleaved [line * 2 + polarity] array into per-polarity counts
+ */
+void deinterleave(const uint32_t* counts, int lines, std::vector<uint32_t>& on, std::vector<uint32_t>& off,
+                  uint64_t& on_total, uint64_t& off_total) {
+    on.resize(lines);
+    off.resize(lines);
+    for (int i = 0; i < lines; ++i) {
+        off[i] = counts[2 * i];
+        on[i] = counts[2 * i + 1];
+        off_total += off[i];
+        on_total += on[i];
+    }
+}
+
+} // namespace
+
+bool EventActivityProfile::configure(int width, int height, uint32_t accumulation_time_us,
+                                     int origin_x, int origin_y) {
+    const bool supported = width > 0 && height > 0 && width <= MAX_DIMENSION && height <= MAX_DIMENSION;
+    width_ = supported ? width : 0;
+    height_ = supported ? height : 0;
+    accumulation_time_us_ = std::max<uint32_t>(1, accumulation_time_us);
+    window_end_ts_ = -1;
+    rows_.fill(0);
+    cols_.fill(0);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    published_ = ActivitySnapshot{};
+    published_.width = width_;
+    published_.height = height_;
+    published_.origin_x = origin_x;
+    published_.origin_y = origin_y;
+
+    if (!supported) {
+        std::cerr << "EventActivityProfile: " << width << "x" << height
+                  << " exceeds " << MAX_DIMENSION << ", row/column profile disabled" << std::endl;
+    }
+    return supported;
+}
+
+void EventActivityProfile::process(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    if (width_ == 0 || begin == end) {
+        return;
+    }
+    if (!enabled_.load(std::memory_order_relaxed)) {
+        // Drop the partial window so re-enabling starts clean
+        if (window_end_ts_ >= 0) {
+            rows_.fill(0);
+            cols_.fill(0);
+            window_end_ts_ = -1;
+        }
+        return;
+    }
+
+    if (window_end_ts_ < 0) {
+        // Same alignment as the frame generators
+        window_end_ts_ = (begin->t / accumulation_time_us_ + 1) * accumulation_time_us_;
+    }
+
+    uint32_t* rows = rows_.data();
+    uint32_t* cols = cols_.data();
+    constexpr uint32_t coord_mask = MAX_DIMENSION - 1;  // Keeps corrupt replay coordinates in bounds
+
+    const Metavision::EventCD* it = begin;
+    while (it != end) {
+        // Timestamps are non-decreasing, so the window boundary is a binary search
+        const int64_t window_end = window_end_ts_;
+        const Metavision::EventCD* split = std::partition_point(it, end,
+            [window_end](const Metavision::EventCD& ev) { return ev.t < window_end; });
+
+        for (; it != split; ++it) {
+            const uint32_t p = static_cast<uint32_t>(it->p) & 1u;
+            ++rows[((it->y & coord_mask) << 1) | p];
+            ++cols[((it->x & coord_mask) << 1) | p];
+        }
+        if (split == end) {
+            break;
+        }
+
+        publish(window_end_ts_);
+        window_end_ts_ += accumulation_time_us_;
+
+        // Skip over idle gaps: one empty profile, not one per empty window
+        if (split->t >= window_end_ts_) {
+            window_end_ts_ = (split->t / accumulation_time_us_ + 1) * accumulation_time_us_;
+        }
+    }
+}
+
+void EventActivityProfile::publish(int64_t window_end_ts) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        published_.window_end_ts = window_end_ts;
+        ++published_.window_index;
+        published_.on_events = 0;
+        published_.off_events = 0;
+        deinterleave(rows_.data(), height_, published_.row_on, published_.row_off,
+                     published_.on_events, published_.off_events);
+
+        // Row and column totals are the same events; count them once
+        uint64_t unused_on = 0;
+        uint64_t unused_off = 0;
+        deinterleave(cols_.data(), width_, published_.col_on, published_.col_off, unused_on, unused_off);
+    }
+
+    std::fill_n(rows_.begin(), 2 * height_, 0u);
+    std::fill_n(cols_.begin(), 2 * width_, 0u);
+}
+
+bool EventActivityProfile::get_snapshot(ActivitySnapshot& snapshot) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (published_.window_index == 0) {
+        return false;
+    }
+
+    // Member-wise so the caller's vectors keep their capacity
+    snapshot.width = published_.width;
+    snapshot.height = published_.height;
+    snapshot.origin_x = published_.origin_x;
+    snapshot.origin_y = published_.origin_y;
+    snapshot.window_end_ts = published_.window_end_ts;
+    snapshot.window_index = published_.window_index;
+    snapshot.on_events = published_.on_events;
+    snapshot.off_events = published_.off_events;
+    snapshot.row_on.assign(published_.row_on.begin(), published_.row_on.end());
+    snapshot.row_off.assign(published_.row_off.begin(), published_.row_off.end());
+    snapshot.col_on.assign(published_.col_on.begin(), published_.col_on.end());
+    snapshot.col_off.assign(published_.col_off.begin(), published_.col_off.end());
+    return true;
+}
+
+ActivitySnapshot::LineStats ActivitySnapshot::line_stats(const std::vector<uint32_t>& on,
+                                                         const std::vector<uint32_t>& off,
+                                                         double hot_factor, double min_mean) {
+    LineStats stats;
+    const size_t lines = std::min(on.size(), off.size());
+    if (lines == 0) {
+        return stats;
+    }
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < lines; ++i) {
+        total += on[i] + off[i];
+    }
+    stats.mean = static_cast<double>(total) / lines;
+
+    const double hot_limit = stats.mean * hot_factor;
+    const bool expect_events = stats.mean >= min_mean;
+    for (size_t i = 0; i < lines; ++i) {
+        const uint32_t count = on[i] + off[i];
+        if (count == 0 && expect_events) {
+            if (stats.silent++ == 0) stats.first_silent = static_cast<int>(i);
+        } else if (count > hot_limit && stats.mean > 0.0) {
+            if (stats.hot++ == 0) stats.first_hot = static_cast<int>(i);
+        }
+    }
+    return stats;
+}
+
+} // namespace video
@@ -0,0 +1,333 @@
+#include "video/event_archive.h"
+#include "video/event_codec.h"
+#include "core/log.h"
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace video {
+
+EventArchive::~EventArchive() {
+    close();
+}
+
+bool EventArchive::map_file(const std::string& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    file_handle_ = file;
+    mapping_handle_ = mapping;
+    base_ = static_cast<const uint8_t*>(view);
+    size_ = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps the file referenced
+    if (view == MAP_FAILED) {
+        return false;
+    }
+
+    base_ = static_cast<const uint8_t*>(view);
+    size_ = static_cast<size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void EventArchive::close() {
+    if (base_) {
+#ifdef _WIN32
+        UnmapViewOfFile(base_);
+        CloseHandle(static_cast<HANDLE>(mapping_handle_));
+        CloseHandle(static_cast<HANDLE>(file_handle_));
+        mapping_handle_ = nullptr;
+        file_handle_ = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(base_), size_);
+#endif
+    }
+
+    base_ = nullptr;
+    size_ = 0;
+    header_ = event_file::FileHeader{};
+    data_ = nullptr;
+    data_words_ = 0;
+    index_ = nullptr;
+    index_count_ = 0;
+    chunk_bytes_ = 0;
+    scanned_index_.clear();
+    end_timestamp_ = 0;
+}
+
+bool EventArchive::open(const std::string& path) {
+    close();
+
+    if (!map_file(path)) {
+        std::cerr << "EventArchive: Failed to map " << path << std::endl;
+        return false;
+    }
+
+    if (size_ < sizeof(header_)) {
+        std::cerr << "EventArchive: " << path << " is not an event recording" << std::endl;
+        close();
+        return false;
+    }
+    std::memcpy(&header_, base_, sizeof(header_));
+    if (!event_file::is_valid(header_)) {
+        std::cerr << "EventArchive: " << path << " is not an event recording" << std::endl;
+        close();
+        return false;
+    }
+
+    // Event words run up to the index if the trailer is intact, else to end of file
+    data_ = reinterpret_cast<const uint64_t*>(base_ + sizeof(header_));
+    data_words_ = (size_ - sizeof(header_)) / event_file::WORD_SIZE;
+
+    event_file::FileTrailer trailer{};
+    if (header_.version >= 2 && size_ >= sizeof(header_) + sizeof(trailer)) {
+        std::memcpy(&trailer, base_ + size_ - sizeof(trailer), sizeof(trailer));
+        const uint64_t index_end = trailer.index_offset + trailer.entry_count * sizeof(event_file::IndexEntry);
+        if (event_file::is_valid(trailer) && trailer.index_offset >= sizeof(header_) &&
+            index_end + sizeof(trailer) == size_) {
+            index_ = reinterpret_cast<const event_file::IndexEntry*>(base_ + trailer.index_offset);
+            index_count_ = static_cast<size_t>(trailer.entry_count);
+            data_words_ = static_cast<size_t>((trailer.index_offset - sizeof(header_)) / event_file::WORD_SIZE);
+        }
+    }
+
+    if (is_compressed()) {
+        // Chunks are not words; an intact index gives their extent, else walk them
+        chunk_bytes_ = has_index() ? data_words_ * event_file::WORD_SIZE : size_ - sizeof(header_);
+        data_ = nullptr;
+        data_words_ = 0;
+        if (!has_index()) {
+            scan_chunks(chunk_bytes_);
+            std::cout << "EventArchive: " << path << " was not closed cleanly, recovered "
+                      << index_count_ << " chunks" << std::endl;
+        }
+    } else if (!has_index()) {
+        std::cout << "EventArchive: " << path << " has no chunk index, seeks decode from the start" << std::endl;
+    }
+
+    end_timestamp_ = find_end_timestamp();
+    return true;
+}
+
+void EventArchive::scan_chunks(size_t end) {
+    // Stops at the first torn or missing chunk (the tail of an interrupted recording)
+    uint64_t event_count = 0;
+    size_t offset = 0;
+    event_file::ChunkHeader chunk{};
+    while (offset + sizeof(chunk) <= end) {
+        std::memcpy(&chunk, base_ + sizeof(header_) + offset, sizeof(chunk));
+        if (!event_file::is_valid(chunk) || offset + sizeof(chunk) + chunk.payload_bytes > end) {
+            break;
+        }
+        scanned_index_.push_back({chunk.first_timestamp, offset});
+        event_count += chunk.event_count;
+        offset += sizeof(chunk) + chunk.payload_bytes;
+    }
+
+    chunk_bytes_ = offset;
+    index_ = scanned_index_.data();
+    index_count_ = scanned_index_.size();
+    if (index_count_ > 0) {
+        // The header is only finalized on a clean stop
+        header_.start_timestamp = scanned_index_.front().first_timestamp;
+        header_.event_count = event_count;
+    }
+}
+
+bool EventArchive::chunk_header(size_t chunk, event_file::ChunkHeader& header) const {
+    if (chunk >= index_count_ || index_[chunk].offset + sizeof(header) > chunk_bytes_) {
+        return false;
+    }
+    std::memcpy(&header, base_ + sizeof(header_) + index_[chunk].offset, sizeof(header));
+    return event_file::is_valid(header) && index_[chunk].offset + sizeof(header) + header.payload_bytes <= chunk_bytes_;
+}
+
+int64_t EventArchive::find_end_timestamp() const {
+    if (is_compressed()) {
+        event_file::ChunkHeader chunk{};
+        return has_index() && chunk_header(index_count_ - 1, chunk) ? chunk.last_timestamp : header_.start_timestamp;
+    }
+
+    // Only the last chunk needs decoding
+    int64_t time_base = header_.start_timestamp;
+    size_t pos = 0;
+    if (has_index()) {
+        pos = static_cast<size_t>(index_[index_count_ - 1].offset);
+    }
+
+    int64_t last = header_.start_timestamp;
+    for (; pos < data_words_; ++pos) {
+        const uint64_t word = data_[pos];
+        if (event_file::is_time_base(word)) {
+            time_base = event_file::decode_time_base(word);
+        } else {
+            last = time_base + static_cast<int64_t>(word & event_file::OFFSET_MASK);
+        }
+    }
+    return last;
+}
+
+size_t EventArchive::find_chunk(int64_t timestamp) const {
+    // Last chunk starting strictly before timestamp: events equal to it may
+    // close the previous chunk
+    const event_file::IndexEntry* end = index_ + index_count_;
+    const event_file::IndexEntry* it = std::lower_bound(index_, end, timestamp,
+        [](const event_file::IndexEntry& entry, int64_t t) { return entry.first_timestamp < t; });
+    return (it == index_) ? 0 : static_cast<size_t>(it - index_) - 1;
+}
+
+size_t EventArchive::seek(int64_t timestamp, int64_t& time_base) const {
+    time_base = header_.start_timestamp;
+    if (!has_index() || is_compressed()) {
+        return 0;
+    }
+
+    const size_t chunk = find_chunk(timestamp);
+    time_base = index_[chunk].first_timestamp;
+    return static_cast<size_t>(index_[chunk].offset);
+}
+
+void EventArchive::seek(int64_t timestamp, Cursor& cursor) const {
+    cursor.chunk.clear();
+    cursor.chunk_pos = 0;
+    if (is_compressed()) {
+        cursor.position = has_index() ? find_chunk(timestamp) : 0;
+        cursor.time_base = header_.start_timestamp;
+    } else {
+        cursor.position = seek(timestamp, cursor.time_base);
+    }
+}
+
+bool EventArchive::next(Cursor& cursor, Metavision::EventCD& ev) const {
+    if (is_compressed()) {
+        while (cursor.chunk_pos == cursor.chunk.size()) {
+            if (cursor.position >= index_count_) {
+                return false;
+            }
+            decode_chunk(cursor.position++, cursor.chunk, cursor.scratch);
+            cursor.chunk_pos = 0;
+        }
+        ev = cursor.chunk[cursor.chunk_pos++];
+        return true;
+    }
+
+    while (cursor.position < data_words_) {
+        const uint64_t word = data_[cursor.position++];
+        if (event_file::is_time_base(word)) {
+            cursor.time_base = event_file::decode_time_base(word);
+            continue;
+        }
+        ev = event_file::decode_event(word, cursor.time_base);
+        return true;
+    }
+    return false;
+}
+
+bool EventArchive::decode_chunk(size_t chunk, std::vector<Metavision::EventCD>& events,
+                               std::vector<uint8_t>& scratch) const {
+    events.clear();
+    if (chunk >= index_count_) {
+        return false;
+    }
+
+    if (!is_compressed()) {
+        // Every word chunk opens with its own time base
+        const size_t begin = std::min(static_cast<size_t>(index_[chunk].offset), data_words_);
+        const size_t end = chunk + 1 < index_count_
+            ? std::min(std::max(static_cast<size_t>(index_[chunk + 1].offset), begin), data_words_) : data_words_;
+        int64_t time_base = index_[chunk].first_timestamp;
+        events.reserve(end - begin);
+        for (size_t pos = begin; pos < end; ++pos) {
+            const uint64_t word = data_[pos];
+            if (event_file::is_time_base(word)) {
+                time_base = event_file::decode_time_base(word);
+            } else {
+                events.push_back(event_file::decode_event(word, time_base));
+            }
+        }
+        return true;
+    }
+
+    event_file::ChunkHeader header{};
+    if (chunk_header(chunk, header) &&
+        event_codec::decode_chunk(header, base_ + sizeof(header_) + index_[chunk].offset + sizeof(header),
+                                  events, scratch)) {
+        return true;
+    }
+    static core::LogSite site(5000);
+    core::LogLine(core::LogLevel::Warning, &site)
+        << "EventArchive: Chunk " << chunk << " skipped: "
+        << ((header.flags & event_file::CHUNK_LZ4) && !event_codec::has_lz4()
+                ? "LZ4-compressed, this build has no LZ4 (RTCAM_LZ4)" : "corrupt");
+    return false;
+}
+
+size_t EventArchive::read_range(int64_t t_begin, int64_t t_end,
+                                std::vector<Metavision::EventCD>& events) const {
+    events.clear();
+    if (!is_open() || t_end <= t_begin) {
+        return 0;
+    }
+
+    Cursor cursor;
+    seek(t_begin, cursor);
+    Metavision::EventCD ev;
+    while (next(cursor, ev)) {
+        if (ev.t >= t_end) {
+            break;
+        }
+        if (ev.t >= t_begin) {
+            events.push_back(ev);
+        }
+    }
+    return events.size();
+}
+
+} // namespace video
@@ -0,0 +1,156 @@
+#include "video/event_codec.h"
+#include <cstring>
+
+#ifdef RTCAM_LZ4
+#include <lz4.h>
+#endif
+
+namespace video {
+namespace event_codec {
+
+namespace {
+
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline uint8_t* put_varint(uint8_t* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+/**
+ * Read a varint (nullptr if it runs past end or over 64 bits)
+ */
+inline const uint8_t* get_varint(const uint8_t* in, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; in < end && shift < 64; shift += 7) {
+        const uint8_t byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return in;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Varint-encode events into out (sized to the worst case); returns the bytes used
+ */
+size_t encode_varints(const Metavision::EventCD* begin, const Metavision::EventCD* end, std::vector<uint8_t>& out) {
+    out.resize(static_cast<size_t>(end - begin) * MAX_EVENT_BYTES);
+    uint8_t* pos = out.data();
+    int64_t previous_t = begin->t;
+    int64_t previous_y = 0;
+    for (const Metavision::EventCD* ev = begin; ev != end; ++ev) {
+        pos = put_varint(pos, zigzag(ev->t - previous_t));
+        pos = put_varint(pos, zigzag(static_cast<int64_t>(ev->y) - previous_y) << 15 |
+                              static_cast<uint64_t>(ev->x & 0x3FFF) << 1 | static_cast<uint64_t>(ev->p != 0));
+        previous_t = ev->t;
+        previous_y = ev->y;
+    }
+    return static_cast<size_t>(pos - out.data());
+}
+
+} // namespace
+
+bool has_lz4() {
+#ifdef RTCAM_LZ4
+    return true;
+#else
+    return false;
+#endif
+}
+
+void encode_chunk(const Metavision::EventCD* begin, const Metavision::EventCD* end, bool lz4,
+                  event_file::ChunkHeader& header, std::vector<uint8_t>& payload, std::vector<uint8_t>& scratch) {
+    header = event_file::ChunkHeader{};
+    std::memcpy(header.magic, event_file::CHUNK_MAGIC, sizeof(header.magic));
+    header.event_count = static_cast<uint32_t>(end - begin);
+    if (begin == end) {
+        payload.clear();
+        return;
+    }
+    header.first_timestamp = begin->t;
+    header.last_timestamp = (end - 1)->t;
+
+#ifdef RTCAM_LZ4
+    if (lz4) {
+        const size_t encoded = encode_varints(begin, end, scratch);
+        payload.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(encoded))));
+        const int stored = LZ4_compress_default(reinterpret_cast<const char*>(scratch.data()),
+                                                reinterpret_cast<char*>(payload.data()),
+                                                static_cast<int>(encoded), static_cast<int>(payload.size()));
+        if (stored > 0 && static_cast<size_t>(stored) < encoded) {
+            header.flags = event_file::CHUNK_LZ4;
+            header.encoded_bytes = static_cast<uint32_t>(encoded);
+            header.payload_bytes = static_cast<uint32_t>(stored);
+            payload.resize(static_cast<size_t>(stored));
+            return;
+        }
+        // Incompressible: keep the varints
+        scratch.resize(encoded);
+        payload.swap(scratch);
+        header.encoded_bytes = header.payload_bytes = static_cast<uint32_t>(encoded);
+        return;
+    }
+#else
+    (void)lz4;
+    (void)scratch;
+#endif
+    const size_t encoded = encode_varints(begin, end, payload);
+    payload.resize(encoded);
+    header.encoded_bytes = header.payload_bytes = static_cast<uint32_t>(encoded);
+}
+
+bool decode_chunk(const event_file::ChunkHeader& header, const uint8_t* payload,
+                  std::vector<Metavision::EventCD>& events, std::vector<uint8_t>& scratch) {
+    events.clear();
+    const uint8_t* in = payload;
+    if (header.flags & event_file::CHUNK_LZ4) {
+#ifdef RTCAM_LZ4
+        scratch.resize(header.encoded_bytes);
+        const int decoded = LZ4_decompress_safe(reinterpret_cast<const char*>(payload),
+                                                reinterpret_cast<char*>(scratch.data()),
+                                                static_cast<int>(header.payload_bytes),
+                                                static_cast<int>(scratch.size()));
+        if (decoded != static_cast<int>(header.encoded_bytes)) {
+            return false;
+        }
+        in = scratch.data();
+#else
+        (void)scratch;
+        return false;
+#endif
+    } else if (header.encoded_bytes != header.payload_bytes) {
+        return false;
+    }
+
+    const uint8_t* end = in + header.encoded_bytes;
+    events.resize(header.event_count);
+    int64_t t = header.first_timestamp;
+    int64_t y = 0;
+    for (Metavision::EventCD& ev : events) {
+        uint64_t dt, code;
+        if (!(in = get_varint(in, end, dt)) || !(in = get_varint(in, end, code))) {
+            events.clear();
+            return false;
+        }
+        t += unzigzag(dt);
+        y += unzigzag(static_cast<int64_t>(code >> 15));
+        ev = Metavision::EventCD(static_cast<unsigned short>((code >> 1) & 0x3FFF), static_cast<unsigned short>(y),
+                                 static_cast<short>(code & 1), t);
+    }
+    return true;
+}
+
+} // namespace event_codec
+} // namespace video
@@ -0,0 +1,201 @@
+#include "video/event_interval_histogram.h"
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace video {
+
+namespace {
+
+/**
+ * Bits needed to hold v (0 for 0), without a branch on v
+ */
+inline int bit_width(uint32_t v) {
+    const uint64_t shifted = (static_cast<uint64_t>(v) << 1) | 1u;   // Never 0
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index = 0;
+    _BitScanReverse64(&index, shifted);
+    return static_cast<int>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(shifted);
+#else
+    int width = 0;
+    while (shifted >> (width + 1)) ++width;
+    return width;
+#endif
+}
+
+} // namespace
+
+int64_t IntervalHistograms::quantile_us(int pixel_class, double fraction) const {
+    const auto& bins = counts[pixel_class];
+    uint64_t total = 0;
+    for (uint64_t count : bins) {
+        total += count;
+    }
+    if (total == 0) {
+        return -1;
+    }
+
+    const double target = std::min(std::max(fraction, 0.0), 1.0) * static_cast<double>(total);
+    uint64_t cumulative = 0;
+    for (int b = 0; b < BINS; ++b) {
+        cumulative += bins[b];
+        if (static_cast<double>(cumulative) >= target) {
+            return b == BINS - 1 ? bin_min_us(b) : int64_t(1) << b;
+        }
+    }
+    return bin_min_us(BINS - 1);
+}
+
+const char* EventIntervalHistogram::class_name(int pixel_class) {
+    switch (pixel_class) {
+        case Signal: return "Signal";
+        case Noise: return "Noise";
+        case Hot: return "Hot";
+        default: return "Unclassified";
+    }
+}
+
+void EventIntervalHistogram::configure(int width, int height) {
+    width_ = std::max(width, 0);
+    height_ = std::max(height, 0);
+    const size_t pixels = static_cast<size_t>(width_) * height_;
+    stamps_.assign(pixels, 0);
+    classes_.assign(pixels, Unclassified);
+    running_ = false;
+    for (auto& bins : working_) {
+        bins.fill(0);
+    }
+    latest_ts_ = -1;
+    reset_requested_ = false;
+    {
+        std::lock_guard<std::mutex> lock(classes_mutex_);
+        mask_classes_.clear();
+        hot_keys_.clear();
+        next_classes_.clear();
+        class_pixels_.fill(0);
+        class_pixels_[Unclassified] = static_cast<int>(pixels);
+        classes_changed_ = false;
+    }
+    std::lock_guard<std::mutex> lock(counts_mutex_);
+    published_ = IntervalHistograms();
+}
+
+bool EventIntervalHistogram::set_class_masks(const cv::Mat& signal_mask, const cv::Mat& noise_mask) {
+    const cv::Size size(width_, height_);
+    if (signal_mask.type() != CV_8UC1 || noise_mask.type() != CV_8UC1 || signal_mask.size() != size ||
+        noise_mask.size() != size) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(classes_mutex_);
+    mask_classes_.assign(static_cast<size_t>(width_) * height_, Unclassified);
+    for (int y = 0; y < height_; ++y) {
+        const uint8_t* signal_row = signal_mask.ptr<uint8_t>(y);
+        const uint8_t* noise_row = noise_mask.ptr<uint8_t>(y);
+        uint8_t* class_row = mask_classes_.data() + static_cast<size_t>(y) * width_;
+        for (int x = 0; x < width_; ++x) {
+            class_row[x] = signal_row[x] ? Signal : (noise_row[x] ? Noise : Unclassified);
+        }
+    }
+    publish_classes();
+    return true;
+}
+
+void EventIntervalHistogram::set_hot_pixels(const std::vector<cv::Point>& pixels) {
+    std::lock_guard<std::mutex> lock(classes_mutex_);
+    hot_keys_.clear();
+    for (const cv::Point& pixel : pixels) {
+        if (pixel.x >= 0 && pixel.x < width_ && pixel.y >= 0 && pixel.y < height_) {
+            hot_keys_.push_back(pixel.y * width_ + pixel.x);
+        }
+    }
+    publish_classes();
+}
+
+void EventIntervalHistogram::publish_classes() {
+    if (mask_classes_.empty()) {
+        next_classes_.assign(static_cast<size_t>(width_) * height_, Unclassified);
+    } else {
+        next_classes_ = mask_classes_;
+    }
+    for (int32_t key : hot_keys_) {
+        next_classes_[key] = Hot;
+    }
+
+    class_pixels_.fill(0);
+    for (uint8_t pixel_class : next_classes_) {
+        ++class_pixels_[pixel_class];
+    }
+    classes_changed_.store(true, std::memory_order_release);
+}
+
+void EventIntervalHistogram::update(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    if (!enabled_.load(std::memory_order_relaxed)) {
+        running_ = false;
+        return;
+    }
+    if (!running_) {
+        // Intervals across a disabled stretch would be meaningless
+        std::fill(stamps_.begin(), stamps_.end(), 0);
+        running_ = true;
+    }
+    if (reset_requested_.exchange(false)) {
+        for (auto& bins : working_) {
+            bins.fill(0);
+        }
+    }
+    if (classes_changed_.load(std::memory_order_acquire) &&
+        classes_changed_.exchange(false, std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(classes_mutex_);
+        classes_.swap(next_classes_);
+    }
+    if (begin == end) {
+        return;
+    }
+
+    const unsigned width = static_cast<unsigned>(width_);
+    const unsigned height = static_cast<unsigned>(height_);
+    uint32_t* stamps = stamps_.data();
+    const uint8_t* classes = classes_.data();
+    constexpr int LAST_BIN = IntervalHistograms::BINS - 1;
+    constexpr int FIRST_EVENT_BIN = IntervalHistograms::BINS;
+    for (const Metavision::EventCD* it = begin; it != end; ++it) {
+        const unsigned x = static_cast<unsigned>(it->x);
+        const unsigned y = static_cast<unsigned>(it->y);
+        if (x >= width || y >= height) {
+            continue;
+        }
+        const size_t index = static_cast<size_t>(y) * width + x;
+        const uint32_t now = static_cast<uint32_t>(it->t) + 1;
+        const uint32_t last = stamps[index];
+        stamps[index] = now;
+
+        // Selects, not branches: a pixel's first event lands in the extra bin
+        const int bin = std::min(bit_width(now - last), LAST_BIN);
+        ++working_[classes[index]][last != 0 ? bin : FIRST_EVENT_BIN];
+    }
+    latest_ts_ = (end - 1)->t;
+
+    std::lock_guard<std::mutex> lock(counts_mutex_);
+    for (int c = 0; c < IntervalHistograms::CLASSES; ++c) {
+        std::copy(working_[c].begin(), working_[c].begin() + IntervalHistograms::BINS, published_.counts[c].begin());
+        published_.first_events[c] = working_[c][FIRST_EVENT_BIN];
+    }
+    published_.latest_ts = latest_ts_;
+}
+
+void EventIntervalHistogram::get_histograms(IntervalHistograms& out) const {
+    std::lock_guard<std::mutex> lock(counts_mutex_);
+    out = published_;
+}
+
+std::array<int, IntervalHistograms::CLASSES> EventIntervalHistogram::get_class_pixels() const {
+    std::lock_guard<std::mutex> lock(classes_mutex_);
+    return class_pixels_;
+}
+
+} // namespace video
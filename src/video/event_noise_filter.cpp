@@ -0,0 +1,195 @@
+#include "video/event_noise_filter.h"
+#include "video/simd_utils.h"
+#ifdef RTCAM_SIMD_X86
+#include <immintrin.h>
+#endif
+#include <algorithm>
+#include <iostream>
+
+// MSVC emits any intrinsic; GCC/Clang only those enabled for this unit, and
+// the Support checks are inline lambdas that cannot move to a per-ISA file
+#if defined(RTCAM_SIMD_X86) && (defined(_MSC_VER) || defined(__AVX2__))
+#define NOISE_FILTER_AVX2 1
+#else
+#define NOISE_FILTER_AVX2 0
+#endif
+#if defined(RTCAM_SIMD_X86) && (defined(_MSC_VER) || defined(__SSE4_1__))
+#define NOISE_FILTER_SSE41 1
+#else
+#define NOISE_FILTER_SSE41 0
+#endif
+
+namespace video {
+
+namespace {
+
+// Relative times are rebased once they pass this (~35 min), far below the uint32 wrap
+constexpr int64_t REBASE_AFTER_US = int64_t(1) << 31;
+
+/**
+ * Per-event loop shared by all paths; Support checks the 8 neighbours of a
+ * map cell against the oldest relative time that still counts.
+ */
+template <typename Support>
+size_t filter_events(const Metavision::EventCD* begin, const Metavision::EventCD* end, Metavision::EventCD* out,
+                     uint32_t* map, int width, int height, int stride, int64_t base_ts, uint32_t threshold_us,
+                     Support support) {
+    size_t kept = 0;
+    for (const Metavision::EventCD* ev = begin; ev != end; ++ev) {
+        const unsigned x = ev->x;
+        const unsigned y = ev->y;
+        if (x >= static_cast<unsigned>(width) || y >= static_cast<unsigned>(height)) {
+            continue;  // Corrupt replay coordinates
+        }
+
+        uint32_t* cell = map + static_cast<size_t>(y + 1) * stride + (x + 1);
+        const uint32_t now = static_cast<uint32_t>(ev->t - base_ts) + 1;
+        const uint32_t oldest = now > threshold_us ? now - threshold_us : 1;  // 1 also rejects "never"
+        const bool keep = support(cell, oldest);
+        *cell = now;
+
+        // Branch-free compaction: always copy, advance only when kept (kept <= read index, so in-place is safe)
+        const Metavision::EventCD event = *ev;
+        out[kept] = event;
+        kept += keep ? 1 : 0;
+    }
+    return kept;
+}
+
+} // namespace
+
+std::atomic<EventNoiseFilter::Path> EventNoiseFilter::auto_path_{EventNoiseFilter::Path::Scalar};
+
+const char* EventNoiseFilter::path_name(Path path) {
+    switch (path) {
+    case Path::Scalar: return "scalar";
+    case Path::SSE41: return "sse4.1";
+    case Path::AVX2: return "avx2";
+    case Path::Auto:
+    default: return "auto";
+    }
+}
+
+bool EventNoiseFilter::configure(int width, int height, Path path) {
+    const bool valid = width > 0 && height > 0;
+    width_ = valid ? width : 0;
+    height_ = valid ? height : 0;
+    stride_ = valid ? width + 3 : 0;  // 1 border column left, 1 right, 1 spare for the 4-wide loads
+    last_.assign(valid ? static_cast<size_t>(height + 2) * stride_ : 0, 0u);
+    base_ts_ = -1;
+    input_events_ = 0;
+    passed_events_ = 0;
+
+    // Scalar measured fastest (see header) unless a startup benchmark found otherwise
+    const auto& features = simd::get_cpu_features();
+    if (path == Path::Auto) {
+        path = get_auto_path();
+    }
+    if (path == Path::Auto) {
+        path = Path::Scalar;
+    }
+    if (path == Path::AVX2 && (!NOISE_FILTER_AVX2 || !features.has_avx2)) path = Path::SSE41;
+    if (path == Path::SSE41 && (!NOISE_FILTER_SSE41 || !features.has_sse41)) path = Path::Scalar;
+    path_ = path;
+
+    if (!valid) {
+        std::cerr << "EventNoiseFilter: invalid size " << width << "x" << height << ", filter disabled" << std::endl;
+    }
+    return valid;
+}
+
+void EventNoiseFilter::rebase(int64_t ts) {
+    // Keep the last threshold window; anything older reads as "never"
+    const int64_t shift = ts - base_ts_ - static_cast<int64_t>(get_threshold_us());
+    if (shift <= 0) {
+        return;
+    }
+    if (shift > UINT32_MAX) {
+        std::fill(last_.begin(), last_.end(), 0u);
+    } else {
+        const uint32_t s = static_cast<uint32_t>(shift);
+        for (uint32_t& cell : last_) {
+            cell = cell > s ? cell - s : 0u;
+        }
+    }
+    base_ts_ += shift;
+}
+
+size_t EventNoiseFilter::filter(const Metavision::EventCD* begin, const Metavision::EventCD* end,
+                                Metavision::EventCD* out) {
+    const size_t count = static_cast<size_t>(end - begin);
+    if (!enabled_.load(std::memory_order_relaxed) || width_ == 0 || count == 0) {
+        if (out != begin) {
+            std::copy(begin, end, out);
+        }
+        return count;
+    }
+
+    // Time went backwards (replay restarted or looped): old stamps are meaningless
+    if (base_ts_ < 0 || begin->t < base_ts_) {
+        std::fill(last_.begin(), last_.end(), 0u);
+        base_ts_ = begin->t;
+    }
+    if ((end - 1)->t - base_ts_ >= REBASE_AFTER_US) {
+        rebase(begin->t);
+    }
+
+    const uint32_t threshold = get_threshold_us();
+    uint32_t* map = last_.data();
+    const int stride = stride_;
+    size_t kept = 0;
+
+    switch (path_) {
+#if NOISE_FILTER_AVX2
+    case Path::AVX2: {
+        // One gather of the 8 neighbours
+        const __m256i offsets = _mm256_setr_epi32(-stride - 1, -stride, -stride + 1, -1,
+                                                  1, stride - 1, stride, stride + 1);
+        kept = filter_events(begin, end, out, map, width_, height_, stride, base_ts_, threshold,
+            [offsets](const uint32_t* cell, uint32_t oldest) {
+                const __m256i times = _mm256_i32gather_epi32(reinterpret_cast<const int*>(cell), offsets, 4);
+                const __m256i limit = _mm256_set1_epi32(static_cast<int>(oldest));
+                // Unsigned times >= oldest <=> max(times, oldest) == times
+                const __m256i recent = _mm256_cmpeq_epi32(_mm256_max_epu32(times, limit), times);
+                return _mm256_movemask_ps(_mm256_castsi256_ps(recent)) != 0;
+            });
+        break;
+    }
+#endif
+#if NOISE_FILTER_SSE41
+    case Path::SSE41:
+        // Rows above, at and below: lanes x-1, x, x+1 (and x+2, ignored); own pixel masked out
+        kept = filter_events(begin, end, out, map, width_, height_, stride, base_ts_, threshold,
+            [stride](const uint32_t* cell, uint32_t oldest) {
+                const __m128i limit = _mm_set1_epi32(static_cast<int>(oldest));
+                const __m128i up = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cell - stride - 1));
+                const __m128i mid = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cell - 1));
+                const __m128i down = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cell + stride - 1));
+                const __m128i recent_up = _mm_cmpeq_epi32(_mm_max_epu32(up, limit), up);
+                const __m128i recent_mid = _mm_cmpeq_epi32(_mm_max_epu32(mid, limit), mid);
+                const __m128i recent_down = _mm_cmpeq_epi32(_mm_max_epu32(down, limit), down);
+                const int rows = _mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(recent_up, recent_down)));
+                const int row = _mm_movemask_ps(_mm_castsi128_ps(recent_mid));
+                return ((rows & 0x7) | (row & 0x5)) != 0;
+            });
+        break;
+#endif
+    case Path::Scalar:
+    default:
+        kept = filter_events(begin, end, out, map, width_, height_, stride, base_ts_, threshold,
+            [stride](const uint32_t* cell, uint32_t oldest) {
+                const uint32_t* up = cell - stride;
+                const uint32_t* down = cell + stride;
+                return (up[-1] >= oldest) | (up[0] >= oldest) | (up[1] >= oldest) |
+                       (cell[-1] >= oldest) | (cell[1] >= oldest) |
+                       (down[-1] >= oldest) | (down[0] >= oldest) | (down[1] >= oldest);
+            });
+        break;
+    }
+
+    input_events_.fetch_add(count, std::memory_order_relaxed);
+    passed_events_.fetch_add(kept, std::memory_order_relaxed);
+    return kept;
+}
+
+} // namespace video
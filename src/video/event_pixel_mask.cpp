@@ -0,0 +1,67 @@
+#include "video/event_pixel_mask.h"
+#include <algorithm>
+
+namespace video {
+
+void EventPixelMask::configure(int width, int height) {
+    width_ = std::max(width, 0);
+    height_ = std::max(height, 0);
+    mask_.create(width_, height_);
+    masked_pixels_ = 0;
+    suppressed_ = 0;
+}
+
+void EventPixelMask::set_mask(const BinaryFrame& mask) {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_ = mask;
+    mask_changed_ = true;
+}
+
+void EventPixelMask::apply_pending() {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    mask_changed_ = false;
+    if (pending_.width() == width_ && pending_.height() == height_ && !pending_.empty()) {
+        mask_ = pending_;
+    } else {
+        mask_.create(width_, height_);
+    }
+    masked_pixels_ = static_cast<int>(mask_.count());
+}
+
+size_t EventPixelMask::filter(const Metavision::EventCD* begin, const Metavision::EventCD* end,
+                              Metavision::EventCD* out) {
+    if (mask_changed_.load(std::memory_order_acquire)) {
+        apply_pending();
+    }
+    const size_t count = static_cast<size_t>(end - begin);
+    if (!is_enabled() || masked_pixels_.load(std::memory_order_relaxed) == 0 || count == 0) {
+        if (out != begin) {
+            std::copy(begin, end, out);
+        }
+        return count;
+    }
+
+    const uint64_t* words = mask_.data();
+    const size_t words_per_row = static_cast<size_t>(mask_.words_per_row());
+    const unsigned width = static_cast<unsigned>(width_);
+    const unsigned height = static_cast<unsigned>(height_);
+    size_t kept = 0;
+    for (const Metavision::EventCD* ev = begin; ev != end; ++ev) {
+        const unsigned x = ev->x;
+        const unsigned y = ev->y;
+        // Corrupt out-of-frame coordinates test an empty bit and pass, as without the mask
+        const bool inside = (x < width) & (y < height);
+        const size_t word = inside ? static_cast<size_t>(y) * words_per_row + (x >> 6) : 0;
+        const uint64_t bit = inside ? uint64_t(1) << (x & 63) : 0;
+        const bool masked = (words[word] & bit) != 0;
+
+        // Branch-free compaction: always copy, advance only when kept (kept <= read index, so in-place is safe)
+        const Metavision::EventCD event = *ev;
+        out[kept] = event;
+        kept += masked ? 0 : 1;
+    }
+    suppressed_.fetch_add(count - kept, std::memory_order_relaxed);
+    return kept;
+}
+
+} // namespace video
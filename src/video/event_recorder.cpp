@@ -0,0 +1,317 @@
+#include "video/event_recorder.h"
+#include "core/thread_placement.h"
+#include "video/event_codec.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace video {
+
+namespace {
+constexpr size_t BLOCK_WORDS = EventRecorder::BLOCK_BYTES / event_file::WORD_SIZE;
+constexpr size_t HEADER_WORDS = sizeof(event_file::FileHeader) / event_file::WORD_SIZE;
+}
+
+EventRecorder::EventRecorder(size_t ring_capacity, size_t reserve_events)
+    : ring_(ring_capacity, reserve_events) {
+}
+
+EventRecorder::~EventRecorder() {
+    stop();
+}
+
+bool EventRecorder::start(const std::string& path, int width, int height, uint64_t preallocate_bytes,
+                          int compress_threads) {
+    stop();
+
+    // The extent is reserved up front; the writer trims it on close
+    DirectFileWriter::Options options;
+    options.buffer_bytes = BLOCK_BYTES;
+    options.in_flight = BLOCKS_IN_FLIGHT;
+    options.preallocate_bytes = preallocate_bytes;
+    if (!writer_.open(path, options)) {
+        std::cerr << "EventRecorder: Failed to open " << path << std::endl;
+        return false;
+    }
+    block_ = reinterpret_cast<uint64_t*>(writer_.buffer());
+
+    std::memcpy(header_.magic, event_file::MAGIC, sizeof(event_file::MAGIC));
+    header_.version = compress_threads > 0 ? event_file::VERSION : event_file::VERSION_WORDS;
+    header_.width = static_cast<uint16_t>(width);
+    header_.height = static_cast<uint16_t>(height);
+    header_.start_timestamp = 0;
+    header_.event_count = 0;
+    block_fill_ = HEADER_WORDS;  // Header is filled into the first block when it is written
+    has_time_base_ = false;
+    data_words_ = 0;
+    chunk_words_ = event_file::CHUNK_WORDS;  // First event opens the first chunk
+    index_.clear();
+
+    path_ = path;
+    events_written_ = 0;
+    bytes_written_ = 0;
+
+    compress_threads_ = std::max(compress_threads, 0);
+    if (compress_threads_ > 0) {
+        if (!compressors_ || compressors_->concurrency() - 1 != compress_threads_) {
+            compressors_ = std::make_unique<ThreadPool>(compress_threads_);
+        }
+        // Chunks are appended whole; the header placeholder is rewritten on stop
+        block_fill_ = 0;
+        writer_.append(&header_, sizeof(header_));
+        bytes_written_ = sizeof(header_);
+    }
+    write_error_ = false;
+    dropped_batches_base_ = ring_.get_dropped_batches();
+    dropped_events_base_ = ring_.get_dropped_events();
+
+    // Stale batches from an earlier recording are not part of this one
+    ring_.clear();
+    running_ = true;
+    thread_ = std::thread(&EventRecorder::writer_loop, this);
+    recording_.store(true, std::memory_order_release);
+
+    std::cout << "Recording events to " << path << (writer_.is_unbuffered() ? " (unbuffered" : " (buffered");
+    if (compress_threads_ > 0) {
+        std::cout << ", compressed on " << compress_threads_ << " threads" << (event_codec::has_lz4() ? " with LZ4" : "");
+    }
+    std::cout << ")" << std::endl;
+    return true;
+}
+
+void EventRecorder::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    // Stop intake first so the writer can drain a fixed backlog
+    recording_.store(false, std::memory_order_release);
+    running_ = false;
+    ring_.notify();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    std::cout << "Recording stopped: " << events_written_.load() << " events, "
+              << bytes_written_.load() / (1024 * 1024) << " MiB";
+    if (get_dropped_batches() > 0) {
+        std::cout << " (" << get_dropped_batches() << " batches / "
+                  << get_dropped_events() << " events dropped)";
+    }
+    std::cout << std::endl;
+}
+
+void EventRecorder::writer_loop() {
+    core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::IO);
+    while (true) {
+        const bool running = running_.load();
+        ring_.wait_for_data(10000);
+
+        // Drain everything queued so far before sleeping again
+        while (const auto* batch = ring_.front()) {
+            if (compress_threads_ > 0) {
+                gather(batch->data(), batch->data() + batch->size());
+            } else {
+                encode(batch->data(), batch->data() + batch->size());
+            }
+            ring_.pop();
+        }
+        if (compress_threads_ > 0) {
+            write_chunks(jobs_.size());   // Whatever has finished, without waiting
+        }
+
+        if (!running) {
+            break;  // Backlog drained after stop() was requested
+        }
+    }
+
+    finish_file();
+}
+
+void EventRecorder::encode(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    for (const Metavision::EventCD* ev = begin; ev != end; ++ev) {
+        if (chunk_words_ >= event_file::CHUNK_WORDS) {
+            // Every chunk opens with a time base so readers can start decoding there
+            if (!has_time_base_) {
+                header_.start_timestamp = ev->t;
+                has_time_base_ = true;
+            }
+            index_.push_back({ev->t, data_words_});
+            chunk_words_ = 0;
+            time_base_ = ev->t;
+            put_word(event_file::encode_time_base(time_base_));
+        } else if (ev->t < time_base_ ||
+                   static_cast<uint64_t>(ev->t - time_base_) > event_file::OFFSET_MASK) {
+            // New time base when the offset would overflow (or time went backwards)
+            time_base_ = ev->t;
+            put_word(event_file::encode_time_base(time_base_));
+        }
+        put_word(event_file::encode_event(*ev, time_base_));
+    }
+
+    header_.event_count += static_cast<uint64_t>(end - begin);
+    events_written_.store(header_.event_count, std::memory_order_relaxed);
+}
+
+void EventRecorder::gather(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    if (begin == end) {
+        return;
+    }
+    if (!has_time_base_) {
+        header_.start_timestamp = begin->t;
+        has_time_base_ = true;
+    }
+    header_.event_count += static_cast<uint64_t>(end - begin);
+    events_written_.store(header_.event_count, std::memory_order_relaxed);
+
+    while (begin != end) {
+        if (!filling_) {
+            if (spare_jobs_.empty()) {
+                filling_ = std::make_unique<ChunkJob>();
+                filling_->events.reserve(event_file::CHUNK_EVENTS);
+            } else {
+                filling_ = std::move(spare_jobs_.back());
+                spare_jobs_.pop_back();
+            }
+            filling_->events.clear();
+        }
+        const size_t room = event_file::CHUNK_EVENTS - filling_->events.size();
+        const size_t count = std::min(room, static_cast<size_t>(end - begin));
+        filling_->events.insert(filling_->events.end(), begin, begin + count);
+        begin += count;
+        if (filling_->events.size() == event_file::CHUNK_EVENTS) {
+            submit_chunk();
+        }
+    }
+}
+
+void EventRecorder::submit_chunk() {
+    if (!filling_ || filling_->events.empty()) {
+        return;
+    }
+
+    ChunkJob* job = filling_.get();
+    job->done = false;
+    jobs_.push_back(std::move(filling_));
+    compressors_->post([this, job] {
+        event_codec::encode_chunk(job->events.data(), job->events.data() + job->events.size(), true,
+                                  job->header, job->payload, job->scratch);
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex_);
+            job->done = true;
+        }
+        jobs_cv_.notify_all();
+    });
+
+    write_chunks(static_cast<size_t>(compress_threads_) * MAX_CHUNKS_PER_THREAD);
+}
+
+void EventRecorder::write_chunks(size_t max_pending) {
+    // In file order: a finished chunk behind an unfinished one waits for it
+    while (!jobs_.empty()) {
+        ChunkJob& job = *jobs_.front();
+        {
+            std::unique_lock<std::mutex> lock(jobs_mutex_);
+            if (!job.done) {
+                if (jobs_.size() <= max_pending) {
+                    return;
+                }
+                jobs_cv_.wait(lock, [&job] { return job.done; });
+            }
+        }
+
+        if (!write_error_.load(std::memory_order_relaxed)) {
+            index_.push_back({job.header.first_timestamp, bytes_written_.load() - sizeof(header_)});
+            if (!writer_.append(&job.header, sizeof(job.header)) ||
+                !writer_.append(job.payload.data(), job.payload.size())) {
+                std::cerr << "EventRecorder: Write failed (disk full?), further events are discarded" << std::endl;
+                write_error_ = true;
+            } else {
+                bytes_written_.fetch_add(sizeof(job.header) + job.payload.size(), std::memory_order_relaxed);
+            }
+        }
+        spare_jobs_.push_back(std::move(jobs_.front()));
+        jobs_.pop_front();
+    }
+}
+
+void EventRecorder::put_word(uint64_t word) {
+    block_[block_fill_++] = word;
+    data_words_++;
+    chunk_words_++;
+    if (block_fill_ == BLOCK_WORDS) {
+        flush_block();
+    }
+}
+
+void EventRecorder::flush_block() {
+    if (block_fill_ == 0) {
+        return;
+    }
+
+    if (bytes_written_.load(std::memory_order_relaxed) == 0) {
+        std::memcpy(block_, &header_, sizeof(header_));
+    }
+
+    const size_t bytes = block_fill_ * event_file::WORD_SIZE;
+    block_fill_ = 0;
+    if (write_error_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // Returns once the next buffer is free; the block just committed is still being written
+    if (!writer_.commit(bytes)) {
+        std::cerr << "EventRecorder: Write failed (disk full?), further events are discarded" << std::endl;
+        write_error_ = true;
+        return;
+    }
+    block_ = reinterpret_cast<uint64_t*>(writer_.buffer());
+    bytes_written_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void EventRecorder::finish_file() {
+    if (compress_threads_ > 0) {
+        submit_chunk();
+        write_chunks(0);
+    }
+    flush_block();
+    block_ = nullptr;
+    if (!writer_.close() && !write_error_.load()) {
+        std::cerr << "EventRecorder: Write failed (disk full?), recording is incomplete" << std::endl;
+        write_error_ = true;
+    }
+
+    // The data is now trimmed to bytes_written_; the rest is small and goes through the cache
+    std::FILE* file = std::fopen(path_.c_str(), "r+b");
+    if (!file) {
+        std::cerr << "EventRecorder: Failed to reopen " << path_ << " for the chunk index" << std::endl;
+        write_error_ = true;
+        return;
+    }
+
+    // Chunk index and trailer follow the last event word
+    if (!write_error_.load() && std::fseek(file, 0, SEEK_END) == 0) {
+        event_file::FileTrailer trailer{};
+        std::memcpy(trailer.magic, event_file::INDEX_MAGIC, sizeof(event_file::INDEX_MAGIC));
+        trailer.index_offset = bytes_written_.load();
+        trailer.entry_count = index_.size();
+
+        const size_t index_bytes = index_.size() * sizeof(event_file::IndexEntry);
+        if ((index_bytes > 0 && std::fwrite(index_.data(), 1, index_bytes, file) != index_bytes) ||
+            std::fwrite(&trailer, 1, sizeof(trailer), file) != sizeof(trailer)) {
+            std::cerr << "EventRecorder: Failed to write chunk index" << std::endl;
+            write_error_ = true;
+        } else {
+            bytes_written_.fetch_add(index_bytes + sizeof(trailer), std::memory_order_relaxed);
+        }
+    }
+
+    // Final header carries the event count (a crash leaves it at 0 and no index)
+    if (bytes_written_.load() > 0 && std::fseek(file, 0, SEEK_SET) == 0) {
+        std::fwrite(&header_, 1, sizeof(header_), file);
+    }
+    std::fclose(file);
+}
+
+} // namespace video
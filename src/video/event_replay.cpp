@@ -0,0 +1,231 @@
+#include "video/event_replay.h"
+#include <algorithm>
+#include <iostream>
+
+namespace video {
+
+EventReplay::~EventReplay() {
+    stop();
+}
+
+bool EventReplay::open(const std::string& path) {
+    stop();
+    if (!archive_.open(path)) {
+        return false;
+    }
+
+    path_ = path;
+    std::cout << "Replay file: " << path << " (" << width() << "x" << height()
+              << ", " << get_duration_us() / 1e6 << " s";
+    if (get_total_events() > 0) {
+        std::cout << ", " << get_total_events() << " events";
+    }
+    std::cout << ")" << std::endl;
+    return true;
+}
+
+bool EventReplay::start(EventCallback callback, double speed) {
+    stop();
+    if (!archive_.is_open() || !callback) {
+        return false;
+    }
+
+    callback_ = std::move(callback);
+    speed_ = speed;
+
+    parallel_ = decode_threads_ > 0 && archive_.chunk_count() > 1;
+    if (parallel_) {
+        if (!decoders_ || decoders_->concurrency() - 1 != decode_threads_) {
+            decoders_ = std::make_unique<ThreadPool>(decode_threads_);
+        }
+        slots_.resize(static_cast<size_t>(decode_threads_) * LOOKAHEAD_PER_THREAD + 1);
+        for (auto& slot : slots_) {
+            if (!slot) {
+                slot = std::make_unique<DecodedChunk>();
+            }
+        }
+    }
+    events_replayed_ = 0;
+    position_us_ = 0;
+    events_per_second_ = 0.0;
+    finished_ = false;
+
+    running_ = true;
+    thread_ = std::thread(&EventReplay::replay_loop, this);
+    return true;
+}
+
+void EventReplay::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void EventReplay::replay_loop() {
+    // Chunk index makes the start offset a binary search instead of a scan
+    const int64_t start_time = archive_.start_timestamp() + start_offset_us_;
+    rewind(start_time);
+
+    pace_anchored_ = false;
+    batch_.clear();
+    batch_.reserve(MAX_BATCH_EVENTS);
+
+    int64_t batch_end = 0;
+    const Clock::time_point wall_start = Clock::now();
+    rate_start_ = wall_start;
+    rate_events_ = 0;
+
+    Metavision::EventCD ev;
+    while (running_.load()) {
+        if (!next_event(ev)) {
+            // End of file: flush the tail, then loop or finish
+            deliver_batch();
+            if (!loop_.load()) {
+                break;
+            }
+            rewind(start_time);
+            pace_anchored_ = false;  // Timestamps restart, re-anchor pacing
+            continue;
+        }
+
+        if (ev.t < start_time) {
+            continue;  // Rest of the chunk before the seek target
+        }
+
+        // Time-sliced batches
+        if (batch_.empty()) {
+            batch_end = ev.t + BATCH_US;
+        } else if (ev.t >= batch_end || batch_.size() == MAX_BATCH_EVENTS) {
+            deliver_batch();
+            batch_end = ev.t + BATCH_US;
+        }
+        batch_.push_back(ev);
+    }
+
+    drain_decoders();
+    const double total_s = std::chrono::duration<double>(Clock::now() - wall_start).count();
+    if (running_.load()) {
+        std::cout << "Replay finished: " << events_replayed_.load() << " events in "
+                  << total_s << " s" << std::endl;
+    }
+    finished_ = true;
+    running_ = false;
+}
+
+void EventReplay::rewind(int64_t timestamp) {
+    if (!parallel_) {
+        archive_.seek(timestamp, cursor_);
+        return;
+    }
+    drain_decoders();
+    next_chunk_ = posted_ = archive_.find_chunk(timestamp);
+    current_ = nullptr;
+    event_pos_ = 0;
+}
+
+bool EventReplay::next_event(Metavision::EventCD& ev) {
+    if (!parallel_) {
+        return archive_.next(cursor_, ev);
+    }
+
+    while (!current_ || event_pos_ == current_->events.size()) {
+        // Top up the look-ahead; the slot of the chunk just played is free again
+        while (posted_ < archive_.chunk_count() && posted_ - next_chunk_ < slots_.size()) {
+            post_chunk(posted_++);
+        }
+        if (next_chunk_ == posted_) {
+            return false;
+        }
+
+        current_ = slots_[next_chunk_ % slots_.size()].get();
+        {
+            std::unique_lock<std::mutex> lock(decode_mutex_);
+            decode_cv_.wait(lock, [this] { return current_->done; });
+        }
+        ++next_chunk_;
+        event_pos_ = 0;
+    }
+    ev = current_->events[event_pos_++];
+    return true;
+}
+
+void EventReplay::post_chunk(size_t chunk) {
+    DecodedChunk* slot = slots_[chunk % slots_.size()].get();
+    {
+        std::lock_guard<std::mutex> lock(decode_mutex_);
+        slot->done = false;
+    }
+    decoders_->post([this, slot, chunk] {
+        archive_.decode_chunk(chunk, slot->events, slot->scratch);   // Failures leave it empty
+        {
+            std::lock_guard<std::mutex> lock(decode_mutex_);
+            slot->done = true;
+        }
+        decode_cv_.notify_all();
+    });
+}
+
+void EventReplay::drain_decoders() {
+    // Slots may only be reused or freed once no decode writes into them
+    std::unique_lock<std::mutex> lock(decode_mutex_);
+    decode_cv_.wait(lock, [this] {
+        return std::all_of(slots_.begin(), slots_.end(), [](const auto& slot) { return slot->done; });
+    });
+}
+
+void EventReplay::deliver_batch() {
+    if (batch_.empty()) {
+        return;
+    }
+
+    const int64_t last_t = batch_.back().t;
+    pace(last_t);
+
+    callback_(batch_.data(), batch_.data() + batch_.size());
+    events_replayed_.fetch_add(batch_.size(), std::memory_order_relaxed);
+    position_us_.store(last_t - archive_.start_timestamp(), std::memory_order_relaxed);
+    batch_.clear();
+
+    // Throughput over roughly the last second of wall time
+    const Clock::time_point now = Clock::now();
+    const double elapsed = std::chrono::duration<double>(now - rate_start_).count();
+    if (elapsed >= 1.0) {
+        const uint64_t replayed = events_replayed_.load(std::memory_order_relaxed);
+        events_per_second_.store((replayed - rate_events_) / elapsed, std::memory_order_relaxed);
+        rate_events_ = replayed;
+        rate_start_ = now;
+    }
+}
+
+void EventReplay::pace(int64_t timestamp) {
+    const double speed = speed_.load();
+    if (speed <= 0.0) {
+        pace_anchored_ = false;  // As fast as possible
+        return;
+    }
+
+    // Re-anchor on start, loop and speed changes so the new rate applies from here
+    if (!pace_anchored_ || speed != pace_speed_) {
+        pace_wall_start_ = Clock::now();
+        pace_ts_start_ = timestamp;
+        pace_speed_ = speed;
+        pace_anchored_ = true;
+        return;
+    }
+
+    const double wall_us = (timestamp - pace_ts_start_) / speed;
+    const Clock::time_point target = pace_wall_start_ +
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::micro>(wall_us));
+
+    // Sleep in short slices so stop() stays responsive at slow speeds
+    while (running_.load()) {
+        const Clock::time_point now = Clock::now();
+        if (now >= target) {
+            break;
+        }
+        std::this_thread::sleep_for(std::min<Clock::duration>(target - now, std::chrono::milliseconds(10)));
+    }
+}
+
+} // namespace video
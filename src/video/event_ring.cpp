@@ -0,0 +1,92 @@
+#include "video/event_ring.h"
+#include <chrono>
+
+namespace video {
+
+EventRing::EventRing(size_t capacity, size_t reserve_events) {
+    size_t rounded = 2;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+
+    slots_.resize(rounded);
+    for (auto& slot : slots_) {
+        slot.reserve(reserve_events);
+    }
+    mask_ = rounded - 1;
+}
+
+bool EventRing::try_push(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+
+    if (head - tail >= slots_.size()) {
+        // Full: drop rather than stall the decoding thread
+        dropped_batches_.fetch_add(1, std::memory_order_relaxed);
+        dropped_events_.fetch_add(end - begin, std::memory_order_relaxed);
+        peak_size_.store(slots_.size(), std::memory_order_relaxed);
+        return false;
+    }
+
+    slots_[head & mask_].assign(begin, end);
+    head_.store(head + 1, std::memory_order_release);
+
+    // Producer-only max; the reader just swaps in 0
+    const size_t fill = head + 1 - tail;
+    if (fill > peak_size_.load(std::memory_order_relaxed)) {
+        peak_size_.store(fill, std::memory_order_relaxed);
+    }
+
+    // Consumer also wakes on timeout, so a missed notify only costs latency
+    data_cv_.notify_one();
+    return true;
+}
+
+const EventRing::Batch* EventRing::front() const {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (head_.load(std::memory_order_acquire) == tail) {
+        return nullptr;
+    }
+    return &slots_[tail & mask_];
+}
+
+void EventRing::pop() {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (head_.load(std::memory_order_acquire) == tail) {
+        return;
+    }
+    tail_.store(tail + 1, std::memory_order_release);
+}
+
+bool EventRing::wait_for_data(int64_t timeout_us) {
+    if (front()) {
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    data_cv_.wait_for(lock, std::chrono::microseconds(timeout_us),
+                      [this] { return front() != nullptr; });
+    return front() != nullptr;
+}
+
+void EventRing::notify() {
+    data_cv_.notify_all();
+}
+
+void EventRing::clear() {
+    tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+void EventRing::prefault() {
+    for (auto& slot : slots_) {
+        const size_t reserved = slot.capacity();
+        slot.resize(reserved);   // Value-initializes, touching every page
+        slot.clear();            // Keeps the capacity
+    }
+}
+
+size_t EventRing::size() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+}
+
+} // namespace video
@@ -0,0 +1,75 @@
+#include "video/event_scatter_queue.h"
+#include <algorithm>
+
+namespace video {
+
+void EventScatterQueue::configure(int width, int height, uint32_t window_us) {
+    width_.store(width, std::memory_order_relaxed);
+    height_.store(height, std::memory_order_relaxed);
+    window_us_ = std::max<uint32_t>(1, window_us);
+    window_end_ts_ = -1;
+    filling_.clear();
+}
+
+void EventScatterQueue::push(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    if (begin == end) {
+        return;
+    }
+    if (window_end_ts_ < 0) {
+        // Same alignment as the frame generators
+        window_end_ts_ = (begin->t / window_us_ + 1) * window_us_;
+    }
+
+    const unsigned width = static_cast<unsigned>(width_.load(std::memory_order_relaxed));
+    const unsigned height = static_cast<unsigned>(height_.load(std::memory_order_relaxed));
+    const Metavision::EventCD* it = begin;
+    while (it != end) {
+        // Timestamps are non-decreasing, so the window boundary is a binary search
+        const int64_t window_end = window_end_ts_;
+        const Metavision::EventCD* split = std::partition_point(it, end,
+            [window_end](const Metavision::EventCD& ev) { return ev.t < window_end; });
+
+        for (; it != split; ++it) {
+            if (static_cast<unsigned>(it->x) < width && static_cast<unsigned>(it->y) < height) {
+                filling_.push_back(pack(*it));
+            }
+        }
+        if (split == end) {
+            break;
+        }
+
+        complete_window();
+        window_end_ts_ += window_us_;
+
+        // Skip over idle gaps: no empty window per gap period
+        if (split->t >= window_end_ts_) {
+            window_end_ts_ = (split->t / window_us_ + 1) * window_us_;
+        }
+    }
+}
+
+void EventScatterQueue::complete_window() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (completed_new_) {
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        completed_.swap(filling_);
+        completed_end_ts_ = window_end_ts_;
+        completed_new_ = true;
+    }
+    filling_.clear();   // Storage of the replaced (or taken and returned) window
+}
+
+bool EventScatterQueue::take(std::vector<uint32_t>& events, Metavision::timestamp& window_end_ts) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!completed_new_) {
+        return false;
+    }
+    events.swap(completed_);
+    window_end_ts = completed_end_ts_;
+    completed_new_ = false;
+    return true;
+}
+
+} // namespace video
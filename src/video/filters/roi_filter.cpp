@@ -1,4 +1,5 @@
 #include "video/filters/roi_filter.h"
+#include <algorithm>
 
 namespace video {
 
@@ -20,58 +21,95 @@ void ROIFilter::set_show_rectangle(bool show) {
     show_rectangle_ = show;
 }
 
-cv::Mat ROIFilter::apply(const cv::Mat& input) {
+cv::Rect ROIFilter::clipped_roi(cv::Size size) const {
+    // Ensure ROI is within bounds
+    int x = std::max(0, std::min(x_, size.width - 1));
+    int y = std::max(0, std::min(y_, size.height - 1));
+    int w = std::min(width_, size.width - x);
+    int h = std::min(height_, size.height - y);
+
+    if (w <= 0 || h <= 0) {
+        return cv::Rect();
+    }
+    return cv::Rect(x, y, w, h);
+}
+
+void ROIFilter::draw(cv::Mat& frame) const {
+    // Draw bright green rectangle
+    cv::rectangle(frame,
+                 cv::Point(x_, y_),
+                 cv::Point(x_ + width_, y_ + height_),
+                 cv::Scalar(0, 255, 0), 2);
+
+    // Draw corner markers
+    int marker_size = 10;
+    cv::line(frame,
+            cv::Point(x_, y_),
+            cv::Point(x_ + marker_size, y_),
+            cv::Scalar(0, 255, 0), 3);
+    cv::line(frame,
+            cv::Point(x_, y_),
+            cv::Point(x_, y_ + marker_size),
+            cv::Scalar(0, 255, 0), 3);
+}
+
+bool ROIFilter::apply(const FrameRef& input, FrameRef& output) {
     if (input.empty()) {
-        return input;
+        return false;
     }
 
     std::lock_guard<std::mutex> lock(mutex_);
 
     if (!enabled_) {
-        return input;
+        return false;
     }
 
-    cv::Mat output;
+    ReadGuard guard(input);
+    const cv::Mat& in = guard.get();
 
     if (crop_to_roi_) {
-        // Crop to ROI region only
-        // Ensure ROI is within bounds
-        int x = std::max(0, std::min(x_, input.cols - 1));
-        int y = std::max(0, std::min(y_, input.rows - 1));
-        int w = std::min(width_, input.cols - x);
-        int h = std::min(height_, input.rows - y);
-
-        if (w > 0 && h > 0) {
-            cv::Rect roi_rect(x, y, w, h);
-            output = input(roi_rect).clone();
-        } else {
-            output = input.clone();
-        }
-    } else {
-        output = input.clone();
-
-        // Draw ROI rectangle if enabled
-        if (show_rectangle_) {
-            // Draw bright green rectangle
-            cv::rectangle(output,
-                         cv::Point(x_, y_),
-                         cv::Point(x_ + width_, y_ + height_),
-                         cv::Scalar(0, 255, 0), 2);
-
-            // Draw corner markers
-            int marker_size = 10;
-            cv::line(output,
-                    cv::Point(x_, y_),
-                    cv::Point(x_ + marker_size, y_),
-                    cv::Scalar(0, 255, 0), 3);
-            cv::line(output,
-                    cv::Point(x_, y_),
-                    cv::Point(x_, y_ + marker_size),
-                    cv::Scalar(0, 255, 0), 3);
+        // Crop to ROI region only: a view of the input, no copy
+        const cv::Rect roi_rect = clipped_roi(in.size());
+        if (roi_rect.empty()) {
+            return false;
         }
+        output.write() = in(roi_rect);
+        return true;
+    }
+
+    if (!show_rectangle_) {
+        return false;
+    }
+
+    cv::Mat& out = destination(output);
+    in.copyTo(out);
+    draw(out);
+    return true;
+}
+
+bool ROIFilter::apply_in_place(FrameRef& frame) {
+    if (frame.empty()) {
+        return false;
     }
 
-    return output;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!enabled_) {
+        return false;
+    }
+
+    cv::Mat& mat = frame.write();
+
+    if (crop_to_roi_) {
+        // Narrow the header to the ROI; the pixels stay where they are
+        const cv::Rect roi_rect = clipped_roi(mat.size());
+        if (!roi_rect.empty()) {
+            mat = mat(roi_rect);
+        }
+    } else if (show_rectangle_) {
+        draw(mat);
+    }
+    return true;
 }
 
 void ROIFilter::set_enabled(bool enabled) {
@@ -1,62 +1,95 @@
 #include "video/filters/subtraction_filter.h"
+#include "video/simd_utils.h"
+#include <utility>
 
 namespace video {
 
-cv::Mat SubtractionFilter::apply(const cv::Mat& input) {
+bool SubtractionFilter::has_previous(const cv::Mat& current) const {
+    const cv::Mat& prev_mat = previous_frame_.unsafe_get();
+    return !prev_mat.empty() &&
+           current.size() == prev_mat.size() &&
+           current.type() == prev_mat.type();
+}
+
+void SubtractionFilter::subtract(const cv::Mat& current, const cv::Mat& previous, cv::Mat& out) {
+    if (current.depth() == CV_8U) {
+        // Single integer pass: (current - previous) / 2 + 128
+        simd::frame_difference(current, previous, out);
+        return;
+    }
+
+    // current - previous + 127.5, centered at gray (negative diffs darker,
+    // positive brighter), saturated to the depth's range
+    cv::addWeighted(current, 1.0, previous, -1.0, 127.5, out);
+}
+
+bool SubtractionFilter::apply(const FrameRef& input, FrameRef& output) {
     if (input.empty()) {
-        return input;
+        return false;
     }
 
     std::lock_guard<std::mutex> lock(mutex_);
 
     if (!enabled_) {
-        return input;
+        return false;
     }
 
-    cv::Mat output;
+    bool written = false;
+    {
+        ReadGuard guard(input);
+        const cv::Mat& in = guard.get();
 
-    if (!previous_frame_.empty()) {
-        // Get read-only access to previous frame (zero-copy)
-        ReadGuard prev_guard(previous_frame_);
-        const cv::Mat& prev_mat = prev_guard.get();
+        if (has_previous(in)) {
+            // Get read-only access to previous frame (zero-copy)
+            ReadGuard prev_guard(previous_frame_);
 
-        // Ensure both frames have the same size and type
-        if (input.size() == prev_mat.size() &&
-            input.type() == prev_mat.type()) {
+            subtract(in, prev_guard.get(), destination(output));
+            written = true;
+        }
+    }
 
-            // Convert to float for subtraction to avoid underflow
-            cv::Mat float_current, float_previous;
-            input.convertTo(float_current, CV_32F);
-            prev_mat.convertTo(float_previous, CV_32F);
+    // ZERO-COPY: Keep a reference to the unfiltered input as the previous frame
+    previous_frame_ = input;
+
+    // No previous frame (or size mismatch): input passes through as-is
+    return written;
+}
 
-            // Subtract previous from current
-            cv::Mat diff = float_current - float_previous;
+bool SubtractionFilter::apply_in_place(FrameRef& frame) {
+    if (frame.empty()) {
+        return false;
+    }
 
-            // Scale and shift to make differences visible
-            // Add 127.5 to center at gray (so negative diffs are darker, positive are brighter)
-            diff = diff + 127.5f;
+    std::lock_guard<std::mutex> lock(mutex_);
 
-            // Clamp to valid range [0, 255]
-            diff.convertTo(output, CV_8U);
-        } else {
-            // Size mismatch - just return input as-is
-            output = input.clone();
-        }
-    } else {
-        // No previous frame - return input as-is
-        output = input.clone();
+    if (!enabled_) {
+        return false;
     }
 
-    // ZERO-COPY: Store output as previous frame (move semantics)
-    previous_frame_ = FrameRef(std::move(output));
+    cv::Mat& current = frame.write();
+
+    // Save the unfiltered frame before it is overwritten (reuses spare_'s buffer)
+    current.copyTo(spare_);
 
-    // Return a copy for the caller (they expect to own it)
-    return previous_frame_.unsafe_get().clone();
+    if (has_previous(current)) {
+        ReadGuard prev_guard(previous_frame_);
+        subtract(current, prev_guard.get(), current);
+    }
+
+    // Swap buffers: the saved frame becomes previous, the old previous is next frame's spare
+    if (previous_frame_.is_exclusive() && previous_frame_.unsafe_get().u != nullptr) {
+        std::swap(previous_frame_.write(), spare_);
+    } else {
+        previous_frame_ = FrameRef(std::move(spare_));
+        spare_.release();
+    }
+    return true;
 }
 
 void SubtractionFilter::reset() {
     std::lock_guard<std::mutex> lock(mutex_);
     previous_frame_.reset();
+    spare_.release();
 }
 
 void SubtractionFilter::set_enabled(bool enabled) {
@@ -64,6 +97,7 @@ void SubtractionFilter::set_enabled(bool enabled) {
     enabled_ = enabled;
     if (!enabled_) {
         previous_frame_.reset();  // Clear previous frame when disabled
+        spare_.release();
     }
 }
 
@@ -0,0 +1,118 @@
+#include "video/flicker_estimator.h"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace video {
+
+void FlickerEstimator::update(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    if (!enabled_.load(std::memory_order_relaxed)) {
+        bin_end_ts_ = -1;
+        return;
+    }
+    if (begin == end) {
+        return;
+    }
+
+    // First batch, time went backwards (replay restart) or a gap longer than a span: start over
+    const int64_t span_us = BIN_US * BINS;
+    if (bin_end_ts_ < 0 || begin->t < bin_end_ts_ - BIN_US || begin->t >= bin_end_ts_ + span_us) {
+        filling_.assign(BINS, 0);
+        bin_ = 0;
+        bin_end_ts_ = begin->t + BIN_US;
+    }
+
+    uint32_t* bins = filling_.data();
+    for (const Metavision::EventCD* ev = begin; ev != end; ++ev) {
+        while (ev->t >= bin_end_ts_) {
+            bin_end_ts_ += BIN_US;
+            if (++bin_ == BINS) {
+                publish();
+            }
+        }
+        ++bins[bin_];
+    }
+}
+
+void FlickerEstimator::publish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        complete_.swap(filling_);
+        fresh_ = true;
+    }
+    filling_.assign(BINS, 0);
+    bin_ = 0;
+}
+
+bool FlickerEstimator::estimate(double min_hz, double max_hz, FlickerEstimate& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!fresh_ || complete_.size() != static_cast<size_t>(BINS)) {
+        return false;
+    }
+    fresh_ = false;
+
+    double total = 0.0;
+    for (uint32_t count : complete_) {
+        total += count;
+    }
+    if (total == 0.0) {
+        return false;
+    }
+
+    // Mean removed so DC leakage does not mask low frequencies; Hann window against spectral leakage
+    const double mean = total / BINS;
+    signal_.resize(BINS);
+    for (int i = 0; i < BINS; ++i) {
+        const double window = 0.5 - 0.5 * std::cos(2.0 * CV_PI * i / (BINS - 1));
+        signal_[i] = static_cast<float>((complete_[i] - mean) * window);
+    }
+
+    // CCS packed output: [Re0, Re1, Im1, Re2, Im2, ..., Re(N/2)]
+    cv::Mat input(1, BINS, CV_32F, signal_.data());
+    spectrum_.resize(BINS);
+    cv::Mat output(1, BINS, CV_32F, spectrum_.data());
+    cv::dft(input, output);
+    auto power = [this](int k) {
+        const double re = spectrum_[2 * k - 1];
+        const double im = spectrum_[2 * k];
+        return re * re + im * im;
+    };
+
+    const double hz_per_bin = 1e6 / (static_cast<double>(BIN_US) * BINS);
+    const int first = std::max(1, static_cast<int>(std::ceil(min_hz / hz_per_bin)));
+    const int last = std::min(BINS / 2 - 1, static_cast<int>(std::floor(max_hz / hz_per_bin)));
+    if (last - first < 2) {
+        return false;
+    }
+
+    std::vector<double> band(static_cast<size_t>(last - first + 1));
+    int peak = first;
+    for (int k = first; k <= last; ++k) {
+        band[k - first] = power(k);
+        if (band[k - first] > band[peak - first]) {
+            peak = k;
+        }
+    }
+    const double peak_power = band[peak - first];
+    std::nth_element(band.begin(), band.begin() + band.size() / 2, band.end());
+    const double median = band[band.size() / 2];
+
+    // Parabolic interpolation on log power between the neighbouring bins
+    double offset = 0.0;
+    if (peak > 1 && peak < BINS / 2 - 1) {
+        const double a = std::log(power(peak - 1) + 1e-12);
+        const double b = std::log(peak_power + 1e-12);
+        const double c = std::log(power(peak + 1) + 1e-12);
+        const double denom = a - 2.0 * b + c;
+        if (denom < 0.0) {
+            offset = std::clamp(0.5 * (a - c) / denom, -0.5, 0.5);
+        }
+    }
+
+    out.frequency_hz = (peak + offset) * hz_per_bin;
+    out.strength = median > 0.0 ? peak_power / median : (peak_power > 0.0 ? 1e9 : 0.0);
+    out.event_rate = total / (static_cast<double>(BIN_US) * BINS * 1e-6);
+    return true;
+}
+
+} // namespace video
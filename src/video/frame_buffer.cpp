@@ -1,16 +1,258 @@
 #include "video/frame_buffer.h"
+#include "core/alloc_tracker.h"
+#include "core/flight_recorder.h"
+#include "core/metrics.h"
+#include "core/profiler.h"
+#include <chrono>
+#include <algorithm>
+#include <iostream>
 
 namespace video {
 
+namespace {
+// Process-wide view of frames the display/analysis queue refused
+core::Counter& dropped_metric() {
+    static core::Counter& counter = core::MetricsRegistry::instance().counter("frames.dropped.queue");
+    return counter;
+}
+
+// Queue refusals and overwrites; mailbox replacement is the display's normal pace and is not recorded
+void record_queue_drop(int64_t count) {
+    static const uint16_t source = core::FlightRecorder::instance().source_id("frame_queue");
+    core::FlightRecorder::instance().record_drop(source, count);
+}
+} // namespace
+
+void FrameBuffer::configure_queue(size_t capacity, FrameQueuePolicy policy,
+                                  int64_t block_timeout_us) {
+    // Power-of-two capacity so slot index is a mask of the sequence number
+    size_t rounded = 0;
+    if (capacity > 0) {
+        rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    slots_.reset(rounded > 0 ? new QueueSlot[rounded] : nullptr);
+    capacity_ = rounded;
+    policy_ = policy;
+    block_timeout_us_ = block_timeout_us;
+    write_seq_.store(0);
+
+    for (auto& consumer : consumers_) {
+        consumer.active.store(false);
+        consumer.cursor.store(0);
+        consumer.dropped.store(0);
+        consumer.every_frame = false;
+    }
+    if (rounded > 0) {
+        consumers_[0].active.store(true);  // Default display consumer (latest frame only)
+    }
+
+    current_frame_.reset();
+    frame_consumed_.store(true);
+    frames_dropped_.store(0);
+    frames_generated_.store(0);
+}
+
+int FrameBuffer::register_consumer(bool every_frame) {
+    if (capacity_ == 0) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int i = 1; i < MAX_CONSUMERS; ++i) {
+        Consumer& consumer = consumers_[i];
+        if (consumer.active.load()) {
+            continue;
+        }
+        consumer.every_frame = every_frame;
+        consumer.dropped.store(0);
+        consumer.cursor.store(write_seq_.load(std::memory_order_acquire));  // Start at next frame
+        consumer.active.store(true, std::memory_order_release);
+        return i;
+    }
+
+    std::cerr << "FrameBuffer: no free consumer slot (max " << MAX_CONSUMERS << ")" << std::endl;
+    return -1;
+}
+
+void FrameBuffer::unregister_consumer(int consumer_id) {
+    if (consumer_id <= 0 || consumer_id >= MAX_CONSUMERS) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    consumers_[consumer_id].active.store(false, std::memory_order_release);
+
+    // A producer blocked on this consumer may now have space
+    { std::lock_guard<std::mutex> space_lock(space_mutex_); }
+    space_cv_.notify_one();
+}
+
+bool FrameBuffer::has_frame_for(int consumer_id) const {
+    const Consumer& consumer = consumers_[consumer_id];
+    return consumer.active.load(std::memory_order_acquire) &&
+           consumer.cursor.load(std::memory_order_acquire) < write_seq_.load(std::memory_order_acquire);
+}
+
+bool FrameBuffer::wait_for_frame(int consumer_id, int64_t timeout_us) {
+    if (capacity_ == 0 || consumer_id < 0 || consumer_id >= MAX_CONSUMERS) {
+        return false;
+    }
+    if (has_frame_for(consumer_id)) {
+        return true;
+    }
+
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    data_cv_.wait_for(lock, std::chrono::microseconds(timeout_us),
+                      [&]() { return has_frame_for(consumer_id); });
+    return has_frame_for(consumer_id);
+}
+
+void FrameBuffer::notify() {
+    data_cv_.notify_all();
+}
+
+uint64_t FrameBuffer::min_every_frame_cursor(uint64_t write_seq) const {
+    uint64_t min_cursor = write_seq;  // No every-frame consumer = never full
+    for (const auto& consumer : consumers_) {
+        if (consumer.active.load(std::memory_order_acquire) && consumer.every_frame) {
+            min_cursor = std::min(min_cursor, consumer.cursor.load(std::memory_order_acquire));
+        }
+    }
+    return min_cursor;
+}
+
+bool FrameBuffer::queue_full(uint64_t write_seq) const {
+    return write_seq - min_every_frame_cursor(write_seq) >= capacity_;
+}
+
+void FrameBuffer::stamp_stored(FrameRef& frame_ref) {
+    FrameTiming timing = frame_ref.timing();
+    if (timing.callback_us == 0) {
+        return;  // Not traced by the producer
+    }
+    timing.stored_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    frame_ref.set_timing(timing);
+}
+
+void FrameBuffer::push_queue(FrameRef&& frame_ref) {
+    const uint64_t seq = write_seq_.load(std::memory_order_relaxed);  // Single producer
+
+    if (policy_ != FrameQueuePolicy::DropOldest && queue_full(seq)) {
+        if (policy_ == FrameQueuePolicy::Block) {
+            std::unique_lock<std::mutex> lock(space_mutex_);
+            space_cv_.wait_for(lock, std::chrono::microseconds(block_timeout_us_),
+                               [&]() { return !queue_full(seq); });
+        }
+
+        if (queue_full(seq)) {
+            // Nobody receives the refused frame
+            frames_dropped_++;
+            dropped_metric().add();
+            record_queue_drop(1);
+            for (auto& consumer : consumers_) {
+                if (consumer.active.load(std::memory_order_relaxed)) {
+                    consumer.dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            return;
+        }
+    }
+
+    // Still invisible to consumers, so the stamp needs no extra synchronisation
+    stamp_stored(frame_ref);
+
+    QueueSlot& slot = slots_[seq & (capacity_ - 1)];
+    {
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        slot.frame = std::move(frame_ref);
+        slot.seq = seq;
+    }
+
+    write_seq_.store(seq + 1, std::memory_order_release);
+    frames_generated_++;
+
+    // Consumers also wake on timeout, so a missed notify only costs latency
+    data_cv_.notify_all();
+}
+
+std::optional<FrameRef> FrameBuffer::consume_frame(int consumer_id) {
+    PROFILE_ZONE("FrameBuffer::consume_frame");
+    ALLOC_SCOPE("frame_buffer_consume");
+    if (capacity_ == 0 || consumer_id < 0 || consumer_id >= MAX_CONSUMERS) {
+        return std::nullopt;
+    }
+
+    Consumer& consumer = consumers_[consumer_id];
+    if (!consumer.active.load(std::memory_order_acquire)) {
+        return std::nullopt;
+    }
+
+    const uint64_t write_seq = write_seq_.load(std::memory_order_acquire);
+    uint64_t cursor = consumer.cursor.load(std::memory_order_relaxed);
+    if (cursor >= write_seq) {
+        return std::nullopt;  // Nothing new for this consumer
+    }
+
+    // Display skips to the newest frame; every-frame consumers only skip
+    // what DropOldest has already overwritten
+    uint64_t skipped = 0;
+    if (!consumer.every_frame) {
+        skipped = write_seq - 1 - cursor;
+    } else if (write_seq - cursor > capacity_) {
+        skipped = write_seq - cursor - capacity_;
+    }
+    cursor += skipped;
+
+    FrameRef frame;
+    {
+        QueueSlot& slot = slots_[cursor & (capacity_ - 1)];
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        if (slot.seq != cursor) {
+            // Overwritten since write_seq_ was read (DropOldest) - take the newer frame
+            skipped += slot.seq - cursor;
+            cursor = slot.seq;
+        }
+        frame = slot.frame;  // ZERO-COPY: shares data with the queued frame
+    }
+
+    if (skipped > 0) {
+        consumer.dropped.fetch_add(static_cast<int64_t>(skipped), std::memory_order_relaxed);
+        record_queue_drop(static_cast<int64_t>(skipped));
+    }
+    consumer.cursor.store(cursor + 1, std::memory_order_release);
+
+    // Wake a producer waiting for space (lock pairs with its predicate check)
+    if (policy_ == FrameQueuePolicy::Block && consumer.every_frame) {
+        { std::lock_guard<std::mutex> lock(space_mutex_); }
+        space_cv_.notify_one();
+    }
+
+    return frame;
+}
+
 void FrameBuffer::store_frame(const cv::Mat& frame) {
+    PROFILE_ZONE("FrameBuffer::store_frame");
+    ALLOC_SCOPE("frame_buffer_store");
     if (frame.empty()) {
         return;
     }
 
+    if (capacity_ != 0) {
+        push_queue(FrameRef(frame));
+        return;
+    }
+
     // Only store new frame if previous frame was consumed
     // This prevents frame queue buildup and maintains real-time display
     if (!frame_consumed_.load()) {
         frames_dropped_++;
+        dropped_metric().add();
         return;  // Drop this frame - previous frame not yet displayed
     }
 
@@ -22,13 +264,21 @@ void FrameBuffer::store_frame(const cv::Mat& frame) {
 }
 
 void FrameBuffer::store_frame(const FrameRef& frame_ref) {
+    PROFILE_ZONE("FrameBuffer::store_frame");
+    ALLOC_SCOPE("frame_buffer_store");
     if (frame_ref.empty()) {
         return;
     }
 
+    if (capacity_ != 0) {
+        push_queue(FrameRef(frame_ref));
+        return;
+    }
+
     // Only store new frame if previous frame was consumed
     if (!frame_consumed_.load()) {
         frames_dropped_++;
+        dropped_metric().add();
         return;  // Drop this frame - previous frame not yet displayed
     }
 
@@ -40,24 +290,39 @@ void FrameBuffer::store_frame(const FrameRef& frame_ref) {
 }
 
 void FrameBuffer::store_frame(FrameRef&& frame_ref) {
+    PROFILE_ZONE("FrameBuffer::store_frame");
+    ALLOC_SCOPE("frame_buffer_store");
     if (frame_ref.empty()) {
         return;
     }
 
+    if (capacity_ != 0) {
+        push_queue(std::move(frame_ref));
+        return;
+    }
+
     // Only store new frame if previous frame was consumed
     if (!frame_consumed_.load()) {
         frames_dropped_++;
+        dropped_metric().add();
         return;  // Drop this frame - previous frame not yet displayed
     }
 
     std::lock_guard<std::mutex> lock(mutex_);
     // ZERO-COPY: Move FrameRef (no allocation, just pointer swap)
+    stamp_stored(frame_ref);
     current_frame_ = std::move(frame_ref);
     frame_consumed_.store(false);
     frames_generated_++;
 }
 
 std::optional<FrameRef> FrameBuffer::consume_frame() {
+    PROFILE_ZONE("FrameBuffer::consume_frame");
+    if (capacity_ != 0) {
+        return consume_frame(0);
+    }
+    ALLOC_SCOPE("frame_buffer_consume");  // After the queue path, which is counted there
+
     std::lock_guard<std::mutex> lock(mutex_);
 
     if (frame_consumed_.load()) {
@@ -69,14 +334,51 @@ std::optional<FrameRef> FrameBuffer::consume_frame() {
     return current_frame_;
 }
 
+void FrameBuffer::store_binary_frame(std::shared_ptr<const BinaryFrame> frame) {
+    if (!frame || frame->empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_binary_ = std::move(frame);
+}
+
+std::shared_ptr<const BinaryFrame> FrameBuffer::get_binary_frame() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return current_binary_;
+}
+
 bool FrameBuffer::has_unconsumed_frame() const {
+    if (capacity_ != 0) {
+        return consumers_[0].cursor.load() < write_seq_.load();
+    }
     return !frame_consumed_.load();
 }
 
 int64_t FrameBuffer::get_frames_dropped() const {
+    if (capacity_ != 0) {
+        return consumers_[0].dropped.load();
+    }
     return frames_dropped_.load();
 }
 
+int64_t FrameBuffer::get_frames_dropped(int consumer_id) const {
+    if (consumer_id < 0 || consumer_id >= MAX_CONSUMERS) {
+        return 0;
+    }
+    return consumers_[consumer_id].dropped.load();
+}
+
+size_t FrameBuffer::get_backlog(int consumer_id) const {
+    if (capacity_ == 0 || consumer_id < 0 || consumer_id >= MAX_CONSUMERS ||
+        !consumers_[consumer_id].active.load(std::memory_order_acquire)) {
+        return 0;
+    }
+    const uint64_t write_seq = write_seq_.load(std::memory_order_acquire);
+    const uint64_t cursor = consumers_[consumer_id].cursor.load(std::memory_order_acquire);
+    return write_seq > cursor ? static_cast<size_t>(std::min<uint64_t>(write_seq - cursor, capacity_)) : 0;
+}
+
 int64_t FrameBuffer::get_frames_generated() const {
     return frames_generated_.load();
 }
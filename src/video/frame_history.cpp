@@ -0,0 +1,328 @@
+#include "video/frame_history.h"
+#include <cstring>
+
+namespace video {
+
+namespace {
+
+// Zero bytes a literal may absorb rather than end; a new run costs two varints
+constexpr size_t MAX_LITERAL_GAP = 2;
+
+void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const uint8_t byte = *p++;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Byte stream -> (zero run, literal length, literal bytes) tokens
+ *
+ * Zero bytes after the last literal are dropped; the decoder knows the
+ * frame size and leaves them untouched.
+ */
+class RunEncoder {
+public:
+    RunEncoder(std::vector<uint8_t>& out, std::vector<uint8_t>& literal)
+        : out_(out), literal_(literal) {
+        out_.clear();
+        literal_.clear();
+    }
+
+    void zero_bytes(size_t count) { zeros_ += count; }
+
+    void byte(uint8_t value) {
+        if (value == 0) {
+            ++zeros_;
+            return;
+        }
+        if (!literal_.empty() && zeros_ <= MAX_LITERAL_GAP) {
+            literal_.insert(literal_.end(), zeros_, uint8_t(0));
+        } else {
+            flush();
+            run_ = zeros_;
+        }
+        zeros_ = 0;
+        literal_.push_back(value);
+    }
+
+    void finish() { flush(); }
+
+private:
+    void flush() {
+        if (literal_.empty()) {
+            return;
+        }
+        put_varint(out_, run_);
+        put_varint(out_, literal_.size());
+        out_.insert(out_.end(), literal_.begin(), literal_.end());
+        literal_.clear();
+    }
+
+    std::vector<uint8_t>& out_;
+    std::vector<uint8_t>& literal_;
+    size_t zeros_ = 0;   // Zero bytes since the last non-zero one
+    size_t run_ = 0;     // Zero bytes before the pending literal
+};
+
+/**
+ * Encode cur (key frame, prev = nullptr) or cur ^ prev
+ */
+void encode_frame(const uint64_t* cur, const uint64_t* prev, size_t words,
+                  std::vector<uint8_t>& out, std::vector<uint8_t>& literal) {
+    RunEncoder encoder(out, literal);
+    for (size_t i = 0; i < words; ++i) {
+        const uint64_t word = prev ? cur[i] ^ prev[i] : cur[i];
+        if (word == 0) {
+            encoder.zero_bytes(sizeof(word));   // Most words of a sparse frame or delta
+            continue;
+        }
+        uint8_t bytes[sizeof(word)];
+        std::memcpy(bytes, &word, sizeof(word));
+        for (uint8_t byte : bytes) {
+            encoder.byte(byte);
+        }
+    }
+    encoder.finish();
+}
+
+/**
+ * XOR an encoded frame into frame bytes
+ * @return false if the data runs past the frame or is truncated
+ */
+bool apply_frame(const uint8_t* data, size_t size, uint8_t* frame, size_t frame_bytes) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    size_t pos = 0;
+    while (p < end) {
+        uint64_t run = 0;
+        uint64_t length = 0;
+        if (!get_varint(p, end, run) || !get_varint(p, end, length) ||
+            run > frame_bytes - pos || length > frame_bytes - pos - run ||
+            length > static_cast<size_t>(end - p)) {
+            return false;
+        }
+        pos += run;
+        for (uint64_t i = 0; i < length; ++i) {
+            frame[pos + i] ^= p[i];
+        }
+        p += length;
+        pos += length;
+    }
+    return true;
+}
+
+} // namespace
+
+void FrameHistory::configure(double seconds, size_t max_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    window_us_ = seconds > 0.0 ? static_cast<int64_t>(seconds * 1e6) : 0;
+    if (max_bytes != max_bytes_) {
+        arena_.reset();
+        arena_bytes_.store(0, std::memory_order_relaxed);
+    }
+    max_bytes_ = max_bytes;
+    reset_locked(cv::Size());
+
+    const bool enabled = window_us_ > 0 && max_bytes_ > 0;
+    enabled_.store(enabled, std::memory_order_relaxed);
+    recording_.store(enabled && !frozen_.load(), std::memory_order_release);
+    if (!enabled) {
+        arena_.reset();
+        arena_bytes_.store(0, std::memory_order_relaxed);
+    }
+}
+
+void FrameHistory::freeze(bool frozen) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frozen_.store(frozen, std::memory_order_relaxed);
+    recording_.store(enabled_.load() && !frozen, std::memory_order_release);
+}
+
+void FrameHistory::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    reset_locked(cv::Size());
+}
+
+size_t FrameHistory::release() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (frozen_.load() || !arena_) {
+        return 0;   // Being scrubbed
+    }
+
+    // Stays off until configure(); allocating again with the next frame would only be released again
+    reset_locked(cv::Size());
+    arena_.reset();
+    enabled_.store(false, std::memory_order_relaxed);
+    recording_.store(false, std::memory_order_release);
+    return arena_bytes_.exchange(0);
+}
+
+void FrameHistory::reset_locked(cv::Size size) {
+    entries_.clear();
+    head_ = 0;
+    size_ = size;
+    since_key_ = 0;
+    decoded_timestamp_ = -1;
+    stored_bytes_.store(0, std::memory_order_relaxed);
+}
+
+void FrameHistory::pop_group_locked() {
+    do {
+        stored_bytes_.fetch_sub(entries_.front().bytes, std::memory_order_relaxed);
+        entries_.pop_front();
+    } while (!entries_.empty() && !entries_.front().key);
+}
+
+size_t FrameHistory::reserve_locked(size_t bytes) {
+    // Frames ahead of head_ are the oldest; wrapping skips the tail, so they go first
+    if (head_ + bytes > max_bytes_) {
+        while (!entries_.empty() && entries_.front().offset >= head_) {
+            pop_group_locked();
+        }
+        head_ = 0;
+    }
+    while (!entries_.empty() && entries_.front().offset >= head_ && entries_.front().offset < head_ + bytes) {
+        pop_group_locked();
+    }
+    const size_t offset = head_;
+    head_ += bytes;
+    return offset;
+}
+
+void FrameHistory::push_frame(const cv::Mat& frame, int64_t timestamp_us, uint8_t bit_mask) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!recording_.load(std::memory_order_relaxed)) {
+        return;  // Frozen or disabled since the fast-path check
+    }
+
+    if (!(bit_mask == 0 ? current_.assign(frame) : current_.assign_masked(frame, bit_mask))) {
+        frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // A new size or a clock that went back (camera restart, replay loop) starts over
+    if (frame.size() != size_ || (!entries_.empty() && timestamp_us < entries_.back().timestamp_us)) {
+        reset_locked(frame.size());
+    }
+    if (!arena_) {
+        arena_.reset(new uint8_t[max_bytes_]);
+        arena_bytes_.store(max_bytes_, std::memory_order_relaxed);
+    }
+
+    bool key = entries_.empty() || since_key_ >= KEY_INTERVAL - 1;
+    encode_frame(current_.data(), key ? nullptr : previous_.data(), current_.word_count(), encoded_, literal_);
+    if (encoded_.size() > max_bytes_) {
+        frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;  // previous_ stays the last stored frame, so the next delta still decodes
+    }
+
+    size_t offset = reserve_locked(encoded_.size());
+    if (!key && entries_.empty()) {
+        // Eviction took the frame this delta refers to
+        key = true;
+        encode_frame(current_.data(), nullptr, current_.word_count(), encoded_, literal_);
+        offset = reserve_locked(encoded_.size());
+    }
+    if (!encoded_.empty()) {
+        std::memcpy(arena_.get() + offset, encoded_.data(), encoded_.size());
+    }
+
+    Entry entry;
+    entry.timestamp_us = timestamp_us;
+    entry.offset = offset;
+    entry.bytes = static_cast<uint32_t>(encoded_.size());
+    entry.key = key;
+    entries_.push_back(entry);
+    stored_bytes_.fetch_add(encoded_.size(), std::memory_order_relaxed);
+    since_key_ = key ? 0 : since_key_ + 1;
+    std::swap(previous_, current_);
+
+    // Drop the oldest group once the next one alone still covers the window
+    const int64_t cutoff = timestamp_us - window_us_;
+    for (;;) {
+        size_t next_key = 1;
+        while (next_key < entries_.size() && !entries_[next_key].key) {
+            ++next_key;
+        }
+        if (next_key >= entries_.size() || entries_[next_key].timestamp_us > cutoff) {
+            break;
+        }
+        pop_group_locked();
+    }
+}
+
+int FrameHistory::get_frame_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(entries_.size());
+}
+
+int64_t FrameHistory::get_timestamp(int index) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index < 0 || index >= static_cast<int>(entries_.size())) {
+        return -1;
+    }
+    return entries_[static_cast<size_t>(index)].timestamp_us;
+}
+
+cv::Size FrameHistory::get_size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+}
+
+bool FrameHistory::decode(int index, cv::Mat& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index < 0 || index >= static_cast<int>(entries_.size())) {
+        return false;
+    }
+
+    // Continue from the decoded frame when it is in the same group and not after index
+    int key = index;
+    while (!entries_[static_cast<size_t>(key)].key) {
+        --key;
+    }
+    int from = key;
+    if (decoded_timestamp_ >= 0 && decoded_.size() == size_) {
+        for (int k = index; k >= key; --k) {
+            if (entries_[static_cast<size_t>(k)].timestamp_us == decoded_timestamp_) {
+                from = k + 1;
+                break;
+            }
+        }
+    }
+    if (from == key) {
+        if (decoded_.size() != size_) {
+            decoded_.create(size_.width, size_.height);
+        } else {
+            decoded_.clear();
+        }
+    }
+
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(decoded_.data());
+    const size_t frame_bytes = decoded_.word_count() * sizeof(uint64_t);
+    for (int k = from; k <= index; ++k) {
+        const Entry& entry = entries_[static_cast<size_t>(k)];
+        if (!apply_frame(arena_.get() + entry.offset, entry.bytes, bytes, frame_bytes)) {
+            decoded_timestamp_ = -1;
+            return false;
+        }
+    }
+    decoded_timestamp_ = entries_[static_cast<size_t>(index)].timestamp_us;
+    decoded_.to_mat(out);
+    return true;
+}
+
+} // namespace video
@@ -0,0 +1,82 @@
+#include "video/frame_pool.h"
+#include "core/locked_memory.h"
+
+namespace video {
+
+FramePool::FramePool(int slot_count) {
+    slots_.resize(slot_count > 0 ? slot_count : 1);
+}
+
+void FramePool::configure(cv::Size size, int type) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (size == size_ && type == type_) {
+        return;
+    }
+
+    // Old slots still in flight stay valid: their control blocks are simply
+    // released by the pool and freed when the last holder drops them
+    for (auto& slot : slots_) {
+        cv::Mat mat;
+        mat.allocator = core::LockedMemory::instance().mat_allocator();
+        mat.create(size, type);
+        slot = std::make_shared<FrameRef::FrameData>(std::move(mat));
+    }
+    size_ = size;
+    type_ = type;
+    next_ = 0;
+    bytes_ = slots_.size() * static_cast<size_t>(size.area()) * CV_ELEM_SIZE(type);
+}
+
+void FramePool::prefault(cv::Size size, int type) {
+    configure(size, type);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& slot : slots_) {
+        if (is_free(slot)) {
+            slot->mat_.setTo(cv::Scalar::all(0));
+        }
+    }
+}
+
+bool FramePool::is_free(const std::shared_ptr<FrameRef::FrameData>& slot) {
+    if (!slot || slot.use_count() != 1) {
+        return false;  // A FrameRef still shares this control block
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);  // The last holder's reads happen before our writes
+
+    // A bare cv::Mat copy (e.g. display copy) may still share the pixels
+    const cv::Mat& mat = slot->mat_;
+    return mat.u == nullptr || mat.u->refcount == 1;
+}
+
+FrameRef FramePool::acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const size_t count = slots_.size();
+    for (size_t n = 0; n < count; ++n) {
+        size_t i = (next_ + n) % count;
+        if (is_free(slots_[i])) {
+            next_ = (i + 1) % count;
+            acquired_.fetch_add(1, std::memory_order_relaxed);
+            slots_[i]->timing_ = FrameTiming{};  // Recycled slot: drop the previous frame's stamps
+            slots_[i]->row_bands_ = RowBands{};
+            slots_[i]->block_map_.reset();
+            slots_[i]->preview_.release();
+            return FrameRef(slots_[i]);
+        }
+    }
+
+    exhausted_.fetch_add(1, std::memory_order_relaxed);
+    return FrameRef();
+}
+
+FrameRef FramePool::acquire(cv::Size size, int type) {
+    configure(size, type);
+    return acquire();
+}
+
+cv::Mat& FramePool::writable(FrameRef& frame) {
+    static cv::Mat empty_mat;
+    return frame.data_ ? frame.data_->mat_ : empty_mat;
+}
+
+} // namespace video
@@ -1,4 +1,5 @@
 #include "video/frame_processor.h"
+#include <algorithm>
 
 namespace video {
 
@@ -8,50 +9,79 @@ void FrameProcessor::add_filter(std::shared_ptr<IVideoFilter> filter) {
     }
 
     std::lock_guard<std::mutex> lock(mutex_);
-    filters_.push_back(filter);
+    stages_.push_back(Stage{std::move(filter), {}});
 }
 
 void FrameProcessor::remove_filter(const std::string& name) {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    filters_.erase(
-        std::remove_if(filters_.begin(), filters_.end(),
-            [&name](const std::shared_ptr<IVideoFilter>& filter) {
-                return filter && filter->name() == name;
+    stages_.erase(
+        std::remove_if(stages_.begin(), stages_.end(),
+            [&name](const Stage& stage) {
+                return stage.filter && stage.filter->name() == name;
             }),
-        filters_.end()
+        stages_.end()
     );
 }
 
 std::shared_ptr<IVideoFilter> FrameProcessor::get_filter(const std::string& name) {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    for (auto& filter : filters_) {
-        if (filter && filter->name() == name) {
-            return filter;
+    for (auto& stage : stages_) {
+        if (stage.filter && stage.filter->name() == name) {
+            return stage.filter;
         }
     }
 
     return nullptr;
 }
 
-cv::Mat FrameProcessor::process(const cv::Mat& input) {
+FrameRef& FrameProcessor::free_slot(Stage& stage) {
+    for (auto& slot : stage.slots) {
+        if (slot.use_count() <= 1) {
+            return slot;
+        }
+    }
+    stage.slots.emplace_back();
+    return stage.slots.back();
+}
+
+bool FrameProcessor::is_exclusive(const FrameRef& frame) {
+    return frame.is_exclusive() && frame.unsafe_get().u != nullptr;
+}
+
+bool FrameProcessor::process(const FrameRef& input, FrameRef& output) {
     if (input.empty()) {
-        return input;
+        output = input;
+        return false;
     }
 
     std::lock_guard<std::mutex> lock(mutex_);
 
-    cv::Mat result = input;
+    const FrameRef* current = &input;
+    FrameRef* owned = nullptr;  // Scratch frame holding the result so far (null = still input)
 
     // Apply all filters in sequence
-    for (auto& filter : filters_) {
-        if (filter && filter->is_enabled()) {
-            result = filter->apply(result);
+    for (auto& stage : stages_) {
+        if (!stage.filter || !stage.filter->is_enabled()) {
+            continue;
+        }
+
+        // Our own scratch frame, untouched by anyone else: no copy needed
+        if (owned && is_exclusive(*owned) && stage.filter->apply_in_place(*owned)) {
+            continue;
+        }
+
+        FrameRef& slot = free_slot(stage);
+        if (stage.filter->apply(*current, slot)) {
+            slot.set_timing(current->timing());
+            current = &slot;
+            owned = &slot;
         }
     }
 
-    return result;
+    output = *current;
+    return owned != nullptr;
 }
 
 cv::Mat FrameProcessor::bgr_to_rgb(const cv::Mat& frame) {
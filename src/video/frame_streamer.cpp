@@ -0,0 +1,411 @@
+#include "video/frame_streamer.h"
+#include "core/metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using socket_t = SOCKET;
+static inline void close_socket(socket_t s) { closesocket(s); }
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using socket_t = int;
+static inline void close_socket(socket_t s) { ::close(s); }
+#endif
+
+namespace video {
+
+namespace {
+
+constexpr intptr_t NO_SOCKET = -1;
+constexpr int POLL_MS = 5;            // Pending sends are retried this often
+constexpr uint16_t MAX_RUN = 0xFFFF;
+
+socket_t as_socket(intptr_t s) { return static_cast<socket_t>(s); }
+
+int64_t steady_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void set_non_blocking(socket_t s) {
+#ifdef _WIN32
+    u_long mode = 1;
+    ioctlsocket(s, FIONBIO, &mode);
+#else
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    int no_delay = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&no_delay), sizeof(no_delay));
+}
+
+/**
+ * Send without blocking
+ * @return Bytes accepted (0 if the socket buffer is full), -1 if the connection is gone
+ */
+int64_t send_some(socket_t s, const uint8_t* data, size_t size) {
+#ifdef _WIN32
+    const int sent = send(s, reinterpret_cast<const char*>(data), static_cast<int>(std::min<size_t>(size, 1 << 30)), 0);
+    if (sent == SOCKET_ERROR) {
+        return WSAGetLastError() == WSAEWOULDBLOCK ? 0 : -1;
+    }
+#else
+    const ssize_t sent = send(s, data, size, MSG_NOSIGNAL);
+    if (sent < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+    }
+#endif
+    return static_cast<int64_t>(sent);
+}
+
+void put_u16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+} // namespace
+
+FrameStreamer::~FrameStreamer() {
+    stop();
+}
+
+bool FrameStreamer::start(const Options& options) {
+    stop();
+    options_ = options;
+    options_.max_clients = std::max(options_.max_clients, 1);
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        std::cerr << "FrameStreamer: WSAStartup failed" << std::endl;
+        return false;
+    }
+    winsock_started_ = true;
+#endif
+
+    socket_t s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == as_socket(NO_SOCKET)) {
+        std::cerr << "FrameStreamer: Failed to create socket" << std::endl;
+        stop();
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(options_.port));
+    if (bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(s, 4) != 0) {
+        std::cerr << "FrameStreamer: Cannot listen on port " << options_.port << std::endl;
+        close_socket(s);
+        stop();
+        return false;
+    }
+    listener_ = static_cast<intptr_t>(s);
+
+    for (int i = 0; i < MAX_CAMERAS; ++i) {
+        latest_[i].release();
+        latest_sequence_[i] = 0;
+        packed_sequence_[i] = 0;
+    }
+    running_ = true;
+    thread_ = std::thread(&FrameStreamer::run, this);
+    std::cout << "Streaming frames on port " << options_.port << " (up to " << options_.max_clients << " clients, "
+              << options_.max_fps << " fps each)" << std::endl;
+    return true;
+}
+
+void FrameStreamer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    for (Client& client : clients_) {
+        close_socket(as_socket(client.socket));
+    }
+    clients_.clear();
+    client_count_ = 0;
+    if (listener_ != NO_SOCKET) {
+        close_socket(as_socket(listener_));
+        listener_ = NO_SOCKET;
+    }
+    for (cv::Mat& frame : latest_) {
+        frame.release();
+    }
+#ifdef _WIN32
+    if (winsock_started_) {
+        WSACleanup();
+    }
+#endif
+    winsock_started_ = false;
+}
+
+void FrameStreamer::submit(int camera_index, int64_t timestamp_us, const cv::Mat& frame, int binning) {
+    if (!running_.load(std::memory_order_relaxed) || camera_index < 0 || camera_index >= MAX_CAMERAS ||
+        frame.empty() || frame.type() != CV_8UC1) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        latest_[camera_index] = frame;  // Replaces an unsent frame: the skip happens here
+        latest_ts_[camera_index] = timestamp_us;
+        latest_binning_[camera_index] = binning;
+        ++latest_sequence_[camera_index];
+    }
+    cv_.notify_one();
+}
+
+void FrameStreamer::run() {
+    static core::Counter& frames_sent = core::MetricsRegistry::instance().counter("stream.frames_sent");
+    static core::Counter& frames_skipped = core::MetricsRegistry::instance().counter("stream.frames_skipped");
+    static core::Gauge& clients_gauge = core::MetricsRegistry::instance().gauge("stream.clients");
+
+    cv::Mat fresh[MAX_CAMERAS];
+    while (running_.load()) {
+        // Take the newest frames; their slots go back to the camera path as soon as they are packed
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait_for(lock, std::chrono::milliseconds(POLL_MS), [this] {
+                if (!running_.load()) return true;
+                for (int i = 0; i < MAX_CAMERAS; ++i) {
+                    if (latest_sequence_[i] != packed_sequence_[i]) return true;
+                }
+                return false;
+            });
+            for (int i = 0; i < MAX_CAMERAS; ++i) {
+                if (latest_sequence_[i] != packed_sequence_[i]) {
+                    fresh[i] = std::move(latest_[i]);
+                    latest_[i].release();
+                    packed_ts_[i] = latest_ts_[i];
+                    packed_binning_[i] = latest_binning_[i];
+                    packed_sequence_[i] = latest_sequence_[i];
+                }
+            }
+        }
+        for (int i = 0; i < MAX_CAMERAS; ++i) {
+            if (!fresh[i].empty()) {
+                packed_[i].assign(fresh[i]);
+                fresh[i].release();
+            }
+        }
+
+        accept_clients();
+        const int64_t now_us = steady_us();
+        for (size_t c = 0; c < clients_.size();) {
+            Client& client = clients_[c];
+            bool alive = flush(client);
+            for (int i = 0; alive && i < MAX_CAMERAS; ++i) {
+                if (client.pending.empty() && packed_sequence_[i] != 0 && packed_sequence_[i] != client.last_sequence[i] &&
+                    now_us >= client.next_send_us[i]) {
+                    if (client.last_sequence[i] != 0) {
+                        frames_skipped.add(static_cast<int64_t>(packed_sequence_[i] - client.last_sequence[i] - 1));
+                    }
+                    send_frame(client, i, now_us);
+                    frames_sent.add();
+                    alive = flush(client);
+                }
+            }
+            if (alive) {
+                ++c;
+            } else {
+                close_socket(as_socket(client.socket));
+                clients_.erase(clients_.begin() + static_cast<std::ptrdiff_t>(c));
+                std::cout << "Stream client disconnected (" << clients_.size() << " left)" << std::endl;
+            }
+        }
+        client_count_.store(static_cast<int>(clients_.size()), std::memory_order_relaxed);
+        clients_gauge.set(static_cast<double>(clients_.size()));
+    }
+}
+
+void FrameStreamer::accept_clients() {
+    const socket_t listener = as_socket(listener_);
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(listener, &set);
+    timeval timeout{0, 0};
+    if (select(static_cast<int>(listener) + 1, &set, nullptr, nullptr, &timeout) <= 0) {
+        return;
+    }
+
+    sockaddr_in addr{};
+    socklen_t addr_len = sizeof(addr);
+    socket_t s = accept(listener, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+    if (s == as_socket(NO_SOCKET)) {
+        return;
+    }
+    if (static_cast<int>(clients_.size()) >= options_.max_clients) {
+        close_socket(s);
+        std::cerr << "FrameStreamer: Rejected client, " << options_.max_clients << " already connected" << std::endl;
+        return;
+    }
+    set_non_blocking(s);
+
+    char host[INET_ADDRSTRLEN] = "?";
+    inet_ntop(AF_INET, &addr.sin_addr, host, sizeof(host));
+    clients_.emplace_back();
+    clients_.back().socket = static_cast<intptr_t>(s);
+    std::cout << "Stream client connected from " << host << " (" << clients_.size() << " connected)" << std::endl;
+}
+
+bool FrameStreamer::flush(Client& client) {
+    const socket_t s = as_socket(client.socket);
+
+    // Viewers send nothing; readable means closed (or stray bytes, discarded)
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(s, &set);
+    timeval timeout{0, 0};
+    if (select(static_cast<int>(s) + 1, &set, nullptr, nullptr, &timeout) > 0) {
+        char scratch[256];
+        if (recv(s, scratch, sizeof(scratch), 0) <= 0) {
+            return false;
+        }
+    }
+
+    while (client.sent < client.pending.size()) {
+        const int64_t sent = send_some(s, client.pending.data() + client.sent, client.pending.size() - client.sent);
+        if (sent < 0) {
+            return false;
+        }
+        if (sent == 0) {
+            return true;  // Socket buffer full: this client skips frames until it drains
+        }
+        client.sent += static_cast<size_t>(sent);
+    }
+    client.pending.clear();
+    client.sent = 0;
+    return true;
+}
+
+void FrameStreamer::send_frame(Client& client, int camera, int64_t now_us) {
+    static core::Counter& bytes_sent = core::MetricsRegistry::instance().counter("stream.bytes_sent");
+
+    const BinaryFrame& frame = packed_[camera];
+    BinaryFrame& reference = client.reference[camera];
+    const bool has_reference = reference.width() == frame.width() && reference.height() == frame.height();
+
+    encode(frame, nullptr, key_);
+    bool delta = false;
+    if (has_reference) {
+        encode(frame, &reference, delta_);
+        delta = delta_.size() < key_.size();
+    }
+    const std::vector<uint8_t>& payload = delta ? delta_ : key_;
+
+    MessageHeader header{};
+    header.magic = MAGIC;
+    header.type = static_cast<uint8_t>(delta ? FrameType::Delta : FrameType::Key);
+    header.camera_index = static_cast<uint8_t>(camera);
+    header.binning = static_cast<uint16_t>(packed_binning_[camera]);
+    header.width = frame.width();
+    header.height = frame.height();
+    header.timestamp_us = packed_ts_[camera];
+    header.sequence = packed_sequence_[camera];
+    header.payload_bytes = static_cast<uint32_t>(payload.size());
+
+    const auto* header_bytes = reinterpret_cast<const uint8_t*>(&header);
+    client.pending.insert(client.pending.end(), header_bytes, header_bytes + sizeof(header));
+    client.pending.insert(client.pending.end(), payload.begin(), payload.end());
+    bytes_sent.add(static_cast<int64_t>(sizeof(header) + payload.size()));
+
+    if (has_reference) {
+        std::copy(frame.data(), frame.data() + frame.word_count(), reference.data());
+    } else {
+        reference = frame;
+    }
+    client.last_sequence[camera] = packed_sequence_[camera];
+    client.next_send_us[camera] = options_.max_fps > 0 ? now_us + 1000000 / options_.max_fps : 0;
+}
+
+void FrameStreamer::encode(const BinaryFrame& frame, const BinaryFrame* reference, std::vector<uint8_t>& out) {
+    out.clear();
+    const int words = frame.words_per_row();
+    for (int y = 0; y < frame.height(); ++y) {
+        const uint64_t* row = frame.row(y);
+        const uint64_t* ref = reference ? reference->row(y) : nullptr;
+        auto word = [row, ref](int x) { return ref ? row[x] ^ ref[x] : row[x]; };
+
+        int x = 0;
+        do {
+            const int zeros_start = x;
+            while (x < words && x - zeros_start < MAX_RUN && word(x) == 0) ++x;
+            const int literal_start = x;
+            while (x < words && x - literal_start < MAX_RUN && word(x) != 0) ++x;
+            put_u16(out, static_cast<uint16_t>(literal_start - zeros_start));
+            put_u16(out, static_cast<uint16_t>(x - literal_start));
+            for (int i = literal_start; i < x; ++i) {
+                const uint64_t value = word(i);
+                for (int b = 0; b < 8; ++b) {
+                    out.push_back(static_cast<uint8_t>(value >> (8 * b)));
+                }
+            }
+        } while (x < words);
+    }
+}
+
+bool FrameStreamer::decode(const MessageHeader& header, const uint8_t* payload, BinaryFrame& frame) {
+    if (header.magic != MAGIC || header.width <= 0 || header.height <= 0) {
+        return false;
+    }
+    if (header.type == static_cast<uint8_t>(FrameType::Key)) {
+        if (frame.width() != header.width || frame.height() != header.height) {
+            frame.create(header.width, header.height);
+        } else {
+            frame.clear();
+        }
+    } else if (frame.width() != header.width || frame.height() != header.height) {
+        return false;  // Delta without its reference
+    }
+
+    const uint8_t* p = payload;
+    const uint8_t* end = payload + header.payload_bytes;
+    auto read = [&p, end](int bytes, uint64_t& value) {
+        if (end - p < bytes) return false;
+        value = 0;
+        for (int b = 0; b < bytes; ++b) value |= static_cast<uint64_t>(p[b]) << (8 * b);
+        p += bytes;
+        return true;
+    };
+
+    const int words = frame.words_per_row();
+    for (int y = 0; y < frame.height(); ++y) {
+        uint64_t* row = frame.row(y);
+        int x = 0;
+        do {
+            uint64_t zeros = 0;
+            uint64_t literals = 0;
+            if (!read(2, zeros) || !read(2, literals) || x + zeros + literals > static_cast<uint64_t>(words)) {
+                return false;
+            }
+            x += static_cast<int>(zeros);
+            for (uint64_t i = 0; i < literals; ++i, ++x) {
+                uint64_t value;
+                if (!read(8, value)) return false;
+                row[x] ^= value;
+            }
+        } while (x < words);
+    }
+    return p == end;
+}
+
+} // namespace video
@@ -1,6 +1,13 @@
 #include "video/gpu_compute.h"
+#include <algorithm>
 #include <iostream>
+#include <cmath>
+#include <cstdio>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
 
 namespace video {
 namespace gpu {
@@ -50,6 +57,57 @@ void main() {
 }
 )";
 
+// Separable morphology pass of the dot detection chain: one 256-pixel line segment per
+// workgroup, staged with its halo in shared memory; the threshold is fused into the first pass
+const char* morphology_chain_shader_source = R"(
+#version 430 core
+#define SEGMENT 256
+#define MAX_KERNEL 63
+layout(local_size_x = SEGMENT) in;
+
+layout(binding = 0, r8) uniform readonly image2D input_image;
+layout(binding = 1, r8) uniform writeonly image2D output_image;
+
+uniform int axis;          // 0 = along rows, 1 = along columns
+uniform int operation;     // 0 = erode (min), 1 = dilate (max)
+uniform int kernel_size;
+uniform int threshold;     // >= 0: binarize the input first (value > threshold)
+
+shared float line_values[SEGMENT + MAX_KERNEL - 1];
+
+void main() {
+    ivec2 size = imageSize(input_image);
+    int length = axis == 0 ? size.x : size.y;
+    int line = int(gl_WorkGroupID.y);
+    int first = int(gl_WorkGroupID.x) * SEGMENT - kernel_size / 2;   // Same anchor as OpenCV
+    float neutral = operation == 0 ? 1.0 : 0.0;   // Outside pixels never win, like OpenCV's border
+
+    for (int i = int(gl_LocalInvocationID.x); i < SEGMENT + kernel_size - 1; i += SEGMENT) {
+        int along = first + i;
+        float value = neutral;
+        if (along >= 0 && along < length) {
+            ivec2 pos = axis == 0 ? ivec2(along, line) : ivec2(line, along);
+            value = imageLoad(input_image, pos).r;
+            if (threshold >= 0) {
+                value = round(value * 255.0) > float(threshold) ? 1.0 : 0.0;
+            }
+        }
+        line_values[i] = value;
+    }
+    barrier();
+
+    int along = int(gl_WorkGroupID.x) * SEGMENT + int(gl_LocalInvocationID.x);
+    if (along < length) {
+        float result = neutral;
+        for (int k = 0; k < kernel_size; ++k) {
+            float value = line_values[int(gl_LocalInvocationID.x) + k];
+            result = operation == 0 ? min(result, value) : max(result, value);
+        }
+        imageStore(output_image, axis == 0 ? ivec2(along, line) : ivec2(line, along), vec4(result));
+    }
+}
+)";
+
 // Histogram compute shader with atomic operations
 const char* histogram_shader_source = R"(
 #version 430 core
@@ -77,73 +135,418 @@ void main() {
 }
 )";
 
-// Fitness evaluation compute shader
-const char* fitness_shader_source = R"(
+// Signal/noise histograms in one pass: a 64x64 tile per workgroup is binned in shared
+// memory, then its non-zero bins are merged into the global histogram
+const char* masked_histogram_shader_source = R"(
 #version 430 core
-#extension GL_NV_shader_atomic_float : enable
-
+#define TILE 64
 layout(local_size_x = 16, local_size_y = 16) in;
 
 layout(binding = 0, r8) uniform readonly image2D input_image;
+layout(binding = 1, r8) uniform readonly image2D mask_image;   // Non-zero = signal
+
+// Bins 0-255 signal, 256-511 noise
+layout(std430, binding = 1) buffer HistogramBuffer {
+    uint histogram[512];
+};
+
+shared uint tile_histogram[512];
+
+void main() {
+    uint local = gl_LocalInvocationIndex;   // 256 invocations, two bins each
+    tile_histogram[local] = 0u;
+    tile_histogram[local + 256u] = 0u;
+    barrier();
+
+    ivec2 size = imageSize(input_image);
+    ivec2 origin = ivec2(gl_WorkGroupID.xy) * TILE + ivec2(gl_LocalInvocationID.xy);
+    for (int dy = 0; dy < TILE; dy += 16) {
+        for (int dx = 0; dx < TILE; dx += 16) {
+            ivec2 pos = origin + ivec2(dx, dy);
+            if (pos.x < size.x && pos.y < size.y) {
+                uint bin = uint(round(imageLoad(input_image, pos).r * 255.0));
+                uint region = imageLoad(mask_image, pos).r > 0.0 ? 0u : 256u;
+                atomicAdd(tile_histogram[region + bin], 1u);
+            }
+        }
+    }
+    barrier();
+
+    uint signal_count = tile_histogram[local];
+    uint noise_count = tile_histogram[local + 256u];
+    if (signal_count != 0u) atomicAdd(histogram[local], signal_count);
+    if (noise_count != 0u) atomicAdd(histogram[local + 256u], noise_count);
+}
+)";
+
+// Fitness evaluation compute shader: one workgroup layer per frame of the batch
+const char* fitness_shader_source = R"(
+#version 430 core
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+
+layout(binding = 0) uniform usampler2DArray frames;  // R8UI, one layer per frame
 
-// SSBO for fitness metrics
+// Per frame: sum lo/hi, sum of squares lo/hi, non-zero count (64-bit sums as
+// two words so full-resolution frames cannot overflow)
 layout(std430, binding = 1) buffer MetricsBuffer {
-    float mean_brightness;
-    float variance;
-    float non_zero_pixels;
-    float total_pixels;
+    uint sums[];
 };
 
-// Shared memory for reduction
-shared float local_sum[256];
-shared float local_sum_sq[256];
+uniform int frame_offset;  // First frame of this dispatch within the batch
+
+shared uint local_sum[256];
+shared uint local_sum_sq[256];
 shared uint local_count[256];
 
+// Portable 64-bit accumulation from 32-bit integer atomics
+void add64(uint base, uint value) {
+    if (value == 0u) return;
+    uint old = atomicAdd(sums[base], value);
+    if (old + value < old) {
+        atomicAdd(sums[base + 1u], 1u);
+    }
+}
+
 void main() {
+    ivec3 size = textureSize(frames, 0);
     ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
-    ivec2 size = imageSize(input_image);
+    int layer = int(gl_WorkGroupID.z);
     uint local_idx = gl_LocalInvocationIndex;
 
-    // Initialize shared memory
-    local_sum[local_idx] = 0.0;
-    local_sum_sq[local_idx] = 0.0;
-    local_count[local_idx] = 0u;
+    uint val = 0u;
+    if (pos.x < size.x && pos.y < size.y) {
+        val = texelFetch(frames, ivec3(pos, layer), 0).r;
+    }
+    local_sum[local_idx] = val;
+    local_sum_sq[local_idx] = val * val;
+    local_count[local_idx] = (val > 10u) ? 1u : 0u;
+    barrier();
+
+    // Tree reduction: 256 -> 1 in 8 steps, all invocations busy in the first
+    // (worst case per group: 256 * 255^2 fits in 32 bits)
+    for (uint stride = 128u; stride > 0u; stride >>= 1) {
+        if (local_idx < stride) {
+            local_sum[local_idx] += local_sum[local_idx + stride];
+            local_sum_sq[local_idx] += local_sum_sq[local_idx + stride];
+            local_count[local_idx] += local_count[local_idx + stride];
+        }
+        barrier();
+    }
+
+    if (local_idx == 0u) {
+        uint base = uint(frame_offset + layer) * 5u;
+        add64(base, local_sum[0]);
+        add64(base + 2u, local_sum_sq[0]);
+        if (local_count[0] > 0u) {
+            atomicAdd(sums[base + 4u], local_count[0]);
+        }
+    }
+}
+)";
+
+// Fused binary pipeline shader: bit extraction, scattering count, stats
+const char* binary_pipeline_shader_source = R"(
+#version 430 core
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(binding = 0) uniform usampler2D source_image;     // Raw frame, channel 0 in .r
+layout(binding = 1) uniform usampler2D reference_image;  // 0 = not part of reference
+
+layout(binding = 0, r8) uniform writeonly image2D binary_image;
+layout(binding = 1, r32ui) uniform uimage2D count_image;
+
+layout(std430, binding = 2) buffer StatsBuffer {
+    uint active_pixels;
+    uint scattering_pixels;
+    uint total_scattering_events;
+    uint max_scattering_count;
+};
+
+uniform uint bit_mask;
+uniform bool track_scattering;
+
+shared uint local_active;
+shared uint local_scattering;
+shared uint local_max;
+
+void main() {
+    ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(binary_image);
+    bool first = (gl_LocalInvocationIndex == 0u);
+
+    if (first) {
+        local_active = 0u;
+        local_scattering = 0u;
+        local_max = 0u;
+    }
     barrier();
 
-    // Process pixel
+    // No early return: every invocation must reach both barriers
     if (pos.x < size.x && pos.y < size.y) {
-        float val = imageLoad(input_image, pos).r;
-        local_sum[local_idx] = val;
-        local_sum_sq[local_idx] = val * val;
-        local_count[local_idx] = (val > 0.04) ? 1u : 0u;  // Threshold ~10/255
+        bool active = (texelFetch(source_image, pos, 0).r & bit_mask) != 0u;
+        imageStore(binary_image, pos, vec4(active ? 1.0 : 0.0));
+
+        if (active) {
+            atomicAdd(local_active, 1u);
+
+            if (track_scattering && texelFetch(reference_image, pos, 0).r == 0u) {
+                uint count = imageAtomicAdd(count_image, pos, 1u) + 1u;
+                atomicAdd(local_scattering, 1u);
+                atomicMax(local_max, count);
+            }
+        }
     }
     barrier();
 
-    // Parallel reduction (only first thread in workgroup)
-    if (local_idx == 0) {
-        float sum = 0.0;
-        float sum_sq = 0.0;
-        uint count = 0u;
+    // One global atomic per workgroup instead of one per pixel
+    if (first && local_active > 0u) {
+        atomicAdd(active_pixels, local_active);
+        if (local_scattering > 0u) {
+            atomicAdd(scattering_pixels, local_scattering);
+            atomicAdd(total_scattering_events, local_scattering);
+            atomicMax(max_scattering_count, local_max);
+        }
+    }
+}
+)";
+
+// Event scatter: one invocation per packed event, one texel store each
+const char* event_scatter_shader_source = R"(
+#version 430 core
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) readonly buffer EventBuffer {
+    uint events[];                  // x bits 0-14, y bits 15-30, polarity bit 31
+};
+
+layout(binding = 0, r8) uniform writeonly image2D frame_image;
+
+uniform uint event_count;
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= event_count) {
+        return;
+    }
+    uint word = events[i];
+    ivec2 pos = ivec2(int(word & 0x7FFFu), int((word >> 15) & 0xFFFFu));
+    // Every writer stores the same value, so colliding events need no atomics
+    imageStore(frame_image, pos, vec4(1.0));
+}
+)";
+
+// Offscreen passes: fullscreen triangle from gl_VertexID (no vertex buffer)
+const char* fullscreen_vertex_source = R"(
+#version 130
+void main() {
+    vec2 pos = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+// Binary display: bit tests and colouring, one fragment per frame pixel
+const char* binary_display_fragment_source = R"(
+#version 130
+uniform usampler2D source_image;     // Raw frame, channel 0 in .r
+uniform usampler2D reference_image;  // 0 = not part of reference
+
+uniform uint bit1_mask;
+uniform uint bit2_mask;
+uniform bool show_reference;
+uniform vec3 bit1_color;
+uniform vec3 bit2_color;
+uniform vec3 both_color;
+uniform vec3 reference_color;
+uniform vec3 scattering_color;
+
+out vec4 frag_color;
+
+void main() {
+    ivec2 pos = ivec2(gl_FragCoord.xy);
+    uint value = texelFetch(source_image, pos, 0).r;
+    bool bit1 = (value & bit1_mask) != 0u;
+    bool bit2 = (value & bit2_mask) != 0u;
+
+    vec3 color = vec3(0.0);
+    if (bit1 && bit2) {
+        color = both_color;
+    } else if (bit1) {
+        color = bit1_color;
+    } else if (bit2) {
+        color = bit2_color;
+    }
 
-        for (uint i = 0; i < 256; i++) {
-            sum += local_sum[i];
-            sum_sq += local_sum_sq[i];
-            count += local_count[i];
+    if (show_reference) {
+        bool reference = texelFetch(reference_image, pos, 0).r != 0u;
+        if ((bit1 || bit2) && !reference) {
+            color = scattering_color;
+        } else if (!(bit1 || bit2) && reference) {
+            color = reference_color;
         }
+    }
+    frag_color = vec4(color, 1.0);
+}
+)";
+
+// Scattering views: overlay of the live image or JET heatmap of the counts
+const char* scattering_view_fragment_source = R"(
+#version 130
+uniform sampler2D binary_image;      // Live binary (R8, 0/1)
+uniform usampler2D reference_image;  // 0 = not part of reference
+uniform usampler2D count_image;      // Per-pixel scattering counts (R32UI)
+uniform sampler2D colormap;          // 256 x 1 colormap
+
+uniform int mode;                    // 0 = overlay, 1 = heatmap
+uniform float max_count;
+uniform bool track_scattering;
+uniform vec3 highlight_color;
+
+out vec4 frag_color;
 
-        // Atomic add to global results
-        atomicAdd(mean_brightness, sum);
-        atomicAdd(variance, sum_sq);
-        atomicAdd(non_zero_pixels, float(count));
+void main() {
+    ivec2 pos = ivec2(gl_FragCoord.xy);
+    if (mode == 1) {
+        uint count = texelFetch(count_image, pos, 0).r;
+        if (count == 0u) {
+            frag_color = vec4(0.0, 0.0, 0.0, 1.0);  // Black for no scattering
+            return;
+        }
+        // Same rounding as convertTo(CV_8U, 255 / max)
+        int index = int(clamp(float(count) * 255.0 / max_count + 0.5, 0.0, 255.0));
+        frag_color = vec4(texelFetch(colormap, ivec2(index, 0), 0).rgb, 1.0);
+    } else {
+        float live = texelFetch(binary_image, pos, 0).r;
+        bool scattering = track_scattering && live > 0.5 && texelFetch(reference_image, pos, 0).r == 0u;
+        frag_color = vec4(scattering ? highlight_color : vec3(live), 1.0);
     }
 }
 )";
 
+// Compare view: live and loaded binary images composited, one fragment per pixel
+const char* compare_view_fragment_source = R"(
+#version 130
+uniform sampler2D live_image;        // Any 8-bit display texture (R8 or RGB(A)8)
+uniform sampler2D loaded_image;
+
+uniform vec3 live_color;
+uniform vec3 loaded_color;
+uniform vec3 both_color;
+
+out vec4 frag_color;
+
+void main() {
+    ivec2 pos = ivec2(gl_FragCoord.xy);
+    vec3 a = texelFetch(live_image, pos, 0).rgb;
+    vec3 b = texelFetch(loaded_image, pos, 0).rgb;
+    bool live = max(a.r, max(a.g, a.b)) > 0.5;
+    bool loaded = max(b.r, max(b.g, b.b)) > 0.5;
+    vec3 color = live ? (loaded ? both_color : live_color) : (loaded ? loaded_color : vec3(0.0));
+    frag_color = vec4(color, 1.0);
+}
+)";
+
 //=============================================================================
 // Utility Functions
 //=============================================================================
 
+// Program binary cache (GL thread only; see set_program_cache_directory)
+static std::string program_cache_directory;
+static ProgramCacheStats program_cache_stats;
+
+static uint64_t hash_text(uint64_t hash, const char* text) {
+    // FNV-1a; text ends in a 0 byte that is hashed too, so concatenations differ
+    for (const char* c = text ? text : ""; ; ++c) {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ull;
+        if (*c == '\0') {
+            return hash;
+        }
+    }
+}
+
+/**
+ * Cache file of a program built from these sources on this driver
+ * @return "" if caching is off or the driver cannot return program binaries
+ */
+static std::string program_cache_path(std::initializer_list<const char*> sources) {
+    if (program_cache_directory.empty() || !(GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)) {
+        return "";
+    }
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        return "";
+    }
+
+    uint64_t hash = 14695981039346656037ull;
+    for (const GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        hash = hash_text(hash, reinterpret_cast<const char*>(glGetString(name)));
+    }
+    for (const char* source : sources) {
+        hash = hash_text(hash, source);
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hash));
+    return (std::filesystem::path(program_cache_directory) / name).string();
+}
+
+/**
+ * Program linked from a cached binary
+ * @return 0 if there is none or the driver rejects it
+ */
+static GLuint load_program_binary(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    GLenum format = 0;
+    if (path.empty() || !file.read(reinterpret_cast<char*>(&format), sizeof(format))) {
+        return 0;
+    }
+    const std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        glDeleteProgram(program);   // Stale (driver changed in place): compiled and rewritten
+        return 0;
+    }
+    ++program_cache_stats.loaded;
+    return program;
+}
+
+static void save_program_binary(const std::string& path, GLuint program) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+    std::error_code ec;
+    std::filesystem::create_directories(program_cache_directory, ec);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+    file.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+    if (!file) {
+        std::cerr << "Program cache: Could not write " << path << std::endl;
+    }
+}
+
+void set_program_cache_directory(const std::string& directory) {
+    program_cache_directory = directory;
+}
+
+ProgramCacheStats get_program_cache_stats() {
+    return program_cache_stats;
+}
+
 GLuint compile_compute_shader(const char* source) {
+    const std::string cache_path = program_cache_path({source});
+    if (GLuint cached = load_program_binary(cache_path)) {
+        return cached;
+    }
+
     GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
     glShaderSource(shader, 1, &source, nullptr);
     glCompileShader(shader);
@@ -155,6 +558,9 @@ GLuint compile_compute_shader(const char* source) {
 
     GLuint program = glCreateProgram();
     glAttachShader(program, shader);
+    if (!cache_path.empty()) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(program);
 
     if (!check_compute_errors(program, "PROGRAM")) {
@@ -164,6 +570,10 @@ GLuint compile_compute_shader(const char* source) {
     }
 
     glDeleteShader(shader);
+    ++program_cache_stats.compiled;
+    if (!cache_path.empty()) {
+        save_program_binary(cache_path, program);
+    }
     return program;
 }
 
@@ -192,26 +602,282 @@ bool check_compute_errors(GLuint shader, const char* type) {
     return true;
 }
 
-void upload_texture_async(GLuint texture, const cv::Mat& mat) {
-    GLenum format = (mat.channels() == 1) ? GL_RED : GL_BGR;
-    GLenum internal_format = (mat.channels() == 1) ? GL_R8 : GL_RGB8;
+/**
+ * Compile and link a vertex + fragment shader program
+ * @return Program ID, or 0 on failure
+ */
+static GLuint compile_render_program(const char* vertex_source, const char* fragment_source) {
+    // The fragment output binding is part of the linked binary
+    const std::string cache_path = program_cache_path({vertex_source, fragment_source});
+    if (GLuint cached = load_program_binary(cache_path)) {
+        return cached;
+    }
+
+    GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &vertex_source, nullptr);
+    glCompileShader(vertex);
+    GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment, 1, &fragment_source, nullptr);
+    glCompileShader(fragment);
+
+    GLuint program = 0;
+    if (check_compute_errors(vertex, "SHADER") && check_compute_errors(fragment, "SHADER")) {
+        program = glCreateProgram();
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        glBindFragDataLocation(program, 0, "frag_color");
+        if (!cache_path.empty()) {
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        glLinkProgram(program);
+        if (!check_compute_errors(program, "PROGRAM")) {
+            glDeleteProgram(program);
+            program = 0;
+        } else {
+            ++program_cache_stats.compiled;
+            if (!cache_path.empty()) {
+                save_program_binary(cache_path, program);
+            }
+        }
+    }
+
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    return program;
+}
 
+/**
+ * Create an RGBA8 texture with a framebuffer drawing into it
+ * @return false if the framebuffer is incomplete (both objects are then deleted)
+ */
+static bool create_render_target(int width, int height, GLuint& texture, GLuint& framebuffer) {
+    glGenTextures(1, &texture);
     glBindTexture(GL_TEXTURE_2D, texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, internal_format,
-                mat.cols, mat.rows, 0,
-                format, GL_UNSIGNED_BYTE, mat.data);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLint previous_framebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+    if (!complete) {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteTextures(1, &texture);
+        framebuffer = 0;
+        texture = 0;
+    }
+    return complete;
+}
+
+/**
+ * Draw the fullscreen triangle into a render target with the bound program and textures
+ *
+ * Called mid-frame, so the caller's framebuffer, viewport and blend /
+ * scissor / depth state are restored afterwards.
+ */
+static void draw_offscreen(GLuint framebuffer, GLuint vertex_array, int width, int height) {
+    GLint previous_framebuffer = 0;
+    GLint previous_viewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+    glGetIntegerv(GL_VIEWPORT, previous_viewport);
+    const GLboolean blend = glIsEnabled(GL_BLEND);
+    const GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
+    const GLboolean depth = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glDisable(GL_SCISSOR_TEST);
+    glDisable(GL_DEPTH_TEST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+    glBindVertexArray(vertex_array);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+    glViewport(previous_viewport[0], previous_viewport[1], previous_viewport[2], previous_viewport[3]);
+    if (blend) glEnable(GL_BLEND);
+    if (scissor) glEnable(GL_SCISSOR_TEST);
+    if (depth) glEnable(GL_DEPTH_TEST);
+}
+
+/**
+ * Poll or wait for a fence, deleting it once signaled
+ */
+static bool wait_fence(GLsync& fence, bool wait) {
+    if (!fence) {
+        return true;
+    }
+
+    // Flush on wait so the fence is guaranteed to reach the GPU
+    GLenum status = wait
+        ? glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000)  // 1 s
+        : glClientWaitSync(fence, 0, 0);
+    if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+        glDeleteSync(fence);
+        fence = nullptr;
+        return true;
+    }
+    return false;
+}
+
+//=============================================================================
+// StreamingTexture Implementation
+//=============================================================================
 
+StreamingTexture::~StreamingTexture() {
+    release();
+}
+
+bool StreamingTexture::ensure(int width, int height, int channels) {
+    if (texture_ != 0 && width == width_ && height == height_ && channels == channels_) {
+        return true;
+    }
+    if (width <= 0 || height <= 0 || (channels != 1 && channels != 3)) {
+        return false;
+    }
+
+    release();
+    width_ = width;
+    height_ = height;
+    channels_ = channels;
+
+    glGenTextures(1, &texture_);
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glTexStorage2D(GL_TEXTURE_2D, 1, channels == 1 ? GL_R8 : GL_RGB8, width, height);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    const size_t bytes = static_cast<size_t>(width) * height * channels;
+    glGenBuffers(NUM_PBOS, upload_pbo_);
+    glGenBuffers(NUM_PBOS, pack_pbo_);
+    for (int i = 0; i < NUM_PBOS; ++i) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo_[i]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pack_pbo_[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
 }
 
-void download_texture_async(GLuint texture, cv::Mat& mat) {
-    GLenum format = (mat.channels() == 1) ? GL_RED : GL_BGR;
+bool StreamingTexture::upload(const cv::Mat& mat) {
+    if (texture_ == 0 || mat.cols != width_ || mat.rows != height_ ||
+        mat.type() != CV_MAKETYPE(CV_8U, channels_)) {
+        return false;
+    }
 
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glGetTexImage(GL_TEXTURE_2D, 0, format, GL_UNSIGNED_BYTE, mat.data);
+    const size_t row_bytes = static_cast<size_t>(width_) * channels_;
+    const size_t bytes = row_bytes * height_;
+
+    // Orphan the PBO so a transfer still reading the old contents never blocks us
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo_[upload_idx_]);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    void* ptr = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if (!ptr) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+    if (mat.isContinuous()) {
+        memcpy(ptr, mat.data, bytes);
+    } else {
+        for (int y = 0; y < height_; ++y) {
+            memcpy(static_cast<uint8_t*>(ptr) + y * row_bytes, mat.ptr(y), row_bytes);
+        }
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_,
+                    channels_ == 1 ? GL_RED : GL_BGR, GL_UNSIGNED_BYTE, 0);  // 0 = use bound PBO
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    upload_idx_ = (upload_idx_ + 1) % NUM_PBOS;
+    return true;
+}
+
+void StreamingTexture::begin_readback() {
+    if (texture_ == 0) return;
+
+    if (pending_ == NUM_PBOS) {
+        // Caller never collected the oldest result; drop it to free its slot
+        int oldest = (pack_write_ + NUM_PBOS - pending_) % NUM_PBOS;
+        if (pack_fence_[oldest]) glDeleteSync(pack_fence_[oldest]);
+        pack_fence_[oldest] = nullptr;
+        pending_--;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pack_pbo_[pack_write_]);
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTexImage(GL_TEXTURE_2D, 0, channels_ == 1 ? GL_RED : GL_BGR, GL_UNSIGNED_BYTE, 0);  // 0 = into bound PBO
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    pack_fence_[pack_write_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pack_write_ = (pack_write_ + 1) % NUM_PBOS;
+    pending_++;
+}
+
+bool StreamingTexture::end_readback(cv::Mat& out, bool wait) {
+    if (pending_ == 0) {
+        return false;
+    }
+
+    int oldest = (pack_write_ + NUM_PBOS - pending_) % NUM_PBOS;
+    if (!wait_fence(pack_fence_[oldest], wait)) {
+        return false;  // Still in flight
+    }
+    pending_--;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pack_pbo_[oldest]);
+    const void* ptr = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (ptr) {
+        out.create(height_, width_, CV_MAKETYPE(CV_8U, channels_));
+        const size_t row_bytes = static_cast<size_t>(width_) * channels_;
+        for (int y = 0; y < height_; ++y) {
+            memcpy(out.ptr(y), static_cast<const uint8_t*>(ptr) + y * row_bytes, row_bytes);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return ptr != nullptr;
+}
+
+void StreamingTexture::release() {
+    for (int i = 0; i < NUM_PBOS; ++i) {
+        if (pack_fence_[i]) glDeleteSync(pack_fence_[i]);
+        pack_fence_[i] = nullptr;
+    }
+    if (upload_pbo_[0]) glDeleteBuffers(NUM_PBOS, upload_pbo_);
+    if (pack_pbo_[0]) glDeleteBuffers(NUM_PBOS, pack_pbo_);
+    if (texture_) glDeleteTextures(1, &texture_);
+
+    for (int i = 0; i < NUM_PBOS; ++i) {
+        upload_pbo_[i] = 0;
+        pack_pbo_[i] = 0;
+    }
+    texture_ = 0;
+    upload_idx_ = 0;
+    pack_write_ = 0;
+    pending_ = 0;
+    width_ = 0;
+    height_ = 0;
+    channels_ = 0;
 }
 
 //=============================================================================
@@ -236,10 +902,10 @@ void GPUMorphology::init() {
         return;
     }
 
-    // Create textures (will be resized on first use)
-    glGenTextures(1, &input_texture_);
-    glGenTextures(1, &output_texture_);
+    kernel_size_location_ = glGetUniformLocation(program_, "kernel_size");
+    operation_location_ = glGetUniformLocation(program_, "operation");
 
+    // Texture storage is allocated on first use and kept while the size is unchanged
     initialized_ = true;
     std::cout << "GPUMorphology initialized" << std::endl;
 }
@@ -248,58 +914,145 @@ void GPUMorphology::cleanup() {
     if (!initialized_) return;
 
     if (program_) glDeleteProgram(program_);
-    if (input_texture_) glDeleteTextures(1, &input_texture_);
-    if (output_texture_) glDeleteTextures(1, &output_texture_);
+    input_.release();
+    output_.release();
 
     program_ = 0;
-    input_texture_ = 0;
-    output_texture_ = 0;
     initialized_ = false;
 }
 
-void GPUMorphology::process(const cv::Mat& input, cv::Mat& output,
+bool GPUMorphology::process(const cv::Mat& input, cv::Mat& output,
                             Operation op, int kernel_size) {
     if (!initialized_) {
         std::cerr << "GPUMorphology not initialized" << std::endl;
-        return;
+        return false;
     }
 
-    if (input.type() != CV_8UC1 || output.type() != CV_8UC1) {
+    if (input.type() != CV_8UC1) {
         std::cerr << "GPUMorphology requires CV_8UC1 images" << std::endl;
-        return;
+        return false;
     }
 
-    // Resize textures if needed
-    if (width_ != input.cols || height_ != input.rows) {
-        width_ = input.cols;
-        height_ = input.rows;
-
-        upload_texture_async(input_texture_, input);
-        upload_texture_async(output_texture_, output);
+    // Reallocates only when the frame size changes
+    if (!input_.ensure(input.cols, input.rows, 1) || !output_.ensure(input.cols, input.rows, 1)) {
+        return false;
     }
 
     // Upload input
-    upload_texture_async(input_texture_, input);
+    input_.upload(input);
 
     // Bind textures as compute images
-    glBindImageTexture(0, input_texture_, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R8);
-    glBindImageTexture(1, output_texture_, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8);
+    glBindImageTexture(0, input_.id(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_R8);
+    glBindImageTexture(1, output_.id(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8);
 
     // Set uniforms
     glUseProgram(program_);
-    glUniform1i(glGetUniformLocation(program_, "kernel_size"), kernel_size);
-    glUniform1i(glGetUniformLocation(program_, "operation"), static_cast<int>(op));
+    glUniform1i(kernel_size_location_, kernel_size);
+    glUniform1i(operation_location_, static_cast<int>(op));
 
     // Dispatch compute shader
-    GLuint groups_x = (width_ + 15) / 16;
-    GLuint groups_y = (height_ + 15) / 16;
+    GLuint groups_x = (input.cols + 15) / 16;
+    GLuint groups_y = (input.rows + 15) / 16;
     glDispatchCompute(groups_x, groups_y, 1);
 
-    // Wait for completion
+    // Order the image writes before the pack into the readback PBO
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+    output_.begin_readback();
+
+    // Deferred: collect the previous frame's result, which has had a frame to finish
+    if (deferred_readback_ && output_.pending_readbacks() < 2) {
+        return false;
+    }
+    return output_.end_readback(output, true);
+}
+
+//=============================================================================
+// GPUMorphologyChain Implementation
+//=============================================================================
+
+GPUMorphologyChain::~GPUMorphologyChain() {
+    release();
+}
+
+bool GPUMorphologyChain::is_supported() {
+    return GPUBinaryPipeline::is_supported();
+}
+
+bool GPUMorphologyChain::init_program() {
+    if (program_ != 0) return true;
+    if (program_failed_) return false;
+
+    program_ = compile_compute_shader(morphology_chain_shader_source);
+    if (program_ == 0) {
+        std::cerr << "Failed to compile morphology chain compute shader" << std::endl;
+        program_failed_ = true;  // Don't retry every frame
+        return false;
+    }
+
+    axis_location_ = glGetUniformLocation(program_, "axis");
+    operation_location_ = glGetUniformLocation(program_, "operation");
+    kernel_size_location_ = glGetUniformLocation(program_, "kernel_size");
+    threshold_location_ = glGetUniformLocation(program_, "threshold");
+    std::cout << "GPUMorphologyChain initialized" << std::endl;
+    return true;
+}
+
+void GPUMorphologyChain::dispatch_pass(GLuint source, GLuint target, int axis, int operation, int threshold) {
+    glBindImageTexture(0, source, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R8);
+    glBindImageTexture(1, target, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8);
+    glUniform1i(axis_location_, axis);
+    glUniform1i(operation_location_, operation);
+    glUniform1i(threshold_location_, threshold);
+
+    const int length = axis == 0 ? input_.width() : input_.height();
+    const int lines = axis == 0 ? input_.height() : input_.width();
+    glDispatchCompute(static_cast<GLuint>((length + 255) / 256), static_cast<GLuint>(lines), 1);
+
+    // The next pass reads what this one wrote
     glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+}
 
-    // Download result
-    download_texture_async(output_texture_, output);
+bool GPUMorphologyChain::process(const cv::Mat& gray, int threshold, int kernel_size, cv::Mat& binary) {
+    if (gray.empty() || gray.type() != CV_8UC1 || threshold < 0 || kernel_size < 1 || kernel_size > MAX_KERNEL) {
+        return false;
+    }
+    if (!init_program()) {
+        return false;
+    }
+    if (!input_.ensure(gray.cols, gray.rows, 1) || !ping_.ensure(gray.cols, gray.rows, 1) ||
+        !pong_.ensure(gray.cols, gray.rows, 1) || !input_.upload(gray)) {
+        return false;
+    }
+
+    glUseProgram(program_);
+    glUniform1i(kernel_size_location_, kernel_size);
+
+    // Open = erode, dilate; close = dilate, erode; each rectangle is a row pass then a column pass
+    constexpr int ERODE = 0;
+    constexpr int DILATE = 1;
+    const int operations[4] = {ERODE, DILATE, DILATE, ERODE};
+    GLuint source = input_.id();
+    StreamingTexture* target = &ping_;
+    for (int step = 0; step < 8; ++step) {
+        const int operation = operations[step / 2];
+        dispatch_pass(source, target->id(), step % 2, operation, step == 0 ? threshold : -1);
+        source = target->id();
+        target = target == &ping_ ? &pong_ : &ping_;
+    }
+    glUseProgram(0);
+
+    // One readback for the whole chain (an even pass count ends in pong_)
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+    pong_.begin_readback();
+    return pong_.end_readback(binary, true);
+}
+
+void GPUMorphologyChain::release() {
+    input_.release();
+    ping_.release();
+    pong_.release();
+    if (program_) glDeleteProgram(program_);
+    program_ = 0;
 }
 
 //=============================================================================
@@ -323,16 +1076,25 @@ void GPUHistogram::init() {
         std::cerr << "Failed to compile histogram compute shader" << std::endl;
         return;
     }
+    masked_program_ = compile_compute_shader(masked_histogram_shader_source);
+    if (masked_program_ == 0) {
+        std::cerr << "Failed to compile masked histogram compute shader" << std::endl;
+    }
 
-    // Create texture
-    glGenTextures(1, &input_texture_);
-
-    // Create SSBO for histogram
+    // Create SSBO for histogram (sized for the masked pair)
     glGenBuffers(1, &histogram_buffer_);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, histogram_buffer_);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, 256 * sizeof(uint32_t),
+    glBufferData(GL_SHADER_STORAGE_BUFFER, MASKED_BINS * sizeof(uint32_t),
                 nullptr, GL_DYNAMIC_COPY);
 
+    // Readback ring: the SSBO is copied out and fenced instead of read directly
+    glGenBuffers(NUM_READBACKS, readback_buffers_);
+    for (int i = 0; i < NUM_READBACKS; ++i) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, readback_buffers_[i]);
+        glBufferData(GL_COPY_WRITE_BUFFER, MASKED_BINS * sizeof(uint32_t), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
     initialized_ = true;
     std::cout << "GPUHistogram initialized" << std::endl;
 }
@@ -341,57 +1103,150 @@ void GPUHistogram::cleanup() {
     if (!initialized_) return;
 
     if (program_) glDeleteProgram(program_);
-    if (input_texture_) glDeleteTextures(1, &input_texture_);
+    if (masked_program_) glDeleteProgram(masked_program_);
+    input_.release();
+    mask_.release();
     if (histogram_buffer_) glDeleteBuffers(1, &histogram_buffer_);
+    for (int i = 0; i < NUM_READBACKS; ++i) {
+        if (readback_fences_[i]) glDeleteSync(readback_fences_[i]);
+        readback_fences_[i] = nullptr;
+    }
+    glDeleteBuffers(NUM_READBACKS, readback_buffers_);
 
     program_ = 0;
-    input_texture_ = 0;
+    masked_program_ = 0;
     histogram_buffer_ = 0;
+    readback_buffers_[0] = readback_buffers_[1] = 0;
+    readback_write_ = 0;
+    readback_pending_ = 0;
     initialized_ = false;
 }
 
-void GPUHistogram::compute(const cv::Mat& input, std::vector<uint32_t>& histogram) {
+void GPUHistogram::clear_bins(int bins) {
+    static const uint32_t zero_data[MASKED_BINS] = {0};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, histogram_buffer_);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, bins * sizeof(uint32_t), zero_data);
+}
+
+bool GPUHistogram::read_bins(int bins, uint32_t* out) {
+    // Order the atomics before the copy into the readback buffer
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    if (readback_pending_ == NUM_READBACKS) {
+        // Oldest result was never collected; drop it to free its slot
+        int oldest = (readback_write_ + NUM_READBACKS - readback_pending_) % NUM_READBACKS;
+        if (readback_fences_[oldest]) glDeleteSync(readback_fences_[oldest]);
+        readback_fences_[oldest] = nullptr;
+        readback_pending_--;
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, histogram_buffer_);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, readback_buffers_[readback_write_]);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, bins * sizeof(uint32_t));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    readback_fences_[readback_write_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback_write_ = (readback_write_ + 1) % NUM_READBACKS;
+    readback_pending_++;
+
+    // Deferred: collect the previous frame's histogram, which has had a frame to finish
+    if (deferred_readback_ && readback_pending_ < 2) {
+        return false;
+    }
+
+    int oldest = (readback_write_ + NUM_READBACKS - readback_pending_) % NUM_READBACKS;
+    if (!wait_fence(readback_fences_[oldest], true)) {
+        return false;
+    }
+    readback_pending_--;
+
+    // Download histogram
+    glBindBuffer(GL_COPY_READ_BUFFER, readback_buffers_[oldest]);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, bins * sizeof(uint32_t), out);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    return true;
+}
+
+bool GPUHistogram::compute(const cv::Mat& input, std::vector<uint32_t>& histogram) {
     if (!initialized_) {
         std::cerr << "GPUHistogram not initialized" << std::endl;
-        return;
+        return false;
     }
 
     if (input.type() != CV_8UC1) {
         std::cerr << "GPUHistogram requires CV_8UC1 image" << std::endl;
-        return;
+        return false;
     }
 
-    histogram.resize(256, 0);
-
     // Clear histogram buffer
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, histogram_buffer_);
-    uint32_t zero_data[256] = {0};
-    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, 256 * sizeof(uint32_t), zero_data);
+    clear_bins(256);
 
-    // Upload input texture
-    if (width_ != input.cols || height_ != input.rows) {
-        width_ = input.cols;
-        height_ = input.rows;
+    // Upload input texture (storage reallocated only on size change)
+    if (!input_.ensure(input.cols, input.rows, 1) || !input_.upload(input)) {
+        return false;
     }
-    upload_texture_async(input_texture_, input);
 
     // Bind texture and buffer
-    glBindImageTexture(0, input_texture_, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R8);
+    glBindImageTexture(0, input_.id(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_R8);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, histogram_buffer_);
 
     // Dispatch compute shader
     glUseProgram(program_);
-    GLuint groups_x = (width_ + 15) / 16;
-    GLuint groups_y = (height_ + 15) / 16;
+    GLuint groups_x = (input.cols + 15) / 16;
+    GLuint groups_y = (input.rows + 15) / 16;
     glDispatchCompute(groups_x, groups_y, 1);
 
-    // Wait for completion
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    uint32_t bins[256];
+    if (!read_bins(256, bins)) {
+        return false;
+    }
+    histogram.assign(bins, bins + 256);
+    return true;
+}
 
-    // Download histogram
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, histogram_buffer_);
-    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
-                      256 * sizeof(uint32_t), histogram.data());
+bool GPUHistogram::set_mask(const cv::Mat& mask) {
+    if (!initialized_ || mask.type() != CV_8UC1 || mask.empty()) {
+        return false;
+    }
+    return mask_.ensure(mask.cols, mask.rows, 1) && mask_.upload(mask);
+}
+
+bool GPUHistogram::compute_masked(const cv::Mat& input, std::vector<uint32_t>& signal, std::vector<uint32_t>& noise) {
+    if (!initialized_ || input.type() != CV_8UC1) {
+        std::cerr << "GPUHistogram requires CV_8UC1 image" << std::endl;
+        return false;
+    }
+    if (!input_.ensure(input.cols, input.rows, 1) || !input_.upload(input)) {
+        return false;
+    }
+    return compute_masked(input_.id(), input.cols, input.rows, signal, noise);
+}
+
+bool GPUHistogram::compute_masked(GLuint texture, int width, int height,
+                                  std::vector<uint32_t>& signal, std::vector<uint32_t>& noise) {
+    if (!initialized_ || masked_program_ == 0) {
+        std::cerr << "GPUHistogram masked histograms unavailable" << std::endl;
+        return false;
+    }
+    if (mask_.width() != width || mask_.height() != height) {
+        return false;   // No mask yet, or the frame size changed since set_mask()
+    }
+
+    clear_bins(MASKED_BINS);
+    glBindImageTexture(0, texture, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R8);
+    glBindImageTexture(1, mask_.id(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_R8);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, histogram_buffer_);
+
+    glUseProgram(masked_program_);
+    glDispatchCompute((width + MASKED_TILE - 1) / MASKED_TILE, (height + MASKED_TILE - 1) / MASKED_TILE, 1);
+
+    uint32_t bins[MASKED_BINS];
+    if (!read_bins(MASKED_BINS, bins)) {
+        return false;
+    }
+    signal.assign(bins, bins + 256);
+    noise.assign(bins + 256, bins + MASKED_BINS);
+    return true;
 }
 
 //=============================================================================
@@ -415,110 +1270,1279 @@ void GPUFitnessEvaluator::init() {
         std::cerr << "Failed to compile fitness compute shader" << std::endl;
         return;
     }
+    frame_offset_location_ = glGetUniformLocation(program_, "frame_offset");
+
+    // Layers per dispatch are bounded by the array texture and the z group count
+    GLint max_groups_z = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers_);
+    glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 2, &max_groups_z);
+    if (max_groups_z > 0 && max_groups_z < max_layers_) {
+        max_layers_ = max_groups_z;
+    }
+    if (max_layers_ <= 0) {
+        max_layers_ = 256;  // GL 4.3 guarantees at least this many layers
+    }
 
-    // Create texture
-    glGenTextures(1, &input_texture_);
-
-    // Create SSBO for metrics (4 floats)
+    glGenBuffers(1, &upload_pbo_);
     glGenBuffers(1, &metrics_buffer_);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, metrics_buffer_);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, 4 * sizeof(float),
-                nullptr, GL_DYNAMIC_COPY);
 
     initialized_ = true;
-    std::cout << "GPUFitnessEvaluator initialized" << std::endl;
+    std::cout << "GPUFitnessEvaluator initialized (up to " << max_layers_
+              << " frames per dispatch)" << std::endl;
 }
 
 void GPUFitnessEvaluator::cleanup() {
     if (!initialized_) return;
 
     if (program_) glDeleteProgram(program_);
-    if (input_texture_) glDeleteTextures(1, &input_texture_);
+    if (frames_texture_) glDeleteTextures(1, &frames_texture_);
+    if (upload_pbo_) glDeleteBuffers(1, &upload_pbo_);
     if (metrics_buffer_) glDeleteBuffers(1, &metrics_buffer_);
 
     program_ = 0;
-    input_texture_ = 0;
+    frames_texture_ = 0;
+    upload_pbo_ = 0;
     metrics_buffer_ = 0;
+    width_ = 0;
+    height_ = 0;
+    layers_ = 0;
+    metrics_capacity_ = 0;
     initialized_ = false;
 }
 
-void GPUFitnessEvaluator::evaluate_batch(const std::vector<cv::Mat>& frames,
+bool GPUFitnessEvaluator::ensure_resources(int width, int height, int layers, size_t frames) {
+    if (frames_texture_ == 0 || width != width_ || height != height_ || layers > layers_) {
+        if (frames_texture_) glDeleteTextures(1, &frames_texture_);
+
+        // Immutable storage: reallocated only when the frame size changes or the batch grows
+        glGenTextures(1, &frames_texture_);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, frames_texture_);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R8UI, width, height, layers);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        width_ = width;
+        height_ = height;
+        layers_ = layers;
+    }
+
+    if (frames > metrics_capacity_) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, metrics_buffer_);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, frames * METRIC_WORDS * sizeof(uint32_t),
+                     nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        metrics_capacity_ = frames;
+    }
+    return true;
+}
+
+bool GPUFitnessEvaluator::upload(const std::vector<cv::Mat>& frames, size_t first, int count) {
+    const size_t row_bytes = static_cast<size_t>(width_);
+    const size_t frame_bytes = row_bytes * height_;
+
+    // One PBO for the whole chunk, orphaned so an in-flight transfer never blocks
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo_);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, frame_bytes * count, nullptr, GL_STREAM_DRAW);
+    uint8_t* ptr = static_cast<uint8_t*>(glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY));
+    if (!ptr) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+    for (int i = 0; i < count; ++i) {
+        const cv::Mat& frame = frames[first + i];
+        uint8_t* layer = ptr + frame_bytes * i;
+        if (frame.isContinuous()) {
+            memcpy(layer, frame.data, frame_bytes);
+        } else {
+            for (int y = 0; y < height_; ++y) {
+                memcpy(layer + y * row_bytes, frame.ptr(y), row_bytes);
+            }
+        }
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    // All layers in a single transfer
+    glBindTexture(GL_TEXTURE_2D_ARRAY, frames_texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, width_, height_, count,
+                    GL_RED_INTEGER, GL_UNSIGNED_BYTE, 0);  // 0 = use bound PBO
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+bool GPUFitnessEvaluator::evaluate_batch(const std::vector<cv::Mat>& frames,
                                         std::vector<float>& metrics) {
+    metrics.clear();
+
     if (!initialized_) {
         static bool error_logged = false;
         if (!error_logged) {
             std::cerr << "GPUFitnessEvaluator not initialized (GPU acceleration disabled, using CPU fallback)" << std::endl;
             error_logged = true;
         }
-        return;
+        return false;
     }
 
-    metrics.clear();
+    if (frames.empty()) {
+        return true;
+    }
 
+    // One array texture holds the batch, so every frame must match the first
+    const int width = frames[0].cols;
+    const int height = frames[0].rows;
     for (const auto& frame : frames) {
         if (frame.type() != CV_8UC1) {
             std::cerr << "GPUFitnessEvaluator requires CV_8UC1 frames (got type=" << frame.type() << ")" << std::endl;
-            continue;
+            return false;
         }
+        if (frame.cols != width || frame.rows != height) {
+            std::cerr << "GPUFitnessEvaluator requires equally sized frames in a batch" << std::endl;
+            return false;
+        }
+    }
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
 
-        // Clear metrics buffer
-        float zero_data[4] = {0.0f, 0.0f, 0.0f, static_cast<float>(frame.total())};
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, metrics_buffer_);
-        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, 4 * sizeof(float), zero_data);
-
-        // Upload frame
-        upload_texture_async(input_texture_, frame);
-
-        // Bind texture and buffer
-        glBindImageTexture(0, input_texture_, 0, GL_FALSE, 0, GL_READ_ONLY, GL_R8);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, metrics_buffer_);
+    const int chunk = static_cast<int>(std::min<size_t>(frames.size(), static_cast<size_t>(max_layers_)));
+    if (!ensure_resources(width, height, chunk, frames.size())) {
+        return false;
+    }
 
-        // Dispatch compute shader
-        glUseProgram(program_);
-        GLuint groups_x = (frame.cols + 15) / 16;
-        GLuint groups_y = (frame.rows + 15) / 16;
-        glDispatchCompute(groups_x, groups_y, 1);
+    // Zero every frame's sums at once
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, metrics_buffer_);
+    glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0,
+                         frames.size() * METRIC_WORDS * sizeof(uint32_t),
+                         GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
-        // Wait for completion
-        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    glUseProgram(program_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, metrics_buffer_);
+    const GLuint groups_x = (width + 15) / 16;
+    const GLuint groups_y = (height + 15) / 16;
+
+    // A single dispatch per chunk; only batches beyond the layer limit need more
+    for (size_t first = 0; first < frames.size(); first += chunk) {
+        const int count = static_cast<int>(std::min<size_t>(chunk, frames.size() - first));
+        if (first > 0) {
+            // The next upload overwrites layers the previous dispatch still reads
+            glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+        }
+        if (!upload(frames, first, count)) {
+            glUseProgram(0);
+            return false;
+        }
 
-        // Download metrics
-        float result[4];
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, metrics_buffer_);
-        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, 4 * sizeof(float), result);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, frames_texture_);
+        glUniform1i(frame_offset_location_, static_cast<GLint>(first));
+        glDispatchCompute(groups_x, groups_y, static_cast<GLuint>(count));
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glUseProgram(0);
 
-        // Calculate final metrics
-        float total_pixels = result[3];
+    // Order the atomics before the readback
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
 
-        // Validate GPU results
-        if (total_pixels <= 0.0f || !std::isfinite(result[0]) || !std::isfinite(result[1]) || !std::isfinite(result[2])) {
+    std::vector<uint32_t> sums(frames.size() * METRIC_WORDS);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, metrics_buffer_);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sums.size() * sizeof(uint32_t), sums.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // Integer sums are exact; normalize to [0, 1] intensities as the CPU path does
+    const double total_pixels = static_cast<double>(width) * height;
+    metrics.reserve(frames.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const uint32_t* words = &sums[i * METRIC_WORDS];
+        const uint64_t sum = (static_cast<uint64_t>(words[1]) << 32) | words[0];
+        const uint64_t sum_sq = (static_cast<uint64_t>(words[3]) << 32) | words[2];
+
+        const double mean = sum / total_pixels / 255.0;
+        const double variance = std::max(0.0, sum_sq / total_pixels / (255.0 * 255.0) - mean * mean);
+        const double non_zero_ratio = words[4] / total_pixels;
+
+        if (words[4] > total_pixels || mean > 1.0) {
             std::cerr << "WARNING: GPU produced invalid results, disabling GPU acceleration" << std::endl;
-            std::cerr << "  result[0]=" << result[0] << " result[1]=" << result[1]
-                     << " result[2]=" << result[2] << " total_pixels=" << total_pixels << std::endl;
+            std::cerr << "  frame=" << i << " sum=" << sum << " sum_sq=" << sum_sq
+                     << " non_zero=" << words[4] << " total_pixels=" << total_pixels << std::endl;
 
             // Disable GPU and mark as not initialized
             cleanup();
             metrics.clear();
-            return;
+            return false;
         }
 
-        float mean = result[0] / total_pixels;
-        float variance = (result[1] / total_pixels) - (mean * mean);
-        float non_zero_ratio = result[2] / total_pixels;
+        // Combined fitness metric
+        metrics.push_back(static_cast<float>(mean + variance * 0.5 + non_zero_ratio * 0.3));
+    }
+    return true;
+}
 
-        // Validate calculated values
-        if (!std::isfinite(mean) || !std::isfinite(variance) || !std::isfinite(non_zero_ratio)) {
-            std::cerr << "WARNING: GPU calculations produced invalid results, disabling GPU acceleration" << std::endl;
-            std::cerr << "  mean=" << mean << " variance=" << variance << " non_zero_ratio=" << non_zero_ratio << std::endl;
+//=============================================================================
+// GPUBinaryPipeline Implementation
+//=============================================================================
 
-            cleanup();
-            metrics.clear();
-            return;
+GPUBinaryPipeline::GPUBinaryPipeline() {
+    // GL objects are created lazily on the first frame
+}
+
+GPUBinaryPipeline::~GPUBinaryPipeline() {
+    release();
+}
+
+bool GPUBinaryPipeline::is_supported() {
+    if (GLEW_VERSION_4_3) {
+        return true;
+    }
+    return GLEW_ARB_compute_shader && GLEW_ARB_shader_image_load_store &&
+           GLEW_ARB_shader_storage_buffer_object && GLEW_ARB_texture_storage &&
+           GLEW_ARB_copy_image;
+}
+
+bool GPUBinaryPipeline::init_program() {
+    if (program_ != 0) return true;
+    if (program_failed_) return false;
+
+    program_ = compile_compute_shader(binary_pipeline_shader_source);
+    if (program_ == 0) {
+        std::cerr << "Failed to compile binary pipeline compute shader" << std::endl;
+        program_failed_ = true;  // Don't retry every frame
+        return false;
+    }
+
+    bit_mask_location_ = glGetUniformLocation(program_, "bit_mask");
+    track_scattering_location_ = glGetUniformLocation(program_, "track_scattering");
+    std::cout << "GPUBinaryPipeline initialized" << std::endl;
+    return true;
+}
+
+bool GPUBinaryPipeline::prepare(int width, int height, int channels) {
+    if (width <= 0 || height <= 0 || (channels != 1 && channels != 3)) {
+        return false;
+    }
+    return init_program() && ensure_resources(width, height, channels);
+}
+
+bool GPUBinaryPipeline::ensure_resources(int width, int height, int channels) {
+    if (source_texture_ != 0 && width == width_ && height == height_ && channels == channels_) {
+        return true;
+    }
+
+    destroy_resources();
+    width_ = width;
+    height_ = height;
+    channels_ = channels;
+
+    auto create_texture = [width, height](GLuint& texture, GLenum internal_format, GLint filter) {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, internal_format, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    };
+
+    // Integer textures must use nearest filtering to be complete
+    create_texture(source_texture_, channels == 1 ? GL_R8UI : GL_RGB8UI, GL_NEAREST);
+    create_texture(reference_texture_, GL_R8UI, GL_NEAREST);
+    create_texture(count_texture_, GL_R32UI, GL_NEAREST);
+    create_texture(binary_texture_, GL_R8, GL_LINEAR);
+    const GLint swizzle[4] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    const size_t frame_bytes = static_cast<size_t>(width) * height * channels;
+    const size_t binary_bytes = static_cast<size_t>(width) * height;
+    for (int i = 0; i < NUM_SLOTS; ++i) {
+        glGenBuffers(1, &upload_pbo_[i]);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo_[i]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, frame_bytes, nullptr, GL_STREAM_DRAW);
+
+        glGenBuffers(1, &binary_slots_[i].buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, binary_slots_[i].buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, binary_bytes, nullptr, GL_STREAM_READ);
+
+        glGenBuffers(1, &stats_slots_[i].buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, stats_slots_[i].buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, 4 * sizeof(uint32_t), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glGenBuffers(1, &stats_buffer_);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, stats_buffer_);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, 4 * sizeof(uint32_t), nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    has_reference_ = false;  // Old reference no longer matches the frame size
+    clear_counts();
+    return true;
+}
+
+void GPUBinaryPipeline::destroy_resources() {
+    for (int i = 0; i < NUM_SLOTS; ++i) {
+        for (ReadbackSlot* slot : {&stats_slots_[i], &binary_slots_[i]}) {
+            if (slot->fence) glDeleteSync(slot->fence);
+            if (slot->buffer) glDeleteBuffers(1, &slot->buffer);
+            *slot = ReadbackSlot();
         }
+        if (upload_pbo_[i]) glDeleteBuffers(1, &upload_pbo_[i]);
+        upload_pbo_[i] = 0;
+    }
 
-        // Combined fitness metric
-        float fitness = mean + variance * 0.5f + non_zero_ratio * 0.3f;
-        metrics.push_back(fitness);
+    for (GLuint* texture : {&source_texture_, &binary_texture_, &reference_texture_, &count_texture_}) {
+        if (*texture) glDeleteTextures(1, texture);
+        *texture = 0;
+    }
+    if (stats_buffer_) glDeleteBuffers(1, &stats_buffer_);
+    stats_buffer_ = 0;
+
+    width_ = 0;
+    height_ = 0;
+    channels_ = 0;
+}
+
+void GPUBinaryPipeline::clear_counts() {
+    if (count_texture_ == 0) return;
+
+    // Texture storage is immutable, so zero it in place from a zero-filled PBO
+    const size_t bytes = static_cast<size_t>(width_) * height_ * sizeof(uint32_t);
+    GLuint zero_pbo = 0;
+    glGenBuffers(1, &zero_pbo);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, zero_pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    if (void* ptr = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY)) {
+        memset(ptr, 0, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindTexture(GL_TEXTURE_2D, count_texture_);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, GL_RED_INTEGER, GL_UNSIGNED_INT, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &zero_pbo);
+
+    const uint32_t zero_stats[4] = {0, 0, 0, 0};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, stats_buffer_);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(zero_stats), zero_stats);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    last_stats_ = Stats();
+}
+
+bool GPUBinaryPipeline::fence_done(GLsync& fence) {
+    if (!fence) {
+        return true;
+    }
+
+    GLenum status = glClientWaitSync(fence, 0, 0);  // Poll only, never block
+    if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+        glDeleteSync(fence);
+        fence = nullptr;
+        return true;
+    }
+    return false;
+}
+
+bool GPUBinaryPipeline::process(const cv::Mat& frame, uint8_t bit_mask) {
+    if (frame.empty() || frame.depth() != CV_8U ||
+        (frame.channels() != 1 && frame.channels() != 3)) {
+        return false;
+    }
+    if (!init_program() || !ensure_resources(frame.cols, frame.rows, frame.channels())) {
+        return false;
+    }
+
+    // 1. Upload raw frame through the PBO ring (orphaned so the driver never stalls)
+    const size_t row_bytes = static_cast<size_t>(frame.cols) * frame.channels();
+    const size_t frame_bytes = row_bytes * frame.rows;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo_[upload_idx_]);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, frame_bytes, nullptr, GL_STREAM_DRAW);
+    void* ptr = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if (!ptr) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+    if (frame.isContinuous()) {
+        memcpy(ptr, frame.data, frame_bytes);
+    } else {
+        for (int y = 0; y < frame.rows; ++y) {
+            memcpy(static_cast<uint8_t*>(ptr) + y * row_bytes, frame.ptr(y), row_bytes);
+        }
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    glBindTexture(GL_TEXTURE_2D, source_texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, frame.cols, frame.rows,
+                    channels_ == 1 ? GL_RED_INTEGER : GL_RGB_INTEGER, GL_UNSIGNED_BYTE, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    upload_idx_ = (upload_idx_ + 1) % NUM_SLOTS;
+
+    // 2. Fused extraction / scattering / reduction pass
+    glUseProgram(program_);
+    glUniform1ui(bit_mask_location_, bit_mask);
+    glUniform1i(track_scattering_location_, has_reference_ ? 1 : 0);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, source_texture_);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, reference_texture_);
+    glBindImageTexture(0, binary_texture_, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8);
+    glBindImageTexture(1, count_texture_, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, stats_buffer_);
+
+    GLuint groups_x = (width_ + 15) / 16;
+    GLuint groups_y = (height_ + 15) / 16;
+    glDispatchCompute(groups_x, groups_y, 1);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+
+    // Display sampling, readbacks and the stats copy all consume shader writes
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT |
+                    GL_PIXEL_BUFFER_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    // 3. Snapshot stats into a readback slot (skipped while both are in flight)
+    ReadbackSlot& stats_slot = stats_slots_[stats_write_];
+    if (fence_done(stats_slot.fence)) {
+        glBindBuffer(GL_COPY_READ_BUFFER, stats_buffer_);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, stats_slot.buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, 4 * sizeof(uint32_t));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        stats_slot.frame_index = frame_index_;
+        stats_slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        stats_write_ = (stats_write_ + 1) % NUM_SLOTS;
+    }
+
+    // Per-frame counters restart; running totals and max are kept
+    const uint32_t zero_frame[2] = {0, 0};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, stats_buffer_);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(zero_frame), zero_frame);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // 4. Optional binary readback for CPU consumers
+    if (binary_readback_) {
+        ReadbackSlot& binary_slot = binary_slots_[binary_write_];
+        if (fence_done(binary_slot.fence)) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, binary_slot.buffer);
+            glBindTexture(GL_TEXTURE_2D, binary_texture_);
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_UNSIGNED_BYTE, 0);  // 0 = into bound PBO
+            glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            binary_slot.frame_index = frame_index_;
+            binary_slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            binary_write_ = (binary_write_ + 1) % NUM_SLOTS;
+        }
+    }
+
+    frame_index_++;
+    return true;
+}
+
+bool GPUBinaryPipeline::read_binary(cv::Mat& out) {
+    // Newest finished slot that hasn't been delivered yet
+    ReadbackSlot* ready = nullptr;
+    for (auto& slot : binary_slots_) {
+        if (slot.frame_index > last_binary_frame_ && fence_done(slot.fence) &&
+            (!ready || slot.frame_index > ready->frame_index)) {
+            ready = &slot;
+        }
+    }
+    if (!ready) {
+        return false;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, ready->buffer);
+    const void* ptr = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (ptr) {
+        out.create(height_, width_, CV_8UC1);
+        memcpy(out.data, ptr, out.total());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        last_binary_frame_ = ready->frame_index;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return ptr != nullptr;
+}
+
+bool GPUBinaryPipeline::set_reference(const cv::Mat& reference) {
+    if (reference.type() != CV_8UC1 || reference.cols != width_ || reference.rows != height_) {
+        std::cerr << "GPUBinaryPipeline: Reference must be CV_8UC1 of the frame size" << std::endl;
+        return false;
+    }
+
+    cv::Mat upload = reference.isContinuous() ? reference : reference.clone();
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, reference_texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, GL_RED_INTEGER, GL_UNSIGNED_BYTE, upload.data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    has_reference_ = true;
+    return true;
+}
+
+bool GPUBinaryPipeline::set_reference_from_current() {
+    if (binary_texture_ == 0 || frame_index_ == 0) {
+        std::cerr << "GPUBinaryPipeline: No frame processed yet" << std::endl;
+        return false;
+    }
+
+    // R8 and R8UI share a texel size, so the bytes (0/255) copy across unchanged
+    glCopyImageSubData(binary_texture_, GL_TEXTURE_2D, 0, 0, 0, 0,
+                       reference_texture_, GL_TEXTURE_2D, 0, 0, 0, 0,
+                       width_, height_, 1);
+    has_reference_ = true;
+    return true;
+}
+
+GPUBinaryPipeline::Stats GPUBinaryPipeline::get_stats() {
+    for (auto& slot : stats_slots_) {
+        if (slot.frame_index <= last_stats_.frame_index || !fence_done(slot.fence)) {
+            continue;
+        }
+
+        uint32_t values[4];
+        glBindBuffer(GL_COPY_READ_BUFFER, slot.buffer);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(values), values);  // Fence passed: no stall
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+        last_stats_.active_pixels = values[0];
+        last_stats_.scattering_pixels = values[1];
+        last_stats_.total_scattering_events = values[2];
+        last_stats_.max_scattering_count = values[3];
+        last_stats_.frame_index = slot.frame_index;
+    }
+    return last_stats_;
+}
+
+void GPUBinaryPipeline::reset() {
+    // Results still in flight predate the reset
+    for (auto& slot : stats_slots_) {
+        if (slot.fence) glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        slot.frame_index = -1;
+    }
+    clear_counts();
+}
+
+void GPUBinaryPipeline::release() {
+    destroy_resources();
+    if (program_) glDeleteProgram(program_);
+    program_ = 0;
+    has_reference_ = false;
+    last_stats_ = Stats();
+    last_binary_frame_ = -1;
+    frame_index_ = 0;
+}
+
+//=============================================================================
+// GPUEventScatter Implementation
+//=============================================================================
+
+GPUEventScatter::~GPUEventScatter() {
+    release();
+}
+
+bool GPUEventScatter::is_supported() {
+    if (GLEW_VERSION_4_4) {
+        return true;
+    }
+    return GPUBinaryPipeline::is_supported() && GLEW_ARB_buffer_storage && GLEW_ARB_clear_texture;
+}
+
+bool GPUEventScatter::init_program() {
+    if (program_ != 0) return true;
+    if (program_failed_) return false;
+
+    program_ = compile_compute_shader(event_scatter_shader_source);
+    if (program_ == 0) {
+        std::cerr << "Failed to compile event scatter compute shader" << std::endl;
+        program_failed_ = true;  // Don't retry every frame
+        return false;
+    }
+
+    event_count_location_ = glGetUniformLocation(program_, "event_count");
+    std::cout << "GPUEventScatter initialized" << std::endl;
+    return true;
+}
+
+bool GPUEventScatter::prepare(int width, int height) {
+    if (width <= 0 || height <= 0 || !init_program()) {
+        return false;
+    }
+    const bool fresh_ring = ring_buffer_ == 0;
+    if (!ensure_ring() || !ensure_frame(width, height)) {
+        return false;
+    }
+    if (fresh_ring) {
+        // First touch of the mapped pages here rather than under the first large window
+        std::memset(ring_ptr_, 0, NUM_SEGMENTS * SEGMENT_EVENTS * sizeof(uint32_t));
+    }
+    return true;
+}
+
+bool GPUEventScatter::ensure_ring() {
+    if (ring_buffer_ != 0) return true;
+
+    // Written through the pointer for the buffer's whole life; coherent, so no flush calls
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr bytes = static_cast<GLsizeiptr>(NUM_SEGMENTS * SEGMENT_EVENTS * sizeof(uint32_t));
+    glGenBuffers(1, &ring_buffer_);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ring_buffer_);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, bytes, nullptr, flags);
+    ring_ptr_ = static_cast<uint32_t*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, bytes, flags));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    if (!ring_ptr_) {
+        std::cerr << "GPUEventScatter: Could not map the event ring" << std::endl;
+        glDeleteBuffers(1, &ring_buffer_);
+        ring_buffer_ = 0;
+        program_failed_ = true;
+        return false;
+    }
+    return true;
+}
+
+bool GPUEventScatter::ensure_frame(int width, int height) {
+    if (frame_texture_ != 0 && width == width_ && height == height_) {
+        return true;
+    }
+
+    destroy_frame();
+    width_ = width;
+    height_ = height;
+    glGenTextures(1, &frame_texture_);
+    glBindTexture(GL_TEXTURE_2D, frame_texture_);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    const GLint swizzle[4] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+void GPUEventScatter::destroy_frame() {
+    if (frame_texture_) glDeleteTextures(1, &frame_texture_);
+    frame_texture_ = 0;
+    width_ = 0;
+    height_ = 0;
+    frame_events_ = 0;
+}
+
+bool GPUEventScatter::scatter(const uint32_t* events, size_t count, int width, int height) {
+    if (width <= 0 || height <= 0 || (count > 0 && !events)) {
+        return false;
+    }
+    if (!init_program() || !ensure_ring() || !ensure_frame(width, height)) {
+        return false;
+    }
+
+    // 1. Clear pass: the window starts from an empty frame
+    const uint8_t zero = 0;
+    glClearTexImage(frame_texture_, 0, GL_RED, GL_UNSIGNED_BYTE, &zero);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    // 2. Scatter, one ring segment per chunk
+    glUseProgram(program_);
+    glBindImageTexture(0, frame_texture_, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8);
+    for (size_t done = 0; done < count;) {
+        GLsync& fence = segment_fences_[segment_];
+        if (fence) {
+            // Segments are used round-robin, so this is the dispatch NUM_SEGMENTS chunks ago
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+
+        const size_t chunk = std::min(count - done, SEGMENT_EVENTS);
+        const size_t offset = static_cast<size_t>(segment_) * SEGMENT_EVENTS;
+        memcpy(ring_ptr_ + offset, events + done, chunk * sizeof(uint32_t));
+
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, ring_buffer_,
+                          static_cast<GLintptr>(offset * sizeof(uint32_t)),
+                          static_cast<GLsizeiptr>(chunk * sizeof(uint32_t)));
+        glUniform1ui(event_count_location_, static_cast<GLuint>(chunk));
+        glDispatchCompute(static_cast<GLuint>((chunk + 255) / 256), 1, 1);
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        segment_ = (segment_ + 1) % NUM_SEGMENTS;
+        done += chunk;
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glUseProgram(0);
+
+    // Display sampling consumes the image stores
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    frame_events_ = count;
+    return true;
+}
+
+void GPUEventScatter::release() {
+    for (GLsync& fence : segment_fences_) {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (ring_buffer_) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, ring_buffer_);
+        glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        glDeleteBuffers(1, &ring_buffer_);
+    }
+    ring_buffer_ = 0;
+    ring_ptr_ = nullptr;
+    segment_ = 0;
+    destroy_frame();
+    if (program_) glDeleteProgram(program_);
+    program_ = 0;
+}
+
+//=============================================================================
+// GPUBinaryDisplay Implementation
+//=============================================================================
+
+GPUBinaryDisplay::~GPUBinaryDisplay() {
+    release();
+}
+
+bool GPUBinaryDisplay::is_supported() {
+    // Integer textures, texelFetch and framebuffer objects are all core in 3.0
+    return GLEW_VERSION_3_0;
+}
+
+bool GPUBinaryDisplay::init_program() {
+    if (program_ != 0) return true;
+    if (program_failed_) return false;
+
+    program_ = compile_render_program(fullscreen_vertex_source, binary_display_fragment_source);
+    if (program_ == 0) {
+        std::cerr << "Failed to compile binary display shader" << std::endl;
+        program_failed_ = true;  // Don't retry every frame
+        return false;
+    }
+
+    glUseProgram(program_);
+    glUniform1i(glGetUniformLocation(program_, "source_image"), 0);
+    glUniform1i(glGetUniformLocation(program_, "reference_image"), 1);
+    glUseProgram(0);
+
+    bit1_mask_location_ = glGetUniformLocation(program_, "bit1_mask");
+    bit2_mask_location_ = glGetUniformLocation(program_, "bit2_mask");
+    show_reference_location_ = glGetUniformLocation(program_, "show_reference");
+    const char* color_names[5] = {"bit1_color", "bit2_color", "both_color", "reference_color", "scattering_color"};
+    for (int i = 0; i < 5; ++i) {
+        color_locations_[i] = glGetUniformLocation(program_, color_names[i]);
+    }
+
+    glGenVertexArrays(1, &vertex_array_);
+    std::cout << "GPUBinaryDisplay initialized" << std::endl;
+    return true;
+}
+
+bool GPUBinaryDisplay::prepare(int width, int height, int channels) {
+    if (width <= 0 || height <= 0 || (channels != 1 && channels != 3)) {
+        return false;
+    }
+    return init_program() && ensure_resources(width, height, channels);
+}
+
+bool GPUBinaryDisplay::ensure_resources(int width, int height, int channels) {
+    if (source_texture_ != 0 && width == width_ && height == height_ && channels == channels_) {
+        return true;
+    }
+
+    destroy_resources();
+    width_ = width;
+    height_ = height;
+    channels_ = channels;
+
+    // Integer textures must use nearest filtering to be complete
+    auto create_texture = [width, height](GLuint& texture, GLint internal_format, GLenum format) {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    };
+    create_texture(source_texture_, channels == 1 ? GL_R8UI : GL_RGB8UI,
+                   channels == 1 ? GL_RED_INTEGER : GL_RGB_INTEGER);
+    create_texture(reference_texture_, GL_R8UI, GL_RED_INTEGER);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (!create_render_target(width, height, output_texture_, framebuffer_)) {
+        std::cerr << "GPUBinaryDisplay: Display framebuffer incomplete" << std::endl;
+        destroy_resources();
+        return false;
+    }
+
+    const size_t frame_bytes = static_cast<size_t>(width) * height * channels;
+    for (int i = 0; i < NUM_PBOS; ++i) {
+        glGenBuffers(1, &upload_pbo_[i]);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo_[i]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, frame_bytes, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    has_reference_ = false;  // Old reference no longer matches the frame size
+    return true;
+}
+
+void GPUBinaryDisplay::destroy_resources() {
+    for (int i = 0; i < NUM_PBOS; ++i) {
+        if (upload_pbo_[i]) glDeleteBuffers(1, &upload_pbo_[i]);
+        upload_pbo_[i] = 0;
+    }
+    if (framebuffer_) glDeleteFramebuffers(1, &framebuffer_);
+    framebuffer_ = 0;
+    for (GLuint* texture : {&source_texture_, &reference_texture_, &output_texture_}) {
+        if (*texture) glDeleteTextures(1, texture);
+        *texture = 0;
+    }
+
+    width_ = 0;
+    height_ = 0;
+    channels_ = 0;
+    uploaded_ = false;
+}
+
+bool GPUBinaryDisplay::upload(const cv::Mat& frame) {
+    if (frame.empty() || frame.depth() != CV_8U ||
+        (frame.channels() != 1 && frame.channels() != 3)) {
+        return false;
+    }
+    if (!ensure_resources(frame.cols, frame.rows, frame.channels())) {
+        return false;
+    }
+
+    // Orphaned PBO ring, as in GPUBinaryPipeline::process
+    const size_t row_bytes = static_cast<size_t>(frame.cols) * frame.channels();
+    const size_t frame_bytes = row_bytes * frame.rows;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo_[upload_idx_]);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, frame_bytes, nullptr, GL_STREAM_DRAW);
+    void* ptr = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if (!ptr) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+    if (frame.isContinuous()) {
+        memcpy(ptr, frame.data, frame_bytes);
+    } else {
+        for (int y = 0; y < frame.rows; ++y) {
+            memcpy(static_cast<uint8_t*>(ptr) + y * row_bytes, frame.ptr(y), row_bytes);
+        }
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    glBindTexture(GL_TEXTURE_2D, source_texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, frame.cols, frame.rows,
+                    channels_ == 1 ? GL_RED_INTEGER : GL_RGB_INTEGER, GL_UNSIGNED_BYTE, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    upload_idx_ = (upload_idx_ + 1) % NUM_PBOS;
+
+    uploaded_ = true;
+    return true;
+}
+
+bool GPUBinaryDisplay::render(const Style& style) {
+    if (!uploaded_ || !init_program()) {
+        return false;
+    }
+
+    glUseProgram(program_);
+    glUniform1ui(bit1_mask_location_, style.bit1_mask);
+    glUniform1ui(bit2_mask_location_, style.bit2_mask);
+    glUniform1i(show_reference_location_, (style.show_reference && has_reference_) ? 1 : 0);
+    const float* colors[5] = {style.bit1_color, style.bit2_color, style.both_color,
+                              style.reference_color, style.scattering_color};
+    for (int i = 0; i < 5; ++i) {
+        glUniform3fv(color_locations_[i], 1, colors[i]);
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, source_texture_);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, reference_texture_);
+
+    draw_offscreen(framebuffer_, vertex_array_, width_, height_);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    return true;
+}
+
+bool GPUBinaryDisplay::set_reference(const cv::Mat& reference) {
+    if (reference.type() != CV_8UC1 || reference.cols != width_ || reference.rows != height_) {
+        std::cerr << "GPUBinaryDisplay: Reference must be CV_8UC1 of the frame size" << std::endl;
+        return false;
+    }
+
+    cv::Mat contiguous = reference.isContinuous() ? reference : reference.clone();
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, reference_texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, GL_RED_INTEGER, GL_UNSIGNED_BYTE, contiguous.data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    has_reference_ = true;
+    return true;
+}
+
+void GPUBinaryDisplay::release() {
+    destroy_resources();
+    if (vertex_array_) glDeleteVertexArrays(1, &vertex_array_);
+    vertex_array_ = 0;
+    if (program_) glDeleteProgram(program_);
+    program_ = 0;
+    has_reference_ = false;
+}
+
+//=============================================================================
+// GPUScatteringView Implementation
+//=============================================================================
+
+GPUScatteringView::~GPUScatteringView() {
+    release();
+}
+
+bool GPUScatteringView::init_program() {
+    if (program_ != 0) return true;
+    if (program_failed_) return false;
+
+    program_ = compile_render_program(fullscreen_vertex_source, scattering_view_fragment_source);
+    if (program_ == 0) {
+        std::cerr << "Failed to compile scattering view shader" << std::endl;
+        program_failed_ = true;  // Don't retry every frame
+        return false;
+    }
+
+    glUseProgram(program_);
+    glUniform1i(glGetUniformLocation(program_, "binary_image"), 0);
+    glUniform1i(glGetUniformLocation(program_, "reference_image"), 1);
+    glUniform1i(glGetUniformLocation(program_, "count_image"), 2);
+    glUniform1i(glGetUniformLocation(program_, "colormap"), 3);
+    glUseProgram(0);
+
+    mode_location_ = glGetUniformLocation(program_, "mode");
+    max_count_location_ = glGetUniformLocation(program_, "max_count");
+    track_scattering_location_ = glGetUniformLocation(program_, "track_scattering");
+    highlight_location_ = glGetUniformLocation(program_, "highlight_color");
+
+    // Colormap built once from OpenCV's own table so both paths show the same colours
+    cv::Mat ramp(1, 256, CV_8UC1);
+    for (int i = 0; i < 256; ++i) {
+        ramp.at<uint8_t>(0, i) = static_cast<uint8_t>(i);
+    }
+    cv::Mat jet;
+    cv::applyColorMap(ramp, jet, cv::COLORMAP_JET);
+    cv::cvtColor(jet, jet, cv::COLOR_BGR2RGB);
+
+    glGenTextures(1, &colormap_texture_);
+    glBindTexture(GL_TEXTURE_2D, colormap_texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, 256, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, jet.data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenVertexArrays(1, &vertex_array_);
+    return true;
+}
+
+bool GPUScatteringView::ensure_target(int width, int height) {
+    if (output_texture_ != 0 && width == width_ && height == height_) {
+        return true;
+    }
+
+    if (framebuffer_) glDeleteFramebuffers(1, &framebuffer_);
+    if (output_texture_) glDeleteTextures(1, &output_texture_);
+    framebuffer_ = 0;
+    output_texture_ = 0;
+    width_ = 0;
+    height_ = 0;
+
+    if (!create_render_target(width, height, output_texture_, framebuffer_)) {
+        std::cerr << "GPUScatteringView: View framebuffer incomplete" << std::endl;
+        return false;
+    }
+    width_ = width;
+    height_ = height;
+    return true;
+}
+
+bool GPUScatteringView::render(const GPUBinaryPipeline& pipeline, Mode mode, uint32_t max_count) {
+    if (pipeline.get_binary_texture() == 0 || !init_program() ||
+        !ensure_target(pipeline.get_width(), pipeline.get_height())) {
+        return false;
+    }
+
+    glUseProgram(program_);
+    glUniform1i(mode_location_, static_cast<int>(mode));
+    glUniform1f(max_count_location_, static_cast<float>(std::max<uint32_t>(max_count, 1)));
+    glUniform1i(track_scattering_location_, pipeline.has_reference() ? 1 : 0);
+    glUniform3fv(highlight_location_, 1, highlight_);
+
+    const GLuint textures[4] = {pipeline.get_binary_texture(), pipeline.get_reference_texture(),
+                                pipeline.get_count_texture(), colormap_texture_};
+    for (int i = 0; i < 4; ++i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+    }
+
+    draw_offscreen(framebuffer_, vertex_array_, width_, height_);
+
+    for (int i = 3; i >= 0; --i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glUseProgram(0);
+    return true;
+}
+
+void GPUScatteringView::set_highlight_color(float r, float g, float b) {
+    highlight_[0] = r;
+    highlight_[1] = g;
+    highlight_[2] = b;
+}
+
+void GPUScatteringView::release() {
+    if (framebuffer_) glDeleteFramebuffers(1, &framebuffer_);
+    framebuffer_ = 0;
+    for (GLuint* texture : {&output_texture_, &colormap_texture_}) {
+        if (*texture) glDeleteTextures(1, texture);
+        *texture = 0;
+    }
+    if (vertex_array_) glDeleteVertexArrays(1, &vertex_array_);
+    vertex_array_ = 0;
+    if (program_) glDeleteProgram(program_);
+    program_ = 0;
+    width_ = 0;
+    height_ = 0;
+}
+
+//=============================================================================
+// GPUCompareView Implementation
+//=============================================================================
+
+GPUCompareView::~GPUCompareView() {
+    release();
+}
+
+bool GPUCompareView::init_program() {
+    if (program_ != 0) return true;
+    if (program_failed_) return false;
+
+    program_ = compile_render_program(fullscreen_vertex_source, compare_view_fragment_source);
+    if (program_ == 0) {
+        std::cerr << "Failed to compile compare view shader" << std::endl;
+        program_failed_ = true;  // Don't retry every frame
+        return false;
+    }
+
+    glUseProgram(program_);
+    glUniform1i(glGetUniformLocation(program_, "live_image"), 0);
+    glUniform1i(glGetUniformLocation(program_, "loaded_image"), 1);
+    glUseProgram(0);
+
+    color_locations_[0] = glGetUniformLocation(program_, "live_color");
+    color_locations_[1] = glGetUniformLocation(program_, "loaded_color");
+    color_locations_[2] = glGetUniformLocation(program_, "both_color");
+
+    glGenVertexArrays(1, &vertex_array_);
+    return true;
+}
+
+bool GPUCompareView::ensure_target(int width, int height) {
+    if (output_texture_ != 0 && width == width_ && height == height_) {
+        return true;
+    }
+
+    if (framebuffer_) glDeleteFramebuffers(1, &framebuffer_);
+    if (output_texture_) glDeleteTextures(1, &output_texture_);
+    framebuffer_ = 0;
+    output_texture_ = 0;
+    width_ = 0;
+    height_ = 0;
+
+    if (!create_render_target(width, height, output_texture_, framebuffer_)) {
+        std::cerr << "GPUCompareView: View framebuffer incomplete" << std::endl;
+        return false;
+    }
+    width_ = width;
+    height_ = height;
+    return true;
+}
+
+bool GPUCompareView::render(GLuint live_texture, GLuint loaded_texture, int width, int height,
+                            const Style& style) {
+    if (live_texture == 0 || loaded_texture == 0 || width <= 0 || height <= 0 ||
+        !init_program() || !ensure_target(width, height)) {
+        return false;
+    }
+
+    glUseProgram(program_);
+    glUniform3fv(color_locations_[0], 1, style.live_color);
+    glUniform3fv(color_locations_[1], 1, style.loaded_color);
+    glUniform3fv(color_locations_[2], 1, style.both_color);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, live_texture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, loaded_texture);
+
+    draw_offscreen(framebuffer_, vertex_array_, width_, height_);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    return true;
+}
+
+void GPUCompareView::release() {
+    if (framebuffer_) glDeleteFramebuffers(1, &framebuffer_);
+    framebuffer_ = 0;
+    if (output_texture_) glDeleteTextures(1, &output_texture_);
+    output_texture_ = 0;
+    if (vertex_array_) glDeleteVertexArrays(1, &vertex_array_);
+    vertex_array_ = 0;
+    if (program_) glDeleteProgram(program_);
+    program_ = 0;
+    width_ = 0;
+    height_ = 0;
+}
+
+//=============================================================================
+// GPUPassTimer Implementation
+//=============================================================================
+
+GPUPassTimer::~GPUPassTimer() {
+    release();
+}
+
+bool GPUPassTimer::is_supported() {
+    return GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+}
+
+bool GPUPassTimer::init() {
+    if (supported_ < 0) {
+        supported_ = is_supported() ? 1 : 0;
+    }
+    return supported_ == 1;
+}
+
+int GPUPassTimer::add_pass(const std::string& name) {
+    if (static_cast<int>(passes_.size()) >= MAX_PASSES) {
+        return -1;
+    }
+    Pass pass;
+    pass.name = name;
+    passes_.push_back(pass);
+    rings_.emplace_back();
+    return static_cast<int>(passes_.size()) - 1;
+}
+
+void GPUPassTimer::begin(int pass) {
+    if (pass < 0 || pass >= static_cast<int>(passes_.size()) || open_pass_ >= 0 || !init()) {
+        return;
+    }
+
+    Ring& ring = rings_[pass];
+    if (ring.queries[0] == 0) {
+        glGenQueries(RING_SIZE, ring.queries);
+    }
+    if (ring.pending[ring.next]) {
+        ++passes_[pass].skipped;  // Oldest result still in flight; never wait for it
+        return;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, ring.queries[ring.next]);
+    open_pass_ = pass;
+}
+
+void GPUPassTimer::end() {
+    if (open_pass_ < 0) {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED);
+    Ring& ring = rings_[open_pass_];
+    ring.pending[ring.next] = true;
+    ring.next = (ring.next + 1) % RING_SIZE;
+    open_pass_ = -1;
+}
+
+const std::vector<GPUPassTimer::Sample>& GPUPassTimer::collect() {
+    samples_.clear();
+    if (supported_ != 1) {
+        return samples_;
+    }
+
+    for (int pass = 0; pass < static_cast<int>(rings_.size()); ++pass) {
+        Ring& ring = rings_[pass];
+
+        // Oldest first; queries complete in submission order, so stop at the first pending one
+        for (int i = 0; i < RING_SIZE; ++i) {
+            const int slot = (ring.next + i) % RING_SIZE;
+            if (!ring.pending[slot]) {
+                continue;
+            }
+            GLint available = 0;
+            glGetQueryObjectiv(ring.queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) {
+                break;
+            }
+            GLuint64 elapsed_ns = 0;
+            glGetQueryObjectui64v(ring.queries[slot], GL_QUERY_RESULT, &elapsed_ns);
+            ring.pending[slot] = false;
+            record(pass, elapsed_ns);
+        }
+    }
+    return samples_;
+}
+
+void GPUPassTimer::record(int pass, uint64_t elapsed_ns) {
+    Pass& stats = passes_[pass];
+    const double ms = elapsed_ns / 1e6;
+    stats.last_ms = ms;
+    stats.avg_ms = stats.samples == 0 ? ms : stats.avg_ms + (ms - stats.avg_ms) / 32.0;
+    stats.max_ms = std::max(stats.max_ms, ms);
+    ++stats.samples;
+    samples_.push_back({pass, elapsed_ns});
+}
+
+void GPUPassTimer::release() {
+    if (open_pass_ >= 0) {
+        glEndQuery(GL_TIME_ELAPSED);
+        open_pass_ = -1;
+    }
+    for (Ring& ring : rings_) {
+        if (ring.queries[0]) glDeleteQueries(RING_SIZE, ring.queries);
+        ring = Ring();
     }
 }
 
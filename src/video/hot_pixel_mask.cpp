@@ -0,0 +1,74 @@
+#include "video/hot_pixel_mask.h"
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace video {
+
+bool save_hot_pixel_mask(const std::string& path, const BinaryFrame& mask, const HotPixelMaskInfo& info) {
+    if (mask.empty() || mask.width() > 0xFFFF || mask.height() > 0xFFFF) {
+        std::cerr << "HotPixelMask: Invalid mask size" << std::endl;
+        return false;
+    }
+
+    hot_pixel_file::FileHeader header{};
+    std::memcpy(header.magic, hot_pixel_file::MAGIC, sizeof(header.magic));
+    header.version = hot_pixel_file::VERSION;
+    header.width = static_cast<uint16_t>(mask.width());
+    header.height = static_cast<uint16_t>(mask.height());
+    header.words_per_row = static_cast<uint32_t>(mask.words_per_row());
+    header.pixel_count = static_cast<uint32_t>(mask.count());
+    header.duration_ms = info.duration_ms;
+    header.threshold_hz = info.threshold_hz;
+
+    std::error_code ec;
+    const fs::path target(path);
+    if (target.has_parent_path()) {
+        fs::create_directories(target.parent_path(), ec);
+    }
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "HotPixelMask: Failed to create " << path << std::endl;
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(mask.data(), sizeof(uint64_t), mask.word_count(), file) == mask.word_count();
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok) {
+        std::cerr << "HotPixelMask: Write failed: " << path << std::endl;
+    }
+    return ok;
+}
+
+bool load_hot_pixel_mask(const std::string& path, BinaryFrame& mask, HotPixelMaskInfo& info) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;   // No calibration yet is not an error
+    }
+
+    hot_pixel_file::FileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || !hot_pixel_file::is_valid(header)) {
+        std::cerr << "HotPixelMask: " << path << " is not a hot pixel mask" << std::endl;
+        std::fclose(file);
+        return false;
+    }
+
+    mask.create(header.width, header.height);
+    const bool ok = std::fread(mask.data(), sizeof(uint64_t), mask.word_count(), file) == mask.word_count();
+    std::fclose(file);
+    if (!ok) {
+        std::cerr << "HotPixelMask: " << path << " is truncated" << std::endl;
+        mask = BinaryFrame();
+        return false;
+    }
+
+    info.duration_ms = header.duration_ms;
+    info.threshold_hz = header.threshold_hz;
+    info.pixel_count = header.pixel_count;
+    return true;
+}
+
+} // namespace video
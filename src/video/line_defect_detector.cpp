@@ -0,0 +1,173 @@
+#include "video/line_defect_detector.h"
+#include <algorithm>
+
+namespace video {
+
+void LineDefectDetector::configure(int width, int height) {
+    width_ = std::max(width, 0);
+    height_ = std::max(height, 0);
+    const int words_per_row = (width_ + 63) / 64;
+    planes_.assign(static_cast<size_t>(COUNTER_BITS) * words_per_row, 0);
+    rows_in_planes_ = 0;
+    row_sums_.assign(height_, 0);
+    column_sums_.assign(width_, 0);
+    row_states_.assign(height_, LineState());
+    column_states_.assign(width_, LineState());
+    frames_processed_ = 0;
+    clear_requested_ = false;
+    {
+        std::lock_guard<std::mutex> lock(defects_mutex_);
+        defects_.clear();
+    }
+    defect_count_ = 0;
+}
+
+void LineDefectDetector::set_threshold(float sigma, float min_fill, int min_frames) {
+    sigma_ = sigma > 0.0f ? sigma : 1.0f;
+    min_fill_ = std::min(std::max(min_fill, 0.0f), 1.0f);
+    min_frames_ = std::max(min_frames, 1);
+}
+
+void LineDefectDetector::process(Metavision::timestamp ts, const cv::Mat& frame) {
+    if (packed_.assign_masked(frame, 0xFF)) {
+        process(ts, packed_);
+    }
+}
+
+void LineDefectDetector::add_row(const uint64_t* row) {
+    // Ripple-carry add of one bit per column into COUNTER_BITS planes, 64 columns at a time
+    const size_t words_per_row = planes_.size() / COUNTER_BITS;
+    for (size_t w = 0; w < words_per_row; ++w) {
+        uint64_t carry = row[w];
+        for (int k = 0; carry && k < COUNTER_BITS; ++k) {
+            uint64_t& plane = planes_[k * words_per_row + w];
+            const uint64_t next = plane & carry;
+            plane ^= carry;
+            carry = next;
+        }
+    }
+    ++rows_in_planes_;
+}
+
+void LineDefectDetector::spill_counters() {
+    const size_t words_per_row = planes_.size() / COUNTER_BITS;
+    for (size_t w = 0; w < words_per_row; ++w) {
+        uint32_t* sums = column_sums_.data() + w * 64;
+        const int n = std::min(64, width_ - static_cast<int>(w) * 64);
+        for (int k = 0; k < COUNTER_BITS; ++k) {
+            uint64_t plane = planes_[k * words_per_row + w];
+            planes_[k * words_per_row + w] = 0;
+            while (plane) {
+                const int bit = BinaryFrame::lowest_set_bit(plane);
+                if (bit < n) {
+                    sums[bit] += uint32_t(1) << k;
+                }
+                plane &= plane - 1;
+            }
+        }
+    }
+    rows_in_planes_ = 0;
+}
+
+void LineDefectDetector::process(Metavision::timestamp ts, const BinaryFrame& frame) {
+    if (frame.width() != width_ || frame.height() != height_ || width_ == 0 || height_ == 0) {
+        return;
+    }
+    if (clear_requested_.exchange(false)) {
+        std::fill(row_states_.begin(), row_states_.end(), LineState());
+        std::fill(column_states_.begin(), column_states_.end(), LineState());
+        std::lock_guard<std::mutex> lock(defects_mutex_);
+        defects_.clear();
+        defect_count_ = 0;
+    }
+
+    // Rows: a popcount per word; columns: the bit-sliced counters, spilled before they overflow
+    std::fill(column_sums_.begin(), column_sums_.end(), 0);
+    const int words_per_row = frame.words_per_row();
+    for (int y = 0; y < height_; ++y) {
+        const uint64_t* row = frame.row(y);
+        uint32_t sum = 0;
+        for (int w = 0; w < words_per_row; ++w) {
+            sum += static_cast<uint32_t>(BinaryFrame::popcount(row[w]));
+        }
+        row_sums_[y] = sum;
+        if (sum == 0) {
+            continue;   // Adds nothing to any column
+        }
+        add_row(row);
+        if (rows_in_planes_ == (1 << COUNTER_BITS) - 1) {
+            spill_counters();
+        }
+    }
+    if (rows_in_planes_ > 0) {
+        spill_counters();
+    }
+
+    update_lines(row_sums_, width_, false, row_states_, ts);
+    update_lines(column_sums_, height_, true, column_states_, ts);
+    frames_processed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LineDefectDetector::update_lines(const std::vector<uint32_t>& sums, int length, bool column,
+                                      std::vector<LineState>& states, Metavision::timestamp ts) {
+    // Median and MAD by selection, so a few defective lines never move the threshold
+    scratch_.assign(sums.begin(), sums.end());
+    const size_t mid = scratch_.size() / 2;
+    std::nth_element(scratch_.begin(), scratch_.begin() + mid, scratch_.end());
+    const uint32_t median = scratch_[mid];
+    for (size_t i = 0; i < sums.size(); ++i) {
+        scratch_[i] = sums[i] > median ? sums[i] - median : median - sums[i];
+    }
+    std::nth_element(scratch_.begin(), scratch_.begin() + mid, scratch_.end());
+    const float mad = static_cast<float>(scratch_[mid]);
+    const float limit = std::max(median + sigma_.load(std::memory_order_relaxed) * 1.4826f * mad,
+                                 min_fill_.load(std::memory_order_relaxed) * length);
+    const uint32_t min_frames = static_cast<uint32_t>(min_frames_.load(std::memory_order_relaxed));
+
+    std::lock_guard<std::mutex> lock(defects_mutex_);
+    for (size_t i = 0; i < sums.size(); ++i) {
+        LineState& state = states[i];
+        if (static_cast<float>(sums[i]) <= limit) {
+            if (state.streak != 0) {
+                state.streak = 0;
+                if (state.listed >= 0) {
+                    defects_[state.listed].streak = 0;
+                }
+            }
+            continue;
+        }
+
+        ++state.streak;
+        ++state.frames_flagged;
+        if (state.listed == UNLISTED_OVERFLOW) {
+            continue;
+        }
+        if (state.listed == UNLISTED) {
+            if (state.frames_flagged < min_frames) {
+                continue;
+            }
+            if (defect_count_.fetch_add(1, std::memory_order_relaxed) >= MAX_DEFECTS) {
+                state.listed = UNLISTED_OVERFLOW;   // Counted once, not listed
+                continue;
+            }
+            LineDefect defect;
+            defect.column = column;
+            defect.index = static_cast<int>(i);
+            defect.first_ts = ts;
+            state.listed = static_cast<int32_t>(defects_.size());
+            defects_.push_back(defect);
+        }
+        LineDefect& defect = defects_[state.listed];
+        defect.last_ts = ts;
+        defect.frames_flagged = state.frames_flagged;
+        defect.streak = state.streak;
+        defect.fill = length > 0 ? static_cast<float>(sums[i]) / length : 0.0f;
+    }
+}
+
+void LineDefectDetector::get_defects(std::vector<LineDefect>& out) const {
+    std::lock_guard<std::mutex> lock(defects_mutex_);
+    out.assign(defects_.begin(), defects_.end());
+}
+
+} // namespace video
@@ -0,0 +1,245 @@
+#include "video/pixel_lifetime_stats.h"
+#include "core/log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace video {
+
+static_assert(sizeof(PixelLifetimeStats::FileHeader) <= PixelLifetimeStats::HEADER_BYTES,
+              "Lifetime header outgrew its reserved bytes");
+static_assert(sizeof(PixelLifetimeStats::PixelRecord) == 32, "Lifetime records are part of the file format");
+
+namespace {
+
+int64_t unix_now_s() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Increase since the last merge; a count below the merged one restarted from zero
+inline uint32_t delta(uint32_t current, uint32_t& merged) {
+    const uint32_t added = current >= merged ? current - merged : current;
+    merged = current;
+    return added;
+}
+
+} // namespace
+
+PixelLifetimeStats::~PixelLifetimeStats() {
+    close();
+}
+
+std::string PixelLifetimeStats::file_name(const std::string& serial) {
+    std::string safe = serial.empty() ? std::string("unknown") : serial;
+    for (char& c : safe) {
+        const bool ok = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '-';
+        if (!ok) {
+            c = '_';
+        }
+    }
+    return "lifetime_" + safe + ".rtls";
+}
+
+bool PixelLifetimeStats::map_file(const std::string& path, size_t bytes) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    // Grows a new (empty) file to the full size, zero-filled
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32),
+                                        static_cast<DWORD>(bytes & 0xFFFFFFFFu), nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    file_handle_ = file;
+    mapping_handle_ = mapping;
+    base_ = static_cast<uint8_t*>(view);
+#else
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        (static_cast<size_t>(st.st_size) < bytes && ftruncate(fd, static_cast<off_t>(bytes)) != 0)) {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);  // The mapping keeps the file referenced
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    base_ = static_cast<uint8_t*>(view);
+#endif
+    size_ = bytes;
+    return true;
+}
+
+bool PixelLifetimeStats::open(const std::string& path, const std::string& serial, int width, int height) {
+    close();
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    const size_t bytes = HEADER_BYTES + static_cast<size_t>(width) * height * sizeof(PixelRecord);
+    if (!map_file(path, bytes)) {
+        core::LogLine(core::LogLevel::Warning) << "Lifetime statistics: cannot map " << path;
+        return false;
+    }
+
+    FileHeader& head = mutable_header();
+    if (head.magic == 0) {
+        // New file: the mapping is zero-filled, so only the header needs writing
+        head = FileHeader();
+        head.width = static_cast<uint32_t>(width);
+        head.height = static_cast<uint32_t>(height);
+        head.record_bytes = sizeof(PixelRecord);
+        head.created_unix_s = unix_now_s();
+        std::memcpy(head.serial, serial.data(), std::min(serial.size(), sizeof(head.serial) - 1));
+    } else if (head.magic != MAGIC || head.version != VERSION || head.record_bytes != sizeof(PixelRecord) ||
+               head.width != static_cast<uint32_t>(width) || head.height != static_cast<uint32_t>(height)) {
+        core::LogLine(core::LogLevel::Warning) << "Lifetime statistics: " << path << " is not a " << width << "x"
+                                               << height << " version " << VERSION << " file, not used";
+        close();
+        return false;
+    }
+
+    session_counted_ = false;
+    merged_exposure_us_ = 0;
+    merged_scattering_.clear();
+    merged_toggles_.clear();
+    merged_hot_.clear();
+    return true;
+}
+
+void PixelLifetimeStats::flush() {
+#ifdef _WIN32
+    FlushViewOfFile(base_, size_);
+#else
+    msync(base_, size_, MS_ASYNC);
+#endif
+}
+
+void PixelLifetimeStats::close() {
+    if (base_) {
+        flush();
+#ifdef _WIN32
+        UnmapViewOfFile(base_);
+        CloseHandle(static_cast<HANDLE>(mapping_handle_));
+        CloseHandle(static_cast<HANDLE>(file_handle_));
+        mapping_handle_ = nullptr;
+        file_handle_ = nullptr;
+#else
+        munmap(base_, size_);
+#endif
+    }
+    base_ = nullptr;
+    size_ = 0;
+}
+
+bool PixelLifetimeStats::merge(const SessionTotals& totals) {
+    if (!is_open()) {
+        return false;
+    }
+    const int w = width();
+    const int h = height();
+    const size_t pixels = static_cast<size_t>(w) * h;
+
+    const int64_t exposure = std::max<int64_t>(totals.exposure_us - merged_exposure_us_, 0);
+    merged_exposure_us_ = std::max(merged_exposure_us_, totals.exposure_us);
+    const cv::Mat* scattering = totals.scattering;
+    if (scattering && (scattering->rows != h || scattering->cols != w || scattering->type() != CV_32SC1)) {
+        scattering = nullptr;
+    }
+    const std::vector<uint32_t>* toggles = totals.toggles;
+    if (toggles && toggles->size() != pixels) {
+        toggles = nullptr;
+    }
+    if (scattering && merged_scattering_.size() != pixels) {
+        merged_scattering_.assign(pixels, 0);
+    }
+    if (toggles && merged_toggles_.size() != pixels) {
+        merged_toggles_.assign(pixels, 0);
+    }
+
+    // Row by row, so only the pages of rows with something to add are touched
+    if (exposure > 0 || scattering || toggles) {
+        for (int y = 0; y < h; ++y) {
+            PixelRecord* out = records() + static_cast<size_t>(y) * w;
+            const size_t base = static_cast<size_t>(y) * w;
+            if (exposure > 0) {
+                for (int x = 0; x < w; ++x) {
+                    out[x].exposure_us += static_cast<uint64_t>(exposure);
+                }
+            }
+            if (scattering) {
+                const int32_t* counts = scattering->ptr<int32_t>(y);
+                uint32_t* merged = merged_scattering_.data() + base;
+                for (int x = 0; x < w; ++x) {
+                    const uint32_t current = static_cast<uint32_t>(std::max(counts[x], 0));
+                    if (current != merged[x]) {
+                        out[x].scattering += delta(current, merged[x]);
+                    }
+                }
+            }
+            if (toggles) {
+                const uint32_t* counts = toggles->data() + base;
+                uint32_t* merged = merged_toggles_.data() + base;
+                for (int x = 0; x < w; ++x) {
+                    if (counts[x] != merged[x]) {
+                        out[x].toggles += delta(counts[x], merged[x]);
+                    }
+                }
+            }
+        }
+    }
+
+    // A pixel flagged again later in the same session still counts once
+    for (const cv::Point& p : totals.hot_pixels) {
+        if (p.x < 0 || p.y < 0 || p.x >= w || p.y >= h) {
+            continue;
+        }
+        if (merged_hot_.insert(static_cast<int64_t>(p.y) * w + p.x).second) {
+            ++records()[static_cast<size_t>(p.y) * w + p.x].hot_flags;
+        }
+    }
+
+    FileHeader& head = mutable_header();
+    if (!session_counted_) {
+        ++head.sessions;
+        session_counted_ = true;
+    }
+    head.exposure_us += static_cast<uint64_t>(exposure);
+    head.updated_unix_s = unix_now_s();
+    flush();
+    return true;
+}
+
+} // namespace video
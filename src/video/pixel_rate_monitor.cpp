@@ -0,0 +1,191 @@
+#include "video/pixel_rate_monitor.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace video {
+
+bool PixelRateMonitor::configure(int width, int height) {
+    const bool valid = width > 0 && height > 0;
+    width_ = valid ? width : 0;
+    height_ = valid ? height : 0;
+    const size_t count = valid ? static_cast<size_t>(width) * height : 0;
+    rates_.assign(count, 0);
+    stamps_.assign(count, 0);
+    flags_.assign(count, 0);
+    tick_us_ = 0;
+    latest_ts_ = -1;
+    scrub_row_ = 0;
+    flagged_count_ = 0;
+    {
+        std::lock_guard<std::mutex> lock(flagged_mutex_);
+        flagged_.clear();
+    }
+    known_changed_ = true;   // Marked again in the new flags
+
+    if (!valid) {
+        std::cerr << "PixelRateMonitor: invalid size " << width << "x" << height << ", monitor disabled" << std::endl;
+    }
+    return valid;
+}
+
+void PixelRateMonitor::set_known_hot(const BinaryFrame& mask) {
+    std::lock_guard<std::mutex> lock(known_mutex_);
+    known_hot_ = mask;
+    known_changed_ = true;
+}
+
+void PixelRateMonitor::apply_known_hot() {
+    for (uint8_t& flag : flags_) {
+        flag = flag == KNOWN_HOT ? 0 : flag;
+    }
+    int known = 0;
+    if (known_hot_.width() == width_ && known_hot_.height() == height_) {
+        for (int y = 0; y < height_; ++y) {
+            const uint64_t* row = known_hot_.row(y);
+            uint8_t* flags = flags_.data() + static_cast<size_t>(y) * width_;
+            for (int w = 0; w < known_hot_.words_per_row(); ++w) {
+                for (uint64_t bits = row[w]; bits; bits &= bits - 1) {
+                    const int x = w * 64 + BinaryFrame::lowest_set_bit(bits);
+                    if (x < width_) {
+                        flags[x] = KNOWN_HOT;
+                        ++known;
+                    }
+                }
+            }
+        }
+    }
+    known_count_ = known;
+}
+
+void PixelRateMonitor::set_half_life_ms(int half_life_ms) {
+    half_life_ms_ = std::max(half_life_ms, 1);
+}
+
+void PixelRateMonitor::restart(int half_life_ms) {
+    applied_half_life_ms_ = half_life_ms;
+    tick_us_ = std::max<int64_t>(1, static_cast<int64_t>(half_life_ms) * 1000 / TICKS_PER_HALF_LIFE);
+    for (int n = 0; n < LUT_TICKS; ++n) {
+        decay_lut_[n] = static_cast<uint32_t>(std::lround(65536.0 * std::exp2(-static_cast<double>(n) / TICKS_PER_HALF_LIFE)));
+    }
+    std::fill(rates_.begin(), rates_.end(), 0);
+    std::fill(stamps_.begin(), stamps_.end(), 0);
+    tick_end_ts_ = -1;
+}
+
+uint32_t PixelRateMonitor::decayed(size_t index, uint16_t now_tick) const {
+    const uint16_t age = static_cast<uint16_t>(now_tick - stamps_[index]);
+    if (age == 0) {
+        return rates_[index];
+    }
+    return age < LUT_TICKS ? (rates_[index] * decay_lut_[age]) >> 16 : 0;
+}
+
+void PixelRateMonitor::update(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    if (!enabled_.load(std::memory_order_relaxed)) {
+        tick_us_ = 0;  // Rates are stale by the time updates resume
+        return;
+    }
+    if (width_ == 0 || begin == end) {
+        return;
+    }
+
+    if (clear_requested_.exchange(false)) {
+        for (uint8_t& flag : flags_) {
+            flag = flag == KNOWN_HOT ? KNOWN_HOT : 0;
+        }
+        flagged_count_ = 0;
+        std::lock_guard<std::mutex> lock(flagged_mutex_);
+        flagged_.clear();
+    }
+    if (known_changed_.load(std::memory_order_relaxed) && known_changed_.exchange(false)) {
+        std::lock_guard<std::mutex> lock(known_mutex_);
+        apply_known_hot();
+    }
+
+    // New settings, re-enabled, or time went backwards (replay restarted or looped)
+    const int half_life_ms = half_life_ms_.load(std::memory_order_relaxed);
+    if (tick_us_ == 0 || half_life_ms != applied_half_life_ms_ || begin->t < latest_ts_) {
+        restart(half_life_ms);
+    }
+
+    const unsigned width = static_cast<unsigned>(width_);
+    const unsigned height = static_cast<unsigned>(height_);
+    constexpr uint32_t min_count = MIN_EVENTS * ONE;
+
+    for (const Metavision::EventCD* ev = begin; ev != end; ++ev) {
+        const unsigned x = ev->x;
+        const unsigned y = ev->y;
+        if (x >= width || y >= height) {
+            continue;
+        }
+        if (ev->t >= tick_end_ts_) {
+            const int64_t tick = ev->t / tick_us_;
+            now_tick_ = static_cast<uint16_t>(tick);
+            tick_end_ts_ = (tick + 1) * tick_us_;
+        }
+
+        const size_t index = static_cast<size_t>(y) * width + x;
+        const uint32_t count = std::min<uint32_t>(decayed(index, now_tick_) + ONE, 0xFFFF);
+        rates_[index] = static_cast<uint16_t>(count);
+        stamps_[index] = now_tick_;
+        if (count >= min_count && !flags_[index]) {
+            test_pixel(static_cast<int>(x), static_cast<int>(y), count, now_tick_, ev->t);
+        }
+    }
+    latest_ts_ = (end - 1)->t;
+
+    // One row per batch: every stamp is refreshed long before its tick can wrap
+    uint16_t* rate_row = rates_.data() + static_cast<size_t>(scrub_row_) * width;
+    uint16_t* stamp_row = stamps_.data() + static_cast<size_t>(scrub_row_) * width;
+    for (unsigned x = 0; x < width; ++x) {
+        if (static_cast<uint16_t>(now_tick_ - stamp_row[x]) >= LUT_TICKS) {
+            rate_row[x] = 0;
+            stamp_row[x] = now_tick_;
+        }
+    }
+    scrub_row_ = scrub_row_ + 1 < height_ ? scrub_row_ + 1 : 0;
+}
+
+void PixelRateMonitor::test_pixel(int x, int y, uint32_t count, uint16_t now_tick, int64_t ts) {
+    uint32_t sum = 0;
+    int neighbours = 0;
+    for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, height_ - 1); ++ny) {
+        for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, width_ - 1); ++nx) {
+            if (nx != x || ny != y) {
+                sum += decayed(static_cast<size_t>(ny) * width_ + nx, now_tick);
+                ++neighbours;
+            }
+        }
+    }
+
+    // Poisson: the neighbourhood mean is also its variance; at least one event so silence is not zero-width
+    const double events = static_cast<double>(count) / ONE;
+    const double lambda = neighbours > 0 ? static_cast<double>(sum) / ONE / neighbours : 0.0;
+    if (events <= lambda + sigma_.load(std::memory_order_relaxed) * std::sqrt(std::max(lambda, 1.0))) {
+        return;
+    }
+
+    flags_[static_cast<size_t>(y) * width_ + x] = FLAGGED;
+    flagged_count_.fetch_add(1, std::memory_order_relaxed);
+
+    // A count of n covers about half-life / ln 2 of events
+    const double per_s = std::log(2.0) * 1000.0 / applied_half_life_ms_;
+    std::lock_guard<std::mutex> lock(flagged_mutex_);
+    if (flagged_.size() < static_cast<size_t>(MAX_FLAGGED)) {
+        FlaggedPixel pixel;
+        pixel.x = x;
+        pixel.y = y;
+        pixel.flagged_ts = ts;
+        pixel.events_per_s = static_cast<float>(events * per_s);
+        pixel.neighbour_events_per_s = static_cast<float>(lambda * per_s);
+        flagged_.push_back(pixel);
+    }
+}
+
+void PixelRateMonitor::get_flagged(std::vector<FlaggedPixel>& out) const {
+    std::lock_guard<std::mutex> lock(flagged_mutex_);
+    out.assign(flagged_.begin(), flagged_.end());
+}
+
+} // namespace video
@@ -0,0 +1,201 @@
+#include "video/pixel_toggle_analyzer.h"
+#include "video/simd_utils.h"
+#include <algorithm>
+#include <cmath>
+
+namespace video {
+
+void PixelToggleAnalyzer::configure(int width, int height) {
+    width_ = std::max(width, 0);
+    height_ = std::max(height, 0);
+    previous_.create(width_, height_);
+    has_previous_ = false;
+    const size_t words = previous_.word_count();
+    toggle_planes_.assign(static_cast<size_t>(COUNTER_BITS) * words, 0);
+    streak_planes_.assign(static_cast<size_t>(COUNTER_BITS) * words, 0);
+    active_.assign(words, 0);
+    frames_in_window_ = 0;
+    stuck_scratch_.create(width_, height_);
+    flicker_scratch_.create(width_, height_);
+    last_toggles_ = 0;
+    frames_processed_ = 0;
+    clear_requested_ = false;
+    {
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        classes_ = ToggleClasses();
+        stuck_mask_ = BinaryFrame();
+        flicker_mask_ = BinaryFrame();
+        session_toggles_.assign(static_cast<size_t>(width_) * height_, 0);
+    }
+}
+
+void PixelToggleAnalyzer::set_threshold(int window_frames, int stuck_frames, float flicker_rate) {
+    window_frames_ = std::min(std::max(window_frames, 2), MAX_COUNT);
+    stuck_frames_ = std::min(std::max(stuck_frames, 1), MAX_COUNT);
+    flicker_rate_ = std::min(std::max(flicker_rate, 0.0f), 1.0f);
+}
+
+void PixelToggleAnalyzer::process(Metavision::timestamp ts, const cv::Mat& frame) {
+    if (packed_.assign_masked(frame, 0xFF)) {
+        process(ts, packed_);
+    }
+}
+
+void PixelToggleAnalyzer::increment(uint64_t* planes, size_t stride, uint64_t mask) {
+    // Counters at all ones hold; the rest take a ripple-carry add of one
+    uint64_t saturated = ~uint64_t(0);
+    for (int k = 0; k < COUNTER_BITS; ++k) {
+        saturated &= planes[k * stride];
+    }
+    uint64_t carry = mask & ~saturated;
+    for (int k = 0; carry && k < COUNTER_BITS; ++k) {
+        uint64_t& plane = planes[k * stride];
+        const uint64_t next = plane & carry;
+        plane ^= carry;
+        carry = next;
+    }
+}
+
+uint64_t PixelToggleAnalyzer::at_least(const uint64_t* planes, size_t stride, int value) {
+    // Bit-sliced comparison from the top bit: greater once a counter has a 1 where value has a 0
+    uint64_t greater = 0;
+    uint64_t equal = ~uint64_t(0);
+    for (int k = COUNTER_BITS - 1; k >= 0; --k) {
+        const uint64_t plane = planes[k * stride];
+        if ((value >> k) & 1) {
+            equal &= plane;
+        } else {
+            greater |= equal & plane;
+            equal &= ~plane;
+        }
+    }
+    return greater | equal;
+}
+
+void PixelToggleAnalyzer::process(Metavision::timestamp ts, const BinaryFrame& frame) {
+    if (frame.width() != width_ || frame.height() != height_ || width_ == 0 || height_ == 0) {
+        return;
+    }
+    if (clear_requested_.exchange(false)) {
+        std::fill(toggle_planes_.begin(), toggle_planes_.end(), 0);
+        std::fill(streak_planes_.begin(), streak_planes_.end(), 0);
+        std::fill(active_.begin(), active_.end(), 0);
+        has_previous_ = false;
+        frames_in_window_ = 0;
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        classes_ = ToggleClasses();
+        stuck_mask_ = BinaryFrame();
+        flicker_mask_ = BinaryFrame();
+        std::fill(session_toggles_.begin(), session_toggles_.end(), 0);
+    }
+
+    // One pass: XOR with the previous frame, both counters, the activity mask, then keep the frame
+    const size_t words = frame.word_count();
+    const uint64_t* current = frame.data();
+    uint64_t* previous = previous_.data();
+    int64_t toggles = 0;
+    for (size_t w = 0; w < words; ++w) {
+        const uint64_t bits = current[w];
+        const uint64_t toggled = has_previous_ ? bits ^ previous[w] : 0;
+        if (toggled) {
+            toggles += BinaryFrame::popcount(toggled);
+            increment(toggle_planes_.data() + w, words, toggled);
+        }
+        if (bits != ~uint64_t(0)) {
+            for (int k = 0; k < COUNTER_BITS; ++k) {
+                streak_planes_[k * words + w] &= bits;
+            }
+        }
+        if (bits) {
+            increment(streak_planes_.data() + w, words, bits);
+        }
+        active_[w] |= bits;
+        previous[w] = bits;
+    }
+    has_previous_ = true;
+    last_toggles_.store(toggles, std::memory_order_relaxed);
+    frames_processed_.fetch_add(1, std::memory_order_relaxed);
+
+    if (++frames_in_window_ >= window_frames_.load(std::memory_order_relaxed)) {
+        classify(ts);
+    }
+}
+
+void PixelToggleAnalyzer::classify(Metavision::timestamp ts) {
+    const size_t words = active_.size();
+    const int stuck_frames = stuck_frames_.load(std::memory_order_relaxed);
+    // Toggles are counted between frames, so a window of n frames has n - 1 chances
+    const float rate = flicker_rate_.load(std::memory_order_relaxed);
+    const int flicker_toggles = std::min(
+        std::max(static_cast<int>(std::ceil(rate * (frames_in_window_ - 1))), 1), MAX_COUNT);
+
+    uint64_t* stuck = stuck_scratch_.data();
+    uint64_t* flickering = flicker_scratch_.data();
+    for (size_t w = 0; w < words; ++w) {
+        if (!active_[w]) {
+            stuck[w] = 0;   // Never set this window: no streak and no toggles
+            flickering[w] = 0;
+            continue;
+        }
+        stuck[w] = at_least(streak_planes_.data() + w, words, stuck_frames);
+        flickering[w] = at_least(toggle_planes_.data() + w, words, flicker_toggles) & ~stuck[w];
+    }
+
+    ToggleClasses classes;
+    classes.stuck = simd::count_bits(stuck, words);
+    classes.flickering = simd::count_bits(flickering, words);
+    classes.normal = simd::count_ternary(active_.data(), stuck, flickering, words,
+                                         simd::TERN_A & ~simd::TERN_B & ~simd::TERN_C);
+    classes.window_end_ts = ts;
+    classes.window_frames = frames_in_window_;
+
+    std::lock_guard<std::mutex> lock(results_mutex_);
+
+    // Spill the toggle planes into the session totals, one add per set bit
+    const int words_per_row = previous_.words_per_row();
+    for (size_t w = 0; w < words; ++w) {
+        if (!active_[w]) {
+            continue;
+        }
+        uint32_t* totals = session_toggles_.data() + (w / words_per_row) * width_ + (w % words_per_row) * 64;
+        for (int k = 0; k < COUNTER_BITS; ++k) {
+            for (uint64_t plane = toggle_planes_[k * words + w]; plane; plane &= plane - 1) {
+                totals[BinaryFrame::lowest_set_bit(plane)] += uint32_t(1) << k;
+            }
+        }
+    }
+    std::fill(toggle_planes_.begin(), toggle_planes_.end(), 0);
+    std::fill(active_.begin(), active_.end(), 0);
+    frames_in_window_ = 0;
+
+    classes.windows = classes_.windows + 1;
+    classes_ = classes;
+    std::swap(stuck_mask_, stuck_scratch_);
+    std::swap(flicker_mask_, flicker_scratch_);
+    if (stuck_scratch_.size() != stuck_mask_.size()) {
+        stuck_scratch_.create(width_, height_);   // First window: the results were empty
+        flicker_scratch_.create(width_, height_);
+    }
+}
+
+void PixelToggleAnalyzer::get_session_toggles(std::vector<uint32_t>& out) const {
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    out.assign(session_toggles_.begin(), session_toggles_.end());
+}
+
+ToggleClasses PixelToggleAnalyzer::get_classes() const {
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    return classes_;
+}
+
+bool PixelToggleAnalyzer::get_masks(BinaryFrame& stuck, BinaryFrame& flickering) const {
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    if (classes_.windows == 0) {
+        return false;
+    }
+    stuck = stuck_mask_;
+    flickering = flicker_mask_;
+    return true;
+}
+
+} // namespace video
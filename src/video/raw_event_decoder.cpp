@@ -0,0 +1,316 @@
+#include "video/raw_event_decoder.h"
+#include "video/binary_frame.h"
+#include "video/binary_frame_accumulator.h"
+#include <algorithm>
+#include <cctype>
+
+namespace video {
+
+namespace {
+
+/**
+ * Sink writing row vectors straight into the packed frame
+ */
+struct PackedSink {
+    BinaryFrameAccumulator& target;
+
+    void time(Metavision::timestamp ts) { target.advance_packed(ts); }
+    void vector(int x, int y, uint32_t mask, int p) { target.write_packed(x, y, mask, p); }
+};
+
+/**
+ * Sink expanding row vectors into a small EventCD chunk for process_events()
+ */
+struct ChunkSink {
+    BinaryFrameAccumulator& target;
+    std::vector<Metavision::EventCD>& chunk;
+    int width;
+    Metavision::timestamp ts = 0;
+
+    void time(Metavision::timestamp t) { ts = t; }
+
+    void vector(int x, int y, uint32_t mask, int p) {
+        for (; mask != 0; mask &= mask - 1) {
+            const int px = x + BinaryFrame::lowest_set_bit(mask);
+            if (px >= width) {
+                break;
+            }
+            chunk.emplace_back(static_cast<unsigned short>(px), static_cast<unsigned short>(y),
+                               static_cast<short>(p), ts);
+            if (chunk.size() == RawEventDecoder::CHUNK_EVENTS) {
+                finish();
+            }
+        }
+    }
+
+    void finish() {
+        if (!chunk.empty()) {
+            target.process_events(chunk.data(), chunk.data() + chunk.size());
+            chunk.clear();
+        }
+    }
+};
+
+// EVT 2.1 word types (top 4 bits)
+constexpr unsigned EVT21_NEG = 0x0;
+constexpr unsigned EVT21_POS = 0x1;
+constexpr unsigned EVT21_TIME_HIGH = 0x8;
+constexpr unsigned EVT21_EXT_TRIGGER = 0xA;
+constexpr unsigned EVT21_OTHERS = 0xE;
+constexpr uint64_t EVT21_TIME_HIGH_MASK = ((uint64_t(1) << 28) - 1) << 6;
+constexpr int EVT21_LOOP_SHIFT = 34;
+
+// EVT 3.0 word types (top 4 bits)
+constexpr unsigned EVT3_ADDR_Y = 0x0;
+constexpr unsigned EVT3_EM_ADDR_Y = 0x1;
+constexpr unsigned EVT3_ADDR_X = 0x2;
+constexpr unsigned EVT3_VECT_BASE_X = 0x3;
+constexpr unsigned EVT3_VECT_12 = 0x4;
+constexpr unsigned EVT3_VECT_8 = 0x5;
+constexpr unsigned EVT3_TIME_LOW = 0x6;
+constexpr unsigned EVT3_TIME_HIGH = 0x8;
+constexpr size_t EVT3_VECTOR_WORDS = 3;   // VECT_12, VECT_12, VECT_8
+
+} // namespace
+
+RawEventDecoder::Format RawEventDecoder::parse_format(const std::string& encoding) {
+    std::string name = encoding.substr(0, encoding.find(';'));
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    if (name == "EVT21") return Format::Evt21;
+    if (name == "EVT3") return Format::Evt3;
+    return Format::Unsupported;
+}
+
+const char* RawEventDecoder::format_name(Format format) {
+    switch (format) {
+        case Format::Evt21: return "EVT 2.1";
+        case Format::Evt3: return "EVT 3.0";
+        default: return "unsupported";
+    }
+}
+
+void RawEventDecoder::configure(Format format, int width, int height) {
+    format_ = format;
+    width_ = width;
+    height_ = height;
+    chunk_.reserve(CHUNK_EVENTS);
+    reset();
+}
+
+void RawEventDecoder::reset() {
+    base_set_ = false;
+    shift_set_ = false;
+    shift_ = 0;
+    time_ = 0;
+    y_ = 0;
+    cd_row_ = false;
+    vector_x_ = 0;
+    vector_p_ = 0;
+    carry_.clear();
+    chunk_.clear();
+}
+
+void RawEventDecoder::set_time_shift(Metavision::timestamp shift) {
+    shift_ = shift;
+    shift_set_ = true;
+}
+
+uint64_t RawEventDecoder::decode(const uint8_t* data, size_t size, BinaryFrameAccumulator& target) {
+    if (format_ == Format::Unsupported || size == 0) {
+        return 0;
+    }
+    if (target.accepts_packed_input()) {
+        PackedSink sink{target};
+        return decode_with(data, size, sink);
+    }
+    ChunkSink sink{target, chunk_, width_};
+    const uint64_t events = decode_with(data, size, sink);
+    sink.finish();
+    return events;
+}
+
+template <class Sink>
+uint64_t RawEventDecoder::decode_with(const uint8_t* data, size_t size, Sink& sink) {
+    uint64_t events = 0;
+    size_t consumed = 0;
+
+    // Finish the unit the previous buffer split (at most one EVT 3.0 vector or EVT 2.1 word)
+    if (!carry_.empty()) {
+        const size_t carried = carry_.size();
+        const size_t head = std::min(size, sizeof(uint64_t));
+        carry_.insert(carry_.end(), data, data + head);
+        events += decode_words(carry_.data(), carry_.size(), sink, consumed);
+        if (consumed < carried) {
+            carry_.erase(carry_.begin(), carry_.begin() + static_cast<std::ptrdiff_t>(consumed));
+            return events;   // Still incomplete: this buffer was tiny
+        }
+        data += consumed - carried;
+        size -= consumed - carried;
+        carry_.clear();
+    }
+
+    events += decode_words(data, size, sink, consumed);
+    carry_.assign(data + consumed, data + size);
+    return events;
+}
+
+template <class Sink>
+uint64_t RawEventDecoder::decode_words(const uint8_t* data, size_t size, Sink& sink, size_t& consumed) {
+    if (format_ == Format::Evt21) {
+        const size_t words = size / sizeof(uint64_t);
+        const uint64_t* begin = reinterpret_cast<const uint64_t*>(data);
+        consumed = words * sizeof(uint64_t);
+        return decode_evt21(begin, begin + words, sink);
+    }
+    const size_t words = size / sizeof(uint16_t);
+    const uint16_t* begin = reinterpret_cast<const uint16_t*>(data);
+    size_t used = 0;
+    const uint64_t events = decode_evt3(begin, begin + words, sink, used);
+    consumed = used * sizeof(uint16_t);
+    return events;
+}
+
+template <class Sink>
+uint64_t RawEventDecoder::decode_evt21(const uint64_t* begin, const uint64_t* end, Sink& sink) {
+    uint64_t events = 0;
+    for (const uint64_t* it = begin; it != end; ++it) {
+        const uint64_t word = *it;
+        const unsigned type = static_cast<unsigned>(word >> 60);
+
+        if (type == EVT21_NEG || type == EVT21_POS) {
+            if (!base_set_) {
+                continue;   // No time base yet; the SDK drops these too
+            }
+            time_ = (time_ & ~uint64_t(63)) | ((word >> 54) & 63);
+            const int y = static_cast<int>((word >> 32) & 0x7FF);
+            const uint32_t mask = static_cast<uint32_t>(word);
+            if (y >= height_ || mask == 0) {
+                continue;
+            }
+            sink.time(static_cast<Metavision::timestamp>(time_) - shift_);
+            sink.vector(static_cast<int>((word >> 43) & 0x7FF), y, mask, static_cast<int>(type));
+            events += static_cast<uint64_t>(BinaryFrame::popcount(mask));
+        } else if (type == EVT21_TIME_HIGH) {
+            const uint64_t high = ((word >> 32) & 0x0FFFFFFF) << 6;
+            if (!base_set_) {
+                base_set_ = true;
+                time_ = high;
+                if (!shift_set_) {
+                    set_time_shift(static_cast<Metavision::timestamp>(high));
+                }
+                continue;
+            }
+            // Same wraparound rule as the SDK decoder
+            const uint64_t last_high = time_ & EVT21_TIME_HIGH_MASK;
+            uint64_t loops = time_ >> EVT21_LOOP_SHIFT;
+            if (high < last_high && last_high - high >= EVT21_TIME_HIGH_MASK) {
+                ++loops;
+            }
+            if (high != last_high) {
+                time_ = high | (loops << EVT21_LOOP_SHIFT);
+            }
+        } else if (type == EVT21_EXT_TRIGGER || type == EVT21_OTHERS) {
+            time_ = (time_ & ~uint64_t(63)) | ((word >> 54) & 63);   // Carries the time low bits too
+        }
+    }
+    return events;
+}
+
+template <class Sink>
+uint64_t RawEventDecoder::decode_evt3(const uint16_t* begin, const uint16_t* end, Sink& sink, size_t& consumed) {
+    uint64_t events = 0;
+    const size_t count = static_cast<size_t>(end - begin);
+    size_t i = 0;
+    while (i < count) {
+        const uint16_t word = begin[i];
+        switch (word >> 12) {
+            case EVT3_ADDR_Y:
+                y_ = word & 0x7FF;
+                cd_row_ = y_ < height_;
+                ++i;
+                break;
+
+            case EVT3_EM_ADDR_Y:
+                cd_row_ = false;
+                ++i;
+                break;
+
+            case EVT3_ADDR_X:
+                if (cd_row_ && base_set_) {
+                    sink.vector(word & 0x7FF, y_, 1, (word >> 11) & 1);
+                    ++events;
+                }
+                ++i;
+                break;
+
+            case EVT3_VECT_BASE_X:
+                vector_x_ = word & 0x7FF;
+                vector_p_ = (word >> 11) & 1;
+                ++i;
+                break;
+
+            case EVT3_VECT_12: {
+                if (i + EVT3_VECTOR_WORDS > count) {
+                    consumed = i;   // Rest of the vector is in the next buffer
+                    return events;
+                }
+                if ((begin[i + 1] >> 12) != EVT3_VECT_12 || (begin[i + 2] >> 12) != EVT3_VECT_8) {
+                    ++i;   // Broken pattern: skip the word, as the SDK validator does
+                    break;
+                }
+                if (cd_row_ && base_set_) {
+                    const uint32_t mask = static_cast<uint32_t>(word & 0xFFF) |
+                                          static_cast<uint32_t>(begin[i + 1] & 0xFFF) << 12 |
+                                          static_cast<uint32_t>(begin[i + 2] & 0xFF) << 24;
+                    if (mask != 0) {
+                        sink.vector(vector_x_, y_, mask, vector_p_);
+                        events += static_cast<uint64_t>(BinaryFrame::popcount(mask));
+                    }
+                }
+                vector_x_ += 32;
+                i += EVT3_VECTOR_WORDS;
+                break;
+            }
+
+            case EVT3_TIME_LOW:
+                time_ = (time_ & ~uint64_t(0xFFF)) | (word & 0xFFF);
+                if (base_set_) {
+                    sink.time(static_cast<Metavision::timestamp>(time_) - shift_);
+                }
+                ++i;
+                break;
+
+            case EVT3_TIME_HIGH: {
+                const uint64_t high = word & 0xFFF;
+                if (!base_set_) {
+                    base_set_ = true;
+                    time_ = high << 12;
+                    if (!shift_set_) {
+                        set_time_shift(static_cast<Metavision::timestamp>((high > 0 ? high - 1 : 0) << 12));
+                    }
+                } else {
+                    // Same wraparound rule as the SDK decoder (24-bit time, a loop every ~16.7 s)
+                    const uint64_t last_high = (time_ >> 12) & 0xFFF;
+                    uint64_t loops = time_ >> 24;
+                    if (last_high >= 2048 + high) {
+                        ++loops;
+                    }
+                    const uint64_t low = last_high == high ? (time_ & 0xFFF) : 0;
+                    time_ = (loops << 24) | (high << 12) | low;
+                }
+                sink.time(static_cast<Metavision::timestamp>(time_) - shift_);
+                ++i;
+                break;
+            }
+
+            default:
+                ++i;   // Triggers, system and continued words carry no CD events
+                break;
+        }
+    }
+    consumed = count;
+    return events;
+}
+
+} // namespace video
@@ -0,0 +1,287 @@
+#include "video/run_frame.h"
+#include <algorithm>
+#include <cstring>
+
+namespace video {
+
+namespace {
+
+// Row y may hold set pixels (bit 63 covers every row below it)
+inline bool row_touched(uint64_t bands, int y) {
+    return (bands >> std::min(y / RowBands::BAND_ROWS, 63)) & 1u;
+}
+
+// Untouched rows equal the background, which is only empty if it is 0
+inline uint64_t touched_bands(const RowBands& bands) {
+    return bands.background ? RowBands::ALL : bands.bands;
+}
+
+/**
+ * Call fn(begin, end) for each piece of the runs [a0, a1) not covered by [b0, b1)
+ *
+ * The first overlapping run of b is binary searched per run of a, so the
+ * cost follows a's runs, not b's.
+ */
+template <typename Fn>
+void for_each_andnot(const RunFrame::Run* a0, const RunFrame::Run* a1,
+                     const RunFrame::Run* b0, const RunFrame::Run* b1, Fn&& fn) {
+    const RunFrame::Run* j = b0;
+    for (const RunFrame::Run* a = a0; a != a1; ++a) {
+        const int32_t begin = a->begin;
+        j = std::partition_point(j, b1, [begin](const RunFrame::Run& run) { return run.end <= begin; });
+        int32_t cursor = begin;
+        for (const RunFrame::Run* b = j; b != b1 && b->begin < a->end; ++b) {
+            if (b->begin > cursor) {
+                fn(cursor, b->begin);
+            }
+            cursor = std::max(cursor, b->end);
+        }
+        if (cursor < a->end) {
+            fn(cursor, a->end);
+        }
+    }
+}
+
+// Set bits [begin, end) of a packed row
+inline void set_bits(uint64_t* row, int32_t begin, int32_t end) {
+    const int first_word = begin >> 6;
+    const int last_word = (end - 1) >> 6;
+    const uint64_t first = ~uint64_t(0) << (begin & 63);
+    const uint64_t last = ~uint64_t(0) >> (63 - ((end - 1) & 63));
+    if (first_word == last_word) {
+        row[first_word] |= first & last;
+        return;
+    }
+    row[first_word] |= first;
+    for (int w = first_word + 1; w < last_word; ++w) {
+        row[w] = ~uint64_t(0);
+    }
+    row[last_word] |= last;
+}
+
+} // namespace
+
+void RunFrame::begin_rows(int width, int height) {
+    width_ = std::max(0, width);
+    height_ = std::max(0, height);
+    runs_.clear();
+    row_start_.assign(static_cast<size_t>(height_) + 1, 0);
+}
+
+void RunFrame::create(int width, int height) {
+    begin_rows(width, height);
+}
+
+void RunFrame::clear() {
+    runs_.clear();
+    std::fill(row_start_.begin(), row_start_.end(), 0);
+}
+
+void RunFrame::assign(const BinaryFrame& bits, const RowBands& bands) {
+    begin_rows(bits.width(), bits.height());
+    const uint64_t touched = touched_bands(bands);
+    const int words_per_row = bits.words_per_row();
+
+    for (int y = 0; y < height_; ++y) {
+        if (row_touched(touched, y)) {
+            const uint64_t* row = bits.row(y);
+            int32_t open = -1;   // Begin of a run continuing into the next word
+            for (int w = 0; w < words_per_row; ++w) {
+                const uint64_t word = row[w];
+                const int32_t base = w * 64;
+                if (word == 0) {
+                    if (open >= 0) {
+                        push(open, base);
+                        open = -1;
+                    }
+                    continue;
+                }
+                if (word == ~uint64_t(0)) {
+                    if (open < 0) open = base;
+                    continue;
+                }
+
+                // Alternate between the next set and the next clear bit
+                int pos = 0;
+                while (pos < 64) {
+                    if (open < 0) {
+                        const uint64_t rest = word >> pos;
+                        if (!rest) break;
+                        pos += BinaryFrame::lowest_set_bit(rest);
+                        open = base + pos;
+                    }
+                    const uint64_t gaps = ~word >> pos;
+                    if (!gaps) break;   // Runs into the next word
+                    pos += BinaryFrame::lowest_set_bit(gaps);
+                    push(open, base + pos);
+                    open = -1;
+                }
+            }
+            if (open >= 0) {
+                push(open, width_);   // Width a multiple of 64: no padding bit closed it
+            }
+        }
+        end_row(y);
+    }
+}
+
+bool RunFrame::assign_masked(const cv::Mat& mat, uint8_t bit_mask, const RowBands& bands, const BlockMap* blocks) {
+    if (mat.empty() || mat.depth() != CV_8U || bit_mask == 0) {
+        return false;
+    }
+
+    begin_rows(mat.cols, mat.rows);
+    if (blocks && !blocks->matches(width_, height_)) {
+        blocks = nullptr;
+    }
+    const uint64_t touched = touched_bands(bands);
+    const int step = mat.channels();
+    const uint64_t wide_mask = 0x0101010101010101ull * bit_mask;
+
+    for (int y = 0; y < height_; ++y) {
+        const int by = y >> BlockMap::ROW_SHIFT;
+        if (row_touched(touched, y) && (!blocks || blocks->row_any(by))) {
+            const uint8_t* src = mat.ptr<uint8_t>(y);
+            int32_t open = -1;
+            for (int32_t x = 0; x < width_;) {
+                // Empty block: a run ends at its left edge, none starts inside
+                if (blocks && (x & 63) == 0 && !blocks->block(x >> BlockMap::COL_SHIFT, by)) {
+                    if (open >= 0) {
+                        push(open, x);
+                        open = -1;
+                    }
+                    x += 64;
+                    continue;
+                }
+                // Single channel: skip 8 clear pixels per load between runs
+                if (step == 1 && open < 0 && x + 8 <= width_) {
+                    uint64_t chunk;
+                    std::memcpy(&chunk, src + x, sizeof(chunk));
+                    if (!(chunk & wide_mask)) {
+                        x += 8;
+                        continue;
+                    }
+                }
+                const bool set = (src[static_cast<size_t>(x) * step] & bit_mask) != 0;
+                if (set && open < 0) {
+                    open = x;
+                } else if (!set && open >= 0) {
+                    push(open, x);
+                    open = -1;
+                }
+                ++x;
+            }
+            if (open >= 0) {
+                push(open, width_);
+            }
+        }
+        end_row(y);
+    }
+    return true;
+}
+
+void RunFrame::to_binary(BinaryFrame& out) const {
+    if (out.size() != size()) {
+        out.create(width_, height_);
+    } else {
+        out.clear();
+    }
+    for (int y = 0; y < height_; ++y) {
+        uint64_t* row = out.row(y);
+        for (const Run* run = row_begin(y); run != row_end(y); ++run) {
+            set_bits(row, run->begin, run->end);
+        }
+    }
+}
+
+void RunFrame::to_mat(cv::Mat& out) const {
+    out.create(height_, width_, CV_8UC1);
+    out.setTo(0);
+    for (int y = 0; y < height_; ++y) {
+        uint8_t* row = out.ptr<uint8_t>(y);
+        for (const Run* run = row_begin(y); run != row_end(y); ++run) {
+            std::memset(row + run->begin, 255, static_cast<size_t>(run->end - run->begin));
+        }
+    }
+}
+
+int64_t RunFrame::count() const {
+    int64_t total = 0;
+    for (const Run& run : runs_) {
+        total += run.end - run.begin;
+    }
+    return total;
+}
+
+bool RunFrame::bitwise_andnot(const RunFrame& a, const RunFrame& b, RunFrame& out) {
+    if (a.size() != b.size() || &out == &a || &out == &b) {
+        return false;
+    }
+    out.begin_rows(a.width_, a.height_);
+    for (int y = 0; y < a.height_; ++y) {
+        for_each_andnot(a.row_begin(y), a.row_end(y), b.row_begin(y), b.row_end(y),
+                        [&out](int32_t begin, int32_t end) { out.push(begin, end); });
+        out.end_row(y);
+    }
+    return true;
+}
+
+bool RunFrame::bitwise_or(const RunFrame& a, const RunFrame& b, RunFrame& out) {
+    if (a.size() != b.size() || &out == &a || &out == &b) {
+        return false;
+    }
+    out.begin_rows(a.width_, a.height_);
+    for (int y = 0; y < a.height_; ++y) {
+        // Merge by begin, coalescing runs that overlap or touch
+        const Run* i = a.row_begin(y);
+        const Run* i_end = a.row_end(y);
+        const Run* j = b.row_begin(y);
+        const Run* j_end = b.row_end(y);
+        int32_t open = -1;
+        int32_t open_end = -1;
+        while (i != i_end || j != j_end) {
+            const Run& run = (j == j_end || (i != i_end && i->begin <= j->begin)) ? *i++ : *j++;
+            if (open >= 0 && run.begin <= open_end) {
+                open_end = std::max(open_end, run.end);
+                continue;
+            }
+            if (open >= 0) {
+                out.push(open, open_end);
+            }
+            open = run.begin;
+            open_end = run.end;
+        }
+        if (open >= 0) {
+            out.push(open, open_end);
+        }
+        out.end_row(y);
+    }
+    return true;
+}
+
+int64_t RunFrame::count_andnot(const RunFrame& a, const RunFrame& b) {
+    if (a.size() != b.size()) {
+        return -1;
+    }
+    int64_t total = 0;
+    for (int y = 0; y < a.height_; ++y) {
+        for_each_andnot(a.row_begin(y), a.row_end(y), b.row_begin(y), b.row_end(y),
+                        [&total](int32_t begin, int32_t end) { total += end - begin; });
+    }
+    return total;
+}
+
+bool RunFrame::overlap(const RunFrame& a, const RunFrame& b, BinaryFrame::Overlap& out) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    const int64_t count_a = a.count();
+    const int64_t count_b = b.count();
+    out.a_only = count_andnot(a, b);
+    out.both = count_a - out.a_only;
+    out.b_only = count_b - out.both;
+    out.neither = int64_t(a.width_) * a.height_ - count_a - out.b_only;
+    return true;
+}
+
+} // namespace video
@@ -0,0 +1,133 @@
+#include "video/scattering_event_tap.h"
+#include <algorithm>
+
+namespace video {
+
+void ScatteringEventTap::configure(int width, int height, uint32_t window_us) {
+    width_.store(width, std::memory_order_relaxed);
+    height_.store(height, std::memory_order_relaxed);
+    window_us_ = std::max<uint32_t>(1, window_us);
+    stamps_.assign(static_cast<size_t>(std::max(width, 0)) * std::max(height, 0), 0);
+    generation_ = 1;
+    restart_window();
+}
+
+void ScatteringEventTap::set_reference(std::shared_ptr<const BinaryFrame> reference) {
+    std::lock_guard<std::mutex> lock(reference_mutex_);
+    next_reference_ = std::move(reference);
+    reference_changed_.store(true, std::memory_order_release);
+}
+
+void ScatteringEventTap::restart_window() {
+    filling_.clear();
+    window_end_ts_ = -1;
+    if (++generation_ == 0) {
+        std::fill(stamps_.begin(), stamps_.end(), 0);
+        generation_ = 1;
+    }
+
+    // Pending windows belong to the old reference or geometry
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Window& window : pending_) {
+        window.keys.clear();
+        spare_.push_back(std::move(window.keys));
+    }
+    pending_.clear();
+}
+
+void ScatteringEventTap::push(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    if (reference_changed_.load(std::memory_order_acquire) &&
+        reference_changed_.exchange(false, std::memory_order_acquire)) {
+        {
+            std::lock_guard<std::mutex> lock(reference_mutex_);
+            reference_ = next_reference_;
+        }
+        restart_window();
+    }
+
+    const unsigned width = static_cast<unsigned>(width_.load(std::memory_order_relaxed));
+    const unsigned height = static_cast<unsigned>(height_.load(std::memory_order_relaxed));
+    if (begin == end || !reference_ || static_cast<unsigned>(reference_->width()) != width ||
+        static_cast<unsigned>(reference_->height()) != height) {
+        return;
+    }
+    if (window_end_ts_ < 0) {
+        // Same alignment as the frame generators
+        window_end_ts_ = (begin->t / window_us_ + 1) * window_us_;
+    }
+
+    const BinaryFrame& reference = *reference_;
+    uint16_t* stamps = stamps_.data();
+    const Metavision::EventCD* it = begin;
+    while (it != end) {
+        // Timestamps are non-decreasing, so the window boundary is a binary search
+        const int64_t window_end = window_end_ts_;
+        const Metavision::EventCD* split = std::partition_point(it, end,
+            [window_end](const Metavision::EventCD& ev) { return ev.t < window_end; });
+
+        for (; it != split; ++it) {
+            const unsigned x = static_cast<unsigned>(it->x);
+            const unsigned y = static_cast<unsigned>(it->y);
+            if (x >= width || y >= height || reference.get(static_cast<int>(x), static_cast<int>(y))) {
+                continue;
+            }
+            // Listed once per window however often the pixel fires
+            const uint32_t key = y * width + x;
+            if (stamps[key] != generation_) {
+                stamps[key] = generation_;
+                filling_.push_back(key);
+            }
+        }
+        if (split == end) {
+            break;
+        }
+
+        complete_window();
+        window_end_ts_ += window_us_;
+
+        // Skip over idle gaps: no empty window per gap period, as the frame generators do
+        if (split->t >= window_end_ts_) {
+            window_end_ts_ = (split->t / window_us_ + 1) * window_us_;
+        }
+    }
+}
+
+void ScatteringEventTap::complete_window() {
+    std::vector<uint32_t> next;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.size() >= MAX_PENDING) {
+            next.swap(pending_.front().keys);
+            pending_.pop_front();
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        } else if (!spare_.empty()) {
+            next.swap(spare_.back());
+            spare_.pop_back();
+        }
+        pending_.push_back(Window{std::move(filling_), window_end_ts_});
+    }
+    filling_.swap(next);
+    filling_.clear();
+
+    // A new generation unlists every pixel without touching the stamps
+    if (++generation_ == 0) {
+        std::fill(stamps_.begin(), stamps_.end(), 0);
+        generation_ = 1;
+    }
+}
+
+bool ScatteringEventTap::take(std::vector<uint32_t>& keys, Metavision::timestamp& window_end_ts) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.empty()) {
+        return false;
+    }
+    Window& window = pending_.front();
+    keys.swap(window.keys);
+    window_end_ts = window.end_ts;
+    window.keys.clear();
+    spare_.push_back(std::move(window.keys));
+    pending_.pop_front();
+    return true;
+}
+
+} // namespace video
@@ -0,0 +1,247 @@
+#include "video/shm_publisher.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace video {
+
+SharedMemoryPublisher::~SharedMemoryPublisher() {
+    stop();
+}
+
+bool SharedMemoryPublisher::map(const std::string& name, size_t bytes) {
+#ifdef _WIN32
+    const std::string mapping_name = "Local\\" + name;
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32),
+                                        static_cast<DWORD>(bytes & 0xFFFFFFFFu), mapping_name.c_str());
+    if (!mapping) {
+        return false;
+    }
+
+    // A mapping a reader still holds open keeps its original size
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    mapping_handle_ = mapping;
+    base_ = static_cast<uint8_t*>(view);
+#else
+    const std::string mapping_name = "/" + name;
+    int fd = shm_open(mapping_name.c_str(), O_CREAT | O_RDWR, 0666);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);  // The mapping keeps the object referenced
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    base_ = static_cast<uint8_t*>(view);
+#endif
+    size_ = bytes;
+    return true;
+}
+
+void SharedMemoryPublisher::unmap() {
+    if (!base_) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(base_);
+    CloseHandle(static_cast<HANDLE>(mapping_handle_));
+    mapping_handle_ = nullptr;
+#else
+    munmap(base_, size_);
+    shm_unlink(("/" + name_).c_str());  // Readers keep their mappings; new ones find nothing
+#endif
+    base_ = nullptr;
+    size_ = 0;
+}
+
+bool SharedMemoryPublisher::start(const Options& options) {
+    stop();
+
+    if (options.width <= 0 || options.height <= 0 || options.frame_slots <= 0 || options.name.empty()) {
+        std::cerr << "SharedMemoryPublisher: invalid options (" << options.width << "x" << options.height
+                  << ", " << options.frame_slots << " slots), not publishing" << std::endl;
+        return false;
+    }
+
+    const bool packed = options.packed;
+    const uint64_t stride = packed ? static_cast<uint64_t>((options.width + 63) / 64) * sizeof(uint64_t)
+                                   : static_cast<uint64_t>(options.width);
+    const uint64_t frame_slot_bytes = shm_ring::align_up(sizeof(shm_ring::SlotHeader) + stride * options.height);
+    const uint32_t event_slots = static_cast<uint32_t>(std::max(options.event_slots, 0));
+    const uint32_t slot_events = static_cast<uint32_t>(std::max(options.event_slot_events, 1));
+    const uint64_t event_slot_bytes = event_slots > 0
+        ? shm_ring::align_up(sizeof(shm_ring::SlotHeader) + sizeof(Metavision::EventCD) * slot_events) : 0;
+
+    const uint64_t frames_offset = shm_ring::align_up(sizeof(shm_ring::RingHeader));
+    const uint64_t events_offset = frames_offset + frame_slot_bytes * static_cast<uint64_t>(options.frame_slots);
+    const uint64_t total = events_offset + event_slot_bytes * event_slots;
+
+    name_ = options.name;
+    if (!map(options.name, static_cast<size_t>(total))) {
+        std::cerr << "SharedMemoryPublisher: cannot map " << options.name << " (" << total / (1024 * 1024)
+                  << " MiB)" << std::endl;
+        return false;
+    }
+
+    // Zero every slot (seq 0 = never written) before the header becomes valid
+    std::memset(base_, 0, size_);
+    header_ = new (base_) shm_ring::RingHeader();
+    header_->version = shm_ring::VERSION;
+    header_->header_bytes = sizeof(shm_ring::RingHeader);
+    header_->frame_slots = static_cast<uint32_t>(options.frame_slots);
+    header_->frame_format = packed ? shm_ring::FORMAT_PACKED : shm_ring::FORMAT_U8;
+    header_->frame_slot_bytes = frame_slot_bytes;
+    header_->frames_offset = frames_offset;
+    header_->event_slots = event_slots;
+    header_->event_slot_events = event_slots > 0 ? slot_events : 0;
+    header_->event_slot_bytes = event_slot_bytes;
+    header_->events_offset = events_offset;
+    header_->width = options.width;
+    header_->height = options.height;
+    header_->total_bytes = total;
+#ifdef _WIN32
+    header_->writer_pid = static_cast<uint32_t>(GetCurrentProcessId());
+#else
+    header_->writer_pid = static_cast<uint32_t>(getpid());
+#endif
+    for (uint32_t i = 0; i < header_->frame_slots; ++i) {
+        new (base_ + frames_offset + frame_slot_bytes * i) shm_ring::SlotHeader();
+    }
+    for (uint32_t i = 0; i < event_slots; ++i) {
+        new (base_ + events_offset + event_slot_bytes * i) shm_ring::SlotHeader();
+    }
+    header_->writer_open.store(1, std::memory_order_relaxed);
+    events_published_ = 0;
+
+    // Magic last: a reader that sees it sees the whole layout
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->magic, shm_ring::MAGIC, sizeof(shm_ring::MAGIC));
+
+    std::cout << "Shared memory: publishing " << (packed ? "packed" : "8-bit") << " frames to " << options.name
+              << " (" << options.frame_slots << " slots";
+    if (event_slots > 0) {
+        std::cout << ", " << event_slots << " event slots of " << slot_events << " events";
+    }
+    std::cout << ", " << total / 1024 << " KiB)" << std::endl;
+    return true;
+}
+
+void SharedMemoryPublisher::stop() {
+    if (!header_) {
+        return;
+    }
+    header_->writer_open.store(0, std::memory_order_release);
+    header_ = nullptr;
+    unmap();
+}
+
+shm_ring::SlotHeader* SharedMemoryPublisher::begin_write(std::atomic<uint64_t>& count, uint8_t* base,
+                                                         uint64_t slot_bytes, uint32_t slots) {
+    const uint64_t index = count.fetch_add(1, std::memory_order_relaxed);
+    auto* slot = reinterpret_cast<shm_ring::SlotHeader*>(base + slot_bytes * (index % slots));
+    slot->seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);  // Odd seq visible before any payload byte
+    slot->index = index;
+    return slot;
+}
+
+void SharedMemoryPublisher::end_write(shm_ring::SlotHeader* slot) {
+    slot->seq.store(2 * slot->index + 2, std::memory_order_release);
+}
+
+void SharedMemoryPublisher::publish_frame(int camera_index, int64_t timestamp_us, uint32_t window_us, int64_t events,
+                                          const cv::Mat& frame, const BinaryFrame* packed) {
+    if (!header_ || frame.empty() || frame.type() != CV_8UC1 ||
+        frame.cols > header_->width || frame.rows > header_->height) {
+        return;
+    }
+
+    const bool packed_format = header_->frame_format == shm_ring::FORMAT_PACKED;
+    if (packed_format && (!packed || packed->width() != frame.cols || packed->height() != frame.rows)) {
+        if (camera_index < 0 || camera_index >= MAX_CAMERAS) {
+            return;
+        }
+        scratch_[camera_index].assign(frame);
+        packed = &scratch_[camera_index];
+    }
+
+    shm_ring::SlotHeader* slot = begin_write(header_->frames_published, base_ + header_->frames_offset,
+                                             header_->frame_slot_bytes, header_->frame_slots);
+    uint8_t* payload = reinterpret_cast<uint8_t*>(slot + 1);
+    slot->timestamp_us = timestamp_us;
+    slot->events = events;
+    slot->camera_index = static_cast<uint32_t>(camera_index);
+    slot->window_us = window_us;
+    slot->width = frame.cols;
+    slot->height = frame.rows;
+    if (packed_format) {
+        const size_t bytes = packed->word_count() * sizeof(uint64_t);
+        slot->stride = static_cast<uint32_t>(packed->words_per_row() * sizeof(uint64_t));
+        slot->payload_bytes = static_cast<uint32_t>(bytes);
+        std::memcpy(payload, packed->data(), bytes);
+    } else {
+        const size_t row_bytes = static_cast<size_t>(frame.cols);
+        slot->stride = static_cast<uint32_t>(row_bytes);
+        slot->payload_bytes = static_cast<uint32_t>(row_bytes * frame.rows);
+        if (frame.isContinuous()) {
+            std::memcpy(payload, frame.data, row_bytes * frame.rows);
+        } else {
+            for (int y = 0; y < frame.rows; ++y) {
+                std::memcpy(payload + row_bytes * y, frame.ptr(y), row_bytes);
+            }
+        }
+    }
+    end_write(slot);
+}
+
+void SharedMemoryPublisher::publish_events(int camera_index, const Metavision::EventCD* begin,
+                                           const Metavision::EventCD* end) {
+    if (!header_ || header_->event_slots == 0) {
+        return;
+    }
+
+    const size_t capacity = header_->event_slot_events;
+    while (begin != end) {
+        const size_t count = std::min(capacity, static_cast<size_t>(end - begin));
+        shm_ring::SlotHeader* slot = begin_write(header_->events_published, base_ + header_->events_offset,
+                                                 header_->event_slot_bytes, header_->event_slots);
+        slot->timestamp_us = begin->t;
+        slot->events = static_cast<int64_t>(count);
+        slot->camera_index = static_cast<uint32_t>(camera_index);
+        slot->window_us = static_cast<uint32_t>(std::max<int64_t>(begin[count - 1].t - begin->t, 0));
+        slot->width = 0;
+        slot->height = 0;
+        slot->stride = 0;
+        slot->payload_bytes = static_cast<uint32_t>(count * sizeof(Metavision::EventCD));
+        std::memcpy(reinterpret_cast<uint8_t*>(slot + 1), begin, count * sizeof(Metavision::EventCD));
+        end_write(slot);
+        events_published_.fetch_add(count, std::memory_order_relaxed);
+        begin += count;
+    }
+}
+
+} // namespace video
@@ -0,0 +1,465 @@
+#include "video/simd_utils.h"
+
+// AVX2 kernels. Compiled with AVX2 enabled (see CMakeLists.txt) and only
+// called once get_cpu_features() reports it.
+#ifdef RTCAM_SIMD_X86
+
+#include "video/simd_kernels_x86.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+
+namespace video {
+namespace simd {
+namespace internal {
+
+//-----------------------------------------------------------------------------
+// BGR to Grayscale Conversion
+//-----------------------------------------------------------------------------
+
+// AVX2: Process 32 pixels at once
+void bgr_to_gray_avx2(const uint8_t* bgr, uint8_t* gray, size_t pixels) {
+    const __m256i wb = _mm256_set1_epi16(29);
+    const __m256i wg = _mm256_set1_epi16(150);
+    const __m256i wr = _mm256_set1_epi16(77);
+
+    size_t i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        __m256i y[2];
+        for (int half = 0; half < 2; ++half) {
+            __m128i b, g, r;
+            deinterleave_bgr_16(bgr + (i + half * 16) * 3, b, g, r);
+
+            // Widen 16 pixels to u16 and compute weighted sum
+            __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(b), wb),
+                                           _mm256_mullo_epi16(_mm256_cvtepu8_epi16(g), wg));
+            sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(_mm256_cvtepu8_epi16(r), wr));
+            y[half] = _mm256_srli_epi16(sum, 8);
+        }
+
+        // Pack to 8-bit (packus works per lane, permute restores order)
+        __m256i result = _mm256_permute4x64_epi64(_mm256_packus_epi16(y[0], y[1]), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(gray + i), result);
+    }
+
+    // Handle remaining pixels with SSE/scalar
+    bgr_to_gray_sse41(bgr + i * 3, gray + i, pixels - i);
+}
+
+//-----------------------------------------------------------------------------
+// Range Filter
+//-----------------------------------------------------------------------------
+
+// Unsigned in-range test: (x - low) <= (high - low), wrap-around safe for any bounds
+static inline __m256i in_range_avx2(__m256i data, __m256i vlow, __m256i vspan) {
+    __m256i d = _mm256_sub_epi8(data, vlow);
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(d, vspan), d);
+}
+
+// AVX2: Process 32 pixels at once
+void range_filter_avx2(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t low, uint8_t high) {
+    if (low > high) {
+        range_filter_scalar(src, dst, pixels, low, high);  // Empty range
+        return;
+    }
+
+    const __m256i vlow = _mm256_set1_epi8(static_cast<char>(low));
+    const __m256i vspan = _mm256_set1_epi8(static_cast<char>(high - low));
+
+    size_t i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), in_range_avx2(data, vlow, vspan));
+    }
+
+    // Handle remaining with scalar
+    range_filter_scalar(src + i, dst + i, pixels - i, low, high);
+}
+
+//-----------------------------------------------------------------------------
+// Dual Range Filter (single pass, both ranges OR-ed in registers)
+//-----------------------------------------------------------------------------
+
+// AVX2: Process 32 pixels at once
+void dual_range_filter_avx2(const uint8_t* src, uint8_t* dst, size_t pixels,
+                            uint8_t low1, uint8_t high1, uint8_t low2, uint8_t high2) {
+    if (low1 > high1 || low2 > high2) {
+        dual_range_filter_scalar(src, dst, pixels, low1, high1, low2, high2);
+        return;
+    }
+
+    const __m256i vlow1 = _mm256_set1_epi8(static_cast<char>(low1));
+    const __m256i vspan1 = _mm256_set1_epi8(static_cast<char>(high1 - low1));
+    const __m256i vlow2 = _mm256_set1_epi8(static_cast<char>(low2));
+    const __m256i vspan2 = _mm256_set1_epi8(static_cast<char>(high2 - low2));
+
+    size_t i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i result = _mm256_or_si256(in_range_avx2(data, vlow1, vspan1),
+                                         in_range_avx2(data, vlow2, vspan2));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), result);
+    }
+
+    dual_range_filter_scalar(src + i, dst + i, pixels - i, low1, high1, low2, high2);
+}
+
+//-----------------------------------------------------------------------------
+// Fused Bit-Mask Extraction
+//-----------------------------------------------------------------------------
+
+// (v & mask) != 0 -> 0xFF, 32 pixels
+template <uint8_t Mask>
+static inline __m256i bit_test_32(__m256i v, uint8_t bit_mask) {
+    if constexpr (is_single_bit<Mask>()) {
+        constexpr int shift = single_bit_shift<Mask>();
+        const __m256i shifted = shift ? _mm256_slli_epi16(v, shift) : v;
+        return _mm256_cmpgt_epi8(_mm256_setzero_si256(), shifted);
+    } else {
+        const __m256i vmask = _mm256_set1_epi8(static_cast<char>(Mask ? Mask : bit_mask));
+        const __m256i is_zero = _mm256_cmpeq_epi8(_mm256_and_si256(v, vmask), _mm256_setzero_si256());
+        return _mm256_xor_si256(is_zero, _mm256_set1_epi8(-1));
+    }
+}
+
+// AVX2: Process 32 pixels at once (deinterleave per 128-bit lane, test in 256-bit)
+template <uint8_t Mask>
+static void bit_mask_bgr_avx2_t(const uint8_t* bgr, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    size_t i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        const __m128i lo = gather_channel0_16(bgr + i * 3);
+        const __m128i hi = gather_channel0_16(bgr + i * 3 + 48);
+        const __m256i ch0 = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), bit_test_32<Mask>(ch0, bit_mask));
+    }
+
+    // Handle remaining with SSE/scalar
+    bit_mask_bgr_sse41_t<Mask>(bgr + i * 3, dst + i, pixels - i, bit_mask);
+}
+
+// AVX2: Process 32 pixels at once
+template <uint8_t Mask>
+static void bit_mask_gray_avx2_t(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    size_t i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), bit_test_32<Mask>(data, bit_mask));
+    }
+
+    bit_mask_gray_scalar_t<Mask>(src + i, dst + i, pixels - i, bit_mask);
+}
+
+void bit_mask_bgr_avx2(const uint8_t* bgr, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    bit_mask_bgr_avx2_t<0>(bgr, dst, pixels, bit_mask);
+}
+
+void bit_mask_gray_avx2(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    bit_mask_gray_avx2_t<0>(src, dst, pixels, bit_mask);
+}
+
+template <size_t... Pairs>
+static constexpr std::array<BitMaskKernels, sizeof...(Pairs)> make_bit_mask_table(std::index_sequence<Pairs...>) {
+    return {{BitMaskKernels{bit_mask_bgr_avx2_t<pair_mask<Pairs>()>, bit_mask_gray_avx2_t<pair_mask<Pairs>()>}...}};
+}
+
+static constexpr auto BIT_MASK_TABLE = make_bit_mask_table(std::make_index_sequence<64>());
+
+const BitMaskKernels* fixed_bit_mask_avx2(uint8_t bit_mask) {
+    const int index = bit_pair_index(bit_mask);
+    return index < 0 ? nullptr : &BIT_MASK_TABLE[static_cast<size_t>(index)];
+}
+
+//-----------------------------------------------------------------------------
+// Bit-Plane Split
+//-----------------------------------------------------------------------------
+
+// 64 pixels in 2 x 32 (bit b shifted to bit 7, then VPMOVMSKB)
+template <size_t... Bits>
+static inline void store_planes_avx2(__m256i v0, __m256i v1, const PlaneRows& dst, size_t w,
+                                     std::index_sequence<Bits...>) {
+    ((dst.rows[Bits][w] = uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_slli_epi16(v0, 7 - Bits)))) |
+                          uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_slli_epi16(v1, 7 - Bits)))) << 32), ...);
+}
+
+// AVX2: 64 pixels per word (deinterleave per 128-bit lane)
+void bit_planes_bgr_avx2(const uint8_t* bgr, uint64_t* const* planes, size_t pixels) {
+    const PlaneRows rows(planes);
+    for_each_plane_word<3>(bgr, pixels, [&rows](const uint8_t* p, size_t w) {
+        const __m256i v0 = _mm256_inserti128_si256(_mm256_castsi128_si256(gather_channel0_16(p)),
+                                                   gather_channel0_16(p + 48), 1);
+        const __m256i v1 = _mm256_inserti128_si256(_mm256_castsi128_si256(gather_channel0_16(p + 96)),
+                                                   gather_channel0_16(p + 144), 1);
+        store_planes_avx2(v0, v1, rows, w, PlaneBits());
+    });
+}
+
+// AVX2: 64 pixels per word
+void bit_planes_gray_avx2(const uint8_t* src, uint64_t* const* planes, size_t pixels) {
+    const PlaneRows rows(planes);
+    for_each_plane_word<1>(src, pixels, [&rows](const uint8_t* p, size_t w) {
+        const __m256i* v = reinterpret_cast<const __m256i*>(p);
+        store_planes_avx2(_mm256_loadu_si256(v), _mm256_loadu_si256(v + 1), rows, w, PlaneBits());
+    });
+}
+
+//-----------------------------------------------------------------------------
+// Masked Histogram
+//-----------------------------------------------------------------------------
+
+void masked_histogram_avx2(const uint8_t* src, const uint8_t* mask, size_t pixels, uint32_t* banks) {
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 32 <= pixels; i += 32) {
+        __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask + i));
+        uint32_t outside = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(m, zero)));
+        masked_histogram_block(src + i, 32, ~outside, 0xFFFFFFFFu, banks);
+    }
+
+    masked_histogram_scalar(src + i, mask + i, pixels - i, banks);
+}
+
+//-----------------------------------------------------------------------------
+// Frame Difference
+//-----------------------------------------------------------------------------
+
+// AVX2: Process 32 pixels at once
+void frame_difference_avx2(const uint8_t* cur, const uint8_t* prev, uint8_t* dst, size_t pixels) {
+    const __m256i ones = _mm256_set1_epi8(-1);
+
+    size_t i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + i));
+        __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_avg_epu8(c, _mm256_xor_si256(p, ones)));
+    }
+
+    frame_difference_sse41(cur + i, prev + i, dst + i, pixels - i);
+}
+
+//-----------------------------------------------------------------------------
+// Masked Integral Images
+//-----------------------------------------------------------------------------
+
+// Inclusive prefix sum of 8 uint32 lanes
+static inline __m256i prefix_sum_8(__m256i x) {
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+    // Shifts stay inside 128-bit lanes: add the low lane's total to the high lane
+    const __m256i low_total = _mm256_permutevar8x32_epi32(x, _mm256_set1_epi32(3));
+    return _mm256_add_epi32(x, _mm256_blend_epi32(_mm256_setzero_si256(), low_total, 0xF0));
+}
+
+// AVX2: Process 8 pixels at once (32-bit lanes for value, square and count)
+void masked_integral_row_avx2(const uint8_t* src, const uint8_t* mask, size_t pixels,
+                              const IntegralRow& above, const IntegralRow& row) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i last = _mm256_set1_epi32(7);
+    __m256i run_sum = zero;     // Row totals so far, broadcast
+    __m256i run_sq = zero;
+    __m256i run_count = zero;
+
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        const __m256i m = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(mask + i)));
+        const __m256i inside = _mm256_xor_si256(_mm256_cmpeq_epi32(m, zero), _mm256_set1_epi32(-1));
+        const __m256i v = _mm256_and_si256(
+            _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i))), inside);
+
+        const __m256i sum = _mm256_add_epi32(prefix_sum_8(v), run_sum);
+        const __m256i sq = _mm256_add_epi32(prefix_sum_8(_mm256_mullo_epi32(v, v)), run_sq);
+        const __m256i count = _mm256_add_epi32(prefix_sum_8(_mm256_srli_epi32(inside, 31)), run_count);
+        run_sum = _mm256_permutevar8x32_epi32(sum, last);
+        run_sq = _mm256_permutevar8x32_epi32(sq, last);
+        run_count = _mm256_permutevar8x32_epi32(count, last);
+
+        // Add the row above
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row.sum + i),
+            _mm256_add_epi32(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(above.sum + i))));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row.count + i),
+            _mm256_add_epi32(count, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(above.count + i))));
+        // Row square sums stay below 2^31 (at most 32768 columns), so the signed conversion is exact
+        _mm256_storeu_pd(row.sum_sq + i, _mm256_add_pd(_mm256_loadu_pd(above.sum_sq + i),
+                                                       _mm256_cvtepi32_pd(_mm256_castsi256_si128(sq))));
+        _mm256_storeu_pd(row.sum_sq + i + 4, _mm256_add_pd(_mm256_loadu_pd(above.sum_sq + i + 4),
+                                                           _mm256_cvtepi32_pd(_mm256_extracti128_si256(sq, 1))));
+    }
+
+    // Handle remaining pixels with scalar
+    masked_integral_row_from(src, mask, i, pixels, above, row,
+                             static_cast<uint32_t>(_mm_cvtsi128_si32(_mm256_castsi256_si128(run_sum))),
+                             static_cast<uint32_t>(_mm_cvtsi128_si32(_mm256_castsi256_si128(run_sq))),
+                             static_cast<uint32_t>(_mm_cvtsi128_si32(_mm256_castsi256_si128(run_count))));
+}
+
+//-----------------------------------------------------------------------------
+// Event Batch Statistics
+//-----------------------------------------------------------------------------
+
+static_assert(sizeof(Metavision::EventCD) == 16 && offsetof(Metavision::EventCD, t) == 8,
+              "event_stats_avx2 expects x, y, p in the low quadword and t in the high one");
+
+// AVX2: 8 events (128 bytes) per iteration
+void event_stats_avx2(const Metavision::EventCD* events, size_t count, EventStats& stats,
+                      uint32_t* row_counts, int row_count) {
+    const __m256i on_bit = _mm256_set1_epi64x(int64_t(1) << 32);   // Bit 0 of p
+    __m256i coord_min = _mm256_set1_epi16(-1);
+    __m256i coord_max = _mm256_setzero_si256();
+    __m256i t_min = _mm256_set1_epi64x(std::numeric_limits<int64_t>::max());
+    __m256i t_max = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+    __m256i on = _mm256_setzero_si256();
+    alignas(32) uint64_t coords[8];
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i* src = reinterpret_cast<const __m256i*>(events + i);
+        const __m256i e01 = _mm256_loadu_si256(src);
+        const __m256i e23 = _mm256_loadu_si256(src + 1);
+        const __m256i e45 = _mm256_loadu_si256(src + 2);
+        const __m256i e67 = _mm256_loadu_si256(src + 3);
+
+        // Per 128-bit lane: low quadwords (x, y, p) and high quadwords (t) of two events
+        const __m256i c0 = _mm256_unpacklo_epi64(e01, e23);
+        const __m256i c1 = _mm256_unpacklo_epi64(e45, e67);
+        const __m256i t0 = _mm256_unpackhi_epi64(e01, e23);
+        const __m256i t1 = _mm256_unpackhi_epi64(e45, e67);
+
+        // x and y keep to their own 16-bit slots; p and padding slots are ignored at the end
+        coord_min = _mm256_min_epu16(coord_min, _mm256_min_epu16(c0, c1));
+        coord_max = _mm256_max_epu16(coord_max, _mm256_max_epu16(c0, c1));
+        on = _mm256_add_epi64(on, _mm256_add_epi64(_mm256_and_si256(c0, on_bit), _mm256_and_si256(c1, on_bit)));
+
+        const __m256i t_lo = _mm256_blendv_epi8(t0, t1, _mm256_cmpgt_epi64(t0, t1));   // min(t0, t1)
+        const __m256i t_hi = _mm256_blendv_epi8(t1, t0, _mm256_cmpgt_epi64(t0, t1));   // max(t0, t1)
+        t_min = _mm256_blendv_epi8(t_min, t_lo, _mm256_cmpgt_epi64(t_min, t_lo));
+        t_max = _mm256_blendv_epi8(t_max, t_hi, _mm256_cmpgt_epi64(t_hi, t_max));
+
+        if (row_counts) {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(coords), c0);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(coords + 4), c1);
+            for (uint64_t c : coords) {
+                const uint16_t y = static_cast<uint16_t>(c >> 16);
+                if (y < row_count) {
+                    ++row_counts[y];
+                }
+            }
+        }
+    }
+
+    if (i > 0) {
+        alignas(32) uint16_t mins[16];
+        alignas(32) uint16_t maxs[16];
+        alignas(32) int64_t t_mins[4];
+        alignas(32) int64_t t_maxs[4];
+        alignas(32) uint64_t ons[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(mins), coord_min);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(maxs), coord_max);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(t_mins), t_min);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(t_maxs), t_max);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(ons), on);
+
+        EventStats vector_stats;
+        vector_stats.events = i;
+        for (int q = 0; q < 4; ++q) {
+            vector_stats.x_min = std::min(vector_stats.x_min, mins[q * 4]);
+            vector_stats.y_min = std::min(vector_stats.y_min, mins[q * 4 + 1]);
+            vector_stats.x_max = std::max(vector_stats.x_max, maxs[q * 4]);
+            vector_stats.y_max = std::max(vector_stats.y_max, maxs[q * 4 + 1]);
+            vector_stats.t_min = std::min(vector_stats.t_min, t_mins[q]);
+            vector_stats.t_max = std::max(vector_stats.t_max, t_maxs[q]);
+            vector_stats.on_events += ons[q] >> 32;
+        }
+        stats.merge(vector_stats);
+    }
+
+    // Handle remaining events with scalar
+    event_stats_scalar(events + i, count - i, stats, row_counts, row_count);
+}
+
+//-----------------------------------------------------------------------------
+// Bit-Packed Frame Algebra
+//-----------------------------------------------------------------------------
+
+// f(a, b, c) on 4 words: ternary_word's selects, on lanes spread from the table
+template <typename Table>
+static inline __m256i ternary_avx2(__m256i a, __m256i b, __m256i c, Table table) {
+    auto lane = [table](int i) { return _mm256_set1_epi64x(static_cast<long long>(table_lane(table, i))); };
+    auto select = [](__m256i s, __m256i one, __m256i zero) {
+        return _mm256_or_si256(_mm256_and_si256(s, one), _mm256_andnot_si256(s, zero));
+    };
+    const __m256i f00 = select(c, lane(1), lane(0));
+    const __m256i f01 = select(c, lane(3), lane(2));
+    const __m256i f10 = select(c, lane(5), lane(4));
+    const __m256i f11 = select(c, lane(7), lane(6));
+    return select(a, select(b, f11, f10), select(b, f01, f00));
+}
+
+static inline __m256i load_words_avx2(const uint64_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+namespace {
+
+// Harley-Seal operations on 4 x 64-bit lanes
+struct HarleySealAvx2 {
+    using Vector = __m256i;
+
+    static __m256i zero() { return _mm256_setzero_si256(); }
+
+    static void csa(__m256i& high, __m256i& low, __m256i a, __m256i b, __m256i c) {
+        const __m256i u = _mm256_xor_si256(a, b);
+        high = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+        low = _mm256_xor_si256(u, c);
+    }
+
+    // PSHUFB looks up each nibble's bit count, PSADBW sums the 8 bytes of every lane
+    static __m256i popcount(__m256i v) {
+        const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+        const __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, nibble));
+        const __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+        return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+    }
+
+    static __m256i add(__m256i x, __m256i y) { return _mm256_add_epi64(x, y); }
+
+    static int64_t sum(__m256i v) {
+        const __m128i pair = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        return _mm_cvtsi128_si64(pair) + _mm_extract_epi64(pair, 1);
+    }
+};
+
+} // namespace
+
+// AVX2: 4 words per step
+void bitwise_ternary_avx2(const uint64_t* a, const uint64_t* b, const uint64_t* c, uint64_t* out,
+                          size_t words, uint8_t table) {
+    with_fixed_table(table, [&](auto t) {
+        size_t i = 0;
+        for (; i + 4 <= words; i += 4) {
+            const __m256i r = ternary_avx2(load_words_avx2(a + i), load_words_avx2(b + i), load_words_avx2(c + i), t);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+        }
+        bitwise_ternary_from(a, b, c, out, i, words, t);
+    });
+}
+
+// AVX2: Harley-Seal over f(a, b, c), 16 vectors (64 words) per tree
+int64_t count_ternary_avx2(const uint64_t* a, const uint64_t* b, const uint64_t* c, size_t words,
+                           uint8_t table) {
+    return with_fixed_table(table, [&](auto t) {
+        const size_t vectors = words / 4;
+        const int64_t total = harley_seal<HarleySealAvx2>(vectors, [&](size_t v) {
+            return ternary_avx2(load_words_avx2(a + v * 4), load_words_avx2(b + v * 4), load_words_avx2(c + v * 4), t);
+        });
+        return total + count_ternary_from(a, b, c, vectors * 4, words, t);
+    });
+}
+
+} // namespace internal
+} // namespace simd
+} // namespace video
+
+#endif // RTCAM_SIMD_X86
@@ -0,0 +1,169 @@
+#include "video/simd_utils.h"
+
+// AVX-512BW kernels. Compiled with AVX-512F/BW enabled (see CMakeLists.txt)
+// and only called once get_cpu_features() reports AVX-512BW.
+#ifdef RTCAM_SIMD_X86
+
+#include "video/simd_kernels_avx512.h"
+
+namespace video {
+namespace simd {
+namespace internal {
+
+//-----------------------------------------------------------------------------
+// BGR to Grayscale Conversion
+//-----------------------------------------------------------------------------
+
+// AVX-512BW: Process 64 pixels at once
+void bgr_to_gray_avx512(const uint8_t* bgr, uint8_t* gray, size_t pixels) {
+    const __m512i wb = _mm512_set1_epi16(29);
+    const __m512i wg = _mm512_set1_epi16(150);
+    const __m512i wr = _mm512_set1_epi16(77);
+    const __m512i pack_order = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
+
+    size_t i = 0;
+    for (; i + 64 <= pixels; i += 64) {
+        __m512i y[2];
+        for (int half = 0; half < 2; ++half) {
+            const uint8_t* src = bgr + (i + half * 32) * 3;
+            __m128i b0, g0, r0, b1, g1, r1;
+            deinterleave_bgr_16(src, b0, g0, r0);
+            deinterleave_bgr_16(src + 48, b1, g1, r1);
+
+            // 32 pixels per channel, widened to u16
+            __m512i b = _mm512_cvtepu8_epi16(_mm256_inserti128_si256(_mm256_castsi128_si256(b0), b1, 1));
+            __m512i g = _mm512_cvtepu8_epi16(_mm256_inserti128_si256(_mm256_castsi128_si256(g0), g1, 1));
+            __m512i r = _mm512_cvtepu8_epi16(_mm256_inserti128_si256(_mm256_castsi128_si256(r0), r1, 1));
+
+            __m512i sum = _mm512_add_epi16(_mm512_mullo_epi16(b, wb), _mm512_mullo_epi16(g, wg));
+            sum = _mm512_add_epi16(sum, _mm512_mullo_epi16(r, wr));
+            y[half] = _mm512_srli_epi16(sum, 8);
+        }
+
+        // packus interleaves 128-bit lanes of both inputs; reorder 64-bit chunks
+        __m512i result = _mm512_permutexvar_epi64(pack_order, _mm512_packus_epi16(y[0], y[1]));
+        _mm512_storeu_si512(reinterpret_cast<void*>(gray + i), result);
+    }
+
+    // Handle remaining pixels with AVX2/SSE/scalar
+    bgr_to_gray_avx2(bgr + i * 3, gray + i, pixels - i);
+}
+
+//-----------------------------------------------------------------------------
+// Dual Range Filter (single pass, both ranges OR-ed in registers)
+//-----------------------------------------------------------------------------
+
+// AVX-512BW: Process 64 pixels at once (compare into mask registers)
+void dual_range_filter_avx512(const uint8_t* src, uint8_t* dst, size_t pixels,
+                              uint8_t low1, uint8_t high1, uint8_t low2, uint8_t high2) {
+    if (low1 > high1 || low2 > high2) {
+        dual_range_filter_scalar(src, dst, pixels, low1, high1, low2, high2);
+        return;
+    }
+
+    const __m512i vlow1 = _mm512_set1_epi8(static_cast<char>(low1));
+    const __m512i vspan1 = _mm512_set1_epi8(static_cast<char>(high1 - low1));
+    const __m512i vlow2 = _mm512_set1_epi8(static_cast<char>(low2));
+    const __m512i vspan2 = _mm512_set1_epi8(static_cast<char>(high2 - low2));
+
+    size_t i = 0;
+    for (; i + 64 <= pixels; i += 64) {
+        __m512i data = _mm512_loadu_si512(reinterpret_cast<const void*>(src + i));
+        __mmask64 in1 = _mm512_cmple_epu8_mask(_mm512_sub_epi8(data, vlow1), vspan1);
+        __mmask64 in2 = _mm512_cmple_epu8_mask(_mm512_sub_epi8(data, vlow2), vspan2);
+        _mm512_storeu_si512(reinterpret_cast<void*>(dst + i), _mm512_movm_epi8(in1 | in2));
+    }
+
+    dual_range_filter_avx2(src + i, dst + i, pixels - i, low1, high1, low2, high2);
+}
+
+//-----------------------------------------------------------------------------
+// Bit-Plane Split
+//-----------------------------------------------------------------------------
+
+// 64 pixels in 1 x 64, VPTESTMB straight into the plane word
+template <size_t... Bits>
+static inline void store_planes_avx512(__m512i v, const PlaneRows& dst, size_t w, std::index_sequence<Bits...>) {
+    ((dst.rows[Bits][w] = _mm512_test_epi8_mask(v, _mm512_set1_epi8(static_cast<char>(1 << Bits)))), ...);
+}
+
+// AVX-512BW: 64 pixels per word
+void bit_planes_gray_avx512(const uint8_t* src, uint64_t* const* planes, size_t pixels) {
+    const PlaneRows rows(planes);
+    for_each_plane_word<1>(src, pixels, [&rows](const uint8_t* p, size_t w) {
+        store_planes_avx512(_mm512_loadu_si512(reinterpret_cast<const void*>(p)), rows, w, PlaneBits());
+    });
+}
+
+//-----------------------------------------------------------------------------
+// Bit-Packed Frame Algebra
+//-----------------------------------------------------------------------------
+
+namespace {
+
+// Harley-Seal operations on 8 x 64-bit lanes; both adder outputs are one VPTERNLOGQ
+struct HarleySealAvx512 {
+    using Vector = __m512i;
+
+    static __m512i zero() { return _mm512_setzero_si512(); }
+
+    static void csa(__m512i& high, __m512i& low, __m512i a, __m512i b, __m512i c) {
+        high = _mm512_ternarylogic_epi64(a, b, c, 0xE8);   // Majority
+        low = _mm512_ternarylogic_epi64(a, b, c, 0x96);    // a ^ b ^ c
+    }
+
+    // VPSHUFB nibble lookup and VPSADBW, as on AVX2 (VPOPCNTQ needs AVX512_VPOPCNTDQ)
+    static __m512i popcount(__m512i v) {
+        const __m512i lookup = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+        const __m512i nibble = _mm512_set1_epi8(0x0F);
+        const __m512i lo = _mm512_shuffle_epi8(lookup, _mm512_and_si512(v, nibble));
+        const __m512i hi = _mm512_shuffle_epi8(lookup, _mm512_and_si512(_mm512_srli_epi16(v, 4), nibble));
+        return _mm512_sad_epu8(_mm512_add_epi8(lo, hi), _mm512_setzero_si512());
+    }
+
+    static __m512i add(__m512i x, __m512i y) { return _mm512_add_epi64(x, y); }
+    static int64_t sum(__m512i v) { return _mm512_reduce_add_epi64(v); }
+};
+
+} // namespace
+
+// AVX-512: 8 words per VPTERNLOGQ, the tail under a lane mask
+void bitwise_ternary_avx512(const uint64_t* a, const uint64_t* b, const uint64_t* c, uint64_t* out,
+                            size_t words, uint8_t table) {
+    with_fixed_table(table, [&](auto t) {
+        size_t i = 0;
+        for (; i + 8 <= words; i += 8) {
+            const __m512i r = ternary_avx512(load_words_avx512(a + i), load_words_avx512(b + i),
+                                             load_words_avx512(c + i), t);
+            _mm512_storeu_si512(reinterpret_cast<void*>(out + i), r);
+        }
+        if (i < words) {
+            const __mmask8 lanes = static_cast<__mmask8>((1u << (words - i)) - 1);
+            _mm512_mask_storeu_epi64(out + i, lanes, ternary_tail_avx512(a + i, b + i, c + i, lanes, t));
+        }
+    });
+}
+
+// AVX-512BW: Harley-Seal over f(a, b, c), 16 vectors (128 words) per tree
+int64_t count_ternary_avx512(const uint64_t* a, const uint64_t* b, const uint64_t* c, size_t words,
+                             uint8_t table) {
+    return with_fixed_table(table, [&](auto t) {
+        const size_t vectors = words / 8;
+        int64_t total = harley_seal<HarleySealAvx512>(vectors, [&](size_t v) {
+            return ternary_avx512(load_words_avx512(a + v * 8), load_words_avx512(b + v * 8),
+                                  load_words_avx512(c + v * 8), t);
+        });
+        const size_t i = vectors * 8;
+        if (i < words) {
+            const __mmask8 lanes = static_cast<__mmask8>((1u << (words - i)) - 1);
+            total += HarleySealAvx512::sum(HarleySealAvx512::popcount(ternary_tail_avx512(a + i, b + i, c + i, lanes, t)));
+        }
+        return total;
+    });
+}
+
+} // namespace internal
+} // namespace simd
+} // namespace video
+
+#endif // RTCAM_SIMD_X86
@@ -0,0 +1,44 @@
+#include "video/simd_utils.h"
+
+// AVX512_VPOPCNTDQ kernels. Compiled with AVX-512F/BW and VPOPCNTDQ enabled
+// (see CMakeLists.txt) and only called once get_cpu_features() reports
+// has_avx512vpopcntdq; CPUs with AVX-512BW alone run simd_avx512.cpp.
+#ifdef RTCAM_SIMD_X86
+
+#include "video/simd_kernels_avx512.h"
+
+namespace video {
+namespace simd {
+namespace internal {
+
+//-----------------------------------------------------------------------------
+// Bit-Packed Frame Algebra
+//-----------------------------------------------------------------------------
+
+// One VPTERNLOGQ and one VPOPCNTQ per 8 words; two accumulators hide the add latency
+int64_t count_ternary_avx512_vpopcnt(const uint64_t* a, const uint64_t* b, const uint64_t* c, size_t words,
+                                     uint8_t table) {
+    return with_fixed_table(table, [&](auto t) {
+        __m512i sum0 = _mm512_setzero_si512();
+        __m512i sum1 = _mm512_setzero_si512();
+        size_t i = 0;
+        for (; i + 16 <= words; i += 16) {
+            sum0 = _mm512_add_epi64(sum0, _mm512_popcnt_epi64(ternary_avx512(
+                load_words_avx512(a + i), load_words_avx512(b + i), load_words_avx512(c + i), t)));
+            sum1 = _mm512_add_epi64(sum1, _mm512_popcnt_epi64(ternary_avx512(
+                load_words_avx512(a + i + 8), load_words_avx512(b + i + 8), load_words_avx512(c + i + 8), t)));
+        }
+        for (; i < words; i += 8) {
+            const size_t n = words - i < 8 ? words - i : 8;
+            const __mmask8 lanes = static_cast<__mmask8>((1u << n) - 1);
+            sum0 = _mm512_add_epi64(sum0, _mm512_popcnt_epi64(ternary_tail_avx512(a + i, b + i, c + i, lanes, t)));
+        }
+        return static_cast<int64_t>(_mm512_reduce_add_epi64(_mm512_add_epi64(sum0, sum1)));
+    });
+}
+
+} // namespace internal
+} // namespace simd
+} // namespace video
+
+#endif // RTCAM_SIMD_X86
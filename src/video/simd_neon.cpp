@@ -0,0 +1,187 @@
+#include "video/simd_utils.h"
+
+// AArch64 NEON kernels. Advanced SIMD is part of the AArch64 baseline, so
+// this unit needs no extra compile flags and the NEON tier is always present.
+#ifdef RTCAM_SIMD_NEON
+
+#include "video/simd_kernels.h"
+#include <arm_neon.h>
+
+namespace video {
+namespace simd {
+namespace internal {
+
+//-----------------------------------------------------------------------------
+// BGR to Grayscale Conversion
+//-----------------------------------------------------------------------------
+
+// NEON: Process 16 pixels at once (VLD3 deinterleaves, widening multiply-accumulate)
+void bgr_to_gray_neon(const uint8_t* bgr, uint8_t* gray, size_t pixels) {
+    const uint8x8_t wb = vdup_n_u8(29);
+    const uint8x8_t wg = vdup_n_u8(150);
+    const uint8x8_t wr = vdup_n_u8(77);
+
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        const uint8x16x3_t v = vld3q_u8(bgr + i * 3);
+
+        // Max value 256*255 fits u16, so the wrapping sum matches the scalar formula exactly
+        uint16x8_t lo = vmull_u8(vget_low_u8(v.val[0]), wb);
+        lo = vmlal_u8(lo, vget_low_u8(v.val[1]), wg);
+        lo = vmlal_u8(lo, vget_low_u8(v.val[2]), wr);
+        uint16x8_t hi = vmull_u8(vget_high_u8(v.val[0]), wb);
+        hi = vmlal_u8(hi, vget_high_u8(v.val[1]), wg);
+        hi = vmlal_u8(hi, vget_high_u8(v.val[2]), wr);
+
+        vst1q_u8(gray + i, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+    }
+
+    // Handle remaining pixels with scalar
+    bgr_to_gray_scalar(bgr + i * 3, gray + i, pixels - i);
+}
+
+//-----------------------------------------------------------------------------
+// Range Filter
+//-----------------------------------------------------------------------------
+
+// Unsigned in-range test: (x - low) <= (high - low), wrap-around safe for any bounds
+static inline uint8x16_t in_range_neon(uint8x16_t data, uint8x16_t vlow, uint8x16_t vspan) {
+    return vcleq_u8(vsubq_u8(data, vlow), vspan);
+}
+
+// NEON: Process 16 pixels at once
+void range_filter_neon(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t low, uint8_t high) {
+    if (low > high) {
+        range_filter_scalar(src, dst, pixels, low, high);  // Empty range
+        return;
+    }
+
+    const uint8x16_t vlow = vdupq_n_u8(low);
+    const uint8x16_t vspan = vdupq_n_u8(static_cast<uint8_t>(high - low));
+
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        vst1q_u8(dst + i, in_range_neon(vld1q_u8(src + i), vlow, vspan));
+    }
+
+    // Handle remaining with scalar
+    range_filter_scalar(src + i, dst + i, pixels - i, low, high);
+}
+
+//-----------------------------------------------------------------------------
+// Dual Range Filter (single pass, both ranges OR-ed in registers)
+//-----------------------------------------------------------------------------
+
+// NEON: Process 16 pixels at once
+void dual_range_filter_neon(const uint8_t* src, uint8_t* dst, size_t pixels,
+                            uint8_t low1, uint8_t high1, uint8_t low2, uint8_t high2) {
+    if (low1 > high1 || low2 > high2) {
+        dual_range_filter_scalar(src, dst, pixels, low1, high1, low2, high2);
+        return;
+    }
+
+    const uint8x16_t vlow1 = vdupq_n_u8(low1);
+    const uint8x16_t vspan1 = vdupq_n_u8(static_cast<uint8_t>(high1 - low1));
+    const uint8x16_t vlow2 = vdupq_n_u8(low2);
+    const uint8x16_t vspan2 = vdupq_n_u8(static_cast<uint8_t>(high2 - low2));
+
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        const uint8x16_t data = vld1q_u8(src + i);
+        vst1q_u8(dst + i, vorrq_u8(in_range_neon(data, vlow1, vspan1), in_range_neon(data, vlow2, vspan2)));
+    }
+
+    dual_range_filter_scalar(src + i, dst + i, pixels - i, low1, high1, low2, high2);
+}
+
+//-----------------------------------------------------------------------------
+// Fused Bit-Mask Extraction
+//-----------------------------------------------------------------------------
+
+// VTST is (v & mask) != 0 -> 0xFF in one instruction for any mask, so NEON
+// has no fixed-mask variants: an immediate would save nothing.
+
+// NEON: Process 16 pixels at once (VLD3 leaves channel 0 in its own register)
+void bit_mask_bgr_neon(const uint8_t* bgr, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    const uint8x16_t vmask = vdupq_n_u8(bit_mask);
+
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        vst1q_u8(dst + i, vtstq_u8(vld3q_u8(bgr + i * 3).val[0], vmask));
+    }
+
+    bit_mask_bgr_scalar_t<0>(bgr + i * 3, dst + i, pixels - i, bit_mask);
+}
+
+// NEON: Process 16 pixels at once
+void bit_mask_gray_neon(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    const uint8x16_t vmask = vdupq_n_u8(bit_mask);
+
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        vst1q_u8(dst + i, vtstq_u8(vld1q_u8(src + i), vmask));
+    }
+
+    bit_mask_gray_scalar_t<0>(src + i, dst + i, pixels - i, bit_mask);
+}
+
+//-----------------------------------------------------------------------------
+// Bit-Plane Split
+//-----------------------------------------------------------------------------
+
+// NEON has no PMOVMSKB: each lane's test result is weighted by 1 << (lane % 8)
+// and three rounds of pairwise adds sum every 8 lanes into one byte, leaving
+// the 64 bits in pixel order in the low half of the register.
+static inline uint64_t movemask_64(uint8x16_t m0, uint8x16_t m1, uint8x16_t m2, uint8x16_t m3) {
+    static const uint8_t WEIGHTS[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t weights = vld1q_u8(WEIGHTS);
+    const uint8x16_t s01 = vpaddq_u8(vandq_u8(m0, weights), vandq_u8(m1, weights));
+    const uint8x16_t s23 = vpaddq_u8(vandq_u8(m2, weights), vandq_u8(m3, weights));
+    const uint8x16_t s = vpaddq_u8(s01, s23);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(vpaddq_u8(s, s)), 0);
+}
+
+// 64 pixels in 4 x 16, one VTST per plane and register
+template <size_t... Bits>
+static inline void store_planes_neon(uint8x16_t v0, uint8x16_t v1, uint8x16_t v2, uint8x16_t v3,
+                                     const PlaneRows& dst, size_t w, std::index_sequence<Bits...>) {
+    ((dst.rows[Bits][w] = movemask_64(vtstq_u8(v0, vdupq_n_u8(1 << Bits)), vtstq_u8(v1, vdupq_n_u8(1 << Bits)),
+                                      vtstq_u8(v2, vdupq_n_u8(1 << Bits)), vtstq_u8(v3, vdupq_n_u8(1 << Bits)))), ...);
+}
+
+// NEON: 64 pixels per word, channel 0 deinterleaved 16 at a time
+void bit_planes_bgr_neon(const uint8_t* bgr, uint64_t* const* planes, size_t pixels) {
+    const PlaneRows rows(planes);
+    for_each_plane_word<3>(bgr, pixels, [&rows](const uint8_t* p, size_t w) {
+        store_planes_neon(vld3q_u8(p).val[0], vld3q_u8(p + 48).val[0],
+                          vld3q_u8(p + 96).val[0], vld3q_u8(p + 144).val[0], rows, w, PlaneBits());
+    });
+}
+
+// NEON: 64 pixels per word
+void bit_planes_gray_neon(const uint8_t* src, uint64_t* const* planes, size_t pixels) {
+    const PlaneRows rows(planes);
+    for_each_plane_word<1>(src, pixels, [&rows](const uint8_t* p, size_t w) {
+        store_planes_neon(vld1q_u8(p), vld1q_u8(p + 16), vld1q_u8(p + 32), vld1q_u8(p + 48), rows, w, PlaneBits());
+    });
+}
+
+//-----------------------------------------------------------------------------
+// Frame Difference
+//-----------------------------------------------------------------------------
+
+// NEON: Process 16 pixels at once (VRHADD on the inverted previous frame, as PAVGB)
+void frame_difference_neon(const uint8_t* cur, const uint8_t* prev, uint8_t* dst, size_t pixels) {
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        vst1q_u8(dst + i, vrhaddq_u8(vld1q_u8(cur + i), vmvnq_u8(vld1q_u8(prev + i))));
+    }
+
+    frame_difference_scalar(cur + i, prev + i, dst + i, pixels - i);
+}
+
+} // namespace internal
+} // namespace simd
+} // namespace video
+
+#endif // RTCAM_SIMD_NEON
@@ -0,0 +1,201 @@
+#include "video/simd_utils.h"
+
+// SSE4.1 kernels. Compiled with SSE4.1 enabled (see CMakeLists.txt) and only
+// called once get_cpu_features() reports it.
+#ifdef RTCAM_SIMD_X86
+
+#include "video/simd_kernels_x86.h"
+#include <array>
+
+namespace video {
+namespace simd {
+namespace internal {
+
+//-----------------------------------------------------------------------------
+// BGR to Grayscale Conversion
+//-----------------------------------------------------------------------------
+
+// Weighted sum on 8 x u16 lanes. Max value 256*255 fits u16, so plain
+// (wrapping) add + logical shift matches the scalar formula exactly.
+static inline __m128i gray_u16_sse(__m128i b, __m128i g, __m128i r) {
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(29)),
+                                _mm_mullo_epi16(g, _mm_set1_epi16(150)));
+    sum = _mm_add_epi16(sum, _mm_mullo_epi16(r, _mm_set1_epi16(77)));
+    return _mm_srli_epi16(sum, 8);
+}
+
+// SSE4.1: Process 16 pixels at once
+void bgr_to_gray_sse41(const uint8_t* bgr, uint8_t* gray, size_t pixels) {
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        __m128i b, g, r;
+        deinterleave_bgr_16(bgr + i * 3, b, g, r);
+
+        __m128i lo = gray_u16_sse(_mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(g, zero), _mm_unpacklo_epi8(r, zero));
+        __m128i hi = gray_u16_sse(_mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(g, zero), _mm_unpackhi_epi8(r, zero));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(gray + i), _mm_packus_epi16(lo, hi));
+    }
+
+    // Handle remaining pixels with scalar
+    bgr_to_gray_scalar(bgr + i * 3, gray + i, pixels - i);
+}
+
+//-----------------------------------------------------------------------------
+// Range Filter
+//-----------------------------------------------------------------------------
+
+// Unsigned in-range test: (x - low) <= (high - low), wrap-around safe for any bounds
+static inline __m128i in_range_sse(__m128i data, __m128i vlow, __m128i vspan) {
+    __m128i d = _mm_sub_epi8(data, vlow);
+    return _mm_cmpeq_epi8(_mm_min_epu8(d, vspan), d);
+}
+
+// SSE4.1: Process 16 pixels at once
+void range_filter_sse41(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t low, uint8_t high) {
+    if (low > high) {
+        range_filter_scalar(src, dst, pixels, low, high);  // Empty range
+        return;
+    }
+
+    const __m128i vlow = _mm_set1_epi8(static_cast<char>(low));
+    const __m128i vspan = _mm_set1_epi8(static_cast<char>(high - low));
+
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), in_range_sse(data, vlow, vspan));
+    }
+
+    // Handle remaining with scalar
+    range_filter_scalar(src + i, dst + i, pixels - i, low, high);
+}
+
+//-----------------------------------------------------------------------------
+// Dual Range Filter (single pass, both ranges OR-ed in registers)
+//-----------------------------------------------------------------------------
+
+// SSE4.1: Process 16 pixels at once
+void dual_range_filter_sse41(const uint8_t* src, uint8_t* dst, size_t pixels,
+                             uint8_t low1, uint8_t high1, uint8_t low2, uint8_t high2) {
+    if (low1 > high1 || low2 > high2) {
+        dual_range_filter_scalar(src, dst, pixels, low1, high1, low2, high2);
+        return;
+    }
+
+    const __m128i vlow1 = _mm_set1_epi8(static_cast<char>(low1));
+    const __m128i vspan1 = _mm_set1_epi8(static_cast<char>(high1 - low1));
+    const __m128i vlow2 = _mm_set1_epi8(static_cast<char>(low2));
+    const __m128i vspan2 = _mm_set1_epi8(static_cast<char>(high2 - low2));
+
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i result = _mm_or_si128(in_range_sse(data, vlow1, vspan1),
+                                      in_range_sse(data, vlow2, vspan2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), result);
+    }
+
+    dual_range_filter_scalar(src + i, dst + i, pixels - i, low1, high1, low2, high2);
+}
+
+//-----------------------------------------------------------------------------
+// Fused Bit-Mask Extraction
+//-----------------------------------------------------------------------------
+
+void bit_mask_bgr_sse41(const uint8_t* bgr, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    bit_mask_bgr_sse41_t<0>(bgr, dst, pixels, bit_mask);
+}
+
+void bit_mask_gray_sse41(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    bit_mask_gray_sse41_t<0>(src, dst, pixels, bit_mask);
+}
+
+template <size_t... Pairs>
+static constexpr std::array<BitMaskKernels, sizeof...(Pairs)> make_bit_mask_table(std::index_sequence<Pairs...>) {
+    return {{BitMaskKernels{bit_mask_bgr_sse41_t<pair_mask<Pairs>()>, bit_mask_gray_sse41_t<pair_mask<Pairs>()>}...}};
+}
+
+static constexpr auto BIT_MASK_TABLE = make_bit_mask_table(std::make_index_sequence<64>());
+
+const BitMaskKernels* fixed_bit_mask_sse41(uint8_t bit_mask) {
+    const int index = bit_pair_index(bit_mask);
+    return index < 0 ? nullptr : &BIT_MASK_TABLE[static_cast<size_t>(index)];
+}
+
+//-----------------------------------------------------------------------------
+// Bit-Plane Split
+//-----------------------------------------------------------------------------
+
+// 64 pixels in 4 x 16: bit b of each byte is shifted to bit 7 (per 16-bit
+// lane, as in bit_test_16) and PMOVMSKB collects it
+template <size_t... Bits>
+static inline void store_planes_sse(__m128i v0, __m128i v1, __m128i v2, __m128i v3,
+                                    const PlaneRows& dst, size_t w, std::index_sequence<Bits...>) {
+    ((dst.rows[Bits][w] = uint64_t(uint32_t(_mm_movemask_epi8(_mm_slli_epi16(v0, 7 - Bits)))) |
+                          uint64_t(uint32_t(_mm_movemask_epi8(_mm_slli_epi16(v1, 7 - Bits)))) << 16 |
+                          uint64_t(uint32_t(_mm_movemask_epi8(_mm_slli_epi16(v2, 7 - Bits)))) << 32 |
+                          uint64_t(uint32_t(_mm_movemask_epi8(_mm_slli_epi16(v3, 7 - Bits)))) << 48), ...);
+}
+
+// SSE4.1: 64 pixels per word, channel 0 gathered 16 at a time
+void bit_planes_bgr_sse41(const uint8_t* bgr, uint64_t* const* planes, size_t pixels) {
+    const PlaneRows rows(planes);
+    for_each_plane_word<3>(bgr, pixels, [&rows](const uint8_t* p, size_t w) {
+        store_planes_sse(gather_channel0_16(p), gather_channel0_16(p + 48),
+                         gather_channel0_16(p + 96), gather_channel0_16(p + 144), rows, w, PlaneBits());
+    });
+}
+
+// SSE4.1: 64 pixels per word
+void bit_planes_gray_sse41(const uint8_t* src, uint64_t* const* planes, size_t pixels) {
+    const PlaneRows rows(planes);
+    for_each_plane_word<1>(src, pixels, [&rows](const uint8_t* p, size_t w) {
+        const __m128i* v = reinterpret_cast<const __m128i*>(p);
+        store_planes_sse(_mm_loadu_si128(v), _mm_loadu_si128(v + 1),
+                         _mm_loadu_si128(v + 2), _mm_loadu_si128(v + 3), rows, w, PlaneBits());
+    });
+}
+
+//-----------------------------------------------------------------------------
+// Masked Histogram
+//-----------------------------------------------------------------------------
+
+void masked_histogram_sse41(const uint8_t* src, const uint8_t* mask, size_t pixels, uint32_t* banks) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 16 <= pixels; i += 16) {
+        __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i));
+        uint32_t outside = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(m, zero)));
+        masked_histogram_block(src + i, 16, ~outside & 0xFFFFu, 0xFFFFu, banks);
+    }
+
+    masked_histogram_scalar(src + i, mask + i, pixels - i, banks);
+}
+
+//-----------------------------------------------------------------------------
+// Frame Difference
+//-----------------------------------------------------------------------------
+
+// SSE4.1: Process 16 pixels at once (PAVGB on the inverted previous frame)
+void frame_difference_sse41(const uint8_t* cur, const uint8_t* prev, uint8_t* dst, size_t pixels) {
+    const __m128i ones = _mm_set1_epi8(-1);
+
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + i));
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_avg_epu8(c, _mm_xor_si128(p, ones)));
+    }
+
+    frame_difference_scalar(cur + i, prev + i, dst + i, pixels - i);
+}
+
+} // namespace internal
+} // namespace simd
+} // namespace video
+
+#endif // RTCAM_SIMD_X86
@@ -1,37 +1,106 @@
 #include "video/simd_utils.h"
-#include <intrin.h>  // MSVC intrinsics
-#include <immintrin.h>  // AVX/AVX2
+#include "video/simd_kernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 
+#if defined(RTCAM_SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>  // __cpuidex, _xgetbv
+#elif defined(RTCAM_SIMD_X86)
+#include <cpuid.h>
+#endif
+
 namespace video {
 namespace simd {
 
-// CPU feature detection using CPUID
+bool cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+#if defined(RTCAM_SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) {
+        regs[i] = static_cast<uint32_t>(info[i]);
+    }
+    return true;
+#elif defined(RTCAM_SIMD_X86)
+    // Leaves above the highest supported one read as zero, as on MSVC with a checked leaf
+    if (!__get_cpuid_count(leaf, subleaf, &regs[0], &regs[1], &regs[2], &regs[3])) {
+        regs[0] = regs[1] = regs[2] = regs[3] = 0;
+    }
+    return true;
+#else
+    regs[0] = regs[1] = regs[2] = regs[3] = 0;
+    (void)leaf;
+    (void)subleaf;
+    return false;
+#endif
+}
+
+namespace {
+
+#ifdef RTCAM_SIMD_X86
+// XCR0: register state the OS saves on a context switch (only valid when CPUID reports OSXSAVE)
+uint64_t read_xcr0() {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+}
+#endif
+
+} // namespace
+
+// CPU feature detection using CPUID (x86) or the architecture baseline (AArch64)
 const CPUFeatures& get_cpu_features() {
     static CPUFeatures features = []() {
         CPUFeatures f;
-        int cpu_info[4];
+
+#if defined(RTCAM_SIMD_X86)
+        uint32_t regs[4];
 
         // Check for SSE2 (always available on x64)
-        __cpuid(cpu_info, 1);
-        f.has_sse2 = (cpu_info[3] & (1 << 26)) != 0;
-        f.has_sse41 = (cpu_info[2] & (1 << 19)) != 0;
-        f.has_avx = (cpu_info[2] & (1 << 28)) != 0;
+        cpuid(1, 0, regs);
+        f.has_sse2 = (regs[3] & (1u << 26)) != 0;
+        f.has_sse41 = (regs[2] & (1u << 19)) != 0;
+
+        // AVX needs the OS to save YMM state (XCR0 bits 1-2), AVX-512 also opmask and ZMM (bits 5-7)
+        const uint64_t xcr0 = (regs[2] & (1u << 27)) != 0 ? read_xcr0() : 0;
+        const bool os_avx = (xcr0 & 0x06) == 0x06;
+        const bool os_avx512 = (xcr0 & 0xE6) == 0xE6;
+        f.has_avx = os_avx && (regs[2] & (1u << 28)) != 0;
 
         // Check for AVX2
         if (f.has_avx) {
-            __cpuidex(cpu_info, 7, 0);
-            f.has_avx2 = (cpu_info[1] & (1 << 5)) != 0;
-            f.has_avx512 = (cpu_info[1] & (1 << 16)) != 0;
+            cpuid(7, 0, regs);
+            f.has_avx2 = (regs[1] & (1u << 5)) != 0;
+            f.has_avx512 = os_avx512 && (regs[1] & (1u << 16)) != 0;
+            f.has_avx512bw = f.has_avx512 && (regs[1] & (1u << 30)) != 0;
+            f.has_avx512vl = f.has_avx512 && (regs[1] & (1u << 31)) != 0;
+            f.has_avx512vpopcntdq = f.has_avx512 && (regs[2] & (1u << 14)) != 0;
         }
+#elif defined(RTCAM_SIMD_NEON)
+        f.has_neon = true;
+#endif
 
         // Log detected features
         std::cout << "SIMD CPU Features Detected:" << std::endl;
+#if defined(RTCAM_SIMD_NEON)
+        std::cout << "  NEON: " << (f.has_neon ? "YES" : "NO") << std::endl;
+#else
         std::cout << "  SSE2: " << (f.has_sse2 ? "YES" : "NO") << std::endl;
         std::cout << "  SSE4.1: " << (f.has_sse41 ? "YES" : "NO") << std::endl;
         std::cout << "  AVX: " << (f.has_avx ? "YES" : "NO") << std::endl;
         std::cout << "  AVX2: " << (f.has_avx2 ? "YES" : "NO") << std::endl;
         std::cout << "  AVX-512: " << (f.has_avx512 ? "YES" : "NO") << std::endl;
+        std::cout << "  AVX-512BW: " << (f.has_avx512bw ? "YES" : "NO") << std::endl;
+        std::cout << "  AVX-512VL: " << (f.has_avx512vl ? "YES" : "NO") << std::endl;
+        std::cout << "  AVX-512 VPOPCNTDQ: " << (f.has_avx512vpopcntdq ? "YES" : "NO") << std::endl;
+#endif
 
         return f;
     }();
@@ -40,104 +109,134 @@ const CPUFeatures& get_cpu_features() {
 }
 
 //-----------------------------------------------------------------------------
-// BGR to Grayscale Conversion
+// Per-kernel dispatch tiers
 //-----------------------------------------------------------------------------
 
-namespace internal {
-
-// Scalar fallback: Standard C++ implementation
-void bgr_to_gray_scalar(const uint8_t* bgr, uint8_t* gray, size_t pixels) {
-    // Y = 0.299*R + 0.587*G + 0.114*B
-    // Using fixed-point: Y = (77*R + 150*G + 29*B) >> 8
-    for (size_t i = 0; i < pixels; ++i) {
-        uint8_t b = bgr[i * 3 + 0];
-        uint8_t g = bgr[i * 3 + 1];
-        uint8_t r = bgr[i * 3 + 2];
-        gray[i] = static_cast<uint8_t>((29 * b + 150 * g + 77 * r) >> 8);
+namespace {
+
+constexpr uint8_t tier_bit(Isa isa) { return static_cast<uint8_t>(1u << static_cast<int>(isa)); }
+constexpr uint8_t SCALAR_SSE41_AVX2 = tier_bit(Isa::Scalar) | tier_bit(Isa::SSE41) | tier_bit(Isa::AVX2);
+constexpr uint8_t ALL_X86 = SCALAR_SSE41_AVX2 | tier_bit(Isa::AVX512);
+constexpr uint8_t SCALAR_AVX2 = tier_bit(Isa::Scalar) | tier_bit(Isa::AVX2);
+constexpr uint8_t NEON_TIER = tier_bit(Isa::NEON);
+
+struct KernelInfo {
+    const char* name;
+    uint8_t tiers;      // Implemented tiers (tier_bit)
+};
+
+// Same order as Kernel
+constexpr KernelInfo KERNELS[KERNEL_COUNT] = {
+    {"bgr_to_gray", ALL_X86 | NEON_TIER},
+    {"range_filter", SCALAR_SSE41_AVX2 | NEON_TIER},
+    {"dual_range_filter", ALL_X86 | NEON_TIER},
+    {"extract_bit_mask", SCALAR_SSE41_AVX2 | NEON_TIER},
+    {"split_bit_planes", ALL_X86 | NEON_TIER},   // AVX-512 for single-channel input; BGR runs AVX2
+    {"masked_histogram", SCALAR_SSE41_AVX2},
+    {"masked_integrals", SCALAR_AVX2},
+    {"frame_difference", SCALAR_SSE41_AVX2 | NEON_TIER},
+    {"event_stats", SCALAR_AVX2},
+    {"bit_algebra", SCALAR_AVX2 | tier_bit(Isa::AVX512)},   // AVX-512 counts with VPOPCNTQ when reported
+};
+
+constexpr const char* ISA_NAMES[ISA_COUNT] = {"scalar", "sse41", "avx2", "avx512", "neon"};
+
+bool cpu_has(Isa isa) {
+    const CPUFeatures& f = get_cpu_features();
+    switch (isa) {
+        case Isa::Scalar: return true;
+        case Isa::SSE41: return f.has_sse41;
+        case Isa::AVX2: return f.has_avx2;
+        case Isa::AVX512: return f.has_avx512bw;
+        case Isa::NEON: return f.has_neon;
     }
+    return false;
 }
 
-// SSE4.1: Process 8 pixels at once
-void bgr_to_gray_sse41(const uint8_t* bgr, uint8_t* gray, size_t pixels) {
-    const __m128i weight_b = _mm_set1_epi16(29);
-    const __m128i weight_g = _mm_set1_epi16(150);
-    const __m128i weight_r = _mm_set1_epi16(77);
-    const __m128i zero = _mm_setzero_si128();
-
-    size_t i = 0;
-    // Process 8 pixels per iteration
-    for (; i + 8 <= pixels; i += 8) {
-        // Load 24 bytes (8 BGR pixels)
-        __m128i bgr0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgr + i * 3));
-        __m128i bgr1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(bgr + i * 3 + 16));
+constexpr uint8_t UNSET = 0xFF;
+std::atomic<uint8_t> dispatch_tiers[KERNEL_COUNT] = {
+    {UNSET}, {UNSET}, {UNSET}, {UNSET}, {UNSET}, {UNSET}, {UNSET}, {UNSET}, {UNSET}, {UNSET}};
 
-        // Deinterleave BGR channels
-        // This is complex - simplified approach: extract and convert
-        __m128i b_lo = _mm_unpacklo_epi8(bgr0, zero);
-        __m128i g_hi = _mm_unpackhi_epi8(bgr0, zero);
+} // namespace
 
-        // Weighted sum (simplified for SSE4.1)
-        __m128i result = _mm_adds_epi16(
-            _mm_mullo_epi16(b_lo, weight_b),
-            _mm_mullo_epi16(g_hi, weight_g)
-        );
+const char* kernel_name(Kernel kernel) {
+    const int index = static_cast<int>(kernel);
+    return index < KERNEL_COUNT ? KERNELS[index].name : "?";
+}
 
-        // Shift and pack
-        result = _mm_srli_epi16(result, 8);
-        result = _mm_packus_epi16(result, zero);
+const char* isa_name(Isa isa) {
+    return ISA_NAMES[static_cast<int>(isa)];
+}
 
-        _mm_storel_epi64(reinterpret_cast<__m128i*>(gray + i), result);
+bool parse_kernel(const std::string& name, Kernel& kernel) {
+    for (int i = 0; i < KERNEL_COUNT; ++i) {
+        if (name == KERNELS[i].name) {
+            kernel = static_cast<Kernel>(i);
+            return true;
+        }
     }
+    return false;
+}
 
-    // Handle remaining pixels with scalar
-    bgr_to_gray_scalar(bgr + i * 3, gray + i, pixels - i);
+bool parse_isa(const std::string& name, Isa& isa) {
+    for (int i = 0; i < ISA_COUNT; ++i) {
+        if (name == ISA_NAMES[i]) {
+            isa = static_cast<Isa>(i);
+            return true;
+        }
+    }
+    return false;
 }
 
-// AVX2: Process 16 pixels at once
-void bgr_to_gray_avx2(const uint8_t* bgr, uint8_t* gray, size_t pixels) {
-    const __m256i weight_b = _mm256_set1_epi16(29);
-    const __m256i weight_g = _mm256_set1_epi16(150);
-    const __m256i weight_r = _mm256_set1_epi16(77);
+bool has_isa(Kernel kernel, Isa isa) {
+    return (KERNELS[static_cast<int>(kernel)].tiers & tier_bit(isa)) != 0 && cpu_has(isa);
+}
 
-    size_t i = 0;
-    // Process 16 pixels per iteration
-    for (; i + 16 <= pixels; i += 16) {
-        // Load 48 bytes (16 BGR pixels)
-        __m256i bgr_data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bgr + i * 3));
+Isa max_isa(Kernel kernel) {
+    for (int i = ISA_COUNT - 1; i > 0; --i) {
+        if (has_isa(kernel, static_cast<Isa>(i))) {
+            return static_cast<Isa>(i);
+        }
+    }
+    return Isa::Scalar;
+}
 
-        // Convert BGR bytes to 16-bit for processing
-        __m256i bgr_lo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bgr_data));
-        __m256i bgr_hi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bgr_data, 1));
+Isa get_isa(Kernel kernel) {
+    const uint8_t tier = dispatch_tiers[static_cast<int>(kernel)].load(std::memory_order_relaxed);
+    return tier == UNSET ? max_isa(kernel) : static_cast<Isa>(tier);
+}
 
-        // Extract channels (every 3rd element)
-        // Simplified: process as interleaved and approximate
-        __m256i b_vals = _mm256_and_si256(bgr_lo, _mm256_set1_epi16(0xFF));
-        __m256i g_vals = _mm256_srli_epi16(bgr_lo, 8);
-        __m256i r_vals = _mm256_and_si256(bgr_hi, _mm256_set1_epi16(0xFF));
+void set_isa(Kernel kernel, Isa isa) {
+    // Highest implemented tier at or below the request, within what the CPU runs;
+    // a tier the CPU lacks (the other architecture's included) starts from max_isa()
+    const int top = static_cast<int>(max_isa(kernel));
+    int tier = cpu_has(isa) ? std::min(static_cast<int>(isa), top) : top;
+    while (tier > 0 && !has_isa(kernel, static_cast<Isa>(tier))) {
+        --tier;
+    }
+    dispatch_tiers[static_cast<int>(kernel)].store(static_cast<uint8_t>(tier), std::memory_order_relaxed);
+}
 
-        // Weighted sum
-        __m256i result = _mm256_adds_epi16(
-            _mm256_adds_epi16(
-                _mm256_mullo_epi16(b_vals, weight_b),
-                _mm256_mullo_epi16(g_vals, weight_g)
-            ),
-            _mm256_mullo_epi16(r_vals, weight_r)
-        );
+//-----------------------------------------------------------------------------
+// Scalar kernels (the SIMD tiers are in simd_sse41/avx2/avx512/neon.cpp)
+//-----------------------------------------------------------------------------
 
-        // Shift to 8-bit range
-        result = _mm256_srli_epi16(result, 8);
+namespace internal {
 
-        // Pack to 8-bit
-        result = _mm256_packus_epi16(result, result);
-        result = _mm256_permute4x64_epi64(result, 0xD8);
+//-----------------------------------------------------------------------------
+// BGR to Grayscale Conversion
+//-----------------------------------------------------------------------------
 
-        // Store 16 bytes
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(gray + i),
-                        _mm256_castsi256_si128(result));
+// Scalar fallback: Standard C++ implementation
+void bgr_to_gray_scalar(const uint8_t* bgr, uint8_t* gray, size_t pixels) {
+    // Y = 0.299*R + 0.587*G + 0.114*B
+    // Using fixed-point: Y = (77*R + 150*G + 29*B) >> 8
+    for (size_t i = 0; i < pixels; ++i) {
+        uint8_t b = bgr[i * 3 + 0];
+        uint8_t g = bgr[i * 3 + 1];
+        uint8_t r = bgr[i * 3 + 2];
+        gray[i] = static_cast<uint8_t>((29 * b + 150 * g + 77 * r) >> 8);
     }
-
-    // Handle remaining pixels with scalar
-    bgr_to_gray_scalar(bgr + i * 3, gray + i, pixels - i);
 }
 
 //-----------------------------------------------------------------------------
@@ -152,53 +251,148 @@ void range_filter_scalar(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_
     }
 }
 
-// SSE4.1: Process 16 pixels at once
-void range_filter_sse41(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t low, uint8_t high) {
-    const __m128i vlow = _mm_set1_epi8(low);
-    const __m128i vhigh = _mm_set1_epi8(high);
+//-----------------------------------------------------------------------------
+// Dual Range Filter (single pass, both ranges OR-ed in registers)
+//-----------------------------------------------------------------------------
 
-    size_t i = 0;
-    for (; i + 16 <= pixels; i += 16) {
-        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+// Scalar fallback
+void dual_range_filter_scalar(const uint8_t* src, uint8_t* dst, size_t pixels,
+                              uint8_t low1, uint8_t high1, uint8_t low2, uint8_t high2) {
+    for (size_t i = 0; i < pixels; ++i) {
+        uint8_t val = src[i];
+        bool in1 = val >= low1 && val <= high1;
+        bool in2 = val >= low2 && val <= high2;
+        dst[i] = (in1 || in2) ? 255 : 0;
+    }
+}
 
-        // Compare: data >= low
-        __m128i mask_low = _mm_cmpgt_epi8(data, _mm_sub_epi8(vlow, _mm_set1_epi8(1)));
-        // Compare: data <= high
-        __m128i mask_high = _mm_cmpgt_epi8(_mm_add_epi8(vhigh, _mm_set1_epi8(1)), data);
+//-----------------------------------------------------------------------------
+// Fused Bit-Mask Extraction
+//-----------------------------------------------------------------------------
+
+// Runtime mask: the scalar loop measured slower with the mask as an immediate
+void bit_mask_bgr_scalar(const uint8_t* bgr, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    bit_mask_bgr_scalar_t<0>(bgr, dst, pixels, bit_mask);
+}
+
+void bit_mask_gray_scalar(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t bit_mask) {
+    bit_mask_gray_scalar_t<0>(src, dst, pixels, bit_mask);
+}
 
-        // Combine: AND the masks
-        __m128i result = _mm_and_si128(mask_low, mask_high);
+//-----------------------------------------------------------------------------
+// Bit-Plane Split
+//-----------------------------------------------------------------------------
+
+// 8x8 bit transpose of one register: in byte i = pixel i, out byte b = bit b of pixels 0-7
+static inline uint64_t transpose_8x8(uint64_t x) {
+    uint64_t t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x ^= t ^ (t << 28);
+    return x;
+}
 
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), result);
+static void bit_planes_scalar(const uint8_t* src, size_t stride, uint64_t* const* planes, size_t pixels) {
+    for (size_t x0 = 0, w = 0; x0 < pixels; x0 += 64, ++w) {
+        const size_t n = std::min<size_t>(64, pixels - x0);
+        uint64_t words[8] = {};
+        for (size_t g = 0; g < n; g += 8) {
+            // Short last group: missing pixels read as 0, keeping padding bits clear
+            uint64_t block = 0;
+            const size_t m = std::min<size_t>(8, n - g);
+            for (size_t i = 0; i < m; ++i) {
+                block |= uint64_t(src[(x0 + g + i) * stride]) << (i * 8);
+            }
+            block = transpose_8x8(block);
+            for (int b = 0; b < 8; ++b) {
+                words[b] |= ((block >> (b * 8)) & 0xFF) << g;
+            }
+        }
+        for (int b = 0; b < 8; ++b) {
+            planes[b][w] = words[b];
+        }
     }
+}
 
-    // Handle remaining with scalar
-    range_filter_scalar(src + i, dst + i, pixels - i, low, high);
+void bit_planes_bgr_scalar(const uint8_t* bgr, uint64_t* const* planes, size_t pixels) {
+    bit_planes_scalar(bgr, 3, planes, pixels);
 }
 
-// AVX2: Process 32 pixels at once
-void range_filter_avx2(const uint8_t* src, uint8_t* dst, size_t pixels, uint8_t low, uint8_t high) {
-    const __m256i vlow = _mm256_set1_epi8(low);
-    const __m256i vhigh = _mm256_set1_epi8(high);
-    const __m256i one = _mm256_set1_epi8(1);
+void bit_planes_gray_scalar(const uint8_t* src, uint64_t* const* planes, size_t pixels) {
+    bit_planes_scalar(src, 1, planes, pixels);
+}
 
-    size_t i = 0;
-    for (; i + 32 <= pixels; i += 32) {
-        __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+//-----------------------------------------------------------------------------
+// Masked Histogram
+//-----------------------------------------------------------------------------
 
-        // Compare: data >= low (using data > low-1)
-        __m256i mask_low = _mm256_cmpgt_epi8(data, _mm256_sub_epi8(vlow, one));
-        // Compare: data <= high (using high+1 > data)
-        __m256i mask_high = _mm256_cmpgt_epi8(_mm256_add_epi8(vhigh, one), data);
+void masked_histogram_scalar(const uint8_t* src, const uint8_t* mask, size_t pixels, uint32_t* banks) {
+    for (size_t i = 0; i < pixels; ++i) {
+        banks[(i & 3) * HIST_BANK + ((mask[i] != 0) << 8) + src[i]]++;
+    }
+}
 
-        // Combine masks with AND
-        __m256i result = _mm256_and_si256(mask_low, mask_high);
+//-----------------------------------------------------------------------------
+// Frame Difference
+//-----------------------------------------------------------------------------
 
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), result);
+// Scalar fallback: (cur + ~prev + 1) >> 1 == floor((cur - prev) / 2) + 128, never out of range
+void frame_difference_scalar(const uint8_t* cur, const uint8_t* prev, uint8_t* dst, size_t pixels) {
+    for (size_t i = 0; i < pixels; ++i) {
+        dst[i] = static_cast<uint8_t>((cur[i] + (255 - prev[i]) + 1) >> 1);
     }
+}
+
+//-----------------------------------------------------------------------------
+// Masked Integral Images
+//-----------------------------------------------------------------------------
+
+// Scalar fallback
+void masked_integral_row_scalar(const uint8_t* src, const uint8_t* mask, size_t pixels,
+                                const IntegralRow& above, const IntegralRow& row) {
+    masked_integral_row_from(src, mask, 0, pixels, above, row, 0, 0, 0);
+}
 
-    // Handle remaining with scalar
-    range_filter_scalar(src + i, dst + i, pixels - i, low, high);
+//-----------------------------------------------------------------------------
+// Event Batch Statistics
+//-----------------------------------------------------------------------------
+
+// Scalar fallback
+void event_stats_scalar(const Metavision::EventCD* events, size_t count, EventStats& stats,
+                        uint32_t* row_counts, int row_count) {
+    EventStats local = stats;
+    for (size_t i = 0; i < count; ++i) {
+        const Metavision::EventCD& ev = events[i];
+        local.on_events += static_cast<uint64_t>(ev.p & 1);
+        local.t_min = std::min<int64_t>(local.t_min, ev.t);
+        local.t_max = std::max<int64_t>(local.t_max, ev.t);
+        local.x_min = std::min(local.x_min, ev.x);
+        local.x_max = std::max(local.x_max, ev.x);
+        local.y_min = std::min(local.y_min, ev.y);
+        local.y_max = std::max(local.y_max, ev.y);
+        if (row_counts && ev.y < row_count) {
+            ++row_counts[ev.y];
+        }
+    }
+    local.events += count;
+    stats = local;
+}
+
+//-----------------------------------------------------------------------------
+// Bit-Packed Frame Algebra
+//-----------------------------------------------------------------------------
+
+// Scalar fallback
+void bitwise_ternary_scalar(const uint64_t* a, const uint64_t* b, const uint64_t* c, uint64_t* out,
+                            size_t words, uint8_t table) {
+    with_fixed_table(table, [&](auto t) { bitwise_ternary_from(a, b, c, out, 0, words, t); });
+}
+
+int64_t count_ternary_scalar(const uint64_t* a, const uint64_t* b, const uint64_t* c, size_t words,
+                             uint8_t table) {
+    return with_fixed_table(table, [&](auto t) { return count_ternary_from(a, b, c, 0, words, t); });
 }
 
 } // namespace internal
@@ -217,14 +411,16 @@ void bgr_to_gray(const cv::Mat& bgr, cv::Mat& gray) {
     uint8_t* gray_data = gray.data;
     size_t pixels = bgr.total();
 
-    const auto& features = get_cpu_features();
-
-    if (features.has_avx2) {
-        internal::bgr_to_gray_avx2(bgr_data, gray_data, pixels);
-    } else if (features.has_sse41) {
-        internal::bgr_to_gray_sse41(bgr_data, gray_data, pixels);
-    } else {
-        internal::bgr_to_gray_scalar(bgr_data, gray_data, pixels);
+    switch (get_isa(Kernel::BgrToGray)) {
+#ifdef RTCAM_SIMD_X86
+        case Isa::AVX512: internal::bgr_to_gray_avx512(bgr_data, gray_data, pixels); break;
+        case Isa::AVX2: internal::bgr_to_gray_avx2(bgr_data, gray_data, pixels); break;
+        case Isa::SSE41: internal::bgr_to_gray_sse41(bgr_data, gray_data, pixels); break;
+#endif
+#ifdef RTCAM_SIMD_NEON
+        case Isa::NEON: internal::bgr_to_gray_neon(bgr_data, gray_data, pixels); break;
+#endif
+        default: internal::bgr_to_gray_scalar(bgr_data, gray_data, pixels); break;
     }
 }
 
@@ -238,14 +434,97 @@ void apply_range_filter(const cv::Mat& src, cv::Mat& dst, uint8_t low, uint8_t h
     uint8_t* dst_data = dst.data;
     size_t pixels = src.total();
 
-    const auto& features = get_cpu_features();
+    switch (get_isa(Kernel::RangeFilter)) {
+#ifdef RTCAM_SIMD_X86
+        case Isa::AVX2: internal::range_filter_avx2(src_data, dst_data, pixels, low, high); break;
+        case Isa::SSE41: internal::range_filter_sse41(src_data, dst_data, pixels, low, high); break;
+#endif
+#ifdef RTCAM_SIMD_NEON
+        case Isa::NEON: internal::range_filter_neon(src_data, dst_data, pixels, low, high); break;
+#endif
+        default: internal::range_filter_scalar(src_data, dst_data, pixels, low, high); break;
+    }
+}
 
-    if (features.has_avx2) {
-        internal::range_filter_avx2(src_data, dst_data, pixels, low, high);
-    } else if (features.has_sse41) {
-        internal::range_filter_sse41(src_data, dst_data, pixels, low, high);
-    } else {
-        internal::range_filter_scalar(src_data, dst_data, pixels, low, high);
+void extract_bit_mask(const cv::Mat& src, cv::Mat& dst, uint8_t bit_mask) {
+    CV_Assert(src.type() == CV_8UC3 || src.type() == CV_8UC1);
+    dst.create(src.size(), CV_8UC1);
+
+    const bool bgr = src.channels() == 3;
+
+    // Pick the kernel once per frame: mask compiled in for one or two bits, else the runtime-mask one
+    using internal::BitMaskKernels;
+    BitMaskKernels kernels{internal::bit_mask_bgr_scalar, internal::bit_mask_gray_scalar};
+    switch (get_isa(Kernel::ExtractBitMask)) {
+#ifdef RTCAM_SIMD_X86
+        case Isa::AVX2: {
+            const BitMaskKernels* fixed = internal::fixed_bit_mask_avx2(bit_mask);
+            kernels = fixed ? *fixed : BitMaskKernels{internal::bit_mask_bgr_avx2, internal::bit_mask_gray_avx2};
+            break;
+        }
+        case Isa::SSE41: {
+            const BitMaskKernels* fixed = internal::fixed_bit_mask_sse41(bit_mask);
+            kernels = fixed ? *fixed : BitMaskKernels{internal::bit_mask_bgr_sse41, internal::bit_mask_gray_sse41};
+            break;
+        }
+#endif
+#ifdef RTCAM_SIMD_NEON
+        case Isa::NEON:
+            kernels = BitMaskKernels{internal::bit_mask_bgr_neon, internal::bit_mask_gray_neon};
+            break;
+#endif
+        default: break;
+    }
+    const BitMaskKernels::Row kernel = bgr ? kernels.bgr : kernels.gray;
+
+    // Whole image in one call when continuous, otherwise row by row
+    const int rows = (src.isContinuous() && dst.isContinuous()) ? 1 : src.rows;
+    const size_t pixels = (rows == 1) ? src.total() : static_cast<size_t>(src.cols);
+
+    for (int y = 0; y < rows; ++y) {
+        kernel(src.ptr<uint8_t>(y), dst.ptr<uint8_t>(y), pixels, bit_mask);
+    }
+}
+
+void split_bit_planes(const cv::Mat& src, BinaryFrame planes[8]) {
+    CV_Assert(src.type() == CV_8UC3 || src.type() == CV_8UC1);
+
+    const bool bgr = src.channels() == 3;
+    using PlaneKernel = void (*)(const uint8_t*, uint64_t* const*, size_t);
+    PlaneKernel kernel = bgr ? internal::bit_planes_bgr_scalar : internal::bit_planes_gray_scalar;
+    switch (get_isa(Kernel::SplitBitPlanes)) {
+#ifdef RTCAM_SIMD_X86
+        case Isa::AVX512:
+            kernel = bgr ? internal::bit_planes_bgr_avx2 : internal::bit_planes_gray_avx512;
+            break;
+        case Isa::AVX2:
+            kernel = bgr ? internal::bit_planes_bgr_avx2 : internal::bit_planes_gray_avx2;
+            break;
+        case Isa::SSE41:
+            kernel = bgr ? internal::bit_planes_bgr_sse41 : internal::bit_planes_gray_sse41;
+            break;
+#endif
+#ifdef RTCAM_SIMD_NEON
+        case Isa::NEON:
+            kernel = bgr ? internal::bit_planes_bgr_neon : internal::bit_planes_gray_neon;
+            break;
+#endif
+        default: break;
+    }
+
+    for (int b = 0; b < 8; ++b) {
+        if (planes[b].size() != src.size()) {
+            planes[b].create(src.cols, src.rows);
+        }
+    }
+
+    // Plane rows are word aligned, so always row by row
+    for (int y = 0; y < src.rows; ++y) {
+        uint64_t* rows[8];
+        for (int b = 0; b < 8; ++b) {
+            rows[b] = planes[b].row(y);
+        }
+        kernel(src.ptr<uint8_t>(y), rows, static_cast<size_t>(src.cols));
     }
 }
 
@@ -256,15 +535,189 @@ void apply_dual_range_filter(const cv::Mat& src, cv::Mat& dst,
     CV_Assert(dst.type() == CV_8UC1);
     CV_Assert(src.size() == dst.size());
 
-    // Process both ranges
-    cv::Mat temp1(src.size(), CV_8UC1);
-    cv::Mat temp2(src.size(), CV_8UC1);
+    using RangeKernel = void (*)(const uint8_t*, uint8_t*, size_t, uint8_t, uint8_t, uint8_t, uint8_t);
+    RangeKernel kernel = internal::dual_range_filter_scalar;
+    switch (get_isa(Kernel::DualRangeFilter)) {
+#ifdef RTCAM_SIMD_X86
+        case Isa::AVX512: kernel = internal::dual_range_filter_avx512; break;
+        case Isa::AVX2: kernel = internal::dual_range_filter_avx2; break;
+        case Isa::SSE41: kernel = internal::dual_range_filter_sse41; break;
+#endif
+#ifdef RTCAM_SIMD_NEON
+        case Isa::NEON: kernel = internal::dual_range_filter_neon; break;
+#endif
+        default: break;
+    }
+
+    // Whole image in one sweep when continuous, otherwise row by row
+    const int rows = (src.isContinuous() && dst.isContinuous()) ? 1 : src.rows;
+    const size_t pixels = (rows == 1) ? src.total() : static_cast<size_t>(src.cols);
+
+    for (int y = 0; y < rows; ++y) {
+        kernel(src.ptr<uint8_t>(y), dst.ptr<uint8_t>(y), pixels, low1, high1, low2, high2);
+    }
+}
+
+void masked_histogram(const cv::Mat& image, const cv::Mat& mask,
+                      uint32_t inside[256], uint32_t outside[256]) {
+    CV_Assert(image.type() == CV_8UC1);
+    CV_Assert(mask.type() == CV_8UC1);
+    CV_Assert(image.size() == mask.size());
+
+    using HistogramKernel = void (*)(const uint8_t*, const uint8_t*, size_t, uint32_t*);
+    HistogramKernel kernel = internal::masked_histogram_scalar;
+    switch (get_isa(Kernel::MaskedHistogram)) {
+#ifdef RTCAM_SIMD_X86
+        case Isa::AVX2: kernel = internal::masked_histogram_avx2; break;
+        case Isa::SSE41: kernel = internal::masked_histogram_sse41; break;
+#endif
+        default: break;
+    }
+    alignas(64) uint32_t banks[4 * internal::HIST_BANK] = {};
+
+    // Whole image in one sweep when continuous, otherwise row by row
+    const int rows = (image.isContinuous() && mask.isContinuous()) ? 1 : image.rows;
+    const size_t pixels = (rows == 1) ? image.total() : static_cast<size_t>(image.cols);
+
+    for (int y = 0; y < rows; ++y) {
+        kernel(image.ptr<uint8_t>(y), mask.ptr<uint8_t>(y), pixels, banks);
+    }
+
+    // Merge the 4 banks
+    for (int v = 0; v < 256; ++v) {
+        uint32_t in = 0;
+        uint32_t out = 0;
+        for (int b = 0; b < 4; ++b) {
+            out += banks[b * internal::HIST_BANK + v];
+            in += banks[b * internal::HIST_BANK + 256 + v];
+        }
+        inside[v] = in;
+        outside[v] = out;
+    }
+}
+
+void masked_integrals(const cv::Mat& image, const cv::Mat& mask,
+                      cv::Mat& sum, cv::Mat& sum_sq, cv::Mat& count) {
+    CV_Assert(image.type() == CV_8UC1);
+    CV_Assert(mask.type() == CV_8UC1);
+    CV_Assert(image.size() == mask.size());
+
+    sum.create(image.rows + 1, image.cols + 1, CV_32S);
+    sum_sq.create(image.rows + 1, image.cols + 1, CV_64F);
+    count.create(image.rows + 1, image.cols + 1, CV_32S);
+    sum.row(0).setTo(0);
+    sum_sq.row(0).setTo(0);
+    count.row(0).setTo(0);
+
+    using IntegralKernel = void (*)(const uint8_t*, const uint8_t*, size_t,
+                                    const internal::IntegralRow&, const internal::IntegralRow&);
+    IntegralKernel kernel = internal::masked_integral_row_scalar;
+#ifdef RTCAM_SIMD_X86
+    // Row prefixes of squares are 32-bit: 255^2 * 32768 < 2^31
+    if (get_isa(Kernel::MaskedIntegrals) == Isa::AVX2 && image.cols <= 32768) {
+        kernel = internal::masked_integral_row_avx2;
+    }
+#endif
+    const size_t pixels = static_cast<size_t>(image.cols);
+
+    for (int y = 0; y < image.rows; ++y) {
+        const internal::IntegralRow above{sum.ptr<uint32_t>(y) + 1, sum_sq.ptr<double>(y) + 1,
+                                          count.ptr<uint32_t>(y) + 1};
+        const internal::IntegralRow row{sum.ptr<uint32_t>(y + 1) + 1, sum_sq.ptr<double>(y + 1) + 1,
+                                        count.ptr<uint32_t>(y + 1) + 1};
+        row.sum[-1] = 0;
+        row.sum_sq[-1] = 0.0;
+        row.count[-1] = 0;
+
+        kernel(image.ptr<uint8_t>(y), mask.ptr<uint8_t>(y), pixels, above, row);
+    }
+}
+
+void frame_difference(const cv::Mat& current, const cv::Mat& previous, cv::Mat& dst) {
+    CV_Assert(current.depth() == CV_8U);
+    CV_Assert(current.type() == previous.type());
+    CV_Assert(current.size() == previous.size());
+    dst.create(current.size(), current.type());
+
+    using DifferenceKernel = void (*)(const uint8_t*, const uint8_t*, uint8_t*, size_t);
+    DifferenceKernel kernel = internal::frame_difference_scalar;
+    switch (get_isa(Kernel::FrameDifference)) {
+#ifdef RTCAM_SIMD_X86
+        case Isa::AVX2: kernel = internal::frame_difference_avx2; break;
+        case Isa::SSE41: kernel = internal::frame_difference_sse41; break;
+#endif
+#ifdef RTCAM_SIMD_NEON
+        case Isa::NEON: kernel = internal::frame_difference_neon; break;
+#endif
+        default: break;
+    }
+
+    // Whole image in one sweep when continuous, otherwise row by row
+    const bool continuous = current.isContinuous() && previous.isContinuous() && dst.isContinuous();
+    const int rows = continuous ? 1 : current.rows;
+    const size_t bytes = (continuous ? current.total() : static_cast<size_t>(current.cols)) * current.channels();
+
+    for (int y = 0; y < rows; ++y) {
+        kernel(current.ptr<uint8_t>(y), previous.ptr<uint8_t>(y), dst.ptr<uint8_t>(y), bytes);
+    }
+}
+
+void EventStats::merge(const EventStats& other) {
+    if (other.events == 0) {
+        return;
+    }
+    events += other.events;
+    on_events += other.on_events;
+    t_min = std::min(t_min, other.t_min);
+    t_max = std::max(t_max, other.t_max);
+    x_min = std::min(x_min, other.x_min);
+    x_max = std::max(x_max, other.x_max);
+    y_min = std::min(y_min, other.y_min);
+    y_max = std::max(y_max, other.y_max);
+}
 
-    apply_range_filter(src, temp1, low1, high1);
-    apply_range_filter(src, temp2, low2, high2);
+void event_stats(const Metavision::EventCD* begin, const Metavision::EventCD* end, EventStats& stats,
+                 uint32_t* row_counts, int row_count) {
+    if (begin >= end) {
+        return;
+    }
+    const size_t count = static_cast<size_t>(end - begin);
+#ifdef RTCAM_SIMD_X86
+    if (get_isa(Kernel::EventStats) == Isa::AVX2) {
+        internal::event_stats_avx2(begin, count, stats, row_counts, row_count);
+        return;
+    }
+#endif
+    internal::event_stats_scalar(begin, count, stats, row_counts, row_count);
+}
+
+void bitwise_ternary(const uint64_t* a, const uint64_t* b, const uint64_t* c, uint64_t* out,
+                     size_t words, uint8_t table) {
+    switch (get_isa(Kernel::BitAlgebra)) {
+#ifdef RTCAM_SIMD_X86
+        case Isa::AVX512: internal::bitwise_ternary_avx512(a, b, c, out, words, table); break;
+        case Isa::AVX2: internal::bitwise_ternary_avx2(a, b, c, out, words, table); break;
+#endif
+        default: internal::bitwise_ternary_scalar(a, b, c, out, words, table); break;
+    }
+}
+
+int64_t count_ternary(const uint64_t* a, const uint64_t* b, const uint64_t* c, size_t words, uint8_t table) {
+    switch (get_isa(Kernel::BitAlgebra)) {
+#ifdef RTCAM_SIMD_X86
+        case Isa::AVX512:
+            // Harley-Seal only where the CPU lacks the vector popcount
+            return get_cpu_features().has_avx512vpopcntdq
+                       ? internal::count_ternary_avx512_vpopcnt(a, b, c, words, table)
+                       : internal::count_ternary_avx512(a, b, c, words, table);
+        case Isa::AVX2: return internal::count_ternary_avx2(a, b, c, words, table);
+#endif
+        default: return internal::count_ternary_scalar(a, b, c, words, table);
+    }
+}
 
-    // Combine with OR (bitwise)
-    cv::bitwise_or(temp1, temp2, dst);
+int64_t count_bits(const uint64_t* words, size_t count) {
+    return count_ternary(words, words, words, count, TERN_A);
 }
 
 } // namespace simd
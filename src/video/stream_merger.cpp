@@ -0,0 +1,278 @@
+#include "video/stream_merger.h"
+#include "core/thread_placement.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+namespace video {
+
+namespace {
+
+int64_t steady_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+StreamMerger::~StreamMerger() {
+    stop();
+}
+
+bool StreamMerger::start(const std::vector<cv::Size>& sizes, const Options& options, WindowCallback on_window,
+                         EventsCallback on_events) {
+    if (thread_.joinable() || sizes.size() < 2) {
+        return false;
+    }
+
+    sizes_ = sizes;
+    options_ = options;
+    options_.window_us = std::max<uint32_t>(options_.window_us, 1);
+    options_.buffer_events = std::max<size_t>(options_.buffer_events, 1024);
+    options_.max_wait_ms = std::max(options_.max_wait_ms, 0);
+    options_.stall_ms = std::max(options_.stall_ms, 1);
+    on_window_ = std::move(on_window);
+    on_events_ = std::move(on_events);
+
+    // Buffers are allocated once; a stream not heard from within stall_ms stops holding the others
+    const int64_t now_us = steady_us();
+    streams_.assign(sizes_.size(), Stream());
+    for (Stream& stream : streams_) {
+        stream.buffer.reserve(options_.buffer_events);
+        stream.last_submit_us = now_us;
+    }
+    taken_.assign(sizes_.size(), std::vector<MergedEvent>());
+    window_ = Window();
+    for (const cv::Size& size : sizes_) {
+        window_.frames.emplace_back(size.width, size.height);
+    }
+    window_.events.assign(sizes_.size(), 0);
+    merged_until_us_ = 0;
+
+    windows_.store(0);
+    merged_.store(0);
+    dropped_.store(0);
+    unmapped_.store(0);
+    late_.store(0);
+    waits_.store(0);
+    skew_us_.store(0);
+
+    running_.store(true);
+    thread_ = std::thread(&StreamMerger::merge_loop, this);
+    std::cout << "Stream merge: " << sizes_.size() << " cameras, " << options_.window_us << " μs windows, "
+              << options_.buffer_events << " events look-ahead per camera" << std::endl;
+    return true;
+}
+
+void StreamMerger::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.store(false);
+    }
+    data_cv_.notify_all();
+    room_cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+        std::cout << "Stream merge: " << windows_.load() << " windows, " << merged_.load() << " events";
+        if (dropped_.load() > 0 || late_.load() > 0) {
+            std::cout << " (" << dropped_.load() << " dropped, " << late_.load() << " late)";
+        }
+        std::cout << std::endl;
+    }
+}
+
+size_t StreamMerger::get_buffered(int stream) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stream < 0 || stream >= static_cast<int>(streams_.size())) {
+        return 0;
+    }
+    return streams_[stream].buffer.size();
+}
+
+void StreamMerger::submit(int stream, const Metavision::EventCD* begin, const Metavision::EventCD* end,
+                          const core::ClockSync& clock) {
+    if (begin == end || !running_.load(std::memory_order_relaxed) || stream < 0 ||
+        stream >= static_cast<int>(streams_.size())) {
+        return;
+    }
+    if (!clock.is_valid()) {
+        unmapped_.fetch_add(end - begin, std::memory_order_relaxed);
+        return;
+    }
+    // One offset per batch: the fitted drift moves it far less than a microsecond within one
+    const int64_t offset_us = clock.to_host_us(begin->t) - begin->t;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    Stream& s = streams_[stream];
+    s.last_submit_us = steady_us();
+    while (begin != end) {
+        size_t room = options_.buffer_events - s.buffer.size();
+        if (room == 0) {
+            // Back-pressure: this stream is ahead of a lagging one; give the watermark time to move
+            waits_.fetch_add(1, std::memory_order_relaxed);
+            data_cv_.notify_one();
+            room_cv_.wait_for(lock, std::chrono::milliseconds(options_.max_wait_ms), [this, &s] {
+                return !running_.load() || s.buffer.size() < options_.buffer_events;
+            });
+            room = options_.buffer_events - s.buffer.size();
+            if (!running_.load()) {
+                return;
+            }
+            if (room == 0) {
+                dropped_.fetch_add(end - begin, std::memory_order_relaxed);
+                break;
+            }
+        }
+
+        const size_t count = std::min(room, static_cast<size_t>(end - begin));
+        for (size_t i = 0; i < count; ++i, ++begin) {
+            // A refit between batches can step the offset back; keep the stream in order
+            MergedEvent ev;
+            ev.t = std::max<int64_t>(begin->t + offset_us, s.newest_us);
+            ev.x = begin->x;
+            ev.y = begin->y;
+            ev.p = static_cast<uint8_t>(begin->p != 0);
+            ev.stream = static_cast<uint8_t>(stream);
+            s.buffer.push_back(ev);
+            s.newest_us = ev.t;
+        }
+    }
+    lock.unlock();
+    data_cv_.notify_one();
+}
+
+int64_t StreamMerger::watermark(int64_t now_us) {
+    const int64_t stall_us = static_cast<int64_t>(options_.stall_ms) * 1000;
+    int64_t lowest = std::numeric_limits<int64_t>::max();
+    int64_t highest = std::numeric_limits<int64_t>::min();
+    int64_t newest_all = 0;
+    for (const Stream& s : streams_) {
+        newest_all = std::max(newest_all, s.newest_us);
+        if (now_us - s.last_submit_us < stall_us) {
+            lowest = std::min(lowest, s.newest_us);
+            highest = std::max(highest, s.newest_us);
+        }
+    }
+    if (lowest == std::numeric_limits<int64_t>::max()) {
+        // Every stream silent: nothing else will arrive soon, flush what is buffered
+        skew_us_.store(0, std::memory_order_relaxed);
+        return newest_all + 1;
+    }
+    skew_us_.store(lowest > 0 ? highest - lowest : 0, std::memory_order_relaxed);
+    return lowest;
+}
+
+void StreamMerger::merge_loop() {
+    core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::Analysis);
+    const auto poll = std::chrono::milliseconds(std::max(options_.stall_ms / 4, 1));
+    while (running_.load()) {
+        int64_t watermark_us = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            data_cv_.wait_for(lock, poll);
+            if (!running_.load()) {
+                break;
+            }
+
+            // Events older than the watermark are final: take them, leave the rest for later
+            watermark_us = watermark(steady_us());
+            if (watermark_us <= merged_until_us_) {
+                continue;
+            }
+            for (size_t i = 0; i < streams_.size(); ++i) {
+                std::vector<MergedEvent>& buffer = streams_[i].buffer;
+                const auto split = std::lower_bound(buffer.begin(), buffer.end(), watermark_us,
+                                                    [](const MergedEvent& ev, int64_t t) { return ev.t < t; });
+                taken_[i].assign(buffer.begin(), split);
+                buffer.erase(buffer.begin(), split);
+            }
+        }
+        room_cv_.notify_all();
+        merge(watermark_us);
+    }
+}
+
+void StreamMerger::merge(int64_t watermark_us) {
+    // Heap of stream heads, earliest first; ties go to the lower stream index
+    struct Head {
+        int64_t t;
+        int stream;
+        size_t index;
+    };
+    auto later = [](const Head& a, const Head& b) { return a.t != b.t ? a.t > b.t : a.stream > b.stream; };
+    std::vector<Head> heads;
+    size_t total = 0;
+    for (size_t i = 0; i < taken_.size(); ++i) {
+        std::vector<MergedEvent>& events = taken_[i];
+        // A stream back from a stall delivers events the others were already merged past
+        const auto first = std::lower_bound(events.begin(), events.end(), merged_until_us_,
+                                            [](const MergedEvent& ev, int64_t t) { return ev.t < t; });
+        late_.fetch_add(first - events.begin(), std::memory_order_relaxed);
+        events.erase(events.begin(), first);
+        if (!events.empty()) {
+            heads.push_back(Head{events.front().t, static_cast<int>(i), 0});
+            total += events.size();
+        }
+    }
+    std::make_heap(heads.begin(), heads.end(), later);
+
+    merged_events_.clear();
+    merged_events_.reserve(total);
+    while (!heads.empty()) {
+        std::pop_heap(heads.begin(), heads.end(), later);
+        Head& head = heads.back();
+        const std::vector<MergedEvent>& events = taken_[head.stream];
+        merged_events_.push_back(events[head.index]);
+        if (++head.index < events.size()) {
+            head.t = events[head.index].t;
+            std::push_heap(heads.begin(), heads.end(), later);
+        } else {
+            heads.pop_back();
+        }
+    }
+    merged_until_us_ = watermark_us;
+    if (merged_events_.empty()) {
+        return;
+    }
+
+    merged_.fetch_add(static_cast<int64_t>(merged_events_.size()), std::memory_order_relaxed);
+    if (on_events_) {
+        on_events_(merged_events_.data(), merged_events_.data() + merged_events_.size());
+    }
+    add_to_windows(merged_events_.data(), merged_events_.data() + merged_events_.size());
+}
+
+void StreamMerger::add_to_windows(const MergedEvent* begin, const MergedEvent* end) {
+    const int64_t window_us = options_.window_us;
+    for (const MergedEvent* ev = begin; ev != end; ++ev) {
+        if (window_.end_us == 0) {
+            window_.end_us = (ev->t / window_us + 1) * window_us;   // Same grid for every camera
+        }
+        if (ev->t >= window_.end_us) {
+            close_window();
+            if (ev->t >= window_.end_us) {
+                window_.end_us = (ev->t / window_us + 1) * window_us;   // No camera had events in between
+            }
+        }
+        const cv::Size& size = sizes_[ev->stream];
+        if (ev->x < size.width && ev->y < size.height) {
+            window_.frames[ev->stream].set(ev->x, ev->y, true);
+        }
+        ++window_.events[ev->stream];
+    }
+}
+
+void StreamMerger::close_window() {
+    if (on_window_) {
+        on_window_(window_);
+    }
+    windows_.fetch_add(1, std::memory_order_relaxed);
+    for (BinaryFrame& frame : window_.frames) {
+        frame.clear();
+    }
+    std::fill(window_.events.begin(), window_.events.end(), 0);
+    window_.end_us += options_.window_us;
+}
+
+} // namespace video
@@ -0,0 +1,173 @@
+#include "video/texture_cache.h"
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+
+namespace video {
+
+TextureCache::Key TextureCache::Key::of(const FrameRef& frame) {
+    Key key;
+    key.source = reinterpret_cast<uintptr_t>(frame.unsafe_get().data);
+    return key;
+}
+
+TextureCache::Key TextureCache::Key::of_file(const std::string& path) {
+    Key key;
+    key.source = static_cast<uintptr_t>(std::hash<std::string>()(path)) | 1;   // Never 0 (empty)
+    key.file = true;
+    std::error_code ec;
+    const auto modified = std::filesystem::last_write_time(path, ec);
+    if (!ec) {
+        key.version = static_cast<int64_t>(modified.time_since_epoch().count());
+    }
+    return key;
+}
+
+TextureCache::Handle TextureCache::reserve() {
+    Entry entry;
+    entry.texture = std::make_shared<TextureManager>();
+    entry.last_used = ++tick_;
+    entries_.push_back(entry);
+    return entry.texture;
+}
+
+void TextureCache::prepare(const cv::Size& size, int channels) {
+    for (const Entry& entry : entries_) {
+        if (entry.idle() && entry.texture->get_width() == size.width && entry.texture->get_height() == size.height) {
+            return;
+        }
+    }
+    Entry entry;
+    entry.texture = std::make_shared<TextureManager>();
+    entry.texture->prepare(size.width, size.height, channels);
+    entry.last_used = ++tick_;
+    entries_.push_back(entry);
+}
+
+TextureCache::Entry* TextureCache::entry_of(const Handle& handle) {
+    if (!handle) {
+        return nullptr;
+    }
+    for (Entry& entry : entries_) {
+        if (entry.texture == handle) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+TextureCache::Entry* TextureCache::entry_for(const Handle& handle, const cv::Size& size) {
+    // The caller's own texture, if nobody else shows it: streams in place
+    Entry* own = entry_of(handle);
+    if (own && own->texture.use_count() == 2) {
+        return own;
+    }
+
+    // Else an idle texture, preferring one whose storage already fits
+    Entry* best = nullptr;
+    for (Entry& entry : entries_) {
+        if (!entry.idle()) {
+            continue;
+        }
+        const bool fits = entry.texture->get_width() == size.width && entry.texture->get_height() == size.height;
+        const bool best_fits = best && best->texture->get_width() == size.width &&
+                               best->texture->get_height() == size.height;
+        if (!best || (fits && !best_fits) || (fits == best_fits && entry.last_used < best->last_used)) {
+            best = &entry;
+        }
+    }
+    if (best) {
+        return best;
+    }
+
+    Entry entry;
+    entry.texture = std::make_shared<TextureManager>();
+    entries_.push_back(entry);
+    return &entries_.back();
+}
+
+bool TextureCache::acquire(Handle& handle, const FrameRef& frame, const Key& key) {
+    if (frame.empty() || key.empty()) {
+        return false;
+    }
+
+    // Already showing it, or another view uploaded it
+    Entry* entry = entry_of(handle);
+    if (!entry || !(entry->key == key)) {
+        entry = nullptr;
+        for (Entry& candidate : entries_) {
+            if (candidate.key == key && candidate.texture->get_texture_id() != 0) {
+                entry = &candidate;
+                break;
+            }
+        }
+    }
+    if (entry) {
+        entry->last_used = ++tick_;
+        handle = entry->texture;
+        ++hits_;
+        trim();
+        return false;
+    }
+
+    entry = entry_for(handle, frame.size());
+    entry->texture->upload_frame(frame);
+    entry->key = key;
+    entry->last_used = ++tick_;
+    handle = entry->texture;   // May be a new entry: take it before trim() sees it idle
+    ++uploads_;
+    trim();
+    return true;
+}
+
+TextureCache::Handle TextureCache::find(const Key& key) {
+    if (key.empty()) {
+        return Handle();
+    }
+    for (Entry& entry : entries_) {
+        if (entry.key == key && entry.texture->get_texture_id() != 0) {
+            entry.last_used = ++tick_;
+            return entry.texture;
+        }
+    }
+    return Handle();
+}
+
+void TextureCache::trim() {
+    size_t idle = 0;
+    for (Entry& entry : entries_) {
+        if (!entry.idle()) {
+            continue;
+        }
+        ++idle;
+        entry.texture->release_frame();
+        if (!entry.key.file) {
+            entry.key = Key();   // The pixel buffer may be reused once released
+        }
+    }
+
+    // Evict the least recently used idle entries
+    while (idle > MAX_IDLE) {
+        auto oldest = entries_.end();
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->idle() && (oldest == entries_.end() || it->last_used < oldest->last_used)) {
+                oldest = it;
+            }
+        }
+        oldest->texture->reset();
+        entries_.erase(oldest);
+        --idle;
+    }
+}
+
+void TextureCache::clear() {
+    for (Entry& entry : entries_) {
+        entry.texture->reset();
+        entry.key = Key();
+    }
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                  [](const Entry& entry) { return entry.idle(); }),
+                   entries_.end());
+}
+
+} // namespace video
@@ -1,4 +1,8 @@
 #include "video/texture_manager.h"
+#include "core/alloc_tracker.h"
+#include "core/profiler.h"
+#include <cstring>
+#include <vector>
 
 namespace video {
 
@@ -7,10 +11,20 @@ TextureManager::TextureManager() {
 }
 
 TextureManager::~TextureManager() {
-    if (texture_id_ != 0) {
-        glDeleteTextures(1, &texture_id_);
-        texture_id_ = 0;
-    }
+    destroy_gl_objects();
+}
+
+bool TextureManager::r8_upload_supported() {
+    static const bool supported = []() {
+        bool ok = (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage) &&
+                  (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage) &&
+                  (GLEW_VERSION_3_3 || GLEW_ARB_texture_swizzle) &&
+                  (GLEW_VERSION_3_2 || GLEW_ARB_sync);
+        std::cout << "R8 texture upload (persistent PBO ring): "
+                  << (ok ? "enabled" : "unsupported, using RGB uploads") << std::endl;
+        return ok;
+    }();
+    return supported;
 }
 
 void TextureManager::ensure_texture_created() {
@@ -27,40 +41,23 @@ void TextureManager::ensure_texture_created() {
 }
 
 void TextureManager::upload_frame(const cv::Mat& frame) {
+    PROFILE_ZONE("TextureManager::upload_frame");
+    ALLOC_SCOPE("texture_upload");
     if (frame.empty()) {
         return;
     }
 
-    ensure_texture_created();
-
-    // Convert to RGB format for OpenGL
-    cv::Mat rgb_frame;
-    if (frame.channels() == 1) {
-        // Convert grayscale to RGB
-        cv::cvtColor(frame, rgb_frame, cv::COLOR_GRAY2RGB);
-    } else if (frame.channels() == 3) {
-        // If the frame is BGR, convert to RGB
-        if (frame.type() == CV_8UC3) {
-            cv::cvtColor(frame, rgb_frame, cv::COLOR_BGR2RGB);
-        } else {
-            rgb_frame = frame;
-        }
-    } else {
-        rgb_frame = frame;
+    if (frame.type() != CV_8UC1 || !upload_r8(frame, RowBands{})) {
+        upload_rgb(frame);
     }
 
-    // Upload to GPU
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, rgb_frame.cols, rgb_frame.rows,
-                 0, GL_RGB, GL_UNSIGNED_BYTE, rgb_frame.data);
-
-    width_ = rgb_frame.cols;
-    height_ = rgb_frame.rows;
-
     // ZERO-COPY: Store FrameRef (shares data, no clone!)
     last_frame_ = FrameRef(frame);
 }
 
 void TextureManager::upload_frame(const FrameRef& frame_ref) {
+    PROFILE_ZONE("TextureManager::upload_frame");
+    ALLOC_SCOPE("texture_upload");
     if (frame_ref.empty()) {
         return;
     }
@@ -79,15 +76,66 @@ void TextureManager::upload_frame(const FrameRef& frame_ref) {
         return;
     }
 
+    if (frame.type() != CV_8UC1 || !upload_r8(frame, frame_ref.row_bands())) {
+        upload_rgb(frame);
+    }
+
+    // ZERO-COPY: Store FrameRef (shares data, no clone!)
+    last_frame_ = frame_ref;
+}
+
+void TextureManager::prepare(int width, int height, int channels) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    // R8: touch the persistent PBOs and clear the storage from one of them
+    const bool r8_ready = channels == 1 && r8_enabled_ && r8_upload_supported() &&
+                          ((format_ == TextureFormat::R8 && width == width_ && height == height_) ||
+                           create_r8_storage(width, height));
+    if (r8_ready) {
+        const size_t size = static_cast<size_t>(width) * height;
+        for (auto& pbo : pbo_ring_) {
+            std::memset(pbo.mapped, 0, size);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_ring_[0].id);
+        glBindTexture(GL_TEXTURE_2D, texture_id_);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        pbo_ring_[0].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        pbo_index_ = 1;
+        texture_bands_ = RowBands{};  // The first real frame uploads in full
+        return;
+    }
+    if (format_ != TextureFormat::RGB) {
+        destroy_gl_objects();   // R8 texture of another size, or R8 storage half created
+    }
+
+    ensure_texture_created();
+    const std::vector<uint8_t> black(static_cast<size_t>(width) * height * 3, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, black.data());
+    width_ = width;
+    height_ = height;
+    format_ = TextureFormat::RGB;
+}
+
+void TextureManager::upload_rgb(const cv::Mat& frame) {
+    // R8 textures are immutable; switching back needs a fresh texture
+    if (format_ == TextureFormat::R8) {
+        destroy_gl_objects();
+    }
+
     ensure_texture_created();
 
     // Convert to RGB format for OpenGL
-    // For single-channel grayscale, convert to RGB
     cv::Mat rgb_frame;
     if (frame.channels() == 1) {
         // Convert grayscale to RGB
         cv::cvtColor(frame, rgb_frame, cv::COLOR_GRAY2RGB);
     } else if (frame.channels() == 3) {
+        // If the frame is BGR, convert to RGB
         if (frame.type() == CV_8UC3) {
             cv::cvtColor(frame, rgb_frame, cv::COLOR_BGR2RGB);
         } else {
@@ -109,16 +157,128 @@ void TextureManager::upload_frame(const FrameRef& frame_ref) {
 
     width_ = rgb_frame.cols;
     height_ = rgb_frame.rows;
+    format_ = TextureFormat::RGB;
+}
 
-    // ZERO-COPY: Store FrameRef (shares data, no clone!)
-    last_frame_ = frame_ref;
+bool TextureManager::upload_r8(const cv::Mat& frame, const RowBands& bands) {
+    if (!r8_enabled_ || !r8_upload_supported()) {
+        return false;
+    }
+
+    // (Re)allocate immutable storage only when size or format changes
+    if (format_ != TextureFormat::R8 || frame.cols != width_ || frame.rows != height_) {
+        if (!create_r8_storage(frame.cols, frame.rows)) {
+            destroy_gl_objects();
+            return false;
+        }
+    }
+
+    // Only the bands that differ from the frame the texture holds
+    const uint64_t changed = RowBands::upload_bands(texture_bands_, bands, height_);
+    if (changed == 0) {
+        texture_bands_ = bands;
+        return true;  // Both frames are all background
+    }
+
+    PixelBuffer& pbo = pbo_ring_[pbo_index_];
+
+    // Wait until the GPU has finished reading this slot (ring depth makes this rare)
+    if (pbo.fence) {
+        glClientWaitSync(pbo.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 2000000);  // 2 ms
+        glDeleteSync(pbo.fence);
+        pbo.fence = nullptr;
+    }
+
+    // Copy tightly packed rows into the mapped buffer and stream PBO -> texture
+    // (no storage reallocation); each changed run keeps its offset in the frame
+    uint8_t* dst = static_cast<uint8_t*>(pbo.mapped);
+    const size_t row_bytes = static_cast<size_t>(width_);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.id);
+    glBindTexture(GL_TEXTURE_2D, texture_id_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    RowBands::for_each_run(changed, height_, [&](int first_row, int rows) {
+        const size_t offset = first_row * row_bytes;
+        if (frame.isContinuous()) {
+            std::memcpy(dst + offset, frame.ptr<uint8_t>(first_row), row_bytes * rows);
+        } else {
+            for (int y = first_row; y < first_row + rows; ++y) {
+                std::memcpy(dst + y * row_bytes, frame.ptr<uint8_t>(y), row_bytes);
+            }
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first_row, width_, rows, GL_RED, GL_UNSIGNED_BYTE,
+                        reinterpret_cast<const void*>(offset));
+    });
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    texture_bands_ = bands;
+
+    pbo.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pbo_index_ = (pbo_index_ + 1) % PBO_RING_SIZE;
+    return true;
 }
 
-void TextureManager::reset() {
+bool TextureManager::create_r8_storage(int width, int height) {
+    destroy_gl_objects();
+
+    ensure_texture_created();
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, width, height);
+
+    // Display single channel as grayscale
+    const GLint swizzle[4] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+
+    const GLsizeiptr size = static_cast<GLsizeiptr>(width) * height;
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    for (auto& pbo : pbo_ring_) {
+        glGenBuffers(1, &pbo.id);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.id);
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, nullptr, flags);
+        pbo.mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, flags);
+
+        if (!pbo.mapped) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            std::cerr << "Failed to map persistent PBO, falling back to RGB uploads" << std::endl;
+            return false;
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    width_ = width;
+    height_ = height;
+    format_ = TextureFormat::R8;
+    pbo_index_ = 0;
+    texture_bands_ = RowBands{};  // Storage content undefined until the first full upload
+    return true;
+}
+
+void TextureManager::destroy_gl_objects() {
+    for (auto& pbo : pbo_ring_) {
+        if (pbo.fence) {
+            glDeleteSync(pbo.fence);
+            pbo.fence = nullptr;
+        }
+        if (pbo.id != 0) {
+            if (pbo.mapped) {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo.id);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                pbo.mapped = nullptr;
+            }
+            glDeleteBuffers(1, &pbo.id);
+            pbo.id = 0;
+        }
+    }
+
     if (texture_id_ != 0) {
         glDeleteTextures(1, &texture_id_);
         texture_id_ = 0;
     }
+    format_ = TextureFormat::NONE;
+}
+
+void TextureManager::reset() {
+    destroy_gl_objects();
     width_ = 0;
     height_ = 0;
     last_frame_.reset();  // Clear stored frame reference
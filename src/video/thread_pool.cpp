@@ -0,0 +1,139 @@
+#include "video/thread_pool.h"
+#include <algorithm>
+
+namespace video {
+
+ThreadPool::ThreadPool(int worker_count) {
+    if (worker_count < 0) {
+        worker_count = std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+
+    // One queue per worker plus one the calling threads drain from too
+    for (int i = 0; i <= worker_count; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (int i = 0; i < worker_count; ++i) {
+        workers_.emplace_back(&ThreadPool::worker_loop, this, static_cast<size_t>(i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+int ThreadPool::band_rows(int rows, size_t bytes_per_row, size_t band_bytes) {
+    if (rows <= 0 || bytes_per_row == 0) {
+        return std::max(rows, 1);
+    }
+    return static_cast<int>(std::clamp<size_t>(band_bytes / bytes_per_row, 1, static_cast<size_t>(rows)));
+}
+
+void ThreadPool::push(Task task) {
+    const size_t index = next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    pending_.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);  // Pairs with the waiter's predicate check
+    }
+    wake_cv_.notify_one();
+}
+
+bool ThreadPool::try_pop(size_t index, Task& task) {
+    const size_t count = queues_.size();
+    for (size_t n = 0; n < count; ++n) {
+        Queue& queue = *queues_[(index + n) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (n == 0) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        } else {
+            task = std::move(queue.tasks.back());  // Steal from the cold end
+            queue.tasks.pop_back();
+        }
+        pending_.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::worker_loop(size_t index) {
+    Task task;
+    while (true) {
+        if (try_pop(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_cv_.wait(lock, [this] { return stopping_ || pending_.load(std::memory_order_acquire) > 0; });
+        if (stopping_) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::post(std::function<void()> task) {
+    push(std::move(task));
+}
+
+void ThreadPool::parallel_for(int count, const std::function<void(int)>& body) {
+    if (count <= 0) {
+        return;
+    }
+    if (count == 1 || workers_.empty()) {
+        for (int i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    // Completion state lives on this stack frame. The count only changes under
+    // done_mutex, so the last task has let go of it before the wait returns.
+    int remaining = count - 1;
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+
+    for (int i = 1; i < count; ++i) {
+        push([&, i] {
+            body(i);
+            std::lock_guard<std::mutex> lock(done_mutex);
+            if (--remaining == 0) {
+                done_cv.notify_one();
+            }
+        });
+    }
+
+    // Caller takes the first index, then helps with whatever is still queued
+    body(0);
+    const size_t home = queues_.size() - 1;
+    Task task;
+    while (try_pop(home, task)) {
+        task();
+        task = nullptr;
+    }
+
+    // Everything left is running elsewhere: wait for the last one
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait(lock, [&] { return remaining == 0; });
+}
+
+} // namespace video
@@ -0,0 +1,122 @@
+#include "video/time_surface.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace video {
+
+namespace {
+
+// Cells at least this old are scrubbed to "never" before their age can wrap
+constexpr uint32_t STALE_AGE_US = uint32_t(1) << 31;
+
+// LUT spans this many time constants; 255 * exp(-8) rounds to 0
+constexpr uint32_t DECAY_SPAN = 8;
+
+// Cells up to this far ahead of the rendered "now" belong to a batch still being written
+constexpr uint32_t IN_FLIGHT_US = uint32_t(1) << 20;
+
+// Keeps DECAY_SPAN * decay_us well inside 32 bits (~4.5 min)
+constexpr uint32_t MAX_DECAY_US = uint32_t(1) << 28;
+
+} // namespace
+
+bool TimeSurface::configure(int width, int height) {
+    const bool valid = width > 0 && height > 0;
+    width_ = valid ? width : 0;
+    height_ = valid ? height : 0;
+    cells_.reset(valid ? new std::atomic<uint32_t>[static_cast<size_t>(width) * height]() : nullptr);
+    latest_ts_ = -1;
+    scrub_row_ = 0;
+
+    if (!valid) {
+        std::cerr << "TimeSurface: invalid size " << width << "x" << height << ", time surface disabled" << std::endl;
+    }
+    return valid;
+}
+
+void TimeSurface::update(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    if (!enabled_.load(std::memory_order_relaxed) || width_ == 0 || begin == end) {
+        return;
+    }
+
+    const unsigned width = static_cast<unsigned>(width_);
+    const unsigned height = static_cast<unsigned>(height_);
+    std::atomic<uint32_t>* cells = cells_.get();
+
+    // Time went backwards (replay restarted or looped): old stamps would read as future events
+    if (begin->t < latest_ts_.load(std::memory_order_relaxed)) {
+        const size_t count = static_cast<size_t>(width) * height;
+        for (size_t i = 0; i < count; ++i) {
+            cells[i].store(0, std::memory_order_relaxed);
+        }
+    }
+    for (const Metavision::EventCD* ev = begin; ev != end; ++ev) {
+        const unsigned x = ev->x;
+        const unsigned y = ev->y;
+        if (x < width && y < height) {
+            uint32_t stamp = static_cast<uint32_t>(ev->t);
+            stamp += stamp == 0 ? 1 : 0;  // 0 is "never"
+            cells[static_cast<size_t>(y) * width + x].store(stamp, std::memory_order_relaxed);
+        }
+    }
+
+    const int64_t latest = (end - 1)->t;
+    latest_ts_.store(latest, std::memory_order_relaxed);
+
+    // One row per batch: the whole plane is revisited long before a stale age can wrap
+    const uint32_t now = static_cast<uint32_t>(latest);
+    std::atomic<uint32_t>* row = cells + static_cast<size_t>(scrub_row_) * width;
+    for (unsigned x = 0; x < width; ++x) {
+        const uint32_t stamp = row[x].load(std::memory_order_relaxed);
+        if (stamp != 0 && now - stamp >= STALE_AGE_US) {
+            row[x].store(0, std::memory_order_relaxed);
+        }
+    }
+    scrub_row_ = scrub_row_ + 1 < height_ ? scrub_row_ + 1 : 0;
+}
+
+void TimeSurface::build_lut(uint32_t decay_us) {
+    const uint32_t horizon_us = DECAY_SPAN * decay_us;
+    for (int i = 0; i < LUT_SIZE; ++i) {
+        const double age_us = (i + 0.5) * horizon_us / LUT_SIZE;
+        lut_[i] = static_cast<uint8_t>(std::lround(255.0 * std::exp(-age_us / decay_us)));
+    }
+    lut_[0] = 255;  // An event at "now" is always full brightness
+    lut_scale_ = (uint64_t(LUT_SIZE) << 32) / horizon_us;
+    lut_decay_us_ = decay_us;
+}
+
+bool TimeSurface::render(cv::Mat& out, uint32_t decay_us) {
+    const int64_t latest = get_latest_timestamp();
+    if (width_ == 0 || latest < 0) {
+        return false;
+    }
+
+    decay_us = std::clamp<uint32_t>(decay_us, 1, MAX_DECAY_US);
+    if (decay_us != lut_decay_us_) {
+        build_lut(decay_us);
+    }
+
+    out.create(height_, width_, CV_8UC1);
+    const uint32_t now = static_cast<uint32_t>(latest);
+    const uint32_t horizon_us = DECAY_SPAN * decay_us;
+    const uint64_t scale = lut_scale_;
+    const uint8_t* lut = lut_.data();
+    const std::atomic<uint32_t>* cells = cells_.get();
+
+    for (int y = 0; y < height_; ++y) {
+        const std::atomic<uint32_t>* row = cells + static_cast<size_t>(y) * width_;
+        uint8_t* dst = out.ptr<uint8_t>(y);
+        for (int x = 0; x < width_; ++x) {
+            const uint32_t stamp = row[x].load(std::memory_order_relaxed);
+            uint32_t age = now - stamp;
+            age = age >= uint32_t(0) - IN_FLIGHT_US ? 0 : age;  // Newer than "now": written since latest was read
+            const bool visible = stamp != 0 && age < horizon_us;
+            dst[x] = visible ? lut[(uint64_t(age) * scale) >> 32] : 0;
+        }
+    }
+    return true;
+}
+
+} // namespace video
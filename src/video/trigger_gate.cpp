@@ -0,0 +1,83 @@
+#include "video/trigger_gate.h"
+#include <algorithm>
+
+namespace video {
+
+void TriggerGate::set_enabled(bool enabled, int64_t window_us) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    windows_.clear();
+    edge_high_ = false;
+    window_us_ = std::max<int64_t>(window_us, 0);
+    current_ = 0;
+    in_window_ = false;
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void TriggerGate::on_triggers(const Metavision::EventExtTrigger* begin, const Metavision::EventExtTrigger* end) {
+    if (!is_enabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Metavision::EventExtTrigger* ev = begin; ev != end; ++ev) {
+        if (ev->p != 0) {
+            if (edge_high_) {
+                continue;   // Repeated rising edge: the window is already open
+            }
+            edge_high_ = true;
+            Window window;
+            window.number = next_number_++;
+            window.begin_us = ev->t;
+            window.end_us = window_us_ > 0 ? ev->t + window_us_ : OPEN;
+            windows_.push_back(window);
+            windows_opened_.fetch_add(1, std::memory_order_relaxed);
+            if (windows_.size() > MAX_PENDING) {
+                windows_.pop_front();   // Frames stopped arriving; keep the newest windows
+                windows_dropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            edge_high_ = false;
+            if (window_us_ == 0 && !windows_.empty() && windows_.back().end_us == OPEN) {
+                windows_.back().end_us = ev->t;
+            }
+        }
+    }
+}
+
+TriggerGate::Step TriggerGate::step(int64_t frame_begin_us, int64_t frame_end_us) {
+    Step step;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Windows that ended before this frame started are over
+        while (!windows_.empty() && windows_.front().end_us <= frame_begin_us) {
+            if (windows_.front().number == current_) {
+                step.closed = true;
+                current_ = 0;
+            }
+            windows_.pop_front();
+        }
+
+        // The oldest remaining window has not ended before the frame; it holds
+        // the frame once it began before the frame's end
+        if (!windows_.empty() && windows_.front().begin_us < frame_end_us) {
+            const Window& window = windows_.front();
+            step.inside = true;
+            step.window = window.number;
+            step.begin_us = window.begin_us;
+            if (window.number != current_) {
+                step.closed = step.closed || current_ != 0;
+                step.opened = true;
+                current_ = window.number;
+            }
+        }
+    }
+
+    in_window_.store(step.inside, std::memory_order_relaxed);
+    if (step.inside) {
+        frames_inside_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return step;
+}
+
+} // namespace video
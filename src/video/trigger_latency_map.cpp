@@ -0,0 +1,181 @@
+#include "video/trigger_latency_map.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace video {
+
+namespace {
+
+// First event at or after t (batches are time-ordered)
+inline const Metavision::EventCD* first_at(const Metavision::EventCD* begin, const Metavision::EventCD* end,
+                                           int64_t t) {
+    return std::lower_bound(begin, end, t,
+                            [](const Metavision::EventCD& ev, int64_t ts) { return ev.t < ts; });
+}
+
+} // namespace
+
+void TriggerLatencyMap::configure(int width, int height) {
+    width_ = std::max(width, 0);
+    height_ = std::max(height, 0);
+    std::lock_guard<std::mutex> lock(planes_mutex_);
+    responded_.clear();
+    counts_.clear();
+    sums_.clear();
+    sums_sq_.clear();
+    batch_onsets_.clear();
+    cycle_ = 0;
+    window_end_us_ = 0;
+    cycles_ = 0;
+    responses_ = 0;
+    reset_requested_ = false;
+}
+
+void TriggerLatencyMap::set_enabled(bool enabled, int64_t window_us) {
+    {
+        std::lock_guard<std::mutex> lock(onsets_mutex_);
+        onsets_.clear();
+        edge_high_ = false;
+    }
+    window_us_ = std::max<int64_t>(window_us, 1);
+    reset_requested_ = true;
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void TriggerLatencyMap::on_triggers(const Metavision::EventExtTrigger* begin, const Metavision::EventExtTrigger* end) {
+    if (!is_enabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(onsets_mutex_);
+    for (const Metavision::EventExtTrigger* ev = begin; ev != end; ++ev) {
+        if (ev->p == 0) {
+            edge_high_ = false;
+            continue;
+        }
+        if (edge_high_) {
+            continue;   // Repeated rising edge: same stimulus
+        }
+        edge_high_ = true;
+        onsets_.push_back(ev->t);
+        if (onsets_.size() > MAX_PENDING) {
+            onsets_.erase(onsets_.begin());   // Events stopped arriving; keep the newest onsets
+            onsets_dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void TriggerLatencyMap::update(const Metavision::EventCD* begin, const Metavision::EventCD* end) {
+    if (!is_enabled() || width_ == 0 || height_ == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(planes_mutex_);
+    const size_t pixels = static_cast<size_t>(width_) * height_;
+    if (reset_requested_.exchange(false) || responded_.size() != pixels) {
+        responded_.assign(pixels, 0);
+        counts_.assign(pixels, 0);
+        sums_.assign(pixels, 0);
+        sums_sq_.assign(pixels, 0);
+        batch_onsets_.clear();
+        cycle_ = 0;
+        window_end_us_ = 0;
+        cycles_ = 0;
+        responses_ = 0;
+    }
+    {
+        std::lock_guard<std::mutex> onsets_lock(onsets_mutex_);
+        batch_onsets_.insert(batch_onsets_.end(), onsets_.begin(), onsets_.end());
+        onsets_.clear();
+    }
+
+    const int64_t window_us = window_us_.load(std::memory_order_relaxed);
+    uint32_t* responded = responded_.data();
+    uint64_t responses = 0;
+    size_t next = 0;
+    const Metavision::EventCD* ev = begin;
+    while (ev != end) {
+        // Events up to the next onset belong to the current cycle, if still inside its window
+        const Metavision::EventCD* segment_end =
+            next < batch_onsets_.size() ? first_at(ev, end, batch_onsets_[next]) : end;
+        const Metavision::EventCD* window_end = first_at(ev, segment_end, window_end_us_);
+        const uint32_t cycle = cycle_;
+        for (const Metavision::EventCD* e = ev; e != window_end; ++e) {
+            const size_t index = static_cast<size_t>(e->y) * width_ + e->x;
+            if (responded[index] == cycle) {
+                continue;   // Not the pixel's first event of this cycle
+            }
+            responded[index] = cycle;
+            const uint64_t latency = static_cast<uint64_t>(e->t - onset_us_);
+            ++counts_[index];
+            sums_[index] += latency;
+            sums_sq_[index] += latency * latency;
+            ++responses;
+        }
+        ev = segment_end;
+        if (ev == end) {
+            break;   // Later onsets wait for the events after them
+        }
+
+        onset_us_ = batch_onsets_[next++];
+        window_end_us_ = onset_us_ + window_us;
+        cycle_ = cycle_ == std::numeric_limits<uint32_t>::max() ? 1 : cycle_ + 1;
+        cycles_.fetch_add(1, std::memory_order_relaxed);
+    }
+    batch_onsets_.erase(batch_onsets_.begin(), batch_onsets_.begin() + next);
+    responses_.fetch_add(responses, std::memory_order_relaxed);
+}
+
+bool TriggerLatencyMap::build_maps(int min_cycles, cv::Mat& mean_us, cv::Mat& jitter_us, Summary& summary) const {
+    std::lock_guard<std::mutex> lock(planes_mutex_);
+    summary = Summary();
+    summary.cycles = cycles_.load(std::memory_order_relaxed);
+    if (counts_.empty() || summary.cycles == 0) {
+        return false;
+    }
+
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    mean_us.create(height_, width_, CV_32FC1);
+    jitter_us.create(height_, width_, CV_32FC1);
+    const uint32_t min_count = static_cast<uint32_t>(std::max(min_cycles, 1));
+    std::vector<float> means;
+    double mean_total = 0.0;
+    double jitter_total = 0.0;
+    for (int y = 0; y < height_; ++y) {
+        float* mean_row = mean_us.ptr<float>(y);
+        float* jitter_row = jitter_us.ptr<float>(y);
+        for (int x = 0; x < width_; ++x) {
+            const size_t index = static_cast<size_t>(y) * width_ + x;
+            const uint32_t n = counts_[index];
+            if (n < min_count) {
+                mean_row[x] = nan;
+                jitter_row[x] = nan;
+                continue;
+            }
+            const double mean = static_cast<double>(sums_[index]) / n;
+            const double variance = std::max(static_cast<double>(sums_sq_[index]) / n - mean * mean, 0.0);
+            const double jitter = std::sqrt(variance);
+            mean_row[x] = static_cast<float>(mean);
+            jitter_row[x] = static_cast<float>(jitter);
+            means.push_back(static_cast<float>(mean));
+            mean_total += mean;
+            jitter_total += jitter;
+        }
+    }
+
+    summary.pixels = static_cast<int>(means.size());
+    if (!means.empty()) {
+        summary.mean_us = mean_total / means.size();
+        summary.mean_jitter_us = jitter_total / means.size();
+        const size_t mid = means.size() / 2;
+        std::nth_element(means.begin(), means.begin() + mid, means.end());
+        summary.median_us = means[mid];
+        const size_t p95 = std::min(means.size() - 1, means.size() * 95 / 100);
+        std::nth_element(means.begin(), means.begin() + p95, means.end());
+        summary.p95_us = means[p95];
+    }
+    return true;
+}
+
+} // namespace video
@@ -1,5 +1,8 @@
 #include "video/triple_buffer_renderer.h"
-#include <chrono>
+#include "core/alloc_tracker.h"
+#include "core/profiler.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 namespace video {
@@ -29,21 +32,25 @@ void TripleBufferRenderer::create_pbo(GLuint& pbo_id, size_t size) {
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 }
 
-void TripleBufferRenderer::ensure_gl_resources_created(int width, int height) {
-    if (initialized_ && width == width_ && height == height_) {
+void TripleBufferRenderer::ensure_gl_resources_created(int width, int height, int channels) {
+    if (initialized_ && width == width_ && height == height_ && channels == channels_) {
         return;  // Resources already created for this size
     }
 
-    // Clean up old resources if size changed
+    // Clean up old resources if size changed (keeps any pending frame)
     if (initialized_) {
         reset();
     }
 
     width_ = width;
     height_ = height;
+    channels_ = channels;
 
-    // Calculate buffer size (RGB, 3 bytes per pixel)
-    size_t buffer_size = width * height * 3;
+    // Single-channel frames stay 1 byte/pixel on the GPU when swizzle is available
+    use_r8_ = (channels == 1) && (GLEW_VERSION_3_3 || GLEW_ARB_texture_swizzle);
+    const GLint internal_format = use_r8_ ? GL_R8 : GL_RGB;
+    const GLenum format = use_r8_ ? GL_RED : GL_RGB;
+    size_t buffer_size = static_cast<size_t>(width) * height * (use_r8_ ? 1 : 3);
 
     // Create textures and PBOs for all 3 buffers
     for (int i = 0; i < NUM_BUFFERS; ++i) {
@@ -52,14 +59,60 @@ void TripleBufferRenderer::ensure_gl_resources_created(int width, int height) {
 
         // Pre-allocate texture storage
         glBindTexture(GL_TEXTURE_2D, buffers_[i].texture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height,
-                     0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height,
+                     0, format, GL_UNSIGNED_BYTE, nullptr);
+
+        if (use_r8_) {
+            const GLint swizzle[4] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+        }
     }
 
     glBindTexture(GL_TEXTURE_2D, 0);
     initialized_ = true;
 }
 
+void TripleBufferRenderer::prepare(int width, int height, int channels) {
+    if (width <= 0 || height <= 0 || (channels != 1 && channels != 3)) {
+        return;
+    }
+    ensure_gl_resources_created(width, height, channels);
+
+    const size_t row_bytes = static_cast<size_t>(width) * (use_r8_ ? 1 : 3);
+    const size_t size = row_bytes * height;
+    for (BufferSlot& slot : buffers_) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        void* ptr = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+        if (ptr) {
+            std::memset(ptr, 0, size);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindTexture(GL_TEXTURE_2D, slot.texture);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, use_r8_ ? GL_RED : GL_RGB, GL_UNSIGNED_BYTE,
+                            nullptr);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        }
+        slot.texture_bands = RowBands{};  // The first real frame uploads in full
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+bool TripleBufferRenderer::fence_done(GLsync& fence) {
+    if (!fence) {
+        return true;
+    }
+
+    GLenum status = glClientWaitSync(fence, 0, 0);  // Poll only, never block
+    if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+        glDeleteSync(fence);
+        fence = nullptr;
+        return true;
+    }
+    return false;
+}
+
 void TripleBufferRenderer::async_upload_frame(BufferSlot& slot) {
     if (slot.frame.empty()) {
         return;
@@ -69,37 +122,56 @@ void TripleBufferRenderer::async_upload_frame(BufferSlot& slot) {
     ReadGuard guard(slot.frame);
     const cv::Mat& frame = guard.get();
 
-    // Ensure resources created
-    ensure_gl_resources_created(frame.cols, frame.rows);
-
-    // Convert BGR to RGB if needed
-    cv::Mat rgb_frame;
+    // Convert to upload layout if needed
+    cv::Mat upload;
     if (frame.channels() == 3) {
-        cv::cvtColor(frame, rgb_frame, cv::COLOR_BGR2RGB);
+        cv::cvtColor(frame, upload, cv::COLOR_BGR2RGB);
+    } else if (!use_r8_) {
+        cv::cvtColor(frame, upload, cv::COLOR_GRAY2RGB);
     } else {
-        rgb_frame = frame;
+        upload = frame.isContinuous() ? frame : frame.clone();
     }
 
+    const size_t size = upload.total() * upload.elemSize();
+    const size_t row_bytes = upload.cols * upload.elemSize();
+
+    // R8 slots only re-upload the bands that differ from the slot's previous frame
+    const RowBands bands = use_r8_ ? slot.frame.row_bands() : RowBands{};
+    const uint64_t changed = RowBands::upload_bands(slot.texture_bands, bands, upload.rows);
+    slot.texture_bands = RowBands{};  // Unknown until the upload below is issued
+
     // Bind PBO for async upload
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.pbo);
 
     // Map PBO buffer for writing (invalidate old data for performance)
-    glBufferData(GL_PIXEL_UNPACK_BUFFER, rgb_frame.total() * rgb_frame.elemSize(),
-                 nullptr, GL_STREAM_DRAW);
-    void* ptr = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    void* ptr = nullptr;
+    if (changed != 0) {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        ptr = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    }
 
     if (ptr) {
-        // Copy frame data to PBO
-        memcpy(ptr, rgb_frame.data, rgb_frame.total() * rgb_frame.elemSize());
+        // Copy the changed rows to the PBO, each at its offset in the frame
+        RowBands::for_each_run(changed, upload.rows, [&](int first_row, int rows) {
+            memcpy(static_cast<uint8_t*>(ptr) + first_row * row_bytes, upload.ptr(first_row), rows * row_bytes);
+        });
         glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
 
         // Upload from PBO to texture (async - GPU DMA transfer)
         glBindTexture(GL_TEXTURE_2D, slot.texture);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, rgb_frame.cols, rgb_frame.rows,
-                        GL_RGB, GL_UNSIGNED_BYTE, 0);  // 0 = use bound PBO
-
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        RowBands::for_each_run(changed, upload.rows, [&](int first_row, int rows) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first_row, upload.cols, rows, use_r8_ ? GL_RED : GL_RGB,
+                            GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(first_row * row_bytes));  // Offset into bound PBO
+        });
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
         glBindTexture(GL_TEXTURE_2D, 0);
     }
+    if (ptr || changed == 0) {
+        // Nothing changed still goes through the fence, so the slot is promoted as usual
+        slot.texture_bands = bands;
+        slot.upload_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
 
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 }
@@ -109,14 +181,15 @@ void TripleBufferRenderer::submit_frame(const FrameRef& frame_ref) {
         return;
     }
 
-    int idx = write_idx_.load(std::memory_order_acquire);
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    if (has_pending_) {
+        stats_.frames_skipped++;  // Previous pending frame never reached the GPU
+    }
 
-    // Store frame in write buffer (zero-copy share)
-    buffers_[idx].frame = frame_ref;
-    buffers_[idx].timestamp.store(
-        std::chrono::steady_clock::now().time_since_epoch().count(),
-        std::memory_order_release);
-    buffers_[idx].ready.store(true, std::memory_order_release);
+    // Store frame as pending (zero-copy share)
+    pending_frame_ = frame_ref;
+    pending_time_ = Clock::now();
+    has_pending_ = true;
 }
 
 void TripleBufferRenderer::submit_frame(FrameRef&& frame_ref) {
@@ -124,44 +197,121 @@ void TripleBufferRenderer::submit_frame(FrameRef&& frame_ref) {
         return;
     }
 
-    int idx = write_idx_.load(std::memory_order_acquire);
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    if (has_pending_) {
+        stats_.frames_skipped++;
+    }
 
-    // Store frame in write buffer (zero-copy move)
-    buffers_[idx].frame = std::move(frame_ref);
-    buffers_[idx].timestamp.store(
-        std::chrono::steady_clock::now().time_since_epoch().count(),
-        std::memory_order_release);
-    buffers_[idx].ready.store(true, std::memory_order_release);
+    // Store frame as pending (zero-copy move)
+    pending_frame_ = std::move(frame_ref);
+    pending_time_ = Clock::now();
+    has_pending_ = true;
 }
 
 void TripleBufferRenderer::update() {
-    // Check if write buffer has new frame ready
-    int write_idx = write_idx_.load(std::memory_order_acquire);
-    int upload_idx = upload_idx_.load(std::memory_order_acquire);
+    PROFILE_ZONE("TripleBufferRenderer::update");
+    ALLOC_SCOPE("triple_buffer_update");
+    // 1. Promote finished upload to display
+    if (upload_idx_ >= 0 && fence_done(buffers_[upload_idx_].upload_fence)) {
+        BufferSlot& slot = buffers_[upload_idx_];
+
+        double latency_ms = std::chrono::duration<double, std::milli>(
+            Clock::now() - slot.submit_time).count();
+
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        stats_.last_latency_ms = latency_ms;
+        stats_.avg_latency_ms = (stats_.frames_uploaded == 0)
+            ? latency_ms
+            : stats_.avg_latency_ms * 0.9 + latency_ms * 0.1;
+        stats_.max_latency_ms = std::max(stats_.max_latency_ms, latency_ms);
+        stats_.frames_uploaded++;
+
+        display_idx_ = upload_idx_;
+        upload_idx_ = -1;
+    }
 
-    if (buffers_[write_idx].ready.load(std::memory_order_acquire)) {
-        // Swap write and upload buffers atomically
-        write_idx_.store(upload_idx, std::memory_order_release);
-        upload_idx_.store(write_idx, std::memory_order_release);
-        buffers_[write_idx].ready.store(false, std::memory_order_release);
+    // 2. Start uploading newest pending frame if a slot is free
+    if (upload_idx_ >= 0) {
+        return;  // Previous upload still in flight; keep the newest pending frame
+    }
 
-        // Now upload from new upload buffer
-        async_upload_frame(buffers_[upload_idx]);
+    FrameRef frame;
+    Clock::time_point submit_time;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        if (!has_pending_) {
+            return;
+        }
+        frame = std::move(pending_frame_);
+        submit_time = pending_time_;
+        has_pending_ = false;
+        pending_frame_.reset();
+    }
 
-        // Swap upload and display buffers for next render
-        int display_idx = display_idx_.load(std::memory_order_acquire);
-        upload_idx_.store(display_idx, std::memory_order_release);
-        display_idx_.store(upload_idx, std::memory_order_release);
+    {
+        ReadGuard guard(frame);
+        const cv::Mat& mat = guard.get();
+        if (mat.empty()) {
+            return;
+        }
+        ensure_gl_resources_created(mat.cols, mat.rows, mat.channels());
+    }
+
+    // Any slot other than display whose last draw has completed on the GPU
+    for (int i = 0; i < NUM_BUFFERS; ++i) {
+        if (i == display_idx_ || !fence_done(buffers_[i].render_fence)) {
+            continue;
+        }
+
+        BufferSlot& slot = buffers_[i];
+        slot.frame = std::move(frame);
+        slot.submit_time = submit_time;
+        async_upload_frame(slot);
+        if (slot.upload_fence) {
+            upload_idx_ = i;
+        }
+        return;
+    }
+
+    // GPU still sampling every spare slot: put frame back, retry next UI frame
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    if (!has_pending_) {
+        pending_frame_ = std::move(frame);
+        pending_time_ = submit_time;
+        has_pending_ = true;
     }
 }
 
+void TripleBufferRenderer::end_frame() {
+    if (!initialized_ || display_idx_ < 0) {
+        return;
+    }
+
+    GLsync& fence = buffers_[display_idx_].render_fence;
+    if (fence) {
+        glDeleteSync(fence);
+    }
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
 GLuint TripleBufferRenderer::get_texture_id() const {
-    if (!initialized_) {
+    if (!initialized_ || display_idx_ < 0) {
         return 0;
     }
 
-    int idx = display_idx_.load(std::memory_order_acquire);
-    return buffers_[idx].texture;
+    return buffers_[display_idx_].texture;
+}
+
+FrameRef TripleBufferRenderer::get_display_frame() const {
+    if (display_idx_ < 0) {
+        return FrameRef();
+    }
+    return buffers_[display_idx_].frame;
+}
+
+TripleBufferRenderer::UploadStats TripleBufferRenderer::get_stats() const {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    return stats_;
 }
 
 void TripleBufferRenderer::reset() {
@@ -171,6 +321,14 @@ void TripleBufferRenderer::reset() {
 
     // Delete all OpenGL resources
     for (int i = 0; i < NUM_BUFFERS; ++i) {
+        if (buffers_[i].upload_fence) {
+            glDeleteSync(buffers_[i].upload_fence);
+            buffers_[i].upload_fence = nullptr;
+        }
+        if (buffers_[i].render_fence) {
+            glDeleteSync(buffers_[i].render_fence);
+            buffers_[i].render_fence = nullptr;
+        }
         if (buffers_[i].texture != 0) {
             glDeleteTextures(1, &buffers_[i].texture);
             buffers_[i].texture = 0;
@@ -180,11 +338,14 @@ void TripleBufferRenderer::reset() {
             buffers_[i].pbo = 0;
         }
         buffers_[i].frame.reset();
-        buffers_[i].ready.store(false);
+        buffers_[i].texture_bands = RowBands{};
     }
 
+    upload_idx_ = -1;
+    display_idx_ = -1;
     width_ = 0;
     height_ = 0;
+    channels_ = 0;
     initialized_ = false;
 }
 
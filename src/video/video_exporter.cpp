@@ -0,0 +1,249 @@
+#include "video/video_exporter.h"
+#include "core/thread_placement.h"
+#include <opencv2/videoio.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace video {
+
+namespace {
+
+/**
+ * Lossless codecs tried in order for a container
+ */
+std::vector<std::string> codecs_for(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".avi") {
+        return {"FFV1", "HFYU"};
+    }
+    return {"FFV1"};
+}
+
+} // namespace
+
+VideoExporter::~VideoExporter() {
+    close();
+}
+
+std::string VideoExporter::timestamps_path(const std::string& video_path) {
+    fs::path path(video_path);
+    path.replace_filename(path.stem().string() + "_timestamps.csv");
+    return path.string();
+}
+
+bool VideoExporter::open(const std::string& path, cv::Size size, double fps) {
+    close();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_.clear();
+    }
+    if (path.empty() || size.area() <= 0) {
+        error_ = "Nothing to export";
+        return false;
+    }
+
+    std::error_code ec;
+    const fs::path video_path(path);
+    if (video_path.has_parent_path()) {
+        fs::create_directories(video_path.parent_path(), ec);
+    }
+
+    // FFmpeg backend only: the others have no lossless intra codec
+    writer_ = std::make_unique<cv::VideoWriter>();
+    codec_.clear();
+    for (const std::string& codec : codecs_for(video_path)) {
+        const int fourcc = cv::VideoWriter::fourcc(codec[0], codec[1], codec[2], codec[3]);
+        if (writer_->open(path, cv::CAP_FFMPEG, fourcc, std::max(fps, 1.0), size,
+                          {cv::VIDEOWRITER_PROP_IS_COLOR, 0})) {
+            codec_ = codec;
+            break;
+        }
+    }
+    if (codec_.empty()) {
+        writer_.reset();
+        error_ = "No lossless encoder for " + path + " (FFV1 needs OpenCV's FFmpeg backend)";
+        std::cerr << "VideoExporter: " << error_ << std::endl;
+        return false;
+    }
+
+    timestamps_.open(timestamps_path(path));
+    if (!timestamps_.is_open()) {
+        writer_.reset();
+        error_ = "Cannot write " + timestamps_path(path);
+        std::cerr << "VideoExporter: " << error_ << std::endl;
+        return false;
+    }
+    timestamps_ << "frame,timestamp_us\n";
+
+    path_ = path;
+    size_ = size;
+    slots_.assign(QUEUE_FRAMES, Slot());
+    for (Slot& slot : slots_) {
+        slot.frame.create(size.width, size.height);   // Allocated once, reused for every frame
+    }
+    free_.clear();
+    for (int i = static_cast<int>(QUEUE_FRAMES) - 1; i >= 0; --i) {
+        free_.push_back(i);
+    }
+    ready_.clear();
+    finishing_ = false;
+    done_.store(false);
+    written_.store(0, std::memory_order_relaxed);
+    encode_ns_.store(0, std::memory_order_relaxed);
+    first_timestamp_.store(-1, std::memory_order_relaxed);
+    last_timestamp_.store(-1, std::memory_order_relaxed);
+
+    thread_ = std::thread(&VideoExporter::encoder_loop, this);
+    std::cout << "VideoExporter: " << path << " (" << codec_ << ", " << size.width << "x" << size.height
+              << ")" << std::endl;
+    return true;
+}
+
+int VideoExporter::acquire_slot(bool wait) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (wait) {
+        free_cv_.wait(lock, [this] { return finishing_ || !free_.empty(); });
+    }
+    if (finishing_ || free_.empty()) {
+        return -1;
+    }
+    const int index = free_.back();
+    free_.pop_back();
+    return index;
+}
+
+void VideoExporter::submit_slot(int index) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready_.push_back(index);
+    }
+    ready_cv_.notify_one();
+}
+
+bool VideoExporter::push(const BinaryFrame& frame, int64_t timestamp_us, bool wait) {
+    if (!is_open() || frame.size() != size_) {
+        return false;
+    }
+    const int index = acquire_slot(wait);
+    if (index < 0) {
+        return false;
+    }
+    // Same size: copies the words into the slot's storage
+    std::copy(frame.data(), frame.data() + frame.word_count(), slots_[index].frame.data());
+    slots_[index].timestamp_us = timestamp_us;
+    submit_slot(index);
+    return true;
+}
+
+bool VideoExporter::push(const cv::Mat& frame, int64_t timestamp_us, bool wait) {
+    if (!is_open() || frame.size() != size_ || frame.type() != CV_8UC1) {
+        return false;
+    }
+    const int index = acquire_slot(wait);
+    if (index < 0) {
+        return false;
+    }
+    slots_[index].frame.assign(frame);
+    slots_[index].timestamp_us = timestamp_us;
+    submit_slot(index);
+    return true;
+}
+
+void VideoExporter::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finishing_ = true;
+    }
+    ready_cv_.notify_one();
+    free_cv_.notify_all();
+}
+
+bool VideoExporter::close() {
+    if (!thread_.joinable()) {
+        return false;
+    }
+    finish();
+    thread_.join();
+
+    timestamps_.close();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (timestamps_.fail() && error_.empty()) {
+        error_ = "Failed to write " + timestamps_path(path_);
+    }
+    if (!error_.empty()) {
+        std::cerr << "VideoExporter: " << error_ << std::endl;
+        return false;
+    }
+    std::cout << "VideoExporter: " << path_ << ": " << written_.load() << " frames, "
+              << get_speed() << "x real time" << std::endl;
+    return true;
+}
+
+std::string VideoExporter::get_error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+size_t VideoExporter::get_pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ready_.size();
+}
+
+double VideoExporter::get_speed() const {
+    const int64_t first = first_timestamp_.load(std::memory_order_relaxed);
+    const int64_t last = last_timestamp_.load(std::memory_order_relaxed);
+    const double encode_s = get_encode_seconds();
+    if (first < 0 || last <= first || encode_s <= 0.0) {
+        return 0.0;
+    }
+    return (last - first) / 1e6 / encode_s;
+}
+
+void VideoExporter::encoder_loop() {
+    core::ThreadPlacements::instance().place_current_thread(core::ThreadStage::IO);
+    cv::Mat unpacked;   // Reused for every frame
+    while (true) {
+        int index = -1;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_cv_.wait(lock, [this] { return finishing_ || !ready_.empty(); });
+            if (ready_.empty()) {
+                break;  // Finishing and fully drained
+            }
+            index = ready_.front();
+            ready_.pop_front();
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const Slot& slot = slots_[index];
+        slot.frame.to_mat(unpacked);
+        writer_->write(unpacked);
+        const int64_t frame = written_.fetch_add(1, std::memory_order_relaxed);
+        timestamps_ << frame << ',' << slot.timestamp_us << '\n';
+        if (frame == 0) {
+            first_timestamp_.store(slot.timestamp_us, std::memory_order_relaxed);
+        }
+        last_timestamp_.store(slot.timestamp_us, std::memory_order_relaxed);
+        encode_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(index);
+        }
+        free_cv_.notify_one();
+    }
+
+    writer_->release();   // Writes the container trailer (seek index)
+    writer_.reset();
+    done_.store(true);
+}
+
+} // namespace video
@@ -0,0 +1,98 @@
+#include "video/window_pyramid.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace video {
+
+int WindowPyramid::configure(int fine_window_us, const std::vector<int>& windows_us) {
+    levels_.clear();
+    const int fine = std::max(fine_window_us, 1);
+
+    std::vector<int> windows;
+    for (int window : windows_us) {
+        const int rounded = std::max((window + fine / 2) / fine, 1) * fine;
+        if (rounded != window && window > fine) {
+            std::cerr << "Accumulation window " << window << " μs is not a multiple of " << fine
+                      << " μs, using " << rounded << " μs" << std::endl;
+        }
+        if (rounded > fine) {
+            windows.push_back(rounded);
+        }
+    }
+    std::sort(windows.begin(), windows.end());
+    windows.erase(std::unique(windows.begin(), windows.end()), windows.end());
+    if (static_cast<int>(windows.size()) > MAX_LEVELS) {
+        std::cerr << "Only " << MAX_LEVELS << " accumulation windows supported, ignoring the longest "
+                  << (windows.size() - MAX_LEVELS) << std::endl;
+        windows.resize(MAX_LEVELS);
+    }
+
+    levels_.resize(windows.size());
+    for (size_t i = 0; i < windows.size(); ++i) {
+        levels_[i].window_us = windows[i];
+    }
+    return levels();
+}
+
+void WindowPyramid::set_output_callback(OutputCallback callback) {
+    output_callback_ = std::move(callback);
+}
+
+void WindowPyramid::push(Metavision::timestamp ts, const BinaryFrame& fine) {
+    if (fine.empty()) return;
+
+    for (int i = 0; i < levels(); ++i) {
+        Level& level = levels_[i];
+
+        // The fine window ending at ts lies in the level window ending at the next multiple
+        const Metavision::timestamp window_end = ((ts - 1) / level.window_us + 1) * level.window_us;
+        if (level.window_end >= 0 && level.window_end != window_end) {
+            emit(i);  // Events skipped ahead (idle gap): close the window we had
+        }
+
+        if (level.window_end < 0) {
+            if (level.frame.width() != fine.width() || level.frame.height() != fine.height()) {
+                level.frame.create(fine.width(), fine.height());
+            }
+            level.window_end = window_end;
+            std::copy(fine.data(), fine.data() + fine.word_count(), level.frame.data());
+        } else {
+            BinaryFrame::bitwise_or(level.frame, fine, level.frame);
+        }
+
+        if (ts >= window_end) {
+            emit(i);
+        }
+    }
+}
+
+void WindowPyramid::emit(int index) {
+    Level& level = levels_[index];
+    if (output_callback_) {
+        output_callback_(index, level.window_end, level.frame);
+    }
+    level.window_end = -1;  // Next push() overwrites the frame, so no clear is needed
+}
+
+void WindowPyramid::reset() {
+    for (auto& level : levels_) {
+        level.window_end = -1;
+    }
+}
+
+std::vector<int> WindowPyramid::parse_windows(const std::string& list) {
+    std::vector<int> windows;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        item.erase(0, item.find_first_not_of(" \t"));
+        if (!item.empty()) {
+            windows.push_back(std::atoi(item.c_str()));
+        }
+    }
+    return windows;
+}
+
+} // namespace video